@@ -18,12 +18,16 @@
 	    i__3;
 
     /* Local variables */
-    static integer info;
-    static logical nota, notb;
-    static doublereal temp;
-    static integer i, j, l, ncola;
-    static integer nrowa, nrowb;
+    integer info;
+    logical nota, notb;
+    doublereal temp;
+    integer i, j, l, ncola;
+    integer nrowa, nrowb;
+    doublereal one = 1.;
     extern /* Subroutine */ int input_error_dist(char *, integer *);
+    extern int dgemm_blocked_dist(int, int, integer, integer, integer,
+	    doublereal, doublereal *, integer, doublereal *, integer,
+	    doublereal *, integer);
 
 
 /*  Purpose   
@@ -265,6 +269,24 @@
 	return 0;
     }
 
+/*     Products beyond a few thousand flops go to the blocked kernel
+       of dgemm_kernel.c, after C := beta*C. */
+
+    if ((doublereal) *m * *n * *k >= 4096.) {
+	if (*beta != 1.) {
+	    for (j = 1; j <= *n; ++j) {
+		for (i = 1; i <= *m; ++i) {
+		    C(i,j) = *beta == 0. ? 0. : *beta * C(i,j);
+		}
+	    }
+	}
+	if (dgemm_blocked_dist(nota, notb, *m, *n, *k, *alpha, a, *lda,
+			       b, *ldb, c, *ldc) == 0) {
+	    return 0;
+	}
+	beta = &one;
+    }
+
 /*     Start the operations. */
 
     if (notb) {
@@ -0,0 +1,257 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Blocked kernel of the internal dgemm
+ *
+ * <pre>
+ * dgemm_blocked_dist() computes C += alpha*op(A)*op(B) the way optimized
+ * BLAS libraries do: op(B) is copied by blocks of KC x NC into panels of
+ * NR columns, op(A) by blocks of MC x KC into panels of MR rows, and a
+ * micro-kernel multiplies one panel of each into an MR x NR block of C
+ * held in registers. The blocks fit in the caches, and the panels are
+ * read with unit stride whatever the transposition.
+ *
+ * The micro-kernel is chosen when compiling: AVX-512, AVX2 with FMA, or
+ * NEON (aarch64) intrinsics if the compiler targets them, e.g. with
+ * -march=native, and otherwise plain C that the compiler may vectorize.
+ * With OpenMP the blocks of op(A) are shared among the threads, unless
+ * the call is made from a parallel region.
+ * </pre>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "f2c.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define MR 16
+#define NR 8
+#elif defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define MR 8
+#define NR 6
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define MR 8
+#define NR 6
+#else
+#define MR 8
+#define NR 4
+#endif
+
+#define KC 256          /* op(A) panel of MR x KC in L1, op(B) block in L3 */
+#define MC 128          /* op(A) block of MC x KC in L2 */
+#define NC 2048
+
+/* C[0:MR-1, 0:NR-1] += Ap * Bp, Ap an MR x kc panel and Bp a kc x NR one. */
+static void
+dgemm_ukernel(integer kc, const doublereal *Ap, const doublereal *Bp,
+	      doublereal *c, integer ldc)
+{
+    integer p;
+    int j;
+
+#if defined(__AVX512F__)
+    __m512d c0[NR], c1[NR], a0, a1, bj;
+
+    for (j = 0; j < NR; ++j) c0[j] = c1[j] = _mm512_setzero_pd();
+    for (p = 0; p < kc; ++p, Ap += MR, Bp += NR) {
+	a0 = _mm512_loadu_pd(Ap);
+	a1 = _mm512_loadu_pd(Ap + 8);
+	for (j = 0; j < NR; ++j) {
+	    bj = _mm512_set1_pd(Bp[j]);
+	    c0[j] = _mm512_fmadd_pd(a0, bj, c0[j]);
+	    c1[j] = _mm512_fmadd_pd(a1, bj, c1[j]);
+	}
+    }
+    for (j = 0; j < NR; ++j, c += ldc) {
+	_mm512_storeu_pd(c, _mm512_add_pd(_mm512_loadu_pd(c), c0[j]));
+	_mm512_storeu_pd(c + 8, _mm512_add_pd(_mm512_loadu_pd(c + 8), c1[j]));
+    }
+#elif defined(__AVX2__) && defined(__FMA__)
+    __m256d c0[NR], c1[NR], a0, a1, bj;
+
+    for (j = 0; j < NR; ++j) c0[j] = c1[j] = _mm256_setzero_pd();
+    for (p = 0; p < kc; ++p, Ap += MR, Bp += NR) {
+	a0 = _mm256_loadu_pd(Ap);
+	a1 = _mm256_loadu_pd(Ap + 4);
+	for (j = 0; j < NR; ++j) {
+	    bj = _mm256_broadcast_sd(Bp + j);
+	    c0[j] = _mm256_fmadd_pd(a0, bj, c0[j]);
+	    c1[j] = _mm256_fmadd_pd(a1, bj, c1[j]);
+	}
+    }
+    for (j = 0; j < NR; ++j, c += ldc) {
+	_mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), c0[j]));
+	_mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), c1[j]));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float64x2_t cc[NR][4], a[4];
+    int i;
+
+    for (j = 0; j < NR; ++j)
+	for (i = 0; i < 4; ++i) cc[j][i] = vdupq_n_f64(0.);
+    for (p = 0; p < kc; ++p, Ap += MR, Bp += NR) {
+	for (i = 0; i < 4; ++i) a[i] = vld1q_f64(Ap + 2 * i);
+	for (j = 0; j < NR; ++j)
+	    for (i = 0; i < 4; ++i)
+		cc[j][i] = vfmaq_n_f64(cc[j][i], a[i], Bp[j]);
+    }
+    for (j = 0; j < NR; ++j, c += ldc)
+	for (i = 0; i < 4; ++i)
+	    vst1q_f64(c + 2 * i, vaddq_f64(vld1q_f64(c + 2 * i), cc[j][i]));
+#else
+    doublereal ab[NR][MR], bj;
+    int i;
+
+    memset(ab, 0, sizeof(ab));
+    for (p = 0; p < kc; ++p, Ap += MR, Bp += NR)
+	for (j = 0; j < NR; ++j) {
+	    bj = Bp[j];
+	    for (i = 0; i < MR; ++i) ab[j][i] += Ap[i] * bj;
+	}
+    for (j = 0; j < NR; ++j, c += ldc)
+	for (i = 0; i < MR; ++i) c[i] += ab[j][i];
+#endif
+}
+
+/* Copy alpha*op(A)[0:mc-1, 0:kc-1] into panels of MR rows, padded with 0. */
+static void
+dgemm_pack_a(int nota, integer mc, integer kc, doublereal alpha,
+	     const doublereal *a, integer lda, doublereal *Ap)
+{
+    integer i, ir, p, mr;
+
+    for (ir = 0; ir < mc; ir += MR, Ap += MR * kc) {
+	mr = mc - ir < MR ? mc - ir : MR;
+	for (p = 0; p < kc; ++p) {
+	    if ( nota )
+		for (i = 0; i < mr; ++i)
+		    Ap[p * MR + i] = alpha * a[ir + i + p * lda];
+	    else
+		for (i = 0; i < mr; ++i)
+		    Ap[p * MR + i] = alpha * a[p + (ir + i) * lda];
+	    for (; i < MR; ++i) Ap[p * MR + i] = 0.;
+	}
+    }
+}
+
+/* Copy op(B)[0:kc-1, 0:nc-1] into panels of NR columns, padded with 0. */
+static void
+dgemm_pack_b(int notb, integer kc, integer nc, const doublereal *b,
+	     integer ldb, doublereal *Bp)
+{
+    integer j, jr, p, nr;
+
+    for (jr = 0; jr < nc; jr += NR, Bp += NR * kc) {
+	nr = nc - jr < NR ? nc - jr : NR;
+	for (p = 0; p < kc; ++p) {
+	    if ( notb )
+		for (j = 0; j < nr; ++j)
+		    Bp[p * NR + j] = b[p + (jr + j) * ldb];
+	    else
+		for (j = 0; j < nr; ++j)
+		    Bp[p * NR + j] = b[jr + j + p * ldb];
+	    for (; j < NR; ++j) Bp[p * NR + j] = 0.;
+	}
+    }
+}
+
+/* C[0:mc-1, 0:nc-1] += Ap * Bp, for packed blocks of op(A) and op(B). */
+static void
+dgemm_macro(integer mc, integer nc, integer kc, const doublereal *Ap,
+	    const doublereal *Bp, doublereal *c, integer ldc)
+{
+    doublereal tmp[MR * NR];
+    integer ir, jr, i, j, mr, nr;
+
+    for (jr = 0; jr < nc; jr += NR) {
+	nr = nc - jr < NR ? nc - jr : NR;
+	for (ir = 0; ir < mc; ir += MR) {
+	    mr = mc - ir < MR ? mc - ir : MR;
+	    if ( mr == MR && nr == NR ) {
+		dgemm_ukernel(kc, Ap + ir * kc, Bp + jr * kc,
+			      c + ir + jr * ldc, ldc);
+	    } else { /* edge of C */
+		memset(tmp, 0, sizeof(tmp));
+		dgemm_ukernel(kc, Ap + ir * kc, Bp + jr * kc, tmp, MR);
+		for (j = 0; j < nr; ++j)
+		    for (i = 0; i < mr; ++i)
+			c[ir + i + (jr + j) * ldc] += tmp[i + j * MR];
+	    }
+	}
+    }
+}
+
+/*! \brief C := C + alpha*op(A)*op(B), op(A) m x k and op(B) k x n.
+ *
+ * <pre>
+ * nota (notb) is 1 if op(A) = A (op(B) = B), 0 if it is the transpose.
+ * The arguments are those of dgemm_(), checked by it. Returns 0, or -1
+ * if the work space cannot be allocated, in which case C is unchanged.
+ * </pre>
+ */
+int
+dgemm_blocked_dist(int nota, int notb, integer m, integer n, integer k,
+		   doublereal alpha, doublereal *a, integer lda,
+		   doublereal *b, integer ldb, doublereal *c, integer ldc)
+{
+    doublereal *Ap, *Bp;
+    integer jc, pc, nc, kc;
+    size_t nap = (size_t) MC * KC, nbp = (size_t) KC * ((NC < n ? NC : n) + NR);
+    int nthreads = 1;
+
+#ifdef _OPENMP
+    if ( !omp_in_parallel() && m > MC ) {
+	nthreads = omp_get_max_threads();
+	if ( nthreads > (m + MC - 1) / MC ) nthreads = (m + MC - 1) / MC;
+    }
+#endif
+    Ap = (doublereal *) malloc((nthreads * nap + nbp) * sizeof(doublereal));
+    if ( !Ap ) return -1;
+    Bp = Ap + nthreads * nap;
+
+    for (jc = 0; jc < n; jc += NC) {
+	nc = n - jc < NC ? n - jc : NC;
+	for (pc = 0; pc < k; pc += KC) {
+	    kc = k - pc < KC ? k - pc : KC;
+	    dgemm_pack_b(notb, kc, nc,
+			 notb ? b + pc + jc * ldb : b + jc + pc * ldb,
+			 ldb, Bp);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads) if (nthreads > 1)
+#endif
+	    {
+		doublereal *Apt = Ap;
+		integer ic, mc;
+
+#ifdef _OPENMP
+		Apt += omp_get_thread_num() * nap;
+#pragma omp for schedule(dynamic)
+#endif
+		for (ic = 0; ic < m; ic += MC) {
+		    mc = m - ic < MC ? m - ic : MC;
+		    dgemm_pack_a(nota, mc, kc, alpha,
+				 nota ? a + ic + pc * lda : a + pc + ic * lda,
+				 lda, Apt);
+		    dgemm_macro(mc, nc, kc, Apt, Bp, c + ic + jc * ldc, ldc);
+		}
+	    }
+	}
+    }
+    free(Ap);
+    return 0;
+}
@@ -16,14 +16,21 @@
     integer a_dim1, a_offset, b_dim1, b_offset, i__1, i__2, i__3;
 
     /* Local variables */
-    static integer info;
-    static doublereal temp;
-    static integer i, j, k;
-    static logical lside;
-    static integer nrowa;
-    static logical upper;
+    integer info;
+    doublereal temp;
+    integer i, j, k;
+    logical lside;
+    integer nrowa;
+    logical upper;
     extern /* Subroutine */ int input_error_dist(char *, integer *);
-    static logical nounit;
+    logical nounit;
+    logical notrans;
+    integer h, r;
+    doublereal one = 1., mone = -1.;
+    doublereal *a12, *a21, *a22, *b2;
+    extern /* Subroutine */ int dgemm_(char *, char *, integer *, integer *,
+	    integer *, doublereal *, doublereal *, integer *, doublereal *,
+	    integer *, doublereal *, doublereal *, integer *);
 
 
 /*  Purpose   
@@ -233,6 +240,60 @@
 	return 0;
     }
 
+/*     Large triangles are split in two, recursively: the solves with
+       the diagonal halves are smaller, and the update of the other half
+       of B is a dgemm, blocked in dgemm_kernel.c. */
+
+    if ((lside ? *m : *n) > 32) {
+	notrans = (strncmp(transa, "N", 1)==0);
+	h = (lside ? *m : *n) / 2;
+	r = (lside ? *m : *n) - h;
+	a12 = a + h * *lda;
+	a21 = a + h;
+	a22 = a12 + h;
+	if (*alpha != 1.) {
+	    for (j = 1; j <= *n; ++j) {
+		for (i = 1; i <= *m; ++i) {
+		    B(i,j) = *alpha * B(i,j);
+		}
+	    }
+	}
+	if (lside) {
+	    b2 = b + h;
+	    if (upper != notrans) {
+/*              op( A ) is lower: X1 first. */
+		dtrsm_(side, uplo, transa, diag, &h, n, &one, a, lda, b, ldb);
+		dgemm_(transa, "N", &r, n, &h, &mone, notrans ? a21 : a12,
+		       lda, b, ldb, &one, b2, ldb);
+		dtrsm_(side, uplo, transa, diag, &r, n, &one, a22, lda, b2,
+		       ldb);
+	    } else {
+		dtrsm_(side, uplo, transa, diag, &r, n, &one, a22, lda, b2,
+		       ldb);
+		dgemm_(transa, "N", &h, n, &r, &mone, notrans ? a12 : a21,
+		       lda, b2, ldb, &one, b, ldb);
+		dtrsm_(side, uplo, transa, diag, &h, n, &one, a, lda, b, ldb);
+	    }
+	} else {
+	    b2 = b + h * *ldb;
+	    if (upper == notrans) {
+/*              op( A ) is upper: X1 first. */
+		dtrsm_(side, uplo, transa, diag, m, &h, &one, a, lda, b, ldb);
+		dgemm_("N", transa, m, &r, &h, &mone, b, ldb,
+		       notrans ? a12 : a21, lda, &one, b2, ldb);
+		dtrsm_(side, uplo, transa, diag, m, &r, &one, a22, lda, b2,
+		       ldb);
+	    } else {
+		dtrsm_(side, uplo, transa, diag, m, &r, &one, a22, lda, b2,
+		       ldb);
+		dgemm_("N", transa, m, &h, &r, &mone, b2, ldb,
+		       notrans ? a21 : a12, lda, &one, b, ldb);
+		dtrsm_(side, uplo, transa, diag, m, &h, &one, a, lda, b, ldb);
+	    }
+	}
+	return 0;
+    }
+
 /*     Start the operations. */
 
     if (lside) {
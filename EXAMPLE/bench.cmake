@@ -0,0 +1,35 @@
+# Run pdbench over a set of matrices, process grids and thread counts.
+#
+# cmake -DMPIEXEC=<mpiexec> -DMPIEXEC_NUMPROC_FLAG=<flag> -DBENCH=<pdbench>
+#       -DMATRICES=<m1;m2;..> -DGRIDS=<2x2;..> -DTHREADS=<1;2;..>
+#       -DREPS=<n> -DOUTPUT=<file> -P bench.cmake
+#
+# Each run appends one line of JSON per repetition to OUTPUT; a matrix is
+# a file name or a generated matrix such as lap3d:<k> (see
+# dcreate_matrix_gen.c).
+
+file(WRITE "${OUTPUT}" "")
+separate_arguments(PREFLAGS UNIX_COMMAND "${MPIEXEC_PREFLAGS}")
+separate_arguments(POSTFLAGS UNIX_COMMAND "${MPIEXEC_POSTFLAGS}")
+
+foreach(matrix ${MATRICES})
+  foreach(grid ${GRIDS})
+    string(REPLACE "x" ";" rc "${grid}")
+    list(GET rc 0 nprow)
+    list(GET rc 1 npcol)
+    math(EXPR procs "${nprow} * ${npcol}")
+    foreach(threads ${THREADS})
+      message(STATUS "pdbench ${matrix} on ${nprow}x${npcol} processes, ${threads} threads")
+      set(ENV{OMP_NUM_THREADS} ${threads})
+      execute_process(
+        COMMAND ${MPIEXEC} ${MPIEXEC_NUMPROC_FLAG} ${procs} ${PREFLAGS}
+                ${BENCH} ${POSTFLAGS} -r ${nprow} -c ${npcol} -n ${REPS}
+                -o ${OUTPUT} ${matrix}
+        RESULT_VARIABLE result
+        OUTPUT_QUIET)
+      if(NOT result EQUAL 0)
+        message(WARNING "pdbench ${matrix} ${grid} failed: ${result}")
+      endif()
+    endforeach()
+  endforeach()
+endforeach()
@@ -0,0 +1,302 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Benchmark driver for PDGSSVX with machine-readable output
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <math.h>
+#include <string.h>
+#include "superlu_ddefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * The driver program PDBENCH.
+ *
+ * PDBENCH factorizes and solves one matrix a number of times with
+ * PDGSSVX and the default options, and writes one line of JSON per
+ * repetition, with the time of each phase (min/max/avg over the
+ * processes), the flop counts, the memory of the LU factors and the
+ * error of the solution. The matrix is either read from a file, as in
+ * PDDRIVE, or generated on the fly by each process, e.g. lap3d:<k> for
+ * the 7-point Laplacian on a k x k x k grid (see dcreate_matrix_gen.c).
+ *
+ * Usage:
+ *    mpiexec -n <np> pdbench -r <proc rows> -c <proc columns>
+ *            [-n <repetitions>] [-o <output file>] [-p] [-H] <matrix>
+ * Without -o, the JSON lines go to the standard output. The target
+ * superlu_bench runs it over a set of matrices, grids and thread counts
+ * (see bench.cmake).
+ *
+ * With -p, the first repetition also prints the memory predicted by
+ * superlu_predict() and the times simulated by superlu_simulate(), for
+ * the grid and for the candidates of SUPERLU_SIMULATE, e.g.
+ *    SUPERLU_SIMULATE=8x8,16x8:4 mpiexec -n 4 pdbench -r 2 -c 2 -p <matrix>
+ * to choose the grid of a large run from a small one; the JSON line gives
+ * the measured times of the small grid to calibrate the machine against
+ * (SUPERLU_SIM_MACHINE, see superlu_simulate.c).
+ *
+ * With -H, -r and -c are ignored: the grid and the threads per process
+ * are chosen for the matrix by superlu_gridinit_hybrid() among all the
+ * processes launched, which prints the candidates, e.g.
+ *    OMP_NUM_THREADS=2 mpiexec -n 32 pdbench -H <matrix>
+ * on nodes of 16 cores may keep 16, 8, 4, 2 or 1 processes per node with
+ * 2, 4, 8, 16 or 32 threads.
+ * </pre>
+ */
+
+/* Generate or read the matrix A0 on grid, with one right-hand side. */
+static void get_matrix(char *matrix, SuperMatrix *A0, double **b0, int *ldb,
+		       double **xtrue, int *ldx, gridinfo_t *grid)
+{
+    char *postfix = NULL;
+    FILE *fp;
+    int  i;
+
+    if ( dcreate_matrix_gen(A0, 1, b0, ldb, xtrue, ldx, matrix, grid) ) {
+	if ( !(fp = fopen(matrix, "r")) ) ABORT("File does not exist");
+	for (i = 0; i < strlen(matrix); ++i)
+	    if ( matrix[i] == '.' ) postfix = &matrix[i+1];
+	dcreate_matrix_postfix(A0, 1, b0, ldb, xtrue, ldx, fp, postfix, grid);
+	fclose(fp);
+    }
+}
+
+/* B := a copy of A, since PDGSSVX overwrites its matrix. */
+static void copy_matrix(SuperMatrix *A, SuperMatrix *B)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t m_loc = Astore->m_loc, nnz_loc = Astore->nnz_loc, i;
+    double *nzval = doubleMalloc_dist(nnz_loc);
+    int_t *colind = intMalloc_dist(nnz_loc);
+    int_t *rowptr = intMalloc_dist(m_loc + 1);
+
+    if ( !nzval || !colind || !rowptr )
+	ABORT("Malloc fails for the copy of A.");
+    for (i = 0; i < nnz_loc; ++i) {
+	nzval[i] = ((double *) Astore->nzval)[i];
+	colind[i] = Astore->colind[i];
+    }
+    for (i = 0; i <= m_loc; ++i) rowptr[i] = Astore->rowptr[i];
+    dCreate_CompRowLoc_Matrix_dist(B, A->nrow, A->ncol, nnz_loc, m_loc,
+				   Astore->fst_row, nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_D, SLU_GE);
+}
+
+/* Write "name": {"min": .., "max": .., "avg": ..} of a per-process value. */
+static void
+print_minmax(FILE *fp, const char *name, double v, gridinfo_t *grid, int last)
+{
+    double vmin, vmax, vsum;
+    int nprocs = grid->nprow * grid->npcol;
+
+    MPI_Reduce(&v, &vmin, 1, MPI_DOUBLE, MPI_MIN, 0, grid->comm);
+    MPI_Reduce(&v, &vmax, 1, MPI_DOUBLE, MPI_MAX, 0, grid->comm);
+    MPI_Reduce(&v, &vsum, 1, MPI_DOUBLE, MPI_SUM, 0, grid->comm);
+    if ( !grid->iam )
+	fprintf(fp, "\"%s\": {\"min\": %.6e, \"max\": %.6e, \"avg\": %.6e}%s",
+		name, vmin, vmax, vsum / nprocs, last ? "" : ", ");
+}
+
+int main(int argc, char *argv[])
+{
+    superlu_dist_options_t options;
+    SuperLUStat_t stat;
+    SuperMatrix A0, A;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    superlu_dist_mem_usage_t mem;
+    gridinfo_t grid;
+    double   *b0, *b, *xtrue, berr[1], t, err, xnorm, v;
+    double   fops, sops;
+    float    ops;
+    int      nprow = 1, npcol = 1, nreps = 1, predict = 0, hybrid = 0;
+    int      iam, info, ldb, ldx, m_loc, rep, i, nthreads = 1;
+    int      omp_mpi_level;
+    char     **cpp, c, *matrix = NULL, *output = NULL;
+    FILE     *out = stdout;
+    static const PhaseType phases[] =
+	{EQUIL, ROWPERM, COLPERM, SYMBFAC, DIST, FACT, SOLVE, REFINE};
+    static const char *phase_names[] =
+	{"equil", "rowperm", "colperm", "symbfact", "distribute", "factor",
+	 "solve", "refine"};
+    int nphases = sizeof(phases) / sizeof(phases[0]);
+
+    MPI_Init_thread( &argc, &argv, MPI_THREAD_MULTIPLE, &omp_mpi_level);
+
+    /* Parse command line argv[]. */
+    for (cpp = argv+1; *cpp; ++cpp) {
+	if ( **cpp == '-' ) {
+	    c = *(*cpp+1);
+	    ++cpp;
+	    switch (c) {
+	      case 'h':
+		  printf("Options:\n");
+		  printf("\t-r <int>: process rows    (default %4d)\n", nprow);
+		  printf("\t-c <int>: process columns (default %4d)\n", npcol);
+		  printf("\t-n <int>: repetitions     (default %4d)\n", nreps);
+		  printf("\t-o <file>: append the JSON lines to file\n");
+		  printf("\t-p: print the predicted memory and simulated times\n");
+		  printf("\t-H: choose the grid and the threads (hybrid mode)\n");
+		  printf("\t<matrix>: file name, or lap3d:<k>, cd3d:<k>, elast3d:<k>,\n\t\t  rand:<nb>... (see dcreate_matrix_gen.c)\n");
+		  exit(0);
+		  break;
+	      case 'r': nprow = atoi(*cpp);
+		        break;
+	      case 'c': npcol = atoi(*cpp);
+		        break;
+	      case 'n': nreps = atoi(*cpp);
+		        break;
+	      case 'o': output = *cpp;
+		        break;
+	      case 'p': predict = 1;
+			--cpp; /* no argument */
+		        break;
+	      case 'H': hybrid = 1;
+			--cpp; /* no argument */
+		        break;
+	    }
+	} else { /* Last arg is considered the matrix */
+	    matrix = *cpp;
+	    break;
+	}
+    }
+    if ( !matrix ) ABORT("No matrix given.");
+
+    /* ------------------------------------------------------------
+       INITIALIZE THE SUPERLU PROCESS GRID.
+       ------------------------------------------------------------*/
+    set_default_options_dist(&options);
+    if ( hybrid ) {
+	/* Read the matrix on all the processes to choose the grid, then
+	   again on the grid. */
+	MPI_Comm_size(MPI_COMM_WORLD, &npcol);
+	superlu_gridinit(MPI_COMM_WORLD, 1, npcol, &grid);
+	get_matrix(matrix, &A0, &b0, &ldb, &xtrue, &ldx, &grid);
+	superlu_gridexit(&grid);
+	superlu_gridinit_hybrid(MPI_COMM_WORLD, &options, &A0, 1, &grid);
+	Destroy_CompRowLoc_Matrix_dist(&A0);
+	SUPERLU_FREE(b0);
+	SUPERLU_FREE(xtrue);
+	nprow = grid.nprow;
+	npcol = grid.npcol;
+    } else {
+	superlu_gridinit(MPI_COMM_WORLD, nprow, npcol, &grid);
+    }
+
+    /* Bail out if I do not belong in the grid. */
+    iam = grid.iam;
+    if ( iam >= nprow * npcol )	goto out;
+
+    /* ------------------------------------------------------------
+       GET THE MATRIX AND SETUP THE RIGHT HAND SIDE.
+       ------------------------------------------------------------*/
+    get_matrix(matrix, &A0, &b0, &ldb, &xtrue, &ldx, &grid);
+    m_loc = ((NRformat_loc *) A0.Store)->m_loc;
+    if ( !(b = doubleMalloc_dist(ldb)) ) ABORT("Malloc fails for b[].");
+
+    if ( !iam && output && !(out = fopen(output, "a")) )
+	ABORT("Cannot open the output file.");
+    nthreads = superlu_num_threads();
+    options.PrintStat = NO;
+
+    for (rep = 0; rep < nreps; ++rep) {
+	copy_matrix(&A0, &A);
+	for (i = 0; i < m_loc; ++i) b[i] = b0[i];
+	options.Predict = predict && rep == 0 ? YES : NO;
+
+	dScalePermstructInit(A.nrow, A.ncol, &ScalePermstruct);
+	dLUstructInit(A.ncol, &LUstruct);
+	PStatInit(&stat);
+
+	MPI_Barrier(grid.comm);
+	t = SuperLU_timer_();
+	pdgssvx(&options, &A, &ScalePermstruct, b, ldb, 1, &grid,
+		&LUstruct, &SOLVEstruct, berr, &stat, &info);
+	t = SuperLU_timer_() - t;
+
+	/* Relative error of the solution in the max norm. */
+	for (i = 0, err = xnorm = 0.0; i < m_loc; ++i) {
+	    err = SUPERLU_MAX(err, fabs(b[i] - xtrue[i]));
+	    xnorm = SUPERLU_MAX(xnorm, fabs(b[i]));
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_DOUBLE, MPI_MAX, grid.comm);
+	MPI_Allreduce(MPI_IN_PLACE, &xnorm, 1, MPI_DOUBLE, MPI_MAX, grid.comm);
+
+	MPI_Reduce(&stat.ops[FACT], &ops, 1, MPI_FLOAT, MPI_SUM, 0, grid.comm);
+	fops = ops;
+	MPI_Reduce(&stat.ops[SOLVE], &ops, 1, MPI_FLOAT, MPI_SUM, 0, grid.comm);
+	sops = ops;
+	dQuerySpace_dist(A.ncol, &LUstruct, &grid, &stat, &mem);
+
+	if ( !iam ) {
+	    fprintf(out, "{\"matrix\": \"%s\", \"n\": %d, \"nprow\": %d, "
+		    "\"npcol\": %d, \"threads\": %d, \"rep\": %d, "
+		    "\"info\": %d, \"error\": %.6e, \"factor_flops\": %.6e, "
+		    "\"solve_flops\": %.6e, ", matrix, (int) A.ncol, nprow,
+		    npcol, nthreads, rep, info,
+		    xnorm > 0.0 ? err / xnorm : err, fops, sops);
+	}
+	print_minmax(out, "total_time", t, &grid, 0);
+	if ( !iam ) fprintf(out, "\"time\": {");
+	for (i = 0; i < nphases; ++i)
+	    print_minmax(out, phase_names[i], stat.utime[phases[i]], &grid,
+			 i == nphases - 1);
+	if ( !iam ) fprintf(out, "}, \"memory_mb\": {");
+	v = mem.for_lu * 1e-6;
+	print_minmax(out, "lu", v, &grid, 0);
+	v = mem.total * 1e-6;
+	print_minmax(out, "total", v, &grid, 1);
+	if ( !iam ) {
+	    fprintf(out, "}}\n");
+	    fflush(out);
+	}
+
+	PStatFree(&stat);
+	Destroy_CompRowLoc_Matrix_dist(&A);
+	dScalePermstructFree(&ScalePermstruct);
+	dDestroy_LU(A.ncol, &grid, &LUstruct);
+	dLUstructFree(&LUstruct);
+	if ( options.SolveInitialized ) {
+	    dSolveFinalize(&options, &SOLVEstruct);
+	    options.SolveInitialized = NO;
+	}
+    }
+
+    if ( !iam && out != stdout ) fclose(out);
+    Destroy_CompRowLoc_Matrix_dist(&A0);
+    SUPERLU_FREE(b0);
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(xtrue);
+
+    /* ------------------------------------------------------------
+       RELEASE THE SUPERLU PROCESS GRID.
+       ------------------------------------------------------------*/
+out:
+    superlu_gridexit(&grid);
+
+    /* ------------------------------------------------------------
+       TERMINATES THE MPI EXECUTION ENVIRONMENT.
+       ------------------------------------------------------------*/
+    MPI_Finalize();
+    return 0;
+}
@@ -104,9 +104,6 @@ int main(int argc, char *argv[])
 		        break;
 	    }
 	} else { /* Last arg is considered a filename */
-	    if ( !(fp = fopen(*cpp, "r")) ) {
-                ABORT("File does not exist");
-            }
 	    break;
 	}
     }
@@ -164,17 +161,22 @@ int main(int argc, char *argv[])
     CHECK_MALLOC(iam, "Enter main()");
 #endif
 
-    for(ii = 0;ii<strlen(*cpp);ii++){
-	if((*cpp)[ii]=='.'){
+    /* ------------------------------------------------------------
+       GENERATE THE MATRIX (see dcreate_matrix_gen.c), OR GET IT FROM
+       FILE, AND SETUP THE RIGHT HAND SIDE.
+       ------------------------------------------------------------*/
+    if ( dcreate_matrix_gen(&A, nrhs, &b, &ldb, &xtrue, &ldx, *cpp, &grid) ) {
+	if ( !(fp = fopen(*cpp, "r")) ) {
+	    ABORT("File does not exist");
+	}
+	for(ii = 0;ii<strlen(*cpp);ii++){
+	    if((*cpp)[ii]=='.'){
 		postfix = &((*cpp)[ii+1]);
+	    }
 	}
+	dcreate_matrix_postfix(&A, nrhs, &b, &ldb, &xtrue, &ldx, fp, postfix, &grid);
+	fclose(fp);
     }
-    // printf("%s\n", postfix);
-	
-    /* ------------------------------------------------------------
-       GET THE MATRIX FROM FILE AND SETUP THE RIGHT HAND SIDE. 
-       ------------------------------------------------------------*/
-    dcreate_matrix_postfix(&A, nrhs, &b, &ldb, &xtrue, &ldx, fp, postfix, &grid);
 
     if ( !(berr = doubleMalloc_dist(nrhs)) )
 	ABORT("Malloc fails for berr[].");
@@ -252,7 +254,6 @@ int main(int argc, char *argv[])
     SUPERLU_FREE(b);
     SUPERLU_FREE(xtrue);
     SUPERLU_FREE(berr);
-    fclose(fp);
 
     /* ------------------------------------------------------------
        RELEASE THE SUPERLU PROCESS GRID.
@@ -0,0 +1,447 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Persistent solver service spawned with MPI_Comm_spawn
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_ddefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * The driver program PDDRIVE_SERVER.
+ *
+ * Unlike PDDRIVE_SPAWN, which factors one matrix per spawned job, the
+ * spawned job here is a long-lived service: it keeps any number of
+ * factorizations, each known to the client by a handle, and serves
+ * factor, refactor and solve requests until it is told to quit, so that
+ * the job start-up, the grid set-up and the analysis are paid once.
+ *
+ * Run without a parent, the program is the client: process 0 spawns
+ * <proc rows> x <proc columns> copies of itself as the service, reads
+ * the matrix, and factors, solves, refactors with new values and solves
+ * again through the service, checking the solutions:
+ *    mpiexec -n 1 pddrive_server -r <proc rows> -c <proc columns>
+ *            [-s <nrhs>] big.rua
+ *
+ * Protocol, on the intercommunicator returned by MPI_Comm_spawn, with
+ * the client at rank 0 of its side and mpi_int_t for the integers:
+ *   - The client sends the request hdr[4] = {op, handle, n or nrhs, 0} to
+ *     server rank 0 with tag SRV_REQ.
+ *   - The data go directly between the user arrays of the client and
+ *     those handed to pdgssvx() by each server rank p, with tag SRV_DATA:
+ *     rank p owns the rows [fst_row, fst_row + m_loc) given by
+ *     srv_rows(n, nprocs, p), n being the order of the matrix.
+ *   - Server rank 0 answers every request but SRV_QUIT with
+ *     {handle, info} and tag SRV_REPLY, info being that of pdgssvx().
+ *
+ *   SRV_FACTOR   hdr = {SRV_FACTOR, -, n}. To each rank p, the client
+ *                sends the m_loc+1 entries of the global row pointer
+ *                from fst_row on, then the column indices and the values
+ *                of those rows (compressed row storage). The reply gives
+ *                the new handle, or -1 if the factorization failed.
+ *   SRV_REFACTOR hdr = {SRV_REFACTOR, handle}. To each rank p, the values
+ *                of its rows, in the order of SRV_FACTOR; the matrix is
+ *                factored with the kept permutations and structure
+ *                (Fact = SamePattern_SameRowPerm).
+ *   SRV_SOLVE    hdr = {SRV_SOLVE, handle, nrhs}. To each rank p, its
+ *                rows of B; each rank p then sends its rows of X back.
+ *                The client can send and receive the rows of B in place
+ *                with an MPI_Type_vector of nrhs blocks of m_loc.
+ *   SRV_FREE     hdr = {SRV_FREE, handle}. Free the factorization.
+ *   SRV_QUIT     End the service.
+ * </pre>
+ */
+
+#define SRV_REQ   0
+#define SRV_DATA  1
+#define SRV_REPLY 2
+
+#define SRV_FACTOR   1
+#define SRV_REFACTOR 2
+#define SRV_SOLVE    3
+#define SRV_FREE     4
+#define SRV_QUIT     5
+
+#define SRV_HANDLES  64 /* Factorizations kept at a time */
+
+/* A factorization of the service, with the pattern of its rows kept for
+   the refactorizations, as pdgssvx() overwrites A. */
+typedef struct {
+    int_t  n;             /* EMPTY if the slot is free */
+    int_t  m_loc, fst_row, nnz_loc;
+    int_t  *rowptr, *colind;
+    SuperMatrix A;
+    superlu_dist_options_t options;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    double *b;            /* m_loc x maxrhs */
+    int    maxrhs;
+} srv_handle_t;
+
+/* The rows [*fst_row, *fst_row + *m_loc) of rank p of nprocs. */
+static void
+srv_rows(int_t n, int nprocs, int p, int_t *fst_row, int_t *m_loc)
+{
+    *m_loc = n / nprocs + (p < n % nprocs);
+    *fst_row = (n / nprocs) * p + SUPERLU_MIN(p, n % nprocs);
+}
+
+/* Set up A of h from its kept pattern and the values nzval. */
+static void
+srv_matrix(srv_handle_t *h, double *nzval)
+{
+    int_t *rowptr = intMalloc_dist(h->m_loc + 1);
+    int_t *colind = intMalloc_dist(h->nnz_loc);
+    int_t i;
+
+    if ( !rowptr || !colind ) ABORT("Malloc fails for A.");
+    for (i = 0; i <= h->m_loc; ++i) rowptr[i] = h->rowptr[i];
+    for (i = 0; i < h->nnz_loc; ++i) colind[i] = h->colind[i];
+    dCreate_CompRowLoc_Matrix_dist(&h->A, h->n, h->n, h->nnz_loc, h->m_loc,
+				   h->fst_row, nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_D, SLU_GE);
+}
+
+static void
+srv_free(srv_handle_t *h, gridinfo_t *grid)
+{
+    if ( h->n == EMPTY ) return;
+    Destroy_CompRowLoc_Matrix_dist(&h->A);
+    dDestroy_LU(h->n, grid, &h->LUstruct);
+    dScalePermstructFree(&h->ScalePermstruct);
+    dLUstructFree(&h->LUstruct);
+    if ( h->options.SolveInitialized )
+	dSolveFinalize(&h->options, &h->SOLVEstruct);
+    SUPERLU_FREE(h->rowptr);
+    SUPERLU_FREE(h->colind);
+    if ( h->b ) SUPERLU_FREE(h->b);
+    h->n = EMPTY;
+}
+
+/* Factor A of h with options->Fact = fact; the factorization is dropped
+   if it fails. */
+static int
+srv_factor(srv_handle_t *h, fact_t fact, gridinfo_t *grid)
+{
+    SuperLUStat_t stat;
+    double berr;
+    int info;
+
+    h->options.Fact = fact;
+    PStatInit(&stat);
+    pdgssvx(&h->options, &h->A, &h->ScalePermstruct, NULL, h->m_loc, 0, grid,
+	    &h->LUstruct, &h->SOLVEstruct, &berr, &stat, &info);
+    PStatFree(&stat);
+    if ( info ) srv_free(h, grid);
+    return info;
+}
+
+/* The service: serve the requests of parent until SRV_QUIT. */
+static void
+srv_serve(MPI_Comm parent, gridinfo_t *grid)
+{
+    srv_handle_t *handles, *h;
+    SuperLUStat_t stat;
+    MPI_Status status;
+    double *nzval, *berr;
+    int_t  hdr[4], reply[2], i;
+    int    iam = grid->iam, nprocs = grid->nprow * grid->npcol, info;
+
+    if ( !(handles = SUPERLU_MALLOC(SRV_HANDLES * sizeof(srv_handle_t))) )
+	ABORT("Malloc fails for handles[].");
+    for (i = 0; i < SRV_HANDLES; ++i) handles[i].n = EMPTY;
+
+    for (;;) {
+	if ( !iam ) MPI_Recv(hdr, 4, mpi_int_t, 0, SRV_REQ, parent, &status);
+	MPI_Bcast(hdr, 4, mpi_int_t, 0, grid->comm);
+	if ( hdr[0] == SRV_QUIT ) break;
+
+	reply[0] = hdr[1];
+	info = 0;
+	h = ( hdr[1] >= 0 && hdr[1] < SRV_HANDLES ) ? &handles[hdr[1]] : NULL;
+	if ( hdr[0] != SRV_FACTOR && (!h || h->n == EMPTY) ) {
+	    /* Unknown handle: nothing is exchanged. */
+	    reply[0] = EMPTY;
+	    info = -1;
+	} else switch ( hdr[0] ) {
+	  case SRV_FACTOR:
+	    for (i = 0; i < SRV_HANDLES && handles[i].n != EMPTY; ++i) ;
+	    if ( i == SRV_HANDLES ) ABORT("Too many factorizations kept.");
+	    h = &handles[i];
+	    reply[0] = i;
+	    h->n = hdr[2];
+	    srv_rows(h->n, nprocs, iam, &h->fst_row, &h->m_loc);
+	    h->rowptr = intMalloc_dist(h->m_loc + 1);
+	    MPI_Recv(h->rowptr, h->m_loc + 1, mpi_int_t, 0, SRV_DATA, parent,
+		     &status);
+	    for (i = h->m_loc; i >= 0; --i) h->rowptr[i] -= h->rowptr[0];
+	    h->nnz_loc = h->rowptr[h->m_loc];
+	    h->colind = intMalloc_dist(SUPERLU_MAX(h->nnz_loc, 1));
+	    nzval = doubleMalloc_dist(SUPERLU_MAX(h->nnz_loc, 1));
+	    MPI_Recv(h->colind, h->nnz_loc, mpi_int_t, 0, SRV_DATA, parent,
+		     &status);
+	    MPI_Recv(nzval, h->nnz_loc, MPI_DOUBLE, 0, SRV_DATA, parent,
+		     &status);
+	    srv_matrix(h, nzval);
+	    set_default_options_dist(&h->options);
+	    h->options.PrintStat = NO;
+	    dScalePermstructInit(h->n, h->n, &h->ScalePermstruct);
+	    dLUstructInit(h->n, &h->LUstruct);
+	    h->b = NULL;
+	    h->maxrhs = 0;
+	    if ( (info = srv_factor(h, DOFACT, grid)) ) reply[0] = EMPTY;
+	    break;
+
+	  case SRV_REFACTOR:
+	    nzval = doubleMalloc_dist(SUPERLU_MAX(h->nnz_loc, 1));
+	    MPI_Recv(nzval, h->nnz_loc, MPI_DOUBLE, 0, SRV_DATA, parent,
+		     &status);
+	    Destroy_CompRowLoc_Matrix_dist(&h->A);
+	    srv_matrix(h, nzval);
+	    if ( (info = srv_factor(h, SamePattern_SameRowPerm, grid)) )
+		reply[0] = EMPTY;
+	    break;
+
+	  case SRV_SOLVE:
+	    if ( hdr[2] > h->maxrhs ) {
+		if ( h->b ) SUPERLU_FREE(h->b);
+		h->maxrhs = hdr[2];
+		h->b = doubleMalloc_dist(SUPERLU_MAX(h->m_loc * h->maxrhs, 1));
+	    }
+	    MPI_Recv(h->b, h->m_loc * hdr[2], MPI_DOUBLE, 0, SRV_DATA, parent,
+		     &status);
+	    berr = doubleMalloc_dist(SUPERLU_MAX(hdr[2], 1));
+	    h->options.Fact = FACTORED;
+	    PStatInit(&stat);
+	    pdgssvx(&h->options, &h->A, &h->ScalePermstruct, h->b, h->m_loc,
+		    hdr[2], grid, &h->LUstruct, &h->SOLVEstruct, berr, &stat,
+		    &info);
+	    PStatFree(&stat);
+	    SUPERLU_FREE(berr);
+	    MPI_Send(h->b, h->m_loc * hdr[2], MPI_DOUBLE, 0, SRV_DATA, parent);
+	    break;
+
+	  case SRV_FREE:
+	    srv_free(h, grid);
+	    break;
+
+	  default:
+	    reply[0] = EMPTY;
+	    info = -1;
+	}
+	reply[1] = info;
+	if ( !iam ) MPI_Send(reply, 2, mpi_int_t, 0, SRV_REPLY, parent);
+    }
+
+    for (i = 0; i < SRV_HANDLES; ++i) srv_free(&handles[i], grid);
+    SUPERLU_FREE(handles);
+}
+
+/* Client side of a request: send hdr, and the data of srv_serve(). */
+static int_t
+srv_request(MPI_Comm server, int_t op, int_t handle, SuperMatrix *A,
+	    double *nzval, double *B, int ldb, int nrhs, int_t *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    MPI_Datatype rows;
+    MPI_Status status;
+    int_t  hdr[4] = {op, handle, op == SRV_SOLVE ? nrhs : A->ncol, 0};
+    int_t  reply[2], *rowptr = Astore->rowptr, fst_row, m_loc;
+    int    nprocs, p;
+
+    MPI_Comm_remote_size(server, &nprocs);
+    MPI_Send(hdr, 4, mpi_int_t, 0, SRV_REQ, server);
+    for (p = 0; p < nprocs && op != SRV_QUIT && op != SRV_FREE; ++p) {
+	srv_rows(A->ncol, nprocs, p, &fst_row, &m_loc);
+	switch ( op ) {
+	  case SRV_FACTOR:
+	    MPI_Send(&rowptr[fst_row], m_loc + 1, mpi_int_t, p, SRV_DATA,
+		     server);
+	    MPI_Send(&((int_t *) Astore->colind)[rowptr[fst_row]],
+		     rowptr[fst_row + m_loc] - rowptr[fst_row], mpi_int_t, p,
+		     SRV_DATA, server);
+	    /* Fall through for the values. */
+	  case SRV_REFACTOR:
+	    MPI_Send(&nzval[rowptr[fst_row]],
+		     rowptr[fst_row + m_loc] - rowptr[fst_row], MPI_DOUBLE, p,
+		     SRV_DATA, server);
+	    break;
+	  case SRV_SOLVE:
+	    MPI_Type_vector(nrhs, m_loc, ldb, MPI_DOUBLE, &rows);
+	    MPI_Type_commit(&rows);
+	    MPI_Send(&B[fst_row], 1, rows, p, SRV_DATA, server);
+	    MPI_Type_free(&rows);
+	}
+    }
+    for (p = 0; p < nprocs && op == SRV_SOLVE; ++p) {
+	srv_rows(A->ncol, nprocs, p, &fst_row, &m_loc);
+	MPI_Type_vector(nrhs, m_loc, ldb, MPI_DOUBLE, &rows);
+	MPI_Type_commit(&rows);
+	MPI_Recv(&B[fst_row], 1, rows, p, SRV_DATA, server, &status);
+	MPI_Type_free(&rows);
+    }
+    if ( op == SRV_QUIT ) return EMPTY;
+    MPI_Recv(reply, 2, mpi_int_t, 0, SRV_REPLY, server, &status);
+    *info = reply[1];
+    return reply[0];
+}
+
+/* The largest relative error of the nrhs columns of x against xtrue. */
+static double
+srv_error(int_t n, int nrhs, double *x, int ldx, double *xtrue, double s)
+{
+    double err = 0.0, xnorm, d;
+    int_t i;
+    int j;
+
+    for (j = 0; j < nrhs; ++j) {
+	for (xnorm = d = 0.0, i = 0; i < n; ++i) {
+	    d = SUPERLU_MAX(d, fabs(x[i + j*ldx] - s * xtrue[i + j*ldx]));
+	    xnorm = SUPERLU_MAX(xnorm, fabs(s * xtrue[i + j*ldx]));
+	}
+	err = SUPERLU_MAX(err, d / xnorm);
+    }
+    return err;
+}
+
+int main(int argc, char *argv[])
+{
+    SuperMatrix A;
+    gridinfo_t grid;
+    MPI_Comm parent, server;
+    double *b, *b1, *xtrue, *nzval, t;
+    int_t  handle[2], info, i;
+    int    nprow = 1, npcol = 1, nrhs = 1, ldb, ldx, iam, k;
+    char   **cpp, c, *spawn_argv[5], rbuf[16], cbuf[16];
+    FILE   *fp = NULL;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_get_parent(&parent);
+
+    /* Parse command line argv[]. */
+    for (cpp = argv+1; *cpp; ++cpp) {
+	if ( **cpp == '-' ) {
+	    c = *(*cpp+1);
+	    ++cpp;
+	    switch (c) {
+	      case 'h':
+		  printf("Options:\n");
+		  printf("\t-r <int>: process rows    (default %4d)\n", nprow);
+		  printf("\t-c <int>: process columns (default %4d)\n", npcol);
+		  printf("\t-s <int>: number of right-hand sides (default %d)\n",
+			 nrhs);
+		  exit(0);
+		  break;
+	      case 'r': nprow = atoi(*cpp);
+		        break;
+	      case 'c': npcol = atoi(*cpp);
+		        break;
+	      case 's': nrhs = atoi(*cpp);
+		        break;
+	    }
+	} else { /* Last arg is considered a filename */
+	    if ( !(fp = fopen(*cpp, "r")) ) {
+                ABORT("File does not exist");
+            }
+	    break;
+	}
+    }
+
+    if ( parent != MPI_COMM_NULL ) {
+	/* The service, on its own MPI_COMM_WORLD. */
+	superlu_gridinit(MPI_COMM_WORLD, nprow, npcol, &grid);
+	if ( grid.iam < nprow * npcol ) srv_serve(parent, &grid);
+	superlu_gridexit(&grid);
+	MPI_Comm_disconnect(&parent);
+	MPI_Finalize();
+	return 0;
+    }
+
+    /* The client, on process 0 only. */
+    MPI_Comm_rank(MPI_COMM_WORLD, &iam);
+    if ( iam || !fp ) {
+	if ( !iam ) printf("Usage: pddrive_server -r <int> -c <int> <file>\n");
+	MPI_Finalize();
+	return 0;
+    }
+
+    snprintf(rbuf, sizeof(rbuf), "%d", nprow);
+    snprintf(cbuf, sizeof(cbuf), "%d", npcol);
+    spawn_argv[0] = "-r"; spawn_argv[1] = rbuf;
+    spawn_argv[2] = "-c"; spawn_argv[3] = cbuf;
+    spawn_argv[4] = NULL;
+    t = SuperLU_timer_();
+    MPI_Comm_spawn(argv[0], spawn_argv, nprow * npcol, MPI_INFO_NULL, 0,
+		   MPI_COMM_SELF, &server, MPI_ERRCODES_IGNORE);
+    printf("Service of %d x %d processes spawned in %.3f s\n", nprow, npcol,
+	   SuperLU_timer_() - t);
+
+    /* The whole matrix, in compressed row storage. */
+    superlu_gridinit(MPI_COMM_SELF, 1, 1, &grid);
+    dcreate_matrix(&A, nrhs, &b, &ldb, &xtrue, &ldx, fp, &grid);
+    fclose(fp);
+    nzval = (double *) ((NRformat_loc *) A.Store)->nzval;
+    b1 = doubleMalloc_dist(ldb * nrhs);
+    for (i = 0; i < ldb * nrhs; ++i) b1[i] = b[i];
+
+    /* Two factorizations of A kept at once. */
+    for (k = 0; k < 2; ++k) {
+	t = SuperLU_timer_();
+	handle[k] = srv_request(server, SRV_FACTOR, EMPTY, &A, nzval, NULL, 0,
+				0, &info);
+	printf("Factor     handle %d  info %d  %8.3f s\n", (int) handle[k],
+	       (int) info, SuperLU_timer_() - t);
+    }
+
+    t = SuperLU_timer_();
+    srv_request(server, SRV_SOLVE, handle[0], &A, NULL, b, ldb, nrhs, &info);
+    printf("Solve      handle %d  info %d  %8.3f s  error %e\n",
+	   (int) handle[0], (int) info, SuperLU_timer_() - t,
+	   srv_error(A.ncol, nrhs, b, ldb, xtrue, 1.0));
+
+    /* A/2 with the same pattern: the solution doubles. */
+    for (i = 0; i < ((NRformat_loc *) A.Store)->nnz_loc; ++i) nzval[i] *= 0.5;
+    t = SuperLU_timer_();
+    srv_request(server, SRV_REFACTOR, handle[1], &A, nzval, NULL, 0, 0, &info);
+    printf("Refactor   handle %d  info %d  %8.3f s\n", (int) handle[1],
+	   (int) info, SuperLU_timer_() - t);
+    t = SuperLU_timer_();
+    srv_request(server, SRV_SOLVE, handle[1], &A, NULL, b1, ldb, nrhs, &info);
+    printf("Solve      handle %d  info %d  %8.3f s  error %e\n",
+	   (int) handle[1], (int) info, SuperLU_timer_() - t,
+	   srv_error(A.ncol, nrhs, b1, ldb, xtrue, 2.0));
+
+    for (k = 0; k < 2; ++k)
+	srv_request(server, SRV_FREE, handle[k], &A, NULL, NULL, 0, 0, &info);
+    srv_request(server, SRV_QUIT, EMPTY, &A, NULL, NULL, 0, 0, &info);
+    MPI_Comm_disconnect(&server);
+
+    Destroy_CompRowLoc_Matrix_dist(&A);
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(b1);
+    SUPERLU_FREE(xtrue);
+    superlu_gridexit(&grid);
+    MPI_Finalize();
+    return 0;
+}
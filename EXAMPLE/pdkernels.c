@@ -0,0 +1,367 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Microbenchmarks of the kernels of the factorization and the solve
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <math.h>
+#include <string.h>
+#include "superlu_ddefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * The driver program PDKERNELS.
+ *
+ * PDKERNELS times the internal kernels of PDGSTRF and PDGSTRS on their
+ * own, on synthetic supernodes of width s (each size given by -s), and
+ * writes one line of JSON per kernel and size:
+ *    scatter_l  dscatter_l() of an L block of 4s rows and s columns, into
+ *               a destination with the same rows ("path": "dense") or
+ *               twice as many ("indirect"); reports GB/s,
+ *    scatter_u  dscatter_u() of the same block into a U block, with
+ *               consecutive rows or every other row; reports GB/s,
+ *    panel      pdgstrf2_trsm() on a block column L(:,k) of 4s rows and
+ *               s columns, the diagonal block factored and the rest
+ *               solved with it; GFLOP/s,
+ *    trsm_u     pdgstrs2_omp() on a block row U(k,:) of 8 blocks of
+ *               s columns; GFLOP/s,
+ *    bcast      TreeBcast_slu forwarding of s doubles from process 0 to
+ *               all the others, as in the solve; messages/s and GB/s.
+ * The local kernels run on process 0 only; bcast needs 2 processes or
+ * more, and counts the messages received by all the processes.
+ *
+ * Usage:
+ *    mpiexec -n <np> pdkernels [-k <kernel>] [-s <s1,s2,..>]
+ *            [-n <repetitions>] [-o <output file>]
+ * The target superlu_kernels runs it with the default sizes.
+ * </pre>
+ */
+
+#define KERNEL_SIZES "8,16,32,64,128,256"
+#define TRSM_BLOCKS  8
+
+/* Uniform in [-1, 1); the matrices need no particular property. */
+static double rnd(void) { return 2.0 * rand() / ((double) RAND_MAX + 1) - 1.0; }
+
+static void
+print_result(FILE *out, const char *kernel, const char *fields, double rate,
+	     const char *unit, double t, int nreps)
+{
+    fprintf(out, "{\"kernel\": \"%s\", %s, \"reps\": %d, \"time\": %.6e, "
+	    "\"%s\": %.6e}\n", kernel, fields, nreps, t / nreps, unit, rate);
+    fflush(out);
+}
+
+/* Supernodes 0 (size s, the pivot block k), 1 (size 2m, the block of the
+   rows) and 2 (size s, the block of the columns). */
+static void
+set_xsup(int_t *xsup, int_t s, int_t m)
+{
+    xsup[0] = 0;
+    xsup[1] = s;
+    xsup[2] = s + 2 * m;
+    xsup[3] = 2 * s + 2 * m;
+}
+
+static void
+bench_scatter(FILE *out, int_t s, int nreps, gridinfo_t *grid)
+{
+    int_t m = 4 * s, xsup[4], i, j;
+    int_t lsub[4 * 256], usub[256], *Lindex, *Uindex, *Uptr[2];
+    double *tempv, *Lval, *Uval, *Uvptr[2], t, bytes;
+    int *indirect, *indirect2, rep, path;
+    char fields[128];
+
+    set_xsup(xsup, s, m);
+    Lindex = intMalloc_dist(BC_HEADER + LB_DESCRIPTOR + 2 * m);
+    Uindex = intMalloc_dist(BR_HEADER + UB_DESCRIPTOR + s);
+    tempv = doubleMalloc_dist(m * s);
+    Lval = doubleMalloc_dist(2 * m * s);
+    Uval = doubleMalloc_dist(2 * m * s);
+    indirect = SUPERLU_MALLOC(2 * m * sizeof(int));
+    indirect2 = SUPERLU_MALLOC(m * sizeof(int));
+    if ( !Lindex || !Uindex || !tempv || !Lval || !Uval || !indirect
+	 || !indirect2 )
+	ABORT("Malloc fails for the scatter.");
+    Uptr[0] = NULL; /* U(1,2) is in the local block row 1 */
+    Uptr[1] = Uindex;
+    Uvptr[0] = NULL;
+    Uvptr[1] = Uval;
+    for (i = 0; i < m * s; ++i) tempv[i] = rnd();
+    for (i = 0; i < 2 * m * s; ++i) Lval[i] = Uval[i] = rnd();
+    for (j = 0; j < s; ++j) usub[j] = 0; /* full segments, klst = s */
+
+    for (path = 0; path < 2; ++path) { /* dense, then indirect */
+	/* Rows of the source block, in supernode 1. */
+	for (i = 0; i < m; ++i) lsub[i] = xsup[1] + (path ? 2 * i : i);
+
+	/* Destination L(1,2): the same rows, or all the 2m rows. */
+	Lindex[0] = 1;
+	Lindex[1] = path ? 2 * m : m;
+	Lindex[BC_HEADER] = 1;
+	Lindex[BC_HEADER + 1] = Lindex[1];
+	for (i = 0; i < Lindex[1]; ++i)
+	    Lindex[BC_HEADER + LB_DESCRIPTOR + i] = xsup[1] + i;
+	t = SuperLU_timer_();
+	for (rep = 0; rep < nreps; ++rep)
+	    dscatter_l(1, 0, s, 0, xsup, s, m, 0, m, usub, lsub, tempv,
+		       indirect, indirect2, &Lindex, &Lval, grid);
+	t = SuperLU_timer_() - t;
+	bytes = 3.0 * sizeof(double) * m * s * nreps;
+	sprintf(fields, "\"path\": \"%s\", \"rows\": %d, \"cols\": %d",
+		path ? "indirect" : "dense", (int) m, (int) s);
+	print_result(out, "scatter_l", fields, bytes / t * 1e-9, "gbytes_s",
+		     t, nreps);
+
+	/* Destination U(1,2), full segments of 2m rows. */
+	Uindex[0] = 1;
+	Uindex[1] = UB_DESCRIPTOR + s;
+	Uindex[2] = 2 * m * s;
+	Uindex[BR_HEADER] = 2;
+	Uindex[BR_HEADER + 1] = 2 * m * s;
+	for (j = 0; j < s; ++j) Uindex[BR_HEADER + UB_DESCRIPTOR + j] = xsup[1];
+	t = SuperLU_timer_();
+	for (rep = 0; rep < nreps; ++rep)
+	    dscatter_u(1, 2, s, 0, xsup, s, m, 0, m, lsub, usub, tempv,
+		       Uptr, Uvptr, grid);
+	t = SuperLU_timer_() - t;
+	bytes = 3.0 * sizeof(double) * m * s * nreps;
+	print_result(out, "scatter_u", fields, bytes / t * 1e-9, "gbytes_s",
+		     t, nreps);
+    }
+
+    SUPERLU_FREE(Lindex);
+    SUPERLU_FREE(Uindex);
+    SUPERLU_FREE(tempv);
+    SUPERLU_FREE(Lval);
+    SUPERLU_FREE(Uval);
+    SUPERLU_FREE(indirect);
+    SUPERLU_FREE(indirect2);
+}
+
+/* The diagonal block is made diagonally dominant, so that neither kernel
+   needs pivoting and repeated calls stay bounded. */
+static void
+bench_panel_trsm(FILE *out, int_t s, int nreps, gridinfo_t *grid)
+{
+    superlu_dist_options_t options;
+    SuperLUStat_t stat;
+    Glu_persist_t Glu_persist;
+    dLocalLU_t Llu;
+    superlu_arena_t arena;
+    int_t xsup[TRSM_BLOCKS + 2], Lindex[BC_HEADER], *Uindex, *Lindex_p;
+    int_t i, j, b, nsupr = 4 * s, nu = TRSM_BLOCKS * s * s;
+    double *lusup, *lusup0, *uval, *uval0, t, t1, ops;
+    int rep, info = 0;
+    char fields[128];
+
+    for (i = 0; i <= TRSM_BLOCKS + 1; ++i) xsup[i] = i * s;
+    Glu_persist.xsup = xsup;
+    memset(&Llu, 0, sizeof(Llu));
+    set_default_options_dist(&options);
+    PStatInit(&stat);
+
+    lusup = doubleMalloc_dist(nsupr * s);
+    lusup0 = doubleMalloc_dist(nsupr * s);
+    Llu.ujrow = doubleMalloc_dist(s * s);
+    uval = doubleMalloc_dist(nu);
+    uval0 = doubleMalloc_dist(nu);
+    Uindex = intMalloc_dist(BR_HEADER + TRSM_BLOCKS * (UB_DESCRIPTOR + s));
+    if ( !lusup || !lusup0 || !Llu.ujrow || !uval || !uval0 || !Uindex )
+	ABORT("Malloc fails for the panel.");
+    for (j = 0; j < s; ++j)
+	for (i = 0; i < nsupr; ++i)
+	    lusup0[i + j * nsupr] = i == j ? s + 1.0 : rnd();
+    for (i = 0; i < nu; ++i) uval0[i] = rnd();
+
+    Lindex[0] = 1;
+    Lindex[1] = nsupr;
+    Lindex_p = Lindex;
+    Llu.Lrowind_bc_ptr = &Lindex_p;
+    Llu.Lnzval_bc_ptr = &lusup;
+
+    /* Panel: pdgstrf2_trsm() overwrites L(:,k), copied back each time. */
+    t = 0.0;
+    ops = stat.ops[FACT];
+    for (rep = 0; rep < nreps; ++rep) {
+	memcpy(lusup, lusup0, nsupr * s * sizeof(double));
+	t1 = SuperLU_timer_();
+	pdgstrf2_trsm(&options, 0, 0, 0.0, &Glu_persist, grid, &Llu, NULL, 0,
+		      &stat, &info);
+	t += SuperLU_timer_() - t1;
+    }
+    ops = stat.ops[FACT] - ops;
+    sprintf(fields, "\"rows\": %d, \"cols\": %d", (int) nsupr, (int) s);
+    print_result(out, "panel", fields, ops / t * 1e-9, "gflops", t, nreps);
+
+    /* Block row U(0,1:TRSM_BLOCKS), full segments, with the factored L. */
+    Uindex[0] = TRSM_BLOCKS;
+    Uindex[1] = BR_HEADER + TRSM_BLOCKS * (UB_DESCRIPTOR + s);
+    Uindex[2] = nu;
+    for (b = 0, i = BR_HEADER; b < TRSM_BLOCKS; ++b) {
+	Uindex[i++] = b + 1;
+	Uindex[i++] = s * s;
+	for (j = 0; j < s; ++j) Uindex[i++] = 0;
+    }
+    Llu.Ufstnz_br_ptr = &Uindex;
+    Llu.Unzval_br_ptr = &uval;
+    superlu_arena_init(&arena, superlu_arena_bytes(3 * TRSM_BLOCKS
+						   * sizeof(int)));
+    t = 0.0;
+    for (rep = 0; rep < nreps; ++rep) {
+	memcpy(uval, uval0, nu * sizeof(double));
+	t1 = SuperLU_timer_();
+	pdgstrs2_omp(0, 0, &Glu_persist, grid, &Llu, NULL, &arena, &stat);
+	t += SuperLU_timer_() - t1;
+    }
+    /* As counted by the kernel, from its threads. */
+    ops = (double) nreps * TRSM_BLOCKS * s * s * (s + 1);
+    sprintf(fields, "\"nsupc\": %d, \"blocks\": %d", (int) s, TRSM_BLOCKS);
+    print_result(out, "trsm_u", fields, ops / t * 1e-9, "gflops", t, nreps);
+
+    superlu_arena_destroy(&arena);
+    PStatFree(&stat);
+    SUPERLU_FREE(lusup);
+    SUPERLU_FREE(lusup0);
+    SUPERLU_FREE(Llu.ujrow);
+    SUPERLU_FREE(uval);
+    SUPERLU_FREE(uval0);
+    SUPERLU_FREE(Uindex);
+}
+
+/* Process 0 sends s doubles down the tree nreps times; the others receive
+   each message and forward it, as the solve does. */
+static void
+bench_bcast(FILE *out, int_t s, int nreps, MPI_Comm comm)
+{
+    int nprocs, iam, i, rep, *ranks;
+    double *buf, t;
+    BcTree tree;
+    MPI_Status status;
+    char fields[128];
+
+    MPI_Comm_size(comm, &nprocs);
+    MPI_Comm_rank(comm, &iam);
+    if ( nprocs < 2 ) return;
+    buf = doubleMalloc_dist(s);
+    ranks = SUPERLU_MALLOC(nprocs * sizeof(int));
+    if ( !buf || !ranks ) ABORT("Malloc fails for the broadcast.");
+    for (i = 0; i < nprocs; ++i) ranks[i] = i;
+    for (i = 0; i < s; ++i) buf[i] = 1.0;
+
+    tree = BcTree_Create(comm, ranks, nprocs, s, 0.5, 'd');
+    BcTree_SetTag(tree, BC_L, 'd');
+    BcTree_allocateRequest(tree, 'd');
+
+    MPI_Barrier(comm);
+    t = SuperLU_timer_();
+    for (rep = 0; rep < nreps; ++rep) {
+	if ( iam )
+	    MPI_Recv(buf, s, MPI_DOUBLE, MPI_ANY_SOURCE, BC_L, comm, &status);
+	BcTree_forwardMessageSimple(tree, buf, s, 'd');
+	BcTree_waitSendRequest(tree, 'd');
+    }
+    t = SuperLU_timer_() - t;
+    MPI_Allreduce(MPI_IN_PLACE, &t, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+    if ( !iam ) {
+	double msgs = (double) nreps * (nprocs - 1) / t;
+	sprintf(fields, "\"procs\": %d, \"msg_bytes\": %d, \"msgs_s\": %.6e",
+		nprocs, (int) (s * sizeof(double)), msgs);
+	print_result(out, "bcast", fields, msgs * s * sizeof(double) * 1e-9,
+		     "gbytes_s", t, nreps);
+    }
+    BcTree_Destroy(tree, 'd');
+    SUPERLU_FREE(buf);
+    SUPERLU_FREE(ranks);
+}
+
+int main(int argc, char *argv[])
+{
+    gridinfo_t grid;
+    int      iam, nreps = 100, omp_mpi_level;
+    int_t    s;
+    char     **cpp, c, *kernel = "all", *sizes = KERNEL_SIZES, *output = NULL;
+    char     *p;
+    FILE     *out = stdout;
+
+    MPI_Init_thread( &argc, &argv, MPI_THREAD_MULTIPLE, &omp_mpi_level);
+    MPI_Comm_rank(MPI_COMM_WORLD, &iam);
+
+    /* Parse command line argv[]. */
+    for (cpp = argv+1; *cpp; ++cpp) {
+	if ( **cpp == '-' ) {
+	    c = *(*cpp+1);
+	    ++cpp;
+	    switch (c) {
+	      case 'h':
+		  printf("Options:\n");
+		  printf("\t-k <kernel>: scatter, panel, trsm, bcast or all"
+			 " (default %s)\n", kernel);
+		  printf("\t-s <s1,s2,..>: supernode sizes (default %s)\n",
+			 sizes);
+		  printf("\t-n <int>: repetitions (default %d)\n", nreps);
+		  printf("\t-o <file>: append the JSON lines to file\n");
+		  exit(0);
+		  break;
+	      case 'k': kernel = *cpp;
+		        break;
+	      case 's': sizes = *cpp;
+		        break;
+	      case 'n': nreps = atoi(*cpp);
+		        break;
+	      case 'o': output = *cpp;
+		        break;
+	    }
+	}
+    }
+    if ( !iam && output && !(out = fopen(output, "a")) )
+	ABORT("Cannot open the output file.");
+
+    /* The local kernels see a 1 x 1 grid of their own. */
+    superlu_gridinit(MPI_COMM_SELF, 1, 1, &grid);
+    srand(1);
+
+    for (p = sizes; *p; ) {
+	char *q = p;
+	s = strtol(q, &p, 10);
+	if ( p == q ) break;
+	if ( *p == ',' ) ++p;
+	if ( s < 1 || s > 256 ) {
+	    if ( !iam ) fprintf(stderr, "Size %d skipped, not in [1, 256].\n",
+				(int) s);
+	    continue;
+	}
+	if ( !iam && (!strcmp(kernel, "all") || !strcmp(kernel, "scatter")) )
+	    bench_scatter(out, s, nreps, &grid);
+	if ( !iam && (!strcmp(kernel, "all") || !strcmp(kernel, "panel")
+		      || !strcmp(kernel, "trsm")) )
+	    bench_panel_trsm(out, s, nreps, &grid);
+	if ( !strcmp(kernel, "all") || !strcmp(kernel, "bcast") )
+	    bench_bcast(out, s, nreps, MPI_COMM_WORLD);
+    }
+
+    if ( !iam && out != stdout ) fclose(out);
+    superlu_gridexit(&grid);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,259 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Generate a test matrix directly in distributed form
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "superlu_sdefs.h"
+
+/* Kinds of generated matrices. */
+enum {GEN_LAP, GEN_CD, GEN_ELAST, GEN_RAND};
+
+/* Hash of a 64-bit integer (splitmix64), random but reproducible. */
+static uint64_t gen_hash(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/* Value in [-1, 1) for the entry (row, col) of the random matrix. */
+static float gen_value(int_t row, int_t col)
+{
+    uint64_t h = gen_hash(((uint64_t) row << 32) ^ (uint64_t) col);
+    return (float) (h >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+/* Block column j of block row I of the random matrix, j = 0 for the
+   diagonal block. */
+static int_t gen_block_col(int_t I, int j, int_t nb)
+{
+    return j ? (int_t) (gen_hash(((uint64_t) I << 16) + j) % nb) : I;
+}
+
+/* \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * SCREATE_MATRIX_GEN generates a test matrix in the distributed compressed
+ * row format, each process computing only the rows it owns, so that its
+ * size is not bounded by a file or by the memory of one process, e.g. to
+ * measure weak scaling. The rows are split evenly among the processes, in
+ * order. The true solution is the vector of all ones, in each column, and
+ * the right-hand side is A times it. SPEC is one of
+ *
+ *   lap2d:<k>       5-point Laplacian on a k x k grid,
+ *   lap3d:<k>       7-point Laplacian on a k x k x k grid,
+ *   cd2d:<k>[,<pe>] convection-diffusion on a k x k grid, with upwind
+ *                   differences and the Peclet number pe (default 100);
+ *                   nonsymmetric,
+ *   cd3d:<k>[,<pe>] the same on a k x k x k grid,
+ *   elast2d:<k>     vector PDE with 2 coupled unknowns per point of a
+ *                   k x k grid, stiffer along the direction of the unknown,
+ *                   like linear elasticity; symmetric,
+ *   elast3d:<k>     the same with 3 unknowns per point of a k x k x k grid,
+ *   rand:<nb>[,<bs>[,<nblk>]]
+ *                   nb x nb blocks of bs x bs (default 8), with up to nblk
+ *                   (default 6) dense blocks at random positions besides
+ *                   the diagonal in each block row; nonsymmetric, the
+ *                   diagonal making it strictly diagonally dominant.
+ *
+ * The matrices of the grids are irreducibly diagonally dominant, hence
+ * nonsingular.
+ *
+ * Arguments
+ * =========
+ *
+ * A     (output) SuperMatrix*
+ *       Local matrix A in NR_loc format.
+ *
+ * NRHS  (input) int
+ *       Number of right-hand sides.
+ *
+ * RHS   (output) float**
+ *       The right-hand side matrix.
+ *
+ * LDB   (output) int*
+ *       Leading dimension of the right-hand side matrix.
+ *
+ * X     (output) float**
+ *       The true solution matrix.
+ *
+ * LDX   (output) int*
+ *       The leading dimension of the true solution matrix.
+ *
+ * SPEC  (input) char*
+ *       The matrix to generate, see above.
+ *
+ * GRID  (input) gridinfo_t*
+ *       The 2D process mesh.
+ *
+ * Return value
+ * ============
+ *
+ * 0, or -1 if SPEC is not one of the above, e.g. a file name, in which
+ * case nothing is allocated.
+ * </pre>
+ */
+
+int screate_matrix_gen(SuperMatrix *A, int nrhs, float **rhs,
+		       int *ldb, float **x, int *ldx,
+		       char *spec, gridinfo_t *grid)
+{
+    static const struct { const char *name; int kind, dim; } kinds[] = {
+	{"lap2d", GEN_LAP, 2}, {"lap3d", GEN_LAP, 3},
+	{"cd2d", GEN_CD, 2}, {"cd3d", GEN_CD, 3},
+	{"elast2d", GEN_ELAST, 2}, {"elast3d", GEN_ELAST, 3},
+	{"rand", GEN_RAND, 0}};
+    int nprocs = grid->nprow * grid->npcol;
+    int kind = -1, dim = 0, ncomp = 1, nblk = 6, bs = 8, nb, i, j, d, c, cc;
+    char *colon = strchr(spec, ':'), *p;
+    long long k, nn;
+    int_t n, m_loc, fst_row, nnz_loc, maxrow, row, pt, q, stride, col, I;
+    int_t bcols[64];
+    int_t *rowptr, *colind;
+    float *nzval, *b, *xtrue, pe = 100.0, beta = 0.0, v, sum;
+
+    if ( !colon ) return -1;
+    for (i = 0; i < (int) (sizeof(kinds) / sizeof(kinds[0])); ++i)
+	if ( (long) strlen(kinds[i].name) == (long) (colon - spec)
+	     && !strncmp(spec, kinds[i].name, colon - spec) ) {
+	    kind = kinds[i].kind;
+	    dim = kinds[i].dim;
+	}
+    if ( kind < 0 ) return -1;
+
+    k = strtoll(colon + 1, &p, 10);
+    if ( k < 1 ) ABORT("Invalid size of the generated matrix.");
+    if ( kind == GEN_CD && *p == ',' ) pe = strtod(p + 1, &p);
+    if ( kind == GEN_RAND && *p == ',' ) {
+	bs = strtol(p + 1, &p, 10);
+	if ( *p == ',' ) nblk = strtol(p + 1, &p, 10);
+	if ( bs < 1 || nblk < 0 || nblk > 63 )
+	    ABORT("Invalid blocks of the generated matrix.");
+    }
+
+    if ( kind == GEN_RAND ) {
+	nn = k * bs;
+	maxrow = (nblk + 1) * bs;
+    } else {
+	if ( kind == GEN_ELAST ) ncomp = dim;
+	nn = (dim == 2 ? k * k : k * k * k) * ncomp;
+	maxrow = (2 * dim + 1) * ncomp;
+	beta = pe / (k + 1); /* Peclet number of a cell */
+    }
+    n = (int_t) nn;
+    if ( n != nn ) ABORT("The generated matrix is too large for int_t.");
+
+    m_loc = n / nprocs;
+    fst_row = m_loc * grid->iam + SUPERLU_MIN(grid->iam, n % nprocs);
+    if ( grid->iam < n % nprocs ) ++m_loc;
+
+    rowptr = intMalloc_dist(m_loc + 1);
+    colind = intMalloc_dist(maxrow * m_loc);
+    nzval = floatMalloc_dist(maxrow * m_loc);
+    b = floatMalloc_dist(m_loc * nrhs);
+    xtrue = floatMalloc_dist(m_loc * nrhs);
+    if ( !rowptr || !colind || !nzval || !b || !xtrue )
+	ABORT("Malloc fails for the generated matrix.");
+
+    nnz_loc = 0;
+    for (i = 0; i < m_loc; ++i) {
+	row = fst_row + i;
+	rowptr[i] = nnz_loc;
+	if ( kind == GEN_RAND ) {
+	    /* Sorted, distinct block columns of the block row. */
+	    nb = 0;
+	    I = row / bs;
+	    for (j = 0; j <= nblk; ++j) {
+		col = gen_block_col(I, j, (int_t) k);
+		for (c = nb; c > 0 && bcols[c-1] > col; --c)
+		    bcols[c] = bcols[c-1];
+		if ( c == 0 || bcols[c-1] != col ) {
+		    bcols[c] = col;
+		    ++nb;
+		} else { /* duplicate: undo the shift */
+		    for (; c < nb; ++c) bcols[c] = bcols[c+1];
+		}
+	    }
+	    sum = 0.0;
+	    for (j = 0; j < nb; ++j)
+		for (c = 0; c < bs; ++c) {
+		    col = bcols[j] * bs + c;
+		    colind[nnz_loc] = col;
+		    if ( col != row ) {
+			nzval[nnz_loc] = gen_value(row, col);
+			sum += fabs(nzval[nnz_loc]);
+		    }
+		    ++nnz_loc;
+		}
+	    for (j = rowptr[i]; j < nnz_loc; ++j)
+		if ( colind[j] == row ) nzval[j] = sum + 1.0;
+	} else {
+	    /* Neighbours in increasing column order: -z, -y, -x, self, +x,
+	       ..., each with its ncomp unknowns. */
+	    pt = row / ncomp;
+	    c = row % ncomp;
+	    for (d = -dim; d <= dim; ++d) {
+		stride = abs(d) == 1 ? 1 : (abs(d) == 2 ? k : k * k);
+		if ( d < 0 ) {
+		    if ( (pt / stride) % k == 0 ) continue;
+		    q = pt - stride;
+		} else if ( d > 0 ) {
+		    if ( (pt / stride) % k == k - 1 ) continue;
+		    q = pt + stride;
+		} else q = pt;
+		for (cc = 0; cc < ncomp; ++cc) {
+		    if ( d == 0 ) {
+			if ( cc != c ) continue;
+			if ( kind == GEN_LAP ) v = 2.0 * dim;
+			else if ( kind == GEN_CD ) v = 2.0 * dim + dim * beta;
+			else v = 2.0 * (dim + 1) + 0.5 * dim * (dim - 1);
+		    } else if ( kind == GEN_ELAST ) {
+			/* Direction abs(d)-1 is stiffer for unknown c. */
+			v = cc != c ? -0.25 : (abs(d) - 1 == c ? -2.0 : -1.0);
+		    } else {
+			v = kind == GEN_CD && d < 0 ? -1.0 - beta : -1.0;
+		    }
+		    colind[nnz_loc] = q * ncomp + cc;
+		    nzval[nnz_loc++] = v;
+		}
+	    }
+	}
+	for (j = rowptr[i], sum = 0.0; j < nnz_loc; ++j) sum += nzval[j];
+	for (j = 0; j < nrhs; ++j) {
+	    b[i + j * m_loc] = sum;
+	    xtrue[i + j * m_loc] = 1.0;
+	}
+    }
+    rowptr[m_loc] = nnz_loc;
+
+    sCreate_CompRowLoc_Matrix_dist(A, n, n, nnz_loc, m_loc, fst_row,
+				   nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_S, SLU_GE);
+    *rhs = b;
+    *ldb = m_loc;
+    *x = xtrue;
+    *ldx = m_loc;
+    return 0;
+}
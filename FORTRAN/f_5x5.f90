@@ -10,7 +10,9 @@
 ! =======
 !
 ! This example illustrates how to use F_PDGSSVX with the full
-! (default) options to solve a linear system.
+! (default) options to solve a linear system, then F_PDGSREFACTOR and
+! F_PDGSSVX_SOLVE to factor new values of the matrix and solve several
+! right-hand sides in place, reusing the handles and the Fortran arrays.
 ! The input matrix is a small 5x5 example appeared in SuperLU Users' Guide,,
 ! Section 2.2:
 !
@@ -40,8 +42,9 @@
       parameter ( maxn = 10, maxnz = 100, maxnrhs = 10 )
       integer colind(maxnz), rowptr(maxn+1)
       real*8  nzval(maxnz), b(maxn), berr(maxnrhs)
+      real*8  nzval2(maxnz), b2(maxn,2)
       integer n, m, nnz, nrhs, ldb, nprow, npcol, init
-      integer*4 iam, info, i, ierr, ldb4
+      integer*4 iam, info, i, j, ierr, ldb4, ldb2
       integer nnz_loc, m_loc, fst_row
       real*8  s, u, p, e, r, l
 
@@ -156,6 +159,11 @@
          write(*,*) ' Matrix A was set up'
       endif
 
+! The new values refactored below: twice those of A
+      do i = 1, nnz_loc
+         nzval2(i) = 2.0 * nzval(i)
+      enddo
+
 ! Create the distributed compressed row matrix pointed to by the F90 handle A
       call f_dCreate_CompRowLoc_Mat_dist(A, m, n, nnz_loc, m_loc, fst_row, &
            nzval, colind, rowptr, SLU_NR_loc, SLU_D, SLU_GE)
@@ -175,6 +183,9 @@
       call set_superlu_options(options,ColPerm=NATURAL)
       call set_superlu_options(options,RowPerm=NOROWPERM)
 
+! Keep what f_pdgsrefactor needs
+      call f_set_RefactorMap(options, YES)
+
 ! Initialize ScalePermstruct and LUstruct
       call get_SuperMatrix(A,nrow=m,ncol=n)
       call f_ScalePermstructInit(m, n, ScalePermstruct)
@@ -193,6 +204,30 @@
          write(*,*) 'INFO from f_pdgssvx = ', info
       endif
 
+! Factor the new values in nzval2 with the same pattern, then solve for
+! two right-hand sides overwritten by the solution in b2; the solution
+! of 2*A*x = 1 is half the one above.
+      call f_pdgsrefactor(options, A, nzval2, ScalePermstruct, grid, &
+                          LUstruct, SOLVEstruct, stat, info)
+      do j = 1, 2
+         do i = 1, ldb
+            b2(i,j) = j
+         enddo
+      enddo
+      nrhs = 2
+      ldb2 = maxn
+      if (info == 0) then
+         call f_pdgssvx_solve(options, A, ScalePermstruct, b2, ldb2, nrhs, &
+                              grid, LUstruct, SOLVEstruct, berr, stat, info)
+      endif
+
+      if (info == 0 .and. iam == 1) then
+         write (*,*) 'Refactored, backward error: ', (berr(i), i = 1, nrhs)
+         write (*,*) 'x(1)/b(1): ', b2(1,1) / b(1), b2(1,2) / b(1)
+      else if (info /= 0) then
+         write(*,*) 'INFO from f_pdgsrefactor/f_pdgssvx_solve = ', info
+      endif
+
 ! Deallocate the storage allocated by SuperLU_DIST
       call f_PStatFree(stat)
       call f_Destroy_SuperMat_Store_dist(A)
@@ -202,6 +202,11 @@ void f_set_superlu_options(fptr *opt, int *Fact, int *Equil, int *ParSymbFact,
    ((superlu_dist_options_t *) *opt)->PrintStat = (yes_no_t) *PrintStat;
 }
 
+void f_set_RefactorMap(fptr *opt, int *RefactorMap)
+{
+   ((superlu_dist_options_t *) *opt)->RefactorMap = (yes_no_t) *RefactorMap;
+}
+
 /* wrappers for SuperLU functions */
 
 void f_set_default_options(fptr *options)
@@ -307,6 +312,48 @@ void f_pdgssvx(fptr *options, fptr *A, fptr *ScalePermstruct, double *B,
 	       (gridinfo_t *) *grid);
 }
 
+/* Refactor new values of A in place, with the structures of the last
+   factorization; nzval is the Fortran array of the new values, in the
+   order of the entries of A when it was created. The first factorization
+   must be done with RefactorMap = YES, see f_set_RefactorMap. */
+void f_pdgsrefactor(fptr *options, fptr *A, double *nzval,
+		    fptr *ScalePermstruct, fptr *grid, fptr *LUstruct,
+		    fptr *SOLVEstruct, fptr *stat, int *info)
+{
+    pdgsrefactor((superlu_dist_options_t *) *options, (SuperMatrix *) *A,
+		 nzval, (dScalePermstruct_t *) *ScalePermstruct,
+		 (gridinfo_t *) *grid, (dLUstruct_t *) *LUstruct,
+		 (dSOLVEstruct_t *) *SOLVEstruct, (SuperLUStat_t *) *stat,
+		 info);
+}
+
+/* Solve with the factors of the last f_pdgssvx or f_pdgsrefactor call,
+   for the nrhs columns of the Fortran array B, overwritten by X in
+   place. The solve workspace in SOLVEstruct is kept from call to call;
+   the statistics are not printed, see f_PStatPrint. */
+void f_pdgssvx_solve(fptr *options, fptr *A, fptr *ScalePermstruct,
+		     double *B, int *ldb, int *nrhs, fptr *grid,
+		     fptr *LUstruct, fptr *SOLVEstruct, double *berr,
+		     fptr *stat, int *info)
+{
+    superlu_dist_options_t *opt = (superlu_dist_options_t *) *options;
+    fact_t fact = opt->Fact;
+
+    opt->Fact = FACTORED;
+    pdgssvx(opt, (SuperMatrix *) *A,
+	    (dScalePermstruct_t *) *ScalePermstruct, B, *ldb, *nrhs,
+	    (gridinfo_t *) *grid, (dLUstruct_t *) *LUstruct,
+	    (dSOLVEstruct_t *) *SOLVEstruct, berr,
+	    (SuperLUStat_t *) *stat, info);
+    opt->Fact = fact;
+}
+
+void f_PStatPrint(fptr *options, fptr *stat, fptr *grid)
+{
+    PStatPrint((superlu_dist_options_t *) *options, (SuperLUStat_t *) *stat,
+	       (gridinfo_t *) *grid);
+}
+
 /* Create the distributed matrix */
 
 void f_dcreate_dist_matrix(fptr *A, int_t *m, int_t *n, int_t *nnz,
@@ -0,0 +1,244 @@
+/*! @file
+ * \brief Flat C interface to pdgssvx() for the Python bindings.
+ *
+ * <pre>
+ * -- Distributed SuperLU routine --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * A handle keeps the process grid, the options, the distributed matrix
+ * and the structures of the factorization from call to call, as the
+ * handles of the Fortran 90 interface do, see FORTRAN/superlu_c2f_dwrap.c.
+ * The local rows of A are described by the CSR arrays of the caller,
+ * used in place: pdgssvx() scales and permutes them on exit.
+ * </pre>
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "pdbridge.h"
+
+struct pdbridge_t {
+    gridinfo_t grid;
+    superlu_dist_options_t options;
+    SuperMatrix A;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    SuperLUStat_t stat;
+    int_t n, m_loc;
+    int factored;       /* A is factored, the solves can be done */
+    int distributed;    /* pdgssvx() has set up LUstruct */
+};
+
+/* The options that can be set by name; the enumerations are ints. */
+#define OPT_INT(name) { #name, offsetof(superlu_dist_options_t, name), 0 }
+#define OPT_DBL(name) { #name, offsetof(superlu_dist_options_t, name), 1 }
+
+static const struct {
+    const char *name;
+    size_t off;
+    int isdouble;
+} pdbridge_opts[] = {
+    OPT_INT(Equil), OPT_INT(DiagInv), OPT_INT(ColPerm), OPT_INT(Trans),
+    OPT_INT(IterRefine), OPT_DBL(DiagPivotThresh), OPT_INT(RowPerm),
+    OPT_INT(ParSymbFact), OPT_INT(ReplaceTinyPivot), OPT_INT(PrintStat),
+    OPT_INT(num_lookaheads), OPT_INT(lookahead_etree), OPT_INT(SymPattern),
+    OPT_INT(Reproducible), OPT_DBL(Amalg_Tol), OPT_INT(Equil_Iter),
+    OPT_INT(Fact_Comm), OPT_INT(Sched_Priority), OPT_INT(Solve_RootSize),
+    OPT_INT(Solve_RHSTile), OPT_DBL(MemBudget), OPT_INT(ReleaseMemory),
+    OPT_INT(RefactorMap), OPT_INT(SymValues), OPT_INT(Solve_Compact),
+    OPT_INT(Solve_Priority)
+};
+
+/* Size in bytes of int_t: the index arrays given to pdbridge_create()
+   must be of this size. */
+int pdbridge_int_size(void)
+{
+    return (int) sizeof(int_t);
+}
+
+/* Size of the communicator fcomm, as for pdbridge_create(); MPI is
+   initialized if it was not already. */
+int pdbridge_comm_size(int fcomm)
+{
+    int initialized, provided, size;
+
+    MPI_Initialized(&initialized);
+    if ( !initialized )
+	MPI_Init_thread(NULL, NULL, MPI_THREAD_MULTIPLE, &provided);
+    MPI_Comm_size(fcomm < 0 ? MPI_COMM_WORLD : MPI_Comm_f2c((MPI_Fint) fcomm),
+		  &size);
+    return size;
+}
+
+/* Rank of the calling process in fcomm; MPI is initialized if it was
+   not already. */
+int pdbridge_comm_rank(int fcomm)
+{
+    int rank;
+
+    pdbridge_comm_size(fcomm);
+    MPI_Comm_rank(fcomm < 0 ? MPI_COMM_WORLD : MPI_Comm_f2c((MPI_Fint) fcomm),
+		  &rank);
+    return rank;
+}
+
+/* Create a handle for the n-by-n matrix A distributed by block rows:
+   the calling process holds rows fst_row:fst_row+m_loc-1, in CSR format
+   with 0-based column indices; with fst_row < 0, the rows follow those
+   of the lower ranks, and with n < 0, n is the sum of the m_loc. The
+   arrays are kept, not copied, and must
+   live as long as the handle. fcomm is the Fortran handle of the
+   communicator (as given by mpi4py's Comm.py2f()), or < 0 for
+   MPI_COMM_WORLD; its size must be nprow*npcol. MPI is initialized with
+   MPI_THREAD_MULTIPLE if it was not already.
+   Returns NULL if an argument is not valid. */
+pdbridge_t *pdbridge_create(int fcomm, int nprow, int npcol, int_t n,
+			    int_t m_loc, int_t fst_row, int_t *rowptr,
+			    int_t *colind, double *nzval)
+{
+    pdbridge_t *h;
+    int size = pdbridge_comm_size(fcomm), iam;
+    MPI_Comm comm = fcomm < 0 ? MPI_COMM_WORLD : MPI_Comm_f2c((MPI_Fint) fcomm);
+    int_t t;
+
+    if ( fst_row < 0 ) {
+	MPI_Comm_rank(comm, &iam);
+	MPI_Exscan(&m_loc, &t, 1, mpi_int_t, MPI_SUM, comm);
+	fst_row = iam ? t : 0;
+    }
+    if ( n < 0 ) MPI_Allreduce(&m_loc, &n, 1, mpi_int_t, MPI_SUM, comm);
+    if ( nprow < 1 || npcol < 1 || size != nprow * npcol || n < 0
+	 || m_loc < 0 || fst_row < 0 || fst_row + m_loc > n || !rowptr
+	 || (m_loc && (!colind || !nzval)) )
+	return NULL;
+
+    if ( !(h = (pdbridge_t *) SUPERLU_MALLOC(sizeof(pdbridge_t))) )
+	ABORT("Malloc fails for pdbridge_t.");
+    memset(h, 0, sizeof(pdbridge_t));
+    superlu_gridinit(comm, nprow, npcol, &h->grid);
+    set_default_options_dist(&h->options);
+    h->options.PrintStat = NO;
+    h->n = n;
+    h->m_loc = m_loc;
+    dCreate_CompRowLoc_Matrix_dist(&h->A, n, n, rowptr[m_loc], m_loc,
+				   fst_row, nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_D, SLU_GE);
+    dScalePermstructInit(n, n, &h->ScalePermstruct);
+    dLUstructInit(n, &h->LUstruct);
+    PStatInit(&h->stat);
+    return h;
+}
+
+/* Set the option of the given name, as in superlu_dist_options_t; the
+   value of an enumeration is its number, e.g. 0 for NO and 1 for YES.
+   Returns 0, or -1 if there is no such option or the matrix is already
+   factored. */
+int pdbridge_set_option(pdbridge_t *h, const char *name, double value)
+{
+    size_t i;
+    char *p = (char *) &h->options;
+
+    if ( h->distributed ) return -1;
+    for (i = 0; i < sizeof(pdbridge_opts) / sizeof(pdbridge_opts[0]); ++i)
+	if ( !strcmp(name, pdbridge_opts[i].name) ) {
+	    if ( pdbridge_opts[i].isdouble )
+		*(double *) (p + pdbridge_opts[i].off) = value;
+	    else
+		*(int *) (p + pdbridge_opts[i].off) = (int) value;
+	    return 0;
+	}
+    return -1;
+}
+
+/* Factor A. Returns the info of pdgssvx(), or -1 if A is already
+   factored: new values are factored with pdbridge_refactor(). */
+int pdbridge_factor(pdbridge_t *h)
+{
+    int info;
+
+    if ( h->distributed ) return -1;
+    PStatFree(&h->stat);
+    PStatInit(&h->stat);
+    h->options.Fact = DOFACT;
+    pdgssvx(&h->options, &h->A, &h->ScalePermstruct, NULL,
+	    SUPERLU_MAX(h->m_loc, 1), 0, &h->grid, &h->LUstruct,
+	    &h->SOLVEstruct, NULL, &h->stat, &info);
+    h->distributed = 1;
+    if ( info == 0 ) h->factored = 1;
+    return info;
+}
+
+/* Factor new values of A with the structures of the last factorization,
+   see pdgsrefactor(); nzval is in the order of the entries on entry to
+   pdbridge_create(). RefactorMap must be set before pdbridge_factor().
+   Returns the info of pdgsrefactor(). */
+int pdbridge_refactor(pdbridge_t *h, double *nzval)
+{
+    int info;
+
+    if ( !h->distributed ) return -1;
+    PStatFree(&h->stat);
+    PStatInit(&h->stat);
+    pdgsrefactor(&h->options, &h->A, nzval, &h->ScalePermstruct, &h->grid,
+		 &h->LUstruct, &h->SOLVEstruct, &h->stat, &info);
+    h->factored = ( info == 0 );
+    return info;
+}
+
+/* Solve for the nrhs columns of B, stored by columns with leading
+   dimension ldb >= m_loc, overwritten by X in place; berr, of length
+   nrhs, receives the componentwise backward errors. Returns the info of
+   pdgssvx(). */
+int pdbridge_solve(pdbridge_t *h, int nrhs, double *b, int ldb, double *berr)
+{
+    int info;
+
+    if ( !h->factored ) return -1;
+    PStatFree(&h->stat);
+    PStatInit(&h->stat);
+    h->options.Fact = FACTORED;
+    pdgssvx(&h->options, &h->A, &h->ScalePermstruct, b, ldb, nrhs,
+	    &h->grid, &h->LUstruct, &h->SOLVEstruct, berr, &h->stat, &info);
+    return info;
+}
+
+/* Rank of the calling process in the grid. */
+int pdbridge_rank(pdbridge_t *h)
+{
+    return h->grid.iam;
+}
+
+/* Print the statistics of the last call. */
+void pdbridge_print_stat(pdbridge_t *h)
+{
+    PStatPrint(&h->options, &h->stat, &h->grid);
+}
+
+/* Free the handle; the arrays of the caller are left alone. Nothing is
+   done once MPI is finalized, the process is about to exit. */
+void pdbridge_free(pdbridge_t *h)
+{
+    int finalized;
+
+    MPI_Finalized(&finalized);
+    if ( !h || finalized ) return;
+    PStatFree(&h->stat);
+    if ( h->distributed ) dDestroy_LU(h->n, &h->grid, &h->LUstruct);
+    dScalePermstructFree(&h->ScalePermstruct);
+    dLUstructFree(&h->LUstruct);
+    if ( h->options.SolveInitialized )
+	dSolveFinalize(&h->options, &h->SOLVEstruct);
+    Destroy_SuperMatrix_Store_dist(&h->A);
+    superlu_gridexit(&h->grid);
+    SUPERLU_FREE(h);
+}
+
+/* Finalize MPI, unless it is already finalized. */
+void pdbridge_mpi_finalize(void)
+{
+    int finalized;
+
+    MPI_Finalized(&finalized);
+    if ( !finalized ) MPI_Finalize();
+}
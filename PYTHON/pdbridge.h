@@ -0,0 +1,44 @@
+/*! @file
+ * \brief Flat C interface to pdgssvx() for the Python bindings.
+ *
+ * <pre>
+ * -- Distributed SuperLU routine --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * All the arguments are plain C types, so that the functions can be
+ * called through ctypes without compiling against the Python headers.
+ * The arrays are used in place: the library keeps the pointers given to
+ * pdbridge_create() and pdbridge_solve(), they are never copied.
+ * </pre>
+ */
+
+#ifndef __SUPERLU_PDBRIDGE
+#define __SUPERLU_PDBRIDGE
+
+#include "superlu_ddefs.h"
+
+typedef struct pdbridge_t pdbridge_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int  pdbridge_int_size(void);
+extern int  pdbridge_comm_size(int);
+extern int  pdbridge_comm_rank(int);
+extern pdbridge_t *pdbridge_create(int, int, int, int_t, int_t, int_t,
+				   int_t *, int_t *, double *);
+extern int  pdbridge_set_option(pdbridge_t *, const char *, double);
+extern int  pdbridge_factor(pdbridge_t *);
+extern int  pdbridge_refactor(pdbridge_t *, double *);
+extern int  pdbridge_solve(pdbridge_t *, int, double *, int, double *);
+extern int  pdbridge_rank(pdbridge_t *);
+extern void pdbridge_print_stat(pdbridge_t *);
+extern void pdbridge_free(pdbridge_t *);
+extern void pdbridge_mpi_finalize(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SUPERLU_PDBRIDGE */
@@ -0,0 +1,96 @@
+"""Example of the Python interface of SuperLU_DIST.
+
+Each process builds its block of rows of the 7-point Laplacian on a
+k x k x k grid, factors it, solves two right-hand sides of known
+solution, then factors new values of the matrix and solves again.
+
+    mpiexec -n 4 python3 pddrive.py [k]
+
+mpi4py is used when it is installed, MPI_COMM_WORLD otherwise; the
+arrays are array.array, NumPy arrays are used the same way.
+"""
+
+import array
+import sys
+
+import superlu_dist
+
+try:
+    from mpi4py import MPI
+    comm = MPI.COMM_WORLD
+except ImportError:
+    comm = None
+
+
+def laplacian(k, first, last, shift):
+    """CSR arrays of the rows first:last-1 of the Laplacian + shift*I."""
+    typecode = "q" if superlu_dist.int_size() == 8 else "i"
+    indptr, indices = array.array(typecode, [0]), array.array(typecode)
+    data = array.array("d")
+    for i in range(first, last):
+        x, y, z = i % k, (i // k) % k, i // (k * k)
+        for j, inside in ((i - k * k, z > 0), (i - k, y > 0), (i - 1, x > 0),
+                          (i, True), (i + 1, x < k - 1),
+                          (i + k, y < k - 1), (i + k * k, z < k - 1)):
+            if inside:
+                indices.append(j)
+                data.append(6.0 + shift if j == i else -1.0)
+        indptr.append(len(indices))
+    return indptr, indices, data
+
+
+def rhs(A, first, xtrue, nrhs):
+    """b = A*xtrue for nrhs columns, stored by columns."""
+    indptr, indices, data = A
+    m_loc = len(indptr) - 1
+    b = array.array("d", bytes(8 * m_loc * nrhs))
+    for j in range(nrhs):
+        for r in range(m_loc):
+            b[r + j * m_loc] = sum(
+                data[p] * xtrue(indices[p], j)
+                for p in range(indptr[r], indptr[r + 1]))
+    return b
+
+
+def error(b, first, xtrue, nrhs):
+    m_loc = len(b) // nrhs
+    return max([abs(b[r + j * m_loc] - xtrue(first + r, j))
+                for j in range(nrhs) for r in range(m_loc)] + [0.0])
+
+
+def main():
+    k = int(sys.argv[1]) if len(sys.argv) > 1 else 10
+    n, nrhs = k ** 3, 2
+    size = superlu_dist.comm_size(comm)
+    rank = superlu_dist.comm_rank(comm)
+    first, last = n * rank // size, n * (rank + 1) // size
+
+    def xtrue(i, j):
+        return 1.0 + 0.5 * j + i / float(n)
+
+    A = laplacian(k, first, last, 0.0)
+    b = rhs(A, first, xtrue, nrhs)
+    # A is scaled and permuted in place by the factorization.
+    with superlu_dist.Solver(A, first_row=first, n=n, comm=comm,
+                             RefactorMap=True) as slv:
+        slv.factor()
+        berr = slv.solve(b)
+        err = error(b, first, xtrue, nrhs)
+        if slv.rank == 0:
+            print("factor: berr %s" % ["%.2e" % e for e in berr])
+
+        # New values with the same pattern.
+        A2 = laplacian(k, first, last, 1.0)
+        b = rhs(A2, first, xtrue, nrhs)
+        slv.refactor(A2[2])
+        slv.solve(b)
+        err = max(err, error(b, first, xtrue, nrhs))
+        if comm:
+            err = comm.allreduce(err, op=MPI.MAX)
+        print("rank %d: max error %.2e" % (rank, err))
+    if not comm:
+        superlu_dist.finalize()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,289 @@
+"""Python interface to the distributed solver pdgssvx() of SuperLU_DIST.
+
+Each MPI process gives its block of consecutive rows of the sparse matrix
+A, in CSR format (a scipy.sparse.csr_matrix, or the three arrays indptr,
+indices and data), and its rows of the right-hand sides. The arrays are
+passed to the library through the buffer protocol and are never copied:
+
+  * the CSR arrays are kept by the Solver and are scaled and permuted in
+    place by the factorization; pass copy=True to keep them intact;
+  * the right-hand sides are overwritten in place by the solution.
+
+The library is called through ctypes, which releases the GIL for the
+duration of each call, so that other Python threads keep running during
+a factorization or a solve.
+
+    from mpi4py import MPI
+    import superlu_dist
+
+    with superlu_dist.Solver(A_loc, comm=MPI.COMM_WORLD) as slv:
+        slv.factor()
+        berr = slv.solve(b_loc)      # b_loc now holds x_loc
+
+mpi4py, NumPy and SciPy are optional: any object exporting a contiguous
+writable buffer of the right type (e.g. array.array) is accepted, and
+without a communicator MPI_COMM_WORLD is used, MPI being initialized by
+the library if needed.
+
+The shared library libsuperlu_dist_python is found in the directory named
+by the environment variable SUPERLU_DIST_PYTHON_LIB, then next to this
+file, then in its parent directory.
+"""
+
+import ctypes
+import math
+import os
+
+__all__ = ["Solver", "SuperLUError", "comm_rank", "comm_size", "finalize",
+           "int_size"]
+
+NO, YES = 0, 1
+
+
+class SuperLUError(RuntimeError):
+    """Error returned by the library, with its info value."""
+
+    def __init__(self, routine, info):
+        RuntimeError.__init__(self, "%s returned info = %d" % (routine, info))
+        self.info = info
+
+
+def _load():
+    names = ("libsuperlu_dist_python.so", "libsuperlu_dist_python.dylib")
+    here = os.path.dirname(os.path.abspath(__file__))
+    dirs = [os.environ.get("SUPERLU_DIST_PYTHON_LIB"), here,
+            os.path.dirname(here)]
+    for d in dirs:
+        for name in names:
+            if d and os.path.exists(os.path.join(d, name)):
+                # RTLD_GLOBAL: the MPI library loads its own plugins.
+                return ctypes.CDLL(os.path.join(d, name),
+                                   mode=ctypes.RTLD_GLOBAL)
+    raise OSError("libsuperlu_dist_python not found, "
+                  "set SUPERLU_DIST_PYTHON_LIB")
+
+
+_lib = _load()
+_int_t = ctypes.c_int64 if _lib.pdbridge_int_size() == 8 else ctypes.c_int32
+_vp = ctypes.c_void_p
+
+_lib.pdbridge_comm_size.argtypes = [ctypes.c_int]
+_lib.pdbridge_comm_rank.argtypes = [ctypes.c_int]
+_lib.pdbridge_create.restype = _vp
+_lib.pdbridge_create.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_int,
+                                 _int_t, _int_t, _int_t, _vp, _vp, _vp]
+_lib.pdbridge_set_option.argtypes = [_vp, ctypes.c_char_p, ctypes.c_double]
+_lib.pdbridge_factor.argtypes = [_vp]
+_lib.pdbridge_refactor.argtypes = [_vp, _vp]
+_lib.pdbridge_solve.argtypes = [_vp, ctypes.c_int, _vp, ctypes.c_int, _vp]
+_lib.pdbridge_rank.argtypes = [_vp]
+_lib.pdbridge_print_stat.argtypes = [_vp]
+_lib.pdbridge_free.argtypes = [_vp]
+
+
+def int_size():
+    """Size in bytes of the indices expected by the library (int_t)."""
+    return ctypes.sizeof(_int_t)
+
+
+def _fcomm(comm):
+    if comm is None:
+        return -1
+    if hasattr(comm, "py2f"):
+        return comm.py2f()
+    return int(comm)
+
+
+def comm_size(comm=None):
+    """Size of the communicator, MPI_COMM_WORLD by default; MPI is
+    initialized if it was not already."""
+    return _lib.pdbridge_comm_size(_fcomm(comm))
+
+
+def comm_rank(comm=None):
+    """Rank of the calling process in the communicator."""
+    return _lib.pdbridge_comm_rank(_fcomm(comm))
+
+
+def finalize():
+    """Finalize MPI, if mpi4py is not doing it."""
+    _lib.pdbridge_mpi_finalize()
+
+
+def _buffer(obj, kind, name, copy=False):
+    """Return (memoryview, address, owner) of the contiguous writable
+    buffer of obj, whose items are kind 'f' (float64) or 'i' (int_t);
+    owner must be kept alive as long as the address is used. With copy,
+    the buffer is a private copy of obj."""
+    mv = memoryview(obj)
+    fmt = mv.format.lstrip("<=@")
+    if kind == "f":
+        ok = fmt == "d"
+        what = "float64"
+    else:
+        ok = fmt in ("i", "l", "q") and mv.itemsize == ctypes.sizeof(_int_t)
+        what = "int%d" % (8 * ctypes.sizeof(_int_t))
+    if not ok:
+        raise TypeError("%s must be a buffer of %s, not '%s'"
+                        % (name, what, mv.format))
+    if not (mv.c_contiguous or mv.f_contiguous):
+        raise ValueError("%s must be contiguous" % name)
+    if copy:
+        owner = bytearray(mv.tobytes(order="A"))
+        obj, mv = owner, memoryview(owner).cast(fmt, mv.shape)
+    elif mv.readonly:
+        raise ValueError("%s must be writable" % name)
+    if mv.nbytes == 0:
+        return mv, None, obj
+    if hasattr(obj, "__array_interface__"):
+        addr = obj.__array_interface__["data"][0]
+    else:
+        # Only the C-contiguous buffers can be cast to bytes.
+        addr = ctypes.addressof(
+            (ctypes.c_char * mv.nbytes).from_buffer(mv.cast("B")))
+    return mv, addr, obj
+
+
+def _grid_shape(size):
+    nprow = int(math.sqrt(size))
+    while size % nprow:
+        nprow -= 1
+    return nprow, size // nprow
+
+
+class Solver(object):
+    """Factorization of a sparse matrix distributed by block rows.
+
+    A is the local block of rows: a scipy.sparse.csr_matrix, or a tuple
+    (indptr, indices, data), with 0-based column indices of the size of
+    int_size() and float64 values.
+    first_row is the global index of the first local row; by default the
+    blocks of the ranks follow one another. n is the order of A; by
+    default the number of columns of a scipy matrix, else the sum of the
+    numbers of local rows.
+    comm is an mpi4py communicator (or its Fortran handle), by default
+    MPI_COMM_WORLD; grid = (nprow, npcol) is the process grid, by default
+    the most nearly square one.
+    options are fields of superlu_dist_options_t, with the numbers of the
+    enumerations of SRC/superlu_enum_consts.h, e.g. ColPerm=4 for
+    METIS_AT_PLUS_A, or True and False for YES and NO.
+    """
+
+    def __init__(self, A, first_row=None, n=None, comm=None, grid=None,
+                 copy=False, **options):
+        if hasattr(A, "indptr"):
+            indptr, indices, data = A.indptr, A.indices, A.data
+            if n is None:
+                n = A.shape[1]
+        else:
+            indptr, indices, data = A
+        fcomm = _fcomm(comm)
+        self._h = None
+        # With copy, the Solver works on private copies of the arrays.
+        rp, rp_addr, self._indptr = _buffer(indptr, "i", "indptr", copy)
+        ci, ci_addr, self._indices = _buffer(indices, "i", "indices", copy)
+        va, va_addr, self._data = _buffer(data, "f", "data", copy)
+        m_loc = len(rp) - 1
+        if m_loc < 0 or len(ci) < rp[m_loc] or len(va) < rp[m_loc]:
+            raise ValueError("inconsistent CSR arrays")
+        if grid is None:
+            grid = _grid_shape(_lib.pdbridge_comm_size(fcomm))
+        self.m_loc = m_loc
+        self._h = _lib.pdbridge_create(
+            fcomm, grid[0], grid[1], -1 if n is None else n, m_loc,
+            -1 if first_row is None else first_row, rp_addr, ci_addr,
+            va_addr)
+        if not self._h:
+            raise ValueError("invalid matrix or grid %s" % (grid,))
+        for name, value in options.items():
+            self.set_option(name, value)
+
+    def set_option(self, name, value):
+        """Set a field of superlu_dist_options_t before factor()."""
+        self._check()
+        if _lib.pdbridge_set_option(self._h, name.encode(),
+                                    float(value)) != 0:
+            raise ValueError("unknown option %s, or matrix already factored"
+                             % name)
+
+    @property
+    def rank(self):
+        """Rank of the calling process in the grid."""
+        self._check()
+        return _lib.pdbridge_rank(self._h)
+
+    def factor(self):
+        """Factor A; it can be done only once, see refactor()."""
+        self._check()
+        info = _lib.pdbridge_factor(self._h)
+        if info:
+            raise SuperLUError("pdgssvx", info)
+
+    def refactor(self, data):
+        """Factor the new values data of A, in the order of the entries
+        given to the Solver, with the structures of factor(); the option
+        RefactorMap must have been set. data is only read."""
+        self._check()
+        va, addr, owner = _buffer(data, "f", "data",
+                                  copy=memoryview(data).readonly)
+        if len(va) < len(memoryview(self._data)):
+            raise ValueError("data is too short")
+        info = _lib.pdbridge_refactor(self._h, addr)
+        if info:
+            raise SuperLUError("pdgsrefactor", info)
+
+    def solve(self, b, nrhs=None):
+        """Solve A x = b for the local rows b of the right-hand sides,
+        overwritten by x in place: a Fortran-ordered (m_loc, nrhs) array
+        of float64, or a vector of the nrhs columns one after the other.
+        nrhs is needed only where m_loc = 0. Returns the backward
+        errors."""
+        self._check()
+        mv, addr, owner = _buffer(b, "f", "b")
+        if mv.ndim == 2 and mv.shape[0] == self.m_loc and (
+                mv.f_contiguous or mv.shape[1] == 1):
+            cols = mv.shape[1]
+        elif mv.ndim == 1 and self.m_loc and len(mv) % self.m_loc == 0:
+            cols = len(mv) // self.m_loc
+        elif mv.ndim == 1 and not len(mv):
+            cols = nrhs
+        else:
+            raise ValueError("b must have %d rows stored by columns"
+                             % self.m_loc)
+        if nrhs is None:
+            nrhs = cols
+        if cols != nrhs:
+            raise ValueError("b must have %d columns" % nrhs)
+        berr = (ctypes.c_double * max(nrhs, 1))()
+        info = _lib.pdbridge_solve(self._h, nrhs, addr, max(self.m_loc, 1),
+                                   berr)
+        if info:
+            raise SuperLUError("pdgssvx", info)
+        return list(berr)[:nrhs]
+
+    def print_stat(self):
+        """Print the statistics of the last call."""
+        self._check()
+        _lib.pdbridge_print_stat(self._h)
+
+    def close(self):
+        """Free the factors; the arrays given to the Solver are left."""
+        if self._h:
+            _lib.pdbridge_free(self._h)
+            self._h = None
+
+    def _check(self):
+        if not self._h:
+            raise ValueError("the Solver is closed")
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        try:
+            self.close()
+        except Exception:
+            pass
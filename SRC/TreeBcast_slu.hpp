@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <string>
 #include <memory>
+#include <mutex>
 //#include <random>
 
 // options to switch from a flat bcast/reduce tree to a binary tree
@@ -19,6 +20,12 @@
 #define FTREE_LIMIT 8
 #endif
 
+// the broadcasts of messages up to BCAST_SMALL_BYTES are latency bound,
+// see BcastShapeTable()
+#ifndef BCAST_SMALL_BYTES
+#define BCAST_SMALL_BYTES 1024
+#endif
+
 namespace SuperLU_ASYNCOMM {
 
     // Basic data types
@@ -28,7 +35,26 @@ namespace SuperLU_ASYNCOMM {
     // Commonly used
   const Int DEG_TREE = 2; //number of children of each tree node
 
-  extern std::map< MPI_Comm , std::vector<Int> > commGlobRanks;
+  // node number of each rank of a communicator, see TreeNodeMap_Create();
+  // the grids of several threads may be created and freed concurrently,
+  // so the map is only accessed under commNodeIdsLock
+  extern std::map< MPI_Comm , std::vector<Int> > commNodeIds;
+  extern std::mutex commNodeIdsLock;
+  inline const std::vector<Int> * NodeIdsOf(const MPI_Comm & pComm);
+  inline bool UseNodeTree(const MPI_Comm & pComm, Int * ranks, Int rank_cnt);
+
+  // shape of a broadcast, chosen by TreeBcast_slu<T>::Create() from the
+  // number of destinations and the message size
+  enum BcastShape { BCAST_FLAT, BCAST_CHAIN, BCAST_TREE };
+  struct BcastShapeRow {
+    Int maxBytes;   // the row applies to messages up to maxBytes, -1: any
+    Int flatDests;  // flat up to flatDests destinations,
+    Int chainDests; // then a chain up to chainDests, then a tree
+  };
+  inline const std::vector<BcastShapeRow> & BcastShapeTable();
+  inline BcastShape ChooseBcastShape(Int ndest, double msgBytes);
+  inline void BuildNodeTree(const std::vector<Int> & nodeOf, Int myRank,
+      Int * ranks, Int rank_cnt, Int & myRoot, std::vector<Int> & myDests);
 
   template< typename T>
     class TreeBcast_slu{
@@ -49,6 +75,32 @@ namespace SuperLU_ASYNCOMM {
         Int sendPostedCount_;
         Int sendCount_;
 
+        // persistent send requests in sendRequests_ are bound to this
+        // buffer, message size, tag and datatype
+        T * persistBuf_;
+        Int persistSize_;
+        Int persistTag_;
+        MPI_Datatype persistType_;
+
+        // the requests of the last other keys, kept to be restarted,
+        // oldest first
+        struct PersistSend {
+          T * buf;
+          Int size;
+          Int tag;
+          MPI_Datatype type;
+          std::vector<MPI_Request> reqs;
+        };
+        std::vector<PersistSend> persistOld_;
+        static const Int maxPersistOld_ = 3;
+
+        // small messages are handed to this aggregator instead, if set
+        pxgstrs_agg_t * agg_;
+
+        // precision of the values sent (msg_prec_t), and their packed copy
+        Int msgPrec_;
+        std::vector<char> lowpBuf_;
+
         bool done_;
         bool fwded_;
         bool isReady_;
@@ -71,7 +123,10 @@ namespace SuperLU_ASYNCOMM {
 
 
       public:
-        static TreeBcast_slu<T> * Create(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize,double rseed);
+        // msgSize is per right-hand side, the shape is chosen for nrhs of them
+        static TreeBcast_slu<T> * Create(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize,double rseed, Int nrhs=1);
+        // rebuild the local view of a tree (root and destinations of this rank), e.g. when reading saved factors
+        static TreeBcast_slu<T> * CreateLocal(const MPI_Comm & pComm, Int root, Int * dests, Int ndest, Int msgSize);
         TreeBcast_slu();
         TreeBcast_slu(const MPI_Comm & pComm, Int * ranks, Int rank_cnt,Int msgSize);
         TreeBcast_slu(const TreeBcast_slu & Tree);
@@ -94,6 +149,8 @@ namespace SuperLU_ASYNCOMM {
         Int GetRoot();
         bool IsRoot();
         void SetMsgSize(Int msgSize){ this->msgSize_ = msgSize;}
+        void SetAggregator(pxgstrs_agg_t * agg){ this->agg_ = agg;}
+        void SetMsgPrec(Int prec){ this->msgPrec_ = prec;}
         Int GetMsgSize();
         bool IsReady(){ return this->isReady_;}
 
@@ -106,6 +163,12 @@ namespace SuperLU_ASYNCOMM {
 		virtual void allocateRequest();
 		virtual void forwardMessageSimple(T * locBuffer, Int msgSize);	
 		virtual void waitSendRequest();	
+		virtual void freeRequest();
+		// start the persistent sends of count entries of type at buf to dests
+		void startSend(void * buf, Int count, MPI_Datatype type, Int tag,
+		    const Int * dests, Int nDests);
+		// pack locBuffer in reduced precision, see pxgstrs_lowp_pack()
+		Int packLowPrec(T * locBuffer, Int msgSize);
 
     };
 
@@ -141,6 +204,30 @@ namespace SuperLU_ASYNCOMM {
         virtual ModBTreeBcast2<T> * clone() const;
     };
 
+  // chain: each rank forwards to the next one in ranks[], so that every
+  // rank sends the message at most once
+  template< typename T>
+    class ChainBcast2: public TreeBcast_slu<T>{
+      protected:
+        virtual void buildTree(Int * ranks, Int rank_cnt);
+
+      public:
+        ChainBcast2(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize);
+        virtual ChainBcast2<T> * clone() const;
+    };
+
+  // two-level tree: across nodes between one leader per node, then
+  // within each node from the leader (see BuildNodeTree)
+  template< typename T>
+    class NodeTreeBcast2: public TreeBcast_slu<T>{
+      protected:
+        virtual void buildTree(Int * ranks, Int rank_cnt);
+
+      public:
+        NodeTreeBcast2(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize);
+        virtual NodeTreeBcast2<T> * clone() const;
+    };
+
 } // namespace SuperLU_ASYNCOMM
 
 #include "TreeBcast_slu_impl.hpp"
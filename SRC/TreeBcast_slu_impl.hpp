@@ -4,6 +4,130 @@
 
 namespace SuperLU_ASYNCOMM {
 
+  // The node map of pComm, or NULL if there is none. The entry stays valid
+  // while the grid of pComm exists, as the other entries do not move it.
+  inline const std::vector<Int> * NodeIdsOf(const MPI_Comm & pComm){
+    std::lock_guard<std::mutex> lock(commNodeIdsLock);
+    std::map< MPI_Comm , std::vector<Int> >::const_iterator it = commNodeIds.find(pComm);
+    return it==commNodeIds.end() ? NULL : &it->second;
+  }
+
+  // Use the node-aware tree if the node map of pComm is known and the
+  // ranks share nodes but do not all live on the same one.
+  inline bool UseNodeTree(const MPI_Comm & pComm, Int * ranks, Int rank_cnt){
+    const std::vector<Int> * nodeOf = NodeIdsOf(pComm);
+    if(nodeOf==NULL) return false;
+
+    std::vector<Int> nodes(rank_cnt);
+    for(Int i=0;i<rank_cnt;++i) nodes[i] = (*nodeOf)[ranks[i]];
+    std::sort(nodes.begin(),nodes.end());
+    Int nnodes = std::unique(nodes.begin(),nodes.end()) - nodes.begin();
+    return nnodes>1 && nnodes<rank_cnt;
+  }
+
+  // Crossover table of the broadcast shapes, in increasing maxBytes. Small
+  // messages are latency bound: a flat broadcast to up to FTREE_LIMIT
+  // destinations saves the extra hops of a tree. For larger ones the root
+  // sends the whole message to each destination of a flat broadcast, so
+  // flat only pays for 2-3 destinations, where a tree adds a hop but the
+  // root still sends twice. A chain has every rank send once; it is off
+  // by default, as X[k] is forwarded whole and not in pipelined segments.
+  // SUPERLU_BCAST_SHAPE="bytes:flat:chain,...,-1:flat:chain" replaces the
+  // table; it must be the same on all the ranks.
+  inline std::vector<BcastShapeRow> ReadBcastShapeTable(){
+    std::vector<BcastShapeRow> table;
+
+    char * ttemp = getenv("SUPERLU_BCAST_SHAPE");
+    if(ttemp){
+      BcastShapeRow row;
+      char * p = ttemp;
+      while(sscanf(p,"%d:%d:%d",&row.maxBytes,&row.flatDests,&row.chainDests)==3){
+        table.push_back(row);
+        if((p = strchr(p,','))==NULL) break;
+        ++p;
+      }
+    }
+    if(table.empty()){
+      BcastShapeRow small = {BCAST_SMALL_BYTES, FTREE_LIMIT, 0};
+      BcastShapeRow large = {-1, 3, 0};
+      table.push_back(small);
+      table.push_back(large);
+    }
+    return table;
+  }
+
+  // Read once; the initialization of a local static is thread-safe.
+  inline const std::vector<BcastShapeRow> & BcastShapeTable(){
+    static const std::vector<BcastShapeRow> table = ReadBcastShapeTable();
+    return table;
+  }
+
+  inline BcastShape ChooseBcastShape(Int ndest, double msgBytes){
+    const std::vector<BcastShapeRow> & table = BcastShapeTable();
+    Int i = 0;
+    while(i<(Int)table.size()-1 && table[i].maxBytes>=0
+        && msgBytes>table[i].maxBytes) ++i;
+    if(ndest<=table[i].flatDests) return BCAST_FLAT;
+    if(ndest<=table[i].chainDests) return BCAST_CHAIN;
+    return BCAST_TREE;
+  }
+
+  // Root and destinations of myRank in a two-level tree over ranks[],
+  // rooted at ranks[0]. The ranks are grouped by node in their order in
+  // ranks[], and the first one of each node is its leader (ranks[0] leads
+  // the first node). The leaders form a binary tree, and each leader then
+  // reaches the other ranks of its node by a flat tree if there are at most
+  // FTREE_LIMIT of them, by a binary tree otherwise. A message thus crosses
+  // the network once per node. A leader sends to the other nodes first.
+  inline void BuildNodeTree(const std::vector<Int> & nodeOf, Int myRank,
+      Int * ranks, Int rank_cnt, Int & myRoot, std::vector<Int> & myDests){
+    std::map<Int,Int> nodeIdx;
+    std::vector< std::vector<Int> > members;
+    Int myNode = 0, myPos = 0;
+
+    for(Int i=0;i<rank_cnt;++i){
+      Int idx;
+      std::map<Int,Int>::iterator it = nodeIdx.find(nodeOf[ranks[i]]);
+      if(it==nodeIdx.end()){
+        idx = members.size();
+        nodeIdx[nodeOf[ranks[i]]] = idx;
+        members.push_back(std::vector<Int>());
+      }
+      else{
+        idx = it->second;
+      }
+      if(ranks[i]==myRank){
+        myNode = idx;
+        myPos = members[idx].size();
+      }
+      members[idx].push_back(ranks[i]);
+    }
+
+    Int nnodes = members.size();
+    std::vector<Int> & local = members[myNode];
+    Int nlocal = local.size();
+
+    if(myPos==0){
+      for(Int ii=0;ii<DEG_TREE;++ii){
+        Int child = myNode*DEG_TREE+1+ii;
+        if(child<nnodes) myDests.push_back(members[child][0]);
+      }
+      myRoot = myNode==0 ? myRank : members[(myNode-1)/DEG_TREE][0];
+    }
+
+    if(nlocal-1<=FTREE_LIMIT){
+      if(myPos==0) myDests.insert(myDests.end(),local.begin()+1,local.end());
+      else myRoot = local[0];
+    }
+    else{
+      for(Int ii=0;ii<DEG_TREE;++ii){
+        Int child = myPos*DEG_TREE+1+ii;
+        if(child<nlocal) myDests.push_back(local[child]);
+      }
+      if(myPos!=0) myRoot = local[(myPos-1)/DEG_TREE];
+    }
+  }
+
   template< typename T> 
     TreeBcast_slu<T>::TreeBcast_slu(){
       comm_ = MPI_COMM_NULL;
@@ -21,6 +145,12 @@ namespace SuperLU_ASYNCOMM {
       recvRequests_.assign(1,MPI_REQUEST_NULL);
       fwded_=false;
       done_ = false;
+      persistBuf_ = NULL;
+      persistSize_ = -1;
+      persistTag_ = -1;
+      persistType_ = MPI_DATATYPE_NULL;
+      agg_ = NULL;
+      msgPrec_ = SLU_MSG_FULL;
 
 
       MPI_Type_contiguous( sizeof(T), MPI_BYTE, &type_ );
@@ -68,7 +198,15 @@ namespace SuperLU_ASYNCOMM {
 
       this->recvRequests_ = Tree.recvRequests_;
       this->recvTempBuffer_ = Tree.recvTempBuffer_;
-      this->sendRequests_ = Tree.sendRequests_;
+      // persistent requests are owned by Tree, do not share them
+      this->sendRequests_.assign(Tree.sendRequests_.size(),MPI_REQUEST_NULL);
+      this->persistOld_.clear();
+      this->persistBuf_ = NULL;
+      this->persistSize_ = -1;
+      this->persistTag_ = -1;
+      this->persistType_ = MPI_DATATYPE_NULL;
+      this->agg_ = NULL;
+      this->msgPrec_ = SLU_MSG_FULL;
       this->recvDataPtrs_ = Tree.recvDataPtrs_;
       if(Tree.recvDataPtrs_[0]==(T*)Tree.recvTempBuffer_.data()){
         this->recvDataPtrs_[0]=(T*)this->recvTempBuffer_.data();
@@ -164,27 +302,100 @@ namespace SuperLU_ASYNCOMM {
 
   template< typename T> 
     inline void TreeBcast_slu<T>::forwardMessageSimple(T * locBuffer, Int msgSize){
+		Int nDests = this->myDests_.size();
+		if(nDests==0) return;
+
+		// A small message is copied into the packets of the destinations.
+		if(this->agg_ && msgSize*sizeof(T)<=this->agg_->maxmsg){
+		  for( Int idxRecv = 0; idxRecv < nDests; ++idxRecv )
+            pxgstrs_agg_put(this->agg_, this->myDests_[idxRecv], this->tag_,
+                locBuffer, msgSize*sizeof(T));
+		  return;
+		}
+
+		// A large message may go in reduced precision, packed into lowpBuf_.
+		Int bytes = this->packLowPrec(locBuffer, msgSize);
+		if(bytes)
+		  this->startSend(&this->lowpBuf_[0], bytes, MPI_BYTE, this->tag_+SOL_LOWP,
+		      &this->myDests_[0], nDests);
+		else
+		  this->startSend(locBuffer, msgSize, this->type_, this->tag_,
+		      &this->myDests_[0], nDests);
+    }	  
+
+  // The send requests are persistent: they are built once for a given
+  // buffer, message size, tag and datatype, and restarted on every solve.
+  // The count of a persistent send is fixed, so each key has its own
+  // requests. Those of the last maxPersistOld_ other keys are kept, so
+  // that a message packed in lowpBuf_ as bytes on tag_+SOL_LOWP after a
+  // full one, or the fewer right-hand sides of the iterative refinement,
+  // restart them instead of building new ones.
+  template< typename T> 
+    inline void TreeBcast_slu<T>::startSend(void * buf, Int count, MPI_Datatype type, Int tag,
+        const Int * dests, Int nDests){
         MPI_Status status;
 		Int flag;
-		for( Int idxRecv = 0; idxRecv < this->myDests_.size(); ++idxRecv ){
-          Int iProc = this->myDests_[idxRecv];
-          // Use Isend to send to multiple targets
-          Int error_code = MPI_Isend( locBuffer, msgSize, this->type_, 
-              iProc, this->tag_,this->comm_, &this->sendRequests_[idxRecv] );
-			  
+
+		if((T *)buf!=this->persistBuf_ || count!=this->persistSize_
+		    || tag!=this->persistTag_ || type!=this->persistType_){
+		  PersistSend cur = { this->persistBuf_, this->persistSize_,
+		      this->persistTag_, this->persistType_, std::vector<MPI_Request>() };
+		  cur.reqs.swap(this->sendRequests_);
+		  Int i, nold = this->persistOld_.size();
+		  for( i = 0; i < nold; ++i ){
+		    PersistSend & old = this->persistOld_[i];
+		    if(old.buf==(T *)buf && old.size==count && old.tag==tag && old.type==type) break;
+		  }
+		  if(i<nold){
+		    this->sendRequests_.swap(this->persistOld_[i].reqs);
+		    this->persistOld_.erase(this->persistOld_.begin()+i);
+		  }else{
+		    this->sendRequests_.assign(cur.reqs.size(),MPI_REQUEST_NULL);
+		    for( Int idxRecv = 0; idxRecv < nDests; ++idxRecv ){
+              Int iProc = dests[idxRecv];
+              MPI_Send_init( buf, count, type, 
+                  iProc, tag,this->comm_, &this->sendRequests_[idxRecv] );
+		    }
+		  }
+		  this->persistBuf_ = (T *)buf;
+		  this->persistSize_ = count;
+		  this->persistTag_ = tag;
+		  this->persistType_ = type;
+
+		  // the previous requests are inactive, see waitSendRequest()
+		  if(cur.buf!=NULL){
+		    if((Int)this->persistOld_.size()==maxPersistOld_){
+		      std::vector<MPI_Request> & reqs = this->persistOld_[0].reqs;
+		      for( i = 0; i < (Int)reqs.size(); ++i )
+		        if(reqs[i]!=MPI_REQUEST_NULL) MPI_Request_free(&reqs[i]);
+		      this->persistOld_.erase(this->persistOld_.begin());
+		    }
+		    this->persistOld_.push_back(cur);
+		  }
+		}
+
+		MPI_Startall(nDests, &this->sendRequests_[0]);
+		for( Int idxRecv = 0; idxRecv < nDests; ++idxRecv ){
 			  MPI_Test(&this->sendRequests_[idxRecv],&flag,&status) ; 
-			  
-			  // MPI_Wait(&this->sendRequests_[idxRecv],&status) ; 
-			  // std::cout<<this->myRank_<<" FWD to "<<iProc<<" on tag "<<this->tag_<<std::endl;
+			  // std::cout<<this->myRank_<<" FWD to "<<dests[idxRecv]<<" on tag "<<tag<<std::endl;
         } // for (iProc)
     }	  
 
+  // The buffer is only resized between solves: each tree sends one message
+  // per solve, and waitSendRequest() is called before the next one.
+  template< typename T> 
+    inline Int TreeBcast_slu<T>::packLowPrec(T * locBuffer, Int msgSize){
+		if(this->msgPrec_==SLU_MSG_FULL || sizeof(T)>sizeof(double)) return 0;
+		size_t need = msgSize*sizeof(T)+16;
+		if(this->lowpBuf_.size()<need) this->lowpBuf_.resize(need);
+		return pxgstrs_lowp_pack(this->msgPrec_, locBuffer, msgSize,
+				sizeof(T), &this->lowpBuf_[0]);
+    }
+
   template< typename T> 
     inline void TreeBcast_slu<T>::waitSendRequest(){
-        MPI_Status status;
-		for( Int idxRecv = 0; idxRecv < this->myDests_.size(); ++idxRecv ){
-			  MPI_Wait(&this->sendRequests_[idxRecv],&status) ; 
-        } // for (iProc)
+		// spin, then block or yield, see pxgstrs_waitsome()
+		pxgstrs_waitall(this->myDests_.size(),&this->sendRequests_[0]);
     }	
 	
 	
@@ -193,10 +404,29 @@ namespace SuperLU_ASYNCOMM {
 
   template< typename T> 
     inline void TreeBcast_slu<T>::allocateRequest(){
-        if(this->sendRequests_.size()!=this->GetDestCount()){
-          this->sendRequests_.resize(this->GetDestCount());
+        // keep the persistent requests from a previous solve
+        if((Int)this->sendRequests_.size()!=this->GetDestCount()){
+          this->freeRequest();
+          this->sendRequests_.assign(this->GetDestCount(),MPI_REQUEST_NULL);
         }
-		this->sendRequests_.assign(this->GetDestCount(),MPI_REQUEST_NULL);
+    }
+
+  template< typename T> 
+    inline void TreeBcast_slu<T>::freeRequest(){
+        for( Int i = 0; i < (Int)this->sendRequests_.size(); ++i ){
+          if(this->sendRequests_[i]!=MPI_REQUEST_NULL)
+            MPI_Request_free(&this->sendRequests_[i]);
+        }
+        for( Int j = 0; j < (Int)this->persistOld_.size(); ++j ){
+          std::vector<MPI_Request> & reqs = this->persistOld_[j].reqs;
+          for( Int i = 0; i < (Int)reqs.size(); ++i )
+            if(reqs[i]!=MPI_REQUEST_NULL) MPI_Request_free(&reqs[i]);
+        }
+        this->persistOld_.clear();
+        this->persistBuf_ = NULL;
+        this->persistSize_ = -1;
+        this->persistTag_ = -1;
+        this->persistType_ = MPI_DATATYPE_NULL;
     }
 	
 	
@@ -206,6 +436,7 @@ namespace SuperLU_ASYNCOMM {
 	
   template< typename T> 
     inline void TreeBcast_slu<T>::cleanupBuffers(){
+      this->freeRequest();
       this->recvRequests_.clear();
       this->recvStatuses_.clear();
       this->recvDoneIdx_.clear();
@@ -247,12 +478,11 @@ namespace SuperLU_ASYNCOMM {
     }	
 	
   template< typename T>
-    inline TreeBcast_slu<T> * TreeBcast_slu<T>::Create(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize, double rseed){
-      //get communicator size
-      Int nprocs = 0;
-      MPI_Comm_size(pComm, &nprocs);
+    inline TreeBcast_slu<T> * TreeBcast_slu<T>::Create(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize, double rseed, Int nrhs){
+      BcastShape shape = ChooseBcastShape(rank_cnt-1,
+          (double)msgSize*nrhs*sizeof(T));
 
-      if(nprocs<=FTREE_LIMIT){
+      if(shape==BCAST_FLAT){
 #if ( _DEBUGlevel_ >= 1 ) || defined(REDUCE_VERBOSE)
         statusOFS<<"FLAT TREE USED"<<std::endl;
 #endif
@@ -260,6 +490,18 @@ namespace SuperLU_ASYNCOMM {
         return new FTreeBcast2<T>(pComm,ranks,rank_cnt,msgSize);
 
       }
+      else if(shape==BCAST_CHAIN){
+#if ( _DEBUGlevel_ >= 1 ) || defined(REDUCE_VERBOSE)
+        statusOFS<<"CHAIN USED"<<std::endl;
+#endif
+        return new ChainBcast2<T>(pComm,ranks,rank_cnt,msgSize);
+      }
+      else if(UseNodeTree(pComm,ranks,rank_cnt)){
+#if ( _DEBUGlevel_ >= 1 ) || defined(REDUCE_VERBOSE)
+        statusOFS<<"NODE-AWARE TREE USED"<<std::endl;
+#endif
+        return new NodeTreeBcast2<T>(pComm,ranks,rank_cnt,msgSize);
+      }
       else{
 #if ( _DEBUGlevel_ >= 1 ) || defined(REDUCE_VERBOSE)
         statusOFS<<"BINARY TREE USED"<<std::endl;
@@ -270,6 +512,20 @@ namespace SuperLU_ASYNCOMM {
 
 
 
+  template< typename T>
+    inline TreeBcast_slu<T> * TreeBcast_slu<T>::CreateLocal(const MPI_Comm & pComm, Int root, Int * dests, Int ndest, Int msgSize){
+      Int myRank;
+      MPI_Comm_rank(pComm, &myRank);
+
+      //start from a one-node flat tree and set the local root and destinations
+      TreeBcast_slu<T> * out = new FTreeBcast2<T>(pComm,&myRank,1,msgSize);
+      out->myRoot_ = root;
+      out->mainRoot_ = root;
+      out->myDests_.assign(dests,dests+ndest);
+      return out;
+    }
+
+
   template< typename T>
     inline void FTreeBcast2<T>::buildTree(Int * ranks, Int rank_cnt){
       Int idxStart = 0;
@@ -349,6 +605,31 @@ namespace SuperLU_ASYNCOMM {
 
 
 
+  template< typename T>
+    inline ChainBcast2<T>::ChainBcast2(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize):TreeBcast_slu<T>(pComm,ranks,rank_cnt,msgSize){
+      buildTree(ranks,rank_cnt);
+    }
+
+  template< typename T>
+    inline ChainBcast2<T> * ChainBcast2<T>::clone() const{
+      ChainBcast2<T> * out = new ChainBcast2<T>(*this);
+      return out;
+    }
+
+  template< typename T>
+    inline void ChainBcast2<T>::buildTree(Int * ranks, Int rank_cnt){
+      Int myIdx = 0;
+      for(Int ii=0;ii<rank_cnt;ii++)
+        if(this->myRank_ == ranks[ii]){
+          myIdx = ii;
+          break;
+        }
+      if(myIdx+1<rank_cnt) this->myDests_.push_back(ranks[myIdx+1]);
+      this->myRoot_ = myIdx==0 ? this->myRank_ : ranks[myIdx-1];
+    }
+
+
+
   template< typename T>
     ModBTreeBcast2<T>::ModBTreeBcast2(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize, double rseed):TreeBcast_slu<T>(pComm,ranks,rank_cnt,msgSize){
       //build the binary tree;
@@ -438,6 +719,30 @@ namespace SuperLU_ASYNCOMM {
     }
 
 
+  template< typename T>
+    NodeTreeBcast2<T>::NodeTreeBcast2(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize):TreeBcast_slu<T>(pComm,ranks,rank_cnt,msgSize){
+      buildTree(ranks,rank_cnt);
+    }
+
+  template< typename T>
+    inline NodeTreeBcast2<T> * NodeTreeBcast2<T>::clone() const{
+      NodeTreeBcast2<T> * out = new NodeTreeBcast2<T>(*this);
+      return out;
+    }
+
+  template< typename T>
+    inline void NodeTreeBcast2<T>::buildTree(Int * ranks, Int rank_cnt){
+      BuildNodeTree(*NodeIdsOf(this->comm_),this->myRank_,ranks,rank_cnt,
+                    this->myRoot_,this->myDests_);
+#if (defined(BCAST_VERBOSE))
+      statusOFS<<"My root is "<<this->myRoot_<<std::endl;
+      statusOFS<<"My dests are ";
+      for(Int i =0;i<this->myDests_.size();++i){statusOFS<<this->myDests_[i]<<" ";}
+      statusOFS<<std::endl;
+#endif
+    }
+
+
 } //namespace SuperLU_ASYNCOMM
 
 
@@ -1,27 +1,150 @@
 #include "TreeReduce_slu.hpp"
 #include "dcomplex.h"
+#include "scomplex.h"
 
 namespace SuperLU_ASYNCOMM{
 	
-	
+	std::map< MPI_Comm , std::vector<Int> > commNodeIds;
+	std::mutex commNodeIdsLock;
 	
 #ifdef __cplusplus
 	extern "C" {
 #endif
 
+	/* Record the node of each rank of comm, so that BcTree_Create() and
+	   RdTree_Create() can build node-aware trees. Collective over comm.
+	   The nodes are found with MPI_Comm_split_type(MPI_COMM_TYPE_SHARED);
+	   SUPERLU_RANKS_PER_NODE=k instead puts k consecutive ranks on each
+	   node, and SUPERLU_NODE_TREE=0 turns the node-aware trees off. */
+	void TreeNodeMap_Create(MPI_Comm comm){
+		int rank, nprocs, node, k;
+		char *ttemp;
+
+		ttemp = getenv("SUPERLU_NODE_TREE");
+		if(ttemp && !atoi(ttemp)) return;
+
+		MPI_Comm_rank(comm, &rank);
+		MPI_Comm_size(comm, &nprocs);
+		ttemp = getenv("SUPERLU_RANKS_PER_NODE");
+		if(ttemp && (k = atoi(ttemp)) > 0){
+			node = rank / k;
+		}else{
+#if MPI_VERSION >= 3
+			MPI_Comm shmcomm;
+			/* a node is named by its lowest rank */
+			MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &shmcomm);
+			node = rank;
+			MPI_Bcast(&node, 1, MPI_INT, 0, shmcomm);
+			MPI_Comm_free(&shmcomm);
+#else
+			return;
+#endif
+		}
+
+		std::vector<Int> nodeOf(nprocs);
+		MPI_Allgather(&node, 1, MPI_INT, &nodeOf[0], 1, MPI_INT, comm);
+		std::lock_guard<std::mutex> lock(commNodeIdsLock);
+		commNodeIds[comm].swap(nodeOf);
+	}
+
+	void TreeNodeMap_Destroy(MPI_Comm comm){
+		std::lock_guard<std::mutex> lock(commNodeIdsLock);
+		commNodeIds.erase(comm);
+	}
+
 	BcTree BcTree_Create(MPI_Comm comm, Int* ranks, Int rank_cnt, Int msgSize, double rseed, char precision){
+		return BcTree_CreateNrhs(comm, ranks, rank_cnt, msgSize, 1, rseed, precision);
+	}
+
+	/* As BcTree_Create(), with the shape of the tree chosen for messages
+	   of nrhs right-hand sides of msgSize entries each. */
+	BcTree BcTree_CreateNrhs(MPI_Comm comm, Int* ranks, Int rank_cnt, Int msgSize, Int nrhs, double rseed, char precision){
 		assert(msgSize>0);
+		if(precision=='s'){
+			TreeBcast_slu<float>* BcastTree = TreeBcast_slu<float>::Create(comm,ranks,rank_cnt,msgSize,rseed,nrhs);
+			return (BcTree) BcastTree;
+		}
 		if(precision=='d'){
-			TreeBcast_slu<double>* BcastTree = TreeBcast_slu<double>::Create(comm,ranks,rank_cnt,msgSize,rseed);
+			TreeBcast_slu<double>* BcastTree = TreeBcast_slu<double>::Create(comm,ranks,rank_cnt,msgSize,rseed,nrhs);
 			return (BcTree) BcastTree;
 		}
 		if(precision=='z'){
-			TreeBcast_slu<doublecomplex>* BcastTree = TreeBcast_slu<doublecomplex>::Create(comm,ranks,rank_cnt,msgSize,rseed);		
+			TreeBcast_slu<doublecomplex>* BcastTree = TreeBcast_slu<doublecomplex>::Create(comm,ranks,rank_cnt,msgSize,rseed,nrhs);		
+			return (BcTree) BcastTree;
+		}
+		if(precision=='c'){
+			TreeBcast_slu<singlecomplex>* BcastTree = TreeBcast_slu<singlecomplex>::Create(comm,ranks,rank_cnt,msgSize,rseed,nrhs);		
 			return (BcTree) BcastTree;
 		}
+		return NULL; /* unknown precision */
+	}
+
+	BcTree BcTree_CreateLocal(MPI_Comm comm, Int root, Int* dests, Int ndest, Int msgSize, char precision){
+		assert(msgSize>0);
+		if(precision=='s'){
+			TreeBcast_slu<float>* BcastTree = TreeBcast_slu<float>::CreateLocal(comm,root,dests,ndest,msgSize);
+			return (BcTree) BcastTree;
+		}
+		if(precision=='d'){
+			TreeBcast_slu<double>* BcastTree = TreeBcast_slu<double>::CreateLocal(comm,root,dests,ndest,msgSize);
+			return (BcTree) BcastTree;
+		}
+		if(precision=='z'){
+			TreeBcast_slu<doublecomplex>* BcastTree = TreeBcast_slu<doublecomplex>::CreateLocal(comm,root,dests,ndest,msgSize);
+			return (BcTree) BcastTree;
+		}
+		if(precision=='c'){
+			TreeBcast_slu<singlecomplex>* BcastTree = TreeBcast_slu<singlecomplex>::CreateLocal(comm,root,dests,ndest,msgSize);
+			return (BcTree) BcastTree;
+		}
+		return NULL; /* unknown precision */
+	}
+
+	int BcTree_GetRoot(BcTree Tree, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		return BcastTree->GetRoot();
+		}
+		if(precision=='d'){
+		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
+		return BcastTree->GetRoot();
+		}
+		if(precision=='z'){
+		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
+		return BcastTree->GetRoot();
+		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		return BcastTree->GetRoot();
+		}
+		return -1; /* unknown precision */
+	}
+
+	int BcTree_GetDest(BcTree Tree, Int i, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		return BcastTree->GetDest(i);
+		}
+		if(precision=='d'){
+		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
+		return BcastTree->GetDest(i);
+		}
+		if(precision=='z'){
+		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
+		return BcastTree->GetDest(i);
+		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		return BcastTree->GetDest(i);
+		}
+		return -1; /* unknown precision */
 	}
 
 	void BcTree_Destroy(BcTree Tree, char precision){
+		if(precision=='s'){
+			TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+			delete BcastTree; 
+		}
 		if(precision=='d'){
 			TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
 			delete BcastTree; 
@@ -30,10 +153,18 @@ namespace SuperLU_ASYNCOMM{
 			TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
 			delete BcastTree; 
 		}
+		if(precision=='c'){
+			TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+			delete BcastTree; 
+		}
 
 	}		
 	
 	void BcTree_SetTag(BcTree Tree, Int tag, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		BcastTree->SetTag(tag); 
+		}
 		if(precision=='d'){
 		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
 		BcastTree->SetTag(tag); 
@@ -42,10 +173,18 @@ namespace SuperLU_ASYNCOMM{
 		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
 		BcastTree->SetTag(tag); 
 		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		BcastTree->SetTag(tag); 
+		}
 	}
 
 
 	yes_no_t BcTree_IsRoot(BcTree Tree, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		return BcastTree->IsRoot()?YES:NO;
+		}
 		if(precision=='d'){
 		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
 		return BcastTree->IsRoot()?YES:NO;
@@ -54,10 +193,19 @@ namespace SuperLU_ASYNCOMM{
 		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
 		return BcastTree->IsRoot()?YES:NO;
 		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		return BcastTree->IsRoot()?YES:NO;
+		}
+		return NO; /* unknown precision */
 	}
 
 	
 	void BcTree_forwardMessageSimple(BcTree Tree, void* localBuffer, Int msgSize, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		BcastTree->forwardMessageSimple((float*)localBuffer,msgSize);	
+		}
 		if(precision=='d'){
 		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
 		BcastTree->forwardMessageSimple((double*)localBuffer,msgSize);	
@@ -65,10 +213,18 @@ namespace SuperLU_ASYNCOMM{
 		if(precision=='z'){
 		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
 		BcastTree->forwardMessageSimple((doublecomplex*)localBuffer,msgSize);	
+		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		BcastTree->forwardMessageSimple((singlecomplex*)localBuffer,msgSize);	
 		}	
 	}
 
 	void BcTree_waitSendRequest(BcTree Tree, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		BcastTree->waitSendRequest();		
+		}
 		if(precision=='d'){
 		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
 		BcastTree->waitSendRequest();		
@@ -77,11 +233,57 @@ namespace SuperLU_ASYNCOMM{
 		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
 		BcastTree->waitSendRequest();		
 		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		BcastTree->waitSendRequest();		
+		}
 	}
 	
 	
 	
+	void BcTree_SetAggregator(BcTree Tree, pxgstrs_agg_t *agg, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		BcastTree->SetAggregator(agg);
+		}
+		if(precision=='d'){
+		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
+		BcastTree->SetAggregator(agg);
+		}
+		if(precision=='z'){
+		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
+		BcastTree->SetAggregator(agg);
+		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		BcastTree->SetAggregator(agg);
+		}
+	}
+
+	void BcTree_SetMsgPrec(BcTree Tree, int prec, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		BcastTree->SetMsgPrec(prec);
+		}
+		if(precision=='d'){
+		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
+		BcastTree->SetMsgPrec(prec);
+		}
+		if(precision=='z'){
+		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
+		BcastTree->SetMsgPrec(prec);
+		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		BcastTree->SetMsgPrec(prec);
+		}
+	}
+
 	void BcTree_allocateRequest(BcTree Tree, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		BcastTree->allocateRequest();
+		}
 		if(precision=='d'){
 		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
 		BcastTree->allocateRequest();
@@ -89,10 +291,18 @@ namespace SuperLU_ASYNCOMM{
 		if(precision=='z'){
 		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
 		BcastTree->allocateRequest();
+		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		BcastTree->allocateRequest();
 		}			
 	}	
 	
 	int BcTree_getDestCount(BcTree Tree, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		return BcastTree->GetDestCount();					
+		}
 		if(precision=='d'){
 		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
 		return BcastTree->GetDestCount();					
@@ -101,9 +311,18 @@ namespace SuperLU_ASYNCOMM{
 		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
 		return BcastTree->GetDestCount();					
 		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		return BcastTree->GetDestCount();					
+		}
+		return -1; /* unknown precision */
 	}	
 
 	int BcTree_GetMsgSize(BcTree Tree, char precision){
+		if(precision=='s'){
+		TreeBcast_slu<float>* BcastTree = (TreeBcast_slu<float>*) Tree;
+		return BcastTree->GetMsgSize();					
+		}
 		if(precision=='d'){
 		TreeBcast_slu<double>* BcastTree = (TreeBcast_slu<double>*) Tree;
 		return BcastTree->GetMsgSize();					
@@ -112,6 +331,11 @@ namespace SuperLU_ASYNCOMM{
 		TreeBcast_slu<doublecomplex>* BcastTree = (TreeBcast_slu<doublecomplex>*) Tree;
 		return BcastTree->GetMsgSize();					
 		}
+		if(precision=='c'){
+		TreeBcast_slu<singlecomplex>* BcastTree = (TreeBcast_slu<singlecomplex>*) Tree;
+		return BcastTree->GetMsgSize();					
+		}
+		return -1; /* unknown precision */
 	}		
 	
 
@@ -162,6 +386,10 @@ namespace SuperLU_ASYNCOMM{
 
 	RdTree RdTree_Create(MPI_Comm comm, Int* ranks, Int rank_cnt, Int msgSize, double rseed, char precision){
 		assert(msgSize>0);
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = TreeReduce_slu<float>::Create(comm,ranks,rank_cnt,msgSize,rseed);
+		return (RdTree) ReduceTree;
+		}
 		if(precision=='d'){
 		TreeReduce_slu<double>* ReduceTree = TreeReduce_slu<double>::Create(comm,ranks,rank_cnt,msgSize,rseed);
 		return (RdTree) ReduceTree;
@@ -170,9 +398,79 @@ namespace SuperLU_ASYNCOMM{
 		TreeReduce_slu<doublecomplex>* ReduceTree = TreeReduce_slu<doublecomplex>::Create(comm,ranks,rank_cnt,msgSize,rseed);
 		return (RdTree) ReduceTree;
 		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = TreeReduce_slu<singlecomplex>::Create(comm,ranks,rank_cnt,msgSize,rseed);
+		return (RdTree) ReduceTree;
+		}
+		return NULL; /* unknown precision */
 	}
 	
+	RdTree RdTree_CreateLocal(MPI_Comm comm, Int root, Int* dests, Int ndest, Int msgSize, char precision){
+		assert(msgSize>0);
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = TreeReduce_slu<float>::CreateLocal(comm,root,dests,ndest,msgSize);
+		return (RdTree) ReduceTree;
+		}
+		if(precision=='d'){
+		TreeReduce_slu<double>* ReduceTree = TreeReduce_slu<double>::CreateLocal(comm,root,dests,ndest,msgSize);
+		return (RdTree) ReduceTree;
+		}
+		if(precision=='z'){
+		TreeReduce_slu<doublecomplex>* ReduceTree = TreeReduce_slu<doublecomplex>::CreateLocal(comm,root,dests,ndest,msgSize);
+		return (RdTree) ReduceTree;
+		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = TreeReduce_slu<singlecomplex>::CreateLocal(comm,root,dests,ndest,msgSize);
+		return (RdTree) ReduceTree;
+		}
+		return NULL; /* unknown precision */
+	}
+
+	int RdTree_GetRoot(RdTree Tree, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		return ReduceTree->GetRoot();
+		}
+		if(precision=='d'){
+		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
+		return ReduceTree->GetRoot();
+		}
+		if(precision=='z'){
+		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
+		return ReduceTree->GetRoot();
+		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		return ReduceTree->GetRoot();
+		}
+		return -1; /* unknown precision */
+	}
+
+	int RdTree_GetDest(RdTree Tree, Int i, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		return ReduceTree->GetDest(i);
+		}
+		if(precision=='d'){
+		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
+		return ReduceTree->GetDest(i);
+		}
+		if(precision=='z'){
+		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
+		return ReduceTree->GetDest(i);
+		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		return ReduceTree->GetDest(i);
+		}
+		return -1; /* unknown precision */
+	}
+
 	void RdTree_Destroy(RdTree Tree, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		delete ReduceTree; 
+		}
 		if(precision=='d'){
 		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
 		delete ReduceTree; 
@@ -180,11 +478,19 @@ namespace SuperLU_ASYNCOMM{
 		if(precision=='z'){
 		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
 		delete ReduceTree;
+		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		delete ReduceTree;
 		}		
 	}	
 	
 
 	void RdTree_SetTag(RdTree Tree, Int tag, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		ReduceTree->SetTag(tag); 		
+		}
 		if(precision=='d'){
 		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
 		ReduceTree->SetTag(tag); 		
@@ -193,9 +499,17 @@ namespace SuperLU_ASYNCOMM{
 		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
 		ReduceTree->SetTag(tag); 
 		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		ReduceTree->SetTag(tag); 
+		}
 	}
 
 	int  RdTree_GetDestCount(RdTree Tree, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		return ReduceTree->GetDestCount();		
+		}
 		if(precision=='d'){
 		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
 		return ReduceTree->GetDestCount();		
@@ -204,9 +518,18 @@ namespace SuperLU_ASYNCOMM{
 		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
 		return ReduceTree->GetDestCount();		
 		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		return ReduceTree->GetDestCount();		
+		}
+		return -1; /* unknown precision */
 	}	
 	
 	int  RdTree_GetMsgSize(RdTree Tree, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		return ReduceTree->GetMsgSize();		
+		}
 		if(precision=='d'){
 		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
 		return ReduceTree->GetMsgSize();		
@@ -215,11 +538,20 @@ namespace SuperLU_ASYNCOMM{
 		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
 		return ReduceTree->GetMsgSize();		
 		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		return ReduceTree->GetMsgSize();		
+		}
+		return -1; /* unknown precision */
 	}		
 	
 	
 
 	yes_no_t RdTree_IsRoot(RdTree Tree, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		return ReduceTree->IsRoot()?YES:NO;
+		}
 		if(precision=='d'){
 		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
 		return ReduceTree->IsRoot()?YES:NO;
@@ -228,10 +560,19 @@ namespace SuperLU_ASYNCOMM{
 		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
 		return ReduceTree->IsRoot()?YES:NO;
 		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		return ReduceTree->IsRoot()?YES:NO;
+		}
+		return NO; /* unknown precision */
 	}
 
 
 	void RdTree_forwardMessageSimple(RdTree Tree, void* localBuffer, Int msgSize, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		ReduceTree->forwardMessageSimple((float*)localBuffer,msgSize);	
+		}
 		if(precision=='d'){
 		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
 		ReduceTree->forwardMessageSimple((double*)localBuffer,msgSize);	
@@ -239,8 +580,53 @@ namespace SuperLU_ASYNCOMM{
 		if(precision=='z'){TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
 		ReduceTree->forwardMessageSimple((doublecomplex*)localBuffer,msgSize);	
 		}
+		if(precision=='c'){TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		ReduceTree->forwardMessageSimple((singlecomplex*)localBuffer,msgSize);	
+		}
+	}
+	void RdTree_SetAggregator(RdTree Tree, pxgstrs_agg_t *agg, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		ReduceTree->SetAggregator(agg);
+		}
+		if(precision=='d'){
+		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
+		ReduceTree->SetAggregator(agg);
+		}
+		if(precision=='z'){
+		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
+		ReduceTree->SetAggregator(agg);
+		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		ReduceTree->SetAggregator(agg);
+		}
 	}
+
+	void RdTree_SetMsgPrec(RdTree Tree, int prec, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		ReduceTree->SetMsgPrec(prec);
+		}
+		if(precision=='d'){
+		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
+		ReduceTree->SetMsgPrec(prec);
+		}
+		if(precision=='z'){
+		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
+		ReduceTree->SetMsgPrec(prec);
+		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		ReduceTree->SetMsgPrec(prec);
+		}
+	}
+
 	void RdTree_allocateRequest(RdTree Tree, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		ReduceTree->allocateRequest();
+		}
 		if(precision=='d'){
 		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
 		ReduceTree->allocateRequest();
@@ -249,10 +635,18 @@ namespace SuperLU_ASYNCOMM{
 		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
 		ReduceTree->allocateRequest();		
 		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		ReduceTree->allocateRequest();		
+		}
 		
 	}
 
 	void RdTree_waitSendRequest(RdTree Tree, char precision){
+		if(precision=='s'){
+		TreeReduce_slu<float>* ReduceTree = (TreeReduce_slu<float>*) Tree;
+		ReduceTree->waitSendRequest();			
+		}
 		if(precision=='d'){
 		TreeReduce_slu<double>* ReduceTree = (TreeReduce_slu<double>*) Tree;
 		ReduceTree->waitSendRequest();			
@@ -260,6 +654,10 @@ namespace SuperLU_ASYNCOMM{
 		if(precision=='z'){
 		TreeReduce_slu<doublecomplex>* ReduceTree = (TreeReduce_slu<doublecomplex>*) Tree;
 		ReduceTree->waitSendRequest();	
+		}
+		if(precision=='c'){
+		TreeReduce_slu<singlecomplex>* ReduceTree = (TreeReduce_slu<singlecomplex>*) Tree;
+		ReduceTree->waitSendRequest();	
 		}		
 	}
 	
@@ -22,6 +22,7 @@ namespace SuperLU_ASYNCOMM{
 
       public:
         static TreeReduce_slu<T> * Create(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize,double rseed);
+        static TreeReduce_slu<T> * CreateLocal(const MPI_Comm & pComm, Int root, Int * dests, Int ndest, Int msgSize);
 
         TreeReduce_slu();
         TreeReduce_slu(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize);
@@ -87,6 +88,17 @@ public:
 
 };
 
+template< typename T>
+class NodeTreeReduce_slu: public TreeReduce_slu<T>{
+protected:
+  virtual void buildTree(Int * ranks, Int rank_cnt);
+
+public:
+  NodeTreeReduce_slu(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize);
+  virtual NodeTreeReduce_slu<T> * clone() const;
+
+};
+
 }//namespace SuperLU_ASYNCOMM
 
 #include "TreeReduce_slu_impl.hpp"
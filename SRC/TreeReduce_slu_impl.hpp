@@ -42,20 +42,22 @@ namespace SuperLU_ASYNCOMM {
 	
   template< typename T> 
     inline void TreeReduce_slu<T>::forwardMessageSimple(T * locBuffer, Int msgSize){
-        MPI_Status status;
-		Int flag;
 		if(this->myRank_!=this->myRoot_){
 			// if(this->recvCount_== this->GetDestCount()){		
 			  //forward to my root if I have reseived everything
 			  Int iProc = this->myRoot_;
-			  // Use Isend to send to multiple targets
-
-			  Int error_code = MPI_Isend(locBuffer, msgSize, this->type_, 
-				  iProc, this->tag_,this->comm_, &this->sendRequests_[0] );
-				  
-				  MPI_Test(&this->sendRequests_[0],&flag,&status) ; 
-				  
-				  // std::cout<<this->myRank_<<" FWD to "<<iProc<<" on tag "<<this->tag_<<std::endl;
+			  if(this->agg_ && pxgstrs_agg_put(this->agg_, iProc, this->tag_,
+					  locBuffer, msgSize*sizeof(T))) return;
+			  // Persistent send to my root, kept for each buffer, size, tag
+			  // and datatype, see startSend(); a large message may go in
+			  // reduced precision
+			  Int bytes = this->packLowPrec(locBuffer, msgSize);
+			  if(bytes)
+				  this->startSend(&this->lowpBuf_[0], bytes, MPI_BYTE, this->tag_+SOL_LOWP,
+					  &iProc, 1);
+			  else
+				  this->startSend(locBuffer, msgSize, this->type_, this->tag_,
+					  &iProc, 1);
 				  
 				 // MPI_Wait(&this->sendRequests_[0],&status) ; 
 				  
@@ -67,18 +69,17 @@ namespace SuperLU_ASYNCOMM {
 
   template< typename T> 
     inline void TreeReduce_slu<T>::allocateRequest(){
+        // keep the persistent request from a previous solve
         if(this->sendRequests_.size()==0){
-          this->sendRequests_.resize(1);
+          this->sendRequests_.assign(1,MPI_REQUEST_NULL);
         }
-		this->sendRequests_.assign(1,MPI_REQUEST_NULL);
     }
 		
 	
   template< typename T> 
     inline void TreeReduce_slu<T>::waitSendRequest(){
-        MPI_Status status;		
         if(this->sendRequests_.size()>0){
-		  MPI_Wait(&this->sendRequests_[0],&status) ; 
+		  pxgstrs_waitall(1,&this->sendRequests_[0]);
         }	
 	}	
 
@@ -98,13 +99,20 @@ namespace SuperLU_ASYNCOMM {
     }
 
 
+  // The contributions of the ranks that share a node are combined at the
+  // node leader before one message crosses the network, whatever the size
+  // of pComm: intra-node messages go through the shared memory of the MPI
+  // library, so only the inter-node ones are costly. Otherwise the tree is
+  // flat up to FTREE_LIMIT contributors and binary beyond.
   template< typename T>
     inline TreeReduce_slu<T> * TreeReduce_slu<T>::Create(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize, double rseed){
-      //get communicator size
-      Int nprocs = 0;
-      MPI_Comm_size(pComm, &nprocs);
-
-      if(nprocs<=FTREE_LIMIT){
+      if(UseNodeTree(pComm,ranks,rank_cnt)){
+#if ( _DEBUGlevel_ >= 1 ) || defined(REDUCE_VERBOSE)
+        statusOFS<<"NODE-AWARE TREE USED"<<std::endl;
+#endif
+        return new NodeTreeReduce_slu<T>(pComm,ranks,rank_cnt,msgSize);
+      }
+      else if(rank_cnt-1<=FTREE_LIMIT){
 #if ( _DEBUGlevel_ >= 1 ) || defined(REDUCE_VERBOSE)
         statusOFS<<"FLAT TREE USED"<<std::endl;
 #endif
@@ -119,6 +127,18 @@ namespace SuperLU_ASYNCOMM {
       }
     }
 
+  template< typename T>
+    inline TreeReduce_slu<T> * TreeReduce_slu<T>::CreateLocal(const MPI_Comm & pComm, Int root, Int * dests, Int ndest, Int msgSize){
+      Int myRank;
+      MPI_Comm_rank(pComm, &myRank);
+
+      TreeReduce_slu<T> * out = new FTreeReduce_slu<T>(pComm,&myRank,1,msgSize);
+      out->myRoot_ = root;
+      out->mainRoot_ = root;
+      out->myDests_.assign(dests,dests+ndest);
+      return out;
+    }
+
   template< typename T>
     FTreeReduce_slu<T>::FTreeReduce_slu(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize):TreeReduce_slu<T>(pComm, ranks, rank_cnt, msgSize){
       buildTree(ranks,rank_cnt);
@@ -303,5 +323,29 @@ namespace SuperLU_ASYNCOMM {
 #endif
     }
 
+  template< typename T>
+    NodeTreeReduce_slu<T>::NodeTreeReduce_slu(const MPI_Comm & pComm, Int * ranks, Int rank_cnt, Int msgSize):TreeReduce_slu<T>(pComm, ranks, rank_cnt, msgSize){
+      buildTree(ranks,rank_cnt);
+    }
+
+  template< typename T>
+    inline NodeTreeReduce_slu<T> * NodeTreeReduce_slu<T>::clone() const{
+      NodeTreeReduce_slu<T> * out = new NodeTreeReduce_slu<T>(*this);
+      return out;
+    }
+
+  template< typename T>
+    inline void NodeTreeReduce_slu<T>::buildTree(Int * ranks, Int rank_cnt){
+      // the messages flow towards ranks[0] along the broadcast tree
+      BuildNodeTree(*NodeIdsOf(this->comm_),this->myRank_,ranks,rank_cnt,
+                    this->myRoot_,this->myDests_);
+#if (defined(REDUCE_VERBOSE))
+      statusOFS<<"My root is "<<this->myRoot_<<std::endl;
+      statusOFS<<"My dests are ";
+      for(Int i =0;i<this->myDests_.size();++i){statusOFS<<this->myDests_[i]<<" ";}
+      statusOFS<<std::endl;
+#endif
+    }
+
 } //namespace SuperLU_ASYNCOMM
 #endif
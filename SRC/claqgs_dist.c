@@ -0,0 +1,145 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required 
+approvals from U.S. Dept. of Energy) 
+
+All rights reserved. 
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Equilibrates a general sparse M by N matrix A
+ */
+
+/*
+ * File name:	claqgs.c
+ * History:     Modified from LAPACK routine CLAQGE
+ */
+#include <math.h>
+#include "superlu_cdefs.h"
+
+/*! \brief
+
+<pre>
+    Purpose   
+    =======   
+
+    CLAQGS_DIST equilibrates a general sparse M by N matrix A using the row
+    and column scaling factors in the vectors R and C.   
+
+    See supermatrix.h for the definition of 'SuperMatrix' structure.
+
+    Arguments   
+    =========   
+
+    A       (input/output) SuperMatrix*
+            On exit, the equilibrated matrix.  See EQUED for the form of 
+            the equilibrated matrix. The type of A can be:
+	    Stype = SLU_NC; Dtype = SLU_C; Mtype = SLU_GE.
+	    
+    R       (input) float*, dimension (A->nrow)
+            The row scale factors for A.
+	    
+    C       (input) float*, dimension (A->ncol)
+            The column scale factors for A.
+	    
+    ROWCND  (input) float
+            Ratio of the smallest R(i) to the largest R(i).
+	    
+    COLCND  (input) float
+            Ratio of the smallest C(i) to the largest C(i).
+	    
+    AMAX    (input) float
+            Absolute value of largest matrix entry.
+	    
+    EQUED   (output) char*
+            Specifies the form of equilibration that was done.   
+            = 'N':  No equilibration   
+            = 'R':  Row equilibration, i.e., A has been premultiplied by  
+                    diag(R).   
+            = 'C':  Column equilibration, i.e., A has been postmultiplied  
+                    by diag(C).   
+            = 'B':  Both row and column equilibration, i.e., A has been
+                    replaced by diag(R) * A * diag(C).   
+
+    Internal Parameters   
+    ===================   
+
+    THRESH is a threshold value used to decide if row or column scaling   
+    should be done based on the ratio of the row or column scaling   
+    factors.  If ROWCND < THRESH, row scaling is done, and if   
+    COLCND < THRESH, column scaling is done.   
+
+    LARGE and SMALL are threshold values used to decide if row scaling   
+    should be done based on the absolute size of the largest matrix   
+    element.  If AMAX > LARGE or AMAX < SMALL, row scaling is done.   
+
+    ===================================================================== 
+</pre>
+*/
+void
+claqgs_dist(SuperMatrix *A, float *r, float *c, 
+	    float rowcnd, float colcnd, float amax, char *equed)
+{
+#define THRESH    (0.1)
+    
+    /* Local variables */
+    NCformat *Astore;
+    singlecomplex   *Aval;
+    int i, j, irow;
+    float large, small, cj;
+    float temp;
+
+
+    /* Quick return if possible */
+    if (A->nrow <= 0 || A->ncol <= 0) {
+	*(unsigned char *)equed = 'N';
+	return;
+    }
+
+    Astore = (NCformat *) A->Store;
+    Aval = (singlecomplex *) Astore->nzval;
+    
+    /* Initialize LARGE and SMALL. */
+    small = smach_dist("Safe minimum") / smach_dist("Precision");
+    large = 1. / small;
+
+    if (rowcnd >= THRESH && amax >= small && amax <= large) {
+	if (colcnd >= THRESH)
+	    *(unsigned char *)equed = 'N';
+	else {
+	    /* Column scaling */
+	    for (j = 0; j < A->ncol; ++j) {
+		cj = c[j];
+		for (i = Astore->colptr[j]; i < Astore->colptr[j+1]; ++i) {
+		    cs_mult(&Aval[i], &Aval[i], cj);
+                }
+	    }
+	    *(unsigned char *)equed = 'C';
+	}
+    } else if (colcnd >= THRESH) {
+	/* Row scaling, no column scaling */
+	for (j = 0; j < A->ncol; ++j)
+	    for (i = Astore->colptr[j]; i < Astore->colptr[j+1]; ++i) {
+		irow = Astore->rowind[i];
+		cs_mult(&Aval[i], &Aval[i], r[irow]);
+	    }
+	*(unsigned char *)equed = 'R';
+    } else {
+	/* Row and column scaling */
+	for (j = 0; j < A->ncol; ++j) {
+	    cj = c[j];
+	    for (i = Astore->colptr[j]; i < Astore->colptr[j+1]; ++i) {
+		irow = Astore->rowind[i];
+		temp = cj * r[irow];
+		cs_mult(&Aval[i], &Aval[i], temp);
+	    }
+	}
+	*(unsigned char *)equed = 'B';
+    }
+
+    return;
+
+} /* claqgs_dist */
+
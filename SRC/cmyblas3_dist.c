@@ -0,0 +1,131 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Complex matrix product by three real matrix products
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "superlu_cdefs.h"
+
+#ifdef USE_VENDOR_BLAS
+extern void sgemm_(const char*, const char*, const int*, const int*,
+		   const int*, const float*, const float*, const int*,
+		   const float*, const int*, const float*, float*,
+		   const int*, int, int);
+#else
+extern int sgemm_(const char*, const char*, const int*, const int*,
+		  const int*, const float*, const float*, const int*,
+		  const float*, const int*, const float*, float*,
+		  const int*);
+#endif
+
+/* The smallest m, n and k for which cgemm_3m() is used. */
+#define CGEMM_3M_MIN 128
+
+/* The real part of X in Xr, its imaginary part in Xi and their sum in
+   Xs, all of leading dimension m. */
+static void
+csplit_dist(int m, int n, const singlecomplex *X, int ldx,
+	    float *Xr, float *Xi, float *Xs)
+{
+    int i, j;
+
+    for (j = 0; j < n; ++j) {
+	const singlecomplex *x = &X[(size_t) j * ldx];
+	float *xr = &Xr[(size_t) j * m], *xi = &Xi[(size_t) j * m];
+	float *xs = &Xs[(size_t) j * m];
+	for (i = 0; i < m; ++i) {
+	    xr[i] = x[i].r;
+	    xi[i] = x[i].i;
+	    xs[i] = x[i].r + x[i].i;
+	}
+    }
+}
+
+static void
+sgemm_nn_dist(int m, int n, int k, const float *A, const float *B,
+	      float *C)
+{
+    float one = 1.0, zero = 0.0;
+#if defined (USE_VENDOR_BLAS)
+    sgemm_("N", "N", &m, &n, &k, &one, A, &m, B, &k, &zero, C, &m, 1, 1);
+#else
+    sgemm_("N", "N", &m, &n, &k, &one, A, &m, B, &k, &zero, C, &m);
+#endif
+}
+
+/*! \brief Compute C = A * B by three real matrix products.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * With A = Ar + i*Ai and B = Br + i*Bi, the products
+ *
+ *     T1 = Ar * Br,   T2 = Ai * Bi,   T3 = (Ar + Ai) * (Br + Bi)
+ *
+ * give C = (T1 - T2) + i*(T3 - T1 - T2): 3 real GEMMs, 6mnk flops,
+ * instead of the 8mnk of CGEMM, on operands split into their real and
+ * imaginary parts, which the real kernels stream without the shuffles of
+ * the interleaved complex ones. The imaginary part has an error bound
+ * in |Ar|+|Ai| and |Br|+|Bi| instead of |A| and |B|, so that it may lose
+ * a few digits when its entries are much smaller than those of the real
+ * part.
+ *
+ * The split copies cost O(mk + kn + mn) and a workspace of
+ * 3(mk + kn + mn) doubles, so only products with m, n and k at least
+ * CGEMM_3M_MIN are computed; for the others, or if the workspace cannot
+ * be allocated, nothing is done and 0 is returned, so that the caller
+ * uses CGEMM. A is m-by-k, B is k-by-n and C is m-by-n, all column major.
+ * </pre>
+ */
+int
+cgemm_3m(int m, int n, int k, singlecomplex *A, int lda,
+	 singlecomplex *B, int ldb, singlecomplex *C, int ldc)
+{
+    float *work, *Ar, *Ai, *As, *Br, *Bi, *Bs, *T1, *T2, *T3;
+    size_t mk = (size_t) m * k, kn = (size_t) k * n, mn = (size_t) m * n;
+    int i, j;
+
+    if ( m < CGEMM_3M_MIN || n < CGEMM_3M_MIN || k < CGEMM_3M_MIN )
+	return 0;
+    if ( !(work = (float *) SUPERLU_MALLOC(3 * (mk + kn + mn)
+					    * sizeof(float))) )
+	return 0;
+    Ar = work;    Ai = Ar + mk; As = Ai + mk;
+    Br = As + mk; Bi = Br + kn; Bs = Bi + kn;
+    T1 = Bs + kn; T2 = T1 + mn; T3 = T2 + mn;
+
+    csplit_dist(m, k, A, lda, Ar, Ai, As);
+    csplit_dist(k, n, B, ldb, Br, Bi, Bs);
+    sgemm_nn_dist(m, n, k, Ar, Br, T1);
+    sgemm_nn_dist(m, n, k, Ai, Bi, T2);
+    sgemm_nn_dist(m, n, k, As, Bs, T3);
+
+    for (j = 0; j < n; ++j) {
+	singlecomplex *c = &C[(size_t) j * ldc];
+	const float *t1 = &T1[(size_t) j * m], *t2 = &T2[(size_t) j * m];
+	const float *t3 = &T3[(size_t) j * m];
+	for (i = 0; i < m; ++i) {
+	    c[i].r = t1[i] - t2[i];
+	    c[i].i = t3[i] - t1[i] - t2[i];
+	}
+    }
+
+    SUPERLU_FREE(work);
+    return 1;
+}
@@ -80,7 +80,7 @@ bcast_tree(void *buf, int count, MPI_Datatype dtype, int root, int tag,
     MPI_Status status;
 
     if ( scope == COMM_COLUMN ) scp = &grid->cscp;
-    else if ( scope == ROW ) scp = &grid->rscp;
+    else scp = &grid->rscp;
     Np = scp->Np;
     if ( Np < 2 ) return;
     Iam = scp->Iam;
@@ -117,8 +117,165 @@ bcast_tree(void *buf, int count, MPI_Datatype dtype, int root, int tag,
 } /* BCAST_TREE */
 
 
+#define BCAST_SEG_BYTES 65536 /* default of $SUPERLU_BCAST_SEG */
 
+/* Send segment i to the children. */
+static void bcast_tree_forward(superlu_bcast_t *bc, int i)
+{
+    int j, cnt = SUPERLU_MIN(bc->seg, bc->count - i * bc->seg);
+    MPI_Request *sreq = bc->req + bc->nseg + i * bc->ndest;
+
+    for (j = 0; j < bc->ndest; ++j)
+	MPI_Isend(bc->buf + (size_t) i * bc->seg * bc->extent, cnt, bc->dtype,
+		  bc->dest[j], bc->tag, bc->comm, &sreq[j]);
+}
+
+/*! \brief Start a non-blocking broadcast of an array of *dtype* numbers.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Start broadcasting buf[0:count-1] from the process root of scope
+ *   (COMM_COLUMN or COMM_ROW; root is the rank in the scope, as for
+ *   bcast_tree()), and return at once; bcast_tree_test() advances the
+ *   broadcast and bcast_tree_wait() completes it. Unlike bcast_tree(),
+ *   count must be the same on all the processes of the scope.
+ *
+ *   The message is cut into segments of $SUPERLU_BCAST_SEG bytes
+ *   (default 64 KB) that go down the binomial tree of bcast_tree() one
+ *   after the other: a process forwards a segment to its children as
+ *   soon as it has it, so that a long message streams through the tree
+ *   instead of being held whole at each level. The receives of all the
+ *   segments are posted here.
+ *
+ *   If $SUPERLU_BCAST_IBCAST is set to a nonzero value, or if scope is
+ *   COMM_ALL, this is MPI_Ibcast() on the communicator of the scope; the
+ *   broadcasts of a communicator must then be started in the same order on
+ *   all its processes. COMM_ALL is grid->comm, whose point-to-point
+ *   messages are those of the solves.
+ *
+ *   The broadcasts in progress on one communicator must have distinct
+ *   tags.
+ * </pre>
+ */
+void
+bcast_tree_start(void *buf, int count, MPI_Datatype dtype, int root, int tag,
+		 gridinfo_t *grid, int scope, superlu_bcast_t *bc)
+{
+    int Iam, Np, i, d, mydist, size;
+    MPI_Aint lb, extent;
+    char *ttemp;
+    superlu_scope_t *scp;
+
+    if ( scope == COMM_ALL ) {
+	bc->comm = grid->comm;
+	Np = grid->nprow * grid->npcol;
+	Iam = grid->iam;
+    } else {
+	scp = ( scope == COMM_COLUMN ) ? &grid->cscp : &grid->rscp;
+	bc->comm = scp->comm;
+	Np = scp->Np;
+	Iam = scp->Iam;
+    }
+    bc->buf = (char *) buf;
+    bc->count = count;
+    bc->dtype = dtype;
+    bc->tag = tag;
+    bc->nseg = bc->irecv = bc->ndest = bc->ibcast = 0;
+    bc->parent = -1;
+    bc->req = NULL;
+    if ( Np < 2 || count == 0 ) return;
 
+    ttemp = getenv("SUPERLU_BCAST_IBCAST");
+    bc->ibcast = ( scope == COMM_ALL || (ttemp && atoi(ttemp)) );
+#if ( MPI_VERSION < 3 )
+    if ( bc->ibcast ) {
+	MPI_Bcast(buf, count, dtype, root, bc->comm);
+	return;
+    }
+#endif
+    if ( bc->ibcast ) {
+	if ( !(bc->req = (MPI_Request *) SUPERLU_MALLOC(sizeof(MPI_Request))) )
+	    ABORT("Malloc fails for bc->req[].");
+	MPI_Ibcast(buf, count, dtype, root, bc->comm, bc->req);
+	bc->nseg = 1;
+	return;
+    }
+
+    /* The tree of bcast_tree(): the process at distance mydist from the
+       root receives from mydist - i, i its lowest bit, and sends to
+       mydist + i/2, mydist + i/4, ..., mydist + 1. */
+    mydist = (Np + Iam - root) % Np;
+    for (i = 1; i < Np; i *= 2);
+    if ( mydist ) {
+	for (i = 1; !(mydist & i); i *= 2);
+	bc->parent = (root + mydist - i) % Np;
+    }
+    for (i /= 2; i > 0; i /= 2) {
+	d = mydist + i;
+	if ( d < Np ) bc->dest[bc->ndest++] = (root + d) % Np;
+    }
+
+    ttemp = getenv("SUPERLU_BCAST_SEG");
+    MPI_Type_size(dtype, &size);
+    MPI_Type_get_extent(dtype, &lb, &extent);
+    bc->extent = extent;
+    bc->seg = ( ttemp && atoi(ttemp) > 0 ) ? atoi(ttemp) : BCAST_SEG_BYTES;
+    bc->seg = SUPERLU_MAX(1, bc->seg / SUPERLU_MAX(1, size));
+    bc->nseg = (count + bc->seg - 1) / bc->seg;
+    if ( !(bc->req = (MPI_Request *)
+	   SUPERLU_MALLOC(bc->nseg * (bc->ndest + 1) * sizeof(MPI_Request))) )
+	ABORT("Malloc fails for bc->req[].");
+    for (i = 0; i < bc->nseg * (bc->ndest + 1); ++i)
+	bc->req[i] = MPI_REQUEST_NULL;
+
+    if ( bc->parent < 0 ) {
+	/* The root sends segment by segment, to all its children. */
+	for (i = 0; i < bc->nseg; ++i) bcast_tree_forward(bc, i);
+	bc->irecv = bc->nseg;
+    } else {
+	for (i = 0; i < bc->nseg; ++i)
+	    MPI_Irecv(bc->buf + (size_t) i * bc->seg * bc->extent,
+		      SUPERLU_MIN(bc->seg, count - i * bc->seg), dtype,
+		      bc->parent, tag, bc->comm, &bc->req[i]);
+    }
+}
 
+/*! \brief Advance a broadcast started by bcast_tree_start(): forward the
+ *         segments received. Returns 1 if all of buf has been received.
+ */
+int
+bcast_tree_test(superlu_bcast_t *bc)
+{
+    int flag;
 
+    if ( bc->ibcast ) {
+	if ( bc->req ) MPI_Test(bc->req, &flag, MPI_STATUS_IGNORE);
+	return !bc->req || bc->req[0] == MPI_REQUEST_NULL;
+    }
+    while ( bc->irecv < bc->nseg ) {
+	MPI_Test(&bc->req[bc->irecv], &flag, MPI_STATUS_IGNORE);
+	if ( !flag ) return 0;
+	bcast_tree_forward(bc, bc->irecv++);
+    }
+    return 1;
+}
 
+/*! \brief Complete a broadcast started by bcast_tree_start(): buf is
+ *         received, and the sends from it are done.
+ */
+void
+bcast_tree_wait(superlu_bcast_t *bc)
+{
+    if ( !bc->req ) return;
+    if ( !bc->ibcast ) {
+	while ( bc->irecv < bc->nseg ) {
+	    MPI_Wait(&bc->req[bc->irecv], MPI_STATUS_IGNORE);
+	    bcast_tree_forward(bc, bc->irecv++);
+	}
+    }
+    MPI_Waitall(bc->nseg * (bc->ibcast ? 1 : bc->ndest + 1), bc->req,
+		MPI_STATUSES_IGNORE);
+    SUPERLU_FREE(bc->req);
+    bc->req = NULL;
+}
@@ -28,6 +28,8 @@ at the top-level directory.
  *   - Padding zeros for nice dimensions of GEMM.
  *
  *  June 1, 2018  add parallel AWPM pivoting; add back arrive_at_ublock()
+ *
+ *  The tiles of the Schur complement update are scheduled largest first.
  */
 
 #define SCHEDULE_STRATEGY guided
@@ -69,6 +71,13 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	 ib = lsub[lptr];            /* Block number of L(i,k). */
 	 temp_nbrow = lsub[lptr+1];  /* Number of full rows. */
 
+	 if ( SN_CLEAN(ib) ) { /* L(i,k) updates no dirty panel */
+	     cum_nrow += temp_nbrow;
+	     lptr += LB_DESCRIPTOR + temp_nbrow;
+	     luptr += temp_nbrow;
+	     continue;
+	 }
+
 	 int look_up_flag = 1; /* assume ib is outside look-up window */
 	 for (int j = k0+1; j < SUPERLU_MIN (k0 + num_look_aheads+2, nsupers );
 	      ++j) {
@@ -127,6 +136,13 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
      nbrow = Lnbrow + Rnbrow; /* total number of rows in L */
      LookAheadRowSepMOP += 2*knsupc*(nbrow);
 
+     /* With options->MemBudget, U(k,:) may be updated by chunks of
+	blocks jj0:nub-1 of at most u_chunk nonzero columns, which bound
+	bigU and bigV (see dmem_budget()). Otherwise there is one chunk. */
+     int jj0_k = jj0, nub_k = nub;
+     for ( ; jj0 < nub_k; jj0 = nub) {
+     nub = nub_k;
+
      /***********************************************
       * Gather U blocks (AFTER LOOK-AHEAD WINDOW)   *
       ***********************************************/
@@ -181,15 +197,22 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 			j, Ublock_info[j].iukp, Ublock_info[j].rukp,
 			Ublock_info[j].jb, nsupc); */
 
-	     /* Prepare to call GEMM. */
+	     /* Prepare to call GEMM; U(k,j) of a clean supernode has no
+		column there, it updates no dirty panel (see SN_CLEAN()). */
+	     int temp_ldu = 0;
 	     jj = iukp;
-	     for (; jj < iukp+nsupc; ++jj) {
+	     for (; jj < iukp+nsupc && !SN_CLEAN(jb); ++jj) {
 		 segsize = klst - usub[jj];
 		 if ( segsize ) {
                     ++temp_ncols;
-                    if ( segsize > ldu ) ldu = segsize;
+                    if ( segsize > temp_ldu ) temp_ldu = segsize;
 		 }
 	     }
+	     if ( u_chunk > 0 && j > jj0 && ncols + temp_ncols > u_chunk ) {
+		 nub = j; /* U(k,j) starts the next chunk */
+		 break;
+	     }
+	     if ( temp_ldu > ldu ) ldu = temp_ldu;
 
 	     Ublock_info[j].full_u_cols = temp_ncols;
 	     ncols += temp_ncols;
@@ -262,7 +285,7 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	    nsupc = SuperSize (jb );
 #endif
             /* Copy from U(k,j) to tempu[], padding zeros.  */
-            for (jj = iukp; jj < iukp+nsupc; ++jj) {
+            for (jj = iukp; jj < iukp+nsupc && !SN_CLEAN(jb); ++jj) {
                 segsize = klst - usub[jj];
                 if ( segsize ) {
                     lead_zero = ldu - segsize;
@@ -293,6 +316,27 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
     int thread_id;
     /*tempv = bigV;*/
 
+    /* The tiles L(i,k)*U(k,j) are taken by the threads one at a time
+       (schedule(dynamic)). With skewed block sizes, the threads that
+       pick the last large tiles keep the others waiting at the end of
+       the loop, so the U blocks and the remaining L blocks are visited
+       in decreasing order of their size: the largest tiles go first and
+       the tail of the loop is made of small ones. */
+    for (j = jj0; j < nub; ++j) {
+	Ublock_order[j-jj0] = j;
+	Ublock_key[j-jj0] = -Ublock_info[j].full_u_cols
+	    + (j > jj0 ? Ublock_info[j-1].full_u_cols : 0);
+    }
+    for (i = 0; i < RemainBlk; ++i) {
+	Remain_order[i] = i;
+	Remain_key[i] = -Remain_info[i].FullRow
+	    + (i > 0 ? Remain_info[i-1].FullRow : 0);
+    }
+    if ( num_threads > 1 ) {
+	isort (nub - jj0, Ublock_key, Ublock_order);
+	isort (RemainBlk, Remain_key, Remain_order);
+    }
+
     /**********************
      * Gather L blocks    *
      **********************/
@@ -424,20 +468,22 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	   int i = sizeof(int);
 	   int* indirect_thread    = indirect + (ldt + CACHELINE/i) * thread_id;
 	   int* indirect2_thread   = indirect2 + (ldt + CACHELINE/i) * thread_id;
+	   double t_thread = TRACE_TIME(stat);
 
 #pragma omp for \
     private (nsupc,ljb,lptr,ib,temp_nbrow,cum_nrow)	\
-    schedule(dynamic)
+    schedule(dynamic) nowait
 #else /* not use _OPENMP */
 	   thread_id = 0;
 	   int* indirect_thread    = indirect;
 	   int* indirect2_thread   = indirect2;
+	   double t_thread = TRACE_TIME(stat);
 #endif
 	   /* Each thread is assigned one loop index ij, responsible for
 	      block update L(lb,k) * U(k,j) -> tempv[]. */
 	   for (int ij = 0; ij < lookAheadBlk*(nub-jj0); ++ij) {
 	       /* jj0 starts after look-ahead window. */
-            int j   = ij/lookAheadBlk + jj0;
+            int j   = Ublock_order[ij/lookAheadBlk];
             int lb  = ij%lookAheadBlk;
 
             /* Getting U block U(k,j) information */
@@ -456,6 +502,7 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
                 ncols  = Ublock_info[j].full_u_cols;
                 st_col = 0;
             }
+            if ( SN_CLEAN(jb) ) continue; /* no column of U(k,j) */
 
             /* Getting L block L(i,k) information */
             int_t lptr = lookAhead_lptr[lb];
@@ -479,6 +526,12 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	    gemm_max_k = SUPERLU_MAX(gemm_max_k, ldu);
 #endif
 
+	    double t_histo = stat->gemm_histo ? SuperLU_timer_() : 0.0;
+
+	    /* alpha = 1, beta = 0: a narrow supernode goes to the small kernel */
+	    if ( !dgemm_small(temp_nbrow, ncols, ldu,
+			      &lookAhead_L_buff[cum_nrow], Lnbrow,
+			      &tempu[st_col*ldu], ldu, tempv1, temp_nbrow) ) {
 #if defined (USE_VENDOR_BLAS)
             dgemm_("N", "N", &temp_nbrow, &ncols, &ldu, &alpha,
 		   //&lookAhead_L_buff[(knsupc-ldu)*Lnbrow+cum_nrow], &Lnbrow,
@@ -490,6 +543,10 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 		   &lookAhead_L_buff[cum_nrow], &Lnbrow,
 		   &tempu[st_col*ldu], &ldu, &beta, tempv1, &temp_nbrow);
 #endif
+	    }
+	    if ( stat->gemm_histo )
+		superlu_histo_gemm(stat, temp_nbrow, ncols, ldu,
+				   SuperLU_timer_() - t_histo);
 
 #if (PRNTlevel>=1 )
 	    if (thread_id == 0) {
@@ -534,8 +591,15 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 #if ( PRNTlevel>=1 )
 	    if (thread_id == 0)
 		LookAheadScatterTimer += SuperLU_timer_() - tt_start;
+#endif
+#ifdef _OPENMP
+	    if ( comm_threads )
+		poll_lookahead(&poll_lock, &poll_last, k0, nfact,
+			       num_look_aheads, recv_reqs, recv_reqs_u,
+			       send_reqs, send_reqs_u, Pr, Pc);
 #endif
 	   } /* end omp for ij = ... */
+	   superlu_trace_event(stat, TRACE_LOOKAHEAD, k, t_thread);
 
 #ifdef _OPENMP
 	 } /* end omp parallel */
@@ -562,7 +626,21 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	   iam, k0,Rnbrow,ldu,ncols,RemainBlk);  fflush(stdout);
 	assert( Rnbrow*ncols < bigv_size ); */
 #endif
+	superlu_hwc_begin(stat, HWC_GEMM);
+	t_trace = SuperLU_timer_();
+	if ( options->BLR_Tol > 0.0 && ncols > 0 ) {
+	    /* Compress the large blocks L(i,k) and multiply in low-rank
+	       form, result stored in bigV[]. */
+	    double blr_flps = dblr_gemm(RemainBlk, Remain_info, ldu, ncols,
+					Remain_L_buff, gemm_m_pad,
+					bigU, gemm_k_pad, bigV,
+					options->BLR_Tol, options->BLR_MinSize);
+	    schur_flop_counter += blr_flps - flps;
+	    stat->ops[FACT]    += blr_flps - flps;
+	} else {
 	/* calling aggregated large GEMM, result stored in bigV[]. */
+	/* Single call of the master thread: let a threaded BLAS use all. */
+	int gemm_threads = superlu_blas_set_threads(superlu_blas_max_threads(flps));
 #if defined (USE_VENDOR_BLAS)
 	//dgemm_("N", "N", &Rnbrow, &ncols, &ldu, &alpha,
 	dgemm_("N", "N", &gemm_m_pad, &gemm_n_pad, &gemm_k_pad, &alpha,
@@ -576,6 +654,15 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	       &Remain_L_buff[0], &gemm_m_pad,
 	       &bigU[0], &gemm_k_pad, &beta, bigV, &gemm_m_pad);
 #endif
+	superlu_blas_restore_threads(gemm_threads);
+	superlu_histo_gemm(stat, Rnbrow, ncols, ldu, SuperLU_timer_() - t_trace);
+	}
+	superlu_trace_event(stat, TRACE_SCHUR_GEMM, k, t_trace);
+	superlu_hwc_end(stat, HWC_GEMM);
+	if ( options->Fact_Comm == SLU_COMM_IRECV
+	     || options->Fact_Comm == SLU_COMM_THREADS )
+	    progress_lookahead_recvs(k0, nfact, num_look_aheads,
+				     recv_reqs, recv_reqs_u);
 
 #if ( PRNTlevel>=1 )
 	tt_end = SuperLU_timer_();
@@ -598,6 +685,7 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 #endif
 
 	/* Scatter into destination block-by-block. */
+	superlu_hwc_begin(stat, HWC_SCATTER);
 #ifdef _OPENMP
 #pragma omp parallel default(shared) private(thread_id)
 	{
@@ -621,21 +709,23 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	    int i = sizeof(int);
 	    int* indirect_thread = indirect + (ldt + CACHELINE/i) * thread_id;
 	    int* indirect2_thread = indirect2 + (ldt + CACHELINE/i) * thread_id;
+	    double t_thread = TRACE_TIME(stat);
 
 #pragma omp for \
     private (j,lb,rukp,iukp,jb,nsupc,ljb,lptr,ib,temp_nbrow,cum_nrow)	\
-    schedule(dynamic)
+    schedule(dynamic) nowait
 #else /* not use _OPENMP */
 	    thread_id = 0;
 	    int* indirect_thread = indirect;
 	    int* indirect2_thread = indirect2;
+	    double t_thread = TRACE_TIME(stat);
 #endif
 	    /* Each thread is assigned one loop index ij, responsible for
 	       block update L(lb,k) * U(k,j) -> tempv[]. */
 	    for (int ij = 0; ij < RemainBlk*(jj_cpu-jj0); ++ij) {
 		/* jj_cpu := nub, jj0 starts after look-ahead window. */
-		int j   = ij / RemainBlk + jj0; /* j-th block in U panel */
-		int lb  = ij % RemainBlk;       /* lb-th block in L panel */
+		int j   = Ublock_order[ij / RemainBlk]; /* j-th block in U panel */
+		int lb  = Remain_order[ij % RemainBlk]; /* lb-th block in L panel */
 
 		/* Getting U block U(k,j) information */
 		/* unsigned long long ut_start, ut_end; */
@@ -653,6 +743,7 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 		    ncols = Ublock_info[j].full_u_cols;
 		    st_col = 0;
 		}
+		if ( SN_CLEAN(jb) ) continue; /* no column of U(k,j) */
 
 		/* Getting L block L(i,k) information */
 		int_t lptr = Remain_info[lb].lptr;
@@ -693,12 +784,20 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 			       grid
 			       );
 		}
+#ifdef _OPENMP
+		if ( comm_threads )
+		    poll_lookahead(&poll_lock, &poll_last, k0, nfact,
+				   num_look_aheads, recv_reqs, recv_reqs_u,
+				   send_reqs, send_reqs_u, Pr, Pc);
+#endif
 
 	    } /* end omp for (int ij =...) */
+	    superlu_trace_event(stat, TRACE_SCATTER, k, t_thread);
 
 #ifdef _OPENMP
 	} /* end omp parallel region */
 #endif
+	superlu_hwc_end(stat, HWC_SCATTER);
 
 #if ( PRNTlevel>=1 )
 	RemainScatterTimer += SuperLU_timer_() - tt_start;
@@ -711,4 +810,8 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 
     } /* end if Rnbrow>0 ... update remaining block */
 
+     } /* end for the chunks of U(k,:) */
+     jj0 = jj0_k;
+     nub = nub_k;
+
 }  /* end if L(:,k) and U(k,:) are not empty */
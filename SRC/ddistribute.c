@@ -696,10 +696,9 @@ ddistribute(fact_t fact, int_t n, SuperMatrix *A,
 				ABORT("Malloc fails for lusup[]");
 			if ( !(Lindval_loc_bc_ptr[ljb] = intCalloc_dist(nrbl*3) ))
 				ABORT("Malloc fails for Lindval_loc_bc_ptr[ljb][]");
-			if (!(Linv_bc_ptr[ljb] = (double*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(double))))
-				ABORT("Malloc fails for Linv_bc_ptr[ljb][]");
-			if (!(Uinv_bc_ptr[ljb] = (double*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(double))))
-				ABORT("Malloc fails for Uinv_bc_ptr[ljb][]");
+			/* Allocated by pdCompute_Diag_Inv() if inverted. */
+			Linv_bc_ptr[ljb] = NULL;
+			Uinv_bc_ptr[ljb] = NULL;
 		    mybufmax[0] = SUPERLU_MAX( mybufmax[0], len1 );
 		    mybufmax[1] = SUPERLU_MAX( mybufmax[1], len*nsupc );
 		    mybufmax[4] = SUPERLU_MAX( mybufmax[4], len );
@@ -915,6 +914,7 @@ ddistribute(fact_t fact, int_t n, SuperMatrix *A,
 	k = CEILING( nsupers, grid->npcol );/* Number of local block columns */
 	if ( !(LBtree_ptr = (BcTree*)SUPERLU_MALLOC(k * sizeof(BcTree))) )
 		ABORT("Malloc fails for LBtree_ptr[].");
+	superlu_treespec_init(&Llu->LBtree_spec, k);
 	if ( !(ActiveFlag = intCalloc_dist(grid->nprow*2)) )
 		ABORT("Calloc fails for ActiveFlag[].");
 	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->nprow * sizeof(int))) )
@@ -924,7 +924,7 @@ ddistribute(fact_t fact, int_t n, SuperMatrix *A,
 
 
 	for (i=0;i<k;i++){
-		SeedSTD_BC[i]=rand();
+		SeedSTD_BC[i]=i; /* deterministic tree seeds */
 	}
 
 	MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_BC[0],k,MPI_DOUBLE,MPI_MAX,grid->cscp.comm);
@@ -999,8 +999,8 @@ ddistribute(fact_t fact, int_t n, SuperMatrix *A,
 				// rseed=rand();
 				// rseed=1.0;
 				msgsize = SuperSize( jb );
-				LBtree_ptr[ljb] = BcTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_BC[ljb],'d');
-				BcTree_SetTag(LBtree_ptr[ljb],BC_L,'d');
+				superlu_treespec_add(&Llu->LBtree_spec, ljb, ranks, rank_cnt,
+						     msgsize, SeedSTD_BC[ljb]);
 
 				// printf("iam %5d btree rank_cnt %5d \n",iam,rank_cnt);
 				// fflush(stdout);
@@ -1075,6 +1075,7 @@ if ( !iam) printf(".. Construct Bcast tree for L: %.2f\t\n", t);
 	k = CEILING( nsupers, grid->nprow );/* Number of local block rows */
 	if ( !(LRtree_ptr = (RdTree*)SUPERLU_MALLOC(k * sizeof(RdTree))) )
 		ABORT("Malloc fails for LRtree_ptr[].");
+	superlu_treespec_init(&Llu->LRtree_spec, k);
 	if ( !(ActiveFlag = intCalloc_dist(grid->npcol*2)) )
 		ABORT("Calloc fails for ActiveFlag[].");
 	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->npcol * sizeof(int))) )
@@ -1090,7 +1091,7 @@ if ( !iam) printf(".. Construct Bcast tree for L: %.2f\t\n", t);
 		ABORT("Malloc fails for SeedSTD_RD[].");
 
 	for (i=0;i<k;i++){
-		SeedSTD_RD[i]=rand();
+		SeedSTD_RD[i]=i; /* deterministic tree seeds */
 	}
 
 	MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_RD[0],k,MPI_DOUBLE,MPI_MAX,grid->rscp.comm);
@@ -1182,8 +1183,8 @@ if ( !iam) printf(".. Construct Bcast tree for L: %.2f\t\n", t);
 
 					// if(ib==0){
 
-					LRtree_ptr[lib] = RdTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_RD[lib],'d');
-					RdTree_SetTag(LRtree_ptr[lib], RD_L,'d');
+					superlu_treespec_add(&Llu->LRtree_spec, lib, ranks, rank_cnt,
+							     msgsize, SeedSTD_RD[lib]);
 					// }
 
 					// printf("iam %5d rtree rank_cnt %5d \n",iam,rank_cnt);
@@ -1241,6 +1242,7 @@ if ( !iam) printf(".. Construct Reduce tree for L: %.2f\t\n", t);
 	k = CEILING( nsupers, grid->npcol );/* Number of local block columns */
 	if ( !(UBtree_ptr = (BcTree*)SUPERLU_MALLOC(k * sizeof(BcTree))) )
 		ABORT("Malloc fails for UBtree_ptr[].");
+	superlu_treespec_init(&Llu->UBtree_spec, k);
 	if ( !(ActiveFlag = intCalloc_dist(grid->nprow*2)) )
 		ABORT("Calloc fails for ActiveFlag[].");
 	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->nprow * sizeof(int))) )
@@ -1249,7 +1251,7 @@ if ( !iam) printf(".. Construct Reduce tree for L: %.2f\t\n", t);
 		ABORT("Malloc fails for SeedSTD_BC[].");
 
 	for (i=0;i<k;i++){
-		SeedSTD_BC[i]=rand();
+		SeedSTD_BC[i]=i; /* deterministic tree seeds */
 	}
 
 	MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_BC[0],k,MPI_DOUBLE,MPI_MAX,grid->cscp.comm);
@@ -1339,8 +1341,8 @@ if ( !iam) printf(".. Construct Reduce tree for L: %.2f\t\n", t);
 				// rseed=rand();
 				// rseed=1.0;
 				msgsize = SuperSize( jb );
-				UBtree_ptr[ljb] = BcTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_BC[ljb],'d');
-				BcTree_SetTag(UBtree_ptr[ljb],BC_U,'d');
+				superlu_treespec_add(&Llu->UBtree_spec, ljb, ranks, rank_cnt,
+						     msgsize, SeedSTD_BC[ljb]);
 
 				// printf("iam %5d btree rank_cnt %5d \n",iam,rank_cnt);
 				// fflush(stdout);
@@ -1402,6 +1404,7 @@ if ( !iam) printf(".. Construct Bcast tree for U: %.2f\t\n", t);
 	k = CEILING( nsupers, grid->nprow );/* Number of local block rows */
 	if ( !(URtree_ptr = (RdTree*)SUPERLU_MALLOC(k * sizeof(RdTree))) )
 		ABORT("Malloc fails for URtree_ptr[].");
+	superlu_treespec_init(&Llu->URtree_spec, k);
 	if ( !(ActiveFlag = intCalloc_dist(grid->npcol*2)) )
 		ABORT("Calloc fails for ActiveFlag[].");
 	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->npcol * sizeof(int))) )
@@ -1417,7 +1420,7 @@ if ( !iam) printf(".. Construct Bcast tree for U: %.2f\t\n", t);
 		ABORT("Malloc fails for SeedSTD_RD[].");
 
 	for (i=0;i<k;i++){
-		SeedSTD_RD[i]=rand();
+		SeedSTD_RD[i]=i; /* deterministic tree seeds */
 	}
 
 	MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_RD[0],k,MPI_DOUBLE,MPI_MAX,grid->rscp.comm);
@@ -1540,8 +1543,8 @@ if ( !iam) printf(".. Construct Bcast tree for U: %.2f\t\n", t);
 
 					// if(ib==0){
 
-					URtree_ptr[lib] = RdTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_RD[lib],'d');
-					RdTree_SetTag(URtree_ptr[lib], RD_U,'d');
+					superlu_treespec_add(&Llu->URtree_spec, lib, ranks, rank_cnt,
+							     msgsize, SeedSTD_RD[lib]);
 					// }
 
 					// #if ( PRNTlevel>=1 )
@@ -155,10 +155,21 @@ while (j < nub && perm_u[2 * j] <= k0 + num_look_aheads)
 
         lptr += LB_DESCRIPTOR;  /* Skip descriptor. */
 
+        if ( SN_CLEAN(ib) || SN_CLEAN(jb) ) { /* updates no dirty panel */
+            ++current_b;
+            lptr += temp_nbrow;
+            luptr += temp_nbrow;
+            continue;
+        }
+
 	/*if (thread_id == 0) tt_start = SuperLU_timer_();*/
 
         /* calling gemm */
 	stat->ops[FACT] += 2.0 * (flops_t)temp_nbrow * ldu * ncols;
+        /* alpha = 1, beta = 0: a narrow supernode goes to the small kernel */
+        if ( !dgemm_small(temp_nbrow, ncols, ldu,
+                          &lusup[luptr + (knsupc - ldu) * nsupr], nsupr,
+                          tempu, ldu, tempv, temp_nbrow) ) {
 #if defined (USE_VENDOR_BLAS)
         dgemm_("N", "N", &temp_nbrow, &ncols, &ldu, &alpha,
                    &lusup[luptr + (knsupc - ldu) * nsupr], &nsupr,
@@ -168,6 +179,7 @@ while (j < nub && perm_u[2 * j] <= k0 + num_look_aheads)
                    &lusup[luptr + (knsupc - ldu) * nsupr], &nsupr,
                    tempu, &ldu, &beta, tempv, &temp_nbrow );
 #endif
+        }
 
 #if 0
 	if (thread_id == 0) {
@@ -216,8 +228,9 @@ while (j < nub && perm_u[2 * j] <= k0 + num_look_aheads)
 #endif
     look_id = kk0 % (1 + num_look_aheads);
 
-    if (look_ahead[kk] == k0 && kcol == mycol) {
-        /* current column is the last dependency */
+    if (look_ahead[kk] == k0 && kcol == mycol && kk0 < nfact) {
+        /* current column is the last dependency; the panels from nfact
+           on are left unfactored (options->SchurSize) */
         look_id = kk0 % (1 + num_look_aheads);
 
         /* Factor diagonal and subdiagonal blocks and test for exact
@@ -226,8 +239,9 @@ while (j < nub && perm_u[2 * j] <= k0 + num_look_aheads)
 
         double tt1 = SuperLU_timer_();
 
-        PDGSTRF2(options, kk0, kk, thresh, Glu_persist, grid, Llu,
-                  U_diag_blk_send_req, tag_ub, stat, info);
+        if ( !SN_CLEAN(kk) )
+            PDGSTRF2(options, kk0, kk, thresh, Glu_persist, grid, Llu,
+                      U_diag_blk_send_req, tag_ub, stat, info);
 
         pdgstrf2_timer += SuperLU_timer_() - tt1;
 
@@ -249,17 +263,19 @@ while (j < nub && perm_u[2 * j] <= k0 + num_look_aheads)
         }
 
         scp = &grid->rscp;      /* The scope of process row. */
+        if ( use_rma ) panel_rma_ready(&Lrma, mycol, lk);
+        imsg = index_msg(lsub1, msgcnt[0], Lpack, look_id, &icnt, &itype);
         for (pj = 0; pj < Pc; ++pj) {
-            if (ToSendR[lk][pj] != EMPTY) {
+            if (!use_rma && ToSendR[lk][pj] != EMPTY) {
 #if ( PROFlevel>=1 )
                 TIC (t1);
 #endif
-                MPI_Isend (lsub1, msgcnt[0], mpi_int_t, pj,
+                MPI_Isend (imsg, icnt, itype, pj,
                            SLU_MPI_TAG (0, kk0) /* (4*kk0)%tag_ub */ ,
-                           scp->comm, &send_req[pj]);
+                           PANEL_COMM (scp, kk0), &send_req[pj]);
                 MPI_Isend (lusup1, msgcnt[1], MPI_DOUBLE, pj,
                            SLU_MPI_TAG (1, kk0) /* (4*kk0+1)%tag_ub */ ,
-                           scp->comm, &send_req[pj + Pc]);
+                           PANEL_COMM (scp, kk0), &send_req[pj + Pc]);
 #if ( PROFlevel>=1 )
                 TOC (t2, t1);
                 stat->utime[COMM] += t2;
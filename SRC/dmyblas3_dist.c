@@ -0,0 +1,179 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Level 3 BLAS operations for small blocks, written in C
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "superlu_ddefs.h"
+
+/* C = A * B, or C -= A * B if sub, with the inner dimension k a
+   compile-time constant in each instance below, so that the loop over k
+   is unrolled and the loop over the rows is vectorized. */
+static inline void
+dgemm_small_kernel(const int m, const int n, const int k, const int sub,
+		   const double *A, const int lda,
+		   const double *B, const int ldb,
+		   double *C, const int ldc)
+{
+    int i, j, l;
+
+    for (j = 0; j < n; ++j) {
+	const double *b = &B[j * ldb];
+	double *c = &C[j * ldc];
+	if ( !sub ) for (i = 0; i < m; ++i) c[i] = 0.0;
+	for (l = 0; l < k; ++l) {
+	    const double *a = &A[l * lda];
+	    const double blj = sub ? -b[l] : b[l];
+	    for (i = 0; i < m; ++i) c[i] += a[i] * blj;
+	}
+    }
+}
+
+/* Solve T * X = B in place for a unit lower (uplo = 'L') or a non-unit
+   upper (uplo = 'U') triangular T of compile-time order m, column by
+   column of B as the reference DTRSM does. */
+static inline void
+dtrsm_small_kernel(const char uplo, const int m, const int n,
+		   const double *T, const int ldt, double *B, const int ldb)
+{
+    int i, j, l;
+
+    for (j = 0; j < n; ++j) {
+	double *b = &B[j * ldb];
+	if ( uplo == 'L' ) {
+	    for (l = 0; l < m; ++l) {
+		const double *t = &T[l * ldt];
+		const double blj = b[l];
+		for (i = l + 1; i < m; ++i) b[i] -= t[i] * blj;
+	    }
+	} else {
+	    for (l = m - 1; l >= 0; --l) {
+		const double *t = &T[l * ldt];
+		const double blj = b[l] /= t[l];
+		for (i = 0; i < l; ++i) b[i] -= t[i] * blj;
+	    }
+	}
+    }
+}
+
+/*! \brief Compute C = A * B for a small inner dimension k.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * The Schur complement update of a supernode with few columns is a long
+ * series of GEMMs with k = ldu <= nsupc, for which the call overhead of
+ * the vendor DGEMM dominates. For 1 <= k <= 16 the product is
+ * computed here by a kernel specialized for that k, and 1 is returned;
+ * otherwise nothing is done and 0 is returned, so that the caller uses
+ * DGEMM. A is m-by-k, B is k-by-n and C is m-by-n, all column major.
+ * </pre>
+ */
+int
+dgemm_small(int m, int n, int k, double *A, int lda, double *B, int ldb,
+	    double *C, int ldc)
+{
+    switch ( k ) {
+#define DGEMM_SMALL_CASE(K) \
+    case K: dgemm_small_kernel(m, n, K, 0, A, lda, B, ldb, C, ldc); return 1;
+	DGEMM_SMALL_CASE(1)  DGEMM_SMALL_CASE(2)  DGEMM_SMALL_CASE(3)
+	DGEMM_SMALL_CASE(4)  DGEMM_SMALL_CASE(5)  DGEMM_SMALL_CASE(6)
+	DGEMM_SMALL_CASE(7)  DGEMM_SMALL_CASE(8)  DGEMM_SMALL_CASE(9)
+	DGEMM_SMALL_CASE(10) DGEMM_SMALL_CASE(11) DGEMM_SMALL_CASE(12)
+	DGEMM_SMALL_CASE(13) DGEMM_SMALL_CASE(14) DGEMM_SMALL_CASE(15)
+	DGEMM_SMALL_CASE(16)
+#undef DGEMM_SMALL_CASE
+    default: return 0;
+    }
+}
+
+/*! \brief Compute C = C - A * B for a small inner dimension k.
+ *
+ * <pre>
+ * As dgemm_small(), for the updates lsum[i] -= U_i,k * X[k] of the back
+ * solve, which accumulate into C: 1 is returned if 1 <= k <= 16,
+ * otherwise 0 and C is unchanged.
+ * </pre>
+ */
+int
+dgemm_small_sub(int m, int n, int k, double *A, int lda, double *B, int ldb,
+		double *C, int ldc)
+{
+    switch ( k ) {
+#define DGEMM_SMALL_CASE(K) \
+    case K: dgemm_small_kernel(m, n, K, 1, A, lda, B, ldb, C, ldc); return 1;
+	DGEMM_SMALL_CASE(1)  DGEMM_SMALL_CASE(2)  DGEMM_SMALL_CASE(3)
+	DGEMM_SMALL_CASE(4)  DGEMM_SMALL_CASE(5)  DGEMM_SMALL_CASE(6)
+	DGEMM_SMALL_CASE(7)  DGEMM_SMALL_CASE(8)  DGEMM_SMALL_CASE(9)
+	DGEMM_SMALL_CASE(10) DGEMM_SMALL_CASE(11) DGEMM_SMALL_CASE(12)
+	DGEMM_SMALL_CASE(13) DGEMM_SMALL_CASE(14) DGEMM_SMALL_CASE(15)
+	DGEMM_SMALL_CASE(16)
+#undef DGEMM_SMALL_CASE
+    default: return 0;
+    }
+}
+
+/*! \brief Solve T * X = B for a small triangular T.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * The triangular solve computes X[k] = L_k,k \ X[k] and U_k,k \ X[k]
+ * for every supernode k, and for the narrow supernodes of circuit and
+ * other very sparse matrices the call overhead of the vendor DTRSM is
+ * most of the solve time. For 1 <= m <= 16 the solve is done here by a
+ * kernel specialized for that order, and 1 is returned; otherwise
+ * nothing is done and 0 is returned, so that the caller uses DTRSM.
+ *
+ * T is m-by-m, unit lower triangular if uplo = 'L' and non-unit upper
+ * triangular if uplo = 'U', and B is m-by-n, overwritten by X; alpha = 1.
+ * </pre>
+ */
+int
+dtrsm_small(char uplo, int m, int n, double *T, int ldt, double *B, int ldb)
+{
+    if ( uplo == 'L' ) {
+	switch ( m ) {
+#define DTRSM_SMALL_CASE(M) \
+	case M: dtrsm_small_kernel('L', M, n, T, ldt, B, ldb); return 1;
+	    DTRSM_SMALL_CASE(1)  DTRSM_SMALL_CASE(2)  DTRSM_SMALL_CASE(3)
+	    DTRSM_SMALL_CASE(4)  DTRSM_SMALL_CASE(5)  DTRSM_SMALL_CASE(6)
+	    DTRSM_SMALL_CASE(7)  DTRSM_SMALL_CASE(8)  DTRSM_SMALL_CASE(9)
+	    DTRSM_SMALL_CASE(10) DTRSM_SMALL_CASE(11) DTRSM_SMALL_CASE(12)
+	    DTRSM_SMALL_CASE(13) DTRSM_SMALL_CASE(14) DTRSM_SMALL_CASE(15)
+	    DTRSM_SMALL_CASE(16)
+#undef DTRSM_SMALL_CASE
+	default: return 0;
+	}
+    } else {
+	switch ( m ) {
+#define DTRSM_SMALL_CASE(M) \
+	case M: dtrsm_small_kernel('U', M, n, T, ldt, B, ldb); return 1;
+	    DTRSM_SMALL_CASE(1)  DTRSM_SMALL_CASE(2)  DTRSM_SMALL_CASE(3)
+	    DTRSM_SMALL_CASE(4)  DTRSM_SMALL_CASE(5)  DTRSM_SMALL_CASE(6)
+	    DTRSM_SMALL_CASE(7)  DTRSM_SMALL_CASE(8)  DTRSM_SMALL_CASE(9)
+	    DTRSM_SMALL_CASE(10) DTRSM_SMALL_CASE(11) DTRSM_SMALL_CASE(12)
+	    DTRSM_SMALL_CASE(13) DTRSM_SMALL_CASE(14) DTRSM_SMALL_CASE(15)
+	    DTRSM_SMALL_CASE(16)
+#undef DTRSM_SMALL_CASE
+	default: return 0;
+	}
+    }
+}
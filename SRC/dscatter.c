@@ -20,11 +20,21 @@ at the top-level directory.
  *
  * Modified:
  *   September 18, 2017, enable SIMD vectorized scatter operation.
+ *   Dense fast paths: when the rows of the source block are those of the
+ *   destination block (L), or consecutive (U), the update is a plain
+ *   column-by-column subtraction and no indirect table is built.
+ *   Contiguous runs (L): when the destination rows of the source block
+ *   form a few runs of consecutive rows, each run is subtracted as a
+ *   contiguous segment instead of through the indirect table.
  *
  */
 #include <math.h>
 #include "superlu_ddefs.h"
 
+/* The smallest average run length of the destination rows for which
+   dscatter_l() subtracts by runs. */
+#define SCATTER_RUN_MIN 4
+
 void
 dscatter_l_1 (int ib,
            int ljb,
@@ -149,6 +159,27 @@ dscatter_l (
     int_t dest_nbrow;
     lptrj += LB_DESCRIPTOR;
     dest_nbrow=index[lptrj - 1];
+    nzval = Lnzval_bc_ptr[ljb] + luptrj; /* Destination block L(i,j) */
+
+    /* Same rows in the same order: no indirection needed. */
+    if ( temp_nbrow == dest_nbrow ) {
+        for (i = 0; i < temp_nbrow; ++i)
+            if ( lsub[lptr + i] != index[lptrj + i] ) break;
+        if ( i == temp_nbrow ) {
+            for (jj = 0; jj < nsupc; ++jj) {
+                segsize = klst - usub[iukp + jj];
+                if (segsize) {
+#if (_OPENMP>=201307)
+#pragma omp simd
+#endif
+                    for (i = 0; i < temp_nbrow; ++i) nzval[i] -= tempv[i];
+                    tempv += nbrow;
+                }
+                nzval += ldv;
+            }
+            return;
+        }
+    }
 
 #if (_OPENMP>=201307)
 #pragma omp simd
@@ -168,7 +199,39 @@ dscatter_l (
         indirect2[i] =indirect_thread[rel];
     }
 
-    nzval = Lnzval_bc_ptr[ljb] + luptrj; /* Destination block L(i,j) */
+    /* Split the destination rows into runs of consecutive rows; the first
+       source row of run r goes to indirect_thread[r], which is no longer
+       needed, and the run is rows indirect_thread[r]:indirect_thread[r+1]-1
+       of tempv[], at nzval[indirect2[indirect_thread[r]]] on. */
+    int nruns = 0;
+    for (i = 0; i < temp_nbrow; ++i)
+        if ( i == 0 || indirect2[i] != indirect2[i-1] + 1 ) {
+            if ( (nruns + 1) * SCATTER_RUN_MIN > temp_nbrow ) break;
+            indirect_thread[nruns++] = i;
+        }
+    if ( i == temp_nbrow ) {
+        int r, ir, len;
+        double *dest;
+        indirect_thread[nruns] = temp_nbrow;
+        for (jj = 0; jj < nsupc; ++jj) {
+            segsize = klst - usub[iukp + jj];
+            if (segsize) {
+                for (r = 0; r < nruns; ++r) {
+                    ir = indirect_thread[r];
+                    len = indirect_thread[r+1] - ir;
+                    dest = &nzval[indirect2[ir]];
+#if (_OPENMP>=201307)
+#pragma omp simd
+#endif
+                    for (i = 0; i < len; ++i) dest[i] -= tempv[ir + i];
+                }
+                tempv += nbrow;
+            }
+            nzval += ldv;
+        }
+        return;
+    }
+
 #ifdef __INTEL_COMPILER
 #pragma ivdep
 #endif
@@ -236,6 +299,28 @@ dscatter_u (int ib,
     /* Skip descriptor. Now point to fstnz index of block U(i,j). */
     iuip_lib += UB_DESCRIPTOR;
 
+    /* Whether the rows of L(i,k) are consecutive; then each segment of
+       U(i,j) is updated by a dense subtraction. */
+    int_t fstrow = temp_nbrow ? lsub[lptr] : 0;
+    for (i = 1; i < temp_nbrow; ++i)
+        if ( lsub[lptr + i] != fstrow + i ) break;
+    if ( i == temp_nbrow ) {
+        for (jj = 0; jj < nsupc; ++jj) {
+            segsize = klst - usub[iukp + jj];
+            fnz = index[iuip_lib++];
+            if (segsize) {
+                ucol = &Unzval_br_ptr[lib][ruip_lib] + (fstrow - fnz);
+#if (_OPENMP>=201307)
+#pragma omp simd
+#endif
+                for (i = 0; i < temp_nbrow; ++i) ucol[i] -= tempv[i];
+                tempv += nbrow;
+            }
+            ruip_lib += ilst - fnz;
+        }
+        return;
+    }
+
     // tempv = bigV + (cum_nrow + cum_ncol*nbrow);
     for (jj = 0; jj < nsupc; ++jj) {
         segsize = klst - usub[iukp + jj];
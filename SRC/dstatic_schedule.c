@@ -27,20 +27,149 @@ at the top-level directory.
 
 #include "superlu_ddefs.h"
 
-#ifdef ISORT
-extern void isort (int_t N, int_t * ARRAY1, int_t * ARRAY2);
 extern void isort1 (int_t N, int_t * ARRAY);
 
-#else
+/* Flops the processor does in the time one word of a panel is sent, used
+   to add the communication to the weights of the critical-path schedule. */
+#define SCHED_WORD_FLOPS 8.0
 
-static int
-superlu_sort_perm (const void *arg1, const void *arg2)
+/*! \brief Estimate the cost of each supernode for the schedule.
+ *
+ * <pre>
+ * w[j] = flops of the panel factorization of L(:,j) and U(j,:) and of the
+ * Schur complement update L(:,j)*U(j,:), plus SCHED_WORD_FLOPS per word
+ * of the two panels on more than one process. The row counts of L and the
+ * nonzero counts of U are summed over the grid, so w[] is the same on all
+ * processes. Collective over grid->comm.
+ *
+ * If the previous factorization recorded the measured cost of each
+ * supernode (Llu->sn_cost, see superlu_sncost.c), w[j] is taken from it
+ * instead: the panel and update flops, plus SCHED_WORD_FLOPS per word sent.
+ * </pre>
+ */
+static void
+supernode_weights(int nsupers, Glu_persist_t *Glu_persist, dLocalLU_t *Llu,
+		  gridinfo_t *grid, double *w)
 {
-    const int_t *val1 = (const int_t *) arg1;
-    const int_t *val2 = (const int_t *) arg2;
-    return (*val2 < *val1);
+    int_t *xsup = Glu_persist->xsup, *index;
+    int_t  lb, jb;
+    int    Pr = grid->nprow, Pc = grid->npcol;
+    int    myrow = MYROW (grid->iam, grid), mycol = MYCOL (grid->iam, grid);
+    double *cnt, nsupc, lrows, unnz, *c = Llu->sn_cost;
+
+    if ( c ) { /* measured, the same on all processes */
+	for (jb = 0; jb < nsupers; ++jb) {
+	    w[jb] = c[3 * jb + SNCOST_PANEL] + c[3 * jb + SNCOST_SCHUR];
+	    if ( Pr * Pc > 1 )
+		w[jb] += SCHED_WORD_FLOPS * c[3 * jb + SNCOST_BYTES] / sizeof(double);
+	}
+	return;
+    }
+
+    if ( !(cnt = SUPERLU_MALLOC (4 * nsupers * sizeof (double))) )
+	ABORT ("Malloc fails for cnt[].");
+    for (jb = 0; jb < 2 * nsupers; ++jb) cnt[jb] = 0.0;
+    for (lb = 0; (jb = lb * Pc + mycol) < nsupers; ++lb)
+	if ( (index = Llu->Lrowind_bc_ptr[lb]) ) cnt[jb] = index[1];
+    for (lb = 0; (jb = lb * Pr + myrow) < nsupers; ++lb)
+	if ( (index = Llu->Ufstnz_br_ptr[lb]) ) cnt[nsupers + jb] = index[1];
+    MPI_Allreduce (cnt, &cnt[2 * nsupers], 2 * nsupers, MPI_DOUBLE,
+		   MPI_SUM, grid->comm);
+
+    for (jb = 0; jb < nsupers; ++jb) {
+	nsupc = SuperSize (jb);
+	lrows = cnt[2 * nsupers + jb];  /* rows of L(:,jb) */
+	unnz  = cnt[3 * nsupers + jb];  /* nonzeros of U(jb,:) */
+	w[jb] = nsupc * nsupc * lrows
+	      + 2.0 * SUPERLU_MAX (lrows - nsupc, 0.0) * unnz;
+	if ( Pr * Pc > 1 ) w[jb] += SCHED_WORD_FLOPS * (nsupc * lrows + unnz);
+    }
+    SUPERLU_FREE (cnt);
+}
+
+/* The ready supernodes are kept in a binary heap on (bottom level, then
+   smallest number first). */
+#define SCHED_BEFORE(a, b) \
+    ( blevel[a] > blevel[b] || (blevel[a] == blevel[b] && (a) < (b)) )
+
+static void
+sched_heap_push(int_t *heap, int_t *n, double *blevel, int_t j)
+{
+    int_t c = (*n)++, p;
+    while ( c > 0 && SCHED_BEFORE(j, heap[p = (c - 1) / 2]) ) {
+	heap[c] = heap[p];
+	c = p;
+    }
+    heap[c] = j;
+}
+
+static int_t
+sched_heap_pop(int_t *heap, int_t *n, double *blevel)
+{
+    int_t top = heap[0], last = heap[--(*n)], p = 0, c;
+    while ( (c = 2 * p + 1) < *n ) {
+	if ( c + 1 < *n && SCHED_BEFORE(heap[c + 1], heap[c]) ) ++c;
+	if ( !SCHED_BEFORE(heap[c], last) ) break;
+	heap[p] = heap[c];
+	p = c;
+    }
+    if ( *n ) heap[p] = last;
+    return top;
+}
+
+/*! \brief Reorder a schedule by critical-path priority.
+ *
+ * <pre>
+ * On entry, perm_c_supno[] is a topological order of the dependency graph
+ * in which succ[j][0:nsucc[j]-1] are the supernodes that wait for j. The
+ * bottom level of j is w[j] plus the largest bottom level of its
+ * successors, i.e. the cost of the longest chain of panels from j to a
+ * root. On exit, perm_c_supno[] is the topological order that takes,
+ * among the supernodes whose predecessors are all scheduled, the one of
+ * largest bottom level first, so that the look-ahead window factors the
+ * panels of the critical path early.
+ * </pre>
+ */
+static void
+schedule_critical_path(int nsupers, int_t *nsucc, int_t **succ, double *w,
+		       int_t *perm_c_supno)
+{
+    double *blevel;
+    int_t  *npred, *heap;
+    int_t   i, j, k, s, n;
+
+    if ( !(blevel = SUPERLU_MALLOC (nsupers * sizeof (double))) )
+	ABORT ("Malloc fails for blevel[].");
+    if ( !(npred = intMalloc_dist (2 * nsupers)) )
+	ABORT ("Malloc fails for npred[].");
+    heap = &npred[nsupers];
+
+    for (k = nsupers - 1; k >= 0; --k) {
+	j = perm_c_supno[k];
+	blevel[j] = 0.0;
+	for (i = 0; i < nsucc[j]; ++i)
+	    blevel[j] = SUPERLU_MAX (blevel[j], blevel[succ[j][i]]);
+	blevel[j] += w[j];
+    }
+
+    for (j = 0; j < nsupers; ++j) npred[j] = 0;
+    for (j = 0; j < nsupers; ++j)
+	for (i = 0; i < nsucc[j]; ++i) ++npred[succ[j][i]];
+
+    n = 0;
+    for (j = 0; j < nsupers; ++j)
+	if ( npred[j] == 0 ) sched_heap_push (heap, &n, blevel, j);
+    for (k = 0; n > 0; ++k) {
+	j = sched_heap_pop (heap, &n, blevel);
+	perm_c_supno[k] = j;
+	for (i = 0; i < nsucc[j]; ++i)
+	    if ( --npred[s = succ[j][i]] == 0 )
+		sched_heap_push (heap, &n, blevel, s);
+    }
+
+    SUPERLU_FREE (npred);
+    SUPERLU_FREE (blevel);
 }
-#endif
 
 int
 dstatic_schedule(superlu_dist_options_t * options, int m, int n, 
@@ -273,6 +402,27 @@ dstatic_schedule(superlu_dist_options_t * options, int m, int n,
             }
             /*printf( "\n" ); */
         }
+
+        if ( options->Sched_Priority == YES ) {
+            int_t *nparent, **parent;
+            double *w;
+            if ( !(nparent = intMalloc_dist (nsupers)) )
+                ABORT ("Malloc fails for nparent[].");
+            if ( !(parent = SUPERLU_MALLOC (nsupers * sizeof (int_t *))) )
+                ABORT ("Malloc fails for parent[].");
+            if ( !(w = SUPERLU_MALLOC (nsupers * sizeof (double))) )
+                ABORT ("Malloc fails for w[].");
+            for (i = 0; i < nsupers; i++) {
+                nparent[i] = (etree_supno[i] != nsupers);
+                parent[i] = &etree_supno[i];
+            }
+            supernode_weights (nsupers, Glu_persist, Llu, grid, w);
+            schedule_critical_path (nsupers, nparent, parent, w, perm_c_supno);
+            SUPERLU_FREE (w);
+            SUPERLU_FREE (parent);
+            SUPERLU_FREE (nparent);
+        }
+
         SUPERLU_FREE (num_child);
         SUPERLU_FREE (etree_supno);
 	log_memory(-2 * nsupers * iword, stat);
@@ -447,12 +597,7 @@ dstatic_schedule(superlu_dist_options_t * options, int m, int n,
             }
             /* sort by the column indices to make things easier for later on */
 
-#ifdef ISORT
             isort1 (Urows[jb], &(Ublock[k - Urows[jb]]));
-#else
-            qsort (&(Ublock[k - Urows[jb]]), (size_t) (Urows[jb]),
-                   sizeof (int_t), &superlu_sort_perm);
-#endif
         }
         if (mycol < nsupers % grid->npcol) {
             j = nlb * Pc + mycol;
@@ -470,12 +615,7 @@ dstatic_schedule(superlu_dist_options_t * options, int m, int n,
                 }
                 rdispls[p] += rrows[p * nrb + lb];
             }
-#ifdef ISORT
             isort1 (Urows[nlb], &(Ublock[k - Urows[nlb]]));
-#else
-            qsort (&(Ublock[k - Urows[nlb]]), (size_t) (Urows[nlb]),
-                   sizeof (int_t), &superlu_sort_perm);
-#endif
         }
         SUPERLU_FREE (blockr);
 	log_memory( -nblocks * iword, stat );
@@ -529,12 +669,7 @@ dstatic_schedule(superlu_dist_options_t * options, int m, int n,
                     k += LB_DESCRIPTOR + index[k + 1];
                 }
             }
-#ifdef ISORT
             isort1 (Lrows[lb], &(Lblock[nblocks - Lrows[lb]]));
-#else
-            qsort (&(Lblock[nblocks - Lrows[lb]]), (size_t) (Lrows[lb]),
-                   sizeof (int_t), &superlu_sort_perm);
-#endif
         }
         if (mycol < nsupers % grid->npcol) {
             Lrows[ncb] = 0;
@@ -554,12 +689,7 @@ dstatic_schedule(superlu_dist_options_t * options, int m, int n,
                     nblocks++;
                     k += LB_DESCRIPTOR + index[k + 1];
                 }
-#ifdef ISORT
                 isort1 (Lrows[ncb], &(Lblock[nblocks - Lrows[ncb]]));
-#else
-                qsort (&(Lblock[nblocks - Lrows[ncb]]), (size_t) (Lrows[ncb]),
-                       sizeof (int_t), &superlu_sort_perm);
-#endif
             }
         }
 
@@ -950,6 +1080,17 @@ dstatic_schedule(superlu_dist_options_t * options, int m, int n,
             }
             /*printf( "\n" ); */
         }
+
+        if ( options->Sched_Priority == YES ) {
+            double *w;
+            if ( !(w = SUPERLU_MALLOC (nsupers * sizeof (double))) )
+                ABORT ("Malloc fails for w[].");
+            supernode_weights (nsupers, Glu_persist, Llu, grid, w);
+            schedule_critical_path (nsupers, nnodes_l, edag_supno, w,
+                                    perm_c_supno);
+            SUPERLU_FREE (w);
+        }
+
         for (lb = 0; lb < nsupers; lb++)
             if (nnodes_l[lb] > 0)  SUPERLU_FREE (edag_supno[lb]);
 
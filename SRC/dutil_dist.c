@@ -407,8 +407,8 @@ void dScalePermstructInit(const int_t m, const int_t n,
 /*! \brief Deallocate ScalePermstruct */
 void dScalePermstructFree(dScalePermstruct_t *ScalePermstruct)
 {
-    SUPERLU_FREE(ScalePermstruct->perm_r);
-    SUPERLU_FREE(ScalePermstruct->perm_c);
+    superlu_shm_free(ScalePermstruct->perm_r);
+    superlu_shm_free(ScalePermstruct->perm_c);
     switch ( ScalePermstruct->DiagScale ) {
       case ROW:
         SUPERLU_FREE(ScalePermstruct->R);
@@ -569,8 +569,17 @@ void dZeroLblocks(int iam, int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
     int_t *xsup = Glu_persist->xsup;
     int_t *index;
     double *nzval;
-    int_t nsupers = Glu_persist->supno[n-1] + 1;
+    int_t nsupers;
 
+    if ( LUstruct->dense ) return; /* Refactored whole by pdgssvx_dense() */
+    nsupers = Glu_persist->supno[n-1] + 1;
+
+#ifdef SLU_HAVE_SINGLE
+    if ( LUstruct->sLUstruct ) { /* Factored in single precision */
+	dsZeroLblocks(iam, n, grid, LUstruct);
+	return;
+    }
+#endif
     ncb = nsupers / grid->npcol;
     extra = nsupers % grid->npcol;
     mycol = MYCOL( iam, grid );
@@ -285,6 +285,379 @@ sp_coletree_dist(
 	return 0;
 } /* SP_COLETREE_DIST */
 
+/*
+ * Bucket the pairs (val[k], key[k]), k = 0:npairs-1, by key:
+ * adj[xadj[v]:xadj[v+1]-1] holds the val's of the pairs with key v.
+ */
+static void
+etree_graph_bucket(int_t n, int_t npairs, int_t *val, int_t *key,
+		   int_t *xadj, int_t *adj)
+{
+	int_t	k, v;
+
+	for (v = 0; v <= n; v++) xadj[v] = 0;
+	for (k = 0; k < npairs; k++) ++xadj[key[k] + 1];
+	for (v = 0; v < n; v++) xadj[v+1] += xadj[v];
+	for (k = 0; k < npairs; k++) adj[xadj[key[k]]++] = val[k];
+	for (v = n; v > 0; v--) xadj[v] = xadj[v-1];
+	xadj[0] = 0;
+}
+
+/*
+ * Merge the elimination forests computed on the processes of grid into
+ * the elimination forest of the union of their graphs, and broadcast it.
+ *
+ * The etree of G1 U G2 is the etree of T(G1) U G2, where T(G1) is the
+ * graph of the tree edges {v, parent(v)} of etree(G1): for every k, the
+ * connected components of the subgraphs induced by the vertices 0:k are
+ * the same in G1 and in T(G1). The forests are merged pairwise along a
+ * binary tree, with O(n) work and communication per level.
+ */
+static void
+etree_merge_dist(int_t n, int_t *parent, gridinfo_t *grid)
+{
+	int	iam, nprocs, step;
+	int_t	v, nedges, *other, *lo, *hi, *xadj, *adj;
+	MPI_Status status;
+
+	MPI_Comm_rank(grid->comm, &iam);
+	MPI_Comm_size(grid->comm, &nprocs);
+	if ( nprocs == 1 ) return;
+
+	if ( !(other = intMalloc_dist(8*n + 1)) )
+	    ABORT("Malloc fails for other[]");
+	lo = other + n;
+	hi = lo + 2*n;
+	adj = hi + 2*n;
+	xadj = adj + 2*n;
+
+	for (step = 1; step < nprocs; step *= 2) {
+	    if ( iam % (2*step) ) {
+		MPI_Send(parent, n, mpi_int_t, iam - step, 0, grid->comm);
+		break;
+	    }
+	    if ( iam + step >= nprocs ) continue;
+	    MPI_Recv(other, n, mpi_int_t, iam + step, 0, grid->comm, &status);
+	    for (v = 0, nedges = 0; v < n; v++) {
+		if ( parent[v] < n ) {
+		    lo[nedges] = v; hi[nedges++] = parent[v];
+		}
+		if ( other[v] < n ) {
+		    lo[nedges] = v; hi[nedges++] = other[v];
+		}
+	    }
+	    etree_graph_bucket(n, nedges, lo, hi, xadj, adj);
+	    sp_symetree_dist(xadj, xadj+1, adj, n, parent);
+	}
+
+	SUPERLU_FREE(other);
+	MPI_Bcast(parent, n, mpi_int_t, 0, grid->comm);
+}
+
+/*
+ * Form the local edges of the graph of Pc*(Pr*A + (Pr*A)')*Pc' (symm = 1),
+ * or of the row cliques of A*Pc' replaced by stars centered at their first
+ * column (symm = 0), from the rows of A held by this process.
+ * On return, lo[k] < hi[k] for the *nedges edges; duplicates are kept.
+ */
+static void
+etree_local_edges(SuperMatrix *A, int_t *perm_r, int_t *perm_c, int symm,
+		  int_t *nedges, int_t **lo, int_t **hi)
+{
+	NRformat_loc *Astore = (NRformat_loc *) A->Store;
+	int_t	m_loc = Astore->m_loc, fst_row = Astore->fst_row;
+	int_t	*rowptr = Astore->rowptr, *colind = Astore->colind;
+	int_t	i, j, a, b, f, ne = 0;
+
+	if ( !(*lo = intMalloc_dist(SUPERLU_MAX(2*rowptr[m_loc], 1))) )
+	    ABORT("Malloc fails for lo[]");
+	*hi = *lo + rowptr[m_loc];
+
+	for (i = 0; i < m_loc; i++) {
+	    if ( symm ) {
+		a = perm_r ? perm_r[i + fst_row] : i + fst_row;
+		if ( perm_c ) a = perm_c[a];
+	    } else {
+		/* first column of the row */
+		for (a = A->ncol, j = rowptr[i]; j < rowptr[i+1]; j++) {
+		    f = perm_c ? perm_c[colind[j]] : colind[j];
+		    a = SUPERLU_MIN(a, f);
+		}
+	    }
+	    for (j = rowptr[i]; j < rowptr[i+1]; j++) {
+		b = perm_c ? perm_c[colind[j]] : colind[j];
+		if ( a == b ) continue;
+		(*lo)[ne] = SUPERLU_MIN(a, b);
+		(*hi)[ne++] = SUPERLU_MAX(a, b);
+	    }
+	}
+	*nedges = ne;
+}
+
+static void
+sp_etree_dist_loc(SuperMatrix *A, int_t *perm_r, int_t *perm_c, int symm,
+		  int_t *parent, gridinfo_t *grid)
+{
+	int_t	n = A->ncol, nedges, *lo, *hi, *xadj, *adj;
+
+	etree_local_edges(A, perm_r, perm_c, symm, &nedges, &lo, &hi);
+	if ( !(xadj = intMalloc_dist(n + 1 + SUPERLU_MAX(nedges, 1))) )
+	    ABORT("Malloc fails for xadj[]");
+	adj = xadj + n + 1;
+	etree_graph_bucket(n, nedges, lo, hi, xadj, adj);
+	sp_symetree_dist(xadj, xadj+1, adj, n, parent);
+	SUPERLU_FREE(lo);
+	SUPERLU_FREE(xadj);
+
+	etree_merge_dist(n, parent, grid);
+}
+
+/*! \brief Symmetric elimination tree of a distributed matrix
+ *
+ * <pre>
+ *      Find the elimination tree of Pc*(Pr*A + (Pr*A)')*Pc', where the
+ *      rows of A are distributed in the SLU_NR_loc format, without
+ *      gathering A or forming A'+A.
+ *
+ *      Each process computes the elimination forest of the graph of its
+ *      own rows with Liu's algorithm, and the forests are merged in
+ *      log2(P) steps (see etree_merge_dist). The result is the same as
+ *      that of sp_symetree_dist() on the global Pc*(Pr*A + (Pr*A)')*Pc'.
+ *
+ *      Input:
+ *        A       Square matrix of type SLU_NR_loc; only its structure
+ *                is used.
+ *        perm_r  Row permutation Pr (perm_r[i] = j means row i of A is
+ *                row j of Pr*A), or NULL for the identity.
+ *        perm_c  Symmetric permutation Pc, or NULL for the identity.
+ *      Output:
+ *        parent  Parent in the elimination tree, with n meaning a root,
+ *                on all processes of grid.
+ * </pre>
+ */
+int
+sp_symetree_dist_loc(SuperMatrix *A, int_t *perm_r, int_t *perm_c,
+		     int_t *parent, gridinfo_t *grid)
+{
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(grid->iam, "Enter sp_symetree_dist_loc()");
+#endif
+	sp_etree_dist_loc(A, perm_r, perm_c, 1, parent, grid);
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(grid->iam, "Exit sp_symetree_dist_loc()");
+#endif
+	return 0;
+}
+
+/*! \brief Column elimination tree of a distributed matrix
+ *
+ * <pre>
+ *      Find the elimination tree of (A*Pc')'*(A*Pc'), where the rows of
+ *      A are distributed in the SLU_NR_loc format. As in
+ *      sp_coletree_dist(), each row clique is replaced by a star
+ *      centered at its first column; since each row is held by one
+ *      process, the local forests are then merged as in
+ *      sp_symetree_dist_loc().
+ *
+ *      Input:
+ *        A       Matrix of type SLU_NR_loc; only its structure is used.
+ *        perm_c  Column permutation Pc, or NULL for the identity.
+ *      Output:
+ *        parent  Parent in the column elimination tree, with A->ncol
+ *                meaning a root, on all processes of grid.
+ * </pre>
+ */
+int
+sp_coletree_dist_loc(SuperMatrix *A, int_t *perm_c, int_t *parent,
+		     gridinfo_t *grid)
+{
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(grid->iam, "Enter sp_coletree_dist_loc()");
+#endif
+	sp_etree_dist_loc(A, NULL, perm_c, 0, parent, grid);
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(grid->iam, "Exit sp_coletree_dist_loc()");
+#endif
+	return 0;
+}
+
+/*
+ * Column counts of the Cholesky factor of the graph of etree_local_edges(),
+ * see sp_colcounts_dist_loc() and sp_colcounts_ata_dist_loc().
+ */
+static void
+sp_colcounts_loc(SuperMatrix *A, int_t *perm_r, int_t *perm_c, int symm,
+		 int_t *parent, int_t *colcnt, gridinfo_t *grid)
+{
+	int	iam, nprocs, p, *sendcnts, *recvcnts, *sdispls, *rdispls;
+	int_t	n = A->ncol, nedges, nrecv, blk, i, j, k, q, s, sparent, jprev;
+	int_t	*lo, *hi, *sbuf, *rbuf, *post, *tparent, *first, *maxfirst;
+	int_t	*prevleaf, *ancestor, *delta, *xadj, *adj;
+
+	MPI_Comm_rank(grid->comm, &iam);
+	MPI_Comm_size(grid->comm, &nprocs);
+
+	/* Number the vertices in postorder. */
+	post = TreePostorder_dist(n, parent);
+	if ( !(tparent = intMalloc_dist(7*n + 1)) )
+	    ABORT("Malloc fails for tparent[]");
+	first = tparent + n;
+	maxfirst = first + n;
+	prevleaf = maxfirst + n;
+	ancestor = prevleaf + n;
+	delta = ancestor + n;
+	xadj = delta + n;
+	for (j = 0; j < n; j++) tparent[post[j]] = post[parent[j]];
+
+	/* Send the edge {i, j}, i > j, to the owner of row i. */
+	etree_local_edges(A, perm_r, perm_c, symm, &nedges, &lo, &hi);
+	blk = (n + nprocs - 1) / nprocs;
+	if ( !(sendcnts = SUPERLU_MALLOC(4 * nprocs * sizeof(int))) )
+	    ABORT("Malloc fails for sendcnts[]");
+	recvcnts = sendcnts + nprocs;
+	sdispls = recvcnts + nprocs;
+	rdispls = sdispls + nprocs;
+	for (p = 0; p < nprocs; p++) sendcnts[p] = 0;
+	for (k = 0; k < nedges; k++) {
+	    i = post[hi[k]]; j = post[lo[k]];
+	    hi[k] = SUPERLU_MAX(i, j);
+	    lo[k] = SUPERLU_MIN(i, j);
+	    sendcnts[hi[k] / blk] += 2;
+	}
+	MPI_Alltoall(sendcnts, 1, MPI_INT, recvcnts, 1, MPI_INT, grid->comm);
+	sdispls[0] = rdispls[0] = 0;
+	for (p = 1; p < nprocs; p++) {
+	    sdispls[p] = sdispls[p-1] + sendcnts[p-1];
+	    rdispls[p] = rdispls[p-1] + recvcnts[p-1];
+	}
+	nrecv = (rdispls[nprocs-1] + recvcnts[nprocs-1]) / 2;
+	if ( !(sbuf = intMalloc_dist(SUPERLU_MAX(2*nedges, 1))) )
+	    ABORT("Malloc fails for sbuf[]");
+	for (k = 0; k < nedges; k++) {
+	    p = hi[k] / blk;
+	    sbuf[sdispls[p]++] = hi[k];
+	    sbuf[sdispls[p]++] = lo[k];
+	}
+	for (p = 0; p < nprocs; p++) sdispls[p] -= sendcnts[p];
+	SUPERLU_FREE(lo);
+	if ( !(rbuf = intMalloc_dist(SUPERLU_MAX(4*nrecv, 1))) )
+	    ABORT("Malloc fails for rbuf[]");
+	MPI_Alltoallv(sbuf, sendcnts, sdispls, mpi_int_t,
+		      rbuf, recvcnts, rdispls, mpi_int_t, grid->comm);
+	SUPERLU_FREE(sbuf);
+	SUPERLU_FREE(sendcnts);
+
+	/* The rows i > j of the received edges, by column j. */
+	lo = rbuf + 2*nrecv;
+	hi = lo + nrecv;
+	for (k = 0; k < nrecv; k++) {
+	    hi[k] = rbuf[2*k];
+	    lo[k] = rbuf[2*k+1];
+	}
+	adj = rbuf;
+	etree_graph_bucket(n, nrecv, hi, lo, xadj, adj);
+
+	/* first[j] = first descendant of j = the smallest label in its
+	   subtree; j is a leaf iff first[j] == j. */
+	for (j = 0; j < n; j++) first[j] = -1;
+	for (j = 0; j < n; j++) {
+	    delta[j] = (first[j] == -1 && !iam) ? 1 : 0;
+	    for (k = j; k < n && first[k] == -1; k = tparent[k]) first[k] = j;
+	}
+	for (j = 0; j < n; j++) {
+	    maxfirst[j] = prevleaf[j] = -1;
+	    ancestor[j] = j;
+	}
+
+	for (j = 0; j < n; j++) {
+	    if ( tparent[j] < n && !iam ) delta[tparent[j]]--;
+	    for (k = xadj[j]; k < xadj[j+1]; k++) {
+		i = adj[k];
+		/* Is j a leaf of the row subtree of i? */
+		if ( first[j] <= maxfirst[i] ) continue;
+		maxfirst[i] = first[j];
+		jprev = prevleaf[i];
+		prevleaf[i] = j;
+		delta[j]++;
+		if ( jprev == -1 ) continue;  /* first leaf */
+		/* q = least common ancestor of jprev and j */
+		for (q = jprev; q != ancestor[q]; q = ancestor[q]) ;
+		for (s = jprev; s != q; s = sparent) {
+		    sparent = ancestor[s];
+		    ancestor[s] = q;
+		}
+		delta[q]--;
+	    }
+	    if ( tparent[j] < n ) ancestor[j] = tparent[j];
+	}
+	SUPERLU_FREE(rbuf);
+
+	MPI_Allreduce(delta, first, n, mpi_int_t, MPI_SUM, grid->comm);
+	for (j = 0; j < n; j++)
+	    if ( tparent[j] < n ) first[tparent[j]] += first[j];
+	for (j = 0; j < n; j++) colcnt[j] = first[post[j]];
+
+	SUPERLU_FREE(post);
+	SUPERLU_FREE(tparent);
+}
+
+/*! \brief Column counts of the Cholesky factor of a distributed matrix
+ *
+ * <pre>
+ *      Compute colcnt[j], the number of nonzeros in column j of the
+ *      Cholesky factor L of Pc*(Pr*A + (Pr*A)')*Pc', diagonal included,
+ *      given its elimination tree parent[] (e.g. from
+ *      sp_symetree_dist_loc). The rows and columns of U are those of L',
+ *      so this bounds the structure of L and U of the static pivoting
+ *      LU factorization before symbfact() or symbfact_dist().
+ *
+ *      This is the algorithm of Gilbert, Ng and Peyton, in time nearly
+ *      O(nnz(A)) (see also cs_counts in CSparse). The edges {i, j}, i > j,
+ *      are sent to the process owning row i in a block distribution, so
+ *      that the row subtree of each row is handled by one process; every
+ *      process sweeps the postordered etree, and the contributions are
+ *      summed with one MPI_Allreduce.
+ * </pre>
+ */
+int
+sp_colcounts_dist_loc(SuperMatrix *A, int_t *perm_r, int_t *perm_c,
+		      int_t *parent, int_t *colcnt, gridinfo_t *grid)
+{
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(grid->iam, "Enter sp_colcounts_dist_loc()");
+#endif
+	sp_colcounts_loc(A, perm_r, perm_c, 1, parent, colcnt, grid);
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(grid->iam, "Exit sp_colcounts_dist_loc()");
+#endif
+	return 0;
+}
+
+/*! \brief Column counts of the Cholesky factor of (A*Pc')'*(A*Pc')
+ *
+ * <pre>
+ *      As sp_colcounts_dist_loc(), for Pc*A'*A*Pc' and its column
+ *      elimination tree parent[] (e.g. from sp_coletree_dist_loc), with
+ *      each row clique of A*Pc' replaced by a star centered at its first
+ *      column, which has the same Cholesky factor. When the diagonal of
+ *      Pr*A has no structural zero, A'*A contains the structure of
+ *      Pr*A + (Pr*A)', so this also bounds L and U.
+ * </pre>
+ */
+int
+sp_colcounts_ata_dist_loc(SuperMatrix *A, int_t *perm_c, int_t *parent,
+			  int_t *colcnt, gridinfo_t *grid)
+{
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(grid->iam, "Enter sp_colcounts_ata_dist_loc()");
+#endif
+	sp_colcounts_loc(A, NULL, perm_c, 0, parent, colcnt, grid);
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(grid->iam, "Exit sp_colcounts_ata_dist_loc()");
+#endif
+	return 0;
+}
+
 /*! \brief Depth-first search from vertext
  *
  * <pre>
@@ -139,6 +139,144 @@ get_colamd_dist(
     SUPERLU_FREE(p);
 }
 
+/*! \brief Approximate minimum degree ordering of a symmetric pattern.
+ *
+ * <pre>
+ * (colptr, rowind) is the pattern of a symmetric n-by-n matrix, of which
+ * only the strictly lower part is used, as formed by at_plus_a_dist().
+ * perm_c[i] = j means that column i is in position j, as with GENMMD.
+ * </pre>
+ */
+static void
+get_symamd_dist(const int n, const int_t nnz, int_t *colptr, int_t *rowind,
+		int_t *perm_c)
+{
+    int *A, *p, *perm, i, info;
+    double knobs[COLAMD_KNOBS];
+    int stats[COLAMD_STATS];
+
+    colamd_set_defaults(knobs);
+    if ( !(A = (int *) SUPERLU_MALLOC(SUPERLU_MAX(nnz, 1) * sizeof(int))) )
+        ABORT("Malloc fails for A[]");
+    if ( !(p = (int *) SUPERLU_MALLOC(2 * (n+1) * sizeof(int))) )
+        ABORT("Malloc fails for p[]");
+    perm = p + n + 1;
+    for (i = 0; i <= n; ++i) p[i] = colptr[i];
+    for (i = 0; i < nnz; ++i) A[i] = rowind[i];
+    info = symamd(n, A, p, perm, knobs, stats, calloc, free);
+    if ( info == FALSE ) ABORT("SYMAMD failed");
+
+    for (i = 0; i < n; ++i) perm_c[perm[i]] = i;
+
+    SUPERLU_FREE(A);
+    SUPERLU_FREE(p);
+}
+
+/* Breadth-first search of the component of root among the nodes not yet
+   ordered (done[] = 0), marking them with st in stamp[]: the nodes are
+   put in ls[] level by level. Returns the number of levels; the last one
+   starts at ls[*last] and the component has *nls nodes. */
+static int_t
+rcm_levels(int_t root, int_t *colptr, int_t *rowind, int_t *done,
+	   int_t *stamp, int_t st, int_t *ls, int_t *last, int_t *nls)
+{
+    int_t head = 0, tail = 0, nlev = 0, lend, i, j, k;
+
+    ls[tail++] = root;
+    stamp[root] = st;
+    while ( head < tail ) {
+	*last = head;
+	lend = tail;
+	++nlev;
+	for (; head < lend; ++head) {
+	    j = ls[head];
+	    for (i = colptr[j]; i < colptr[j+1]; ++i) {
+		k = rowind[i];
+		if ( !done[k] && stamp[k] != st ) {
+		    stamp[k] = st;
+		    ls[tail++] = k;
+		}
+	    }
+	}
+    }
+    *nls = tail;
+    return nlev;
+}
+
+/*! \brief Reverse Cuthill-McKee ordering of a symmetric pattern.
+ *
+ * <pre>
+ * (colptr, rowind) is the pattern of a symmetric n-by-n matrix without
+ * its diagonal, as formed by at_plus_a_dist(). Each connected component
+ * is numbered breadth-first from a pseudo-peripheral node (George and
+ * Liu), the neighbors of a node by increasing degree, and the order is
+ * reversed. This keeps the entries of the permuted matrix, and the fill
+ * of its factors, in a narrow band when the graph is long and thin.
+ * perm_c[i] = j means that column i is in position j, as with GENMMD.
+ * </pre>
+ */
+static void
+get_rcm_dist(const int_t n, int_t *colptr, int_t *rowind, int_t *perm_c)
+{
+    int_t *done, *stamp, *ls, *order;
+    int_t i, j, k, s, x, root, nlev, nlev2, last, nls, first, head, nord;
+    int_t st = 0;
+
+    if ( !(done = intCalloc_dist(4 * n)) )
+	ABORT("Calloc fails for done[].");
+    stamp = done + n;
+    ls = stamp + n;
+    order = ls + n;
+    for (i = 0; i < n; ++i) stamp[i] = EMPTY;
+
+#define RCM_DEG(v) (colptr[(v)+1] - colptr[v])
+    nord = 0;
+    for (s = 0; s < n; ++s) {
+	if ( done[s] ) continue;
+
+	/* A pseudo-peripheral node of the component of s: the node of
+	   least degree of the last level, while the depth increases. */
+	root = s;
+	nlev = rcm_levels(root, colptr, rowind, done, stamp, st++, ls,
+			  &last, &nls);
+	while ( nls > 1 ) {
+	    for (x = ls[last], i = last + 1; i < nls; ++i)
+		if ( RCM_DEG(ls[i]) < RCM_DEG(x) ) x = ls[i];
+	    nlev2 = rcm_levels(x, colptr, rowind, done, stamp, st++, ls,
+			       &last, &nls);
+	    if ( nlev2 <= nlev ) break;
+	    root = x;
+	    nlev = nlev2;
+	}
+
+	/* Cuthill-McKee from root. */
+	head = nord;
+	order[nord++] = root;
+	done[root] = 1;
+	while ( head < nord ) {
+	    j = order[head++];
+	    first = nord;
+	    for (i = colptr[j]; i < colptr[j+1]; ++i) {
+		k = rowind[i];
+		if ( !done[k] ) {
+		    done[k] = 1;
+		    order[nord++] = k;
+		}
+	    }
+	    for (i = first + 1; i < nord; ++i) { /* by increasing degree */
+		x = order[i];
+		for (k = i; k > first && RCM_DEG(order[k-1]) > RCM_DEG(x); --k)
+		    order[k] = order[k-1];
+		order[k] = x;
+	    }
+	}
+    }
+#undef RCM_DEG
+
+    for (i = 0; i < n; ++i) perm_c[order[i]] = n - 1 - i;
+    SUPERLU_FREE(done);
+}
+
 /*! \brief
  *
  * <pre>
@@ -174,11 +312,16 @@ getata_dist(
 	    )
 {
 
-    register int_t i, j, k, col, num_nz, ti, trow;
-    int_t *marker, *b_colptr, *b_rowind;
+    int_t i, j, k, col, ti, trow;
+    int_t *marker, *b_colptr, *b_rowind = NULL;
     int_t *t_colptr, *t_rowind; /* a column oriented form of T = A' */
+    int nthreads = 1;
 
-    if ( !(marker = (int_t*) SUPERLU_MALLOC( (SUPERLU_MAX(m,n)+1) * sizeof(int_t)) ) )
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    if ( !(marker = (int_t*) SUPERLU_MALLOC( SUPERLU_MAX(SUPERLU_MAX(m,n)+1,
+				(size_t) nthreads * n) * sizeof(int_t)) ) )
 	ABORT("SUPERLU_MALLOC fails for marker[]");
     if ( !(t_colptr = (int_t*) SUPERLU_MALLOC( (m+1) * sizeof(int_t)) ) )
 	ABORT("SUPERLU_MALLOC t_colptr[]");
@@ -220,65 +363,94 @@ getata_dist(
          T * A_*j = (T_*1, ..., T_*m) * A_*j.  )
        ---------------------------------------------------------------- */
 
-    /* Zero the diagonal flag */
-    for (i = 0; i < n; ++i) marker[i] = -1;
+    /* Allocate the column pointers of A'*A */
+    if ( !(*ata_colptr = (int_t*) SUPERLU_MALLOC( (n+1) * sizeof(int_t)) ) )
+	ABORT("SUPERLU_MALLOC fails for ata_colptr[]");
+    b_colptr = *ata_colptr; /* aliasing */
+    b_colptr[0] = 0;
+
+    /* The columns of B are independent: each thread computes a subset of
+       them, with its own marker[] of size n. The first pass counts the
+       nonzeros of each column, the second one fills the row indices in
+       place, in the same order as one thread would. */
+#ifdef _OPENMP
+#pragma omp parallel private(i, j, k, ti, trow)
+#endif
+    {
+	int_t *mark = marker, cnt;
+#ifdef _OPENMP
+	mark = &marker[(size_t) omp_get_thread_num() * n];
+#endif
 
-    /* First pass determines number of nonzeros in B */
-    num_nz = 0;
-    for (j = 0; j < n; ++j) {
-	/* Flag the diagonal so it's not included in the B matrix */
-	marker[j] = j;
+	/* Zero the diagonal flag */
+	for (i = 0; i < n; ++i) mark[i] = -1;
 
-	for (i = colptr[j]; i < colptr[j+1]; ++i) {
-	    /* A_kj is nonzero, add pattern of column T_*k to B_*j */
-	    k = rowind[i];
-	    for (ti = t_colptr[k]; ti < t_colptr[k+1]; ++ti) {
-		trow = t_rowind[ti];
-		if ( marker[trow] != j ) {
-		    marker[trow] = j;
-		    num_nz++;
+	/* First pass determines number of nonzeros in B */
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+	for (j = 0; j < n; ++j) {
+	    /* Flag the diagonal so it's not included in the B matrix */
+	    mark[j] = j;
+	    cnt = 0;
+
+	    for (i = colptr[j]; i < colptr[j+1]; ++i) {
+		/* A_kj is nonzero, add pattern of column T_*k to B_*j */
+		k = rowind[i];
+		for (ti = t_colptr[k]; ti < t_colptr[k+1]; ++ti) {
+		    trow = t_rowind[ti];
+		    if ( mark[trow] != j ) {
+			mark[trow] = j;
+			++cnt;
+		    }
 		}
 	    }
+	    b_colptr[j+1] = cnt;
 	}
-    }
-    *atanz = num_nz;
-    
-    /* Allocate storage for A'*A */
-    if ( !(*ata_colptr = (int_t*) SUPERLU_MALLOC( (n+1) * sizeof(int_t)) ) )
-	ABORT("SUPERLU_MALLOC fails for ata_colptr[]");
-    if ( *atanz ) {
-	if ( !(*ata_rowind = (int_t*)SUPERLU_MALLOC(*atanz*sizeof(int_t)) ) ) {
-	    fprintf(stderr, ".. atanz = %lld\n", (long long) *atanz);
-	    ABORT("SUPERLU_MALLOC fails for ata_rowind[]");
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+	{
+	    for (j = 0; j < n; ++j) b_colptr[j+1] += b_colptr[j];
+	    *atanz = b_colptr[n];
+
+	    /* Allocate storage for A'*A */
+	    if ( *atanz ) {
+		if ( !(*ata_rowind = (int_t*)SUPERLU_MALLOC(*atanz*sizeof(int_t)) ) ) {
+		    fprintf(stderr, ".. atanz = %lld\n", (long long) *atanz);
+		    ABORT("SUPERLU_MALLOC fails for ata_rowind[]");
+		}
+	    }
+	    b_rowind = *ata_rowind;
 	}
-    }
-    b_colptr = *ata_colptr; /* aliasing */
-    b_rowind = *ata_rowind;
-    
-    /* Zero the diagonal flag */
-    for (i = 0; i < n; ++i) marker[i] = -1;
-    
-    /* Compute each column of B, one at a time */
-    num_nz = 0;
-    for (j = 0; j < n; ++j) {
-	b_colptr[j] = num_nz;
-	
-	/* Flag the diagonal so it's not included in the B matrix */
-	marker[j] = j;
 
-	for (i = colptr[j]; i < colptr[j+1]; ++i) {
-	    /* A_kj is nonzero, add pattern of column T_*k to B_*j */
-	    k = rowind[i];
-	    for (ti = t_colptr[k]; ti < t_colptr[k+1]; ++ti) {
-		trow = t_rowind[ti];
-		if ( marker[trow] != j ) {
-		    marker[trow] = j;
-		    b_rowind[num_nz++] = trow;
+	/* Zero the diagonal flag */
+	for (i = 0; i < n; ++i) mark[i] = -1;
+
+	/* Compute each column of B */
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+	for (j = 0; j < n; ++j) {
+	    cnt = b_colptr[j];
+
+	    /* Flag the diagonal so it's not included in the B matrix */
+	    mark[j] = j;
+
+	    for (i = colptr[j]; i < colptr[j+1]; ++i) {
+		/* A_kj is nonzero, add pattern of column T_*k to B_*j */
+		k = rowind[i];
+		for (ti = t_colptr[k]; ti < t_colptr[k+1]; ++ti) {
+		    trow = t_rowind[ti];
+		    if ( mark[trow] != j ) {
+			mark[trow] = j;
+			b_rowind[cnt++] = trow;
+		    }
 		}
 	    }
 	}
-    }
-    b_colptr[n] = num_nz;
+    } /* end parallel */
        
     SUPERLU_FREE(marker);
     SUPERLU_FREE(t_colptr);
@@ -310,11 +482,15 @@ at_plus_a_dist(
 	       )
 {
 
-    register int_t i, j, k, col, num_nz;
+    int_t i, j, k, col;
     int_t *t_colptr, *t_rowind; /* a column oriented form of T = A' */
-    int_t *marker;
+    int_t *marker, *bp, *bi = NULL;
+    int nthreads = 1;
 
-    if ( !(marker = (int_t*) SUPERLU_MALLOC( n * sizeof(int_t)) ) )
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    if ( !(marker = (int_t*) SUPERLU_MALLOC( (size_t) nthreads * n * sizeof(int_t)) ) )
 	ABORT("SUPERLU_MALLOC fails for marker[]");
     if ( !(t_colptr = (int_t*) SUPERLU_MALLOC( (n+1) * sizeof(int_t)) ) )
 	ABORT("SUPERLU_MALLOC fails for t_colptr[]");
@@ -352,74 +528,102 @@ at_plus_a_dist(
        do not include the diagonal entry
        ---------------------------------------------------------------- */
 
-    /* Zero the diagonal flag */
-    for (i = 0; i < n; ++i) marker[i] = -1;
+    /* Allocate the column pointers of A+A' */
+    if ( !(*b_colptr = (int_t*) SUPERLU_MALLOC( (n+1) * sizeof(int_t)) ) )
+	ABORT("SUPERLU_MALLOC fails for b_colptr[]");
+    bp = *b_colptr;
+    bp[0] = 0;
 
-    /* First pass determines number of nonzeros in B */
-    num_nz = 0;
-    for (j = 0; j < n; ++j) {
-	/* Flag the diagonal so it's not included in the B matrix */
-	marker[j] = j;
+    /* Two passes over the columns of B, shared among the threads as in
+       getata_dist(). */
+#ifdef _OPENMP
+#pragma omp parallel private(i, j, k)
+#endif
+    {
+	int_t *mark = marker, cnt;
+#ifdef _OPENMP
+	mark = &marker[(size_t) omp_get_thread_num() * n];
+#endif
 
-	/* Add pattern of column A_*k to B_*j */
-	for (i = colptr[j]; i < colptr[j+1]; ++i) {
-	    k = rowind[i];
-	    if ( marker[k] != j ) {
-		marker[k] = j;
-		++num_nz;
+	/* Zero the diagonal flag */
+	for (i = 0; i < n; ++i) mark[i] = -1;
+
+	/* First pass determines number of nonzeros in B */
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+	for (j = 0; j < n; ++j) {
+	    /* Flag the diagonal so it's not included in the B matrix */
+	    mark[j] = j;
+	    cnt = 0;
+
+	    /* Add pattern of column A_*k to B_*j */
+	    for (i = colptr[j]; i < colptr[j+1]; ++i) {
+		k = rowind[i];
+		if ( mark[k] != j ) {
+		    mark[k] = j;
+		    ++cnt;
+		}
+	    }
+
+	    /* Add pattern of column T_*k to B_*j */
+	    for (i = t_colptr[j]; i < t_colptr[j+1]; ++i) {
+		k = t_rowind[i];
+		if ( mark[k] != j ) {
+		    mark[k] = j;
+		    ++cnt;
+		}
 	    }
+	    bp[j+1] = cnt;
 	}
 
-	/* Add pattern of column T_*k to B_*j */
-	for (i = t_colptr[j]; i < t_colptr[j+1]; ++i) {
-	    k = t_rowind[i];
-	    if ( marker[k] != j ) {
-		marker[k] = j;
-		++num_nz;
+#ifdef _OPENMP
+#pragma omp single
+#endif
+	{
+	    for (j = 0; j < n; ++j) bp[j+1] += bp[j];
+	    *bnz = bp[n];
+
+	    /* Allocate storage for A+A' */
+	    if ( *bnz ) {
+		if ( !(*b_rowind = (int_t*) SUPERLU_MALLOC( *bnz * sizeof(int_t)) ) )
+		    ABORT("SUPERLU_MALLOC fails for b_rowind[]");
 	    }
+	    bi = *b_rowind;
 	}
-    }
-    *bnz = num_nz;
 
+	/* Zero the diagonal flag */
+	for (i = 0; i < n; ++i) mark[i] = -1;
 
-    /* Allocate storage for A+A' */
-    if ( !(*b_colptr = (int_t*) SUPERLU_MALLOC( (n+1) * sizeof(int_t)) ) )
-	ABORT("SUPERLU_MALLOC fails for b_colptr[]");
-    if ( *bnz ) {
-	if ( !(*b_rowind = (int_t*) SUPERLU_MALLOC( *bnz * sizeof(int_t)) ) )
-	    ABORT("SUPERLU_MALLOC fails for b_rowind[]");
-    }
-    
-    /* Zero the diagonal flag */
-    for (i = 0; i < n; ++i) marker[i] = -1;
-    
-    /* Compute each column of B, one at a time */
-    num_nz = 0;
-    for (j = 0; j < n; ++j) {
-	(*b_colptr)[j] = num_nz;
-	
-	/* Flag the diagonal so it's not included in the B matrix */
-	marker[j] = j;
-
-	/* Add pattern of column A_*k to B_*j */
-	for (i = colptr[j]; i < colptr[j+1]; ++i) {
-	    k = rowind[i];
-	    if ( marker[k] != j ) {
-		marker[k] = j;
-		(*b_rowind)[num_nz++] = k;
+	/* Compute each column of B */
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+	for (j = 0; j < n; ++j) {
+	    cnt = bp[j];
+
+	    /* Flag the diagonal so it's not included in the B matrix */
+	    mark[j] = j;
+
+	    /* Add pattern of column A_*k to B_*j */
+	    for (i = colptr[j]; i < colptr[j+1]; ++i) {
+		k = rowind[i];
+		if ( mark[k] != j ) {
+		    mark[k] = j;
+		    bi[cnt++] = k;
+		}
 	    }
-	}
 
-	/* Add pattern of column T_*k to B_*j */
-	for (i = t_colptr[j]; i < t_colptr[j+1]; ++i) {
-	    k = t_rowind[i];
-	    if ( marker[k] != j ) {
-		marker[k] = j;
-		(*b_rowind)[num_nz++] = k;
+	    /* Add pattern of column T_*k to B_*j */
+	    for (i = t_colptr[j]; i < t_colptr[j+1]; ++i) {
+		k = t_rowind[i];
+		if ( mark[k] != j ) {
+		    mark[k] = j;
+		    bi[cnt++] = k;
+		}
 	    }
 	}
-    }
-    (*b_colptr)[n] = num_nz;
+    } /* end parallel */
        
     SUPERLU_FREE(marker);
     SUPERLU_FREE(t_colptr);
@@ -447,6 +651,8 @@ at_plus_a_dist(
  *         = MMD_AT_PLUS_A: minimum degree ordering on structure of A'+A
  *         = MMD_ATA: minimum degree ordering on structure of A'*A
  *         = METIS_AT_PLUS_A: MeTis on A'+A
+ *         = AMD_AT_PLUS_A: approximate minimum degree ordering on A'+A
+ *         = RCM_AT_PLUS_A: reverse Cuthill-McKee ordering on A'+A
  * 
  * A       (input) SuperMatrix*
  *         Matrix A in A*X=B, of dimension (A->nrow, A->ncol). The number
@@ -514,6 +720,28 @@ get_perm_c_dist(int_t pnum, int_t ispec, SuperMatrix *A, int_t *perm_c)
 			      perm_c);
 #if ( PRNTlevel>=1 )
 	      printf(".. Use approximate minimum degree column ordering.\n");
+#endif
+	      return;
+        case AMD_AT_PLUS_A: /* Approximate minimum degree on A'+A */
+	      if ( m != n ) ABORT("Matrix is not square");
+	      at_plus_a_dist(n, Astore->nnz, Astore->colptr, Astore->rowind,
+			     &bnz, &b_colptr, &b_rowind);
+	      get_symamd_dist(n, bnz, b_colptr, b_rowind, perm_c);
+	      SUPERLU_FREE(b_colptr);
+	      if ( bnz ) SUPERLU_FREE(b_rowind);
+#if ( PRNTlevel>=1 )
+	      if ( !pnum ) printf(".. Use approximate minimum degree ordering on A'+A\n");
+#endif
+	      return;
+        case RCM_AT_PLUS_A: /* Reverse Cuthill-McKee on A'+A */
+	      if ( m != n ) ABORT("Matrix is not square");
+	      at_plus_a_dist(n, Astore->nnz, Astore->colptr, Astore->rowind,
+			     &bnz, &b_colptr, &b_rowind);
+	      get_rcm_dist(n, b_colptr, bnz ? b_rowind : NULL, perm_c);
+	      SUPERLU_FREE(b_colptr);
+	      if ( bnz ) SUPERLU_FREE(b_rowind);
+#if ( PRNTlevel>=1 )
+	      if ( !pnum ) printf(".. Use reverse Cuthill-McKee ordering on A'+A\n");
 #endif
 	      return;
 #ifdef HAVE_PARMETIS
@@ -588,3 +816,112 @@ get_perm_c_dist(int_t pnum, int_t ispec, SuperMatrix *A, int_t *perm_c)
     CHECK_MALLOC((int) pnum, "Exit get_perm_c_dist()");
 #endif
 } /* get_perm_c_dist */
+
+/* The pattern of A compressed by blocks of b rows and columns: entry
+   (I,J) if A has an entry in rows I*b:I*b+b-1 and columns J*b:J*b+b-1.
+   Returns its number of entries; the arrays are allocated. */
+static int_t
+compress_pattern(int_t m, int_t n, int_t *colptr, int_t *rowind, int_t b,
+		 int_t **ccolptr, int_t **crowind)
+{
+    int_t mc = m / b, nc = n / b, nnz = colptr[n], I, J, i, j, k;
+    int_t *marker;
+
+    if ( !(*ccolptr = intMalloc_dist(nc + 1)) )
+	ABORT("Malloc fails for ccolptr[].");
+    if ( !(*crowind = intMalloc_dist(SUPERLU_MAX(nnz, 1))) )
+	ABORT("Malloc fails for crowind[].");
+    if ( !(marker = intMalloc_dist(SUPERLU_MAX(mc, 1))) )
+	ABORT("Malloc fails for marker[].");
+    for (I = 0; I < mc; ++I) marker[I] = EMPTY;
+    for (k = 0, J = 0; J < nc; ++J) {
+	(*ccolptr)[J] = k;
+	for (j = J * b; j < (J + 1) * b; ++j)
+	    for (i = colptr[j]; i < colptr[j+1]; ++i) {
+		I = rowind[i] / b;
+		if ( marker[I] != J ) {
+		    marker[I] = J;
+		    (*crowind)[k++] = I;
+		}
+	    }
+    }
+    (*ccolptr)[nc] = k;
+    SUPERLU_FREE(marker);
+    return k;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * GET_PERM_C_BLOCK is get_perm_c_dist() for a matrix A whose unknowns
+ * come in blocks of b consecutive ones, as the b unknowns of each node of
+ * a mesh for a vector PDE: the graph of the nodes, of order n/b, is
+ * ordered, and the permutation is expanded with the b unknowns of each
+ * node kept consecutive, in their order. The ordering then costs about
+ * b^2 times less time and memory, and the unknowns of a node, which have
+ * the same structure, stay together in the supernodes of symbfact().
+ *
+ * Arguments
+ * =========
+ *
+ * As for get_perm_c_dist(), with
+ *
+ * b       (input) int
+ *         The number of unknowns per block; = 1: get_perm_c_dist(); = 0:
+ *         the largest b <= 8 dividing both dimensions of A for which the
+ *         pattern of A is that of its compression by blocks of b, filled,
+ *         if any, else 1. b is ignored, and get_perm_c_dist() is used, if
+ *         it does not divide the dimensions of A, or for ispec = NATURAL.
+ * </pre>
+ */
+void
+get_perm_c_block(int_t pnum, int_t ispec, int b, SuperMatrix *A,
+		 int_t *perm_c)
+{
+    NCformat *Astore = A->Store, cstore;
+    SuperMatrix C;
+    int_t m = A->nrow, n = A->ncol, nnz = Astore->nnz, *ccolptr, *crowind;
+    int_t *cperm, cnnz, j;
+    int   t;
+
+    if ( b == 0 ) { /* the largest b for which nothing is filled */
+	for (t = 8; t > 1; --t) {
+	    if ( m % t || n % t || n < t ) continue;
+	    cnnz = compress_pattern(m, n, Astore->colptr, Astore->rowind, t,
+				    &ccolptr, &crowind);
+	    SUPERLU_FREE(ccolptr);
+	    SUPERLU_FREE(crowind);
+	    if ( cnnz * t * t == nnz ) break;
+	}
+	b = t;
+    }
+    if ( b <= 1 || m % b || n % b || ispec == NATURAL ) {
+	get_perm_c_dist(pnum, ispec, A, perm_c);
+	return;
+    }
+#if ( PRNTlevel>=1 )
+    if ( !pnum ) printf(".. Order the graph of blocks of %d unknowns\n", b);
+#endif
+
+    cstore.nnz = compress_pattern(m, n, Astore->colptr, Astore->rowind, b,
+				  &ccolptr, &crowind);
+    cstore.colptr = ccolptr;
+    cstore.rowind = crowind;
+    cstore.nzval = NULL;
+    C.Stype = SLU_NC;
+    C.Dtype = A->Dtype;
+    C.Mtype = SLU_GE;
+    C.nrow = m / b;
+    C.ncol = n / b;
+    C.Store = &cstore;
+    if ( !(cperm = intMalloc_dist(n / b)) ) ABORT("Malloc fails for cperm[].");
+    get_perm_c_dist(pnum, ispec, &C, cperm);
+    for (j = 0; j < n; ++j) perm_c[j] = cperm[j / b] * b + j % b;
+
+    SUPERLU_FREE(cperm);
+    SUPERLU_FREE(ccolptr);
+    SUPERLU_FREE(crowind);
+} /* get_perm_c_block */
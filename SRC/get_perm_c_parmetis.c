@@ -28,6 +28,10 @@ at the top-level directory.
 #ifdef HAVE_PARMETIS
 #include "parmetis.h"
 #endif
+#ifdef HAVE_PTSCOTCH
+#include <stdio.h>
+#include <ptscotch.h>
+#endif
 #include "superlu_ddefs.h"
 
 /*
@@ -38,6 +42,59 @@ static float
 a_plus_at_CompRow_loc
 (int, int_t *, int, int_t *, int_t , int_t *, int_t *,  
  int, int_t *, int_t *, int_t **,  int_t **, gridinfo_t *);
+static void
+sep_tree_fstVtxSep(int, int_t *, int_t *);
+#ifdef HAVE_PTSCOTCH
+static void
+sep_tree_from_scotch(int_t, SCOTCH_Num *, SCOTCH_Num *, int, int_t *);
+#endif
+
+/*! \brief
+ *
+ * <pre>
+ * Determine the first node in each sub-domain and separator of the
+ * separator tree described by l_sizes[] (see get_perm_c_parmetis), and
+ * store it in l_fstVtxSep[].
+ * </pre>
+ */
+static void
+sep_tree_fstVtxSep(int noDomains, int_t *l_sizes, int_t *l_fstVtxSep)
+{
+  int_t i, j, k, szSep, noNodes;
+
+  /* Determine the first node in each separator, store it in l_fstVtxSep */  
+  for (j = 0; j < 2 * noDomains; j++)
+    l_fstVtxSep[j] = 0;
+  l_fstVtxSep[2*noDomains - 2] = l_sizes[2*noDomains - 2];
+  szSep = noDomains;
+  i = 0;
+  while (szSep != 1) {
+    for (j = i; j < i + szSep; j++) {
+      l_fstVtxSep[j] += l_sizes[j]; 	      
+    }
+    for (j = i; j < i + szSep; j++) {
+      k = i + szSep + (j-i) / 2;
+      l_fstVtxSep[k] += l_fstVtxSep[j]; 
+    }
+    i += szSep;
+    szSep = szSep / 2;
+  }
+  
+  l_fstVtxSep[2 * noDomains - 2] -= l_sizes[2 * noDomains - 2];
+  i = 2 * noDomains - 2;
+  szSep = 1;
+  while (i > 0) {
+    for (j = i; j < i + szSep; j++) {
+      k = (i - 2 * szSep) + (j-i) * 2 + 1;
+      noNodes = l_fstVtxSep[k];
+      l_fstVtxSep[k] = l_fstVtxSep[j] - l_sizes[k];
+      l_fstVtxSep[k-1] = l_fstVtxSep[k] + l_sizes[k] - 
+	noNodes - l_sizes[k-1];
+    }
+    szSep *= 2;
+    i -= szSep;
+  }
+}
 
 /*! \brief
  *
@@ -127,7 +184,7 @@ get_perm_c_parmetis (SuperMatrix *A, int_t *perm_r, int_t *perm_c,
   /* first row index on each processor when the matrix is distributed
      on nprocs (vtxdist_i) or noDomains processors (vtxdist_o) */
   int_t  *vtxdist_i, *vtxdist_o; 
-  int_t szSep, k, noNodes;
+  int_t k;
   float apat_mem_l; /* memory used during the computation of the graph of A+A' */
   MPI_Status status;
 
@@ -315,38 +372,8 @@ get_perm_c_parmetis (SuperMatrix *A, int_t *perm_r, int_t *perm_c,
     MPI_Recv (l_sizes, 2*noDomains, mpi_int_t, 0, 0, grid->comm,
 	      &status);
   
-  /* Determine the first node in each separator, store it in l_fstVtxSep */  
-  for (j = 0; j < 2 * noDomains; j++)
-    l_fstVtxSep[j] = 0;
-  l_fstVtxSep[2*noDomains - 2] = l_sizes[2*noDomains - 2];
-  szSep = noDomains;
-  i = 0;
-  while (szSep != 1) {
-    for (j = i; j < i + szSep; j++) {
-      l_fstVtxSep[j] += l_sizes[j]; 	      
-    }
-    for (j = i; j < i + szSep; j++) {
-      k = i + szSep + (j-i) / 2;
-      l_fstVtxSep[k] += l_fstVtxSep[j]; 
-    }
-    i += szSep;
-    szSep = szSep / 2;
-  }
-  
-  l_fstVtxSep[2 * noDomains - 2] -= l_sizes[2 * noDomains - 2];
-  i = 2 * noDomains - 2;
-  szSep = 1;
-  while (i > 0) {
-    for (j = i; j < i + szSep; j++) {
-      k = (i - 2 * szSep) + (j-i) * 2 + 1;
-      noNodes = l_fstVtxSep[k];
-      l_fstVtxSep[k] = l_fstVtxSep[j] - l_sizes[k];
-      l_fstVtxSep[k-1] = l_fstVtxSep[k] + l_sizes[k] - 
-	noNodes - l_sizes[k-1];
-    }
-    szSep *= 2;
-    i -= szSep;
-  }
+  /* Determine the first node in each separator, store it in l_fstVtxSep */
+  sep_tree_fstVtxSep(noDomains, l_sizes, l_fstVtxSep);
 
 #if ( PRNTlevel>=2 )
   if (!iam ) {
@@ -363,6 +390,277 @@ get_perm_c_parmetis (SuperMatrix *A, int_t *perm_r, int_t *perm_c,
   return (-mem);
 } /* get_perm_c_parmetis */
 
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * GET_PERM_C_PTSCOTCH obtains a permutation matrix Pc by parallel
+ * nested dissection of the symmetrized graph A+A' with PT-Scotch
+ * (SCOTCH_dgraphOrderCompute), for ColPerm = ZOLTAN. The arguments and
+ * the return value are those of get_perm_c_parmetis(); in particular
+ * the top log2(noDomains) levels of the separator tree are returned in
+ * sizes[] and fstVtxSep[] for the parallel symbolic factorization.
+ *
+ * PT-Scotch indexes the graph with SCOTCH_Num, which is 64-bit when
+ * Scotch is built with INTSIZE64, so it handles graphs of more than
+ * 2^31 edges.
+ * </pre>
+ */
+float
+get_perm_c_ptscotch (SuperMatrix *A, int_t *perm_r, int_t *perm_c,
+		     int nprocs_i, int noDomains,
+		     int_t **sizes, int_t **fstVtxSep,
+		     gridinfo_t *grid, MPI_Comm *scotch_comm)
+{
+  float mem;  /* Memory used during this routine */
+  mem = 0.;
+#ifdef HAVE_PTSCOTCH
+  NRformat_loc *Astore;
+  int   iam, p, levels;
+  int_t m_loc, fst_row, m, n, bnz, i, j, k;
+  int_t *rowptr, *colind, *l_fstVtxSep, *l_sizes;
+  int_t *b_rowptr, *b_colind;
+  int_t *vtxdist_i, *vtxdist_o;
+  float apat_mem_l;
+  SCOTCH_Dgraph    dgraph;
+  SCOTCH_Dordering dorder;
+  SCOTCH_Ordering  corder;
+  SCOTCH_Strat     strat;
+  SCOTCH_Num       *vertloctab, *edgeloctab, *permtab, *peritab;
+  SCOTCH_Num       *rangtab, *treetab, cblknbr;
+
+  /* Initialization. */
+  MPI_Comm_rank (grid->comm, &iam);
+  n = A->ncol;
+  m = A->nrow;
+  if ( m != n ) ABORT("Matrix is not square");
+
+#if ( DEBUGlevel>=1 )
+  CHECK_MALLOC(iam, "Enter get_perm_c_ptscotch()");
+#endif
+
+  Astore = (NRformat_loc *) A->Store;
+  m_loc = Astore->m_loc;
+  fst_row = Astore->fst_row;
+  rowptr = Astore->rowptr;
+  colind = Astore->colind;
+
+#if ( PRNTlevel>=1 )
+  if ( !iam ) printf(".. Use PT-Scotch ordering on A'+A with %d sub-domains.\n",
+		     noDomains);
+#endif
+
+  /* Same distributions as in get_perm_c_parmetis(). */
+  vtxdist_i = (int_t *) SUPERLU_MALLOC((nprocs_i+1) * sizeof(int_t));
+  if ( !vtxdist_i ) ABORT("SUPERLU_MALLOC fails for vtxdist_i.");
+  vtxdist_o = (int_t *) SUPERLU_MALLOC((nprocs_i+1) * sizeof(int_t));
+  if ( !vtxdist_o ) ABORT("SUPERLU_MALLOC fails for vtxdist_o.");
+
+  MPI_Allgather (&fst_row, 1, mpi_int_t, vtxdist_i, 1, mpi_int_t,
+		 grid->comm);
+  vtxdist_i[nprocs_i] = m;
+
+  if (noDomains == nprocs_i) {
+    for (p = 0; p <= nprocs_i; p++)
+      vtxdist_o[p] = vtxdist_i[p];
+  }
+  else {
+    i = n / noDomains;
+    j = n % noDomains;
+    for (k = 0, p = 0; p < noDomains; p++) {
+      vtxdist_o[p] = k;
+      k += i;
+      if (p < j)  k++;
+    }
+    for (p = noDomains; p <= nprocs_i; p++)
+      vtxdist_o[p] = k;
+  }
+
+  /* Compute distributed A + A' */
+  if ((apat_mem_l =
+       a_plus_at_CompRow_loc(iam, perm_r, nprocs_i, vtxdist_i,
+			     n, rowptr, colind, noDomains, vtxdist_o,
+			     &bnz, &b_rowptr, &b_colind, grid)) > 0)
+    return (apat_mem_l);
+  mem += -apat_mem_l;
+
+  (*sizes) = (int_t *) SUPERLU_MALLOC(2 * noDomains * sizeof(int_t));
+  if (!(*sizes)) ABORT("SUPERLU_MALLOC fails for sizes.");
+  l_sizes = *sizes;
+  (*fstVtxSep) = (int_t *) SUPERLU_MALLOC(2 * noDomains * sizeof(int_t));
+  if (!(*fstVtxSep)) ABORT("SUPERLU_MALLOC fails for fstVtxSep.");
+  l_fstVtxSep = *fstVtxSep;
+  m_loc = vtxdist_o[iam+1] - vtxdist_o[iam];
+  for (levels = 0; (1 << levels) < noDomains; ++levels) ;
+
+  if ( iam < noDomains ) {
+    /* Copy the graph if SCOTCH_Num and int_t differ. */
+    if ( sizeof(SCOTCH_Num) == sizeof(int_t) ) {
+      vertloctab = (SCOTCH_Num *) b_rowptr;
+      edgeloctab = (SCOTCH_Num *) b_colind;
+    } else {
+      if ( !(vertloctab = (SCOTCH_Num *) SUPERLU_MALLOC((m_loc+1) * sizeof(SCOTCH_Num))) )
+	ABORT("SUPERLU_MALLOC fails for vertloctab.");
+      if ( !(edgeloctab = (SCOTCH_Num *) SUPERLU_MALLOC(SUPERLU_MAX(bnz,1) * sizeof(SCOTCH_Num))) )
+	ABORT("SUPERLU_MALLOC fails for edgeloctab.");
+      for (i = 0; i <= m_loc; i++) vertloctab[i] = b_rowptr[i];
+      for (i = 0; i < bnz; i++) edgeloctab[i] = b_colind[i];
+    }
+
+    SCOTCH_dgraphInit (&dgraph, *scotch_comm);
+    if ( SCOTCH_dgraphBuild (&dgraph, 0, m_loc, m_loc, vertloctab, NULL,
+			     NULL, NULL, bnz, bnz, edgeloctab, NULL, NULL) )
+      ABORT("SCOTCH_dgraphBuild fails.");
+
+    /* Force nested dissection on the top levels of the separator tree. */
+    SCOTCH_stratInit (&strat);
+    SCOTCH_stratDgraphOrderBuild (&strat,
+				  SCOTCH_STRATLEVELMAX | SCOTCH_STRATLEVELMIN,
+				  noDomains, levels, 0.1);
+    SCOTCH_dgraphOrderInit (&dgraph, &dorder);
+    if ( SCOTCH_dgraphOrderCompute (&dgraph, &dorder, &strat) )
+      ABORT("SCOTCH_dgraphOrderCompute fails.");
+
+    /* Gather the ordering and its separator tree on process 0. */
+    if ( !iam ) {
+      if ( !(permtab = (SCOTCH_Num *) SUPERLU_MALLOC(4 * (n+1) * sizeof(SCOTCH_Num))) )
+	ABORT("SUPERLU_MALLOC fails for permtab.");
+      peritab = permtab + n + 1;
+      rangtab = peritab + n + 1;
+      treetab = rangtab + n + 1;
+      SCOTCH_dgraphCorderInit (&dgraph, &corder, permtab, peritab,
+			       &cblknbr, rangtab, treetab);
+      SCOTCH_dgraphOrderGather (&dgraph, &dorder, &corder);
+      for (i = 0; i < n; i++) perm_c[i] = permtab[i];
+      sep_tree_from_scotch (cblknbr, rangtab, treetab, levels, l_sizes);
+      SCOTCH_dgraphCorderExit (&dgraph, &corder);
+      SUPERLU_FREE (permtab);
+    } else {
+      SCOTCH_dgraphOrderGather (&dgraph, &dorder, NULL);
+    }
+
+    SCOTCH_dgraphOrderExit (&dgraph, &dorder);
+    SCOTCH_stratExit (&strat);
+    SCOTCH_dgraphExit (&dgraph);
+    if ( sizeof(SCOTCH_Num) != sizeof(int_t) ) {
+      SUPERLU_FREE (vertloctab);
+      SUPERLU_FREE (edgeloctab);
+    }
+  }
+
+  if (bnz) SUPERLU_FREE (b_colind);
+  SUPERLU_FREE (b_rowptr);
+  SUPERLU_FREE (vtxdist_i);
+  SUPERLU_FREE (vtxdist_o);
+
+  MPI_Bcast (perm_c, n, mpi_int_t, 0, grid->comm);
+  MPI_Bcast (l_sizes, 2*noDomains, mpi_int_t, 0, grid->comm);
+
+  sep_tree_fstVtxSep(noDomains, l_sizes, l_fstVtxSep);
+
+#if ( PRNTlevel>=2 )
+  if (!iam ) {
+    PrintInt10 ("Sizes of separators", 2 * noDomains-1, l_sizes);
+    PrintInt10 ("First Vertex Separator", 2 * noDomains-1, l_fstVtxSep);
+  }
+#endif
+
+#if ( DEBUGlevel>=1 )
+  CHECK_MALLOC(iam, "Exit get_perm_c_ptscotch()");
+#endif
+
+#endif /* HAVE_PTSCOTCH */
+  return (-mem);
+} /* get_perm_c_ptscotch */
+
+#ifdef HAVE_PTSCOTCH
+/* Add the columns of the subtree of cblk c to the node (d, p) of the
+   separator tree of depth D: the sub-domain p for d = D, and otherwise
+   the separator p of level d. A subtree that Scotch did not dissect in
+   two is kept whole in the first of the two halves. */
+static void
+sep_tree_fill(SCOTCH_Num c, int d, int p, int D, SCOTCH_Num *rangtab,
+	      SCOTCH_Num *fstchild, SCOTCH_Num *nxtsib, SCOTCH_Num *sublo,
+	      int_t *l_sizes)
+{
+  SCOTCH_Num last;
+  int noDomains = 1 << D;
+
+  while ( d < D ) {
+    /* The separator of this node is the column block c itself. */
+    l_sizes[2*noDomains - (2 << d) + p] += rangtab[c+1] - rangtab[c];
+
+    if ( fstchild[c] < 0 ) return;
+    for (last = fstchild[c]; nxtsib[last] >= 0; last = nxtsib[last]) ;
+    if ( last == fstchild[c] ) { /* a chain: same node */
+      c = last;
+      continue;
+    }
+    /* All the children but the last go to the first half. */
+    if ( nxtsib[fstchild[c]] == last )
+      sep_tree_fill(fstchild[c], d+1, 2*p, D, rangtab, fstchild, nxtsib,
+		    sublo, l_sizes);
+    else
+      l_sizes[(2*p) << (D-d-1)] += sublo[last] - sublo[c];
+    c = last;
+    ++d;
+    p = 2*p + 1;
+  }
+  /* A sub-domain: the whole subtree of c. */
+  l_sizes[p] += rangtab[c+1] - sublo[c];
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Convert the column block tree of a PT-Scotch ordering (rangtab[],
+ * treetab[], with the blocks numbered in the order of their columns)
+ * into the separator tree of depth levels stored in l_sizes[] as by
+ * ParMETIS_V3_NodeND.
+ * </pre>
+ */
+static void
+sep_tree_from_scotch(int_t cblknbr, SCOTCH_Num *rangtab, SCOTCH_Num *treetab,
+		     int levels, int_t *l_sizes)
+{
+  SCOTCH_Num *fstchild, *nxtsib, *sublo, c, f, root = -1;
+  int i;
+
+  for (i = 0; i < 2 << levels; i++) l_sizes[i] = 0;
+  if ( !(fstchild = (SCOTCH_Num *) SUPERLU_MALLOC(3 * SUPERLU_MAX(cblknbr,1) * sizeof(SCOTCH_Num))) )
+    ABORT("SUPERLU_MALLOC fails for fstchild.");
+  nxtsib = fstchild + cblknbr;
+  sublo = nxtsib + cblknbr;
+
+  /* Children lists in column order, and the first column of each
+     subtree; the children of a block precede it. */
+  for (c = 0; c < cblknbr; c++) {
+    fstchild[c] = nxtsib[c] = -1;
+    sublo[c] = rangtab[c];
+  }
+  for (c = cblknbr - 1; c >= 0; c--) {
+    f = treetab[c];
+    if ( f < 0 ) { if ( root < 0 ) root = c; else root = -2; continue; }
+    nxtsib[c] = fstchild[f];
+    fstchild[f] = c;
+  }
+  for (c = 0; c < cblknbr; c++) {
+    f = treetab[c];
+    if ( f >= 0 ) sublo[f] = SUPERLU_MIN(sublo[f], sublo[c]);
+  }
+
+  if ( root >= 0 ) {
+    sep_tree_fill(root, 0, 0, levels, rangtab, fstchild, nxtsib, sublo,
+		  l_sizes);
+  } else { /* A forest: keep it in the first sub-domain. */
+    l_sizes[0] = rangtab[cblknbr] - rangtab[0];
+  }
+  SUPERLU_FREE(fstchild);
+}
+#endif /* HAVE_PTSCOTCH */
+
 /*! \brief
  *
  * <pre>
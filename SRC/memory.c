@@ -21,7 +21,12 @@ at the top-level directory.
  * </pre>
  */
 
+#include <stdint.h>
+#include <pthread.h>
 #include "superlu_ddefs.h"
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 /*
  * Global variables
@@ -29,6 +34,12 @@ at the top-level directory.
 SuperLU_ExpHeader *expanders; /* Array of pointers to 4 types of memory */
 SuperLU_LU_stack_t stack;
 int_t no_expand;
+static int_t nzlmax_hint, nzumax_hint; /* set by symbfact_SubHint() */
+#ifdef _OPENMP
+/* symbfact() runs symbfact_SubInit() on independent subtrees of the
+   etree in several threads; each thread has its own expanders. */
+#pragma omp threadprivate(expanders, no_expand, nzlmax_hint, nzumax_hint)
+#endif
 
 
 /*
@@ -55,100 +66,289 @@ superlu_abort_and_exit_dist(char *msg)
 
 long int superlu_malloc_total = 0;
 
-#if ( DEBUGlevel>=1 )           /* Debug malloc/free. */
+/*
+ * Raw allocation of the production mode.
+ */
+//#if  0 
+#if (__STDC_VERSION__ >= 201112L)
 
-#define PAD_FACTOR  2
-#define DWORD  (sizeof(double)) /* Be sure it's no smaller than double. */
+static void *raw_malloc(size_t size) {void* ptr;int alignment=1<<12;if(size>1<<19){alignment=1<<21;}if(posix_memalign( (void**)&(ptr), alignment, size ))ptr=NULL;return(ptr);}
+static void  raw_free(void * ptr)    {free(ptr);}
 
-void *superlu_malloc_dist(size_t size)
+#elif defined (__INTEL_COMPILER)
+#include <immintrin.h>
+static void *raw_malloc(size_t size) {
+    void* ptr;
+    int alignment = 1<<12; // align at 4K page
+    if (size > 1<<19 ) { alignment=1<<21; }
+    return (_mm_malloc(size, alignment));
+}
+static void raw_free(void * ptr)  { _mm_free(ptr); }
+
+#else // normal malloc/free 
+
+static void *raw_malloc(size_t size) { return malloc(size); }
+static void raw_free(void *addr) { free (addr); }
+
+#endif
+
+/*
+ * Allocations tracked by category.
+ *
+ * With DEBUGlevel>=1, or if the environment variable SUPERLU_MEM_TRACK is
+ * set to a nonzero value, each block of superlu_malloc_dist() is preceded
+ * by a header holding its size and its category, the one set last by
+ * superlu_mem_tag(). The current and peak bytes of each category are kept
+ * with atomic updates; only a new peak takes a critical section. The
+ * category is read and set under mem_cat_lock. Tracked blocks are aligned
+ * to MEM_HEADER bytes. Otherwise the blocks come from raw_malloc(), and
+ * the tracking costs one test per call.
+ */
+#define MEM_HEADER  64          /* bytes before a tracked block */
+#define MEM_LIVE    0x5e1a110c  /* not freed yet */
+
+typedef struct {
+    size_t size;
+    void   *base;  /* as returned by malloc() */
+    int    cat;
+    int    live;   /* MEM_LIVE, 0 once freed */
+} mem_header_t;
+
+static int mem_track = 0;
+static pthread_once_t mem_track_once = PTHREAD_ONCE_INIT;
+static int mem_cat = SUPERLU_MEM_OTHER;
+static pthread_mutex_t mem_cat_lock = PTHREAD_MUTEX_INITIALIZER;
+static long int mem_cur[SUPERLU_MEM_NCATS], mem_peak[SUPERLU_MEM_NCATS];
+
+static void mem_track_init(void)
 {
-    char *buf;
-    int iam;
+#if ( DEBUGlevel>=1 )
+    mem_track = 1;
+#else
+    char *ttemp = getenv("SUPERLU_MEM_TRACK");
+    mem_track = ( ttemp && atoi(ttemp) ) ? 1 : 0;
+#endif
+}
 
-    MPI_Comm_rank(MPI_COMM_WORLD, &iam);
-    if ( size <= 0 ) {
-	printf("(%d) superlu_malloc size %lld\n", iam, size);
-	ABORT("superlu_malloc: nonpositive size");
+static int mem_tracking(void)
+{
+    pthread_once(&mem_track_once, mem_track_init);
+    return mem_track;
+}
+
+static void mem_count(int cat, long int bytes)
+{
+    long int cur;
+
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+    cur = mem_cur[cat] += bytes;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    superlu_malloc_total += bytes;
+
+    if ( bytes > 0 && cur > mem_peak[cat] ) {
+#ifdef _OPENMP
+#pragma omp critical (superlu_mem_peak)
+#endif
+	if ( cur > mem_peak[cat] ) mem_peak[cat] = cur;
     }
-    buf = (char *) malloc(size + DWORD);
-    if ( !buf ) {
+}
+
+void *superlu_malloc_dist(size_t size)
+{
+    char *base, *buf;
+    mem_header_t *h;
+
+    if ( !mem_tracking() ) return raw_malloc(size);
+
+#if ( DEBUGlevel>=1 )
+    if ( size == 0 ) ABORT("superlu_malloc: nonpositive size");
+#endif
+    if ( !(base = (char *) malloc(size + 2 * MEM_HEADER - 1)) ) {
+#if ( DEBUGlevel>=1 )
+	int iam;
+	MPI_Comm_rank(MPI_COMM_WORLD, &iam);
 	printf("(%d) superlu_malloc fails: malloc_total %.0f MB, size %lld\n",
-	       iam, superlu_malloc_total*1e-6, size);
+	       iam, superlu_malloc_total*1e-6, (long long) size);
 	ABORT("superlu_malloc: out of memory");
-    }
-
-    ((size_t *) buf)[0] = size;
-#if 0
-    superlu_malloc_total += size + DWORD;
-#else
-    superlu_malloc_total += size;
 #endif
-    return (void *) (buf + DWORD);
+	return NULL;
+    }
+    buf = base + MEM_HEADER
+	  + (MEM_HEADER - (size_t) base % MEM_HEADER) % MEM_HEADER;
+    h = (mem_header_t *) (buf - sizeof(mem_header_t));
+    h->size = size;
+    h->base = base;
+    pthread_mutex_lock(&mem_cat_lock);
+    h->cat = mem_cat;
+    pthread_mutex_unlock(&mem_cat_lock);
+    h->live = MEM_LIVE;
+    mem_count(h->cat, (long int) size);
+    return (void *) buf;
 }
 
 void superlu_free_dist(void *addr)
 {
-    char *p = ((char *) addr) - DWORD;
+    mem_header_t *h;
 
-    if ( !addr )
+    if ( !mem_tracking() ) {
+	raw_free(addr);
+	return;
+    }
+    if ( !addr ) {
+#if ( DEBUGlevel>=1 )
 	ABORT("superlu_free: tried to free NULL pointer");
+#endif
+	return;
+    }
+    h = (mem_header_t *) ((char *) addr - sizeof(mem_header_t));
+    if ( h->live != MEM_LIVE )
+	ABORT("superlu_free: tried to free a freed pointer");
+    h->live = 0; /* to detect duplicate free's */
+    mem_count(h->cat, -(long int) h->size);
+#if ( DEBUGlevel>=1 )
+    if ( superlu_malloc_total < 0 )
+	ABORT("superlu_malloc_total went negative");
+#endif
+    free(h->base);
+}
 
-    if ( !p )
-	ABORT("superlu_free: tried to free NULL+DWORD pointer");
+/*! \brief Attribute the next allocations to category cat (a MemCategory).
+ *
+ * <pre>
+ * Returns the previous category, to be set back at the end of the phase.
+ * The category is global: it is set by the master thread outside the
+ * parallel regions, and the allocations of all the threads go to it.
+ * Solvers run concurrently by several application threads thus mix their
+ * categories; the counts stay exact.
+ * </pre>
+ */
+int superlu_mem_tag(int cat)
+{
+    int prev;
+    pthread_mutex_lock(&mem_cat_lock);
+    prev = mem_cat;
+    mem_cat = cat;
+    pthread_mutex_unlock(&mem_cat_lock);
+    return prev;
+}
 
-    { 
-	int_t n = ((size_t *) p)[0];
-	//printf("superlu_free-dist: n %d\n", n);
-	
-	if ( n==0 ) {
-	    ABORT("superlu_free: tried to free a freed pointer");
-	}
-	*((size_t *) p) = 0; /* Set to zero to detect duplicate free's. */
-#if 0	
-	superlu_malloc_total -= (n + DWORD);
-#else
-	superlu_malloc_total -= n;
-#endif
+/*! \brief Return 1 if the allocations are tracked by category.
+ */
+int superlu_mem_tracked(void)
+{
+    return mem_tracking();
+}
 
-	if ( superlu_malloc_total < 0 )
-	    ABORT("superlu_malloc_total went negative");
-	
-	/*free (addr);*/
-	free (p);
+/*! \brief Return the current and the peak bytes of each category, in
+ *  cur[] and peak[] of length SUPERLU_MEM_NCATS.
+ */
+void superlu_mem_query(double *cur, double *peak)
+{
+    int i;
+    for (i = 0; i < SUPERLU_MEM_NCATS; ++i) {
+	cur[i] = (double) mem_cur[i];
+	peak[i] = (double) mem_peak[i];
     }
+}
 
+/*! \brief Print the current and peak megabytes of each category, the
+ *  maximum and the average over the processes of the grid.
+ *
+ * <pre>
+ * Collective over grid->comm; nothing is printed if the allocations are
+ * not tracked.
+ * </pre>
+ */
+void superlu_mem_print(gridinfo_t *grid)
+{
+    static const char *cat_name[SUPERLU_MEM_NCATS] = {
+	"other   ", "symbolic", "factors ", "trees   ", "solve   ", "redist  "
+    };
+    double mem[2 * SUPERLU_MEM_NCATS], mx[2 * SUPERLU_MEM_NCATS],
+	   sum[2 * SUPERLU_MEM_NCATS];
+    int i, P = grid->nprow * grid->npcol;
+
+    if ( !superlu_mem_tracked() ) return;
+    superlu_mem_query(mem, mem + SUPERLU_MEM_NCATS);
+    MPI_Reduce(mem, mx, 2 * SUPERLU_MEM_NCATS, MPI_DOUBLE, MPI_MAX,
+	       0, grid->comm);
+    MPI_Reduce(mem, sum, 2 * SUPERLU_MEM_NCATS, MPI_DOUBLE, MPI_SUM,
+	       0, grid->comm);
+    if ( grid->iam ) return;
+    printf("\tMemory (MB)           current max      avg     peak max      avg\n");
+    for (i = 0; i < SUPERLU_MEM_NCATS; ++i)
+	printf("\t  %s       %12.2f %8.2f %12.2f %8.2f\n", cat_name[i],
+	       mx[i] * 1e-6, sum[i] * 1e-6 / P,
+	       mx[i + SUPERLU_MEM_NCATS] * 1e-6,
+	       sum[i + SUPERLU_MEM_NCATS] * 1e-6 / P);
 }
- 
-#else  /* The production mode. */
 
-//#if  0 
-#if (__STDC_VERSION__ >= 201112L)
+/*
+ * Placement of the large arrays.
+ *
+ * If the environment variable SUPERLU_HUGEPAGE is set to a nonzero value,
+ * superlu_hugepage() advises the kernel to back an array with transparent
+ * huge pages (Linux); it is applied to the slabs of the values of L and U,
+ * the factorization arena, the panel buffers of PxGSTRF and the receive
+ * buffer of PxGSTRS. If SUPERLU_MPI_ALLOC_MEM is set to a nonzero value,
+ * superlu_malloc_comm() takes the panel and receive buffers from
+ * MPI_Alloc_mem(), which returns memory registered with the network on
+ * RDMA interconnects, so that it is not registered again at each message.
+ */
+#define MEM_HUGEPAGE  (1 << 21)  /* 2 MB */
 
-void * superlu_malloc_dist(size_t size) {void* ptr;int alignment=1<<12;if(size>1<<19){alignment=1<<21;}posix_memalign( (void**)&(ptr), alignment, size );return(ptr);}
-void   superlu_free_dist(void * ptr)    {free(ptr);}
+static int mem_hugepage = -1, mem_mpi = -1; /* -1 until the first call */
 
-#elif defined (__INTEL_COMPILER)
-#include <immintrin.h>
-void * superlu_malloc_dist(size_t size) {
-    void* ptr;
-    int alignment = 1<<12; // align at 4K page
-    if (size > 1<<19 ) { alignment=1<<21; }
-    return (_mm_malloc(size, alignment));
+static int mem_env(int *flag, const char *name)
+{
+    if ( *flag < 0 ) {
+	char *ttemp = getenv(name);
+	*flag = ( ttemp && atoi(ttemp) ) ? 1 : 0;
+    }
+    return *flag;
 }
-void  superlu_free_dist(void * ptr)  { _mm_free(ptr); }
 
-#else // normal malloc/free 
+/*! \brief Advise huge pages for the whole 2 MB pages in [addr, addr+size)
+ *  if SUPERLU_HUGEPAGE is set.
+ */
+void superlu_hugepage(void *addr, size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    uintptr_t b, e;
 
-void *superlu_malloc_dist(size_t size) {
-    void *buf;
-    buf = (void *) malloc(size);
-    return (buf);
+    if ( !addr || !mem_env(&mem_hugepage, "SUPERLU_HUGEPAGE") ) return;
+    b = ((uintptr_t) addr + MEM_HUGEPAGE - 1) & ~((uintptr_t) MEM_HUGEPAGE - 1);
+    e = ((uintptr_t) addr + size) & ~((uintptr_t) MEM_HUGEPAGE - 1);
+    if ( e > b ) madvise((void *) b, e - b, MADV_HUGEPAGE);
+#endif
 }
-void superlu_free_dist(void *addr) { free (addr); }
 
-#endif
+/*! \brief Allocate a buffer sent or received with MPI, to be freed with
+ *  superlu_free_comm(). Returns NULL if it fails.
+ */
+void *superlu_malloc_comm(size_t size)
+{
+    void *buf = NULL;
+
+    size = SUPERLU_MAX(size, 1);
+    if ( mem_env(&mem_mpi, "SUPERLU_MPI_ALLOC_MEM") ) {
+	if ( MPI_Alloc_mem((MPI_Aint) size, MPI_INFO_NULL, &buf)
+	     != MPI_SUCCESS ) buf = NULL;
+    } else
+	buf = SUPERLU_MALLOC(size);
+    superlu_hugepage(buf, size);
+    return buf;
+}
 
-#endif  /* End debug malloc/free. */
+void superlu_free_comm(void *buf)
+{
+    if ( mem_env(&mem_mpi, "SUPERLU_MPI_ALLOC_MEM") ) MPI_Free_mem(buf);
+    else SUPERLU_FREE(buf);
+}
 
 
 
@@ -244,12 +444,28 @@ void SetupSpace(void *work, int_t lwork, LU_space_t *MemModel)
 }
 
 
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Set the initial sizes of lsub[] and usub[] for the next call of
+ * symbfact_SubInit(), instead of the guess FILL * nnz(A); see
+ * symbfact_estimate().
+ * </pre>
+ */
+void symbfact_SubHint(int_t nzlmax, int_t nzumax)
+{
+    nzlmax_hint = SUPERLU_MAX(nzlmax, 1);
+    nzumax_hint = SUPERLU_MAX(nzumax, 1);
+}
+
 /************************************************************************/
 /*! \brief
  *
  * <pre>
  * Allocate storage for the data structures common to symbolic factorization
- * routines. For those unpredictable size, make a guess as FILL * nnz(A).
+ * routines. For those unpredictable size, make a guess as FILL * nnz(A),
+ * or use the sizes given by symbfact_SubHint().
  * Return value:
  *     If lwork = -1, return the estimated amount of space required, plus n;
  *     otherwise, return the amount of space actually allocated when
@@ -285,8 +501,14 @@ int_t symbfact_SubInit
     
     if ( fact == DOFACT || fact == SamePattern ) {
 	/* Guess for L\U factors */
-	nzlmax = FILL * annz;
-	nzumax = FILL/2.0 * annz;
+	if ( nzlmax_hint ) {
+	    nzlmax = nzlmax_hint;
+	    nzumax = nzumax_hint;
+	    nzlmax_hint = nzumax_hint = 0;
+	} else {
+	    nzlmax = FILL * annz;
+	    nzumax = FILL/2.0 * annz;
+	}
 
 	if ( lwork == -1 ) {
 	    return ( SuperLU_GluIntArray(n) * iword + SuperLU_TempSpace(m,1)
@@ -444,7 +666,12 @@ int_t symbfact_SubFree(Glu_freeable_t *Glu_freeable)
     CHECK_MALLOC(iam, "Enter symbfact_SubFree()");
 #endif
     
-    SUPERLU_FREE(expanders);
+    /* expanders is not allocated when the structures are taken from
+       the symbfact cache. */
+    if ( expanders ) {
+        SUPERLU_FREE(expanders);
+        expanders = NULL;
+    }
     SUPERLU_FREE(Glu_freeable->lsub);
     SUPERLU_FREE(Glu_freeable->xlsub);
     SUPERLU_FREE(Glu_freeable->usub);
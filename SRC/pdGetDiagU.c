@@ -9,7 +9,7 @@ The source code is distributed under BSD license, see the file License.txt
 at the top-level directory.
 */
 /*! @file p@(pre)GetDiagU.c
- * \brief Extracts the main diagonal of matrix U
+ * \brief Extracts the main diagonal of matrix U, and the determinant of A
  *
  * <pre>
  * -- Auxiliary routine in distributed SuperLU (version 5.1.0) --
@@ -76,6 +76,13 @@ void pdGetDiagU(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid,
     dLocalLU_t *Llu = LUstruct->Llu;
     double *dblock, *dwork, *lusup;
 
+#ifdef SLU_HAVE_SINGLE
+    if ( LUstruct->sLUstruct ) { /* Single precision factors */
+	pdsGetDiagU(n, LUstruct, grid, diagU);
+	return;
+    }
+#endif
+
     iam = grid->iam;
     nsupers = Glu_persist->supno[n-1] + 1;
     xsup = Glu_persist->xsup;
@@ -119,3 +126,121 @@ void pdGetDiagU(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid,
     SUPERLU_FREE(diag_len);
     SUPERLU_FREE(dwork);
 }
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * pdLogDet computes the determinant of A from its factorization by
+ * pdgssvx(), as sign * exp(logdet), which does not overflow.
+ *
+ * From Pc*Pr*diag(R)*A*diag(C)*Pc' = L*U with a unit L,
+ *
+ *     det(A) = det(Pr) * prod U(i,i) / ( prod R(i) * prod C(i) ).
+ *
+ * Each diagonal process sums log|U(i,i)| over its diagonal blocks and one
+ * reduction combines them; the sign of Pr is found from the cycles of
+ * perm_r[] on each process. If a factor was perturbed (see the options
+ * ReplaceTinyPivot and ILU_DropTol), this is the determinant of the
+ * perturbed matrix.
+ *
+ * Arguments
+ * =========
+ *
+ * n        (input) int
+ *          Dimension of the matrix.
+ *
+ * LUstruct (input) dLUstruct_t*
+ *          The distributed L and U factors computed by pdgssvx().
+ *
+ * ScalePermstruct (input) dScalePermstruct_t*
+ *          The scaling and the permutations of this factorization.
+ *
+ * grid     (input) gridinfo_t*
+ *          The 2D process mesh.
+ *
+ * logdet   (output) double*
+ *          log|det(A)|, -infinity if U is singular.
+ *
+ * sign     (output) int*
+ *          The sign of det(A): 1, -1, or 0 if U is singular.
+ *          On exit, logdet and sign are available on all processes.
+ * </pre>
+ */
+void pdLogDet(int_t n, dLUstruct_t *LUstruct,
+	      dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	      double *logdet, int *sign)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = Glu_persist->xsup, *perm_r = ScalePermstruct->perm_r;
+    int_t i, j, k, lk, nsupers, knsupc;
+    int   nsupr, iam = grid->iam, swaps;
+    int   myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+    double part[3] = {0.0, 0.0, 0.0}; /* log|U(i,i)|, negative, zero */
+    double u, *lusup, *diagU;
+    DiagScale_t DiagScale = ScalePermstruct->DiagScale;
+    char *mark;
+
+    if ( n <= 0 ) { *logdet = 0.0; *sign = 1; return; }
+
+#ifdef SLU_HAVE_SINGLE
+    if ( LUstruct->sLUstruct ) { /* Single precision factors */
+	if ( !(diagU = doubleMalloc_dist(n)) )
+	    ABORT("Malloc fails for diagU[].");
+	pdGetDiagU(n, LUstruct, grid, diagU);
+	for (i = 0; i < n; ++i) {
+	    u = diagU[i];
+	    if ( u == 0.0 ) part[2] += 1.0;
+	    else part[0] += log(fabs(u));
+	    if ( u < 0.0 ) part[1] += 1.0;
+	}
+	SUPERLU_FREE(diagU);
+    } else
+#endif
+    {
+	/* The diagonal blocks are in L, on the diagonal processes. */
+	nsupers = Glu_persist->supno[n-1] + 1;
+	for (k = 0; k < nsupers; ++k) {
+	    if ( myrow != PROW( k, grid ) || mycol != PCOL( k, grid ) ) continue;
+	    knsupc = SuperSize( k );
+	    lk = LBj( k, grid );
+	    nsupr = Llu->Lrowind_bc_ptr[lk][1]; /* LDA of lusup[] */
+	    lusup = Llu->Lnzval_bc_ptr[lk];
+	    for (i = 0; i < knsupc; ++i) {
+		u = lusup[i*(nsupr+1)];
+		if ( u == 0.0 ) part[2] += 1.0;
+		else part[0] += log(fabs(u));
+		if ( u < 0.0 ) part[1] += 1.0;
+	    }
+	}
+	MPI_Allreduce(MPI_IN_PLACE, part, 3, MPI_DOUBLE, MPI_SUM, grid->comm);
+    }
+
+    /* The scaling factors are positive. */
+    if ( DiagScale == ROW || DiagScale == BOTH )
+	for (i = 0; i < n; ++i) part[0] -= log(ScalePermstruct->R[i]);
+    if ( DiagScale == COL || DiagScale == BOTH )
+	for (i = 0; i < n; ++i) part[0] -= log(ScalePermstruct->C[i]);
+
+    /* det(Pr) = (-1)^(n - number of cycles). */
+    if ( !(mark = SUPERLU_MALLOC(n * sizeof(char))) )
+	ABORT("Malloc fails for mark[].");
+    for (i = 0; i < n; ++i) mark[i] = 0;
+    for (swaps = 0, i = 0; i < n; ++i) {
+	if ( mark[i] ) continue;
+	for (j = i; !mark[j]; j = perm_r[j]) { mark[j] = 1; ++swaps; }
+	--swaps;
+    }
+    SUPERLU_FREE(mark);
+
+    if ( part[2] > 0.0 ) {
+	*logdet = -HUGE_VAL;
+	*sign = 0;
+    } else {
+	*logdet = part[0];
+	*sign = ( ((long) part[1] + swaps) % 2 ) ? -1 : 1;
+    }
+}
@@ -0,0 +1,274 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Extracts the Schur complement left by a partial factorization
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "superlu_ddefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGETSCHUR returns the Schur complement
+ *
+ *     S = A22 - A21 * inv(A11) * A12
+ *
+ * of the interior block A11 of A, after pdgssvx() was called with
+ * options->SchurSize = ns > 0 and nrhs = 0. A22 is the block of the last
+ * ns rows and columns of A, the interface. The interior supernodes of
+ * Pc*diag(R)*A*diag(C)*Pc^T have then been factored, and the blocks of
+ * the interface supernodes in the L and U data structures hold the
+ * entries of the scaled Schur complement, on the pattern of L+U.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *        The options used for the factorization; options->SchurSize is
+ *        the order of S.
+ *
+ * n      (input) int (global)
+ *        The order of A.
+ *
+ * ScalePermstruct (input) dScalePermstruct_t*
+ *        The scaling and permutations of the factorization.
+ *
+ * LUstruct (input) dLUstruct_t*
+ *        The partially factored L and U data structures.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * S      (output) SuperMatrix*
+ *        The Schur complement of order options->SchurSize, with row and
+ *        column i for row and column n - SchurSize + i of A, in the
+ *        distributed compressed row format (Stype = SLU_NR_loc;
+ *        Dtype = SLU_D; Mtype = SLU_GE). The rows are split among the
+ *        processes in the order of their ranks, with the remainder on the
+ *        last process; the column indices of each row are increasing.
+ *        Its storage is freed by Destroy_CompRowLoc_Matrix_dist().
+ * </pre>
+ */
+void
+pdGetSchur(superlu_dist_options_t *options, int_t n,
+	   dScalePermstruct_t *ScalePermstruct, dLUstruct_t *LUstruct,
+	   gridinfo_t *grid, SuperMatrix *S)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = Glu_persist->xsup;
+    int_t *perm_r = ScalePermstruct->perm_r, *perm_c = ScalePermstruct->perm_c;
+    int_t ns = options->SchurSize, nint = n - ns;
+    int_t *iq, *ic, *lsub, *usub, *eidx, *recvidx, *rowptr, *colind, *itmp;
+    int_t nsupers, ksch, nlb, nub, gb, gj, lb, ljb, b, pos, luptr, uptr;
+    int_t irow, fnz, t, c, i, j, nloc, nnz_loc, m_loc, m_loc_fst, fst_row;
+    int   iam = grid->iam, nprocs = grid->nprow * grid->npcol, p;
+    int   myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+    int   knsupc, nsupr, *sendcnts, *sdispls, *recvcnts, *rdispls;
+    double *lusup, *uval, *evals, *sendval, *recvval, *nzval, *dtmp;
+    double *R = ScalePermstruct->R, *C = ScalePermstruct->C;
+    int   rowequ = ScalePermstruct->DiagScale == ROW
+		   || ScalePermstruct->DiagScale == BOTH;
+    int   colequ = ScalePermstruct->DiagScale == COL
+		   || ScalePermstruct->DiagScale == BOTH;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter pdGetSchur()");
+#endif
+    if ( ns <= 0 ) ABORT("pdGetSchur() needs options->SchurSize > 0.");
+
+    nsupers = Glu_persist->supno[n-1] + 1;
+    ksch = Glu_persist->supno[nint];
+    nlb = CEILING( nsupers, grid->nprow );
+    nub = CEILING( nsupers, grid->npcol );
+
+    /* Row q and column p of A1 = Pc*Pr*A*Pc^T are row iq[q] and column
+       ic[p] of A. */
+    if ( !(iq = intMalloc_dist(2 * n)) ) ABORT("Malloc fails for iq[].");
+    ic = iq + n;
+    for (i = 0; i < n; ++i) {
+	iq[perm_c[perm_r[i]]] = i;
+	ic[perm_c[i]] = i;
+    }
+
+    /* The rows of S owned by each process, as in the examples. */
+    m_loc_fst = ns / nprocs;
+    fst_row = iam * m_loc_fst;
+    m_loc = iam == nprocs - 1 ? ns - fst_row : m_loc_fst;
+
+    /* Gather the local entries S(i,j) in the L blocks of the interface
+       block columns and in the U blocks of the interface block rows. */
+    for (nloc = 0, ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * grid->npcol + mycol;
+	if ( gb >= ksch && gb < nsupers && (lsub = Llu->Lrowind_bc_ptr[ljb]) )
+	    nloc += SuperSize( gb ) * lsub[1];
+    }
+    for (lb = 0; lb < nlb; ++lb) {
+	gb = lb * grid->nprow + myrow;
+	if ( gb >= ksch && gb < nsupers && (usub = Llu->Ufstnz_br_ptr[lb]) )
+	    nloc += usub[1];
+    }
+    if ( !(eidx = intMalloc_dist(2 * nloc + 1)) )
+	ABORT("Malloc fails for eidx[].");
+    if ( !(evals = doubleMalloc_dist(nloc + 1)) )
+	ABORT("Malloc fails for evals[].");
+
+    for (nloc = 0, ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * grid->npcol + mycol;
+	if ( gb < ksch || gb >= nsupers || !(lsub = Llu->Lrowind_bc_ptr[ljb]) )
+	    continue;
+	lusup = Llu->Lnzval_bc_ptr[ljb];
+	knsupc = SuperSize( gb );
+	nsupr = lsub[1];
+	for (b = 0, pos = BC_HEADER, luptr = 0; b < lsub[0]; ++b) {
+	    for (t = 0; t < lsub[pos+1]; ++t) {
+		irow = lsub[pos + LB_DESCRIPTOR + t];
+		for (c = 0; c < knsupc; ++c, ++nloc) {
+		    eidx[2*nloc] = iq[irow];
+		    eidx[2*nloc+1] = ic[FstBlockC( gb ) + c];
+		    evals[nloc] = lusup[luptr + t + c*nsupr];
+		}
+	    }
+	    luptr += lsub[pos+1];
+	    pos += LB_DESCRIPTOR + lsub[pos+1];
+	}
+    }
+    for (lb = 0; lb < nlb; ++lb) {
+	gb = lb * grid->nprow + myrow;
+	if ( gb < ksch || gb >= nsupers || !(usub = Llu->Ufstnz_br_ptr[lb]) )
+	    continue;
+	uval = Llu->Unzval_br_ptr[lb];
+	for (b = 0, pos = BR_HEADER, uptr = 0; b < usub[0]; ++b) {
+	    gj = usub[pos];
+	    knsupc = SuperSize( gj );
+	    for (c = 0; c < knsupc; ++c) {
+		fnz = usub[pos + UB_DESCRIPTOR + c];
+		for (irow = fnz; irow < FstBlockC( gb+1 ); ++irow, ++nloc) {
+		    eidx[2*nloc] = iq[irow];
+		    eidx[2*nloc+1] = ic[FstBlockC( gj ) + c];
+		    evals[nloc] = uval[uptr++];
+		}
+	    }
+	    pos += UB_DESCRIPTOR + knsupc;
+	}
+    }
+
+    /* Undo the scaling: A1 holds diag(R)*S*diag(C) on the interface. */
+    for (t = 0; t < nloc; ++t) {
+	if ( rowequ ) evals[t] /= R[eidx[2*t]];
+	if ( colequ ) evals[t] /= C[eidx[2*t+1]];
+	eidx[2*t] -= nint;
+	eidx[2*t+1] -= nint;
+    }
+
+    /* Send each entry to the owner of its row. */
+    if ( !(sendcnts = SUPERLU_MALLOC(4 * nprocs * sizeof(int))) )
+	ABORT("Malloc fails for sendcnts[].");
+    sdispls = sendcnts + nprocs;
+    recvcnts = sdispls + nprocs;
+    rdispls = recvcnts + nprocs;
+    for (p = 0; p < nprocs; ++p) sendcnts[p] = 0;
+    for (t = 0; t < nloc; ++t) {
+	p = m_loc_fst ? SUPERLU_MIN( eidx[2*t] / m_loc_fst, nprocs - 1 )
+		      : nprocs - 1;
+	++sendcnts[p];
+    }
+    MPI_Alltoall(sendcnts, 1, MPI_INT, recvcnts, 1, MPI_INT, grid->comm);
+    for (p = 0, sdispls[0] = rdispls[0] = 0; p < nprocs - 1; ++p) {
+	sdispls[p+1] = sdispls[p] + sendcnts[p];
+	rdispls[p+1] = rdispls[p] + recvcnts[p];
+    }
+    nnz_loc = rdispls[nprocs-1] + recvcnts[nprocs-1];
+
+    if ( !(itmp = intMalloc_dist(2 * nloc + 3 * nnz_loc + ns + 1)) )
+	ABORT("Malloc fails for itmp[].");
+    recvidx = itmp + 2 * nloc;
+    if ( !(dtmp = doubleMalloc_dist(nloc + 2 * nnz_loc + 1)) )
+	ABORT("Malloc fails for dtmp[].");
+    sendval = dtmp;
+    recvval = dtmp + nloc;
+    for (t = 0; t < nloc; ++t) {
+	p = m_loc_fst ? SUPERLU_MIN( eidx[2*t] / m_loc_fst, nprocs - 1 )
+		      : nprocs - 1;
+	i = sdispls[p]++;
+	itmp[2*i] = eidx[2*t];
+	itmp[2*i+1] = eidx[2*t+1];
+	sendval[i] = evals[t];
+    }
+    for (p = 0; p < nprocs; ++p) sdispls[p] -= sendcnts[p];
+    SUPERLU_FREE(eidx);
+    SUPERLU_FREE(evals);
+
+    MPI_Alltoallv(sendval, sendcnts, sdispls, MPI_DOUBLE,
+		  recvval, recvcnts, rdispls, MPI_DOUBLE, grid->comm);
+    for (p = 0; p < nprocs; ++p) {
+	sendcnts[p] *= 2; sdispls[p] *= 2;
+	recvcnts[p] *= 2; rdispls[p] *= 2;
+    }
+    MPI_Alltoallv(itmp, sendcnts, sdispls, mpi_int_t,
+		  recvidx, recvcnts, rdispls, mpi_int_t, grid->comm);
+    SUPERLU_FREE(sendcnts);
+
+    /* Sort the entries by columns, then by rows, into the compressed row
+       storage. */
+    if ( !(rowptr = intMalloc_dist(m_loc + 1)) )
+	ABORT("Malloc fails for rowptr[].");
+    if ( !(colind = intMalloc_dist(nnz_loc + 1)) )
+	ABORT("Malloc fails for colind[].");
+    if ( !(nzval = doubleMalloc_dist(nnz_loc + 1)) )
+	ABORT("Malloc fails for nzval[].");
+    {
+	int_t *bycol = recvidx + 2 * nnz_loc, *cptr = bycol + nnz_loc;
+	double *valcol = recvval + nnz_loc;
+
+	for (j = 0; j <= ns; ++j) cptr[j] = 0;
+	for (t = 0; t < nnz_loc; ++t) ++cptr[recvidx[2*t+1] + 1];
+	for (j = 0; j < ns; ++j) cptr[j+1] += cptr[j];
+	for (t = 0; t < nnz_loc; ++t) {
+	    i = cptr[recvidx[2*t+1]]++;
+	    bycol[i] = t;
+	}
+	for (t = 0; t < nnz_loc; ++t) valcol[t] = recvval[bycol[t]];
+
+	for (i = 0; i <= m_loc; ++i) rowptr[i] = 0;
+	for (t = 0; t < nnz_loc; ++t) ++rowptr[recvidx[2*t] - fst_row + 1];
+	for (i = 0; i < m_loc; ++i) rowptr[i+1] += rowptr[i];
+	for (t = 0; t < nnz_loc; ++t) {
+	    irow = recvidx[2*bycol[t]] - fst_row;
+	    i = rowptr[irow]++;
+	    colind[i] = recvidx[2*bycol[t]+1];
+	    nzval[i] = valcol[t];
+	}
+	for (i = m_loc; i > 0; --i) rowptr[i] = rowptr[i-1];
+	rowptr[0] = 0;
+    }
+    SUPERLU_FREE(itmp);
+    SUPERLU_FREE(dtmp);
+    SUPERLU_FREE(iq);
+
+    dCreate_CompRowLoc_Matrix_dist(S, ns, ns, nnz_loc, m_loc, fst_row,
+				   nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_D, SLU_GE);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit pdGetSchur()");
+#endif
+} /* PDGETSCHUR */
@@ -0,0 +1,627 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Selected inversion: entries of the inverse on the pattern of L+U
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * With A1 = L*U, let W = A1^{-T}. For the supernodes K from the last to
+ * the first, with I the block rows of L(:,K) and J the block columns of
+ * U(K,:) outside the diagonal block,
+ *
+ *     Lhat(I,K) = L(I,K) * inv(L(K,K)),   Uhat(K,J) = inv(U(K,K)) * U(K,J),
+ *     W(I,K) = - W(I,J) * Uhat(K,J)^T,
+ *     W(K,J) = - Lhat(I,K)^T * W(I,J),
+ *     W(K,K) = inv(A1(K,K))^T - W(K,J) * Uhat(K,J)^T.
+ *
+ * An entry (i,j) with L(i,K) and U(K,j) nonzero is a fill entry of the
+ * elimination, so only entries of W on the pattern of L+U computed at the
+ * previous steps are used, and W is kept in blocks laid out as those of
+ * L and U. That is A1^{-1} on the pattern of (L+U)^T, which contains the
+ * transpose of the pattern of A1 and hence, through the permutations, the
+ * diagonal of A^{-1}.
+ *
+ * At step K, Lhat(I,K) is sent along the process rows and Uhat(K,J) down
+ * the process columns, as the panels of step K in pdgstrf(), and the
+ * products are summed along the process rows into the owners of W(I,K)
+ * and down the process columns into the owners of W(K,J).
+ * </pre>
+ */
+
+#include "superlu_ddefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDSELINV computes the selected inverse of the factored matrix
+ * A1 = Pc*Pr*diag(R)*A*diag(C)*Pc^T = L*U: the entries of A1^{-1} on the
+ * pattern of (L+U)^T, with the distributed L and U factors computed by
+ * pdgstrf() (for instance through pdgssvx()). The factors are not changed.
+ *
+ * Arguments
+ * =========
+ *
+ * n      (input) int (global)
+ *        The order of the matrix.
+ *
+ * LUstruct (input) dLUstruct_t*
+ *        The distributed data structures storing L and U factors,
+ *        in double precision.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * SelInv (output) dSelInvstruct_t*
+ *        On exit, SelInv->Ainv_bc_ptr[lk] holds A1^{-1}(j,i) at the position
+ *        of L(i,j) in Llu->Lnzval_bc_ptr[lk], including the diagonal block,
+ *        and SelInv->Ainv_br_ptr[lk] holds A1^{-1}(j,i) at the position of
+ *        U(i,j) in Llu->Unzval_br_ptr[lk]. It is freed by dSelInvFree().
+ *        See pdSelInvDiag() for the diagonal of A^{-1}.
+ * </pre>
+ */
+void
+pdSelInv(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid,
+	 dSelInvstruct_t *SelInv)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = Glu_persist->xsup;
+    int_t *lsub, *usub, *rinfo, *cinfo, *Lidx, *Uidx, *blkpos, *rowpos;
+    int_t nsupers, nlb, nub, k, gb, gi, gj, lk, lb, ljb, b, a, pos, lptr;
+    int_t luptr, uptr, irow, fnz, fst, klast, lidx_max, uidx_max;
+    int_t lval_max, uval_max, i, t, c, r, ri, cj;
+    int   Pr = grid->nprow, Pc = grid->npcol, iam = grid->iam;
+    int   myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+    int   krow, kcol, knsupc, nsupr, jnsupr, nbl, nrl, nbu, ncu;
+    int   nri, ncj, maxsupc;
+    double *lusup, *uval, *Lval, *Uval, *CL, *CU, *dblk, *D, *G, *w;
+    double one = 1.0, mone = -1.0, zero = 0.0;
+
+#ifdef SLU_HAVE_SINGLE
+    if ( LUstruct->sLUstruct )
+	ABORT("pdSelInv() needs the double precision factors.");
+#endif
+    if ( Llu->Udropped )
+	ABORT("pdSelInv() needs U, see options->SymValues.");
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter pdSelInv()");
+#endif
+
+    nsupers = Glu_persist->supno[n-1] + 1;
+    nlb = CEILING( nsupers, Pr );
+    nub = CEILING( nsupers, Pc );
+    for (k = 0, maxsupc = 0; k < nsupers; ++k)
+	maxsupc = SUPERLU_MAX( maxsupc, SuperSize( k ) );
+
+    /* W is stored in arrays with the shapes of the local L and U blocks. */
+    if ( !(SelInv->Ainv_bc_ptr = (double **)
+	   SUPERLU_MALLOC(nub * sizeof(double *))) )
+	ABORT("Malloc fails for Ainv_bc_ptr[].");
+    if ( !(SelInv->Ainv_br_ptr = (double **)
+	   SUPERLU_MALLOC(nlb * sizeof(double *))) )
+	ABORT("Malloc fails for Ainv_br_ptr[].");
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	SelInv->Ainv_bc_ptr[ljb] = NULL;
+	if ( gb < nsupers && (lsub = Llu->Lrowind_bc_ptr[ljb]) )
+	    if ( !(SelInv->Ainv_bc_ptr[ljb] =
+		   doubleCalloc_dist(SuperSize( gb ) * lsub[1])) )
+		ABORT("Calloc fails for Ainv_bc_ptr[*].");
+    }
+    for (lb = 0; lb < nlb; ++lb) {
+	gb = lb * Pr + myrow;
+	SelInv->Ainv_br_ptr[lb] = NULL;
+	if ( gb < nsupers && (usub = Llu->Ufstnz_br_ptr[lb]) )
+	    if ( !(SelInv->Ainv_br_ptr[lb] = doubleCalloc_dist(usub[1])) )
+		ABORT("Calloc fails for Ainv_br_ptr[*].");
+    }
+
+    /* The structure of the steps that my process row and column take part
+       in: rinfo[3*k] and rinfo[3*k+1] are the numbers of the blocks and
+       of the rows of L(:,k) outside the diagonal block in my process row,
+       and cinfo[3*k] and cinfo[3*k+1] the numbers of the blocks and of the
+       columns of U(k,:) in my process column. rinfo[3*k+2] (on process row
+       PROW(k)) is the number of blocks of U(k,:), and cinfo[3*k+2] (on
+       process column PCOL(k)) the number of off-diagonal blocks of L(:,k). */
+    if ( !(rinfo = intCalloc_dist(6 * nsupers)) )
+	ABORT("Calloc fails for rinfo[].");
+    cinfo = rinfo + 3 * nsupers;
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	if ( gb >= nsupers || !(lsub = Llu->Lrowind_bc_ptr[ljb]) ) continue;
+	rinfo[3*gb] = lsub[0];
+	rinfo[3*gb+1] = lsub[1];
+	if ( PROW( gb, grid ) == myrow ) {
+	    --rinfo[3*gb];
+	    rinfo[3*gb+1] -= SuperSize( gb );
+	}
+	cinfo[3*gb+2] = rinfo[3*gb];
+    }
+    for (lb = 0; lb < nlb; ++lb) {
+	gb = lb * Pr + myrow;
+	if ( gb >= nsupers || !(usub = Llu->Ufstnz_br_ptr[lb]) ) continue;
+	cinfo[3*gb] = usub[0];
+	for (b = 0, pos = BR_HEADER; b < usub[0]; ++b) {
+	    cinfo[3*gb+1] += SuperSize( usub[pos] );
+	    pos += UB_DESCRIPTOR + SuperSize( usub[pos] );
+	}
+	rinfo[3*gb+2] = usub[0];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, rinfo, 3 * nsupers, mpi_int_t, MPI_SUM,
+		  grid->rscp.comm);
+    MPI_Allreduce(MPI_IN_PLACE, cinfo, 3 * nsupers, mpi_int_t, MPI_SUM,
+		  grid->cscp.comm);
+
+    lidx_max = uidx_max = lval_max = uval_max = 1;
+    for (k = 0; k < nsupers; ++k) {
+	lidx_max = SUPERLU_MAX( lidx_max, 2 * rinfo[3*k] + rinfo[3*k+1] );
+	lval_max = SUPERLU_MAX( lval_max, rinfo[3*k+1] * SuperSize( k ) );
+	uidx_max = SUPERLU_MAX( uidx_max, cinfo[3*k] );
+	uval_max = SUPERLU_MAX( uval_max, cinfo[3*k+1] * SuperSize( k ) );
+    }
+    if ( !(Lidx = intMalloc_dist(lidx_max + uidx_max + nsupers + maxsupc)) )
+	ABORT("Malloc fails for Lidx[].");
+    Uidx = Lidx + lidx_max;
+    blkpos = Uidx + uidx_max;
+    rowpos = blkpos + nsupers;
+    for (i = 0; i < nsupers; ++i) blkpos[i] = EMPTY;
+    for (i = 0; i < maxsupc; ++i) rowpos[i] = EMPTY;
+    if ( !(Lval = doubleMalloc_dist(2 * (lval_max + uval_max)
+				    + 3 * maxsupc * maxsupc)) )
+	ABORT("Malloc fails for Lval[].");
+    CL = Lval + lval_max;
+    Uval = CL + lval_max;
+    CU = Uval + uval_max;
+    dblk = CU + uval_max;
+    D = dblk + maxsupc * maxsupc;
+    G = D + maxsupc * maxsupc;
+
+    for (k = nsupers - 1; k >= 0; --k) {
+	knsupc = SuperSize( k );
+	krow = PROW( k, grid );
+	kcol = PCOL( k, grid );
+	fst = FstBlockC( k );
+	klast = FstBlockC( k+1 );
+	nbl = rinfo[3*k];
+	nrl = rinfo[3*k+1];
+	nbu = cinfo[3*k];
+	ncu = cinfo[3*k+1];
+
+	/* The diagonal block L\U(k,k) to the processes forming Lhat and
+	   Uhat. */
+	if ( myrow == krow && mycol == kcol ) {
+	    lk = LBj( k, grid );
+	    nsupr = Llu->Lrowind_bc_ptr[lk][1];
+	    lusup = Llu->Lnzval_bc_ptr[lk];
+	    for (c = 0; c < knsupc; ++c)
+		for (r = 0; r < knsupc; ++r)
+		    dblk[r + c*knsupc] = lusup[r + c*nsupr];
+	}
+	if ( mycol == kcol && cinfo[3*k+2] )
+	    MPI_Bcast(dblk, knsupc * knsupc, MPI_DOUBLE, krow, grid->cscp.comm);
+	if ( myrow == krow && rinfo[3*k+2] )
+	    MPI_Bcast(dblk, knsupc * knsupc, MPI_DOUBLE, kcol, grid->rscp.comm);
+
+	/* Lhat(I,k) with the indices of its blocks, along my process row:
+	   Lval[] is nrl-by-knsupc. */
+	if ( nbl ) {
+	    if ( mycol == kcol ) {
+		lk = LBj( k, grid );
+		lsub = Llu->Lrowind_bc_ptr[lk];
+		lusup = Llu->Lnzval_bc_ptr[lk];
+		nsupr = lsub[1];
+		lptr = BC_HEADER;
+		luptr = 0;
+		if ( myrow == krow ) {
+		    lptr += LB_DESCRIPTOR + knsupc;
+		    luptr = knsupc;
+		}
+		for (i = 0; i < 2 * nbl + nrl; ++i) Lidx[i] = lsub[lptr + i];
+		for (c = 0; c < knsupc; ++c)
+		    for (r = 0; r < nrl; ++r)
+			Lval[r + c*nrl] = lusup[luptr + r + c*nsupr];
+#if defined (USE_VENDOR_BLAS)
+		dtrsm_("R", "L", "N", "U", &nrl, &knsupc, &one, dblk, &knsupc,
+		       Lval, &nrl, 1, 1, 1, 1);
+#else
+		dtrsm_("R", "L", "N", "U", &nrl, &knsupc, &one, dblk, &knsupc,
+		       Lval, &nrl);
+#endif
+	    }
+	    MPI_Bcast(Lidx, 2 * nbl + nrl, mpi_int_t, kcol, grid->rscp.comm);
+	    MPI_Bcast(Lval, nrl * knsupc, MPI_DOUBLE, kcol, grid->rscp.comm);
+	}
+
+	/* Uhat(k,J) with the numbers of its blocks, down my process column:
+	   Uval[] is knsupc-by-ncu. */
+	if ( nbu ) {
+	    if ( myrow == krow ) {
+		lk = LBi( k, grid );
+		usub = Llu->Ufstnz_br_ptr[lk];
+		uval = Llu->Unzval_br_ptr[lk];
+		pos = BR_HEADER;
+		for (b = 0, uptr = 0, cj = 0; b < nbu; ++b) {
+		    gj = usub[pos];
+		    Uidx[b] = gj;
+		    for (c = 0; c < SuperSize( gj ); ++c, ++cj) {
+			fnz = usub[pos + UB_DESCRIPTOR + c];
+			w = &Uval[cj * knsupc];
+			for (irow = fst; irow < fnz; ++irow) w[irow - fst] = 0.0;
+			for (irow = fnz; irow < klast; ++irow)
+			    w[irow - fst] = uval[uptr++];
+		    }
+		    pos += UB_DESCRIPTOR + SuperSize( gj );
+		}
+#if defined (USE_VENDOR_BLAS)
+		dtrsm_("L", "U", "N", "N", &knsupc, &ncu, &one, dblk, &knsupc,
+		       Uval, &knsupc, 1, 1, 1, 1);
+#else
+		dtrsm_("L", "U", "N", "N", &knsupc, &ncu, &one, dblk, &knsupc,
+		       Uval, &knsupc);
+#endif
+	    }
+	    MPI_Bcast(Uidx, nbu, mpi_int_t, krow, grid->cscp.comm);
+	    MPI_Bcast(Uval, knsupc * ncu, MPI_DOUBLE, krow, grid->cscp.comm);
+	}
+
+	/* The products with my blocks W(I,J): CL = - W(I,J) * Uhat(k,J)^T
+	   and CU = - Lhat(I,k)^T * W(I,J). G is W(I,J) restricted to the
+	   rows of Lhat(I,k); the entries outside the pattern of L+U multiply
+	   the columns of Uhat(k,J) that are zero. */
+	for (i = 0; i < nrl * knsupc; ++i) CL[i] = 0.0;
+	for (i = 0; i < knsupc * ncu; ++i) CU[i] = 0.0;
+	if ( nbl && nbu ) {
+	    /* W(I,J) with I >= J, in the L blocks of column J. */
+	    for (b = 0, cj = 0; b < nbu; cj += SuperSize( Uidx[b] ), ++b) {
+		gj = Uidx[b];
+		ncj = SuperSize( gj );
+		if ( !(lsub = Llu->Lrowind_bc_ptr[LBj( gj, grid )]) ) continue;
+		lusup = SelInv->Ainv_bc_ptr[LBj( gj, grid )];
+		jnsupr = lsub[1];
+		for (t = 0, pos = BC_HEADER, luptr = 0; t < lsub[0]; ++t) {
+		    blkpos[lsub[pos]] = pos;
+		    pos += LB_DESCRIPTOR + lsub[pos+1];
+		}
+		for (a = 0, pos = 0, ri = 0; a < nbl; ++a) {
+		    gi = Lidx[pos];
+		    nri = Lidx[pos+1];
+		    if ( gi >= gj && (lptr = blkpos[gi]) != EMPTY ) {
+			/* Row offset of the block in lusup[]. */
+			for (t = BC_HEADER, luptr = 0; t < lptr;
+			     t += LB_DESCRIPTOR + lsub[t+1])
+			    luptr += lsub[t+1];
+			for (t = 0; t < lsub[lptr+1]; ++t)
+			    rowpos[lsub[lptr + LB_DESCRIPTOR + t] - FstBlockC( gi )] = t;
+			for (r = 0; r < nri; ++r) {
+			    t = rowpos[Lidx[pos + LB_DESCRIPTOR + r] - FstBlockC( gi )];
+			    for (c = 0; c < ncj; ++c)
+				G[r + c*nri] = t == EMPTY ? 0.0
+					       : lusup[luptr + t + c*jnsupr];
+			}
+			for (t = 0; t < lsub[lptr+1]; ++t)
+			    rowpos[lsub[lptr + LB_DESCRIPTOR + t] - FstBlockC( gi )] = EMPTY;
+#if defined (USE_VENDOR_BLAS)
+			dgemm_("N", "T", &nri, &knsupc, &ncj, &mone, G, &nri,
+			       &Uval[cj * knsupc], &knsupc, &one, &CL[ri], &nrl,
+			       1, 1);
+			dgemm_("T", "N", &knsupc, &ncj, &nri, &mone, &Lval[ri],
+			       &nrl, G, &nri, &one, &CU[cj * knsupc], &knsupc,
+			       1, 1);
+#else
+			dgemm_("N", "T", &nri, &knsupc, &ncj, &mone, G, &nri,
+			       &Uval[cj * knsupc], &knsupc, &one, &CL[ri], &nrl);
+			dgemm_("T", "N", &knsupc, &ncj, &nri, &mone, &Lval[ri],
+			       &nrl, G, &nri, &one, &CU[cj * knsupc], &knsupc);
+#endif
+		    }
+		    ri += nri;
+		    pos += LB_DESCRIPTOR + nri;
+		}
+		for (t = 0, pos = BC_HEADER; t < lsub[0]; ++t) {
+		    blkpos[lsub[pos]] = EMPTY;
+		    pos += LB_DESCRIPTOR + lsub[pos+1];
+		}
+	    }
+
+	    /* W(I,J) with I < J, in the U blocks of row I. */
+	    for (a = 0, pos = 0, ri = 0; a < nbl;
+		 ri += Lidx[pos+1], pos += LB_DESCRIPTOR + Lidx[pos+1], ++a) {
+		gi = Lidx[pos];
+		nri = Lidx[pos+1];
+		if ( !(usub = Llu->Ufstnz_br_ptr[LBi( gi, grid )]) ) continue;
+		uval = SelInv->Ainv_br_ptr[LBi( gi, grid )];
+		for (t = 0, lptr = BR_HEADER; t < usub[0]; ++t) {
+		    blkpos[usub[lptr]] = lptr;
+		    lptr += UB_DESCRIPTOR + SuperSize( usub[lptr] );
+		}
+		for (b = 0, cj = 0; b < nbu; cj += SuperSize( Uidx[b] ), ++b) {
+		    gj = Uidx[b];
+		    ncj = SuperSize( gj );
+		    if ( gj <= gi || (lptr = blkpos[gj]) == EMPTY ) continue;
+		    /* Offset of the block in uval[]. */
+		    for (t = BR_HEADER, uptr = 0; t < lptr;
+			 t += UB_DESCRIPTOR + SuperSize( usub[t] ))
+			uptr += usub[t+1];
+		    for (c = 0; c < ncj; ++c) {
+			fnz = usub[lptr + UB_DESCRIPTOR + c];
+			for (r = 0; r < nri; ++r) {
+			    irow = Lidx[pos + LB_DESCRIPTOR + r];
+			    G[r + c*nri] = irow < fnz ? 0.0
+					   : uval[uptr + irow - fnz];
+			}
+			uptr += FstBlockC( gi+1 ) - fnz;
+		    }
+#if defined (USE_VENDOR_BLAS)
+		    dgemm_("N", "T", &nri, &knsupc, &ncj, &mone, G, &nri,
+			   &Uval[cj * knsupc], &knsupc, &one, &CL[ri], &nrl,
+			   1, 1);
+		    dgemm_("T", "N", &knsupc, &ncj, &nri, &mone, &Lval[ri],
+			   &nrl, G, &nri, &one, &CU[cj * knsupc], &knsupc,
+			   1, 1);
+#else
+		    dgemm_("N", "T", &nri, &knsupc, &ncj, &mone, G, &nri,
+			   &Uval[cj * knsupc], &knsupc, &one, &CL[ri], &nrl);
+		    dgemm_("T", "N", &knsupc, &ncj, &nri, &mone, &Lval[ri],
+			   &nrl, G, &nri, &one, &CU[cj * knsupc], &knsupc);
+#endif
+		}
+		for (t = 0, lptr = BR_HEADER; t < usub[0]; ++t) {
+		    blkpos[usub[lptr]] = EMPTY;
+		    lptr += UB_DESCRIPTOR + SuperSize( usub[lptr] );
+		}
+	    }
+	}
+
+	/* W(I,k) = sum of CL along my process row, into the L blocks of
+	   column k. */
+	if ( nbl ) {
+	    MPI_Reduce(mycol == kcol ? MPI_IN_PLACE : CL, CL, nrl * knsupc,
+		       MPI_DOUBLE, MPI_SUM, kcol, grid->rscp.comm);
+	    if ( mycol == kcol ) {
+		lk = LBj( k, grid );
+		nsupr = Llu->Lrowind_bc_ptr[lk][1];
+		w = SelInv->Ainv_bc_ptr[lk];
+		luptr = myrow == krow ? knsupc : 0;
+		for (c = 0; c < knsupc; ++c)
+		    for (r = 0; r < nrl; ++r)
+			w[luptr + r + c*nsupr] = CL[r + c*nrl];
+	    }
+	}
+
+	/* W(k,J) = sum of CU down my process column, into the U blocks of
+	   row k. */
+	if ( nbu ) {
+	    MPI_Reduce(myrow == krow ? MPI_IN_PLACE : CU, CU, knsupc * ncu,
+		       MPI_DOUBLE, MPI_SUM, krow, grid->cscp.comm);
+	    if ( myrow == krow ) {
+		lk = LBi( k, grid );
+		usub = Llu->Ufstnz_br_ptr[lk];
+		w = SelInv->Ainv_br_ptr[lk];
+		pos = BR_HEADER;
+		for (b = 0, uptr = 0, cj = 0; b < nbu; ++b) {
+		    gj = usub[pos];
+		    for (c = 0; c < SuperSize( gj ); ++c, ++cj) {
+			fnz = usub[pos + UB_DESCRIPTOR + c];
+			for (irow = fnz; irow < klast; ++irow)
+			    w[uptr++] = CU[irow - fst + cj * knsupc];
+		    }
+		    pos += UB_DESCRIPTOR + SuperSize( gj );
+		}
+	    }
+	}
+
+	/* W(k,k) = inv(A1(k,k))^T - W(k,J) * Uhat(k,J)^T on the diagonal
+	   process. */
+	if ( myrow == krow && rinfo[3*k+2] ) {
+	    if ( nbu ) {
+#if defined (USE_VENDOR_BLAS)
+		dgemm_("N", "T", &knsupc, &knsupc, &ncu, &mone, CU, &knsupc,
+		       Uval, &knsupc, &zero, D, &knsupc, 1, 1);
+#else
+		dgemm_("N", "T", &knsupc, &knsupc, &ncu, &mone, CU, &knsupc,
+		       Uval, &knsupc, &zero, D, &knsupc);
+#endif
+	    } else {
+		for (i = 0; i < knsupc * knsupc; ++i) D[i] = 0.0;
+	    }
+	    MPI_Reduce(mycol == kcol ? MPI_IN_PLACE : D, D, knsupc * knsupc,
+		       MPI_DOUBLE, MPI_SUM, kcol, grid->rscp.comm);
+	}
+	if ( myrow == krow && mycol == kcol ) {
+	    lk = LBj( k, grid );
+	    nsupr = Llu->Lrowind_bc_ptr[lk][1];
+	    w = SelInv->Ainv_bc_ptr[lk];
+	    for (c = 0; c < knsupc; ++c)
+		for (r = 0; r < knsupc; ++r)
+		    w[r + c*nsupr] = r == c ? 1.0 : 0.0;
+	    /* inv(A1(k,k))^T = inv(L(k,k))^T * inv(U(k,k))^T */
+#if defined (USE_VENDOR_BLAS)
+	    dtrsm_("L", "U", "T", "N", &knsupc, &knsupc, &one, dblk, &knsupc,
+		   w, &nsupr, 1, 1, 1, 1);
+	    dtrsm_("L", "L", "T", "U", &knsupc, &knsupc, &one, dblk, &knsupc,
+		   w, &nsupr, 1, 1, 1, 1);
+#else
+	    dtrsm_("L", "U", "T", "N", &knsupc, &knsupc, &one, dblk, &knsupc,
+		   w, &nsupr);
+	    dtrsm_("L", "L", "T", "U", &knsupc, &knsupc, &one, dblk, &knsupc,
+		   w, &nsupr);
+#endif
+	    if ( rinfo[3*k+2] )
+		for (c = 0; c < knsupc; ++c)
+		    for (r = 0; r < knsupc; ++r)
+			w[r + c*nsupr] += D[r + c*knsupc];
+	}
+    } /* for k ... */
+
+    SUPERLU_FREE(Lval);
+    SUPERLU_FREE(Lidx);
+    SUPERLU_FREE(rinfo);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit pdSelInv()");
+#endif
+} /* PDSELINV */
+
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDSELINVDIAG gathers the diagonal of A^{-1} from the selected inverse
+ * computed by pdSelInv(). With A1 = Pc*Pr*diag(R)*A*diag(C)*Pc^T,
+ *
+ *     A^{-1}(j,j) = C(j) * A1^{-1}(Pc(j), Pc(Pr(j))) * R(j),
+ *
+ * which is computed if A(j,j) is in the pattern of A.
+ *
+ * Arguments
+ * =========
+ *
+ * n      (input) int (global)
+ *        The order of the matrix.
+ *
+ * ScalePermstruct (input) dScalePermstruct_t*
+ *        The scaling and permutations of the factorization.
+ *
+ * LUstruct (input) dLUstruct_t*
+ *        The distributed L and U factors.
+ *
+ * SelInv (input) dSelInvstruct_t*
+ *        The selected inverse computed by pdSelInv().
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * diag   (output) double*, dimension (n)
+ *        The diagonal of A^{-1}; on exit, it is available on all processes.
+ *
+ * Return value
+ * ============
+ *
+ * The number of diagonal entries outside the pattern of (L+U)^T, which
+ * are set to zero; there are none if A has no structural zero on its
+ * diagonal.
+ * </pre>
+ */
+int_t
+pdSelInvDiag(int_t n, dScalePermstruct_t *ScalePermstruct,
+	     dLUstruct_t *LUstruct, dSelInvstruct_t *SelInv,
+	     gridinfo_t *grid, double *diag)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *perm_r = ScalePermstruct->perm_r, *perm_c = ScalePermstruct->perm_c;
+    int_t *iq, *lsub, *usub, nsupers, nlb, nub, gb, gj, lb, ljb, b, pos;
+    int_t luptr, uptr, irow, fnz, j, p, q, c, t, nfound;
+    int   Pr = grid->nprow, Pc = grid->npcol;
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    int   knsupc, nsupr;
+    double *w;
+
+    nsupers = supno[n-1] + 1;
+    nlb = CEILING( nsupers, Pr );
+    nub = CEILING( nsupers, Pc );
+
+    /* iq[q] = j for the row q = Pc(Pr(j)) of A1. */
+    if ( !(iq = intMalloc_dist(n)) ) ABORT("Malloc fails for iq[].");
+    for (j = 0; j < n; ++j) iq[perm_c[perm_r[j]]] = j;
+    for (j = 0; j < n; ++j) diag[j] = 0.0;
+    nfound = 0;
+
+    /* The entries (q,p) of W = A1^{-T} with p = Pc(iq[q]), in the L blocks
+       (including the diagonal blocks) and in the U blocks. */
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	if ( gb >= nsupers || !(lsub = Llu->Lrowind_bc_ptr[ljb]) ) continue;
+	w = SelInv->Ainv_bc_ptr[ljb];
+	nsupr = lsub[1];
+	for (b = 0, pos = BC_HEADER, luptr = 0; b < lsub[0]; ++b) {
+	    for (t = 0; t < lsub[pos+1]; ++t) {
+		q = lsub[pos + LB_DESCRIPTOR + t];
+		p = perm_c[iq[q]];
+		if ( supno[p] == gb ) {
+		    diag[iq[q]] = w[luptr + t + (p - FstBlockC( gb )) * nsupr];
+		    ++nfound;
+		}
+	    }
+	    luptr += lsub[pos+1];
+	    pos += LB_DESCRIPTOR + lsub[pos+1];
+	}
+    }
+    for (lb = 0; lb < nlb; ++lb) {
+	gb = lb * Pr + myrow;
+	if ( gb >= nsupers || !(usub = Llu->Ufstnz_br_ptr[lb]) ) continue;
+	w = SelInv->Ainv_br_ptr[lb];
+	for (b = 0, pos = BR_HEADER, uptr = 0; b < usub[0]; ++b) {
+	    gj = usub[pos];
+	    knsupc = SuperSize( gj );
+	    for (c = 0; c < knsupc; ++c) {
+		fnz = usub[pos + UB_DESCRIPTOR + c];
+		p = FstBlockC( gj ) + c;
+		for (irow = fnz; irow < FstBlockC( gb+1 ); ++irow, ++uptr)
+		    if ( perm_c[iq[irow]] == p ) {
+			diag[iq[irow]] = w[uptr];
+			++nfound;
+		    }
+	    }
+	    pos += UB_DESCRIPTOR + knsupc;
+	}
+    }
+    MPI_Allreduce(MPI_IN_PLACE, diag, n, MPI_DOUBLE, MPI_SUM, grid->comm);
+    MPI_Allreduce(MPI_IN_PLACE, &nfound, 1, mpi_int_t, MPI_SUM, grid->comm);
+
+    switch ( ScalePermstruct->DiagScale ) {
+	case ROW:
+	    for (j = 0; j < n; ++j) diag[j] *= ScalePermstruct->R[j];
+	    break;
+	case COL:
+	    for (j = 0; j < n; ++j) diag[j] *= ScalePermstruct->C[j];
+	    break;
+	case BOTH:
+	    for (j = 0; j < n; ++j)
+		diag[j] *= ScalePermstruct->R[j] * ScalePermstruct->C[j];
+	    break;
+	default:
+	    break;
+    }
+
+    SUPERLU_FREE(iq);
+    return n - nfound;
+} /* PDSELINVDIAG */
+
+
+/*! \brief Free the storage of the selected inverse.
+ */
+void
+dSelInvFree(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct,
+	    dSelInvstruct_t *SelInv)
+{
+    int_t i, nsupers = LUstruct->Glu_persist->supno[n-1] + 1;
+    int_t nlb = CEILING( nsupers, grid->nprow );
+    int_t nub = CEILING( nsupers, grid->npcol );
+
+    for (i = 0; i < nub; ++i)
+	if ( SelInv->Ainv_bc_ptr[i] ) SUPERLU_FREE(SelInv->Ainv_bc_ptr[i]);
+    for (i = 0; i < nlb; ++i)
+	if ( SelInv->Ainv_br_ptr[i] ) SUPERLU_FREE(SelInv->Ainv_br_ptr[i]);
+    SUPERLU_FREE(SelInv->Ainv_bc_ptr);
+    SUPERLU_FREE(SelInv->Ainv_br_ptr);
+}
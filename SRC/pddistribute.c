@@ -53,6 +53,16 @@ at the top-level directory.
  *
  * a      (output) double*
  *
+ * Amap   (output) dAmap_t*
+ *        If not NULL, the send side of the value map (see pddistribute())
+ *        is recorded: Amap->send_slot[], the counts and displacements,
+ *        Amap->nnz_loc, Amap->nlocal and Amap->nrecv.
+ *
+ * pos    (output) int_t**
+ *        If not NULL, (*pos)[k] is the position in the received order
+ *        (the local entries first, then by sending process) of the entry
+ *        k of the output (colptr, rowind, a).
+ *
  * Return value
  * ============
  *   > 0, working storage (in bytes) required to perform redistribution.
@@ -63,7 +73,7 @@ int_t
 dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
                 Glu_freeable_t *Glu_freeable, int_t *xsup, int_t *supno,
                 gridinfo_t *grid, int_t *colptr[], int_t *rowind[],
-                double *a[])
+                double *a[], dAmap_t *Amap, int_t *pos[])
 {
     NRformat_loc *Astore;
     int_t  *perm_r; /* row permutation vector */
@@ -72,15 +82,14 @@ dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
     int_t  nnz_loc;    /* number of local nonzeros */
     int_t  SendCnt; /* number of remote nonzeros to be sent */
     int_t  RecvCnt; /* number of remote nonzeros to be sent */
-    int_t  *nnzToSend, *nnzToRecv, maxnnzToRecv;
-    int_t  *ia, *ja, **ia_send, *index, *itemp;
+    int_t  *nnzToSend, *nnzToRecv;
+    int_t  *ia, *ja, **ia_send, *index;
     int_t  *ptr_to_send;
-    double *aij, **aij_send, *nzval, *dtemp;
+    double *aij, **aij_send, *nzval;
     double *nzval_a;
 	double asum,asum_tot;
-    int    iam, it, p, procs, iam_g;
-    MPI_Request *send_req;
-    MPI_Status  status;
+    int    iam, p, procs, iam_g;
+    int    *sendcnts, *sdispls, *recvcnts, *rdispls;
 
 
     /* ------------------------------------------------------------
@@ -120,14 +129,12 @@ dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
     MPI_Alltoall( nnzToSend, 1, mpi_int_t, nnzToRecv, 1, mpi_int_t,
 		  grid->comm);
 
-    maxnnzToRecv = 0;
     nnz_loc = SendCnt = RecvCnt = 0;
 
     for (p = 0; p < procs; ++p) {
 	if ( p != iam ) {
 	    SendCnt += nnzToSend[p];
 	    RecvCnt += nnzToRecv[p];
-	    maxnnzToRecv = SUPERLU_MAX( nnzToRecv[p], maxnnzToRecv );
 	} else {
 	    nnz_loc += nnzToRecv[p];
 	    /*assert(nnzToSend[p] == nnzToRecv[p]);*/
@@ -135,20 +142,48 @@ dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
     }
     k = nnz_loc + RecvCnt; /* Total nonzeros ended up in my process. */
 
-    /* Allocate space for storing the triplets after redistribution. */
+    if ( Amap ) {
+	Amap->nnz_loc = Astore->rowptr[m_loc];
+	Amap->nlocal = nnz_loc;
+	Amap->nrecv = k;
+	if ( !(Amap->send_slot = intMalloc_dist(SUPERLU_MAX(Amap->nnz_loc,1))) )
+	    ABORT("Malloc fails for Amap->send_slot[].");
+	if ( !(Amap->sendcnt = SUPERLU_MALLOC(4 * procs * sizeof(int))) )
+	    ABORT("Malloc fails for Amap->sendcnt[].");
+	Amap->sdispls = Amap->sendcnt + procs;
+	Amap->recvcnt = Amap->sdispls + procs;
+	Amap->rdispls = Amap->recvcnt + procs;
+	for (i = 0, j = 0, p = 0; p < procs; ++p) {
+	    Amap->sendcnt[p] = ( p != iam ) ? nnzToSend[p] : 0;
+	    Amap->recvcnt[p] = ( p != iam ) ? nnzToRecv[p] : 0;
+	    Amap->sdispls[p] = i;
+	    Amap->rdispls[p] = j;
+	    i += Amap->sendcnt[p];
+	    j += Amap->recvcnt[p];
+	}
+    }
+
+    /* Allocate space for storing the triplets after redistribution.
+       The remote entries are received directly behind the local ones. */
+    ia = ja = index = NULL;
+    aij = nzval = NULL;
     if ( k ) { /* count can be zero. */
-        if ( !(ia = intMalloc_dist(2*k)) )
+        if ( !(ia = intMalloc_dist(k)) )
             ABORT("Malloc fails for ia[].");
+        if ( !(ja = intMalloc_dist(k)) )
+            ABORT("Malloc fails for ja[].");
         if ( !(aij = doubleMalloc_dist(k)) )
             ABORT("Malloc fails for aij[].");
     }
-    ja = ia + k;
 
-    /* Allocate temporary storage for sending/receiving the A triplets. */
+    /* Allocate temporary storage for sending the A triplets: the row
+       indices in index[0:SendCnt-1], the column indices behind them. */
     if ( procs > 1 ) {
-      if ( !(send_req = (MPI_Request *)
-	     SUPERLU_MALLOC(2*procs *sizeof(MPI_Request))) )
-	ABORT("Malloc fails for send_req[].");
+      if ( !(sendcnts = (int *) SUPERLU_MALLOC(4*procs * sizeof(int))) )
+	ABORT("Malloc fails for sendcnts[].");
+      sdispls = sendcnts + procs;
+      recvcnts = sdispls + procs;
+      rdispls = recvcnts + procs;
       if ( !(ia_send = (int_t **) SUPERLU_MALLOC(procs*sizeof(int_t*))) )
         ABORT("Malloc fails for ia_send[].");
       if ( !(aij_send = (double **)SUPERLU_MALLOC(procs*sizeof(double*))) )
@@ -161,20 +196,16 @@ dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
       }
       if ( !(ptr_to_send = intCalloc_dist(procs)) )
         ABORT("Malloc fails for ptr_to_send[].");
-      if ( maxnnzToRecv ) { /* count can be zero */
-          if ( !(itemp = intMalloc_dist(2*maxnnzToRecv)) )
-              ABORT("Malloc fails for itemp[].");
-          if ( !(dtemp = doubleMalloc_dist(maxnnzToRecv)) )
-              ABORT("Malloc fails for dtemp[].");
-      }
 
       for (i = 0, j = 0, p = 0; p < procs; ++p) {
-          if ( p != iam ) {
-	      ia_send[p] = &index[i];
-	      i += 2 * nnzToSend[p]; /* ia/ja indices alternate */
-	      aij_send[p] = &nzval[j];
-	      j += nnzToSend[p];
-	  }
+	  sendcnts[p] = ( p != iam ) ? nnzToSend[p] : 0;
+	  recvcnts[p] = ( p != iam ) ? nnzToRecv[p] : 0;
+	  sdispls[p] = i;
+	  rdispls[p] = j;
+	  ia_send[p] = &index[i];
+	  aij_send[p] = &nzval[i];
+	  i += sendcnts[p];
+	  j += recvcnts[p];
       }
     } /* if procs > 1 */
 
@@ -197,69 +228,39 @@ dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
 
 	    if ( p != iam ) { /* remote */
 	        k = ptr_to_send[p];
+		if ( Amap )
+		    Amap->send_slot[j] = Amap->nlocal + Amap->sdispls[p] + k;
 	        ia_send[p][k] = irow;
-	        ia_send[p][k + nnzToSend[p]] = jcol;
+	        ia_send[p][k + SendCnt] = jcol;
 		aij_send[p][k] = nzval_a[j];
 		++ptr_to_send[p];
 	    } else {          /* local */
+		if ( Amap ) Amap->send_slot[j] = nnz_loc;
 	        ia[nnz_loc] = irow;
 	        ja[nnz_loc] = jcol;
 		aij[nnz_loc] = nzval_a[j];
 		++nnz_loc;
-		++(*colptr)[jcol]; /* Count nonzeros in each column */
-	    }
-	}
-    }
-
-    /* ------------------------------------------------------------
-       PERFORM REDISTRIBUTION. THIS INVOLVES ALL-TO-ALL COMMUNICATION.
-       NOTE: Can possibly use MPI_Alltoallv.
-       ------------------------------------------------------------*/
-    for (p = 0; p < procs; ++p) {
-        if ( p != iam ) {
-	    it = 2*nnzToSend[p];
-	    MPI_Isend( ia_send[p], it, mpi_int_t,
-		       p, iam, grid->comm, &send_req[p] );
-	    it = nnzToSend[p];
-	    MPI_Isend( aij_send[p], it, MPI_DOUBLE,
-	               p, iam+procs, grid->comm, &send_req[procs+p] );
-	}
-    }
-
-    for (p = 0; p < procs; ++p) {
-        if ( p != iam ) {
-	    it = 2*nnzToRecv[p];
-	    MPI_Recv( itemp, it, mpi_int_t, p, p, grid->comm, &status );
-	    it = nnzToRecv[p];
-            MPI_Recv( dtemp, it, MPI_DOUBLE, p, p+procs,
-		      grid->comm, &status );
-	    for (i = 0; i < nnzToRecv[p]; ++i) {
-	        ia[nnz_loc] = itemp[i];
-		jcol = itemp[i + nnzToRecv[p]];
-		/*assert(jcol<n);*/
-	        ja[nnz_loc] = jcol;
-		aij[nnz_loc] = dtemp[i];
-		++nnz_loc;
-		++(*colptr)[jcol]; /* Count nonzeros in each column */
 	    }
 	}
     }
 
-    for (p = 0; p < procs; ++p) {
-        if ( p != iam ) {
-	    MPI_Wait( &send_req[p], &status);
-	    MPI_Wait( &send_req[procs+p], &status);
-	}
-    }
-
     /* ------------------------------------------------------------
-       DEALLOCATE TEMPORARY STORAGE
+       PERFORM REDISTRIBUTION. THIS INVOLVES ALL-TO-ALL COMMUNICATION:
+       ONE MPI_Alltoallv EACH FOR THE ROW INDICES, THE COLUMN INDICES
+       AND THE VALUES, RECEIVED IN PLACE INTO (IA,JA,AIJ).
+       The entries from process p are after those from processes < p,
+       as in the map of the values recorded in Amap.
        ------------------------------------------------------------*/
-
-    SUPERLU_FREE(nnzToRecv);
-
     if ( procs > 1 ) {
-	SUPERLU_FREE(send_req);
+	MPI_Alltoallv(index, sendcnts, sdispls, mpi_int_t,
+		      ia + nnz_loc, recvcnts, rdispls, mpi_int_t, grid->comm);
+	MPI_Alltoallv(index + SendCnt, sendcnts, sdispls, mpi_int_t,
+		      ja + nnz_loc, recvcnts, rdispls, mpi_int_t, grid->comm);
+	MPI_Alltoallv(nzval, sendcnts, sdispls, MPI_DOUBLE,
+		      aij + nnz_loc, recvcnts, rdispls, MPI_DOUBLE, grid->comm);
+	nnz_loc += RecvCnt;
+
+	SUPERLU_FREE(sendcnts);
 	SUPERLU_FREE(ia_send);
 	SUPERLU_FREE(aij_send);
 	if ( SendCnt ) {
@@ -267,21 +268,15 @@ dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
             SUPERLU_FREE(nzval);
         }
 	SUPERLU_FREE(ptr_to_send);
-        if ( maxnnzToRecv ) {
-            SUPERLU_FREE(itemp);
-            SUPERLU_FREE(dtemp);
-        }
     }
+    SUPERLU_FREE(nnzToRecv);
 
     /* ------------------------------------------------------------
        CONVERT THE TRIPLET FORMAT INTO THE CCS FORMAT.
+       Each of (IA,JA,AIJ) is freed as soon as it has been consumed,
+       so that at most four arrays of length nnz_loc are live.
        ------------------------------------------------------------*/
-    if ( nnz_loc ) { /* nnz_loc can be zero */
-        if ( !(*rowind = intMalloc_dist(nnz_loc)) )
-            ABORT("Malloc fails for *rowind[].");
-        if ( !(*a = doubleMalloc_dist(nnz_loc)) )
-            ABORT("Malloc fails for *a[].");
-    }
+    for (i = 0; i < nnz_loc; ++i) ++(*colptr)[ja[i]]; /* Count nonzeros in each column */
 
     /* Initialize the array of column pointers */
     k = 0;
@@ -293,24 +288,35 @@ dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
 	(*colptr)[j] = k;
     }
 
-    /* Copy the triplets into the column oriented storage */
+    /* Place the row indices, keeping the position of entry i in ja[i] */
+    if ( pos ) *pos = NULL;
+    if ( nnz_loc && !(*rowind = intMalloc_dist(nnz_loc)) )
+        ABORT("Malloc fails for *rowind[].");
     for (i = 0; i < nnz_loc; ++i) {
 	j = ja[i];
-	k = (*colptr)[j];
+	k = (*colptr)[j]++;
 	(*rowind)[k] = ia[i];
-	(*a)[k] = aij[i];
-	++(*colptr)[j];
+	ja[i] = k;
+    }
+    if ( nnz_loc ) SUPERLU_FREE(ia);
+
+    /* Then the values */
+    if ( nnz_loc && !(*a = doubleMalloc_dist(nnz_loc)) )
+        ABORT("Malloc fails for *a[].");
+    for (i = 0; i < nnz_loc; ++i) (*a)[ja[i]] = aij[i];
+    if ( nnz_loc ) SUPERLU_FREE(aij);
+
+    if ( pos && nnz_loc ) {
+        if ( !(*pos = intMalloc_dist(nnz_loc)) )
+            ABORT("Malloc fails for *pos[].");
+        for (i = 0; i < nnz_loc; ++i) (*pos)[ja[i]] = i;
     }
+    if ( nnz_loc ) SUPERLU_FREE(ja);
 
     /* Reset the column pointers to the beginning of each column */
     for (j = n; j > 0; --j) (*colptr)[j] = (*colptr)[j-1];
     (*colptr)[0] = 0;
 
-    if ( nnz_loc ) {
-        SUPERLU_FREE(ia);
-        SUPERLU_FREE(aij);
-    }
-
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(iam, "Exit dReDistribute_A()");
 #endif
@@ -318,6 +324,180 @@ dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
     return 0;
 } /* dReDistribute_A */
 
+/*! \brief Move the values of A into L and U with the recorded map.
+ *
+ * <pre>
+ * The entries of L and U not in A are set to zero. Only the values of A
+ * are communicated, with one MPI_Alltoallv. With Llu->sn_dirty (see
+ * pdgsrefactor_partial()), only the panels of the dirty supernodes are
+ * refilled, the others keep their factors.
+ * </pre>
+ */
+static void
+dAmap_scatter(SuperMatrix *A, dLocalLU_t *Llu, int_t *xsup, int_t nsupers,
+	      gridinfo_t *grid)
+{
+    dAmap_t *Amap = Llu->Amap;
+    double *nzval_a = (double *) ((NRformat_loc *) A->Store)->nzval;
+    double *sendbuf = Amap->sendbuf, *recvbuf = Amap->recvbuf;
+    double **dst = Amap->dst;
+    int_t  *send_slot = Amap->send_slot, *index;
+    int_t  i, lb, len, nlocal = Amap->nlocal;
+    int    myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    int    *dst_sn = Amap->dst_sn;
+    char   *dirty = Llu->sn_dirty;
+
+    /* The blocks, the slots and the destinations are all distinct, so
+       that the loops are shared by the threads. */
+#ifdef _OPENMP
+#pragma omp parallel private(i, index, len)
+#endif
+    {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16) nowait
+#endif
+    for (lb = 0; lb < CEILING( nsupers, grid->nprow ); ++lb)
+	if ( (index = Llu->Ufstnz_br_ptr[lb])
+	     && (!dirty || dirty[lb * grid->nprow + myrow]) ) {
+	    len = index[1];
+	    for (i = 0; i < len; ++i) Llu->Unzval_br_ptr[lb][i] = 0.0;
+	}
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16) nowait
+#endif
+    for (lb = 0; lb < CEILING( nsupers, grid->npcol ); ++lb)
+	if ( (index = Llu->Lrowind_bc_ptr[lb])
+	     && (!dirty || dirty[lb * grid->npcol + mycol]) ) {
+	    len = index[1] * SuperSize( lb * grid->npcol + mycol );
+	    for (i = 0; i < len; ++i) Llu->Lnzval_bc_ptr[lb][i] = 0.0;
+	}
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (i = 0; i < Amap->nnz_loc; ++i) sendbuf[send_slot[i]] = nzval_a[i];
+    }
+    MPI_Alltoallv(sendbuf + nlocal, Amap->sendcnt, Amap->sdispls, MPI_DOUBLE,
+		  recvbuf, Amap->recvcnt, Amap->rdispls, MPI_DOUBLE,
+		  grid->comm);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+#ifdef _OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+    for (i = 0; i < nlocal; ++i)
+	if ( dst[i] && (!dirty || dirty[dst_sn[i]]) ) *dst[i] = sendbuf[i];
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (i = nlocal; i < Amap->nrecv; ++i)
+	if ( dst[i] && (!dirty || dirty[dst_sn[i]]) ) *dst[i] = recvbuf[i - nlocal];
+    }
+}
+
+/*! \brief Free the value map recorded by pddistribute(), if any.
+ */
+void
+dDestroy_Amap(dLocalLU_t *Llu)
+{
+    dAmap_t *Amap = Llu->Amap;
+
+    if ( !Amap ) return;
+    SUPERLU_FREE(Amap->send_slot);
+    SUPERLU_FREE(Amap->sendcnt);
+    SUPERLU_FREE(Amap->dst);
+    SUPERLU_FREE(Amap->dst_sn);
+    SUPERLU_FREE(Amap->sendbuf);
+    SUPERLU_FREE(Amap->recvbuf);
+    SUPERLU_FREE(Amap);
+    Llu->Amap = NULL;
+}
+
+/*! \brief Count the entries of A outside the structure of L and U.
+ *
+ * <pre>
+ * A is in the form pddistribute() takes, with the column indices of
+ * Pc*A (see pdgssvx()); the row permutation is that of ScalePermstruct.
+ * The return value, the same on all processes, is the number of entries
+ * of A that have no place in the L and U of LUstruct, 0 if they can be
+ * refilled with pddistribute(SamePattern_SameRowPerm, ...). The values
+ * of A are not used.
+ * </pre>
+ */
+int_t
+pdLU_pattern_check(int_t n, SuperMatrix *A,
+		   dScalePermstruct_t *ScalePermstruct, dLUstruct_t *LUstruct,
+		   gridinfo_t *grid)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *xa, *asub, *index, *mark, *Ublk, *Upos;
+    int_t nsupers = supno[n-1] + 1, nrbu, nb, missing = 0, gmissing;
+    int_t i, j, jb, gb, lb, k, r, nrbl, len;
+    double *a;
+    int   mycol = MYCOL(grid->iam, grid);
+
+    dReDistribute_A(A, ScalePermstruct, NULL, xsup, supno, grid,
+		    &xa, &asub, &a, NULL, NULL);
+
+    /* Per local block row of U: the next block and its place in index[],
+       advanced with jb as in pddistribute(). */
+    nrbu = CEILING( nsupers, grid->nprow );
+    if ( !(mark = intMalloc_dist(n + 2 * nrbu)) )
+	ABORT("Malloc fails for mark[].");
+    Ublk = mark + n;
+    Upos = Ublk + nrbu;
+    for (i = 0; i < n; ++i) mark[i] = EMPTY;
+    for (lb = 0; lb < nrbu; ++lb) { Ublk[lb] = 0; Upos[lb] = BR_HEADER; }
+
+    for (jb = 0; jb < nsupers; ++jb) {
+	if ( mycol != PCOL( jb, grid ) ) continue;
+	/* Mark the rows of L(:,jb), the diagonal block included. */
+	if ( (index = Llu->Lrowind_bc_ptr[LBj( jb, grid )]) ) {
+	    nrbl = index[0];
+	    for (k = BC_HEADER, r = 0; r < nrbl; ++r) {
+		len = index[k + 1];
+		for (k += LB_DESCRIPTOR, i = 0; i < len; ++i, ++k)
+		    mark[index[k]] = jb;
+	    }
+	}
+	for (j = FstBlockC( jb ); j < FstBlockC( jb+1 ); ++j) {
+	    for (i = xa[j]; i < xa[j+1]; ++i) {
+		gb = BlockNum( asub[i] );
+		if ( gb >= jb ) { /* in L */
+		    if ( mark[asub[i]] != jb ) ++missing;
+		    continue;
+		}
+		/* In U: find block (gb,jb) in the block row; the entry is in
+		   it if it is not above the first nonzero of its column. */
+		lb = LBi( gb, grid );
+		index = Llu->Ufstnz_br_ptr[lb];
+		nb = index ? index[0] : 0;
+		while ( Ublk[lb] < nb && index[Upos[lb]] < jb ) {
+		    Upos[lb] += UB_DESCRIPTOR + SuperSize( index[Upos[lb]] );
+		    ++Ublk[lb];
+		}
+		if ( Ublk[lb] == nb || index[Upos[lb]] != jb
+		     || asub[i] < index[Upos[lb] + UB_DESCRIPTOR
+					+ j - FstBlockC( jb )] )
+		    ++missing;
+	    }
+	}
+    }
+
+    SUPERLU_FREE(mark);
+    if ( xa[A->ncol] > 0 ) {
+	SUPERLU_FREE(asub);
+	SUPERLU_FREE(a);
+    }
+    SUPERLU_FREE(xa);
+    MPI_Allreduce(&missing, &gmissing, 1, mpi_int_t, MPI_SUM, grid->comm);
+    return gmissing;
+}
+
 float
 pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 	     dScalePermstruct_t *ScalePermstruct,
@@ -340,6 +520,11 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
  *        Specifies whether or not the L and U structures will be re-used.
  *        = SamePattern_SameRowPerm: L and U structures are input, and
  *                                   unchanged on exit.
+ *                                   The first time, the places of the
+ *                                   entries of A in L and U are recorded
+ *                                   in LUstruct->Llu->Amap; the following
+ *                                   times, the values are moved directly
+ *                                   to these places.
  *        = DOFACT or SamePattern: L and U structures are computed and output.
  *
  * n      (input) int
@@ -467,6 +652,10 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
     int_t  lptr1_tmp, idx_i, idx_v,m, uu;
     int_t nub;
     int tag;
+    dAmap_t *Amap = NULL; /* recorded at this call */
+    size_t slab_len, slab_pos; /* lengths in Llu->Lnzval_slab/Unzval_slab */
+    int_t *apos = NULL;   /* received position of each entry of (xa,asub,a) */
+    int_t *dense_pos;     /* SPA of the received positions, for the map */
 
 #if ( PRNTlevel>=1 )
     int_t nLblocks = 0, nUblocks = 0;
@@ -496,8 +685,30 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
     t = SuperLU_timer_();
 #endif
 
+    if ( fact == SamePattern_SameRowPerm && Llu->Amap ) {
+	/* Nothing to compute: L and U are refilled with the recorded map. */
+	dAmap_scatter(A, Llu, xsup, nsupers, grid);
+#if ( PROFlevel>=1 )
+	t = SuperLU_timer_() - t;
+	if ( !iam ) printf(".. Amap distribute time: %.2f\n", t);
+#endif
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(iam, "Exit pddistribute()");
+#endif
+	return 0.0;
+    }
+
+    if ( fact == SamePattern_SameRowPerm ) {
+	/* Not recorded with options->ReleaseMemory. */
+	if ( !Llu->release
+	     && !(Amap = (dAmap_t *) SUPERLU_MALLOC(sizeof(dAmap_t))) )
+	    ABORT("Malloc fails for Amap.");
+    } else {
+	dDestroy_Amap(Llu); /* the L and U structures are new */
+    }
+
     dReDistribute_A(A, ScalePermstruct, Glu_freeable, xsup, supno,
-		      grid, &xa, &asub, &a);
+		      grid, &xa, &asub, &a, Amap, Amap ? &apos : NULL);
 
 #if ( PROFlevel>=1 )
     t = SuperLU_timer_() - t;
@@ -516,6 +727,18 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 	ldaspa = Llu->ldalsum;
 	if ( !(dense = doubleCalloc_dist(ldaspa * sp_ienv_dist(3))) )
 	    ABORT("Calloc fails for SPA dense[].");
+	if ( !(dense_pos = intMalloc_dist(ldaspa * sp_ienv_dist(3))) )
+	    ABORT("Malloc fails for SPA dense_pos[].");
+	for (i = 0; i < ldaspa * sp_ienv_dist(3); ++i) dense_pos[i] = EMPTY;
+	if ( Amap ) {
+	    if ( !(Amap->dst = (double **)
+		   SUPERLU_MALLOC(SUPERLU_MAX(Amap->nrecv, 1) * sizeof(double *))) )
+		ABORT("Malloc fails for Amap->dst[].");
+	    if ( !(Amap->dst_sn = (int *)
+		   SUPERLU_MALLOC(SUPERLU_MAX(Amap->nrecv, 1) * sizeof(int))) )
+		ABORT("Malloc fails for Amap->dst_sn[].");
+	    for (i = 0; i < Amap->nrecv; ++i) Amap->dst[i] = NULL;
+	}
 	nrbu = CEILING( nsupers, grid->nprow ); /* No. of local block rows */
 	if ( !(Urb_length = intCalloc_dist(nrbu)) )
 	    ABORT("Calloc fails for Urb_length[].");
@@ -535,6 +758,9 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 #endif
 
 	/* Initialize Uval to zero. */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) private(i, index, uval, len)
+#endif
 	for (lb = 0; lb < nrbu; ++lb) {
 	    Urb_indptr[lb] = BR_HEADER; /* Skip header in U index[]. */
 	    index = Ufstnz_br_ptr[lb];
@@ -579,9 +805,15 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 				    len += fsupc1 - index[istart++];
 				/*assert(irow>=index[istart]);*/
 				uval[len + irow - index[istart]] = a[i];
+				if ( Amap ) {
+				    Amap->dst[apos[i]] = &uval[len + irow - index[istart]];
+				    Amap->dst_sn[apos[i]] = gb;
+				}
 			    } else { /* in L; put in SPA first */
   				irow = ilsum[lb] + irow - FstBlockC( gb );
   				dense_col[irow] = a[i];
+				if ( Amap )
+				    dense_pos[dense_col - dense + irow] = apos[i];
   			    }
   			}
 		    } /* for i ... */
@@ -613,6 +845,12 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 			    for (j = 0, dense_col = dense; j < nsupc; ++j) {
 				lusup[k] = dense_col[irow];
 				dense_col[irow] = zero;
+				ii = dense_col - dense + irow;
+				if ( dense_pos[ii] != EMPTY ) {
+				    Amap->dst[dense_pos[ii]] = &lusup[k];
+				    Amap->dst_sn[dense_pos[ii]] = jb;
+				    dense_pos[ii] = EMPTY;
+				}
 				k += len;
 				dense_col += ldaspa;
 			    }
@@ -626,8 +864,21 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 	} /* for jb ... */
 
 	SUPERLU_FREE(dense);
+	SUPERLU_FREE(dense_pos);
 	SUPERLU_FREE(Urb_length);
 	SUPERLU_FREE(Urb_indptr);
+
+	/* Keep the map for the next refactorizations. */
+	if ( apos ) SUPERLU_FREE(apos);
+	if ( Amap ) {
+	    if ( !(Amap->sendbuf = doubleMalloc_dist(SUPERLU_MAX(Amap->nnz_loc, 1))) )
+		ABORT("Malloc fails for Amap->sendbuf[].");
+	    if ( !(Amap->recvbuf = doubleMalloc_dist(SUPERLU_MAX(Amap->nrecv
+								 - Amap->nlocal, 1))) )
+		ABORT("Malloc fails for Amap->recvbuf[].");
+	    Llu->Amap = Amap;
+	    mem_use += (Amap->nnz_loc + Amap->nrecv) * (iword + dword);
+	}
 #if ( PROFlevel>=1 )
 	if ( !iam ) printf(".. 2nd distribute time: L %.2f\tU %.2f\tu_blks %d\tnrbu %d\n",
 			   t_l, t_u, u_blks, nrbu);
@@ -751,8 +1002,23 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 	    } /* for j ... */
 	} /* for jb ... */
 
-	/* Set up the initial pointers for each block row in U. */
+	/* Set up the initial pointers for each block row in U.
+	   The values of all the blocks of U are in one array, and so
+	   are those of L below. */
 	nrbu = CEILING( nsupers, grid->nprow );/* Number of local block rows */
+	for (slab_len = 0, lb = 0; lb < nrbu; ++lb) slab_len += Urb_length[lb];
+	Llu->Unzval_slab = NULL;
+	if ( Llu->ooc )
+	    Llu->Unzval_slab = (double *)
+		superlu_ooc_alloc(&Llu->Unzval_ooc, slab_len * sizeof(double));
+	else
+	    Llu->Unzval_ooc.base = NULL;
+	if ( !Llu->Unzval_slab && !(Llu->Unzval_slab = (double *)
+	       SUPERLU_MALLOC(SUPERLU_MAX(slab_len, 1) * sizeof(double))) )
+	    ABORT("Malloc fails for Unzval_slab[].");
+	if ( !Llu->Unzval_ooc.base )
+	    superlu_hugepage(Llu->Unzval_slab, slab_len * sizeof(double));
+	slab_pos = 0;
 	for (lb = 0; lb < nrbu; ++lb) {
 	    len = Urb_length[lb];
 	    rb_marker[lb] = 0; /* Reset block marker. */
@@ -762,8 +1028,8 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 		if ( !(index = intMalloc_dist(len1+1)) )
 		    ABORT("Malloc fails for Uindex[].");
 		Ufstnz_br_ptr[lb] = index;
-		if ( !(Unzval_br_ptr[lb] = doubleMalloc_dist(len)) )
-		    ABORT("Malloc fails for Unzval_br_ptr[*][].");
+		Unzval_br_ptr[lb] = &Llu->Unzval_slab[slab_pos];
+		slab_pos += len;
 		mybufmax[2] = SUPERLU_MAX( mybufmax[2], len1 );
 		mybufmax[3] = SUPERLU_MAX( mybufmax[3], len );
 		index[0] = Ucbs[lb]; /* Number of column blocks */
@@ -862,6 +1128,26 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 	mem_use += 4.0*k*sizeof(int_t*) + 2.0*len*iword;
 	memTRS += k*sizeof(int_t*) + 2.0*k*sizeof(double*) + k*iword;  //acount for Lindval_loc_bc_ptr, Unnz, Linv_bc_ptr,Uinv_bc_ptr
 
+	/* Size of the values of the local blocks of L. */
+	for (slab_len = 0, jb = mycol; jb < nsupers; jb += grid->npcol) {
+	    fsupc = FstBlockC( jb );
+	    for (len = 0, i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i)
+		if ( myrow == PROW( BlockNum( lsub[i] ), grid ) ) ++len;
+	    slab_len += (size_t) len * SuperSize( jb );
+	}
+	Llu->Lnzval_slab = NULL;
+	if ( Llu->ooc )
+	    Llu->Lnzval_slab = (double *)
+		superlu_ooc_alloc(&Llu->Lnzval_ooc, slab_len * sizeof(double));
+	else
+	    Llu->Lnzval_ooc.base = NULL;
+	if ( !Llu->Lnzval_slab && !(Llu->Lnzval_slab = (double *)
+	       SUPERLU_MALLOC(SUPERLU_MAX(slab_len, 1) * sizeof(double))) )
+	    ABORT("Malloc fails for Lnzval_slab[].");
+	if ( !Llu->Lnzval_ooc.base )
+	    superlu_hugepage(Llu->Lnzval_slab, slab_len * sizeof(double));
+	slab_pos = 0;
+
 	/*------------------------------------------------------------
 	  PROPAGATE ROW SUBSCRIPTS AND VALUES OF A INTO L AND U BLOCKS.
 	  THIS ACCOUNTS FOR ONE-PASS PROCESSING OF A, L AND U.
@@ -1012,14 +1298,13 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 			ABORT("Malloc fails for lusup[]");
 		    if ( !(Lindval_loc_bc_ptr[ljb] = intCalloc_dist(nrbl*3)) )
 			ABORT("Malloc fails for Lindval_loc_bc_ptr[ljb][]");
-  		    if (!(Linv_bc_ptr[ljb] = (double*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(double))))
-			ABORT("Malloc fails for Linv_bc_ptr[ljb][]");
-		    if (!(Uinv_bc_ptr[ljb] = (double*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(double))))
-			ABORT("Malloc fails for Uinv_bc_ptr[ljb][]");
+		    /* Allocated by pdCompute_Diag_Inv() if inverted. */
+		    Linv_bc_ptr[ljb] = NULL;
+		    Uinv_bc_ptr[ljb] = NULL;
 		    mybufmax[0] = SUPERLU_MAX( mybufmax[0], len1 );
 		    mybufmax[1] = SUPERLU_MAX( mybufmax[1], len*nsupc );
 		    mybufmax[4] = SUPERLU_MAX( mybufmax[4], len );
-	  	    memTRS += nrbl*3.0*iword + 2.0*nsupc*nsupc*dword;  //acount for Lindval_loc_bc_ptr[ljb],Linv_bc_ptr[ljb],Uinv_bc_ptr[ljb]
+	  	    memTRS += nrbl*3.0*iword;  //acount for Lindval_loc_bc_ptr[ljb]
 		    index[0] = nrbl;  /* Number of row blocks */
 		    index[1] = len;   /* LDA of the nzval[] */
 		    next_lind = BC_HEADER;
@@ -1080,8 +1365,8 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 
 			if ( !(index_srt = intMalloc_dist(len1)) )
 				ABORT("Malloc fails for index_srt[]");
-			if (!(lusup_srt = (double*)SUPERLU_MALLOC(len*nsupc * sizeof(double))))
-				ABORT("Malloc fails for lusup_srt[]");
+			lusup_srt = &Llu->Lnzval_slab[slab_pos];
+			slab_pos += (size_t) len * nsupc;
 
 			idx_indx = BC_HEADER;
 			idx_lusup = 0;
@@ -1232,6 +1517,7 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 	k = CEILING( nsupers, grid->npcol );/* Number of local block columns */
 	if ( !(LBtree_ptr = (BcTree*)SUPERLU_MALLOC(k * sizeof(BcTree))) )
 		ABORT("Malloc fails for LBtree_ptr[].");
+	superlu_treespec_init(&Llu->LBtree_spec, k);
 	if ( !(ActiveFlag = intCalloc_dist(grid->nprow*2)) )
 		ABORT("Calloc fails for ActiveFlag[].");
 	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->nprow * sizeof(int))) )
@@ -1241,7 +1527,7 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 
 
 	for (i=0;i<k;i++){
-		SeedSTD_BC[i]=rand();
+		SeedSTD_BC[i]=i; /* deterministic tree seeds */
 	}
 
 	MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_BC[0],k,MPI_DOUBLE,MPI_MAX,grid->cscp.comm);
@@ -1255,6 +1541,12 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 		ABORT("Calloc fails for ActiveFlag[].");
 	memTRS += k*sizeof(BcTree) + k*dword + grid->nprow*k*iword;  //acount for LBtree_ptr, SeedSTD_BC, ActiveFlagAll
 	for (j=0;j<grid->nprow*k;++j)ActiveFlagAll[j]=3*nsupers;
+	/* The block columns are independent: ljb only updates its own
+	   column of ActiveFlagAll. The same holds for U below. */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) \
+	private(jb, pc, fsupc, nsupc, istart, i, irow, gb, pr)
+#endif
 	for (ljb = 0; ljb < k; ++ljb) { /* for each local block column ... */
 		jb = mycol+ljb*grid->npcol;  /* not sure */
 		if(jb<nsupers){
@@ -1317,8 +1609,8 @@ pddistribute(fact_t fact, int_t n, SuperMatrix *A,
 				// rseed=rand();
 				// rseed=1.0;
 				msgsize = SuperSize( jb );
-				LBtree_ptr[ljb] = BcTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_BC[ljb],'d');
-				BcTree_SetTag(LBtree_ptr[ljb],BC_L,'d');
+				superlu_treespec_add(&Llu->LBtree_spec, ljb, ranks, rank_cnt,
+						     msgsize, SeedSTD_BC[ljb]);
 
 				// printf("iam %5d btree rank_cnt %5d \n",iam,rank_cnt);
 				// fflush(stdout);
@@ -1393,6 +1685,7 @@ if ( !iam) printf(".. Construct Bcast tree for L: %.2f\t\n", t);
 	k = CEILING( nsupers, grid->nprow );/* Number of local block rows */
 	if ( !(LRtree_ptr = (RdTree*)SUPERLU_MALLOC(k * sizeof(RdTree))) )
 		ABORT("Malloc fails for LRtree_ptr[].");
+	superlu_treespec_init(&Llu->LRtree_spec, k);
 	if ( !(ActiveFlag = intCalloc_dist(grid->npcol*2)) )
 		ABORT("Calloc fails for ActiveFlag[].");
 	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->npcol * sizeof(int))) )
@@ -1408,7 +1701,7 @@ if ( !iam) printf(".. Construct Bcast tree for L: %.2f\t\n", t);
 		ABORT("Malloc fails for SeedSTD_RD[].");
 
 	for (i=0;i<k;i++){
-		SeedSTD_RD[i]=rand();
+		SeedSTD_RD[i]=i; /* deterministic tree seeds */
 	}
 
 	MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_RD[0],k,MPI_DOUBLE,MPI_MAX,grid->rscp.comm);
@@ -1500,8 +1793,8 @@ if ( !iam) printf(".. Construct Bcast tree for L: %.2f\t\n", t);
 
 					// if(ib==0){
 
-					LRtree_ptr[lib] = RdTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_RD[lib],'d');
-					RdTree_SetTag(LRtree_ptr[lib], RD_L,'d');
+					superlu_treespec_add(&Llu->LRtree_spec, lib, ranks, rank_cnt,
+							     msgsize, SeedSTD_RD[lib]);
 					// }
 
 					// printf("iam %5d rtree rank_cnt %5d \n",iam,rank_cnt);
@@ -1559,6 +1852,7 @@ if ( !iam) printf(".. Construct Reduce tree for L: %.2f\t\n", t);
 	k = CEILING( nsupers, grid->npcol );/* Number of local block columns */
 	if ( !(UBtree_ptr = (BcTree*)SUPERLU_MALLOC(k * sizeof(BcTree))) )
 		ABORT("Malloc fails for UBtree_ptr[].");
+	superlu_treespec_init(&Llu->UBtree_spec, k);
 	if ( !(ActiveFlag = intCalloc_dist(grid->nprow*2)) )
 		ABORT("Calloc fails for ActiveFlag[].");
 	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->nprow * sizeof(int))) )
@@ -1567,7 +1861,7 @@ if ( !iam) printf(".. Construct Reduce tree for L: %.2f\t\n", t);
 		ABORT("Malloc fails for SeedSTD_BC[].");
 
 	for (i=0;i<k;i++){
-		SeedSTD_BC[i]=rand();
+		SeedSTD_BC[i]=i; /* deterministic tree seeds */
 	}
 
 	MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_BC[0],k,MPI_DOUBLE,MPI_MAX,grid->cscp.comm);
@@ -1582,6 +1876,10 @@ if ( !iam) printf(".. Construct Reduce tree for L: %.2f\t\n", t);
 	for (j=0;j<grid->nprow*k;++j)ActiveFlagAll[j]=-3*nsupers;
 	memTRS += k*sizeof(BcTree) + k*dword + grid->nprow*k*iword;  //acount for UBtree_ptr, SeedSTD_BC, ActiveFlagAll
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) \
+	private(jb, pc, fsupc, j, istart, i, irow, gb, pr)
+#endif
 	for (ljb = 0; ljb < k; ++ljb) { /* for each local block column ... */
 		jb = mycol+ljb*grid->npcol;  /* not sure */
 		if(jb<nsupers){
@@ -1658,8 +1956,8 @@ if ( !iam) printf(".. Construct Reduce tree for L: %.2f\t\n", t);
 				// rseed=rand();
 				// rseed=1.0;
 				msgsize = SuperSize( jb );
-				UBtree_ptr[ljb] = BcTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_BC[ljb],'d');
-				BcTree_SetTag(UBtree_ptr[ljb],BC_U,'d');
+				superlu_treespec_add(&Llu->UBtree_spec, ljb, ranks, rank_cnt,
+						     msgsize, SeedSTD_BC[ljb]);
 
 				// printf("iam %5d btree rank_cnt %5d \n",iam,rank_cnt);
 				// fflush(stdout);
@@ -1722,6 +2020,7 @@ if ( !iam) printf(".. Construct Bcast tree for U: %.2f\t\n", t);
 	k = CEILING( nsupers, grid->nprow );/* Number of local block rows */
 	if ( !(URtree_ptr = (RdTree*)SUPERLU_MALLOC(k * sizeof(RdTree))) )
 		ABORT("Malloc fails for URtree_ptr[].");
+	superlu_treespec_init(&Llu->URtree_spec, k);
 	if ( !(ActiveFlag = intCalloc_dist(grid->npcol*2)) )
 		ABORT("Calloc fails for ActiveFlag[].");
 	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->npcol * sizeof(int))) )
@@ -1737,7 +2036,7 @@ if ( !iam) printf(".. Construct Bcast tree for U: %.2f\t\n", t);
 		ABORT("Malloc fails for SeedSTD_RD[].");
 
 	for (i=0;i<k;i++){
-		SeedSTD_RD[i]=rand();
+		SeedSTD_RD[i]=i; /* deterministic tree seeds */
 	}
 
 	MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_RD[0],k,MPI_DOUBLE,MPI_MAX,grid->rscp.comm);
@@ -1861,8 +2160,8 @@ if ( !iam) printf(".. Construct Bcast tree for U: %.2f\t\n", t);
 
 					// if(ib==0){
 
-					URtree_ptr[lib] = RdTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_RD[lib],'d');
-					RdTree_SetTag(URtree_ptr[lib], RD_U,'d');
+					superlu_treespec_add(&Llu->URtree_spec, lib, ranks, rank_cnt,
+							     msgsize, SeedSTD_RD[lib]);
 					// }
 
 					// #if ( PRNTlevel>=1 )
@@ -19,6 +19,105 @@ at the top-level directory.
 #include <math.h>
 #include "superlu_ddefs.h"
 
+#define RUIZ_TOL 1.e-2
+
+/*
+ * Find cmax[j] = max_i |a_ij| * r[i] * c[j] over the local rows of A,
+ * where c = NULL stands for all ones. If rmax is not NULL, also returns
+ * rmax[i] = max_j |a_ij| * r[i] * c[j] for the local row i. r[] is
+ * indexed by the global row number.
+ *
+ * With OpenMP, the rows are shared among the threads, each with its own
+ * copy of cmax[], as long as the local matrix has enough entries per
+ * column to pay for the copies.
+ */
+static void
+pdgsequ_max(NRformat_loc *Astore, int_t n, double *r, double *c,
+            double *rmax, double *cmax)
+{
+    double *Aval = Astore->nzval, *buf = cmax;
+    int_t  *rowptr = Astore->rowptr, *colind = Astore->colind;
+    int_t  fst_row = Astore->fst_row, m_loc = Astore->m_loc;
+    int    nthr = 1;
+
+#ifdef _OPENMP
+    nthr = SUPERLU_MIN(omp_get_max_threads(),
+                       1 + Astore->nnz_loc / SUPERLU_MAX(n, 1));
+    if ( nthr > 1 && !(buf = doubleMalloc_dist((size_t) nthr * n)) )
+        ABORT("Malloc fails for buf[].");
+#endif
+
+#pragma omp parallel num_threads(nthr) if (nthr > 1)
+    {
+        int_t  i, j, jcol;
+        int    t, tid = 0;
+        double *cm, s, rm, v;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        cm = buf + (size_t) tid * n;
+        for (j = 0; j < n; ++j) cm[j] = 0.;
+
+#pragma omp for schedule(static)
+        for (i = 0; i < m_loc; ++i) {
+            s = r[fst_row + i];
+            rm = 0.;
+            for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+                jcol = colind[j];
+                v = fabs(Aval[j]) * s;
+                if ( c ) v *= c[jcol];
+                cm[jcol] = SUPERLU_MAX( cm[jcol], v );
+                rm = SUPERLU_MAX( rm, v );
+            }
+            if ( rmax ) rmax[i] = rm;
+        }
+
+        if ( nthr > 1 ) {
+#pragma omp for schedule(static)
+            for (j = 0; j < n; ++j) {
+                v = buf[j];
+                for (t = 1; t < nthr; ++t)
+                    v = SUPERLU_MAX( v, buf[(size_t) t * n + j] );
+                cmax[j] = v;
+            }
+        }
+    }
+
+    if ( nthr > 1 ) SUPERLU_FREE(buf);
+}
+
+/*
+ * Gather R from each process to get the global R.
+ */
+static void
+pdgsequ_gather_r(NRformat_loc *Astore, double *r, gridinfo_t *grid)
+{
+    int    m_loc = Astore->m_loc, i, procs = grid->nprow * grid->npcol;
+    int    *r_sizes, *displs;
+    double *loc_r;
+
+    if ( !(r_sizes = SUPERLU_MALLOC(2 * procs * sizeof(int))))
+      ABORT("Malloc fails for r_sizes[].");
+    displs = r_sizes + procs;
+    if ( !(loc_r = doubleMalloc_dist(m_loc)))
+      ABORT("Malloc fails for loc_r[].");
+    for (i = 0; i < m_loc; ++i) loc_r[i] = r[Astore->fst_row + i];
+
+    /* First gather the size of each piece. */
+    MPI_Allgather(&m_loc, 1, MPI_INT, r_sizes, 1, MPI_INT, grid->comm);
+
+    /* Set up the displacements for allgatherv */
+    displs[0] = 0;
+    for (i = 1; i < procs; ++i) displs[i] = displs[i-1] + r_sizes[i-1];
+
+    /* Now gather the actual data */
+    MPI_Allgatherv(loc_r, m_loc, MPI_DOUBLE, r, r_sizes, displs,
+                MPI_DOUBLE, grid->comm);
+
+    SUPERLU_FREE(r_sizes);
+    SUPERLU_FREE(loc_r);
+}
+
 /*! \brief
 
  <pre>
@@ -90,14 +189,11 @@ pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
     /* Local variables */
     NRformat_loc *Astore;
     double *Aval;
-    int i, j, irow, jcol, m_loc;
+    int i, j, irow, m_loc;
     double rcmin, rcmax;
     double bignum, smlnum;
-    double tempmax, tempmin;
+    double temp[2], gtemp[2];
     double *loc_max;
-    int *r_sizes, *displs;
-    double *loc_r;
-    int_t  procs;
 
     /* Test the input parameters. */
     *info = 0;
@@ -127,31 +223,28 @@ pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
     bignum = 1. / smlnum;
 
     /* Compute row scale factors. */
+#pragma omp parallel for
     for (i = 0; i < A->nrow; ++i) r[i] = 0.;
 
-    /* Find the maximum element in each row. */
-    irow = Astore->fst_row;
+    /* Find the maximum element in each row, and the maximum and
+       minimum scale factors. */
+    rcmin = bignum;
+    rcmax = 0.;
+#pragma omp parallel for private(j, irow) reduction(max:rcmax) reduction(min:rcmin)
     for (i = 0; i < m_loc; ++i) {
+	irow = Astore->fst_row + i;
 	for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j)
 	    r[irow] = SUPERLU_MAX( r[irow], fabs(Aval[j]) );
-	++irow;
+	rcmax = SUPERLU_MAX(rcmax, r[irow]);
+	rcmin = SUPERLU_MIN(rcmin, r[irow]);
     }
 
-    /* Find the maximum and minimum scale factors. */
-    rcmin = bignum;
-    rcmax = 0.;
-    for (i = Astore->fst_row; i < Astore->fst_row + m_loc; ++i) {
-	rcmax = SUPERLU_MAX(rcmax, r[i]);
-	rcmin = SUPERLU_MIN(rcmin, r[i]);
-    }
-
-    /* Get the global MAX and MIN for R */
-    tempmax = rcmax;
-    tempmin = rcmin;
-    MPI_Allreduce( &tempmax, &rcmax,
-		1, MPI_DOUBLE, MPI_MAX, grid->comm);
-    MPI_Allreduce( &tempmin, &rcmin,
-		1, MPI_DOUBLE, MPI_MIN, grid->comm);
+    /* Get the global MAX and MIN for R in one reduction. */
+    temp[0] = rcmax;
+    temp[1] = -rcmin;
+    MPI_Allreduce( temp, gtemp, 2, MPI_DOUBLE, MPI_MAX, grid->comm);
+    rcmax = gtemp[0];
+    rcmin = -gtemp[1];
 
     *amax = rcmax;
 
@@ -164,36 +257,26 @@ pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
 	    }
     } else {
 	/* Invert the scale factors. */
+#pragma omp parallel for
 	for (i = 0; i < A->nrow; ++i)
 	    r[i] = 1. / SUPERLU_MIN( SUPERLU_MAX( r[i], smlnum ), bignum );
 	/* Compute ROWCND = min(R(I)) / max(R(I)) */
 	*rowcnd = SUPERLU_MAX( rcmin, smlnum ) / SUPERLU_MIN( rcmax, bignum );
     }
 
-    /* Compute column scale factors */
-    for (j = 0; j < A->ncol; ++j) c[j] = 0.;
-
-    /* Find the maximum element in each column, assuming the row
-       scalings computed above. */
-    irow = Astore->fst_row;
-    for (i = 0; i < m_loc; ++i) {
-        for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j) {
-	    jcol = Astore->colind[j];
-	    c[jcol] = SUPERLU_MAX( c[jcol], fabs(Aval[j]) * r[irow] );
-	}
-	++irow;
-    }
-
-    /* Find the global maximum for c[j] */
+    /* Compute column scale factors.
+       Find the maximum element in each column, assuming the row
+       scalings computed above, then the global maximum for c[j]. */
     if ( !(loc_max = doubleMalloc_dist(A->ncol)))
       ABORT("Malloc fails for loc_max[].");
-    for (j = 0; j < A->ncol; ++j) loc_max[j] = c[j];
+    pdgsequ_max(Astore, A->ncol, r, NULL, NULL, loc_max);
     MPI_Allreduce(loc_max, c, A->ncol, MPI_DOUBLE, MPI_MAX, grid->comm);
     SUPERLU_FREE(loc_max);
 
     /* Find the maximum and minimum scale factors. */
     rcmin = bignum;
     rcmax = 0.;
+#pragma omp parallel for reduction(max:rcmax) reduction(min:rcmin)
     for (j = 0; j < A->ncol; ++j) {
 	rcmax = SUPERLU_MAX(rcmax, c[j]);
 	rcmin = SUPERLU_MIN(rcmin, c[j]);
@@ -208,6 +291,7 @@ pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
 	    }
     } else {
 	/* Invert the scale factors. */
+#pragma omp parallel for
 	for (j = 0; j < A->ncol; ++j)
 	    c[j] = 1. / SUPERLU_MIN( SUPERLU_MAX( c[j], smlnum ), bignum);
 	/* Compute COLCND = min(C(J)) / max(C(J)) */
@@ -215,30 +299,156 @@ pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
     }
 
     /* gather R from each process to get the global R.  */
+    pdgsequ_gather_r(Astore, r, grid);
 
-    procs = grid->nprow * grid->npcol;
-    if ( !(r_sizes = SUPERLU_MALLOC(2 * procs * sizeof(int))))
-      ABORT("Malloc fails for r_sizes[].");
-    displs = r_sizes + procs;
-    if ( !(loc_r = doubleMalloc_dist(m_loc)))
-      ABORT("Malloc fails for loc_r[].");
-    j = Astore->fst_row;
-    for (i = 0; i < m_loc; ++i) loc_r[i] = r[j++];
+    return;
 
-    /* First gather the size of each piece. */
-    MPI_Allgather(&m_loc, 1, MPI_INT, r_sizes, 1, MPI_INT, grid->comm);
+} /* pdgsequ */
 
-    /* Set up the displacements for allgatherv */
-    displs[0] = 0;
-    for (i = 1; i < procs; ++i) displs[i] = displs[i-1] + r_sizes[i-1];
 
-    /* Now gather the actual data */
-    MPI_Allgatherv(loc_r, m_loc, MPI_DOUBLE, r, r_sizes, displs,
-                MPI_DOUBLE, grid->comm);
+/*! \brief
 
-    SUPERLU_FREE(r_sizes);
-    SUPERLU_FREE(loc_r);
+ <pre>
+    Purpose
+    =======
 
-    return;
+    PDGSEQU_RUIZ computes row and column scalings of an M-by-N sparse
+    matrix A by the iterative scaling of Ruiz: starting from R = C = 1,
+    each sweep divides R(i) by the square root of the largest entry of
+    row i of diag(R)*A*diag(C), and C(j) by that of column j, both taken
+    from the same matrix. The sweeps stop after MAXIT of them, or once
+    all the row and column maxima are within RUIZ_TOL of one. In the
+    limit, every row and column of diag(R)*A*diag(C) has its largest
+    entry of magnitude one.
 
-} /* pdgsequ */
+    Each sweep makes a single pass over the local entries, finding the
+    row and column maxima together (see pdgsequ_max()), and a single
+    reduction of the column maxima and convergence flags among the
+    processes.
+
+    Arguments
+    =========
+
+    A       (input) SuperMatrix*
+            The matrix of dimension (A->nrow, A->ncol) whose equilibration
+            factors are to be computed. The type of A can be:
+            Stype = SLU_NR_loc; Dtype = SLU_D; Mtype = SLU_GE.
+
+    MAXIT   (input) int
+            The largest number of sweeps, MAXIT >= 1.
+
+    R, C, ROWCND, COLCND, AMAX, INFO, GRID
+            As in pdgsequ(), so that the result can be applied with
+            pdlaqgs().
+    =====================================================================
+</pre>
+*/
+
+void
+pdgsequ_ruiz(SuperMatrix *A, int maxit, double *r, double *c,
+             double *rowcnd, double *colcnd, double *amax, int_t *info,
+             gridinfo_t *grid)
+{
+    NRformat_loc *Astore;
+    int_t  m = A->nrow, n = A->ncol, i, j, fst_row, m_loc;
+    int    it, zero_row;
+    double *rmax, *cm, dev, rcmin, rcmax, ccmin, ccmax;
+
+    /* Test the input parameters. */
+    *info = 0;
+    if ( A->nrow < 0 || A->ncol < 0 ||
+	 A->Stype != SLU_NR_loc || A->Dtype != SLU_D || A->Mtype != SLU_GE )
+	*info = -1;
+    else if ( maxit < 1 ) *info = -2;
+    if (*info != 0) {
+	i = -(*info);
+	pxerr_dist("pdgsequ_ruiz", grid, i);
+	return;
+    }
+
+    /* Quick return if possible */
+    if ( m == 0 || n == 0 ) {
+	*rowcnd = 1.;
+	*colcnd = 1.;
+	*amax = 0.;
+	return;
+    }
+
+    Astore = A->Store;
+    fst_row = Astore->fst_row;
+    m_loc = Astore->m_loc;
+    if ( !(rmax = doubleMalloc_dist(SUPERLU_MAX(m_loc, 1))) )
+	ABORT("Malloc fails for rmax[].");
+    /* cm[n] and cm[n+1] carry the row deviation and zero row flag. */
+    if ( !(cm = doubleMalloc_dist(2 * (n + 2))) )
+	ABORT("Malloc fails for cm[].");
+
+    for (i = 0; i < m; ++i) r[i] = 1.;
+    for (j = 0; j < n; ++j) c[j] = 1.;
+
+    for (it = 0; it < maxit; ++it) {
+	/* Find the row and column maxima of diag(R)*A*diag(C). */
+	pdgsequ_max(Astore, n, r, c, rmax, cm + n + 2);
+	dev = 0.;
+	zero_row = 0;
+	for (i = 0; i < m_loc; ++i) {
+	    if ( rmax[i] == 0. ) zero_row = 1;
+	    dev = SUPERLU_MAX( dev, fabs(1. - rmax[i]) );
+	}
+	cm[2*n + 2] = dev;
+	cm[2*n + 3] = zero_row;
+	MPI_Allreduce(cm + n + 2, cm, n + 2, MPI_DOUBLE, MPI_MAX, grid->comm);
+
+	if ( it == 0 ) {
+	    if ( cm[n+1] != 0. ) {
+		/* Find the first zero row and return an error code. */
+		i = m;
+		for (j = 0; j < m_loc; ++j)
+		    if ( rmax[j] == 0. ) { i = fst_row + j; break; }
+		MPI_Allreduce(&i, &j, 1, mpi_int_t, MPI_MIN, grid->comm);
+		*info = j + 1;
+		break;
+	    }
+	    *amax = 0.;
+	    for (j = 0; j < n; ++j) {
+		if ( cm[j] == 0. ) {
+		    *info = m + j + 1;
+		    break;
+		}
+		*amax = SUPERLU_MAX( *amax, cm[j] );
+	    }
+	    if ( *info ) break;
+	}
+
+	dev = cm[n];
+	for (j = 0; j < n; ++j) dev = SUPERLU_MAX( dev, fabs(1. - cm[j]) );
+	if ( dev <= RUIZ_TOL ) break;
+
+	/* Update the scale factors. */
+#pragma omp parallel for
+	for (i = 0; i < m_loc; ++i) r[fst_row + i] /= sqrt(rmax[i]);
+#pragma omp parallel for
+	for (j = 0; j < n; ++j) c[j] /= sqrt(cm[j]);
+    }
+
+    SUPERLU_FREE(rmax);
+    SUPERLU_FREE(cm);
+    if ( *info ) return;
+
+    pdgsequ_gather_r(Astore, r, grid);
+
+    /* Compute ROWCND and COLCND. */
+    rcmin = rcmax = r[0];
+    for (i = 1; i < m; ++i) {
+	rcmax = SUPERLU_MAX(rcmax, r[i]);
+	rcmin = SUPERLU_MIN(rcmin, r[i]);
+    }
+    ccmin = ccmax = c[0];
+    for (j = 1; j < n; ++j) {
+	ccmax = SUPERLU_MAX(ccmax, c[j]);
+	ccmin = SUPERLU_MIN(ccmin, c[j]);
+    }
+    *rowcnd = rcmin / rcmax;
+    *colcnd = ccmin / ccmax;
+
+} /* pdgsequ_ruiz */
@@ -226,6 +226,39 @@ void pdgsmv_init
 
 } /* PDGSMV_INIT */
 
+/*! \brief Put A in the form set up by pdgsmv_init() for a matrix of the
+ * same pattern.
+ *
+ * <pre>
+ * A, permuted by columns as on entry to pdgsmv_init(), has the pattern of
+ * the matrix given to it. Its entries are moved in each row the same way,
+ * the local part of x first, and the column indices are replaced by the
+ * local ones kept in colind_gsmv[], so that the communication structure
+ * set up by pdgsmv_init() serves for A.
+ * </pre>
+ */
+void
+pdgsmv_reuse(SuperMatrix *A, int_t *row_to_proc, int_t *colind_gsmv,
+	     gridinfo_t *grid)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t *rowptr = Astore->rowptr, *colind = Astore->colind;
+    double *a = (double *) Astore->nzval, atemp;
+    int_t i, j, k, nnz_loc = rowptr[Astore->m_loc];
+    int   iam = grid->iam;
+
+    for (i = 0; i < Astore->m_loc; ++i) { /* Loop through each row */
+	k = rowptr[i];
+	for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+	    if ( row_to_proc[colind[j]] == iam ) { /* Local */
+		atemp = a[k]; a[k] = a[j]; a[j] = atemp;
+		++k;
+	    }
+	}
+    }
+    for (i = 0; i < nnz_loc; ++i) colind[i] = colind_gsmv[i];
+}
+
 
 /*
  * Performs sparse matrix-vector multiplication.
@@ -253,7 +286,7 @@ pdgsmv
     int_t *ind_tosend, *ind_torecv, *ptr_ind_tosend, *ptr_ind_torecv;
     int_t *extern_start, TotalValSend;
     double *nzval, *val_tosend, *val_torecv;
-    double zero = 0.0;
+    double zero = 0.0, s;
     MPI_Request *send_req, *recv_req;
     MPI_Status status;
 
@@ -317,12 +350,16 @@ pdgsmv
        ------------------------------------------------------------*/
     if ( abs ) { /* Perform abs(A)*abs(x) */
         /* Multiply the local part. */
+#ifdef _OPENMP
+#pragma omp parallel for private(j, jcol, s) schedule(static)
+#endif
         for (i = 0; i < m_loc; ++i) { /* Loop through each row */
-	    ax[i] = 0.0;
+	    s = zero;
 	    for (j = rowptr[i]; j < extern_start[i]; ++j) {
 	        jcol = colind[j];
-		ax[i] += fabs(nzval[j]) * fabs(x[jcol]);
+		s += fabs(nzval[j]) * fabs(x[jcol]);
 	    }
+	    ax[i] = s;
         }
 
         for (p = 0; p < procs; ++p) {
@@ -331,20 +368,29 @@ pdgsmv
         }
 
         /* Multiply the external part. */
+#ifdef _OPENMP
+#pragma omp parallel for private(j, jcol, s) schedule(static)
+#endif
         for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    s = ax[i];
 	    for (j = extern_start[i]; j < rowptr[i+1]; ++j) {
 	        jcol = colind[j];
-	        ax[i] += fabs(nzval[j]) * fabs(val_torecv[jcol]);
+	        s += fabs(nzval[j]) * fabs(val_torecv[jcol]);
 	    }
+	    ax[i] = s;
 	}
     } else {
         /* Multiply the local part. */
+#ifdef _OPENMP
+#pragma omp parallel for private(j, jcol, s) schedule(static)
+#endif
         for (i = 0; i < m_loc; ++i) { /* Loop through each row */
-	    ax[i] = zero;
+	    s = zero;
 	    for (j = rowptr[i]; j < extern_start[i]; ++j) {
 	        jcol = colind[j];
-		ax[i] += nzval[j] * x[jcol];
+		s += nzval[j] * x[jcol];
 	    }
+	    ax[i] = s;
         }
 
         for (p = 0; p < procs; ++p) {
@@ -353,11 +399,16 @@ pdgsmv
         }
 
         /* Multiply the external part. */
+#ifdef _OPENMP
+#pragma omp parallel for private(j, jcol, s) schedule(static)
+#endif
         for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    s = ax[i];
 	    for (j = extern_start[i]; j < rowptr[i+1]; ++j) {
 	        jcol = colind[j];
-	        ax[i] += nzval[j] * val_torecv[jcol];
+	        s += nzval[j] * val_torecv[jcol];
 	    }
+	    ax[i] = s;
 	}
     }
 
@@ -368,6 +419,279 @@ pdgsmv
 
 } /* PDGSMV */
 
+
+/* Number of vectors multiplied together by pdgsmv_block(). */
+#define GSMV_TILE 8
+
+/*
+ * Performs the sparse matrix-vector multiplication for a block of nrhs
+ * vectors: ax = A * x and aax = abs(A) * abs(x), as pdgsmv() does for one
+ * vector with abs = 0 and 1. The external entries of all the vectors are
+ * exchanged in one message per process pair, with the communication
+ * structure of pdgsmv_init(), and the rows of A are read once for every
+ * GSMV_TILE vectors instead of twice per vector. The local entries of
+ * each tile of vectors are interleaved, entry (i, k) of the tile at
+ * i*nk + k, and so are the exchanged ones, at i*nrhs + k, so that the
+ * entries of a row of the tile are contiguous.
+ */
+void
+pdgsmv_block
+(
+ SuperMatrix *A_internal,  /* Input. Matrix A permuted by columns, as for
+			      pdgsmv(). */
+ gridinfo_t *grid,         /* Input */
+ pdgsmv_comm_t *gsmv_comm, /* Input. The data structure for communication. */
+ int    nrhs,              /* Input. Number of vectors. */
+ double x[],               /* Input. The distributed source vectors */
+ int_t  ldx,               /* Input. Leading dimension of x[]. */
+ double ax[],              /* Output. The distributed A * x */
+ double aax[],             /* Output. The distributed abs(A) * abs(x) */
+ int_t  ldax               /* Input. Leading dimension of ax[], aax[]. */
+)
+{
+    NRformat_loc *Astore;
+    int iam, procs, k, k0, nk;
+    int_t i, j, p, m_loc, fst_row, jcol;
+    int_t *colind, *rowptr;
+    int   *SendCounts, *RecvCounts;
+    int_t *ind_torecv, *ptr_ind_tosend, *ptr_ind_torecv;
+    int_t *extern_start, TotalIndSend, TotalValSend;
+    double *nzval, *xb, *val_tosend, *val_torecv, *xj, a;
+    double s[GSMV_TILE], sa[GSMV_TILE];
+    MPI_Request *send_req, *recv_req;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter pdgsmv_block()");
+#endif
+
+    /* ------------------------------------------------------------
+       INITIALIZATION.
+       ------------------------------------------------------------*/
+    iam = grid->iam;
+    procs = grid->nprow * grid->npcol;
+    Astore = (NRformat_loc *) A_internal->Store;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    colind = Astore->colind;
+    rowptr = Astore->rowptr;
+    nzval = (double *) Astore->nzval;
+    extern_start = gsmv_comm->extern_start;
+    ind_torecv = gsmv_comm->ind_torecv;
+    ptr_ind_tosend = gsmv_comm->ptr_ind_tosend;
+    ptr_ind_torecv = gsmv_comm->ptr_ind_torecv;
+    SendCounts = gsmv_comm->SendCounts;
+    RecvCounts = gsmv_comm->RecvCounts;
+    TotalIndSend = gsmv_comm->TotalIndSend;
+    TotalValSend = gsmv_comm->TotalValSend;
+
+    /* The local x, by tiles, and the send and receive buffers. */
+    if ( !(xb = doubleMalloc_dist(SUPERLU_MAX((size_t) nrhs * (m_loc
+			+ TotalValSend + TotalIndSend), 1))) )
+	ABORT("Malloc fails for xb[].");
+    val_tosend = xb + (size_t) nrhs * m_loc;
+    val_torecv = val_tosend + (size_t) nrhs * TotalValSend;
+
+    for (k0 = 0; k0 < nrhs; k0 += GSMV_TILE) {
+	nk = SUPERLU_MIN(GSMV_TILE, nrhs - k0);
+	xj = &xb[(size_t) k0 * m_loc];
+	for (i = 0; i < m_loc; ++i)
+	    for (k = 0; k < nk; ++k) xj[i*nk + k] = x[i + (k0+k)*ldx];
+    }
+    for (i = 0; i < TotalValSend; ++i) {
+        j = ind_torecv[i] - fst_row; /* Relative index in x[] */
+	for (k = 0; k < nrhs; ++k) val_tosend[i*nrhs + k] = x[j + k*ldx];
+    }
+
+    /* ------------------------------------------------------------
+       COMMUNICATE THE X VALUES.
+       ------------------------------------------------------------*/
+    if ( !(send_req = (MPI_Request *)
+	   SUPERLU_MALLOC(2*procs *sizeof(MPI_Request))))
+        ABORT("Malloc fails for recv_req[].");
+    recv_req = send_req + procs;
+    for (p = 0; p < procs; ++p) {
+	send_req[p] = recv_req[p] = MPI_REQUEST_NULL;
+        if ( RecvCounts[p] ) {
+	    MPI_Isend(&val_tosend[ptr_ind_torecv[p] * nrhs],
+		      RecvCounts[p] * nrhs, MPI_DOUBLE, p, iam,
+                      grid->comm, &send_req[p]);
+	}
+	if ( SendCounts[p] ) {
+	    MPI_Irecv(&val_torecv[ptr_ind_tosend[p] * nrhs],
+		      SendCounts[p] * nrhs, MPI_DOUBLE, p, p,
+                      grid->comm, &recv_req[p]);
+	}
+    }
+
+    /* ------------------------------------------------------------
+       PERFORM THE ACTUAL MULTIPLICATION, LOCAL PART FIRST.
+       ------------------------------------------------------------*/
+    for (k0 = 0; k0 < nrhs; k0 += GSMV_TILE) {
+	nk = SUPERLU_MIN(GSMV_TILE, nrhs - k0);
+#ifdef _OPENMP
+#pragma omp parallel for private(j, k, jcol, xj, a, s, sa) schedule(static)
+#endif
+	for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    for (k = 0; k < nk; ++k) s[k] = sa[k] = 0.0;
+	    for (j = rowptr[i]; j < extern_start[i]; ++j) {
+		a = nzval[j];
+		jcol = colind[j];
+		xj = &xb[(size_t) k0 * m_loc + jcol*nk];
+		for (k = 0; k < nk; ++k) {
+		    s[k] += a * xj[k];
+		    sa[k] += fabs(a) * fabs(xj[k]);
+		}
+	    }
+	    for (k = 0; k < nk; ++k) {
+		ax[i + (k0+k)*ldax] = s[k];
+		aax[i + (k0+k)*ldax] = sa[k];
+	    }
+	}
+    }
+
+    MPI_Waitall(2*procs, send_req, MPI_STATUSES_IGNORE);
+
+    /* Multiply the external part. */
+    for (k0 = 0; k0 < nrhs; k0 += GSMV_TILE) {
+	nk = SUPERLU_MIN(GSMV_TILE, nrhs - k0);
+#ifdef _OPENMP
+#pragma omp parallel for private(j, k, jcol, xj, a, s, sa) schedule(static)
+#endif
+	for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    if ( extern_start[i] == rowptr[i+1] ) continue;
+	    for (k = 0; k < nk; ++k) s[k] = sa[k] = 0.0;
+	    for (j = extern_start[i]; j < rowptr[i+1]; ++j) {
+		a = nzval[j];
+		jcol = colind[j];
+		xj = &val_torecv[jcol*nrhs + k0];
+		for (k = 0; k < nk; ++k) {
+		    s[k] += a * xj[k];
+		    sa[k] += fabs(a) * fabs(xj[k]);
+		}
+	    }
+	    for (k = 0; k < nk; ++k) {
+		ax[i + (k0+k)*ldax] += s[k];
+		aax[i + (k0+k)*ldax] += sa[k];
+	    }
+	}
+    }
+
+    SUPERLU_FREE(send_req);
+    SUPERLU_FREE(xb);
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit pdgsmv_block()");
+#endif
+
+} /* PDGSMV_BLOCK */
+
+
+/*
+ * Performs the transposed sparse matrix-vector multiplication
+ * atx = A^T * x, with the communication structure set up by pdgsmv_init()
+ * for A * x, used in reverse: the products with the external part of x
+ * are summed into val_torecv[] and sent back to the owners of those
+ * entries, which receive them in val_tosend[].
+ */
+void
+pdgsmv_trans
+(
+ int_t  abs,               /* Input. Do abs(A)^T*abs(x). */
+ SuperMatrix *A_internal,  /* Input. Matrix A permuted by columns.
+			      The column indices are translated into
+			      the relative positions in the gathered x-vector.
+			      The type of A can be:
+			      Stype = NR_loc; Dtype = SLU_D; Mtype = GE. */
+ gridinfo_t *grid,         /* Input */
+ pdgsmv_comm_t *gsmv_comm, /* Input. The data structure for communication. */
+ double x[],       /* Input. The distributed source vector */
+ double atx[]      /* Output. The distributed destination vector */
+)
+{
+    NRformat_loc *Astore;
+    int iam, procs;
+    int_t i, j, p, m_loc, fst_row, jcol;
+    int_t *colind, *rowptr;
+    int   *SendCounts, *RecvCounts;
+    int_t *ind_torecv, *ptr_ind_tosend, *ptr_ind_torecv;
+    int_t *extern_start, TotalIndSend, TotalValSend;
+    double *nzval, *val_tosend, *val_torecv, a, xi;
+    MPI_Request *send_req, *recv_req;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter pdgsmv_trans()");
+#endif
+
+    /* ------------------------------------------------------------
+       INITIALIZATION.
+       ------------------------------------------------------------*/
+    iam = grid->iam;
+    procs = grid->nprow * grid->npcol;
+    Astore = (NRformat_loc *) A_internal->Store;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    colind = Astore->colind;
+    rowptr = Astore->rowptr;
+    nzval = (double *) Astore->nzval;
+    extern_start = gsmv_comm->extern_start;
+    ind_torecv = gsmv_comm->ind_torecv;
+    ptr_ind_tosend = gsmv_comm->ptr_ind_tosend;
+    ptr_ind_torecv = gsmv_comm->ptr_ind_torecv;
+    SendCounts = gsmv_comm->SendCounts;
+    RecvCounts = gsmv_comm->RecvCounts;
+    val_tosend = (double *) gsmv_comm->val_tosend;
+    val_torecv = (double *) gsmv_comm->val_torecv;
+    TotalIndSend = gsmv_comm->TotalIndSend;
+    TotalValSend = gsmv_comm->TotalValSend;
+
+    /* ------------------------------------------------------------
+       PERFORM THE MULTIPLICATION, ROW BY ROW OF A.
+       ------------------------------------------------------------*/
+    for (i = 0; i < m_loc; ++i) atx[i] = 0.0;
+    for (i = 0; i < TotalIndSend; ++i) val_torecv[i] = 0.0;
+    for (i = 0; i < m_loc; ++i) {
+	xi = abs ? fabs(x[i]) : x[i];
+	for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+	    a = abs ? fabs(nzval[j]) : nzval[j];
+	    jcol = colind[j];
+	    if ( j < extern_start[i] ) atx[jcol] += a * xi;
+	    else val_torecv[jcol] += a * xi;
+	}
+    }
+
+    /* ------------------------------------------------------------
+       SEND THE EXTERNAL PRODUCTS TO THEIR OWNERS.
+       ------------------------------------------------------------*/
+    if ( !(send_req = (MPI_Request *)
+	   SUPERLU_MALLOC(2*procs *sizeof(MPI_Request))))
+        ABORT("Malloc fails for recv_req[].");
+    recv_req = send_req + procs;
+    for (p = 0; p < procs; ++p) {
+	send_req[p] = recv_req[p] = MPI_REQUEST_NULL;
+        if ( SendCounts[p] ) {
+	    MPI_Isend(&val_torecv[ptr_ind_tosend[p]], SendCounts[p],
+                      MPI_DOUBLE, p, iam,
+                      grid->comm, &send_req[p]);
+	}
+	if ( RecvCounts[p] ) {
+	    MPI_Irecv(&val_tosend[ptr_ind_torecv[p]], RecvCounts[p],
+                      MPI_DOUBLE, p, p,
+                      grid->comm, &recv_req[p]);
+	}
+    }
+    MPI_Waitall(2*procs, send_req, MPI_STATUSES_IGNORE);
+
+    for (i = 0; i < TotalValSend; ++i) {
+        j = ind_torecv[i] - fst_row; /* Relative index in atx[] */
+	atx[j] += val_tosend[i];
+    }
+
+    SUPERLU_FREE(send_req);
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit pdgsmv_trans()");
+#endif
+
+} /* PDGSMV_TRANS */
+
 void pdgsmv_finalize(pdgsmv_comm_t *gsmv_comm)
 {
     int_t *it;
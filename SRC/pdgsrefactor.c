@@ -0,0 +1,642 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Refactors new values of A with the structures of the factors
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "superlu_ddefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSREFACTOR factors the matrix A of the last factorization by pdgssvx()
+ * with new values, as pdgssvx() with Fact = SamePattern_SameRowPerm and
+ * nrhs = 0 would, without a new SuperMatrix: the values are given in the
+ * order of the entries of A on entry to pdgssvx(), scaled by the kept R
+ * and C, and moved into L and U, where the numerical factorization takes
+ * them. Nothing of the analysis is redone.
+ *
+ * That factorization must have been done with options->RefactorMap = YES,
+ * which keeps the column indices of A with the factors. The places of the
+ * values in L and U are recorded by the first call, and reused by the
+ * following ones (see pddistribute()).
+ *
+ * The factors are then used by pdgssvx() with Fact = FACTORED, which
+ * refines against A with the new values.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         The options of the last factorization; Fact is not used.
+ *
+ * A       (input/output) SuperMatrix*
+ *         The matrix of the last factorization, as left by pdgssvx() or by
+ *         pdgsrefactor(). On exit, its values are the scaled new ones.
+ *
+ * nzval   (input) double*, dimension (A->Store->rowptr[m_loc])
+ *         The new values of the local rows of A, in the order of the
+ *         entries of A on entry to pdgssvx().
+ *
+ * ScalePermstruct (input) dScalePermstruct_t*
+ *         The scalings and permutations of the last factorization.
+ *
+ * grid    (input) gridinfo_t*
+ *         The 2D process mesh of the last factorization.
+ *
+ * LUstruct (input/output) dLUstruct_t*
+ *         The factors of the last factorization, overwritten by the new
+ *         ones.
+ *
+ * SOLVEstruct (input/output) dSOLVEstruct_t*
+ *         The solve structures of pdgssvx(), kept for the solves.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         The times of the distribution and of the factorization, and the
+ *         operation count of the factorization.
+ *
+ * info    (output) int*
+ *         = 0: successful exit
+ *         < 0: if info = -i, the i-th argument had an illegal value
+ *         > 0: as for pdgssvx(), U(i,i) is exactly zero.
+ * </pre>
+ */
+void
+pdgsrefactor(superlu_dist_options_t *options, SuperMatrix *A, double *nzval,
+	     dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	     dLUstruct_t *LUstruct, dSOLVEstruct_t *SOLVEstruct,
+	     SuperLUStat_t *stat, int *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    DiagScale_t DiagScale = ScalePermstruct->DiagScale;
+    double *R = ScalePermstruct->R, *C = ScalePermstruct->C;
+    double *a, anorm, t;
+    int_t  *rowptr, *colind, *perm_c = ScalePermstruct->perm_c;
+    int_t  *iperm_c = NULL, i, j, irow, m_loc, n = A->ncol;
+    int    rowequ, colequ, mem_tag;
+    char   norm[1];
+
+    *info = 0;
+    if ( !Llu->Acolind ) {
+	*info = -1;
+	printf("ERROR: pdgsrefactor() needs a factorization with "
+	       "options->RefactorMap = YES and ReleaseMemory = NO.\n");
+    } else if ( Llu->Udropped ) {
+	*info = -1;
+	printf("ERROR: pdgsrefactor() needs U, see options->SymValues.\n");
+    } else if ( A->nrow != A->ncol || A->Stype != SLU_NR_loc
+	      || A->Dtype != SLU_D || A->Mtype != SLU_GE )
+	*info = -2;
+    else if ( !nzval && Astore->rowptr[Astore->m_loc] )
+	*info = -3;
+    if ( *info ) {
+	pxerr_dist("pdgsrefactor", grid, -*info);
+	return;
+    }
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter pdgsrefactor()");
+#endif
+
+    /* Restore A as distributed by pdgssvx(), with the new values
+       scaled: A <-- diag(R)*A*diag(C)*Pc^T. */
+    t = SuperLU_timer_();
+    m_loc = Astore->m_loc;
+    rowptr = Astore->rowptr;
+    colind = Astore->colind;
+    a = (double *) Astore->nzval;
+    rowequ = ( DiagScale == ROW || DiagScale == BOTH );
+    colequ = ( DiagScale == COL || DiagScale == BOTH );
+    if ( colequ ) {
+	if ( !(iperm_c = intMalloc_dist(n)) )
+	    ABORT("Malloc fails for iperm_c[].");
+	for (j = 0; j < n; ++j) iperm_c[perm_c[j]] = j;
+    }
+    irow = Astore->fst_row;
+    for (i = 0; i < m_loc; ++i, ++irow) {
+	for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+	    colind[j] = Llu->Acolind[j];
+	    a[j] = nzval[j];
+	    if ( rowequ ) a[j] *= R[irow];
+	    if ( colequ ) a[j] *= C[iperm_c[colind[j]]];
+	}
+    }
+    if ( iperm_c ) SUPERLU_FREE(iperm_c);
+    stat->utime[EQUIL] = SuperLU_timer_() - t;
+
+    /* Compute norm(A), which will be used to adjust small diagonal. */
+    *(unsigned char *)norm = ( options->Trans == NOTRANS ) ? '1' : 'I';
+    anorm = pdlangs(norm, A, grid);
+
+    /* Move the values of A into L and U. */
+    mem_tag = superlu_mem_tag(SUPERLU_MEM_FACTORS);
+    t = SuperLU_timer_();
+    Llu->ooc = ( options->OutOfCore == YES );
+#ifdef SLU_HAVE_SINGLE
+    if ( LUstruct->sLUstruct )
+	pdsdistribute(SamePattern_SameRowPerm, n, A, ScalePermstruct, NULL,
+		      LUstruct, grid);
+    else
+#endif
+    pddistribute(SamePattern_SameRowPerm, n, A, ScalePermstruct, NULL,
+		 LUstruct, grid);
+    stat->utime[DIST] = SuperLU_timer_() - t;
+
+    /* Perform numerical factorization in parallel. */
+    t = SuperLU_timer_();
+#ifdef SLU_HAVE_SINGLE
+    if ( LUstruct->sLUstruct )
+	pdsgstrf(options, A->nrow, n, anorm, LUstruct, grid, stat, info);
+    else
+#endif
+    pdgstrf(options, A->nrow, n, anorm, LUstruct, grid, stat, info);
+    stat->utime[FACT] = SuperLU_timer_() - t;
+    superlu_mem_tag(mem_tag);
+    if ( Llu->release ) dRelease_LU(n, grid, LUstruct);
+
+    if ( options->DiagInv == YES ) {
+	/* The inverses are computed by the first solve, see pdgstrs(). */
+#ifdef SLU_HAVE_SINGLE
+	if ( LUstruct->sLUstruct )
+	    pdsDefer_Diag_Inv(options, LUstruct);
+	else
+#endif
+	pdDefer_Diag_Inv(options, LUstruct);
+    }
+
+    /* The counts kept by pdgstrs() are those of the previous L and U. */
+    if ( options->SolveInitialized == YES ) dSolveWorkFree(SOLVEstruct);
+    /* A is put in the form set up by the refinement, if any. */
+    if ( options->RefineInitialized == YES )
+	pdgsmv_reuse(A, SOLVEstruct->row_to_proc, SOLVEstruct->A_colind_gsmv,
+		     grid);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Exit pdgsrefactor()");
+#endif
+}
+
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSREFACTOR_PARTIAL is pdgsrefactor() when only the ncols columns
+ * cols[] of A have new values: only the supernodes whose factors depend on
+ * them, those of the changed entries and their ancestors in the etree
+ * (see superlu_dirty_supernodes()), are refilled from A and factored
+ * again. The other supernodes keep their factors, and only update the
+ * panels of the dirty ones, with the parts of L(:,k) and U(k,:) in them;
+ * their panels are still sent. For a change localized in a subtree, this
+ * is the work of the path from it to the root.
+ *
+ * The values of the other columns in nzval[] are taken into A, but not
+ * into the factors: they must be those of the last factorization.
+ *
+ * The first call after pdgssvx(), which records the map of the values
+ * into L and U, refactors all the supernodes, as do the calls with
+ * options->OutOfCore, for the factors
+ * in single precision (options->SingleFactor) or with GPU_ACC.
+ *
+ * Arguments
+ * =========
+ *
+ * As for pdgsrefactor(), with
+ *
+ * ncols   (input) int_t
+ *         The number of the columns with new values.
+ *
+ * cols    (input) int_t*, dimension (ncols)
+ *         The columns with new values, in the numbering of A on entry to
+ *         pdgssvx(); the same on all the processes.
+ * </pre>
+ */
+void
+pdgsrefactor_partial(superlu_dist_options_t *options, SuperMatrix *A,
+		     double *nzval, int_t ncols, int_t *cols,
+		     dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+		     dLUstruct_t *LUstruct, dSOLVEstruct_t *SOLVEstruct,
+		     SuperLUStat_t *stat, int *info)
+{
+    dLocalLU_t *Llu = LUstruct->Llu;
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    int_t n = A->ncol, nsupers, nfact;
+    char  *dirty;
+
+    if ( ncols < 0 || (ncols > 0 && !cols) ) {
+	*info = -4;
+	pxerr_dist("pdgsrefactor_partial", grid, 4);
+	return;
+    }
+#ifndef GPU_ACC
+    if ( (Llu->Amap && Llu->Acolind && options->OutOfCore != YES)
+	 || LUstruct->sLUstruct ) {
+	nsupers = Glu_persist->supno[n-1] + 1;
+	nfact = options->SchurSize > 0
+	      ? Glu_persist->supno[n - options->SchurSize]
+	      : pdgstrf_root_start(options, n, Glu_persist, grid, Llu);
+	if ( !(dirty = SUPERLU_MALLOC(nsupers)) )
+	    ABORT("Malloc fails for dirty[].");
+	superlu_dirty_supernodes(options, A, Llu->Acolind,
+				 ScalePermstruct->perm_r, ScalePermstruct->perm_c,
+				 Glu_persist, LUstruct->etree, nfact, ncols, cols,
+				 dirty, grid);
+#if ( PRNTlevel>=1 )
+	if ( !grid->iam ) {
+	    int_t k, ndirty = 0;
+	    for (k = 0; k < nsupers; ++k) ndirty += dirty[k];
+	    printf(".. refactor " IFMT " of " IFMT " supernodes\n",
+		   ndirty, nsupers);
+	}
+#endif
+	Llu->sn_dirty = dirty;
+	pdgsrefactor(options, A, nzval, ScalePermstruct, grid, LUstruct,
+		     SOLVEstruct, stat, info);
+	Llu->sn_dirty = NULL;
+	SUPERLU_FREE(dirty);
+	return;
+    }
+#endif
+    pdgsrefactor(options, A, nzval, ScalePermstruct, grid, LUstruct,
+		 SOLVEstruct, stat, info);
+}
+
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSREFACTOR_PATTERN factors a matrix A of the order of the last
+ * factorization by pdgssvx() but with more entries than it had, as after
+ * a few couplings are added by a mesh adaptation, without computing the
+ * column ordering again.
+ *
+ * If all the entries of A, in the row and column order of the last
+ * factorization, fall in the structure of its L and U (in the fill, or in
+ * a supernode), nothing is analysed: the new map of the values is recorded
+ * and A is factored as by pdgsrefactor(), with the scaling of the last
+ * factorization. Otherwise perm_c[] and perm_r[] are kept, and only the
+ * symbolic factorization and the distribution of L and U are done again,
+ * by pdgssvx() with Fact = SamePattern and RowPerm = MY_PERMR; A is then
+ * equilibrated again as options->Equil asks. The entries of A on exit
+ * are those of the factorization, as with pdgssvx().
+ *
+ * The last factorization must have been done with options->RefactorMap =
+ * YES and ReleaseMemory = NO. The factors are used by pdgssvx() with Fact
+ * = FACTORED.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input/output) superlu_dist_options_t*
+ *         The options of the last factorization; SolveInitialized and
+ *         RefineInitialized are reset as the new pattern needs.
+ *
+ * A       (input/output) SuperMatrix*
+ *         The new matrix, distributed by block rows as for pdgssvx(),
+ *         with the pattern of the last one plus some entries.
+ *
+ * ScalePermstruct, grid, LUstruct, SOLVEstruct, stat, info
+ *         As for pdgsrefactor().
+ * </pre>
+ */
+void
+pdgsrefactor_pattern(superlu_dist_options_t *options, SuperMatrix *A,
+		     dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+		     dLUstruct_t *LUstruct, dSOLVEstruct_t *SOLVEstruct,
+		     SuperLUStat_t *stat, int *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    superlu_dist_options_t opts;
+    int_t  *colind = Astore->colind, *perm_c = ScalePermstruct->perm_c;
+    int_t  *iperm_c, n = A->ncol, nnz_loc, j, missing = 1;
+    double t;
+
+    *info = 0;
+    if ( !Llu->Acolind ) {
+	*info = -1;
+	printf("ERROR: pdgsrefactor_pattern() needs a factorization with "
+	       "options->RefactorMap = YES and ReleaseMemory = NO.\n");
+    } else if ( A->nrow != A->ncol || A->Stype != SLU_NR_loc
+	      || A->Dtype != SLU_D || A->Mtype != SLU_GE )
+	*info = -2;
+    if ( *info ) {
+	pxerr_dist("pdgsrefactor_pattern", grid, -*info);
+	return;
+    }
+
+    /* Do the entries of Pc*A fall in L and U? */
+    t = SuperLU_timer_();
+    nnz_loc = Astore->rowptr[Astore->m_loc];
+    for (j = 0; j < nnz_loc; ++j) colind[j] = perm_c[colind[j]];
+    if ( !LUstruct->sLUstruct && !Llu->Udropped )
+	missing = pdLU_pattern_check(n, A, ScalePermstruct, LUstruct, grid);
+    stat->utime[SYMBFAC] = SuperLU_timer_() - t;
+#if ( PRNTlevel>=1 )
+    if ( !grid->iam )
+	printf(".. entries of A outside L and U: " IFMT "\n", missing);
+#endif
+
+    if ( !missing ) {
+	/* Only the map of the values into L and U changes. */
+	SUPERLU_FREE(Llu->Acolind);
+	if ( !(Llu->Acolind = intMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	    ABORT("Malloc fails for Acolind[].");
+	memcpy(Llu->Acolind, colind, nnz_loc * sizeof(int_t));
+	dDestroy_Amap(Llu);
+	/* The matrix-vector product of the refinement is set up again. */
+	if ( options->RefineInitialized == YES ) {
+	    pdgsmv_finalize(SOLVEstruct->gsmv_comm);
+	    options->RefineInitialized = NO;
+	}
+	pdgsrefactor(options, A, (double *) Astore->nzval, ScalePermstruct,
+		     grid, LUstruct, SOLVEstruct, stat, info);
+	return;
+    }
+
+    /* The structure grows: analyse A again with the orderings kept. */
+    if ( !(iperm_c = intMalloc_dist(n)) )
+	ABORT("Malloc fails for iperm_c[].");
+    for (j = 0; j < n; ++j) iperm_c[perm_c[j]] = j;
+    for (j = 0; j < nnz_loc; ++j) colind[j] = iperm_c[colind[j]];
+    SUPERLU_FREE(iperm_c);
+    dDestroy_LU(n, grid, LUstruct);
+
+    opts = *options;
+    opts.Fact = SamePattern;
+    if ( opts.RowPerm != NOROWPERM ) opts.RowPerm = MY_PERMR;
+    opts.RefactorMap = YES;
+    opts.ReleaseMemory = NO;
+    pdgssvx(&opts, A, ScalePermstruct, NULL, Astore->m_loc, 0, grid,
+	    LUstruct, SOLVEstruct, NULL, stat, info);
+    options->SolveInitialized = opts.SolveInitialized;
+    options->RefineInitialized = opts.RefineInitialized;
+}
+
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSSVX_SWEEP solves A_v * X_v = B_v for nvals matrices A_v of the
+ * pattern of A, given by their values only, as met in a parametric sweep.
+ * The ordering, the symbolic factorization and the index structures of L,
+ * U and the solve are set up once, by pdgssvx() for the first value set,
+ * unless options->Fact = FACTORED; each of the following sets is moved
+ * into L and U along the map kept by pdgsrefactor() and factored
+ * numerically, then solved with Fact = FACTORED. Only the factors of the
+ * last value set are kept.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         The options of pdgssvx(). With Fact = FACTORED, A, the scalings
+ *         and the factors are those of a previous factorization with
+ *         RefactorMap = YES (a previous sweep, say), and the first value
+ *         set is refactored as the others. RefactorMap and ReleaseMemory
+ *         are overridden. On exit, only SolveInitialized and
+ *         RefineInitialized are changed, as by pdgssvx().
+ *
+ * A       (input/output) SuperMatrix*
+ *         The matrix of the pattern, as for pdgssvx(); its values on entry
+ *         are not used. On exit, as left by pdgsrefactor() and pdgssvx()
+ *         for the last value set.
+ *
+ * nvals   (input) int
+ *         The number of value sets.
+ *
+ * nzval   (input) double**, dimension (nvals)
+ *         nzval[v], of dimension A->Store->rowptr[m_loc], holds the values
+ *         of the local rows of A_v, in the order of the entries of A on
+ *         entry.
+ *
+ * B       (input/output) double**, dimension (nvals)
+ *         On entry, B[v] holds the local rows of the right-hand sides of
+ *         A_v; on exit, those of the solution.
+ *
+ * ldb     (input) int
+ *         The leading dimension of each B[v].
+ *
+ * nrhs    (input) int
+ *         The number of right-hand sides of each A_v; may be 0.
+ *
+ * ScalePermstruct, grid, LUstruct, SOLVEstruct
+ *         As for pdgssvx(); kept for the last value set.
+ *
+ * berr    (output) double**, dimension (nvals)
+ *         berr[v], of dimension nrhs, is the componentwise relative
+ *         backward error of the solution of A_v.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         The times and operation counts summed over the value sets.
+ *
+ * info    (output) int*, dimension (nvals)
+ *         info[v] is the info of the factorization and the solve of A_v.
+ *         A singular A_v does not stop the sweep; an illegal argument or
+ *         a memory failure does, and is repeated in the info of the
+ *         remaining value sets.
+ * </pre>
+ */
+void
+pdgssvx_sweep(superlu_dist_options_t *options, SuperMatrix *A, int nvals,
+	      double **nzval, double **B, int ldb, int nrhs,
+	      dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	      dLUstruct_t *LUstruct, dSOLVEstruct_t *SOLVEstruct,
+	      double **berr, SuperLUStat_t *stat, int *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    superlu_dist_options_t opts = *options;
+    SuperLUStat_t vstat;
+    int_t nnz_loc = Astore->rowptr[Astore->m_loc], n = A->ncol;
+    int   v, i, stop = 0;
+
+    opts.RefactorMap = YES;
+    opts.ReleaseMemory = NO;
+    for (v = 0; v < nvals; ++v) {
+	if ( stop ) { /* no factors to work with */
+	    info[v] = info[v-1];
+	    continue;
+	}
+	PStatInit(&vstat);
+	if ( v == 0 && options->Fact != FACTORED ) {
+	    /* The analysis and the first factorization. */
+	    memcpy(Astore->nzval, nzval[0], nnz_loc * sizeof(double));
+	    pdgssvx(&opts, A, ScalePermstruct, B[0], ldb, nrhs, grid,
+		    LUstruct, SOLVEstruct, berr[0], &vstat, &info[0]);
+	} else {
+	    opts.Fact = FACTORED;
+	    pdgsrefactor(&opts, A, nzval[v], ScalePermstruct, grid, LUstruct,
+			 SOLVEstruct, &vstat, &info[v]);
+	    if ( info[v] == 0 && nrhs > 0 )
+		pdgssvx(&opts, A, ScalePermstruct, B[v], ldb, nrhs, grid,
+			LUstruct, SOLVEstruct, berr[v], &vstat, &info[v]);
+	}
+	stop = ( info[v] < 0 || info[v] > n );
+
+	for (i = 0; i < NPHASES; ++i) {
+	    stat->utime[i] += vstat.utime[i];
+	    stat->ops[i] += vstat.ops[i];
+	}
+	stat->TinyPivots += vstat.TinyPivots;
+	stat->RefineSteps = SUPERLU_MAX(stat->RefineSteps, vstat.RefineSteps);
+	PStatFree(&vstat);
+    }
+    options->SolveInitialized = opts.SolveInitialized;
+    options->RefineInitialized = opts.RefineInitialized;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSSVX_SHIFTS solves (A - sigma[v]*I) * X_v = B_v for nshifts shifts,
+ * as met in eigensolvers and frequency sweeps, with one analysis: the
+ * diagonal is added to the pattern of A where missing, the first shift
+ * goes through pdgssvx() (row permutation, scalings, ordering, symbolic
+ * factorization and distribution), and the others are only refactored
+ * along the kept map, see pdgssvx_sweep(). The row permutation and the
+ * scalings are those of the first shift, which should be the most
+ * representative one.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         As for pdgssvx_sweep(); options->Fact applies to the first
+ *         shift and must not be FACTORED.
+ *
+ * A       (input/output) SuperMatrix*
+ *         On entry, the matrix A, as for pdgssvx(). On exit, its pattern
+ *         includes the diagonal (the arrays of A->Store are reallocated
+ *         by SUPERLU_MALLOC if entries are added), and it is left as by
+ *         pdgssvx_sweep() for the last shift.
+ *
+ * nshifts (input) int
+ *         The number of shifts.
+ *
+ * sigma   (input) double*, dimension (nshifts)
+ *         The shifts.
+ *
+ * B, ldb, nrhs, ScalePermstruct, grid, LUstruct, SOLVEstruct, berr,
+ * stat, info
+ *         As for pdgssvx_sweep(), with one value set per shift.
+ * </pre>
+ */
+void
+pdgssvx_shifts(superlu_dist_options_t *options, SuperMatrix *A,
+	       int nshifts, double *sigma, double **B, int ldb, int nrhs,
+	       dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	       dLUstruct_t *LUstruct, dSOLVEstruct_t *SOLVEstruct,
+	       double **berr, SuperLUStat_t *stat, int *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    superlu_dist_options_t opts = *options;
+    int_t  m_loc = Astore->m_loc, fst_row = Astore->fst_row;
+    int_t  *rowptr = Astore->rowptr, *colind = Astore->colind;
+    int_t  *diag, *nrowptr, *ncolind, nnz_loc, nmiss = 0, i, j, k;
+    double *a = (double *) Astore->nzval, *na, *a0, *work;
+    int    v;
+
+    if ( nshifts <= 0 ) return;
+    if ( options->Fact == FACTORED || A->nrow != A->ncol ) {
+	for (v = 0; v < nshifts; ++v) info[v] = options->Fact == FACTORED ?
+					     -1 : -2;
+	pxerr_dist("pdgssvx_shifts", grid, -info[0]);
+	return;
+    }
+
+    /* Find the diagonal of each local row. */
+    if ( !(diag = intMalloc_dist(m_loc + 1)) )
+	ABORT("Malloc fails for diag[].");
+    for (i = 0; i < m_loc; ++i) {
+	diag[i] = EMPTY;
+	for (j = rowptr[i]; j < rowptr[i+1]; ++j)
+	    if ( colind[j] == fst_row + i ) diag[i] = j;
+	if ( diag[i] == EMPTY ) ++nmiss;
+    }
+
+    if ( nmiss ) {
+	/* Put explicit zeros on the missing diagonal, at the end of the
+	   row. */
+	nnz_loc = rowptr[m_loc] + nmiss;
+	if ( !(nrowptr = intMalloc_dist(m_loc + 1))
+	     || !(ncolind = intMalloc_dist(nnz_loc))
+	     || !(na = doubleMalloc_dist(nnz_loc)) )
+	    ABORT("Malloc fails for the shifted A.");
+	for (k = 0, i = 0; i < m_loc; ++i) {
+	    nrowptr[i] = k;
+	    if ( diag[i] != EMPTY ) diag[i] += k - rowptr[i];
+	    for (j = rowptr[i]; j < rowptr[i+1]; ++j, ++k) {
+		ncolind[k] = colind[j];
+		na[k] = a[j];
+	    }
+	    if ( diag[i] == EMPTY ) {
+		ncolind[k] = fst_row + i;
+		na[k] = 0.0;
+		diag[i] = k++;
+	    }
+	}
+	nrowptr[m_loc] = k;
+	SUPERLU_FREE(Astore->rowptr);
+	SUPERLU_FREE(Astore->colind);
+	SUPERLU_FREE(Astore->nzval);
+	Astore->rowptr = rowptr = nrowptr;
+	Astore->colind = ncolind;
+	Astore->nzval = a = na;
+	Astore->nnz_loc = nnz_loc;
+    }
+
+    /* The values of A, which pdgssvx() overwrites, and of A - sigma*I. */
+    nnz_loc = rowptr[m_loc];
+    if ( !(a0 = doubleMalloc_dist(nnz_loc + 1))
+	 || !(work = doubleMalloc_dist(nnz_loc + 1)) )
+	ABORT("Malloc fails for a0[] and work[].");
+    memcpy(a0, a, nnz_loc * sizeof(double));
+
+    for (v = 0; v < nshifts; ++v) {
+	memcpy(work, a0, nnz_loc * sizeof(double));
+	for (i = 0; i < m_loc; ++i) work[diag[i]] -= sigma[v];
+	if ( v > 0 ) opts.Fact = FACTORED;
+	pdgssvx_sweep(&opts, A, 1, &work, &B[v], ldb, nrhs, ScalePermstruct,
+		      grid, LUstruct, SOLVEstruct, &berr[v], stat, &info[v]);
+	if ( info[v] < 0 || info[v] > A->ncol ) {
+	    for (++v; v < nshifts; ++v) info[v] = info[v-1];
+	    break;
+	}
+    }
+    options->SolveInitialized = opts.SolveInitialized;
+    options->RefineInitialized = opts.RefineInitialized;
+
+    SUPERLU_FREE(a0);
+    SUPERLU_FREE(work);
+    SUPERLU_FREE(diag);
+}
@@ -26,6 +26,315 @@ at the top-level directory.
 #include <math.h>
 #include "superlu_ddefs.h"
 
+/*! \brief Multiply by the matrix of the refinement.
+ *
+ * <pre>
+ * Computes Y = op(A1)*X, or Y = abs(op(A1))*abs(X) if abs is nonzero, for
+ * the m_loc-by-nrhs local parts X and Y, where A1 = diag(R)*A*diag(C)*Pc'
+ * is the matrix refined by PDGSRFS. Without LUstruct->matvec the product
+ * uses the distributed A set up by pdgsmv_init(). Otherwise A1 is applied
+ * as the product by the original A supplied by the user, between the
+ * permutation by Pc and the scalings by R and C; only m_loc and fst_row of
+ * the distributed A are then accessed.
+ * </pre>
+ */
+void
+pdgsrfs_matvec(trans_t trans, int abs, SuperMatrix *A, dLUstruct_t *LUstruct,
+	       dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	       dSOLVEstruct_t *SOLVEstruct, int nrhs, double *X, int_t ldx,
+	       double *Y, int_t ldy)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t m_loc = Astore->m_loc, fst_row = Astore->fst_row;
+    dMatvec_t *matvec = LUstruct->matvec;
+    DiagScale_t DiagScale = ScalePermstruct->DiagScale;
+    int rowequ = ( DiagScale == ROW || DiagScale == BOTH );
+    int colequ = ( DiagScale == COL || DiagScale == BOTH );
+    double *R = ScalePermstruct->R, *C = ScalePermstruct->C, *w, *z;
+    int_t i, j;
+
+    if ( !matvec ) {
+	for (j = 0; j < nrhs; ++j)
+	    if ( trans == NOTRANS )
+		pdgsmv(abs, A, grid, SOLVEstruct->gsmv_comm, &X[j*ldx],
+		       &Y[j*ldy]);
+	    else
+		pdgsmv_trans(abs, A, grid, SOLVEstruct->gsmv_comm,
+			     &X[j*ldx], &Y[j*ldy]);
+	return;
+    }
+
+    if ( !(w = doubleMalloc_dist(SUPERLU_MAX(2 * m_loc * nrhs, 1))) )
+	ABORT("Malloc fails for w[]");
+    z = w + m_loc * nrhs;
+
+    if ( trans == NOTRANS ) {
+	/* Y = diag(R)*A*diag(C)*(Pc'*X) */
+	pdPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc,
+			       SOLVEstruct->inv_perm_c, X, ldx, w, m_loc,
+			       nrhs, grid);
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < m_loc; ++i) {
+		if ( abs ) w[i + j*m_loc] = fabs(w[i + j*m_loc]);
+		if ( colequ ) w[i + j*m_loc] *= C[fst_row + i];
+	    }
+	matvec->apply(NOTRANS, abs, nrhs, w, m_loc, Y, ldy, matvec->data);
+	if ( rowequ )
+	    for (j = 0; j < nrhs; ++j)
+		for (i = 0; i < m_loc; ++i) Y[i + j*ldy] *= R[fst_row + i];
+    } else {
+	/* Y = Pc*(diag(C)*A'*(diag(R)*X)) */
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < m_loc; ++i) {
+		w[i + j*m_loc] = abs ? fabs(X[i + j*ldx]) : X[i + j*ldx];
+		if ( rowequ ) w[i + j*m_loc] *= R[fst_row + i];
+	    }
+	matvec->apply(TRANS, abs, nrhs, w, m_loc, z, m_loc, matvec->data);
+	if ( colequ )
+	    for (j = 0; j < nrhs; ++j)
+		for (i = 0; i < m_loc; ++i) z[i + j*m_loc] *= C[fst_row + i];
+	pdPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc,
+			       ScalePermstruct->perm_c, z, m_loc, Y, ldy,
+			       nrhs, grid);
+    }
+    SUPERLU_FREE(w);
+}
+
+/* PDGSRFS for op(A) = A (trans = NOTRANS) or op(A) = A^T. */
+static void
+dgsrfs_op(trans_t trans, int_t n, SuperMatrix *A, double anorm,
+	  dLUstruct_t *LUstruct, dScalePermstruct_t *ScalePermstruct,
+	  gridinfo_t *grid, double *B, int_t ldb, double *X, int_t ldx,
+	  int nrhs, dSOLVEstruct_t *SOLVEstruct,
+	  double *berr, SuperLUStat_t *stat, int *info)
+{
+#define ITMAX 20
+
+    double *ax, *R, *T, *dx, *temp, *work, *B_col, *X_col, *lstres, *sloc;
+    int_t *count, *act, i, j, jj, k, lwork, nz;
+    int   iam, nact, stall, block;
+    double eps;
+    double s, safmin, safe1, safe2;
+
+    /* Data structures used by matrix-vector multiply routine. */
+    pdgsmv_comm_t *gsmv_comm = SOLVEstruct->gsmv_comm;
+    NRformat_loc *Astore;
+    int_t        m_loc, fst_row;
+    /* Precision of the messages of the next correction solve. */
+    msg_prec_t   prec = SOLVEstruct->refine_msg_prec;
+
+
+    /* Initialization. */
+    Astore = (NRformat_loc *) A->Store;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    iam = grid->iam;
+
+    /* Test the input parameters. */
+    *info = 0;
+    if ( n < 0 ) *info = -1;
+    else if ( A->nrow != A->ncol || A->nrow < 0 || A->Stype != SLU_NR_loc
+	      || A->Dtype != SLU_D || A->Mtype != SLU_GE )
+	*info = -2;
+    else if ( ldb < SUPERLU_MAX(0, m_loc) ) *info = -10;
+    else if ( ldx < SUPERLU_MAX(0, m_loc) ) *info = -12;
+    else if ( nrhs < 0 ) *info = -13;
+    if (*info != 0) {
+	i = -(*info);
+	pxerr_dist("PDGSRFS", grid, i);
+	return;
+    }
+
+    /* Quick return if possible. */
+    if ( n == 0 || nrhs == 0 ) {
+	return;
+    }
+
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter pdgsrfs()");
+#endif
+
+    /* For the active X, temp and dx of each RHS (NOTRANS or the product
+       by LUstruct->matvec), or ax, temp and dx of each RHS. */
+    block = ( trans == NOTRANS || LUstruct->matvec );
+    lwork = block ? 3 * nrhs * m_loc : (nrhs + 2) * m_loc;
+    if ( !(work = doubleMalloc_dist(SUPERLU_MAX(lwork, 1))) )
+	ABORT("Malloc fails for work[]");
+    ax = work;
+    if ( block ) {
+	temp = ax + nrhs * m_loc;
+	dx = temp + nrhs * m_loc;
+    } else {
+	temp = ax + m_loc;
+	dx = temp + m_loc;
+    }
+    if ( !(count = intMalloc_dist(2 * nrhs)) )
+	ABORT("Malloc fails for count[]");
+    act = count + nrhs;
+    if ( !(lstres = doubleMalloc_dist(3 * nrhs)) )
+	ABORT("Malloc fails for lstres[]");
+    sloc = lstres + nrhs;
+
+    /* NZ = maximum number of nonzero elements in each row of A, plus 1 */
+    nz     = A->ncol + 1;
+    eps    = dmach_dist("Epsilon");
+    safmin = dmach_dist("Safe minimum");
+
+    /* Set SAFE1 essentially to be the underflow threshold times the
+       number of additions in each row. */
+    safe1  = nz * safmin;
+    safe2  = safe1 / eps;
+
+#if ( DEBUGlevel>=1 )
+    if ( !iam ) printf(".. eps = %e\tanorm = %e\tsafe1 = %e\tsafe2 = %e\n",
+		       eps, anorm, safe1, safe2);
+#endif
+
+    /* The right-hand sides are refined together. Each step computes the
+       residuals of those still active, with one block product
+       pdgsmv_block() for A if there are several (or two products by
+       LUstruct->matvec), reduces their backward errors in one
+       MPI_Allreduce, and solves for all their corrections, stored in
+       the first nact columns of dx[], in one triangular solve. A step made
+       with reduced precision messages that does not halve the backward
+       error is made again in full precision, as are the next ones. */
+    for (j = 0; j < nrhs; ++j) {
+	count[j] = 0;
+	lstres[j] = 3.;
+	act[j] = j;
+    }
+    nact = nrhs;
+
+    SUPERLU_PROF_BEGIN(PROF_REFINE, EMPTY);
+    while ( nact ) { /* Loop until stopping criterion is satisfied. */
+
+	block = ( (trans == NOTRANS || LUstruct->matvec) && nact > 1 );
+	if ( block ) {
+	    /* A*X and abs(A)*abs(X) of the active X, stored in dx[] and
+	       temp[], by one block product. */
+	    for (jj = 0; jj < nact; ++jj)
+		memcpy(&ax[jj*m_loc], &X[act[jj]*ldx], m_loc * sizeof(double));
+	    if ( LUstruct->matvec ) {
+		pdgsrfs_matvec(trans, 0, A, LUstruct, ScalePermstruct, grid,
+			       SOLVEstruct, nact, ax, m_loc, dx, m_loc);
+		pdgsrfs_matvec(trans, 1, A, LUstruct, ScalePermstruct, grid,
+			       SOLVEstruct, nact, ax, m_loc, temp, m_loc);
+	    } else
+		pdgsmv_block(A, grid, gsmv_comm, nact, ax, m_loc, dx, temp,
+			     m_loc);
+	}
+
+	for (jj = 0; jj < nact; ++jj) {
+	    j = act[jj];
+	    B_col = &B[j*ldb];
+	    X_col = &X[j*ldx];
+	    R = &dx[jj*m_loc];
+
+	    /* Compute residual R = B - op(A) * X,
+	       where op(A) = A, A**T, or A**H, depending on TRANS. */
+	    if ( block ) {
+		T = &temp[jj*m_loc];
+		for (i = 0; i < m_loc; ++i) R[i] = B_col[i] - R[i];
+	    } else {
+		T = temp;
+		pdgsrfs_matvec(trans, 0, A, LUstruct, ScalePermstruct, grid,
+			       SOLVEstruct, 1, X_col, ldx, ax, m_loc);
+		for (i = 0; i < m_loc; ++i) R[i] = B_col[i] - ax[i];
+		pdgsrfs_matvec(trans, 1, A, LUstruct, ScalePermstruct, grid,
+			       SOLVEstruct, 1, X_col, ldx, T, m_loc);
+	    }
+
+	    /* Compute abs(op(A))*abs(X) + abs(B), stored in T[]. */
+	    for (i = 0; i < m_loc; ++i) T[i] += fabs(B_col[i]);
+
+	    s = 0.0;
+	    for (i = 0; i < m_loc; ++i) {
+		if ( T[i] > safe2 ) {
+		    s = SUPERLU_MAX(s, fabs(R[i]) / T[i]);
+		} else if ( T[i] != 0.0 ) {
+		    /* Adding SAFE1 to the numerator guards against
+		       spuriously zero residuals (underflow). */
+		    s = SUPERLU_MAX(s, (safe1 + fabs(R[i])) / T[i]);
+		}
+		/* If T[i] is exactly 0.0 (computed by PxGSMV), then
+		   we know the true residual also must be exactly 0.0. */
+	    }
+	    sloc[jj] = s;
+	}
+	MPI_Allreduce( sloc, sloc + nrhs, nact, MPI_DOUBLE, MPI_MAX, grid->comm );
+
+	for (jj = 0, k = 0, stall = 0; jj < nact; ++jj) {
+	    j = act[jj];
+	    berr[j] = sloc[nrhs + jj];
+#if ( PRNTlevel>= 1 )
+	    if ( !iam )
+		printf("(%2d) .. RHS " IFMT " step " IFMT ": berr[j] = %e\n",
+		       iam, j, count[j], berr[j]);
+#endif
+	    if ( berr[j] > eps && count[j] < ITMAX
+		 && (berr[j] * 2 <= lstres[j] || prec != SLU_MSG_FULL) ) {
+		if ( berr[j] * 2 > lstres[j] ) stall = 1;
+		if ( k < jj )
+		    memcpy(&dx[k*m_loc], &dx[jj*m_loc], m_loc * sizeof(double));
+		act[k++] = j;
+	    }
+	}
+	nact = k;
+	if ( !nact ) break;
+	if ( stall ) prec = SLU_MSG_FULL;
+
+	/* Compute new dx. */
+	SOLVEstruct->msg_prec = prec;
+#ifdef SLU_HAVE_SINGLE
+	if ( LUstruct->sLUstruct && trans != NOTRANS )
+	    pdsgstrs_trans(n, LUstruct, ScalePermstruct, grid,
+			   dx, m_loc, fst_row, m_loc, nact,
+			   SOLVEstruct, stat, info);
+	else if ( LUstruct->sLUstruct ) /* Single precision factors */
+	    pdsgstrs(n, LUstruct, ScalePermstruct, grid,
+		     dx, m_loc, fst_row, m_loc, nact,
+		     SOLVEstruct, stat, info);
+	else
+#endif
+	if ( trans != NOTRANS )
+	    pdgstrs_trans(n, LUstruct, ScalePermstruct, grid,
+			  dx, m_loc, fst_row, m_loc, nact,
+			  SOLVEstruct, stat, info);
+	else
+	pdgstrs(n, LUstruct, ScalePermstruct, grid,
+		dx, m_loc, fst_row, m_loc, nact,
+		SOLVEstruct, stat, info);
+
+	SOLVEstruct->msg_prec = SLU_MSG_FULL;
+
+	/* Update solution. */
+	for (jj = 0; jj < nact; ++jj) {
+	    j = act[jj];
+	    X_col = &X[j*ldx];
+	    for (i = 0; i < m_loc; ++i) X_col[i] += dx[jj*m_loc + i];
+	    lstres[j] = berr[j];
+	    ++count[j];
+	}
+    } /* end while */
+    SUPERLU_PROF_END(PROF_REFINE, EMPTY);
+
+    /* Report the largest number of steps over all right-hand sides. */
+    stat->RefineSteps = 0;
+    for (j = 0; j < nrhs; ++j)
+	stat->RefineSteps = SUPERLU_MAX(stat->RefineSteps, count[j]);
+
+    /* Deallocate storage. */
+    SUPERLU_FREE(count);
+    SUPERLU_FREE(lstres);
+    SUPERLU_FREE(work);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit pdgsrfs()");
+#endif
+
+} /* dgsrfs_op */
+
 /*! \brief
  *
  * <pre>
@@ -55,6 +364,9 @@ at the top-level directory.
  *        The distributed data structures storing L and U factors.
  *        The L and U factors are obtained from pdgstrf for
  *        the possibly scaled and permuted matrix A.
+ *        If LUstruct->matvec is not NULL, the products by A are made by
+ *        LUstruct->matvec->apply() with the original matrix, and only
+ *        m_loc and fst_row of A are used (see pdgsrfs_matvec()).
  *        See superlu_ddefs.h for the definition of 'dLUstruct_t'.
  *
  * ScalePermstruct (input) dScalePermstruct_t* (global)
@@ -104,6 +416,9 @@ at the top-level directory.
  *
  * stat   (output) SuperLUStat_t*
  *        Record the statistics about the refinement steps.
+ *        stat->RefineSteps is the largest number of steps taken over
+ *        the right-hand sides; it equals ITMAX if the refinement did
+ *        not converge for some right-hand side.
  *        See util.h for the definition of SuperLUStat_t.
  *
  * info   (output) int*
@@ -123,138 +438,33 @@ pdgsrfs(int_t n, SuperMatrix *A, double anorm, dLUstruct_t *LUstruct,
 	dSOLVEstruct_t *SOLVEstruct,
 	double *berr, SuperLUStat_t *stat, int *info)
 {
-#define ITMAX 20
-
-    double *ax, *R, *dx, *temp, *work, *B_col, *X_col;
-    int_t count, i, j, lwork, nz;
-    int   iam;
-    double eps, lstres;
-    double s, safmin, safe1, safe2;
-
-    /* Data structures used by matrix-vector multiply routine. */
-    pdgsmv_comm_t *gsmv_comm = SOLVEstruct->gsmv_comm;
-    NRformat_loc *Astore;
-    int_t        m_loc, fst_row;
-
-
-    /* Initialization. */
-    Astore = (NRformat_loc *) A->Store;
-    m_loc = Astore->m_loc;
-    fst_row = Astore->fst_row;
-    iam = grid->iam;
-
-    /* Test the input parameters. */
-    *info = 0;
-    if ( n < 0 ) *info = -1;
-    else if ( A->nrow != A->ncol || A->nrow < 0 || A->Stype != SLU_NR_loc
-	      || A->Dtype != SLU_D || A->Mtype != SLU_GE )
-	*info = -2;
-    else if ( ldb < SUPERLU_MAX(0, m_loc) ) *info = -10;
-    else if ( ldx < SUPERLU_MAX(0, m_loc) ) *info = -12;
-    else if ( nrhs < 0 ) *info = -13;
-    if (*info != 0) {
-	i = -(*info);
-	pxerr_dist("PDGSRFS", grid, i);
-	return;
-    }
-
-    /* Quick return if possible. */
-    if ( n == 0 || nrhs == 0 ) {
-	return;
-    }
-
-
-#if ( DEBUGlevel>=1 )
-    CHECK_MALLOC(iam, "Enter pdgsrfs()");
-#endif
-
-    lwork = 2 * m_loc;  /* For ax/R/dx and temp */
-    if ( !(work = doubleMalloc_dist(lwork)) )
-	ABORT("Malloc fails for work[]");
-    ax = R = dx = work;
-    temp = ax + m_loc;
-
-    /* NZ = maximum number of nonzero elements in each row of A, plus 1 */
-    nz     = A->ncol + 1;
-    eps    = dmach_dist("Epsilon");
-    safmin = dmach_dist("Safe minimum");
-
-    /* Set SAFE1 essentially to be the underflow threshold times the
-       number of additions in each row. */
-    safe1  = nz * safmin;
-    safe2  = safe1 / eps;
-
-#if ( DEBUGlevel>=1 )
-    if ( !iam ) printf(".. eps = %e\tanorm = %e\tsafe1 = %e\tsafe2 = %e\n",
-		       eps, anorm, safe1, safe2);
-#endif
-
-    /* Do for each right-hand side ... */
-    for (j = 0; j < nrhs; ++j) {
-	count = 0;
-	lstres = 3.;
-	B_col = &B[j*ldb];
-	X_col = &X[j*ldx];
-
-	while (1) { /* Loop until stopping criterion is satisfied. */
-
-	    /* Compute residual R = B - op(A) * X,
-	       where op(A) = A, A**T, or A**H, depending on TRANS. */
-
-	    /* Matrix-vector multiply. */
-	    pdgsmv(0, A, grid, gsmv_comm, X_col, ax);
-
-	    /* Compute residual, stored in R[]. */
-	    for (i = 0; i < m_loc; ++i) R[i] = B_col[i] - ax[i];
-
-	    /* Compute abs(op(A))*abs(X) + abs(B), stored in temp[]. */
-	    pdgsmv(1, A, grid, gsmv_comm, X_col, temp);
-	    for (i = 0; i < m_loc; ++i) temp[i] += fabs(B_col[i]);
-
-	    s = 0.0;
-	    for (i = 0; i < m_loc; ++i) {
-		if ( temp[i] > safe2 ) {
-		    s = SUPERLU_MAX(s, fabs(R[i]) / temp[i]);
-		} else if ( temp[i] != 0.0 ) {
-                    /* Adding SAFE1 to the numerator guards against
-                       spuriously zero residuals (underflow). */
-                    s = SUPERLU_MAX(s, (safe1 + fabs(R[i])) /temp[i]);
-                }
-                /* If temp[i] is exactly 0.0 (computed by PxGSMV), then
-                   we know the true residual also must be exactly 0.0. */
-	    }
-	    MPI_Allreduce( &s, &berr[j], 1, MPI_DOUBLE, MPI_MAX, grid->comm );
-
-#if ( PRNTlevel>= 1 )
-	    if ( !iam )
-		printf("(%2d) .. Step " IFMT ": berr[j] = %e\n", iam, count, berr[j]);
-#endif
-	    if ( berr[j] > eps && berr[j] * 2 <= lstres && count < ITMAX ) {
-		/* Compute new dx. */
-		pdgstrs(n, LUstruct, ScalePermstruct, grid,
-			dx, m_loc, fst_row, m_loc, 1,
-			SOLVEstruct, stat, info);
-
-		/* Update solution. */
-		for (i = 0; i < m_loc; ++i) X_col[i] += dx[i];
-
-		lstres = berr[j];
-		++count;
-	    } else {
-		break;
-	    }
-	} /* end while */
-
-	stat->RefineSteps = count;
-
-    } /* for j ... */
-
-    /* Deallocate storage. */
-    SUPERLU_FREE(work);
-
-#if ( DEBUGlevel>=1 )
-    CHECK_MALLOC(iam, "Exit pdgsrfs()");
-#endif
-
+    dgsrfs_op(NOTRANS, n, A, anorm, LUstruct, ScalePermstruct, grid,
+	      B, ldb, X, ldx, nrhs, SOLVEstruct, berr, stat, info);
 } /* PDGSRFS */
 
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSRFS_TRANS is PDGSRFS for the transposed system A^T*X = B:
+ * B is Pc*diag(C)*B, and X is the solution Y computed by PDGSTRS_TRANS,
+ * of A2^T*Y = B with A2 = diag(R)*A*diag(C)*Pc'. The other arguments are
+ * those of PDGSRFS; in particular A is A2, as left by PDGSSVX.
+ *
+ * In order to obtain the solution X to the original system, Y should be
+ * premultiplied by diag(R) if DiagScale = ROW or BOTH.
+ * </pre>
+ */
+void
+pdgsrfs_trans(int_t n, SuperMatrix *A, double anorm, dLUstruct_t *LUstruct,
+	      dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	      double *B, int_t ldb, double *X, int_t ldx, int nrhs,
+	      dSOLVEstruct_t *SOLVEstruct,
+	      double *berr, SuperLUStat_t *stat, int *info)
+{
+    dgsrfs_op(TRANS, n, A, anorm, LUstruct, ScalePermstruct, grid,
+	      B, ldb, X, ldx, nrhs, SOLVEstruct, berr, stat, info);
+} /* PDGSRFS_TRANS */
+
@@ -23,15 +23,49 @@ at the top-level directory.
  * </pre>
  */
 
-#include <math.h>
 #include "superlu_ddefs.h"
 
-/*-- Function prototypes --*/
-static void gather_1rhs_diag_to_all(int_t, double [], Glu_persist_t *,
-                                    dLocalLU_t *, gridinfo_t *, int_t, int_t [],
-				    int_t [], double [], double []);
-static void redist_all_to_diag(int_t, double [], Glu_persist_t *,
-                               dLocalLU_t *, gridinfo_t *, int_t [], double []);
+/*! \brief Make the local rows [fst_row, fst_row+m_loc) of the global
+ *         A (SLU_NCP) a distributed matrix, in the form pdgsrfs() takes.
+ */
+static void
+dcreate_rows_loc(SuperMatrix *A, int_t fst_row, int_t m_loc,
+		 SuperMatrix *A_loc)
+{
+    NCPformat *Astore = (NCPformat *) A->Store;
+    double *a = (double *) Astore->nzval, *nzval;
+    int_t  *colbeg = Astore->colbeg, *colend = Astore->colend;
+    int_t  *rowind = Astore->rowind;
+    int_t  *rowptr, *colind, i, irow, j, nnz_loc;
+
+    if ( !(rowptr = intCalloc_dist(m_loc + 1)) )
+	ABORT("Calloc fails for rowptr[]");
+    for (j = 0; j < A->ncol; ++j)
+	for (i = colbeg[j]; i < colend[j]; ++i) {
+	    irow = rowind[i] - fst_row;
+	    if ( irow >= 0 && irow < m_loc ) ++rowptr[irow + 1];
+	}
+    for (i = 0; i < m_loc; ++i) rowptr[i + 1] += rowptr[i];
+    nnz_loc = rowptr[m_loc];
+    if ( !(colind = intMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for colind[]");
+    if ( !(nzval = doubleMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for nzval[]");
+    for (j = 0; j < A->ncol; ++j)
+	for (i = colbeg[j]; i < colend[j]; ++i) {
+	    irow = rowind[i] - fst_row;
+	    if ( irow >= 0 && irow < m_loc ) {
+		colind[rowptr[irow]] = j;
+		nzval[rowptr[irow]++] = a[i];
+	    }
+	}
+    for (i = m_loc; i > 0; --i) rowptr[i] = rowptr[i - 1];
+    rowptr[0] = 0;
+
+    dCreate_CompRowLoc_Matrix_dist(A_loc, A->nrow, A->ncol, nnz_loc, m_loc,
+				   fst_row, nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_D, SLU_GE);
+}
 
 /*! \brief
  *
@@ -43,6 +77,13 @@ static void redist_all_to_diag(int_t, double [], Glu_persist_t *,
  * equations and provides error bounds and backward error estimates
  * for the solution.
  *
+ * A, B and X are global, but the refinement is that of pdgsrfs(): each
+ * process takes a block of rows of A, B and X, the products with A are
+ * made by pdgsmv() on these rows and the corrections are solved by
+ * pdgstrs() for all the right-hand sides still active at once, so that
+ * a step costs O(nnz(A)/P) flops per process instead of O(n) and the
+ * full vectors are only gathered once, on exit.
+ *
  * Arguments
  * =========
  *
@@ -55,8 +96,7 @@ static void redist_all_to_diag(int_t, double [], Glu_persist_t *,
  *        are permutation matrices. The type of A can be:
  *        Stype = SLU_NCP; Dtype = SLU_D; Mtype = SLU_GE.
  *
- *        NOTE: Currently, A must reside in all processes when calling
- *              this routine.
+ *        NOTE: A must reside in all processes when calling this routine.
  *
  * anorm  (input) double
  *        The norm of the original matrix A, or the scaled A if
@@ -80,8 +120,7 @@ static void redist_all_to_diag(int_t, double [], Glu_persist_t *,
  *        The N-by-NRHS right-hand side matrix of the possibly equilibrated
  *        and row permuted system.
  *
- *        NOTE: Currently, B must reside on all processes when calling
- *              this routine.
+ *        NOTE: B must reside on all processes when calling this routine.
  *
  * ldb    (input) int (global)
  *        Leading dimension of matrix B.
@@ -92,8 +131,7 @@ static void redist_all_to_diag(int_t, double [], Glu_persist_t *,
  *        If DiagScale = COL or BOTH, X should be premultiplied by diag(C)
  *        in order to obtain the solution to the original system.
  *
- *        NOTE: Currently, X must reside on all processes when calling
- *              this routine.
+ *        NOTE: X must reside on all processes when calling this routine.
  *
  * ldx    (input) int (global)
  *        Leading dimension of matrix X.
@@ -108,16 +146,13 @@ static void redist_all_to_diag(int_t, double [], Glu_persist_t *,
  *
  * stat   (output) SuperLUStat_t*
  *        Record the statistics about the refinement steps.
+ *        stat->RefineSteps is the largest number of steps taken over
+ *        the right-hand sides.
  *        See util.h for the definition of SuperLUStat_t.
  *
  * info   (output) int*
  *        = 0: successful exit
  *        < 0: if info = -i, the i-th argument had an illegal value
- *
- * Internal Parameters
- * ===================
- *
- * ITMAX is the maximum number of steps of iterative refinement.
  * </pre>
  */
 
@@ -126,39 +161,13 @@ pdgsrfs_ABXglobal(int_t n, SuperMatrix *A, double anorm, dLUstruct_t *LUstruct,
 		  gridinfo_t *grid, double *B, int_t ldb, double *X, int_t ldx,
 		  int nrhs, double *berr, SuperLUStat_t *stat, int *info)
 {
-
-
-#define ITMAX 20
-
-    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
-    dLocalLU_t *Llu = LUstruct->Llu;
-    /*
-     * Data structures used by matrix-vector multiply routine.
-     */
-    int_t  N_update; /* Number of variables updated on this process */
-    int_t  *update;  /* vector elements (global index) updated
-			on this processor.                     */
-    int_t  *bindx;
-    double *val;
-    int_t *mv_sup_to_proc;  /* Supernode to process mapping in
-			       matrix-vector multiply.  */
-    /*-- end data structures for matrix-vector multiply --*/
-    double *b, *ax, *R, *B_col, *temp, *work, *X_col,
-           *x_trs, *dx_trs;
-    int_t count, ii, j, jj, k, knsupc, lk, lwork,
-          nprow, nsupers, nz, p;
-    int   i, iam, pkk;
-    int_t *ilsum, *xsup;
-    double eps, lstres;
-    double s, safmin, safe1, safe2;
-
-    /* NEW STUFF */
-    int_t num_diag_procs, *diag_procs; /* Record diagonal process numbers. */
-    int_t *diag_len; /* Length of the X vector on diagonal processes. */
-
-    /*-- Function prototypes --*/
-    extern void pdgstrs1(int_t, dLUstruct_t *, gridinfo_t *,
-			 double *, int, SuperLUStat_t *, int *);
+    superlu_dist_options_t options;
+    dScalePermstruct_t ScalePermstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    SuperMatrix A_loc;
+    double *b_loc, *x_loc, *work;
+    int_t  *perm, fst_row, m_loc, i, j;
+    int    *counts, *displs, iam, p, procs;
 
     /* Test the input parameters. */
     *info = 0;
@@ -182,284 +191,78 @@ pdgsrfs_ABXglobal(int_t n, SuperMatrix *A, double anorm, dLUstruct_t *LUstruct,
 
     /* Initialization. */
     iam = grid->iam;
-    nprow = grid->nprow;
-    nsupers = Glu_persist->supno[n-1] + 1;
-    xsup = Glu_persist->xsup;
-    ilsum = Llu->ilsum;
+    procs = grid->nprow * grid->npcol;
 
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(iam, "Enter pdgsrfs_ABXglobal()");
 #endif
 
-    get_diag_procs(n, Glu_persist, grid, &num_diag_procs,
-		   &diag_procs, &diag_len);
-#if ( PRNTlevel>=1 )
-    if ( !iam ) {
-	printf(".. number of diag processes = " IFMT "\n", num_diag_procs);
-	PrintInt10("diag_procs", num_diag_procs, diag_procs);
-	PrintInt10("diag_len", num_diag_procs, diag_len);
+    /* Block row distribution: n/procs rows per process, the remainder
+       to the last one. */
+    if ( !(counts = SUPERLU_MALLOC(2 * procs * sizeof(int))) )
+	ABORT("Malloc fails for counts[]");
+    displs = counts + procs;
+    for (p = 0; p < procs; ++p) {
+	displs[p] = p * (n / procs);
+	counts[p] = ( p == procs - 1 ) ? n - displs[p] : n / procs;
     }
-#endif
-
-    if ( !(mv_sup_to_proc = intCalloc_dist(nsupers)) )
-	ABORT("Calloc fails for mv_sup_to_proc[]");
-
-    pdgsmv_AXglobal_setup(A, Glu_persist, grid, &N_update, &update,
-		          &val, &bindx, mv_sup_to_proc);
-
-    i = CEILING( nsupers, nprow ); /* Number of local block rows */
-    ii = Llu->ldalsum + i * XK_H;
-    k = SUPERLU_MAX(N_update, sp_ienv_dist(3));
-    jj = diag_len[0];
-    for (j = 1; j < num_diag_procs; ++j) jj = SUPERLU_MAX( jj, diag_len[j] );
-    jj = SUPERLU_MAX( jj, N_update );
-    lwork = N_update         /* For ax and R */
-	  + ii               /* For dx_trs */
-	  + ii               /* For x_trs */
-          + k                /* For b */
-	  + jj;              /* for temp */
-    if ( !(work = doubleMalloc_dist(lwork)) )
+    fst_row = displs[iam];
+    m_loc = counts[iam];
+    dcreate_rows_loc(A, fst_row, m_loc, &A_loc);
+
+    /* A, B and X are already in the permuted order of the factors. */
+    if ( !(perm = intMalloc_dist(n)) ) ABORT("Malloc fails for perm[]");
+    for (i = 0; i < n; ++i) perm[i] = i;
+    ScalePermstruct.DiagScale = NOEQUIL;
+    ScalePermstruct.R = ScalePermstruct.C = NULL;
+    ScalePermstruct.perm_r = ScalePermstruct.perm_c = perm;
+
+    set_default_options_dist(&options);
+    dSolveInit(&options, &A_loc, perm, perm, nrhs, LUstruct, grid,
+	       &SOLVEstruct);
+    pdgsmv_init(&A_loc, SOLVEstruct.row_to_proc, grid, SOLVEstruct.gsmv_comm);
+    options.RefineInitialized = YES;
+
+    if ( !(work = doubleMalloc_dist(SUPERLU_MAX((size_t) n * nrhs,
+					       2 * (size_t) m_loc * nrhs))) )
 	ABORT("Malloc fails for work[]");
-    ax = R = work;
-    dx_trs = work + N_update;
-    x_trs  = dx_trs + ii;
-    b      = x_trs + ii;
-    temp   = b + k;
-
-#if ( DEBUGlevel>=2 )
-    {
-	double *dwork = doubleMalloc_dist(n);
-	for (i = 0; i < n; ++i) {
-	    if ( i & 1 ) dwork[i] = 1.;
-	    else dwork[i] = 2.;
-        }
-	/* Check correctness of matrix-vector multiply. */
-	pdgsmv_AXglobal(N_update, update, val, bindx, dwork, ax);
-	Printdouble5("Mult A*x", N_update, ax);
-	SUPERLU_FREE(dwork);
-    }
-#endif
-
-
-    /* NZ = maximum number of nonzero elements in each row of A, plus 1 */
-    nz     = A->ncol + 1;
-    eps    = dmach_dist("Epsilon");
-    safmin = dmach_dist("Safe minimum");
-
-    /* Set SAFE1 essentially to be the underflow threshold times the
-       number of additions in each row. */
-    safe1  = nz * safmin;
-    safe2  = safe1 / eps;
-
-#if ( DEBUGlevel>=1 )
-    if ( !iam ) printf(".. eps = %e\tanorm = %e\tsafe1 = %e\tsafe2 = %e\n",
-		       eps, anorm, safe1, safe2);
-#endif
-
-    /* Do for each right-hand side ... */
-    for (j = 0; j < nrhs; ++j) {
-	count = 0;
-	lstres = 3.;
-
-	/* Copy X into x on the diagonal processes. */
-	B_col = &B[j*ldb];
-	X_col = &X[j*ldx];
-	for (p = 0; p < num_diag_procs; ++p) {
-	    pkk = diag_procs[p];
-	    if ( iam == pkk ) {
-		for (k = p; k < nsupers; k += num_diag_procs) {
-		    knsupc = SuperSize( k );
-		    lk = LBi( k, grid );
-		    ii = ilsum[lk] + (lk+1)*XK_H;
-		    jj = FstBlockC( k );
-		    for (i = 0; i < knsupc; ++i) x_trs[i+ii] = X_col[i+jj];
-		    dx_trs[ii-XK_H] = k;/* Block number prepended in header. */
-		}
-	    }
+    b_loc = work;
+    x_loc = work + (size_t) m_loc * nrhs;
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) {
+	    b_loc[i + j * m_loc] = B[fst_row + i + j * ldb];
+	    x_loc[i + j * m_loc] = X[fst_row + i + j * ldx];
 	}
-	/* Copy B into b distributed the same way as matrix-vector product. */
-        if ( N_update ) ii = update[0];
-	for (i = 0; i < N_update; ++i) b[i] = B_col[i + ii];
-
-	while (1) { /* Loop until stopping criterion is satisfied. */
-
-	    /* Compute residual R = B - op(A) * X,
-	       where op(A) = A, A**T, or A**H, depending on TRANS. */
-
-	    /* Matrix-vector multiply. */
-	    pdgsmv_AXglobal(N_update, update, val, bindx, X_col, ax);
-
-	    /* Compute residual. */
-	    for (i = 0; i < N_update; ++i) R[i] = b[i] - ax[i];
-
-	    /* Compute abs(op(A))*abs(X) + abs(B). */
-	    pdgsmv_AXglobal_abs(N_update, update, val, bindx, X_col, temp);
-	    for (i = 0; i < N_update; ++i) temp[i] += fabs(b[i]);
-
-	    s = 0.0;
-	    for (i = 0; i < N_update; ++i) {
-		if ( temp[i] > safe2 ) {
-		    s = SUPERLU_MAX(s, fabs(R[i]) / temp[i]);
-		} else if ( temp[i] != 0.0 ) {
-                    /* Adding SAFE1 to the numerator guards against
-                       spuriously zero residuals (underflow). */
-		    s = SUPERLU_MAX(s, (safe1 + fabs(R[i])) / temp[i]);
-                }
-                /* If temp[i] is exactly 0.0 (computed by PxGSMV), then
-                   we know the true residual also must be exactly 0.0. */
-	    }
-	    MPI_Allreduce( &s, &berr[j], 1, MPI_DOUBLE, MPI_MAX, grid->comm );
-
-#if ( PRNTlevel>= 1 )
-	    if ( !iam )
-		printf("(%2d) .. Step " IFMT ": berr[j] = %e\n", iam, count, berr[j]);
-#endif
-	    if ( berr[j] > eps && berr[j] * 2 <= lstres && count < ITMAX ) {
-		/* Compute new dx. */
-		redist_all_to_diag(n, R, Glu_persist, Llu, grid,
-				   mv_sup_to_proc, dx_trs);
-		pdgstrs1(n, LUstruct, grid, dx_trs, 1, stat, info);
 
-		/* Update solution. */
-		for (p = 0; p < num_diag_procs; ++p)
-		    if ( iam == diag_procs[p] )
-			for (k = p; k < nsupers; k += num_diag_procs) {
-			    lk = LBi( k, grid );
-			    ii = ilsum[lk] + (lk+1)*XK_H;
-			    knsupc = SuperSize( k );
-			    for (i = 0; i < knsupc; ++i)
-				x_trs[i + ii] += dx_trs[i + ii];
-			}
-		lstres = berr[j];
-		++count;
-		/* Transfer x_trs (on diagonal processes) into X
-		   (on all processes). */
-		gather_1rhs_diag_to_all(n, x_trs, Glu_persist, Llu, grid,
-					num_diag_procs, diag_procs, diag_len,
-					X_col, temp);
-	    } else {
-		break;
-	    }
-	} /* end while */
-
-	stat->RefineSteps = count;
-
-    } /* for j ... */
-
-
-    /* Deallocate storage used by matrix-vector multiplication. */
-    SUPERLU_FREE(diag_procs);
-    SUPERLU_FREE(diag_len);
-    if ( N_update ) {
-	SUPERLU_FREE(update);
-	SUPERLU_FREE(bindx);
-	SUPERLU_FREE(val);
+    pdgsrfs(n, &A_loc, anorm, LUstruct, &ScalePermstruct, grid,
+	    b_loc, SUPERLU_MAX(m_loc, 1), x_loc, SUPERLU_MAX(m_loc, 1), nrhs,
+	    &SOLVEstruct, berr, stat, info);
+
+    /* Gather the refined rows of X onto all processes; the block of
+       process p, m_p-by-nrhs, is at work[f_p * nrhs]. */
+    memmove(&work[(size_t) fst_row * nrhs], x_loc,
+	    (size_t) m_loc * nrhs * sizeof(double));
+    for (p = 0; p < procs; ++p) {
+	counts[p] *= nrhs;
+	displs[p] *= nrhs;
     }
-    SUPERLU_FREE(mv_sup_to_proc);
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, work, counts, displs,
+		   MPI_DOUBLE, grid->comm);
+    for (p = 0; p < procs; ++p) {
+	int_t m_p = counts[p] / nrhs, f_p = displs[p] / nrhs;
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < m_p; ++i)
+		X[f_p + i + j * ldx] = work[displs[p] + i + j * m_p];
+    }
+
+    dSolveFinalize(&options, &SOLVEstruct);
+    Destroy_CompRowLoc_Matrix_dist(&A_loc);
+    SUPERLU_FREE(perm);
     SUPERLU_FREE(work);
+    SUPERLU_FREE(counts);
 
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(iam, "Exit pdgsrfs_ABXglobal()");
 #endif
 
 } /* PDGSRFS_ABXGLOBAL */
-
-
-/*! \brief
- *
- * <pre>
- * r[] is the residual vector distributed the same way as
- * matrix-vector product.
- * </pre>
- */
-static void
-redist_all_to_diag(int_t n, double r[], Glu_persist_t *Glu_persist,
-		   dLocalLU_t *Llu, gridinfo_t *grid, int_t mv_sup_to_proc[],
-		   double work[])
-{
-    int_t i, ii, k, lk, lr, nsupers;
-    int_t *ilsum, *xsup;
-    int iam, knsupc, psrc, pkk;
-    MPI_Status status;
-
-    iam = grid->iam;
-    nsupers = Glu_persist->supno[n-1] + 1;
-    xsup = Glu_persist->xsup;
-    ilsum = Llu->ilsum;
-    lr = 0;
-
-    for (k = 0; k < nsupers; ++k) {
-	pkk = PNUM( PROW( k, grid ), PCOL( k, grid ), grid );
-	psrc = mv_sup_to_proc[k];
-	knsupc = SuperSize( k );
-	lk = LBi( k, grid );
-	ii = ilsum[lk] + (lk+1)*XK_H;
-	if ( iam == psrc ) {
-	    if ( iam != pkk ) { /* Send X component. */
-		MPI_Send( &r[lr], knsupc, MPI_DOUBLE, pkk, Xk,
-			 grid->comm );
-	    } else { /* Local copy. */
-		for (i = 0; i < knsupc; ++i)
-		    work[i + ii] = r[i + lr];
-	    }
-	    lr += knsupc;
-	} else {
-	    if ( iam == pkk ) { /* Recv X component. */
-		MPI_Recv( &work[ii], knsupc, MPI_DOUBLE, psrc, Xk,
-			 grid->comm, &status );
-	    }
-	}
-    }
-} /* REDIST_ALL_TO_DIAG */
-
-
-/*! \brief
- *
- * <pre>
- * Gather the components of x vector on the diagonal processes
- * onto all processes, and combine them into the global vector y.
- * </pre>
- */
-static void
-gather_1rhs_diag_to_all(int_t n, double x[],
-			Glu_persist_t *Glu_persist, dLocalLU_t *Llu,
-			gridinfo_t *grid, int_t num_diag_procs,
-			int_t diag_procs[], int_t diag_len[],
-			double y[], double work[])
-{
-    int_t i, ii, k, lk, lwork, nsupers, p;
-    int_t *ilsum, *xsup;
-    int iam, knsupc, pkk;
-
-    iam = grid->iam;
-    nsupers = Glu_persist->supno[n-1] + 1;
-    xsup = Glu_persist->xsup;
-    ilsum = Llu->ilsum;
-
-    for (p = 0; p < num_diag_procs; ++p) {
-	pkk = diag_procs[p];
-	if ( iam == pkk ) {
-	    /* Copy x vector into a buffer. */
-	    lwork = 0;
-	    for (k = p; k < nsupers; k += num_diag_procs) {
-		knsupc = SuperSize( k );
-		lk = LBi( k, grid );
-		ii = ilsum[lk] + (lk+1)*XK_H;
-		for (i = 0; i < knsupc; ++i) work[i+lwork] = x[i+ii];
-		lwork += knsupc;
-	    }
-	    MPI_Bcast( work, lwork, MPI_DOUBLE, pkk, grid->comm );
-	} else {
-	    MPI_Bcast( work, diag_len[p], MPI_DOUBLE, pkk, grid->comm );
-	}
-	/* Scatter work[] into global y vector. */
-	lwork = 0;
-	for (k = p; k < nsupers; k += num_diag_procs) {
-	    knsupc = SuperSize( k );
-	    ii = FstBlockC( k );
-	    for (i = 0; i < knsupc; ++i) y[i+ii] = work[i+lwork];
-	    lwork += knsupc;
-	}
-    }
-} /* GATHER_1RHS_DIAG_TO_ALL */
-
@@ -0,0 +1,326 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Solves with a low-rank update of the factored matrix
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * With the Sherman-Morrison-Woodbury formula,
+ *
+ *   (A + U*V^T)^{-1} = A^{-1} - W * C^{-1} * V^T * A^{-1},
+ *
+ * where W = A^{-1}*U and C = I + V^T*W is the k-by-k capacitance matrix,
+ * a solve with A + U*V^T is a solve with the factors of A, one product
+ * with V^T, a k-by-k solve and one product with W.
+ * </pre>
+ */
+
+#include "superlu_ddefs.h"
+
+#define SMW_MAXRANK 32 /* default of dSMWInit() */
+
+/* LU factorization with partial pivoting of the k-by-k matrix C; returns
+   0, or j+1 if U(j,j) is zero. */
+static int
+smw_getrf(int k, double *C, int *ipiv)
+{
+    int i, j, l, p;
+    double t;
+
+    for (j = 0; j < k; ++j) {
+	for (p = j, i = j + 1; i < k; ++i)
+	    if ( fabs(C[i + j*k]) > fabs(C[p + j*k]) ) p = i;
+	ipiv[j] = p;
+	if ( C[p + j*k] == 0.0 ) return j + 1;
+	if ( p != j )
+	    for (l = 0; l < k; ++l) {
+		t = C[j + l*k]; C[j + l*k] = C[p + l*k]; C[p + l*k] = t;
+	    }
+	for (i = j + 1; i < k; ++i) C[i + j*k] /= C[j + j*k];
+	for (l = j + 1; l < k; ++l)
+	    for (i = j + 1; i < k; ++i) C[i + l*k] -= C[i + j*k] * C[j + l*k];
+    }
+    return 0;
+}
+
+/* Solve C*Y = Y with the factors of smw_getrf(), Y of leading dimension k. */
+static void
+smw_getrs(int k, double *C, int *ipiv, int nrhs, double *Y)
+{
+    int i, j, r;
+    double t, *y;
+
+    for (r = 0, y = Y; r < nrhs; ++r, y += k) {
+	for (j = 0; j < k; ++j)
+	    if ( ipiv[j] != j ) {
+		t = y[j]; y[j] = y[ipiv[j]]; y[ipiv[j]] = t;
+	    }
+	for (j = 0; j < k; ++j)
+	    for (i = j + 1; i < k; ++i) y[i] -= C[i + j*k] * y[j];
+	for (j = k - 1; j >= 0; --j) {
+	    y[j] /= C[j + j*k];
+	    for (i = 0; i < j; ++i) y[i] -= C[i + j*k] * y[j];
+	}
+    }
+}
+
+/* Y = V^T * B, k-by-nrhs, summed over the grid; V of m local rows and k
+   columns, B of leading dimension ldb. */
+static void
+smw_vtb(int m, int k, double *V, double *B, int ldb, int nrhs, double *Y,
+	gridinfo_t *grid)
+{
+    int ldv = SUPERLU_MAX(m, 1);
+    double one = 1.0, zero = 0.0;
+
+    if ( m > 0 ) {
+#if defined (USE_VENDOR_BLAS)
+	dgemm_("T", "N", &k, &nrhs, &m, &one, V, &ldv, B, &ldb, &zero,
+	       Y, &k, 1, 1);
+#else
+	dgemm_("T", "N", &k, &nrhs, &m, &one, V, &ldv, B, &ldb, &zero,
+	       Y, &k);
+#endif
+    } else {
+	memset(Y, 0, (size_t) k * nrhs * sizeof(double));
+    }
+    MPI_Allreduce(MPI_IN_PLACE, Y, k * nrhs, MPI_DOUBLE, MPI_SUM, grid->comm);
+}
+
+/*! \brief Start an empty update of at most kmax columns.
+ *
+ * <pre>
+ * With kmax <= 0, the limit is the environment variable
+ * SUPERLU_SMW_MAXRANK if set, else 32. Beyond it, each solve costs more
+ * than 4*kmax flops per row on top of the solve with A, and
+ * refactoring A + U*V^T is usually the better deal.
+ * </pre>
+ */
+void
+dSMWInit(int kmax, dSMW_t *smw)
+{
+    char *ttemp;
+
+    if ( kmax <= 0 ) {
+	ttemp = getenv("SUPERLU_SMW_MAXRANK");
+	kmax = ttemp ? atoi(ttemp) : SMW_MAXRANK;
+    }
+    smw->kmax = SUPERLU_MAX(kmax, 1);
+    smw->k = 0;
+    smw->m_loc = 0;
+    smw->W = smw->V = smw->C = NULL;
+    smw->ipiv = NULL;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSSMW_UPDATE adds the rank-k term U*V^T to the low-rank update smw of
+ * the matrix A factored by pdgssvx(): W = A^{-1}*U is computed by one
+ * solve with k right-hand sides, and the capacitance matrix
+ * C = I + V^T*W of all the columns so far is formed and factored, the
+ * same on all the processes. pdgssmw_solve() then solves with
+ * A + (all the U*V^T so far).
+ *
+ * Arguments
+ * =========
+ *
+ * options (input/output) superlu_dist_options_t*
+ *         The options of the factorization of A; Fact is restored on
+ *         exit. Only Trans = NOTRANS is supported.
+ *
+ * A, ScalePermstruct, grid, LUstruct, SOLVEstruct
+ *         As left by pdgssvx() after the factorization of A.
+ *
+ * smw     (input/output) dSMW_t*
+ *         The update so far, started by dSMWInit().
+ *
+ * k       (input) int
+ *         The number of columns of U and V.
+ *
+ * U, V    (input) double*, dimension (ldu, k)
+ *         The local rows of U and V, distributed as the rows of A.
+ *
+ * ldu     (input) int
+ *         The leading dimension of U and V, at least A->Store->m_loc.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         The statistics of the solve with A.
+ *
+ * info    (output) int*
+ *         = 0: successful exit
+ *         < 0: if info = -i, the i-th argument had an illegal value
+ *         = 1: the rank would exceed smw->kmax: nothing is done, and
+ *              A + U*V^T should be factored instead (the update is
+ *              then restarted with dSMWFree() and dSMWInit())
+ *         = 2: C is singular, and so is A + U*V^T; the update is left
+ *              as before the call
+ *         > 2: as for pdgssvx(), the solve with A failed.
+ * </pre>
+ */
+void
+pdgssmw_update(superlu_dist_options_t *options, SuperMatrix *A,
+	       dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	       dLUstruct_t *LUstruct, dSOLVEstruct_t *SOLVEstruct,
+	       dSMW_t *smw, int k, double *U, double *V, int ldu,
+	       SuperLUStat_t *stat, int *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int    m = Astore->m_loc, ld = SUPERLU_MAX(m, 1), k0 = smw->k, kt, i, j;
+    double *W, *Vn, *C, *berr;
+    int    *ipiv;
+    fact_t Fact = options->Fact;
+
+    *info = 0;
+    if ( options->Trans != NOTRANS ) *info = -1;
+    else if ( k0 > 0 && m != smw->m_loc ) *info = -2;
+    else if ( k < 0 ) *info = -8;
+    else if ( ldu < m ) *info = -11;
+    if ( *info ) {
+	pxerr_dist("pdgssmw_update", grid, -*info);
+	return;
+    }
+    if ( k == 0 ) return;
+    if ( k0 + k > smw->kmax ) {
+	*info = 1;
+	return;
+    }
+    kt = k0 + k;
+
+    /* The columns of W and V so far, then the new ones. */
+    if ( !(W = doubleMalloc_dist((size_t) ld * kt))
+	 || !(Vn = doubleMalloc_dist((size_t) ld * kt))
+	 || !(C = doubleMalloc_dist((size_t) kt * kt))
+	 || !(ipiv = SUPERLU_MALLOC(kt * sizeof(int)))
+	 || !(berr = doubleMalloc_dist(k)) )
+	ABORT("Malloc fails for the low-rank update.");
+    if ( k0 ) {
+	memcpy(W, smw->W, (size_t) ld * k0 * sizeof(double));
+	memcpy(Vn, smw->V, (size_t) ld * k0 * sizeof(double));
+    }
+    for (j = 0; j < k; ++j)
+	for (i = 0; i < m; ++i) {
+	    W[i + (k0 + j) * ld] = U[i + j * ldu];
+	    Vn[i + (k0 + j) * ld] = V[i + j * ldu];
+	}
+
+    /* W(:,k0:kt-1) = A^{-1} * U, one solve with k right-hand sides. */
+    options->Fact = FACTORED;
+    pdgssvx(options, A, ScalePermstruct, &W[k0 * ld], ld, k, grid, LUstruct,
+	    SOLVEstruct, berr, stat, info);
+    options->Fact = Fact;
+    SUPERLU_FREE(berr);
+    if ( *info ) {
+	*info += 2;
+	goto fail;
+    }
+
+    /* C = I + V^T * W, on all the processes. */
+    smw_vtb(m, kt, Vn, W, ld, kt, C, grid);
+    for (j = 0; j < kt; ++j) C[j + j * kt] += 1.0;
+    if ( smw_getrf(kt, C, ipiv) ) {
+	*info = 2;
+	goto fail;
+    }
+
+    dSMWFree(smw);
+    smw->k = kt;
+    smw->m_loc = m;
+    smw->W = W;
+    smw->V = Vn;
+    smw->C = C;
+    smw->ipiv = ipiv;
+    return;
+
+fail:
+    SUPERLU_FREE(W);
+    SUPERLU_FREE(Vn);
+    SUPERLU_FREE(C);
+    SUPERLU_FREE(ipiv);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSSMW_SOLVE solves (A + U*V^T) * X = B, with the factors of A and the
+ * update smw of pdgssmw_update(): X = A^{-1}*B by pdgssvx(), then
+ * X = X - W * C^{-1} * (V^T*X). Without update, it is pdgssvx() with
+ * Fact = FACTORED.
+ *
+ * The arguments are those of pdgssvx() with Fact = FACTORED, and smw.
+ * berr is that of the solve with A (see options->IterRefine), not of
+ * the updated system.
+ * </pre>
+ */
+void
+pdgssmw_solve(superlu_dist_options_t *options, SuperMatrix *A,
+	      dScalePermstruct_t *ScalePermstruct, dSMW_t *smw, double *B,
+	      int ldb, int nrhs, gridinfo_t *grid, dLUstruct_t *LUstruct,
+	      dSOLVEstruct_t *SOLVEstruct, double *berr, SuperLUStat_t *stat,
+	      int *info)
+{
+    int    m = ((NRformat_loc *) A->Store)->m_loc, k = smw->k;
+    double *Y, one = 1.0, mone = -1.0;
+    fact_t Fact = options->Fact;
+
+    *info = 0;
+    if ( options->Trans != NOTRANS ) *info = -1;
+    else if ( k > 0 && m != smw->m_loc ) *info = -2;
+    if ( *info ) {
+	pxerr_dist("pdgssmw_solve", grid, -*info);
+	return;
+    }
+
+    options->Fact = FACTORED;
+    pdgssvx(options, A, ScalePermstruct, B, ldb, nrhs, grid, LUstruct,
+	    SOLVEstruct, berr, stat, info);
+    options->Fact = Fact;
+    if ( *info || k == 0 || nrhs == 0 ) return;
+
+    if ( !(Y = doubleMalloc_dist((size_t) k * nrhs)) )
+	ABORT("Malloc fails for Y[].");
+    smw_vtb(m, k, smw->V, B, ldb, nrhs, Y, grid);
+    smw_getrs(k, smw->C, smw->ipiv, nrhs, Y);
+    if ( m > 0 ) {
+	int ld = SUPERLU_MAX(m, 1);
+#if defined (USE_VENDOR_BLAS)
+	dgemm_("N", "N", &m, &nrhs, &k, &mone, smw->W, &ld, Y, &k, &one,
+	       B, &ldb, 1, 1);
+#else
+	dgemm_("N", "N", &m, &nrhs, &k, &mone, smw->W, &ld, Y, &k, &one,
+	       B, &ldb);
+#endif
+    }
+    SUPERLU_FREE(Y);
+}
+
+/*! \brief Free the storage of the update; dSMWInit() starts a new one. */
+void
+dSMWFree(dSMW_t *smw)
+{
+    if ( smw->W ) SUPERLU_FREE(smw->W);
+    if ( smw->V ) SUPERLU_FREE(smw->V);
+    if ( smw->C ) SUPERLU_FREE(smw->C);
+    if ( smw->ipiv ) SUPERLU_FREE(smw->ipiv);
+    smw->W = smw->V = smw->C = NULL;
+    smw->ipiv = NULL;
+    smw->k = 0;
+}
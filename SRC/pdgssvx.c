@@ -264,6 +264,8 @@ at the top-level directory.
  *           be factorized based on the previous history.
  *
  *           = DOFACT: The matrix A will be factorized from scratch.
+ *             If SUPERLU_TUNE_CACHE is set, the blocking parameters
+ *             recorded for A by pdgstune() are used.
  *                 Inputs:  A
  *                          options->Equil, RowPerm, ColPerm, ReplaceTinyPivot
  *                 Outputs: modified A
@@ -295,7 +297,9 @@ at the top-level directory.
  *             both row and column scaling factors R and C, and the
  *             both row and column permutation vectors perm_r and perm_c,
  *             distributed data structure set up from the previous symbolic
- *             factorization.
+ *             factorization. The first such call records where the
+ *             entries of A go in L and U (LUstruct->Llu->Amap); the
+ *             following ones only move the new values there.
  *                 Inputs:  A
  *                          options->Equil, ReplaceTinyPivot
  *                          all of ScalePermstruct
@@ -330,24 +334,259 @@ at the top-level directory.
  *                        off-diagonal.
  *           = MY_PERMR:  use the ordering given in ScalePermstruct->perm_r
  *                        input by the user.
+ *           = LargeDiag_AUCTION: use a distributed auction algorithm on
+ *                        the distributed A, with the objective of MC64
+ *                        (maximum product of the diagonal); with Equil = YES
+ *                        the matrix is also scaled as by MC64.
  *
  *         o ColPerm (colperm_t)
  *           Specifies what type of column permutation to use to reduce fill.
  *           = NATURAL:       natural ordering.
  *           = MMD_AT_PLUS_A: minimum degree ordering on structure of A'+A.
  *           = MMD_ATA:       minimum degree ordering on structure of A'*A.
+ *           = AMD_AT_PLUS_A: approximate minimum degree ordering (SYMAMD)
+ *                            on structure of A'+A.
+ *           = RCM_AT_PLUS_A: reverse Cuthill-McKee ordering on structure
+ *                            of A'+A, for long and thin domains; if the
+ *                            band of the factors is narrow, the
+ *                            supernodes are its block columns (see
+ *                            symbfact_band()).
+ *           = PARMETIS:      parallel METIS ordering on structure of A'+A.
+ *           = ZOLTAN:        PT-Scotch parallel nested dissection on the
+ *                            structure of A'+A; needs HAVE_PTSCOTCH.
  *           = MY_PERMC:      the ordering given in ScalePermstruct->perm_c.
+ *           The orderings other than PARMETIS and ZOLTAN are sequential:
+ *           with ParSymbFact = NO, process 0 computes perm_c[] from the
+ *           global graph and broadcasts it; the other processes do not
+ *           order.
  *
  *         o ReplaceTinyPivot (yes_no_t)
  *           = NO:  do not modify pivots
  *           = YES: replace tiny pivots by sqrt(epsilon)*norm(A) during
  *                  LU factorization.
  *
+ *         o Trans (trans_t)
+ *           Specifies the form of the system of equations.
+ *           = NOTRANS: A * X = B.
+ *           = TRANS:   A**T * X = B, solved with the factors of A by
+ *                      pdgstrs_trans(); DiagInv is not used.
+ *           = CONJ:    A**H * X = B, the same as TRANS for real A.
+ *
  *         o IterRefine (IterRefine_t)
  *           Specifies how to perform iterative refinement.
  *           = NO:     no iterative refinement.
  *           = SLU_DOUBLE: accumulate residual in double precision.
  *           = SLU_EXTRA:  accumulate residual in extra precision.
+ *           = SLU_GMRES:  flexible GMRES preconditioned by the LU factors,
+ *                         see pdgsrfs_gmres(); for approximate factors.
+ *
+ *         o SingleFactor (yes_no_t)
+ *           = NO:  compute the LU factors in double precision.
+ *           = YES: compute the LU factors in single precision; they are
+ *                  kept in LUstruct->sLUstruct and used by the triangular
+ *                  solves, while the residual and the update in iterative
+ *                  refinement are computed in double precision.
+ *                  stat->RefineSteps reports the number of steps taken.
+ *
+ *         o ParSymbFact (yes_no_t)
+ *           = NO:  the ordering and the symbolic factorization are done
+ *                  on the global structure of A, gathered on all processes.
+ *                  The symbolic factorization is computed by one process
+ *                  of each node, with its OpenMP threads on independent
+ *                  subtrees of the etree, and broadcast to the others
+ *                  (see symbfact_node()).
+ *           = YES: use the parallel symbolic factorization on the
+ *                  distributed A (ColPerm = PARMETIS, ZOLTAN, NATURAL or
+ *                  MY_PERMC).
+ *                  Set SUPERLU_SYMB_SCRATCH to a node-local directory to
+ *                  spill the structures there when they are expanded.
+ *                  Unless RowPerm = LargeDiag_MC64, no process then holds
+ *                  the global matrix: equilibration, the row permutation
+ *                  (not MC64), the ordering, the symbolic
+ *                  factorization and the redistribution into L and U all
+ *                  work on distributed data.
+ *
+ *         o ShareReplicated (yes_no_t)
+ *           = YES: after the factorization, keep perm_r, perm_c, etree
+ *                  and the supernode partition in node-shared memory
+ *                  (one copy per node, see superlu_shm.c).
+ *
+ *         o SchurSize (int)
+ *           Specifies the number of trailing rows and columns of A, the
+ *           interface, that are left out of the factorization. With
+ *           SchurSize > 0, perm_c[] orders the interface last, the
+ *           supernodes of the interface are not factored, and the
+ *           Schur complement of the interior of A is returned by
+ *           pdGetSchur() afterwards. It requires RowPerm = NOROWPERM,
+ *           ParSymbFact = NO, SingleFactor = NO and nrhs = 0.
+ *
+ *         o BLR_Tol (double), BLR_MinSize (int)
+ *           With BLR_Tol > 0, the blocks L(i,k) of at least BLR_MinSize
+ *           rows and columns are compressed to low rank with tolerance
+ *           BLR_Tol in the Schur complement update. The LU factors are then
+ *           approximate, and IterRefine should not be NOREFINE.
+ *
+ *         o Reproducible (yes_no_t)
+ *           Specifies whether the triangular solves add the contributions
+ *           of the processes in a fixed order, so that repeated runs on
+ *           the same process grid give bitwise identical solutions.
+ *           Only the solves with Trans = NOTRANS are affected.
+ *
+ *         o Amalg_Tol (double)
+ *           With Amalg_Tol > 0 and ParSymbFact = NO, each supernode from
+ *           the symbolic factorization is merged with its parent while the
+ *           explicit zeros stay below the fraction Amalg_Tol of the stored
+ *           L of the merged supernode (see symbfact_amalgamate()).
+ *
+ *         o SplitSuper (int)
+ *           With SplitSuper > 0 and ParSymbFact = NO, the supernodes with
+ *           more columns are split into block columns of at most
+ *           SplitSuper columns after the symbolic factorization (see
+ *           symbfact_split()).
+ *
+ *         o Dense_MaxN (int)
+ *           With Fact != FACTORED and n <= Dense_MaxN, A is gathered on
+ *           every process and factored by dense LU with partial pivoting,
+ *           and the later solves with Fact = FACTORED use these factors
+ *           (see pdgssvx_dense()). Of ScalePermstruct, only the scaling
+ *           is used, by the solves with Fact = FACTORED; SOLVEstruct is
+ *           not used.
+ *
+ *         o UserSymbFact (yes_no_t)
+ *           With UserSymbFact = YES, Fact = DOFACT or SamePattern and
+ *           ColPerm = MY_PERMC, the supernodes, etree and blocks of L and
+ *           U given in LUstruct->usymb replace the symbolic
+ *           factorization; info = -8 if they are not valid for A.
+ *
+ *         o Solve_Compact (yes_no_t)
+ *           With Solve_Compact = YES, the factors are released as with
+ *           ReleaseMemory = YES and, at the first solve, copied into one
+ *           array in the order of the solves, see dCompact_LU().
+ *
+ *         o PatternCache (yes_no_t)
+ *           = YES: with Fact = DOFACT and ParSymbFact = NO, the column
+ *                  ordering, etree and symbolic factorization are kept in
+ *                  a cache keyed by the sparsity pattern of Pr*A, and
+ *                  reused for the next matrices with the same pattern.
+ *                  It is ignored with ColPerm = MY_PERMC, PARMETIS or
+ *                  ZOLTAN.
+ *
+ *         o RowPerm_Tol (double)
+ *           With RowPerm_Tol > 0, Fact = SamePattern, Equil = YES and
+ *           RowPerm = LargeDiag_MC64 or LargeDiag_AUCTION, the perm_r, R
+ *           and C of the previous factorization (ScalePermstruct->DiagScale
+ *           = BOTH) are kept, and the row permutation step is skipped,
+ *           while in diag(R)*A*diag(C) the matched entries stay at least
+ *           RowPerm_Tol and all entries at most 1/RowPerm_Tol in absolute
+ *           value (see pdldperm_check()).
+ *
+ *         o Equil_Iter (int)
+ *           With Equil_Iter > 0 and Equil = YES, R and C are computed by
+ *           at most Equil_Iter sweeps of the Ruiz scaling, which bring the
+ *           largest entry of every row and column of diag(R)*A*diag(C)
+ *           close to one (see pdgsequ_ruiz()), instead of pdgsequ().
+ *
+ *         o DenseRoot_Tol (double)
+ *           With DenseRoot_Tol > 0 and SchurSize = 0, the trailing
+ *           supernodes whose L and U blocks fill at least the fraction
+ *           DenseRoot_Tol of their dense block are factored as one dense
+ *           matrix on the process grid (see pdgstrf_root()), e.g. the top
+ *           separators of a nested dissection ordering.
+ *
+ *         o Fact_Comm (fact_comm_t)
+ *           Selects how the panels are exchanged in the factorization:
+ *           SLU_COMM_ISEND (default) eager MPI_Isend of the look-ahead
+ *           panels, SLU_COMM_IRECV the same look-ahead with the pre-posted
+ *           receives also tested during the Schur complement update,
+ *           SLU_COMM_SYNC no look-ahead and blocking MPI_Send of the
+ *           panels, SLU_COMM_RMA the panels pulled by the receivers
+ *           from RMA windows, SLU_COMM_THREADS as SLU_COMM_IRECV with a
+ *           communicator per look-ahead slot and the messages tested by
+ *           the update threads (MPI_THREAD_MULTIPLE).
+ *
+ *         o Sched_Priority (yes_no_t)
+ *           With Sched_Priority = YES, the static schedule of the
+ *           factorization takes the ready panels by critical-path
+ *           priority (see dstatic_schedule()).
+ *
+ *         o Panel_Compress (yes_no_t)
+ *           With Panel_Compress = YES, the indices of the panels sent in
+ *           the factorization are delta and varint encoded.
+ *
+ *         o SparseRHS (yes_no_t)
+ *           With SparseRHS = YES, the forward solve only visits the
+ *           supernodes reached in the etree from the nonzeros of B.
+ *           The solve is further restricted to some rows of X by
+ *           setting SOLVEstruct->out_rows (see pdgstrs()).
+ *
+ *         o Solve_CritPath (yes_no_t)
+ *           With Solve_CritPath = YES, the triangular solves measure their
+ *           critical path through the supernodal etree, returned in
+ *           stat->sol_critpath[] and stat->sol_crithops[].
+ *
+ *         o Solve_Priority (yes_no_t)
+ *           With Solve_Priority = YES, the triangular solves process the
+ *           ready supernodes and received messages with the longest
+ *           remaining path in the supernodal etree first.
+ *
+ *         o Solve_RootSize (int)
+ *           With Solve_RootSize > 0, the trailing supernodes of order up
+ *           to Solve_RootSize are gathered on all the processes at the
+ *           first solve after the factorization, and solved there
+ *           without messages.
+ *
+ *         o Solve_RHSTile (int)
+ *           With more than Solve_RHSTile right-hand sides, B and X are
+ *           copied to and from the message buffers by tiles of
+ *           Solve_RHSTile columns; 0 disables the tiles.
+ *
+ *         o Predict (yes_no_t)
+ *           With Predict = YES and ParSymbFact = NO, process 0 prints the
+ *           memory, flops and messages of each process predicted by
+ *           superlu_predict() after the symbolic factorization.
+ *
+ *         o OutOfCore (yes_no_t)
+ *           With OutOfCore = YES and ParSymbFact = NO, the values of L and
+ *           U are kept in files under $SUPERLU_OOC_DIR, written out during
+ *           the factorization and read back ahead of the solves.
+ *
+ *         o ReleaseMemory (yes_no_t)
+ *           With ReleaseMemory = YES, the map of the values of A into L
+ *           and U is not kept, and the schedule of the messages of the
+ *           factorization is freed after it; the factors can then only be
+ *           used for solves (Fact = FACTORED), or replaced by a new
+ *           factorization with Fact = DOFACT or SamePattern.
+ *
+ *         o RefactorMap (yes_no_t)
+ *           With RefactorMap = YES, the column indices of A are kept with
+ *           the factors, for pdgsrefactor() to refactor new values of A.
+ *
+ *         o SymValues (yes_no_t)
+ *           With SymValues = YES, A is taken as numerically symmetric.
+ *           If RowPerm = NOROWPERM and the scaling is symmetric (R = C),
+ *           the blocks of U off the diagonal are freed after the
+ *           factorization, as U = diag(U)*L^T, and the solves use L and
+ *           diag(U) only; Fact = SamePattern_SameRowPerm is then not
+ *           available for the next factorization.
+ *
+ *         o ILU_DropTol (double)
+ *           With ILU_DropTol > 0, the factorization is incomplete: the
+ *           blocks of L and U smaller than this threshold are dropped, see
+ *           superlu_defs.h. The factors are then a preconditioner; the
+ *           solution needs iterative refinement or a Krylov method.
+ *
+ *         o ConditionNumber (yes_no_t)
+ *           With ConditionNumber = YES and nrhs > 0, the reciprocal
+ *           condition number of A1 in the norm of the system (1-norm,
+ *           or infinity-norm with Trans != NOTRANS) is estimated by
+ *           PDGSCON with a few solves of several right-hand sides, and
+ *           returned in stat->RCond.
+ *
+ *         o DiagInv_MinSize, DiagInv_MaxSize (int)
+ *           With DiagInv = YES, only the diagonal blocks of the supernodes
+ *           of these sizes are inverted (DiagInv_MaxSize = 0 for no upper
+ *           bound). The inverses are computed by the first solve after
+ *           the factorization.
  *
  *         NOTE: all options must be identical on all processes when
  *               calling this routine.
@@ -471,6 +710,15 @@ at the top-level directory.
  *           The distributed data structures to store L and U factors.
  *           See superlu_ddefs.h for the definition of 'dLocalLU_t'.
  *
+ *         o matvec (dMatvec_t*) (input)
+ *           If not NULL, the iterative refinement computes the products
+ *           by A with matvec->apply() and the original matrix, instead of
+ *           the distributed A (see pdgsrfs_matvec()). A is then not
+ *           accessed after the factorization: with Fact = FACTORED and
+ *           ConditionNumber = NO, the arrays nzval[] and colind[] of A may
+ *           have been freed. The set-up of the product by the distributed
+ *           A is skipped.
+ *
  * SOLVEstruct (input/output) dSOLVEstruct_t*
  *         The data structure to hold the communication pattern used
  *         in the phases of triangular solution and iterative refinement.
@@ -497,6 +745,8 @@ at the top-level directory.
  *                so the solution could not be computed.
  *             > A->ncol: number of bytes allocated when memory allocation
  *                failure occurred, plus A->ncol.
+ *                With options->MemBudget > 0, the number of megabytes
+ *                the factorization is short of, plus A->ncol.
  *
  * See superlu_ddefs.h for the definitions of various data types.
  * </pre>
@@ -545,6 +795,12 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
     double   *X, *b_col, *b_work, *x_col;
     double   t;
     float    GA_mem_use = 0.0;    /* memory usage by global A */
+    int      need_GA = 0;         /* whether global A is gathered */
+    int      mem_tag;             /* allocations of the caller, see
+				     superlu_mem_tag() */
+    int      keep_rowperm = 0;    /* keep the previous perm_r, R and C */
+    int      order_rank = -1;     /* process computing perm_c[] during MC64 */
+    double   t_order = 0.0;
     float    dist_mem_use = 0.0;  /* memory usage during distribution */
     superlu_dist_mem_usage_t num_mem_usage, symb_mem_usage;
     int64_t  nnzLU;
@@ -568,6 +824,9 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
     int   col, key; /* parameters for creating a new communicator */
     Pslu_freeable_t Pslu_freeable;
     float  flinfo;
+    symbfact_key_t symb_key; /* sparsity pattern of GA, for PatternCache */
+    int   symb_cached = 0, symb_cacheable = 0;
+    int   symb_user = 0; /* symbolic factorization of LUstruct->usymb */
 
     /* Initialization. */
     m       = A->nrow;
@@ -590,22 +849,53 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
     Fact = options->Fact;
     if ( Fact < 0 || Fact > FACTORED )
 	*info = -1;
-    else if ( options->RowPerm < 0 || options->RowPerm > MY_PERMR )
+    else if ( options->RowPerm < 0 || options->RowPerm > LargeDiag_AUCTION )
+	*info = -1;
+    else if ( options->ColPerm < 0 || options->ColPerm > RCM_AT_PLUS_A )
 	*info = -1;
-    else if ( options->ColPerm < 0 || options->ColPerm > MY_PERMC )
+#ifndef HAVE_PTSCOTCH
+    else if ( options->ColPerm == ZOLTAN ) {
 	*info = -1;
-    else if ( options->IterRefine < 0 || options->IterRefine > SLU_EXTRA )
+	printf("ERROR: ColPerm = ZOLTAN needs SuperLU_DIST built with PT-Scotch.\n");
+    }
+#endif
+    else if ( options->IterRefine < 0 || options->IterRefine > SLU_GMRES )
 	*info = -1;
     else if ( options->IterRefine == SLU_EXTRA ) {
 	*info = -1;
 	printf("ERROR: Extra precise iterative refinement yet to support.\n");
+    } else if ( options->BLR_Tol < 0.0 )
+	*info = -1;
+    else if ( options->SchurSize < 0 || options->SchurSize >= A->ncol
+		|| (options->SchurSize && (options->RowPerm != NOROWPERM
+					   || options->ParSymbFact == YES
+					   || options->SingleFactor == YES)) )
+	*info = -1;
+    else if ( Fact == SamePattern_SameRowPerm && LUstruct->Llu->release
+	      && !LUstruct->Llu->ToRecv ) {
+	*info = -1;
+	printf("ERROR: SamePattern_SameRowPerm after the factorization "
+	       "schedule is released, see options->ReleaseMemory.\n");
+    } else if ( options->UserSymbFact == YES
+		&& (Fact == DOFACT || Fact == SamePattern)
+		&& (options->ColPerm != MY_PERMC || options->ParSymbFact == YES
+		    || !LUstruct->usymb) ) {
+	*info = -1;
+	printf("ERROR: UserSymbFact needs ColPerm = MY_PERMC, "
+	       "ParSymbFact = NO and LUstruct->usymb.\n");
+    } else if ( Fact == SamePattern_SameRowPerm && LUstruct->Llu->Udropped ) {
+	*info = -1;
+	printf("ERROR: SamePattern_SameRowPerm after U is dropped, "
+	       "see options->SymValues.\n");
     } else if ( A->nrow != A->ncol || A->nrow < 0 || A->Stype != SLU_NR_loc
 		|| A->Dtype != SLU_D || A->Mtype != SLU_GE )
 	*info = -2;
     else if ( ldb < m_loc )
 	*info = -5;
-    else if ( nrhs < 0 )
+    else if ( nrhs < 0 || (nrhs && options->SchurSize) )
 	*info = -6;
+    /* Blocking parameters tuned for this matrix, see superlu_tune.c. */
+    if ( !*info && Fact == DOFACT ) superlu_tune_load(A, grid);
     if ( sp_ienv_dist(2) > sp_ienv_dist(3) ) {
         *info = 1;
 	printf("ERROR: Relaxation (NREL) cannot be larger than max. supernode size (NSUP).\n"
@@ -617,6 +907,15 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	return;
     }
 
+    /* Small systems are solved by dense LU, see pdgsdense.c. */
+    if ( Fact == FACTORED ? LUstruct->dense != NULL
+	 : A->ncol <= options->Dense_MaxN ) {
+	pdgssvx_dense(options, A, ScalePermstruct, B, ldb, nrhs, grid,
+		      LUstruct, berr, stat, info);
+	return;
+    }
+    if ( LUstruct->dense ) dDestroy_DenseLU(LUstruct);
+
     factored = (Fact == FACTORED);
     Equil = (!factored && options->Equil == YES);
     notran = (options->Trans == NOTRANS);
@@ -624,7 +923,24 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 
     iam = grid->iam;
     job = 5;
-    if ( factored || (Fact == SamePattern_SameRowPerm && Equil) ) {
+    /* With options->RowPerm_Tol > 0, the large-diagonal row permutation
+       and the scaling of the previous factorization are kept if they
+       still fit A. */
+    if ( Fact == SamePattern && Equil && options->RowPerm_Tol > 0.0
+	 && (options->RowPerm == LargeDiag_MC64
+	     || options->RowPerm == LargeDiag_AUCTION)
+	 && ScalePermstruct->DiagScale == BOTH ) {
+	keep_rowperm = pdldperm_check(A, ScalePermstruct,
+				      options->RowPerm_Tol, grid);
+#if ( PRNTlevel>=1 )
+	if ( !grid->iam ) {
+	    printf(".. keep the previous row permutation? %d\n", keep_rowperm);
+	    fflush(stdout);
+	}
+#endif
+    }
+    if ( factored || ((Fact == SamePattern_SameRowPerm || keep_rowperm)
+		      && Equil) ) {
 	rowequ = (ScalePermstruct->DiagScale == ROW) ||
 	         (ScalePermstruct->DiagScale == BOTH);
 	colequ = (ScalePermstruct->DiagScale == COL) ||
@@ -632,6 +948,13 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
     } else rowequ = colequ = FALSE;
 
     /* The following arrays are replicated on all processes. */
+    if ( !factored ) {
+        /* They are recomputed below, so a node-shared copy kept by
+	   a previous call (options->ShareReplicated) is made private. */
+	superlu_shm_unshare((void **) &ScalePermstruct->perm_r, m * sizeof(int_t));
+	superlu_shm_unshare((void **) &ScalePermstruct->perm_c, n * sizeof(int_t));
+	superlu_shm_unshare((void **) &LUstruct->etree, n * sizeof(int_t));
+    }
     perm_r = ScalePermstruct->perm_r;
     perm_c = ScalePermstruct->perm_c;
     etree = LUstruct->etree;
@@ -679,7 +1002,7 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 #endif
 	t = SuperLU_timer_();
 
-	if ( Fact == SamePattern_SameRowPerm ) {
+	if ( Fact == SamePattern_SameRowPerm || keep_rowperm ) {
 	    /* Reuse R and C. */
 	    switch ( ScalePermstruct->DiagScale ) {
 	      case NOEQUIL:
@@ -713,7 +1036,11 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    }
 	} else { /* Compute R & C from scratch */
             /* Compute the row and column scalings. */
-	    pdgsequ(A, R, C, &rowcnd, &colcnd, &amax, &iinfo, grid);
+	    if ( options->Equil_Iter > 0 )
+		pdgsequ_ruiz(A, options->Equil_Iter, R, C, &rowcnd, &colcnd,
+			     &amax, &iinfo, grid);
+	    else
+		pdgsequ(A, R, C, &rowcnd, &colcnd, &amax, &iinfo, grid);
 
 	    if ( iinfo > 0 ) {
 		if ( iinfo <= m ) {
@@ -765,12 +1092,20 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	 * compressed row format to global A in compressed column format.
          * Numerical values are gathered only when a row permutation
          * for large diagonal is sought after.
+         * With parallel symbolic factorization, global A is needed only
+         * by MC64; with any other RowPerm, the matrix stays distributed
+         * throughout.
          */
-	if ( Fact != SamePattern_SameRowPerm &&
-             (parSymbFact == NO || options->RowPerm != NO) ) {
+	/* The symbolic factorization supplied by the user needs no GA. */
+	symb_user = ( options->UserSymbFact == YES
+		      && Fact != SamePattern_SameRowPerm );
+	need_GA = ( Fact != SamePattern_SameRowPerm &&
+		    ((parSymbFact == NO && !symb_user) ||
+		     (options->RowPerm == LargeDiag_MC64 && !keep_rowperm)) );
+	if ( need_GA ) {
              /* Performs serial symbolic factorzation and/or MC64 */
 
-            need_value = (options->RowPerm == LargeDiag_MC64);
+            need_value = (options->RowPerm == LargeDiag_MC64 && !keep_rowperm);
 
             pdCompRow_loc_to_CompCol_global(need_value, A, grid, &GA);
 
@@ -786,6 +1121,24 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
             } else assert(GAstore->nzval == NULL);
 	}
 
+	/* With Overlap_Preproc = YES, the ordering of A'*A or COLAMD, which
+	   does not depend on the row permutation, is computed by the last
+	   process from the unpermuted GA while process 0 runs MC64, and
+	   broadcast in place of the get_perm_c_block() of process 0 below. */
+	if ( options->Overlap_Preproc == YES && need_GA && Fact == DOFACT
+	     && parSymbFact == NO && options->PatternCache != YES
+	     && options->RowPerm == LargeDiag_MC64 && !keep_rowperm
+	     && (options->ColPerm == MMD_ATA || options->ColPerm == COLAMD)
+	     && grid->nprow * grid->npcol > 1 ) {
+	    order_rank = grid->nprow * grid->npcol - 1;
+	    if ( iam == order_rank ) {
+		t_order = SuperLU_timer_();
+		get_perm_c_block(iam, options->ColPerm, options->DofBlock, &GA,
+				 perm_c);
+		t_order = SuperLU_timer_() - t_order;
+	    }
+	}
+
         /* ------------------------------------------------------------
            Find the row permutation Pr for A, and apply Pr*[GA].
 	   GA is overwritten by Pr*[GA].
@@ -793,11 +1146,14 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
         if ( options->RowPerm != NO ) {
 	    t = SuperLU_timer_();
 	    if ( Fact != SamePattern_SameRowPerm ) {
-	        if ( options->RowPerm == MY_PERMR ) { /* Use user's perm_r. */
+	        if ( options->RowPerm == MY_PERMR || keep_rowperm ) {
+		    /* Use user's perm_r, or the previous one. */
 	            /* Permute the global matrix GA for symbfact() */
-	            for (i = 0; i < colptr[n]; ++i) {
-	            	irow = rowind[i];
-		    	rowind[i] = perm_r[irow];
+	            if ( need_GA ) {
+	                for (i = 0; i < colptr[n]; ++i) {
+	            	    irow = rowind[i];
+		    	    rowind[i] = perm_r[irow];
+	                }
 	            }
 	        } else if ( options->RowPerm == LargeDiag_MC64 ) {
 	            /* Get a new perm_r[] from MC64 */
@@ -912,6 +1268,53 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 		        if ( !iam ) printf("\t product of diagonal %e\n", dprod);
 	            }
 #endif
+                } else if ( options->RowPerm == LargeDiag_AUCTION ) {
+		    /* Get a new perm_r[] (and scaling) on the distributed A */
+		    if ( Equil ) {
+		        if ( !(R1 = doubleMalloc_dist(m)) )
+		            ABORT("SUPERLU_MALLOC fails for R1[]");
+		    	if ( !(C1 = doubleMalloc_dist(n)) )
+		            ABORT("SUPERLU_MALLOC fails for C1[]");
+		    }
+		    iinfo = pdldperm_auction(A, grid, perm_r,
+		                             Equil ? R1 : NULL, Equil ? C1 : NULL);
+		    if ( iinfo == 0 && Equil ) {
+		        /* A <-- diag(R1)*A*diag(C1) */
+		        irow = fst_row;
+		        for (j = 0; j < m_loc; ++j) {
+			    for (i = rowptr[j]; i < rowptr[j+1]; ++i)
+			        a[i] *= R1[irow] * C1[colind[i]];
+			    ++irow;
+		        }
+		        if ( rowequ ) for (i = 0; i < m; ++i) R[i] *= R1[i];
+		        else for (i = 0; i < m; ++i) R[i] = R1[i];
+		        if ( colequ ) for (i = 0; i < n; ++i) C[i] *= C1[i];
+		        else for (i = 0; i < n; ++i) C[i] = C1[i];
+
+		        ScalePermstruct->DiagScale = BOTH;
+		        rowequ = colequ = 1;
+		    } else if ( iinfo ) {
+#if ( PRNTlevel>=1 )
+		        if ( !iam ) {
+			    printf(".. auction matching fails (structurally"
+				   " singular?), no row permutation\n");
+			    fflush(stdout);
+			}
+#endif
+		        for (i = 0; i < m; ++i) perm_r[i] = i;
+		    }
+		    if ( Equil ) {
+		        SUPERLU_FREE(R1);
+		        SUPERLU_FREE(C1);
+		    }
+
+		    /* Permute the global matrix GA for symbfact() */
+		    if ( need_GA ) {
+		        for (i = 0; i < colptr[n]; ++i) {
+			    irow = rowind[i];
+			    rowind[i] = perm_r[irow];
+		        }
+		    }
                 } else { /* use largeDiag_AWPM */
 #ifdef HAVE_COMBBLAS
 		    d_c2cpp_GetHWPM(A, grid, ScalePermstruct);
@@ -919,7 +1322,15 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 		    if ( iam == 0 ) {
 		        printf("CombBLAS is not available\n"); fflush(stdout);
 		    }
+		    for (i = 0; i < m; ++i) perm_r[i] = i;
 #endif
+		    /* Permute the global matrix GA for symbfact() */
+		    if ( need_GA ) {
+		        for (i = 0; i < colptr[n]; ++i) {
+			    irow = rowind[i];
+			    rowind[i] = perm_r[irow];
+		        }
+		    }
                 } /* end if options->RowPerm ... */
 
 	        t = SuperLU_timer_() - t;
@@ -941,7 +1352,9 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 #endif
     } /* end if (!factored) */
 
-    if ( !factored || options->IterRefine ) {
+    anorm = 0.0;
+    if ( !factored || (options->IterRefine && !LUstruct->matvec)
+	 || options->ConditionNumber == YES ) {
 	/* Compute norm(A), which will be used to adjust small diagonal. */
 	if ( notran ) *(unsigned char *)norm = '1';
 	else *(unsigned char *)norm = 'I';
@@ -956,6 +1369,8 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
        redistribution, and numerical factorization.
        ------------------------------------------------------------*/
     if ( !factored ) {
+	mem_tag = superlu_mem_tag(SUPERLU_MEM_SYMB);
+	SUPERLU_PROF_BEGIN(PROF_ANALYSIS, EMPTY);
 	t = SuperLU_timer_();
 	/*
 	 * Get column permutation vector perm_c[], according to permc_spec:
@@ -964,11 +1379,13 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	 *   permc_spec = MMD_ATA:  minimum degree on structure of A'*A
 	 *   permc_spec = METIS_AT_PLUS_A: METIS on structure of A'+A
 	 *   permc_spec = PARMETIS: parallel METIS on structure of A'+A
+	 *   permc_spec = ZOLTAN: PT-Scotch nested dissection on A'+A
 	 *   permc_spec = MY_PERMC: the ordering already supplied in perm_c[]
 	 */
 	permc_spec = options->ColPerm;
 
-	if ( parSymbFact == YES || permc_spec == PARMETIS ) {
+	if ( parSymbFact == YES || permc_spec == PARMETIS
+	     || permc_spec == ZOLTAN ) {
 	    nprocs_num = grid->nprow * grid->npcol;
   	    noDomains = (int) ( pow(2, ((int) LOG2( nprocs_num ))));
 
@@ -993,7 +1410,7 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 		}
 		sizes[2*noDomains - 2] = m;
 		fstVtxSep[2*noDomains - 2] = 0;
-	    } else if ( permc_spec != PARMETIS ) {   /* same as before */
+	    } else if ( permc_spec != PARMETIS && permc_spec != ZOLTAN ) {
 		printf("{" IFMT "," IFMT "}: pdgssvx: invalid ColPerm option when ParSymbfact is used\n",
 		       MYROW(grid->iam, grid), MYCOL(grid->iam, grid));
 	    }
@@ -1001,7 +1418,7 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 
 	if ( permc_spec != MY_PERMC && Fact == DOFACT ) {
           /* Reuse perm_c if Fact == SamePattern, or SamePattern_SameRowPerm */
-	  if ( permc_spec == PARMETIS ) {
+	  if ( permc_spec == PARMETIS || permc_spec == ZOLTAN ) {
 	// #pragma omp parallel
     // {
 	// #pragma omp master
@@ -1011,6 +1428,11 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	       * and does not modify it.  It also allocates memory for       *
 	       * sizes[] and fstVtxSep[] arrays, that contain information    *
 	       * on the separator tree computed by ParMETIS.                 */
+	      if ( permc_spec == ZOLTAN )
+		  flinfo = get_perm_c_ptscotch(A, perm_r, perm_c, nprocs_num,
+					       noDomains, &sizes, &fstVtxSep,
+					       grid, &symb_comm);
+	      else
 	      flinfo = get_perm_c_parmetis(A, perm_r, perm_c, nprocs_num,
                                   	   noDomains, &sizes, &fstVtxSep,
                                            grid, &symb_comm);
@@ -1021,27 +1443,97 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	          fprintf(stderr, "Insufficient memory for get_perm_c parmetis\n");
 #endif
 		  *info = flinfo;
+		  superlu_mem_tag(mem_tag);
+		  SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
 		  return;
      	      }
-	  } else {
-	      get_perm_c_dist(iam, permc_spec, &GA, perm_c);
+	  } else if ( order_rank >= 0 ) { /* computed during MC64 */
+	      MPI_Bcast(perm_c, n, mpi_int_t, order_rank, grid->comm);
+	  } else if ( need_GA ) { /* else perm_c[] is set above */
+	      /* With PatternCache = YES, perm_c[], etree[] and the serial
+		 symbolic factorization of a known pattern are reused. */
+	      symb_cacheable = options->PatternCache == YES && parSymbFact == NO
+			       && permc_spec != MY_PERMC;
+	      if ( symb_cacheable ) {
+		  symbfact_cache_key(options, &GA, &symb_key);
+		  symb_cached = symbfact_cache_get(&symb_key, perm_c, etree,
+						   Glu_persist, &Glu_freeable,
+						   &iinfo, grid);
+	      }
+	      /* The ordering is the same on every process: it is computed
+		 once, by process 0, and broadcast. */
+	      if ( !symb_cached ) {
+		  if ( permc_spec == NATURAL || permc_spec == MY_PERMC ) {
+		      get_perm_c_block(iam, permc_spec, options->DofBlock, &GA,
+				       perm_c);
+		  } else {
+		      if ( !iam )
+			  get_perm_c_block(iam, permc_spec, options->DofBlock,
+					   &GA, perm_c);
+		      MPI_Bcast(perm_c, n, mpi_int_t, 0, grid->comm);
+		  }
+	      }
           }
         }
 
-	stat->utime[COLPERM] = SuperLU_timer_() - t;
+	stat->utime[COLPERM] = SuperLU_timer_() - t + t_order;
 
 	/* Symbolic factorization. */
 	if ( Fact != SamePattern_SameRowPerm ) {
-	    if ( parSymbFact == NO ) { /* Perform serial symbolic factorization */
+	    if ( symb_cached ) { /* Taken from the cache with perm_c[] */
+		nnzLU = Glu_freeable->nnzLU;
+		stat->utime[SYMBFAC] = 0.0;
+		QuerySpace_dist(n, -iinfo, Glu_freeable, &symb_mem_usage);
+	    } else if ( symb_user ) { /* Supplied with perm_c[] */
+		t = SuperLU_timer_();
+		if ( !(Glu_freeable = (Glu_freeable_t *)
+		      SUPERLU_MALLOC(sizeof(Glu_freeable_t))) )
+		    ABORT("Malloc fails for Glu_freeable.");
+		if ( symbfact_user(LUstruct->usymb, n, A, perm_r, perm_c, etree,
+				   Glu_persist, Glu_freeable, grid) ) {
+		    if ( !iam )
+			printf("ERROR: the structure of LUstruct->usymb is not "
+			       "valid, see symbfact_user().\n");
+		    SUPERLU_FREE(Glu_freeable);
+		    if ( need_GA ) Destroy_CompCol_Matrix_dist(&GA);
+		    *info = -8;
+		    superlu_mem_tag(mem_tag);
+		    SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
+		    return;
+		}
+		nnzLU = Glu_freeable->nnzLU;
+		stat->utime[SYMBFAC] = SuperLU_timer_() - t;
+		QuerySpace_dist(n, Glu_freeable->xlsub[n], Glu_freeable,
+				&symb_mem_usage);
+	    } else if ( parSymbFact == NO ) { /* Perform serial symbolic factorization */
 		/* GA = Pr*A, perm_r[] is already applied. */
 	        int_t *GACcolbeg, *GACcolend, *GACrowind;
 
 	        /* Compute the elimination tree of Pc*(A^T+A)*Pc^T or Pc*A^T*A*Pc^T
-	           (a.k.a. column etree), depending on the choice of ColPerm.
+	           (a.k.a. column etree), depending on the choice of ColPerm,
+	           on the distributed A.
 	           Adjust perm_c[] to be consistent with a postorder of etree.
 	           Permute columns of A to form A*Pc'.
 		   After this routine, GAC = GA*Pc^T.  */
-	        sp_colorder(options, &GA, perm_c, etree, &GAC);
+	        sp_colorder_loc(options, &GA, perm_c, etree, &GAC,
+				A, perm_r, grid);
+
+		{
+		    /* Size the L & U subscripts of symbfact() from the column
+		       counts of the Cholesky factor of Pc*(Pr*A+(Pr*A)^T)*Pc^T,
+		       or of Pc*A^T*A*Pc^T, whose etree was computed. */
+		    int_t *colcnt;
+		    if ( !(colcnt = intMalloc_dist(n)) )
+			ABORT("Malloc fails for colcnt[].");
+		    if ( options->ColPerm == MMD_ATA )
+			sp_colcounts_ata_dist_loc(A, perm_c, etree, colcnt,
+						  grid);
+		    else
+			sp_colcounts_dist_loc(A, perm_r, perm_c, etree, colcnt,
+					      grid);
+		    symbfact_estimate(options, &GAC, etree, colcnt);
+		    SUPERLU_FREE(colcnt);
+		}
 
 	        /* Form Pc*A*Pc^T to preserve the diagonal of the matrix GAC. */
 	        GACstore = (NCPformat *) GAC.Store;
@@ -1069,13 +1561,29 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 		      SUPERLU_MALLOC(sizeof(Glu_freeable_t))) )
 		    ABORT("Malloc fails for Glu_freeable.");
 
-	    	/* Every process does this. */
-	    	iinfo = symbfact(options, iam, &GAC, perm_c, etree,
-			     	 Glu_persist, Glu_freeable);
+	    	/* One process of each node does this. */
+	    	iinfo = symbfact_node(options, iam, &GAC, perm_c, etree,
+				      Glu_persist, Glu_freeable, grid);
 			nnzLU = Glu_freeable->nnzLU;
 	    	stat->utime[SYMBFAC] = SuperLU_timer_() - t;
 	    	if ( iinfo <= 0 ) { /* Successful return */
 		    QuerySpace_dist(n, -iinfo, Glu_freeable, &symb_mem_usage);
+		    /* A narrow band is factored by block columns of its
+		       width, see symbfact_band(). */
+		    if ( options->ColPerm == RCM_AT_PLUS_A
+			 && symbfact_band(options, n, Glu_persist, Glu_freeable) ) {
+			nnzLU = Glu_freeable->nnzLU;
+		    } else if ( options->Amalg_Tol > 0.0 ) {
+			symbfact_amalgamate(options, n, Glu_persist, Glu_freeable);
+			nnzLU = Glu_freeable->nnzLU;
+		    }
+		    if ( options->SplitSuper > 0 ) {
+			symbfact_split(options, n, Glu_persist, Glu_freeable);
+			nnzLU = Glu_freeable->nnzLU;
+		    }
+		    if ( symb_cacheable )
+			symbfact_cache_put(&symb_key, perm_c, etree,
+					   Glu_persist, Glu_freeable, iinfo);
 #if ( PRNTlevel>=1 )
 		    if ( !iam ) {
 		    	printf("\tNo of supers " IFMT "\n", Glu_persist->supno[n-1]+1);
@@ -1097,6 +1605,8 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 		        fprintf(stderr,"symbfact() error returns " IFMT "\n",iinfo);
 #endif
 		    *info = iinfo;
+		    superlu_mem_tag(mem_tag);
+		    SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
 		    return;
 	        }
 	    } /* end serial symbolic factorization */
@@ -1113,14 +1623,36 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	      	    fprintf(stderr, "Insufficient memory for parallel symbolic factorization.");
 #endif
 		    *info = flinfo;
+		    superlu_mem_tag(mem_tag);
+		    SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
 		    return;
                 }
 	    }
 
+	    /* Predict the memory of the factorization on this grid from
+	       the serial symbolic factorization. */
+	    if ( options->Predict == YES && parSymbFact == NO && !iam ) {
+		superlu_predict_t *pred;
+		int nthreads = 1;
+#ifdef _OPENMP
+		nthreads = omp_get_max_threads();
+#endif
+		if ( !(pred = SUPERLU_MALLOC(grid->nprow * grid->npcol
+					     * sizeof(superlu_predict_t))) )
+		    ABORT("Malloc fails for pred[].");
+		superlu_predict(options, n, Glu_persist, Glu_freeable,
+				grid->nprow, grid->npcol, nthreads,
+				sizeof(double), pred);
+		superlu_predict_print(grid->nprow, grid->npcol, pred);
+		superlu_simulate_print(options, n, Glu_persist, Glu_freeable,
+				       grid->nprow, grid->npcol, nthreads,
+				       nrhs, sizeof(double));
+		SUPERLU_FREE(pred);
+	    }
+
             /* Destroy global GA */
-            if ( parSymbFact == NO || options->RowPerm != NO )
-                Destroy_CompCol_Matrix_dist(&GA);
-            if ( parSymbFact == NO )
+            if ( need_GA ) Destroy_CompCol_Matrix_dist(&GA);
+            if ( parSymbFact == NO && !symb_cached && !symb_user )
  	        Destroy_CompCol_Permuted_dist(&GAC);
 
 	} /* end if Fact != SamePattern_SameRowPerm ... */
@@ -1129,17 +1661,36 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
         if (fstVtxSep) SUPERLU_FREE (fstVtxSep);
 	if (symb_comm != MPI_COMM_NULL) MPI_Comm_free (&symb_comm);
 
-	/* Distribute entries of A into L & U data structures. */
-	//if (parSymbFact == NO || ???? Fact == SamePattern_SameRowPerm) {
-	if ( parSymbFact == NO ) {
+	SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
+	superlu_mem_tag(SUPERLU_MEM_FACTORS);
+	SUPERLU_PROF_BEGIN(PROF_DIST, EMPTY);
+	LUstruct->Llu->release = ( (options->ReleaseMemory == YES
+				    || options->Solve_Compact == YES)
+				   && options->SingleFactor != YES );
+
+	/* Distribute entries of A into L & U data structures.
+	   With SamePattern_SameRowPerm, only the values of A are moved
+	   into the existing L & U, whichever symbolic factorization
+	   produced them. */
+	if ( parSymbFact == NO || Fact == SamePattern_SameRowPerm ) {
 	    /* CASE OF SERIAL SYMBOLIC */
   	    /* Apply column permutation to the original distributed A */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
 	    for (j = 0; j < nnz_loc; ++j) colind[j] = perm_c[colind[j]];
 
 	    /* Distribute Pc*Pr*diag(R)*A*diag(C)*Pc^T into L and U storage.
 	       NOTE: the row permutation Pc*Pr is applied internally in the
   	       distribution routine. */
 	    t = SuperLU_timer_();
+	    LUstruct->Llu->ooc = ( options->OutOfCore == YES );
+#ifdef SLU_HAVE_SINGLE
+	    if ( options->SingleFactor == YES )
+	        dist_mem_use = pdsdistribute(Fact, n, A, ScalePermstruct,
+                                             Glu_freeable, LUstruct, grid);
+	    else
+#endif
 	    dist_mem_use = pddistribute(Fact, n, A, ScalePermstruct,
                                       Glu_freeable, LUstruct, grid);
 	    stat->utime[DIST] = SuperLU_timer_() - t;
@@ -1154,9 +1705,18 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	       NOTE: the row permutation Pc*Pr is applied internally in the
 	       distribution routine. */
 	    /* Apply column permutation to the original distributed A */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
 	    for (j = 0; j < nnz_loc; ++j) colind[j] = perm_c[colind[j]];
 
     	    t = SuperLU_timer_();
+#ifdef SLU_HAVE_SINGLE
+	    if ( options->SingleFactor == YES )
+	        dist_mem_use = dsdist_psymbtonum(Fact, n, A, ScalePermstruct,
+		  			         &Pslu_freeable, LUstruct, grid);
+	    else
+#endif
 	    dist_mem_use = ddist_psymbtonum(Fact, n, A, ScalePermstruct,
 		  			   &Pslu_freeable, LUstruct, grid);
 	    if (dist_mem_use > 0)
@@ -1165,16 +1725,59 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    stat->utime[DIST] = SuperLU_timer_() - t;
 	}
 
+	SUPERLU_PROF_END(PROF_DIST, EMPTY);
 	/*if (!iam) printf ("\tDISTRIBUTE time  %8.2f\n", stat->utime[DIST]);*/
 
+	/* Keep the column indices of A for pdgsrefactor(). */
+	if ( Fact != SamePattern_SameRowPerm && LUstruct->Llu->Acolind ) {
+	    SUPERLU_FREE(LUstruct->Llu->Acolind);
+	    LUstruct->Llu->Acolind = NULL;
+	}
+	if ( options->RefactorMap == YES && !LUstruct->Llu->Acolind ) {
+	    if ( !(LUstruct->Llu->Acolind = intMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+		ABORT("Malloc fails for Acolind[].");
+	    memcpy(LUstruct->Llu->Acolind, colind, nnz_loc * sizeof(int_t));
+	}
+
 	/* Perform numerical factorization in parallel. */
 	t = SuperLU_timer_();
     // #pragma omp parallel
     // {
 	// #pragma omp master
 	// {
+#ifdef SLU_HAVE_SINGLE
+	if ( options->SingleFactor == YES )
+	    pdsgstrf(options, m, n, anorm, LUstruct, grid, stat, info);
+	else
+#endif
 	pdgstrf(options, m, n, anorm, LUstruct, grid, stat, info);
 	stat->utime[FACT] = SuperLU_timer_() - t;
+	superlu_mem_tag(mem_tag);
+	if ( LUstruct->Llu->release ) dRelease_LU(n, grid, LUstruct);
+	/* With a symmetric A1, U = diag(U)*L^T is not kept. */
+	if ( options->SymValues == YES )
+	    dDrop_U(options, n, ScalePermstruct, LUstruct, grid);
+	/* The factors are put in the layout of the solves by the first
+	   one, see dCompact_LU(). */
+	LUstruct->Llu->compact = ( options->Solve_Compact == YES
+				   && LUstruct->Llu->release
+				   && !LUstruct->Llu->Udropped );
+
+	if ( options->DiagInv == YES ) {
+	    /* The inverses are computed by the first solve, see pdgstrs(). */
+#ifdef SLU_HAVE_SINGLE
+	    if ( LUstruct->sLUstruct )
+	        pdsDefer_Diag_Inv(options, LUstruct);
+	    else
+#endif
+	    pdDefer_Diag_Inv(options, LUstruct);
+	}
+
+	/* The refinement set up by a previous call keeps A in the form of
+	   pdgsmv_init(); a new A of the same pattern is put in it. */
+	if ( Fact == SamePattern_SameRowPerm && options->RefineInitialized == YES )
+	    pdgsmv_reuse(A, SOLVEstruct->row_to_proc, SOLVEstruct->A_colind_gsmv,
+			 grid);
 	// }
 	// }
 
@@ -1276,6 +1879,11 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    int_t TinyPivots;
 	    float for_lu, total, max, avg, temp;
 
+#ifdef SLU_HAVE_SINGLE
+	    if ( LUstruct->sLUstruct )
+	        dsQuerySpace_dist(n, LUstruct, grid, stat, &num_mem_usage);
+	    else
+#endif
 	    dQuerySpace_dist(n, LUstruct, grid, stat, &num_mem_usage);
 
 	    if (parSymbFact == TRUE) {
@@ -1284,7 +1892,7 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
   		   structure and the memory allocated for numerical
 		   factorization */
 	        temp = SUPERLU_MAX(symb_mem_usage.total, -dist_mem_use);
-                if ( options->RowPerm != NO )
+                if ( need_GA )
                     temp = SUPERLU_MAX(temp, GA_mem_use);
             } else {
 	        temp = SUPERLU_MAX (
@@ -1324,6 +1932,23 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
             }
 	} /* end printing stats */
 
+	if ( options->ShareReplicated == YES ) {
+	    /* Keep one copy per node of the replicated arrays. */
+	    nsupers = Glu_persist->supno[n-1] + 1;
+	    superlu_shm_share((void **) &ScalePermstruct->perm_r,
+			      m * sizeof(int_t), grid);
+	    superlu_shm_share((void **) &ScalePermstruct->perm_c,
+			      n * sizeof(int_t), grid);
+	    superlu_shm_share((void **) &LUstruct->etree, n * sizeof(int_t), grid);
+	    superlu_shm_share((void **) &Glu_persist->xsup,
+			      (nsupers + 1) * sizeof(int_t), grid);
+	    superlu_shm_share((void **) &Glu_persist->supno,
+			      n * sizeof(int_t), grid);
+	    perm_r = ScalePermstruct->perm_r;
+	    perm_c = ScalePermstruct->perm_c;
+	    etree = LUstruct->etree;
+	}
+
     } /* end if (!factored) */
 
 
@@ -1335,6 +1960,10 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    options->SolveInitialized = NO;   /* Reset the solve state */
 	}
      }
+    if ( !factored && options->SolveInitialized == YES ) {
+	/* The counts kept by pdgstrs() are those of the previous L and U. */
+	dSolveWorkFree(SOLVEstruct);
+    }
 #if 0
     /* Need to revisit: Why the following is not good enough for X-to-B
        distribution -- inv_perm_c changed */
@@ -1396,27 +2025,67 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	   Solve the linear system.
 	   ------------------------------------------------------------*/
 	if ( options->SolveInitialized == NO ) { /* First time */
+	    mem_tag = superlu_mem_tag(SUPERLU_MEM_REDIST);
 	    dSolveInit(options, A, perm_r, perm_c, nrhs, LUstruct, grid,
 		       SOLVEstruct);
+	    superlu_mem_tag(mem_tag);
             /* Inside this routine, SolveInitialized is set to YES.
 	       For repeated call to pdgssvx(), no need to re-initialilze
 	       the Solve data & communication structures, unless a new
 	       factorization with Fact == DOFACT or SamePattern is asked for. */
 	}
 
-	if ( options->DiagInv==YES &&
-             (options->SolveInitialized == NO || Fact == SamePattern ||
-              Fact == SamePattern_SameRowPerm) ) {
-	    pdCompute_Diag_Inv(n, LUstruct, grid, stat, info);
+	LUstruct->Llu->fixed_order = ( options->Reproducible == YES );
+	SOLVEstruct->sparse_rhs = options->SparseRHS;
+	SOLVEstruct->root_size = options->Solve_RootSize;
+	SOLVEstruct->crit_path = options->Solve_CritPath;
+	SOLVEstruct->priority = options->Solve_Priority;
+	SOLVEstruct->rhs_tile = options->Solve_RHSTile;
+	SOLVEstruct->refine_msg_prec = options->Refine_MsgPrec;
+	SOLVEstruct->msg_prec = SLU_MSG_FULL;
+
+	if ( options->ConditionNumber == YES ) {
+	    /* Estimate the reciprocal of the condition number of A1. */
+	    double rcond;
+	    int cinfo;
+	    pdgscon(norm, n, anorm, LUstruct, ScalePermstruct, grid, m_loc,
+		    fst_row, SOLVEstruct, &rcond, stat, &cinfo);
+	    stat->RCond = rcond;
 	}
 
 
+	if ( !notran ) {
+	    /* The right-hand side of A_s'*Y = Pc*C*B is ordered as the
+	       columns of A_s; it is also used by the refinement. */
+	    pdPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc,
+				   perm_c, X, ldx, X, ldx, nrhs, grid);
+	    x_col = X;  b_col = B;
+	    for (j = 0; j < nrhs; ++j) {
+		memcpy(b_col, x_col, m_loc * sizeof(double));
+		x_col += ldx;  b_col += ldb;
+	    }
+	}
+
     // #pragma omp parallel
     // {
 	// #pragma omp master
 	// {
-	pdgstrs(n, LUstruct, ScalePermstruct, grid, X, m_loc,
-		fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+#ifdef SLU_HAVE_SINGLE
+	if ( LUstruct->sLUstruct ) { /* Single precision factors */
+	    if ( notran )
+		pdsgstrs(n, LUstruct, ScalePermstruct, grid, X, m_loc,
+			 fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+	    else
+		pdsgstrs_trans(n, LUstruct, ScalePermstruct, grid, X, m_loc,
+			       fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+	} else
+#endif
+	if ( notran )
+	    pdgstrs(n, LUstruct, ScalePermstruct, grid, X, m_loc,
+		    fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+	else
+	    pdgstrs_trans(n, LUstruct, ScalePermstruct, grid, X, m_loc,
+			  fst_row, ldb, nrhs, SOLVEstruct, stat, info);
 	// }
 	// }
 
@@ -1432,12 +2101,16 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    dSOLVEstruct_t *SOLVEstruct1;  /* Used by refinement. */
 
 	    t = SuperLU_timer_();
-	    if ( options->RefineInitialized == NO || Fact == DOFACT ) {
+	    /* The product supplied in LUstruct->matvec does not use A. */
+	    if ( !LUstruct->matvec &&
+		 (options->RefineInitialized == NO || Fact == DOFACT) ) {
 	        /* All these cases need to re-initialize gsmv structure */
 	        if ( options->RefineInitialized )
 		    pdgsmv_finalize(SOLVEstruct->gsmv_comm);
+	        mem_tag = superlu_mem_tag(SUPERLU_MEM_REDIST);
 	        pdgsmv_init(A, SOLVEstruct->row_to_proc, grid,
 			    SOLVEstruct->gsmv_comm);
+	        superlu_mem_tag(mem_tag);
 
                 /* Save a copy of the transformed local col indices
 		   in colind_gsmv[]. */
@@ -1447,27 +2120,6 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	        colind_gsmv = SOLVEstruct->A_colind_gsmv = it;
 	        for (i = 0; i < nnz_loc; ++i) colind_gsmv[i] = colind[i];
 	        options->RefineInitialized = YES;
-	    } else if ( Fact == SamePattern ||
-			Fact == SamePattern_SameRowPerm ) {
-	        double atemp;
-	        int_t k, jcol, p;
-	        /* Swap to beginning the part of A corresponding to the
-		   local part of X, as was done in pdgsmv_init() */
-	        for (i = 0; i < m_loc; ++i) { /* Loop through each row */
-		    k = rowptr[i];
-		    for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
-		        jcol = colind[j];
-		        p = SOLVEstruct->row_to_proc[jcol];
-		        if ( p == iam ) { /* Local */
-		            atemp = a[k]; a[k] = a[j]; a[j] = atemp;
-		            ++k;
-		        }
-		    }
-	        }
-
-	        /* Re-use the local col indices of A obtained from the
-		   previous call to pdgsmv_init() */
-	        for (i = 0; i < nnz_loc; ++i) colind[i] = colind_gsmv[i];
 	    }
 
 	    if ( nrhs == 1 ) { /* Use the existing solve structure */
@@ -1488,6 +2140,16 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	        SOLVEstruct1->diag_len = SOLVEstruct->diag_len;
 	        SOLVEstruct1->gsmv_comm = SOLVEstruct->gsmv_comm;
 	        SOLVEstruct1->A_colind_gsmv = SOLVEstruct->A_colind_gsmv;
+	        SOLVEstruct1->gstrs_work = NULL;
+	        SOLVEstruct1->sparse_rhs = SOLVEstruct->sparse_rhs;
+	        SOLVEstruct1->out_rows = NULL;
+	        SOLVEstruct1->x_layout = NO;
+	        SOLVEstruct1->root_size = SOLVEstruct->root_size;
+	        SOLVEstruct1->crit_path = SOLVEstruct->crit_path;
+	        SOLVEstruct1->priority = SOLVEstruct->priority;
+	        SOLVEstruct1->rhs_tile = SOLVEstruct->rhs_tile;
+	        SOLVEstruct1->refine_msg_prec = SOLVEstruct->refine_msg_prec;
+	        SOLVEstruct1->msg_prec = SLU_MSG_FULL;
 
 		/* Initialize the *gstrs_comm for 1 RHS. */
 		if ( !(SOLVEstruct1->gstrs_comm = (pxgstrs_comm_t *)
@@ -1497,22 +2159,40 @@ pdgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 			     Glu_persist, SOLVEstruct1);
 	    }
 
-	    pdgsrfs(n, A, anorm, LUstruct, ScalePermstruct, grid,
-		    B, ldb, X, ldx, nrhs, SOLVEstruct1, berr, stat, info);
+	    if ( options->IterRefine == SLU_GMRES )
+		pdgsrfs_gmres(notran ? NOTRANS : TRANS, n, A, anorm, LUstruct,
+			      ScalePermstruct, grid, B, ldb, X, ldx, nrhs,
+			      SOLVEstruct1, berr, stat, info);
+	    else if ( notran )
+		pdgsrfs(n, A, anorm, LUstruct, ScalePermstruct, grid,
+			B, ldb, X, ldx, nrhs, SOLVEstruct1, berr, stat, info);
+	    else
+		pdgsrfs_trans(n, A, anorm, LUstruct, ScalePermstruct, grid,
+			      B, ldb, X, ldx, nrhs, SOLVEstruct1, berr, stat,
+			      info);
 
             /* Deallocate the storage associated with SOLVEstruct1 */
 	    if ( nrhs > 1 ) {
 	        pxgstrs_finalize(SOLVEstruct1->gstrs_comm);
+	        dSolveWorkFree(SOLVEstruct1);
 	        SUPERLU_FREE(SOLVEstruct1);
 	    }
 
 	    stat->utime[REFINE] = SuperLU_timer_() - t;
 	} /* end if IterRefine */
 
-	/* Permute the solution matrix B <= Pc'*X. */
-	pdPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc,
-			       SOLVEstruct->inv_perm_c,
-			       X, ldx, B, ldb, nrhs, grid);
+	if ( notran ) {
+	    /* Permute the solution matrix B <= Pc'*X. */
+	    pdPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc,
+				   SOLVEstruct->inv_perm_c,
+				   X, ldx, B, ldb, nrhs, grid);
+	} else { /* Y is ordered as the rows of A_s. */
+	    x_col = X;  b_col = B;
+	    for (j = 0; j < nrhs; ++j) {
+		memcpy(b_col, x_col, m_loc * sizeof(double));
+		x_col += ldx;  b_col += ldb;
+	    }
+	}
 #if ( DEBUGlevel>=2 )
 	printf("\n (%d) .. After pdPermute_Dense_Matrix(): b =\n", iam);
 	for (i = 0; i < m_loc; ++i)
@@ -0,0 +1,175 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Split-phase (non-blocking) interface to pdgssvx
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <pthread.h>
+#include "superlu_ddefs.h"
+
+/* State of the progress thread, allocated by pdgssvx_start(). */
+typedef struct {
+    pthread_t       tid;
+    pthread_mutex_t lock;
+    int             done;
+} dgssvx_thread_t;
+
+static void *
+dgssvx_thread_main(void *arg)
+{
+    dgssvxRequest_t *req = (dgssvxRequest_t *) arg;
+    dgssvx_thread_t *th = (dgssvx_thread_t *) req->thread;
+
+    pdgssvx(req->options, req->A, req->ScalePermstruct, req->B, req->ldb,
+	    req->nrhs, req->grid, req->LUstruct, req->SOLVEstruct, req->berr,
+	    req->stat, req->info);
+
+    pthread_mutex_lock(&th->lock);
+    th->done = 1;
+    pthread_mutex_unlock(&th->lock);
+    return NULL;
+}
+
+static void
+dgssvx_thread_join(dgssvxRequest_t *req)
+{
+    dgssvx_thread_t *th = (dgssvx_thread_t *) req->thread;
+
+    pthread_join(th->tid, NULL);
+    pthread_mutex_destroy(&th->lock);
+    SUPERLU_FREE(th);
+    req->thread = NULL;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSSVX_START starts pdgssvx() with the same arguments and returns
+ * without waiting for it, so that the calling process can carry on with
+ * its own work while the matrix is factored and solved. The call is
+ * completed by pdgssvx_test() or pdgssvx_wait() on the handle req.
+ *
+ * pdgssvx() runs in a progress thread of the process, on the
+ * communicators of grid, which superlu_gridinit() creates for SuperLU
+ * only. In the meantime the application may communicate on any other
+ * communicator, but must not use the arguments of the call. This needs
+ * MPI to be initialized with MPI_THREAD_MULTIPLE; otherwise, or if the
+ * thread cannot be created, pdgssvx() is run before returning.
+ *
+ * All the processes of grid must call pdgssvx_start() and complete the
+ * call before starting another one on the same grid.
+ *
+ * Arguments
+ * =========
+ *
+ * options, ..., info: see pdgssvx(). info is set on completion.
+ *
+ * req     (output) dgssvxRequest_t*
+ *         The handle of the call.
+ *
+ * Return value
+ * ============
+ *
+ * 1 if pdgssvx() runs in the background, 0 if it has already completed.
+ * </pre>
+ */
+int
+pdgssvx_start(superlu_dist_options_t *options, SuperMatrix *A,
+	      dScalePermstruct_t *ScalePermstruct, double B[], int ldb,
+	      int nrhs, gridinfo_t *grid, dLUstruct_t *LUstruct,
+	      dSOLVEstruct_t *SOLVEstruct, double *berr, SuperLUStat_t *stat,
+	      int *info, dgssvxRequest_t *req)
+{
+    dgssvx_thread_t *th;
+    int provided;
+
+    req->options = options;
+    req->A = A;
+    req->ScalePermstruct = ScalePermstruct;
+    req->B = B;
+    req->ldb = ldb;
+    req->nrhs = nrhs;
+    req->grid = grid;
+    req->LUstruct = LUstruct;
+    req->SOLVEstruct = SOLVEstruct;
+    req->berr = berr;
+    req->stat = stat;
+    req->info = info;
+    req->thread = NULL;
+
+    MPI_Query_thread(&provided);
+    if ( provided == MPI_THREAD_MULTIPLE ) {
+	if ( !(th = (dgssvx_thread_t *) SUPERLU_MALLOC(sizeof(dgssvx_thread_t))) )
+	    ABORT("Malloc fails for dgssvx_thread_t.");
+	th->done = 0;
+	pthread_mutex_init(&th->lock, NULL);
+	req->thread = th;
+	if ( pthread_create(&th->tid, NULL, dgssvx_thread_main, req) == 0 )
+	    return 1;
+	pthread_mutex_destroy(&th->lock);
+	SUPERLU_FREE(th);
+	req->thread = NULL;
+    }
+
+    pdgssvx(options, A, ScalePermstruct, B, ldb, nrhs, grid, LUstruct,
+	    SOLVEstruct, berr, stat, info);
+    return 0;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSSVX_TEST returns 1 if the call started by pdgssvx_start() with the
+ * handle req has completed, and 0 otherwise. It does not block.
+ * </pre>
+ */
+int
+pdgssvx_test(dgssvxRequest_t *req)
+{
+    dgssvx_thread_t *th = (dgssvx_thread_t *) req->thread;
+    int done;
+
+    if ( !th ) return 1;
+    pthread_mutex_lock(&th->lock);
+    done = th->done;
+    pthread_mutex_unlock(&th->lock);
+    if ( done ) dgssvx_thread_join(req);
+    return done;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSSVX_WAIT blocks until the call started by pdgssvx_start() with the
+ * handle req has completed.
+ * </pre>
+ */
+void
+pdgssvx_wait(dgssvxRequest_t *req)
+{
+    if ( req->thread ) dgssvx_thread_join(req);
+}
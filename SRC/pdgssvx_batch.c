@@ -0,0 +1,269 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Solves a batch of independent systems on process subgroups
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "superlu_ddefs.h"
+
+static int
+batch_cmp(const void *a, const void *b)
+{
+    const double *x = (const double *) a, *y = (const double *) b;
+    if ( x[0] != y[0] ) return (x[0] < y[0]) - (x[0] > y[0]); /* decreasing */
+    return (x[1] > y[1]) - (x[1] < y[1]);                     /* then by index */
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * dBatchInit prepares the solution of nsys independent systems by
+ * pdgssvx_batch(). The processes of grid are split into groups of
+ * nprow*npcol consecutive processes, each with its own nprow-by-npcol
+ * process grid; the processes left over are idle. The systems are
+ * assigned to the groups once for all, the most costly first to the
+ * least loaded group.
+ *
+ * Arguments
+ * =========
+ *
+ * nsys    (input) int
+ *         The number of systems of the batch.
+ *
+ * cost    (input) double*, dimension (nsys)
+ *         An estimate of the cost of each system, for example the number
+ *         of nonzeros of its factors; the same on every process. With
+ *         cost = NULL, the systems are assumed to cost the same.
+ *
+ * nprow, npcol (input) int
+ *         The shape of the process grid of each group.
+ *
+ * grid    (input) gridinfo_t*
+ *         The 2D process mesh to split.
+ *
+ * batch   (output) dBatch_t*
+ *         The groups and the assignment of the systems. On a process of
+ *         group batch->group, the systems batch->loc[0:batch->nloc-1] are
+ *         solved on batch->grid, on which their matrices must be
+ *         distributed. batch->group = -1 on the idle processes.
+ * </pre>
+ */
+void
+dBatchInit(int nsys, double *cost, int nprow, int npcol, gridinfo_t *grid,
+	   dBatch_t *batch)
+{
+    MPI_Comm gcomm;
+    double *pair, *load;
+    int   iam = grid->iam, nprocs = grid->nprow * grid->npcol;
+    int   gsize = nprow * npcol, ng, g, gmin, s, l;
+
+    if ( nsys < 0 || gsize < 1 || gsize > nprocs )
+	ABORT("dBatchInit: illegal batch or sub-grid size.");
+
+    ng = SUPERLU_MAX(1, SUPERLU_MIN(nprocs / gsize, nsys));
+    batch->nsys = nsys;
+    batch->ngroups = ng;
+    batch->group = iam / gsize < ng ? iam / gsize : -1;
+
+    if ( !(batch->sys_group = SUPERLU_MALLOC(2 * (nsys + 1) * sizeof(int))) )
+	ABORT("Malloc fails for sys_group[].");
+    batch->loc = batch->sys_group + nsys + 1;
+    if ( !(pair = SUPERLU_MALLOC((2 * nsys + ng + 1) * sizeof(double))) )
+	ABORT("Malloc fails for pair[].");
+    load = pair + 2 * nsys;
+    for (s = 0; s < nsys; ++s) {
+	pair[2*s] = cost ? cost[s] : 1.0;
+	pair[2*s+1] = s;
+    }
+    qsort(pair, nsys, 2 * sizeof(double), batch_cmp);
+    for (g = 0; g < ng; ++g) load[g] = 0.0;
+    for (s = 0; s < nsys; ++s) {
+	for (gmin = 0, g = 1; g < ng; ++g) if ( load[g] < load[gmin] ) gmin = g;
+	load[gmin] += pair[2*s];
+	batch->sys_group[(int) pair[2*s+1]] = gmin;
+    }
+    SUPERLU_FREE(pair);
+    for (batch->nloc = 0, s = 0; s < nsys; ++s)
+	if ( batch->sys_group[s] == batch->group ) batch->loc[batch->nloc++] = s;
+
+    MPI_Comm_split(grid->comm, batch->group >= 0 ? batch->group : MPI_UNDEFINED,
+		   iam, &gcomm);
+    if ( batch->group >= 0 ) {
+	superlu_gridinit(gcomm, nprow, npcol, &batch->grid);
+	MPI_Comm_free(&gcomm);
+    } else {
+	batch->grid.comm = MPI_COMM_NULL;
+    }
+
+    l = SUPERLU_MAX(batch->nloc, 1);
+    batch->options = SUPERLU_MALLOC(l * sizeof(superlu_dist_options_t));
+    batch->ScalePermstruct = SUPERLU_MALLOC(l * sizeof(dScalePermstruct_t));
+    batch->LUstruct = SUPERLU_MALLOC(l * sizeof(dLUstruct_t));
+    batch->SOLVEstruct = SUPERLU_MALLOC(l * sizeof(dSOLVEstruct_t));
+    batch->n = intMalloc_dist(l);
+    if ( !batch->options || !batch->ScalePermstruct || !batch->LUstruct
+	 || !batch->SOLVEstruct || !batch->n )
+	ABORT("Malloc fails for the batch.");
+    for (l = 0; l < batch->nloc; ++l) batch->n[l] = EMPTY;
+
+#if ( PRNTlevel>=1 )
+    if ( !iam )
+	printf(".. Batch of %d systems on %d groups of %d x %d processes\n",
+	       nsys, ng, nprow, npcol);
+#endif
+}
+
+/* Free the factors and the solve structures of system l of my group. */
+static void
+batch_free_system(dBatch_t *batch, int l)
+{
+    if ( batch->n[l] == EMPTY ) return;
+    dDestroy_LU(batch->n[l], &batch->grid, &batch->LUstruct[l]);
+    dScalePermstructFree(&batch->ScalePermstruct[l]);
+    dLUstructFree(&batch->LUstruct[l]);
+    if ( batch->options[l].SolveInitialized )
+	dSolveFinalize(&batch->options[l], &batch->SOLVEstruct[l]);
+    batch->n[l] = EMPTY;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSSVX_BATCH solves the systems A_l * X_l = B_l of my group, set up by
+ * dBatchInit(), one after the other with pdgssvx() on the grid of the
+ * group; the groups work concurrently without communicating. It is
+ * collective over each group; the idle processes return at once.
+ *
+ * The factors, the permutations and the communication structures of the
+ * solve are kept in batch between the calls, so that the fixed costs of
+ * pdgssvx() are paid once per system rather than once per call:
+ *   - the first call for a system always factors it (Fact = DOFACT);
+ *   - later calls apply options->Fact to every system of the group:
+ *     FACTORED only solves with the kept factors, SamePattern and
+ *     SamePattern_SameRowPerm refactor A_l with the kept column (and row)
+ *     permutation, and DOFACT starts afresh;
+ *   - a system whose pdgssvx() failed is factored afresh at the next call.
+ * The other options are passed to pdgssvx() unchanged.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         The options of pdgssvx(), see above for options->Fact.
+ *
+ * batch   (input/output) dBatch_t*
+ *         The batch set up by dBatchInit().
+ *
+ * A       (input/output) SuperMatrix**, dimension (batch->nloc)
+ *         A[l] is the matrix of system batch->loc[l], distributed by
+ *         block rows on batch->grid as for pdgssvx().
+ *         On exit, A[l] is overwritten as by pdgssvx(); a new A[l] with
+ *         the same sparsity pattern is passed to refactor.
+ *
+ * B       (input/output) double**, dimension (batch->nloc)
+ *         On entry, B[l] holds the local rows of the right-hand sides of
+ *         system batch->loc[l]; on exit, those of the solution.
+ *
+ * ldb     (input) int*, dimension (batch->nloc)
+ *         The leading dimension of each B[l].
+ *
+ * nrhs    (input) int
+ *         The number of right-hand sides of every system.
+ *
+ * berr    (output) double**, dimension (batch->nloc)
+ *         berr[l], of dimension nrhs, is the componentwise relative
+ *         backward error of the solution of system batch->loc[l].
+ *
+ * stat    (output) SuperLUStat_t*
+ *         The times and operation counts summed over the systems of the
+ *         group.
+ *
+ * info    (output) int*, dimension (batch->nloc)
+ *         info[l] is the info of pdgssvx() for system batch->loc[l].
+ * </pre>
+ */
+void
+pdgssvx_batch(superlu_dist_options_t *options, dBatch_t *batch,
+	      SuperMatrix **A, double **B, int *ldb, int nrhs,
+	      double **berr, SuperLUStat_t *stat, int *info)
+{
+    superlu_dist_options_t *opts;
+    SuperLUStat_t gstat;
+    yes_no_t solve_init;
+    int_t n;
+    int   l, i;
+
+    for (l = 0; l < batch->nloc; ++l) {
+	n = A[l]->ncol;
+	opts = &batch->options[l];
+	if ( batch->n[l] != EMPTY && (options->Fact == DOFACT
+				      || n != batch->n[l]) )
+	    batch_free_system(batch, l);
+
+	if ( batch->n[l] == EMPTY ) {
+	    *opts = *options;
+	    opts->Fact = DOFACT;
+	    opts->SolveInitialized = NO;
+	    dScalePermstructInit(n, n, &batch->ScalePermstruct[l]);
+	    dLUstructInit(n, &batch->LUstruct[l]);
+	} else {
+	    solve_init = opts->SolveInitialized;
+	    *opts = *options;
+	    opts->SolveInitialized = solve_init;
+	    if ( opts->Fact == SamePattern )
+		dDestroy_LU(n, &batch->grid, &batch->LUstruct[l]);
+	}
+
+	PStatInit(&gstat);
+	pdgssvx(opts, A[l], &batch->ScalePermstruct[l], B[l], ldb[l], nrhs,
+		&batch->grid, &batch->LUstruct[l], &batch->SOLVEstruct[l],
+		berr[l], &gstat, &info[l]);
+	batch->n[l] = n;
+	if ( info[l] ) batch_free_system(batch, l); /* refactor next time */
+
+	for (i = 0; i < NPHASES; ++i) {
+	    stat->utime[i] += gstat.utime[i];
+	    stat->ops[i] += gstat.ops[i];
+	}
+	stat->TinyPivots += gstat.TinyPivots;
+	stat->RefineSteps = SUPERLU_MAX(stat->RefineSteps, gstat.RefineSteps);
+	PStatFree(&gstat);
+    }
+}
+
+/*! \brief Free the factors of the batch and the grids of the groups. */
+void
+dBatchFinalize(dBatch_t *batch)
+{
+    int l;
+
+    for (l = 0; l < batch->nloc; ++l) batch_free_system(batch, l);
+    if ( batch->group >= 0 ) superlu_gridexit(&batch->grid);
+    SUPERLU_FREE(batch->sys_group);
+    SUPERLU_FREE(batch->options);
+    SUPERLU_FREE(batch->ScalePermstruct);
+    SUPERLU_FREE(batch->LUstruct);
+    SUPERLU_FREE(batch->SOLVEstruct);
+    SUPERLU_FREE(batch->n);
+}
@@ -0,0 +1,173 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Solves a system once, with the forward solve in the factorization
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The factorization of the bordered matrix
+ *
+ *       M = [ A  B ]  =  [ L  0 ] [ U  L^{-1}B ]
+ *           [ 0  I ]     [ 0  I ] [ 0     I    ]
+ *
+ * computes L^{-1}B in its last block column: each block of it is final as
+ * soon as the panel of its block row is, and is updated by the Schur
+ * complement GEMMs and sent with the U panels of the factorization. Then
+ * M * [X; Z] = [0; -I] gives Z = -I and A*X = B, and its forward solve
+ * has nothing to do: with options->SparseRHS, it is pruned to the last
+ * rows, and only the back solve with U remains.
+ * </pre>
+ */
+
+#include "superlu_ddefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSSVX_FUSED solves A*X = B once, as pdgssvx() with Fact = DOFACT
+ * would, but with the forward solve L^{-1}*B done by the factorization
+ * (see above) instead of by a separate, latency-bound phase of pdgstrs().
+ * The factors are not kept: the solution of other right-hand sides needs
+ * pdgssvx().
+ *
+ * The bordered matrix M has n+nrhs rows; the nrhs last are given to the
+ * process of the last row of A. The orderings are those of options for
+ * M: the columns of B, dense in general, are ordered last by the minimum
+ * degree and nested dissection orderings, and the row permutation and the
+ * scalings see the entries of B in the rows of A. options->Fact is not
+ * used; with Trans other than NOTRANS, this is pdgssvx() with Fact =
+ * DOFACT on a copy of A.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         The options of pdgssvx(); SparseRHS is set for the solve.
+ *
+ * A       (input) SuperMatrix*
+ *         The matrix A, distributed by block rows as for pdgssvx();
+ *         unchanged on exit.
+ *
+ * B       (input/output) double*, dimension (ldb, nrhs)
+ *         On entry, the local rows of B; on exit, those of X.
+ *
+ * ldb     (input) int
+ *         The leading dimension of B.
+ *
+ * nrhs    (input) int
+ *         The number of right-hand sides.
+ *
+ * grid    (input) gridinfo_t*
+ *         The 2D process mesh.
+ *
+ * berr    (output) double*, dimension (nrhs)
+ *         The componentwise relative backward error of each solution of
+ *         the bordered system, see options->IterRefine.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         The times and operation counts of the factorization and the
+ *         solve of M.
+ *
+ * info    (output) int*
+ *         As for pdgssvx(), for M: 0 < info <= n means U(info,info) of A
+ *         is exactly zero.
+ * </pre>
+ */
+void
+pdgssvx_fused(superlu_dist_options_t *options, SuperMatrix *A, double *B,
+	      int ldb, int nrhs, gridinfo_t *grid, double *berr,
+	      SuperLUStat_t *stat, int *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    superlu_dist_options_t opts = *options;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    SuperMatrix M;
+    int_t  n = A->ncol, m_loc = Astore->m_loc, fst_row = Astore->fst_row;
+    int_t  *rowptr = Astore->rowptr, *colind = Astore->colind;
+    int_t  *mrowptr, *mcolind, nb, mn, m_locM, nnz_locM, i, j, k;
+    double *a = (double *) Astore->nzval, *mval, *BM;
+    int    ldbM;
+
+    /* The border, of nrhs rows and columns, on the process of the last
+       row of A. */
+    nb = ( options->Trans == NOTRANS ) ? nrhs : 0;
+    mn = n + nb;
+    m_locM = m_loc + (( m_loc > 0 && fst_row + m_loc == n ) ? nb : 0);
+
+    /* The local rows of M = [A B; 0 I], B in columns n:n+nb-1. */
+    for (nnz_locM = rowptr[m_loc], i = 0; i < m_loc; ++i)
+	for (j = 0; j < nb; ++j)
+	    if ( B[i + j * ldb] != 0.0 ) ++nnz_locM;
+    nnz_locM += m_locM - m_loc;
+    if ( !(mrowptr = intMalloc_dist(m_locM + 1))
+	 || !(mcolind = intMalloc_dist(SUPERLU_MAX(nnz_locM, 1)))
+	 || !(mval = doubleMalloc_dist(SUPERLU_MAX(nnz_locM, 1))) )
+	ABORT("Malloc fails for M.");
+    for (k = 0, i = 0; i < m_loc; ++i) {
+	mrowptr[i] = k;
+	for (j = rowptr[i]; j < rowptr[i+1]; ++j, ++k) {
+	    mcolind[k] = colind[j];
+	    mval[k] = a[j];
+	}
+	for (j = 0; j < nb; ++j)
+	    if ( B[i + j * ldb] != 0.0 ) {
+		mcolind[k] = n + j;
+		mval[k++] = B[i + j * ldb];
+	    }
+    }
+    for (i = m_loc; i < m_locM; ++i) {
+	mrowptr[i] = k;
+	mcolind[k] = n + i - m_loc;
+	mval[k++] = 1.0;
+    }
+    mrowptr[m_locM] = k;
+    dCreate_CompRowLoc_Matrix_dist(&M, A->nrow + nb, mn, nnz_locM, m_locM,
+				   fst_row, mval, mcolind, mrowptr,
+				   SLU_NR_loc, SLU_D, SLU_GE);
+
+    /* The right-hand sides [0; -I], or B without border. */
+    ldbM = SUPERLU_MAX(m_locM, 1);
+    if ( !(BM = doubleCalloc_dist((size_t) ldbM * SUPERLU_MAX(nrhs, 1))) )
+	ABORT("Calloc fails for BM[].");
+    if ( nb ) {
+	for (j = 0; j < m_locM - m_loc; ++j) BM[m_loc + j + j * ldbM] = -1.0;
+	opts.SparseRHS = YES;
+    } else {
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < m_loc; ++i) BM[i + j * ldbM] = B[i + j * ldb];
+    }
+
+    dScalePermstructInit(A->nrow + nb, mn, &ScalePermstruct);
+    dLUstructInit(mn, &LUstruct);
+    opts.Fact = DOFACT;
+    opts.SolveInitialized = opts.RefineInitialized = NO;
+    pdgssvx(&opts, &M, &ScalePermstruct, BM, ldbM, nrhs, grid, &LUstruct,
+	    &SOLVEstruct, berr, stat, info);
+
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) B[i + j * ldb] = BM[i + j * ldbM];
+
+    SUPERLU_FREE(BM);
+    Destroy_CompRowLoc_Matrix_dist(&M);
+    if ( *info >= 0 ) dDestroy_LU(mn, grid, &LUstruct);
+    dScalePermstructFree(&ScalePermstruct);
+    dLUstructFree(&LUstruct);
+    if ( opts.SolveInitialized == YES ) dSolveFinalize(&opts, &SOLVEstruct);
+}
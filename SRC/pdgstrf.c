@@ -152,29 +152,573 @@ at the top-level directory.
 
 #define PDGSTRF2 pdgstrf2_trsm
 
+/* Supernode s keeps its factors: it is not factored again, and only
+   updates the dirty panels (see pdgsrefactor_partial()). */
+#define SN_CLEAN(s) ( sn_dirty && !sn_dirty[s] )
+
 #ifdef ISORT
 extern void isort (int_t N, int_t * ARRAY1, int_t * ARRAY2);
 extern void isort1 (int_t N, int_t * ARRAY);
+#endif
 
-#else
 
-int
-superlu_sort_perm (const void *arg1, const void *arg2)
+/************************************************************************/
+
+#include "dscatter.c"
+
+/************************************************************************/
+
+/*! \brief Choose the depth of the look-ahead window from the elimination
+ *  tree of the supernodes.
+ *
+ * <pre>
+ * A panel in the window can be factorized ahead of time only if it does
+ * not wait for the panels before it. The parent of supernode j is taken
+ * as the first block below the diagonal in L(:,j); the number of
+ * supernodes divided by the height of this tree is the average number of
+ * panels that can be ready at the same time. The depth returned is this
+ * number, at least 1 and at most twice the larger dimension of the
+ * process grid: the panels are owned cyclically, and a deeper window
+ * costs buffer space without keeping more processes busy.
+ * Collective over grid->comm.
+ * </pre>
+ */
+static int
+adaptive_lookaheads(int_t nsupers, dLocalLU_t *Llu, gridinfo_t *grid)
+{
+    int_t *parent, *height, *index;
+    int_t h, i, jb, k, lb, nlb;
+    int mycol = MYCOL( grid->iam, grid );
+
+    if ( !(height = intMalloc_dist(2 * nsupers)) )
+	ABORT("Malloc fails for height[].");
+    parent = height + nsupers;
+
+    for (i = 0; i < nsupers; ++i) height[i] = nsupers;
+    for (lb = 0; (jb = lb * grid->npcol + mycol) < nsupers; ++lb) {
+	if ( !(index = Llu->Lrowind_bc_ptr[lb]) ) continue;
+	nlb = index[0];
+	k = BC_HEADER;
+	for (i = 0; i < nlb; ++i) {
+	    if ( index[k] != jb ) height[jb] = SUPERLU_MIN(height[jb], index[k]);
+	    k += LB_DESCRIPTOR + index[k+1];
+	}
+    }
+    MPI_Allreduce(height, parent, nsupers, mpi_int_t, MPI_MIN, grid->comm);
+
+    /* The parent of a supernode is always numbered after it. */
+    for (i = 0; i < nsupers; ++i) height[i] = 1;
+    for (h = 0, i = 0; i < nsupers; ++i) {
+	h = SUPERLU_MAX(h, height[i]);
+	if ( parent[i] < nsupers )
+	    height[parent[i]] = SUPERLU_MAX(height[parent[i]], height[i] + 1);
+    }
+
+    SUPERLU_FREE(height);
+    h = SUPERLU_MIN(nsupers / SUPERLU_MAX(h, 1),
+                    2 * SUPERLU_MAX(grid->nprow, grid->npcol));
+    return (int) SUPERLU_MAX(1, SUPERLU_MIN(h, MAX_LOOKAHEADS - 1));
+}
+
+/*! \brief Fit the buffers of the factorization in options->MemBudget.
+ *
+ * <pre>
+ * The local L and U factors are counted first, the look-ahead panel
+ * buffers, bigU and bigV must fit in the rest of the budget. The
+ * look-ahead depth is reduced first; then U(k,:) is updated by chunks of
+ * at most *u_chunk nonzero columns, halved down to the maximum supernode
+ * size, which shrinks bigU and bigV. The depth is the smallest over the
+ * processes. Returns the number of megabytes missing on the process
+ * short of the most memory, 0 if the buffers fit.
+ * Collective over grid->comm.
+ * </pre>
+ */
+static int
+dmem_budget(superlu_dist_options_t *options, int_t n, dLUstruct_t *LUstruct,
+	    gridinfo_t *grid, int *num_look_aheads, int_t *u_chunk)
 {
-    const int_t *val1 = (const int_t *) arg1;
-    const int_t *val2 = (const int_t *) arg2;
-    return (*val2 < *val1);
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t nsupers = LUstruct->Glu_persist->supno[n-1] + 1;
+    int_t *perm_u, *lsub, lb, max_ncols = 0, max_ldu, bigu, chunk;
+    int   mycol = MYCOL( grid->iam, grid ), ldt = sp_ienv_dist(3);
+    int   nla = *num_look_aheads, num_threads = 1, my_row_size = 0;
+    int   max_row_size, missing, my_missing;
+    double avail, panel = 0.0, dword = sizeof(double), need;
+
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    for (lb = 0; lb * grid->npcol + mycol < nsupers; ++lb)
+	if ( (lsub = Llu->Lrowind_bc_ptr[lb]) && lsub[1] > my_row_size )
+	    my_row_size = lsub[1];
+    MPI_Allreduce(&my_row_size, &max_row_size, 1, MPI_INT, MPI_MAX,
+		  grid->rscp.comm);
+    if ( !(perm_u = intMalloc_dist(nsupers)) )
+	ABORT("Malloc fails for perm_u[].");
+    bigu = estimate_bigu_size(nsupers, Llu->Ufstnz_br_ptr, LUstruct->Glu_persist,
+			      grid, perm_u, &max_ncols);
+    SUPERLU_FREE(perm_u);
+    max_ldu = max_ncols ? bigu / max_ncols : 0;
+    if ( grid->nprow * grid->npcol > 1 )
+	panel = (double) (Llu->bufmax[0] + Llu->bufmax[2]) * sizeof(int_t)
+	    + (double) (Llu->bufmax[1] + Llu->bufmax[3]) * dword;
+
+#define BUDGET_NEED(nla, chunk) \
+    ((nla + 1) * panel + dword * ((double) max_ldu * (chunk) \
+	+ SUPERLU_MAX((double) max_row_size * (chunk), \
+		      (ldt * ldt + CACHELINE / dword) * num_threads)))
+
+    avail = options->MemBudget * 1e6 - dLU_local_bytes(n, LUstruct, grid);
+    chunk = max_ncols;
+    while ( nla > 0 && BUDGET_NEED(nla, chunk) > avail ) --nla;
+    MPI_Allreduce(MPI_IN_PLACE, &nla, 1, MPI_INT, MPI_MIN, grid->comm);
+#ifndef GPU_ACC /* dSchCompUdt-cuda.c takes U(k,:) whole */
+    while ( chunk > ldt && BUDGET_NEED(nla, chunk) > avail )
+	chunk = SUPERLU_MAX(ldt, chunk / 2);
+#endif
+    need = BUDGET_NEED(nla, chunk);
+#undef BUDGET_NEED
+
+    my_missing = need > avail ? (int) ceil((need - avail) * 1e-6) : 0;
+    MPI_Allreduce(&my_missing, &missing, 1, MPI_INT, MPI_MAX, grid->comm);
+#if ( PRNTlevel>=1 )
+    if ( nla < *num_look_aheads || chunk < max_ncols || my_missing )
+	printf("(%d) .. MemBudget: look-ahead %d, U chunk " IFMT
+	       " of " IFMT " columns, %d MB missing\n", grid->iam, nla,
+	       chunk, max_ncols, my_missing);
+#endif
+    *num_look_aheads = nla;
+    *u_chunk = chunk < max_ncols ? chunk : 0;
+    return missing;
+}
+
+/*! \brief Let the receives posted for the look-ahead window progress.
+ *
+ * <pre>
+ * Used with options->Fact_Comm = SLU_COMM_IRECV between the phases of the
+ * Schur complement update of step k0. MPI_Request_get_status() does not
+ * free a completed request, so that the MPI_Test/MPI_Wait calls of the
+ * main loop and their message counts are unchanged.
+ * </pre>
+ */
+static void
+progress_lookahead_recvs(int_t k0, int_t nfact, int num_look_aheads,
+			 MPI_Request **recv_reqs, MPI_Request **recv_reqs_u)
+{
+    int_t kk0, kk1 = SUPERLU_MIN(k0 + num_look_aheads, nfact - 1);
+    int   i, look_id, flag;
+    MPI_Status status;
+
+    for (kk0 = k0 + 1; kk0 <= kk1; ++kk0) {
+	look_id = kk0 % (1 + num_look_aheads);
+	for (i = 0; i < 2; ++i) {
+	    if ( recv_reqs[look_id][i] != MPI_REQUEST_NULL )
+		MPI_Request_get_status(recv_reqs[look_id][i], &flag, &status);
+	    if ( recv_reqs_u[look_id][i] != MPI_REQUEST_NULL )
+		MPI_Request_get_status(recv_reqs_u[look_id][i], &flag, &status);
+	}
+    }
+}
+
+/* Seconds between two tests of poll_lookahead(). */
+#define SLU_COMM_POLL 2e-5
+
+/* The communicator of the panel messages of step kk0 in the scope scp, of
+   its look-ahead slot with options->Fact_Comm = SLU_COMM_THREADS. */
+#define PANEL_COMM(scp, kk0) \
+    ( slot_comm ? slot_comm[2 * ((kk0) % (1 + num_look_aheads)) \
+			    + ((scp) == &grid->cscp)] : (scp)->comm )
+
+#ifdef _OPENMP
+/*! \brief Let the panel messages of the look-ahead window progress from
+ *         the threads of the Schur complement update.
+ *
+ * <pre>
+ * Used with options->Fact_Comm = SLU_COMM_THREADS after each block
+ * update. The thread that gets *lock, if the last test is SLU_COMM_POLL
+ * seconds old, tests the receives of the window as
+ * progress_lookahead_recvs() and the sends of all the slots; the other
+ * threads go on with their blocks. MPI_Request_get_status() leaves the
+ * requests to the main loop.
+ * </pre>
+ */
+static void
+poll_lookahead(omp_lock_t *lock, double *last, int_t k0, int_t nfact,
+	       int num_look_aheads, MPI_Request **recv_reqs,
+	       MPI_Request **recv_reqs_u, MPI_Request **send_reqs,
+	       MPI_Request **send_reqs_u, int Pr, int Pc)
+{
+    double t;
+    int   i, look_id, flag;
+    MPI_Status status;
+
+    if ( !omp_test_lock(lock) ) return;
+    t = SuperLU_timer_();
+    if ( t - *last >= SLU_COMM_POLL ) {
+	*last = t;
+	progress_lookahead_recvs(k0, nfact, num_look_aheads, recv_reqs,
+				 recv_reqs_u);
+	for (look_id = 0; look_id <= num_look_aheads; ++look_id) {
+	    for (i = 0; i < 2 * Pc; ++i)
+		if ( send_reqs[look_id][i] != MPI_REQUEST_NULL )
+		    MPI_Request_get_status(send_reqs[look_id][i], &flag, &status);
+	    for (i = 0; i < 2 * Pr; ++i)
+		if ( send_reqs_u[look_id][i] != MPI_REQUEST_NULL )
+		    MPI_Request_get_status(send_reqs_u[look_id][i], &flag,
+					   &status);
+	}
+    }
+    omp_unset_lock(lock);
 }
 #endif
 
+/*! \brief The L (or U) panels of a process exposed to its process row
+ * (or column), used with options->Fact_Comm = SLU_COMM_RMA.
+ */
+typedef struct {
+    MPI_Win   iwin, vwin, fwin; /* indices, values and ready flags */
+    int_t    *index;    /* contiguous copy of the local panel indices */
+    int      *ready;    /* ready[lb] = 1 once the local panel lb is final */
+    int       np;       /* size of the communicator, no windows if 1 */
+    int_t     nlb;      /* max. number of local panels of a process */
+    MPI_Aint *disp;     /* 4 entries at 4*(p*nlb+lb) for the panel lb of
+			   process p: displacements of its index and values,
+			   then their counts */
+} panel_rma_t;
+
+/*! \brief Expose the local L (is_L = 1) or U panels in RMA windows.
+ *
+ * <pre>
+ * The panel lb of the calling process, rank me of comm, is the global
+ * block lb*np+me; index[lb] and val[lb] are its index and values. The
+ * values are read in place from the slab that holds all of them, the
+ * indices are copied into one array. The displacements and counts of
+ * every panel of comm are gathered, so that a panel is pulled with one
+ * MPI_Get per array once panel_rma_ready() has been called for it.
+ * </pre>
+ */
+static void
+panel_rma_init(panel_rma_t *pw, int is_L, int_t nsupers, int_t *xsup,
+	       MPI_Comm comm, int me, int np,
+	       int_t **index, double **val, double *slab)
+{
+    int_t lb, gb, i, *sub;
+    MPI_Aint *d, ilen = 0, vlen = 0;
+
+    /* Nothing to pull from with a single process; this also avoids the
+       windows on a communicator of size 1 that some MPIs fail to create. */
+    if ( (pw->np = np) == 1 ) return;
+    pw->nlb = CEILING(nsupers, np);
+    if ( !(d = SUPERLU_MALLOC(4 * SUPERLU_MAX(pw->nlb, 1) * sizeof(MPI_Aint))) )
+	ABORT("Malloc fails for disp[].");
+    for (i = 0; i < 4 * pw->nlb; ++i) d[i] = 0;
+    for (lb = 0, gb = me; gb < nsupers; gb += np, ++lb) {
+	if ( !(sub = index[lb]) ) continue;
+	d[4*lb]   = ilen;
+	d[4*lb+1] = val[lb] - slab;
+	d[4*lb+2] = is_L ? sub[1] + BC_HEADER + sub[0] * LB_DESCRIPTOR : sub[2];
+	d[4*lb+3] = is_L ? (MPI_Aint) sub[1] * SuperSize(gb) : sub[1];
+	ilen += d[4*lb+2];
+	vlen = SUPERLU_MAX(vlen, d[4*lb+1] + d[4*lb+3]);
+    }
+
+    if ( !(pw->index = intMalloc_dist(SUPERLU_MAX(ilen, 1))) )
+	ABORT("Malloc fails for index[].");
+    for (lb = 0, gb = me; gb < nsupers; gb += np, ++lb)
+	for (i = 0; i < d[4*lb+2]; ++i) pw->index[d[4*lb] + i] = index[lb][i];
+
+    if ( !(pw->disp = SUPERLU_MALLOC(4 * SUPERLU_MAX(pw->nlb, 1) * np
+				     * sizeof(MPI_Aint))) )
+	ABORT("Malloc fails for disp[].");
+    MPI_Allgather(d, 4 * pw->nlb, MPI_AINT, pw->disp, 4 * pw->nlb, MPI_AINT,
+		  comm);
+    SUPERLU_FREE(d);
+
+    if ( !(pw->ready = SUPERLU_MALLOC(SUPERLU_MAX(pw->nlb, 1) * sizeof(int))) )
+	ABORT("Malloc fails for ready[].");
+    for (lb = 0; lb < pw->nlb; ++lb) pw->ready[lb] = 0;
+
+    MPI_Win_create(pw->index, ilen * sizeof(int_t), sizeof(int_t),
+		   MPI_INFO_NULL, comm, &pw->iwin);
+    MPI_Win_create(slab, vlen * sizeof(double), sizeof(double),
+		   MPI_INFO_NULL, comm, &pw->vwin);
+    MPI_Win_create(pw->ready, pw->nlb * sizeof(int), sizeof(int),
+		   MPI_INFO_NULL, comm, &pw->fwin);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, pw->iwin);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, pw->vwin);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, pw->fwin);
+}
 
-/************************************************************************/
+/*! \brief Flag the local panel lb as final, replaces its MPI_Isend's. */
+static void
+panel_rma_ready(panel_rma_t *pw, int me, int_t lb)
+{
+    int one = 1;
 
-#include "dscatter.c"
+    if ( pw->np == 1 ) return;
+    MPI_Win_sync(pw->vwin); /* the values are visible before the flag */
+    MPI_Accumulate(&one, 1, MPI_INT, me, lb, 1, MPI_INT, MPI_REPLACE,
+		   pw->fwin);
+    MPI_Win_flush(me, pw->fwin);
+}
 
-/************************************************************************/
+/*! \brief Pull the panel lb of process p into sub_buf[] and val_buf[].
+ *
+ * <pre>
+ * With wait = 0 the panel is only pulled if it is already flagged ready.
+ * Returns 1 if it was pulled, with the counts of sub_buf[] and val_buf[]
+ * in msgcnt[0] and msgcnt[1], as from the MPI_Irecv's it replaces.
+ * </pre>
+ */
+static int
+panel_rma_get(panel_rma_t *pw, int p, int_t lb, int wait,
+	      int_t *sub_buf, double *val_buf, int *msgcnt)
+{
+    MPI_Aint *d = &pw->disp[4 * (p * pw->nlb + lb)];
+    int flag;
+
+    do {
+	MPI_Fetch_and_op(NULL, &flag, MPI_INT, p, lb, MPI_NO_OP, pw->fwin);
+	MPI_Win_flush(p, pw->fwin);
+    } while ( !flag && wait );
+    if ( !flag ) return 0;
+
+    if ( d[2] ) MPI_Get(sub_buf, (int) d[2], mpi_int_t, p, d[0], (int) d[2],
+			mpi_int_t, pw->iwin);
+    if ( d[3] ) MPI_Get(val_buf, (int) d[3], MPI_DOUBLE, p, d[1], (int) d[3],
+			MPI_DOUBLE, pw->vwin);
+    MPI_Win_flush(p, pw->iwin);
+    MPI_Win_flush(p, pw->vwin);
+    msgcnt[0] = (int) d[2];
+    msgcnt[1] = (int) d[3];
+    return 1;
+}
+
+/*! \brief Close the windows of panel_rma_init(); collective on its comm. */
+static void
+panel_rma_finalize(panel_rma_t *pw)
+{
+    if ( pw->np == 1 ) return;
+    MPI_Win_unlock_all(pw->iwin);
+    MPI_Win_unlock_all(pw->vwin);
+    MPI_Win_unlock_all(pw->fwin);
+    MPI_Win_free(&pw->iwin);
+    MPI_Win_free(&pw->vwin);
+    MPI_Win_free(&pw->fwin);
+    SUPERLU_FREE(pw->index);
+    SUPERLU_FREE(pw->ready);
+    SUPERLU_FREE(pw->disp);
+}
+
+
+/*! \brief Step k is done with L(:,k) (or U(k,:)), local block lb: retire
+ *  the slab of L (U) up to the first block still needed.
+ *
+ * <pre>
+ * done[] flags the local blocks the factorization is done with, and next
+ * is the first one not done. See options->OutOfCore.
+ * </pre>
+ */
+static void
+dooc_retire(superlu_ooc_t *ooc, double **nzval_ptr, int_t nb, char *done,
+	     int_t *next, int_t lb)
+{
+    done[lb] = 1;
+    while ( *next < nb && done[*next] ) ++(*next);
+    for (lb = *next; lb < nb && !nzval_ptr[lb]; ++lb) ;
+    superlu_ooc_retire(ooc, lb < nb ? (void *) nzval_ptr[lb] : NULL);
+}
+
+/*! \brief Let each thread write first the scratch it uses in the Schur
+ * complement update.
+ *
+ * <pre>
+ * A page is placed in the NUMA domain of the thread that touches it first,
+ * so the arena is not left to the master thread. Thread t uses the slice t
+ * of indirect[] and indirect2[] (iinfo entries each) and of the look-ahead
+ * GEMM output at the head of bigV[] (ldt*ldt entries); the rest of bigV[]
+ * and bigU[] are shared and split evenly among the threads. With unbound
+ * threads (OMP_PROC_BIND unset) the placement may not last.
+ * </pre>
+ */
+static void
+first_touch_scratch(int num_threads, int *indirect, int *indirect2, int iinfo,
+		    double *bigV, int_t bigv_size, int ldt,
+		    double *bigU, int_t bigu_size)
+{
+#ifdef _OPENMP
+    int_t nslice = SUPERLU_MIN((int_t) ldt * ldt * num_threads, bigv_size);
+
+#pragma omp parallel num_threads(num_threads)
+    {
+	int t = omp_get_thread_num(), i;
+	int_t j, lo = SUPERLU_MIN((int_t) ldt * ldt * t, nslice),
+	    hi = SUPERLU_MIN(lo + (int_t) ldt * ldt, nslice);
+
+	for (i = 0; i < iinfo; ++i)
+	    indirect[t * iinfo + i] = indirect2[t * iinfo + i] = 0;
+	for (j = lo; j < hi; ++j) bigV[j] = 0.0;
+#pragma omp for schedule(static) nowait
+	for (j = nslice; j < bigv_size; ++j) bigV[j] = 0.0;
+#pragma omp for schedule(static) nowait
+	for (j = 0; j < bigu_size; ++j) bigU[j] = 0.0;
+    }
+#endif
+}
+
+/*! \brief Buffers of the encoded panel indices, options->Panel_Compress.
+ *
+ * <pre>
+ * pack[2*look_id] and pack[2*look_id+1] hold the index sent and the
+ * index received in the look-ahead slot look_id, each of up to bufmax
+ * entries.
+ * </pre>
+ */
+static unsigned char **
+index_pack_alloc(int num_look_aheads, int_t bufmax)
+{
+    int i, nbuf = 2 * (1 + num_look_aheads);
+    size_t size = SUPERLU_PACK_MAX((size_t) SUPERLU_MAX(bufmax, 1));
+    unsigned char **pack;
+
+    if ( !(pack = SUPERLU_MALLOC(nbuf * sizeof(unsigned char *))) ||
+	 !(pack[0] = SUPERLU_MALLOC(nbuf * size)) )
+	ABORT("Malloc fails for pack[].");
+    for (i = 1; i < nbuf; ++i) pack[i] = pack[0] + i * size;
+    return pack;
+}
+
+static void
+index_pack_free(unsigned char **pack)
+{
+    SUPERLU_FREE(pack[0]);
+    SUPERLU_FREE(pack);
+}
+
+/*! \brief The message of the index sub[] of cnt entries of a panel sent
+ * from the slot look_id: sub[] itself, or its encoding in the slot if
+ * pack is not NULL.
+ */
+static void *
+index_msg(int_t *sub, int cnt, unsigned char **pack, int look_id,
+	  int *msgcnt, MPI_Datatype *type)
+{
+    if ( !pack ) {
+	*msgcnt = cnt;
+	*type = mpi_int_t;
+	return sub;
+    }
+    *msgcnt = superlu_pack_index(cnt, sub, pack[2 * look_id]);
+    *type = MPI_BYTE;
+    return pack[2 * look_id];
+}
+
+/*! \brief The buffer, count and type of the receive of a panel index
+ * into sub_buf[] of bufmax entries in the slot look_id.
+ */
+static void *
+index_recv_buf(int_t *sub_buf, int bufmax, unsigned char **pack,
+	       int look_id, int *cnt, MPI_Datatype *type)
+{
+    if ( !pack ) {
+	*cnt = bufmax;
+	*type = mpi_int_t;
+	return sub_buf;
+    }
+    *cnt = SUPERLU_PACK_MAX(bufmax);
+    *type = MPI_BYTE;
+    return pack[2 * look_id + 1];
+}
+
+/*! \brief The number of entries of the panel index received, decoded
+ * into sub_buf[] if it was encoded.
+ */
+static int
+index_recv_count(MPI_Status *status, int_t *sub_buf, unsigned char **pack,
+		 int look_id)
+{
+    int cnt;
+
+    if ( !pack ) {
+	MPI_Get_count(status, mpi_int_t, &cnt);
+	return cnt;
+    }
+    MPI_Get_count(status, MPI_BYTE, &cnt);
+    return (int) superlu_unpack_index(cnt, pack[2 * look_id + 1], sub_buf);
+}
 
 
+/* Bits of the columns of a block U(k,j) per entry of a folded index. */
+#define UFOLD_BITS      (8 * (int) sizeof(int_t) - 1)
+#define UFOLD_WORDS(nc) (((nc) + UFOLD_BITS - 1) / UFOLD_BITS)
+
+/*! \brief The index of U(k,:) to send with options->SymPattern.
+ *
+ * <pre>
+ * A column of a block U(k,j) is full, its first nonzero being the first
+ * row of block k, or empty; with a symmetric pattern, the full columns
+ * are the rows of L(j,k). Each block is then sent as its number, its
+ * number of values and one bit per column, rather than the first
+ * nonzero of each column. The folded index is written in buf[], of at
+ * least usub[2] entries, with usub[2] replaced by -1 - usub[2]; *cnt is
+ * set to its length. usub is returned as is, and *cnt left unchanged, if
+ * buf is NULL or a column is neither full nor empty.
+ * </pre>
+ */
+static int_t *
+uindex_fold(int_t *usub, int_t k, int_t *xsup, int_t *buf, int *cnt)
+{
+    int_t fst = FstBlockC( k ), lst = FstBlockC( k+1 );
+    int_t b, pos, m, gb, nc, jj, f;
+
+    if ( !buf || !usub ) return usub;
+    buf[0] = usub[0];
+    buf[1] = usub[1];
+    buf[2] = -1 - usub[2];
+    for (b = 0, pos = m = BR_HEADER; b < usub[0]; ++b) {
+	gb = usub[pos];
+	nc = SuperSize( gb );
+	buf[m] = gb;
+	buf[m+1] = usub[pos+1];
+	for (jj = 0; jj < UFOLD_WORDS(nc); ++jj) buf[m+2+jj] = 0;
+	for (jj = 0; jj < nc; ++jj) {
+	    f = usub[pos + UB_DESCRIPTOR + jj];
+	    if ( f == fst ) buf[m + 2 + jj / UFOLD_BITS] |= (int_t) 1 << (jj % UFOLD_BITS);
+	    else if ( f != lst ) return usub;
+	}
+	m += 2 + UFOLD_WORDS(nc);
+	pos += UB_DESCRIPTOR + nc;
+    }
+    *cnt = m;
+    return buf;
+}
+
+/*! \brief Expand in place the index of U(k,:) received in usub[], of cnt
+ * entries, if it was folded by uindex_fold(); msg[] is a scratch of at
+ * least cnt entries.
+ */
+static void
+uindex_unfold(int_t *usub, int cnt, int_t k, int_t *xsup, int_t *msg)
+{
+    int_t fst = FstBlockC( k ), lst = FstBlockC( k+1 );
+    int_t b, pos, m, gb, nc, jj;
+
+    if ( cnt < BR_HEADER || usub[2] >= 0 ) return;
+    for (m = 0; m < cnt; ++m) msg[m] = usub[m];
+    usub[2] = -1 - msg[2];
+    for (b = 0, pos = m = BR_HEADER; b < msg[0]; ++b) {
+	gb = msg[m];
+	nc = SuperSize( gb );
+	usub[pos] = gb;
+	usub[pos+1] = msg[m+1];
+	for (jj = 0; jj < nc; ++jj)
+	    usub[pos + UB_DESCRIPTOR + jj] =
+		(msg[m + 2 + jj / UFOLD_BITS] >> (jj % UFOLD_BITS)) & 1 ? fst : lst;
+	m += 2 + UFOLD_WORDS(nc);
+	pos += UB_DESCRIPTOR + nc;
+    }
+}
+
 /*! \brief
  *
  * <pre>
@@ -238,6 +782,8 @@ superlu_sort_perm (const void *arg1, const void *arg2)
  *             been completed, but the factor U is exactly singular,
  *             and division by zero will occur if it is used to solve a
  *             system of equations.
+ *        > n: the buffers do not fit in options->MemBudget; info - n is
+ *             the number of megabytes missing. Nothing is factored.
  * </pre>
  */
 int_t
@@ -262,6 +808,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     int_t Pc, Pr;
     int iam, kcol, krow, yourcol, mycol, myrow, pi, pj;
     int j, k, lk, nsupers;  /* k - current panel to work on */
+    int nfact;     /* number of panels to factor */
     int k0;        /* counter of the next supernode to be factored */
     int kk, kk0, kk1, kk2, jj0; /* panels in the look-ahead window */
     int iukp0, rukp0, flag0, flag1;
@@ -273,6 +820,8 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     double *nzval;
     double *ucol;
     int *indirect, *indirect2;
+    superlu_arena_t arena; /* work arrays of the factorization */
+    size_t arena_size;
     int_t *tempi;
     double *tempu, *tempv, *tempr;
     /*    double *tempv2d, *tempU2d;  Sherry */
@@ -305,6 +854,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     etree_node *head, *tail, *ptr;
     int *num_child;
     int num_look_aheads, look_id;
+    int_t u_chunk = 0; /* columns of U(k,:) per update, see dmem_budget() */
     int *look_ahead; /* global look_ahead table */
     int_t *perm_c_supno, *iperm_c_supno;
           /* perm_c_supno[k] = j means at the k-th step of elimination,
@@ -312,6 +862,26 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     MPI_Request *recv_req, **recv_reqs, **send_reqs, **send_reqs_u,
         **recv_reqs_u;
     MPI_Request *send_req, *U_diag_blk_send_req = NULL;
+    panel_rma_t Lrma, Urma;   /* options->Fact_Comm = SLU_COMM_RMA */
+    int_t rma_inL[MAX_LOOKAHEADS]; /* step of the L panel pulled in a buffer */
+    int use_rma = 0;
+    int sync_comm = (options->Fact_Comm == SLU_COMM_SYNC); /* MPI_Send */
+    int comm_threads = 0;     /* options->Fact_Comm = SLU_COMM_THREADS */
+    MPI_Comm *slot_comm = NULL; /* row and column comms of each slot */
+    double poll_last = 0.;    /* see poll_lookahead() */
+#ifdef _OPENMP
+    omp_lock_t poll_lock;
+#endif
+    char *ooc_done = NULL; /* options->OutOfCore, see dooc_retire() */
+    char *sn_dirty = Llu->sn_dirty; /* see SN_CLEAN() */
+    int_t ooc_next[2] = {0, 0};
+    unsigned char **Lpack = NULL, **Upack = NULL; /* Panel_Compress */
+    int_t *Ufold = NULL; /* options->SymPattern, see uindex_fold() */
+    int_t ldfold = 0;    /* length of a slot of Ufold[] */
+    int_t *usub_msg;
+    void *imsg, *ibuf;
+    int icnt;
+    MPI_Datatype itype;
     MPI_Status status;
     void *attr_val;
     int flag;
@@ -401,6 +971,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     if (m == 0 || n == 0) return 0;
 
     double tt1 = SuperLU_timer_ ();
+    double t_trace;
 
     /*
      * Initialization.
@@ -412,6 +983,14 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     mycol = MYCOL (iam, grid);
     nsupers = Glu_persist->supno[n - 1] + 1;
     xsup = Glu_persist->xsup;
+    /* With options->SchurSize > 0, the supernodes of the trailing
+       SchurSize columns only receive the updates of the others and are
+       left unfactored (see pdGetSchur()). With options->DenseRoot_Tol > 0,
+       the supernodes of the dense root are factored after the main loop by
+       pdgstrf_root(). */
+    nfact = options->SchurSize > 0 ? Glu_persist->supno[n - options->SchurSize]
+                                   : pdgstrf_root_start(options, n, Glu_persist,
+                                                        grid, Llu);
     s_eps = smach_dist("Epsilon");
     thresh = s_eps * anorm;
 
@@ -445,7 +1024,27 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     stat->gpu_buffer     = 0.0;
 
     /* make sure the range of look-ahead window [0, MAX_LOOKAHEADS-1] */
-    num_look_aheads = SUPERLU_MAX(0, SUPERLU_MIN(options->num_lookaheads, MAX_LOOKAHEADS - 1));
+    if ( options->Fact_Comm == SLU_COMM_SYNC )
+        num_look_aheads = 0;
+    else if ( options->num_lookaheads < 0 )
+        num_look_aheads = adaptive_lookaheads(nsupers, Llu, grid);
+    else
+        num_look_aheads = SUPERLU_MAX(0, SUPERLU_MIN(options->num_lookaheads, MAX_LOOKAHEADS - 1));
+#if ( PRNTlevel>=1 )
+    if ( !iam && options->num_lookaheads < 0 )
+        printf(".. adaptive look-ahead depth %d\n", num_look_aheads);
+#endif
+
+    if ( options->MemBudget > 0.0 ) {
+	i = dmem_budget(options, n, LUstruct, grid, &num_look_aheads, &u_chunk);
+	if ( i ) { /* The buffers do not fit even at the smallest. */
+	    if ( !iam )
+		fprintf(stderr, "pdgstrf: MemBudget %g MB is short of %d MB\n",
+			options->MemBudget, (int) i);
+	    *info = n + i;
+	    return 0;
+	}
+    }
 
     if (Pr * Pc > 1) {
         if (!(U_diag_blk_send_req =
@@ -457,7 +1056,8 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         /* allocating buffers for look-ahead */
         i = Llu->bufmax[0];
         if (i != 0) {
-            if ( !(Llu->Lsub_buf_2[0] = intMalloc_dist ((num_look_aheads + 1) * ((size_t) i))) )
+            if ( !(Llu->Lsub_buf_2[0] = (int_t *) superlu_malloc_comm
+                   ((num_look_aheads + 1) * (size_t) i * iword)) )
                 ABORT ("Malloc fails for Lsub_buf.");
 	    tempi = Llu->Lsub_buf_2[0];
             for (jj = 0; jj < num_look_aheads; jj++)
@@ -466,7 +1066,8 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }
         i = Llu->bufmax[1];
         if (i != 0) {
-            if (!(Llu->Lval_buf_2[0] = doubleMalloc_dist ((num_look_aheads + 1) * ((size_t) i))))
+            if (!(Llu->Lval_buf_2[0] = (double *) superlu_malloc_comm
+                  ((num_look_aheads + 1) * (size_t) i * dword)))
                 ABORT ("Malloc fails for Lval_buf[].");
 	    tempr = Llu->Lval_buf_2[0];
             for (jj = 0; jj < num_look_aheads; jj++)
@@ -475,7 +1076,8 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }
         i = Llu->bufmax[2];
         if (i != 0) {
-            if (!(Llu->Usub_buf_2[0] = intMalloc_dist ((num_look_aheads + 1) * i)))
+            if (!(Llu->Usub_buf_2[0] = (int_t *) superlu_malloc_comm
+                  ((num_look_aheads + 1) * (size_t) i * iword)))
                 ABORT ("Malloc fails for Usub_buf_2[].");
 	    tempi = Llu->Usub_buf_2[0];
             for (jj = 0; jj < num_look_aheads; jj++)
@@ -484,7 +1086,8 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }
         i = Llu->bufmax[3];
         if (i != 0) {
-            if (!(Llu->Uval_buf_2[0] = doubleMalloc_dist ((num_look_aheads + 1) * i)))
+            if (!(Llu->Uval_buf_2[0] = (double *) superlu_malloc_comm
+                  ((num_look_aheads + 1) * (size_t) i * dword)))
                 ABORT ("Malloc fails for Uval_buf_2[].");
 	    tempr = Llu->Uval_buf_2[0];
             for (jj = 0; jj < num_look_aheads; jj++)
@@ -542,8 +1145,10 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
             ABORT ("Malloc fails for send_reqs[i].");
         if (!(recv_reqs[i] = (MPI_Request *) SUPERLU_MALLOC (4 * sizeof (MPI_Request))))
             ABORT ("Malloc fails for recv_req[].");
-        send_reqs[i][0] = send_reqs[i][1] = MPI_REQUEST_NULL;
+        for (j = 0; j < 2 * Pc; ++j) send_reqs[i][j] = MPI_REQUEST_NULL;
+        for (j = 0; j < 2 * Pr; ++j) send_reqs_u[i][j] = MPI_REQUEST_NULL;
         recv_reqs[i][0] = recv_reqs[i][1] = MPI_REQUEST_NULL;
+        recv_reqs_u[i][0] = recv_reqs_u[i][1] = MPI_REQUEST_NULL;
     }
 
     if (!(factored = SUPERLU_MALLOC (nsupers * sizeof (int_t))))
@@ -554,14 +1159,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 
     log_memory(2 * nsupers * iword, stat);
 
-    int num_threads = 1;
-#ifdef _OPENMP
-#pragma omp parallel default(shared)
-    #pragma omp master
-    {
-        num_threads = omp_get_num_threads ();
-    }
-#endif
+    int num_threads = superlu_num_threads();
 
 #if 0
     omp_loop_time = (double *) _mm_malloc (sizeof (double) * num_threads,64);
@@ -572,6 +1170,11 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #if ( PRNTlevel>=1 )
     if(!iam) {
        printf(".. Starting with %d OpenMP threads \n", num_threads );
+#ifdef _OPENMP
+       if ( num_threads > 1 && omp_get_proc_bind() == omp_proc_bind_false )
+           printf(".. OpenMP threads are not bound (OMP_PROC_BIND), "
+                  "the work arrays may be on a remote NUMA domain\n");
+#endif
        fflush(stdout);
     }
 #endif
@@ -612,6 +1215,17 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     dstatic_schedule(options, m, n, LUstruct, grid, stat,
 		    perm_c_supno, iperm_c_supno, info);
 
+    if ( nfact < nsupers ) {
+        /* No interior panel depends on the unfactored ones, which are
+           moved to the end of the schedule. */
+        for (i = 0, j = 0; i < nsupers; ++i)
+            if ( perm_c_supno[i] < nfact ) iperm_c_supno[j++] = perm_c_supno[i];
+        for (i = 0; i < nsupers; ++i)
+            if ( perm_c_supno[i] >= nfact ) iperm_c_supno[j++] = perm_c_supno[i];
+        for (i = 0; i < nsupers; ++i) perm_c_supno[i] = iperm_c_supno[i];
+        for (i = 0; i < nsupers; ++i) iperm_c_supno[perm_c_supno[i]] = i;
+    }
+
 #if ( DEBUGlevel >= 2 )
     PrintInt10("schedule:perm_c_supno", nsupers, perm_c_supno);
 
@@ -797,6 +1411,11 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     	                                  grid, perm_u, &max_ncols );
 #endif
 
+    if ( u_chunk > 0 ) { /* U(k,:) is updated by chunks, see dmem_budget() */
+	bigu_size = bigu_size / max_ncols * u_chunk;
+	max_ncols = u_chunk;
+    }
+
     /* +16 to avoid cache line false sharing */
     // int_t bigv_size = SUPERLU_MAX(max_row_size * (bigu_size / ldt),
     int_t bigv_size = SUPERLU_MAX(max_row_size * max_ncols,
@@ -897,16 +1516,11 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 //#ifdef __INTEL_COMPILER
 //    bigU = _mm_malloc(bigu_size * sizeof(double), 1<<12); // align at 4K page
 //    bigV = _mm_malloc(bigv_size * sizeof(double), 1<<12);
-//#else
-    if ( !(bigU = doubleMalloc_dist(bigu_size)) )
-        ABORT ("Malloc fails for dgemm U buffer");
-    if ( !(bigV = doubleMalloc_dist(bigv_size)) )
-        ABORT ("Malloc failed for dgemm V buffer");
 //#endif
-
-#endif /* end ifdef GPU_ACC */
+    /* bigU and bigV are taken from the arena below. */
 
     log_memory((bigv_size + bigu_size) * dword, stat);
+#endif /* end ifdef GPU_ACC */
 
     // mlock(bigU,(bigu_size) * sizeof (double));
 
@@ -919,72 +1533,141 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 
 #endif
 
+    int_t mrb = (nsupers + Pr - 1) / Pr;
+    int_t mcb = (nsupers + Pc - 1) / Pc;
+
     /* Sherry: (ldt + 16), avoid cache line false sharing.
        KNL cacheline size = 64 bytes = 16 int */
     iinfo = ldt + CACHELINE / sizeof(int);
-    if (!(indirect = SUPERLU_MALLOC (iinfo * num_threads * sizeof(int))))
-        ABORT ("Malloc fails for indirect[].");
-    if (!(indirect2 = SUPERLU_MALLOC (iinfo * num_threads * sizeof(int))))
-        ABORT ("Malloc fails for indirect[].");
+    j = gemm_m_pad * (ldt + max_row_size + gemm_k_pad);
 
-    log_memory(2 * ldt*ldt * dword + 2 * iinfo * num_threads * iword, stat);
+    /* The work arrays below are used until the end of the factorization
+       and are all taken from one arena. The last 3 * mcb integers are the
+       scratch space of pdgstrs2_omp(), released after each U panel. */
+    arena_size = 2 * superlu_arena_bytes(iinfo * num_threads * sizeof(int))
+	+ 4 * superlu_arena_bytes((num_look_aheads + 1) * iword)
+	+ 3 * superlu_arena_bytes(mrb * iword)
+	+ superlu_arena_bytes(mrb * sizeof(Remain_info_t))
+	+ 2 * superlu_arena_bytes(mrb * iword) + 2 * superlu_arena_bytes(mcb * iword)
+	+ superlu_arena_bytes((size_t) ldt * ldt * (num_look_aheads + 1) * dword)
+	+ superlu_arena_bytes((size_t) (Llu->bufmax[1] + j) * dword) /* This is loose */
+	+ superlu_arena_bytes(mcb * sizeof(Ublock_info_t))
+	+ superlu_arena_bytes(3 * mcb * sizeof(int));
+#ifndef GPU_ACC
+    arena_size += superlu_arena_bytes((size_t) bigu_size * dword)
+	+ superlu_arena_bytes((size_t) bigv_size * dword);
+#endif
+    superlu_arena_init(&arena, arena_size);
+    log_memory(arena.size, stat);
+
+#ifndef GPU_ACC
+    bigU = (double *) superlu_arena_alloc(&arena, (size_t) bigu_size * dword);
+    bigV = (double *) superlu_arena_alloc(&arena, (size_t) bigv_size * dword);
+#endif
+    indirect = (int *) superlu_arena_alloc(&arena, iinfo * num_threads * sizeof(int));
+    indirect2 = (int *) superlu_arena_alloc(&arena, iinfo * num_threads * sizeof(int));
+#ifndef GPU_ACC
+    first_touch_scratch(num_threads, indirect, indirect2, iinfo,
+                        bigV, bigv_size, ldt, bigU, bigu_size);
+#endif
 
     int_t *lookAheadFullRow,*lookAheadStRow,*lookAhead_lptr,*lookAhead_ib,
-          *RemainStRow,*Remain_lptr,*Remain_ib;
-
-    lookAheadFullRow   = intMalloc_dist( (num_look_aheads+1) );
-    lookAheadStRow     = intMalloc_dist( (num_look_aheads+1) );
-    lookAhead_lptr     = intMalloc_dist( (num_look_aheads+1) );
-    lookAhead_ib       = intMalloc_dist( (num_look_aheads+1) );
+          *RemainStRow;
 
-    int_t mrb = (nsupers + Pr - 1) / Pr;
-    int_t mcb = (nsupers + Pc - 1) / Pc;
+    lookAheadFullRow = (int_t *) superlu_arena_alloc(&arena, (num_look_aheads+1) * iword);
+    lookAheadStRow   = (int_t *) superlu_arena_alloc(&arena, (num_look_aheads+1) * iword);
+    lookAhead_lptr   = (int_t *) superlu_arena_alloc(&arena, (num_look_aheads+1) * iword);
+    lookAhead_ib     = (int_t *) superlu_arena_alloc(&arena, (num_look_aheads+1) * iword);
 
-    RemainStRow     = intMalloc_dist(mrb);
-#if 0
-    Remain_lptr     = (int *) _mm_malloc(sizeof(int)*mrb,1);
-#else
-    Remain_lptr     = intMalloc_dist(mrb);
-#endif
-    // mlock(Remain_lptr, sizeof(int)*mrb );
-    Remain_ib       = intMalloc_dist(mrb);
+    RemainStRow  = (int_t *) superlu_arena_alloc(&arena, mrb * iword);
 
     Remain_info_t *Remain_info;
-#if 0
-    Remain_info = (Remain_info_t *) _mm_malloc(mrb*sizeof(Remain_info_t),64);
-#else
-    Remain_info = (Remain_info_t *) SUPERLU_MALLOC(mrb*sizeof(Remain_info_t));
-#endif
+    Remain_info = (Remain_info_t *) superlu_arena_alloc(&arena, mrb * sizeof(Remain_info_t));
+
+    /* Order in which the Schur complement tiles L(i,k)*U(k,j) are handed
+       to the threads: the largest first (see dSchCompUdt-2Ddynamic.c). */
+    int_t *Remain_key, *Remain_order, *Ublock_key, *Ublock_order;
+    Remain_key   = (int_t *) superlu_arena_alloc(&arena, mrb * iword);
+    Remain_order = (int_t *) superlu_arena_alloc(&arena, mrb * iword);
+    Ublock_key   = (int_t *) superlu_arena_alloc(&arena, mcb * iword);
+    Ublock_order = (int_t *) superlu_arena_alloc(&arena, mcb * iword);
 
     double *lookAhead_L_buff, *Remain_L_buff; /* Stores entire L-panel */
     Ublock_info_t *Ublock_info;
-    ldt = sp_ienv_dist (3); /* max supernode size */
     /* The following is quite loose */
-    lookAhead_L_buff = doubleMalloc_dist(ldt*ldt* (num_look_aheads+1) );
-
-#if 0
-    Remain_L_buff = (double *) _mm_malloc( sizeof(double)*(Llu->bufmax[1]),64);
-    Ublock_info = (Ublock_info_t *) _mm_malloc(mcb*sizeof(Ublock_info_t),64);
-    /*int * Ublock_info_iukp = (int *) _mm_malloc(mcb*sizeof(int),64);
-      int * Ublock_info_rukp = (int *) _mm_malloc(mcb*sizeof(int),64);
-      int * Ublock_info_jb = (int *) _mm_malloc(mcb*sizeof(int),64); */
-#else
-    j = gemm_m_pad * (ldt + max_row_size + gemm_k_pad);
-    Remain_L_buff = doubleMalloc_dist(Llu->bufmax[1] + j); /* This is loose */
-    Ublock_info = (Ublock_info_t *) SUPERLU_MALLOC(mcb*sizeof(Ublock_info_t));
-    /*int *Ublock_info_iukp = (int *) SUPERLU_MALLOC(mcb*sizeof(int));
-      int *Ublock_info_rukp = (int *) SUPERLU_MALLOC(mcb*sizeof(int));
-      int *Ublock_info_jb = (int *) SUPERLU_MALLOC(mcb*sizeof(int)); */
+    lookAhead_L_buff = (double *) superlu_arena_alloc(&arena,
+                           (size_t) ldt * ldt * (num_look_aheads + 1) * dword);
+    Remain_L_buff = (double *) superlu_arena_alloc(&arena, (size_t) (Llu->bufmax[1] + j) * dword);
+    Ublock_info = (Ublock_info_t *) superlu_arena_alloc(&arena, mcb * sizeof(Ublock_info_t));
+
+    /* The panels are pulled one-sided from the slabs of the values of L
+       and U, so the factors of all the processes must be in slabs. */
+    if ( options->Fact_Comm == SLU_COMM_RMA && Pr * Pc > 1 ) {
+        flag = (Llu->Lnzval_slab != NULL && Llu->Unzval_slab != NULL);
+        MPI_Allreduce(&flag, &use_rma, 1, MPI_INT, MPI_MIN, grid->comm);
+#if ( PRNTlevel>=1 )
+        if ( !iam && !use_rma )
+            printf(".. no slab storage of L and U, panels sent with MPI_Isend\n");
 #endif
-
-    long long alloc_mem = 3 * mrb * iword + mrb * sizeof(Remain_info_t)
-                        + ldt * ldt * (num_look_aheads+1) * dword
- 			+ Llu->bufmax[1] * dword ;
-    log_memory(alloc_mem, stat);
+    }
+    if ( use_rma ) {
+        panel_rma_init(&Lrma, 1, nsupers, xsup, grid->rscp.comm, mycol, Pc,
+                       Lrowind_bc_ptr, Lnzval_bc_ptr, Llu->Lnzval_slab);
+        panel_rma_init(&Urma, 0, nsupers, xsup, grid->cscp.comm, myrow, Pr,
+                       Ufstnz_br_ptr, Unzval_br_ptr, Llu->Unzval_slab);
+        for (i = 0; i <= num_look_aheads; ++i) rma_inL[i] = -1;
+    }
+    /* Each look-ahead slot has its own row and column communicators,
+       which the MPI libraries with several network contexts match
+       independently, and the threads of the Schur complement update test
+       the panel messages; needs MPI_THREAD_MULTIPLE on all the processes. */
+#ifdef _OPENMP
+    if ( options->Fact_Comm == SLU_COMM_THREADS && Pr * Pc > 1 ) {
+        MPI_Query_thread(&flag);
+        flag = (flag == MPI_THREAD_MULTIPLE);
+        MPI_Allreduce(&flag, &comm_threads, 1, MPI_INT, MPI_MIN, grid->comm);
+#if ( PRNTlevel>=1 )
+        if ( !iam && !comm_threads )
+            printf(".. MPI_THREAD_MULTIPLE not provided, panels sent as with SLU_COMM_IRECV\n");
+#endif
+    }
+    if ( comm_threads ) {
+        if ( !(slot_comm = (MPI_Comm *) SUPERLU_MALLOC(2 * (1 + num_look_aheads)
+                                                       * sizeof(MPI_Comm))) )
+            ABORT ("Malloc fails for slot_comm[].");
+        for (i = 0; i <= num_look_aheads; ++i) {
+            MPI_Comm_dup(grid->rscp.comm, &slot_comm[2 * i]);
+            MPI_Comm_dup(grid->cscp.comm, &slot_comm[2 * i + 1]);
+        }
+        omp_init_lock(&poll_lock);
+    }
+#endif
+    if ( options->Panel_Compress == YES && Pr * Pc > 1 && !use_rma ) {
+        Lpack = index_pack_alloc(num_look_aheads, Llu->bufmax[0]);
+        Upack = index_pack_alloc(num_look_aheads, Llu->bufmax[2]);
+    }
+    /* A slot for each look-ahead, and a scratch for the receives. */
+    if ( options->SymPattern == YES && Pr > 1 && !use_rma ) {
+        ldfold = SUPERLU_MAX(Llu->bufmax[2], 1);
+        if ( !(Ufold = intMalloc_dist((2 + num_look_aheads) * ldfold)) )
+            ABORT ("Malloc fails for Ufold[].");
+    }
 
     InitTimer = SuperLU_timer_() - tt1;
 
+    superlu_trace_init(grid, stat);
+    superlu_histo_supernodes(stat, nsupers, xsup);
+    /* Drives the panel sends while the threads update, if requested. */
+    superlu_progress_t *progress = superlu_progress_start(grid);
+    /* One BLAS thread in the parallel regions; see superlu_blas_threads.c */
+    int blas_threads = superlu_blas_set_threads(1);
+    stat->fact_sent = stat->fact_recv = stat->fact_wait = 0.;
+    stat->fact_dropped = 0.;
+    superlu_sncost_start(options, stat, nsupers);
+    Llu->droptol = SUPERLU_MAX(options->ILU_DropTol, 0.0);
     double pxgstrfTimer = SuperLU_timer_();
+    superlu_hwc_begin(stat, HWC_FACT);
+    SUPERLU_PROF_BEGIN(PROF_FACT, EMPTY);
 
     /* ##################################################################
        ** Handle first block column separately to start the pipeline. **
@@ -1002,10 +1685,12 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         double ttt1 = SuperLU_timer_();
 
 	/* panel factorization */
-        PDGSTRF2 (options, k0, k, thresh, Glu_persist, grid, Llu,
-                  U_diag_blk_send_req, tag_ub, stat, info);
+        if ( !SN_CLEAN(k) )
+            PDGSTRF2 (options, k0, k, thresh, Glu_persist, grid, Llu,
+                      U_diag_blk_send_req, tag_ub, stat, info);
 
         pdgstrf2_timer += SuperLU_timer_()-ttt1;
+        superlu_trace_event(stat, TRACE_PANEL_L, k, ttt1);
 
         scp = &grid->rscp;      /* The scope of process row. */
 
@@ -1022,18 +1707,32 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
             msgcnt[0] = msgcnt[1] = 0;
         }
 
+        if ( use_rma ) panel_rma_ready(&Lrma, mycol, lk);
+        imsg = index_msg(lsub, msgcnt[0], Lpack, look_id, &icnt, &itype);
         for (pj = 0; pj < Pc; ++pj) {
-            if (ToSendR[lk][pj] != EMPTY) {
+            if (!use_rma && ToSendR[lk][pj] != EMPTY) {
 #if ( PROFlevel>=1 )
                 TIC (t1);
 #endif
 
-                MPI_Isend (lsub, msgcnt[0], mpi_int_t, pj,
-                           SLU_MPI_TAG (0, 0) /* 0 */,
-                           scp->comm, &send_req[pj]);
-                MPI_Isend (lusup, msgcnt[1], MPI_DOUBLE, pj,
-                           SLU_MPI_TAG (1, 0) /* 1 */,
-                           scp->comm, &send_req[pj + Pc]);
+                t_trace = TRACE_TIME(stat);
+                if ( sync_comm ) { /* see SLU_COMM_SYNC */
+                    MPI_Send (imsg, icnt, itype, pj,
+                              SLU_MPI_TAG (0, 0) /* 0 */,
+                              PANEL_COMM (scp, 0));
+                    MPI_Send (lusup, msgcnt[1], MPI_DOUBLE, pj,
+                              SLU_MPI_TAG (1, 0) /* 1 */,
+                              PANEL_COMM (scp, 0));
+                } else {
+                    MPI_Isend (imsg, icnt, itype, pj,
+                               SLU_MPI_TAG (0, 0) /* 0 */,
+                               PANEL_COMM (scp, 0), &send_req[pj]);
+                    MPI_Isend (lusup, msgcnt[1], MPI_DOUBLE, pj,
+                               SLU_MPI_TAG (1, 0) /* 1 */,
+                               PANEL_COMM (scp, 0), &send_req[pj + Pc]);
+                }
+                superlu_trace_event(stat, TRACE_SEND_L, k, t_trace);
+                stat->fact_sent += (double) msgcnt[0] * iword + msgcnt[1] * dword;
 #if ( DEBUGlevel>=2 )
                 printf ("[%d] first block cloumn Send L(:,%4d): lsub %4d, lusup %4d to Pc %2d\n",
                         iam, 0, msgcnt[0], msgcnt[1], pj);
@@ -1049,18 +1748,20 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #endif
             } /* end if */
         }  /* end for pj ... */
+        superlu_sncost_charge(stat, SNCOST_PANEL, k);
     } else {  /* Post immediate receives. */
-        if (ToRecv[k] >= 1) {   /* Recv block column L(:,0). */
+        if (!use_rma && ToRecv[k] >= 1) {   /* Recv block column L(:,0). */
             scp = &grid->rscp;  /* The scope of process row. */
 #if ( PROFlevel>=1 )
 	    TIC (t1);
 #endif
-            MPI_Irecv (Lsub_buf_2[0], Llu->bufmax[0], mpi_int_t, kcol,
+            ibuf = index_recv_buf(Lsub_buf_2[0], Llu->bufmax[0], Lpack, 0, &icnt, &itype);
+            MPI_Irecv (ibuf, icnt, itype, kcol,
                        SLU_MPI_TAG (0, 0) /* 0 */ ,
-                       scp->comm, &recv_req[0]);
+                       PANEL_COMM (scp, 0), &recv_req[0]);
             MPI_Irecv (Lval_buf_2[0], Llu->bufmax[1], MPI_DOUBLE, kcol,
                        SLU_MPI_TAG (1, 0) /* 1 */ ,
-                       scp->comm, &recv_req[1]);
+                       PANEL_COMM (scp, 0), &recv_req[1]);
 #if ( PROFlevel>=1 )
 	    TOC (t2, t1);
 	    stat->utime[COMM] += t2;
@@ -1073,19 +1774,20 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 
     /* post receive of first U-row */
     if (myrow != krow) {
-        if (ToRecv[k] == 2) {   /* Recv block row U(k,:). */
+        if (!use_rma && ToRecv[k] == 2) {   /* Recv block row U(k,:). */
             scp = &grid->cscp;  /* The scope of process column. */
             Usub_buf = Llu->Usub_buf_2[0];
             Uval_buf = Llu->Uval_buf_2[0];
 #if ( PROFlevel>=1 )
 	    TIC (t1);
 #endif
-            MPI_Irecv (Usub_buf, Llu->bufmax[2], mpi_int_t, krow,
+            ibuf = index_recv_buf(Usub_buf, Llu->bufmax[2], Upack, 0, &icnt, &itype);
+            MPI_Irecv (ibuf, icnt, itype, krow,
                        SLU_MPI_TAG (2, 0) /* 2%tag_ub */ ,
-                       scp->comm, &recv_reqs_u[0][0]);
+                       PANEL_COMM (scp, 0), &recv_reqs_u[0][0]);
             MPI_Irecv (Uval_buf, Llu->bufmax[3], MPI_DOUBLE, krow,
                        SLU_MPI_TAG (3, 0) /* 3%tag_ub */ ,
-                       scp->comm, &recv_reqs_u[0][1]);
+                       PANEL_COMM (scp, 0), &recv_reqs_u[0][1]);
 #if ( PROFlevel>=1 )
 	    TOC (t2, t1);
 	    stat->utime[COMM] += t2;
@@ -1094,11 +1796,22 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }
     }
 
+    /* The values of L and U in files are written out as the steps are
+       done with them. */
+    if ( Llu->Lnzval_ooc.base || Llu->Unzval_ooc.base ) {
+        superlu_ooc_rewind(&Llu->Lnzval_ooc);
+        superlu_ooc_rewind(&Llu->Unzval_ooc);
+        if ( !(ooc_done = (char *) SUPERLU_MALLOC(mcb + mrb)) )
+            ABORT("Malloc fails for ooc_done[].");
+        memset(ooc_done, 0, mcb + mrb);
+    }
+
     /* ##################################################################
        **** MAIN LOOP ****
        ################################################################## */
-    for (k0 = 0; k0 < nsupers; ++k0) {
+    for (k0 = 0; k0 < nfact; ++k0) {
         k = perm_c_supno[k0];
+        SUPERLU_PROF_BEGIN(PROF_STEP, k);
 
         /* ============================================ *
          * ======= look-ahead the new L columns ======= *
@@ -1106,10 +1819,10 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         /* tt1 = SuperLU_timer_(); */
         if (k0 == 0) { /* look-ahead all the columns in the window */
             kk1 = k0 + 1;
-            kk2 = SUPERLU_MIN (k0 + num_look_aheads, nsupers - 1);
+            kk2 = SUPERLU_MIN (k0 + num_look_aheads, nfact - 1);
         } else {  /* look-ahead one new column after the current window */
             kk1 = k0 + num_look_aheads;
-            kk2 = SUPERLU_MIN (kk1, nsupers - 1);
+            kk2 = SUPERLU_MIN (kk1, nfact - 1);
         }
 
         for (kk0 = kk1; kk0 <= kk2; kk0++) {
@@ -1127,10 +1840,12 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                     factored[kk] = 0; /* flag column kk as factored */
                     double ttt1 = SuperLU_timer_();
 
-                    PDGSTRF2 (options, kk0, kk, thresh, Glu_persist,
-                              grid, Llu, U_diag_blk_send_req, tag_ub, stat, info);
+                    if ( !SN_CLEAN(kk) )
+                        PDGSTRF2 (options, kk0, kk, thresh, Glu_persist,
+                                  grid, Llu, U_diag_blk_send_req, tag_ub, stat, info);
 
                      pdgstrf2_timer += SuperLU_timer_() - ttt1;
+                     superlu_trace_event(stat, TRACE_PANEL_L, kk, ttt1);
 
                     /* Multicasts numeric values of L(:,kk) to process rows. */
                     /* ttt1 = SuperLU_timer_(); */
@@ -1147,18 +1862,32 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                         msgcnt[1] = 0;
                     }
                     scp = &grid->rscp;  /* The scope of process row. */
+                    if ( use_rma ) panel_rma_ready(&Lrma, mycol, lk);
+                    imsg = index_msg(lsub1, msgcnt[0], Lpack, look_id, &icnt, &itype);
                     for (pj = 0; pj < Pc; ++pj) {
-                        if (ToSendR[lk][pj] != EMPTY) {
+                        if (!use_rma && ToSendR[lk][pj] != EMPTY) {
                             lusup1 = Lnzval_bc_ptr[lk];
 #if ( PROFlevel>=1 )
 			    TIC (t1);
 #endif
-                            MPI_Isend (lsub1, msgcnt[0], mpi_int_t, pj,
-                                       SLU_MPI_TAG (0, kk0),  /* (4*kk0)%tag_ub */
-                                       scp->comm, &send_req[pj]);
-                            MPI_Isend (lusup1, msgcnt[1], MPI_DOUBLE, pj,
-                                       SLU_MPI_TAG (1, kk0),  /* (4*kk0+1)%tag_ub */
-                                       scp->comm, &send_req[pj + Pc]);
+                            t_trace = TRACE_TIME(stat);
+                            if ( sync_comm ) { /* see SLU_COMM_SYNC */
+                                MPI_Send (imsg, icnt, itype, pj,
+                                          SLU_MPI_TAG (0, kk0),  /* (4*kk0)%tag_ub */
+                                          PANEL_COMM (scp, kk0));
+                                MPI_Send (lusup1, msgcnt[1], MPI_DOUBLE, pj,
+                                          SLU_MPI_TAG (1, kk0),  /* (4*kk0+1)%tag_ub */
+                                          PANEL_COMM (scp, kk0));
+                            } else {
+                                MPI_Isend (imsg, icnt, itype, pj,
+                                           SLU_MPI_TAG (0, kk0),  /* (4*kk0)%tag_ub */
+                                           PANEL_COMM (scp, kk0), &send_req[pj]);
+                                MPI_Isend (lusup1, msgcnt[1], MPI_DOUBLE, pj,
+                                           SLU_MPI_TAG (1, kk0),  /* (4*kk0+1)%tag_ub */
+                                           PANEL_COMM (scp, kk0), &send_req[pj + Pc]);
+                            }
+                            superlu_trace_event(stat, TRACE_SEND_L, kk, t_trace);
+                            stat->fact_sent += (double) msgcnt[0] * iword + msgcnt[1] * dword;
 #if ( PROFlevel>=1 )
 			    TOC (t2, t1);
 			    stat->utime[COMM] += t2;
@@ -1172,21 +1901,24 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                         }
                     }
                     /* stat->time9 += SuperLU_timer_() - ttt1; */
+                    superlu_sncost_charge(stat, SNCOST_PANEL, kk);
                 } else {     /* Post Recv of block column L(:,kk). */
                     /* double ttt1 = SuperLU_timer_(); */
-                    if (ToRecv[kk] >= 1) {
+                    if (!use_rma && ToRecv[kk] >= 1) {
                         scp = &grid->rscp;  /* The scope of process row. */
                         recv_req = recv_reqs[look_id];
 #if ( PROFlevel>=1 )
 			TIC (t1);
 #endif
-                        MPI_Irecv (Lsub_buf_2[look_id], Llu->bufmax[0],
-                                   mpi_int_t, kcol, SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
-                                   scp->comm, &recv_req[0]);
+                        ibuf = index_recv_buf(Lsub_buf_2[look_id], Llu->bufmax[0],
+                                              Lpack, look_id, &icnt, &itype);
+                        MPI_Irecv (ibuf, icnt,
+                                   itype, kcol, SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
+                                   PANEL_COMM (scp, kk0), &recv_req[0]);
                         MPI_Irecv (Lval_buf_2[look_id], Llu->bufmax[1],
                                    MPI_DOUBLE, kcol,
                                    SLU_MPI_TAG (1, kk0), /* (4*kk0+1)%tag_ub */
-                                   scp->comm, &recv_req[1]);
+                                   PANEL_COMM (scp, kk0), &recv_req[1]);
 #if ( PROFlevel>=1 )
 			TOC (t2, t1);
 			stat->utime[COMM] += t2;
@@ -1200,19 +1932,20 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
             /* Pre-post irecv for U-row look-ahead */
             krow = PROW (kk, grid);
             if (myrow != krow) {
-                if (ToRecv[kk] == 2) { /* post iRecv block row U(kk,:). */
+                if (!use_rma && ToRecv[kk] == 2) { /* post iRecv block row U(kk,:). */
                     scp = &grid->cscp;  /* The scope of process column. */
                     Usub_buf = Llu->Usub_buf_2[look_id];
                     Uval_buf = Llu->Uval_buf_2[look_id];
 #if ( PROFlevel>=1 )
 		    TIC (t1);
 #endif
-                    MPI_Irecv (Usub_buf, Llu->bufmax[2], mpi_int_t, krow,
+                    ibuf = index_recv_buf(Usub_buf, Llu->bufmax[2], Upack, look_id, &icnt, &itype);
+                    MPI_Irecv (ibuf, icnt, itype, krow,
                                SLU_MPI_TAG (2, kk0) /* (4*kk0+2)%tag_ub */ ,
-                               scp->comm, &recv_reqs_u[look_id][0]);
+                               PANEL_COMM (scp, kk0), &recv_reqs_u[look_id][0]);
                     MPI_Irecv (Uval_buf, Llu->bufmax[3], MPI_DOUBLE, krow,
                                SLU_MPI_TAG (3, kk0) /* (4*kk0+3)%tag_ub */ ,
-                               scp->comm, &recv_reqs_u[look_id][1]);
+                               PANEL_COMM (scp, kk0), &recv_reqs_u[look_id][1]);
 #if ( PROFlevel>=1 )
 		    TOC (t2, t1);
 		    stat->utime[COMM] += t2;
@@ -1229,7 +1962,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
          * ==== look-ahead the U rows    === *
          * ================================= */
         kk1 = k0;
-        kk2 = SUPERLU_MIN (k0 + num_look_aheads, nsupers - 1);
+        kk2 = SUPERLU_MIN (k0 + num_look_aheads, nfact - 1);
         for (kk0 = kk1; kk0 < kk2; kk0++) {
             kk = perm_c_supno[kk0]; /* order determined from static schedule */
             if (factoredU[kk0] != 1 && look_ahead[kk] < k0) {
@@ -1260,7 +1993,8 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                         if ( recv_req[0] != MPI_REQUEST_NULL ) {
                             MPI_Test (&recv_req[0], &flag0, &status);
                             if ( flag0 ) {
-                                MPI_Get_count (&status, mpi_int_t, &msgcnt[0]);
+                                msgcnt[0] = index_recv_count(&status, Lsub_buf_2[look_id],
+                                                             Lpack, look_id);
                                 recv_req[0] = MPI_REQUEST_NULL;
                             }
                         } else flag0 = 1;
@@ -1268,10 +2002,19 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                         if ( recv_req[1] != MPI_REQUEST_NULL ) {
                             MPI_Test (&recv_req[1], &flag1, &status);
                             if ( flag1 ) {
-                                MPI_Get_count (&status, mpi_int_t, &msgcnt[1]);
+                                MPI_Get_count (&status, MPI_DOUBLE, &msgcnt[1]);
                                 recv_req[1] = MPI_REQUEST_NULL;
                             }
                         } else flag1 = 1;
+
+                        if ( use_rma ) { /* pull L(:,kk) if it is ready */
+                            if ( rma_inL[look_id] != kk0
+                                 && panel_rma_get(&Lrma, kcol, LBj (kk, grid), 0,
+                                                  Lsub_buf_2[look_id],
+                                                  Lval_buf_2[look_id], msgcnt) )
+                                rma_inL[look_id] = kk0;
+                            flag0 = flag1 = (rma_inL[look_id] == kk0);
+                        }
 #if ( PROFlevel>=1 )
 			TOC (t2, t1);
 			stat->utime[COMM] += t2;
@@ -1294,11 +2037,13 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 /* #pragma omp parallel */ /* Sherry -- parallel done inside pdgstrs2 */
 #endif
 			{
-                            pdgstrs2_omp (kk0, kk, Glu_persist, grid, Llu,
-                                        Ublock_info, stat);
+                            if ( !SN_CLEAN(kk) )
+                                pdgstrs2_omp (kk0, kk, Glu_persist, grid, Llu,
+                                            Ublock_info, &arena, stat);
                         }
 
                         pdgstrs2_timer += SuperLU_timer_()-ttt2;
+                        superlu_trace_event(stat, TRACE_PANEL_U, kk, ttt2);
                         /* stat->time8 += SuperLU_timer_()-ttt2; */
 
                         /* Multicasts U(kk,:) to process columns. */
@@ -1312,19 +2057,26 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                             msgcnt[2] = msgcnt[3] = 0;
                         }
 
-                        if (ToSendD[lk] == YES) {
+                        if ( use_rma ) panel_rma_ready(&Urma, myrow, lk);
+                        usub_msg = uindex_fold(usub, kk, xsup, Ufold ?
+                                               &Ufold[look_id * ldfold] : NULL, &msgcnt[2]);
+                        imsg = index_msg(usub_msg, msgcnt[2], Upack, look_id, &icnt, &itype);
+                        if (!use_rma && ToSendD[lk] == YES) {
                             for (pi = 0; pi < Pr; ++pi) {
                                 if (pi != myrow) {
 #if ( PROFlevel>=1 )
                                     TIC (t1);
 #endif
 
-                                    MPI_Isend (usub, msgcnt[2], mpi_int_t, pi,
+                                    t_trace = TRACE_TIME(stat);
+                                    MPI_Isend (imsg, icnt, itype, pi,
                                                SLU_MPI_TAG (2, kk0), /* (4*kk0+2)%tag_ub */
-                                               scp->comm, &send_reqs_u[look_id][pi]);
+                                               PANEL_COMM (scp, kk0), &send_reqs_u[look_id][pi]);
                                     MPI_Isend (uval, msgcnt[3], MPI_DOUBLE,
                                                pi, SLU_MPI_TAG (3, kk0), /* (4*kk0+3)%tag_ub */
-                                               scp->comm, &send_reqs_u[look_id][pi + Pr]);
+                                               PANEL_COMM (scp, kk0), &send_reqs_u[look_id][pi + Pr]);
+                                    superlu_trace_event(stat, TRACE_SEND_U, kk, t_trace);
+                                    stat->fact_sent += (double) msgcnt[2] * iword + msgcnt[3] * dword;
 
 #if ( PROFlevel>=1 )
                                     TOC (t2, t1);
@@ -1341,6 +2093,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                         }       /* if ToSendD ... */
 
                         /* stat->time2 += SuperLU_timer_()-tt1; */
+                        superlu_sncost_charge(stat, SNCOST_PANEL, kk);
 
                     } /* end if myrow == krow */
                 } /* end if flag0 & flag1 ... */
@@ -1368,9 +2121,10 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #if ( PROFlevel>=1 )
 	    TIC(t1);
 #endif
+            t_trace = TRACE_TIME(stat);
             for (pj = 0; pj < Pc; ++pj) {
                 /* Wait for Isend to complete before using lsub/lusup buffer. */
-                if (ToSendR[lk][pj] != EMPTY) {
+                if (!use_rma && ToSendR[lk][pj] != EMPTY) {
                     MPI_Wait (&send_req[pj], &status);
                     MPI_Wait (&send_req[pj + Pc], &status);
                 }
@@ -1380,6 +2134,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 	    stat->utime[COMM] += t2;
 	    stat->utime[COMM_RIGHT] += t2;
 #endif
+            superlu_trace_event(stat, TRACE_WAIT_L, k, t_trace);
             lsub = Lrowind_bc_ptr[lk];
             lusup = Lnzval_bc_ptr[lk];
         } else {
@@ -1396,9 +2151,18 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #if ( PROFlevel>=1 )
                 TIC (t1);
 #endif
+                t_trace = SuperLU_timer_();
+                if ( use_rma && rma_inL[look_id] != k0 ) {
+                    /* not pulled in the look-ahead, counts as below */
+                    panel_rma_get(&Lrma, kcol, LBj (k, grid), 1,
+                                  Lsub_buf_2[look_id], Lval_buf_2[look_id],
+                                  msgcntsU[look_id]);
+                    rma_inL[look_id] = k0;
+                }
                 if (recv_req[0] != MPI_REQUEST_NULL) {
                     MPI_Wait (&recv_req[0], &status);
-                    MPI_Get_count (&status, mpi_int_t, &msgcnt[0]);
+                    msgcnt[0] = index_recv_count(&status, Lsub_buf_2[look_id],
+                                                 Lpack, look_id);
                     recv_req[0] = MPI_REQUEST_NULL;
                 } else {
                     msgcnt[0] = msgcntsU[look_id][0];
@@ -1425,6 +2189,9 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                 stat->utime[COMM] += t2;
                 stat->utime[COMM_RIGHT] += t2;
 #endif
+                stat->fact_wait += SuperLU_timer_() - t_trace;
+                stat->fact_recv += (double) msgcnt[0] * iword + msgcnt[1] * dword;
+                superlu_trace_event(stat, TRACE_WAIT_L, k, t_trace);
 #if ( DEBUGlevel>=2 )
                 printf("[%d] Recv L(:,%4d): #lsub %4d, #lusup %4d from Pc %2d\n",
                      iam, k, msgcnt[0], msgcnt[1], kcol);
@@ -1460,10 +2227,12 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 /* #pragma omp parallel */ /* Sherry -- parallel done inside pdgstrs2 */
 #endif
                 {
-                    pdgstrs2_omp (k0, k, Glu_persist, grid, Llu, 
-		                    Ublock_info, stat);
+                    if ( !SN_CLEAN(k) )
+                        pdgstrs2_omp (k0, k, Glu_persist, grid, Llu,
+                                    Ublock_info, &arena, stat);
                 }
                 pdgstrs2_timer += SuperLU_timer_() - ttt2;
+                superlu_trace_event(stat, TRACE_PANEL_U, k, ttt2);
 
 	        /* Sherry -- need to set factoredU[k0] = 1; ?? */
 
@@ -1475,18 +2244,25 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                     msgcnt[2] = msgcnt[3] = 0;
                 }
 
-                if (ToSendD[lk] == YES) {
+                if ( use_rma ) panel_rma_ready(&Urma, myrow, lk);
+                usub_msg = uindex_fold(usub, k, xsup, Ufold ?
+                                       &Ufold[look_id * ldfold] : NULL, &msgcnt[2]);
+                imsg = index_msg(usub_msg, msgcnt[2], Upack, look_id, &icnt, &itype);
+                if (!use_rma && ToSendD[lk] == YES) {
                     for (pi = 0; pi < Pr; ++pi) {
                         if (pi != myrow) { /* Matching recv was pre-posted before */
 #if ( PROFlevel>=1 )
                             TIC (t1);
 #endif
-                            MPI_Send (usub, msgcnt[2], mpi_int_t, pi,
+                            t_trace = TRACE_TIME(stat);
+                            MPI_Send (imsg, icnt, itype, pi,
                                       SLU_MPI_TAG (2, k0), /* (4*k0+2)%tag_ub */
-                                      scp->comm);
+                                      PANEL_COMM (scp, k0));
                             MPI_Send (uval, msgcnt[3], MPI_DOUBLE, pi,
                                       SLU_MPI_TAG (3, k0), /* (4*k0+3)%tag_ub */
-                                      scp->comm);
+                                      PANEL_COMM (scp, k0));
+                            superlu_trace_event(stat, TRACE_SEND_U, k, t_trace);
+                            stat->fact_sent += (double) msgcnt[2] * iword + msgcnt[3] * dword;
 #if ( PROFlevel>=1 )
                             TOC (t2, t1);
                             stat->utime[COMM] += t2;
@@ -1500,6 +2276,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                         } /* if pi ... */
                     } /* for pi ... */
                 } /* if ToSendD ... */
+                superlu_sncost_charge(stat, SNCOST_PANEL, k);
 
             } else { /* Panel U(k,:) already factorized from previous look-ahead */
 
@@ -1508,10 +2285,11 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 		* for outer-product update.                        *
                 * ================================================ */
 
-                if (ToSendD[lk] == YES) {
+                if (!use_rma && ToSendD[lk] == YES) {
 #if ( PROFlevel>=1 )
 		    TIC (t1);
 #endif
+                    t_trace = TRACE_TIME(stat);
                     for (pi = 0; pi < Pr; ++pi) {
                         if (pi != myrow) {
                             MPI_Wait (&send_reqs_u[look_id][pi], &status);
@@ -1523,6 +2301,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 		    stat->utime[COMM] += t2;
 		    stat->utime[COMM_DOWN] += t2;
 #endif
+                    superlu_trace_event(stat, TRACE_WAIT_U, k, t_trace);
                 }
                 msgcnt[2] = msgcntsU[look_id][2];
                 msgcnt[3] = msgcntsU[look_id][3];
@@ -1539,16 +2318,28 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #if ( PROFlevel>=1 )
                 TIC (t1);
 #endif
-                MPI_Wait (&recv_reqs_u[look_id][0], &status);
-                MPI_Get_count (&status, mpi_int_t, &msgcnt[2]);
-                MPI_Wait (&recv_reqs_u[look_id][1], &status);
-                MPI_Get_count (&status, MPI_DOUBLE, &msgcnt[3]);
+                t_trace = SuperLU_timer_();
+                if ( use_rma ) {
+                    panel_rma_get(&Urma, krow, LBi (k, grid), 1,
+                                  Usub_buf, Uval_buf, &msgcnt[2]);
+                } else {
+                    MPI_Wait (&recv_reqs_u[look_id][0], &status);
+                    msgcnt[2] = index_recv_count(&status, Usub_buf, Upack, look_id);
+                    if ( Ufold )
+                        uindex_unfold(Usub_buf, msgcnt[2], k, xsup,
+                                      &Ufold[(1 + num_look_aheads) * ldfold]);
+                    MPI_Wait (&recv_reqs_u[look_id][1], &status);
+                    MPI_Get_count (&status, MPI_DOUBLE, &msgcnt[3]);
+                }
 
 #if ( PROFlevel>=1 )
                 TOC (t2, t1);
                 stat->utime[COMM] += t2;
                 stat->utime[COMM_DOWN] += t2;
 #endif
+                stat->fact_wait += SuperLU_timer_() - t_trace;
+                stat->fact_recv += (double) msgcnt[2] * iword + msgcnt[3] * dword;
+                superlu_trace_event(stat, TRACE_WAIT_U, k, t_trace);
                 usub = Usub_buf;
                 uval = Uval_buf;
 #if ( DEBUGlevel>=2 )
@@ -1617,8 +2408,7 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                perm_u reorders the U blocks to match the elimination order. */
             isort (nub, iperm_u, perm_u);
 #else
-            qsort (perm_u, (size_t) nub, 2 * sizeof (int_t),
-                   &superlu_sort_perm);
+            superlu_sort_pairs (nub, perm_u);
 #endif
 
 /************************************************************************/
@@ -1628,6 +2418,8 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #include "dlook_ahead_update.c"
 
             lookaheadupdatetimer += SuperLU_timer_() - ttx;
+            superlu_sncost_charge(stat, SNCOST_SCHUR, k);
+            superlu_trace_event(stat, TRACE_LOOKAHEAD, k, ttx);
 /************************************************************************/
 
             /*ifdef OMP_LOOK_AHEAD */
@@ -1639,14 +2431,14 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         /* ================== */
         /* == post receive == */
         /* ================== */
-        kk1 = SUPERLU_MIN (k0 + num_look_aheads, nsupers - 1);
+        kk1 = SUPERLU_MIN (k0 + num_look_aheads, nfact - 1);
         for (kk0 = k0 + 1; kk0 <= kk1; kk0++) {
             kk = perm_c_supno[kk0];
             kcol = PCOL (kk, grid);
 
             if (look_ahead[kk] == k0) {
                 if (mycol != kcol) {
-                    if (ToRecv[kk] >= 1) {
+                    if (!use_rma && ToRecv[kk] >= 1) {
                         scp = &grid->rscp;  /* The scope of process row. */
 
                         look_id = kk0 % (1 + num_look_aheads);
@@ -1654,13 +2446,15 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #if ( PROFlevel>=1 )
 			TIC (t1);
 #endif
-                        MPI_Irecv (Lsub_buf_2[look_id], Llu->bufmax[0],
-                                   mpi_int_t, kcol, SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
-                                   scp->comm, &recv_req[0]);
+                        ibuf = index_recv_buf(Lsub_buf_2[look_id], Llu->bufmax[0],
+                                              Lpack, look_id, &icnt, &itype);
+                        MPI_Irecv (ibuf, icnt,
+                                   itype, kcol, SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
+                                   PANEL_COMM (scp, kk0), &recv_req[0]);
                         MPI_Irecv (Lval_buf_2[look_id], Llu->bufmax[1],
                                    MPI_DOUBLE, kcol,
                                    SLU_MPI_TAG (1, kk0), /* (4*kk0+1)%tag_ub */
-                                   scp->comm, &recv_req[1]);
+                                   PANEL_COMM (scp, kk0), &recv_req[1]);
 #if ( PROFlevel>=1 )
 			TOC (t2, t1);
 			stat->utime[COMM] += t2;
@@ -1676,10 +2470,12 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 			   test for exact singularity.  */
                         factored[kk] = 0; /* flag column kk as factored */
                         double ttt1 = SuperLU_timer_();
-                        PDGSTRF2 (options, kk0, kk, thresh,
-                                  Glu_persist, grid, Llu, U_diag_blk_send_req,
-                                  tag_ub, stat, info);
+                        if ( !SN_CLEAN(kk) )
+                            PDGSTRF2 (options, kk0, kk, thresh,
+                                      Glu_persist, grid, Llu, U_diag_blk_send_req,
+                                      tag_ub, stat, info);
                         pdgstrf2_timer += SuperLU_timer_() - ttt1;
+                        superlu_trace_event(stat, TRACE_PANEL_L, kk, ttt1);
 
                         /* Process column *kcol+1* multicasts numeric
 			   values of L(:,k+1) to process rows. */
@@ -1696,17 +2492,31 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                         }
 
                         scp = &grid->rscp;  /* The scope of process row. */
+                        if ( use_rma ) panel_rma_ready(&Lrma, mycol, lk);
+                        imsg = index_msg(lsub1, msgcnt[0], Lpack, look_id, &icnt, &itype);
                         for (pj = 0; pj < Pc; ++pj) {
-                            if (ToSendR[lk][pj] != EMPTY) {
+                            if (!use_rma && ToSendR[lk][pj] != EMPTY) {
 #if ( PROFlevel>=1 )
 			       TIC (t1);
 #endif
-                                MPI_Isend (lsub1, msgcnt[0], mpi_int_t, pj,
-                                           SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
-                                           scp->comm, &send_req[pj]);
-                                MPI_Isend (lusup1, msgcnt[1], MPI_DOUBLE, pj,
-                                           SLU_MPI_TAG (1, kk0), /* (4*kk0+1)%tag_ub */
-                                           scp->comm, &send_req[pj + Pc]);
+                                t_trace = TRACE_TIME(stat);
+                                if ( sync_comm ) { /* see SLU_COMM_SYNC */
+                                    MPI_Send (imsg, icnt, itype, pj,
+                                              SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
+                                              PANEL_COMM (scp, kk0));
+                                    MPI_Send (lusup1, msgcnt[1], MPI_DOUBLE, pj,
+                                              SLU_MPI_TAG (1, kk0), /* (4*kk0+1)%tag_ub */
+                                              PANEL_COMM (scp, kk0));
+                                } else {
+                                    MPI_Isend (imsg, icnt, itype, pj,
+                                               SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
+                                               PANEL_COMM (scp, kk0), &send_req[pj]);
+                                    MPI_Isend (lusup1, msgcnt[1], MPI_DOUBLE, pj,
+                                               SLU_MPI_TAG (1, kk0), /* (4*kk0+1)%tag_ub */
+                                               PANEL_COMM (scp, kk0), &send_req[pj + Pc]);
+                                }
+                                superlu_trace_event(stat, TRACE_SEND_L, kk, t_trace);
+                                stat->fact_sent += (double) msgcnt[0] * iword + msgcnt[1] * dword;
 #if ( PROFlevel>=1 )
 				TOC (t2, t1);
 				stat->utime[COMM] += t2;
@@ -1715,12 +2525,19 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #endif
                             }
                         } /* end for pj ... */
+                        superlu_sncost_charge(stat, SNCOST_PANEL, kk);
                     } /* if    factored[kk] ... */
                 }
             }
         }
 
+        if ( options->Fact_Comm == SLU_COMM_IRECV
+             || options->Fact_Comm == SLU_COMM_THREADS )
+            progress_lookahead_recvs(k0, nfact, num_look_aheads,
+                                     recv_reqs, recv_reqs_u);
+
         double tsch = SuperLU_timer_();
+        SUPERLU_PROF_BEGIN(PROF_SCHUR, k);
 
 	/*******************************************************************/
 
@@ -1741,14 +2558,62 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 	/************************************************************************/
 
         NetSchurUpTimer += SuperLU_timer_() - tsch;
+        superlu_sncost_charge(stat, SNCOST_SCHUR, k);
+        SUPERLU_PROF_END(PROF_SCHUR, k);
+
+        if ( options->Fact_Comm == SLU_COMM_IRECV
+             || options->Fact_Comm == SLU_COMM_THREADS )
+            progress_lookahead_recvs(k0, nfact, num_look_aheads,
+                                     recv_reqs, recv_reqs_u);
+
+        if ( ooc_done ) {
+            if ( mycol == PCOL( k, grid ) )
+                dooc_retire(&Llu->Lnzval_ooc, Lnzval_bc_ptr, mcb, ooc_done,
+                             &ooc_next[0], LBj( k, grid ));
+            if ( myrow == PROW( k, grid ) )
+                dooc_retire(&Llu->Unzval_ooc, Unzval_br_ptr, mrb,
+                             ooc_done + mcb, &ooc_next[1], LBi( k, grid ));
+        }
 
+        SUPERLU_PROF_END(PROF_STEP, k);
     }  /* MAIN LOOP for k0 = 0, ... */
 
     /* ##################################################################
        ** END MAIN LOOP: for k0 = ...
        ################################################################## */
 
+    if ( use_rma ) {
+        panel_rma_finalize(&Lrma);
+        panel_rma_finalize(&Urma);
+    }
+#ifdef _OPENMP
+    if ( slot_comm ) {
+        for (i = 0; i < 2 * (1 + num_look_aheads); ++i)
+            MPI_Comm_free(&slot_comm[i]);
+        SUPERLU_FREE(slot_comm);
+        omp_destroy_lock(&poll_lock);
+    }
+#endif
+
+    if ( nfact < nsupers && options->SchurSize == 0 )
+        pdgstrf_root(options, nfact, n, thresh, Glu_persist, grid, Llu,
+                     stat, info);
+    /* The dense root, if any, is charged to the last supernode. */
+    superlu_sncost_charge(stat, SNCOST_SCHUR, nsupers - 1);
+    superlu_sncost_finish(stat, xsup, grid, &Llu->sn_cost);
+
+    if ( ooc_done ) { /* the rest of the factors, the root among them */
+        superlu_ooc_retire(&Llu->Lnzval_ooc, NULL);
+        superlu_ooc_retire(&Llu->Unzval_ooc, NULL);
+        SUPERLU_FREE(ooc_done);
+    }
+
     pxgstrfTimer = SuperLU_timer_() - pxgstrfTimer;
+    superlu_hwc_end(stat, HWC_FACT);
+    SUPERLU_PROF_END(PROF_FACT, EMPTY);
+    superlu_progress_stop(progress);
+    superlu_blas_restore_threads(blas_threads);
+    superlu_trace_finalize(grid, stat);
 
 #if ( PRNTlevel>=2 )
     /* Print detailed statistics */
@@ -1802,12 +2667,12 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
      ********************************************************/
 
     if (Pr * Pc > 1) {
-        SUPERLU_FREE (Lsub_buf_2[0]);   /* also free Lsub_buf_2[1] */
-        SUPERLU_FREE (Lval_buf_2[0]);   /* also free Lval_buf_2[1] */
+        superlu_free_comm (Lsub_buf_2[0]);   /* also free Lsub_buf_2[1] */
+        superlu_free_comm (Lval_buf_2[0]);   /* also free Lval_buf_2[1] */
         if (Llu->bufmax[2] != 0)
-            SUPERLU_FREE (Usub_buf_2[0]);
+            superlu_free_comm (Usub_buf_2[0]);
         if (Llu->bufmax[3] != 0)
-            SUPERLU_FREE (Uval_buf_2[0]);
+            superlu_free_comm (Uval_buf_2[0]);
         if (U_diag_blk_send_req[myrow] != MPI_REQUEST_NULL) {
             /* wait for last Isend requests to complete, deallocate objects */
             for (krow = 0; krow < Pr; ++krow) {
@@ -1850,6 +2715,10 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         SUPERLU_FREE (recv_reqs[i]);
     }
 
+    if ( Lpack ) index_pack_free(Lpack);
+    if ( Upack ) index_pack_free(Upack);
+    if ( Ufold ) SUPERLU_FREE (Ufold);
+
     SUPERLU_FREE (recv_reqs_u);
     SUPERLU_FREE (send_reqs_u);
     SUPERLU_FREE (recv_reqs);
@@ -1865,24 +2734,11 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     SUPERLU_FREE( streams );
     SUPERLU_FREE( stream_end_col );
 #else
-//  #ifdef __INTEL_COMPILER
-//    _mm_free (bigU);
-//    _mm_free (bigV);
-//  #else
-    SUPERLU_FREE (bigV);
-    SUPERLU_FREE (bigU);
-//  #endif
-    /* Decrement freed memory from memory stat. */
-    log_memory(-(bigv_size + bigu_size) * dword, stat);
+    /* bigU and bigV are freed with the arena. */
 #endif
 
     SUPERLU_FREE (Llu->ujrow);
     // SUPERLU_FREE (tempv2d);/* Sherry */
-    SUPERLU_FREE (indirect);
-    SUPERLU_FREE (indirect2); /* Sherry added */
-
-    ldt = sp_ienv_dist(3);
-    log_memory( -(3 * ldt *ldt * dword + 2 * ldt * num_threads * iword), stat );
 
     /* Sherry added */
     SUPERLU_FREE(omp_loop_time);
@@ -1892,25 +2748,12 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     log_memory(-2 * ncb * dword, stat);
 #endif
 
-    SUPERLU_FREE(lookAheadFullRow);
-    SUPERLU_FREE(lookAheadStRow);
-    SUPERLU_FREE(lookAhead_lptr);
-    SUPERLU_FREE(lookAhead_ib);
-
-    SUPERLU_FREE(RemainStRow);
-    SUPERLU_FREE(Remain_lptr);
-    SUPERLU_FREE(Remain_ib);
-    SUPERLU_FREE(Remain_info);
-    SUPERLU_FREE(lookAhead_L_buff);
-    SUPERLU_FREE(Remain_L_buff);
-    log_memory( -(3 * mrb * iword + mrb * sizeof(Remain_info_t) +
-		  ldt * ldt * (num_look_aheads + 1) * dword +
-		  Llu->bufmax[1] * dword), stat );
-
-    SUPERLU_FREE(Ublock_info);
-    /*SUPERLU_FREE(Ublock_info_iukp);
-      SUPERLU_FREE(Ublock_info_rukp);
-      SUPERLU_FREE(Ublock_info_jb);  */
+#if ( PRNTlevel>=1 )
+    printf("[%d].. factorization arena: %.2f MB reserved, %.2f MB peak\n",
+	   iam, arena.size * 1e-6, arena.peak * 1e-6);
+#endif
+    log_memory(-(int64_t) arena.size, stat);
+    superlu_arena_destroy(&arena);
 
 
 #if ( PROFlevel>=1 )
@@ -1923,6 +2766,26 @@ pdgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     if ( iinfo == n + 1 ) *info = 0;
     else *info = iinfo;
 
+    /* Size of the local factors, and the balance over the grid. */
+    if ( options->PrintStat == YES ) {
+        int_t *index, gb;
+        stat->fact_size = 0.;
+        for (lk = 0; lk < CEILING( nsupers, Pc ); ++lk) {
+            gb = lk * Pc + mycol;
+            if ( gb < nsupers && (index = Lrowind_bc_ptr[lk]) )
+                stat->fact_size += (double)
+                    (BC_HEADER + index[0] * LB_DESCRIPTOR + index[1]) * iword
+                    + (double) index[1] * SuperSize( gb ) * dword;
+        }
+        for (lk = 0; lk < CEILING( nsupers, Pr ); ++lk) {
+            gb = lk * Pr + myrow;
+            if ( gb < nsupers && (index = Ufstnz_br_ptr[lk]) )
+                stat->fact_size += (double) index[2] * iword
+                                   + (double) index[1] * dword;
+        }
+        PStatImbalance(stat, grid);
+    }
+
 #if ( PROFlevel>=1 )
     TOC (t2, t1);
     stat->utime[COMM] += t2;
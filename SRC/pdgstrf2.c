@@ -79,6 +79,9 @@ at the top-level directory.
 #include "superlu_ddefs.h"
 //#include "cblas.h"
 
+/* Width of the diagonal blocks factored by rank-1 updates. */
+#define DIAG_NB 32
+
 /*****************************************************************************
  * The following pdgstrf2_trsm is in version 6 and earlier.
  *****************************************************************************/
@@ -136,6 +139,168 @@ at the top-level directory.
  *             system of equations.
  * </pre>
  */
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Factor the diagonal block A (n-by-n, leading dimension lda) of a
+ *   supernode in place as L\U without pivoting, with L unit lower
+ *   triangular. Tiny pivots are replaced by +-thresh as in
+ *   pdgstrf2_trsm() with ReplaceTinyPivot = YES, counting them in
+ *   stat->TinyPivots, and *info is set to jfst+j+1 for a zero U(j,j).
+ *
+ *   Blocks wider than DIAG_NB are split recursively in halves, so most
+ *   of the work is in one DTRSM pair and one DGEMM per level; the blocks
+ *   of at most DIAG_NB columns are factored column by column with rank-1
+ *   updates.
+ * </pre>
+ */
+void
+pdgstrf2_diag(superlu_dist_options_t *options, int n, double *A, int lda,
+	      double thresh, int_t jfst, SuperLUStat_t *stat, int *info)
+{
+    int i, j, l, n1, n2, incx = 1;
+    double temp, alpha = -1.0, one = 1.0;
+
+    if ( n <= DIAG_NB ) {
+	for (j = 0; j < n; ++j) {
+	    /* Not to replace zero pivot.  */
+	    if ( options->ReplaceTinyPivot == YES ) {
+		if ( fabs(A[j + j*lda]) < thresh ) {  /* Diagonal */
+#if ( PRNTlevel>=2 )
+		    printf (".. col %d, tiny pivot %e  ",
+			    (int) (jfst + j), A[j + j*lda]);
+#endif
+		    /* Keep the new diagonal entry with the same sign. */
+		    if ( A[j + j*lda] < 0 ) A[j + j*lda] = -thresh;
+		    else A[j + j*lda] = thresh;
+#if ( PRNTlevel>=2 )
+		    printf ("replaced by %e\n", A[j + j*lda]);
+#endif
+		    ++(stat->TinyPivots);
+		}
+	    }
+
+	    if ( A[j + j*lda] == 0.0 ) { /* Test for singularity. */
+		*info = j + jfst + 1;
+	    } else {   /* Scale the j-th column within diag. block. */
+		temp = 1.0 / A[j + j*lda];
+		for (i = j + 1; i < n; ++i) A[i + j*lda] *= temp;
+		stat->ops[FACT] += n - j - 1;
+	    }
+
+	    /* Rank-1 update of the trailing submatrix within diag. block. */
+	    if ( (l = n - j - 1) ) {
+		dger_ (&l, &l, &alpha, &A[j+1 + j*lda], &incx,
+		       &A[j + (j+1)*lda], &lda, &A[j+1 + (j+1)*lda], &lda);
+		stat->ops[FACT] += 2 * l * l;
+	    }
+	}
+	return;
+    }
+
+    n1 = n / 2;
+    n2 = n - n1;
+    pdgstrf2_diag(options, n1, A, lda, thresh, jfst, stat, info);
+
+    /* A21 = A21 * inv(U11) and A12 = inv(L11) * A12 */
+#if defined (USE_VENDOR_BLAS)
+    dtrsm_ ("R", "U", "N", "N", &n2, &n1, &one, A, &lda, &A[n1], &lda,
+	    1, 1, 1, 1);
+    dtrsm_ ("L", "L", "N", "U", &n1, &n2, &one, A, &lda, &A[n1*lda], &lda,
+	    1, 1, 1, 1);
+#else
+    dtrsm_ ("R", "U", "N", "N", &n2, &n1, &one, A, &lda, &A[n1], &lda);
+    dtrsm_ ("L", "L", "N", "U", &n1, &n2, &one, A, &lda, &A[n1*lda], &lda);
+#endif
+    stat->ops[FACT] += 2 * (flops_t) n1 * n1 * n2;
+
+    /* A22 = A22 - A21 * A12 */
+#if defined (USE_VENDOR_BLAS)
+    dgemm_ ("N", "N", &n2, &n2, &n1, &alpha, &A[n1], &lda, &A[n1*lda], &lda,
+	    &one, &A[n1 + n1*lda], &lda, 1, 1);
+#else
+    dgemm_ ("N", "N", &n2, &n2, &n1, &alpha, &A[n1], &lda, &A[n1*lda], &lda,
+	    &one, &A[n1 + n1*lda], &lda);
+#endif
+    stat->ops[FACT] += 2 * (flops_t) n1 * n2 * n2;
+
+    pdgstrf2_diag(options, n2, &A[n1 + n1*lda], lda, thresh, jfst + n1,
+		  stat, info);
+}
+
+/*! \brief Zero the blocks of L(:,k) whose entries are all smaller than
+ *  tau in magnitude (threshold ILU, see options->ILU_DropTol).
+ *
+ * <pre>
+ * lsub[] and lusup[] are the index and values of the local part of
+ * L(:,k); the diagonal block is kept. The blocks stay in the structure,
+ * so that the solves are unchanged. L(:,k) holds the multipliers, already
+ * divided by the diagonal of U(k,k), so that the absolute test on them is
+ * relative to the pivots, as the test of dILU_drop_U() is.
+ * </pre>
+ */
+static void
+dILU_drop_L(int_t k, double tau, int_t *lsub, double *lusup, int nsupc,
+	    SuperLUStat_t *stat)
+{
+    int_t nsupr = lsub[1], k_idx = BC_HEADER, luptr = 0, lb, nbrow, i, j;
+    double amax;
+
+    for (lb = 0; lb < lsub[0]; ++lb) {
+	nbrow = lsub[k_idx + 1];
+	if ( lsub[k_idx] != k ) {
+	    amax = 0.0;
+	    for (j = 0; j < nsupc; ++j)
+		for (i = 0; i < nbrow; ++i)
+		    amax = SUPERLU_MAX(amax, fabs(lusup[luptr + i + j*nsupr]));
+	    if ( amax > 0.0 && amax < tau ) {
+		for (j = 0; j < nsupc; ++j)
+		    for (i = 0; i < nbrow; ++i) lusup[luptr + i + j*nsupr] = 0.0;
+		stat->fact_dropped += (double) nbrow * nsupc;
+	    }
+	}
+	luptr += nbrow;
+	k_idx += LB_DESCRIPTOR + nbrow;
+    }
+}
+
+/*! \brief Zero the blocks of U(k,:) whose entries are all smaller than
+ *  tau times the largest entry of U(k,k) in magnitude (threshold ILU).
+ *
+ * <pre>
+ * usub[] and uval[] are the index and values of the local part of
+ * U(k,:), and lusup[] (leading dimension nsupr) starts with the
+ * diagonal block L\U(k,k) of knsupc columns.
+ * </pre>
+ */
+static void
+dILU_drop_U(double tau, int_t *usub, double *uval, double *lusup,
+	    int nsupr, int_t knsupc, int_t *xsup, SuperLUStat_t *stat)
+{
+    int_t iukp = BR_HEADER, rukp = 0, b, i, j, len;
+    double amax, ukk = 0.0;
+
+    for (j = 0; j < knsupc; ++j)
+	for (i = 0; i <= j; ++i)
+	    ukk = SUPERLU_MAX(ukk, fabs(lusup[i + j*nsupr]));
+    tau *= ukk;
+
+    for (b = 0; b < usub[0]; ++b) {
+	len = usub[iukp + 1];
+	amax = 0.0;
+	for (i = 0; i < len; ++i)
+	    amax = SUPERLU_MAX(amax, fabs(uval[rukp + i]));
+	if ( amax > 0.0 && amax < tau ) {
+	    for (i = 0; i < len; ++i) uval[rukp + i] = 0.0;
+	    stat->fact_dropped += (double) len;
+	}
+	rukp += len;
+	iukp += UB_DESCRIPTOR + SuperSize(usub[iukp]);
+    }
+}
+
 /* This pdgstrf2 is based on TRSM function */
 void
 pdgstrf2_trsm
@@ -145,17 +310,14 @@ pdgstrf2_trsm
      SuperLUStat_t * stat, int *info)
 {
     /* printf("entering pdgstrf2 %d \n", grid->iam); */
-    int cols_left, iam, l, pkk, pr;
-    int incx = 1, incy = 1;
+    int iam, l, pkk, pr;
 
     int nsupr;            /* number of rows in the block (LDA) */
     int nsupc;            /* number of columns in the block */
-    int luptr;
-    int_t i, myrow, krow, j, jfst, jlst, u_diag_cnt;
+    int_t myrow, krow, j, jfst, lk;
     int_t *xsup = Glu_persist->xsup;
-    double *lusup, temp;
+    double *lusup;
     double *ujrow, *ublk_ptr;   /* pointer to the U block */
-    double alpha = -1, zero = 0.0;
     int_t Pr;
     MPI_Status status;
     MPI_Comm comm = (grid->cscp).comm;
@@ -167,13 +329,12 @@ pdgstrf2_trsm
     myrow = MYROW (iam, grid);
     krow = PROW (k, grid);
     pkk = PNUM (PROW (k, grid), PCOL (k, grid), grid);
-    j = LBj (k, grid);          /* Local block number */
+    lk = LBj (k, grid);         /* Local block number */
     jfst = FstBlockC (k);
-    jlst = FstBlockC (k + 1);
-    lusup = Llu->Lnzval_bc_ptr[j];
+    lusup = Llu->Lnzval_bc_ptr[lk];
     nsupc = SuperSize (k);
-    if (Llu->Lrowind_bc_ptr[j])
-        nsupr = Llu->Lrowind_bc_ptr[j][1];
+    if (Llu->Lrowind_bc_ptr[lk])
+        nsupr = Llu->Lrowind_bc_ptr[lk][1];
     else
         nsupr = 0;
 #ifdef PI_DEBUG
@@ -182,11 +343,7 @@ pdgstrf2_trsm
 #endif
     ublk_ptr = ujrow = Llu->ujrow;
 
-    luptr = 0;                  /* Point to the diagonal entries. */
-    cols_left = nsupc;          /* supernode size */
     int ld_ujrow = nsupc;       /* leading dimension of ujrow */
-    u_diag_cnt = 0;
-    incy = ld_ujrow;
 
     if ( U_diag_blk_send_req &&
 	 U_diag_blk_send_req[myrow] != MPI_REQUEST_NULL ) {
@@ -210,64 +367,12 @@ pdgstrf2_trsm
 
     if (iam == pkk) {            /* diagonal process */
 	/* ++++ First step compute diagonal block ++++++++++ */
-        for (j = 0; j < jlst - jfst; ++j) {  /* for each column in panel */
-            /* Diagonal pivot */
-            i = luptr;
-            /* Not to replace zero pivot.  */
-            // if (options->ReplaceTinyPivot == YES && lusup[i] != 0.0 )  {
-            if (options->ReplaceTinyPivot == YES)  {
-                if (fabs (lusup[i]) < thresh) {  /* Diagonal */
+	pdgstrf2_diag(options, nsupc, lusup, nsupr, thresh, jfst, stat, info);
 
-#if ( PRNTlevel>=2 )
-                    printf ("(%d) .. col %d, tiny pivot %e  ",
-                            iam, jfst + j, lusup[i]);
-#endif
-                    /* Keep the new diagonal entry with the same sign. */
-                    if (lusup[i] < 0)  lusup[i] = -thresh;
-                    else  lusup[i] = thresh;
-#if ( PRNTlevel>=2 )
-                    printf ("replaced by %e\n", lusup[i]);
-#endif
-                    ++(stat->TinyPivots);
-                }
-            }
-
-#if 0
-            for (l = 0; l < cols_left; ++l, i += nsupr, ++u_diag_cnt)
-                 ublk_ptr[u_diag_cnt] = lusup[i]; /* copy one row of U */
-#endif
-
-            /* storing U in full form  */
-            int st;
-            for (l = 0; l < cols_left; ++l, i += nsupr, ++u_diag_cnt) {
-                st = j * ld_ujrow + j;
-                ublk_ptr[st + l * ld_ujrow] = lusup[i]; /* copy one row of U */
-            }
-
-            if ( ujrow[0] == zero ) { /* Test for singularity. */
-                *info = j + jfst + 1;
-            } else {              /* Scale the j-th column within diag. block. */
-                temp = 1.0 / ujrow[0];
-                for (i = luptr + 1; i < luptr - j + nsupc; ++i)
-		    lusup[i] *= temp;
-                stat->ops[FACT] += nsupc - j - 1;
-            }
-
-            /* Rank-1 update of the trailing submatrix within diag. block. */
-            if (--cols_left) {
-                /* l = nsupr - j - 1;  */
-                l = nsupc - j - 1;  /* Piyush */
-                dger_ (&l, &cols_left, &alpha, &lusup[luptr + 1], &incx,
-                       &ujrow[ld_ujrow], &incy, &lusup[luptr + nsupr + 1],
-                       &nsupr);
-                stat->ops[FACT] += 2 * l * cols_left;
-            }
-
-            /* ujrow = ublk_ptr + u_diag_cnt;  */
-            ujrow = ujrow + ld_ujrow + 1; /* move to next row of U */
-            luptr += nsupr + 1; /* move to next column */
-
-        }                       /* for column j ...  first loop */
+	/* storing U in full form  */
+	for (j = 0; j < nsupc; ++j)
+	    for (l = 0; l <= j; ++l)
+		ujrow[l + j * ld_ujrow] = lusup[l + j * nsupr];
 
 	/* ++++ Second step compute off-diagonal block with communication  ++*/
 
@@ -358,6 +463,9 @@ pdgstrf2_trsm
 
     } /* end if pkk ... */
 
+    if ( Llu->droptol > 0.0 && nsupr > 0 )
+	dILU_drop_L(k, Llu->droptol, Llu->Lrowind_bc_ptr[lk], lusup, nsupc, stat);
+
     /* printf("exiting pdgstrf2 %d \n", grid->iam);  */
 
 }  /* PDGSTRF2_trsm */
@@ -770,7 +878,8 @@ int_t dTrs2_GatherTrsmScatter(int_t klst, int_t iukp, int_t rukp,
  *****************************************************************************/
 void pdgstrs2_omp
 (int_t k0, int_t k, Glu_persist_t * Glu_persist, gridinfo_t * grid,
- dLocalLU_t * Llu, Ublock_info_t *Ublock_info, SuperLUStat_t * stat)
+ dLocalLU_t * Llu, Ublock_info_t *Ublock_info, superlu_arena_t *arena,
+ SuperLUStat_t * stat)
 {
 #ifdef PI_DEBUG
     printf("====Entering pdgstrs2==== \n");
@@ -829,7 +938,11 @@ void pdgstrs2_omp
     /* Loop through all the row blocks. to get the iukp and rukp*/
     Trs2_InitUblock_info(klst, nb, Ublock_info, usub, Glu_persist, stat );
 #else
-    int* blocks_index_pointers = SUPERLU_MALLOC (3 * nb * sizeof(int));
+    /* nb is at most the number of local block columns; the space is
+       reserved in the arena by pdgstrf(). */
+    size_t arena_mark = superlu_arena_mark(arena);
+    int* blocks_index_pointers = (int *)
+        superlu_arena_alloc(arena, 3 * nb * sizeof(int));
     int* blocks_value_pointers = blocks_index_pointers + nb;
     int* nsupc_temp = blocks_value_pointers + nb;
     for (b = 0; b < nb; b++) { /* set up pointers to each block */
@@ -893,10 +1006,13 @@ void pdgstrs2_omp
     }  /* end for b ... */
 
 #ifndef USE_Ublock_info
-    /* Deallocate memory */
-    SUPERLU_FREE(blocks_index_pointers);
+    /* Release the scratch space for the next panel */
+    superlu_arena_reset(arena, arena_mark);
 #endif
 
+    if ( Llu->droptol > 0.0 )
+	dILU_drop_U(Llu->droptol, usub, uval, lusup, nsupr, knsupc, xsup, stat);
+
 #if 0
     //#ifdef USE_VTUNE
     __itt_pause(); // stop VTune
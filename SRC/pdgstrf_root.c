@@ -0,0 +1,277 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Dense factorization of the trailing supernodes (the dense root)
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_ddefs.h"
+
+/*! \brief Find the first supernode of the dense root.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * Returns the smallest kd < nsupers-1 such that the entries stored in the
+ * L and U blocks of the supernodes kd:nsupers-1 fill at least the fraction
+ * options->DenseRoot_Tol of the trailing block of order n - xsup[kd], or
+ * nsupers when there is none or DenseRoot_Tol = 0. Since the stored blocks
+ * of supernode k only hold rows and columns from xsup[k] on, the entries
+ * of each supernode are counted once, with one reduction among all the
+ * processes.
+ * </pre>
+ */
+int_t
+pdgstrf_root_start(superlu_dist_options_t *options, int_t n,
+		   Glu_persist_t *Glu_persist, gridinfo_t *grid,
+		   dLocalLU_t *Llu)
+{
+    int_t *xsup = Glu_persist->xsup;
+    int_t nsupers = Glu_persist->supno[n-1] + 1;
+    int   iam = grid->iam, myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+    int_t k, kd, *index;
+    double *cnt, *gcnt, tail, ord;
+
+    if ( options->DenseRoot_Tol <= 0.0 || options->SchurSize > 0
+	 || nsupers < 2 ) return nsupers;
+
+    if ( !(cnt = doubleCalloc_dist(2 * nsupers)) )
+	ABORT("Calloc fails for cnt[].");
+    gcnt = cnt + nsupers;
+    for (k = mycol; k < nsupers; k += grid->npcol)
+	if ( (index = Llu->Lrowind_bc_ptr[LBj( k, grid )]) )
+	    cnt[k] += (double) SuperSize( k ) * index[1];
+    for (k = myrow; k < nsupers; k += grid->nprow)
+	if ( (index = Llu->Ufstnz_br_ptr[LBi( k, grid )]) )
+	    cnt[k] += index[1];
+    MPI_Allreduce(cnt, gcnt, nsupers, MPI_DOUBLE, MPI_SUM, grid->comm);
+
+    kd = nsupers;
+    tail = 0.;
+    for (k = nsupers - 1; k >= 0; --k) {
+	tail += gcnt[k];
+	ord = n - xsup[k];
+	if ( k < nsupers - 1 && tail >= options->DenseRoot_Tol * ord * ord )
+	    kd = k;
+    }
+    SUPERLU_FREE(cnt);
+    return kd;
+}
+
+/*
+ * Copy the L and U blocks of the supernodes kd:nsupers-1 into the local
+ * dense block D (store = 0), or back (store = 1). Row i of supernode I
+ * is row rpos[I-kd] + i of D, column j of supernode J is column
+ * cpos[J-kd] + j.
+ */
+static void
+root_copy(int store, int_t kd, int_t nsupers, int_t *xsup, int_t *rpos,
+	  int_t *cpos, double *D, int_t ldd, gridinfo_t *grid,
+	  dLocalLU_t *Llu)
+{
+    int   iam = grid->iam, myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+    int_t k, gb, b, t, c, pos, luptr, len, nsupr, nsupc, irow, fnz, klst;
+    int_t *index;
+    double *lusup, *uval, *Dk;
+
+    for (k = kd; k < nsupers; ++k) {
+	if ( PCOL( k, grid ) != mycol ) continue;
+	if ( !(index = Llu->Lrowind_bc_ptr[LBj( k, grid )]) ) continue;
+	lusup = Llu->Lnzval_bc_ptr[LBj( k, grid )];
+	nsupr = index[1];
+	nsupc = SuperSize( k );
+	Dk = &D[cpos[k-kd] * ldd];
+	for (b = 0, pos = BC_HEADER, luptr = 0; b < index[0]; ++b) {
+	    gb = index[pos];
+	    len = index[pos+1];
+	    for (t = 0; t < len; ++t) {
+		irow = rpos[gb-kd] + index[pos + LB_DESCRIPTOR + t] - xsup[gb];
+		for (c = 0; c < nsupc; ++c) {
+		    if ( store ) lusup[luptr + t + c*nsupr] = Dk[irow + c*ldd];
+		    else Dk[irow + c*ldd] = lusup[luptr + t + c*nsupr];
+		}
+	    }
+	    luptr += len;
+	    pos += LB_DESCRIPTOR + len;
+	}
+    }
+
+    for (k = kd; k < nsupers; ++k) {
+	if ( PROW( k, grid ) != myrow ) continue;
+	if ( !(index = Llu->Ufstnz_br_ptr[LBi( k, grid )]) ) continue;
+	uval = Llu->Unzval_br_ptr[LBi( k, grid )];
+	klst = FstBlockC( k+1 );
+	for (b = 0, pos = BR_HEADER, luptr = 0; b < index[0]; ++b) {
+	    gb = index[pos];
+	    nsupc = SuperSize( gb );
+	    Dk = &D[rpos[k-kd] - xsup[k] + cpos[gb-kd] * ldd];
+	    for (c = 0; c < nsupc; ++c) {
+		fnz = index[pos + UB_DESCRIPTOR + c];
+		for (irow = fnz; irow < klst; ++irow, ++luptr) {
+		    if ( store ) uval[luptr] = Dk[irow + c*ldd];
+		    else Dk[irow + c*ldd] = uval[luptr];
+		}
+	    }
+	    pos += UB_DESCRIPTOR + nsupc;
+	}
+    }
+}
+
+/*! \brief Factor the dense root left by the sparse factorization.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSTRF_ROOT factors the trailing supernodes kd:nsupers-1, after
+ * pdgstrf() has factored the others and applied all their updates, as one
+ * dense matrix. The supernodes are already distributed 2D block-cyclically
+ * over the process grid, so each process copies its L and U blocks of the
+ * root into one local dense array, the root is factored there by a right-
+ * looking LU without pivoting with one block column per supernode, and
+ * the result is copied back into the L and U blocks. Each step broadcasts
+ * the diagonal block, the L panel along the process rows and the U panel
+ * along the process columns, then makes one GEMM update of the whole local
+ * trailing matrix, without the per-block index handling of the sparse
+ * factorization. The entries outside the pattern of L+U remain zero, as
+ * the pattern holds all the fill of a factorization without pivoting.
+ *
+ * The diagonal blocks are factored by pdgstrf2_diag(), which replaces the
+ * tiny pivots and sets *info as pdgstrf2_trsm() does.
+ * </pre>
+ */
+void
+pdgstrf_root(superlu_dist_options_t *options, int_t kd, int_t n,
+	     double thresh, Glu_persist_t *Glu_persist, gridinfo_t *grid,
+	     dLocalLU_t *Llu, SuperLUStat_t *stat, int *info)
+{
+    int_t *xsup = Glu_persist->xsup;
+    int_t nsupers = Glu_persist->supno[n-1] + 1, nt = nsupers - kd;
+    int   iam = grid->iam, myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+    int   krow, kcol, ks, mr, nc, i, j, ldd, blas_threads;
+    int_t k, mt, ntc, r0, r1, c0, c1, maxns = 0, *rpos, *cpos;
+    double *D, *dbuf, *lbuf, *ubuf, *Dkk;
+    double alpha = -1.0, one = 1.0;
+
+    if ( nt <= 0 ) return;
+
+    if ( !(rpos = intMalloc_dist(2 * (nt + 1))) )
+	ABORT("Malloc fails for rpos[].");
+    cpos = rpos + nt + 1;
+    rpos[0] = cpos[0] = 0;
+    for (k = kd; k < nsupers; ++k) {
+	ks = SuperSize( k );
+	maxns = SUPERLU_MAX( maxns, ks );
+	rpos[k-kd+1] = rpos[k-kd] + (PROW( k, grid ) == myrow ? ks : 0);
+	cpos[k-kd+1] = cpos[k-kd] + (PCOL( k, grid ) == mycol ? ks : 0);
+    }
+    mt = rpos[nt];
+    ntc = cpos[nt];
+#if ( PRNTlevel>=1 )
+    if ( !iam ) printf(".. dense root: supernodes " IFMT ":" IFMT ", order " IFMT "\n",
+		       kd, nsupers - 1, n - xsup[kd]);
+#endif
+    ldd = SUPERLU_MAX( mt, 1 );
+
+    if ( !(D = doubleCalloc_dist((size_t) ldd * SUPERLU_MAX( ntc, 1 ))) )
+	ABORT("Calloc fails for D[].");
+    if ( !(dbuf = doubleMalloc_dist(maxns * maxns + maxns * (mt + ntc))) )
+	ABORT("Malloc fails for dbuf[].");
+    lbuf = dbuf + maxns * maxns;
+    ubuf = lbuf + maxns * mt;
+
+    root_copy(0, kd, nsupers, xsup, rpos, cpos, D, ldd, grid, Llu);
+
+    /* The updates are single calls outside of any parallel region. */
+    blas_threads = superlu_blas_set_threads(
+		       superlu_blas_max_threads(2.0 * mt * ntc * maxns));
+
+    for (k = kd; k < nsupers; ++k) {
+	ks = SuperSize( k );
+	krow = PROW( k, grid );
+	kcol = PCOL( k, grid );
+	r0 = rpos[k-kd];  r1 = rpos[k-kd+1];  mr = mt - r1;
+	c0 = cpos[k-kd];  c1 = cpos[k-kd+1];  nc = ntc - c1;
+
+	if ( myrow == krow && mycol == kcol ) {
+	    /* Factor the diagonal block in place. */
+	    Dkk = &D[r0 + c0 * ldd];
+	    pdgstrf2_diag(options, ks, Dkk, ldd, thresh, xsup[k], stat, info);
+	    for (j = 0; j < ks; ++j)
+		for (i = 0; i < ks; ++i) dbuf[i + j*ks] = Dkk[i + j*ldd];
+	}
+
+	/* L panel: L(k+1:,k) = A(k+1:,k) * inv(U(k,k)). */
+	if ( mycol == kcol ) {
+	    MPI_Bcast(dbuf, ks * ks, MPI_DOUBLE, krow, grid->cscp.comm);
+	    if ( mr ) {
+#if defined (USE_VENDOR_BLAS)
+		dtrsm_("R", "U", "N", "N", &mr, &ks, &one, dbuf, &ks,
+		       &D[r1 + c0 * ldd], &ldd, 1, 1, 1, 1);
+#else
+		dtrsm_("R", "U", "N", "N", &mr, &ks, &one, dbuf, &ks,
+		       &D[r1 + c0 * ldd], &ldd);
+#endif
+		stat->ops[FACT] += (flops_t) mr * ks * ks;
+		for (j = 0; j < ks; ++j)
+		    for (i = 0; i < mr; ++i)
+			lbuf[i + j*mr] = D[r1 + i + (c0 + j) * ldd];
+	    }
+	}
+
+	/* U panel: U(k,k+1:) = inv(L(k,k)) * A(k,k+1:). */
+	if ( myrow == krow ) {
+	    MPI_Bcast(dbuf, ks * ks, MPI_DOUBLE, kcol, grid->rscp.comm);
+	    if ( nc ) {
+#if defined (USE_VENDOR_BLAS)
+		dtrsm_("L", "L", "N", "U", &ks, &nc, &one, dbuf, &ks,
+		       &D[r0 + c1 * ldd], &ldd, 1, 1, 1, 1);
+#else
+		dtrsm_("L", "L", "N", "U", &ks, &nc, &one, dbuf, &ks,
+		       &D[r0 + c1 * ldd], &ldd);
+#endif
+		stat->ops[FACT] += (flops_t) nc * ks * ks;
+		for (j = 0; j < nc; ++j)
+		    for (i = 0; i < ks; ++i)
+			ubuf[i + j*ks] = D[r0 + i + (c1 + j) * ldd];
+	    }
+	}
+
+	/* Pass the panels on, and update the local trailing matrix. */
+	MPI_Bcast(lbuf, mr * ks, MPI_DOUBLE, kcol, grid->rscp.comm);
+	MPI_Bcast(ubuf, ks * nc, MPI_DOUBLE, krow, grid->cscp.comm);
+	if ( mr && nc ) {
+#if defined (USE_VENDOR_BLAS)
+	    dgemm_("N", "N", &mr, &nc, &ks, &alpha, lbuf, &mr, ubuf, &ks,
+		   &one, &D[r1 + c1 * ldd], &ldd, 1, 1);
+#else
+	    dgemm_("N", "N", &mr, &nc, &ks, &alpha, lbuf, &mr, ubuf, &ks,
+		   &one, &D[r1 + c1 * ldd], &ldd);
+#endif
+	    stat->ops[FACT] += 2 * (flops_t) mr * nc * ks;
+	}
+    }
+
+    superlu_blas_restore_threads(blas_threads);
+    root_copy(1, kd, nsupers, xsup, rpos, cpos, D, ldd, grid, Llu);
+
+    SUPERLU_FREE(D);
+    SUPERLU_FREE(dbuf);
+    SUPERLU_FREE(rpos);
+}
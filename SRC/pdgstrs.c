@@ -98,6 +98,63 @@ _fcd ftcs2;
 _fcd ftcs3;
 #endif
 
+/* Copy nrhs columns of the m rows described by row[]: entry j of row i
+   goes from src[row[4*i] + j*row[4*i+1]] to dst[row[4*i+2] + j*row[4*i+3]].
+   This is done by tiles of tile columns and RHS_TILE_WORDS/tile rows, so
+   that both sides are reused from cache when nrhs is large. */
+static void
+dcopy_rhs_tiles(int_t m, int nrhs, int tile, int_t *row, double *src, double *dst)
+{
+    int_t i, i0, i1, j, j0, j1, mt, *r;
+
+    mt = SUPERLU_MAX(1, RHS_TILE_WORDS / tile);
+#ifdef _OPENMP
+#pragma omp parallel for private (i, i1, j, j0, j1, r) schedule(static)
+#endif
+    for (i0 = 0; i0 < m; i0 += mt) {
+	i1 = SUPERLU_MIN(i0 + mt, m);
+	for (j0 = 0; j0 < nrhs; j0 += tile) {
+	    j1 = SUPERLU_MIN(j0 + tile, nrhs);
+	    for (i = i0; i < i1; ++i) {
+		r = &row[4 * i];
+		for (j = j0; j < j1; ++j)
+		    dst[r[2] + j * r[3]] = src[r[0] + j * r[1]];
+	    }
+	}
+    }
+}
+
+/* With SOLVEstruct->x_layout = YES, B holds the rows of the supernodes
+   of the diagonal blocks owned by this process, in the order given by
+   pdSolveLayout(), so that B and x only differ by the block headers of x. */
+static void
+dcopy_rhs_layout(int to_x, double *B, int_t m_loc, int_t ldb, int nrhs,
+		 double *x, int_t *ilsum, Glu_persist_t *Glu_persist,
+		 gridinfo_t *grid)
+{
+    int_t *xsup = Glu_persist->xsup;
+    int_t i, j, k, knsupc, l, lk, r;
+    int iam = grid->iam;
+
+    for (k = 0, r = 0; r < m_loc; ++k) {
+	if ( iam != PNUM( PROW( k, grid ), PCOL( k, grid ), grid ) ) continue;
+	knsupc = SuperSize( k );
+	lk = LBi( k, grid );
+	l = X_BLK( lk );
+	if ( to_x ) {
+	    x[l - XK_H] = k;
+	    for (j = 0; j < nrhs; ++j)
+		for (i = 0; i < knsupc; ++i)
+		    x[l + i + j*knsupc] = B[r + i + j*ldb];
+	} else {
+	    for (j = 0; j < nrhs; ++j)
+		for (i = 0; i < knsupc; ++i)
+		    B[r + i + j*ldb] = x[l + i + j*knsupc];
+	}
+	r += knsupc;
+    }
+}
+
 /*! \brief
  *
  * <pre>
@@ -171,11 +228,20 @@ pdReDistribute_B_to_X(double *B, int_t m_loc, int nrhs, int_t ldb,
 	MPI_Request req_i, req_d, *req_send, *req_recv;
 	MPI_Status status, *status_send, *status_recv;
 	int Nreq_recv, Nreq_send, pp, pps, ppr;
+	int nbr;
+	size_t isz;
 	double t;
+	int tile = SOLVEstruct->rhs_tile, tiled = tile > 0 && nrhs > tile;
+	int_t *row = NULL;
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(grid->iam, "Enter pdReDistribute_B_to_X()");
 #endif
 
+    if ( SOLVEstruct->x_layout ) {
+	dcopy_rhs_layout(1, B, m_loc, ldb, nrhs, x, ilsum, Glu_persist, grid);
+	return 0;
+    }
+
     /* ------------------------------------------------------------
        INITIALIZATION.
        ------------------------------------------------------------*/
@@ -198,7 +264,22 @@ pdReDistribute_B_to_X(double *B, int_t m_loc, int nrhs, int_t ldb,
     /* ------------------------------------------------------------
        NOW COMMUNICATE THE ACTUAL DATA.
        ------------------------------------------------------------*/
-	if(procs==1){ // faster memory copy when procs=1
+	if(procs==1 && tiled){ /* A tile of B and of x stay in cache. */
+		if ( !(row = intMalloc_dist(4 * SUPERLU_MAX(m_loc, 1))) )
+			ABORT("Malloc fails for row[].");
+		for (i = 0; i < m_loc; ++i) {
+			irow = perm_c[perm_r[i+fst_row]]; /* Row number in Pc*Pr*B */
+			k = BlockNum( irow );
+			l = X_BLK( k );
+			x[l - XK_H] = k;      /* Block number prepended in the header. */
+			row[4*i] = i;
+			row[4*i+1] = ldb;
+			row[4*i+2] = l + irow - FstBlockC( k );
+			row[4*i+3] = SuperSize( k );
+		}
+		dcopy_rhs_tiles(m_loc, nrhs, tile, row, B, x);
+		SUPERLU_FREE(row);
+	}else if(procs==1){ // faster memory copy when procs=1
 
 #ifdef _OPENMP
 #pragma omp parallel default (shared)
@@ -231,25 +312,34 @@ pdReDistribute_B_to_X(double *B, int_t m_loc, int nrhs, int_t ldb,
 	}else{
 		k = sdispls[procs-1] + SendCnt[procs-1]; /* Total number of sends */
 		l = rdispls[procs-1] + RecvCnt[procs-1]; /* Total number of receives */
-		if ( !(send_ibuf = intMalloc_dist(k + l)) )
-			ABORT("Malloc fails for send_ibuf[].");
+		nbr = gstrs_comm->B_to_X_comm != MPI_COMM_NULL;
+		if ( nbr ) { /* Reuse the buffers of the previous solve. */
+			isz = CEILING((k + l) * sizeof(int_t), sizeof(double)) * sizeof(double);
+			send_ibuf = (int_t *) pxgstrs_buf(gstrs_comm,
+					isz + (k + l) * (size_t)nrhs * sizeof(double));
+			send_dbuf = (double *) ((char *) send_ibuf + isz);
+		} else {
+			if ( !(send_ibuf = intMalloc_dist(k + l)) )
+				ABORT("Malloc fails for send_ibuf[].");
+			if ( !(send_dbuf = doubleMalloc_dist((k + l)* (size_t)nrhs)) )
+				ABORT("Malloc fails for send_dbuf[].");
+			if ( !(req_send = (MPI_Request*) SUPERLU_MALLOC(procs*sizeof(MPI_Request))) )
+				ABORT("Malloc fails for req_send[].");
+			if ( !(req_recv = (MPI_Request*) SUPERLU_MALLOC(procs*sizeof(MPI_Request))) )
+				ABORT("Malloc fails for req_recv[].");
+			if ( !(status_send = (MPI_Status*) SUPERLU_MALLOC(procs*sizeof(MPI_Status))) )
+				ABORT("Malloc fails for status_send[].");
+			if ( !(status_recv = (MPI_Status*) SUPERLU_MALLOC(procs*sizeof(MPI_Status))) )
+				ABORT("Malloc fails for status_recv[].");
+		}
 		recv_ibuf = send_ibuf + k;
-		if ( !(send_dbuf = doubleMalloc_dist((k + l)* (size_t)nrhs)) )
-			ABORT("Malloc fails for send_dbuf[].");
 		recv_dbuf = send_dbuf + k * nrhs;
-		if ( !(req_send = (MPI_Request*) SUPERLU_MALLOC(procs*sizeof(MPI_Request))) )
-			ABORT("Malloc fails for req_send[].");
-		if ( !(req_recv = (MPI_Request*) SUPERLU_MALLOC(procs*sizeof(MPI_Request))) )
-			ABORT("Malloc fails for req_recv[].");
-		if ( !(status_send = (MPI_Status*) SUPERLU_MALLOC(procs*sizeof(MPI_Status))) )
-			ABORT("Malloc fails for status_send[].");
-		if ( !(status_recv = (MPI_Status*) SUPERLU_MALLOC(procs*sizeof(MPI_Status))) )
-			ABORT("Malloc fails for status_recv[].");
-
 		for (p = 0; p < procs; ++p) {
 			ptr_to_ibuf[p] = sdispls[p];
 			ptr_to_dbuf[p] = sdispls[p] * nrhs;
 		}
+		if ( tiled && !(row = intMalloc_dist(4 * SUPERLU_MAX(SUPERLU_MAX(k, l), 1))) )
+			ABORT("Malloc fails for row[].");
 
 		/* Copy the row indices and values to the send buffer. */
 		// t = SuperLU_timer_();
@@ -262,11 +352,19 @@ pdReDistribute_B_to_X(double *B, int_t m_loc, int nrhs, int_t ldb,
 		++ptr_to_ibuf[p];
 
 		k = ptr_to_dbuf[p];
+		if ( tiled ) {
+			row[4*i] = i;
+			row[4*i+1] = ldb;
+			row[4*i+2] = k;
+			row[4*i+3] = 1;
+		} else {
 		RHS_ITERATE(j) { /* RHS is stored in row major in the buffer. */
 			send_dbuf[k++] = B[i + j*ldb];
 		}
+		}
 		ptr_to_dbuf[p] += nrhs;
 		}
+		if ( tiled ) dcopy_rhs_tiles(m_loc, nrhs, tile, row, B, send_dbuf);
 
 		// t = SuperLU_timer_() - t;
 		// printf(".. copy to send buffer time\t%8.4f\n", t);
@@ -292,6 +390,10 @@ pdReDistribute_B_to_X(double *B, int_t m_loc, int nrhs, int_t ldb,
 		MPI_Wait(&req_d,&status);
  	#endif
 #endif
+	if ( nbr ) {
+		recv_ibuf = pxgstrs_nbr_exchange(gstrs_comm, 0, nrhs, send_ibuf,
+						 send_dbuf, recv_dbuf, MPI_DOUBLE);
+	} else {
 	MPI_Barrier( grid->comm );
 
 
@@ -345,6 +447,7 @@ pdReDistribute_B_to_X(double *B, int_t m_loc, int nrhs, int_t ldb,
 
 	if(Nreq_send>0)MPI_Waitall(Nreq_send,req_send,status_send);
 	if(Nreq_recv>0)MPI_Waitall(Nreq_recv,req_recv,status_recv);
+	}
 
 
 		/* ------------------------------------------------------------
@@ -366,22 +469,36 @@ pdReDistribute_B_to_X(double *B, int_t m_loc, int nrhs, int_t ldb,
 			x[l - XK_H] = k;      /* Block number prepended in the header. */
 
 			irow = irow - FstBlockC(k); /* Relative row number in X-block */
+			if ( tiled ) {
+				row[4*ii] = jj;
+				row[4*ii+1] = 1;
+				row[4*ii+2] = l + irow;
+				row[4*ii+3] = knsupc;
+				jj += nrhs;
+			} else {
 			RHS_ITERATE(j) {
 				x[l + irow + j*knsupc] = recv_dbuf[jj++];
 			}
+			}
 			++ii;
 		}
 		}
+		if ( tiled ) {
+			dcopy_rhs_tiles(ii, nrhs, tile, row, recv_dbuf, x);
+			SUPERLU_FREE(row);
+		}
 
 		// t = SuperLU_timer_() - t;
 		// printf(".. copy to x time\t%8.4f\n", t);
 
-		SUPERLU_FREE(send_ibuf);
-		SUPERLU_FREE(send_dbuf);
-		SUPERLU_FREE(req_send);
-		SUPERLU_FREE(req_recv);
-		SUPERLU_FREE(status_send);
-		SUPERLU_FREE(status_recv);
+		if ( !nbr ) {
+			SUPERLU_FREE(send_ibuf);
+			SUPERLU_FREE(send_dbuf);
+			SUPERLU_FREE(req_send);
+			SUPERLU_FREE(req_recv);
+			SUPERLU_FREE(status_send);
+			SUPERLU_FREE(status_recv);
+		}
 	}
 
 
@@ -413,7 +530,7 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
 		      Glu_persist_t *Glu_persist, gridinfo_t *grid,
 		      dSOLVEstruct_t *SOLVEstruct)
 {
-    int_t  i, ii, irow, j, jj, k, knsupc, nsupers, l, lk;
+    int_t  i, ii, irow, j, jj, k, knsupc, nsupers, l, lk, rs;
     int_t  *xsup, *supno;
     int  *SendCnt, *SendCnt_nrhs, *RecvCnt, *RecvCnt_nrhs;
     int  *sdispls, *rdispls, *sdispls_nrhs, *rdispls_nrhs;
@@ -427,11 +544,20 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
 	MPI_Request req_i, req_d, *req_send, *req_recv;
 	MPI_Status status, *status_send, *status_recv;
 	int Nreq_recv, Nreq_send, pp,pps,ppr;
+	int nbr;
+	size_t isz;
+	int tile = SOLVEstruct->rhs_tile, tiled = tile > 0 && nrhs > tile;
+	int_t *row = NULL;
 
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(grid->iam, "Enter pdReDistribute_X_to_B()");
 #endif
 
+    if ( SOLVEstruct->x_layout ) {
+	dcopy_rhs_layout(0, B, m_loc, ldb, nrhs, x, ilsum, Glu_persist, grid);
+	return 0;
+    }
+
     /* ------------------------------------------------------------
        INITIALIZATION.
        ------------------------------------------------------------*/
@@ -471,35 +597,45 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
 		lk = LBi( k, grid ); /* Local block number */
 		irow = FstBlockC( k );
 		l = X_BLK( lk );
-		for (i = 0; i < knsupc; ++i) {
-			RHS_ITERATE(j) { /* RHS is stored in row major in the buffer. */
+		RHS_ITERATE(j) { /* Both are column major. */
+			for (i = 0; i < knsupc; ++i)
 				B[irow-fst_row +i + j*ldb] = x[l + i + j*knsupc];
 			}
-			}
 		}
 	}
 	}
 	}else{
 		k = sdispls[procs-1] + SendCnt[procs-1]; /* Total number of sends */
 		l = rdispls[procs-1] + RecvCnt[procs-1]; /* Total number of receives */
-		if ( !(send_ibuf = intMalloc_dist(k + l)) )
-			ABORT("Malloc fails for send_ibuf[].");
+		nbr = gstrs_comm->X_to_B_comm != MPI_COMM_NULL;
+		if ( nbr ) { /* Reuse the buffers of the previous solve. */
+			isz = CEILING((k + l) * sizeof(int_t), sizeof(double)) * sizeof(double);
+			send_ibuf = (int_t *) pxgstrs_buf(gstrs_comm,
+					isz + (k + l) * (size_t)nrhs * sizeof(double));
+			send_dbuf = (double *) ((char *) send_ibuf + isz);
+		} else {
+			if ( !(send_ibuf = intMalloc_dist(k + l)) )
+				ABORT("Malloc fails for send_ibuf[].");
+			if ( !(send_dbuf = doubleMalloc_dist((k + l)*nrhs)) )
+				ABORT("Malloc fails for send_dbuf[].");
+			if ( !(req_send = (MPI_Request*) SUPERLU_MALLOC(procs*sizeof(MPI_Request))) )
+				ABORT("Malloc fails for req_send[].");
+			if ( !(req_recv = (MPI_Request*) SUPERLU_MALLOC(procs*sizeof(MPI_Request))) )
+				ABORT("Malloc fails for req_recv[].");
+			if ( !(status_send = (MPI_Status*) SUPERLU_MALLOC(procs*sizeof(MPI_Status))) )
+				ABORT("Malloc fails for status_send[].");
+			if ( !(status_recv = (MPI_Status*) SUPERLU_MALLOC(procs*sizeof(MPI_Status))) )
+				ABORT("Malloc fails for status_recv[].");
+		}
 		recv_ibuf = send_ibuf + k;
-		if ( !(send_dbuf = doubleMalloc_dist((k + l)*nrhs)) )
-			ABORT("Malloc fails for send_dbuf[].");
-		if ( !(req_send = (MPI_Request*) SUPERLU_MALLOC(procs*sizeof(MPI_Request))) )
-			ABORT("Malloc fails for req_send[].");
-		if ( !(req_recv = (MPI_Request*) SUPERLU_MALLOC(procs*sizeof(MPI_Request))) )
-			ABORT("Malloc fails for req_recv[].");
-		if ( !(status_send = (MPI_Status*) SUPERLU_MALLOC(procs*sizeof(MPI_Status))) )
-			ABORT("Malloc fails for status_send[].");
-		if ( !(status_recv = (MPI_Status*) SUPERLU_MALLOC(procs*sizeof(MPI_Status))) )
-			ABORT("Malloc fails for status_recv[].");
 		recv_dbuf = send_dbuf + k * nrhs;
 		for (p = 0; p < procs; ++p) {
 			ptr_to_ibuf[p] = sdispls[p];
 			ptr_to_dbuf[p] = sdispls_nrhs[p];
 		}
+		if ( tiled && !(row = intMalloc_dist(4 * SUPERLU_MAX(SUPERLU_MAX(k, m_loc), 1))) )
+			ABORT("Malloc fails for row[].");
+		rs = 0; /* Number of rows sent */
 		num_diag_procs = SOLVEstruct->num_diag_procs;
 		diag_procs = SOLVEstruct->diag_procs;
  		for (p = 0; p < num_diag_procs; ++p) {  /* For all diagonal processes. */
@@ -520,9 +656,17 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
 				jj = ptr_to_ibuf[q];
 				send_ibuf[jj] = ii;
 				jj = ptr_to_dbuf[q];
+				if ( tiled ) {
+					row[4*rs] = l + i;
+					row[4*rs+1] = knsupc;
+					row[4*rs+2] = jj;
+					row[4*rs+3] = 1;
+					++rs;
+				} else {
 				RHS_ITERATE(j) { /* RHS stored in row major in buffer. */
 					send_dbuf[jj++] = x[l + i + j*knsupc];
 				}
+				}
 				++ptr_to_ibuf[q];
 				ptr_to_dbuf[q] += nrhs;
 				++irow;
@@ -530,6 +674,7 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
 			}
 		}
 		}
+		if ( tiled ) dcopy_rhs_tiles(rs, nrhs, tile, row, x, send_dbuf);
 
 		/* ------------------------------------------------------------
 			COMMUNICATE THE (PERMUTED) ROW INDICES AND NUMERICAL VALUES.
@@ -552,6 +697,10 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
 	#endif
 #endif
 
+	if ( nbr ) {
+		recv_ibuf = pxgstrs_nbr_exchange(gstrs_comm, 1, nrhs, send_ibuf,
+						 send_dbuf, recv_dbuf, MPI_DOUBLE);
+	} else {
 	MPI_Barrier( grid->comm );
 	Nreq_send=0;
 	Nreq_recv=0;
@@ -603,6 +752,7 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
 
 	if(Nreq_send>0)MPI_Waitall(Nreq_send,req_send,status_send);
 	if(Nreq_recv>0)MPI_Waitall(Nreq_recv,req_recv,status_recv);
+	}
 	// MPI_Barrier( grid->comm );
 
 
@@ -612,17 +762,31 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
 		for (i = 0, k = 0; i < m_loc; ++i) {
 		irow = recv_ibuf[i];
 		irow -= fst_row; /* Relative row number */
+		if ( tiled ) {
+			row[4*i] = k;
+			row[4*i+1] = 1;
+			row[4*i+2] = irow;
+			row[4*i+3] = ldb;
+			k += nrhs;
+		} else {
 		RHS_ITERATE(j) { /* RHS is stored in row major in the buffer. */
 			B[irow + j*ldb] = recv_dbuf[k++];
 		}
 		}
+		}
+		if ( tiled ) {
+			dcopy_rhs_tiles(m_loc, nrhs, tile, row, recv_dbuf, B);
+			SUPERLU_FREE(row);
+		}
 
-    SUPERLU_FREE(send_ibuf);
-    SUPERLU_FREE(send_dbuf);
-	SUPERLU_FREE(req_send);
-	SUPERLU_FREE(req_recv);
-	SUPERLU_FREE(status_send);
-	SUPERLU_FREE(status_recv);
+		if ( !nbr ) {
+			SUPERLU_FREE(send_ibuf);
+			SUPERLU_FREE(send_dbuf);
+			SUPERLU_FREE(req_send);
+			SUPERLU_FREE(req_recv);
+			SUPERLU_FREE(status_send);
+			SUPERLU_FREE(status_recv);
+		}
 }
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(grid->iam, "Exit pdReDistribute_X_to_B()");
@@ -631,8 +795,76 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
 
 } /* pdReDistribute_X_to_B */
 
+/*! \brief Return the rows of the solve layout owned by this process.
+ *
+ * <pre>
+ * The solve layout keeps the rows of each supernode k of the factors,
+ * numbered as in Pc*Pr*B, on the process owning the diagonal block
+ * (k,k), in increasing k. A right-hand side already in this layout is
+ * solved by pdgstrs() without the redistributions of B to x and of x
+ * back to B, when SOLVEstruct->x_layout = YES; m_loc is then the value
+ * returned by this routine.
+ *
+ * If rows is not NULL, the rows are returned in rows[], which must be of
+ * length at least the return value. Entry i of the local B is then row
+ * rows[i] of Pc*Pr*B on input, and row rows[i] of Pc*X on output.
+ * </pre>
+ */
+int_t
+pdSolveLayout(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid, int_t *rows)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    int_t *xsup = Glu_persist->xsup;
+    int_t i, k, m_loc = 0, nsupers = Glu_persist->supno[n-1] + 1;
+    int iam = grid->iam;
+
+    for (k = 0; k < nsupers; ++k) {
+	if ( iam != PNUM( PROW( k, grid ), PCOL( k, grid ), grid ) ) continue;
+	for (i = xsup[k]; i < xsup[k+1]; ++i) {
+	    if ( rows ) rows[m_loc] = i;
+	    ++m_loc;
+	}
+    }
+    return m_loc;
+}
+
+
 
 
+/* Largest size of the supernodes whose diagonal blocks are inverted
+   within Llu->inv_budget: the inverses of the local diagonal blocks in
+   the size range are added from the smallest up next to the factors. */
+static int
+pdInv_budget_size(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid)
+{
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = LUstruct->Glu_persist->xsup;
+    int_t nsupers = LUstruct->Glu_persist->supno[n-1] + 1, k, *count;
+    int   iam = grid->iam, ldt = 0, size;
+    double avail;
+
+    if ( Llu->inv_budget <= 0.0 ) return INT_MAX;
+    for (k = 0; k < nsupers; ++k) ldt = SUPERLU_MAX(ldt, SuperSize( k ));
+    if ( !(count = intCalloc_dist(ldt + 1)) )
+	ABORT("Malloc fails for count[].");
+    for (k = 0; k < nsupers; ++k)
+	if ( PROW( k, grid ) == MYROW( iam, grid )
+	     && PCOL( k, grid ) == MYCOL( iam, grid ) ) ++count[SuperSize( k )];
+
+    avail = Llu->inv_budget * 1e6 - dLU_local_bytes(n, LUstruct, grid);
+    for (size = Llu->inv_minsize; size <= ldt; ++size) {
+	if ( Llu->inv_maxsize > 0 && size > Llu->inv_maxsize ) break;
+	avail -= 2.0 * count[size] * size * size * sizeof(double);
+	if ( avail < 0.0 ) break;
+    }
+    SUPERLU_FREE(count);
+#if ( PRNTlevel>=1 )
+    if ( size <= ldt && (Llu->inv_maxsize <= 0 || size <= Llu->inv_maxsize) )
+	printf("(%d) .. MemBudget: diagonal blocks inverted up to size %d\n",
+	       iam, size - 1);
+#endif
+    return size - 1;
+}
 
 /*! \brief
  *
@@ -640,31 +872,35 @@ pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb, int_t fst_row,
  * Purpose
  * =======
  *   Compute the inverse of the diagonal blocks of the L and U
- *   triangular matrices.
+ *   triangular matrices, for the supernodes whose size is in
+ *   Llu->inv_minsize:Llu->inv_maxsize (no upper bound if inv_maxsize = 0).
+ *   Linv_bc_ptr[] and Uinv_bc_ptr[] are allocated for these supernodes
+ *   only, and are NULL for the others, which the solves do with TRSM.
+ *   With Llu->inv_budget > 0, the inverses that do not fit in this many
+ *   megabytes next to the local factors are left out, the largest first.
+ *   The blocks are inverted in parallel by the OpenMP threads.
  * </pre>
  */
 void
 pdCompute_Diag_Inv(int_t n, dLUstruct_t *LUstruct,gridinfo_t *grid,
                    SuperLUStat_t *stat, int *info)
 {
+    dLocalLU_t *Llu = LUstruct->Llu;
+
+    Llu->inv_pending = 0;
 #ifdef SLU_HAVE_LAPACK
     Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
-    dLocalLU_t *Llu = LUstruct->Llu;
 
     double *lusup;
-    double *recvbuf, *tempv;
     double *Linv;/* Inverse of diagonal block */
     double *Uinv;/* Inverse of diagonal block */
 
     int_t  kcol, krow, mycol, myrow;
-    int_t  i, ii, il, j, jj, k, lb, ljb, lk, lptr, luptr;
-    int_t  nb, nlb,nlb_nodiag, nub, nsupers;
-    int_t  *xsup, *supno, *lsub, *usub;
-    int_t  *ilsum;    /* Starting position of each supernode in lsum (LOCAL)*/
-    int    Pc, Pr, iam;
-    int    knsupc, nsupr;
-    int    ldalsum;   /* Number of lsum entries locally owned. */
-    int    maxrecvsz, p, pi;
+    int_t  i, j, jj, k, lk, ninv;
+    int_t  nsupers;
+    int_t  *xsup, *supno, *lsub;
+    int_t  *invsups;  /* local block columns to invert */
+    int    knsupc, nsupr, maxsize;
     int_t  **Lrowind_bc_ptr;
     double **Lnzval_bc_ptr;
     double **Linv_bc_ptr;
@@ -689,11 +925,8 @@ pdCompute_Diag_Inv(int_t n, dLUstruct_t *LUstruct,gridinfo_t *grid,
     /*
      * Initialization.
      */
-    iam = grid->iam;
-    Pc = grid->npcol;
-    Pr = grid->nprow;
-    myrow = MYROW( iam, grid );
-    mycol = MYCOL( iam, grid );
+    myrow = MYROW( grid->iam, grid );
+    mycol = MYCOL( grid->iam, grid );
     xsup = Glu_persist->xsup;
     supno = Glu_persist->supno;
     nsupers = supno[n-1] + 1;
@@ -701,54 +934,80 @@ pdCompute_Diag_Inv(int_t n, dLUstruct_t *LUstruct,gridinfo_t *grid,
     Linv_bc_ptr = Llu->Linv_bc_ptr;
     Uinv_bc_ptr = Llu->Uinv_bc_ptr;
     Lnzval_bc_ptr = Llu->Lnzval_bc_ptr;
-    nlb = CEILING( nsupers, Pr ); /* Number of local block rows. */
 
     Llu->inv = 1;
 
     /*---------------------------------------------------
-     * Compute inverse of L(lk,lk).
+     * Allocate the inverses of the diagonal blocks in the
+     * size range, and free those outside of it.
+     *---------------------------------------------------*/
+    if ( !(invsups = intMalloc_dist(CEILING( nsupers, grid->npcol ) + 1)) )
+	ABORT("Malloc fails for invsups[].");
+    maxsize = pdInv_budget_size(n, LUstruct, grid);
+    ninv = 0;
+    for (k = 0; k < nsupers; ++k) {
+        krow = PROW( k, grid );
+        kcol = PCOL( k, grid );
+	if ( myrow == krow && mycol == kcol ) { /* diagonal process */
+	    lk = LBj( k, grid ); /* Local block number, column-wise. */
+	    knsupc = SuperSize( k );
+	    if ( knsupc >= Llu->inv_minsize && knsupc <= maxsize &&
+		 (Llu->inv_maxsize <= 0 || knsupc <= Llu->inv_maxsize) ) {
+		if ( !Linv_bc_ptr[lk] ) {
+		    if ( !(Linv_bc_ptr[lk] = (double*)SUPERLU_MALLOC(knsupc*knsupc * sizeof(double))) )
+			ABORT("Malloc fails for Linv_bc_ptr[lk][]");
+		    if ( !(Uinv_bc_ptr[lk] = (double*)SUPERLU_MALLOC(knsupc*knsupc * sizeof(double))) )
+			ABORT("Malloc fails for Uinv_bc_ptr[lk][]");
+		}
+		invsups[ninv++] = k;
+	    } else if ( Linv_bc_ptr[lk] ) {
+		SUPERLU_FREE(Linv_bc_ptr[lk]);
+		SUPERLU_FREE(Uinv_bc_ptr[lk]);
+		Linv_bc_ptr[lk] = Uinv_bc_ptr[lk] = NULL;
+	    }
+	}
+    }
+
+    /*---------------------------------------------------
+     * Compute inverse of L(lk,lk) and U(lk,lk).
      *---------------------------------------------------*/
+#ifdef _OPENMP
+#pragma omp parallel for private (i,j,k,lk,lsub,lusup,Linv,Uinv,nsupr,knsupc,INFO) schedule(dynamic)
+#endif
+    for (jj = 0; jj < ninv; ++jj) {
+	k = invsups[jj];
+	lk = LBj( k, grid ); /* Local block number, column-wise. */
+	lsub = Lrowind_bc_ptr[lk];
+	lusup = Lnzval_bc_ptr[lk];
+	Linv = Linv_bc_ptr[lk];
+	Uinv = Uinv_bc_ptr[lk];
+	nsupr = lsub[1];
+	knsupc = SuperSize( k );
+
+	for (j=0 ; j<knsupc; j++){
+	    for (i=0 ; i<knsupc; i++){
+		Linv[j*knsupc+i] = zero;
+		Uinv[j*knsupc+i] = zero;
+	    }
+	}
+
+	for (j=0 ; j<knsupc; j++){
+	    Linv[j*knsupc+j] = one;
+	    for (i=j+1 ; i<knsupc; i++){
+		Linv[j*knsupc+i] = lusup[j*nsupr+i];
+	    }
+	    for (i=0 ; i<j+1; i++){
+		Uinv[j*knsupc+i] = lusup[j*nsupr+i];
+	    }
+	}
+
+	/* Triangular inversion */
+	dtrtri_("L","U",&knsupc,Linv,&knsupc,&INFO);
+
+	dtrtri_("U","N",&knsupc,Uinv,&knsupc,&INFO);
+    } /* end for jj ... */
 
-     for (k = 0; k < nsupers; ++k) {
-         krow = PROW( k, grid );
-	 if ( myrow == krow ) {
-	     lk = LBi( k, grid );    /* local block number */
-	     kcol = PCOL( k, grid );
-	     if ( mycol == kcol ) { /* diagonal process */
-
-	     	  lk = LBj( k, grid ); /* Local block number, column-wise. */
-		  lsub = Lrowind_bc_ptr[lk];
-		  lusup = Lnzval_bc_ptr[lk];
-		  Linv = Linv_bc_ptr[lk];
-		  Uinv = Uinv_bc_ptr[lk];
-		  nsupr = lsub[1];
-		  knsupc = SuperSize( k );
-
-		  for (j=0 ; j<knsupc; j++){
-		      for (i=0 ; i<knsupc; i++){
-		  	  Linv[j*knsupc+i] = zero;
-			  Uinv[j*knsupc+i] = zero;
-		      }
-	          }
-
-	   	  for (j=0 ; j<knsupc; j++){
-		      Linv[j*knsupc+j] = one;
-		      for (i=j+1 ; i<knsupc; i++){
-		          Linv[j*knsupc+i] = lusup[j*nsupr+i];
-		      }
-		      for (i=0 ; i<j+1; i++){
-			  Uinv[j*knsupc+i] = lusup[j*nsupr+i];
-	              }
- 		  }
-
-		  /* Triangular inversion */
-   		  dtrtri_("L","U",&knsupc,Linv,&knsupc,&INFO);
-
-		  dtrtri_("U","N",&knsupc,Uinv,&knsupc,&INFO);
-
-	    } /* end if (mycol === kcol) */
-	} /* end if (myrow === krow) */
-    } /* end fo k = ... nsupers */
+    SUPERLU_FREE(invsups);
 
 #if ( PROFlevel>=1 )
     if( grid->iam==0 ) {
@@ -762,6 +1021,610 @@ pdCompute_Diag_Inv(int_t n, dLUstruct_t *LUstruct,gridinfo_t *grid,
 #endif /* SLU_HAVE_LAPACK */
 }
 
+/*! \brief Request the inverses of the diagonal blocks for the next solve.
+ *
+ * <pre>
+ * The inverses of the supernodes of sizes
+ * options->DiagInv_MinSize:options->DiagInv_MaxSize are computed by the
+ * first call to pdgstrs() after this, with pdCompute_Diag_Inv(), within
+ * options->MemBudget.
+ * </pre>
+ */
+void
+pdDefer_Diag_Inv(superlu_dist_options_t *options, dLUstruct_t *LUstruct)
+{
+    dLocalLU_t *Llu = LUstruct->Llu;
+
+    Llu->inv_minsize = options->DiagInv_MinSize;
+    Llu->inv_maxsize = options->DiagInv_MaxSize;
+    Llu->inv_budget = options->MemBudget;
+    Llu->inv_pending = 1;
+}
+
+
+/* Set up the arrays of the pruned solves, and the supernodal etree of L:
+   sparent[k] is the first block row below the diagonal in block column k,
+   or nsupers at a root. As L has the structure of the Cholesky factor of
+   Pc(A'+A)Pc', the blocks L(i,k) and U(k,i) are on the path from k to
+   the root. */
+static void
+dgstrs_prune_init(int_t nsupers, dLocalLU_t *Llu, gridinfo_t *grid,
+		  dgstrs_work_t *work)
+{
+    int_t *lsub, k, ik, lb, lk, lptr;
+    int   mycol = MYCOL( grid->iam, grid );
+
+    if ( !(work->sparent = intMalloc_dist(nsupers)) )
+	ABORT("Malloc fails for sparent[].");
+    if ( !(work->prunesups = intMalloc_dist(CEILING( nsupers, grid->nprow ))) )
+	ABORT("Malloc fails for prunesups[].");
+    if ( !(work->active = SUPERLU_MALLOC(2 * nsupers * sizeof(int))) )
+	ABORT("Malloc fails for active[].");
+    work->needed = work->active + nsupers;
+
+    for (k = 0; k < nsupers; ++k) work->sparent[k] = nsupers;
+    for (lk = 0; lk < CEILING( nsupers, grid->npcol ); ++lk) {
+	k = mycol + lk * grid->npcol;
+	if ( k >= nsupers || !(lsub = Llu->Lrowind_bc_ptr[lk]) ) continue;
+	lptr = BC_HEADER;
+	for (lb = 0; lb < lsub[0]; ++lb) {
+	    ik = lsub[lptr];
+	    if ( ik > k ) work->sparent[k] = SUPERLU_MIN( work->sparent[k], ik );
+	    lptr += LB_DESCRIPTOR + lsub[lptr+1];
+	}
+    }
+    MPI_Allreduce(MPI_IN_PLACE, work->sparent, nsupers, mpi_int_t, MPI_MIN,
+		  grid->comm);
+}
+
+/* Add to the marked supernodes all those on their paths to the root. */
+static void
+dgstrs_mark_paths(int_t nsupers, int_t *sparent, int *mark)
+{
+    int_t k;
+
+    for (k = 0; k < nsupers; ++k)
+	if ( mark[k] && sparent[k] < nsupers ) mark[sparent[k]] = 1;
+}
+
+/* Prune the L-solve to the supernodes reached from the nonzeros of B if
+   sparse is set, and to those below the root work->kroot. On entry, x
+   holds B. The X[k] of the other supernodes are 0, or solved later by
+   dgstrs_root_solve(): they are neither solved nor sent. Their blocks
+   are taken off the counts fmod[] of the active rows, the messages they
+   would cause are not expected, and the active leaves are listed in
+   leafsups[]; the off-diagonal processes left with nothing to wait for
+   send their lsum[] (0) at once. Returns the number of leaves. */
+static int_t
+dgstrs_prune_fwd(int_t nsupers, int sparse, int nrhs, double *x,
+		 double *lsum, int_t *fmod, int_t *nfrecvx, int_t *nfrecvmod,
+		 int_t *leafsups, int_t *xsup, dLocalLU_t *Llu,
+		 gridinfo_t *grid, dgstrs_work_t *work)
+{
+    int_t *ilsum = Llu->ilsum, *lsub;
+    int   *mark = work->active;
+    int   iam = grid->iam, myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+    int   aln_i = ceil(CACHELINE/(double)sizeof(int_t)), knsupc;
+    int_t i, ii, il, k, ik, lb, lk, lptr, nleaf = 0;
+    RdTree *LRtree_ptr = Llu->LRtree_ptr;
+
+    /* The supernodes where B is nonzero, on their diagonal processes. */
+    for (k = 0; k < nsupers; ++k) mark[k] = !sparse;
+    if ( sparse ) {
+	for (lk = 0; lk < CEILING( nsupers, grid->nprow ); ++lk) {
+	    k = myrow + lk * grid->nprow;
+	    if ( k >= nsupers || mycol != PCOL( k, grid ) ) continue;
+	    knsupc = SuperSize( k );
+	    ii = X_BLK( lk );
+	    for (i = 0; i < knsupc * nrhs; ++i)
+		if ( x[ii + i] != 0.0 ) { mark[k] = 1; break; }
+	}
+	MPI_Allreduce(MPI_IN_PLACE, mark, nsupers, MPI_INT, MPI_MAX, grid->comm);
+	dgstrs_mark_paths(nsupers, work->sparent, mark);
+    }
+    for (k = work->kroot; k < nsupers; ++k) mark[k] = 0;
+
+    for (lk = 0; lk < CEILING( nsupers, grid->npcol ); ++lk) {
+	k = mycol + lk * grid->npcol;
+	if ( k >= nsupers || mark[k] || !(lsub = Llu->Lrowind_bc_ptr[lk]) )
+	    continue;
+	if ( myrow != PROW( k, grid ) ) --(*nfrecvx); /* X[k] is not sent. */
+	lptr = BC_HEADER;
+	for (lb = 0; lb < lsub[0]; ++lb) {
+	    ik = lsub[lptr];
+	    if ( ik != k && mark[ik] ) --fmod[LBi( ik, grid ) * aln_i];
+	    lptr += LB_DESCRIPTOR + lsub[lptr+1];
+	}
+    }
+
+    for (lk = 0; lk < CEILING( nsupers, grid->nprow ); ++lk) {
+	k = myrow + lk * grid->nprow;
+	if ( k >= nsupers ) break;
+	if ( !mark[k] ) {
+	    *nfrecvmod -= work->frecv_init[lk];
+	    fmod[lk*aln_i] += nsupers + 1; /* Never reaches 0. */
+	} else if ( fmod[lk*aln_i] == 0 ) {
+	    if ( mycol == PCOL( k, grid ) ) {
+		leafsups[nleaf++] = k;
+	    } else if ( work->fmod_init[lk*aln_i] > 0 ) {
+		il = LSUM_BLK( lk );
+		RdTree_forwardMessageSimple(LRtree_ptr[lk], &lsum[il - LSUM_H],
+			RdTree_GetMsgSize(LRtree_ptr[lk],'d')*nrhs+LSUM_H, 'd');
+	    }
+	}
+    }
+    return nleaf;
+}
+
+/* Prune the U-solve to the supernodes of the rows out_rows[] of X, if
+   out_rows is not NULL, and to those they depend on, on their paths to
+   the root; the supernodes from work->kroot on are already solved by
+   dgstrs_root_solve(). The other X[k] are not computed: the counts
+   bmod[] of their rows never reach 0, and the messages they would cause
+   are not expected. The blocks of the solved root are applied here to
+   lsum[], and the rows left with nothing to wait for are added to X[k]
+   on the diagonal process, or sent at once. The roots solved first are
+   listed in rootsups[]. Returns the number of roots. */
+static int_t
+dgstrs_prune_bwd(int_t nsupers, int_t nout_rows, int_t *out_rows,
+		 int_t *perm_c, int_t *supno, int nrhs, double *x,
+		 double *lsum, int_t *bmod, int_t *nbrecvx, int_t *nbrecvmod,
+		 int_t *rootsups, int_t *xsup, dLocalLU_t *Llu,
+		 gridinfo_t *grid, dgstrs_work_t *work, SuperLUStat_t *stat)
+{
+    int_t *Urbs = Llu->Urbs, *ilsum = Llu->ilsum, *usub;
+    Ucb_indptr_t **Ucb_indptr = Llu->Ucb_indptr;
+    int_t **Ucb_valptr = Llu->Ucb_valptr;
+    RdTree *URtree_ptr = Llu->URtree_ptr;
+    int   *mark = work->needed;
+    int   iam = grid->iam, myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+    int   aln_i = ceil(CACHELINE/(double)sizeof(int_t)), knsupc, iknsupc;
+    int_t i, ii, il, j, jj, k, gik, ik, lk, ub, fnz, irow, uptr, nroot = 0;
+    int_t r0 = FstBlockC( work->kroot ), r = FstBlockC( nsupers ) - r0;
+    double *uval, *xk;
+
+    for (k = 0; k < nsupers; ++k) mark[k] = !out_rows;
+    if ( out_rows ) {
+	for (i = 0; i < nout_rows; ++i) mark[supno[perm_c[out_rows[i]]]] = 1;
+	dgstrs_mark_paths(nsupers, work->sparent, mark);
+    }
+    for (k = work->kroot; k < nsupers; ++k) mark[k] = 0;
+
+    for (lk = 0; lk < CEILING( nsupers, grid->npcol ); ++lk) {
+	k = mycol + lk * grid->npcol;
+	if ( k < nsupers && !mark[k] && Urbs[lk] > 0 && myrow != PROW( k, grid ) )
+	    --(*nbrecvx); /* X[k] is not sent. */
+	if ( k < work->kroot || k >= nsupers ) continue;
+
+	/* lsum[i] -= U_i,k * X[k] for the root supernode k. */
+	knsupc = SuperSize( k );
+	xk = &work->rootx[FstBlockC( k ) - r0];
+	for (ub = 0; ub < Urbs[lk]; ++ub) {
+	    ik = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
+	    gik = ik * grid->nprow + myrow;
+	    if ( !mark[gik] ) continue;
+	    usub = &Llu->Ufstnz_br_ptr[ik][Ucb_indptr[lk][ub].indpos + UB_DESCRIPTOR];
+	    uval = &Llu->Unzval_br_ptr[ik][Ucb_valptr[lk][ub]];
+	    il = LSUM_BLK( ik );
+	    iknsupc = SuperSize( gik );
+	    RHS_ITERATE(j) {
+		uptr = 0;
+		for (jj = 0; jj < knsupc; ++jj) {
+		    fnz = usub[jj];
+		    for (irow = fnz; irow < FstBlockC( gik+1 ); ++irow)
+			lsum[il + irow - FstBlockC( gik ) + j*iknsupc] -=
+			    uval[uptr++] * xk[jj + j*r];
+		    stat->ops[SOLVE] += 2 * (FstBlockC( gik+1 ) - fnz);
+		}
+	    }
+	    --bmod[ik*aln_i];
+	}
+    }
+
+    for (lk = 0; lk < CEILING( nsupers, grid->nprow ); ++lk) {
+	k = myrow + lk * grid->nprow;
+	if ( k >= nsupers ) break;
+	if ( !mark[k] ) {
+	    *nbrecvmod -= work->brecv_init[lk];
+	    bmod[lk*aln_i] += nsupers + 1; /* Never reaches 0. */
+	} else if ( bmod[lk*aln_i] == 0 ) {
+	    il = LSUM_BLK( lk );
+	    if ( mycol == PCOL( k, grid ) ) {
+		knsupc = SuperSize( k );
+		ii = X_BLK( lk );
+		for (i = 0; i < knsupc * nrhs; ++i) {
+		    x[ii + i] += lsum[il + i];
+		    lsum[il + i] = 0.0;
+		}
+		rootsups[nroot++] = k;
+	    } else if ( work->bmod_init[lk*aln_i] > 0 ) {
+		RdTree_forwardMessageSimple(URtree_ptr[lk], &lsum[il - LSUM_H],
+			RdTree_GetMsgSize(URtree_ptr[lk],'d')*nrhs+LSUM_H, 'd');
+	    }
+	}
+    }
+    return nroot;
+}
+
+/* The solve is at supernode k: read the values of L, and of U in the
+   U-solve, ahead from there when they are in files (options->OutOfCore),
+   forward in the L-solve (fwd = 1) and backward in the U-solve. */
+static void
+dgstrs_ooc_ahead(int_t k, int fwd, dLocalLU_t *Llu, gridinfo_t *grid)
+{
+    int_t lk = LBj( k, grid );
+
+    if ( Llu->Lnzval_ooc.base && Llu->Lnzval_bc_ptr[lk] )
+	superlu_ooc_ahead(&Llu->Lnzval_ooc, Llu->Lnzval_bc_ptr[lk], fwd);
+    lk = LBi( k, grid );
+    if ( !fwd && Llu->Unzval_ooc.base && Llu->Unzval_br_ptr[lk] )
+	superlu_ooc_ahead(&Llu->Unzval_ooc, Llu->Unzval_br_ptr[lk], fwd);
+}
+
+/* Set up the top of the etree solved on all the processes: the blocks of
+   L and U in the supernodes from work->kroot on are gathered into the
+   dense rootLU, which holds their unit lower L and U as dgetrf() does.
+   Each entry is on one process, the others add 0. */
+static void
+dgstrs_root_init(int_t nsupers, int nrhs, dLocalLU_t *Llu, gridinfo_t *grid,
+		 dgstrs_work_t *work, int_t *xsup)
+{
+    int_t *lsub, *usub, b, c, gb, gj, lb, ljb, pos, luptr, uptr, t, irow, fnz;
+    int_t r0 = FstBlockC( work->kroot ), r = FstBlockC( nsupers ) - r0;
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    int   knsupc, nsupr;
+    double *LU, *lusup, *uval;
+
+    if ( !(work->rootLU = doubleCalloc_dist(r * r)) )
+	ABORT("Calloc fails for rootLU[].");
+    if ( !(work->rootx = doubleMalloc_dist(r * nrhs)) )
+	ABORT("Malloc fails for rootx[].");
+    LU = work->rootLU;
+
+    /* The L blocks, and the diagonal blocks, of the root block columns. */
+    for (ljb = 0; ljb < CEILING( nsupers, grid->npcol ); ++ljb) {
+	gb = ljb * grid->npcol + mycol;
+	if ( gb < work->kroot || gb >= nsupers
+	     || !(lsub = Llu->Lrowind_bc_ptr[ljb]) ) continue;
+	lusup = Llu->Lnzval_bc_ptr[ljb];
+	knsupc = SuperSize( gb );
+	nsupr = lsub[1];
+	for (b = 0, pos = BC_HEADER, luptr = 0; b < lsub[0]; ++b) {
+	    for (t = 0; t < lsub[pos+1]; ++t) {
+		irow = lsub[pos + LB_DESCRIPTOR + t] - r0;
+		for (c = 0; c < knsupc; ++c)
+		    LU[irow + (FstBlockC( gb ) + c - r0) * r] =
+			lusup[luptr + t + c*nsupr];
+	    }
+	    luptr += lsub[pos+1];
+	    pos += LB_DESCRIPTOR + lsub[pos+1];
+	}
+    }
+
+    /* The U blocks of the root block rows. */
+    for (lb = 0; lb < CEILING( nsupers, grid->nprow ); ++lb) {
+	gb = lb * grid->nprow + myrow;
+	if ( gb < work->kroot || gb >= nsupers
+	     || !(usub = Llu->Ufstnz_br_ptr[lb]) ) continue;
+	uval = Llu->Unzval_br_ptr[lb];
+	for (b = 0, pos = BR_HEADER, uptr = 0; b < usub[0]; ++b) {
+	    gj = usub[pos];
+	    knsupc = SuperSize( gj );
+	    for (c = 0; c < knsupc; ++c) {
+		fnz = usub[pos + UB_DESCRIPTOR + c];
+		for (irow = fnz; irow < FstBlockC( gb+1 ); ++irow)
+		    LU[irow - r0 + (FstBlockC( gj ) + c - r0) * r] = uval[uptr++];
+	    }
+	    pos += UB_DESCRIPTOR + knsupc;
+	}
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, LU, r * r, MPI_DOUBLE, MPI_SUM, grid->comm);
+}
+
+/* Solve for the X[k] of the root supernodes, k >= work->kroot, once the
+   pruned L-solve is done: their lsum[] and B are summed over all the
+   processes, each process solves with the dense rootLU, and the
+   diagonal processes keep X[k] in x[] for the U-solve. In the
+   Reproducible mode the contributions are gathered and added in the
+   order of the processes. */
+static void
+dgstrs_root_solve(int_t nsupers, int nrhs, double *x, double *lsum,
+		  int_t *xsup, dLocalLU_t *Llu, gridinfo_t *grid,
+		  dgstrs_work_t *work, SuperLUStat_t *stat)
+{
+    int_t *ilsum = Llu->ilsum;
+    int_t r0 = FstBlockC( work->kroot ), r = FstBlockC( nsupers ) - r0;
+    int_t i, ii, il, j, k, lk, p, th;
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    int   procs = grid->nprow * grid->npcol, knsupc, nr = r, nn = nrhs;
+    double alpha = 1.0, *w = work->rootx, *dest, *buf;
+
+    for (i = 0; i < r * nrhs; ++i) w[i] = 0.0;
+    for (lk = 0; lk < CEILING( nsupers, grid->nprow ); ++lk) {
+	k = myrow + lk * grid->nprow;
+	if ( k < work->kroot ) continue;
+	if ( k >= nsupers ) break;
+	knsupc = SuperSize( k );
+	il = LSUM_BLK( lk );
+	dest = &w[FstBlockC( k ) - r0];
+	for (th = 0; th < work->nlsum; ++th)
+	    RHS_ITERATE(j)
+		for (i = 0; i < knsupc; ++i)
+		    dest[i + j*r] += lsum[il + i + j*knsupc + th*work->sizelsum];
+	if ( mycol == PCOL( k, grid ) ) {
+	    ii = X_BLK( lk );
+	    RHS_ITERATE(j)
+		for (i = 0; i < knsupc; ++i) dest[i + j*r] += x[ii + i + j*knsupc];
+	}
+    }
+
+    if ( Llu->fixed_order ) {
+	if ( !(buf = doubleMalloc_dist(r * nrhs * procs)) )
+	    ABORT("Malloc fails for buf[].");
+	MPI_Allgather(w, r * nrhs, MPI_DOUBLE, buf, r * nrhs, MPI_DOUBLE,
+		      grid->comm);
+	for (i = 0; i < r * nrhs; ++i) w[i] = 0.0;
+	for (p = 0; p < procs; ++p)
+	    for (i = 0; i < r * nrhs; ++i) w[i] += buf[i + p * r * nrhs];
+	SUPERLU_FREE(buf);
+    } else {
+	MPI_Allreduce(MPI_IN_PLACE, w, r * nrhs, MPI_DOUBLE, MPI_SUM,
+		      grid->comm);
+    }
+
+#if defined (USE_VENDOR_BLAS)
+    dtrsm_("L", "L", "N", "U", &nr, &nn, &alpha, work->rootLU, &nr, w, &nr,
+	   1, 1, 1, 1);
+    dtrsm_("L", "U", "N", "N", &nr, &nn, &alpha, work->rootLU, &nr, w, &nr,
+	   1, 1, 1, 1);
+#else
+    dtrsm_("L", "L", "N", "U", &nr, &nn, &alpha, work->rootLU, &nr, w, &nr);
+    dtrsm_("L", "U", "N", "N", &nr, &nn, &alpha, work->rootLU, &nr, w, &nr);
+#endif
+    stat->ops[SOLVE] += 2 * r * r * nrhs;
+
+    for (lk = 0; lk < CEILING( nsupers, grid->nprow ); ++lk) {
+	k = myrow + lk * grid->nprow;
+	if ( k >= nsupers ) break;
+	if ( k < work->kroot || mycol != PCOL( k, grid ) ) continue;
+	knsupc = SuperSize( k );
+	ii = X_BLK( lk );
+	dest = &w[FstBlockC( k ) - r0];
+	RHS_ITERATE(j)
+	    for (i = 0; i < knsupc; ++i) x[ii + i + j*knsupc] = dest[i + j*r];
+    }
+}
+
+/* Compute the level sets of the L-solve on one process: a supernode is
+   one level above the highest of the supernodes it depends on, the
+   leaves are at level 0. The supernodes are listed in lvlsups[] by
+   increasing level, a topological order of the L-solve. */
+static void
+dgstrs_levels(int_t nsupers, dLocalLU_t *Llu, dgstrs_work_t *work)
+{
+    int_t *level, *lsub, k, ik, lb, lptr, l;
+
+    if ( !(level = intCalloc_dist(nsupers)) )
+	ABORT("Calloc fails for level[].");
+    if ( !(work->lvlsups = intMalloc_dist(nsupers)) )
+	ABORT("Malloc fails for lvlsups[].");
+    work->nlevels = 0;
+    for (k = 0; k < nsupers; ++k) {
+	work->nlevels = SUPERLU_MAX( work->nlevels, level[k] + 1 );
+	if ( !(lsub = Llu->Lrowind_bc_ptr[k]) ) continue;
+	lptr = BC_HEADER;
+	for (lb = 0; lb < lsub[0]; ++lb) {
+	    ik = lsub[lptr]; /* Block row of L(ik,k), ik >= k. */
+	    if ( ik != k ) level[ik] = SUPERLU_MAX( level[ik], level[k] + 1 );
+	    lptr += LB_DESCRIPTOR + lsub[lptr+1];
+	}
+    }
+
+    if ( !(work->lvlptr = intCalloc_dist(work->nlevels + 1)) )
+	ABORT("Calloc fails for lvlptr[].");
+    for (k = 0; k < nsupers; ++k) ++work->lvlptr[level[k] + 1];
+    for (l = 0; l < work->nlevels; ++l) work->lvlptr[l+1] += work->lvlptr[l];
+    for (k = 0; k < nsupers; ++k) /* lvlptr[l] is the next free slot of level l. */
+	work->lvlsups[work->lvlptr[level[k]]++] = k;
+    for (l = work->nlevels; l > 0; --l) work->lvlptr[l] = work->lvlptr[l-1];
+    work->lvlptr[0] = 0;
+    SUPERLU_FREE(level);
+}
+
+/* Set up the workspace of pdgstrs() for nrhs right-hand sides: the
+   counts at the start of the L- and U-solves, the blocks that are solved
+   first, and the buffers. They depend only on L, U and the trees, and are
+   kept in SOLVEstruct->gstrs_work until dSolveWorkFree(). */
+static dgstrs_work_t *
+dgstrs_work_create(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid,
+		   int nrhs, int num_thread, int maxrecvsz, int root_size,
+		   SuperLUStat_t *stat)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    RdTree *LRtree_ptr = Llu->LRtree_ptr, *URtree_ptr = Llu->URtree_ptr;
+    dgstrs_work_t *work;
+    int_t *xsup = Glu_persist->xsup;
+    int_t nsupers = Glu_persist->supno[n-1] + 1, nlb, nsends, lk, gb, i, ii;
+    int   Pr = grid->nprow, Pc = grid->npcol, procs = Pr * Pc;
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    int   iword = sizeof(int_t), dword = sizeof(double);
+    int   aln_d = ceil(CACHELINE/(double)dword);
+    int   aln_i = ceil(CACHELINE/(double)iword);
+    int   ldalsum = Llu->ldalsum;
+    size_t nrecv;
+
+    if ( !(work = (dgstrs_work_t *) SUPERLU_MALLOC(sizeof(dgstrs_work_t))) )
+	ABORT("Malloc fails for work.");
+    work->nrhs = nrhs;
+    work->num_thread = num_thread;
+    work->maxrecvsz = maxrecvsz;
+    work->root_size = root_size;
+    nlb = CEILING( nsupers, Pr );
+    nsends = (CEILING( nsupers, Pr ) + CEILING( nsupers, Pc )) * aln_i;
+
+    if ( !(work->fmod_init = intMalloc_dist(2 * nlb * aln_i + 2 * nlb)) )
+	ABORT("Malloc fails for fmod_init[].");
+    work->bmod_init = work->fmod_init + nlb * aln_i;
+    work->frecv_init = work->bmod_init + nlb * aln_i;
+    work->brecv_init = work->frecv_init + nlb;
+    if ( !(work->fmod = intMalloc_dist(2 * nlb * aln_i + 2 * nlb)) )
+	ABORT("Malloc fails for fmod[].");
+    work->bmod = work->fmod + nlb * aln_i;
+    work->frecv = work->bmod + nlb * aln_i;
+    work->brecv = work->frecv + nlb;
+    if ( !(work->leafsups = intMalloc_dist(2 * nlb + 2 * nsends + 1)) )
+	ABORT("Malloc fails for leafsups[].");
+    work->rootsups = work->leafsups + nlb;
+    work->leaf_send = work->rootsups + nlb;
+    work->root_send = work->leaf_send + nsends;
+
+    /* The L-solve: fmod[] includes the contributions received in frecv[]. */
+    work->nleaf = work->nfrecvmod = 0;
+    for (lk = 0; lk < nlb; ++lk) {
+	work->frecv_init[lk] = 0;
+	gb = myrow + lk * Pr;
+	if ( procs > 1 && LRtree_ptr[lk] != NULL ) {
+	    work->frecv_init[lk] = RdTree_GetDestCount(LRtree_ptr[lk],'d');
+	    work->nfrecvmod += work->frecv_init[lk];
+	} else if ( gb < nsupers && (procs == 1 || mycol == PCOL( gb, grid ))
+		    && Llu->fmod[lk] == 0 ) {
+	    work->leafsups[work->nleaf++] = gb;
+	}
+	work->fmod_init[lk*aln_i] = Llu->fmod[lk] + work->frecv_init[lk];
+    }
+
+    /* The U-solve. */
+    work->nroot = work->nbrecvmod = 0;
+    for (lk = 0; lk < nlb; ++lk) {
+	work->brecv_init[lk] = 0;
+	gb = myrow + lk * Pr;
+	if ( URtree_ptr[lk] != NULL ) {
+	    work->brecv_init[lk] = RdTree_GetDestCount(URtree_ptr[lk],'d');
+	    work->nbrecvmod += work->brecv_init[lk];
+	} else if ( gb < nsupers && mycol == PCOL( gb, grid )
+		    && Llu->bmod[lk] == 0 ) {
+	    work->rootsups[work->nroot++] = gb;
+	}
+	work->bmod_init[lk*aln_i] = Llu->bmod[lk] + work->brecv_init[lk];
+    }
+
+    /* The level sets of the threaded L-solve on one process. */
+    work->nlevels = 0;
+    work->lvlptr = work->lvlsups = NULL;
+    if ( procs == 1 && num_thread > 1 )
+	dgstrs_levels(nsupers, Llu, work);
+    work->sparent = work->prunesups = NULL;
+    work->active = work->needed = NULL;
+    work->prio = NULL;
+
+    /* The top of the etree solved on all the processes. */
+    work->kroot = nsupers;
+    while ( work->kroot > 0 && n - FstBlockC( work->kroot - 1 ) <= root_size )
+	--work->kroot;
+    work->rootLU = work->rootx = NULL;
+    work->tdone = NULL;
+    if ( work->kroot < nsupers )
+	dgstrs_root_init(nsupers, nrhs, Llu, grid, work, xsup);
+
+    work->sizelsum = (((size_t)ldalsum)*nrhs + nlb*LSUM_H);
+    work->sizelsum = ((work->sizelsum + (aln_d - 1)) / aln_d) * aln_d;
+    /* A copy of lsum[] per thread, or one shared copy updated with
+       atomic adds, see pxgstrs_lsum_shared(). The fixed summation order
+       keeps the copies. */
+    work->lsum_shared = !Llu->fixed_order
+	 && pxgstrs_lsum_shared(work->sizelsum * dword, num_thread);
+    work->nlsum = work->lsum_shared ? 1 : num_thread;
+    if ( !(work->lsum = (double*)SUPERLU_MALLOC(work->sizelsum*work->nlsum * sizeof(double))))
+	ABORT("Malloc fails for lsum[].");
+    if ( !(work->x = doubleMalloc_dist(ldalsum * nrhs + nlb * XK_H)) )
+	ABORT("Malloc fails for x[].");
+    work->sizertemp = ldalsum * nrhs;
+    work->sizertemp = ((work->sizertemp + (aln_d - 1)) / aln_d) * aln_d;
+    if ( !(work->rtemp = (double*)SUPERLU_MALLOC((work->sizertemp*num_thread + 1) * sizeof(double))) )
+	ABORT("Malloc fails for rtemp[].");
+#ifdef _OPENMP
+#pragma omp parallel default(shared) private(ii)
+    {
+	int thread_id=omp_get_thread_num();
+	for ( ii=0; ii<work->sizertemp; ii++ )
+		work->rtemp[thread_id*work->sizertemp+ii]=0.0;
+    }
+#else
+    for ( ii=0; ii<work->sizertemp*num_thread; ii++ )
+	work->rtemp[ii]=0.0;
+#endif
+    /* The X[k] received are kept in place, and the other messages go
+       through the slots of the receives posted, see pxgstrs_ring_init(). */
+    nrecv = SUPERLU_MAX( Llu->nfrecvx, Llu->nbrecvx ) + pxgstrs_ring_slots(grid);
+    work->nrecvbuf = nrecv;
+    if ( !(work->recvbuf = (double*)superlu_malloc_comm(maxrecvsz * nrecv * sizeof(double))) )
+	ABORT("Malloc fails for recvbuf[].");
+    work->agg = ( procs > 1 ) ? pxgstrs_agg_init(maxrecvsz * sizeof(double), grid)
+			      : NULL;
+    /* The messages by source of the L- and U-solves, recorded by the
+       first solve that is not pruned to B or X. */
+    if ( !(work->plan = (int *) SUPERLU_MALLOC(2 * (procs + 1) * sizeof(int))) )
+	ABORT("Malloc fails for plan[].");
+    work->plan[procs] = work->plan[2 * procs + 1] = -1;
+
+    if ( !(work->stat_loc = (SuperLUStat_t**) SUPERLU_MALLOC(num_thread*sizeof(SuperLUStat_t*))) )
+	ABORT("Malloc fails for stat_loc[].");
+    for ( i=0; i<num_thread; i++) {
+	work->stat_loc[i] = (SuperLUStat_t*)SUPERLU_MALLOC(sizeof(SuperLUStat_t));
+	PStatInit(work->stat_loc[i]);
+    }
+
+    log_memory((4*nlb*aln_i + 6*nlb + 2*nsends + (work->lvlptr ? nsupers + work->nlevels + 1 : 0))*iword + work->sizelsum*work->nlsum * dword + (ldalsum * nrhs + nlb * XK_H) *dword + (work->sizertemp*num_thread + 1)*dword + maxrecvsz*nrecv*dword, stat);	//account for fmod, frecv, bmod, brecv, leafsups, rootsups, leaf_send, root_send, lvlptr, lvlsups, lsum, x, rtemp, recvbuf
+    return work;
+}
+
+/*! \brief Release the workspace kept by pdgstrs() in SOLVEstruct.
+ *
+ * <pre>
+ * It is released by dSolveFinalize(), and by pdgssvx() when L and U are
+ * computed again.
+ * </pre>
+ */
+void
+dSolveWorkFree(dSOLVEstruct_t *SOLVEstruct)
+{
+    dgstrs_work_t *work = SOLVEstruct->gstrs_work;
+    int i;
+
+    if ( !work ) return;
+    for (i = 0; i < work->num_thread; i++) {
+	PStatFree(work->stat_loc[i]);
+	SUPERLU_FREE(work->stat_loc[i]);
+    }
+    SUPERLU_FREE(work->stat_loc);
+    SUPERLU_FREE(work->fmod_init);
+    SUPERLU_FREE(work->fmod);
+    SUPERLU_FREE(work->leafsups);
+    if ( work->lvlptr ) SUPERLU_FREE(work->lvlptr);
+    if ( work->lvlsups ) SUPERLU_FREE(work->lvlsups);
+    if ( work->sparent ) {
+	SUPERLU_FREE(work->sparent);
+	SUPERLU_FREE(work->prunesups);
+	SUPERLU_FREE(work->active);
+    }
+    if ( work->rootLU ) {
+	SUPERLU_FREE(work->rootLU);
+	SUPERLU_FREE(work->rootx);
+    }
+    if ( work->tdone ) SUPERLU_FREE(work->tdone);
+    if ( work->prio ) SUPERLU_FREE(work->prio);
+    SUPERLU_FREE(work->lsum);
+    SUPERLU_FREE(work->x);
+    SUPERLU_FREE(work->rtemp);
+    superlu_free_comm(work->recvbuf);
+    pxgstrs_agg_free(work->agg);
+    SUPERLU_FREE(work->plan);
+    SUPERLU_FREE(work);
+    SOLVEstruct->gstrs_work = NULL;
+}
+
 
 /*! \brief
  *
@@ -823,6 +1686,19 @@ pdCompute_Diag_Inv(int_t n, dLUstruct_t *LUstruct,gridinfo_t *grid,
  * SOLVEstruct (input) dSOLVEstruct_t* (global)
  *        Contains the information for the communication during the
  *        solution phase.
+ *        With SOLVEstruct->sparse_rhs = YES, the L-solve is restricted
+ *        to the supernodes reached in the etree from the nonzeros of B.
+ *        If SOLVEstruct->out_rows is not NULL, only the nout_rows rows
+ *        out_rows[] of the solution (row numbers of A, the same on all
+ *        the processes) and those they depend on are computed; the
+ *        other rows of X are returned as 0. It is set by the caller
+ *        after dSolveInit(); pdgssvx() should then be called with
+ *        IterRefine = NOREFINE.
+ *        If SOLVEstruct->x_layout = YES, B is in the solve layout of
+ *        pdSolveLayout() instead, with m_loc its number of local rows,
+ *        and fst_row is not used. It is set by the caller after
+ *        dSolveInit() to solve directly with pdgstrs(); the scaling
+ *        and the permutations of B and X are then left to the caller.
  *
  * stat   (output) SuperLUStat_t*
  *        Record the statistics about the triangular solves.
@@ -871,7 +1747,7 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
     int_t  *Urbs = Llu->Urbs; /* Number of row blocks in each block column of U. */
     Ucb_indptr_t **Ucb_indptr = Llu->Ucb_indptr;/* Vertical linked list pointing to Uindex[] */
     int_t  **Ucb_valptr = Llu->Ucb_valptr;      /* Vertical linked list pointing to Unzval[] */
-    int_t  kcol, krow, mycol, myrow;
+    int_t  krow, mycol, myrow;
     int_t  i, ii, il, j, jj, k, kk, lb, ljb, lk, lib, lptr, luptr, gb, nn;
     int_t  nb, nlb,nlb_nodiag, nub, nsupers, nsupers_j, nsupers_i,maxsuper;
     int_t  *xsup, *supno, *lsub, *usub;
@@ -887,7 +1763,11 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
     double **Uinv_bc_ptr;
     double sum;
     MPI_Status status,status_on,statusx,statuslsum;
+    pxgstrs_ring_t ring;  /* pre-posted receives of the L- and U-solve */
+    superlu_progress_t *progress; /* drives the tree messages, if requested */
     pxgstrs_comm_t *gstrs_comm = SOLVEstruct->gstrs_comm;
+    dgstrs_work_t *work;
+    int   *active = NULL, *needed = NULL; /* NULL if the solve is not pruned */
     SuperLUStat_t **stat_loc;
 
     double tmax;
@@ -898,7 +1778,6 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
     int_t fmod_tmp;
     int_t  **fsendx_plist = Llu->fsendx_plist;
     int_t  nfrecvx = Llu->nfrecvx; /* Number of X components to be recv'd. */
-    int_t  nfrecvx_buf=0;
     int_t  *frecv;        /* Count of lsum[lk] contributions to be received
     			 from processes in this row.
     			 It is only valid on the diagonal processes. */
@@ -914,14 +1793,13 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
     int_t  bmod_tmp;
     int_t  **bsendx_plist = Llu->bsendx_plist;
     int_t  nbrecvx = Llu->nbrecvx; /* Number of X components to be recv'd. */
-    int_t  nbrecvx_buf=0;
     int_t  *brecv;        /* Count of modifications to be recv'd from
     			 processes in this row. */
     int_t  nbrecvmod = 0; /* Count of total modifications to be recv'd. */
     int_t flagx,flaglsum,flag;
     int_t *LBTree_active, *LRTree_active, *LBTree_finish, *LRTree_finish, *leafsups, *rootsups;
     int_t TAG;
-    double t1_sol, t2_sol, t;
+    double t1_sol, t2_sol, t, tsolve;
 #if ( DEBUGlevel>=2 )
     int_t Ublocks = 0;
 #endif
@@ -930,6 +1808,7 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
 
     int_t *mod_bit = Llu->mod_bit; /* flag contribution from each row block */
     int INFO, pad;
+    int mem_tag; /* category of the allocations of the caller */
     int_t tmpresult;
 
     // #if ( PROFlevel>=1 )
@@ -955,25 +1834,12 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
     int_t ready;
     int thread_id = 0;
     yes_no_t empty;
-    int_t sizelsum,sizertemp,aln_d,aln_i;
-    aln_d = ceil(CACHELINE/(double)dword);
+    int_t sizelsum,sizertemp,aln_i;
     aln_i = ceil(CACHELINE/(double)iword);
-    int num_thread = 1;
+    int num_thread = superlu_num_threads();
 
 	maxsuper = sp_ienv_dist(3);
 
-
-#ifdef _OPENMP
-#pragma omp parallel default(shared)
-    {
-    	if (omp_get_thread_num () == 0) {
-    		num_thread = omp_get_num_threads ();
-    	}
-    }
-#else
-	num_thread=1;
-#endif
-
 #if ( PRNTlevel>=1 )
     if( grid->iam==0 ) {
 	printf("num_thread: %5d\n", num_thread);
@@ -994,9 +1860,18 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
 	return;
     }
 
+    /* U was dropped for a symmetric A1 = L*D*L^T, see dDrop_U(). */
+    if ( Llu->Udropped ) {
+	pdgstrs_sym(n, LUstruct, ScalePermstruct, grid, B, m_loc, fst_row,
+		    ldb, nrhs, SOLVEstruct, stat, info);
+	return;
+    }
+
     /*
      * Initialization.
      */
+    mem_tag = superlu_mem_tag(SUPERLU_MEM_SOLVE);
+    SUPERLU_PROF_BEGIN(PROF_SOLVE, EMPTY);
     iam = grid->iam;
     Pc = grid->npcol;
     Pr = grid->nprow;
@@ -1023,20 +1898,46 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
     stat->ops[SOLVE] = 0.0;
     Llu->SolveMsgSent = 0;
 
-    /* Save the count to be altered so it can be used by
-       subsequent call to PDGSTRS. */
-    if ( !(fmod = intMalloc_dist(nlb*aln_i)) )
-	ABORT("Malloc fails for fmod[].");
-    for (i = 0; i < nlb; ++i) fmod[i*aln_i] = Llu->fmod[i];
-    if ( !(frecv = intCalloc_dist(nlb)) )
-	ABORT("Calloc fails for frecv[].");
+    /* The trees are created at the first solve, shaped for its nrhs. */
+    superlu_mem_tag(SUPERLU_MEM_TREES);
+    dCreate_Trees(Llu, grid, nrhs);
+    superlu_mem_tag(SUPERLU_MEM_SOLVE);
+
+    /* The diagonal blocks requested by pdDefer_Diag_Inv() are inverted
+       at the first solve. */
+    if ( Llu->inv_pending ) pdCompute_Diag_Inv(n, LUstruct, grid, stat, info);
+    if ( Llu->compact ) dCompact_LU(n, grid, LUstruct);
+
+    /* The counts, leaf and root lists and buffers of the previous call
+       are reused when they were sized for nrhs or more right-hand sides,
+       e.g. by the iterative refinement of fewer and fewer columns. The
+       buffers then keep their larger strides. */
+    knsupc = sp_ienv_dist(3);
+    maxrecvsz = knsupc * nrhs + SUPERLU_MAX( XK_H, LSUM_H );
+    work = SOLVEstruct->gstrs_work;
+    if ( work && (work->nrhs < nrhs || work->num_thread != num_thread
+		  || work->maxrecvsz < maxrecvsz
+		  || work->root_size != SOLVEstruct->root_size) ) {
+	dSolveWorkFree(SOLVEstruct);
+	work = NULL;
+    }
+    if ( !work ) {
+	work = dgstrs_work_create(n, LUstruct, grid, nrhs, num_thread,
+				  maxrecvsz, SOLVEstruct->root_size, stat);
+	SOLVEstruct->gstrs_work = work;
+    }
+    maxrecvsz = work->maxrecvsz;
+
+    /* Reset the counts to be altered. */
+    fmod = work->fmod;
+    frecv = work->frecv;
+    memcpy(fmod, work->fmod_init, nlb * aln_i * sizeof(int_t));
+    memcpy(frecv, work->frecv_init, nlb * sizeof(int_t));
     Llu->frecv = frecv;
 
-    if ( !(leaf_send = intMalloc_dist((CEILING( nsupers, Pr )+CEILING( nsupers, Pc ))*aln_i)) )
-	ABORT("Malloc fails for leaf_send[].");
+    leaf_send = work->leaf_send;
     nleaf_send=0;
-    if ( !(root_send = intMalloc_dist((CEILING( nsupers, Pr )+CEILING( nsupers, Pc ))*aln_i)) )
-	ABORT("Malloc fails for root_send[].");
+    root_send = work->root_send;
     nroot_send=0;
 
 #ifdef _CRAY
@@ -1050,52 +1951,59 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
     ilsum = Llu->ilsum;
     ldalsum = Llu->ldalsum;
 
-    /* Allocate working storage. */
-    knsupc = sp_ienv_dist(3);
-    maxrecvsz = knsupc * nrhs + SUPERLU_MAX( XK_H, LSUM_H );
-    sizelsum = (((size_t)ldalsum)*nrhs + nlb*LSUM_H);
-    sizelsum = ((sizelsum + (aln_d - 1)) / aln_d) * aln_d;
-
+    /* Working storage. */
+    sizelsum = work->sizelsum;
+    lsum = work->lsum;
 #ifdef _OPENMP
-    if ( !(lsum = (double*)SUPERLU_MALLOC(sizelsum*num_thread * sizeof(double))))
-	ABORT("Malloc fails for lsum[].");
 #pragma omp parallel default(shared) private(ii) 
     {
 	int thread_id = omp_get_thread_num(); //mjc
-	for (ii=0; ii<sizelsum; ii++)
-    	    lsum[thread_id*sizelsum+ii]=zero;
+	if ( thread_id < work->nlsum )
+	    for (ii=0; ii<sizelsum; ii++)
+		lsum[thread_id*sizelsum+ii]=zero;
     }
 #else
-    if ( !(lsum = (double*)SUPERLU_MALLOC(sizelsum*num_thread * sizeof(double))))
-  	    ABORT("Malloc fails for lsum[].");
-    for ( ii=0; ii < sizelsum*num_thread; ii++ )
+    for ( ii=0; ii < sizelsum*work->nlsum; ii++ )
 	lsum[ii]=zero;
 #endif
-    if ( !(x = doubleCalloc_dist(ldalsum * nrhs + nlb * XK_H)) )
-	ABORT("Calloc fails for x[].");
+    Llu->lsum_shared = work->lsum_shared;
+    x = work->x;
+    memset(x, 0, (ldalsum * nrhs + nlb * XK_H) * sizeof(double));
 
-    sizertemp=ldalsum * nrhs;
-    sizertemp = ((sizertemp + (aln_d - 1)) / aln_d) * aln_d;
-    if ( !(rtemp = (double*)SUPERLU_MALLOC((sizertemp*num_thread + 1) * sizeof(double))) )
-	ABORT("Malloc fails for rtemp[].");
-#ifdef _OPENMP
-#pragma omp parallel default(shared) private(ii)
-    {
-	int thread_id=omp_get_thread_num();
-	for ( ii=0; ii<sizertemp; ii++ )
-		rtemp[thread_id*sizertemp+ii]=zero;
+    sizertemp = work->sizertemp;
+    rtemp = work->rtemp;
+
+    stat_loc = work->stat_loc;
+    for ( i=0; i<num_thread; i++) {
+	for (j = 0; j < NPHASES; ++j) {
+	    stat_loc[i]->utime[j] = 0.;
+	    stat_loc[i]->ops[j] = 0.;
+	}
+	for (j = 0; j < NSOL_TREES; ++j) {
+	    stat_loc[i]->sol_msgs[j] = 0;
+	    stat_loc[i]->sol_bytes[j] = 0.;
+	}
+	stat_loc[i]->sol_packets = 0;
     }
-#else
-    for ( ii=0; ii<sizertemp*num_thread; ii++ )
-	rtemp[ii]=zero;
-#endif
 
-    if ( !(stat_loc = (SuperLUStat_t**) SUPERLU_MALLOC(num_thread*sizeof(SuperLUStat_t*))) )
-	ABORT("Malloc fails for stat_loc[].");
+    /* The time each X[k] is solved, for the critical path. */
+    if ( SOLVEstruct->crit_path == YES ) {
+	if ( !work->tdone
+	     && !(work->tdone = (double*)SUPERLU_MALLOC(2 * nsupers * sizeof(double))) )
+	    ABORT("Malloc fails for work->tdone[].");
+	if ( !work->sparent ) dgstrs_prune_init(nsupers, Llu, grid, work);
+	for (k = 0; k < 2 * nsupers; ++k) work->tdone[k] = -1.0;
+    }
 
-    for ( i=0; i<num_thread; i++) {
-	stat_loc[i] = (SuperLUStat_t*)SUPERLU_MALLOC(sizeof(SuperLUStat_t));
-	PStatInit(stat_loc[i]);
+    /* The critical-path priorities, and the leaves and roots in their
+       order, once per factorization. */
+    if ( SOLVEstruct->priority == YES && !work->prio ) {
+	if ( !(work->prio = intMalloc_dist(2 * nsupers)) )
+	    ABORT("Malloc fails for work->prio[].");
+	if ( !work->sparent ) dgstrs_prune_init(nsupers, Llu, grid, work);
+	pxgstrs_priority(nsupers, work->sparent, xsup, work->prio);
+	pxgstrs_sort_prio(work->nleaf, work->leafsups, work->prio);
+	pxgstrs_sort_prio(work->nroot, work->rootsups, work->prio + nsupers);
     }
 
 #if ( DEBUGlevel>=2 )
@@ -1107,8 +2015,12 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
      * Forward solve Ly = b.
      *---------------------------------------------------*/
     /* Redistribute B into X on the diagonal processes. */
+    /* The pattern may have been set up for another nrhs. */
+    superlu_mem_tag(SUPERLU_MEM_REDIST);
+    pxgstrs_comm_nrhs(SOLVEstruct->gstrs_comm, nrhs, grid);
     pdReDistribute_B_to_X(B, m_loc, nrhs, ldb, fst_row, ilsum, x,
 			  ScalePermstruct, Glu_persist, grid, SOLVEstruct);
+    superlu_mem_tag(SUPERLU_MEM_SOLVE);
 
 #if ( PRNTlevel>=2 )
     t = SuperLU_timer_() - t;
@@ -1138,62 +2050,44 @@ pdgstrs(int_t n, dLUstruct_t *LUstruct,
 			// printf("LBtree_ptr lk %5d\n",lk);
 			if(BcTree_IsRoot(LBtree_ptr[lk],'d')==NO){
 				nbtree++;
-				if(BcTree_getDestCount(LBtree_ptr[lk],'d')>0)nfrecvx_buf++;
 			}
 			BcTree_allocateRequest(LBtree_ptr[lk],'d');
+			BcTree_SetAggregator(LBtree_ptr[lk],work->agg,'d');
+			BcTree_SetMsgPrec(LBtree_ptr[lk],SOLVEstruct->msg_prec,'d');
 		}
 	}
 
 	nsupers_i = CEILING( nsupers, grid->nprow ); /* Number of local block rows */
-	if ( !(	leafsups = (int_t*)intCalloc_dist(nsupers_i)) )
-		ABORT("Calloc fails for leafsups.");
+	leafsups = work->leafsups;
+	nleaf = work->nleaf;
+	nfrecvmod = work->nfrecvmod;
 
 	nrtree = 0;
-	nleaf=0;
-	nfrecvmod=0;
-
-
-
-if(procs==1){
-	for (lk=0;lk<nsupers_i;++lk){
-		gb = myrow+lk*grid->nprow;  /* not sure */
-		if(gb<nsupers){
-			if (fmod[lk*aln_i]==0){
-				leafsups[nleaf]=gb;
-				++nleaf;
-			}
-		}
-	}
-}else{
-	for (lk=0;lk<nsupers_i;++lk){
+	if ( procs > 1 ) {
+	    for (lk=0;lk<nsupers_i;++lk){
 		if(LRtree_ptr[lk]!=NULL){
 			nrtree++;
 			RdTree_allocateRequest(LRtree_ptr[lk],'d');
-			frecv[lk] = RdTree_GetDestCount(LRtree_ptr[lk],'d');
-			nfrecvmod += frecv[lk];
-		}else{
-			gb = myrow+lk*grid->nprow;  /* not sure */
-			if(gb<nsupers){
-				kcol = PCOL( gb, grid );
-				if(mycol==kcol) { /* Diagonal process */
-					if (fmod[lk*aln_i]==0){
-						leafsups[nleaf]=gb;
-						++nleaf;
-					}
-				}
-			}
+			RdTree_SetAggregator(LRtree_ptr[lk],work->agg,'d');
+			RdTree_SetMsgPrec(LRtree_ptr[lk],SOLVEstruct->msg_prec,'d');
 		}
+	    }
 	}
-}
-
-
-	for (i = 0; i < nlb; ++i) fmod[i*aln_i] += frecv[i];
-
-	if ( !(recvbuf_BC_fwd = (double*)SUPERLU_MALLOC(maxrecvsz*(nfrecvx+1) * sizeof(double))) )  // this needs to be optimized for 1D row mapping
-		ABORT("Malloc fails for recvbuf_BC_fwd[].");
-	nfrecvx_buf=0;
 
-	log_memory(nlb*aln_i*iword+nlb*iword+(CEILING( nsupers, Pr )+CEILING( nsupers, Pc ))*aln_i*2.0*iword+ nsupers_i*iword + sizelsum*num_thread * dword + (ldalsum * nrhs + nlb * XK_H) *dword + (sizertemp*num_thread + 1)*dword+maxrecvsz*(nfrecvx+1)*dword, stat);	//account for fmod, frecv, leaf_send, root_send, leafsups, recvbuf_BC_fwd	, lsum, x, rtemp
+	recvbuf_BC_fwd = work->recvbuf;
+
+	/* Prune the L-solve to the supernodes reached from the nonzeros of B,
+	   and to those below the root solved on all the processes. */
+	if ( SOLVEstruct->sparse_rhs == YES || work->kroot < nsupers ) {
+	    if ( !work->sparent ) dgstrs_prune_init(nsupers, Llu, grid, work);
+	    nleaf = dgstrs_prune_fwd(nsupers, SOLVEstruct->sparse_rhs == YES,
+				     nrhs, x, lsum, fmod, &nfrecvx,
+				     &nfrecvmod, work->prunesups, xsup, Llu,
+				     grid, work);
+	    leafsups = work->prunesups;
+	    active = work->active;
+	    if ( work->prio ) pxgstrs_sort_prio(nleaf, leafsups, work->prio);
+	}
 
 
 
@@ -1221,6 +2115,36 @@ if(procs==1){
 	__itt_resume(); // start VTune, again use 2 underscores
 #endif
 
+	/* The receives of the L-solve are posted before it starts together
+	   on all the processes. */
+	pxgstrs_ring_init(&ring, recvbuf_BC_fwd, maxrecvsz, MPI_DOUBLE,
+			  work->nrecvbuf, nfrecvx + nfrecvmod, work->agg,
+			  SOLVEstruct->sparse_rhs == YES ? NULL : work->plan,
+			  grid);
+	if ( work->prio ) pxgstrs_ring_prio(&ring, work->prio, nsupers);
+	MPI_Barrier( grid->comm );
+	Llu->sol_tdone = work->tdone;
+	superlu_ooc_rewind(&Llu->Lnzval_ooc);
+	superlu_ooc_rewind(&Llu->Unzval_ooc);
+	dgstrs_ooc_ahead(0, 1, Llu, grid);
+	progress = superlu_progress_start(grid);
+	superlu_hwc_begin(stat, HWC_LSOLVE);
+	SUPERLU_PROF_BEGIN(PROF_LSOLVE, EMPTY);
+	tsolve = SuperLU_timer_();
+
+	if ( Llu->fixed_order ) {
+	    /* Reproducible mode: apply the X[k] in a fixed order. */
+	    dlsum_fmod_fixed(lsum, x, rtemp, nrhs, nsupers, fmod, frecv,
+			     nfrecvx, nfrecvmod, &ring, active, xsup, grid, Llu,
+			     stat_loc[0]);
+	} else if ( work->lvlptr ) {
+	    /* One process: all the threads solve the supernodes in the
+	       order of the level sets, as soon as they are ready. */
+	    dlsum_fmod_levels(lsum, x, rtemp, nrhs, nsupers, fmod,
+			      work->lvlsups, active, xsup, grid, Llu, stat_loc,
+			      sizelsum, sizertemp, num_thread);
+	} else {
+
 	/* ---------------------------------------------------------
 	   Solve the leaf nodes first by all the diagonal processes.
 	   --------------------------------------------------------- */
@@ -1270,22 +2194,41 @@ thread_id=0;
 					nsupr = lsub[1];
 
 					Linv = Linv_bc_ptr[lk];
+					if ( Linv ) {
+						if ( !dgemm_small(knsupc, nrhs, knsupc,
+						                  Linv, knsupc, &x[ii], knsupc, rtemp_loc, knsupc) ) {
 #ifdef _CRAY
-					SGEMM( ftcs2, ftcs2, &knsupc, &nrhs, &knsupc,
-							&alpha, Linv, &knsupc, &x[ii],
-							&knsupc, &beta, rtemp_loc, &knsupc );
+						SGEMM( ftcs2, ftcs2, &knsupc, &nrhs, &knsupc,
+								&alpha, Linv, &knsupc, &x[ii],
+								&knsupc, &beta, rtemp_loc, &knsupc );
 #elif defined (USE_VENDOR_BLAS)
-					dgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
-							&alpha, Linv, &knsupc, &x[ii],
-							&knsupc, &beta, rtemp_loc, &knsupc, 1, 1 );
+						dgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+								&alpha, Linv, &knsupc, &x[ii],
+								&knsupc, &beta, rtemp_loc, &knsupc, 1, 1 );
 #else
-					dgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
-							&alpha, Linv, &knsupc, &x[ii],
-							&knsupc, &beta, rtemp_loc, &knsupc );
+						dgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+								&alpha, Linv, &knsupc, &x[ii],
+								&knsupc, &beta, rtemp_loc, &knsupc );
 #endif
+						}
 
-					for (i=0 ; i<knsupc*nrhs ; i++){
-						x[ii+i] = rtemp_loc[i];
+						for (i=0 ; i<knsupc*nrhs ; i++){
+							x[ii+i] = rtemp_loc[i];
+						}
+					} else { /* Supernode not in the DiagInv_*Size range. */
+					    if ( !dtrsm_small('L', knsupc, nrhs,
+					                      lusup, nsupr, &x[ii], knsupc) ) {
+#ifdef _CRAY
+					    STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &knsupc, &nrhs, &alpha,
+						  lusup, &nsupr, &x[ii], &knsupc);
+#elif defined (USE_VENDOR_BLAS)
+					    dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+						    lusup, &nsupr, &x[ii], &knsupc, 1, 1, 1, 1);
+#else
+					    dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+						    lusup, &nsupr, &x[ii], &knsupc);
+#endif
+					    }
 					}
 
 					// for (i=0 ; i<knsupc*nrhs ; i++){
@@ -1301,6 +2244,7 @@ thread_id=0;
 #endif
 
 					stat_loc[thread_id]->ops[SOLVE] += knsupc * (knsupc - 1) * nrhs;
+					SOLVE_STAMP(Llu->sol_tdone, k);
 
 
 					// --nleaf;
@@ -1348,6 +2292,8 @@ thread_id=0;
 
 		    nsupr = lsub[1];
 
+		    if ( !dtrsm_small('L', knsupc, nrhs,
+		                      lusup, nsupr, &x[ii], knsupc) ) {
 #ifdef _CRAY
    		    STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &knsupc, &nrhs, &alpha,
 				lusup, &nsupr, &x[ii], &knsupc);
@@ -1358,6 +2304,7 @@ thread_id=0;
  		    dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
 					lusup, &nsupr, &x[ii], &knsupc);
 #endif
+		    }
 
 #if ( PROFlevel>=1 )
 		    TOC(t2, t1);
@@ -1366,6 +2313,7 @@ thread_id=0;
 #endif
 
 		    stat_loc[thread_id]->ops[SOLVE] += knsupc * (knsupc - 1) * nrhs;
+		    SOLVE_STAMP(Llu->sol_tdone, k);
 
 		    // --nleaf;
 #if ( DEBUGlevel>=2 )
@@ -1475,16 +2423,10 @@ thread_id=0;
 				{
 					for ( nfrecv =0; nfrecv<nfrecvx+nfrecvmod;nfrecv++) { /* While not finished. */
 						thread_id = 0;
-#if ( PROFlevel>=1 )
-						TIC(t1);
-						// msgcnt[1] = maxrecvsz;
-#endif
-
-						recvbuf0 = &recvbuf_BC_fwd[nfrecvx_buf*maxrecvsz];
 
 						/* Receive a message. */
-						MPI_Recv( recvbuf0, maxrecvsz, MPI_DOUBLE,
-								MPI_ANY_SOURCE, MPI_ANY_TAG, grid->comm, &status );
+						recvbuf0 = (double *) pxgstrs_ring_recv( &ring, &status,
+											 stat_loc[thread_id] );
 						// MPI_Irecv(recvbuf0,maxrecvsz,MPI_DOUBLE,MPI_ANY_SOURCE,MPI_ANY_TAG,grid->comm,&req);
 						// ready=0;
 						// while(ready==0){
@@ -1493,9 +2435,6 @@ thread_id=0;
 						// }
 
 #if ( PROFlevel>=1 )
-						TOC(t2, t1);
-						stat_loc[thread_id]->utime[SOL_COMM] += t2;
-
 						msg_cnt += 1;
 						msg_vol += maxrecvsz * dword;
 #endif
@@ -1503,6 +2442,7 @@ thread_id=0;
 						{
 
 							k = *recvbuf0;
+							dgstrs_ooc_ahead(k, 1, Llu, grid);
 
 #if ( DEBUGlevel>=2 )
 							printf("(%2d) Recv'd block %d, tag %2d\n", iam, k, status.MPI_TAG);
@@ -1510,7 +2450,7 @@ thread_id=0;
 
 							if(status.MPI_TAG==BC_L){
 								// --nfrecvx;
-								nfrecvx_buf++;
+								pxgstrs_ring_keep(&ring); /* X[k] may be forwarded */
 								{
 									lk = LBj( k, grid );    /* local block number */
 
@@ -1555,9 +2495,12 @@ thread_id=0;
 								tempv = &recvbuf0[LSUM_H];
 								il = LSUM_BLK( lk );
 								RHS_ITERATE(j) {
-									for (i = 0; i < knsupc; ++i)
-										lsum[i + il + j*knsupc + thread_id*sizelsum] += tempv[i + j*knsupc];
-
+									for (i = 0; i < knsupc; ++i) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+										lsum[i + il + j*knsupc + LSUM_COPY(thread_id)] += tempv[i + j*knsupc];
+									}
 								}
 
 								// #ifdef _OPENMP
@@ -1571,7 +2514,7 @@ thread_id=0;
 										if(RdTree_IsRoot(LRtree_ptr[lk],'d')==YES){
 											// ii = X_BLK( lk );
 											knsupc = SuperSize( k );
-											for (ii=1;ii<num_thread;ii++)
+											for (ii=1;ii<LSUM_NCOPY;ii++)
 												for (jj=0;jj<knsupc*nrhs;jj++)
 													lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
 
@@ -1590,8 +2533,10 @@ thread_id=0;
 											TIC(t1);
 #endif
 
-											if(Llu->inv == 1){
+											if(Llu->inv == 1 && Linv_bc_ptr[lk]){
 												Linv = Linv_bc_ptr[lk];
+												if ( !dgemm_small(knsupc, nrhs, knsupc,
+												                  Linv, knsupc, &x[ii], knsupc, rtemp_loc, knsupc) ) {
 #ifdef _CRAY
 												SGEMM( ftcs2, ftcs2, &knsupc, &nrhs, &knsupc,
 														&alpha, Linv, &knsupc, &x[ii],
@@ -1605,11 +2550,14 @@ thread_id=0;
 														&alpha, Linv, &knsupc, &x[ii],
 														&knsupc, &beta, rtemp_loc, &knsupc );
 #endif
+												}
 												for (i=0 ; i<knsupc*nrhs ; i++){
 													x[ii+i] = rtemp_loc[i];
 												}
 											}
 											else{
+												if ( !dtrsm_small('L', knsupc, nrhs,
+												                  lusup, nsupr, &x[ii], knsupc) ) {
 #ifdef _CRAY
 												STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &knsupc, &nrhs, &alpha,
 														lusup, &nsupr, &x[ii], &knsupc);
@@ -1620,6 +2568,7 @@ thread_id=0;
 												dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
 														lusup, &nsupr, &x[ii], &knsupc);
 #endif
+												}
 											}
 
 #if ( PROFlevel>=1 )
@@ -1628,6 +2577,7 @@ thread_id=0;
 #endif
 
 											stat_loc[thread_id]->ops[SOLVE] += knsupc * (knsupc - 1) * nrhs;
+											SOLVE_STAMP(Llu->sol_tdone, k);
 
 #if ( DEBUGlevel>=2 )
 											printf("(%2d) Solve X[%2d]\n", iam, k);
@@ -1664,7 +2614,7 @@ thread_id=0;
 										il = LSUM_BLK( lk );
 										knsupc = SuperSize( k );
 
-										for (ii=1;ii<num_thread;ii++)
+										for (ii=1;ii<LSUM_NCOPY;ii++)
 											for (jj=0;jj<knsupc*nrhs;jj++)
 												lsum[il + jj] += lsum[il + jj + ii*sizelsum];
 										RdTree_forwardMessageSimple(LRtree_ptr[lk],&lsum[il-LSUM_H],RdTree_GetMsgSize(LRtree_ptr[lk],'d')*nrhs+LSUM_H,'d');
@@ -1680,10 +2630,11 @@ thread_id=0;
 
 			}
 		} // end of parallel 
+	} /* if fixed_order */
+	pxgstrs_ring_free(&ring);
 
 #if ( PRNTlevel>=2 )
 		t = SuperLU_timer_() - t;
-		stat->utime[SOL_TOT] += t;
 		if ( !iam ) {
 			printf(".. L-solve time\t%8.4f\n", t);
 			fflush(stdout);
@@ -1721,17 +2672,12 @@ thread_id=0;
 		}
 #endif
 
-		SUPERLU_FREE(fmod);
-		SUPERLU_FREE(frecv);
-		SUPERLU_FREE(leaf_send);
-		SUPERLU_FREE(leafsups);
-		SUPERLU_FREE(recvbuf_BC_fwd);
-		log_memory(-nlb*aln_i*iword-nlb*iword-(CEILING( nsupers, Pr )+CEILING( nsupers, Pc ))*aln_i*iword- nsupers_i*iword -maxrecvsz*(nfrecvx+1)*dword, stat);	//account for fmod, frecv, leaf_send, leafsups, recvbuf_BC_fwd
-
 		for (lk=0;lk<nsupers_j;++lk){
 			if(LBtree_ptr[lk]!=NULL){
 				// if(BcTree_IsRoot(LBtree_ptr[lk],'d')==YES){
 				BcTree_waitSendRequest(LBtree_ptr[lk],'d');
+				BcTree_SetAggregator(LBtree_ptr[lk],NULL,'d');
+				BcTree_SetMsgPrec(LBtree_ptr[lk],SLU_MSG_FULL,'d');
 				// }
 				// deallocate requests here
 			}
@@ -1740,11 +2686,27 @@ thread_id=0;
 		for (lk=0;lk<nsupers_i;++lk){
 			if(LRtree_ptr[lk]!=NULL){
 				RdTree_waitSendRequest(LRtree_ptr[lk],'d');
+				RdTree_SetAggregator(LRtree_ptr[lk],NULL,'d');
+				RdTree_SetMsgPrec(LRtree_ptr[lk],SLU_MSG_FULL,'d');
 				// deallocate requests here
 			}
 		}
 		MPI_Barrier( grid->comm );
 
+		/* The top of the etree, on all the processes. */
+		if ( work->kroot < nsupers ) {
+			dgstrs_root_solve(nsupers, nrhs, x, lsum, xsup, Llu, grid,
+					  work, stat_loc[0]);
+			for (k = work->kroot; k < nsupers; ++k)
+				SOLVE_STAMP(Llu->sol_tdone, k);
+		}
+		stat->utime[SOL_TOT] = SuperLU_timer_() - tsolve;
+		superlu_hwc_end(stat, HWC_LSOLVE);
+		SUPERLU_PROF_END(PROF_LSOLVE, EMPTY);
+		if ( work->tdone )
+			for (k = 0; k < nsupers; ++k)
+				if ( work->tdone[k] >= 0.0 ) work->tdone[k] -= tsolve;
+
 #if ( VAMPIR>=1 )
 		VT_traceoff();
 		VT_finalize();
@@ -1759,13 +2721,11 @@ thread_id=0;
 	 *---------------------------------------------------*/
 
 
-		/* Save the count to be altered so it can be used by
-		   subsequent call to PDGSTRS. */
-		if ( !(bmod = intMalloc_dist(nlb*aln_i)) )
-			ABORT("Malloc fails for bmod[].");
-		for (i = 0; i < nlb; ++i) bmod[i*aln_i] = Llu->bmod[i];
-		if ( !(brecv = intCalloc_dist(nlb)) )
-			ABORT("Calloc fails for brecv[].");
+		/* Reset the counts to be altered. */
+		bmod = work->bmod;
+		brecv = work->brecv;
+		memcpy(bmod, work->bmod_init, nlb * aln_i * sizeof(int_t));
+		memcpy(brecv, work->brecv_init, nlb * sizeof(int_t));
 		Llu->brecv = brecv;
 
 		k = SUPERLU_MAX( Llu->nfsendx, Llu->nbsendx ) + nlb;
@@ -1777,8 +2737,9 @@ thread_id=0;
 #pragma omp parallel default(shared) private(ii)
 	{
 		int thread_id = omp_get_thread_num();
-		for(ii=0;ii<sizelsum;ii++)
-			lsum[thread_id*sizelsum+ii]=zero;
+		if ( thread_id < work->nlsum )
+			for(ii=0;ii<sizelsum;ii++)
+				lsum[thread_id*sizelsum+ii]=zero;
 	}
     /* Set up the headers in lsum[]. */
     for (k = 0; k < nsupers; ++k) {
@@ -1799,7 +2760,7 @@ thread_id=0;
 			il = LSUM_BLK( lk );
 			dest = &lsum[il];
 
-			for (jj = 0; jj < num_thread; ++jj) {
+			for (jj = 0; jj < work->nlsum; ++jj) {
 				RHS_ITERATE(j) {
 					for (i = 0; i < knsupc; ++i) dest[i + j*knsupc + jj*sizelsum] = zero;
 				}
@@ -1856,49 +2817,44 @@ thread_id=0;
 			// printf("UBtree_ptr lk %5d\n",lk);
 			if(BcTree_IsRoot(UBtree_ptr[lk],'d')==NO){
 				nbtree++;
-				if(BcTree_getDestCount(UBtree_ptr[lk],'d')>0)nbrecvx_buf++;
 			}
 			BcTree_allocateRequest(UBtree_ptr[lk],'d');
+			BcTree_SetAggregator(UBtree_ptr[lk],work->agg,'d');
+			BcTree_SetMsgPrec(UBtree_ptr[lk],SOLVEstruct->msg_prec,'d');
 		}
 	}
 
 	nsupers_i = CEILING( nsupers, grid->nprow ); /* Number of local block rows */
-	if ( !(	rootsups = (int_t*)intCalloc_dist(nsupers_i)) )
-		ABORT("Calloc fails for rootsups.");
+	rootsups = work->rootsups;
+	nroot = work->nroot;
+	nbrecvmod = work->nbrecvmod;
 
 	nrtree = 0;
-	nroot=0;
 	for (lk=0;lk<nsupers_i;++lk){
 		if(URtree_ptr[lk]!=NULL){
-			// printf("here lk %5d myid %5d\n",lk,iam);
-			// fflush(stdout);
 			nrtree++;
 			RdTree_allocateRequest(URtree_ptr[lk],'d');
-			brecv[lk] = RdTree_GetDestCount(URtree_ptr[lk],'d');
-			nbrecvmod += brecv[lk];
-		}else{
-			gb = myrow+lk*grid->nprow;  /* not sure */
-			if(gb<nsupers){
-				kcol = PCOL( gb, grid );
-				if(mycol==kcol) { /* Diagonal process */
-					if (bmod[lk*aln_i]==0){
-						rootsups[nroot]=gb;
-						++nroot;
-					}
-				}
-			}
+			RdTree_SetAggregator(URtree_ptr[lk],work->agg,'d');
+			RdTree_SetMsgPrec(URtree_ptr[lk],SOLVEstruct->msg_prec,'d');
 		}
 	}
 
-	for (i = 0; i < nlb; ++i) bmod[i*aln_i] += brecv[i];
-	// for (i = 0; i < nlb; ++i)printf("bmod[i]: %5d\n",bmod[i]);
-
-
-	if ( !(recvbuf_BC_fwd = (double*)SUPERLU_MALLOC(maxrecvsz*(nbrecvx+1) * sizeof(double))) )  // this needs to be optimized for 1D row mapping
-		ABORT("Malloc fails for recvbuf_BC_fwd[].");
-	nbrecvx_buf=0;
 
-	log_memory(nlb*aln_i*iword+nlb*iword + nsupers_i*iword + maxrecvsz*(nbrecvx+1)*dword, stat);	//account for bmod, brecv, rootsups, recvbuf_BC_fwd
+	/* Prune the U-solve to the requested rows of X, and to those below
+	   the root solved on all the processes. */
+	if ( SOLVEstruct->out_rows || work->kroot < nsupers ) {
+	    if ( !work->sparent ) dgstrs_prune_init(nsupers, Llu, grid, work);
+	    nroot = dgstrs_prune_bwd(nsupers, SOLVEstruct->nout_rows,
+				     SOLVEstruct->out_rows,
+				     ScalePermstruct->perm_c, Glu_persist->supno,
+				     nrhs, x, lsum, bmod, &nbrecvx, &nbrecvmod,
+				     work->prunesups, xsup, Llu, grid, work,
+				     stat_loc[0]);
+	    rootsups = work->prunesups;
+	    needed = work->needed;
+	    if ( work->prio )
+		pxgstrs_sort_prio(nroot, rootsups, work->prio + nsupers);
+	}
 
 #if ( DEBUGlevel>=2 )
 	printf("(%2d) nbrecvx %4d,  nbrecvmod %4d,  nroot %4d\n,  nbtree %4d\n,  nrtree %4d\n",
@@ -1915,6 +2871,26 @@ thread_id=0;
 	t = SuperLU_timer_();
 #endif
 
+	pxgstrs_ring_init(&ring, recvbuf_BC_fwd, maxrecvsz, MPI_DOUBLE,
+			  work->nrecvbuf, nbrecvx + nbrecvmod, work->agg,
+			  SOLVEstruct->out_rows ? NULL
+			  : work->plan + grid->nprow * grid->npcol + 1, grid);
+	if ( work->prio )
+	    pxgstrs_ring_prio(&ring, work->prio + nsupers, nsupers);
+	MPI_Barrier( grid->comm );
+	Llu->sol_tdone = work->tdone ? work->tdone + nsupers : NULL;
+	dgstrs_ooc_ahead(nsupers - 1, 0, Llu, grid);
+	superlu_hwc_begin(stat, HWC_USOLVE);
+	SUPERLU_PROF_BEGIN(PROF_USOLVE, EMPTY);
+	tsolve = SuperLU_timer_();
+
+	if ( Llu->fixed_order ) {
+	    /* Reproducible mode: apply the X[k] in a fixed order. */
+	    dlsum_bmod_fixed(lsum, x, rtemp, nrhs, nsupers, bmod, brecv,
+			     nbrecvx, nbrecvmod, &ring, sizertemp, needed, xsup,
+			     grid, Llu, stat_loc[0]);
+	} else {
+
 		/*
 		 * Solve the roots first by all the diagonal processes.
 		 */
@@ -1965,9 +2941,11 @@ thread_id=0;
 			nsupr = lsub[1];
 
 
-			if(Llu->inv == 1){
+			if(Llu->inv == 1 && Uinv_bc_ptr[lk]){
 
 				Uinv = Uinv_bc_ptr[lk];
+				if ( !dgemm_small(knsupc, nrhs, knsupc,
+				                  Uinv, knsupc, &x[ii], knsupc, rtemp_loc, knsupc) ) {
 #ifdef _CRAY
 				SGEMM( ftcs2, ftcs2, &knsupc, &nrhs, &knsupc,
 						&alpha, Uinv, &knsupc, &x[ii],
@@ -1981,10 +2959,13 @@ thread_id=0;
 						&alpha, Uinv, &knsupc, &x[ii],
 						&knsupc, &beta, rtemp_loc, &knsupc );
 #endif
+				}
 				for (i=0 ; i<knsupc*nrhs ; i++){
 					x[ii+i] = rtemp_loc[i];
 				}
 			}else{
+				if ( !dtrsm_small('U', knsupc, nrhs,
+				                  lusup, nsupr, &x[ii], knsupc) ) {
 #ifdef _CRAY
 				STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &knsupc, &nrhs, &alpha,
 						lusup, &nsupr, &x[ii], &knsupc);
@@ -1995,6 +2976,7 @@ thread_id=0;
 				dtrsm_("L", "U", "N", "N", &knsupc, &nrhs, &alpha,
 						lusup, &nsupr, &x[ii], &knsupc);
 #endif
+				}
 			}
 
 #if ( PROFlevel>=1 )
@@ -2002,6 +2984,7 @@ thread_id=0;
 			stat_loc[thread_id]->utime[SOL_TRSM] += t2;
 #endif
 			stat_loc[thread_id]->ops[SOLVE] += knsupc * (knsupc + 1) * nrhs;
+			SOLVE_STAMP(Llu->sol_tdone, k);
 
 #if ( DEBUGlevel>=2 )
 			printf("(%2d) Solve X[%2d]\n", iam, k);
@@ -2098,25 +3081,18 @@ for (i=0;i<nroot_send;i++){
 
 
 			thread_id = 0;
-#if ( PROFlevel>=1 )
-			TIC(t1);
-#endif
-
-			recvbuf0 = &recvbuf_BC_fwd[nbrecvx_buf*maxrecvsz];
 
 			/* Receive a message. */
-			MPI_Recv( recvbuf0, maxrecvsz, MPI_DOUBLE,
-					MPI_ANY_SOURCE, MPI_ANY_TAG, grid->comm, &status );
+			recvbuf0 = (double *) pxgstrs_ring_recv( &ring, &status,
+								 stat_loc[thread_id] );
 
 #if ( PROFlevel>=1 )
-			TOC(t2, t1);
-			stat_loc[thread_id]->utime[SOL_COMM] += t2;
-
 			msg_cnt += 1;
 			msg_vol += maxrecvsz * dword;
 #endif
 
 			k = *recvbuf0;
+			dgstrs_ooc_ahead(k, 0, Llu, grid);
 #if ( DEBUGlevel>=2 )
 			printf("(%2d) Recv'd block %d, tag %2d\n", iam, k, status.MPI_TAG);
 			fflush(stdout);
@@ -2124,7 +3100,7 @@ for (i=0;i<nroot_send;i++){
 
 			if(status.MPI_TAG==BC_U){
 				// --nfrecvx;
-				nbrecvx_buf++;
+				pxgstrs_ring_keep(&ring); /* X[k] may be forwarded */
 
 				lk = LBj( k, grid );    /* local block number */
 
@@ -2150,9 +3126,12 @@ for (i=0;i<nroot_send;i++){
 				tempv = &recvbuf0[LSUM_H];
 				il = LSUM_BLK( lk );
 				RHS_ITERATE(j) {
-					for (i = 0; i < knsupc; ++i)
-						lsum[i + il + j*knsupc + thread_id*sizelsum] += tempv[i + j*knsupc];
-
+					for (i = 0; i < knsupc; ++i) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+						lsum[i + il + j*knsupc + LSUM_COPY(thread_id)] += tempv[i + j*knsupc];
+					}
 				}
 			// #ifdef _OPENMP
 			// #pragma omp atomic capture
@@ -2164,7 +3143,7 @@ for (i=0;i<nroot_send;i++){
 					if(RdTree_IsRoot(URtree_ptr[lk],'d')==YES){
 
 						knsupc = SuperSize( k );
-						for (ii=1;ii<num_thread;ii++)
+						for (ii=1;ii<LSUM_NCOPY;ii++)
 							for (jj=0;jj<knsupc*nrhs;jj++)
 								lsum[il+ jj ] += lsum[il + jj + ii*sizelsum];
 
@@ -2178,10 +3157,12 @@ for (i=0;i<nroot_send;i++){
 						lusup = Lnzval_bc_ptr[lk];
 						nsupr = lsub[1];
 
-						if(Llu->inv == 1){
+						if(Llu->inv == 1 && Uinv_bc_ptr[lk]){
 
 							Uinv = Uinv_bc_ptr[lk];
 
+							if ( !dgemm_small(knsupc, nrhs, knsupc,
+							                  Uinv, knsupc, &x[ii], knsupc, rtemp_loc, knsupc) ) {
 #ifdef _CRAY
 							SGEMM( ftcs2, ftcs2, &knsupc, &nrhs, &knsupc,
 									&alpha, Uinv, &knsupc, &x[ii],
@@ -2195,11 +3176,14 @@ for (i=0;i<nroot_send;i++){
 									&alpha, Uinv, &knsupc, &x[ii],
 									&knsupc, &beta, rtemp_loc, &knsupc );
 #endif
+							}
 
 							for (i=0 ; i<knsupc*nrhs ; i++){
 								x[ii+i] = rtemp_loc[i];
 							}
 						}else{
+							if ( !dtrsm_small('U', knsupc, nrhs,
+							                  lusup, nsupr, &x[ii], knsupc) ) {
 #ifdef _CRAY
 							STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &knsupc, &nrhs, &alpha,
 									lusup, &nsupr, &x[ii], &knsupc);
@@ -2210,6 +3194,7 @@ for (i=0;i<nroot_send;i++){
 							dtrsm_("L", "U", "N", "N", &knsupc, &nrhs, &alpha,
 									lusup, &nsupr, &x[ii], &knsupc);
 #endif
+							}
 						}
 
 #if ( PROFlevel>=1 )
@@ -2217,6 +3202,7 @@ for (i=0;i<nroot_send;i++){
 							stat_loc[thread_id]->utime[SOL_TRSM] += t2;
 #endif
 							stat_loc[thread_id]->ops[SOLVE] += knsupc * (knsupc + 1) * nrhs;
+							SOLVE_STAMP(Llu->sol_tdone, k);
 
 #if ( DEBUGlevel>=2 )
 						printf("(%2d) Solve X[%2d]\n", iam, k);
@@ -2243,7 +3229,7 @@ for (i=0;i<nroot_send;i++){
 						il = LSUM_BLK( lk );
 						knsupc = SuperSize( k );
 
-						for (ii=1;ii<num_thread;ii++)
+						for (ii=1;ii<LSUM_NCOPY;ii++)
 							for (jj=0;jj<knsupc*nrhs;jj++)
 								lsum[il+ jj ] += lsum[il + jj + ii*sizelsum];
 
@@ -2254,9 +3240,19 @@ for (i=0;i<nroot_send;i++){
 			}
 		} /* while not finished ... */
 	}
+	} /* if fixed_order */
+	pxgstrs_ring_free(&ring);
+	stat->utime[SOL_TOT] += SuperLU_timer_() - tsolve;
+	superlu_hwc_end(stat, HWC_USOLVE);
+	superlu_progress_stop(progress);
+	SUPERLU_PROF_END(PROF_USOLVE, EMPTY);
+	Llu->sol_tdone = NULL;
+	Llu->lsum_shared = 0;
+	if ( work->tdone )
+	    for (k = nsupers; k < 2 * nsupers; ++k)
+		if ( work->tdone[k] >= 0.0 ) work->tdone[k] -= tsolve;
 #if ( PRNTlevel>=2 )
 		t = SuperLU_timer_() - t;
-		stat->utime[SOL_TOT] += t;
 		if ( !iam ) printf(".. U-solve time\t%8.4f\n", t);
 		MPI_Reduce (&t, &tmax, 1, MPI_DOUBLE,
 				MPI_MAX, 0, grid->comm);
@@ -2296,8 +3292,19 @@ for (i=0;i<nroot_send;i++){
 		}
 #endif
 
+		/* The rows of X not computed are returned as 0. */
+		if ( needed ) {
+			for (lk = 0; lk < nlb; ++lk) {
+				k = myrow + lk * grid->nprow;
+				if ( k < work->kroot && !needed[k] && mycol == PCOL( k, grid ) )
+					memset(&x[X_BLK( lk )], 0, SuperSize( k ) * nrhs * sizeof(double));
+			}
+		}
+
+		superlu_mem_tag(SUPERLU_MEM_REDIST);
 		pdReDistribute_X_to_B(n, B, m_loc, ldb, fst_row, nrhs, x, ilsum,
 				ScalePermstruct, Glu_persist, grid, SOLVEstruct);
+		superlu_mem_tag(SUPERLU_MEM_SOLVE);
 
 
 #if ( PRNTlevel>=2 )
@@ -2326,32 +3333,37 @@ for (i=0;i<nroot_send;i++){
 		stat->utime[SOL_GEMM] += tmp2;
 		stat->utime[SOL_COMM] += tmp3;
 		stat->ops[SOLVE]+= tmp4;
-
-
-		/* Deallocate storage. */
-		for(i=0;i<num_thread;i++){
-			PStatFree(stat_loc[i]);
-			SUPERLU_FREE(stat_loc[i]);
+		for (j = 0; j < NSOL_TREES; ++j) {
+			stat->sol_msgs[j] = 0;
+			stat->sol_bytes[j] = 0.;
+			for (i = 0; i < num_thread; i++) {
+				stat->sol_msgs[j] += stat_loc[i]->sol_msgs[j];
+				stat->sol_bytes[j] += stat_loc[i]->sol_bytes[j];
+			}
+		}
+		stat->sol_packets = 0;
+		for (i = 0; i < num_thread; i++)
+			stat->sol_packets += stat_loc[i]->sol_packets;
+
+		if ( work->tdone ) {
+			pxgstrs_critpath('L', nsupers, work->sparent, work->tdone,
+					 grid, &stat->sol_critpath[0],
+					 &stat->sol_crithops[0]);
+			pxgstrs_critpath('U', nsupers, work->sparent,
+					 work->tdone + nsupers, grid,
+					 &stat->sol_critpath[1],
+					 &stat->sol_crithops[1]);
 		}
-		SUPERLU_FREE(stat_loc);
-		SUPERLU_FREE(rtemp);
-		SUPERLU_FREE(lsum);
-		SUPERLU_FREE(x);
-
-
-		SUPERLU_FREE(bmod);
-		SUPERLU_FREE(brecv);
-		SUPERLU_FREE(root_send);
 
-		SUPERLU_FREE(rootsups);
-		SUPERLU_FREE(recvbuf_BC_fwd);
 
-		log_memory(-nlb*aln_i*iword-nlb*iword - nsupers_i*iword - (CEILING( nsupers, Pr )+CEILING( nsupers, Pc ))*aln_i*iword - maxrecvsz*(nbrecvx+1)*dword - sizelsum*num_thread * dword - (ldalsum * nrhs + nlb * XK_H) *dword - (sizertemp*num_thread + 1)*dword, stat);	//account for bmod, brecv, root_send, rootsups, recvbuf_BC_fwd,rtemp,lsum,x
+		/* The working storage stays in SOLVEstruct->gstrs_work. */
 
 		for (lk=0;lk<nsupers_j;++lk){
 			if(UBtree_ptr[lk]!=NULL){
 				// if(BcTree_IsRoot(LBtree_ptr[lk],'d')==YES){
 				BcTree_waitSendRequest(UBtree_ptr[lk],'d');
+				BcTree_SetAggregator(UBtree_ptr[lk],NULL,'d');
+				BcTree_SetMsgPrec(UBtree_ptr[lk],SLU_MSG_FULL,'d');
 				// }
 				// deallocate requests here
 			}
@@ -2360,6 +3372,8 @@ for (i=0;i<nroot_send;i++){
 		for (lk=0;lk<nsupers_i;++lk){
 			if(URtree_ptr[lk]!=NULL){
 				RdTree_waitSendRequest(URtree_ptr[lk],'d');
+				RdTree_SetAggregator(URtree_ptr[lk],NULL,'d');
+				RdTree_SetMsgPrec(URtree_ptr[lk],SLU_MSG_FULL,'d');
 				// deallocate requests here
 			}
 		}
@@ -2389,6 +3403,8 @@ for (i=0;i<nroot_send;i++){
 #endif
 
     stat->utime[SOLVE] = SuperLU_timer_() - t1_sol;
+    superlu_mem_tag(mem_tag);
+    SUPERLU_PROF_END(PROF_SOLVE, EMPTY);
 
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(iam, "Exit pdgstrs()");
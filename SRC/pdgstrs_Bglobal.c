@@ -938,9 +938,7 @@ pdgstrs_Bglobal(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid,
 
 	get_diag_procs(n, Glu_persist, grid, &num_diag_procs,
 		       &diag_procs, &diag_len);
-	jj = diag_len[0];
-	for (j = 1; j < num_diag_procs; ++j) jj = SUPERLU_MAX(jj, diag_len[j]);
-	if ( !(work = doubleMalloc_dist(((size_t)jj)*nrhs)) )
+	if ( !(work = doubleMalloc_dist(((size_t)n)*nrhs)) )
 	    ABORT("Malloc fails for work[]");
 	gather_diag_to_all(n, nrhs, x, Glu_persist, Llu,
 			   grid, num_diag_procs, diag_procs, diag_len,
@@ -985,6 +983,11 @@ pdgstrs_Bglobal(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid,
 /*
  * Gather the components of x vector on the diagonal processes
  * onto all processes, and combine them into the global vector y.
+ *
+ * The part of each diagonal process is broadcast down its process column,
+ * then along the process rows, each into its own place in work[] of
+ * n*nrhs entries. All the broadcasts are started before any is waited
+ * for, so that they proceed together rather than one after the other.
  */
 static void
 gather_diag_to_all(int_t n, int_t nrhs, double x[],
@@ -995,36 +998,59 @@ gather_diag_to_all(int_t n, int_t nrhs, double x[],
 {
     int_t i, ii, j, k, lk, lwork, nsupers, p;
     int_t *ilsum, *xsup;
-    int iam, knsupc, pkk;
-    double *x_col, *y_col;
+    int iam, knsupc, pkk, mycol;
+    double *x_col, *y_col, *w;
+    size_t *off;
+    superlu_bcast_t *bc;
 
     iam = grid->iam;
+    mycol = MYCOL( iam, grid );
     nsupers = Glu_persist->supno[n-1] + 1;
     xsup = Glu_persist->xsup;
     ilsum = Llu->ilsum;
-
-    for (p = 0; p < num_diag_procs; ++p) {
+    if ( !(off = (size_t *) SUPERLU_MALLOC(num_diag_procs * sizeof(size_t)))
+	 || !(bc = (superlu_bcast_t *)
+	      SUPERLU_MALLOC(2 * num_diag_procs * sizeof(superlu_bcast_t))) )
+	ABORT("Malloc fails for bc[]");
+
+    for (p = 0, lwork = 0; p < num_diag_procs; ++p) {
+	off[p] = lwork;
+	lwork += diag_len[p] * nrhs;
 	pkk = diag_procs[p];
 	if ( iam == pkk ) {
 	    /* Copy x vector into a buffer. */
-	    lwork = 0;
+	    w = &work[off[p]];
 	    for (k = p; k < nsupers; k += num_diag_procs) {
 		knsupc = SuperSize( k );
 		lk = LBi( k, grid );
 		ii = X_BLK( lk ); /*ilsum[lk] + (lk+1)*XK_H;*/
 		x_col = &x[ii];
 		for (j = 0; j < nrhs; ++j) {
-		    for (i = 0; i < knsupc; ++i) work[i+lwork] = x_col[i];
-		    lwork += knsupc;
+		    for (i = 0; i < knsupc; ++i) w[i] = x_col[i];
+		    w += knsupc;
 		    x_col += knsupc;
 		}
 	    }
-	    MPI_Bcast( work, lwork, MPI_DOUBLE, pkk, grid->comm );
-	} else {
-	    MPI_Bcast( work, diag_len[p]*nrhs, MPI_DOUBLE, pkk, grid->comm );
 	}
+	/* Down the process column of pkk. */
+	if ( mycol == MYCOL( pkk, grid ) )
+	    bcast_tree_start(&work[off[p]], diag_len[p] * nrhs, MPI_DOUBLE,
+			     MYROW( pkk, grid ), p, grid, COMM_COLUMN, &bc[p]);
+    }
+
+    /* Along the process rows, from the column of pkk. */
+    for (p = 0; p < num_diag_procs; ++p) {
+	pkk = diag_procs[p];
+	if ( mycol == MYCOL( pkk, grid ) ) bcast_tree_wait(&bc[p]);
+	bcast_tree_start(&work[off[p]], diag_len[p] * nrhs, MPI_DOUBLE,
+			 MYCOL( pkk, grid ), p, grid, COMM_ROW,
+			 &bc[num_diag_procs + p]);
+    }
+
+    for (p = 0; p < num_diag_procs; ++p) {
+	bcast_tree_wait(&bc[num_diag_procs + p]);
 	/* Scatter work[] into global y vector. */
-	lwork = 0;
+	lwork = off[p];
 	for (k = p; k < nsupers; k += num_diag_procs) {
 	    knsupc = SuperSize( k );
 	    ii = FstBlockC( k );
@@ -1036,5 +1062,7 @@ gather_diag_to_all(int_t n, int_t nrhs, double x[],
 	    }
 	}
     }
+    SUPERLU_FREE(off);
+    SUPERLU_FREE(bc);
 } /* GATHER_DIAG_TO_ALL */
 
@@ -34,6 +34,11 @@ at the top-level directory.
 
 #define ISEND_IRECV
 
+/* Apply the U blocks with GEMM when there are at least this many RHS */
+#ifndef BMOD_GEMM_NRHS
+#define BMOD_GEMM_NRHS 4
+#endif
+
 /*
  * Function prototypes
  */
@@ -47,6 +52,30 @@ _fcd ftcs2;
 _fcd ftcs3;
 #endif
 
+/*! \brief Subtract src from rows of dest shared by the threads.
+ *
+ * <pre>
+ * dest[rows[i] - rel + j*ldd] -= src[i + j*lds], for i < nrow and all the
+ * right-hand sides j, or dest[i + j*ldd] if rows is NULL, with atomic
+ * updates: the threads update the blocks of the shared lsum[] without
+ * locks (see LSUM_COPY()).
+ * </pre>
+ */
+static void dlsum_sub_atomic(double *dest, int_t ldd, int nrhs, int_t nrow,
+			      int_t *rows, int_t rel, double *src, int_t lds)
+{
+    int_t i, irow, j;
+
+    RHS_ITERATE(j)
+	for (i = 0; i < nrow; ++i) {
+	    irow = rows ? rows[i] - rel : i;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+	    dest[irow + j*ldd] -= src[i + j*lds];
+	}
+}
+
 /************************************************************************/
 /*! \brief
  *
@@ -107,6 +136,8 @@ void dlsum_fmod
     for (lb = 0; lb < nlb; ++lb) {
 	ik = lsub[lptr]; /* Global block number, row-wise. */
 	nbrow = lsub[lptr+1];
+	if ( !dgemm_small(nbrow, nrhs, knsupc,
+	                  &lusup[luptr], nsupr, xk, knsupc, rtemp, nbrow) ) {
 #ifdef _CRAY
 	SGEMM( ftcs2, ftcs2, &nbrow, &nrhs, &knsupc,
 	      &alpha, &lusup[luptr], &nsupr, xk,
@@ -120,6 +151,7 @@ void dlsum_fmod
 	       &alpha, &lusup[luptr], &nsupr, xk,
 	       &knsupc, &beta, rtemp, &nbrow );
 #endif
+	}
 	stat->ops[SOLVE] += 2 * nbrow * nrhs * knsupc + nbrow * nrhs;
 
 	lk = LBi( ik, grid ); /* Local block number, row-wise. */
@@ -175,6 +207,8 @@ void dlsum_fmod
 #if ( PROFlevel>=1 )
 			TIC(t1);
 #endif
+		    if ( !dtrsm_small('L', iknsupc, nrhs,
+		                      lusup1, nsupr1, &x[ii], iknsupc) ) {
 #ifdef _CRAY
 		    STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &iknsupc, &nrhs, &alpha,
 			  lusup1, &nsupr1, &x[ii], &iknsupc);
@@ -185,6 +219,7 @@ void dlsum_fmod
 		    dtrsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
 			   lusup1, &nsupr1, &x[ii], &iknsupc);
 #endif
+		    }
 #if ( PROFlevel>=1 )
 			TOC(t2, t1);
 			stat->utime[SOL_TRSM] += t2;
@@ -344,6 +379,8 @@ void dlsum_bmod
 		    lsub = Llu->Lrowind_bc_ptr[lk1];
 		    lusup = Llu->Lnzval_bc_ptr[lk1];
 		    nsupr = lsub[1];
+		    if ( !dtrsm_small('U', iknsupc, nrhs,
+		                      lusup, nsupr, &x[ii], iknsupc) ) {
 #ifdef _CRAY
 		    STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &iknsupc, &nrhs, &alpha,
 			  lusup, &nsupr, &x[ii], &iknsupc);
@@ -354,6 +391,7 @@ void dlsum_bmod
 		    dtrsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
 			   lusup, &nsupr, &x[ii], &iknsupc);
 #endif
+		    }
 		    stat->ops[SOLVE] += iknsupc * (iknsupc + 1) * nrhs;
 #if ( DEBUGlevel>=2 )
 		    printf("(%2d) Solve X[%2d]\n", iam, gik);
@@ -554,6 +592,8 @@ void dlsum_fmod_inv
 						nbrow += lsub[lptr1_tmp+1];
 					}
 
+					if ( !dgemm_small(nbrow, nrhs, knsupc,
+					                  &lusup[luptr_tmp1], nsupr, xk, knsupc, rtemp_loc, nbrow) ) {
 				#ifdef _CRAY
 					SGEMM( ftcs2, ftcs2, &nbrow, &nrhs, &knsupc,
 						  &alpha, &lusup[luptr_tmp1], &nsupr, xk,
@@ -567,6 +607,7 @@ void dlsum_fmod_inv
 						   &alpha, &lusup[luptr_tmp1], &nsupr, xk,
 						   &knsupc, &beta, rtemp_loc, &nbrow );
 				#endif
+					}
 
 					nbrow_ref=0;
 					for (lb = lbstart; lb < lbend; ++lb){
@@ -581,14 +622,19 @@ void dlsum_fmod_inv
 						iknsupc = SuperSize( ik );
 						il = LSUM_BLK( lk );
 
-						RHS_ITERATE(j)
-							#ifdef _OPENMP
-							#pragma omp simd
-							#endif
-							for (i = 0; i < nbrow1; ++i) {
-								irow = lsub[lptr+i] - rel; /* Relative row. */
-								lsum[il+irow + j*iknsupc+sizelsum*thread_id1] -= rtemp_loc[nbrow_ref+i + j*nbrow];
-							}
+						if ( Llu->lsum_shared ) {
+							dlsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1, &lsub[lptr],
+									   rel, &rtemp_loc[nbrow_ref], nbrow);
+						} else {
+							RHS_ITERATE(j)
+								#ifdef _OPENMP
+								#pragma omp simd
+								#endif
+								for (i = 0; i < nbrow1; ++i) {
+									irow = lsub[lptr+i] - rel; /* Relative row. */
+									lsum[il+irow + j*iknsupc+LSUM_COPY(thread_id1)] -= rtemp_loc[nbrow_ref+i + j*nbrow];
+								}
+						}
 						nbrow_ref+=nbrow1;
 					}
 
@@ -617,7 +663,7 @@ void dlsum_fmod_inv
 							ikcol = PCOL( ik, grid );
 							p = PNUM( myrow, ikcol, grid );
 							if ( iam != p ) {
-								for (ii=1;ii<num_thread;ii++)
+								for (ii=1;ii<LSUM_NCOPY;ii++)
 									#ifdef _OPENMP
 									#pragma omp simd
 									#endif
@@ -636,7 +682,7 @@ void dlsum_fmod_inv
 #if ( PROFlevel>=1 )
 								TIC(t1);
 #endif
-								for (ii=1;ii<num_thread;ii++)
+								for (ii=1;ii<LSUM_NCOPY;ii++)
 									#ifdef _OPENMP
 									#pragma omp simd
 									#endif
@@ -658,10 +704,12 @@ void dlsum_fmod_inv
 								lusup1 = Llu->Lnzval_bc_ptr[lk];
 								nsupr1 = lsub1[1];
 
-								if(Llu->inv == 1){
+								if(Llu->inv == 1 && Llu->Linv_bc_ptr[lk]){
 									Linv = Llu->Linv_bc_ptr[lk];
 
 
+									if ( !dgemm_small(iknsupc, nrhs, iknsupc,
+									                  Linv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
 #ifdef _CRAY
 									SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
 											&alpha, Linv, &iknsupc, &x[ii],
@@ -675,6 +723,7 @@ void dlsum_fmod_inv
 											&alpha, Linv, &iknsupc, &x[ii],
 											&iknsupc, &beta, rtemp_loc, &iknsupc );
 #endif
+									}
 									#ifdef _OPENMP
 									#pragma omp simd
 									#endif
@@ -683,6 +732,8 @@ void dlsum_fmod_inv
 									}
 
 								}else{
+									if ( !dtrsm_small('L', iknsupc, nrhs,
+									                  lusup1, nsupr1, &x[ii], iknsupc) ) {
 #ifdef _CRAY
 									STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &iknsupc, &nrhs, &alpha,
 											lusup1, &nsupr1, &x[ii], &iknsupc);
@@ -694,6 +745,7 @@ void dlsum_fmod_inv
 											lusup1, &nsupr1, &x[ii], &iknsupc);
 
 #endif
+									}
 								}
 
 #if ( PROFlevel>=1 )
@@ -703,6 +755,7 @@ void dlsum_fmod_inv
 #endif
 
 								stat[thread_id1]->ops[SOLVE] += iknsupc * (iknsupc - 1) * nrhs;
+								SOLVE_STAMP(Llu->sol_tdone, ik);
 
 #if ( DEBUGlevel>=2 )
 								printf("(%2d) Solve X[%2d]\n", iam, ik);
@@ -749,6 +802,8 @@ void dlsum_fmod_inv
 			TIC(t1);
 #endif
 
+			if ( !dgemm_small(m, nrhs, knsupc,
+			                  &lusup[luptr_tmp], nsupr, xk, knsupc, rtemp_loc, m) ) {
 #ifdef _CRAY
 			SGEMM( ftcs2, ftcs2, &m, &nrhs, &knsupc,
 					&alpha, &lusup[luptr_tmp], &nsupr, xk,
@@ -762,6 +817,7 @@ void dlsum_fmod_inv
 					&alpha, &lusup[luptr_tmp], &nsupr, xk,
 					&knsupc, &beta, rtemp_loc, &m );
 #endif
+			}
 
 			nbrow=0;
 			for (lb = 0; lb < nlb; ++lb){
@@ -781,15 +837,20 @@ void dlsum_fmod_inv
 				iknsupc = SuperSize( ik );
 				il = LSUM_BLK( lk );
 
-				RHS_ITERATE(j)
-					#ifdef _OPENMP
-					#pragma omp simd
-					#endif
-					for (i = 0; i < nbrow1; ++i) {
-						irow = lsub[lptr+i] - rel; /* Relative row. */
+				if ( Llu->lsum_shared ) {
+					dlsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1, &lsub[lptr],
+							   rel, &rtemp_loc[nbrow_ref], nbrow);
+				} else {
+					RHS_ITERATE(j)
+						#ifdef _OPENMP
+						#pragma omp simd
+						#endif
+						for (i = 0; i < nbrow1; ++i) {
+							irow = lsub[lptr+i] - rel; /* Relative row. */
 
-								lsum[il+irow + j*iknsupc+sizelsum*thread_id] -= rtemp_loc[nbrow_ref+i + j*nbrow];
-					}
+									lsum[il+irow + j*iknsupc+LSUM_COPY(thread_id)] -= rtemp_loc[nbrow_ref+i + j*nbrow];
+						}
+				}
 				nbrow_ref+=nbrow1;
 			}
 
@@ -821,7 +882,7 @@ void dlsum_fmod_inv
 					ikcol = PCOL( ik, grid );
 					p = PNUM( myrow, ikcol, grid );
 					if ( iam != p ) {
-						for (ii=1;ii<num_thread;ii++)
+						for (ii=1;ii<LSUM_NCOPY;ii++)
 							#ifdef _OPENMP
 							#pragma omp simd
 							#endif
@@ -839,7 +900,7 @@ void dlsum_fmod_inv
 #if ( PROFlevel>=1 )
 						TIC(t1);
 #endif
-						for (ii=1;ii<num_thread;ii++)
+						for (ii=1;ii<LSUM_NCOPY;ii++)
 							#ifdef _OPENMP
 							#pragma omp simd
 							#endif
@@ -860,8 +921,10 @@ void dlsum_fmod_inv
 						lusup1 = Llu->Lnzval_bc_ptr[lk];
 						nsupr1 = lsub1[1];
 
-						if(Llu->inv == 1){
+						if(Llu->inv == 1 && Llu->Linv_bc_ptr[lk]){
 							Linv = Llu->Linv_bc_ptr[lk];
+							if ( !dgemm_small(iknsupc, nrhs, iknsupc,
+							                  Linv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
 #ifdef _CRAY
 							SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
 									&alpha, Linv, &iknsupc, &x[ii],
@@ -875,6 +938,7 @@ void dlsum_fmod_inv
 									&alpha, Linv, &iknsupc, &x[ii],
 									&iknsupc, &beta, rtemp_loc, &iknsupc );
 #endif
+							}
 							#ifdef _OPENMP
 							#pragma omp simd
 							#endif
@@ -882,6 +946,8 @@ void dlsum_fmod_inv
 								x[ii+i] = rtemp_loc[i];
 							}
 						}else{
+							if ( !dtrsm_small('L', iknsupc, nrhs,
+							                  lusup1, nsupr1, &x[ii], iknsupc) ) {
 #ifdef _CRAY
 							STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &iknsupc, &nrhs, &alpha,
 									lusup1, &nsupr1, &x[ii], &iknsupc);
@@ -892,6 +958,7 @@ void dlsum_fmod_inv
 							dtrsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
 									lusup1, &nsupr1, &x[ii], &iknsupc);
 #endif
+							}
 						}
 
 #if ( PROFlevel>=1 )
@@ -900,6 +967,7 @@ void dlsum_fmod_inv
 #endif
 
 						stat[thread_id]->ops[SOLVE] += iknsupc * (iknsupc - 1) * nrhs;
+						SOLVE_STAMP(Llu->sol_tdone, ik);
 
 #if ( DEBUGlevel>=2 )
 						printf("(%2d) Solve X[%2d]\n", iam, ik);
@@ -1100,6 +1168,8 @@ void dlsum_fmod_inv_master
 						nbrow += lsub[lptr1_tmp+1];
 					}
 
+					if ( !dgemm_small(nbrow, nrhs, knsupc,
+					                  &lusup[luptr_tmp1], nsupr, xk, knsupc, rtemp_loc, nbrow) ) {
 				#ifdef _CRAY
 					SGEMM( ftcs2, ftcs2, &nbrow, &nrhs, &knsupc,
 						  &alpha, &lusup[luptr_tmp1], &nsupr, xk,
@@ -1113,6 +1183,7 @@ void dlsum_fmod_inv_master
 						   &alpha, &lusup[luptr_tmp1], &nsupr, xk,
 						   &knsupc, &beta, rtemp_loc, &nbrow );
 				#endif
+					}
 
 					nbrow_ref=0;
 					for (lb = lbstart; lb < lbend; ++lb){
@@ -1127,14 +1198,19 @@ void dlsum_fmod_inv_master
 						iknsupc = SuperSize( ik );
 						il = LSUM_BLK( lk );
 
-						RHS_ITERATE(j)
-							#ifdef _OPENMP
-								#pragma omp simd lastprivate(irow)
-							#endif
-							for (i = 0; i < nbrow1; ++i) {
-								irow = lsub[lptr+i] - rel; /* Relative row. */
-								lsum[il+irow + j*iknsupc] -= rtemp_loc[nbrow_ref+i + j*nbrow];
-							}
+						if ( Llu->lsum_shared ) {
+							dlsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1, &lsub[lptr],
+									   rel, &rtemp_loc[nbrow_ref], nbrow);
+						} else {
+							RHS_ITERATE(j)
+								#ifdef _OPENMP
+									#pragma omp simd lastprivate(irow)
+								#endif
+								for (i = 0; i < nbrow1; ++i) {
+									irow = lsub[lptr+i] - rel; /* Relative row. */
+									lsum[il+irow + j*iknsupc] -= rtemp_loc[nbrow_ref+i + j*nbrow];
+								}
+						}
 						nbrow_ref+=nbrow1;
 					}
 
@@ -1151,6 +1227,8 @@ void dlsum_fmod_inv_master
 			TIC(t1);
 #endif
 
+			if ( !dgemm_small(m, nrhs, knsupc,
+			                  &lusup[luptr_tmp], nsupr, xk, knsupc, rtemp_loc, m) ) {
 #ifdef _CRAY
 			SGEMM( ftcs2, ftcs2, &m, &nrhs, &knsupc,
 					&alpha, &lusup[luptr_tmp], &nsupr, xk,
@@ -1164,6 +1242,7 @@ void dlsum_fmod_inv_master
 					&alpha, &lusup[luptr_tmp], &nsupr, xk,
 					&knsupc, &beta, rtemp_loc, &m );
 #endif
+			}
 
 			nbrow=0;
 			for (lb = 0; lb < nlb; ++lb){
@@ -1183,15 +1262,20 @@ void dlsum_fmod_inv_master
 				iknsupc = SuperSize( ik );
 				il = LSUM_BLK( lk );
 
-				RHS_ITERATE(j)
-					#ifdef _OPENMP
-						#pragma omp simd lastprivate(irow)
-					#endif
-					for (i = 0; i < nbrow1; ++i) {
-						irow = lsub[lptr+i] - rel; /* Relative row. */
+				if ( Llu->lsum_shared ) {
+					dlsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1, &lsub[lptr],
+							   rel, &rtemp_loc[nbrow_ref], nbrow);
+				} else {
+					RHS_ITERATE(j)
+						#ifdef _OPENMP
+							#pragma omp simd lastprivate(irow)
+						#endif
+						for (i = 0; i < nbrow1; ++i) {
+							irow = lsub[lptr+i] - rel; /* Relative row. */
 
-								lsum[il+irow + j*iknsupc+sizelsum*thread_id] -= rtemp_loc[nbrow_ref+i + j*nbrow];
-					}
+									lsum[il+irow + j*iknsupc+LSUM_COPY(thread_id)] -= rtemp_loc[nbrow_ref+i + j*nbrow];
+						}
+				}
 				nbrow_ref+=nbrow1;
 			}
 #if ( PROFlevel>=1 )
@@ -1232,7 +1316,7 @@ void dlsum_fmod_inv_master
 					// if(frecv[lk]==0){
 					// fmod[lk] = -1;
 
-					for (ii=1;ii<num_thread;ii++)
+					for (ii=1;ii<LSUM_NCOPY;ii++)
 						// if(ii!=thread_id)
 						#ifdef _OPENMP
 							#pragma omp simd
@@ -1253,7 +1337,7 @@ void dlsum_fmod_inv_master
 #if ( PROFlevel>=1 )
 					TIC(t1);
 #endif
-					for (ii=1;ii<num_thread;ii++)
+					for (ii=1;ii<LSUM_NCOPY;ii++)
 						// if(ii!=thread_id)
 						#ifdef _OPENMP
 							#pragma omp simd
@@ -1276,8 +1360,10 @@ void dlsum_fmod_inv_master
 					lusup1 = Llu->Lnzval_bc_ptr[lk];
 					nsupr1 = lsub1[1];
 
-					if(Llu->inv == 1){
+					if(Llu->inv == 1 && Llu->Linv_bc_ptr[lk]){
 						Linv = Llu->Linv_bc_ptr[lk];
+						if ( !dgemm_small(iknsupc, nrhs, iknsupc,
+						                  Linv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
 #ifdef _CRAY
 						SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
 								&alpha, Linv, &iknsupc, &x[ii],
@@ -1291,6 +1377,7 @@ void dlsum_fmod_inv_master
 								&alpha, Linv, &iknsupc, &x[ii],
 								&iknsupc, &beta, rtemp_loc, &iknsupc );
 #endif
+						}
 						#ifdef _OPENMP
 							#pragma omp simd
 						#endif
@@ -1298,6 +1385,8 @@ void dlsum_fmod_inv_master
 							x[ii+i] = rtemp_loc[i];
 						}
 					}else{
+						if ( !dtrsm_small('L', iknsupc, nrhs,
+						                  lusup1, nsupr1, &x[ii], iknsupc) ) {
 #ifdef _CRAY
 						STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &iknsupc, &nrhs, &alpha,
 								lusup1, &nsupr1, &x[ii], &iknsupc);
@@ -1308,6 +1397,7 @@ void dlsum_fmod_inv_master
 						dtrsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
 								lusup1, &nsupr1, &x[ii], &iknsupc);
 #endif
+						}
 					}
 
 #if ( PROFlevel>=1 )
@@ -1317,6 +1407,7 @@ void dlsum_fmod_inv_master
 #endif
 
 					stat[thread_id]->ops[SOLVE] += iknsupc * (iknsupc - 1) * nrhs;
+					SOLVE_STAMP(Llu->sol_tdone, ik);
 
 #if ( DEBUGlevel>=2 )
 					printf("(%2d) Solve X[%2d]\n", iam, ik);
@@ -1355,6 +1446,127 @@ void dlsum_fmod_inv_master
 } /* dLSUM_FMOD_INV */
 
 
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform dest -= U_i,k * X[k] for one block U_i,k, for all the
+ *   right-hand sides. The block is stored by column segments: column jj
+ *   has nonzeros in rows usub[jj], ..., iklrow-1.
+ *
+ *   With nrhs < BMOD_GEMM_NRHS the segments are applied one AXPY at a
+ *   time for each right-hand side. Otherwise the block is expanded into
+ *   a dense matrix in work[] (padded with zeros above the segments) and
+ *   applied to all the right-hand sides with a single GEMM. The AXPY
+ *   loop is kept when the dense block does not fit in work[].
+ *
+ *   If the threads share lsum[] (shared != 0), dest is updated with
+ *   atomic subtractions; the GEMM then goes to work[] after the dense
+ *   block, which must also fit.
+ * </pre>
+ */
+static void dlsum_bmod_blk
+/************************************************************************/
+(
+ double *dest,    /* lsum[] of block i, leading dimension iknsupc.      */
+ double *xk,      /* X[k], leading dimension knsupc.                    */
+ int    nrhs,     /* Number of right-hand sides.                        */
+ int    knsupc,   /* Size of supernode k.                               */
+ int_t  *usub,    /* First nonzero row of each column of the block.     */
+ double *uval,    /* Nonzeros of the block, column by column.           */
+ int_t  ikfrow,   /* First row of supernode i.                          */
+ int_t  iklrow,   /* First row of supernode i+1.                        */
+ double *work,    /* Workspace for the dense block.                     */
+ int_t  lwork,    /* Size of work[].                                    */
+ flops_t *ops,    /* Flop count of the solve.                           */
+ int    shared    /* lsum[] is shared by the threads.                   */
+ )
+{
+    double alpha = -1.0, beta = 1.0, one = 1.0, zero = 0.0, t;
+    int    iknsupc = iklrow - ikfrow, nrow;
+    int_t  fnz, fnzmin = iklrow, irow, j, jj, uptr;
+    double *y, *dst;
+
+    for (jj = 0; jj < knsupc; ++jj) fnzmin = SUPERLU_MIN(fnzmin, usub[jj]);
+    if ( fnzmin == iklrow ) return; /* Empty block. */
+    nrow = iklrow - fnzmin;
+
+    if ( nrhs < BMOD_GEMM_NRHS
+	 || (int_t) nrow * (knsupc + (shared ? nrhs : 0)) > lwork ) {
+	RHS_ITERATE(j) {
+	    dst = &dest[j*iknsupc];
+	    y = &xk[j*knsupc];
+	    uptr = 0;
+	    for (jj = 0; jj < knsupc; ++jj) {
+		fnz = usub[jj];
+		if ( fnz < iklrow ) { /* Nonzero segment. */
+		    /* AXPY */
+		    if ( shared ) {
+			for (irow = fnz; irow < iklrow; ++irow) {
+			    t = uval[uptr++] * y[jj];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+			    dst[irow - ikfrow] -= t;
+			}
+		    } else {
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+			for (irow = fnz; irow < iklrow; ++irow)
+			    dst[irow - ikfrow] -= uval[uptr++] * y[jj];
+		    }
+		    *ops += 2 * (iklrow - fnz);
+		}
+	    } /* for jj ... */
+	}
+	return;
+    }
+
+    /* Expand the block into rows fnzmin:iklrow-1 of a dense matrix. */
+    uptr = 0;
+    for (jj = 0; jj < knsupc; ++jj) {
+	fnz = usub[jj];
+	y = &work[jj*nrow];
+	for (irow = fnzmin; irow < fnz; ++irow) y[irow - fnzmin] = 0.0;
+	for (irow = fnz; irow < iklrow; ++irow) y[irow - fnzmin] = uval[uptr++];
+	*ops += 2 * (iklrow - fnz) * nrhs;
+    }
+
+    dst = &dest[fnzmin - ikfrow];
+    if ( shared ) {
+	/* Y = U_i,k * X[k] in work[], subtracted from dest atomically. */
+	y = &work[nrow * knsupc];
+#ifdef _CRAY
+	SGEMM( ftcs2, ftcs2, &nrow, &nrhs, &knsupc,
+	       &one, work, &nrow, xk, &knsupc, &zero, y, &nrow );
+#elif defined (USE_VENDOR_BLAS)
+	dgemm_( "N", "N", &nrow, &nrhs, &knsupc,
+		&one, work, &nrow, xk, &knsupc, &zero, y, &nrow, 1, 1 );
+#else
+	dgemm_( "N", "N", &nrow, &nrhs, &knsupc,
+		&one, work, &nrow, xk, &knsupc, &zero, y, &nrow );
+#endif
+	dlsum_sub_atomic(dst, iknsupc, nrhs, nrow, NULL, 0, y, nrow);
+	return;
+    }
+    if ( !dgemm_small_sub(nrow, nrhs, knsupc,
+                          work, nrow, xk, knsupc, dst, iknsupc) ) {
+#ifdef _CRAY
+    SGEMM( ftcs2, ftcs2, &nrow, &nrhs, &knsupc,
+	   &alpha, work, &nrow, xk, &knsupc, &beta, dst, &iknsupc );
+#elif defined (USE_VENDOR_BLAS)
+    dgemm_( "N", "N", &nrow, &nrhs, &knsupc,
+	    &alpha, work, &nrow, xk, &knsupc, &beta, dst, &iknsupc, 1, 1 );
+#else
+    dgemm_( "N", "N", &nrow, &nrhs, &knsupc,
+	    &alpha, work, &nrow, xk, &knsupc, &beta, dst, &iknsupc );
+#endif
+    }
+} /* dlsum_bmod_blk */
+
 
 /************************************************************************/
 void dlsum_bmod_inv
@@ -1389,10 +1601,10 @@ void dlsum_bmod_inv
 	 */
     double alpha = 1.0, beta = 0.0;
 	int    iam, iknsupc, knsupc, myrow, nsupr, p, pi;
-	int_t  fnz, gik, gikcol, i, ii, ik, ikfrow, iklrow, il, irow,
+	int_t  gik, gikcol, i, ii, ik, ikfrow, iklrow, il,
 	       j, jj, lk, lk1, nub, ub, uptr;
 	int_t  *usub;
-	double *uval, *dest, *y;
+	double *uval, *dest;
 	int_t  *lsub;
 	double *lusup;
 	int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
@@ -1434,7 +1646,7 @@ void dlsum_bmod_inv
 		remainder = nub % Nchunk;
 		// printf("Unnz: %5d nub: %5d knsupc: %5d\n",Llu->Unnz[lk],nub,knsupc);
 #ifdef _OPENMP
-#pragma	omp	taskloop firstprivate (stat) private (thread_id1,Uinv,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,lk1,gik,gikcol,usub,uval,lsub,lusup,iknsupc,il,i,irow,bmod_tmp,p,ii,jj,t1,t2,j,ikfrow,iklrow,dest,y,uptr,fnz,nsupr) untied nogroup
+#pragma	omp	taskloop firstprivate (stat) private (thread_id1,Uinv,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,lk1,gik,gikcol,usub,uval,lsub,lusup,iknsupc,il,i,bmod_tmp,p,ii,jj,t1,t2,j,ikfrow,iklrow,dest,uptr,nsupr) untied nogroup
 #endif
 		for (nn=0;nn<Nchunk;++nn){
 
@@ -1468,24 +1680,11 @@ void dlsum_bmod_inv
 				TIC(t1);
 #endif
 
-				RHS_ITERATE(j) {
-					dest = &lsum[il + j*iknsupc+sizelsum*thread_id1];
-					y = &xk[j*knsupc];
-					uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
-					for (jj = 0; jj < knsupc; ++jj) {
-						fnz = usub[i + jj];
-						if ( fnz < iklrow ) { /* Nonzero segment. */
-							/* AXPY */
-							#ifdef _OPENMP
-							#pragma omp simd
-							#endif
-							for (irow = fnz; irow < iklrow; ++irow)
-								dest[irow - ikfrow] -= uval[uptr++] * y[jj];
-								stat[thread_id1]->ops[SOLVE] += 2 * (iklrow - fnz);
-
-						}
-					} /* for jj ... */
-				}
+				uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
+				dlsum_bmod_blk(&lsum[il+LSUM_COPY(thread_id1)], xk, nrhs, knsupc,
+						&usub[i], &uval[uptr], ikfrow, iklrow,
+						rtemp_loc, sizertemp, &stat[thread_id1]->ops[SOLVE],
+						Llu->lsum_shared);
 
 #if ( PROFlevel>=1 )
 				TOC(t2, t1);
@@ -1502,7 +1701,7 @@ void dlsum_bmod_inv
 					gikcol = PCOL( gik, grid );
 					p = PNUM( myrow, gikcol, grid );
 					if ( iam != p ) {
-						for (ii=1;ii<num_thread;ii++)
+						for (ii=1;ii<LSUM_NCOPY;ii++)
 							// if(ii!=thread_id1)
 							#ifdef _OPENMP
 							#pragma omp simd
@@ -1527,7 +1726,7 @@ void dlsum_bmod_inv
 						TIC(t1);
 #endif
 
-						for (ii=1;ii<num_thread;ii++)
+						for (ii=1;ii<LSUM_NCOPY;ii++)
 							// if(ii!=thread_id1)
 							#ifdef _OPENMP
 							#pragma omp simd
@@ -1552,8 +1751,10 @@ void dlsum_bmod_inv
 							lusup = Llu->Lnzval_bc_ptr[lk1];
 							nsupr = lsub[1];
 
-							if(Llu->inv == 1){
+							if(Llu->inv == 1 && Llu->Uinv_bc_ptr[lk1]){
 								Uinv = Llu->Uinv_bc_ptr[lk1];
+								if ( !dgemm_small(iknsupc, nrhs, iknsupc,
+								                  Uinv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
 		#ifdef _CRAY
 								SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
 										&alpha, Uinv, &iknsupc, &x[ii],
@@ -1567,6 +1768,7 @@ void dlsum_bmod_inv
 										&alpha, Uinv, &iknsupc, &x[ii],
 										&iknsupc, &beta, rtemp_loc, &iknsupc );
 		#endif
+								}
 								#ifdef _OPENMP
 								#pragma omp simd
 								#endif
@@ -1574,6 +1776,8 @@ void dlsum_bmod_inv
 									x[ii+i] = rtemp_loc[i];
 								}
 							}else{
+								if ( !dtrsm_small('U', iknsupc, nrhs,
+								                  lusup, nsupr, &x[ii], iknsupc) ) {
 		#ifdef _CRAY
 								STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &iknsupc, &nrhs, &alpha,
 										lusup, &nsupr, &x[ii], &iknsupc);
@@ -1584,6 +1788,7 @@ void dlsum_bmod_inv
 								dtrsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
 										lusup, &nsupr, &x[ii], &iknsupc);
 		#endif
+								}
 							}
 
 		#if ( PROFlevel>=1 )
@@ -1591,6 +1796,7 @@ void dlsum_bmod_inv
 							stat[thread_id1]->utime[SOL_TRSM] += t2;
 		#endif
 							stat[thread_id1]->ops[SOLVE] += iknsupc * (iknsupc + 1) * nrhs;
+							SOLVE_STAMP(Llu->sol_tdone, gik);
 
 		#if ( DEBUGlevel>=2 )
 							printf("(%2d) Solve X[%2d]\n", iam, gik);
@@ -1651,24 +1857,11 @@ void dlsum_bmod_inv
 #if ( PROFlevel>=1 )
 		TIC(t1);
 #endif
-			RHS_ITERATE(j) {
-				dest = &lsum[il + j*iknsupc+sizelsum*thread_id];
-				y = &xk[j*knsupc];
-				uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
-				for (jj = 0; jj < knsupc; ++jj) {
-					fnz = usub[i + jj];
-					if ( fnz < iklrow ) { /* Nonzero segment. */
-						/* AXPY */
-						#ifdef _OPENMP
-						#pragma omp simd
-						#endif
-						for (irow = fnz; irow < iklrow; ++irow)
-
-								dest[irow - ikfrow] -= uval[uptr++] * y[jj];
-								stat[thread_id]->ops[SOLVE] += 2 * (iklrow - fnz);
-					}
-				} /* for jj ... */
-			}
+			uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
+			dlsum_bmod_blk(&lsum[il+LSUM_COPY(thread_id)], xk, nrhs, knsupc,
+					&usub[i], &uval[uptr], ikfrow, iklrow,
+					rtemp_loc, sizertemp, &stat[thread_id]->ops[SOLVE],
+					Llu->lsum_shared);
 
 #if ( PROFlevel>=1 )
 		TOC(t2, t1);
@@ -1684,7 +1877,7 @@ void dlsum_bmod_inv
 				gikcol = PCOL( gik, grid );
 				p = PNUM( myrow, gikcol, grid );
 				if ( iam != p ) {
-					for (ii=1;ii<num_thread;ii++)
+					for (ii=1;ii<LSUM_NCOPY;ii++)
 						// if(ii!=thread_id)
 						#ifdef _OPENMP
 						#pragma omp simd
@@ -1708,7 +1901,7 @@ void dlsum_bmod_inv
 					TIC(t1);
 #endif
 
-					for (ii=1;ii<num_thread;ii++)
+					for (ii=1;ii<LSUM_NCOPY;ii++)
 						// if(ii!=thread_id)
 						#ifdef _OPENMP
 						#pragma omp simd
@@ -1733,8 +1926,10 @@ void dlsum_bmod_inv
 						lusup = Llu->Lnzval_bc_ptr[lk1];
 						nsupr = lsub[1];
 
-						if(Llu->inv == 1){
+						if(Llu->inv == 1 && Llu->Uinv_bc_ptr[lk1]){
 							Uinv = Llu->Uinv_bc_ptr[lk1];
+							if ( !dgemm_small(iknsupc, nrhs, iknsupc,
+							                  Uinv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
 	#ifdef _CRAY
 							SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
 									&alpha, Uinv, &iknsupc, &x[ii],
@@ -1748,6 +1943,7 @@ void dlsum_bmod_inv
 									&alpha, Uinv, &iknsupc, &x[ii],
 									&iknsupc, &beta, rtemp_loc, &iknsupc );
 	#endif
+							}
 							#ifdef _OPENMP
 							#pragma omp simd
 							#endif
@@ -1755,6 +1951,8 @@ void dlsum_bmod_inv
 								x[ii+i] = rtemp_loc[i];
 							}
 						}else{
+							if ( !dtrsm_small('U', iknsupc, nrhs,
+							                  lusup, nsupr, &x[ii], iknsupc) ) {
 	#ifdef _CRAY
 							STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &iknsupc, &nrhs, &alpha,
 									lusup, &nsupr, &x[ii], &iknsupc);
@@ -1765,6 +1963,7 @@ void dlsum_bmod_inv
 							dtrsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
 									lusup, &nsupr, &x[ii], &iknsupc);
 	#endif
+							}
 						}
 
 	#if ( PROFlevel>=1 )
@@ -1772,6 +1971,7 @@ void dlsum_bmod_inv
 						stat[thread_id]->utime[SOL_TRSM] += t2;
 	#endif
 						stat[thread_id]->ops[SOLVE] += iknsupc * (iknsupc + 1) * nrhs;
+						SOLVE_STAMP(Llu->sol_tdone, gik);
 	#if ( DEBUGlevel>=2 )
 						printf("(%2d) Solve X[%2d]\n", iam, gik);
 	#endif
@@ -1853,10 +2053,10 @@ void dlsum_bmod_inv_master
 	 */
     double alpha = 1.0, beta = 0.0;
 	int    iam, iknsupc, knsupc, myrow, nsupr, p, pi;
-	int_t  fnz, gik, gikcol, i, ii, ik, ikfrow, iklrow, il, irow,
+	int_t  gik, gikcol, i, ii, ik, ikfrow, iklrow, il,
 	       j, jj, lk, lk1, nub, ub, uptr;
 	int_t  *usub;
-	double *uval, *dest, *y;
+	double *uval, *dest;
 	int_t  *lsub;
 	double *lusup;
 	int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
@@ -1935,24 +2135,11 @@ void dlsum_bmod_inv_master
 				ikfrow = FstBlockC( gik );
 				iklrow = FstBlockC( gik+1 );
 
-				RHS_ITERATE(j) {
-					dest = &lsum[il + j*iknsupc+sizelsum*thread_id1];
-					y = &xk[j*knsupc];
-					uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
-					for (jj = 0; jj < knsupc; ++jj) {
-						fnz = usub[i + jj];
-						if ( fnz < iklrow ) { /* Nonzero segment. */
-							/* AXPY */
-							#ifdef _OPENMP
-							#pragma omp simd
-							#endif
-							for (irow = fnz; irow < iklrow; ++irow)
-								dest[irow - ikfrow] -= uval[uptr++] * y[jj];
-							stat[thread_id1]->ops[SOLVE] += 2 * (iklrow - fnz);
-
-						}
-					} /* for jj ... */
-				}
+				uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
+				dlsum_bmod_blk(&lsum[il+LSUM_COPY(thread_id1)], xk, nrhs, knsupc,
+						&usub[i], &uval[uptr], ikfrow, iklrow,
+						rtemp_loc, sizertemp, &stat[thread_id1]->ops[SOLVE],
+						Llu->lsum_shared);
 			}
 #if ( PROFlevel>=1 )
 			TOC(t2, t1);
@@ -1977,24 +2164,11 @@ void dlsum_bmod_inv_master
 			ikfrow = FstBlockC( gik );
 			iklrow = FstBlockC( gik+1 );
 
-			RHS_ITERATE(j) {
-				dest = &lsum[il + j*iknsupc+sizelsum*thread_id];
-				y = &xk[j*knsupc];
-				uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
-				for (jj = 0; jj < knsupc; ++jj) {
-					fnz = usub[i + jj];
-					if ( fnz < iklrow ) { /* Nonzero segment. */
-						/* AXPY */
-						#ifdef _OPENMP
-						#pragma omp simd
-						#endif
-						for (irow = fnz; irow < iklrow; ++irow)
-							dest[irow - ikfrow] -= uval[uptr++] * y[jj];
-						stat[thread_id]->ops[SOLVE] += 2 * (iklrow - fnz);
-
-					}
-				} /* for jj ... */
-			}
+			uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
+			dlsum_bmod_blk(&lsum[il+LSUM_COPY(thread_id)], xk, nrhs, knsupc,
+					&usub[i], &uval[uptr], ikfrow, iklrow,
+					rtemp_loc, sizertemp, &stat[thread_id]->ops[SOLVE],
+					Llu->lsum_shared);
 		}
 #if ( PROFlevel>=1 )
 		TOC(t2, t1);
@@ -2019,7 +2193,7 @@ void dlsum_bmod_inv_master
 			gikcol = PCOL( gik, grid );
 			p = PNUM( myrow, gikcol, grid );
 			if ( iam != p ) {
-				for (ii=1;ii<num_thread;ii++)
+				for (ii=1;ii<LSUM_NCOPY;ii++)
 					// if(ii!=thread_id)
 					#ifdef _OPENMP
 					#pragma omp simd
@@ -2037,7 +2211,7 @@ void dlsum_bmod_inv_master
 #if ( PROFlevel>=1 )
 				TIC(t1);
 #endif
-				for (ii=1;ii<num_thread;ii++)
+				for (ii=1;ii<LSUM_NCOPY;ii++)
 					// if(ii!=thread_id)
 					#ifdef _OPENMP
 					#pragma omp simd
@@ -2062,8 +2236,10 @@ void dlsum_bmod_inv_master
 					lusup = Llu->Lnzval_bc_ptr[lk1];
 					nsupr = lsub[1];
 
-					if(Llu->inv == 1){
+					if(Llu->inv == 1 && Llu->Uinv_bc_ptr[lk1]){
 						Uinv = Llu->Uinv_bc_ptr[lk1];
+						if ( !dgemm_small(iknsupc, nrhs, iknsupc,
+						                  Uinv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
 #ifdef _CRAY
 						SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
 								&alpha, Uinv, &iknsupc, &x[ii],
@@ -2077,6 +2253,7 @@ void dlsum_bmod_inv_master
 								&alpha, Uinv, &iknsupc, &x[ii],
 								&iknsupc, &beta, rtemp_loc, &iknsupc );
 #endif
+						}
 						#ifdef _OPENMP
 						#pragma omp simd
 						#endif
@@ -2084,6 +2261,8 @@ void dlsum_bmod_inv_master
 							x[ii+i] = rtemp_loc[i];
 						}
 					}else{
+						if ( !dtrsm_small('U', iknsupc, nrhs,
+						                  lusup, nsupr, &x[ii], iknsupc) ) {
 #ifdef _CRAY
 						STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &iknsupc, &nrhs, &alpha,
 								lusup, &nsupr, &x[ii], &iknsupc);
@@ -2094,6 +2273,7 @@ void dlsum_bmod_inv_master
 						dtrsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
 								lusup, &nsupr, &x[ii], &iknsupc);
 #endif
+						}
 					}
 
 #if ( PROFlevel>=1 )
@@ -2101,6 +2281,7 @@ void dlsum_bmod_inv_master
 					stat[thread_id]->utime[SOL_TRSM] += t2;
 #endif
 					stat[thread_id]->ops[SOLVE] += iknsupc * (iknsupc + 1) * nrhs;
+					SOLVE_STAMP(Llu->sol_tdone, gik);
 #if ( DEBUGlevel>=2 )
 					printf("(%2d) Solve X[%2d]\n", iam, gik);
 #endif
@@ -2136,3 +2317,684 @@ void dlsum_bmod_inv_master
 	}
 
 } /* dlsum_bmod_inv_master */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform the L-solve of pdgstrs on one process with all the threads,
+ *   without the recursive tasks of dlsum_fmod_inv().
+ *
+ *   The supernodes are taken in the order of lvlsups[], the level sets of
+ *   the L-solve, each thread taking the next one with an atomic counter.
+ *   A thread waits until the count fmod[] of its supernode k drops to 0,
+ *   adds the partial sums of all the threads into X[k], solves with the
+ *   diagonal block, and subtracts L(i,k) * X[k] from its own copy of
+ *   lsum[i], decrementing fmod[i] atomically. As the supernodes that k
+ *   depends on are at lower levels, they are taken before k, so that the
+ *   threads never wait on a supernode that is not being solved.
+ * </pre>
+ */
+void dlsum_fmod_levels
+/************************************************************************/
+(
+ double *lsum,    /* Sum of local modifications, one copy per thread.   */
+ double *x,       /* X array (local)                                    */
+ double *rtemp,   /* Workspace for the GEMM results, one per thread.    */
+ int    nrhs,     /* Number of right-hand sides.                        */
+ int_t  nsupers,  /* Number of supernodes.                              */
+ int_t  *fmod,    /* Modification count for L-solve.                    */
+ int_t  *lvlsups, /* The supernodes in the order of the level sets.     */
+ int    *active,  /* The supernodes solved, NULL for all of them.       */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ dLocalLU_t *Llu,
+ SuperLUStat_t **stat,
+ int_t  sizelsum,
+ int_t  sizertemp,
+ int    num_thread
+)
+{
+    int_t *ilsum = Llu->ilsum;
+    int_t aln_i = ceil(CACHELINE/(double)sizeof(int_t));
+    int_t next = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel default(shared)
+#endif
+    {
+	double alpha = 1.0, beta = 0.0;
+	double *lusup, *Linv, *rtemp_loc, *xk;
+	int_t  *lsub, *lloc;
+	int    knsupc, iknsupc, nsupr, m, nbrow1, thread_id = 0;
+	int_t  i, j, jj, k, t, ii, ik, il, irow, lb, lk, lkc, nlb, nbrow;
+	int_t  lptr, rel, fmod_tmp;
+
+#ifdef _OPENMP
+	thread_id = omp_get_thread_num();
+#endif
+	rtemp_loc = &rtemp[sizertemp * thread_id];
+
+	for (;;) {
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+	    jj = next++;
+	    if ( jj >= nsupers ) break;
+	    k = lvlsups[jj];
+	    if ( active && !active[k] ) continue; /* X[k] = 0 */
+	    lk = LBi( k, grid );   /* Local block number, row-wise. */
+	    lkc = LBj( k, grid );  /* Local block number, column-wise. */
+
+	    /* Wait for the modifications of X[k] by the lower levels. */
+	    do {
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+		fmod_tmp = fmod[lk*aln_i];
+	    } while ( fmod_tmp > 0 );
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+
+	    /* X[k] += lsum[k], summed over the threads. */
+	    knsupc = SuperSize( k );
+	    il = LSUM_BLK( lk );
+	    ii = X_BLK( lk );
+	    xk = &x[ii];
+	    for (t = 0; t < LSUM_NCOPY; ++t)
+		for (i = 0; i < knsupc * nrhs; ++i)
+		    xk[i] += lsum[il + i + t*sizelsum];
+
+	    lsub = Llu->Lrowind_bc_ptr[lkc];
+	    lusup = Llu->Lnzval_bc_ptr[lkc];
+	    nsupr = lsub[1];
+	    if ( Llu->inv == 1 && Llu->Linv_bc_ptr[lkc] ) {
+		Linv = Llu->Linv_bc_ptr[lkc];
+		if ( !dgemm_small(knsupc, nrhs, knsupc,
+		                  Linv, knsupc, xk, knsupc, rtemp_loc, knsupc) ) {
+#ifdef _CRAY
+		SGEMM( ftcs2, ftcs2, &knsupc, &nrhs, &knsupc,
+		       &alpha, Linv, &knsupc, xk, &knsupc, &beta, rtemp_loc, &knsupc );
+#elif defined (USE_VENDOR_BLAS)
+		dgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+			&alpha, Linv, &knsupc, xk, &knsupc, &beta, rtemp_loc, &knsupc, 1, 1 );
+#else
+		dgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+			&alpha, Linv, &knsupc, xk, &knsupc, &beta, rtemp_loc, &knsupc );
+#endif
+		}
+		for (i = 0; i < knsupc * nrhs; ++i) xk[i] = rtemp_loc[i];
+	    } else {
+		if ( !dtrsm_small('L', knsupc, nrhs,
+		                  lusup, nsupr, xk, knsupc) ) {
+#ifdef _CRAY
+		STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &knsupc, &nrhs, &alpha,
+		      lusup, &nsupr, xk, &knsupc);
+#elif defined (USE_VENDOR_BLAS)
+		dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+		       lusup, &nsupr, xk, &knsupc, 1, 1, 1, 1);
+#else
+		dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+		       lusup, &nsupr, xk, &knsupc);
+#endif
+		}
+	    }
+	    stat[thread_id]->ops[SOLVE] += knsupc * (knsupc - 1) * nrhs;
+	    SOLVE_STAMP(Llu->sol_tdone, k);
+
+	    /* lsum[i] -= L(i,k) * X[k] in the copy of this thread. */
+	    nlb = lsub[0] - 1; /* The diagonal block is first. */
+	    if ( nlb == 0 ) continue;
+	    lloc = Llu->Lindval_loc_bc_ptr[lkc];
+	    m = nsupr - knsupc;
+	    if ( !dgemm_small(m, nrhs, knsupc,
+	                      &lusup[lloc[2*nlb+3]], nsupr, xk, knsupc, rtemp_loc, m) ) {
+#ifdef _CRAY
+	    SGEMM( ftcs2, ftcs2, &m, &nrhs, &knsupc,
+		   &alpha, &lusup[lloc[2*nlb+3]], &nsupr, xk,
+		   &knsupc, &beta, rtemp_loc, &m );
+#elif defined (USE_VENDOR_BLAS)
+	    dgemm_( "N", "N", &m, &nrhs, &knsupc,
+		    &alpha, &lusup[lloc[2*nlb+3]], &nsupr, xk,
+		    &knsupc, &beta, rtemp_loc, &m, 1, 1 );
+#else
+	    dgemm_( "N", "N", &m, &nrhs, &knsupc,
+		    &alpha, &lusup[lloc[2*nlb+3]], &nsupr, xk,
+		    &knsupc, &beta, rtemp_loc, &m );
+#endif
+	    }
+	    stat[thread_id]->ops[SOLVE] += 2 * m * nrhs * knsupc;
+
+	    nbrow = 0;
+	    for (lb = 0; lb < nlb; ++lb) {
+		lptr = lloc[lb + nlb + 2];
+		nbrow1 = lsub[lptr + 1];
+		ik = lsub[lptr]; /* Global block number, row-wise. */
+		rel = xsup[ik];  /* Global row index of block ik. */
+		iknsupc = SuperSize( ik );
+		il = LSUM_BLK( LBi( ik, grid ) ) + LSUM_COPY(thread_id);
+		if ( Llu->lsum_shared )
+		    dlsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1,
+				     &lsub[lptr + 2], rel, &rtemp_loc[nbrow], m);
+		else
+		    RHS_ITERATE(j)
+			for (i = 0; i < nbrow1; ++i) {
+			    irow = lsub[lptr + 2 + i] - rel; /* Relative row. */
+			    lsum[il + irow + j*iknsupc] -= rtemp_loc[nbrow + i + j*m];
+			}
+		nbrow += nbrow1;
+	    }
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+	    for (lb = 0; lb < nlb; ++lb) {
+		lk = lloc[lb + 1];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+		--fmod[lk*aln_i];
+	    }
+	}
+    }
+} /* dlsum_fmod_levels */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Complete the block lsum[lk] of the fixed-order solves, once all its
+ *   local modifications are done and the contributions of its children
+ *   in the reduction tree are buffered in rdbuf[]. The children are
+ *   added in increasing order of the sending process. The diagonal
+ *   process then solves for X[k] and sends it down the broadcast tree;
+ *   the other processes send lsum[lk] to their parent.
+ * </pre>
+ */
+static void dlsum_fixed_done
+/************************************************************************/
+(
+ char   uplo,     /* 'L' for the L-solve, 'U' for the U-solve.          */
+ int_t  lk,       /* Local block number, row-wise.                      */
+ double *lsum,
+ double *x,
+ double *rtemp,
+ int    nrhs,
+ int_t  *rdoff,   /* Start of the children of block lk in rdbuf[].     */
+ int_t  *rdcnt,   /* Number of children of block lk received.          */
+ double *rdbuf,
+ double **xptr,   /* X[k] for each local block column, NULL if unknown. */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ dLocalLU_t *Llu,
+ SuperLUStat_t *stat
+)
+{
+    double alpha = 1.0, beta = 0.0;
+    double *tempv, *lusup, *Linv;
+    int_t  *ilsum = Llu->ilsum;
+    int    iam = grid->iam, myrow = MYROW( iam, grid ), knsupc, nsupr;
+    int_t  c, i, ii, il, k, lkc, size;
+    BcTree btree;
+    RdTree rtree;
+
+    k = myrow + lk * grid->nprow; /* Global block number. */
+    knsupc = SuperSize( k );
+    il = LSUM_BLK( lk );
+    size = knsupc * nrhs;
+
+    tempv = &rdbuf[rdoff[lk]];
+    for (c = 0; c < rdcnt[lk]; ++c, tempv += size)
+	for (i = 0; i < size; ++i) lsum[il + i] += tempv[i];
+
+    if ( iam != PNUM( myrow, PCOL( k, grid ), grid ) ) {
+	rtree = uplo == 'L' ? Llu->LRtree_ptr[lk] : Llu->URtree_ptr[lk];
+	RdTree_forwardMessageSimple(rtree, &lsum[il - LSUM_H],
+			RdTree_GetMsgSize(rtree,'d')*nrhs+LSUM_H, 'd');
+	return;
+    }
+
+    /* Diagonal process: X[k] += lsum[k], then solve with the diagonal block. */
+    ii = X_BLK( lk );
+    for (i = 0; i < size; ++i) x[ii + i] += lsum[il + i];
+
+    lkc = LBj( k, grid ); /* Local block number, column-wise. */
+    lusup = Llu->Lnzval_bc_ptr[lkc];
+    nsupr = Llu->Lrowind_bc_ptr[lkc][1];
+    if ( Llu->inv == 1 && Llu->Linv_bc_ptr[lkc] ) {
+	Linv = uplo == 'L' ? Llu->Linv_bc_ptr[lkc] : Llu->Uinv_bc_ptr[lkc];
+	if ( !dgemm_small(knsupc, nrhs, knsupc,
+	                  Linv, knsupc, &x[ii], knsupc, rtemp, knsupc) ) {
+#ifdef _CRAY
+	SGEMM( ftcs2, ftcs2, &knsupc, &nrhs, &knsupc,
+	       &alpha, Linv, &knsupc, &x[ii], &knsupc, &beta, rtemp, &knsupc );
+#elif defined (USE_VENDOR_BLAS)
+	dgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+	       &alpha, Linv, &knsupc, &x[ii], &knsupc, &beta, rtemp, &knsupc, 1, 1 );
+#else
+	dgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+	       &alpha, Linv, &knsupc, &x[ii], &knsupc, &beta, rtemp, &knsupc );
+#endif
+	}
+	for (i = 0; i < size; ++i) x[ii + i] = rtemp[i];
+    } else if ( uplo == 'L' ) {
+	if ( !dtrsm_small('L', knsupc, nrhs,
+	                  lusup, nsupr, &x[ii], knsupc) ) {
+#ifdef _CRAY
+	STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &knsupc, &nrhs, &alpha,
+	      lusup, &nsupr, &x[ii], &knsupc);
+#elif defined (USE_VENDOR_BLAS)
+	dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &x[ii], &knsupc, 1, 1, 1, 1);
+#else
+	dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &x[ii], &knsupc);
+#endif
+	}
+    } else {
+	if ( !dtrsm_small('U', knsupc, nrhs,
+	                  lusup, nsupr, &x[ii], knsupc) ) {
+#ifdef _CRAY
+	STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &knsupc, &nrhs, &alpha,
+	      lusup, &nsupr, &x[ii], &knsupc);
+#elif defined (USE_VENDOR_BLAS)
+	dtrsm_("L", "U", "N", "N", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &x[ii], &knsupc, 1, 1, 1, 1);
+#else
+	dtrsm_("L", "U", "N", "N", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &x[ii], &knsupc);
+#endif
+	}
+    }
+    stat->ops[SOLVE] += knsupc * (knsupc + (uplo == 'L' ? -1 : 1)) * nrhs;
+    SOLVE_STAMP(Llu->sol_tdone, k);
+
+    btree = uplo == 'L' ? Llu->LBtree_ptr[lkc] : Llu->UBtree_ptr[lkc];
+    if ( btree != NULL )
+	BcTree_forwardMessageSimple(btree, &x[ii - XK_H],
+			BcTree_GetMsgSize(btree,'d')*nrhs+XK_H, 'd');
+    xptr[lkc] = &x[ii];
+} /* dlsum_fixed_done */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Buffer the contribution tempv[] to lsum[lk] received from process
+ *   src, keeping the contributions of block lk sorted by process.
+ * </pre>
+ */
+static void dlsum_fixed_recv
+/************************************************************************/
+(
+ int_t lk, int src, double *tempv, int_t size,
+ int_t *rdoff, int_t *rdslot, int_t *rdcnt, int *rdsrc, double *rdbuf
+)
+{
+    int_t pos = rdcnt[lk]++;
+    int   *s = &rdsrc[rdslot[lk]];
+    double *buf = &rdbuf[rdoff[lk]];
+
+    for ( ; pos > 0 && s[pos-1] > src; --pos) {
+	s[pos] = s[pos-1];
+	memcpy(&buf[pos * size], &buf[(pos-1) * size], size * sizeof(double));
+    }
+    s[pos] = src;
+    memcpy(&buf[pos * size], tempv, size * sizeof(double));
+}
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Set up the buffers of the fixed-order solves for the contributions
+ *   of the children in the reduction trees: recv[lk] blocks of size
+ *   SuperSize(k)*nrhs for each local block row lk.
+ * </pre>
+ */
+static void dlsum_fixed_init
+/************************************************************************/
+(
+ int_t nsupers, int nrhs, int_t *recv, int_t *xsup, gridinfo_t *grid,
+ int_t **rdoff, int_t **rdslot, int_t **rdcnt, int **rdsrc, double **rdbuf
+)
+{
+    int_t lk, k, nlb = CEILING( nsupers, grid->nprow );
+    int   myrow = MYROW( grid->iam, grid );
+
+    if ( !(*rdoff = intMalloc_dist(nlb + 1)) )
+	ABORT("Malloc fails for rdoff[].");
+    if ( !(*rdslot = intMalloc_dist(nlb + 1)) )
+	ABORT("Malloc fails for rdslot[].");
+    if ( !(*rdcnt = intCalloc_dist(nlb)) )
+	ABORT("Calloc fails for rdcnt[].");
+    (*rdoff)[0] = (*rdslot)[0] = 0;
+    for (lk = 0; lk < nlb; ++lk) {
+	k = myrow + lk * grid->nprow;
+	(*rdslot)[lk+1] = (*rdslot)[lk] + recv[lk];
+	(*rdoff)[lk+1] = (*rdoff)[lk] + (k < nsupers ? recv[lk] * SuperSize( k ) * nrhs : 0);
+    }
+    if ( !(*rdsrc = SUPERLU_MALLOC(((*rdslot)[nlb] + 1) * sizeof(int))) )
+	ABORT("Malloc fails for rdsrc[].");
+    if ( !(*rdbuf = doubleMalloc_dist((*rdoff)[nlb] + 1)) )
+	ABORT("Malloc fails for rdbuf[].");
+}
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform the L-solve of pdgstrs with a fixed summation order, so that
+ *   the solution is bitwise identical from run to run on the same grid
+ *   (options->Reproducible = YES).
+ *
+ *   Each process applies the X[k] it needs, lsum[i] -= L_i,k * X[k], in
+ *   increasing order of k, whatever the order in which they arrive; an
+ *   X[k] is buffered until all the smaller ones are applied. In the
+ *   reduction of lsum[i] across a process row, the contributions of the
+ *   children are buffered and added after the local modifications, in
+ *   increasing order of the sending process. The same reduction and
+ *   broadcast trees as in the asynchronous solve are used.
+ *
+ *   On entry, fmod[] includes the children counts frecv[], and the
+ *   broadcast and reduction trees are initialized. If active[] is not
+ *   NULL, the X[k] of the supernodes not marked are 0 and not applied.
+ * </pre>
+ */
+void dlsum_fmod_fixed
+/************************************************************************/
+(
+ double *lsum,    /* Sum of local modifications.                        */
+ double *x,       /* X array (local)                                    */
+ double *rtemp,   /* Workspace for the GEMM results.                    */
+ int    nrhs,     /* Number of right-hand sides.                        */
+ int_t  nsupers,  /* Number of supernodes.                              */
+ int_t  *fmod,    /* Modification count for L-solve.                    */
+ int_t  *frecv,   /* Number of children in the reduction tree.          */
+ int_t  nfrecvx,  /* Number of X[k] to be received.                     */
+ int_t  nfrecvmod,/* Number of lsum[] blocks to be received.            */
+ pxgstrs_ring_t *ring, /* Receives posted for the messages.             */
+ int    *active,  /* The supernodes solved, NULL for all of them.       */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ dLocalLU_t *Llu,
+ SuperLUStat_t *stat
+)
+{
+    double alpha = 1.0, beta = 0.0;
+    double *lusup, *recvbuf0, *rdbuf, **xptr;
+    int_t  *ilsum = Llu->ilsum, *lsub, *lloc, *rdoff, *rdslot, *rdcnt;
+    int    *rdsrc;
+    int    iam = grid->iam, myrow, mycol, knsupc, iknsupc, nsupr, m, nbrow1;
+    int_t  i, j, k, ik, il, irow, lb, lk, lkc, nlb, nlbc, nb, nbrow;
+    int_t  idx_n, idx_i, idx_v, lptr, rel, nrecv = 0;
+    int_t  aln_i = ceil(CACHELINE/(double)sizeof(int_t));
+    BcTree *LBtree_ptr = Llu->LBtree_ptr;
+    MPI_Status status;
+
+    myrow = MYROW( iam, grid );
+    mycol = MYCOL( iam, grid );
+    nlb = CEILING( nsupers, grid->nprow );
+    nlbc = CEILING( nsupers, grid->npcol );
+
+    if ( !(xptr = (double **) SUPERLU_MALLOC(nlbc * sizeof(double*))) )
+	ABORT("Malloc fails for xptr[].");
+    for (lkc = 0; lkc < nlbc; ++lkc) xptr[lkc] = NULL;
+    dlsum_fixed_init(nsupers, nrhs, frecv, xsup, grid,
+		     &rdoff, &rdslot, &rdcnt, &rdsrc, &rdbuf);
+
+    /* Solve the leaves. */
+    for (lk = 0; lk < nlb; ++lk) {
+	k = myrow + lk * grid->nprow;
+	if ( k < nsupers && mycol == PCOL( k, grid ) && fmod[lk*aln_i] == 0 )
+	    dlsum_fixed_done('L', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+			     rdbuf, xptr, xsup, grid, Llu, stat);
+    }
+
+    lkc = 0;
+    for (;;) {
+	/* Apply the known X[k] in increasing order of k. */
+	for ( ; lkc < nlbc; ++lkc) {
+	    k = mycol + lkc * grid->npcol; /* Global block number. */
+	    if ( k >= nsupers ) { lkc = nlbc; break; }
+	    if ( active && !active[k] ) continue; /* X[k] = 0 */
+	    if ( !(lsub = Llu->Lrowind_bc_ptr[lkc]) ) continue;
+	    nb = myrow == PROW( k, grid ) ? lsub[0] - 1 : lsub[0];
+	    if ( nb == 0 ) continue;
+	    if ( xptr[lkc] == NULL ) break; /* Wait for X[k]. */
+
+	    knsupc = SuperSize( k );
+	    lusup = Llu->Lnzval_bc_ptr[lkc];
+	    lloc = Llu->Lindval_loc_bc_ptr[lkc];
+	    nsupr = lsub[1];
+	    if ( myrow == PROW( k, grid ) ) {
+		idx_n = 1;
+		idx_i = nb + 2;
+		idx_v = 2 * nb + 3;
+		m = nsupr - knsupc;
+	    } else {
+		idx_n = 0;
+		idx_i = nb;
+		idx_v = 2 * nb;
+		m = nsupr;
+	    }
+	    if ( !dgemm_small(m, nrhs, knsupc,
+	                      &lusup[lloc[idx_v]], nsupr, xptr[lkc], knsupc, rtemp, m) ) {
+#ifdef _CRAY
+	    SGEMM( ftcs2, ftcs2, &m, &nrhs, &knsupc,
+		   &alpha, &lusup[lloc[idx_v]], &nsupr, xptr[lkc],
+		   &knsupc, &beta, rtemp, &m );
+#elif defined (USE_VENDOR_BLAS)
+	    dgemm_( "N", "N", &m, &nrhs, &knsupc,
+		    &alpha, &lusup[lloc[idx_v]], &nsupr, xptr[lkc],
+		    &knsupc, &beta, rtemp, &m, 1, 1 );
+#else
+	    dgemm_( "N", "N", &m, &nrhs, &knsupc,
+		    &alpha, &lusup[lloc[idx_v]], &nsupr, xptr[lkc],
+		    &knsupc, &beta, rtemp, &m );
+#endif
+	    }
+	    stat->ops[SOLVE] += 2 * m * nrhs * knsupc;
+
+	    nbrow = 0;
+	    for (lb = 0; lb < nb; ++lb) {
+		lptr = lloc[lb + idx_i];
+		nbrow1 = lsub[lptr + 1];
+		ik = lsub[lptr]; /* Global block number, row-wise. */
+		rel = xsup[ik];  /* Global row index of block ik. */
+		iknsupc = SuperSize( ik );
+		il = LSUM_BLK( LBi( ik, grid ) );
+		RHS_ITERATE(j)
+		    for (i = 0; i < nbrow1; ++i) {
+			irow = lsub[lptr + 2 + i] - rel; /* Relative row. */
+			lsum[il + irow + j*iknsupc] -= rtemp[nbrow + i + j*m];
+		    }
+		nbrow += nbrow1;
+	    }
+
+	    for (lb = 0; lb < nb; ++lb) {
+		lk = lloc[lb + idx_n];
+		if ( --fmod[lk*aln_i] == 0 ) /* Local accumulation done. */
+		    dlsum_fixed_done('L', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+				     rdbuf, xptr, xsup, grid, Llu, stat);
+	    }
+	}
+
+	if ( nrecv == nfrecvx + nfrecvmod ) break;
+
+	/* Receive a message. */
+	recvbuf0 = (double *) pxgstrs_ring_recv( ring, &status, stat );
+	++nrecv;
+	k = *recvbuf0;
+
+	if ( status.MPI_TAG == BC_L ) {
+	    pxgstrs_ring_keep(ring); /* X[k] is kept until it is applied. */
+	    lk = LBj( k, grid );
+	    if ( BcTree_getDestCount(LBtree_ptr[lk],'d') > 0 )
+		BcTree_forwardMessageSimple(LBtree_ptr[lk], recvbuf0,
+			BcTree_GetMsgSize(LBtree_ptr[lk],'d')*nrhs+XK_H, 'd');
+	    xptr[lk] = &recvbuf0[XK_H];
+	} else { /* RD_L */
+	    lk = LBi( k, grid );
+	    dlsum_fixed_recv(lk, status.MPI_SOURCE, &recvbuf0[LSUM_H],
+			     SuperSize( k ) * nrhs, rdoff, rdslot, rdcnt, rdsrc, rdbuf);
+	    if ( --fmod[lk*aln_i] == 0 )
+		dlsum_fixed_done('L', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+				 rdbuf, xptr, xsup, grid, Llu, stat);
+	}
+    }
+
+    SUPERLU_FREE(xptr);
+    SUPERLU_FREE(rdoff);
+    SUPERLU_FREE(rdslot);
+    SUPERLU_FREE(rdcnt);
+    SUPERLU_FREE(rdsrc);
+    SUPERLU_FREE(rdbuf);
+} /* dlsum_fmod_fixed */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform the U-solve of pdgstrs with a fixed summation order, as
+ *   dlsum_fmod_fixed() does for the L-solve: the X[k] are applied,
+ *   lsum[i] -= U_i,k * X[k], in decreasing order of k, and the children
+ *   in the reduction trees are added in increasing order of the sending
+ *   process.
+ *
+ *   On entry, bmod[] includes the children counts brecv[], and the
+ *   broadcast and reduction trees are initialized. If needed[] is not
+ *   NULL, the X[k] of the supernodes not marked are not computed.
+ * </pre>
+ */
+void dlsum_bmod_fixed
+/************************************************************************/
+(
+ double *lsum,    /* Sum of local modifications.                        */
+ double *x,       /* X array (local)                                    */
+ double *rtemp,   /* Workspace of size sizertemp.                       */
+ int    nrhs,     /* Number of right-hand sides.                        */
+ int_t  nsupers,  /* Number of supernodes.                              */
+ int_t  *bmod,    /* Modification count for U-solve.                    */
+ int_t  *brecv,   /* Number of children in the reduction tree.          */
+ int_t  nbrecvx,  /* Number of X[k] to be received.                     */
+ int_t  nbrecvmod,/* Number of lsum[] blocks to be received.            */
+ pxgstrs_ring_t *ring, /* Receives posted for the messages.             */
+ int_t  sizertemp,
+ int    *needed,  /* The supernodes solved, NULL for all of them.       */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ dLocalLU_t *Llu,
+ SuperLUStat_t *stat
+)
+{
+    double *recvbuf0, *rdbuf, **xptr;
+    int_t  *ilsum = Llu->ilsum, *usub, *rdoff, *rdslot, *rdcnt;
+    int_t  *Urbs = Llu->Urbs;
+    Ucb_indptr_t **Ucb_indptr = Llu->Ucb_indptr;
+    int_t  **Ucb_valptr = Llu->Ucb_valptr;
+    int    *rdsrc;
+    int    iam = grid->iam, myrow, mycol, knsupc;
+    int_t  gik, i, ik, il, k, lk, lkc, nlb, nlbc, ub, nrecv = 0;
+    int_t  aln_i = ceil(CACHELINE/(double)sizeof(int_t));
+    BcTree *UBtree_ptr = Llu->UBtree_ptr;
+    MPI_Status status;
+
+    myrow = MYROW( iam, grid );
+    mycol = MYCOL( iam, grid );
+    nlb = CEILING( nsupers, grid->nprow );
+    nlbc = CEILING( nsupers, grid->npcol );
+
+    if ( !(xptr = (double **) SUPERLU_MALLOC(nlbc * sizeof(double*))) )
+	ABORT("Malloc fails for xptr[].");
+    for (lkc = 0; lkc < nlbc; ++lkc) xptr[lkc] = NULL;
+    dlsum_fixed_init(nsupers, nrhs, brecv, xsup, grid,
+		     &rdoff, &rdslot, &rdcnt, &rdsrc, &rdbuf);
+
+    /* Solve the roots. */
+    for (lk = 0; lk < nlb; ++lk) {
+	k = myrow + lk * grid->nprow;
+	if ( k < nsupers && mycol == PCOL( k, grid ) && bmod[lk*aln_i] == 0 )
+	    dlsum_fixed_done('U', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+			     rdbuf, xptr, xsup, grid, Llu, stat);
+    }
+
+    lkc = nlbc - 1;
+    for (;;) {
+	/* Apply the known X[k] in decreasing order of k. */
+	for ( ; lkc >= 0; --lkc) {
+	    k = mycol + lkc * grid->npcol; /* Global block number. */
+	    if ( k >= nsupers || Urbs[lkc] == 0 ) continue;
+	    if ( needed && !needed[k] ) continue; /* X[k] is not computed. */
+	    if ( xptr[lkc] == NULL ) break; /* Wait for X[k]. */
+
+	    knsupc = SuperSize( k );
+	    for (ub = 0; ub < Urbs[lkc]; ++ub) {
+		ik = Ucb_indptr[lkc][ub].lbnum; /* Local block number, row-wise. */
+		usub = Llu->Ufstnz_br_ptr[ik];
+		i = Ucb_indptr[lkc][ub].indpos + UB_DESCRIPTOR;
+		il = LSUM_BLK( ik );
+		gik = ik * grid->nprow + myrow; /* Global block number, row-wise. */
+		dlsum_bmod_blk(&lsum[il], xptr[lkc], nrhs, knsupc, &usub[i],
+			       &Llu->Unzval_br_ptr[ik][Ucb_valptr[lkc][ub]],
+			       FstBlockC( gik ), FstBlockC( gik+1 ),
+			       rtemp, sizertemp, &stat->ops[SOLVE], 0);
+	    }
+
+	    for (ub = 0; ub < Urbs[lkc]; ++ub) {
+		ik = Ucb_indptr[lkc][ub].lbnum;
+		if ( --bmod[ik*aln_i] == 0 ) /* Local accumulation done. */
+		    dlsum_fixed_done('U', ik, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+				     rdbuf, xptr, xsup, grid, Llu, stat);
+	    }
+	}
+
+	if ( nrecv == nbrecvx + nbrecvmod ) break;
+
+	/* Receive a message. */
+	recvbuf0 = (double *) pxgstrs_ring_recv( ring, &status, stat );
+	++nrecv;
+	k = *recvbuf0;
+
+	if ( status.MPI_TAG == BC_U ) {
+	    pxgstrs_ring_keep(ring); /* X[k] is kept until it is applied. */
+	    lk = LBj( k, grid );
+	    if ( BcTree_getDestCount(UBtree_ptr[lk],'d') > 0 )
+		BcTree_forwardMessageSimple(UBtree_ptr[lk], recvbuf0,
+			BcTree_GetMsgSize(UBtree_ptr[lk],'d')*nrhs+XK_H, 'd');
+	    xptr[lk] = &recvbuf0[XK_H];
+	} else { /* RD_U */
+	    lk = LBi( k, grid );
+	    dlsum_fixed_recv(lk, status.MPI_SOURCE, &recvbuf0[LSUM_H],
+			     SuperSize( k ) * nrhs, rdoff, rdslot, rdcnt, rdsrc, rdbuf);
+	    if ( --bmod[lk*aln_i] == 0 )
+		dlsum_fixed_done('U', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+				 rdbuf, xptr, xsup, grid, Llu, stat);
+	}
+    }
+
+    SUPERLU_FREE(xptr);
+    SUPERLU_FREE(rdoff);
+    SUPERLU_FREE(rdslot);
+    SUPERLU_FREE(rdcnt);
+    SUPERLU_FREE(rdsrc);
+    SUPERLU_FREE(rdbuf);
+} /* dlsum_bmod_fixed */
@@ -0,0 +1,177 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Streaming of right-hand side batches through pdgstrs
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "superlu_ddefs.h"
+
+/*! \brief Initialize a queue of up to maxrhs right-hand sides.
+ *
+ * <pre>
+ * m_loc and fst_row describe the local rows of B, as in pdgstrs().
+ * </pre>
+ */
+void
+dRHSqueueInit(int_t m_loc, int_t fst_row, int maxrhs, dRHSqueue_t *queue)
+{
+    queue->m_loc = m_loc;
+    queue->fst_row = fst_row;
+    queue->maxrhs = SUPERLU_MAX(maxrhs, 1);
+    queue->nrhs = 0;
+    queue->nbatch = 0;
+    if ( !(queue->Q = doubleMalloc_dist(SUPERLU_MAX(m_loc, 1) * queue->maxrhs)) )
+	ABORT("Malloc fails for queue->Q[].");
+    if ( !(queue->Bptr = (double **) SUPERLU_MALLOC(queue->maxrhs * sizeof(double *))) )
+	ABORT("Malloc fails for queue->Bptr[].");
+    if ( !(queue->ldb = intMalloc_dist(queue->maxrhs)) )
+	ABORT("Malloc fails for queue->ldb[].");
+    if ( !(queue->ncol = (int *) SUPERLU_MALLOC(queue->maxrhs * sizeof(int))) )
+	ABORT("Malloc fails for queue->ncol[].");
+}
+
+void
+dRHSqueueFree(dRHSqueue_t *queue)
+{
+    SUPERLU_FREE(queue->Q);
+    SUPERLU_FREE(queue->Bptr);
+    SUPERLU_FREE(queue->ldb);
+    SUPERLU_FREE(queue->ncol);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSTRS_FLUSH solves the right-hand sides held in the queue with one
+ * call to pdgstrs(), and copies the solution of each batch back to the
+ * array it was pushed from. Does nothing if the queue is empty.
+ *
+ * See pdgstrs_push() for the arguments.
+ * </pre>
+ */
+void
+pdgstrs_flush(int_t n, dLUstruct_t *LUstruct,
+	      dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	      dSOLVEstruct_t *SOLVEstruct, SuperLUStat_t *stat, int *info,
+	      dRHSqueue_t *queue)
+{
+    int_t m_loc = queue->m_loc, i;
+    double *q, *b;
+    int ib, j;
+
+    *info = 0;
+    if ( queue->nrhs == 0 ) return;
+
+    pdgstrs(n, LUstruct, ScalePermstruct, grid, queue->Q, m_loc,
+	    queue->fst_row, m_loc, queue->nrhs, SOLVEstruct, stat, info);
+
+    q = queue->Q;
+    for (ib = 0; ib < queue->nbatch; ++ib) {
+	b = queue->Bptr[ib];
+	for (j = 0; j < queue->ncol[ib]; ++j) {
+	    for (i = 0; i < m_loc; ++i) b[i] = q[i];
+	    b += queue->ldb[ib];
+	    q += m_loc;
+	}
+    }
+    queue->nrhs = 0;
+    queue->nbatch = 0;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSTRS_PUSH adds the nrhs right-hand sides in B to the queue. When
+ * the queue is full they are solved, together with the batches queued
+ * before, by pdgstrs_flush(); the remaining ones are solved by an
+ * explicit call to pdgstrs_flush().
+ *
+ * Successive batches thus go through the L- and U-solves at the same
+ * time: the setup of pdgstrs(), the redistribution of B and the
+ * latency of every message are paid once per queue instead of once per
+ * batch, and each message carries the values of all the queued columns.
+ *
+ * This is collective: all processes of grid must push the same sequence
+ * of batch sizes. B must not be used until the queue is flushed, when
+ * it is overwritten by the solution X, as in pdgstrs().
+ *
+ * Arguments
+ * =========
+ *
+ * n, LUstruct, ScalePermstruct, grid, SOLVEstruct, stat, info:
+ *         see pdgstrs().
+ *
+ * B       (input/output) double*
+ *         The local rows of the nrhs right-hand sides, with leading
+ *         dimension ldb; the solution on return from the flush.
+ *
+ * queue   (input/output) dRHSqueue_t*
+ *         The queue, initialized by dRHSqueueInit().
+ *
+ * Return value
+ * ============
+ *
+ * 1 if the queue is empty on return, so that all the batches pushed
+ * so far (including B) hold their solutions, and 0 otherwise.
+ * </pre>
+ */
+int
+pdgstrs_push(int_t n, dLUstruct_t *LUstruct,
+	     dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	     double *B, int_t ldb, int nrhs, dSOLVEstruct_t *SOLVEstruct,
+	     SuperLUStat_t *stat, int *info, dRHSqueue_t *queue)
+{
+    int_t m_loc = queue->m_loc, i;
+    double *q;
+    int j;
+
+    *info = 0;
+    if ( nrhs <= 0 ) return 0;
+
+    if ( queue->nrhs + nrhs > queue->maxrhs ) {
+	pdgstrs_flush(n, LUstruct, ScalePermstruct, grid, SOLVEstruct,
+		      stat, info, queue);
+    }
+    if ( nrhs > queue->maxrhs ) { /* Too wide for the queue. */
+	pdgstrs(n, LUstruct, ScalePermstruct, grid, B, m_loc,
+		queue->fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+	return 1;
+    }
+
+    q = &queue->Q[queue->nrhs * m_loc];
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) q[i + j*m_loc] = B[i + j*ldb];
+    queue->Bptr[queue->nbatch] = B;
+    queue->ldb[queue->nbatch] = ldb;
+    queue->ncol[queue->nbatch] = nrhs;
+    ++queue->nbatch;
+    queue->nrhs += nrhs;
+
+    if ( queue->nrhs == queue->maxrhs ) {
+	pdgstrs_flush(n, LUstruct, ScalePermstruct, grid, SOLVEstruct,
+		      stat, info, queue);
+	return 1;
+    }
+    return 0;
+}
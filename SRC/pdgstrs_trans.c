@@ -0,0 +1,832 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Solves the transposed system A^T*X = B with the LU factors of A
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * With A1 = L*U, the system A1^T * W = B1 is solved by the forward solve
+ * U^T * Z = B1 followed by the backward solve L^T * W = Z. In both, the
+ * roles of the processes are the transpose of those in PDGSTRS:
+ *
+ *   - X[i] is sent from the diagonal process of block i along its process
+ *     row, to the processes owning a block U(i,k) (resp. L(i,k));
+ *   - each of them sums lsum[k] -= U(i,k)^T * X[i] (resp. L(i,k)^T * X[i])
+ *     for its blocks of block column k, and sends lsum[k] up its process
+ *     column to the diagonal process of block k once all the local blocks
+ *     of column k are done;
+ *   - the diagonal process of block k solves with U(k,k)^T (resp. L(k,k)^T)
+ *     once it has all the lsum[k].
+ *
+ * The blocks are used where PDGSTRF left them, so no second factorization
+ * or copy of the factors is needed.
+ *
+ * When U was dropped for a symmetric A1 = L*D*L^T (see dDrop_U()), U^T
+ * is D*L^T, so both A1*X = B and A1^T*X = B are solved by the forward
+ * solve L * Z = B, with the roles of the processes of PDGSTRS, then
+ * Z = D^{-1} * Z and the backward solve L^T * W = Z above; PDGSTRS calls
+ * PDGSTRS_SYM for them.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_ddefs.h"
+
+/* Message tags of the transposed solves. */
+#define XT_TAG      11
+#define LSUMT_TAG   12
+#define XN_TAG      13
+#define LSUMN_TAG   14
+
+/* A block L(i,k) in the list of the local blocks of block row i. */
+typedef struct {
+    int_t ljb;   /* Local block column of L(i,k).             */
+    int_t lptr;  /* Its descriptor in Lrowind_bc_ptr[ljb][].  */
+    int_t luptr; /* Its first row in Lnzval_bc_ptr[ljb][].    */
+} dLrb_t;
+
+/* The state of one triangular solve. With uplo = 'N', lcnt, rcnt and
+   lsum_off are by local block row, need by local block column, and
+   allneed gathers need[] over my process column. */
+typedef struct {
+    char   uplo;      /* 'U': solve with U^T, 'L': with L^T, 'N': with L. */
+    int    nrhs;
+    double *x;        /* X[k] on the diagonal processes.         */
+    double *lsum;     /* lsum[k] on the other processes.         */
+    double *tempv;    /* Gathered rows of X[i] for L(i,k)^T*X[i]. */
+    int_t  *lsum_off; /* Position of lsum[k] in lsum[], local block col. */
+    int_t  *lcnt;     /* Local blocks still to be done, local block col. */
+    int_t  *rcnt;     /* lsum[k] still to be received, local block col.  */
+    int_t  *need;     /* Whether I need X[i], local block row.           */
+    int_t  *allneed;  /* need[] of all the processes of my process row.  */
+    int_t  *ready;    /* Diagonal blocks ready to be solved.             */
+    int_t  nready;
+    int_t  nneed;     /* Length of need[]. */
+    MPI_Request *send_req;
+    int    nsend;
+    int_t  *Lrb_ptr;  /* Blocks L(i,k) of local block row lbi are */
+    dLrb_t *Lrb;      /* Lrb[Lrb_ptr[lbi] : Lrb_ptr[lbi+1]-1].    */
+    int_t  *xsup;
+    gridinfo_t *grid;
+    dLocalLU_t *Llu;
+    SuperLUStat_t *stat;
+} dtrans_solve_t;
+
+/* Where the products with the blocks of block column k are summed. */
+static double *trans_dest(dtrans_solve_t *S, int_t k)
+{
+    gridinfo_t *grid = S->grid;
+    int_t *ilsum = S->Llu->ilsum, ljb = LBj( k, grid );
+    int   nrhs = S->nrhs;
+
+    if ( PROW( k, grid ) == MYROW( grid->iam, grid ) )
+	return &S->x[X_BLK( LBi( k, grid ) )];
+    return &S->lsum[S->lsum_off[ljb] + LSUM_H];
+}
+
+/* One local block of block column k is done. */
+static void trans_block_done(dtrans_solve_t *S, int_t k)
+{
+    gridinfo_t *grid = S->grid;
+    int_t *xsup = S->xsup, ljb = LBj( k, grid );
+    int   p;
+
+    if ( --S->lcnt[ljb] ) return;
+    if ( PROW( k, grid ) == MYROW( grid->iam, grid ) ) {
+	if ( !S->rcnt[ljb] ) S->ready[S->nready++] = k;
+    } else {
+	p = PNUM( PROW( k, grid ), MYCOL( grid->iam, grid ), grid );
+	MPI_Isend( &S->lsum[S->lsum_off[ljb]], SuperSize( k ) * S->nrhs + LSUM_H,
+		   MPI_DOUBLE, p, LSUMT_TAG, grid->comm,
+		   &S->send_req[S->nsend++] );
+    }
+}
+
+/* Perform the local block modifications with X[i]. */
+static void trans_modify(dtrans_solve_t *S, int_t i, double *xi)
+{
+    gridinfo_t *grid = S->grid;
+    dLocalLU_t *Llu = S->Llu;
+    int_t *xsup = S->xsup, *usub, *lsub;
+    int_t lbi = LBi( i, grid ), ikfrow = FstBlockC( i ), iklrow;
+    int_t b, e, gb, ljb, pos, uptr0, uptr, irow, fnz, jj, r;
+    int   iknsupc = SuperSize( i ), knsupc, nbrow, nsupr, j, nrhs = S->nrhs;
+    double *uval, *lusup, *dest, *d, *y, sum;
+    double alpha = -1.0, beta = 1.0;
+
+    if ( S->uplo == 'U' ) {
+	if ( !(usub = Llu->Ufstnz_br_ptr[lbi]) ) return;
+	uval = Llu->Unzval_br_ptr[lbi];
+	iklrow = FstBlockC( i+1 );
+	pos = BR_HEADER;
+	uptr0 = 0;
+	for (b = 0; b < usub[0]; ++b) { /* For all blocks U(i,k). */
+	    gb = usub[pos];
+	    knsupc = SuperSize( gb );
+	    dest = trans_dest(S, gb);
+	    RHS_ITERATE(j) {
+		d = &dest[j*knsupc];
+		y = &xi[j*iknsupc];
+		uptr = uptr0;
+		for (jj = 0; jj < knsupc; ++jj) {
+		    fnz = usub[pos + UB_DESCRIPTOR + jj];
+		    for (sum = 0.0, irow = fnz; irow < iklrow; ++irow)
+			sum += uval[uptr++] * y[irow - ikfrow];
+		    d[jj] -= sum;
+		}
+	    }
+	    S->stat->ops[SOLVE] += 2 * usub[pos+1] * nrhs;
+	    uptr0 += usub[pos+1];
+	    pos += UB_DESCRIPTOR + knsupc;
+	    trans_block_done(S, gb);
+	}
+    } else {
+	for (e = S->Lrb_ptr[lbi]; e < S->Lrb_ptr[lbi+1]; ++e) {
+	    ljb = S->Lrb[e].ljb;
+	    gb = ljb * grid->npcol + MYCOL( grid->iam, grid );
+	    knsupc = SuperSize( gb );
+	    lsub = Llu->Lrowind_bc_ptr[ljb];
+	    lusup = Llu->Lnzval_bc_ptr[ljb];
+	    nsupr = lsub[1];
+	    pos = S->Lrb[e].lptr;
+	    nbrow = lsub[pos+1];
+	    for (r = 0; r < nbrow; ++r) {
+		irow = lsub[pos + LB_DESCRIPTOR + r] - ikfrow;
+		RHS_ITERATE(j) S->tempv[r + j*nbrow] = xi[irow + j*iknsupc];
+	    }
+	    dest = trans_dest(S, gb);
+#if defined (USE_VENDOR_BLAS)
+	    dgemm_("T", "N", &knsupc, &nrhs, &nbrow, &alpha,
+		   &lusup[S->Lrb[e].luptr], &nsupr, S->tempv, &nbrow,
+		   &beta, dest, &knsupc, 1, 1);
+#else
+	    dgemm_("T", "N", &knsupc, &nrhs, &nbrow, &alpha,
+		   &lusup[S->Lrb[e].luptr], &nsupr, S->tempv, &nbrow,
+		   &beta, dest, &knsupc);
+#endif
+	    S->stat->ops[SOLVE] += 2 * nbrow * knsupc * nrhs;
+	    trans_block_done(S, gb);
+	}
+    }
+}
+
+/* Solve with the diagonal block k, send X[k] along my process row and
+   perform the local block modifications with it. */
+static void trans_diag_solve(dtrans_solve_t *S, int_t k)
+{
+    gridinfo_t *grid = S->grid;
+    dLocalLU_t *Llu = S->Llu;
+    int_t *xsup = S->xsup, *ilsum = Llu->ilsum, *lsub;
+    int   knsupc = SuperSize( k ), nsupr, nrhs = S->nrhs;
+    int_t lk = LBi( k, grid ), ii = X_BLK( lk );
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    int   pc;
+    double *lusup, alpha = 1.0;
+
+    lsub = Llu->Lrowind_bc_ptr[LBj( k, grid )];
+    lusup = Llu->Lnzval_bc_ptr[LBj( k, grid )];
+    nsupr = lsub[1];
+    if ( S->uplo == 'U' ) {
+#if defined (USE_VENDOR_BLAS)
+	dtrsm_("L", "U", "T", "N", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &S->x[ii], &knsupc, 1, 1, 1, 1);
+#else
+	dtrsm_("L", "U", "T", "N", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &S->x[ii], &knsupc);
+#endif
+	S->stat->ops[SOLVE] += knsupc * (knsupc + 1) * nrhs;
+    } else {
+#if defined (USE_VENDOR_BLAS)
+	dtrsm_("L", "L", "T", "U", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &S->x[ii], &knsupc, 1, 1, 1, 1);
+#else
+	dtrsm_("L", "L", "T", "U", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &S->x[ii], &knsupc);
+#endif
+	S->stat->ops[SOLVE] += knsupc * (knsupc - 1) * nrhs;
+    }
+
+    S->x[ii - XK_H] = k;
+    for (pc = 0; pc < grid->npcol; ++pc)
+	if ( pc != mycol && S->allneed[pc * S->nneed + lk] )
+	    MPI_Isend( &S->x[ii - XK_H], knsupc * nrhs + XK_H, MPI_DOUBLE,
+		       PNUM( myrow, pc, grid ), XT_TAG, grid->comm,
+		       &S->send_req[S->nsend++] );
+    if ( S->need[lk] ) trans_modify(S, k, &S->x[ii]);
+}
+
+/* Solve U^T * Z = B (uplo = 'U') or L^T * W = B (uplo = 'L') with B and
+   the solution in x[] on the diagonal processes. */
+static void
+dtrans_solve(char uplo, int nrhs, double *x, int_t *Lrb_ptr, dLrb_t *Lrb,
+	     int_t nsupers, int_t maxsupc, Glu_persist_t *Glu_persist,
+	     dLocalLU_t *Llu, gridinfo_t *grid, SuperLUStat_t *stat)
+{
+    dtrans_solve_t S;
+    int_t *xsup = Glu_persist->xsup, *lsub, *usub;
+    int_t nlb, nub, lbi, ljb, gb, nrecv, pos, k;
+    int   Pr = grid->nprow, Pc = grid->npcol;
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    double *recvbuf;
+    MPI_Status status;
+
+    /* Messages of the previous solve must not be taken for ours. */
+    MPI_Barrier( grid->comm );
+
+    nlb = CEILING( nsupers, Pr );
+    nub = CEILING( nsupers, Pc );
+    S.uplo = uplo;
+    S.nrhs = nrhs;
+    S.x = x;
+    S.nneed = nlb;
+    S.Lrb_ptr = Lrb_ptr;
+    S.Lrb = Lrb;
+    S.xsup = xsup;
+    S.grid = grid;
+    S.Llu = Llu;
+    S.stat = stat;
+    S.nready = 0;
+    S.nsend = 0;
+    if ( !(S.lcnt = intMalloc_dist(4*nub + 2*nlb + nlb*Pc)) )
+	ABORT("Malloc fails for lcnt[].");
+    S.rcnt = S.lcnt + nub;
+    S.lsum_off = S.rcnt + nub;
+    S.ready = S.lsum_off + nub;
+    S.need = S.ready + nub;
+    S.allneed = S.need + nlb;
+
+    /* Count the local blocks of each block column. */
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	S.lcnt[ljb] = 0;
+	if ( gb >= nsupers ) continue;
+	if ( uplo == 'U' ) S.lcnt[ljb] = Llu->Urbs[ljb];
+	else if ( (lsub = Llu->Lrowind_bc_ptr[ljb]) )
+	    S.lcnt[ljb] = lsub[0] - (PROW( gb, grid ) == myrow);
+    }
+    for (lbi = 0; lbi < nlb; ++lbi) {
+	gb = lbi * Pr + myrow;
+	S.need[lbi] = 0;
+	if ( gb >= nsupers ) continue;
+	if ( uplo == 'U' )
+	    S.need[lbi] = (usub = Llu->Ufstnz_br_ptr[lbi]) && usub[0] > 0;
+	else S.need[lbi] = Lrb_ptr[lbi+1] > Lrb_ptr[lbi];
+    }
+
+    /* Who needs X[i] in my process row, and how many lsum[k] the diagonal
+       process of block k receives from its process column. */
+    MPI_Allgather(S.need, nlb, mpi_int_t, S.allneed, nlb, mpi_int_t,
+		  grid->rscp.comm);
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	S.rcnt[ljb] = gb < nsupers && PROW( gb, grid ) != myrow
+	              && S.lcnt[ljb] > 0;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, S.rcnt, nub, mpi_int_t, MPI_SUM,
+		  grid->cscp.comm);
+
+    /* Set up lsum[], count the messages to be received and find the
+       leaves. */
+    nrecv = 0;
+    for (lbi = 0; lbi < nlb; ++lbi) {
+	gb = lbi * Pr + myrow;
+	if ( S.need[lbi] && PCOL( gb, grid ) != mycol ) ++nrecv;
+    }
+    for (ljb = 0, pos = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	if ( gb >= nsupers ) continue;
+	if ( PROW( gb, grid ) == myrow ) {
+	    nrecv += S.rcnt[ljb];
+	    if ( !S.lcnt[ljb] && !S.rcnt[ljb] ) S.ready[S.nready++] = gb;
+	} else if ( S.lcnt[ljb] ) {
+	    S.lsum_off[ljb] = pos;
+	    pos += SuperSize( gb ) * nrhs + LSUM_H;
+	}
+    }
+    if ( !(S.lsum = doubleCalloc_dist(pos + 1)) )
+	ABORT("Calloc fails for lsum[].");
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	if ( gb < nsupers && PROW( gb, grid ) != myrow && S.lcnt[ljb] )
+	    S.lsum[S.lsum_off[ljb]] = gb;
+    }
+    if ( !(recvbuf = doubleMalloc_dist(2 * (maxsupc * nrhs + XK_H))) )
+	ABORT("Malloc fails for recvbuf[].");
+    S.tempv = recvbuf + maxsupc * nrhs + XK_H;
+    if ( !(S.send_req = (MPI_Request *)
+	   SUPERLU_MALLOC((nub + nlb * Pc + 1) * sizeof(MPI_Request))) )
+	ABORT("Malloc fails for send_req[].");
+
+    /* Self-scheduling loop. */
+    while ( S.nready || nrecv ) {
+	if ( S.nready ) {
+	    trans_diag_solve(&S, S.ready[--S.nready]);
+	    continue;
+	}
+	MPI_Recv( recvbuf, maxsupc * nrhs + XK_H, MPI_DOUBLE, MPI_ANY_SOURCE,
+		  MPI_ANY_TAG, grid->comm, &status );
+	--nrecv;
+	k = recvbuf[0];
+	if ( status.MPI_TAG == XT_TAG ) {
+	    trans_modify(&S, k, &recvbuf[XK_H]);
+	} else { /* lsum[k] for the diagonal process. */
+	    double *dest = trans_dest(&S, k);
+	    int_t i, nk = SuperSize( k ) * nrhs;
+
+	    for (i = 0; i < nk; ++i) dest[i] += recvbuf[LSUM_H + i];
+	    ljb = LBj( k, grid );
+	    if ( !--S.rcnt[ljb] && !S.lcnt[ljb] ) S.ready[S.nready++] = k;
+	}
+    }
+    MPI_Waitall(S.nsend, S.send_req, MPI_STATUSES_IGNORE);
+    Llu->SolveMsgSent += S.nsend;
+
+    SUPERLU_FREE(S.send_req);
+    SUPERLU_FREE(recvbuf);
+    SUPERLU_FREE(S.lsum);
+    SUPERLU_FREE(S.lcnt);
+}
+
+
+/* Where the products with the blocks of block row k are summed. */
+static double *lower_dest(dtrans_solve_t *S, int_t k)
+{
+    gridinfo_t *grid = S->grid;
+    int_t *ilsum = S->Llu->ilsum, lbi = LBi( k, grid );
+    int   nrhs = S->nrhs;
+
+    if ( PCOL( k, grid ) == MYCOL( grid->iam, grid ) )
+	return &S->x[X_BLK( lbi )];
+    return &S->lsum[S->lsum_off[lbi] + LSUM_H];
+}
+
+/* One local block of block row k is done. */
+static void lower_block_done(dtrans_solve_t *S, int_t k)
+{
+    gridinfo_t *grid = S->grid;
+    int_t *xsup = S->xsup, lbi = LBi( k, grid );
+    int   p;
+
+    if ( --S->lcnt[lbi] ) return;
+    if ( PCOL( k, grid ) == MYCOL( grid->iam, grid ) ) {
+	if ( !S->rcnt[lbi] ) S->ready[S->nready++] = k;
+    } else {
+	p = PNUM( MYROW( grid->iam, grid ), PCOL( k, grid ), grid );
+	MPI_Isend( &S->lsum[S->lsum_off[lbi]], SuperSize( k ) * S->nrhs + LSUM_H,
+		   MPI_DOUBLE, p, LSUMN_TAG, grid->comm,
+		   &S->send_req[S->nsend++] );
+    }
+}
+
+/* Perform the local block modifications lsum[k] -= L(k,i) * X[i]. */
+static void lower_modify(dtrans_solve_t *S, int_t i, double *xi)
+{
+    gridinfo_t *grid = S->grid;
+    dLocalLU_t *Llu = S->Llu;
+    int_t *xsup = S->xsup, *lsub = Llu->Lrowind_bc_ptr[LBj( i, grid )];
+    int_t lb, lptr, luptr, gb, irow;
+    int   iknsupc = SuperSize( i ), knsupc, nbrow, nsupr = lsub[1], r, j;
+    int   nrhs = S->nrhs;
+    double *lusup = Llu->Lnzval_bc_ptr[LBj( i, grid )], *dest;
+    double alpha = 1.0, beta = 0.0;
+
+    for (lb = 0, lptr = BC_HEADER, luptr = 0; lb < lsub[0]; ++lb) {
+	gb = lsub[lptr];
+	nbrow = lsub[lptr+1];
+	if ( gb != i ) {
+#if defined (USE_VENDOR_BLAS)
+	    dgemm_("N", "N", &nbrow, &nrhs, &iknsupc, &alpha,
+		   &lusup[luptr], &nsupr, xi, &iknsupc,
+		   &beta, S->tempv, &nbrow, 1, 1);
+#else
+	    dgemm_("N", "N", &nbrow, &nrhs, &iknsupc, &alpha,
+		   &lusup[luptr], &nsupr, xi, &iknsupc,
+		   &beta, S->tempv, &nbrow);
+#endif
+	    knsupc = SuperSize( gb );
+	    dest = lower_dest(S, gb);
+	    for (r = 0; r < nbrow; ++r) {
+		irow = lsub[lptr + LB_DESCRIPTOR + r] - FstBlockC( gb );
+		RHS_ITERATE(j) dest[irow + j*knsupc] -= S->tempv[r + j*nbrow];
+	    }
+	    S->stat->ops[SOLVE] += 2 * nbrow * iknsupc * nrhs;
+	    lower_block_done(S, gb);
+	}
+	luptr += nbrow;
+	lptr += LB_DESCRIPTOR + nbrow;
+    }
+}
+
+/* Solve with L(k,k), send X[k] down my process column and perform the
+   local block modifications with it. */
+static void lower_diag_solve(dtrans_solve_t *S, int_t k)
+{
+    gridinfo_t *grid = S->grid;
+    dLocalLU_t *Llu = S->Llu;
+    int_t *xsup = S->xsup, *ilsum = Llu->ilsum, *lsub;
+    int   knsupc = SuperSize( k ), nsupr, nrhs = S->nrhs;
+    int_t ljb = LBj( k, grid ), ii = X_BLK( LBi( k, grid ) );
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    int   pr;
+    double *lusup, alpha = 1.0;
+
+    lsub = Llu->Lrowind_bc_ptr[ljb];
+    lusup = Llu->Lnzval_bc_ptr[ljb];
+    nsupr = lsub[1];
+#if defined (USE_VENDOR_BLAS)
+    dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+	   lusup, &nsupr, &S->x[ii], &knsupc, 1, 1, 1, 1);
+#else
+    dtrsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+	   lusup, &nsupr, &S->x[ii], &knsupc);
+#endif
+    S->stat->ops[SOLVE] += knsupc * (knsupc - 1) * nrhs;
+
+    S->x[ii - XK_H] = k;
+    for (pr = 0; pr < grid->nprow; ++pr)
+	if ( pr != myrow && S->allneed[pr * S->nneed + ljb] )
+	    MPI_Isend( &S->x[ii - XK_H], knsupc * nrhs + XK_H, MPI_DOUBLE,
+		       PNUM( pr, mycol, grid ), XN_TAG, grid->comm,
+		       &S->send_req[S->nsend++] );
+    if ( S->need[ljb] ) lower_modify(S, k, &S->x[ii]);
+}
+
+/* Solve L * Z = B with B and the solution in x[] on the diagonal
+   processes, U being dropped. */
+static void
+dlower_solve(int nrhs, double *x, int_t *Lrb_ptr, int_t nsupers,
+	     int_t maxsupc, Glu_persist_t *Glu_persist, dLocalLU_t *Llu,
+	     gridinfo_t *grid, SuperLUStat_t *stat)
+{
+    dtrans_solve_t S;
+    int_t *xsup = Glu_persist->xsup, *lsub;
+    int_t nlb, nub, lbi, ljb, gb, nrecv, pos, k;
+    int   Pr = grid->nprow, Pc = grid->npcol;
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    double *recvbuf;
+    MPI_Status status;
+
+    /* Messages of the previous solve must not be taken for ours. */
+    MPI_Barrier( grid->comm );
+
+    nlb = CEILING( nsupers, Pr );
+    nub = CEILING( nsupers, Pc );
+    S.uplo = 'N';
+    S.nrhs = nrhs;
+    S.x = x;
+    S.nneed = nub;
+    S.xsup = xsup;
+    S.grid = grid;
+    S.Llu = Llu;
+    S.stat = stat;
+    S.nready = 0;
+    S.nsend = 0;
+    if ( !(S.lcnt = intMalloc_dist(4*nlb + 2*nub + nub*Pr)) )
+	ABORT("Malloc fails for lcnt[].");
+    S.rcnt = S.lcnt + nlb;
+    S.lsum_off = S.rcnt + nlb;
+    S.ready = S.lsum_off + nlb;
+    S.need = S.ready + nlb;
+    S.allneed = S.need + nub;
+
+    /* The local blocks of each block row are those listed in Lrb[]. */
+    for (lbi = 0; lbi < nlb; ++lbi) S.lcnt[lbi] = Lrb_ptr[lbi+1] - Lrb_ptr[lbi];
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	S.need[ljb] = gb < nsupers && (lsub = Llu->Lrowind_bc_ptr[ljb])
+	              && lsub[0] > (PROW( gb, grid ) == myrow);
+    }
+
+    /* Who needs X[i] in my process column, and how many lsum[k] the
+       diagonal process of block k receives from its process row. */
+    MPI_Allgather(S.need, nub, mpi_int_t, S.allneed, nub, mpi_int_t,
+		  grid->cscp.comm);
+    for (lbi = 0; lbi < nlb; ++lbi) {
+	gb = lbi * Pr + myrow;
+	S.rcnt[lbi] = gb < nsupers && PCOL( gb, grid ) != mycol
+	              && S.lcnt[lbi] > 0;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, S.rcnt, nlb, mpi_int_t, MPI_SUM,
+		  grid->rscp.comm);
+
+    /* Set up lsum[], count the messages to be received and find the
+       leaves. */
+    nrecv = 0;
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	if ( S.need[ljb] && PROW( gb, grid ) != myrow ) ++nrecv;
+    }
+    for (lbi = 0, pos = 0; lbi < nlb; ++lbi) {
+	gb = lbi * Pr + myrow;
+	if ( gb >= nsupers ) continue;
+	if ( PCOL( gb, grid ) == mycol ) {
+	    nrecv += S.rcnt[lbi];
+	    if ( !S.lcnt[lbi] && !S.rcnt[lbi] ) S.ready[S.nready++] = gb;
+	} else if ( S.lcnt[lbi] ) {
+	    S.lsum_off[lbi] = pos;
+	    pos += SuperSize( gb ) * nrhs + LSUM_H;
+	}
+    }
+    if ( !(S.lsum = doubleCalloc_dist(pos + 1)) )
+	ABORT("Calloc fails for lsum[].");
+    for (lbi = 0; lbi < nlb; ++lbi) {
+	gb = lbi * Pr + myrow;
+	if ( gb < nsupers && PCOL( gb, grid ) != mycol && S.lcnt[lbi] )
+	    S.lsum[S.lsum_off[lbi]] = gb;
+    }
+    if ( !(recvbuf = doubleMalloc_dist(2 * (maxsupc * nrhs + XK_H))) )
+	ABORT("Malloc fails for recvbuf[].");
+    S.tempv = recvbuf + maxsupc * nrhs + XK_H;
+    if ( !(S.send_req = (MPI_Request *)
+	   SUPERLU_MALLOC((nlb + nub * Pr + 1) * sizeof(MPI_Request))) )
+	ABORT("Malloc fails for send_req[].");
+
+    /* Self-scheduling loop. */
+    while ( S.nready || nrecv ) {
+	if ( S.nready ) {
+	    lower_diag_solve(&S, S.ready[--S.nready]);
+	    continue;
+	}
+	MPI_Recv( recvbuf, maxsupc * nrhs + XK_H, MPI_DOUBLE, MPI_ANY_SOURCE,
+		  MPI_ANY_TAG, grid->comm, &status );
+	--nrecv;
+	k = recvbuf[0];
+	if ( status.MPI_TAG == XN_TAG ) {
+	    lower_modify(&S, k, &recvbuf[XK_H]);
+	} else { /* lsum[k] for the diagonal process. */
+	    double *dest = lower_dest(&S, k);
+	    int_t i, nk = SuperSize( k ) * nrhs;
+
+	    for (i = 0; i < nk; ++i) dest[i] += recvbuf[LSUM_H + i];
+	    lbi = LBi( k, grid );
+	    if ( !--S.rcnt[lbi] && !S.lcnt[lbi] ) S.ready[S.nready++] = k;
+	}
+    }
+    MPI_Waitall(S.nsend, S.send_req, MPI_STATUSES_IGNORE);
+    Llu->SolveMsgSent += S.nsend;
+
+    SUPERLU_FREE(S.send_req);
+    SUPERLU_FREE(recvbuf);
+    SUPERLU_FREE(S.lsum);
+    SUPERLU_FREE(S.lcnt);
+}
+
+/* Solve A1^T * W = B on x[] of the diagonal processes; A1^T = A1 if U
+   was dropped. */
+static void
+dgstrs_x(int nrhs, double *x, int_t nsupers, Glu_persist_t *Glu_persist,
+	 dLocalLU_t *Llu, gridinfo_t *grid, SuperLUStat_t *stat)
+{
+    int_t *xsup = Glu_persist->xsup, *ilsum = Llu->ilsum, *lsub;
+    int_t *Lrb_ptr;
+    dLrb_t *Lrb;
+    int_t i, k, gb, ljb, lb, lptr, luptr, nlb, nub, maxsupc, ii;
+    int   Pr = grid->nprow, Pc = grid->npcol, j, r, knsupc, nsupr;
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    double *lusup;
+
+    nlb = CEILING( nsupers, Pr );
+    nub = CEILING( nsupers, Pc );
+    for (k = 0, maxsupc = 1; k < nsupers; ++k)
+	maxsupc = SUPERLU_MAX( maxsupc, SuperSize( k ) );
+
+    /* List the blocks L(i,k) of each local block row i. */
+    if ( !(Lrb_ptr = intCalloc_dist(nlb + 1)) )
+	ABORT("Calloc fails for Lrb_ptr[].");
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	if ( gb >= nsupers || !(lsub = Llu->Lrowind_bc_ptr[ljb]) ) continue;
+	for (lb = 0, lptr = BC_HEADER; lb < lsub[0]; ++lb) {
+	    if ( lsub[lptr] != gb ) ++Lrb_ptr[LBi( lsub[lptr], grid ) + 1];
+	    lptr += LB_DESCRIPTOR + lsub[lptr+1];
+	}
+    }
+    for (i = 0; i < nlb; ++i) Lrb_ptr[i+1] += Lrb_ptr[i];
+    if ( !(Lrb = (dLrb_t *) SUPERLU_MALLOC((Lrb_ptr[nlb] + 1) * sizeof(dLrb_t))) )
+	ABORT("Malloc fails for Lrb[].");
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * Pc + mycol;
+	if ( gb >= nsupers || !(lsub = Llu->Lrowind_bc_ptr[ljb]) ) continue;
+	for (lb = 0, lptr = BC_HEADER, luptr = 0; lb < lsub[0]; ++lb) {
+	    if ( lsub[lptr] != gb ) {
+		i = Lrb_ptr[LBi( lsub[lptr], grid )]++;
+		Lrb[i].ljb = ljb;
+		Lrb[i].lptr = lptr;
+		Lrb[i].luptr = luptr;
+	    }
+	    luptr += lsub[lptr+1];
+	    lptr += LB_DESCRIPTOR + lsub[lptr+1];
+	}
+    }
+    for (i = nlb; i > 0; --i) Lrb_ptr[i] = Lrb_ptr[i-1];
+    Lrb_ptr[0] = 0;
+
+    if ( Llu->Udropped ) {
+	/* L * Z = B, Z = D^{-1} * Z, then L^T * W = Z. */
+	dlower_solve(nrhs, x, Lrb_ptr, nsupers, maxsupc, Glu_persist, Llu,
+		     grid, stat);
+	for (lb = 0; lb < nlb; ++lb) {
+	    k = lb * Pr + myrow;
+	    if ( k >= nsupers || PCOL( k, grid ) != mycol ) continue;
+	    knsupc = SuperSize( k );
+	    lsub = Llu->Lrowind_bc_ptr[LBj( k, grid )];
+	    lusup = Llu->Lnzval_bc_ptr[LBj( k, grid )];
+	    nsupr = lsub[1];
+	    ii = X_BLK( lb );
+	    for (j = 0; j < nrhs; ++j)
+		for (r = 0; r < knsupc; ++r)
+		    x[ii + j*knsupc + r] /= lusup[r + r*nsupr];
+	    stat->ops[SOLVE] += knsupc * nrhs;
+	}
+    } else {
+	/* U^T * Z = B, then L^T * W = Z. */
+	dtrans_solve('U', nrhs, x, Lrb_ptr, Lrb, nsupers, maxsupc,
+		     Glu_persist, Llu, grid, stat);
+    }
+    dtrans_solve('L', nrhs, x, Lrb_ptr, Lrb, nsupers, maxsupc, Glu_persist,
+		 Llu, grid, stat);
+
+    SUPERLU_FREE(Lrb);
+    SUPERLU_FREE(Lrb_ptr);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSTRS_TRANS solves a system of distributed linear equations
+ * A^T*X = B with a general N-by-N matrix A using the LU factorization
+ * computed by PDGSTRF for A.
+ * If the equilibration, and row and column permutations were performed,
+ * the LU factorization was performed for A1 where
+ *     A1 = Pc*Pr*diag(R)*A*diag(C)*Pc^T = L*U,
+ * and the system solved is
+ *     A2^T * Y = B1,   with A2 = diag(R)*A*diag(C)*Pc^T,
+ * where B was overwritten by B1 = Pc*diag(C)*B; the solution of the
+ * original system is X = diag(R)*Y. A2 is the matrix A as left by
+ * PDGSSVX, so that Y can be refined with it directly.
+ *
+ * Arguments
+ * =========
+ *
+ * The arguments are the same as those of PDGSTRS, except:
+ *
+ * B      (input/output) double*
+ *        On entry, the distributed right-hand side matrix B1.
+ *        On exit, the distributed solution matrix Y if info = 0.
+ *
+ *        The communication structures in SOLVEstruct are those set up by
+ *        pdgstrs_init() for PDGSTRS.
+ * </pre>
+ */
+void
+pdgstrs_trans(int_t n, dLUstruct_t *LUstruct,
+	      dScalePermstruct_t *ScalePermstruct,
+	      gridinfo_t *grid, double *B,
+	      int_t m_loc, int_t fst_row, int_t ldb, int nrhs,
+	      dSOLVEstruct_t *SOLVEstruct,
+	      SuperLUStat_t *stat, int *info)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t *perm_r, *perm_c, *inv_q;
+    int_t i, nsupers, nlb;
+    double *x, t;
+
+    /* Test input parameters. */
+    *info = 0;
+    if ( n < 0 ) *info = -1;
+    else if ( nrhs < 0 ) *info = -9;
+    if ( *info ) {
+	pxerr_dist("PDGSTRS_TRANS", grid, -*info);
+	return;
+    }
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter pdgstrs_trans()");
+#endif
+
+    MPI_Barrier( grid->comm );
+    t = SuperLU_timer_();
+    stat->ops[SOLVE] = 0.0;
+    Llu->SolveMsgSent = 0;
+
+    nsupers = Glu_persist->supno[n-1] + 1;
+    nlb = CEILING( nsupers, grid->nprow );
+    perm_r = ScalePermstruct->perm_r;
+    perm_c = ScalePermstruct->perm_c;
+
+    /* pdReDistribute_B_to_X() puts row i of B in row perm_c[perm_r[i]] of
+       X, while B1 is already in the order of the factors; undo it first. */
+    if ( !(inv_q = intMalloc_dist(n)) )
+	ABORT("Malloc fails for inv_q[].");
+    for (i = 0; i < n; ++i) inv_q[perm_c[perm_r[i]]] = i;
+    pdPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc, inv_q,
+			   B, ldb, B, ldb, nrhs, grid);
+
+    if ( !(x = doubleCalloc_dist(Llu->ldalsum * nrhs + nlb * XK_H)) )
+	ABORT("Calloc fails for x[].");
+    /* The pattern may have been set up for another nrhs. */
+    pxgstrs_comm_nrhs(SOLVEstruct->gstrs_comm, nrhs, grid);
+    pdReDistribute_B_to_X(B, m_loc, nrhs, ldb, fst_row, Llu->ilsum, x,
+			  ScalePermstruct, Glu_persist, grid, SOLVEstruct);
+
+    dgstrs_x(nrhs, x, nsupers, Glu_persist, Llu, grid, stat);
+
+    /* Y = (Pc*Pr)^T * W. */
+    pdReDistribute_X_to_B(n, B, m_loc, ldb, fst_row, nrhs, x, Llu->ilsum,
+			  ScalePermstruct, Glu_persist, grid, SOLVEstruct);
+    pdPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc, inv_q,
+			   B, ldb, B, ldb, nrhs, grid);
+
+    SUPERLU_FREE(x);
+    SUPERLU_FREE(inv_q);
+
+    stat->utime[SOLVE] = SuperLU_timer_() - t;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Exit pdgstrs_trans()");
+#endif
+} /* PDGSTRS_TRANS */
+
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDGSTRS_SYM solves A*X = B as PDGSTRS does, with the factors of a
+ * symmetric A1 = L*D*L^T whose U was dropped (see dDrop_U()): by the
+ * forward solve L * Z = B1, Z = D^{-1} * Z and the backward solve
+ * L^T * W = Z, where D = diag(U) is kept in the diagonal blocks. It is
+ * called by PDGSTRS for such factors, and takes the same arguments.
+ * </pre>
+ */
+void
+pdgstrs_sym(int_t n, dLUstruct_t *LUstruct,
+	    dScalePermstruct_t *ScalePermstruct,
+	    gridinfo_t *grid, double *B,
+	    int_t m_loc, int_t fst_row, int_t ldb, int nrhs,
+	    dSOLVEstruct_t *SOLVEstruct,
+	    SuperLUStat_t *stat, int *info)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t nsupers, nlb;
+    double *x, t;
+
+    /* Test input parameters. */
+    *info = 0;
+    if ( n < 0 ) *info = -1;
+    else if ( nrhs < 0 ) *info = -9;
+    else if ( !Llu->Udropped ) *info = -2;
+    if ( *info ) {
+	pxerr_dist("PDGSTRS_SYM", grid, -*info);
+	return;
+    }
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter pdgstrs_sym()");
+#endif
+
+    MPI_Barrier( grid->comm );
+    t = SuperLU_timer_();
+    stat->ops[SOLVE] = 0.0;
+    Llu->SolveMsgSent = 0;
+
+    nsupers = Glu_persist->supno[n-1] + 1;
+    nlb = CEILING( nsupers, grid->nprow );
+    if ( !(x = doubleCalloc_dist(Llu->ldalsum * nrhs + nlb * XK_H)) )
+	ABORT("Calloc fails for x[].");
+    /* The pattern may have been set up for another nrhs. */
+    pxgstrs_comm_nrhs(SOLVEstruct->gstrs_comm, nrhs, grid);
+    pdReDistribute_B_to_X(B, m_loc, nrhs, ldb, fst_row, Llu->ilsum, x,
+			  ScalePermstruct, Glu_persist, grid, SOLVEstruct);
+
+    dgstrs_x(nrhs, x, nsupers, Glu_persist, Llu, grid, stat);
+
+    pdReDistribute_X_to_B(n, B, m_loc, ldb, fst_row, nrhs, x, Llu->ilsum,
+			  ScalePermstruct, Glu_persist, grid, SOLVEstruct);
+    SUPERLU_FREE(x);
+
+    stat->utime[SOLVE] = SuperLU_timer_() - t;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Exit pdgstrs_sym()");
+#endif
+} /* PDGSTRS_SYM */
@@ -66,25 +66,33 @@ double pdlangs(char *norm, SuperMatrix *A, gridinfo_t *grid)
 {
     /* Local variables */
     NRformat_loc *Astore;
-    int_t    m_loc;
+    int_t    m_loc, ncol;
+    int_t    *rowptr, *colind;
     double   *Aval;
-    int_t    i, j, jcol;
+    int_t    i, j;
     double   value=0., sum;
     double   *rwork;
     double   tempvalue;
-    double   *temprwork;
 
     Astore = (NRformat_loc *) A->Store;
-    m_loc = Astore->m_loc;
+    m_loc  = Astore->m_loc;
+    ncol   = A->ncol;
+    rowptr = Astore->rowptr;
+    colind = Astore->colind;
     Aval   = (double *) Astore->nzval;
 
+    /* Each norm is one pass over the local rows, threaded over the rows
+       where the result is a reduction, followed by one Allreduce. */
     if ( SUPERLU_MIN(A->nrow, A->ncol) == 0) {
 	value = 0.;
     } else if ( strncmp(norm, "M", 1)==0 ) {
 	/* Find max(abs(A(i,j))). */
 	value = 0.;
+#ifdef _OPENMP
+#pragma omp parallel for private(j) reduction(max:value) schedule(static)
+#endif
 	for (i = 0; i < m_loc; ++i) {
-	    for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j)
+	    for (j = rowptr[i]; j < rowptr[i+1]; ++j)
 		value = SUPERLU_MAX( value, fabs(Aval[j]) );
 	}
 
@@ -92,41 +100,30 @@ double pdlangs(char *norm, SuperMatrix *A, gridinfo_t *grid)
 	value = tempvalue;
 
     } else if ( strncmp(norm, "O", 1)==0 || *(unsigned char *)norm == '1') {
-	/* Find norm1(A). */
-	value = 0.;
-#if 0
-	for (j = 0; j < A->ncol; ++j) {
-	    sum = 0.;
-	    for (i = Astore->colptr[j]; i < Astore->colptr[j+1]; i++)
-		sum += fabs(Aval[i]);
-	    value = SUPERLU_MAX(value,sum);
-	}
-#else /* Sherry ==> */
-	if ( !(rwork = doubleCalloc_dist(A->ncol)) )
+	/* Find norm1(A): the column sums of the local rows, summed over
+	   the processes in place. */
+	if ( !(rwork = doubleCalloc_dist(ncol)) )
 	    ABORT("doubleCalloc_dist fails for rwork.");
 	for (i = 0; i < m_loc; ++i) {
-	    for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j) {
-	        jcol = Astore->colind[j];
-		rwork[jcol] += fabs(Aval[j]);
-	    }
+	    for (j = rowptr[i]; j < rowptr[i+1]; ++j)
+		rwork[colind[j]] += fabs(Aval[j]);
 	}
 
-	if ( !(temprwork = doubleCalloc_dist(A->ncol)) )
-	    ABORT("doubleCalloc_dist fails for temprwork.");
-	MPI_Allreduce(rwork, temprwork, A->ncol, MPI_DOUBLE, MPI_SUM, grid->comm);
+	MPI_Allreduce(MPI_IN_PLACE, rwork, ncol, MPI_DOUBLE, MPI_SUM, grid->comm);
 	value = 0.;
-	for (j = 0; j < A->ncol; ++j) {
-	    value = SUPERLU_MAX(value, temprwork[j]);
+	for (j = 0; j < ncol; ++j) {
+	    value = SUPERLU_MAX(value, rwork[j]);
 	}
-	SUPERLU_FREE (temprwork);
 	SUPERLU_FREE (rwork);
-#endif
     } else if ( strncmp(norm, "I", 1)==0 ) {
 	/* Find normI(A). */
 	value = 0.;
-	sum = 0.;
+#ifdef _OPENMP
+#pragma omp parallel for private(j, sum) reduction(max:value) schedule(static)
+#endif
 	for (i = 0; i < m_loc; ++i) {
-	    for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j)
+	    sum = 0.;
+	    for (j = rowptr[i]; j < rowptr[i+1]; ++j)
 	        sum += fabs(Aval[j]);
 	    value = SUPERLU_MAX(value, sum);
 	}
@@ -135,7 +132,16 @@ double pdlangs(char *norm, SuperMatrix *A, gridinfo_t *grid)
 
     } else if ( strncmp(norm, "F", 1)==0 || strncmp(norm, "E", 1)==0 ) {
 	/* Find normF(A). */
-	ABORT("Not implemented.");
+	sum = 0.;
+#ifdef _OPENMP
+#pragma omp parallel for private(j) reduction(+:sum) schedule(static)
+#endif
+	for (i = 0; i < m_loc; ++i) {
+	    for (j = rowptr[i]; j < rowptr[i+1]; ++j)
+		sum += Aval[j] * Aval[j];
+	}
+	MPI_Allreduce(&sum, &tempvalue, 1, MPI_DOUBLE, MPI_SUM, grid->comm);
+	value = sqrt(tempvalue);
     } else {
 	ABORT("Illegal norm specified.");
     }
@@ -113,34 +113,33 @@ pdlaqgs(SuperMatrix *A, double *r, double *c,
 	    *(unsigned char *)equed = 'N';
 	else {
 	    /* Column scaling */
-	    irow = Astore->fst_row;
+#pragma omp parallel for private(j, jcol)
 	    for (i = 0; i < m_loc; ++i) {
 	        for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j) {
 		    jcol = Astore->colind[j];
 		    Aval[j] *= c[jcol];
 	      }
-	      ++irow;
 	    }
 	    *(unsigned char *)equed = 'C';
 	}
     } else if (colcnd >= THRESH) {
 	/* Row scaling, no column scaling */
-	irow = Astore->fst_row;
+#pragma omp parallel for private(j, irow)
 	for (i = 0; i < m_loc; ++i) {
+	    irow = Astore->fst_row + i;
 	    for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j)
 	        Aval[j] *= r[irow];
-	    ++irow;
 	}
 	*(unsigned char *)equed = 'R';
     } else {
 	/* Both row and column scaling */
-	irow = Astore->fst_row;
+#pragma omp parallel for private(j, irow, jcol)
 	for (i = 0; i < m_loc; ++i) {
+	    irow = Astore->fst_row + i;
 	    for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j) {
 	        jcol = Astore->colind[j];
 	        Aval[j] = Aval[j] * r[irow] * c[jcol];
 	    }
-	    ++irow;
 	}
 	*(unsigned char *)equed = 'B';
     }
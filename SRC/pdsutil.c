@@ -0,0 +1,328 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Mixed precision support: single precision LU factors
+ *        used by the double precision driver
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * When options->SingleFactor = YES, pdgssvx() distributes and factors
+ * a single precision copy of the scaled and permuted matrix. The factors
+ * are kept in an sLUstruct_t attached to dLUstruct_t::sLUstruct, which
+ * shares the etree and the supernode partition (Glu_persist) with the
+ * double precision structure. The routines below are thin wrappers that
+ * convert between the two precisions around the single precision kernels,
+ * so that the residual and the update in iterative refinement (pdgsrfs)
+ * remain in double precision.
+ * </pre>
+ */
+
+#include "superlu_ddefs.h"
+#include "superlu_sdefs.h"
+
+/*! \brief Return the single precision factors, allocating them if needed.
+ */
+static sLUstruct_t *
+ds_LUstruct(dLUstruct_t *LUstruct)
+{
+    sLUstruct_t *sLUstruct = (sLUstruct_t *) LUstruct->sLUstruct;
+
+    if ( !sLUstruct ) {
+	if ( !(sLUstruct = (sLUstruct_t *) SUPERLU_MALLOC(sizeof(sLUstruct_t))) )
+	    ABORT("Malloc fails for sLUstruct.");
+	if ( !(sLUstruct->Llu = (sLocalLU_t *) SUPERLU_MALLOC(sizeof(sLocalLU_t))) )
+	    ABORT("Malloc fails for sLocalLU_t.");
+	sLUstruct->Llu->inv = 0;
+	sLUstruct->Llu->inv_pending = 0;
+	sLUstruct->Llu->inv_budget = 0.0;
+	sLUstruct->Llu->sol_tdone = NULL;
+	sLUstruct->Llu->lsum_shared = 0;
+	sLUstruct->Llu->fixed_order = 0;
+	sLUstruct->Llu->Amap = NULL;
+	sLUstruct->Llu->sn_cost = NULL;
+	sLUstruct->Llu->sn_dirty = NULL;
+	sLUstruct->Llu->Acolind = NULL;
+	sLUstruct->Llu->Lnzval_slab = sLUstruct->Llu->Unzval_slab = NULL;
+	sLUstruct->Llu->Lnzval_ooc.base = sLUstruct->Llu->Unzval_ooc.base = NULL;
+	sLUstruct->Llu->release = 0;
+	sLUstruct->Llu->Udropped = 0;
+	sLUstruct->Llu->compact = 0;
+	sLUstruct->Llu->solve_slab = NULL;
+	sLUstruct->Llu->droptol = 0.0;
+	sLUstruct->Llu->ToRecv = NULL;
+	superlu_treespec_init(&sLUstruct->Llu->LBtree_spec, 0);
+	superlu_treespec_init(&sLUstruct->Llu->LRtree_spec, 0);
+	superlu_treespec_init(&sLUstruct->Llu->UBtree_spec, 0);
+	superlu_treespec_init(&sLUstruct->Llu->URtree_spec, 0);
+	sLUstruct->dt = 's';
+	sLUstruct->dense = NULL;
+	sLUstruct->usymb = NULL;
+	sLUstruct->matvec = NULL;
+	LUstruct->sLUstruct = sLUstruct;
+    }
+
+    /* The symbolic data are owned by the double precision structure. */
+    sLUstruct->etree = LUstruct->etree;
+    sLUstruct->Glu_persist = LUstruct->Glu_persist;
+    sLUstruct->Llu->fixed_order = LUstruct->Llu->fixed_order;
+    sLUstruct->Llu->ooc = LUstruct->Llu->ooc;
+    return sLUstruct;
+}
+
+/*! \brief Set up a single precision view of the row and column permutations.
+ *
+ * Only perm_r[] and perm_c[] are used by the distribution and the
+ * triangular solve; the scaling has already been applied to A and B.
+ */
+static void
+ds_ScalePermstruct(dScalePermstruct_t *ScalePermstruct,
+		   sScalePermstruct_t *sScalePermstruct)
+{
+    sScalePermstruct->DiagScale = ScalePermstruct->DiagScale;
+    sScalePermstruct->R = NULL;
+    sScalePermstruct->C = NULL;
+    sScalePermstruct->perm_r = ScalePermstruct->perm_r;
+    sScalePermstruct->perm_c = ScalePermstruct->perm_c;
+}
+
+/*! \brief Make a single precision copy of the values of the distributed A.
+ *
+ * The row pointers and column indices are shared with A.
+ */
+static void
+ds_CompRowLoc_Matrix(SuperMatrix *A, SuperMatrix *sA)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t nnz_loc = Astore->nnz_loc, i;
+    double *a = (double *) Astore->nzval;
+    float *nzval;
+
+    if ( !(nzval = floatMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for nzval[].");
+    for (i = 0; i < nnz_loc; ++i) nzval[i] = (float) a[i];
+
+    sCreate_CompRowLoc_Matrix_dist(sA, A->nrow, A->ncol, nnz_loc,
+				   Astore->m_loc, Astore->fst_row, nzval,
+				   Astore->colind, Astore->rowptr,
+				   SLU_NR_loc, SLU_S, SLU_GE);
+}
+
+static void
+ds_Destroy_CompRowLoc_Matrix(SuperMatrix *sA)
+{
+    NRformat_loc *Astore = (NRformat_loc *) sA->Store;
+    SUPERLU_FREE(Astore->nzval);
+    SUPERLU_FREE(Astore);
+}
+
+/*! \brief Distribute a single precision copy of A into the L and U storage.
+ *
+ * Counterpart of pddistribute(); the factors go to LUstruct->sLUstruct.
+ */
+float
+pdsdistribute(fact_t fact, int_t n, SuperMatrix *A,
+	      dScalePermstruct_t *ScalePermstruct,
+	      Glu_freeable_t *Glu_freeable, dLUstruct_t *LUstruct,
+	      gridinfo_t *grid)
+{
+    sLUstruct_t *sLUstruct = ds_LUstruct(LUstruct);
+    sScalePermstruct_t sScalePermstruct;
+    SuperMatrix sA;
+    float mem_use;
+
+    ds_ScalePermstruct(ScalePermstruct, &sScalePermstruct);
+    ds_CompRowLoc_Matrix(A, &sA);
+    mem_use = psdistribute(fact, n, &sA, &sScalePermstruct, Glu_freeable,
+			   sLUstruct, grid);
+    ds_Destroy_CompRowLoc_Matrix(&sA);
+    return mem_use;
+}
+
+/*! \brief Counterpart of ddist_psymbtonum() for single precision factors.
+ */
+float
+dsdist_psymbtonum(fact_t fact, int_t n, SuperMatrix *A,
+		  dScalePermstruct_t *ScalePermstruct,
+		  Pslu_freeable_t *Pslu_freeable, dLUstruct_t *LUstruct,
+		  gridinfo_t *grid)
+{
+    sLUstruct_t *sLUstruct = ds_LUstruct(LUstruct);
+    sScalePermstruct_t sScalePermstruct;
+    SuperMatrix sA;
+    float mem_use;
+
+    ds_ScalePermstruct(ScalePermstruct, &sScalePermstruct);
+    ds_CompRowLoc_Matrix(A, &sA);
+    mem_use = sdist_psymbtonum(fact, n, &sA, &sScalePermstruct,
+			       Pslu_freeable, sLUstruct, grid);
+    ds_Destroy_CompRowLoc_Matrix(&sA);
+    return mem_use;
+}
+
+/*! \brief Factor the single precision copy of A, see psgstrf().
+ */
+int_t
+pdsgstrf(superlu_dist_options_t *options, int m, int n, double anorm,
+	 dLUstruct_t *LUstruct, gridinfo_t *grid, SuperLUStat_t *stat,
+	 int *info)
+{
+    return psgstrf(options, m, n, (float) anorm, ds_LUstruct(LUstruct),
+		   grid, stat, info);
+}
+
+/*! \brief Invert the diagonal blocks of the single precision factors.
+ */
+void
+pdsCompute_Diag_Inv(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid,
+		    SuperLUStat_t *stat, int *info)
+{
+    psCompute_Diag_Inv(n, ds_LUstruct(LUstruct), grid, stat, info);
+}
+
+/*! \brief Request the inverses of the single precision diagonal blocks
+ *         for the next solve.
+ */
+void
+pdsDefer_Diag_Inv(superlu_dist_options_t *options, dLUstruct_t *LUstruct)
+{
+    psDefer_Diag_Inv(options, ds_LUstruct(LUstruct));
+}
+
+/* pdsgstrs() for A*X = B (trans = NOTRANS) or A^T*X = B. */
+static void
+dsgstrs_op(trans_t trans, int_t n, dLUstruct_t *LUstruct,
+	   dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	   double *B, int_t m_loc, int_t fst_row, int_t ldb, int nrhs,
+	   dSOLVEstruct_t *SOLVEstruct, SuperLUStat_t *stat, int *info)
+{
+    sScalePermstruct_t sScalePermstruct;
+    sSOLVEstruct_t sSOLVEstruct;
+    float *sB;
+    int_t i, j;
+
+    ds_ScalePermstruct(ScalePermstruct, &sScalePermstruct);
+    sSOLVEstruct.row_to_proc = SOLVEstruct->row_to_proc;
+    sSOLVEstruct.inv_perm_c = SOLVEstruct->inv_perm_c;
+    sSOLVEstruct.num_diag_procs = SOLVEstruct->num_diag_procs;
+    sSOLVEstruct.diag_procs = SOLVEstruct->diag_procs;
+    sSOLVEstruct.diag_len = SOLVEstruct->diag_len;
+    sSOLVEstruct.gstrs_comm = SOLVEstruct->gstrs_comm;
+    sSOLVEstruct.gsmv_comm = NULL;
+    sSOLVEstruct.A_colind_gsmv = NULL;
+    sSOLVEstruct.gstrs_work = NULL;
+    sSOLVEstruct.sparse_rhs = SOLVEstruct->sparse_rhs;
+    sSOLVEstruct.nout_rows = SOLVEstruct->nout_rows;
+    sSOLVEstruct.out_rows = SOLVEstruct->out_rows;
+    sSOLVEstruct.x_layout = SOLVEstruct->x_layout;
+    sSOLVEstruct.root_size = SOLVEstruct->root_size;
+    sSOLVEstruct.crit_path = SOLVEstruct->crit_path;
+    sSOLVEstruct.priority = SOLVEstruct->priority;
+    sSOLVEstruct.rhs_tile = SOLVEstruct->rhs_tile;
+    sSOLVEstruct.refine_msg_prec = SOLVEstruct->refine_msg_prec;
+    sSOLVEstruct.msg_prec = SOLVEstruct->msg_prec;
+
+    if ( !(sB = floatMalloc_dist(SUPERLU_MAX(ldb * nrhs, 1))) )
+	ABORT("Malloc fails for sB[].");
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) sB[i + j*ldb] = (float) B[i + j*ldb];
+
+    if ( trans == NOTRANS )
+	psgstrs(n, ds_LUstruct(LUstruct), &sScalePermstruct, grid, sB,
+		m_loc, fst_row, ldb, nrhs, &sSOLVEstruct, stat, info);
+    else
+	psgstrs_trans(n, ds_LUstruct(LUstruct), &sScalePermstruct, grid, sB,
+		      m_loc, fst_row, ldb, nrhs, &sSOLVEstruct, stat, info);
+    sSolveWorkFree(&sSOLVEstruct);
+
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) B[i + j*ldb] = sB[i + j*ldb];
+    SUPERLU_FREE(sB);
+}
+
+/*! \brief Solve A*X = B in double precision using the single precision
+ *         factors.
+ *
+ * B is rounded to single precision, solved with psgstrs() and promoted
+ * back in place. The communication structures in SOLVEstruct do not depend
+ * on the precision and are shared with the single precision solve.
+ */
+void
+pdsgstrs(int_t n, dLUstruct_t *LUstruct,
+	 dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	 double *B, int_t m_loc, int_t fst_row, int_t ldb, int nrhs,
+	 dSOLVEstruct_t *SOLVEstruct, SuperLUStat_t *stat, int *info)
+{
+    dsgstrs_op(NOTRANS, n, LUstruct, ScalePermstruct, grid, B, m_loc,
+	       fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+}
+
+/*! \brief Solve A^T*X = B in double precision using the single precision
+ *         factors, as pdgstrs_trans() does with double precision factors.
+ */
+void
+pdsgstrs_trans(int_t n, dLUstruct_t *LUstruct,
+	       dScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	       double *B, int_t m_loc, int_t fst_row, int_t ldb, int nrhs,
+	       dSOLVEstruct_t *SOLVEstruct, SuperLUStat_t *stat, int *info)
+{
+    dsgstrs_op(TRANS, n, LUstruct, ScalePermstruct, grid, B, m_loc,
+	       fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+}
+
+/*! \brief Gather the diagonal of U from the single precision factors.
+ */
+void
+pdsGetDiagU(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid, double *diagU)
+{
+    float *sdiagU;
+    int_t i;
+
+    if ( !(sdiagU = floatMalloc_dist(SUPERLU_MAX(n, 1))) )
+	ABORT("Malloc fails for sdiagU[].");
+    psGetDiagU(n, ds_LUstruct(LUstruct), grid, sdiagU);
+    for (i = 0; i < n; ++i) diagU[i] = sdiagU[i];
+    SUPERLU_FREE(sdiagU);
+}
+
+/*! \brief Query the memory used by the single precision factors.
+ */
+int_t
+dsQuerySpace_dist(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid,
+		  SuperLUStat_t *stat, superlu_dist_mem_usage_t *mem_usage)
+{
+    return sQuerySpace_dist(n, ds_LUstruct(LUstruct), grid, stat, mem_usage);
+}
+
+/*! \brief Set the single precision factor L to zero, see dZeroLblocks().
+ */
+void
+dsZeroLblocks(int iam, int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
+{
+    sZeroLblocks(iam, n, grid, ds_LUstruct(LUstruct));
+}
+
+/*! \brief Destroy the single precision factors and detach them from LUstruct.
+ */
+void
+dsDestroy_LU(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
+{
+    sLUstruct_t *sLUstruct = (sLUstruct_t *) LUstruct->sLUstruct;
+
+    if ( !sLUstruct ) return;
+    sDestroy_LU(n, grid, ds_LUstruct(LUstruct));
+    SUPERLU_FREE(sLUstruct->Llu);
+    SUPERLU_FREE(sLUstruct);
+    LUstruct->sLUstruct = NULL;
+}
@@ -32,6 +32,183 @@ at the top-level directory.
 #include "superlu_ddefs.h"
 #include "psymbfact.h"
 
+/* The entries of A on their way to the processes of the 2D mesh, between
+   ddist_A_post(), called by dist_symbLU() as soon as the supernodes are
+   known, and ddist_A(), called once the structure of L and U has been
+   redistributed. */
+typedef struct {
+  int_t  n;          /* order of A */
+  int_t  *nnzToRecv; /* entries received from each process, then sent to
+			each process and their offsets in the send buffers */
+  int_t  szbuf;      /* number of entries ending in this process */
+  int_t  *ia, *ja;   /* their row and column numbers in Pc*Pr*A, */
+  double *aij;       /* and values, the local ones first */
+  int_t  *index;     /* indices sent to each process, rows first */
+  double *nzval;     /* values sent to each process */
+  int_t  *itemp;     /* indices received from each process */
+  MPI_Request *req;  /* 2 sends and 2 receives per process */
+  float  memAux;     /* memory of the above */
+} ddist_A_t;
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Start the re-distribution of A on the 2D process mesh: only the
+ *   supernode of each row and column is needed to find the owner of an
+ *   entry, so the entries are sent as soon as dist_symbLU() has set up
+ *   the supernodes, with nonblocking messages that progress while it
+ *   redistributes the structure of L and U.  ddist_A() completes them.
+ *
+ * Return value
+ * ============
+ *   0, or the number of bytes allocated when out of memory.
+ * </pre>
+ */
+static float
+ddist_A_post(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
+	     int_t *supno, gridinfo_t *grid, ddist_A_t *dA)
+{
+  NRformat_loc *Astore = (NRformat_loc *) A->Store;
+  int_t  *perm_r = ScalePermstruct->perm_r; /* row permutation vector */
+  int_t  *perm_c = ScalePermstruct->perm_c; /* column permutation vector */
+  int_t  *rowptr = Astore->rowptr, *colind = Astore->colind;
+  double *nzval_a = (double *) Astore->nzval;
+  int_t  m_loc = Astore->m_loc, fst_row = Astore->fst_row;
+  int_t  *nnzToRecv, *nnzToSend, *ptr_to_send, *fst_to_send;
+  int_t  i, j, k, c, irow, jcol, nnz_loc, SendCnt, RecvCnt;
+  int    iam = grid->iam, procs = grid->nprow * grid->npcol, p;
+  int_t  iword = sizeof(int_t), dword = sizeof(double);
+
+  dA->n = A->ncol;
+  dA->index = dA->itemp = NULL;
+  dA->nzval = NULL;
+  dA->req = NULL;
+  if ( !(nnzToRecv = intCalloc_dist(4*procs)) ) {
+    fprintf (stderr, "Malloc fails for nnzToRecv[].");
+    return (ERROR_RET);
+  }
+  dA->nnzToRecv = nnzToRecv;
+  dA->memAux = (float) (4 * procs * iword);
+  nnzToSend = nnzToRecv + procs;
+  ptr_to_send = nnzToSend + procs;
+  fst_to_send = ptr_to_send + procs;
+
+  /* ------------------------------------------------------------
+     COUNT THE NUMBER OF NONZEROS TO BE SENT TO EACH PROCESS,
+     THEN ALLOCATE SPACE.
+     THIS ACCOUNTS FOR THE FIRST PASS OF A.
+     ------------------------------------------------------------*/
+  for (i = 0; i < m_loc; ++i) {
+    irow = perm_c[perm_r[i+fst_row]];  /* Row number in Pc*Pr*A */
+    for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+      jcol = colind[j];
+      p = PNUM( PROW(BlockNum(irow),grid), PCOL(BlockNum(jcol),grid), grid );
+      ++nnzToSend[p];
+    }
+  }
+
+  /* All-to-all communication */
+  MPI_Alltoall( nnzToSend, 1, mpi_int_t, nnzToRecv, 1, mpi_int_t,
+		grid->comm);
+
+  SendCnt = RecvCnt = 0;
+  for (p = 0; p < procs; ++p)
+    if ( p != iam ) {
+      fst_to_send[p] = SendCnt;
+      SendCnt += nnzToSend[p];
+      RecvCnt += nnzToRecv[p];
+    }
+  k = nnzToRecv[iam] + RecvCnt; /* Total nonzeros ended up in my process. */
+  dA->szbuf = k;
+
+  /* Allocate space for storing the triplets after redistribution. */
+  if ( !(dA->ia = intMalloc_dist(SUPERLU_MAX(2*k, 1))) ) {
+    fprintf (stderr, "Malloc fails for ia[].");
+    return (dA->memAux);
+  }
+  dA->memAux += (float) (2*k*iword);
+  dA->ja = dA->ia + k;
+  if ( !(dA->aij = doubleMalloc_dist(SUPERLU_MAX(k, 1))) ) {
+    fprintf (stderr, "Malloc fails for aij[].");
+    return (dA->memAux);
+  }
+  dA->memAux += (float) (k*dword);
+
+  /* Allocate temporary storage for sending/receiving the A triplets. */
+  if ( procs > 1 ) {
+    if ( !(dA->req = (MPI_Request *)
+	   SUPERLU_MALLOC(4*procs *sizeof(MPI_Request))) ) {
+      fprintf (stderr, "Malloc fails for req[].");
+      return (dA->memAux);
+    }
+    dA->memAux += (float) (4*procs *sizeof(MPI_Request));
+    if ( !(dA->index = intMalloc_dist(SUPERLU_MAX(2*SendCnt, 1))) ) {
+      fprintf(stderr, "Malloc fails for index[].");
+      return (dA->memAux);
+    }
+    dA->memAux += (float) (2*SendCnt*iword);
+    if ( !(dA->nzval = doubleMalloc_dist(SUPERLU_MAX(SendCnt, 1))) ) {
+      fprintf(stderr, "Malloc fails for nzval[].");
+      return (dA->memAux);
+    }
+    dA->memAux += (float) (SendCnt * dword);
+    if ( !(dA->itemp = intMalloc_dist(SUPERLU_MAX(2*RecvCnt, 1))) ) {
+      fprintf(stderr, "Malloc fails for itemp[].");
+      return (dA->memAux);
+    }
+    dA->memAux += (float) (2*RecvCnt*iword);
+  }
+
+  /* ------------------------------------------------------------
+     LOAD THE ENTRIES OF A INTO THE (IA,JA,AIJ) STRUCTURES TO SEND.
+     THIS ACCOUNTS FOR THE SECOND PASS OF A.
+     ------------------------------------------------------------*/
+  for (nnz_loc = 0, i = 0; i < m_loc; ++i) {
+    irow = perm_c[perm_r[i+fst_row]];  /* Row number in Pc*Pr*A */
+    for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+      jcol = colind[j];
+      p = PNUM( PROW(BlockNum(irow),grid), PCOL(BlockNum(jcol),grid), grid );
+      if ( p != iam ) { /* remote */
+	c = ptr_to_send[p]++;
+	k = fst_to_send[p];
+	dA->index[2*k + c] = irow;
+	dA->index[2*k + nnzToSend[p] + c] = jcol;
+	dA->nzval[k + c] = nzval_a[j];
+      } else {          /* local */
+	dA->ia[nnz_loc] = irow;
+	dA->ja[nnz_loc] = jcol;
+	dA->aij[nnz_loc] = nzval_a[j];
+	++nnz_loc;
+      }
+    }
+  }
+
+  /* ------------------------------------------------------------
+     START THE REDISTRIBUTION: THE VALUES ARE RECEIVED IN PLACE,
+     AFTER THE LOCAL ONES.
+     ------------------------------------------------------------*/
+  for (p = 0; procs > 1 && p < procs; ++p) {
+    if ( p != iam ) {
+      k = fst_to_send[p];
+      MPI_Isend( &dA->index[2*k], 2*nnzToSend[p], mpi_int_t,
+		 p, iam, grid->comm, &dA->req[4*p] );
+      MPI_Isend( &dA->nzval[k], nnzToSend[p], MPI_DOUBLE,
+		 p, iam+procs, grid->comm, &dA->req[4*p+1] );
+      MPI_Irecv( &dA->itemp[2*(nnz_loc - nnzToRecv[iam])], 2*nnzToRecv[p],
+		 mpi_int_t, p, p, grid->comm, &dA->req[4*p+2] );
+      MPI_Irecv( &dA->aij[nnz_loc], nnzToRecv[p], MPI_DOUBLE,
+		 p, p+procs, grid->comm, &dA->req[4*p+3] );
+      nnz_loc += nnzToRecv[p];
+    } else {
+      for (i = 0; i < 4; ++i) dA->req[4*p+i] = MPI_REQUEST_NULL;
+    }
+  }
+
+  return 0.;
+}
+
 
 /*! \brief
  *
@@ -90,6 +267,13 @@ at the top-level directory.
  * grid   (Input) gridinfo_t*
  *        The 2D process mesh.
  *
+ * A, ScalePermstruct (Input)
+ *        The matrix A and its permutations, whose entries are sent to
+ *        their processes as soon as the supernodes are known.
+ *
+ * dA     (Output) ddist_A_t*
+ *        The redistribution of A in progress, completed by ddist_A().
+ *
  * Return value
  * ============
  *   < 0, number of bytes allocated on return from the dist_symbLU.
@@ -102,7 +286,8 @@ static float
 dist_symbLU (int_t n, Pslu_freeable_t *Pslu_freeable,
 	     Glu_persist_t *Glu_persist,
 	     int_t **p_xlsub, int_t **p_lsub, int_t **p_xusub, int_t **p_usub,
-	     gridinfo_t *grid
+	     gridinfo_t *grid, SuperMatrix *A,
+	     dScalePermstruct_t *ScalePermstruct, ddist_A_t *dA
 	     )
 {
   int   iam, nprocs, pc, pr, p, np, p_diag;
@@ -125,6 +310,7 @@ dist_symbLU (int_t n, Pslu_freeable_t *Pslu_freeable,
   int_t nelts, isize;
   float memAux;  /* Memory used during this routine and freed on return */
   float memRet; /* Memory allocated and not freed on return */
+  float memA;   /* Memory of the redistribution of A when out of memory */
   int_t iword, dword;
 
   /* ------------------------------------------------------------
@@ -280,6 +466,10 @@ dist_symbLU (int_t n, Pslu_freeable_t *Pslu_freeable,
   }
   xsup_n[nsupers] = n;
 
+  /* Start moving the entries of A, see ddist_A_post(). */
+  if ((memA = ddist_A_post(A, ScalePermstruct, supno_n, grid, dA)) > 0)
+    return (memAux + memRet + memA);
+
   for (p = 0; p < nprocs; p++) {
     send_1[p] = FALSE;
     send_2[p] = FALSE;
@@ -684,20 +874,16 @@ dist_symbLU (int_t n, Pslu_freeable_t *Pslu_freeable,
  * <pre>
  * Purpose
  * =======
- *   Re-distribute A on the 2D process mesh.  The lower part is
+ *   Complete the re-distribution of A on the 2D process mesh started
+ *   by ddist_A_post().  The lower part is
  *   stored using a column format and the upper part
  *   is stored using a row format.
  *
  * Arguments
  * =========
  *
- * A      (Input) SuperMatrix*
- *	  The distributed input matrix A of dimension (A->nrow, A->ncol).
- *        The type of A can be: Stype = SLU_NR_loc; Dtype = SLU_D; Mtype = SLU_GE.
- *
- * ScalePermstruct (Input) dScalePermstruct_t*
- *        The data structure to store the scaling and permutation vectors
- *        describing the transformations performed to the original matrix A.
+ * dA     (Input) ddist_A_t*
+ *        The re-distribution in progress; its buffers are freed.
  *
  * Glu_persist  (Input) Glu_persist_t *
  *        Information on supernodes mapping.
@@ -746,36 +932,26 @@ dist_symbLU (int_t n, Pslu_freeable_t *Pslu_freeable,
  */
 
 static float
-ddist_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
-	Glu_persist_t *Glu_persist, gridinfo_t *grid,
+ddist_A(ddist_A_t *dA, Glu_persist_t *Glu_persist, gridinfo_t *grid,
 	int_t **p_ainf_colptr, int_t **p_ainf_rowind, double **p_ainf_val,
 	int_t **p_asup_rowptr, int_t **p_asup_colind, double **p_asup_val,
 	int_t *ilsum_i, int_t *ilsum_j
 	)
 {
   int    iam, p, procs;
-  NRformat_loc *Astore;
-  int_t  *perm_r; /* row permutation vector */
-  int_t  *perm_c; /* column permutation vector */
-  int_t  i, it, irow, fst_row, j, jcol, k, gbi, gbj, n, m_loc, jsize, isize;
+  int_t  i, irow, j, jcol, k, gbi, gbj, jsize, isize;
   int_t  nsupers, nsupers_i, nsupers_j;
   int_t  nnz_loc, nnz_loc_ainf, nnz_loc_asup;    /* number of local nonzeros */
-  int_t  SendCnt; /* number of remote nonzeros to be sent */
-  int_t  RecvCnt; /* number of remote nonzeros to be sent */
   int_t *ainf_colptr, *ainf_rowind, *asup_rowptr, *asup_colind;
   double *asup_val, *ainf_val;
-  int_t  *nnzToSend, *nnzToRecv, maxnnzToRecv;
-  int_t  *ia, *ja, **ia_send, *index, *itemp;
-  int_t  *ptr_to_send;
-  double *aij, **aij_send, *nzval, *dtemp;
-  double *nzval_a;
-  MPI_Request *send_req;
-  MPI_Status  status;
+  int_t  *nnzToRecv = dA->nnzToRecv, *itemp;
+  int_t  *ia = dA->ia, *ja = dA->ja;
+  double *aij = dA->aij;
   int_t *xsup = Glu_persist->xsup;    /* supernode and column mapping */
   int_t *supno = Glu_persist->supno;
-  float memAux;  /* Memory used during this routine and freed on return */
+  float memAux = dA->memAux; /* Memory used during this routine and freed on return */
   float memRet; /* Memory allocated and not freed on return */
-  int_t iword, dword, szbuf;
+  int_t iword, dword, szbuf = dA->szbuf;
 
   /* ------------------------------------------------------------
      INITIALIZATION.
@@ -786,125 +962,27 @@ ddist_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
 #endif
   iword = sizeof(int_t);
   dword = sizeof(double);
-
-  perm_r = ScalePermstruct->perm_r;
-  perm_c = ScalePermstruct->perm_c;
   procs = grid->nprow * grid->npcol;
-  Astore = (NRformat_loc *) A->Store;
-  n = A->ncol;
-  m_loc = Astore->m_loc;
-  fst_row = Astore->fst_row;
-  if (!(nnzToRecv = intCalloc_dist(2*procs))) {
-    fprintf (stderr, "Malloc fails for nnzToRecv[].");
-    return (ERROR_RET);
-  }
-  memAux = (float) (2 * procs * iword);
   memRet = 0.;
-  nnzToSend = nnzToRecv + procs;
-  nsupers  = supno[n-1] + 1;
+  nsupers  = supno[dA->n-1] + 1;
 
   /* ------------------------------------------------------------
-     COUNT THE NUMBER OF NONZEROS TO BE SENT TO EACH PROCESS,
-     THEN ALLOCATE SPACE.
-     THIS ACCOUNTS FOR THE FIRST PASS OF A.
+     COMPLETE THE REDISTRIBUTION STARTED BY ddist_A_post().
      ------------------------------------------------------------*/
-  for (i = 0; i < m_loc; ++i) {
-    for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j) {
-      irow = perm_c[perm_r[i+fst_row]];  /* Row number in Pc*Pr*A */
-      jcol = Astore->colind[j];
-      gbi = BlockNum( irow );
-      gbj = BlockNum( jcol );
-      p = PNUM( PROW(gbi,grid), PCOL(gbj,grid), grid );
-      ++nnzToSend[p];
-    }
-  }
-
-  /* All-to-all communication */
-  MPI_Alltoall( nnzToSend, 1, mpi_int_t, nnzToRecv, 1, mpi_int_t,
-		grid->comm);
-
-  maxnnzToRecv = 0;
-  nnz_loc = SendCnt = RecvCnt = 0;
-
-  for (p = 0; p < procs; ++p) {
-    if ( p != iam ) {
-      SendCnt += nnzToSend[p];
-      RecvCnt += nnzToRecv[p];
-      maxnnzToRecv = SUPERLU_MAX( nnzToRecv[p], maxnnzToRecv );
-    } else {
-      nnz_loc += nnzToRecv[p];
-      /*assert(nnzToSend[p] == nnzToRecv[p]);*/
-    }
-  }
-  k = nnz_loc + RecvCnt; /* Total nonzeros ended up in my process. */
-  szbuf = k;
-
-  /* Allocate space for storing the triplets after redistribution. */
-  if ( !(ia = intMalloc_dist(2*k)) ) {
-    fprintf (stderr, "Malloc fails for ia[].");
-    return (memAux);
-  }
-  memAux += (float) (2*k*iword);
-  ja = ia + k;
-  if ( !(aij = doubleMalloc_dist(k)) ) {
-    fprintf (stderr, "Malloc fails for aij[].");
-    return (memAux);
-  }
-  memAux += (float) (k*dword);
-
-  /* Allocate temporary storage for sending/receiving the A triplets. */
+  nnz_loc = nnzToRecv[iam];
   if ( procs > 1 ) {
-    if ( !(send_req = (MPI_Request *)
-	   SUPERLU_MALLOC(2*procs *sizeof(MPI_Request))) ) {
-      fprintf (stderr, "Malloc fails for send_req[].");
-      return (memAux);
-    }
-    memAux += (float) (2*procs *sizeof(MPI_Request));
-    if ( !(ia_send = (int_t **) SUPERLU_MALLOC(procs*sizeof(int_t*))) ) {
-      fprintf(stderr, "Malloc fails for ia_send[].");
-      return (memAux);
-    }
-    memAux += (float) (procs*sizeof(int_t*));
-    if ( !(aij_send = (double **)SUPERLU_MALLOC(procs*sizeof(double*))) ) {
-      fprintf(stderr, "Malloc fails for aij_send[].");
-      return (memAux);
-    }
-    memAux += (float) (procs*sizeof(double*));
-    if ( !(index = intMalloc_dist(2*SendCnt)) ) {
-      fprintf(stderr, "Malloc fails for index[].");
-      return (memAux);
-    }
-    memAux += (float) (2*SendCnt*iword);
-    if ( !(nzval = doubleMalloc_dist(SendCnt)) ) {
-      fprintf(stderr, "Malloc fails for nzval[].");
-      return (memAux);
-    }
-    memAux += (float) (SendCnt * dword);
-    if ( !(ptr_to_send = intCalloc_dist(procs)) ) {
-      fprintf(stderr, "Malloc fails for ptr_to_send[].");
-      return (memAux);
-    }
-    memAux += (float) (procs * iword);
-    if ( !(itemp = intMalloc_dist(2*maxnnzToRecv)) ) {
-      fprintf(stderr, "Malloc fails for itemp[].");
-      return (memAux);
-    }
-    memAux += (float) (2*maxnnzToRecv*iword);
-    if ( !(dtemp = doubleMalloc_dist(maxnnzToRecv)) ) {
-      fprintf(stderr, "Malloc fails for dtemp[].");
-      return (memAux);
-    }
-    memAux += (float) (maxnnzToRecv * dword);
-
-    for (i = 0, j = 0, p = 0; p < procs; ++p) {
+    MPI_Waitall( 4*procs, dA->req, MPI_STATUSES_IGNORE );
+    for (itemp = dA->itemp, p = 0; p < procs; ++p) {
       if ( p != iam ) {
-	ia_send[p] = &index[i];
-	i += 2 * nnzToSend[p]; /* ia/ja indices alternate */
-	aij_send[p] = &nzval[j];
-	j += nnzToSend[p];
+	for (i = 0; i < nnzToRecv[p]; ++i) {
+	  ia[nnz_loc + i] = itemp[i];
+	  ja[nnz_loc + i] = itemp[i + nnzToRecv[p]];
+	}
+	itemp += 2*nnzToRecv[p];
+	nnz_loc += nnzToRecv[p];
       }
     }
-  } /* if procs > 1 */
+  }
 
   nsupers_i = CEILING( nsupers, grid->nprow ); /* Number of local block rows */
   nsupers_j = CEILING( nsupers, grid->npcol ); /* Number of local block columns */
@@ -919,95 +997,20 @@ ddist_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
   }
   memRet += (float) (ilsum_i[nsupers_i] + 1) * iword;
 
-  /* ------------------------------------------------------------
-     LOAD THE ENTRIES OF A INTO THE (IA,JA,AIJ) STRUCTURES TO SEND.
-     THIS ACCOUNTS FOR THE SECOND PASS OF A.
-     ------------------------------------------------------------*/
-  nnz_loc = 0; /* Reset the local nonzero count. */
+  /* Count nonzeros in each column of L / row of U */
   nnz_loc_ainf = nnz_loc_asup = 0;
-  nzval_a = Astore->nzval;
-  for (i = 0; i < m_loc; ++i) {
-    for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j) {
-      irow = perm_c[perm_r[i+fst_row]];  /* Row number in Pc*Pr*A */
-      jcol = Astore->colind[j];
-      gbi = BlockNum( irow );
-      gbj = BlockNum( jcol );
-      p = PNUM( PROW(gbi,grid), PCOL(gbj,grid), grid );
-
-      if ( p != iam ) { /* remote */
-	k = ptr_to_send[p];
-	ia_send[p][k] = irow;
-	ia_send[p][k + nnzToSend[p]] = jcol;
-	aij_send[p][k] = nzval_a[j];
-	++ptr_to_send[p];
-      } else {          /* local */
-	ia[nnz_loc] = irow;
-	ja[nnz_loc] = jcol;
-	aij[nnz_loc] = nzval_a[j];
-	++nnz_loc;
-	/* Count nonzeros in each column of L / row of U */
-	if (gbi >= gbj) {
-	  ainf_colptr[ilsum_j[LBj( gbj, grid )] + jcol - FstBlockC( gbj )] ++;
-	  nnz_loc_ainf ++;
-	}
-	else {
-	  asup_rowptr[ilsum_i[LBi( gbi, grid )] + irow - FstBlockC( gbi )] ++;
-	  nnz_loc_asup ++;
-	}
-      }
-    }
-  }
-
-  /* ------------------------------------------------------------
-     PERFORM REDISTRIBUTION. THIS INVOLVES ALL-TO-ALL COMMUNICATION.
-     NOTE: Can possibly use MPI_Alltoallv.
-     ------------------------------------------------------------*/
-  for (p = 0; p < procs; ++p) {
-    if ( p != iam ) {
-      it = 2*nnzToSend[p];
-      MPI_Isend( ia_send[p], it, mpi_int_t,
-		 p, iam, grid->comm, &send_req[p] );
-      it = nnzToSend[p];
-      MPI_Isend( aij_send[p], it, MPI_DOUBLE,
-		 p, iam+procs, grid->comm, &send_req[procs+p] );
-    }
-  }
-
-  for (p = 0; p < procs; ++p) {
-    if ( p != iam ) {
-      it = 2*nnzToRecv[p];
-      MPI_Recv( itemp, it, mpi_int_t, p, p, grid->comm, &status );
-      it = nnzToRecv[p];
-      MPI_Recv( dtemp, it, MPI_DOUBLE, p, p+procs,
-		grid->comm, &status );
-      for (i = 0; i < nnzToRecv[p]; ++i) {
-	ia[nnz_loc] = itemp[i];
-	irow = itemp[i];
-	jcol = itemp[i + nnzToRecv[p]];
-	/* assert(jcol<n); */
-	ja[nnz_loc] = jcol;
-	aij[nnz_loc] = dtemp[i];
-	++nnz_loc;
-
-	gbi = BlockNum( irow );
-	gbj = BlockNum( jcol );
-	/* Count nonzeros in each column of L / row of U */
-	if (gbi >= gbj) {
-	  ainf_colptr[ilsum_j[LBj( gbj, grid )] + jcol - FstBlockC( gbj )] ++;
-	  nnz_loc_ainf ++;
-	}
-	else {
-	  asup_rowptr[ilsum_i[LBi( gbi, grid )] + irow - FstBlockC( gbi )] ++;
-	  nnz_loc_asup ++;
-	}
-      }
+  for (i = 0; i < nnz_loc; ++i) {
+    irow = ia[i];
+    jcol = ja[i];
+    gbi = BlockNum( irow );
+    gbj = BlockNum( jcol );
+    if (gbi >= gbj) {
+      ainf_colptr[ilsum_j[LBj( gbj, grid )] + jcol - FstBlockC( gbj )] ++;
+      nnz_loc_ainf ++;
     }
-  }
-
-  for (p = 0; p < procs; ++p) {
-    if ( p != iam ) {
-      MPI_Wait( &send_req[p], &status);
-      MPI_Wait( &send_req[procs+p], &status);
+    else {
+      asup_rowptr[ilsum_i[LBi( gbi, grid )] + irow - FstBlockC( gbi )] ++;
+      nnz_loc_asup ++;
     }
   }
 
@@ -1016,21 +1019,13 @@ ddist_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
      ------------------------------------------------------------*/
 
   SUPERLU_FREE(nnzToRecv);
-  memAux -= 2 * procs * iword;
   if ( procs > 1 ) {
-    SUPERLU_FREE(send_req);
-    SUPERLU_FREE(ia_send);
-    SUPERLU_FREE(aij_send);
-    SUPERLU_FREE(index);
-    SUPERLU_FREE(nzval);
-    SUPERLU_FREE(ptr_to_send);
-    SUPERLU_FREE(itemp);
-    SUPERLU_FREE(dtemp);
-    memAux -= 2*procs *sizeof(MPI_Request) + procs*sizeof(int_t*) +
-      procs*sizeof(double*) + 2*SendCnt * iword +
-      SendCnt* dword + procs*iword +
-      2*maxnnzToRecv*iword + maxnnzToRecv*dword;
+    SUPERLU_FREE(dA->req);
+    SUPERLU_FREE(dA->index);
+    SUPERLU_FREE(dA->nzval);
+    SUPERLU_FREE(dA->itemp);
   }
+  memAux = (float) (2*szbuf*iword + szbuf*dword); /* ia[] and aij[] */
 
   /* ------------------------------------------------------------
      CONVERT THE TRIPLET FORMAT.
@@ -1210,6 +1205,7 @@ ddist_psymbtonum(fact_t fact, int_t n, SuperMatrix *A,
   int_t *asub, *xa;
   int_t *ainf_colptr, *ainf_rowind, *asup_rowptr, *asup_colind;
   double *asup_val, *ainf_val;
+  ddist_A_t dA;     /* redistribution of A, see ddist_A_post() */
   int_t *xsup, *supno;    /* supernode and column mapping */
   int_t *lsub, *xlsub, *usub, *usub1, *xusub;
   int_t nsupers, nsupers_i, nsupers_j, nsupers_ij;
@@ -1327,7 +1323,8 @@ double *dense, *dense_col; /* SPA */
 
   if ((memStrLU =
        dist_symbLU (n, Pslu_freeable,
-		    Glu_persist, &xlsub, &lsub, &xusub, &usub,	grid)) > 0)
+		    Glu_persist, &xlsub, &lsub, &xusub, &usub,	grid,
+		    A, ScalePermstruct, &dA)) > 0)
     return (memStrLU);
   memDist += (-memStrLU);
   xsup  = Glu_persist->xsup;    /* supernode and column mapping */
@@ -1369,7 +1366,7 @@ double *dense, *dense_col; /* SPA */
     }
   ilsum_j[nsupers_j] = ldaspa_j;
 
-  if ((memA = ddist_A(A, ScalePermstruct, Glu_persist,
+  if ((memA = ddist_A(&dA, Glu_persist,
 		      grid, &ainf_colptr, &ainf_rowind, &ainf_val,
 		      &asup_rowptr, &asup_colind, &asup_val,
 		      ilsum, ilsum_j)) > 0)
@@ -1805,16 +1802,15 @@ double *dense, *dense_col; /* SPA */
 	  return (memDist + memNLU + memTRS);
 	}
 
-	if (!(Linv_bc_ptr[ljb_j] = (double*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(double))))
-		ABORT("Malloc fails for Linv_bc_ptr[ljb_j][]");
-	if (!(Uinv_bc_ptr[ljb_j] = (double*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(double))))
-		ABORT("Malloc fails for Uinv_bc_ptr[ljb_j][]");
+	/* Allocated by pdCompute_Diag_Inv() if inverted. */
+	Linv_bc_ptr[ljb_j] = NULL;
+	Uinv_bc_ptr[ljb_j] = NULL;
 
 	memNLU += len1*iword + len*nsupc*dword;
 
 	if ( !(Lindval_loc_bc_ptr[ljb_j] = intCalloc_dist(nrbl*3)))
 		ABORT("Malloc fails for Lindval_loc_bc_ptr[ljb_j][]");
-	memTRS += nrbl*3.0*iword + 2.0*nsupc*nsupc*dword;  //acount for Lindval_loc_bc_ptr[ljb],Linv_bc_ptr[ljb],Uinv_bc_ptr[ljb]
+	memTRS += nrbl*3.0*iword;  //acount for Lindval_loc_bc_ptr[ljb]
 
 	lusup = Lnzval_bc_ptr[ljb_j];
 	mybufmax[0] = SUPERLU_MAX( mybufmax[0], len1 );
@@ -2125,6 +2121,7 @@ double *dense, *dense_col; /* SPA */
 	for (lb = 0; lb < nub; ++lb) {
 		Unnz[lb] = 0;
 		k = lb * grid->npcol + mycol;/* Global block number, column-wise. */
+		if ( k >= nsupers ) continue; /* Urbs[lb] is 0 */
 		knsupc = SuperSize( k );
 		for (ub = 0; ub < Urbs[lb]; ++ub) {
 			ik = Ucb_indptr[lb][ub].lbnum; /* Local block number, row-wise. */
@@ -2153,6 +2150,7 @@ double *dense, *dense_col; /* SPA */
 		k = CEILING( nsupers, grid->npcol );/* Number of local block columns */
 		if ( !(LBtree_ptr = (BcTree*)SUPERLU_MALLOC(k * sizeof(BcTree))) )
 			ABORT("Malloc fails for LBtree_ptr[].");
+		superlu_treespec_init(&Llu->LBtree_spec, k);
 		if ( !(ActiveFlag = intCalloc_dist(grid->nprow*2)) )
 			ABORT("Calloc fails for ActiveFlag[].");
 		if ( !(ranks = (int*)SUPERLU_MALLOC(grid->nprow * sizeof(int))) )
@@ -2161,7 +2159,7 @@ double *dense, *dense_col; /* SPA */
 			ABORT("Malloc fails for SeedSTD_BC[].");
 
 		for (i=0;i<k;i++){
-			SeedSTD_BC[i]=rand();
+			SeedSTD_BC[i]=i; /* deterministic tree seeds */
 		}
 
 		MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_BC[0],k,MPI_DOUBLE,MPI_MAX,grid->cscp.comm);
@@ -2240,8 +2238,8 @@ double *dense, *dense_col; /* SPA */
 					// rseed=rand();
 					// rseed=1.0;
 					msgsize = SuperSize( jb );
-					LBtree_ptr[ljb] = BcTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_BC[ljb],'d');
-					BcTree_SetTag(LBtree_ptr[ljb],BC_L,'d');
+					superlu_treespec_add(&Llu->LBtree_spec, ljb, ranks, rank_cnt,
+							     msgsize, SeedSTD_BC[ljb]);
 
 					// printf("iam %5d btree rank_cnt %5d \n",iam,rank_cnt);
 					// fflush(stdout);
@@ -2316,6 +2314,7 @@ double *dense, *dense_col; /* SPA */
 		k = CEILING( nsupers, grid->nprow );/* Number of local block rows */
 		if ( !(LRtree_ptr = (RdTree*)SUPERLU_MALLOC(k * sizeof(RdTree))) )
 			ABORT("Malloc fails for LRtree_ptr[].");
+		superlu_treespec_init(&Llu->LRtree_spec, k);
 		if ( !(ActiveFlag = intCalloc_dist(grid->npcol*2)) )
 			ABORT("Calloc fails for ActiveFlag[].");
 		if ( !(ranks = (int*)SUPERLU_MALLOC(grid->npcol * sizeof(int))) )
@@ -2331,7 +2330,7 @@ double *dense, *dense_col; /* SPA */
 			ABORT("Malloc fails for SeedSTD_RD[].");
 
 		for (i=0;i<k;i++){
-			SeedSTD_RD[i]=rand();
+			SeedSTD_RD[i]=i; /* deterministic tree seeds */
 		}
 
 		MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_RD[0],k,MPI_DOUBLE,MPI_MAX,grid->rscp.comm);
@@ -2409,8 +2408,8 @@ double *dense, *dense_col; /* SPA */
 
 						// if(ib==0){
 
-						LRtree_ptr[lib] = RdTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_RD[lib],'d');
-						RdTree_SetTag(LRtree_ptr[lib], RD_L,'d');
+						superlu_treespec_add(&Llu->LRtree_spec, lib, ranks, rank_cnt,
+								     msgsize, SeedSTD_RD[lib]);
 						// }
 
 						// printf("iam %5d rtree rank_cnt %5d \n",iam,rank_cnt);
@@ -2461,6 +2460,7 @@ double *dense, *dense_col; /* SPA */
 		k = CEILING( nsupers, grid->npcol );/* Number of local block columns */
 		if ( !(UBtree_ptr = (BcTree*)SUPERLU_MALLOC(k * sizeof(BcTree))) )
 			ABORT("Malloc fails for UBtree_ptr[].");
+		superlu_treespec_init(&Llu->UBtree_spec, k);
 		if ( !(ActiveFlag = intCalloc_dist(grid->nprow*2)) )
 			ABORT("Calloc fails for ActiveFlag[].");
 		if ( !(ranks = (int*)SUPERLU_MALLOC(grid->nprow * sizeof(int))) )
@@ -2469,7 +2469,7 @@ double *dense, *dense_col; /* SPA */
 			ABORT("Malloc fails for SeedSTD_BC[].");
 
 		for (i=0;i<k;i++){
-			SeedSTD_BC[i]=rand();
+			SeedSTD_BC[i]=i; /* deterministic tree seeds */
 		}
 
 		MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_BC[0],k,MPI_DOUBLE,MPI_MAX,grid->cscp.comm);
@@ -2563,8 +2563,8 @@ double *dense, *dense_col; /* SPA */
 					// rseed=rand();
 					// rseed=1.0;
 					msgsize = SuperSize( jb );
-					UBtree_ptr[ljb] = BcTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_BC[ljb],'d');
-					BcTree_SetTag(UBtree_ptr[ljb],BC_U,'d');
+					superlu_treespec_add(&Llu->UBtree_spec, ljb, ranks, rank_cnt,
+							     msgsize, SeedSTD_BC[ljb]);
 
 					// printf("iam %5d btree rank_cnt %5d \n",iam,rank_cnt);
 					// fflush(stdout);
@@ -2627,6 +2627,7 @@ double *dense, *dense_col; /* SPA */
 		k = CEILING( nsupers, grid->nprow );/* Number of local block rows */
 		if ( !(URtree_ptr = (RdTree*)SUPERLU_MALLOC(k * sizeof(RdTree))) )
 			ABORT("Malloc fails for URtree_ptr[].");
+		superlu_treespec_init(&Llu->URtree_spec, k);
 		if ( !(ActiveFlag = intCalloc_dist(grid->npcol*2)) )
 			ABORT("Calloc fails for ActiveFlag[].");
 		if ( !(ranks = (int*)SUPERLU_MALLOC(grid->npcol * sizeof(int))) )
@@ -2642,7 +2643,7 @@ double *dense, *dense_col; /* SPA */
 			ABORT("Malloc fails for SeedSTD_RD[].");
 
 		for (i=0;i<k;i++){
-			SeedSTD_RD[i]=rand();
+			SeedSTD_RD[i]=i; /* deterministic tree seeds */
 		}
 
 		MPI_Allreduce(MPI_IN_PLACE,&SeedSTD_RD[0],k,MPI_DOUBLE,MPI_MAX,grid->rscp.comm);
@@ -2719,8 +2720,8 @@ double *dense, *dense_col; /* SPA */
 
 						// if(ib==0){
 
-						URtree_ptr[lib] = RdTree_Create(grid->comm, ranks, rank_cnt, msgsize,SeedSTD_RD[lib],'d');
-						RdTree_SetTag(URtree_ptr[lib], RD_U,'d');
+						superlu_treespec_add(&Llu->URtree_spec, lib, ranks, rank_cnt,
+								     msgsize, SeedSTD_RD[lib]);
 						// }
 
 						// #if ( PRNTlevel>=1 )
@@ -410,6 +410,32 @@ void dLUstructInit(const int_t n, dLUstruct_t *LUstruct)
 	   SUPERLU_MALLOC(sizeof(dLocalLU_t))) )
 	ABORT("Malloc fails for LocalLU_t.");
 	LUstruct->Llu->inv = 0;
+    LUstruct->Llu->inv_pending = 0;
+    LUstruct->Llu->inv_budget = 0.0;
+    LUstruct->Llu->sol_tdone = NULL;
+    LUstruct->Llu->lsum_shared = 0;
+    LUstruct->Llu->fixed_order = 0;
+    LUstruct->Llu->Amap = NULL;
+    LUstruct->Llu->sn_cost = NULL;
+    LUstruct->Llu->sn_dirty = NULL;
+    LUstruct->Llu->Acolind = NULL;
+    LUstruct->Llu->Lnzval_slab = LUstruct->Llu->Unzval_slab = NULL;
+    LUstruct->Llu->ooc = 0;
+    LUstruct->Llu->release = 0;
+    LUstruct->Llu->Udropped = 0;
+    LUstruct->Llu->compact = 0;
+    LUstruct->Llu->solve_slab = NULL;
+    LUstruct->Llu->droptol = 0.0;
+    LUstruct->Llu->ToRecv = NULL;
+    LUstruct->Llu->Lnzval_ooc.base = LUstruct->Llu->Unzval_ooc.base = NULL;
+    superlu_treespec_init(&LUstruct->Llu->LBtree_spec, 0);
+    superlu_treespec_init(&LUstruct->Llu->LRtree_spec, 0);
+    superlu_treespec_init(&LUstruct->Llu->UBtree_spec, 0);
+    superlu_treespec_init(&LUstruct->Llu->URtree_spec, 0);
+    LUstruct->sLUstruct = NULL;
+    LUstruct->dense = NULL;
+    LUstruct->usymb = NULL;
+    LUstruct->matvec = NULL;
 }
 
 /*! \brief Deallocate LUstruct */
@@ -421,7 +447,7 @@ void dLUstructFree(dLUstruct_t *LUstruct)
     CHECK_MALLOC(iam, "Enter dLUstructFree()");
 #endif
 
-    SUPERLU_FREE(LUstruct->etree);
+    superlu_shm_free(LUstruct->etree);
     SUPERLU_FREE(LUstruct->Glu_persist);
     SUPERLU_FREE(LUstruct->Llu);
 
@@ -444,7 +470,25 @@ dDestroy_LU(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
     CHECK_MALLOC(iam, "Enter dDestroy_LU()");
 #endif
 
+    if ( LUstruct->dense ) { /* Factored by pdgssvx_dense() */
+        dDestroy_DenseLU(LUstruct);
+        return;
+    }
+
+    if ( Llu->Acolind ) SUPERLU_FREE(Llu->Acolind);
+    Llu->Acolind = NULL;
+    if ( Llu->sn_cost ) SUPERLU_FREE(Llu->sn_cost);
+    Llu->sn_cost = NULL;
+
+#ifdef SLU_HAVE_SINGLE
+    if ( LUstruct->sLUstruct ) { /* Factored in single precision */
+        dsDestroy_LU(n, grid, LUstruct);
+        return;
+    }
+#endif
+
     dDestroy_Tree(n, grid, LUstruct);
+    dDestroy_Amap(Llu);
 
     nsupers = Glu_persist->supno[n-1] + 1;
 
@@ -456,25 +500,36 @@ dDestroy_LU(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
     //#ifdef GPU_ACC
 	    checkCuda(cudaFreeHost(Llu->Lnzval_bc_ptr[i]));
 #endif
-	    SUPERLU_FREE (Llu->Lnzval_bc_ptr[i]);
+	    if ( !Llu->Lnzval_slab && !Llu->solve_slab )
+		SUPERLU_FREE (Llu->Lnzval_bc_ptr[i]);
 	}
     SUPERLU_FREE (Llu->Lrowind_bc_ptr);
     SUPERLU_FREE (Llu->Lnzval_bc_ptr);
+    if ( Llu->Lnzval_ooc.base ) superlu_ooc_free(&Llu->Lnzval_ooc);
+    else if ( Llu->Lnzval_slab ) SUPERLU_FREE (Llu->Lnzval_slab);
+    Llu->Lnzval_slab = NULL;
 
     nb = CEILING(nsupers, grid->nprow);
     for (i = 0; i < nb; ++i)
 	if ( Llu->Ufstnz_br_ptr[i] ) {
 	    SUPERLU_FREE (Llu->Ufstnz_br_ptr[i]);
-	    SUPERLU_FREE (Llu->Unzval_br_ptr[i]);
+	    if ( !Llu->Unzval_slab && !Llu->solve_slab && Llu->Unzval_br_ptr[i] )
+		SUPERLU_FREE (Llu->Unzval_br_ptr[i]);
 	}
     SUPERLU_FREE (Llu->Ufstnz_br_ptr);
     SUPERLU_FREE (Llu->Unzval_br_ptr);
+    if ( Llu->Unzval_ooc.base ) superlu_ooc_free(&Llu->Unzval_ooc);
+    else if ( Llu->Unzval_slab ) SUPERLU_FREE (Llu->Unzval_slab);
+    Llu->Unzval_slab = NULL;
+    Llu->Udropped = 0;
 
     /* The following can be freed after factorization. */
-    SUPERLU_FREE(Llu->ToRecv);
-    SUPERLU_FREE(Llu->ToSendD);
-    SUPERLU_FREE(Llu->ToSendR[0]);
-    SUPERLU_FREE(Llu->ToSendR);
+    if ( Llu->ToRecv ) {
+	SUPERLU_FREE(Llu->ToRecv);
+	SUPERLU_FREE(Llu->ToSendD);
+	SUPERLU_FREE(Llu->ToSendR[0]);
+	SUPERLU_FREE(Llu->ToSendR);
+    }
 
     /* The following can be freed only after iterative refinement. */
     SUPERLU_FREE(Llu->ilsum);
@@ -494,7 +549,7 @@ dDestroy_LU(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
     SUPERLU_FREE(Llu->Lindval_loc_bc_ptr);
 	
     nb = CEILING(nsupers, grid->npcol);
-    for (i=0; i<nb; ++i) {
+    for (i=0; i<nb && !Llu->solve_slab; ++i) {
 	if(Llu->Linv_bc_ptr[i]!=NULL) {
 	    SUPERLU_FREE(Llu->Linv_bc_ptr[i]);
 	}
@@ -505,6 +560,9 @@ dDestroy_LU(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
     SUPERLU_FREE(Llu->Linv_bc_ptr);
     SUPERLU_FREE(Llu->Uinv_bc_ptr);
     SUPERLU_FREE(Llu->Unnz);
+    if ( Llu->solve_slab ) SUPERLU_FREE(Llu->solve_slab);
+    Llu->solve_slab = NULL;
+    Llu->compact = 0;
 	
     nb = CEILING(nsupers, grid->npcol);
     for (i = 0; i < nb; ++i)
@@ -516,8 +574,8 @@ dDestroy_LU(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
     SUPERLU_FREE(Llu->Ucb_valptr);	
     SUPERLU_FREE(Llu->Urbs);
 
-    SUPERLU_FREE(Glu_persist->xsup);
-    SUPERLU_FREE(Glu_persist->supno);
+    superlu_shm_free(Glu_persist->xsup);
+    superlu_shm_free(Glu_persist->supno);
 
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(iam, "Exit dDestroy_LU()");
@@ -681,6 +739,8 @@ pdgstrs_init(int_t n, int_t m_loc, int_t nrhs, int_t fst_row,
     gstrs_comm->ptr_to_ibuf = ptr_to_ibuf;
     gstrs_comm->ptr_to_dbuf = ptr_to_ibuf + procs;
 
+    pxgstrs_neighbors(gstrs_comm, grid);
+
     return 0;
 } /* PDGSTRS_INIT */
 
@@ -768,6 +828,17 @@ int dSolveInit(superlu_dist_options_t *options, SuperMatrix *A,
            SUPERLU_MALLOC(sizeof(pdgsmv_comm_t))) )
         ABORT("Malloc fails for gsmv_comm[]");
     SOLVEstruct->A_colind_gsmv = NULL;
+    SOLVEstruct->gstrs_work = NULL;
+    SOLVEstruct->sparse_rhs = options->SparseRHS;
+    SOLVEstruct->nout_rows = 0;
+    SOLVEstruct->out_rows = NULL;
+    SOLVEstruct->x_layout = NO;
+    SOLVEstruct->root_size = options->Solve_RootSize;
+    SOLVEstruct->crit_path = options->Solve_CritPath;
+    SOLVEstruct->priority = options->Solve_Priority;
+    SOLVEstruct->rhs_tile = options->Solve_RHSTile;
+    SOLVEstruct->refine_msg_prec = options->Refine_MsgPrec;
+    SOLVEstruct->msg_prec = SLU_MSG_FULL;
 
     options->SolveInitialized = YES;
     return 0;
@@ -780,6 +851,7 @@ void dSolveFinalize(superlu_dist_options_t *options, dSOLVEstruct_t *SOLVEstruct
     int_t *it;
 
     pxgstrs_finalize(SOLVEstruct->gstrs_comm);
+    dSolveWorkFree(SOLVEstruct);
 
     if ( options->RefineInitialized ) {
         pdgsmv_finalize(SOLVEstruct->gsmv_comm);
@@ -794,6 +866,50 @@ void dSolveFinalize(superlu_dist_options_t *options, dSOLVEstruct_t *SOLVEstruct
     options->SolveInitialized = NO;
 } /* dSolveFinalize */
 
+/*! \brief Check whether a large-diagonal row permutation and scaling still fit A.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * pdldperm_check() returns 1 if, in diag(R)*A*diag(C) with perm_r[], R[]
+ * and C[] of ScalePermstruct, every matched entry a(i,perm_r[i]) is at
+ * least tol and every entry at most 1/tol in absolute value, and 0
+ * otherwise. After MC64 job 5 or pdldperm_auction() with scaling, the
+ * matched entries are about one and the others at most about one.
+ * A is in SLU_NR_loc format, not scaled yet. Collective over grid->comm.
+ * </pre>
+ */
+int pdldperm_check(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
+		   double tol, gridinfo_t *grid)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    double *a = (double *) Astore->nzval;
+    double *R = ScalePermstruct->R, *C = ScalePermstruct->C;
+    int_t  *perm_r = ScalePermstruct->perm_r;
+    int_t  *rowptr = Astore->rowptr, *colind = Astore->colind;
+    int_t  i, j, irow, nd = 0, gnd;
+    double s, amax[2], gmax[2];
+
+    amax[0] = -dmach_dist("Overflow"); /* -(smallest matched entry) */
+    amax[1] = 0.0;
+    irow = Astore->fst_row;
+    for (j = 0; j < Astore->m_loc; ++j, ++irow) {
+	for (i = rowptr[j]; i < rowptr[j+1]; ++i) {
+	    s = fabs(a[i]) * R[irow] * C[colind[i]];
+	    if ( perm_r[irow] == colind[i] ) {
+		++nd;
+		amax[0] = SUPERLU_MAX(amax[0], -s);
+	    }
+	    amax[1] = SUPERLU_MAX(amax[1], s);
+	}
+    }
+    MPI_Allreduce(amax, gmax, 2, MPI_DOUBLE, MPI_MAX, grid->comm);
+    MPI_Allreduce(&nd, &gnd, 1, mpi_int_t, MPI_SUM, grid->comm);
+
+    return ( gnd == A->ncol && -gmax[0] >= tol && gmax[1] <= 1.0 / tol );
+}
+
 /*! \brief Check the inf-norm of the error vector
  */
 void pdinf_norm_error(int iam, int_t n, int_t nrhs, double x[], int_t ldx,
@@ -823,6 +939,30 @@ void pdinf_norm_error(int iam, int_t n, int_t nrhs, double x[], int_t ldx,
     }
 }
 
+/*! \brief Return the bytes of the local L and U factors, with their indices.
+ */
+double
+dLU_local_bytes(int_t n, dLUstruct_t *LUstruct, gridinfo_t *grid)
+{
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = LUstruct->Glu_persist->xsup, *index, lb, jb;
+    int_t nsupers = LUstruct->Glu_persist->supno[n-1] + 1;
+    int   myrow = MYROW(grid->iam, grid), mycol = MYCOL(grid->iam, grid);
+    double bytes = 0.0;
+
+    for (lb = 0; (jb = lb * grid->npcol + mycol) < nsupers; ++lb) {
+	if ( !(index = Llu->Lrowind_bc_ptr[lb]) ) continue;
+	bytes += (double) index[1] * SuperSize( jb ) * sizeof(double)
+	    + (double) (BC_HEADER + index[0] * LB_DESCRIPTOR + index[1])
+	    * sizeof(int_t);
+    }
+    for (lb = 0; (jb = lb * grid->nprow + myrow) < nsupers; ++lb) {
+	if ( !(index = Llu->Ufstnz_br_ptr[lb]) ) continue;
+	bytes += (double) index[1] * sizeof(double) + (double) index[2] * sizeof(int_t);
+    }
+    return bytes;
+}
+
 /*! \brief Destroy distributed L & U matrices. */
 void
 dDestroy_Tree(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
@@ -861,10 +1001,239 @@ dDestroy_Tree(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
     }
     SUPERLU_FREE(Llu->LRtree_ptr);
     SUPERLU_FREE(Llu->URtree_ptr);
+    superlu_treespec_free(&Llu->LBtree_spec);
+    superlu_treespec_free(&Llu->LRtree_spec);
+    superlu_treespec_free(&Llu->UBtree_spec);
+    superlu_treespec_free(&Llu->URtree_spec);
 
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(iam, "Exit dDestroy_Tree()");
 #endif
 }
 
+static void
+dCreate_Tree_Set(superlu_treespec_t *spec, void **tree, int bcast, int tag,
+		  int nrhs, MPI_Comm comm)
+{
+    int k;
+
+    for (k = 0; k < spec->ntree; ++k) {
+	if ( !spec->cnt[k] ) continue;
+	if ( bcast ) {
+	    tree[k] = BcTree_CreateNrhs(comm, &spec->rank[spec->start[k]],
+					spec->cnt[k], spec->msgsize[k], nrhs,
+					spec->seed[k], 'd');
+	    BcTree_SetTag(tree[k], tag, 'd');
+	} else {
+	    tree[k] = RdTree_Create(comm, &spec->rank[spec->start[k]],
+				    spec->cnt[k], spec->msgsize[k],
+				    spec->seed[k], 'd');
+	    RdTree_SetTag(tree[k], tag, 'd');
+	}
+    }
+    superlu_treespec_free(spec);
+}
+
+/*! \brief Create the communication trees of the triangular solves.
+ *
+ * <pre>
+ * The distribution only records the ranks of the trees in
+ * Llu->LBtree_spec, ..., Llu->URtree_spec; the BcTree and RdTree objects,
+ * with their message buffers and requests, are created here when they are
+ * first needed, so that a factorization that is never solved with does
+ * not pay for them. Nothing is done if they exist already. The shape of
+ * the broadcasts is chosen for messages of nrhs right-hand sides, the
+ * same on all the processes. Local to the calling process.
+ * </pre>
+ */
+void
+dCreate_Trees(dLocalLU_t *Llu, gridinfo_t *grid, int nrhs)
+{
+    dCreate_Tree_Set(&Llu->LBtree_spec, Llu->LBtree_ptr, 1, BC_L, nrhs,
+		     grid->comm);
+    dCreate_Tree_Set(&Llu->UBtree_spec, Llu->UBtree_ptr, 1, BC_U, nrhs,
+		     grid->comm);
+    dCreate_Tree_Set(&Llu->LRtree_spec, Llu->LRtree_ptr, 0, RD_L, nrhs,
+		     grid->comm);
+    dCreate_Tree_Set(&Llu->URtree_spec, Llu->URtree_ptr, 0, RD_U, nrhs,
+		     grid->comm);
+}
+
+
+
+/*! \brief Free what the factorization needs and the solves do not.
+ *
+ * <pre>
+ * Called by pdgssvx() after the factorization with
+ * options->ReleaseMemory = YES: the schedule of the messages of pdgstrf()
+ * and the map of the values of A, if any. ToRecv = NULL marks the factors
+ * as usable for solves only.
+ * </pre>
+ */
+void
+dRelease_LU(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
+{
+    dLocalLU_t *Llu = LUstruct->Llu;
+
+    dDestroy_Amap(Llu);
+    if ( Llu->Acolind ) SUPERLU_FREE(Llu->Acolind);
+    Llu->Acolind = NULL;
+    if ( Llu->sn_cost ) SUPERLU_FREE(Llu->sn_cost);
+    Llu->sn_cost = NULL;
+    if ( Llu->ToRecv ) {
+	SUPERLU_FREE(Llu->ToRecv);
+	SUPERLU_FREE(Llu->ToSendD);
+	SUPERLU_FREE(Llu->ToSendR[0]);
+	SUPERLU_FREE(Llu->ToSendR);
+	Llu->ToRecv = NULL;
+	Llu->ToSendD = NULL;
+	Llu->ToSendR = NULL;
+    }
+}
+
+/*! \brief Free the blocks of U off the diagonal of a symmetric A1.
+ *
+ * <pre>
+ * Called by pdgssvx() after the factorization with options->SymValues =
+ * YES. If A1 = Pc*Pr*diag(R)*A*diag(C)*Pc^T is symmetric, that is, Pr = I
+ * and R = C, the factorization without pivoting gives U = D*L^T with
+ * D = diag(U), kept in the diagonal blocks: the values of the blocks of
+ * U off the diagonal are freed, their indices are kept, and Udropped is
+ * set, with which the solves use L and D only (see pdgstrs_sym()).
+ * Nothing is done for the factors in single precision, with ILU, BLR,
+ * OutOfCore or SchurSize, or if A1 is not symmetric. Returns whether U
+ * was dropped. Local to the calling process.
+ * </pre>
+ */
+int
+dDrop_U(superlu_dist_options_t *options, int_t n,
+	dScalePermstruct_t *ScalePermstruct, dLUstruct_t *LUstruct,
+	gridinfo_t *grid)
+{
+    dLocalLU_t *Llu = LUstruct->Llu;
+    DiagScale_t DiagScale = ScalePermstruct->DiagScale;
+    int_t *perm_r = ScalePermstruct->perm_r;
+    int_t i, nlb;
+    int   sym;
+
+    sym = ( options->SymValues == YES && !LUstruct->sLUstruct
+	    && Llu->droptol == 0.0 && options->BLR_Tol == 0.0 && !Llu->ooc
+	    && options->SchurSize == 0
+	    && (DiagScale == NOEQUIL || DiagScale == BOTH) );
+    for (i = 0; sym && i < n; ++i)
+	sym = perm_r[i] == i && (DiagScale == NOEQUIL
+				 || ScalePermstruct->R[i] == ScalePermstruct->C[i]);
+    if ( !sym ) {
+#if ( PRNTlevel>=1 )
+	if ( !grid->iam && options->SymValues == YES )
+	    printf(".. SymValues ignored: A1 is not symmetric or U is needed\n");
+#endif
+	return 0;
+    }
+
+    nlb = CEILING( LUstruct->Glu_persist->supno[n-1] + 1, grid->nprow );
+    for (i = 0; i < nlb; ++i) {
+	if ( Llu->Unzval_br_ptr[i] && !Llu->Unzval_slab )
+	    SUPERLU_FREE(Llu->Unzval_br_ptr[i]);
+	Llu->Unzval_br_ptr[i] = NULL;
+    }
+    if ( Llu->Unzval_slab ) SUPERLU_FREE(Llu->Unzval_slab);
+    Llu->Unzval_slab = NULL;
+    Llu->Udropped = 1;
+    return 1;
+}
+
+/* Length of a block in the array of dCompact_LU(): 8 values, 64 bytes. */
+#define COMPACT_LEN(len) ( ((len) + 7) & ~(size_t) 7 )
 
+/*! \brief Convert the factors to the layout of the triangular solves.
+ *
+ * <pre>
+ * Called by pdgstrs() at the first solve after a factorization with
+ * options->Solve_Compact = YES, once the diagonal blocks are inverted.
+ * The values of each local block column of L, followed by the inverses
+ * Linv and Uinv of its diagonal block, are copied into one array in
+ * increasing order of the supernodes, as the L-solve takes them, and the
+ * local block rows of U follow in decreasing order, as the U-solve takes
+ * them. Each block starts on 64 bytes. The blocks allocated one by one
+ * and the slabs of pddistribute() are freed; the indices, and the
+ * offsets Ucb_valptr[] into the block rows of U, are unchanged. Nothing
+ * is done with OutOfCore, the slabs being in files.
+ * </pre>
+ */
+void
+dCompact_LU(int_t n, gridinfo_t *grid, dLUstruct_t *LUstruct)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    dLocalLU_t *Llu = LUstruct->Llu;
+    int_t  *xsup = Glu_persist->xsup;
+    int_t  nsupers, k, lk, lb;
+    int    myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    int    mem_tag;
+    size_t nsupc, len, pos;
+    double *slab;
+
+    Llu->compact = 0;
+    if ( Llu->solve_slab || Llu->ooc ) return;
+    nsupers = Glu_persist->supno[n-1] + 1;
+
+    for (len = 0, k = mycol; k < nsupers; k += grid->npcol) {
+	lk = LBj( k, grid );
+	nsupc = SuperSize( k );
+	if ( Llu->Lnzval_bc_ptr[lk] )
+	    len += COMPACT_LEN( nsupc * Llu->Lrowind_bc_ptr[lk][1] );
+	if ( Llu->Linv_bc_ptr[lk] ) len += 2 * COMPACT_LEN( nsupc * nsupc );
+    }
+    for (k = myrow; k < nsupers; k += grid->nprow) {
+	lb = LBi( k, grid );
+	if ( Llu->Unzval_br_ptr[lb] )
+	    len += COMPACT_LEN( (size_t) Llu->Ufstnz_br_ptr[lb][1] );
+    }
+    mem_tag = superlu_mem_tag(SUPERLU_MEM_FACTORS);
+    if ( !(slab = doubleMalloc_dist(SUPERLU_MAX(len, 1))) )
+	ABORT("Malloc fails for solve_slab[].");
+    superlu_mem_tag(mem_tag);
+    superlu_hugepage(slab, len * sizeof(double));
+
+    /* L and the inverses, block column by block column. */
+    pos = 0;
+    for (k = mycol; k < nsupers; k += grid->npcol) {
+	lk = LBj( k, grid );
+	nsupc = SuperSize( k );
+	if ( Llu->Lnzval_bc_ptr[lk] ) {
+	    len = nsupc * Llu->Lrowind_bc_ptr[lk][1];
+	    memcpy(&slab[pos], Llu->Lnzval_bc_ptr[lk], len * sizeof(double));
+	    if ( !Llu->Lnzval_slab ) SUPERLU_FREE(Llu->Lnzval_bc_ptr[lk]);
+	    Llu->Lnzval_bc_ptr[lk] = &slab[pos];
+	    pos += COMPACT_LEN( len );
+	}
+	if ( Llu->Linv_bc_ptr[lk] ) {
+	    len = nsupc * nsupc;
+	    memcpy(&slab[pos], Llu->Linv_bc_ptr[lk], len * sizeof(double));
+	    SUPERLU_FREE(Llu->Linv_bc_ptr[lk]);
+	    Llu->Linv_bc_ptr[lk] = &slab[pos];
+	    pos += COMPACT_LEN( len );
+	    memcpy(&slab[pos], Llu->Uinv_bc_ptr[lk], len * sizeof(double));
+	    SUPERLU_FREE(Llu->Uinv_bc_ptr[lk]);
+	    Llu->Uinv_bc_ptr[lk] = &slab[pos];
+	    pos += COMPACT_LEN( len );
+	}
+    }
+
+    /* U, from the last block row. */
+    for (k = nsupers - 1; k >= 0; --k) {
+	if ( PROW( k, grid ) != myrow ) continue;
+	lb = LBi( k, grid );
+	if ( !Llu->Unzval_br_ptr[lb] ) continue;
+	len = Llu->Ufstnz_br_ptr[lb][1];
+	memcpy(&slab[pos], Llu->Unzval_br_ptr[lb], len * sizeof(double));
+	if ( !Llu->Unzval_slab ) SUPERLU_FREE(Llu->Unzval_br_ptr[lb]);
+	Llu->Unzval_br_ptr[lb] = &slab[pos];
+	pos += COMPACT_LEN( len );
+    }
+
+    if ( Llu->Lnzval_slab ) SUPERLU_FREE(Llu->Lnzval_slab);
+    if ( Llu->Unzval_slab ) SUPERLU_FREE(Llu->Unzval_slab);
+    Llu->Lnzval_slab = Llu->Unzval_slab = NULL;
+    Llu->solve_slab = slab;
+}
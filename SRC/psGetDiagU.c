@@ -0,0 +1,224 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file p@(pre)GetDiagU.c
+ * \brief Extracts the main diagonal of matrix U, and the determinant of A
+ *
+ * <pre>
+ * -- Auxiliary routine in distributed SuperLU (version 5.1.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * Xiaoye S. Li
+ * Created:  April 16, 2002
+ * Modified: May 15, 2016
+ * </pre>
+ */
+
+
+
+#include "superlu_sdefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * GetDiagU extracts the main diagonal of matrix U of the LU factorization.
+ *
+ * Arguments
+ * =========
+ *
+ * n        (input) int
+ *          Dimension of the matrix.
+ *
+ * LUstruct (input) sLUstruct_t*
+ *          The data structures to store the distributed L and U factors.
+ *          see superlu_sdefs.h for its definition.
+ *
+ * grid     (input) gridinfo_t*
+ *          The 2D process mesh. It contains the MPI communicator, the number
+ *          of process rows (NPROW), the number of process columns (NPCOL),
+ *          and my process rank. It is an input argument to all the
+ *          parallel routines.
+ *
+ * diagU    (output) float*, dimension (n)
+ *          The main diagonal of matrix U.
+ *          On exit, it is available on all processes.
+ *
+ *
+ * Note
+ * ====
+ *
+ * The diagonal blocks of the L and U matrices are stored in the L
+ * data structures, and are on the diagonal processes of the
+ * 2D process grid.
+ *
+ * This routine is modified from gather_diag_to_all() in psgstrs_Bglobal.c.
+ * </pre>
+ */
+void psGetDiagU(int_t n, sLUstruct_t *LUstruct, gridinfo_t *grid,
+                  float *diagU)
+{
+
+    int_t *xsup;
+    int iam, knsupc, pkk;
+    int nsupr; /* number of rows in the block L(:,k) (LDA) */
+    int_t i, j, jj, k, lk, lwork, nsupers, p;
+    int_t num_diag_procs, *diag_procs, *diag_len;
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    sLocalLU_t *Llu = LUstruct->Llu;
+    float *dblock, *dwork, *lusup;
+
+    iam = grid->iam;
+    nsupers = Glu_persist->supno[n-1] + 1;
+    xsup = Glu_persist->xsup;
+
+    get_diag_procs(n, Glu_persist, grid, &num_diag_procs,
+		   &diag_procs, &diag_len);
+    jj = diag_len[0];
+    for (j = 1; j < num_diag_procs; ++j) jj = SUPERLU_MAX( jj, diag_len[j] );
+    if ( !(dwork = floatMalloc_dist(jj)) ) ABORT("Malloc fails for dwork[]");
+
+    for (p = 0; p < num_diag_procs; ++p) {
+	pkk = diag_procs[p];
+	if ( iam == pkk ) {
+	    /* Copy diagonal into buffer dwork[]. */
+	    lwork = 0;
+	    for (k = p; k < nsupers; k += num_diag_procs) {
+		knsupc = SuperSize( k );
+		lk = LBj( k, grid );
+		nsupr = Llu->Lrowind_bc_ptr[lk][1]; /* LDA of lusup[] */
+		lusup = Llu->Lnzval_bc_ptr[lk];
+		for (i = 0; i < knsupc; ++i) /* Copy the diagonal. */
+		    dwork[lwork+i] = lusup[i*(nsupr+1)];
+		lwork += knsupc;
+	    }
+	    MPI_Bcast( dwork, lwork, MPI_FLOAT, pkk, grid->comm );
+	} else {
+	    MPI_Bcast( dwork, diag_len[p], MPI_FLOAT, pkk, grid->comm );
+	}
+
+	/* Scatter dwork[] into global diagU vector. */
+	lwork = 0;
+	for (k = p; k < nsupers; k += num_diag_procs) {
+	    knsupc = SuperSize( k );
+	    dblock = &diagU[FstBlockC( k )];
+	    for (i = 0; i < knsupc; ++i) dblock[i] = dwork[lwork+i];
+	    lwork += knsupc;
+	}
+    } /* for p = ... */
+
+    SUPERLU_FREE(diag_procs);
+    SUPERLU_FREE(diag_len);
+    SUPERLU_FREE(dwork);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * psLogDet computes the determinant of A from its factorization by
+ * psgssvx(), as sign * exp(logdet), which does not overflow.
+ *
+ * From Pc*Pr*diag(R)*A*diag(C)*Pc' = L*U with a unit L,
+ *
+ *     det(A) = det(Pr) * prod U(i,i) / ( prod R(i) * prod C(i) ).
+ *
+ * Each diagonal process sums log|U(i,i)| over its diagonal blocks and one
+ * reduction combines them; the sign of Pr is found from the cycles of
+ * perm_r[] on each process. If a factor was perturbed (see the options
+ * ReplaceTinyPivot and ILU_DropTol), this is the determinant of the
+ * perturbed matrix.
+ *
+ * Arguments
+ * =========
+ *
+ * n        (input) int
+ *          Dimension of the matrix.
+ *
+ * LUstruct (input) sLUstruct_t*
+ *          The distributed L and U factors computed by psgssvx().
+ *
+ * ScalePermstruct (input) sScalePermstruct_t*
+ *          The scaling and the permutations of this factorization.
+ *
+ * grid     (input) gridinfo_t*
+ *          The 2D process mesh.
+ *
+ * logdet   (output) float*
+ *          log|det(A)|, -infinity if U is singular.
+ *
+ * sign     (output) int*
+ *          The sign of det(A): 1, -1, or 0 if U is singular.
+ *          On exit, logdet and sign are available on all processes.
+ * </pre>
+ */
+void psLogDet(int_t n, sLUstruct_t *LUstruct,
+	      sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	      float *logdet, int *sign)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    sLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = Glu_persist->xsup, *perm_r = ScalePermstruct->perm_r;
+    int_t i, j, k, lk, nsupers, knsupc;
+    int   nsupr, iam = grid->iam, swaps;
+    int   myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+    double part[3] = {0.0, 0.0, 0.0}; /* log|U(i,i)|, negative, zero */
+    float *lusup;
+    double u;
+    DiagScale_t DiagScale = ScalePermstruct->DiagScale;
+    char *mark;
+
+    if ( n <= 0 ) { *logdet = 0.0; *sign = 1; return; }
+
+    /* The diagonal blocks are in L, on the diagonal processes. */
+    nsupers = Glu_persist->supno[n-1] + 1;
+    for (k = 0; k < nsupers; ++k) {
+	if ( myrow != PROW( k, grid ) || mycol != PCOL( k, grid ) ) continue;
+	knsupc = SuperSize( k );
+	lk = LBj( k, grid );
+	nsupr = Llu->Lrowind_bc_ptr[lk][1]; /* LDA of lusup[] */
+	lusup = Llu->Lnzval_bc_ptr[lk];
+	for (i = 0; i < knsupc; ++i) {
+	    u = lusup[i*(nsupr+1)];
+	    if ( u == 0.0 ) part[2] += 1.0;
+	    else part[0] += log(fabs(u));
+	    if ( u < 0.0 ) part[1] += 1.0;
+	}
+    }
+    MPI_Allreduce(MPI_IN_PLACE, part, 3, MPI_DOUBLE, MPI_SUM, grid->comm);
+
+    /* The scaling factors are positive. */
+    if ( DiagScale == ROW || DiagScale == BOTH )
+	for (i = 0; i < n; ++i) part[0] -= log(ScalePermstruct->R[i]);
+    if ( DiagScale == COL || DiagScale == BOTH )
+	for (i = 0; i < n; ++i) part[0] -= log(ScalePermstruct->C[i]);
+
+    /* det(Pr) = (-1)^(n - number of cycles). */
+    if ( !(mark = SUPERLU_MALLOC(n * sizeof(char))) )
+	ABORT("Malloc fails for mark[].");
+    for (i = 0; i < n; ++i) mark[i] = 0;
+    for (swaps = 0, i = 0; i < n; ++i) {
+	if ( mark[i] ) continue;
+	for (j = i; !mark[j]; j = perm_r[j]) { mark[j] = 1; ++swaps; }
+	--swaps;
+    }
+    SUPERLU_FREE(mark);
+
+    if ( part[2] > 0.0 ) {
+	*logdet = -HUGE_VAL;
+	*sign = 0;
+    } else {
+	*logdet = part[0];
+	*sign = ( ((long) part[1] + swaps) % 2 ) ? -1 : 1;
+    }
+}
@@ -0,0 +1,304 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Parallel assembly of a distributed SLU_NR_loc matrix from
+ *        (i, j, v) triples
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Any process adds triples for any rows with sAssemblyAdd(), e.g. the
+ * contributions of its elements in a finite element code; they are kept
+ * in local buffers. psAssemblyFinish() sends each triple to the process
+ * owning its row in one all-to-all exchange, sorts the columns of each
+ * row, sums the duplicates and creates the matrix. The rows are
+ * distributed in contiguous blocks in the order of the ranks, each
+ * process giving its own m_loc and fst_row to psAssemblyInit().
+ *
+ *     sAssembly_t assembly;
+ *     psAssemblyInit(m, n, m_loc, fst_row, grid, &assembly);
+ *     for (each element e) sAssemblyAdd(&assembly, ne, ie, je, ve);
+ *     psAssemblyFinish(&assembly, &A);
+ * </pre>
+ */
+
+#include <string.h>
+#include "superlu_sdefs.h"
+
+#define ASSEMBLY_MIN_CAP 1024
+
+/*! \brief Create A from the nz triples (row[k], col[k], val[k]) held by
+ *         each process.
+ *
+ * <pre>
+ * Collective over grid->comm. The triples go to the process owning their
+ * row: process p owns the rows start[p] to start[p+1]-1, start[] having
+ * nprow*npcol+1 entries, the same on all the processes. The columns of
+ * each row are sorted, by the OpenMP threads, and the duplicates are
+ * summed. row[], col[] and val[] are freed once they are sent. A is
+ * freed by Destroy_CompRowLoc_Matrix_dist().
+ * </pre>
+ */
+void
+pscoord_to_loc(int_t m, int_t n, int_t nz, int_t *row, int_t *col,
+	       float *val, int_t *start, SuperMatrix *A, gridinfo_t *grid)
+{
+    int iam = grid->iam, procs = grid->nprow * grid->npcol, p, lo, hi;
+    int *sendcnts, *recvcnts, *sdispls, *rdispls, *owner;
+    int_t i, j, k, nz_loc, nnz_loc, m_loc, fst_row, maxrow;
+    int_t *srow, *scol, *rrow, *rcol, *rowptr, *colind, *len;
+    float *sval, *rval, *nzval;
+
+    m_loc = start[iam + 1] - start[iam];
+    fst_row = start[iam];
+
+    /* Send each entry to the owner of its row. */
+    if ( !(sendcnts = SUPERLU_MALLOC(4 * procs * sizeof(int))) )
+	ABORT("Malloc fails for sendcnts[].");
+    recvcnts = sendcnts + procs;
+    sdispls = recvcnts + procs;
+    rdispls = sdispls + procs;
+    if ( !(owner = SUPERLU_MALLOC(SUPERLU_MAX(nz, 1) * sizeof(int))) )
+	ABORT("Malloc fails for owner[].");
+    for (p = 0; p < procs; ++p) sendcnts[p] = 0;
+    for (k = 0; k < nz; ++k) {
+	/* The last process p with start[p] <= row[k]. */
+	for (lo = 0, hi = procs - 1; lo < hi; ) {
+	    p = (lo + hi + 1) / 2;
+	    if ( start[p] <= row[k] ) lo = p; else hi = p - 1;
+	}
+	owner[k] = lo;
+	++sendcnts[lo];
+    }
+    MPI_Alltoall(sendcnts, 1, MPI_INT, recvcnts, 1, MPI_INT, grid->comm);
+    sdispls[0] = rdispls[0] = 0;
+    for (p = 1; p < procs; ++p) {
+	sdispls[p] = sdispls[p-1] + sendcnts[p-1];
+	rdispls[p] = rdispls[p-1] + recvcnts[p-1];
+    }
+    nz_loc = rdispls[procs-1] + recvcnts[procs-1];
+
+    if ( !(srow = intMalloc_dist(SUPERLU_MAX(nz, 1))) ||
+	 !(scol = intMalloc_dist(SUPERLU_MAX(nz, 1))) )
+	ABORT("Malloc fails for srow[] / scol[].");
+    if ( !(sval = floatMalloc_dist(SUPERLU_MAX(nz, 1))) )
+	ABORT("Malloc fails for sval[].");
+    for (k = 0; k < nz; ++k) {
+	i = sdispls[owner[k]]++;
+	srow[i] = row[k];
+	scol[i] = col[k];
+	sval[i] = val[k];
+    }
+    for (p = 0; p < procs; ++p) sdispls[p] -= sendcnts[p];
+    SUPERLU_FREE(owner);
+    SUPERLU_FREE(row);
+    SUPERLU_FREE(col);
+    SUPERLU_FREE(val);
+
+    if ( !(rrow = intMalloc_dist(SUPERLU_MAX(nz_loc, 1))) ||
+	 !(rcol = intMalloc_dist(SUPERLU_MAX(nz_loc, 1))) )
+	ABORT("Malloc fails for rrow[] / rcol[].");
+    if ( !(rval = floatMalloc_dist(SUPERLU_MAX(nz_loc, 1))) )
+	ABORT("Malloc fails for rval[].");
+    MPI_Alltoallv(srow, sendcnts, sdispls, mpi_int_t,
+		  rrow, recvcnts, rdispls, mpi_int_t, grid->comm);
+    MPI_Alltoallv(scol, sendcnts, sdispls, mpi_int_t,
+		  rcol, recvcnts, rdispls, mpi_int_t, grid->comm);
+    MPI_Alltoallv(sval, sendcnts, sdispls, MPI_FLOAT,
+		  rval, recvcnts, rdispls, MPI_FLOAT, grid->comm);
+    SUPERLU_FREE(srow);
+    SUPERLU_FREE(scol);
+    SUPERLU_FREE(sval);
+    SUPERLU_FREE(sendcnts);
+
+    /* Bucket the entries by row. */
+    if ( !(rowptr = intCalloc_dist(m_loc + 1)) )
+	ABORT("Calloc fails for rowptr[].");
+    if ( !(colind = intMalloc_dist(SUPERLU_MAX(nz_loc, 1))) )
+	ABORT("Malloc fails for colind[].");
+    if ( !(nzval = floatMalloc_dist(SUPERLU_MAX(nz_loc, 1))) )
+	ABORT("Malloc fails for nzval[].");
+    for (k = 0; k < nz_loc; ++k) ++rowptr[rrow[k] - fst_row + 1];
+    for (j = 0; j < m_loc; ++j) rowptr[j+1] += rowptr[j];
+    for (k = 0; k < nz_loc; ++k) {
+	i = rowptr[rrow[k] - fst_row]++;
+	colind[i] = rcol[k];
+	nzval[i] = rval[k];
+    }
+    for (j = m_loc; j > 0; --j) rowptr[j] = rowptr[j-1];
+    rowptr[0] = 0;
+    SUPERLU_FREE(rrow);
+    SUPERLU_FREE(rcol);
+    SUPERLU_FREE(rval);
+
+    /* Sort the columns of each row and sum the duplicates; len[j] is the
+       number of distinct columns of row j. */
+    if ( !(len = intMalloc_dist(m_loc + 1)) )
+	ABORT("Malloc fails for len[].");
+    for (maxrow = 0, j = 0; j < m_loc; ++j)
+	maxrow = SUPERLU_MAX(maxrow, rowptr[j+1] - rowptr[j]);
+#ifdef _OPENMP
+#pragma omp parallel private (i, j, k)
+#endif
+    {
+	int_t *perm = intMalloc_dist(SUPERLU_MAX(maxrow, 1));
+	float *v = floatMalloc_dist(SUPERLU_MAX(maxrow, 1));
+	int_t b, e, w;
+
+	if ( !perm || !v ) ABORT("Malloc fails for perm[] / v[].");
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+	for (j = 0; j < m_loc; ++j) {
+	    b = rowptr[j];
+	    e = rowptr[j+1];
+	    for (k = b; k < e; ++k) {
+		perm[k-b] = k;
+		v[k-b] = nzval[k];
+	    }
+	    superlu_sort_int(e - b, &colind[b], perm);
+	    for (w = b, k = b; k < e; ++k) {
+		if ( w > b && colind[k] == colind[w-1] )
+		    nzval[w-1] += v[perm[k-b] - b];
+		else {
+		    colind[w] = colind[k];
+		    nzval[w++] = v[perm[k-b] - b];
+		}
+	    }
+	    len[j] = w - b;
+	}
+	SUPERLU_FREE(perm);
+	SUPERLU_FREE(v);
+    }
+
+    /* Close the gaps left by the duplicates. */
+    for (nnz_loc = 0, j = 0; j < m_loc; ++j) {
+	i = rowptr[j];
+	rowptr[j] = nnz_loc;
+	if ( i != nnz_loc ) {
+	    memmove(&colind[nnz_loc], &colind[i], len[j] * sizeof(int_t));
+	    memmove(&nzval[nnz_loc], &nzval[i], len[j] * sizeof(float));
+	}
+	nnz_loc += len[j];
+    }
+    rowptr[m_loc] = nnz_loc;
+    SUPERLU_FREE(len);
+
+    sCreate_CompRowLoc_Matrix_dist(A, m, n, nnz_loc, m_loc, fst_row,
+				   nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_S, SLU_GE);
+}
+
+/*! \brief Start the assembly of an m-by-n matrix whose rows fst_row to
+ *         fst_row+m_loc-1 are owned by this process.
+ *
+ * <pre>
+ * Collective over grid->comm. The blocks of rows of the processes follow
+ * the order of the ranks and cover the m rows.
+ * </pre>
+ */
+void
+psAssemblyInit(int_t m, int_t n, int_t m_loc, int_t fst_row,
+	       gridinfo_t *grid, sAssembly_t *assembly)
+{
+    int p, procs = grid->nprow * grid->npcol;
+
+    assembly->m = m;
+    assembly->n = n;
+    assembly->grid = grid;
+    if ( !(assembly->start = intMalloc_dist(procs + 1)) )
+	ABORT("Malloc fails for start[].");
+    MPI_Allgather(&fst_row, 1, mpi_int_t, assembly->start, 1, mpi_int_t,
+		  grid->comm);
+    assembly->start[procs] = m;
+    for (p = 0; p < procs; ++p)
+	if ( assembly->start[p] > assembly->start[p+1] )
+	    ABORT("psAssemblyInit: the row blocks are not in the rank order.");
+    if ( assembly->start[grid->iam + 1] - fst_row != m_loc )
+	ABORT("psAssemblyInit: the row blocks do not cover the rows.");
+    assembly->nz = assembly->cap = 0;
+    assembly->row = assembly->col = NULL;
+    assembly->val = NULL;
+}
+
+/*! \brief Add the nt triples (i[k], j[k], v[k]), zero-based, to the matrix.
+ *
+ * <pre>
+ * Local: the triples may be for any rows; the entries added several
+ * times, by one process or by several, are summed. Not thread safe on
+ * the same assembly.
+ * </pre>
+ */
+void
+sAssemblyAdd(sAssembly_t *assembly, int_t nt, int_t *i, int_t *j, float *v)
+{
+    int_t k, cap;
+    int_t *row, *col;
+    float *val;
+
+    if ( assembly->nz + nt > assembly->cap ) {
+	cap = SUPERLU_MAX(2 * assembly->cap, assembly->nz + nt);
+	cap = SUPERLU_MAX(cap, ASSEMBLY_MIN_CAP);
+	if ( !(row = intMalloc_dist(cap)) || !(col = intMalloc_dist(cap)) )
+	    ABORT("Malloc fails for row[] / col[].");
+	if ( !(val = floatMalloc_dist(cap)) )
+	    ABORT("Malloc fails for val[].");
+	if ( assembly->cap ) {
+	    memcpy(row, assembly->row, assembly->nz * sizeof(int_t));
+	    memcpy(col, assembly->col, assembly->nz * sizeof(int_t));
+	    memcpy(val, assembly->val, assembly->nz * sizeof(float));
+	    SUPERLU_FREE(assembly->row);
+	    SUPERLU_FREE(assembly->col);
+	    SUPERLU_FREE(assembly->val);
+	}
+	assembly->row = row;
+	assembly->col = col;
+	assembly->val = val;
+	assembly->cap = cap;
+    }
+    for (k = 0; k < nt; ++k) {
+	if ( i[k] < 0 || i[k] >= assembly->m || j[k] < 0 || j[k] >= assembly->n ) {
+	    fprintf(stderr, "(" IFMT ", " IFMT ") out of bound\n", i[k], j[k]);
+	    ABORT("Matrix entry out of bound.");
+	}
+	assembly->row[assembly->nz + k] = i[k];
+	assembly->col[assembly->nz + k] = j[k];
+	assembly->val[assembly->nz + k] = v[k];
+    }
+    assembly->nz += nt;
+}
+
+/*! \brief Create the matrix A from the triples added on all the processes.
+ *
+ * <pre>
+ * Collective over grid->comm, see pscoord_to_loc(). The buffers of assembly
+ * are freed; A is freed by Destroy_CompRowLoc_Matrix_dist().
+ * </pre>
+ */
+void
+psAssemblyFinish(sAssembly_t *assembly, SuperMatrix *A)
+{
+    if ( !assembly->cap ) {
+	assembly->row = intMalloc_dist(1);
+	assembly->col = intMalloc_dist(1);
+	assembly->val = floatMalloc_dist(1);
+    }
+    pscoord_to_loc(assembly->m, assembly->n, assembly->nz, assembly->row,
+		   assembly->col, assembly->val, assembly->start, A,
+		   assembly->grid);
+    SUPERLU_FREE(assembly->start);
+    assembly->row = assembly->col = NULL;
+    assembly->val = NULL;
+    assembly->nz = assembly->cap = 0;
+}
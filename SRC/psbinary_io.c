@@ -0,0 +1,729 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Save and restore the distributed LU factors with MPI-IO
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * psSave_LU() writes everything psgssvx() needs to solve with an existing
+ * factorization into one binary file: the scaling and permutations
+ * (ScalePermstruct), the supernode partition (Glu_persist), and the local
+ * L and U blocks of every process together with the communication
+ * schedule and trees of the triangular solve (LocalLU_t).
+ * psLoad_LU() reads it back on a process grid of the same shape, after
+ * which psgssvx() can be called with options->Fact = FACTORED.
+ *
+ * File layout (all integers are int_t unless noted):
+ *   header   : 16 long long words, see SAVE_LU_* below
+ *   global   : etree[n], xsup[nsupers+1], supno[n], perm_r[m], perm_c[n],
+ *              R[m] and C[n] if the matrix was equilibrated;
+ *              written by process 0
+ *   table    : offset and length (long long) of each process's section
+ *   local    : one section per process, see sLU_pack()
+ * </pre>
+ */
+
+#include <string.h>
+#include "superlu_sdefs.h"
+
+#define SAVE_LU_MAGIC   0x53554c53   /* "SLUS" */
+#define SAVE_LU_VERSION 2
+#define SAVE_LU_HEADER  16
+#define SAVE_LU_BUFSIZE (8 << 20)    /* Staging buffer for the I/O calls */
+#define SAVE_LU_CHUNK   (1 << 30)    /* Largest single MPI-IO request */
+
+/*! \brief Buffered sequential access to a region of an MPI file. */
+typedef struct {
+    MPI_File   fh;
+    MPI_Offset off;      /* file offset of buf[0] */
+    char       *buf;
+    size_t     len;      /* bytes held in buf[] */
+    size_t     pos;      /* next byte of buf[] to read */
+    long long  size;     /* bytes put so far */
+    int        count;    /* only count the bytes, do not write */
+    int        err;
+} lu_io_t;
+
+static void
+lu_io_init(lu_io_t *io, MPI_File fh, MPI_Offset off, int count)
+{
+    io->fh = fh;
+    io->off = off;
+    io->len = io->pos = 0;
+    io->size = 0;
+    io->count = count;
+    io->err = 0;
+    io->buf = NULL;
+    if ( !count && !(io->buf = SUPERLU_MALLOC(SAVE_LU_BUFSIZE)) )
+	ABORT("Malloc fails for io->buf[].");
+}
+
+static void
+lu_io_rw(lu_io_t *io, MPI_Offset off, void *p, size_t nbytes, int write)
+{
+    char *c = (char *) p;
+    size_t len;
+    MPI_Status status;
+
+    while ( nbytes ) {
+	len = SUPERLU_MIN(nbytes, SAVE_LU_CHUNK);
+	if ( write )
+	    io->err |= MPI_File_write_at(io->fh, off, c, (int) len, MPI_BYTE,
+					 &status);
+	else
+	    io->err |= MPI_File_read_at(io->fh, off, c, (int) len, MPI_BYTE,
+					&status);
+	off += len;
+	c += len;
+	nbytes -= len;
+    }
+}
+
+static void
+lu_io_flush(lu_io_t *io)
+{
+    if ( io->len ) {
+	lu_io_rw(io, io->off, io->buf, io->len, 1);
+	io->off += io->len;
+	io->len = 0;
+    }
+}
+
+static void
+lu_io_put(lu_io_t *io, void *p, size_t nbytes)
+{
+    io->size += nbytes;
+    if ( io->count || !nbytes ) return;
+    if ( io->len + nbytes > SAVE_LU_BUFSIZE ) lu_io_flush(io);
+    if ( nbytes >= SAVE_LU_BUFSIZE ) { /* Write large arrays directly. */
+	lu_io_rw(io, io->off, p, nbytes, 1);
+	io->off += nbytes;
+    } else {
+	memcpy(&io->buf[io->len], p, nbytes);
+	io->len += nbytes;
+    }
+}
+
+static void
+lu_io_get(lu_io_t *io, void *p, size_t nbytes)
+{
+    char *c = (char *) p;
+    size_t len = SUPERLU_MIN(nbytes, io->len - io->pos);
+
+    memcpy(c, &io->buf[io->pos], len);
+    io->pos += len;
+    if ( len == nbytes ) return;
+
+    c += len;
+    nbytes -= len;
+    io->off += io->len;
+    io->len = io->pos = 0;
+    if ( nbytes >= SAVE_LU_BUFSIZE ) { /* Read large arrays directly. */
+	lu_io_rw(io, io->off, c, nbytes, 0);
+	io->off += nbytes;
+    } else {
+	/* The last read of a section may extend past the end of file. */
+	lu_io_rw(io, io->off, io->buf, SAVE_LU_BUFSIZE, 0);
+	io->len = SAVE_LU_BUFSIZE;
+	memcpy(c, io->buf, nbytes);
+	io->pos = nbytes;
+    }
+}
+
+static void
+lu_io_finalize(lu_io_t *io)
+{
+    if ( !io->count ) lu_io_flush(io);
+    SUPERLU_FREE(io->buf);
+}
+
+#define PUT_INT(io, a, n)  lu_io_put(io, a, (n) * sizeof(int_t))
+#define PUT_INT4(io, a, n) lu_io_put(io, a, (n) * sizeof(int))
+#define PUT_VAL(io, a, n)  lu_io_put(io, a, (n) * sizeof(float))
+#define GET_INT(io, a, n)  lu_io_get(io, a, (n) * sizeof(int_t))
+#define GET_INT4(io, a, n) lu_io_get(io, a, (n) * sizeof(int))
+#define GET_VAL(io, a, n)  lu_io_get(io, a, (n) * sizeof(float))
+
+/*! \brief Length of the index array of a block column of L. */
+static int_t
+Lrowind_length(int_t *index)
+{
+    int_t nb = index[0], i, len = BC_HEADER;
+    for (i = 0; i < nb; ++i) len += LB_DESCRIPTOR + index[len+1];
+    return len;
+}
+
+/*! \brief Save the local view of one broadcast or reduction tree. */
+static void
+put_tree(lu_io_t *io, void *tree, int bcast)
+{
+    int_t t[3], dest;
+    int i;
+
+    if ( !tree ) {
+	t[0] = EMPTY;
+	PUT_INT(io, t, 1);
+	return;
+    }
+    if ( bcast ) {
+	t[0] = BcTree_GetRoot(tree,'s');
+	t[1] = BcTree_GetMsgSize(tree,'s');
+	t[2] = BcTree_getDestCount(tree,'s');
+    } else {
+	t[0] = RdTree_GetRoot(tree,'s');
+	t[1] = RdTree_GetMsgSize(tree,'s');
+	t[2] = RdTree_GetDestCount(tree,'s');
+    }
+    PUT_INT(io, t, 3);
+    for (i = 0; i < t[2]; ++i) {
+	dest = bcast ? BcTree_GetDest(tree, i,'s') : RdTree_GetDest(tree, i,'s');
+	PUT_INT(io, &dest, 1);
+    }
+}
+
+static void *
+get_tree(lu_io_t *io, MPI_Comm comm, int bcast, int tag)
+{
+    int_t t[3], dest;
+    int i, *dests;
+    void *tree;
+
+    GET_INT(io, t, 1);
+    if ( t[0] == EMPTY ) return NULL;
+    GET_INT(io, &t[1], 2);
+    if ( !(dests = SUPERLU_MALLOC(SUPERLU_MAX(t[2], 1) * sizeof(int))) )
+	ABORT("Malloc fails for dests[].");
+    for (i = 0; i < t[2]; ++i) {
+	GET_INT(io, &dest, 1);
+	dests[i] = dest;
+    }
+    if ( bcast ) {
+	tree = BcTree_CreateLocal(comm, t[0], dests, t[2], t[1],'s');
+	BcTree_SetTag(tree, tag,'s');
+    } else {
+	tree = RdTree_CreateLocal(comm, t[0], dests, t[2], t[1],'s');
+	RdTree_SetTag(tree, tag,'s');
+    }
+    SUPERLU_FREE(dests);
+    return tree;
+}
+
+/*! \brief Write (or count) the local section of this process.
+ *
+ * <pre>
+ * scalars  : nfrecvx, nfsendx, nbrecvx, nbsendx, ldalsum, bufmax[]
+ * schedule : ToRecv, ToSendD, ToSendR, ilsum, fmod, bmod, fsendx_plist,
+ *            bsendx_plist, Unnz, Urbs
+ * per local block column : Lrowind, Lnzval, Lindval_loc, Ucb_indptr,
+ *            Ucb_valptr
+ * The inverses of the diagonal blocks are not written; they are
+ * computed again by the first solve after psLoad_LU().
+ * per local block row    : Ufstnz, Unzval
+ * trees    : LBtree, UBtree (per block column), LRtree, URtree (per block row)
+ * </pre>
+ */
+static void
+sLU_pack(lu_io_t *io, int_t nsupers, sLUstruct_t *LUstruct, gridinfo_t *grid)
+{
+    sLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = LUstruct->Glu_persist->xsup;
+    int_t nlb = CEILING(nsupers, grid->nprow);
+    int_t ncb = CEILING(nsupers, grid->npcol);
+    int_t lk, len, nsupc, scal[5 + NBUFFERS];
+    int_t *index;
+    int mycol = MYCOL(grid->iam, grid);
+
+    scal[0] = Llu->nfrecvx;
+    scal[1] = Llu->nfsendx;
+    scal[2] = Llu->nbrecvx;
+    scal[3] = Llu->nbsendx;
+    scal[4] = Llu->ldalsum;
+    for (lk = 0; lk < NBUFFERS; ++lk) scal[5+lk] = Llu->bufmax[lk];
+    PUT_INT(io, scal, 5 + NBUFFERS);
+
+    PUT_INT4(io, Llu->ToRecv, nsupers);
+    PUT_INT4(io, Llu->ToSendD, nlb);
+    PUT_INT4(io, Llu->ToSendR[0], ncb * grid->npcol);
+    PUT_INT(io, Llu->ilsum, nlb + 1);
+    PUT_INT(io, Llu->fmod, nlb);
+    PUT_INT(io, Llu->bmod, nlb);
+    PUT_INT(io, Llu->fsendx_plist[0], ncb * grid->nprow);
+    PUT_INT(io, Llu->bsendx_plist[0], ncb * grid->nprow);
+    PUT_INT(io, Llu->Unnz, ncb);
+    PUT_INT(io, Llu->Urbs, 2 * ncb);
+
+    for (lk = 0; lk < ncb; ++lk) {
+	index = Llu->Lrowind_bc_ptr[lk];
+	len = index ? Lrowind_length(index) : 0;
+	PUT_INT(io, &len, 1);
+	if ( len ) {
+	    nsupc = SuperSize(lk * grid->npcol + mycol);
+	    PUT_INT(io, index, len);
+	    PUT_VAL(io, Llu->Lnzval_bc_ptr[lk], index[1] * nsupc);
+	    PUT_INT(io, Llu->Lindval_loc_bc_ptr[lk], index[0] * 3);
+	}
+	if ( Llu->Urbs[lk] ) {
+	    PUT_INT(io, Llu->Ucb_indptr[lk], 2 * Llu->Urbs[lk]);
+	    PUT_INT(io, Llu->Ucb_valptr[lk], Llu->Urbs[lk]);
+	}
+    }
+
+    for (lk = 0; lk < nlb; ++lk) {
+	index = Llu->Ufstnz_br_ptr[lk];
+	len = index ? index[2] + 1 : 0; /* Including the end marker */
+	PUT_INT(io, &len, 1);
+	if ( len ) {
+	    PUT_INT(io, index, len);
+	    PUT_VAL(io, Llu->Unzval_br_ptr[lk], index[1]);
+	}
+    }
+
+    sCreate_Trees(Llu, grid, 1);
+    for (lk = 0; lk < ncb; ++lk) {
+	put_tree(io, Llu->LBtree_ptr[lk], 1);
+	put_tree(io, Llu->UBtree_ptr[lk], 1);
+    }
+    for (lk = 0; lk < nlb; ++lk) {
+	put_tree(io, Llu->LRtree_ptr[lk], 0);
+	put_tree(io, Llu->URtree_ptr[lk], 0);
+    }
+}
+
+/*! \brief Read the local section written by sLU_pack() into Llu.
+ *
+ * The arrays are allocated the same way as in psdistribute(), so that
+ * sDestroy_LU() can free them.
+ */
+static void
+sLU_unpack(lu_io_t *io, int_t nsupers, sLUstruct_t *LUstruct,
+	   gridinfo_t *grid)
+{
+    sLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = LUstruct->Glu_persist->xsup;
+    int_t nlb = CEILING(nsupers, grid->nprow);
+    int_t ncb = CEILING(nsupers, grid->npcol);
+    int_t lk, len, nsupc, scal[5 + NBUFFERS];
+    int_t *index;
+    int *index1;
+    int mycol = MYCOL(grid->iam, grid);
+
+    GET_INT(io, scal, 5 + NBUFFERS);
+    Llu->nfrecvx = scal[0];
+    Llu->nfsendx = scal[1];
+    Llu->nbrecvx = scal[2];
+    Llu->nbsendx = scal[3];
+    Llu->ldalsum = scal[4];
+    for (lk = 0; lk < NBUFFERS; ++lk) Llu->bufmax[lk] = scal[5+lk];
+
+    if ( !(Llu->ToRecv = SUPERLU_MALLOC(nsupers * sizeof(int))) )
+	ABORT("Malloc fails for ToRecv[].");
+    GET_INT4(io, Llu->ToRecv, nsupers);
+    if ( !(Llu->ToSendD = SUPERLU_MALLOC(nlb * sizeof(int))) )
+	ABORT("Malloc fails for ToSendD[].");
+    GET_INT4(io, Llu->ToSendD, nlb);
+    if ( !(Llu->ToSendR = (int **) SUPERLU_MALLOC(ncb * sizeof(int*))) )
+	ABORT("Malloc fails for ToSendR[].");
+    if ( !(index1 = SUPERLU_MALLOC(ncb * grid->npcol * sizeof(int))) )
+	ABORT("Malloc fails for index[].");
+    GET_INT4(io, index1, ncb * grid->npcol);
+    for (lk = 0; lk < ncb; ++lk) Llu->ToSendR[lk] = &index1[lk * grid->npcol];
+
+    if ( !(Llu->ilsum = intMalloc_dist(nlb + 1)) )
+	ABORT("Malloc fails for ilsum[].");
+    GET_INT(io, Llu->ilsum, nlb + 1);
+    if ( !(Llu->fmod = intMalloc_dist(nlb)) )
+	ABORT("Malloc fails for fmod[].");
+    GET_INT(io, Llu->fmod, nlb);
+    if ( !(Llu->bmod = intMalloc_dist(nlb)) )
+	ABORT("Malloc fails for bmod[].");
+    GET_INT(io, Llu->bmod, nlb);
+    if ( !(Llu->mod_bit = intMalloc_dist(nlb)) )
+	ABORT("Malloc fails for mod_bit[].");
+
+    if ( !(Llu->fsendx_plist = (int_t **) SUPERLU_MALLOC(ncb*sizeof(int_t*))) )
+	ABORT("Malloc fails for fsendx_plist[].");
+    if ( !(index = intMalloc_dist(ncb * grid->nprow)) )
+	ABORT("Malloc fails for fsendx_plist[0]");
+    GET_INT(io, index, ncb * grid->nprow);
+    for (lk = 0; lk < ncb; ++lk) Llu->fsendx_plist[lk] = &index[lk*grid->nprow];
+    if ( !(Llu->bsendx_plist = (int_t **) SUPERLU_MALLOC(ncb*sizeof(int_t*))) )
+	ABORT("Malloc fails for bsendx_plist[].");
+    if ( !(index = intMalloc_dist(ncb * grid->nprow)) )
+	ABORT("Malloc fails for bsendx_plist[0]");
+    GET_INT(io, index, ncb * grid->nprow);
+    for (lk = 0; lk < ncb; ++lk) Llu->bsendx_plist[lk] = &index[lk*grid->nprow];
+
+    if ( !(Llu->Unnz = intMalloc_dist(ncb)) )
+	ABORT("Malloc fails for Unnz[].");
+    GET_INT(io, Llu->Unnz, ncb);
+    if ( !(Llu->Urbs = intMalloc_dist(2 * ncb)) )
+	ABORT("Malloc fails for Urbs[].");
+    GET_INT(io, Llu->Urbs, 2 * ncb);
+
+    if ( !(Llu->Lrowind_bc_ptr = (int_t**)SUPERLU_MALLOC(ncb * sizeof(int_t*))) )
+	ABORT("Malloc fails for Lrowind_bc_ptr[].");
+    if ( !(Llu->Lnzval_bc_ptr = (float**)SUPERLU_MALLOC(ncb * sizeof(float*))) )
+	ABORT("Malloc fails for Lnzval_bc_ptr[].");
+    if ( !(Llu->Lindval_loc_bc_ptr =
+	   (int_t**)SUPERLU_MALLOC(ncb * sizeof(int_t*))) )
+	ABORT("Malloc fails for Lindval_loc_bc_ptr[].");
+    if ( !(Llu->Linv_bc_ptr = (float**)SUPERLU_MALLOC(ncb * sizeof(float*))) )
+	ABORT("Malloc fails for Linv_bc_ptr[].");
+    if ( !(Llu->Uinv_bc_ptr = (float**)SUPERLU_MALLOC(ncb * sizeof(float*))) )
+	ABORT("Malloc fails for Uinv_bc_ptr[].");
+    if ( !(Llu->Ucb_indptr = SUPERLU_MALLOC(ncb * sizeof(Ucb_indptr_t *))) )
+	ABORT("Malloc fails for Ucb_indptr[].");
+    if ( !(Llu->Ucb_valptr = SUPERLU_MALLOC(ncb * sizeof(int_t *))) )
+	ABORT("Malloc fails for Ucb_valptr[].");
+
+    for (lk = 0; lk < ncb; ++lk) {
+	GET_INT(io, &len, 1);
+	if ( len ) {
+	    nsupc = SuperSize(lk * grid->npcol + mycol);
+	    if ( !(index = intMalloc_dist(len)) )
+		ABORT("Malloc fails for index[]");
+	    GET_INT(io, index, len);
+	    Llu->Lrowind_bc_ptr[lk] = index;
+	    if ( !(Llu->Lnzval_bc_ptr[lk] =
+		   (float*)SUPERLU_MALLOC(index[1] * nsupc * sizeof(float))) )
+		ABORT("Malloc fails for lusup[]");
+	    GET_VAL(io, Llu->Lnzval_bc_ptr[lk], index[1] * nsupc);
+	    if ( !(Llu->Lindval_loc_bc_ptr[lk] = intMalloc_dist(index[0] * 3)) )
+		ABORT("Malloc fails for Lindval_loc_bc_ptr[lk][]");
+	    GET_INT(io, Llu->Lindval_loc_bc_ptr[lk], index[0] * 3);
+	    Llu->Linv_bc_ptr[lk] = NULL;
+	    Llu->Uinv_bc_ptr[lk] = NULL;
+	} else {
+	    Llu->Lrowind_bc_ptr[lk] = NULL;
+	    Llu->Lnzval_bc_ptr[lk] = NULL;
+	    Llu->Lindval_loc_bc_ptr[lk] = NULL;
+	    Llu->Linv_bc_ptr[lk] = NULL;
+	    Llu->Uinv_bc_ptr[lk] = NULL;
+	}
+	if ( Llu->Urbs[lk] ) {
+	    if ( !(Llu->Ucb_indptr[lk] =
+		   SUPERLU_MALLOC(Llu->Urbs[lk] * sizeof(Ucb_indptr_t))) )
+		ABORT("Malloc fails for Ucb_indptr[lk][]");
+	    GET_INT(io, Llu->Ucb_indptr[lk], 2 * Llu->Urbs[lk]);
+	    if ( !(Llu->Ucb_valptr[lk] = intMalloc_dist(Llu->Urbs[lk])) )
+		ABORT("Malloc fails for Ucb_valptr[lk][]");
+	    GET_INT(io, Llu->Ucb_valptr[lk], Llu->Urbs[lk]);
+	}
+    }
+
+    if ( !(Llu->Ufstnz_br_ptr = (int_t**)SUPERLU_MALLOC(nlb * sizeof(int_t*))) )
+	ABORT("Malloc fails for Ufstnz_br_ptr[].");
+    if ( !(Llu->Unzval_br_ptr = (float**)SUPERLU_MALLOC(nlb * sizeof(float*))) )
+	ABORT("Malloc fails for Unzval_br_ptr[].");
+    for (lk = 0; lk < nlb; ++lk) {
+	GET_INT(io, &len, 1);
+	if ( len ) {
+	    if ( !(index = intMalloc_dist(len)) )
+		ABORT("Malloc fails for Uindex[].");
+	    GET_INT(io, index, len);
+	    Llu->Ufstnz_br_ptr[lk] = index;
+	    if ( !(Llu->Unzval_br_ptr[lk] = floatMalloc_dist(index[1])) )
+		ABORT("Malloc fails for Unzval_br_ptr[*][].");
+	    GET_VAL(io, Llu->Unzval_br_ptr[lk], index[1]);
+	} else {
+	    Llu->Ufstnz_br_ptr[lk] = NULL;
+	    Llu->Unzval_br_ptr[lk] = NULL;
+	}
+    }
+
+    if ( !(Llu->LBtree_ptr = (BcTree*)SUPERLU_MALLOC(ncb * sizeof(BcTree))) )
+	ABORT("Malloc fails for LBtree_ptr[].");
+    if ( !(Llu->UBtree_ptr = (BcTree*)SUPERLU_MALLOC(ncb * sizeof(BcTree))) )
+	ABORT("Malloc fails for UBtree_ptr[].");
+    for (lk = 0; lk < ncb; ++lk) {
+	Llu->LBtree_ptr[lk] = get_tree(io, grid->comm, 1, BC_L);
+	Llu->UBtree_ptr[lk] = get_tree(io, grid->comm, 1, BC_U);
+    }
+    if ( !(Llu->LRtree_ptr = (RdTree*)SUPERLU_MALLOC(nlb * sizeof(RdTree))) )
+	ABORT("Malloc fails for LRtree_ptr[].");
+    if ( !(Llu->URtree_ptr = (RdTree*)SUPERLU_MALLOC(nlb * sizeof(RdTree))) )
+	ABORT("Malloc fails for URtree_ptr[].");
+    for (lk = 0; lk < nlb; ++lk) {
+	Llu->LRtree_ptr[lk] = get_tree(io, grid->comm, 0, RD_L);
+	Llu->URtree_ptr[lk] = get_tree(io, grid->comm, 0, RD_U);
+    }
+}
+
+/*! \brief Save the LU factors computed by psgssvx() to a file.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Write the factorization held in ScalePermstruct and LUstruct to
+ *   the binary file "filename" using MPI-IO. The routine is collective
+ *   over grid->comm. Every process writes its own L and U blocks at an
+ *   offset computed from the sizes of the sections of the processes
+ *   before it, so the time is dominated by the file system bandwidth.
+ *
+ * Arguments
+ * =========
+ *
+ * filename (input) char*
+ *        Name of the file, the same on all processes.
+ *
+ * m, n   (input) int_t
+ *        Dimensions of the factored matrix.
+ *
+ * ScalePermstruct (input) sScalePermstruct_t*
+ *        The scaling and permutation vectors returned by psgssvx().
+ *
+ * LUstruct (input) sLUstruct_t*
+ *        The distributed factors returned by psgssvx().
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * Return value
+ * ============
+ *   = 0: successful exit
+ *   < 0: the file could not be created or written (-1), or the schedule
+ *        of the factors or U was freed (-3, see options->ReleaseMemory and
+ *        options->SymValues), which is not supported.
+ * </pre>
+ */
+int
+psSave_LU(char *filename, int_t m, int_t n,
+	  sScalePermstruct_t *ScalePermstruct, sLUstruct_t *LUstruct,
+	  gridinfo_t *grid)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    int_t nsupers = Glu_persist->supno[n-1] + 1;
+    int iam = grid->iam, nprocs = grid->nprow * grid->npcol, err;
+    long long hdr[SAVE_LU_HEADER], sect[2], mysize;
+    MPI_Offset table;
+    MPI_File fh;
+    lu_io_t io;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter psSave_LU()");
+#endif
+
+    if ( !LUstruct->Llu->ToRecv || LUstruct->Llu->Udropped ) return -3;
+    MPI_File_delete(filename, MPI_INFO_NULL); /* Truncate an existing file. */
+    MPI_Barrier(grid->comm);
+    err = MPI_File_open(grid->comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+			MPI_INFO_NULL, &fh);
+    if ( err != MPI_SUCCESS ) return -1;
+
+    memset(hdr, 0, sizeof(hdr));
+    hdr[0] = SAVE_LU_MAGIC;
+    hdr[1] = SAVE_LU_VERSION;
+    hdr[2] = sizeof(int_t);
+    hdr[3] = sizeof(float);
+    hdr[4] = m;
+    hdr[5] = n;
+    hdr[6] = nsupers;
+    hdr[7] = grid->nprow;
+    hdr[8] = grid->npcol;
+    hdr[9] = ScalePermstruct->DiagScale;
+    hdr[10] = LUstruct->Llu->inv || LUstruct->Llu->inv_pending;
+    hdr[11] = LUstruct->Llu->inv_minsize;
+    hdr[12] = LUstruct->Llu->inv_maxsize;
+
+    /* Global section, written by process 0; the others only count it. */
+    lu_io_init(&io, fh, 0, iam != 0);
+    lu_io_put(&io, hdr, sizeof(hdr));
+    PUT_INT(&io, LUstruct->etree, n);
+    PUT_INT(&io, Glu_persist->xsup, nsupers + 1);
+    PUT_INT(&io, Glu_persist->supno, n);
+    PUT_INT(&io, ScalePermstruct->perm_r, m);
+    PUT_INT(&io, ScalePermstruct->perm_c, n);
+    if ( ScalePermstruct->DiagScale == ROW || ScalePermstruct->DiagScale == BOTH )
+	PUT_VAL(&io, ScalePermstruct->R, m);
+    if ( ScalePermstruct->DiagScale == COL || ScalePermstruct->DiagScale == BOTH )
+	PUT_VAL(&io, ScalePermstruct->C, n);
+    table = io.size;
+    lu_io_finalize(&io);
+
+    /* Local sections: count, then place them one after another. */
+    lu_io_init(&io, fh, 0, 1);
+    sLU_pack(&io, nsupers, LUstruct, grid);
+    mysize = io.size;
+    sect[0] = 0;
+    MPI_Exscan(&mysize, &sect[0], 1, MPI_LONG_LONG, MPI_SUM, grid->comm);
+    if ( iam == 0 ) sect[0] = 0;
+    sect[0] += table + 2 * sizeof(long long) * nprocs;
+    sect[1] = mysize;
+
+    lu_io_init(&io, fh, table + 2 * sizeof(long long) * iam, 0);
+    lu_io_put(&io, sect, sizeof(sect));
+    lu_io_finalize(&io);
+    err = io.err;
+
+    lu_io_init(&io, fh, sect[0], 0);
+    sLU_pack(&io, nsupers, LUstruct, grid);
+    lu_io_finalize(&io);
+    err |= io.err;
+
+    MPI_File_close(&fh);
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_BOR, grid->comm);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psSave_LU()");
+#endif
+    return err ? -1 : 0;
+}
+
+/*! \brief Restore the LU factors saved by psSave_LU().
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Read the factorization from the file "filename" written by
+ *   psSave_LU() on a process grid of the same shape. The routine is
+ *   collective over grid->comm. On return, psgssvx() can be called with
+ *   options->Fact = FACTORED to solve for new right-hand sides, as if
+ *   the matrix had just been factored.
+ *
+ * Arguments
+ * =========
+ *
+ * filename (input) char*
+ *        Name of the file, the same on all processes.
+ *
+ * m, n   (input) int_t
+ *        Dimensions of the factored matrix.
+ *
+ * A      (input/output) SuperMatrix* (local)
+ *        If not NULL, the original matrix in SLU_NR_loc format. On exit,
+ *        it is overwritten by diag(R)*A*diag(C)*Pc^T, as psgssvx() does
+ *        in the factorization, so that it can be passed to psgssvx() with
+ *        options->Fact = FACTORED for iterative refinement.
+ *        Not referenced if NULL, or if an error is returned.
+ *
+ * ScalePermstruct (output) sScalePermstruct_t*
+ *        Must be initialized by sScalePermstructInit(m, n, ...). On exit,
+ *        it contains the scaling and permutations of the factorization;
+ *        R and C are allocated according to DiagScale.
+ *
+ * LUstruct (output) sLUstruct_t*
+ *        Must be initialized by sLUstructInit(n, ...). On exit, it
+ *        contains the distributed factors, to be freed by sDestroy_LU().
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * Return value
+ * ============
+ *   = 0: successful exit
+ *   < 0: the file could not be opened or read (-1), or it was written
+ *        for another matrix size, process grid or integer size (-2).
+ *        In the latter case nothing is allocated.
+ * </pre>
+ */
+int
+psLoad_LU(char *filename, int_t m, int_t n, SuperMatrix *A,
+	  sScalePermstruct_t *ScalePermstruct, sLUstruct_t *LUstruct,
+	  gridinfo_t *grid)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    int_t nsupers;
+    int iam = grid->iam, err;
+    long long hdr[SAVE_LU_HEADER], sect[2];
+    MPI_Offset table;
+    MPI_File fh;
+    lu_io_t io;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter psLoad_LU()");
+#endif
+
+    err = MPI_File_open(grid->comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL,
+			&fh);
+    if ( err != MPI_SUCCESS ) return -1;
+
+    lu_io_init(&io, fh, 0, 0);
+    lu_io_get(&io, hdr, sizeof(hdr));
+    if ( io.err || hdr[0] != SAVE_LU_MAGIC || hdr[1] != SAVE_LU_VERSION ||
+	 hdr[2] != sizeof(int_t) || hdr[3] != sizeof(float) ||
+	 hdr[4] != m || hdr[5] != n ||
+	 hdr[7] != grid->nprow || hdr[8] != grid->npcol ) {
+	err = io.err ? -1 : -2;
+	lu_io_finalize(&io);
+	MPI_File_close(&fh);
+	return err;
+    }
+    nsupers = hdr[6];
+    ScalePermstruct->DiagScale = (DiagScale_t) hdr[9];
+    LUstruct->Llu->inv = 0;
+    LUstruct->Llu->inv_pending = hdr[10];
+    LUstruct->Llu->inv_minsize = hdr[11];
+    LUstruct->Llu->inv_maxsize = hdr[12];
+    LUstruct->dt = 's';
+
+    GET_INT(&io, LUstruct->etree, n);
+    if ( !(Glu_persist->xsup = intMalloc_dist(n+1)) )
+	ABORT("Malloc fails for xsup[].");
+    GET_INT(&io, Glu_persist->xsup, nsupers + 1);
+    if ( !(Glu_persist->supno = intMalloc_dist(n)) )
+	ABORT("Malloc fails for supno[].");
+    GET_INT(&io, Glu_persist->supno, n);
+    GET_INT(&io, ScalePermstruct->perm_r, m);
+    GET_INT(&io, ScalePermstruct->perm_c, n);
+    if ( ScalePermstruct->DiagScale == ROW || ScalePermstruct->DiagScale == BOTH ) {
+	if ( !(ScalePermstruct->R = floatMalloc_dist(m)) )
+	    ABORT("Malloc fails for R[].");
+	GET_VAL(&io, ScalePermstruct->R, m);
+    }
+    if ( ScalePermstruct->DiagScale == COL || ScalePermstruct->DiagScale == BOTH ) {
+	if ( !(ScalePermstruct->C = floatMalloc_dist(n)) )
+	    ABORT("Malloc fails for C[].");
+	GET_VAL(&io, ScalePermstruct->C, n);
+    }
+    table = io.off + io.pos;
+    lu_io_finalize(&io);
+
+    lu_io_init(&io, fh, table + 2 * sizeof(long long) * iam, 0);
+    lu_io_get(&io, sect, sizeof(sect));
+    err = io.err;
+    lu_io_finalize(&io);
+
+    lu_io_init(&io, fh, sect[0], 0);
+    sLU_unpack(&io, nsupers, LUstruct, grid);
+    err |= io.err;
+    lu_io_finalize(&io);
+
+    MPI_File_close(&fh);
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_BOR, grid->comm);
+
+    if ( A && !err ) {
+	/* Transform A the same way as in the factorization. */
+	NRformat_loc *Astore = (NRformat_loc *) A->Store;
+	float *a = (float *) Astore->nzval, *R = ScalePermstruct->R;
+	float *C = ScalePermstruct->C;
+	int_t *rowptr = Astore->rowptr, *colind = Astore->colind;
+	int_t *perm_c = ScalePermstruct->perm_c;
+	int_t i, j, irow = Astore->fst_row;
+	DiagScale_t DiagScale = ScalePermstruct->DiagScale;
+
+	for (j = 0; j < Astore->m_loc; ++j, ++irow) {
+	    for (i = rowptr[j]; i < rowptr[j+1]; ++i) {
+		if ( DiagScale == ROW || DiagScale == BOTH ) a[i] *= R[irow];
+		if ( DiagScale == COL || DiagScale == BOTH ) a[i] *= C[colind[i]];
+		colind[i] = perm_c[colind[i]];
+	    }
+	}
+    }
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psLoad_LU()");
+#endif
+    return err ? -1 : 0;
+}
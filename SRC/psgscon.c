@@ -0,0 +1,284 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Estimates the reciprocal condition number with the LU factors
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_sdefs.h"
+
+#define CON_NCOL   4   /* columns of the block estimator */
+#define CON_ITMAX  5   /* iterations of the block estimator */
+
+/* Solve op(A1) * W = W in place for ncol columns. psgstrs() returns the
+   rows of W permuted by Q = Pc*Pr, which psgstrs_trans() expects: the
+   two are the exact transposes of each other as operators on the local
+   rows, and the 1-norm of either is that of inv(A1). */
+static void
+scon_solve(int fwd, int_t n, sLUstruct_t *LUstruct,
+	   sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	   float *W, int_t m_loc, int_t fst_row, int ncol,
+	   sSOLVEstruct_t *SOLVEstruct, SuperLUStat_t *stat, int *info)
+{
+    if ( !fwd )
+	psgstrs_trans(n, LUstruct, ScalePermstruct, grid, W, m_loc,
+		      fst_row, m_loc, ncol, SOLVEstruct, stat, info);
+    else
+	psgstrs(n, LUstruct, ScalePermstruct, grid, W, m_loc,
+		fst_row, m_loc, ncol, SOLVEstruct, stat, info);
+}
+
+/* A random sign of row i of column j, the same for any process grid. */
+static double scon_sign(int_t i, int j, int it)
+{
+    unsigned long long h = (unsigned long long) i * 2654435761ULL
+	                   + (unsigned long long) (j + 1) * 40503ULL + it;
+    h ^= h >> 13;
+    h *= 0x9E3779B97F4A7C15ULL;
+    return (h >> 40) & 1 ? 1.0 : -1.0;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSCON estimates the reciprocal of the condition number of the matrix
+ * A1 = Pc*Pr*diag(R)*A*diag(C)*Pc^T factored by PSGSTRF, in the 1-norm
+ * or the infinity-norm:
+ *     rcond = 1 / ( norm(A1) * norm(inv(A1)) ).
+ *
+ * norm(inv(A1)) is estimated by the block 1-norm estimator of Higham and
+ * Tisseur (SIAM J. Matrix Anal. Appl. 21, 2000) with CON_NCOL columns,
+ * each iteration of which is one solve with A1 and one with A1^T, for
+ * CON_NCOL right-hand sides at once. At most CON_ITMAX iterations are
+ * done; two or three usually suffice. The estimate is a lower bound,
+ * almost always within a factor of 3 of the exact norm.
+ *
+ * Arguments
+ * =========
+ *
+ * norm   (input) char*
+ *        = '1' or 'O': the 1-norm condition number;
+ *        = 'I':        the infinity-norm condition number.
+ *
+ * n      (input) int_t
+ *        The order of A.
+ *
+ * anorm  (input) float
+ *        The norm of A1, in the same norm, e.g. from PSLANGS.
+ *
+ * LUstruct, ScalePermstruct, grid (input)
+ *        The factors, permutations and process grid, as for PSGSTRS.
+ *
+ * m_loc, fst_row (input) int_t
+ *        The local rows of the distributed vectors, as for PSGSTRS.
+ *
+ * SOLVEstruct (input) sSOLVEstruct_t*
+ *        The solve structures set up by sSolveInit(), for any nrhs.
+ *
+ * rcond  (output) float*
+ *        The estimate of the reciprocal condition number; 0 if A1 is
+ *        singular to working precision.
+ *
+ * stat   (output) SuperLUStat_t*
+ *        stat->utime[RCOND] is set; the solve statistics are those of
+ *        the last solve of the estimator.
+ *
+ * info   (output) int*
+ *        = 0: successful exit
+ *        < 0: if info = -i, the i-th argument had an illegal value
+ * </pre>
+ */
+void
+psgscon(char *norm, int_t n, float anorm, sLUstruct_t *LUstruct,
+	sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	int_t m_loc, int_t fst_row, sSOLVEstruct_t *SOLVEstruct,
+	float *rcond, SuperLUStat_t *stat, int *info)
+{
+    float *W, *Sold;
+    double ainvnm, est, est_old, v;
+    double sum[CON_NCOL], dots[2 * CON_NCOL * CON_NCOL];
+    double best[2 * CON_NCOL], *all;
+    int_t *hist, *out_rows, i, gi, ind[CON_NCOL], ind_best, nhist;
+    int   fwd, t, it, j, l, p, jbest, nall, procs, parallel;
+    double t0;
+
+    /* Test the input parameters. */
+    *info = 0;
+    fwd = ( *norm == '1' || *norm == 'O' );
+    if ( !fwd && *norm != 'I' ) *info = -1;
+    else if ( n < 0 ) *info = -2;
+    else if ( anorm < 0.0 ) *info = -3;
+    if ( *info ) {
+	pxerr_dist("PSGSCON", grid, -*info);
+	return;
+    }
+
+    /* Quick return if possible. */
+    *rcond = 0.0;
+    if ( n == 0 ) {
+	*rcond = 1.0;
+	return;
+    } else if ( anorm == 0.0 ) return;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter psgscon()");
+#endif
+
+    t0 = SuperLU_timer_();
+    t = SUPERLU_MIN(CON_NCOL, n);
+    procs = grid->nprow * grid->npcol;
+    if ( !(W = floatMalloc_dist(2 * t * SUPERLU_MAX(m_loc, 1))) )
+	ABORT("Malloc fails for W[]");
+    Sold = W + t * SUPERLU_MAX(m_loc, 1);
+    if ( !(all = (double *) SUPERLU_MALLOC(2 * t * procs * sizeof(double))) )
+	ABORT("Malloc fails for all[]");
+    if ( !(hist = intMalloc_dist(t * CON_ITMAX)) )
+	ABORT("Malloc fails for hist[]");
+    nhist = 0;
+
+    /* All the rows of the solution are needed. */
+    out_rows = SOLVEstruct->out_rows;
+    SOLVEstruct->out_rows = NULL;
+
+    /* X = [ones(n,1), random +-1] / n. */
+    for (j = 0; j < t; ++j)
+	for (i = 0; i < m_loc; ++i)
+	    W[i + j*m_loc] = ( j ? scon_sign(fst_row + i, j, 0) : 1.0 ) / n;
+    for (i = 0; i < t * m_loc; ++i) Sold[i] = 0.0;
+    for (j = 0; j < t; ++j) ind[j] = EMPTY;
+    ind_best = EMPTY;
+    est_old = 0.0;
+
+    for (it = 1; it <= CON_ITMAX; ++it) {
+	/* Y = inv(A1) * X; est = max_j norm(Y(:,j), 1). */
+	scon_solve(fwd, n, LUstruct, ScalePermstruct, grid, W, m_loc,
+		   fst_row, t, SOLVEstruct, stat, info);
+	for (j = 0; j < t; ++j) {
+	    for (i = 0, v = 0.0; i < m_loc; ++i) v += fabs(W[i + j*m_loc]);
+	    sum[j] = v;
+	}
+	MPI_Allreduce(MPI_IN_PLACE, sum, t, MPI_DOUBLE, MPI_SUM, grid->comm);
+	for (j = 1, jbest = 0; j < t; ++j) if ( sum[j] > sum[jbest] ) jbest = j;
+	est = sum[jbest];
+	if ( it >= 2 && est <= est_old ) {
+	    est = est_old; /* no progress */
+	    break;
+	}
+	est_old = est;
+	if ( it >= 2 ) ind_best = ind[jbest];
+	if ( it == CON_ITMAX ) break;
+
+	/* S = sign(Y). */
+	for (i = 0; i < t * m_loc; ++i) W[i] = W[i] >= 0.0 ? 1.0 : -1.0;
+
+	/* Stop if every column of S is parallel to one of S_old; resample
+	   the columns parallel to a column of S_old or to a previous one. */
+	for (j = 0; j < t; ++j)
+	    for (l = 0; l < t; ++l) {
+		double d0 = 0.0, d1 = 0.0;
+		for (i = 0; i < m_loc; ++i) {
+		    d0 += W[i + j*m_loc] * Sold[i + l*m_loc];
+		    d1 += W[i + j*m_loc] * W[i + l*m_loc];
+		}
+		dots[j*t + l] = ( it >= 2 ) ? d0 : 0.0;
+		dots[t*t + j*t + l] = d1;
+	    }
+	MPI_Allreduce(MPI_IN_PLACE, dots, 2*t*t, MPI_DOUBLE, MPI_SUM,
+		      grid->comm);
+	for (j = 0, parallel = 0; j < t; ++j) {
+	    int par = 0;
+	    for (l = 0; l < t; ++l) if ( fabs(dots[j*t + l]) == n ) par = 1;
+	    if ( par ) ++parallel;
+	    for (l = 0; l < j; ++l) if ( fabs(dots[t*t + j*t + l]) == n ) par = 1;
+	    if ( par )
+		for (i = 0; i < m_loc; ++i)
+		    W[i + j*m_loc] = scon_sign(fst_row + i, j, it);
+	}
+	if ( parallel == t ) break;
+	for (i = 0; i < t * m_loc; ++i) Sold[i] = W[i];
+
+	/* Z = inv(A1)^T * S; h(i) = max_j abs(Z(i,j)). */
+	scon_solve(!fwd, n, LUstruct, ScalePermstruct, grid, W, m_loc,
+		   fst_row, t, SOLVEstruct, stat, info);
+	for (i = 0; i < m_loc; ++i) {
+	    for (j = 1, v = fabs(W[i]); j < t; ++j)
+		v = SUPERLU_MAX(v, fabs(W[i + j*m_loc]));
+	    W[i] = v;
+	}
+
+	/* Stop if the largest h(i) is the one of the best unit vector. */
+	for (i = 0, v = 0.0; i < m_loc; ++i) v = SUPERLU_MAX(v, W[i]);
+	MPI_Allreduce(MPI_IN_PLACE, &v, 1, MPI_DOUBLE, MPI_MAX, grid->comm);
+	sum[0] = 0.0;
+	if ( ind_best >= fst_row && ind_best < fst_row + m_loc )
+	    sum[0] = W[ind_best - fst_row];
+	MPI_Allreduce(MPI_IN_PLACE, sum, 1, MPI_DOUBLE, MPI_MAX, grid->comm);
+	if ( it >= 2 && sum[0] == v ) break;
+
+	/* The t largest h(i) not used yet, local then global. */
+	for (j = 0; j < t; ++j) best[2*j] = -1.0, best[2*j+1] = -1.0;
+	for (i = 0; i < m_loc; ++i) {
+	    gi = fst_row + i;
+	    for (l = 0; l < nhist && hist[l] != gi; ++l) ;
+	    if ( l < nhist || W[i] <= best[2*(t-1)] ) continue;
+	    for (j = t - 1; j > 0 && W[i] > best[2*(j-1)]; --j) {
+		best[2*j] = best[2*(j-1)];
+		best[2*j+1] = best[2*(j-1)+1];
+	    }
+	    best[2*j] = W[i];
+	    best[2*j+1] = (double) gi;
+	}
+	MPI_Allgather(best, 2*t, MPI_DOUBLE, all, 2*t, MPI_DOUBLE, grid->comm);
+	nall = t * procs;
+	for (j = 0; j < t; ++j) {
+	    int k = EMPTY;
+	    for (p = 0; p < nall; ++p)
+		if ( all[2*p+1] >= 0.0 && (k == EMPTY || all[2*p] > all[2*k]
+			|| (all[2*p] == all[2*k] && all[2*p+1] < all[2*k+1])) )
+		    k = p;
+	    ind[j] = k == EMPTY ? EMPTY : (int_t) all[2*k+1];
+	    if ( k != EMPTY ) all[2*k+1] = -1.0;
+	}
+	if ( ind[0] == EMPTY ) break; /* all the unit vectors were used */
+
+	/* X = [e_ind(1), ..., e_ind(t)]. */
+	for (i = 0; i < t * m_loc; ++i) W[i] = 0.0;
+	for (j = 0; j < t; ++j) {
+	    if ( ind[j] == EMPTY ) ind[j] = ind[0];
+	    else hist[nhist++] = ind[j];
+	    if ( ind[j] >= fst_row && ind[j] < fst_row + m_loc )
+		W[ind[j] - fst_row + j*m_loc] = 1.0;
+	}
+    }
+
+    ainvnm = est_old;
+    if ( ainvnm != 0.0 ) *rcond = (1.0 / ainvnm) / anorm;
+
+    SOLVEstruct->out_rows = out_rows;
+    SUPERLU_FREE(hist);
+    SUPERLU_FREE(all);
+    SUPERLU_FREE(W);
+    stat->utime[RCOND] = SuperLU_timer_() - t0;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Exit psgscon()");
+#endif
+} /* PSGSCON */
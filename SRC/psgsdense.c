@@ -0,0 +1,393 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Solves small systems with dense LU on every process
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * For n up to a few thousand, the ordering, the symbolic factorization,
+ * the distribution and the message trees of the sparse path cost more
+ * than a dense LU of A. With n <= options->Dense_MaxN, psgssvx() gathers
+ * A on all the processes of the grid in one MPI_Allgatherv and each of
+ * them factors it with partial pivoting, so that a solve gathers B in one
+ * MPI_Allgatherv and needs no other message: each process keeps its own
+ * rows of X. The factors are attached to LUstruct->dense.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_sdefs.h"
+
+#define DENSE_NB 64   /* block size of dense_getrf() */
+#define ITMAX    20   /* as in psgsrfs() */
+
+/* Dense factors of A, replicated on all the processes. Since the rows of A
+   are gathered, at holds A^T in column order and lu = P*L*U is the LU
+   factorization of A^T, stored as sgetrf() does. */
+typedef struct {
+    int    n;
+    float  *lu;
+    int    *ipiv;
+    float  *at;     /* A^T for the refinement, NULL if not kept */
+    int    *cnt;    /* rows of each process */
+    int    *dsp;    /* first row of each process */
+} sDenseLU_t;
+
+#define LU(i,j) lu[(i) + (size_t) (j) * n]
+
+/* Blocked right-looking LU factorization with partial pivoting of the
+   n-by-n lu; returns 0, or j+1 if U(j,j) is zero. */
+static int
+dense_getrf(int n, float *lu, int *ipiv)
+{
+    int i, j, l, p, j0, jb, m2;
+    float t, one = 1.0, mone = -1.0;
+
+    for (j0 = 0; j0 < n; j0 += DENSE_NB) {
+	jb = SUPERLU_MIN(DENSE_NB, n - j0);
+
+	/* The panel, with the row interchanges applied to whole rows. */
+	for (j = j0; j < j0 + jb; ++j) {
+	    for (p = j, i = j + 1; i < n; ++i)
+		if ( fabs(LU(i, j)) > fabs(LU(p, j)) ) p = i;
+	    ipiv[j] = p;
+	    if ( LU(p, j) == 0.0 ) return j + 1;
+	    if ( p != j )
+		for (l = 0; l < n; ++l) {
+		    t = LU(j, l); LU(j, l) = LU(p, l); LU(p, l) = t;
+		}
+	    t = 1.0 / LU(j, j);
+	    for (i = j + 1; i < n; ++i) LU(i, j) *= t;
+	    for (l = j + 1; l < j0 + jb; ++l)
+		for (i = j + 1; i < n; ++i) LU(i, l) -= LU(i, j) * LU(j, l);
+	}
+
+	/* U12 = L11^{-1} * A12 and A22 -= L21 * U12. */
+	if ( (m2 = n - j0 - jb) > 0 ) {
+#if defined (USE_VENDOR_BLAS)
+	    strsm_("L", "L", "N", "U", &jb, &m2, &one, &LU(j0, j0), &n,
+		   &LU(j0, j0 + jb), &n, 1, 1, 1, 1);
+	    sgemm_("N", "N", &m2, &m2, &jb, &mone, &LU(j0 + jb, j0), &n,
+		   &LU(j0, j0 + jb), &n, &one, &LU(j0 + jb, j0 + jb), &n,
+		   1, 1);
+#else
+	    strsm_("L", "L", "N", "U", &jb, &m2, &one, &LU(j0, j0), &n,
+		   &LU(j0, j0 + jb), &n);
+	    sgemm_("N", "N", &m2, &m2, &jb, &mone, &LU(j0 + jb, j0), &n,
+		   &LU(j0, j0 + jb), &n, &one, &LU(j0 + jb, j0 + jb), &n);
+#endif
+	}
+    }
+    return 0;
+}
+
+/* Solve op(A)*X = X with the factors of A^T; X is n-by-nrhs, of leading
+   dimension n. For A*X = B, (P*L*U)^T * X = B is solved. */
+static void
+dense_getrs(trans_t trans, sDenseLU_t *D, int nrhs, float *X)
+{
+    int    n = D->n, *ipiv = D->ipiv, i, j;
+    float  one = 1.0, t, *x;
+
+    if ( trans == NOTRANS ) {
+#if defined (USE_VENDOR_BLAS)
+	strsm_("L", "U", "T", "N", &n, &nrhs, &one, D->lu, &n, X, &n,
+	       1, 1, 1, 1);
+	strsm_("L", "L", "T", "U", &n, &nrhs, &one, D->lu, &n, X, &n,
+	       1, 1, 1, 1);
+#else
+	strsm_("L", "U", "T", "N", &n, &nrhs, &one, D->lu, &n, X, &n);
+	strsm_("L", "L", "T", "U", &n, &nrhs, &one, D->lu, &n, X, &n);
+#endif
+	for (j = 0, x = X; j < nrhs; ++j, x += n)
+	    for (i = n - 1; i >= 0; --i)
+		if ( ipiv[i] != i ) {
+		    t = x[i]; x[i] = x[ipiv[i]]; x[ipiv[i]] = t;
+		}
+    } else {
+	for (j = 0, x = X; j < nrhs; ++j, x += n)
+	    for (i = 0; i < n; ++i)
+		if ( ipiv[i] != i ) {
+		    t = x[i]; x[i] = x[ipiv[i]]; x[ipiv[i]] = t;
+		}
+#if defined (USE_VENDOR_BLAS)
+	strsm_("L", "L", "N", "U", &n, &nrhs, &one, D->lu, &n, X, &n,
+	       1, 1, 1, 1);
+	strsm_("L", "U", "N", "N", &n, &nrhs, &one, D->lu, &n, X, &n,
+	       1, 1, 1, 1);
+#else
+	strsm_("L", "L", "N", "U", &n, &nrhs, &one, D->lu, &n, X, &n);
+	strsm_("L", "U", "N", "N", &n, &nrhs, &one, D->lu, &n, X, &n);
+#endif
+    }
+}
+
+/* Iterative refinement of one solution x of op(A)*x = b, as psgsrfs()
+   does it, with the residual computed from the copy A^T; r and w are
+   work arrays of length n. Returns the number of steps. */
+static int
+dense_gsrfs(trans_t trans, sDenseLU_t *D, float *b, float *x,
+	    float *r, float *w, float *berr)
+{
+    int    n = D->n, i, k, count = 0;
+    float  *at = D->at, eps, safe1, safe2, lstres = 3., s, ax;
+
+    eps = smach_dist("Epsilon");
+    safe1 = (n + 1) * smach_dist("Safe minimum");
+    safe2 = safe1 / eps;
+
+    for (;;) {
+	/* r = b - op(A)*x and w = abs(op(A))*abs(x) + abs(b). */
+	if ( trans == NOTRANS ) {
+	    for (i = 0; i < n; ++i) {
+		ax = 0.0;
+		w[i] = fabs(b[i]);
+		for (k = 0; k < n; ++k) {
+		    ax += at[k + (size_t) i*n] * x[k];
+		    w[i] += fabs(at[k + (size_t) i*n] * x[k]);
+		}
+		r[i] = b[i] - ax;
+	    }
+	} else {
+	    for (i = 0; i < n; ++i) {
+		r[i] = b[i];
+		w[i] = fabs(b[i]);
+	    }
+	    for (k = 0; k < n; ++k)
+		for (i = 0; i < n; ++i) {
+		    r[i] -= at[i + (size_t) k*n] * x[k];
+		    w[i] += fabs(at[i + (size_t) k*n] * x[k]);
+		}
+	}
+
+	s = 0.0;
+	for (i = 0; i < n; ++i) {
+	    if ( w[i] > safe2 ) s = SUPERLU_MAX(s, fabs(r[i]) / w[i]);
+	    else if ( w[i] != 0.0 )
+		s = SUPERLU_MAX(s, (safe1 + fabs(r[i])) / w[i]);
+	}
+	*berr = s;
+	if ( s <= eps || count >= ITMAX || s * 2 > lstres ) break;
+
+	dense_getrs(trans, D, 1, r);
+	for (i = 0; i < n; ++i) x[i] += r[i];
+	lstres = s;
+	++count;
+    }
+    return count;
+}
+
+/*! \brief Free the dense factors attached to LUstruct, if any.
+ */
+void
+sDestroy_DenseLU(sLUstruct_t *LUstruct)
+{
+    sDenseLU_t *D = (sDenseLU_t *) LUstruct->dense;
+
+    if ( !D ) return;
+    SUPERLU_FREE(D->lu);
+    SUPERLU_FREE(D->ipiv);
+    if ( D->at ) SUPERLU_FREE(D->at);
+    SUPERLU_FREE(D->cnt);
+    SUPERLU_FREE(D->dsp);
+    SUPERLU_FREE(D);
+    LUstruct->dense = NULL;
+}
+
+/*! \brief Gather A and factor it on every process.
+ */
+static void
+psgsdense_factor(superlu_dist_options_t *options, SuperMatrix *A,
+		 gridinfo_t *grid, sLUstruct_t *LUstruct, SuperLUStat_t *stat,
+		 int *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int    n = A->ncol, m_loc = Astore->m_loc;
+    int    nprocs = grid->nprow * grid->npcol, p, *rcnt, *rdsp, loc[2];
+    int_t  i, j;
+    float  *a = (float *) Astore->nzval, *rows;
+    double t;
+    sDenseLU_t *D;
+
+    sDestroy_DenseLU(LUstruct);
+    if ( !(D = (sDenseLU_t *) SUPERLU_MALLOC(sizeof(sDenseLU_t))) )
+	ABORT("Malloc fails for D.");
+    D->n = n;
+    if ( !(D->lu = floatMalloc_dist((size_t) n * n)) )
+	ABORT("Malloc fails for D->lu[].");
+    if ( !(D->ipiv = SUPERLU_MALLOC(SUPERLU_MAX(n, 1) * sizeof(int))) )
+	ABORT("Malloc fails for D->ipiv[].");
+    if ( !(D->cnt = SUPERLU_MALLOC(2 * nprocs * sizeof(int))) )
+	ABORT("Malloc fails for D->cnt[].");
+    if ( !(D->dsp = SUPERLU_MALLOC(nprocs * sizeof(int))) )
+	ABORT("Malloc fails for D->dsp[].");
+    D->at = NULL;
+    LUstruct->dense = D;
+
+    /* The row blocks may be in any order over the processes. */
+    loc[0] = m_loc;
+    loc[1] = Astore->fst_row;
+    MPI_Allgather(loc, 2, MPI_INT, D->cnt, 2, MPI_INT, grid->comm);
+    for (p = 0; p < nprocs; ++p) {
+	D->dsp[p] = D->cnt[2*p + 1];
+	D->cnt[p] = D->cnt[2*p];
+    }
+
+    /* Row i of A is column i of A^T. */
+    if ( !(rows = floatCalloc_dist(SUPERLU_MAX((size_t) m_loc * n, 1))) )
+	ABORT("Calloc fails for rows[].");
+    for (i = 0; i < m_loc; ++i)
+	for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j)
+	    rows[Astore->colind[j] + i * n] += a[j];
+    rcnt = SUPERLU_MALLOC(2 * nprocs * sizeof(int));
+    rdsp = rcnt + nprocs;
+    for (p = 0; p < nprocs; ++p) {
+	rcnt[p] = D->cnt[p] * n;
+	rdsp[p] = D->dsp[p] * n;
+    }
+    MPI_Allgatherv(rows, m_loc * n, MPI_FLOAT, D->lu, rcnt, rdsp,
+		   MPI_FLOAT, grid->comm);
+    SUPERLU_FREE(rcnt);
+    SUPERLU_FREE(rows);
+
+    if ( options->IterRefine != NOREFINE ) {
+	if ( !(D->at = floatMalloc_dist((size_t) n * n)) )
+	    ABORT("Malloc fails for D->at[].");
+	memcpy(D->at, D->lu, (size_t) n * n * sizeof(float));
+    }
+
+    t = SuperLU_timer_();
+    *info = dense_getrf(n, D->lu, D->ipiv);
+    stat->utime[FACT] = SuperLU_timer_() - t;
+    stat->ops[FACT] = 2. / 3. * (double) n * n * n;
+}
+
+/*! \brief Gather B, solve and keep the local rows of X in B.
+ *
+ * With Fact = FACTORED, the scaling of ScalePermstruct is applied to B
+ * and X, as psgssvx() does for the sparse factors.
+ */
+static void
+psgsdense_solve(superlu_dist_options_t *options, SuperMatrix *A,
+		sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+		float *B, int ldb, int nrhs, sLUstruct_t *LUstruct,
+		float *berr, SuperLUStat_t *stat)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    sDenseLU_t *D = (sDenseLU_t *) LUstruct->dense;
+    trans_t trans = options->Trans;
+    int    n = D->n, m_loc = Astore->m_loc, fst_row = Astore->fst_row;
+    int    nprocs = grid->nprow * grid->npcol, p, i, j, steps;
+    int    *rcnt, *rdsp;
+    int    refine = (options->IterRefine != NOREFINE && D->at);
+    DiagScale_t scale = options->Fact == FACTORED ? ScalePermstruct->DiagScale
+						   : NOEQUIL;
+    int    rowequ = (scale == ROW || scale == BOTH);
+    int    colequ = (scale == COL || scale == BOTH);
+    float  *rows, *X, *Bg = NULL, *sb, *sx;
+    double t;
+
+    /* B is gathered by rows, then stored by columns in X. */
+    if ( !(rows = floatMalloc_dist(SUPERLU_MAX(m_loc * nrhs, 1))) )
+	ABORT("Malloc fails for rows[].");
+    if ( !(X = floatMalloc_dist(2 * n * nrhs)) )
+	ABORT("Malloc fails for X[].");
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) rows[j + i * nrhs] = B[i + j * ldb];
+    rcnt = SUPERLU_MALLOC(2 * nprocs * sizeof(int));
+    rdsp = rcnt + nprocs;
+    for (p = 0; p < nprocs; ++p) {
+	rcnt[p] = D->cnt[p] * nrhs;
+	rdsp[p] = D->dsp[p] * nrhs;
+    }
+    MPI_Allgatherv(rows, m_loc * nrhs, MPI_FLOAT, X + n * nrhs, rcnt, rdsp,
+		   MPI_FLOAT, grid->comm);
+    SUPERLU_FREE(rcnt);
+    SUPERLU_FREE(rows);
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < n; ++i) X[i + j * n] = X[n * nrhs + j + i * nrhs];
+
+    /* op(A) = diag(sb)^{-1} * op(A1) * diag(sx)^{-1} for the factored
+       A1: B is scaled by sb and X by sx. */
+    if ( trans == NOTRANS ) {
+	sb = rowequ ? ScalePermstruct->R : NULL;
+	sx = colequ ? ScalePermstruct->C : NULL;
+    } else {
+	sb = colequ ? ScalePermstruct->C : NULL;
+	sx = rowequ ? ScalePermstruct->R : NULL;
+    }
+    if ( sb )
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < n; ++i) X[i + j * n] *= sb[i];
+
+    t = SuperLU_timer_();
+    if ( refine ) { /* Keep B for the residuals. */
+	Bg = X + n * nrhs;
+	memcpy(Bg, X, (size_t) n * nrhs * sizeof(float));
+    }
+    dense_getrs(trans, D, nrhs, X);
+    stat->utime[SOLVE] = SuperLU_timer_() - t;
+    stat->ops[SOLVE] = 2. * (double) n * n * nrhs;
+
+    if ( refine ) {
+	t = SuperLU_timer_();
+	if ( !(rows = floatMalloc_dist(2 * n)) )
+	    ABORT("Malloc fails for rows[].");
+	stat->RefineSteps = 0;
+	for (j = 0; j < nrhs; ++j) {
+	    steps = dense_gsrfs(trans, D, Bg + j * n, X + j * n, rows,
+				rows + n, &berr[j]);
+	    stat->RefineSteps = SUPERLU_MAX(stat->RefineSteps, steps);
+	}
+	SUPERLU_FREE(rows);
+	stat->utime[REFINE] = SuperLU_timer_() - t;
+    }
+    if ( sx )
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < n; ++i) X[i + j * n] *= sx[i];
+
+    for (j = 0; j < nrhs; ++j)
+	memcpy(&B[j * ldb], &X[fst_row + j * n], m_loc * sizeof(float));
+    SUPERLU_FREE(X);
+}
+
+/*! \brief Solve a small system with dense LU, see psgssvx().
+ *
+ * <pre>
+ * Called by psgssvx() with Fact != FACTORED and n <= options->Dense_MaxN,
+ * or Fact = FACTORED and factors in LUstruct->dense. No equilibration or
+ * row permutation for a large diagonal is applied; partial pivoting is
+ * done instead. With Fact = FACTORED, the scaling of ScalePermstruct
+ * (DiagScale, R and C) of an A equilibrated by the caller is applied to
+ * B and X. The refinement needs the copy of A kept by a
+ * factorization with IterRefine != NOREFINE. On return, info = i > 0 if
+ * U(i,i) is exactly zero, and B is not solved.
+ * </pre>
+ */
+void
+psgssvx_dense(superlu_dist_options_t *options, SuperMatrix *A,
+	      sScalePermstruct_t *ScalePermstruct, float *B, int ldb,
+	      int nrhs, gridinfo_t *grid, sLUstruct_t *LUstruct,
+	      float *berr, SuperLUStat_t *stat, int *info)
+{
+    *info = 0;
+    if ( options->Fact != FACTORED ) {
+	psgsdense_factor(options, A, grid, LUstruct, stat, info);
+	if ( *info ) return;
+    }
+    if ( nrhs )
+	psgsdense_solve(options, A, ScalePermstruct, grid, B, ldb, nrhs,
+			LUstruct, berr, stat);
+}
@@ -0,0 +1,708 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief  Parallel sparse matrix-vector multiplication
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 2.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * March 15, 2003
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_sdefs.h"
+
+void psgsmv_init
+(
+ SuperMatrix *A,       /* Matrix A permuted by columns (input/output).
+			  The type of A can be:
+			  Stype = SLU_NR_loc; Dtype = SLU_S; Mtype = SLU_GE. */
+ int_t *row_to_proc,   /* Input. Mapping between rows and processes. */
+ gridinfo_t *grid,     /* Input */
+ psgsmv_comm_t *gsmv_comm /* Output. The data structure for communication. */
+ )
+{
+    NRformat_loc *Astore;
+    int iam, p, procs;
+    int *SendCounts, *RecvCounts;
+    int_t i, j, k, l, m, m_loc, n, fst_row, jcol;
+    int_t TotalIndSend, TotalValSend;
+    int_t *colind, *rowptr;
+    int_t *ind_tosend = NULL, *ind_torecv = NULL;
+    int_t *ptr_ind_tosend, *ptr_ind_torecv;
+    int_t *extern_start, *spa, *itemp;
+    double t;
+    float *nzval, *val_tosend = NULL, *val_torecv = NULL;
+    MPI_Request *send_req, *recv_req;
+    MPI_Status status;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter psgsmv_init()");
+#endif
+
+    /* ------------------------------------------------------------
+       INITIALIZATION.
+       ------------------------------------------------------------*/
+    iam = grid->iam;
+    procs = grid->nprow * grid->npcol;
+    Astore = (NRformat_loc *) A->Store;
+    m = A->nrow;
+    n = A->ncol;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    colind = Astore->colind;
+    rowptr = Astore->rowptr;
+    nzval = Astore->nzval;
+    if ( !(SendCounts = SUPERLU_MALLOC(2*procs * sizeof(int))) )
+        ABORT("Malloc fails for SendCounts[]");
+    /*for (i = 0; i < 2*procs; ++i) SendCounts[i] = 0;*/
+    RecvCounts = SendCounts + procs;
+    if ( !(ptr_ind_tosend = intMalloc_dist(2*(procs+1))) )
+        ABORT("Malloc fails for ptr_ind_tosend[]");
+    ptr_ind_torecv = ptr_ind_tosend + procs + 1;
+    if ( !(extern_start = intMalloc_dist(m_loc)) )
+        ABORT("Malloc fails for extern_start[]");
+    for (i = 0; i < m_loc; ++i) extern_start[i] = rowptr[i];
+
+    /* ------------------------------------------------------------
+       COUNT THE NUMBER OF X ENTRIES TO BE SENT TO EACH PROCESS.
+       THIS IS THE UNION OF THE COLUMN INDICES OF MY ROWS.
+       SWAP TO THE BEGINNING THE PART OF A CORRESPONDING TO THE
+       LOCAL PART OF X.
+       THIS ACCOUNTS FOR THE FIRST PASS OF ACCESSING MATRIX A.
+       ------------------------------------------------------------*/
+    if ( !(spa = intCalloc_dist(n)) ) /* Aid in global to local translation */
+        ABORT("Malloc fails for spa[]");
+    for (p = 0; p < procs; ++p) SendCounts[p] = 0;
+    for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+        k = extern_start[i];
+        for (j = rowptr[i]; j < rowptr[i+1]; ++j) {/* Each nonzero in row i */
+	    jcol = colind[j];
+            p = row_to_proc[jcol];
+	    if ( p != iam ) { /* External */
+	        if ( spa[jcol] == 0 ) { /* First time see this index */
+		    ++SendCounts[p];
+		    spa[jcol] = 1;
+                }
+	    } else { /* Swap to beginning the part of A corresponding
+			to the local part of X */
+		l = colind[k];
+		t = nzval[k];
+		colind[k] = jcol;
+		nzval[k] = nzval[j];
+		colind[j] = l;
+		nzval[j] = t;
+		++k;
+	    }
+	}
+	extern_start[i] = k;
+    }
+
+    /* ------------------------------------------------------------
+       LOAD THE X-INDICES TO BE SENT TO THE OTHER PROCESSES.
+       THIS ACCOUNTS FOR THE SECOND PASS OF ACCESSING MATRIX A.
+       ------------------------------------------------------------*/
+    /* Build pointers to ind_tosend[]. */
+    ptr_ind_tosend[0] = 0;
+    for (p = 0, TotalIndSend = 0; p < procs; ++p) {
+        TotalIndSend += SendCounts[p]; /* Total to send. */
+	ptr_ind_tosend[p+1] = ptr_ind_tosend[p] + SendCounts[p];
+    }
+#if 0
+    ptr_ind_tosend[iam] = 0; /* Local part of X */
+#endif
+    if ( TotalIndSend ) {
+        if ( !(ind_tosend = intMalloc_dist(TotalIndSend)) )
+	    ABORT("Malloc fails for ind_tosend[]"); /* Exclude local part of X */
+    }
+
+    /* Build SPA to aid global to local translation. */
+    for (i = 0; i < n; ++i) spa[i] = EMPTY;
+    for (i = 0; i < m_loc; ++i) { /* Loop through each row of A */
+        for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+	    jcol = colind[j];
+	    if ( spa[jcol] == EMPTY ) { /* First time see this index */
+	        p = row_to_proc[jcol];
+		if ( p == iam ) { /* Local */
+		  /*assert(jcol>=fst_row);*/
+		  spa[jcol] = jcol - fst_row; /* Relative position in local X */
+		} else {          /* External */
+		  ind_tosend[ptr_ind_tosend[p]] = jcol; /* Still global */
+		  spa[jcol] = ptr_ind_tosend[p]; /* Position in ind_tosend[] */
+		  ++ptr_ind_tosend[p];
+		}
+	    }
+	}
+    }
+
+    /* ------------------------------------------------------------
+       TRANSFORM THE COLUMN INDICES OF MATRIX A INTO LOCAL INDICES.
+       THIS ACCOUNTS FOR THE THIRD PASS OF ACCESSING MATRIX A.
+       ------------------------------------------------------------*/
+    for (i = 0; i < m_loc; ++i) {
+        for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+	    jcol = colind[j];
+	    colind[j] = spa[jcol];
+	}
+    }
+
+    /* ------------------------------------------------------------
+       COMMUNICATE THE EXTERNAL INDICES OF X.
+       ------------------------------------------------------------*/
+    MPI_Alltoall(SendCounts, 1, MPI_INT, RecvCounts, 1, MPI_INT,
+		 grid->comm);
+
+    /* Build pointers to ind_torecv[]. */
+    ptr_ind_torecv[0] = 0;
+    for (p = 0, TotalValSend = 0; p < procs; ++p) {
+        TotalValSend += RecvCounts[p]; /* Total to receive. */
+	ptr_ind_torecv[p+1] = ptr_ind_torecv[p] + RecvCounts[p];
+    }
+    if ( TotalValSend ) {
+        if ( !(ind_torecv = intMalloc_dist(TotalValSend)) )
+	    ABORT("Malloc fails for ind_torecv[]");
+    }
+
+    if ( !(send_req = (MPI_Request *)
+	   SUPERLU_MALLOC(2*procs *sizeof(MPI_Request))))
+        ABORT("Malloc fails for recv_req[].");
+    recv_req = send_req + procs;
+    for (p = 0; p < procs; ++p) {
+        ptr_ind_tosend[p] -= SendCounts[p]; /* Reset pointer to beginning */
+        if ( SendCounts[p] ) {
+	    MPI_Isend(&ind_tosend[ptr_ind_tosend[p]], SendCounts[p],
+		      mpi_int_t, p, iam, grid->comm, &send_req[p]);
+	}
+	if ( RecvCounts[p] ) {
+	    MPI_Irecv(&ind_torecv[ptr_ind_torecv[p]], RecvCounts[p],
+		      mpi_int_t, p, p, grid->comm, &recv_req[p]);
+	}
+    }
+    for (p = 0; p < procs; ++p) {
+        if ( SendCounts[p] ) MPI_Wait(&send_req[p], &status);
+	if ( RecvCounts[p] ) MPI_Wait(&recv_req[p], &status);
+    }
+
+    /* Allocate storage for the X values to to transferred. */
+    if ( TotalIndSend &&
+         !(val_torecv = floatMalloc_dist(TotalIndSend)) )
+        ABORT("Malloc fails for val_torecv[].");
+    if ( TotalValSend &&
+         !(val_tosend = floatMalloc_dist(TotalValSend)) )
+        ABORT("Malloc fails for val_tosend[].");
+
+    gsmv_comm->extern_start = extern_start;
+    gsmv_comm->ind_tosend = ind_tosend;
+    gsmv_comm->ind_torecv = ind_torecv;
+    gsmv_comm->ptr_ind_tosend = ptr_ind_tosend;
+    gsmv_comm->ptr_ind_torecv = ptr_ind_torecv;
+    gsmv_comm->SendCounts = SendCounts;
+    gsmv_comm->RecvCounts = RecvCounts;
+    gsmv_comm->val_tosend = val_tosend;
+    gsmv_comm->val_torecv = val_torecv;
+    gsmv_comm->TotalIndSend = TotalIndSend;
+    gsmv_comm->TotalValSend = TotalValSend;
+
+    SUPERLU_FREE(spa);
+    SUPERLU_FREE(send_req);
+
+#if ( DEBUGlevel>=2 )
+    PrintInt10("psgsmv_init::rowptr", m_loc+1, rowptr);
+    PrintInt10("psgsmv_init::extern_start", m_loc, extern_start);
+#endif
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psgsmv_init()");
+#endif
+
+} /* PSGSMV_INIT */
+
+/*! \brief Put A in the form set up by psgsmv_init() for a matrix of the
+ * same pattern.
+ *
+ * <pre>
+ * A, permuted by columns as on entry to psgsmv_init(), has the pattern of
+ * the matrix given to it. Its entries are moved in each row the same way,
+ * the local part of x first, and the column indices are replaced by the
+ * local ones kept in colind_gsmv[], so that the communication structure
+ * set up by psgsmv_init() serves for A.
+ * </pre>
+ */
+void
+psgsmv_reuse(SuperMatrix *A, int_t *row_to_proc, int_t *colind_gsmv,
+	     gridinfo_t *grid)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t *rowptr = Astore->rowptr, *colind = Astore->colind;
+    float *a = (float *) Astore->nzval, atemp;
+    int_t i, j, k, nnz_loc = rowptr[Astore->m_loc];
+    int   iam = grid->iam;
+
+    for (i = 0; i < Astore->m_loc; ++i) { /* Loop through each row */
+	k = rowptr[i];
+	for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+	    if ( row_to_proc[colind[j]] == iam ) { /* Local */
+		atemp = a[k]; a[k] = a[j]; a[j] = atemp;
+		++k;
+	    }
+	}
+    }
+    for (i = 0; i < nnz_loc; ++i) colind[i] = colind_gsmv[i];
+}
+
+
+/*
+ * Performs sparse matrix-vector multiplication.
+ */
+void
+psgsmv
+(
+ int_t  abs,               /* Input. Do abs(A)*abs(x). */
+ SuperMatrix *A_internal,  /* Input. Matrix A permuted by columns.
+			      The column indices are translated into
+			      the relative positions in the gathered x-vector.
+			      The type of A can be:
+			      Stype = NR_loc; Dtype = SLU_S; Mtype = GE. */
+ gridinfo_t *grid,         /* Input */
+ psgsmv_comm_t *gsmv_comm, /* Input. The data structure for communication. */
+ float x[],       /* Input. The distributed source vector */
+ float ax[]       /* Output. The distributed destination vector */
+)
+{
+    NRformat_loc *Astore;
+    int iam, procs;
+    int_t i, j, p, m, m_loc, n, fst_row, jcol;
+    int_t *colind, *rowptr;
+    int   *SendCounts, *RecvCounts;
+    int_t *ind_tosend, *ind_torecv, *ptr_ind_tosend, *ptr_ind_torecv;
+    int_t *extern_start, TotalValSend;
+    float *nzval, *val_tosend, *val_torecv;
+    float zero = 0.0, s;
+    MPI_Request *send_req, *recv_req;
+    MPI_Status status;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter psgsmv()");
+#endif
+
+    /* ------------------------------------------------------------
+       INITIALIZATION.
+       ------------------------------------------------------------*/
+    iam = grid->iam;
+    procs = grid->nprow * grid->npcol;
+    Astore = (NRformat_loc *) A_internal->Store;
+    m = A_internal->nrow;
+    n = A_internal->ncol;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    colind = Astore->colind;
+    rowptr = Astore->rowptr;
+    nzval = (float *) Astore->nzval;
+    extern_start = gsmv_comm->extern_start;
+    ind_torecv = gsmv_comm->ind_torecv;
+    ptr_ind_tosend = gsmv_comm->ptr_ind_tosend;
+    ptr_ind_torecv = gsmv_comm->ptr_ind_torecv;
+    SendCounts = gsmv_comm->SendCounts;
+    RecvCounts = gsmv_comm->RecvCounts;
+    val_tosend = (float *) gsmv_comm->val_tosend;
+    val_torecv = (float *) gsmv_comm->val_torecv;
+    TotalValSend = gsmv_comm->TotalValSend;
+
+    /* ------------------------------------------------------------
+       COPY THE X VALUES INTO THE SEND BUFFER.
+       ------------------------------------------------------------*/
+    for (i = 0; i < TotalValSend; ++i) {
+        j = ind_torecv[i] - fst_row; /* Relative index in x[] */
+	val_tosend[i] = x[j];
+    }
+
+    /* ------------------------------------------------------------
+       COMMUNICATE THE X VALUES.
+       ------------------------------------------------------------*/
+    if ( !(send_req = (MPI_Request *)
+	   SUPERLU_MALLOC(2*procs *sizeof(MPI_Request))))
+        ABORT("Malloc fails for recv_req[].");
+    recv_req = send_req + procs;
+    for (p = 0; p < procs; ++p) {
+        if ( RecvCounts[p] ) {
+	    MPI_Isend(&val_tosend[ptr_ind_torecv[p]], RecvCounts[p],
+                      MPI_FLOAT, p, iam,
+                      grid->comm, &send_req[p]);
+	}
+	if ( SendCounts[p] ) {
+	    MPI_Irecv(&val_torecv[ptr_ind_tosend[p]], SendCounts[p],
+                      MPI_FLOAT, p, p,
+                      grid->comm, &recv_req[p]);
+	}
+    }
+
+    /* ------------------------------------------------------------
+       PERFORM THE ACTUAL MULTIPLICATION.
+       ------------------------------------------------------------*/
+    if ( abs ) { /* Perform abs(A)*abs(x) */
+        /* Multiply the local part. */
+#ifdef _OPENMP
+#pragma omp parallel for private(j, jcol, s) schedule(static)
+#endif
+        for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    s = zero;
+	    for (j = rowptr[i]; j < extern_start[i]; ++j) {
+	        jcol = colind[j];
+		s += fabs(nzval[j]) * fabs(x[jcol]);
+	    }
+	    ax[i] = s;
+        }
+
+        for (p = 0; p < procs; ++p) {
+            if ( RecvCounts[p] ) MPI_Wait(&send_req[p], &status);
+	    if ( SendCounts[p] ) MPI_Wait(&recv_req[p], &status);
+        }
+
+        /* Multiply the external part. */
+#ifdef _OPENMP
+#pragma omp parallel for private(j, jcol, s) schedule(static)
+#endif
+        for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    s = ax[i];
+	    for (j = extern_start[i]; j < rowptr[i+1]; ++j) {
+	        jcol = colind[j];
+	        s += fabs(nzval[j]) * fabs(val_torecv[jcol]);
+	    }
+	    ax[i] = s;
+	}
+    } else {
+        /* Multiply the local part. */
+#ifdef _OPENMP
+#pragma omp parallel for private(j, jcol, s) schedule(static)
+#endif
+        for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    s = zero;
+	    for (j = rowptr[i]; j < extern_start[i]; ++j) {
+	        jcol = colind[j];
+		s += nzval[j] * x[jcol];
+	    }
+	    ax[i] = s;
+        }
+
+        for (p = 0; p < procs; ++p) {
+            if ( RecvCounts[p] ) MPI_Wait(&send_req[p], &status);
+	    if ( SendCounts[p] ) MPI_Wait(&recv_req[p], &status);
+        }
+
+        /* Multiply the external part. */
+#ifdef _OPENMP
+#pragma omp parallel for private(j, jcol, s) schedule(static)
+#endif
+        for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    s = ax[i];
+	    for (j = extern_start[i]; j < rowptr[i+1]; ++j) {
+	        jcol = colind[j];
+	        s += nzval[j] * val_torecv[jcol];
+	    }
+	    ax[i] = s;
+	}
+    }
+
+    SUPERLU_FREE(send_req);
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psgsmv()");
+#endif
+
+} /* PSGSMV */
+
+
+/* Number of vectors multiplied together by psgsmv_block(). */
+#define GSMV_TILE 8
+
+/*
+ * Performs the sparse matrix-vector multiplication for a block of nrhs
+ * vectors: ax = A * x and aax = abs(A) * abs(x), as psgsmv() does for one
+ * vector with abs = 0 and 1. The external entries of all the vectors are
+ * exchanged in one message per process pair, with the communication
+ * structure of psgsmv_init(), and the rows of A are read once for every
+ * GSMV_TILE vectors instead of twice per vector. The local entries of
+ * each tile of vectors are interleaved, entry (i, k) of the tile at
+ * i*nk + k, and so are the exchanged ones, at i*nrhs + k, so that the
+ * entries of a row of the tile are contiguous.
+ */
+void
+psgsmv_block
+(
+ SuperMatrix *A_internal,  /* Input. Matrix A permuted by columns, as for
+			      psgsmv(). */
+ gridinfo_t *grid,         /* Input */
+ psgsmv_comm_t *gsmv_comm, /* Input. The data structure for communication. */
+ int    nrhs,              /* Input. Number of vectors. */
+ float x[],               /* Input. The distributed source vectors */
+ int_t  ldx,               /* Input. Leading dimension of x[]. */
+ float ax[],              /* Output. The distributed A * x */
+ float aax[],             /* Output. The distributed abs(A) * abs(x) */
+ int_t  ldax               /* Input. Leading dimension of ax[], aax[]. */
+)
+{
+    NRformat_loc *Astore;
+    int iam, procs, k, k0, nk;
+    int_t i, j, p, m_loc, fst_row, jcol;
+    int_t *colind, *rowptr;
+    int   *SendCounts, *RecvCounts;
+    int_t *ind_torecv, *ptr_ind_tosend, *ptr_ind_torecv;
+    int_t *extern_start, TotalIndSend, TotalValSend;
+    float *nzval, *xb, *val_tosend, *val_torecv, *xj, a;
+    float s[GSMV_TILE], sa[GSMV_TILE];
+    MPI_Request *send_req, *recv_req;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter psgsmv_block()");
+#endif
+
+    /* ------------------------------------------------------------
+       INITIALIZATION.
+       ------------------------------------------------------------*/
+    iam = grid->iam;
+    procs = grid->nprow * grid->npcol;
+    Astore = (NRformat_loc *) A_internal->Store;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    colind = Astore->colind;
+    rowptr = Astore->rowptr;
+    nzval = (float *) Astore->nzval;
+    extern_start = gsmv_comm->extern_start;
+    ind_torecv = gsmv_comm->ind_torecv;
+    ptr_ind_tosend = gsmv_comm->ptr_ind_tosend;
+    ptr_ind_torecv = gsmv_comm->ptr_ind_torecv;
+    SendCounts = gsmv_comm->SendCounts;
+    RecvCounts = gsmv_comm->RecvCounts;
+    TotalIndSend = gsmv_comm->TotalIndSend;
+    TotalValSend = gsmv_comm->TotalValSend;
+
+    /* The local x, by tiles, and the send and receive buffers. */
+    if ( !(xb = floatMalloc_dist(SUPERLU_MAX((size_t) nrhs * (m_loc
+			+ TotalValSend + TotalIndSend), 1))) )
+	ABORT("Malloc fails for xb[].");
+    val_tosend = xb + (size_t) nrhs * m_loc;
+    val_torecv = val_tosend + (size_t) nrhs * TotalValSend;
+
+    for (k0 = 0; k0 < nrhs; k0 += GSMV_TILE) {
+	nk = SUPERLU_MIN(GSMV_TILE, nrhs - k0);
+	xj = &xb[(size_t) k0 * m_loc];
+	for (i = 0; i < m_loc; ++i)
+	    for (k = 0; k < nk; ++k) xj[i*nk + k] = x[i + (k0+k)*ldx];
+    }
+    for (i = 0; i < TotalValSend; ++i) {
+        j = ind_torecv[i] - fst_row; /* Relative index in x[] */
+	for (k = 0; k < nrhs; ++k) val_tosend[i*nrhs + k] = x[j + k*ldx];
+    }
+
+    /* ------------------------------------------------------------
+       COMMUNICATE THE X VALUES.
+       ------------------------------------------------------------*/
+    if ( !(send_req = (MPI_Request *)
+	   SUPERLU_MALLOC(2*procs *sizeof(MPI_Request))))
+        ABORT("Malloc fails for recv_req[].");
+    recv_req = send_req + procs;
+    for (p = 0; p < procs; ++p) {
+	send_req[p] = recv_req[p] = MPI_REQUEST_NULL;
+        if ( RecvCounts[p] ) {
+	    MPI_Isend(&val_tosend[ptr_ind_torecv[p] * nrhs],
+		      RecvCounts[p] * nrhs, MPI_FLOAT, p, iam,
+                      grid->comm, &send_req[p]);
+	}
+	if ( SendCounts[p] ) {
+	    MPI_Irecv(&val_torecv[ptr_ind_tosend[p] * nrhs],
+		      SendCounts[p] * nrhs, MPI_FLOAT, p, p,
+                      grid->comm, &recv_req[p]);
+	}
+    }
+
+    /* ------------------------------------------------------------
+       PERFORM THE ACTUAL MULTIPLICATION, LOCAL PART FIRST.
+       ------------------------------------------------------------*/
+    for (k0 = 0; k0 < nrhs; k0 += GSMV_TILE) {
+	nk = SUPERLU_MIN(GSMV_TILE, nrhs - k0);
+#ifdef _OPENMP
+#pragma omp parallel for private(j, k, jcol, xj, a, s, sa) schedule(static)
+#endif
+	for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    for (k = 0; k < nk; ++k) s[k] = sa[k] = 0.0;
+	    for (j = rowptr[i]; j < extern_start[i]; ++j) {
+		a = nzval[j];
+		jcol = colind[j];
+		xj = &xb[(size_t) k0 * m_loc + jcol*nk];
+		for (k = 0; k < nk; ++k) {
+		    s[k] += a * xj[k];
+		    sa[k] += fabs(a) * fabs(xj[k]);
+		}
+	    }
+	    for (k = 0; k < nk; ++k) {
+		ax[i + (k0+k)*ldax] = s[k];
+		aax[i + (k0+k)*ldax] = sa[k];
+	    }
+	}
+    }
+
+    MPI_Waitall(2*procs, send_req, MPI_STATUSES_IGNORE);
+
+    /* Multiply the external part. */
+    for (k0 = 0; k0 < nrhs; k0 += GSMV_TILE) {
+	nk = SUPERLU_MIN(GSMV_TILE, nrhs - k0);
+#ifdef _OPENMP
+#pragma omp parallel for private(j, k, jcol, xj, a, s, sa) schedule(static)
+#endif
+	for (i = 0; i < m_loc; ++i) { /* Loop through each row */
+	    if ( extern_start[i] == rowptr[i+1] ) continue;
+	    for (k = 0; k < nk; ++k) s[k] = sa[k] = 0.0;
+	    for (j = extern_start[i]; j < rowptr[i+1]; ++j) {
+		a = nzval[j];
+		jcol = colind[j];
+		xj = &val_torecv[jcol*nrhs + k0];
+		for (k = 0; k < nk; ++k) {
+		    s[k] += a * xj[k];
+		    sa[k] += fabs(a) * fabs(xj[k]);
+		}
+	    }
+	    for (k = 0; k < nk; ++k) {
+		ax[i + (k0+k)*ldax] += s[k];
+		aax[i + (k0+k)*ldax] += sa[k];
+	    }
+	}
+    }
+
+    SUPERLU_FREE(send_req);
+    SUPERLU_FREE(xb);
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psgsmv_block()");
+#endif
+
+} /* PSGSMV_BLOCK */
+
+
+/*
+ * Performs the transposed sparse matrix-vector multiplication
+ * atx = A^T * x, with the communication structure set up by psgsmv_init()
+ * for A * x, used in reverse: the products with the external part of x
+ * are summed into val_torecv[] and sent back to the owners of those
+ * entries, which receive them in val_tosend[].
+ */
+void
+psgsmv_trans
+(
+ int_t  abs,               /* Input. Do abs(A)^T*abs(x). */
+ SuperMatrix *A_internal,  /* Input. Matrix A permuted by columns.
+			      The column indices are translated into
+			      the relative positions in the gathered x-vector.
+			      The type of A can be:
+			      Stype = NR_loc; Dtype = SLU_D; Mtype = GE. */
+ gridinfo_t *grid,         /* Input */
+ psgsmv_comm_t *gsmv_comm, /* Input. The data structure for communication. */
+ float x[],       /* Input. The distributed source vector */
+ float atx[]      /* Output. The distributed destination vector */
+)
+{
+    NRformat_loc *Astore;
+    int iam, procs;
+    int_t i, j, p, m_loc, fst_row, jcol;
+    int_t *colind, *rowptr;
+    int   *SendCounts, *RecvCounts;
+    int_t *ind_torecv, *ptr_ind_tosend, *ptr_ind_torecv;
+    int_t *extern_start, TotalIndSend, TotalValSend;
+    float *nzval, *val_tosend, *val_torecv, a, xi;
+    MPI_Request *send_req, *recv_req;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter psgsmv_trans()");
+#endif
+
+    /* ------------------------------------------------------------
+       INITIALIZATION.
+       ------------------------------------------------------------*/
+    iam = grid->iam;
+    procs = grid->nprow * grid->npcol;
+    Astore = (NRformat_loc *) A_internal->Store;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    colind = Astore->colind;
+    rowptr = Astore->rowptr;
+    nzval = (float *) Astore->nzval;
+    extern_start = gsmv_comm->extern_start;
+    ind_torecv = gsmv_comm->ind_torecv;
+    ptr_ind_tosend = gsmv_comm->ptr_ind_tosend;
+    ptr_ind_torecv = gsmv_comm->ptr_ind_torecv;
+    SendCounts = gsmv_comm->SendCounts;
+    RecvCounts = gsmv_comm->RecvCounts;
+    val_tosend = (float *) gsmv_comm->val_tosend;
+    val_torecv = (float *) gsmv_comm->val_torecv;
+    TotalIndSend = gsmv_comm->TotalIndSend;
+    TotalValSend = gsmv_comm->TotalValSend;
+
+    /* ------------------------------------------------------------
+       PERFORM THE MULTIPLICATION, ROW BY ROW OF A.
+       ------------------------------------------------------------*/
+    for (i = 0; i < m_loc; ++i) atx[i] = 0.0;
+    for (i = 0; i < TotalIndSend; ++i) val_torecv[i] = 0.0;
+    for (i = 0; i < m_loc; ++i) {
+	xi = abs ? fabs(x[i]) : x[i];
+	for (j = rowptr[i]; j < rowptr[i+1]; ++j) {
+	    a = abs ? fabs(nzval[j]) : nzval[j];
+	    jcol = colind[j];
+	    if ( j < extern_start[i] ) atx[jcol] += a * xi;
+	    else val_torecv[jcol] += a * xi;
+	}
+    }
+
+    /* ------------------------------------------------------------
+       SEND THE EXTERNAL PRODUCTS TO THEIR OWNERS.
+       ------------------------------------------------------------*/
+    if ( !(send_req = (MPI_Request *)
+	   SUPERLU_MALLOC(2*procs *sizeof(MPI_Request))))
+        ABORT("Malloc fails for recv_req[].");
+    recv_req = send_req + procs;
+    for (p = 0; p < procs; ++p) {
+	send_req[p] = recv_req[p] = MPI_REQUEST_NULL;
+        if ( SendCounts[p] ) {
+	    MPI_Isend(&val_torecv[ptr_ind_tosend[p]], SendCounts[p],
+                      MPI_FLOAT, p, iam,
+                      grid->comm, &send_req[p]);
+	}
+	if ( RecvCounts[p] ) {
+	    MPI_Irecv(&val_tosend[ptr_ind_torecv[p]], RecvCounts[p],
+                      MPI_FLOAT, p, p,
+                      grid->comm, &recv_req[p]);
+	}
+    }
+    MPI_Waitall(2*procs, send_req, MPI_STATUSES_IGNORE);
+
+    for (i = 0; i < TotalValSend; ++i) {
+        j = ind_torecv[i] - fst_row; /* Relative index in atx[] */
+	atx[j] += val_tosend[i];
+    }
+
+    SUPERLU_FREE(send_req);
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psgsmv_trans()");
+#endif
+
+} /* PSGSMV_TRANS */
+
+void psgsmv_finalize(psgsmv_comm_t *gsmv_comm)
+{
+    int_t *it;
+    float *dt;
+    SUPERLU_FREE(gsmv_comm->extern_start);
+    if ( it = gsmv_comm->ind_tosend ) SUPERLU_FREE(it);
+    if ( it = gsmv_comm->ind_torecv ) SUPERLU_FREE(it);
+    SUPERLU_FREE(gsmv_comm->ptr_ind_tosend);
+    SUPERLU_FREE(gsmv_comm->SendCounts);
+    if ( dt = gsmv_comm->val_tosend ) SUPERLU_FREE(dt);
+    if ( dt = gsmv_comm->val_torecv ) SUPERLU_FREE(dt);
+}
+
@@ -0,0 +1,459 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Improves the computed solution to a system of linear equations and provides error bounds and backward error estimates
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 4.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * March 15, 2003
+ *
+ * Last modified:
+ * December 31, 2015
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_sdefs.h"
+
+/*! \brief Multiply by the matrix of the refinement.
+ *
+ * <pre>
+ * Computes Y = op(A1)*X, or Y = abs(op(A1))*abs(X) if abs is nonzero, for
+ * the m_loc-by-nrhs local parts X and Y, where A1 = diag(R)*A*diag(C)*Pc'
+ * is the matrix refined by PSGSRFS. Without LUstruct->matvec the product
+ * uses the distributed A set up by psgsmv_init(). Otherwise A1 is applied
+ * as the product by the original A supplied by the user, between the
+ * permutation by Pc and the scalings by R and C; only m_loc and fst_row of
+ * the distributed A are then accessed.
+ * </pre>
+ */
+void
+psgsrfs_matvec(trans_t trans, int abs, SuperMatrix *A, sLUstruct_t *LUstruct,
+	       sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	       sSOLVEstruct_t *SOLVEstruct, int nrhs, float *X, int_t ldx,
+	       float *Y, int_t ldy)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t m_loc = Astore->m_loc, fst_row = Astore->fst_row;
+    sMatvec_t *matvec = LUstruct->matvec;
+    DiagScale_t DiagScale = ScalePermstruct->DiagScale;
+    int rowequ = ( DiagScale == ROW || DiagScale == BOTH );
+    int colequ = ( DiagScale == COL || DiagScale == BOTH );
+    float *R = ScalePermstruct->R, *C = ScalePermstruct->C, *w, *z;
+    int_t i, j;
+
+    if ( !matvec ) {
+	for (j = 0; j < nrhs; ++j)
+	    if ( trans == NOTRANS )
+		psgsmv(abs, A, grid, SOLVEstruct->gsmv_comm, &X[j*ldx],
+		       &Y[j*ldy]);
+	    else
+		psgsmv_trans(abs, A, grid, SOLVEstruct->gsmv_comm,
+			     &X[j*ldx], &Y[j*ldy]);
+	return;
+    }
+
+    if ( !(w = floatMalloc_dist(SUPERLU_MAX(2 * m_loc * nrhs, 1))) )
+	ABORT("Malloc fails for w[]");
+    z = w + m_loc * nrhs;
+
+    if ( trans == NOTRANS ) {
+	/* Y = diag(R)*A*diag(C)*(Pc'*X) */
+	psPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc,
+			       SOLVEstruct->inv_perm_c, X, ldx, w, m_loc,
+			       nrhs, grid);
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < m_loc; ++i) {
+		if ( abs ) w[i + j*m_loc] = fabs(w[i + j*m_loc]);
+		if ( colequ ) w[i + j*m_loc] *= C[fst_row + i];
+	    }
+	matvec->apply(NOTRANS, abs, nrhs, w, m_loc, Y, ldy, matvec->data);
+	if ( rowequ )
+	    for (j = 0; j < nrhs; ++j)
+		for (i = 0; i < m_loc; ++i) Y[i + j*ldy] *= R[fst_row + i];
+    } else {
+	/* Y = Pc*(diag(C)*A'*(diag(R)*X)) */
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < m_loc; ++i) {
+		w[i + j*m_loc] = abs ? fabs(X[i + j*ldx]) : X[i + j*ldx];
+		if ( rowequ ) w[i + j*m_loc] *= R[fst_row + i];
+	    }
+	matvec->apply(TRANS, abs, nrhs, w, m_loc, z, m_loc, matvec->data);
+	if ( colequ )
+	    for (j = 0; j < nrhs; ++j)
+		for (i = 0; i < m_loc; ++i) z[i + j*m_loc] *= C[fst_row + i];
+	psPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc,
+			       ScalePermstruct->perm_c, z, m_loc, Y, ldy,
+			       nrhs, grid);
+    }
+    SUPERLU_FREE(w);
+}
+
+/* PSGSRFS for op(A) = A (trans = NOTRANS) or op(A) = A^T. */
+static void
+sgsrfs_op(trans_t trans, int_t n, SuperMatrix *A, float anorm,
+	  sLUstruct_t *LUstruct, sScalePermstruct_t *ScalePermstruct,
+	  gridinfo_t *grid, float *B, int_t ldb, float *X, int_t ldx,
+	  int nrhs, sSOLVEstruct_t *SOLVEstruct,
+	  float *berr, SuperLUStat_t *stat, int *info)
+{
+#define ITMAX 20
+
+    float *ax, *R, *T, *dx, *temp, *work, *B_col, *X_col, *lstres, *sloc;
+    int_t *count, *act, i, j, jj, k, lwork, nz;
+    int   iam, nact, stall, block;
+    float eps;
+    float s, safmin, safe1, safe2;
+
+    /* Data structures used by matrix-vector multiply routine. */
+    psgsmv_comm_t *gsmv_comm = SOLVEstruct->gsmv_comm;
+    NRformat_loc *Astore;
+    int_t        m_loc, fst_row;
+    /* Precision of the messages of the next correction solve. */
+    msg_prec_t   prec = SOLVEstruct->refine_msg_prec;
+
+
+    /* Initialization. */
+    Astore = (NRformat_loc *) A->Store;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    iam = grid->iam;
+
+    /* Test the input parameters. */
+    *info = 0;
+    if ( n < 0 ) *info = -1;
+    else if ( A->nrow != A->ncol || A->nrow < 0 || A->Stype != SLU_NR_loc
+	      || A->Dtype != SLU_S || A->Mtype != SLU_GE )
+	*info = -2;
+    else if ( ldb < SUPERLU_MAX(0, m_loc) ) *info = -10;
+    else if ( ldx < SUPERLU_MAX(0, m_loc) ) *info = -12;
+    else if ( nrhs < 0 ) *info = -13;
+    if (*info != 0) {
+	i = -(*info);
+	pxerr_dist("PSGSRFS", grid, i);
+	return;
+    }
+
+    /* Quick return if possible. */
+    if ( n == 0 || nrhs == 0 ) {
+	return;
+    }
+
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter psgsrfs()");
+#endif
+
+    /* For the active X, temp and dx of each RHS (NOTRANS or the product
+       by LUstruct->matvec), or ax, temp and dx of each RHS. */
+    block = ( trans == NOTRANS || LUstruct->matvec );
+    lwork = block ? 3 * nrhs * m_loc : (nrhs + 2) * m_loc;
+    if ( !(work = floatMalloc_dist(SUPERLU_MAX(lwork, 1))) )
+	ABORT("Malloc fails for work[]");
+    ax = work;
+    if ( block ) {
+	temp = ax + nrhs * m_loc;
+	dx = temp + nrhs * m_loc;
+    } else {
+	temp = ax + m_loc;
+	dx = temp + m_loc;
+    }
+    if ( !(count = intMalloc_dist(2 * nrhs)) )
+	ABORT("Malloc fails for count[]");
+    act = count + nrhs;
+    if ( !(lstres = floatMalloc_dist(3 * nrhs)) )
+	ABORT("Malloc fails for lstres[]");
+    sloc = lstres + nrhs;
+
+    /* NZ = maximum number of nonzero elements in each row of A, plus 1 */
+    nz     = A->ncol + 1;
+    eps    = smach_dist("Epsilon");
+    safmin = smach_dist("Safe minimum");
+
+    /* Set SAFE1 essentially to be the underflow threshold times the
+       number of additions in each row. */
+    safe1  = nz * safmin;
+    safe2  = safe1 / eps;
+
+#if ( DEBUGlevel>=1 )
+    if ( !iam ) printf(".. eps = %e\tanorm = %e\tsafe1 = %e\tsafe2 = %e\n",
+		       eps, anorm, safe1, safe2);
+#endif
+
+    /* The right-hand sides are refined together. Each step computes the
+       residuals of those still active, with one block product
+       psgsmv_block() for A if there are several (or two products by
+       LUstruct->matvec), reduces their backward errors in one
+       MPI_Allreduce, and solves for all their corrections, stored in
+       the first nact columns of dx[], in one triangular solve. A step made
+       with reduced precision messages that does not halve the backward
+       error is made again in full precision, as are the next ones. */
+    for (j = 0; j < nrhs; ++j) {
+	count[j] = 0;
+	lstres[j] = 3.;
+	act[j] = j;
+    }
+    nact = nrhs;
+
+    SUPERLU_PROF_BEGIN(PROF_REFINE, EMPTY);
+    while ( nact ) { /* Loop until stopping criterion is satisfied. */
+
+	block = ( (trans == NOTRANS || LUstruct->matvec) && nact > 1 );
+	if ( block ) {
+	    /* A*X and abs(A)*abs(X) of the active X, stored in dx[] and
+	       temp[], by one block product. */
+	    for (jj = 0; jj < nact; ++jj)
+		memcpy(&ax[jj*m_loc], &X[act[jj]*ldx], m_loc * sizeof(float));
+	    if ( LUstruct->matvec ) {
+		psgsrfs_matvec(trans, 0, A, LUstruct, ScalePermstruct, grid,
+			       SOLVEstruct, nact, ax, m_loc, dx, m_loc);
+		psgsrfs_matvec(trans, 1, A, LUstruct, ScalePermstruct, grid,
+			       SOLVEstruct, nact, ax, m_loc, temp, m_loc);
+	    } else
+		psgsmv_block(A, grid, gsmv_comm, nact, ax, m_loc, dx, temp,
+			     m_loc);
+	}
+
+	for (jj = 0; jj < nact; ++jj) {
+	    j = act[jj];
+	    B_col = &B[j*ldb];
+	    X_col = &X[j*ldx];
+	    R = &dx[jj*m_loc];
+
+	    /* Compute residual R = B - op(A) * X,
+	       where op(A) = A, A**T, or A**H, depending on TRANS. */
+	    if ( block ) {
+		T = &temp[jj*m_loc];
+		for (i = 0; i < m_loc; ++i) R[i] = B_col[i] - R[i];
+	    } else {
+		T = temp;
+		psgsrfs_matvec(trans, 0, A, LUstruct, ScalePermstruct, grid,
+			       SOLVEstruct, 1, X_col, ldx, ax, m_loc);
+		for (i = 0; i < m_loc; ++i) R[i] = B_col[i] - ax[i];
+		psgsrfs_matvec(trans, 1, A, LUstruct, ScalePermstruct, grid,
+			       SOLVEstruct, 1, X_col, ldx, T, m_loc);
+	    }
+
+	    /* Compute abs(op(A))*abs(X) + abs(B), stored in T[]. */
+	    for (i = 0; i < m_loc; ++i) T[i] += fabs(B_col[i]);
+
+	    s = 0.0;
+	    for (i = 0; i < m_loc; ++i) {
+		if ( T[i] > safe2 ) {
+		    s = SUPERLU_MAX(s, fabs(R[i]) / T[i]);
+		} else if ( T[i] != 0.0 ) {
+		    /* Adding SAFE1 to the numerator guards against
+		       spuriously zero residuals (underflow). */
+		    s = SUPERLU_MAX(s, (safe1 + fabs(R[i])) / T[i]);
+		}
+		/* If T[i] is exactly 0.0 (computed by PxGSMV), then
+		   we know the true residual also must be exactly 0.0. */
+	    }
+	    sloc[jj] = s;
+	}
+	MPI_Allreduce( sloc, sloc + nrhs, nact, MPI_FLOAT, MPI_MAX, grid->comm );
+
+	for (jj = 0, k = 0, stall = 0; jj < nact; ++jj) {
+	    j = act[jj];
+	    berr[j] = sloc[nrhs + jj];
+#if ( PRNTlevel>= 1 )
+	    if ( !iam )
+		printf("(%2d) .. RHS " IFMT " step " IFMT ": berr[j] = %e\n",
+		       iam, j, count[j], berr[j]);
+#endif
+	    if ( berr[j] > eps && count[j] < ITMAX
+		 && (berr[j] * 2 <= lstres[j] || prec != SLU_MSG_FULL) ) {
+		if ( berr[j] * 2 > lstres[j] ) stall = 1;
+		if ( k < jj )
+		    memcpy(&dx[k*m_loc], &dx[jj*m_loc], m_loc * sizeof(float));
+		act[k++] = j;
+	    }
+	}
+	nact = k;
+	if ( !nact ) break;
+	if ( stall ) prec = SLU_MSG_FULL;
+
+	/* Compute new dx. */
+	SOLVEstruct->msg_prec = prec;
+	if ( trans != NOTRANS )
+	    psgstrs_trans(n, LUstruct, ScalePermstruct, grid,
+			  dx, m_loc, fst_row, m_loc, nact,
+			  SOLVEstruct, stat, info);
+	else
+	psgstrs(n, LUstruct, ScalePermstruct, grid,
+		dx, m_loc, fst_row, m_loc, nact,
+		SOLVEstruct, stat, info);
+
+	SOLVEstruct->msg_prec = SLU_MSG_FULL;
+
+	/* Update solution. */
+	for (jj = 0; jj < nact; ++jj) {
+	    j = act[jj];
+	    X_col = &X[j*ldx];
+	    for (i = 0; i < m_loc; ++i) X_col[i] += dx[jj*m_loc + i];
+	    lstres[j] = berr[j];
+	    ++count[j];
+	}
+    } /* end while */
+    SUPERLU_PROF_END(PROF_REFINE, EMPTY);
+
+    /* Report the largest number of steps over all right-hand sides. */
+    stat->RefineSteps = 0;
+    for (j = 0; j < nrhs; ++j)
+	stat->RefineSteps = SUPERLU_MAX(stat->RefineSteps, count[j]);
+
+    /* Deallocate storage. */
+    SUPERLU_FREE(count);
+    SUPERLU_FREE(lstres);
+    SUPERLU_FREE(work);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psgsrfs()");
+#endif
+
+} /* sgsrfs_op */
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSRFS improves the computed solution to a system of linear
+ * equations and provides error bounds and backward error estimates
+ * for the solution.
+ *
+ * Arguments
+ * =========
+ *
+ * n      (input) int (global)
+ *        The order of the system of linear equations.
+ *
+ * A      (input) SuperMatrix*
+ *	  The original matrix A, or the scaled A if equilibration was done.
+ *        A is also permuted into diag(R)*A*diag(C)*Pc'. The type of A can be:
+ *        Stype = SLU_NR_loc; Dtype = SLU_S; Mtype = SLU_GE.
+ *
+ * anorm  (input) float
+ *        The norm of the original matrix A, or the scaled A if
+ *        equilibration was done.
+ *
+ * LUstruct (input) sLUstruct_t*
+ *        The distributed data structures storing L and U factors.
+ *        The L and U factors are obtained from psgstrf for
+ *        the possibly scaled and permuted matrix A.
+ *        If LUstruct->matvec is not NULL, the products by A are made by
+ *        LUstruct->matvec->apply() with the original matrix, and only
+ *        m_loc and fst_row of A are used (see psgsrfs_matvec()).
+ *        See superlu_sdefs.h for the definition of 'sLUstruct_t'.
+ *
+ * ScalePermstruct (input) sScalePermstruct_t* (global)
+ *         The data structure to store the scaling and permutation vectors
+ *         describing the transformations performed to the matrix A.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh. It contains the MPI communicator, the number
+ *        of process rows (NPROW), the number of process columns (NPCOL),
+ *        and my process rank. It is an input argument to all the
+ *        parallel routines.
+ *        Grid can be initialized by subroutine SUPERLU_GRIDINIT.
+ *        See superlu_defs.h for the definition of 'gridinfo_t'.
+ *
+ * B      (input) float* (local)
+ *        The m_loc-by-NRHS right-hand side matrix of the possibly
+ *        equilibrated system. That is, B may be overwritten by diag(R)*B.
+ *
+ * ldb    (input) int (local)
+ *        Leading dimension of matrix B.
+ *
+ * X      (input/output) float* (local)
+ *        On entry, the solution matrix Y, as computed by PSGSTRS, of the
+ *            transformed system A1*Y = Pc*Pr*B. where
+ *            A1 = Pc*Pr*diag(R)*A*diag(C)*Pc' and Y = Pc*diag(C)^(-1)*X.
+ *        On exit, the improved solution matrix Y.
+ *
+ *        In order to obtain the solution X to the original system,
+ *        Y should be permutated by Pc^T, and premultiplied by diag(C)
+ *        if DiagScale = COL or BOTH.
+ *        This must be done after this routine is called.
+ *
+ * ldx    (input) int (local)
+ *        Leading dimension of matrix X.
+ *
+ * nrhs   (input) int
+ *        Number of right-hand sides.
+ *
+ * SOLVEstruct (output) sSOLVEstruct_t* (global)
+ *        Contains the information for the communication during the
+ *        solution phase.
+ *
+ * berr   (output) float*, dimension (nrhs)
+ *         The componentwise relative backward error of each solution
+ *         vector X(j) (i.e., the smallest relative change in
+ *         any element of A or B that makes X(j) an exact solution).
+ *
+ * stat   (output) SuperLUStat_t*
+ *        Record the statistics about the refinement steps.
+ *        stat->RefineSteps is the largest number of steps taken over
+ *        the right-hand sides; it equals ITMAX if the refinement did
+ *        not converge for some right-hand side.
+ *        See util.h for the definition of SuperLUStat_t.
+ *
+ * info   (output) int*
+ *        = 0: successful exit
+ *        < 0: if info = -i, the i-th argument had an illegal value
+ *
+ * Internal Parameters
+ * ===================
+ *
+ * ITMAX is the maximum number of steps of iterative refinement.
+ * </pre>
+ */
+void
+psgsrfs(int_t n, SuperMatrix *A, float anorm, sLUstruct_t *LUstruct,
+	sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	float *B, int_t ldb, float *X, int_t ldx, int nrhs,
+	sSOLVEstruct_t *SOLVEstruct,
+	float *berr, SuperLUStat_t *stat, int *info)
+{
+    sgsrfs_op(NOTRANS, n, A, anorm, LUstruct, ScalePermstruct, grid,
+	      B, ldb, X, ldx, nrhs, SOLVEstruct, berr, stat, info);
+} /* PSGSRFS */
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSRFS_TRANS is PSGSRFS for the transposed system A^T*X = B:
+ * B is Pc*diag(C)*B, and X is the solution Y computed by PSGSTRS_TRANS,
+ * of A2^T*Y = B with A2 = diag(R)*A*diag(C)*Pc'. The other arguments are
+ * those of PSGSRFS; in particular A is A2, as left by PSGSSVX.
+ *
+ * In order to obtain the solution X to the original system, Y should be
+ * premultiplied by diag(R) if DiagScale = ROW or BOTH.
+ * </pre>
+ */
+void
+psgsrfs_trans(int_t n, SuperMatrix *A, float anorm, sLUstruct_t *LUstruct,
+	      sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	      float *B, int_t ldb, float *X, int_t ldx, int nrhs,
+	      sSOLVEstruct_t *SOLVEstruct,
+	      float *berr, SuperLUStat_t *stat, int *info)
+{
+    sgsrfs_op(TRANS, n, A, anorm, LUstruct, ScalePermstruct, grid,
+	      B, ldb, X, ldx, nrhs, SOLVEstruct, berr, stat, info);
+} /* PSGSRFS_TRANS */
+
@@ -0,0 +1,268 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Improves the computed solution and provies error bounds
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 4.3) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * September 1, 1999
+ *
+ * Last modified:
+ * December 31, 2015  version 4.3
+ * </pre>
+ */
+
+#include "superlu_sdefs.h"
+
+/*! \brief Make the local rows [fst_row, fst_row+m_loc) of the global
+ *         A (SLU_NCP) a distributed matrix, in the form psgsrfs() takes.
+ */
+static void
+screate_rows_loc(SuperMatrix *A, int_t fst_row, int_t m_loc,
+		 SuperMatrix *A_loc)
+{
+    NCPformat *Astore = (NCPformat *) A->Store;
+    float *a = (float *) Astore->nzval, *nzval;
+    int_t  *colbeg = Astore->colbeg, *colend = Astore->colend;
+    int_t  *rowind = Astore->rowind;
+    int_t  *rowptr, *colind, i, irow, j, nnz_loc;
+
+    if ( !(rowptr = intCalloc_dist(m_loc + 1)) )
+	ABORT("Calloc fails for rowptr[]");
+    for (j = 0; j < A->ncol; ++j)
+	for (i = colbeg[j]; i < colend[j]; ++i) {
+	    irow = rowind[i] - fst_row;
+	    if ( irow >= 0 && irow < m_loc ) ++rowptr[irow + 1];
+	}
+    for (i = 0; i < m_loc; ++i) rowptr[i + 1] += rowptr[i];
+    nnz_loc = rowptr[m_loc];
+    if ( !(colind = intMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for colind[]");
+    if ( !(nzval = floatMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for nzval[]");
+    for (j = 0; j < A->ncol; ++j)
+	for (i = colbeg[j]; i < colend[j]; ++i) {
+	    irow = rowind[i] - fst_row;
+	    if ( irow >= 0 && irow < m_loc ) {
+		colind[rowptr[irow]] = j;
+		nzval[rowptr[irow]++] = a[i];
+	    }
+	}
+    for (i = m_loc; i > 0; --i) rowptr[i] = rowptr[i - 1];
+    rowptr[0] = 0;
+
+    sCreate_CompRowLoc_Matrix_dist(A_loc, A->nrow, A->ncol, nnz_loc, m_loc,
+				   fst_row, nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_S, SLU_GE);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * psgsrfs_ABXglobal improves the computed solution to a system of linear
+ * equations and provides error bounds and backward error estimates
+ * for the solution.
+ *
+ * A, B and X are global, but the refinement is that of psgsrfs(): each
+ * process takes a block of rows of A, B and X, the products with A are
+ * made by psgsmv() on these rows and the corrections are solved by
+ * psgstrs() for all the right-hand sides still active at once, so that
+ * a step costs O(nnz(A)/P) flops per process instead of O(n) and the
+ * full vectors are only gathered once, on exit.
+ *
+ * Arguments
+ * =========
+ *
+ * n      (input) int (global)
+ *        The order of the system of linear equations.
+ *
+ * A      (input) SuperMatrix*
+ *	  The original matrix A, or the scaled A if equilibration was done.
+ *        A is also permuted into the form Pc*Pr*A*Pc', where Pr and Pc
+ *        are permutation matrices. The type of A can be:
+ *        Stype = SLU_NCP; Dtype = SLU_S; Mtype = SLU_GE.
+ *
+ *        NOTE: A must reside in all processes when calling this routine.
+ *
+ * anorm  (input) float
+ *        The norm of the original matrix A, or the scaled A if
+ *        equilibration was done.
+ *
+ * LUstruct (input) sLUstruct_t*
+ *        The distributed data structures storing L and U factors.
+ *        The L and U factors are obtained from psgstrf for
+ *        the possibly scaled and permuted matrix A.
+ *        See superlu_sdefs.h for the definition of 'sLUstruct_t'.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh. It contains the MPI communicator, the number
+ *        of process rows (NPROW), the number of process columns (NPCOL),
+ *        and my process rank. It is an input argument to all the
+ *        parallel routines.
+ *        Grid can be initialized by subroutine SUPERLU_GRIDINIT.
+ *        See superlu_sdefs.h for the definition of 'gridinfo_t'.
+ *
+ * B      (input) float* (global)
+ *        The N-by-NRHS right-hand side matrix of the possibly equilibrated
+ *        and row permuted system.
+ *
+ *        NOTE: B must reside on all processes when calling this routine.
+ *
+ * ldb    (input) int (global)
+ *        Leading dimension of matrix B.
+ *
+ * X      (input/output) float* (global)
+ *        On entry, the solution matrix X, as computed by PSGSTRS.
+ *        On exit, the improved solution matrix X.
+ *        If DiagScale = COL or BOTH, X should be premultiplied by diag(C)
+ *        in order to obtain the solution to the original system.
+ *
+ *        NOTE: X must reside on all processes when calling this routine.
+ *
+ * ldx    (input) int (global)
+ *        Leading dimension of matrix X.
+ *
+ * nrhs   (input) int
+ *        Number of right-hand sides.
+ *
+ * berr   (output) float*, dimension (nrhs)
+ *         The componentwise relative backward error of each solution
+ *         vector X(j) (i.e., the smallest relative change in
+ *         any element of A or B that makes X(j) an exact solution).
+ *
+ * stat   (output) SuperLUStat_t*
+ *        Record the statistics about the refinement steps.
+ *        stat->RefineSteps is the largest number of steps taken over
+ *        the right-hand sides.
+ *        See util.h for the definition of SuperLUStat_t.
+ *
+ * info   (output) int*
+ *        = 0: successful exit
+ *        < 0: if info = -i, the i-th argument had an illegal value
+ * </pre>
+ */
+
+void
+psgsrfs_ABXglobal(int_t n, SuperMatrix *A, float anorm, sLUstruct_t *LUstruct,
+		  gridinfo_t *grid, float *B, int_t ldb, float *X, int_t ldx,
+		  int nrhs, float *berr, SuperLUStat_t *stat, int *info)
+{
+    superlu_dist_options_t options;
+    sScalePermstruct_t ScalePermstruct;
+    sSOLVEstruct_t SOLVEstruct;
+    SuperMatrix A_loc;
+    float *b_loc, *x_loc, *work;
+    int_t  *perm, fst_row, m_loc, i, j;
+    int    *counts, *displs, iam, p, procs;
+
+    /* Test the input parameters. */
+    *info = 0;
+    if ( n < 0 ) *info = -1;
+    else if ( A->nrow != A->ncol || A->nrow < 0 ||
+	      A->Stype != SLU_NCP || A->Dtype != SLU_S || A->Mtype != SLU_GE )
+	*info = -2;
+    else if ( ldb < SUPERLU_MAX(0, n) ) *info = -10;
+    else if ( ldx < SUPERLU_MAX(0, n) )	*info = -12;
+    else if ( nrhs < 0 ) *info = -13;
+    if (*info != 0) {
+	i = -(*info);
+	pxerr_dist("psgsrfs_ABXglobal", grid, i);
+	return;
+    }
+
+    /* Quick return if possible. */
+    if ( n == 0 || nrhs == 0 ) {
+	return;
+    }
+
+    /* Initialization. */
+    iam = grid->iam;
+    procs = grid->nprow * grid->npcol;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter psgsrfs_ABXglobal()");
+#endif
+
+    /* Block row distribution: n/procs rows per process, the remainder
+       to the last one. */
+    if ( !(counts = SUPERLU_MALLOC(2 * procs * sizeof(int))) )
+	ABORT("Malloc fails for counts[]");
+    displs = counts + procs;
+    for (p = 0; p < procs; ++p) {
+	displs[p] = p * (n / procs);
+	counts[p] = ( p == procs - 1 ) ? n - displs[p] : n / procs;
+    }
+    fst_row = displs[iam];
+    m_loc = counts[iam];
+    screate_rows_loc(A, fst_row, m_loc, &A_loc);
+
+    /* A, B and X are already in the permuted order of the factors. */
+    if ( !(perm = intMalloc_dist(n)) ) ABORT("Malloc fails for perm[]");
+    for (i = 0; i < n; ++i) perm[i] = i;
+    ScalePermstruct.DiagScale = NOEQUIL;
+    ScalePermstruct.R = ScalePermstruct.C = NULL;
+    ScalePermstruct.perm_r = ScalePermstruct.perm_c = perm;
+
+    set_default_options_dist(&options);
+    sSolveInit(&options, &A_loc, perm, perm, nrhs, LUstruct, grid,
+	       &SOLVEstruct);
+    psgsmv_init(&A_loc, SOLVEstruct.row_to_proc, grid, SOLVEstruct.gsmv_comm);
+    options.RefineInitialized = YES;
+
+    if ( !(work = floatMalloc_dist(SUPERLU_MAX((size_t) n * nrhs,
+					       2 * (size_t) m_loc * nrhs))) )
+	ABORT("Malloc fails for work[]");
+    b_loc = work;
+    x_loc = work + (size_t) m_loc * nrhs;
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) {
+	    b_loc[i + j * m_loc] = B[fst_row + i + j * ldb];
+	    x_loc[i + j * m_loc] = X[fst_row + i + j * ldx];
+	}
+
+    psgsrfs(n, &A_loc, anorm, LUstruct, &ScalePermstruct, grid,
+	    b_loc, SUPERLU_MAX(m_loc, 1), x_loc, SUPERLU_MAX(m_loc, 1), nrhs,
+	    &SOLVEstruct, berr, stat, info);
+
+    /* Gather the refined rows of X onto all processes; the block of
+       process p, m_p-by-nrhs, is at work[f_p * nrhs]. */
+    memmove(&work[(size_t) fst_row * nrhs], x_loc,
+	    (size_t) m_loc * nrhs * sizeof(float));
+    for (p = 0; p < procs; ++p) {
+	counts[p] *= nrhs;
+	displs[p] *= nrhs;
+    }
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, work, counts, displs,
+		   MPI_FLOAT, grid->comm);
+    for (p = 0; p < procs; ++p) {
+	int_t m_p = counts[p] / nrhs, f_p = displs[p] / nrhs;
+	for (j = 0; j < nrhs; ++j)
+	    for (i = 0; i < m_p; ++i)
+		X[f_p + i + j * ldx] = work[displs[p] + i + j * m_p];
+    }
+
+    sSolveFinalize(&options, &SOLVEstruct);
+    Destroy_CompRowLoc_Matrix_dist(&A_loc);
+    SUPERLU_FREE(perm);
+    SUPERLU_FREE(work);
+    SUPERLU_FREE(counts);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psgsrfs_ABXglobal()");
+#endif
+
+} /* PSGSRFS_ABXGLOBAL */
@@ -0,0 +1,298 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Improves the computed solution by FGMRES preconditioned with the LU factors
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_sdefs.h"
+
+#define GMRES_RESTART 30   /* Krylov vectors per cycle */
+#define GMRES_MAXCYCLE 20  /* Restarted cycles per right-hand side */
+
+/* Solve op(M) * z = z in place, with M = L*U. */
+static void
+sgmres_psolve(trans_t trans, int_t n, sLUstruct_t *LUstruct,
+	      sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	      float *z, int_t m_loc, int_t fst_row,
+	      sSOLVEstruct_t *SOLVEstruct, SuperLUStat_t *stat, int *info)
+{
+    if ( trans != NOTRANS )
+	psgstrs_trans(n, LUstruct, ScalePermstruct, grid,
+		      z, m_loc, fst_row, m_loc, 1, SOLVEstruct, stat, info);
+    else
+	psgstrs(n, LUstruct, ScalePermstruct, grid,
+		z, m_loc, fst_row, m_loc, 1, SOLVEstruct, stat, info);
+}
+
+/* Compute R = B - op(A) * X and temp = abs(op(A))*abs(X) + abs(B), and
+   return the componentwise backward error max(abs(R) / temp), as in
+   psgsrfs(). */
+static float
+sgmres_berr(trans_t trans, SuperMatrix *A, sLUstruct_t *LUstruct,
+	    sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	    sSOLVEstruct_t *SOLVEstruct, int_t m_loc, float *B_col,
+	    float *X_col, float *R, float *temp, float safe1, float safe2)
+{
+    float s = 0.0, berr;
+    int_t i;
+
+    psgsrfs_matvec(trans, 0, A, LUstruct, ScalePermstruct, grid,
+		   SOLVEstruct, 1, X_col, m_loc, R, m_loc);
+    for (i = 0; i < m_loc; ++i) R[i] = B_col[i] - R[i];
+
+    psgsrfs_matvec(trans, 1, A, LUstruct, ScalePermstruct, grid,
+		   SOLVEstruct, 1, X_col, m_loc, temp, m_loc);
+    for (i = 0; i < m_loc; ++i) temp[i] += fabs(B_col[i]);
+
+    for (i = 0; i < m_loc; ++i) {
+	if ( temp[i] > safe2 ) {
+	    s = SUPERLU_MAX(s, fabs(R[i]) / temp[i]);
+	} else if ( temp[i] != 0.0 ) {
+	    s = SUPERLU_MAX(s, (safe1 + fabs(R[i])) / temp[i]);
+	}
+    }
+    MPI_Allreduce( &s, &berr, 1, MPI_FLOAT, MPI_MAX, grid->comm );
+    return berr;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSRFS_GMRES improves the computed solution to a system of linear
+ * equations op(A) * X = B by the flexible GMRES method, restarted every
+ * GMRES_RESTART steps, with the LU factors computed by PSGSTRF as a
+ * right preconditioner. This is selected by options->IterRefine =
+ * SLU_GMRES.
+ *
+ * Each cycle starts from the residual of the current solution, and ends
+ * by adding the correction of smallest residual in the Krylov space of
+ * op(A) * inv(LU). The iteration stops, as in PSGSRFS, when the
+ * componentwise backward error is at most the machine precision or did
+ * not decrease by a factor of 2 over the last cycle. It converges when
+ * the factors are only approximate, e.g. with a block low-rank
+ * tolerance BLR_Tol > 0 or with perturbed pivots, in cases where the classical refinement of PSGSRFS stagnates or diverges.
+ *
+ * The matrix-vector products use PSGSMV, or LUstruct->matvec if set (see
+ * psgsrfs_matvec()), and the inner products one
+ * MPI_Allreduce per Gram-Schmidt pass on grid->comm.
+ *
+ * Arguments
+ * =========
+ *
+ * trans  (input) trans_t
+ *        = NOTRANS: solve A * X = B;
+ *        = TRANS:   solve A**T * X = B.
+ *
+ * n, ..., info: see psgsrfs().
+ *
+ * stat->RefineSteps is set to the largest number of preconditioned
+ * steps over all right-hand sides.
+ * </pre>
+ */
+void
+psgsrfs_gmres(trans_t trans, int_t n, SuperMatrix *A, float anorm,
+	      sLUstruct_t *LUstruct, sScalePermstruct_t *ScalePermstruct,
+	      gridinfo_t *grid, float *B, int_t ldb, float *X, int_t ldx,
+	      int nrhs, sSOLVEstruct_t *SOLVEstruct,
+	      float *berr, SuperLUStat_t *stat, int *info)
+{
+    float H[(GMRES_RESTART+1) * GMRES_RESTART];
+    float cs[GMRES_RESTART], sn[GMRES_RESTART], g[GMRES_RESTART+1];
+    float h[GMRES_RESTART+1], hloc[GMRES_RESTART+1];
+    float *V, *Z, *temp, *work, *B_col, *X_col, *v, *w;
+    float eps, lstres, safmin, safe1, safe2, beta, tol, r, t;
+    float nrm[2], nrm_loc[2];
+    int_t count, cycle, i, j, nz;
+    int   k, l, pass;
+    const int m = GMRES_RESTART, ldh = GMRES_RESTART + 1;
+
+    NRformat_loc *Astore;
+    int_t        m_loc, fst_row;
+
+    /* Initialization. */
+    Astore = (NRformat_loc *) A->Store;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+
+    /* Test the input parameters. */
+    *info = 0;
+    if ( n < 0 ) *info = -2;
+    else if ( A->nrow != A->ncol || A->nrow < 0 || A->Stype != SLU_NR_loc
+	      || A->Dtype != SLU_S || A->Mtype != SLU_GE )
+	*info = -3;
+    else if ( ldb < SUPERLU_MAX(0, m_loc) ) *info = -11;
+    else if ( ldx < SUPERLU_MAX(0, m_loc) ) *info = -13;
+    else if ( nrhs < 0 ) *info = -14;
+    if (*info != 0) {
+	i = -(*info);
+	pxerr_dist("PSGSRFS_GMRES", grid, i);
+	return;
+    }
+
+    /* Quick return if possible. */
+    if ( n == 0 || nrhs == 0 ) {
+	return;
+    }
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter psgsrfs_gmres()");
+#endif
+
+    /* V = [v_0, ..., v_m], Z = [z_0, ..., z_{m-1}] and temp. */
+    if ( !(work = floatMalloc_dist((2 * m + 2) * SUPERLU_MAX(m_loc, 1))) )
+	ABORT("Malloc fails for work[]");
+    V = work;
+    Z = V + (m + 1) * m_loc;
+    temp = Z + m * m_loc;
+
+    nz     = A->ncol + 1;
+    eps    = smach_dist("Epsilon");
+    safmin = smach_dist("Safe minimum");
+    safe1  = nz * safmin;
+    safe2  = safe1 / eps;
+
+    /* Do for each right-hand side ... */
+    stat->RefineSteps = 0;
+    for (j = 0; j < nrhs; ++j) {
+	count = 0;
+	lstres = 3.;
+	B_col = &B[j*ldb];
+	X_col = &X[j*ldx];
+
+	for (cycle = 0; ; ++cycle) {
+	    /* v_0 = B - op(A) * X. */
+	    berr[j] = sgmres_berr(trans, A, LUstruct, ScalePermstruct, grid,
+				  SOLVEstruct, m_loc, B_col, X_col, V, temp,
+				  safe1, safe2);
+#if ( PRNTlevel>= 1 )
+	    if ( !grid->iam )
+		printf(".. GMRES cycle " IFMT ": berr[j] = %e\n", cycle, berr[j]);
+#endif
+	    if ( !(berr[j] > eps && berr[j] * 2 <= lstres
+		   && cycle < GMRES_MAXCYCLE) ) break;
+	    lstres = berr[j];
+
+	    /* Stop the cycle when the residual is at the rounding level of
+	       op(A)*X and B, in the 2-norm. */
+	    nrm_loc[0] = nrm_loc[1] = 0.0;
+	    for (i = 0; i < m_loc; ++i) {
+		nrm_loc[0] += V[i] * V[i];
+		nrm_loc[1] += temp[i] * temp[i];
+	    }
+	    MPI_Allreduce( nrm_loc, nrm, 2, MPI_FLOAT, MPI_SUM, grid->comm );
+	    beta = sqrt(nrm[0]);
+	    tol = eps * sqrt(nrm[1]);
+	    if ( beta == 0.0 ) break;
+
+	    t = 1.0 / beta;
+	    for (i = 0; i < m_loc; ++i) V[i] *= t;
+	    g[0] = beta;
+
+	    for (k = 0; k < m; ) {
+		v = &V[k * m_loc];
+		w = &V[(k+1) * m_loc];
+
+		/* z_k = inv(LU) * v_k, w = op(A) * z_k. */
+		for (i = 0; i < m_loc; ++i) Z[i + k*m_loc] = v[i];
+		sgmres_psolve(trans, n, LUstruct, ScalePermstruct, grid,
+			      &Z[k*m_loc], m_loc, fst_row, SOLVEstruct,
+			      stat, info);
+		psgsrfs_matvec(trans, 0, A, LUstruct, ScalePermstruct, grid,
+			       SOLVEstruct, 1, &Z[k*m_loc], m_loc, w, m_loc);
+
+		/* Classical Gram-Schmidt with one reorthogonalization. */
+		for (l = 0; l <= k; ++l) H[l + k*ldh] = 0.0;
+		for (pass = 0; pass < 2; ++pass) {
+		    for (l = 0; l <= k; ++l) {
+			t = 0.0;
+			for (i = 0; i < m_loc; ++i) t += V[i + l*m_loc] * w[i];
+			hloc[l] = t;
+		    }
+		    MPI_Allreduce( hloc, h, k+1, MPI_FLOAT, MPI_SUM,
+				   grid->comm );
+		    for (l = 0; l <= k; ++l) {
+			t = h[l];
+			for (i = 0; i < m_loc; ++i) w[i] -= t * V[i + l*m_loc];
+			H[l + k*ldh] += t;
+		    }
+		}
+		t = 0.0;
+		for (i = 0; i < m_loc; ++i) t += w[i] * w[i];
+		MPI_Allreduce( &t, &r, 1, MPI_FLOAT, MPI_SUM, grid->comm );
+		H[k+1 + k*ldh] = sqrt(r);
+		if ( H[k+1 + k*ldh] != 0.0 ) {
+		    t = 1.0 / H[k+1 + k*ldh];
+		    for (i = 0; i < m_loc; ++i) w[i] *= t;
+		}
+
+		/* Apply the previous Givens rotations to column k of H,
+		   and eliminate H(k+1,k). */
+		for (l = 0; l < k; ++l) {
+		    t = cs[l] * H[l + k*ldh] + sn[l] * H[l+1 + k*ldh];
+		    H[l+1 + k*ldh] = -sn[l] * H[l + k*ldh]
+			             + cs[l] * H[l+1 + k*ldh];
+		    H[l + k*ldh] = t;
+		}
+		r = sqrt(H[k + k*ldh] * H[k + k*ldh]
+			 + H[k+1 + k*ldh] * H[k+1 + k*ldh]);
+		if ( r == 0.0 ) { /* op(A) * z_k is 0: restart from X. */
+		    break;
+		}
+		cs[k] = H[k + k*ldh] / r;
+		sn[k] = H[k+1 + k*ldh] / r;
+		t = H[k+1 + k*ldh];
+		H[k + k*ldh] = r;
+		H[k+1 + k*ldh] = 0.0;
+		g[k+1] = -sn[k] * g[k];
+		g[k] = cs[k] * g[k];
+
+		++k;
+		++count;
+		if ( fabs(g[k]) <= tol || t == 0.0 ) break;
+	    }
+
+	    /* Solve the k-by-k triangular system H * y = g, in g[], and
+	       update X = X + Z * y. */
+	    for (l = k - 1; l >= 0; --l) {
+		t = g[l];
+		for (i = l + 1; i < k; ++i) t -= H[l + i*ldh] * g[i];
+		g[l] = t / H[l + l*ldh];
+	    }
+	    for (l = 0; l < k; ++l) {
+		t = g[l];
+		for (i = 0; i < m_loc; ++i) X_col[i] += t * Z[i + l*m_loc];
+	    }
+	} /* for cycle ... */
+
+	/* Report the largest number of steps over all right-hand sides. */
+	stat->RefineSteps = SUPERLU_MAX(stat->RefineSteps, count);
+
+    } /* for j ... */
+
+    /* Deallocate storage. */
+    SUPERLU_FREE(work);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Exit psgsrfs_gmres()");
+#endif
+
+} /* PSGSRFS_GMRES */
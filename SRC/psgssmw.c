@@ -0,0 +1,326 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Solves with a low-rank update of the factored matrix
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * With the Sherman-Morrison-Woodbury formula,
+ *
+ *   (A + U*V^T)^{-1} = A^{-1} - W * C^{-1} * V^T * A^{-1},
+ *
+ * where W = A^{-1}*U and C = I + V^T*W is the k-by-k capacitance matrix,
+ * a solve with A + U*V^T is a solve with the factors of A, one product
+ * with V^T, a k-by-k solve and one product with W.
+ * </pre>
+ */
+
+#include "superlu_sdefs.h"
+
+#define SMW_MAXRANK 32 /* default of sSMWInit() */
+
+/* LU factorization with partial pivoting of the k-by-k matrix C; returns
+   0, or j+1 if U(j,j) is zero. */
+static int
+smw_getrf(int k, float *C, int *ipiv)
+{
+    int i, j, l, p;
+    float t;
+
+    for (j = 0; j < k; ++j) {
+	for (p = j, i = j + 1; i < k; ++i)
+	    if ( fabs(C[i + j*k]) > fabs(C[p + j*k]) ) p = i;
+	ipiv[j] = p;
+	if ( C[p + j*k] == 0.0 ) return j + 1;
+	if ( p != j )
+	    for (l = 0; l < k; ++l) {
+		t = C[j + l*k]; C[j + l*k] = C[p + l*k]; C[p + l*k] = t;
+	    }
+	for (i = j + 1; i < k; ++i) C[i + j*k] /= C[j + j*k];
+	for (l = j + 1; l < k; ++l)
+	    for (i = j + 1; i < k; ++i) C[i + l*k] -= C[i + j*k] * C[j + l*k];
+    }
+    return 0;
+}
+
+/* Solve C*Y = Y with the factors of smw_getrf(), Y of leading dimension k. */
+static void
+smw_getrs(int k, float *C, int *ipiv, int nrhs, float *Y)
+{
+    int i, j, r;
+    float t, *y;
+
+    for (r = 0, y = Y; r < nrhs; ++r, y += k) {
+	for (j = 0; j < k; ++j)
+	    if ( ipiv[j] != j ) {
+		t = y[j]; y[j] = y[ipiv[j]]; y[ipiv[j]] = t;
+	    }
+	for (j = 0; j < k; ++j)
+	    for (i = j + 1; i < k; ++i) y[i] -= C[i + j*k] * y[j];
+	for (j = k - 1; j >= 0; --j) {
+	    y[j] /= C[j + j*k];
+	    for (i = 0; i < j; ++i) y[i] -= C[i + j*k] * y[j];
+	}
+    }
+}
+
+/* Y = V^T * B, k-by-nrhs, summed over the grid; V of m local rows and k
+   columns, B of leading dimension ldb. */
+static void
+smw_vtb(int m, int k, float *V, float *B, int ldb, int nrhs, float *Y,
+	gridinfo_t *grid)
+{
+    int ldv = SUPERLU_MAX(m, 1);
+    float one = 1.0, zero = 0.0;
+
+    if ( m > 0 ) {
+#if defined (USE_VENDOR_BLAS)
+	sgemm_("T", "N", &k, &nrhs, &m, &one, V, &ldv, B, &ldb, &zero,
+	       Y, &k, 1, 1);
+#else
+	sgemm_("T", "N", &k, &nrhs, &m, &one, V, &ldv, B, &ldb, &zero,
+	       Y, &k);
+#endif
+    } else {
+	memset(Y, 0, (size_t) k * nrhs * sizeof(float));
+    }
+    MPI_Allreduce(MPI_IN_PLACE, Y, k * nrhs, MPI_FLOAT, MPI_SUM, grid->comm);
+}
+
+/*! \brief Start an empty update of at most kmax columns.
+ *
+ * <pre>
+ * With kmax <= 0, the limit is the environment variable
+ * SUPERLU_SMW_MAXRANK if set, else 32. Beyond it, each solve costs more
+ * than 4*kmax flops per row on top of the solve with A, and
+ * refactoring A + U*V^T is usually the better deal.
+ * </pre>
+ */
+void
+sSMWInit(int kmax, sSMW_t *smw)
+{
+    char *ttemp;
+
+    if ( kmax <= 0 ) {
+	ttemp = getenv("SUPERLU_SMW_MAXRANK");
+	kmax = ttemp ? atoi(ttemp) : SMW_MAXRANK;
+    }
+    smw->kmax = SUPERLU_MAX(kmax, 1);
+    smw->k = 0;
+    smw->m_loc = 0;
+    smw->W = smw->V = smw->C = NULL;
+    smw->ipiv = NULL;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSSMW_UPDATE adds the rank-k term U*V^T to the low-rank update smw of
+ * the matrix A factored by psgssvx(): W = A^{-1}*U is computed by one
+ * solve with k right-hand sides, and the capacitance matrix
+ * C = I + V^T*W of all the columns so far is formed and factored, the
+ * same on all the processes. psgssmw_solve() then solves with
+ * A + (all the U*V^T so far).
+ *
+ * Arguments
+ * =========
+ *
+ * options (input/output) superlu_dist_options_t*
+ *         The options of the factorization of A; Fact is restored on
+ *         exit. Only Trans = NOTRANS is supported.
+ *
+ * A, ScalePermstruct, grid, LUstruct, SOLVEstruct
+ *         As left by psgssvx() after the factorization of A.
+ *
+ * smw     (input/output) sSMW_t*
+ *         The update so far, started by sSMWInit().
+ *
+ * k       (input) int
+ *         The number of columns of U and V.
+ *
+ * U, V    (input) float*, dimension (ldu, k)
+ *         The local rows of U and V, distributed as the rows of A.
+ *
+ * ldu     (input) int
+ *         The leading dimension of U and V, at least A->Store->m_loc.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         The statistics of the solve with A.
+ *
+ * info    (output) int*
+ *         = 0: successful exit
+ *         < 0: if info = -i, the i-th argument had an illegal value
+ *         = 1: the rank would exceed smw->kmax: nothing is done, and
+ *              A + U*V^T should be factored instead (the update is
+ *              then restarted with sSMWFree() and sSMWInit())
+ *         = 2: C is singular, and so is A + U*V^T; the update is left
+ *              as before the call
+ *         > 2: as for psgssvx(), the solve with A failed.
+ * </pre>
+ */
+void
+psgssmw_update(superlu_dist_options_t *options, SuperMatrix *A,
+	       sScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	       sLUstruct_t *LUstruct, sSOLVEstruct_t *SOLVEstruct,
+	       sSMW_t *smw, int k, float *U, float *V, int ldu,
+	       SuperLUStat_t *stat, int *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int    m = Astore->m_loc, ld = SUPERLU_MAX(m, 1), k0 = smw->k, kt, i, j;
+    float *W, *Vn, *C, *berr;
+    int    *ipiv;
+    fact_t Fact = options->Fact;
+
+    *info = 0;
+    if ( options->Trans != NOTRANS ) *info = -1;
+    else if ( k0 > 0 && m != smw->m_loc ) *info = -2;
+    else if ( k < 0 ) *info = -8;
+    else if ( ldu < m ) *info = -11;
+    if ( *info ) {
+	pxerr_dist("psgssmw_update", grid, -*info);
+	return;
+    }
+    if ( k == 0 ) return;
+    if ( k0 + k > smw->kmax ) {
+	*info = 1;
+	return;
+    }
+    kt = k0 + k;
+
+    /* The columns of W and V so far, then the new ones. */
+    if ( !(W = floatMalloc_dist((size_t) ld * kt))
+	 || !(Vn = floatMalloc_dist((size_t) ld * kt))
+	 || !(C = floatMalloc_dist((size_t) kt * kt))
+	 || !(ipiv = SUPERLU_MALLOC(kt * sizeof(int)))
+	 || !(berr = floatMalloc_dist(k)) )
+	ABORT("Malloc fails for the low-rank update.");
+    if ( k0 ) {
+	memcpy(W, smw->W, (size_t) ld * k0 * sizeof(float));
+	memcpy(Vn, smw->V, (size_t) ld * k0 * sizeof(float));
+    }
+    for (j = 0; j < k; ++j)
+	for (i = 0; i < m; ++i) {
+	    W[i + (k0 + j) * ld] = U[i + j * ldu];
+	    Vn[i + (k0 + j) * ld] = V[i + j * ldu];
+	}
+
+    /* W(:,k0:kt-1) = A^{-1} * U, one solve with k right-hand sides. */
+    options->Fact = FACTORED;
+    psgssvx(options, A, ScalePermstruct, &W[k0 * ld], ld, k, grid, LUstruct,
+	    SOLVEstruct, berr, stat, info);
+    options->Fact = Fact;
+    SUPERLU_FREE(berr);
+    if ( *info ) {
+	*info += 2;
+	goto fail;
+    }
+
+    /* C = I + V^T * W, on all the processes. */
+    smw_vtb(m, kt, Vn, W, ld, kt, C, grid);
+    for (j = 0; j < kt; ++j) C[j + j * kt] += 1.0;
+    if ( smw_getrf(kt, C, ipiv) ) {
+	*info = 2;
+	goto fail;
+    }
+
+    sSMWFree(smw);
+    smw->k = kt;
+    smw->m_loc = m;
+    smw->W = W;
+    smw->V = Vn;
+    smw->C = C;
+    smw->ipiv = ipiv;
+    return;
+
+fail:
+    SUPERLU_FREE(W);
+    SUPERLU_FREE(Vn);
+    SUPERLU_FREE(C);
+    SUPERLU_FREE(ipiv);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSSMW_SOLVE solves (A + U*V^T) * X = B, with the factors of A and the
+ * update smw of psgssmw_update(): X = A^{-1}*B by psgssvx(), then
+ * X = X - W * C^{-1} * (V^T*X). Without update, it is psgssvx() with
+ * Fact = FACTORED.
+ *
+ * The arguments are those of psgssvx() with Fact = FACTORED, and smw.
+ * berr is that of the solve with A (see options->IterRefine), not of
+ * the updated system.
+ * </pre>
+ */
+void
+psgssmw_solve(superlu_dist_options_t *options, SuperMatrix *A,
+	      sScalePermstruct_t *ScalePermstruct, sSMW_t *smw, float *B,
+	      int ldb, int nrhs, gridinfo_t *grid, sLUstruct_t *LUstruct,
+	      sSOLVEstruct_t *SOLVEstruct, float *berr, SuperLUStat_t *stat,
+	      int *info)
+{
+    int    m = ((NRformat_loc *) A->Store)->m_loc, k = smw->k;
+    float *Y, one = 1.0, mone = -1.0;
+    fact_t Fact = options->Fact;
+
+    *info = 0;
+    if ( options->Trans != NOTRANS ) *info = -1;
+    else if ( k > 0 && m != smw->m_loc ) *info = -2;
+    if ( *info ) {
+	pxerr_dist("psgssmw_solve", grid, -*info);
+	return;
+    }
+
+    options->Fact = FACTORED;
+    psgssvx(options, A, ScalePermstruct, B, ldb, nrhs, grid, LUstruct,
+	    SOLVEstruct, berr, stat, info);
+    options->Fact = Fact;
+    if ( *info || k == 0 || nrhs == 0 ) return;
+
+    if ( !(Y = floatMalloc_dist((size_t) k * nrhs)) )
+	ABORT("Malloc fails for Y[].");
+    smw_vtb(m, k, smw->V, B, ldb, nrhs, Y, grid);
+    smw_getrs(k, smw->C, smw->ipiv, nrhs, Y);
+    if ( m > 0 ) {
+	int ld = SUPERLU_MAX(m, 1);
+#if defined (USE_VENDOR_BLAS)
+	sgemm_("N", "N", &m, &nrhs, &k, &mone, smw->W, &ld, Y, &k, &one,
+	       B, &ldb, 1, 1);
+#else
+	sgemm_("N", "N", &m, &nrhs, &k, &mone, smw->W, &ld, Y, &k, &one,
+	       B, &ldb);
+#endif
+    }
+    SUPERLU_FREE(Y);
+}
+
+/*! \brief Free the storage of the update; sSMWInit() starts a new one. */
+void
+sSMWFree(sSMW_t *smw)
+{
+    if ( smw->W ) SUPERLU_FREE(smw->W);
+    if ( smw->V ) SUPERLU_FREE(smw->V);
+    if ( smw->C ) SUPERLU_FREE(smw->C);
+    if ( smw->ipiv ) SUPERLU_FREE(smw->ipiv);
+    smw->W = smw->V = smw->C = NULL;
+    smw->ipiv = NULL;
+    smw->k = 0;
+}
@@ -0,0 +1,2215 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Solves a system of linear equations A*X=B
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * November 1, 2007
+ * October 22, 2012
+ * October  1, 2014
+ * April 5, 2015
+ * December 31, 2015  version 4.3
+ * December 31, 2016  version 5.1.3
+ * April 10, 2018  version 5.3
+ * September 18, 2018  version 6.0
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_sdefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSSVX solves a system of linear equations A*X=B,
+ * by using Gaussian elimination with "static pivoting" to
+ * compute the LU factorization of A.
+ *
+ * Static pivoting is a technique that combines the numerical stability
+ * of partial pivoting with the scalability of Cholesky (no pivoting),
+ * to run accurately and efficiently on large numbers of processors.
+ * See our paper at http://www.nersc.gov/~xiaoye/SuperLU/ for a detailed
+ * description of the parallel algorithms.
+ *
+ * The input matrices A and B are distributed by block rows.
+ * Here is a graphical illustration (0-based indexing):
+ *
+ *                        A                B
+ *               0 ---------------       ------
+ *                   |           |        |  |
+ *                   |           |   P0   |  |
+ *                   |           |        |  |
+ *                 ---------------       ------
+ *        - fst_row->|           |        |  |
+ *        |          |           |        |  |
+ *       m_loc       |           |   P1   |  |
+ *        |          |           |        |  |
+ *        -          |           |        |  |
+ *                 ---------------       ------
+ *                   |    .      |        |. |
+ *                   |    .      |        |. |
+ *                   |    .      |        |. |
+ *                 ---------------       ------
+ *
+ * where, fst_row is the row number of the first row,
+ *        m_loc is the number of rows local to this processor
+ * These are defined in the 'SuperMatrix' structure, see supermatrix.h.
+ *
+ *
+ * Here are the options for using this code:
+ *
+ *   1. Independent of all the other options specified below, the
+ *      user must supply
+ *
+ *      -  B, the matrix of right-hand sides, distributed by block rows,
+ *            and its dimensions ldb (local) and nrhs (global)
+ *      -  grid, a structure describing the 2D processor mesh
+ *      -  options->IterRefine, which determines whether or not to
+ *            improve the accuracy of the computed solution using
+ *            iterative refinement
+ *
+ *      On output, B is overwritten with the solution X.
+ *
+ *   2. Depending on options->Fact, the user has four options
+ *      for solving A*X=B. The standard option is for factoring
+ *      A "from scratch". (The other options, described below,
+ *      are used when A is sufficiently similar to a previously
+ *      solved problem to save time by reusing part or all of
+ *      the previous factorization.)
+ *
+ *      -  options->Fact = DOFACT: A is factored "from scratch"
+ *
+ *      In this case the user must also supply
+ *
+ *        o  A, the input matrix
+ *
+ *        as well as the following options to determine what matrix to
+ *        factorize.
+ *
+ *        o  options->Equil,   to specify how to scale the rows and columns
+ *                             of A to "equilibrate" it (to try to reduce its
+ *                             condition number and so improve the
+ *                             accuracy of the computed solution)
+ *
+ *        o  options->RowPerm, to specify how to permute the rows of A
+ *                             (typically to control numerical stability)
+ *
+ *        o  options->ColPerm, to specify how to permute the columns of A
+ *                             (typically to control fill-in and enhance
+ *                             parallelism during factorization)
+ *
+ *        o  options->ReplaceTinyPivot, to specify how to deal with tiny
+ *                             pivots encountered during factorization
+ *                             (to control numerical stability)
+ *
+ *      The outputs returned include
+ *
+ *        o  ScalePermstruct,  modified to describe how the input matrix A
+ *                             was equilibrated and permuted:
+ *          .  ScalePermstruct->DiagScale, indicates whether the rows and/or
+ *                                         columns of A were scaled
+ *          .  ScalePermstruct->R, array of row scale factors
+ *          .  ScalePermstruct->C, array of column scale factors
+ *          .  ScalePermstruct->perm_r, row permutation vector
+ *          .  ScalePermstruct->perm_c, column permutation vector
+ *
+ *          (part of ScalePermstruct may also need to be supplied on input,
+ *           depending on options->RowPerm and options->ColPerm as described
+ *           later).
+ *
+ *        o  A, the input matrix A overwritten by the scaled and permuted
+ *              matrix diag(R)*A*diag(C)*Pc^T, where
+ *              Pc is the row permutation matrix determined by
+ *                  ScalePermstruct->perm_c
+ *              diag(R) and diag(C) are diagonal scaling matrices determined
+ *                  by ScalePermstruct->DiagScale, ScalePermstruct->R and
+ *                  ScalePermstruct->C
+ *
+ *        o  LUstruct, which contains the L and U factorization of A1 where
+ *
+ *                A1 = Pc*Pr*diag(R)*A*diag(C)*Pc^T = L*U
+ *
+ *               (Note that A1 = Pc*Pr*Aout, where Aout is the matrix stored
+ *                in A on output.)
+ *
+ *   3. The second value of options->Fact assumes that a matrix with the same
+ *      sparsity pattern as A has already been factored:
+ *
+ *      -  options->Fact = SamePattern: A is factored, assuming that it has
+ *            the same nonzero pattern as a previously factored matrix. In
+ *            this case the algorithm saves time by reusing the previously
+ *            computed column permutation vector stored in
+ *            ScalePermstruct->perm_c and the "elimination tree" of A
+ *            stored in LUstruct->etree
+ *
+ *      In this case the user must still specify the following options
+ *      as before:
+ *
+ *        o  options->Equil
+ *        o  options->RowPerm
+ *        o  options->ReplaceTinyPivot
+ *
+ *      but not options->ColPerm, whose value is ignored. This is because the
+ *      previous column permutation from ScalePermstruct->perm_c is used as
+ *      input. The user must also supply
+ *
+ *        o  A, the input matrix
+ *        o  ScalePermstruct->perm_c, the column permutation
+ *        o  LUstruct->etree, the elimination tree
+ *
+ *      The outputs returned include
+ *
+ *        o  A, the input matrix A overwritten by the scaled and permuted
+ *              matrix as described above
+ *        o  ScalePermstruct, modified to describe how the input matrix A was
+ *                            equilibrated and row permuted
+ *        o  LUstruct, modified to contain the new L and U factors
+ *
+ *   4. The third value of options->Fact assumes that a matrix B with the same
+ *      sparsity pattern as A has already been factored, and where the
+ *      row permutation of B can be reused for A. This is useful when A and B
+ *      have similar numerical values, so that the same row permutation
+ *      will make both factorizations numerically stable. This lets us reuse
+ *      all of the previously computed structure of L and U.
+ *
+ *      -  options->Fact = SamePattern_SameRowPerm: A is factored,
+ *            assuming not only the same nonzero pattern as the previously
+ *            factored matrix B, but reusing B's row permutation.
+ *
+ *      In this case the user must still specify the following options
+ *      as before:
+ *
+ *        o  options->Equil
+ *        o  options->ReplaceTinyPivot
+ *
+ *      but not options->RowPerm or options->ColPerm, whose values are
+ *      ignored. This is because the permutations from ScalePermstruct->perm_r
+ *      and ScalePermstruct->perm_c are used as input.
+ *
+ *      The user must also supply
+ *
+ *        o  A, the input matrix
+ *        o  ScalePermstruct->DiagScale, how the previous matrix was row
+ *                                       and/or column scaled
+ *        o  ScalePermstruct->R, the row scalings of the previous matrix,
+ *                               if any
+ *        o  ScalePermstruct->C, the columns scalings of the previous matrix,
+ *                               if any
+ *        o  ScalePermstruct->perm_r, the row permutation of the previous
+ *                                    matrix
+ *        o  ScalePermstruct->perm_c, the column permutation of the previous
+ *                                    matrix
+ *        o  all of LUstruct, the previously computed information about
+ *                            L and U (the actual numerical values of L and U
+ *                            stored in LUstruct->Llu are ignored)
+ *
+ *      The outputs returned include
+ *
+ *        o  A, the input matrix A overwritten by the scaled and permuted
+ *              matrix as described above
+ *        o  ScalePermstruct,  modified to describe how the input matrix A was
+ *                             equilibrated (thus ScalePermstruct->DiagScale,
+ *                             R and C may be modified)
+ *        o  LUstruct, modified to contain the new L and U factors
+ *
+ *   5. The fourth and last value of options->Fact assumes that A is
+ *      identical to a matrix that has already been factored on a previous
+ *      call, and reuses its entire LU factorization
+ *
+ *      -  options->Fact = Factored: A is identical to a previously
+ *            factorized matrix, so the entire previous factorization
+ *            can be reused.
+ *
+ *      In this case all the other options mentioned above are ignored
+ *      (options->Equil, options->RowPerm, options->ColPerm,
+ *       options->ReplaceTinyPivot)
+ *
+ *      The user must also supply
+ *
+ *        o  A, the unfactored matrix, only in the case that iterative
+ *              refinement is to be done (specifically A must be the output
+ *              A from the previous call, so that it has been scaled and permuted)
+ *        o  all of ScalePermstruct
+ *        o  all of LUstruct, including the actual numerical values of
+ *           L and U
+ *
+ *      all of which are unmodified on output.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t* (global)
+ *         The structure defines the input parameters to control
+ *         how the LU decomposition will be performed.
+ *         The following fields should be defined for this structure:
+ *
+ *         o Fact (fact_t)
+ *           Specifies whether or not the factored form of the matrix
+ *           A is supplied on entry, and if not, how the matrix A should
+ *           be factorized based on the previous history.
+ *
+ *           = DOFACT: The matrix A will be factorized from scratch.
+ *             If SUPERLU_TUNE_CACHE is set, the blocking parameters
+ *             recorded for A by psgstune() are used.
+ *                 Inputs:  A
+ *                          options->Equil, RowPerm, ColPerm, ReplaceTinyPivot
+ *                 Outputs: modified A
+ *                             (possibly row and/or column scaled and/or
+ *                              permuted)
+ *                          all of ScalePermstruct
+ *                          all of LUstruct
+ *
+ *           = SamePattern: the matrix A will be factorized assuming
+ *             that a factorization of a matrix with the same sparsity
+ *             pattern was performed prior to this one. Therefore, this
+ *             factorization will reuse column permutation vector
+ *             ScalePermstruct->perm_c and the elimination tree
+ *             LUstruct->etree
+ *                 Inputs:  A
+ *                          options->Equil, RowPerm, ReplaceTinyPivot
+ *                          ScalePermstruct->perm_c
+ *                          LUstruct->etree
+ *                 Outputs: modified A
+ *                             (possibly row and/or column scaled and/or
+ *                              permuted)
+ *                          rest of ScalePermstruct (DiagScale, R, C, perm_r)
+ *                          rest of LUstruct (GLU_persist, Llu)
+ *
+ *           = SamePattern_SameRowPerm: the matrix A will be factorized
+ *             assuming that a factorization of a matrix with the same
+ *             sparsity	pattern and similar numerical values was performed
+ *             prior to this one. Therefore, this factorization will reuse
+ *             both row and column scaling factors R and C, and the
+ *             both row and column permutation vectors perm_r and perm_c,
+ *             distributed data structure set up from the previous symbolic
+ *             factorization. The first such call records where the
+ *             entries of A go in L and U (LUstruct->Llu->Amap); the
+ *             following ones only move the new values there.
+ *                 Inputs:  A
+ *                          options->Equil, ReplaceTinyPivot
+ *                          all of ScalePermstruct
+ *                          all of LUstruct
+ *                 Outputs: modified A
+ *                             (possibly row and/or column scaled and/or
+ *                              permuted)
+ *                          modified LUstruct->Llu
+ *           = FACTORED: the matrix A is already factored.
+ *                 Inputs:  all of ScalePermstruct
+ *                          all of LUstruct
+ *
+ *         o Equil (yes_no_t)
+ *           Specifies whether to equilibrate the system.
+ *           = NO:  no equilibration.
+ *           = YES: scaling factors are computed to equilibrate the system:
+ *                      diag(R)*A*diag(C)*inv(diag(C))*X = diag(R)*B.
+ *                  Whether or not the system will be equilibrated depends
+ *                  on the scaling of the matrix A, but if equilibration is
+ *                  used, A is overwritten by diag(R)*A*diag(C) and B by
+ *                  diag(R)*B.
+ *
+ *         o RowPerm (rowperm_t)
+ *           Specifies how to permute rows of the matrix A.
+ *           = NATURAL:   use the natural ordering.
+ *           = LargeDiag_MC64: use the Duff/Koster algorithm to permute rows
+ *                        of the original matrix to make the diagonal large
+ *                        relative to the off-diagonal.
+ *           = LargeDiag_APWM: use the parallel approximate-weight perfect
+ *                        matching to permute rows of the original matrix
+ *                        to make the diagonal large relative to the
+ *                        off-diagonal.
+ *           = MY_PERMR:  use the ordering given in ScalePermstruct->perm_r
+ *                        input by the user.
+ *           = LargeDiag_AUCTION: use a distributed auction algorithm on
+ *                        the distributed A, with the objective of MC64
+ *                        (maximum product of the diagonal); with Equil = YES
+ *                        the matrix is also scaled as by MC64.
+ *
+ *         o ColPerm (colperm_t)
+ *           Specifies what type of column permutation to use to reduce fill.
+ *           = NATURAL:       natural ordering.
+ *           = MMD_AT_PLUS_A: minimum degree ordering on structure of A'+A.
+ *           = MMD_ATA:       minimum degree ordering on structure of A'*A.
+ *           = AMD_AT_PLUS_A: approximate minimum degree ordering (SYMAMD)
+ *                            on structure of A'+A.
+ *           = RCM_AT_PLUS_A: reverse Cuthill-McKee ordering on structure
+ *                            of A'+A, for long and thin domains; if the
+ *                            band of the factors is narrow, the
+ *                            supernodes are its block columns (see
+ *                            symbfact_band()).
+ *           = PARMETIS:      parallel METIS ordering on structure of A'+A.
+ *           = ZOLTAN:        PT-Scotch parallel nested dissection on the
+ *                            structure of A'+A; needs HAVE_PTSCOTCH.
+ *           = MY_PERMC:      the ordering given in ScalePermstruct->perm_c.
+ *           The orderings other than PARMETIS and ZOLTAN are sequential:
+ *           with ParSymbFact = NO, process 0 computes perm_c[] from the
+ *           global graph and broadcasts it; the other processes do not
+ *           order.
+ *
+ *         o ReplaceTinyPivot (yes_no_t)
+ *           = NO:  do not modify pivots
+ *           = YES: replace tiny pivots by sqrt(epsilon)*norm(A) during
+ *                  LU factorization.
+ *
+ *         o Trans (trans_t)
+ *           Specifies the form of the system of equations.
+ *           = NOTRANS: A * X = B.
+ *           = TRANS:   A**T * X = B, solved with the factors of A by
+ *                      psgstrs_trans(); DiagInv is not used.
+ *           = CONJ:    A**H * X = B, the same as TRANS for real A.
+ *
+ *         o IterRefine (IterRefine_t)
+ *           Specifies how to perform iterative refinement.
+ *           = NO:     no iterative refinement.
+ *           = SLU_DOUBLE: accumulate residual in single precision.
+ *           = SLU_EXTRA:  accumulate residual in extra precision.
+ *           = SLU_GMRES:  flexible GMRES preconditioned by the LU factors,
+ *                         see psgsrfs_gmres(); for approximate factors.
+ *
+ *         o ParSymbFact (yes_no_t)
+ *           = NO:  the ordering and the symbolic factorization are done
+ *                  on the global structure of A, gathered on all processes.
+ *                  The symbolic factorization is computed by one process
+ *                  of each node, with its OpenMP threads on independent
+ *                  subtrees of the etree, and broadcast to the others
+ *                  (see symbfact_node()).
+ *           = YES: use the parallel symbolic factorization on the
+ *                  distributed A (ColPerm = PARMETIS, ZOLTAN, NATURAL or
+ *                  MY_PERMC).
+ *                  Set SUPERLU_SYMB_SCRATCH to a node-local directory to
+ *                  spill the structures there when they are expanded.
+ *                  Unless RowPerm = LargeDiag_MC64, no process then holds
+ *                  the global matrix: equilibration, the row permutation
+ *                  (not MC64), the ordering, the symbolic
+ *                  factorization and the redistribution into L and U all
+ *                  work on distributed data.
+ *
+ *         o ShareReplicated (yes_no_t)
+ *           = YES: after the factorization, keep perm_r, perm_c, etree
+ *                  and the supernode partition in node-shared memory
+ *                  (one copy per node, see superlu_shm.c).
+ *
+ *         o SchurSize (int)
+ *           Specifies the number of trailing rows and columns of A, the
+ *           interface, that are left out of the factorization. With
+ *           SchurSize > 0, perm_c[] orders the interface last, the
+ *           supernodes of the interface are not factored, and the
+ *           Schur complement of the interior of A is returned by
+ *           psGetSchur() afterwards. It requires RowPerm = NOROWPERM,
+ *           ParSymbFact = NO and nrhs = 0.
+ *
+ *         o BLR_Tol (double), BLR_MinSize (int)
+ *           With BLR_Tol > 0, the blocks L(i,k) of at least BLR_MinSize
+ *           rows and columns are compressed to low rank with tolerance
+ *           BLR_Tol in the Schur complement update. The LU factors are then
+ *           approximate, and IterRefine should not be NOREFINE.
+ *
+ *         o Reproducible (yes_no_t)
+ *           Specifies whether the triangular solves add the contributions
+ *           of the processes in a fixed order, so that repeated runs on
+ *           the same process grid give bitwise identical solutions.
+ *           Only the solves with Trans = NOTRANS are affected.
+ *
+ *         o Amalg_Tol (double)
+ *           With Amalg_Tol > 0 and ParSymbFact = NO, each supernode from
+ *           the symbolic factorization is merged with its parent while the
+ *           explicit zeros stay below the fraction Amalg_Tol of the stored
+ *           L of the merged supernode (see symbfact_amalgamate()).
+ *
+ *         o SplitSuper (int)
+ *           With SplitSuper > 0 and ParSymbFact = NO, the supernodes with
+ *           more columns are split into block columns of at most
+ *           SplitSuper columns after the symbolic factorization (see
+ *           symbfact_split()).
+ *
+ *         o Dense_MaxN (int)
+ *           With Fact != FACTORED and n <= Dense_MaxN, A is gathered on
+ *           every process and factored by dense LU with partial pivoting,
+ *           and the later solves with Fact = FACTORED use these factors
+ *           (see psgssvx_dense()). Of ScalePermstruct, only the scaling
+ *           is used, by the solves with Fact = FACTORED; SOLVEstruct is
+ *           not used.
+ *
+ *         o UserSymbFact (yes_no_t)
+ *           With UserSymbFact = YES, Fact = DOFACT or SamePattern and
+ *           ColPerm = MY_PERMC, the supernodes, etree and blocks of L and
+ *           U given in LUstruct->usymb replace the symbolic
+ *           factorization; info = -8 if they are not valid for A.
+ *
+ *         o Solve_Compact (yes_no_t)
+ *           With Solve_Compact = YES, the factors are released as with
+ *           ReleaseMemory = YES and, at the first solve, copied into one
+ *           array in the order of the solves, see sCompact_LU().
+ *
+ *         o PatternCache (yes_no_t)
+ *           = YES: with Fact = DOFACT and ParSymbFact = NO, the column
+ *                  ordering, etree and symbolic factorization are kept in
+ *                  a cache keyed by the sparsity pattern of Pr*A, and
+ *                  reused for the next matrices with the same pattern.
+ *                  It is ignored with ColPerm = MY_PERMC, PARMETIS or
+ *                  ZOLTAN.
+ *
+ *         o RowPerm_Tol (double)
+ *           With RowPerm_Tol > 0, Fact = SamePattern, Equil = YES and
+ *           RowPerm = LargeDiag_MC64 or LargeDiag_AUCTION, the perm_r, R
+ *           and C of the previous factorization (ScalePermstruct->DiagScale
+ *           = BOTH) are kept, and the row permutation step is skipped,
+ *           while in diag(R)*A*diag(C) the matched entries stay at least
+ *           RowPerm_Tol and all entries at most 1/RowPerm_Tol in absolute
+ *           value (see psldperm_check()).
+ *
+ *         o Equil_Iter (int)
+ *           With Equil_Iter > 0 and Equil = YES, R and C are computed by
+ *           at most Equil_Iter sweeps of the Ruiz scaling, which bring the
+ *           largest entry of every row and column of diag(R)*A*diag(C)
+ *           close to one (see psgsequ_ruiz()), instead of psgsequ().
+ *
+ *         o DenseRoot_Tol (double)
+ *           With DenseRoot_Tol > 0 and SchurSize = 0, the trailing
+ *           supernodes whose L and U blocks fill at least the fraction
+ *           DenseRoot_Tol of their dense block are factored as one dense
+ *           matrix on the process grid (see psgstrf_root()), e.g. the top
+ *           separators of a nested dissection ordering.
+ *
+ *         o Fact_Comm (fact_comm_t)
+ *           Selects how the panels are exchanged in the factorization:
+ *           SLU_COMM_ISEND (default) eager MPI_Isend of the look-ahead
+ *           panels, SLU_COMM_IRECV the same look-ahead with the pre-posted
+ *           receives also tested during the Schur complement update,
+ *           SLU_COMM_SYNC no look-ahead and blocking MPI_Send of the
+ *           panels, SLU_COMM_RMA the panels pulled by the receivers
+ *           from RMA windows, SLU_COMM_THREADS as SLU_COMM_IRECV with a
+ *           communicator per look-ahead slot and the messages tested by
+ *           the update threads (MPI_THREAD_MULTIPLE).
+ *
+ *         o Sched_Priority (yes_no_t)
+ *           With Sched_Priority = YES, the static schedule of the
+ *           factorization takes the ready panels by critical-path
+ *           priority (see sstatic_schedule()).
+ *
+ *         o Panel_Compress (yes_no_t)
+ *           With Panel_Compress = YES, the indices of the panels sent in
+ *           the factorization are delta and varint encoded.
+ *
+ *         o SparseRHS (yes_no_t)
+ *           With SparseRHS = YES, the forward solve only visits the
+ *           supernodes reached in the etree from the nonzeros of B.
+ *           The solve is further restricted to some rows of X by
+ *           setting SOLVEstruct->out_rows (see psgstrs()).
+ *
+ *         o Solve_CritPath (yes_no_t)
+ *           With Solve_CritPath = YES, the triangular solves measure their
+ *           critical path through the supernodal etree, returned in
+ *           stat->sol_critpath[] and stat->sol_crithops[].
+ *
+ *         o Solve_Priority (yes_no_t)
+ *           With Solve_Priority = YES, the triangular solves process the
+ *           ready supernodes and received messages with the longest
+ *           remaining path in the supernodal etree first.
+ *
+ *         o Solve_RootSize (int)
+ *           With Solve_RootSize > 0, the trailing supernodes of order up
+ *           to Solve_RootSize are gathered on all the processes at the
+ *           first solve after the factorization, and solved there
+ *           without messages.
+ *
+ *         o Solve_RHSTile (int)
+ *           With more than Solve_RHSTile right-hand sides, B and X are
+ *           copied to and from the message buffers by tiles of
+ *           Solve_RHSTile columns; 0 disables the tiles.
+ *
+ *         o Predict (yes_no_t)
+ *           With Predict = YES and ParSymbFact = NO, process 0 prints the
+ *           memory, flops and messages of each process predicted by
+ *           superlu_predict() after the symbolic factorization.
+ *
+ *         o OutOfCore (yes_no_t)
+ *           With OutOfCore = YES and ParSymbFact = NO, the values of L and
+ *           U are kept in files under $SUPERLU_OOC_DIR, written out during
+ *           the factorization and read back ahead of the solves.
+ *
+ *         o ReleaseMemory (yes_no_t)
+ *           With ReleaseMemory = YES, the map of the values of A into L
+ *           and U is not kept, and the schedule of the messages of the
+ *           factorization is freed after it; the factors can then only be
+ *           used for solves (Fact = FACTORED), or replaced by a new
+ *           factorization with Fact = DOFACT or SamePattern.
+ *
+ *         o RefactorMap (yes_no_t)
+ *           With RefactorMap = YES, the column indices of A are kept with
+ *           the factors, for psgsrefactor() to refactor new values of A.
+ *
+ *         o SymValues (yes_no_t)
+ *           With SymValues = YES, A is taken as numerically symmetric.
+ *           If RowPerm = NOROWPERM and the scaling is symmetric (R = C),
+ *           the blocks of U off the diagonal are freed after the
+ *           factorization, as U = diag(U)*L^T, and the solves use L and
+ *           diag(U) only; Fact = SamePattern_SameRowPerm is then not
+ *           available for the next factorization.
+ *
+ *         o ILU_DropTol (double)
+ *           With ILU_DropTol > 0, the factorization is incomplete: the
+ *           blocks of L and U smaller than this threshold are dropped, see
+ *           superlu_defs.h. The factors are then a preconditioner; the
+ *           solution needs iterative refinement or a Krylov method.
+ *
+ *         o ConditionNumber (yes_no_t)
+ *           With ConditionNumber = YES and nrhs > 0, the reciprocal
+ *           condition number of A1 in the norm of the system (1-norm,
+ *           or infinity-norm with Trans != NOTRANS) is estimated by
+ *           PSGSCON with a few solves of several right-hand sides, and
+ *           returned in stat->RCond.
+ *
+ *         o DiagInv_MinSize, DiagInv_MaxSize (int)
+ *           With DiagInv = YES, only the diagonal blocks of the supernodes
+ *           of these sizes are inverted (DiagInv_MaxSize = 0 for no upper
+ *           bound). The inverses are computed by the first solve after
+ *           the factorization.
+ *
+ *         NOTE: all options must be identical on all processes when
+ *               calling this routine.
+ *
+ * A (input/output) SuperMatrix* (local)
+ *         On entry, matrix A in A*X=B, of dimension (A->nrow, A->ncol).
+ *           The number of linear equations is A->nrow. The type of A must be:
+ *           Stype = SLU_NR_loc; Dtype = SLU_S; Mtype = SLU_GE.
+ *           That is, A is stored in distributed compressed row format.
+ *           See supermatrix.h for the definition of 'SuperMatrix'.
+ *           This routine only handles square A, however, the LU factorization
+ *           routine PSGSTRF can factorize rectangular matrices.
+ *         On exit, A may be overwtirren by diag(R)*A*diag(C)*Pc^T,
+ *           depending on ScalePermstruct->DiagScale and options->ColPerm:
+ *             if ScalePermstruct->DiagScale != NOEQUIL, A is overwritten by
+ *                diag(R)*A*diag(C).
+ *             if options->ColPerm != NATURAL, A is further overwritten by
+ *                diag(R)*A*diag(C)*Pc^T.
+ *           If all the above condition are true, the LU decomposition is
+ *           performed on the matrix Pc*Pr*diag(R)*A*diag(C)*Pc^T.
+ *
+ * ScalePermstruct (input/output) sScalePermstruct_t* (global)
+ *         The data structure to store the scaling and permutation vectors
+ *         describing the transformations performed to the matrix A.
+ *         It contains the following fields:
+ *
+ *         o DiagScale (DiagScale_t)
+ *           Specifies the form of equilibration that was done.
+ *           = NOEQUIL: no equilibration.
+ *           = ROW:     row equilibration, i.e., A was premultiplied by
+ *                      diag(R).
+ *           = COL:     Column equilibration, i.e., A was postmultiplied
+ *                      by diag(C).
+ *           = BOTH:    both row and column equilibration, i.e., A was
+ *                      replaced by diag(R)*A*diag(C).
+ *           If options->Fact = FACTORED or SamePattern_SameRowPerm,
+ *           DiagScale is an input argument; otherwise it is an output
+ *           argument.
+ *
+ *         o perm_r (int*)
+ *           Row permutation vector, which defines the permutation matrix Pr;
+ *           perm_r[i] = j means row i of A is in position j in Pr*A.
+ *           If options->RowPerm = MY_PERMR, or
+ *           options->Fact = SamePattern_SameRowPerm, perm_r is an
+ *           input argument; otherwise it is an output argument.
+ *
+ *         o perm_c (int*)
+ *           Column permutation vector, which defines the
+ *           permutation matrix Pc; perm_c[i] = j means column i of A is
+ *           in position j in A*Pc.
+ *           If options->ColPerm = MY_PERMC or options->Fact = SamePattern
+ *           or options->Fact = SamePattern_SameRowPerm, perm_c is an
+ *           input argument; otherwise, it is an output argument.
+ *           On exit, perm_c may be overwritten by the product of the input
+ *           perm_c and a permutation that postorders the elimination tree
+ *           of Pc*A'*A*Pc'; perm_c is not changed if the elimination tree
+ *           is already in postorder.
+ *
+ *         o R (float*) dimension (A->nrow)
+ *           The row scale factors for A.
+ *           If DiagScale = ROW or BOTH, A is multiplied on the left by
+ *                          diag(R).
+ *           If DiagScale = NOEQUIL or COL, R is not defined.
+ *           If options->Fact = FACTORED or SamePattern_SameRowPerm, R is
+ *           an input argument; otherwise, R is an output argument.
+ *
+ *         o C (float*) dimension (A->ncol)
+ *           The column scale factors for A.
+ *           If DiagScale = COL or BOTH, A is multiplied on the right by
+ *                          diag(C).
+ *           If DiagScale = NOEQUIL or ROW, C is not defined.
+ *           If options->Fact = FACTORED or SamePattern_SameRowPerm, C is
+ *           an input argument; otherwise, C is an output argument.
+ *
+ * B       (input/output) float* (local)
+ *         On entry, the right-hand side matrix of dimension (m_loc, nrhs),
+ *           where, m_loc is the number of rows stored locally on my
+ *           process and is defined in the data structure of matrix A.
+ *         On exit, the solution matrix if info = 0;
+ *
+ * ldb     (input) int (local)
+ *         The leading dimension of matrix B.
+ *
+ * nrhs    (input) int (global)
+ *         The number of right-hand sides.
+ *         If nrhs = 0, only LU decomposition is performed, the forward
+ *         and back substitutions are skipped.
+ *
+ * grid    (input) gridinfo_t* (global)
+ *         The 2D process mesh. It contains the MPI communicator, the number
+ *         of process rows (NPROW), the number of process columns (NPCOL),
+ *         and my process rank. It is an input argument to all the
+ *         parallel routines.
+ *         Grid can be initialized by subroutine SUPERLU_GRIDINIT.
+ *         See superlu_sdefs.h for the definition of 'gridinfo_t'.
+ *
+ * LUstruct (input/output) sLUstruct_t*
+ *         The data structures to store the distributed L and U factors.
+ *         It contains the following fields:
+ *
+ *         o etree (int*) dimension (A->ncol) (global)
+ *           Elimination tree of Pc*(A'+A)*Pc' or Pc*A'*A*Pc'.
+ *           It is computed in sp_colorder() during the first factorization,
+ *           and is reused in the subsequent factorizations of the matrices
+ *           with the same nonzero pattern.
+ *           On exit of sp_colorder(), the columns of A are permuted so that
+ *           the etree is in a certain postorder. This postorder is reflected
+ *           in ScalePermstruct->perm_c.
+ *           NOTE:
+ *           Etree is a vector of parent pointers for a forest whose vertices
+ *           are the integers 0 to A->ncol-1; etree[root]==A->ncol.
+ *
+ *         o Glu_persist (Glu_persist_t*) (global)
+ *           Global data structure (xsup, supno) replicated on all processes,
+ *           describing the supernode partition in the factored matrices
+ *           L and U:
+ *	       xsup[s] is the leading column of the s-th supernode,
+ *             supno[i] is the supernode number to which column i belongs.
+ *
+ *         o Llu (sLocalLU_t*) (local)
+ *           The distributed data structures to store L and U factors.
+ *           See superlu_sdefs.h for the definition of 'sLocalLU_t'.
+ *
+ *         o matvec (sMatvec_t*) (input)
+ *           If not NULL, the iterative refinement computes the products
+ *           by A with matvec->apply() and the original matrix, instead of
+ *           the distributed A (see psgsrfs_matvec()). A is then not
+ *           accessed after the factorization: with Fact = FACTORED and
+ *           ConditionNumber = NO, the arrays nzval[] and colind[] of A may
+ *           have been freed. The set-up of the product by the distributed
+ *           A is skipped.
+ *
+ * SOLVEstruct (input/output) sSOLVEstruct_t*
+ *         The data structure to hold the communication pattern used
+ *         in the phases of triangular solution and iterative refinement.
+ *         This pattern should be initialized only once for repeated solutions.
+ *         If options->SolveInitialized = YES, it is an input argument.
+ *         If options->SolveInitialized = NO and nrhs != 0, it is an output
+ *         argument. See superlu_sdefs.h for the definition of 'sSOLVEstruct_t'.
+ *
+ * berr    (output) float*, dimension (nrhs) (global)
+ *         The componentwise relative backward error of each solution
+ *         vector X(j) (i.e., the smallest relative change in
+ *         any element of A or B that makes X(j) an exact solution).
+ *
+ * stat   (output) SuperLUStat_t*
+ *        Record the statistics on runtime and floating-point operation count.
+ *        See util.h for the definition of 'SuperLUStat_t'.
+ *
+ * info    (output) int*
+ *         = 0: successful exit
+ *         < 0: if info = -i, the i-th argument had an illegal value   
+ *         > 0: if info = i, and i is
+ *             <= A->ncol: U(i,i) is exactly zero. The factorization has
+ *                been completed, but the factor U is exactly singular,
+ *                so the solution could not be computed.
+ *             > A->ncol: number of bytes allocated when memory allocation
+ *                failure occurred, plus A->ncol.
+ *                With options->MemBudget > 0, the number of megabytes
+ *                the factorization is short of, plus A->ncol.
+ *
+ * See superlu_sdefs.h for the definitions of various data types.
+ * </pre>
+ */
+
+void
+psgssvx(superlu_dist_options_t *options, SuperMatrix *A,
+	sScalePermstruct_t *ScalePermstruct,
+	float B[], int ldb, int nrhs, gridinfo_t *grid,
+	sLUstruct_t *LUstruct, sSOLVEstruct_t *SOLVEstruct, float *berr,
+	SuperLUStat_t *stat, int *info)
+{
+    NRformat_loc *Astore;
+    SuperMatrix GA;      /* Global A in NC format */
+    NCformat *GAstore;
+    float   *a_GA;
+    SuperMatrix GAC;      /* Global A in NCP format (add n end pointers) */
+    NCPformat *GACstore;
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    Glu_freeable_t *Glu_freeable;
+            /* The nonzero structures of L and U factors, which are
+	       replicated on all processrs.
+	           (lsub, xlsub) contains the compressed subscript of
+		                 supernodes in L.
+          	   (usub, xusub) contains the compressed subscript of
+		                 nonzero segments in U.
+	      If options->Fact != SamePattern_SameRowPerm, they are
+	      computed by SYMBFACT routine, and then used by PSDISTRIBUTE
+	      routine. They will be freed after PSDISTRIBUTE routine.
+	      If options->Fact == SamePattern_SameRowPerm, these
+	      structures are not used.                                  */
+    fact_t   Fact;
+    float   *a;
+    int_t    *colptr, *rowind;
+    int_t    *perm_r; /* row permutations from partial pivoting */
+    int_t    *perm_c; /* column permutation vector */
+    int_t    *etree;  /* elimination tree */
+    int_t    *rowptr, *colind;  /* Local A in NR*/
+    int_t    colequ, Equil, factored, job, notran, rowequ, need_value;
+    int_t    i, iinfo, j, irow, m, n, nnz, permc_spec;
+    int_t    nnz_loc, m_loc, fst_row, icol;
+    int      iam,iam_g;
+    int      ldx;  /* LDA for matrix X (local). */
+    char     equed[1], norm[1];
+    float   *C, *R, *C1, *R1, amax, anorm, colcnd, rowcnd;
+    float   *X, *b_col, *b_work, *x_col;
+    double t;
+    float    GA_mem_use = 0.0;    /* memory usage by global A */
+    int      need_GA = 0;         /* whether global A is gathered */
+    int      mem_tag;             /* allocations of the caller, see
+				     superlu_mem_tag() */
+    int      keep_rowperm = 0;    /* keep the previous perm_r, R and C */
+    int      order_rank = -1;     /* process computing perm_c[] during MC64 */
+    double   t_order = 0.0;
+    float    dist_mem_use = 0.0;  /* memory usage during distribution */
+    superlu_dist_mem_usage_t num_mem_usage, symb_mem_usage;
+    int64_t  nnzLU;
+    int_t    nnz_tot;
+    float *nzval_a;
+    float asum,asum_tot,lsum,lsum_tot;
+    int_t nsupers,nsupers_j;
+    int_t lk,k,knsupc,nsupr;
+    int_t  *lsub,*xsup;
+    float *lusup;
+#if ( PRNTlevel>= 2 )
+    float   dmin, dsum, dprod;
+#endif
+
+	LUstruct->dt = 's';
+
+    /* Structures needed for parallel symbolic factorization */
+    int_t *sizes, *fstVtxSep, parSymbFact;
+    int   noDomains, nprocs_num;
+    MPI_Comm symb_comm; /* communicator for symbolic factorization */
+    int   col, key; /* parameters for creating a new communicator */
+    Pslu_freeable_t Pslu_freeable;
+    float  flinfo;
+    symbfact_key_t symb_key; /* sparsity pattern of GA, for PatternCache */
+    int   symb_cached = 0, symb_cacheable = 0;
+    int   symb_user = 0; /* symbolic factorization of LUstruct->usymb */
+
+    /* Initialization. */
+    m       = A->nrow;
+    n       = A->ncol;
+    Astore  = (NRformat_loc *) A->Store;
+    nnz_loc = Astore->nnz_loc;
+    m_loc   = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    a       = (float *) Astore->nzval;
+    rowptr  = Astore->rowptr;
+    colind  = Astore->colind;
+    sizes   = NULL;
+    fstVtxSep = NULL;
+    symb_comm = MPI_COMM_NULL;
+    num_mem_usage.for_lu = num_mem_usage.total = 0.0;
+    symb_mem_usage.for_lu = symb_mem_usage.total = 0.0;
+
+    /* Test the input parameters. */
+    *info = 0;
+    Fact = options->Fact;
+    if ( Fact < 0 || Fact > FACTORED )
+	*info = -1;
+    else if ( options->RowPerm < 0 || options->RowPerm > LargeDiag_AUCTION )
+	*info = -1;
+    else if ( options->ColPerm < 0 || options->ColPerm > RCM_AT_PLUS_A )
+	*info = -1;
+#ifndef HAVE_PTSCOTCH
+    else if ( options->ColPerm == ZOLTAN ) {
+	*info = -1;
+	printf("ERROR: ColPerm = ZOLTAN needs SuperLU_DIST built with PT-Scotch.\n");
+    }
+#endif
+    else if ( options->IterRefine < 0 || options->IterRefine > SLU_GMRES )
+	*info = -1;
+    else if ( options->IterRefine == SLU_EXTRA ) {
+	*info = -1;
+	printf("ERROR: Extra precise iterative refinement yet to support.\n");
+    } else if ( options->BLR_Tol < 0.0 )
+	*info = -1;
+    else if ( options->SchurSize < 0 || options->SchurSize >= A->ncol
+		|| (options->SchurSize && (options->RowPerm != NOROWPERM
+					   || options->ParSymbFact == YES)) )
+	*info = -1;
+    else if ( Fact == SamePattern_SameRowPerm && LUstruct->Llu->release
+	      && !LUstruct->Llu->ToRecv ) {
+	*info = -1;
+	printf("ERROR: SamePattern_SameRowPerm after the factorization "
+	       "schedule is released, see options->ReleaseMemory.\n");
+    } else if ( options->UserSymbFact == YES
+		&& (Fact == DOFACT || Fact == SamePattern)
+		&& (options->ColPerm != MY_PERMC || options->ParSymbFact == YES
+		    || !LUstruct->usymb) ) {
+	*info = -1;
+	printf("ERROR: UserSymbFact needs ColPerm = MY_PERMC, "
+	       "ParSymbFact = NO and LUstruct->usymb.\n");
+    } else if ( Fact == SamePattern_SameRowPerm && LUstruct->Llu->Udropped ) {
+	*info = -1;
+	printf("ERROR: SamePattern_SameRowPerm after U is dropped, "
+	       "see options->SymValues.\n");
+    } else if ( A->nrow != A->ncol || A->nrow < 0 || A->Stype != SLU_NR_loc
+		|| A->Dtype != SLU_S || A->Mtype != SLU_GE )
+	*info = -2;
+    else if ( ldb < m_loc )
+	*info = -5;
+    else if ( nrhs < 0 || (nrhs && options->SchurSize) )
+	*info = -6;
+    /* Blocking parameters tuned for this matrix, see superlu_tune.c. */
+    if ( !*info && Fact == DOFACT ) superlu_tune_load(A, grid);
+    if ( sp_ienv_dist(2) > sp_ienv_dist(3) ) {
+        *info = 1;
+	printf("ERROR: Relaxation (NREL) cannot be larger than max. supernode size (NSUP).\n"
+	"\t-> Check parameter setting in sp_ienv_dist.c to correct error.\n");
+    }
+    if ( *info ) {
+	i = -(*info);
+	pxerr_dist("psgssvx", grid, -*info);
+	return;
+    }
+
+    /* Small systems are solved by dense LU, see psgsdense.c. */
+    if ( Fact == FACTORED ? LUstruct->dense != NULL
+	 : A->ncol <= options->Dense_MaxN ) {
+	psgssvx_dense(options, A, ScalePermstruct, B, ldb, nrhs, grid,
+		      LUstruct, berr, stat, info);
+	return;
+    }
+    if ( LUstruct->dense ) sDestroy_DenseLU(LUstruct);
+
+    factored = (Fact == FACTORED);
+    Equil = (!factored && options->Equil == YES);
+    notran = (options->Trans == NOTRANS);
+    parSymbFact = options->ParSymbFact;
+
+    iam = grid->iam;
+    job = 5;
+    /* With options->RowPerm_Tol > 0, the large-diagonal row permutation
+       and the scaling of the previous factorization are kept if they
+       still fit A. */
+    if ( Fact == SamePattern && Equil && options->RowPerm_Tol > 0.0
+	 && (options->RowPerm == LargeDiag_MC64
+	     || options->RowPerm == LargeDiag_AUCTION)
+	 && ScalePermstruct->DiagScale == BOTH ) {
+	keep_rowperm = psldperm_check(A, ScalePermstruct,
+				      options->RowPerm_Tol, grid);
+#if ( PRNTlevel>=1 )
+	if ( !grid->iam ) {
+	    printf(".. keep the previous row permutation? %d\n", keep_rowperm);
+	    fflush(stdout);
+	}
+#endif
+    }
+    if ( factored || ((Fact == SamePattern_SameRowPerm || keep_rowperm)
+		      && Equil) ) {
+	rowequ = (ScalePermstruct->DiagScale == ROW) ||
+	         (ScalePermstruct->DiagScale == BOTH);
+	colequ = (ScalePermstruct->DiagScale == COL) ||
+	         (ScalePermstruct->DiagScale == BOTH);
+    } else rowequ = colequ = FALSE;
+
+    /* The following arrays are replicated on all processes. */
+    if ( !factored ) {
+        /* They are recomputed below, so a node-shared copy kept by
+	   a previous call (options->ShareReplicated) is made private. */
+	superlu_shm_unshare((void **) &ScalePermstruct->perm_r, m * sizeof(int_t));
+	superlu_shm_unshare((void **) &ScalePermstruct->perm_c, n * sizeof(int_t));
+	superlu_shm_unshare((void **) &LUstruct->etree, n * sizeof(int_t));
+    }
+    perm_r = ScalePermstruct->perm_r;
+    perm_c = ScalePermstruct->perm_c;
+    etree = LUstruct->etree;
+    R = ScalePermstruct->R;
+    C = ScalePermstruct->C;
+    /********/
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter psgssvx()");
+#endif
+
+    /* Not factored & ask for equilibration */
+    if ( Equil && Fact != SamePattern_SameRowPerm ) {
+	/* Allocate storage if not done so before. */
+	switch ( ScalePermstruct->DiagScale ) {
+	    case NOEQUIL:
+		if ( !(R = (float *) floatMalloc_dist(m)) )
+		    ABORT("Malloc fails for R[].");
+	        if ( !(C = (float *) floatMalloc_dist(n)) )
+		    ABORT("Malloc fails for C[].");
+		ScalePermstruct->R = R;
+		ScalePermstruct->C = C;
+		break;
+	    case ROW:
+	        if ( !(C = (float *) floatMalloc_dist(n)) )
+		    ABORT("Malloc fails for C[].");
+		ScalePermstruct->C = C;
+		break;
+	    case COL:
+		if ( !(R = (float *) floatMalloc_dist(m)) )
+		    ABORT("Malloc fails for R[].");
+		ScalePermstruct->R = R;
+		break;
+	}
+    }
+
+    /* ------------------------------------------------------------
+     * Diagonal scaling to equilibrate the matrix. (simple scheme)
+     *   for row i = 1:n,  A(i,:) <- A(i,:) / max(abs(A(i,:));
+     *   for column j = 1:n,  A(:,j) <- A(:, j) / max(abs(A(:,j))
+     * ------------------------------------------------------------*/
+    if ( Equil ) {
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(iam, "Enter equil");
+#endif
+	t = SuperLU_timer_();
+
+	if ( Fact == SamePattern_SameRowPerm || keep_rowperm ) {
+	    /* Reuse R and C. */
+	    switch ( ScalePermstruct->DiagScale ) {
+	      case NOEQUIL:
+		break;
+	      case ROW:
+		irow = fst_row;
+		for (j = 0; j < m_loc; ++j) {
+		    for (i = rowptr[j]; i < rowptr[j+1]; ++i) {
+			a[i] *= R[irow];       /* Scale rows. */
+		    }
+		    ++irow;
+		}
+		break;
+	      case COL:
+		for (j = 0; j < m_loc; ++j)
+		    for (i = rowptr[j]; i < rowptr[j+1]; ++i){
+		        icol = colind[i];
+			a[i] *= C[icol];          /* Scale columns. */
+		    }
+		break;
+	      case BOTH:
+		irow = fst_row;
+		for (j = 0; j < m_loc; ++j) {
+		    for (i = rowptr[j]; i < rowptr[j+1]; ++i) {
+			icol = colind[i];
+			a[i] *= R[irow] * C[icol]; /* Scale rows and cols. */
+		    }
+		    ++irow;
+		}
+	        break;
+	    }
+	} else { /* Compute R & C from scratch */
+            /* Compute the row and column scalings. */
+	    if ( options->Equil_Iter > 0 )
+		psgsequ_ruiz(A, options->Equil_Iter, R, C, &rowcnd, &colcnd,
+			     &amax, &iinfo, grid);
+	    else
+		psgsequ(A, R, C, &rowcnd, &colcnd, &amax, &iinfo, grid);
+
+	    if ( iinfo > 0 ) {
+		if ( iinfo <= m ) {
+#if ( PRNTlevel>=1 )
+		    fprintf(stderr, "The " IFMT "-th row of A is exactly zero\n", iinfo);
+#endif
+		} else {
+#if ( PRNTlevel>=1 )
+                    fprintf(stderr, "The " IFMT "-th column of A is exactly zero\n", iinfo-n);
+#endif
+                }
+ 	    } else if ( iinfo < 0 ) return;
+
+	    /* Now iinfo == 0 */
+
+            /* Equilibrate matrix A if it is badly-scaled.
+               A <-- diag(R)*A*diag(C)                     */
+	    pslaqgs(A, R, C, rowcnd, colcnd, amax, equed);
+
+	    if ( strncmp(equed, "R", 1)==0 ) {
+		  ScalePermstruct->DiagScale = ROW;
+		  rowequ = ROW;
+	    } else if ( strncmp(equed, "C", 1)==0 ) {
+		  ScalePermstruct->DiagScale = COL;
+		  colequ = COL;
+	    } else if ( strncmp(equed, "B", 1)==0 ) {
+		  ScalePermstruct->DiagScale = BOTH;
+		  rowequ = ROW;
+		  colequ = COL;
+	    } else ScalePermstruct->DiagScale = NOEQUIL;
+
+#if ( PRNTlevel>=1 )
+	    if ( !iam ) {
+		printf(".. equilibrated? *equed = %c\n", *equed);
+		fflush(stdout);
+	    }
+#endif
+	} /* end if Fact ... */
+
+	stat->utime[EQUIL] = SuperLU_timer_() - t;
+#if ( DEBUGlevel>=1 )
+	CHECK_MALLOC(iam, "Exit equil");
+#endif
+    } /* end if Equil ... LAPACK style, not involving MC64 */
+
+    if ( !factored ) { /* Skip this if already factored. */
+        /*
+         * For serial symbolic factorization, gather A from the distributed
+	 * compressed row format to global A in compressed column format.
+         * Numerical values are gathered only when a row permutation
+         * for large diagonal is sought after.
+         * With parallel symbolic factorization, global A is needed only
+         * by MC64; with any other RowPerm, the matrix stays distributed
+         * throughout.
+         */
+	/* The symbolic factorization supplied by the user needs no GA. */
+	symb_user = ( options->UserSymbFact == YES
+		      && Fact != SamePattern_SameRowPerm );
+	need_GA = ( Fact != SamePattern_SameRowPerm &&
+		    ((parSymbFact == NO && !symb_user) ||
+		     (options->RowPerm == LargeDiag_MC64 && !keep_rowperm)) );
+	if ( need_GA ) {
+             /* Performs serial symbolic factorzation and/or MC64 */
+
+            need_value = (options->RowPerm == LargeDiag_MC64 && !keep_rowperm);
+
+            psCompRow_loc_to_CompCol_global(need_value, A, grid, &GA);
+
+            GAstore = (NCformat *) GA.Store;
+            colptr = GAstore->colptr;
+            rowind = GAstore->rowind;
+            nnz = GAstore->nnz;
+            GA_mem_use = (nnz + n + 1) * sizeof(int_t);
+
+            if ( need_value ) {
+                a_GA = (float *) GAstore->nzval;
+                GA_mem_use += nnz * sizeof(float);
+            } else assert(GAstore->nzval == NULL);
+	}
+
+	/* With Overlap_Preproc = YES, the ordering of A'*A or COLAMD, which
+	   does not depend on the row permutation, is computed by the last
+	   process from the unpermuted GA while process 0 runs MC64, and
+	   broadcast in place of the get_perm_c_block() of process 0 below. */
+	if ( options->Overlap_Preproc == YES && need_GA && Fact == DOFACT
+	     && parSymbFact == NO && options->PatternCache != YES
+	     && options->RowPerm == LargeDiag_MC64 && !keep_rowperm
+	     && (options->ColPerm == MMD_ATA || options->ColPerm == COLAMD)
+	     && grid->nprow * grid->npcol > 1 ) {
+	    order_rank = grid->nprow * grid->npcol - 1;
+	    if ( iam == order_rank ) {
+		t_order = SuperLU_timer_();
+		get_perm_c_block(iam, options->ColPerm, options->DofBlock, &GA,
+				 perm_c);
+		t_order = SuperLU_timer_() - t_order;
+	    }
+	}
+
+        /* ------------------------------------------------------------
+           Find the row permutation Pr for A, and apply Pr*[GA].
+	   GA is overwritten by Pr*[GA].
+           ------------------------------------------------------------*/
+        if ( options->RowPerm != NO ) {
+	    t = SuperLU_timer_();
+	    if ( Fact != SamePattern_SameRowPerm ) {
+	        if ( options->RowPerm == MY_PERMR || keep_rowperm ) {
+		    /* Use user's perm_r, or the previous one. */
+	            /* Permute the global matrix GA for symbfact() */
+	            if ( need_GA ) {
+	                for (i = 0; i < colptr[n]; ++i) {
+	            	    irow = rowind[i];
+		    	    rowind[i] = perm_r[irow];
+	                }
+	            }
+	        } else if ( options->RowPerm == LargeDiag_MC64 ) {
+	            /* Get a new perm_r[] from MC64 */
+	            if ( job == 5 ) {
+		        /* Allocate storage for scaling factors. */
+		        if ( !(R1 = floatMalloc_dist(m)) )
+		            ABORT("SUPERLU_MALLOC fails for R1[]");
+		    	if ( !(C1 = floatMalloc_dist(n)) )
+		            ABORT("SUPERLU_MALLOC fails for C1[]");
+	            }
+
+	            if ( !iam ) { /* Process 0 finds a row permutation */
+		        iinfo = sldperm_dist(job, m, nnz, colptr, rowind, a_GA,
+		                perm_r, R1, C1);
+
+                        MPI_Bcast( &iinfo, 1, mpi_int_t, 0, grid->comm );
+		        if ( iinfo == 0 ) {
+		            MPI_Bcast( perm_r, m, mpi_int_t, 0, grid->comm );
+		            if ( job == 5 && Equil ) {
+		                MPI_Bcast( R1, m, MPI_FLOAT, 0, grid->comm );
+		                MPI_Bcast( C1, n, MPI_FLOAT, 0, grid->comm );
+                            }
+		        }
+	            } else {
+		        MPI_Bcast( &iinfo, 1, mpi_int_t, 0, grid->comm );
+			if ( iinfo == 0 ) {
+		            MPI_Bcast( perm_r, m, mpi_int_t, 0, grid->comm );
+		            if ( job == 5 && Equil ) {
+		                MPI_Bcast( R1, m, MPI_FLOAT, 0, grid->comm );
+		                MPI_Bcast( C1, n, MPI_FLOAT, 0, grid->comm );
+                            }
+		        }
+	            }
+
+	    	    if ( iinfo && job == 5) { /* Error return */
+	                SUPERLU_FREE(R1);
+	        	SUPERLU_FREE(C1);
+   	            }
+#if ( PRNTlevel>=2 )
+	            dmin = smach_dist("Overflow");
+	            dsum = 0.0;
+	            dprod = 1.0;
+#endif
+	            if ( iinfo == 0 ) {
+	              if ( job == 5 ) {
+		        if ( Equil ) {
+		            for (i = 0; i < n; ++i) {
+			        R1[i] = exp(R1[i]);
+			        C1[i] = exp(C1[i]);
+		            }
+
+		            /* Scale the distributed matrix further.
+			       A <-- diag(R1)*A*diag(C1)            */
+		            irow = fst_row;
+		            for (j = 0; j < m_loc; ++j) {
+			        for (i = rowptr[j]; i < rowptr[j+1]; ++i) {
+			            icol = colind[i];
+			            a[i] *= R1[irow] * C1[icol];
+#if ( PRNTlevel>=2 )
+			            if ( perm_r[irow] == icol ) { /* New diagonal */
+			              if ( job == 2 || job == 3 )
+				        dmin = SUPERLU_MIN(dmin, fabs(a[i]));
+			              else if ( job == 4 )
+				        dsum += fabs(a[i]);
+			              else if ( job == 5 )
+				        dprod *= fabs(a[i]);
+			            }
+#endif
+			        }
+			        ++irow;
+		            }
+
+		            /* Multiply together the scaling factors --
+			       R/C from simple scheme, R1/C1 from MC64. */
+		            if ( rowequ ) for (i = 0; i < m; ++i) R[i] *= R1[i];
+		            else for (i = 0; i < m; ++i) R[i] = R1[i];
+		            if ( colequ ) for (i = 0; i < n; ++i) C[i] *= C1[i];
+		            else for (i = 0; i < n; ++i) C[i] = C1[i];
+
+		            ScalePermstruct->DiagScale = BOTH;
+		            rowequ = colequ = 1;
+
+		        } /* end Equil */
+
+                        /* Now permute global GA to prepare for symbfact() */
+                        for (j = 0; j < n; ++j) {
+		            for (i = colptr[j]; i < colptr[j+1]; ++i) {
+	                        irow = rowind[i];
+		                rowind[i] = perm_r[irow];
+		            }
+		        }
+		        SUPERLU_FREE (R1);
+		        SUPERLU_FREE (C1);
+	              } else { /* job = 2,3,4 */
+		        for (j = 0; j < n; ++j) {
+		            for (i = colptr[j]; i < colptr[j+1]; ++i) {
+			        irow = rowind[i];
+			        rowind[i] = perm_r[irow];
+		            } /* end for i ... */
+		        } /* end for j ... */
+	              } /* end else job ... */
+                    } else { /* if iinfo != 0 */
+			for (i = 0; i < m; ++i) perm_r[i] = i;
+		    }
+
+#if ( PRNTlevel>=2 )
+	            if ( job == 2 || job == 3 ) {
+		        if ( !iam ) printf("\tsmallest diagonal %e\n", dmin);
+	            } else if ( job == 4 ) {
+		        if ( !iam ) printf("\tsum of diagonal %e\n", dsum);
+	            } else if ( job == 5 ) {
+		        if ( !iam ) printf("\t product of diagonal %e\n", dprod);
+	            }
+#endif
+                } else if ( options->RowPerm == LargeDiag_AUCTION ) {
+		    /* Get a new perm_r[] (and scaling) on the distributed A */
+		    if ( Equil ) {
+		        if ( !(R1 = floatMalloc_dist(m)) )
+		            ABORT("SUPERLU_MALLOC fails for R1[]");
+		    	if ( !(C1 = floatMalloc_dist(n)) )
+		            ABORT("SUPERLU_MALLOC fails for C1[]");
+		    }
+		    iinfo = psldperm_auction(A, grid, perm_r,
+		                             Equil ? R1 : NULL, Equil ? C1 : NULL);
+		    if ( iinfo == 0 && Equil ) {
+		        /* A <-- diag(R1)*A*diag(C1) */
+		        irow = fst_row;
+		        for (j = 0; j < m_loc; ++j) {
+			    for (i = rowptr[j]; i < rowptr[j+1]; ++i)
+			        a[i] *= R1[irow] * C1[colind[i]];
+			    ++irow;
+		        }
+		        if ( rowequ ) for (i = 0; i < m; ++i) R[i] *= R1[i];
+		        else for (i = 0; i < m; ++i) R[i] = R1[i];
+		        if ( colequ ) for (i = 0; i < n; ++i) C[i] *= C1[i];
+		        else for (i = 0; i < n; ++i) C[i] = C1[i];
+
+		        ScalePermstruct->DiagScale = BOTH;
+		        rowequ = colequ = 1;
+		    } else if ( iinfo ) {
+#if ( PRNTlevel>=1 )
+		        if ( !iam ) {
+			    printf(".. auction matching fails (structurally"
+				   " singular?), no row permutation\n");
+			    fflush(stdout);
+			}
+#endif
+		        for (i = 0; i < m; ++i) perm_r[i] = i;
+		    }
+		    if ( Equil ) {
+		        SUPERLU_FREE(R1);
+		        SUPERLU_FREE(C1);
+		    }
+
+		    /* Permute the global matrix GA for symbfact() */
+		    if ( need_GA ) {
+		        for (i = 0; i < colptr[n]; ++i) {
+			    irow = rowind[i];
+			    rowind[i] = perm_r[irow];
+		        }
+		    }
+                } else { /* use largeDiag_AWPM */
+#ifdef HAVE_COMBBLAS
+		    s_c2cpp_GetHWPM(A, grid, ScalePermstruct);
+#else
+		    if ( iam == 0 ) {
+		        printf("CombBLAS is not available\n"); fflush(stdout);
+		    }
+		    for (i = 0; i < m; ++i) perm_r[i] = i;
+#endif
+		    /* Permute the global matrix GA for symbfact() */
+		    if ( need_GA ) {
+		        for (i = 0; i < colptr[n]; ++i) {
+			    irow = rowind[i];
+			    rowind[i] = perm_r[irow];
+		        }
+		    }
+                } /* end if options->RowPerm ... */
+
+	        t = SuperLU_timer_() - t;
+	        stat->utime[ROWPERM] = t;
+#if ( PRNTlevel>=1 )
+                if ( !iam ) {
+		    printf(".. LDPERM job " IFMT "\t time: %.2f\n", job, t);
+		    fflush(stdout);
+		}
+#endif
+            } /* end if Fact ... */
+
+        } else { /* options->RowPerm == NOROWPERM / NATURAL */
+            for (i = 0; i < m; ++i) perm_r[i] = i;
+        }
+
+#if ( DEBUGlevel>=2 )
+        if ( !iam ) PrintInt10("perm_r",  m, perm_r);
+#endif
+    } /* end if (!factored) */
+
+    anorm = 0.0;
+    if ( !factored || (options->IterRefine && !LUstruct->matvec)
+	 || options->ConditionNumber == YES ) {
+	/* Compute norm(A), which will be used to adjust small diagonal. */
+	if ( notran ) *(unsigned char *)norm = '1';
+	else *(unsigned char *)norm = 'I';
+	anorm = pslangs(norm, A, grid);
+#if ( PRNTlevel>=1 )
+	if ( !iam ) { printf(".. anorm %e\n", anorm); 	fflush(stdout); }
+#endif
+    }
+
+    /* ------------------------------------------------------------
+       Perform the LU factorization: symbolic factorization,
+       redistribution, and numerical factorization.
+       ------------------------------------------------------------*/
+    if ( !factored ) {
+	mem_tag = superlu_mem_tag(SUPERLU_MEM_SYMB);
+	SUPERLU_PROF_BEGIN(PROF_ANALYSIS, EMPTY);
+	t = SuperLU_timer_();
+	/*
+	 * Get column permutation vector perm_c[], according to permc_spec:
+	 *   permc_spec = NATURAL:  natural ordering
+	 *   permc_spec = MMD_AT_PLUS_A: minimum degree on structure of A'+A
+	 *   permc_spec = MMD_ATA:  minimum degree on structure of A'*A
+	 *   permc_spec = METIS_AT_PLUS_A: METIS on structure of A'+A
+	 *   permc_spec = PARMETIS: parallel METIS on structure of A'+A
+	 *   permc_spec = ZOLTAN: PT-Scotch nested dissection on A'+A
+	 *   permc_spec = MY_PERMC: the ordering already supplied in perm_c[]
+	 */
+	permc_spec = options->ColPerm;
+
+	if ( parSymbFact == YES || permc_spec == PARMETIS
+	     || permc_spec == ZOLTAN ) {
+	    nprocs_num = grid->nprow * grid->npcol;
+  	    noDomains = (int) ( pow(2, ((int) LOG2( nprocs_num ))));
+
+	    /* create a new communicator for the first noDomains
+               processes in grid->comm */
+	    key = iam;
+    	    if (iam < noDomains) col = 0;
+	    else col = MPI_UNDEFINED;
+	    MPI_Comm_split (grid->comm, col, key, &symb_comm );
+
+	    if ( permc_spec == NATURAL || permc_spec == MY_PERMC ) {
+		if ( permc_spec == NATURAL ) {
+		     for (j = 0; j < n; ++j) perm_c[j] = j;
+                }
+		if ( !(sizes = intMalloc_dist(2 * noDomains)) )
+		     ABORT("SUPERLU_MALLOC fails for sizes.");
+		if ( !(fstVtxSep = intMalloc_dist(2 * noDomains)) )
+		    ABORT("SUPERLU_MALLOC fails for fstVtxSep.");
+		for (i = 0; i < 2*noDomains - 2; ++i) {
+		    sizes[i] = 0;
+		    fstVtxSep[i] = 0;
+		}
+		sizes[2*noDomains - 2] = m;
+		fstVtxSep[2*noDomains - 2] = 0;
+	    } else if ( permc_spec != PARMETIS && permc_spec != ZOLTAN ) {
+		printf("{" IFMT "," IFMT "}: psgssvx: invalid ColPerm option when ParSymbfact is used\n",
+		       MYROW(grid->iam, grid), MYCOL(grid->iam, grid));
+	    }
+        }
+
+	if ( permc_spec != MY_PERMC && Fact == DOFACT ) {
+          /* Reuse perm_c if Fact == SamePattern, or SamePattern_SameRowPerm */
+	  if ( permc_spec == PARMETIS || permc_spec == ZOLTAN ) {
+	// #pragma omp parallel
+    // {
+	// #pragma omp master
+	// {
+	      /* Get column permutation vector in perm_c.                    *
+	       * This routine takes as input the distributed input matrix A  *
+	       * and does not modify it.  It also allocates memory for       *
+	       * sizes[] and fstVtxSep[] arrays, that contain information    *
+	       * on the separator tree computed by ParMETIS.                 */
+	      if ( permc_spec == ZOLTAN )
+		  flinfo = get_perm_c_ptscotch(A, perm_r, perm_c, nprocs_num,
+					       noDomains, &sizes, &fstVtxSep,
+					       grid, &symb_comm);
+	      else
+	      flinfo = get_perm_c_parmetis(A, perm_r, perm_c, nprocs_num,
+                                  	   noDomains, &sizes, &fstVtxSep,
+                                           grid, &symb_comm);
+	// }
+	// }
+	      if (flinfo > 0) {
+#if ( PRNTlevel>=1 )
+	          fprintf(stderr, "Insufficient memory for get_perm_c parmetis\n");
+#endif
+		  *info = flinfo;
+		  superlu_mem_tag(mem_tag);
+		  SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
+		  return;
+     	      }
+	  } else if ( order_rank >= 0 ) { /* computed during MC64 */
+	      MPI_Bcast(perm_c, n, mpi_int_t, order_rank, grid->comm);
+	  } else if ( need_GA ) { /* else perm_c[] is set above */
+	      /* With PatternCache = YES, perm_c[], etree[] and the serial
+		 symbolic factorization of a known pattern are reused. */
+	      symb_cacheable = options->PatternCache == YES && parSymbFact == NO
+			       && permc_spec != MY_PERMC;
+	      if ( symb_cacheable ) {
+		  symbfact_cache_key(options, &GA, &symb_key);
+		  symb_cached = symbfact_cache_get(&symb_key, perm_c, etree,
+						   Glu_persist, &Glu_freeable,
+						   &iinfo, grid);
+	      }
+	      /* The ordering is the same on every process: it is computed
+		 once, by process 0, and broadcast. */
+	      if ( !symb_cached ) {
+		  if ( permc_spec == NATURAL || permc_spec == MY_PERMC ) {
+		      get_perm_c_block(iam, permc_spec, options->DofBlock, &GA,
+				       perm_c);
+		  } else {
+		      if ( !iam )
+			  get_perm_c_block(iam, permc_spec, options->DofBlock,
+					   &GA, perm_c);
+		      MPI_Bcast(perm_c, n, mpi_int_t, 0, grid->comm);
+		  }
+	      }
+          }
+        }
+
+	stat->utime[COLPERM] = SuperLU_timer_() - t + t_order;
+
+	/* Symbolic factorization. */
+	if ( Fact != SamePattern_SameRowPerm ) {
+	    if ( symb_cached ) { /* Taken from the cache with perm_c[] */
+		nnzLU = Glu_freeable->nnzLU;
+		stat->utime[SYMBFAC] = 0.0;
+		QuerySpace_dist(n, -iinfo, Glu_freeable, &symb_mem_usage);
+	    } else if ( symb_user ) { /* Supplied with perm_c[] */
+		t = SuperLU_timer_();
+		if ( !(Glu_freeable = (Glu_freeable_t *)
+		      SUPERLU_MALLOC(sizeof(Glu_freeable_t))) )
+		    ABORT("Malloc fails for Glu_freeable.");
+		if ( symbfact_user(LUstruct->usymb, n, A, perm_r, perm_c, etree,
+				   Glu_persist, Glu_freeable, grid) ) {
+		    if ( !iam )
+			printf("ERROR: the structure of LUstruct->usymb is not "
+			       "valid, see symbfact_user().\n");
+		    SUPERLU_FREE(Glu_freeable);
+		    if ( need_GA ) Destroy_CompCol_Matrix_dist(&GA);
+		    *info = -8;
+		    superlu_mem_tag(mem_tag);
+		    SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
+		    return;
+		}
+		nnzLU = Glu_freeable->nnzLU;
+		stat->utime[SYMBFAC] = SuperLU_timer_() - t;
+		QuerySpace_dist(n, Glu_freeable->xlsub[n], Glu_freeable,
+				&symb_mem_usage);
+	    } else if ( parSymbFact == NO ) { /* Perform serial symbolic factorization */
+		/* GA = Pr*A, perm_r[] is already applied. */
+	        int_t *GACcolbeg, *GACcolend, *GACrowind;
+
+	        /* Compute the elimination tree of Pc*(A^T+A)*Pc^T or Pc*A^T*A*Pc^T
+	           (a.k.a. column etree), depending on the choice of ColPerm,
+	           on the distributed A.
+	           Adjust perm_c[] to be consistent with a postorder of etree.
+	           Permute columns of A to form A*Pc'.
+		   After this routine, GAC = GA*Pc^T.  */
+	        sp_colorder_loc(options, &GA, perm_c, etree, &GAC,
+				A, perm_r, grid);
+
+		{
+		    /* Size the L & U subscripts of symbfact() from the column
+		       counts of the Cholesky factor of Pc*(Pr*A+(Pr*A)^T)*Pc^T,
+		       or of Pc*A^T*A*Pc^T, whose etree was computed. */
+		    int_t *colcnt;
+		    if ( !(colcnt = intMalloc_dist(n)) )
+			ABORT("Malloc fails for colcnt[].");
+		    if ( options->ColPerm == MMD_ATA )
+			sp_colcounts_ata_dist_loc(A, perm_c, etree, colcnt,
+						  grid);
+		    else
+			sp_colcounts_dist_loc(A, perm_r, perm_c, etree, colcnt,
+					      grid);
+		    symbfact_estimate(options, &GAC, etree, colcnt);
+		    SUPERLU_FREE(colcnt);
+		}
+
+	        /* Form Pc*A*Pc^T to preserve the diagonal of the matrix GAC. */
+	        GACstore = (NCPformat *) GAC.Store;
+	        GACcolbeg = GACstore->colbeg;
+	        GACcolend = GACstore->colend;
+	        GACrowind = GACstore->rowind;
+	        for (j = 0; j < n; ++j) {
+	            for (i = GACcolbeg[j]; i < GACcolend[j]; ++i) {
+		        irow = GACrowind[i];
+		        GACrowind[i] = perm_c[irow];
+	            }
+	        }
+
+	        /* Perform a symbolic factorization on Pc*Pr*A*Pc^T and set up
+                   the nonzero data structures for L & U. */
+#if ( PRNTlevel>=1 )
+                if ( !iam ) {
+		    printf(".. symbfact(): relax " IFMT ", maxsuper " IFMT ", fill " IFMT "\n",
+		          sp_ienv_dist(2), sp_ienv_dist(3), sp_ienv_dist(6));
+		    fflush(stdout);
+	        }
+#endif
+  	        t = SuperLU_timer_();
+	        if ( !(Glu_freeable = (Glu_freeable_t *)
+		      SUPERLU_MALLOC(sizeof(Glu_freeable_t))) )
+		    ABORT("Malloc fails for Glu_freeable.");
+
+	    	/* One process of each node does this. */
+	    	iinfo = symbfact_node(options, iam, &GAC, perm_c, etree,
+				      Glu_persist, Glu_freeable, grid);
+			nnzLU = Glu_freeable->nnzLU;
+	    	stat->utime[SYMBFAC] = SuperLU_timer_() - t;
+	    	if ( iinfo <= 0 ) { /* Successful return */
+		    QuerySpace_dist(n, -iinfo, Glu_freeable, &symb_mem_usage);
+		    /* A narrow band is factored by block columns of its
+		       width, see symbfact_band(). */
+		    if ( options->ColPerm == RCM_AT_PLUS_A
+			 && symbfact_band(options, n, Glu_persist, Glu_freeable) ) {
+			nnzLU = Glu_freeable->nnzLU;
+		    } else if ( options->Amalg_Tol > 0.0 ) {
+			symbfact_amalgamate(options, n, Glu_persist, Glu_freeable);
+			nnzLU = Glu_freeable->nnzLU;
+		    }
+		    if ( options->SplitSuper > 0 ) {
+			symbfact_split(options, n, Glu_persist, Glu_freeable);
+			nnzLU = Glu_freeable->nnzLU;
+		    }
+		    if ( symb_cacheable )
+			symbfact_cache_put(&symb_key, perm_c, etree,
+					   Glu_persist, Glu_freeable, iinfo);
+#if ( PRNTlevel>=1 )
+		    if ( !iam ) {
+		    	printf("\tNo of supers " IFMT "\n", Glu_persist->supno[n-1]+1);
+		    	printf("\tSize of G(L) " IFMT "\n", Glu_freeable->xlsub[n]);
+		    	printf("\tSize of G(U) " IFMT "\n", Glu_freeable->xusub[n]);
+		    	printf("\tint %d, short %d, float %d, float %d\n",
+			       (int) sizeof(int_t), (int) sizeof(short),
+        		       (int) sizeof(float), (int) sizeof(float));
+		    	printf("\tSYMBfact (MB):\tL\\U %.2f\ttotal %.2f\texpansions " IFMT "\n",
+			   	symb_mem_usage.for_lu*1e-6,
+			   	symb_mem_usage.total*1e-6,
+			   	symb_mem_usage.expansions);
+			fflush(stdout);
+		    }
+#endif
+	    	} else { /* symbfact out of memory */
+#if ( PRNTlevel>=1 )
+		    if ( !iam )
+		        fprintf(stderr,"symbfact() error returns " IFMT "\n",iinfo);
+#endif
+		    *info = iinfo;
+		    superlu_mem_tag(mem_tag);
+		    SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
+		    return;
+	        }
+	    } /* end serial symbolic factorization */
+	    else {  /* parallel symbolic factorization */
+	    	t = SuperLU_timer_();
+	    	flinfo = symbfact_dist(nprocs_num, noDomains, A, perm_c, perm_r,
+				       sizes, fstVtxSep, &Pslu_freeable,
+				       &(grid->comm), &symb_comm,
+				       &symb_mem_usage);
+			nnzLU = Pslu_freeable.nnzLU;
+	    	stat->utime[SYMBFAC] = SuperLU_timer_() - t;
+	    	if (flinfo > 0) {
+#if ( PRNTlevel>=1 )
+	      	    fprintf(stderr, "Insufficient memory for parallel symbolic factorization.");
+#endif
+		    *info = flinfo;
+		    superlu_mem_tag(mem_tag);
+		    SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
+		    return;
+                }
+	    }
+
+	    /* Predict the memory of the factorization on this grid from
+	       the serial symbolic factorization. */
+	    if ( options->Predict == YES && parSymbFact == NO && !iam ) {
+		superlu_predict_t *pred;
+		int nthreads = 1;
+#ifdef _OPENMP
+		nthreads = omp_get_max_threads();
+#endif
+		if ( !(pred = SUPERLU_MALLOC(grid->nprow * grid->npcol
+					     * sizeof(superlu_predict_t))) )
+		    ABORT("Malloc fails for pred[].");
+		superlu_predict(options, n, Glu_persist, Glu_freeable,
+				grid->nprow, grid->npcol, nthreads,
+				sizeof(float), pred);
+		superlu_predict_print(grid->nprow, grid->npcol, pred);
+		superlu_simulate_print(options, n, Glu_persist, Glu_freeable,
+				       grid->nprow, grid->npcol, nthreads,
+				       nrhs, sizeof(float));
+		SUPERLU_FREE(pred);
+	    }
+
+            /* Destroy global GA */
+            if ( need_GA ) Destroy_CompCol_Matrix_dist(&GA);
+            if ( parSymbFact == NO && !symb_cached && !symb_user )
+ 	        Destroy_CompCol_Permuted_dist(&GAC);
+
+	} /* end if Fact != SamePattern_SameRowPerm ... */
+
+        if (sizes) SUPERLU_FREE (sizes);
+        if (fstVtxSep) SUPERLU_FREE (fstVtxSep);
+	if (symb_comm != MPI_COMM_NULL) MPI_Comm_free (&symb_comm);
+
+	SUPERLU_PROF_END(PROF_ANALYSIS, EMPTY);
+	superlu_mem_tag(SUPERLU_MEM_FACTORS);
+	SUPERLU_PROF_BEGIN(PROF_DIST, EMPTY);
+	LUstruct->Llu->release = ( (options->ReleaseMemory == YES
+				    || options->Solve_Compact == YES)
+				   && options->SingleFactor != YES );
+
+	/* Distribute entries of A into L & U data structures.
+	   With SamePattern_SameRowPerm, only the values of A are moved
+	   into the existing L & U, whichever symbolic factorization
+	   produced them. */
+	if ( parSymbFact == NO || Fact == SamePattern_SameRowPerm ) {
+	    /* CASE OF SERIAL SYMBOLIC */
+  	    /* Apply column permutation to the original distributed A */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+	    for (j = 0; j < nnz_loc; ++j) colind[j] = perm_c[colind[j]];
+
+	    /* Distribute Pc*Pr*diag(R)*A*diag(C)*Pc^T into L and U storage.
+	       NOTE: the row permutation Pc*Pr is applied internally in the
+  	       distribution routine. */
+	    t = SuperLU_timer_();
+	    LUstruct->Llu->ooc = ( options->OutOfCore == YES );
+	    dist_mem_use = psdistribute(Fact, n, A, ScalePermstruct,
+                                      Glu_freeable, LUstruct, grid);
+	    stat->utime[DIST] = SuperLU_timer_() - t;
+
+  	    /* Deallocate storage used in symbolic factorization. */
+	    if ( Fact != SamePattern_SameRowPerm ) {
+	        iinfo = symbfact_SubFree(Glu_freeable);
+	        SUPERLU_FREE(Glu_freeable);
+	    }
+	} else { /* CASE OF PARALLEL SYMBOLIC */
+	    /* Distribute Pc*Pr*diag(R)*A*diag(C)*Pc' into L and U storage.
+	       NOTE: the row permutation Pc*Pr is applied internally in the
+	       distribution routine. */
+	    /* Apply column permutation to the original distributed A */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+	    for (j = 0; j < nnz_loc; ++j) colind[j] = perm_c[colind[j]];
+
+    	    t = SuperLU_timer_();
+	    dist_mem_use = sdist_psymbtonum(Fact, n, A, ScalePermstruct,
+		  			   &Pslu_freeable, LUstruct, grid);
+	    if (dist_mem_use > 0)
+	        ABORT ("Not enough memory available for dist_psymbtonum\n");
+
+	    stat->utime[DIST] = SuperLU_timer_() - t;
+	}
+
+	SUPERLU_PROF_END(PROF_DIST, EMPTY);
+	/*if (!iam) printf ("\tDISTRIBUTE time  %8.2f\n", stat->utime[DIST]);*/
+
+	/* Keep the column indices of A for psgsrefactor(). */
+	if ( Fact != SamePattern_SameRowPerm && LUstruct->Llu->Acolind ) {
+	    SUPERLU_FREE(LUstruct->Llu->Acolind);
+	    LUstruct->Llu->Acolind = NULL;
+	}
+	if ( options->RefactorMap == YES && !LUstruct->Llu->Acolind ) {
+	    if ( !(LUstruct->Llu->Acolind = intMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+		ABORT("Malloc fails for Acolind[].");
+	    memcpy(LUstruct->Llu->Acolind, colind, nnz_loc * sizeof(int_t));
+	}
+
+	/* Perform numerical factorization in parallel. */
+	t = SuperLU_timer_();
+    // #pragma omp parallel
+    // {
+	// #pragma omp master
+	// {
+	psgstrf(options, m, n, anorm, LUstruct, grid, stat, info);
+	stat->utime[FACT] = SuperLU_timer_() - t;
+	superlu_mem_tag(mem_tag);
+	if ( LUstruct->Llu->release ) sRelease_LU(n, grid, LUstruct);
+	/* With a symmetric A1, U = diag(U)*L^T is not kept. */
+	if ( options->SymValues == YES )
+	    sDrop_U(options, n, ScalePermstruct, LUstruct, grid);
+	/* The factors are put in the layout of the solves by the first
+	   one, see sCompact_LU(). */
+	LUstruct->Llu->compact = ( options->Solve_Compact == YES
+				   && LUstruct->Llu->release
+				   && !LUstruct->Llu->Udropped );
+
+	if ( options->DiagInv == YES ) {
+	    /* The inverses are computed by the first solve, see psgstrs(). */
+	    psDefer_Diag_Inv(options, LUstruct);
+	}
+
+	/* The refinement set up by a previous call keeps A in the form of
+	   psgsmv_init(); a new A of the same pattern is put in it. */
+	if ( Fact == SamePattern_SameRowPerm && options->RefineInitialized == YES )
+	    psgsmv_reuse(A, SOLVEstruct->row_to_proc, SOLVEstruct->A_colind_gsmv,
+			 grid);
+	// }
+	// }
+
+
+#if ( PRNTlevel>=2 )
+    /* ------------------------------------------------------------
+       SUM OVER ALL ENTRIES OF A AND PRINT NNZ AND SIZE OF A.
+       ------------------------------------------------------------*/
+    Astore = (NRformat_loc *) A->Store;
+	xsup = Glu_persist->xsup;
+	nzval_a = Astore->nzval;
+
+
+	asum=0;
+    for (i = 0; i < Astore->m_loc; ++i) {
+        for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j) {
+	    asum += nzval_a[j];
+	}
+    }
+
+	nsupers = Glu_persist->supno[n-1] + 1;
+	nsupers_j = CEILING( nsupers, grid->npcol ); /* Number of local block columns */
+
+
+
+	lsum=0.0;
+	for (lk=0;lk<nsupers_j;++lk){
+		lsub = LUstruct->Llu->Lrowind_bc_ptr[lk];
+		lusup = LUstruct->Llu->Lnzval_bc_ptr[lk];
+		if(lsub){
+			k = MYCOL(grid->iam, grid)+lk*grid->npcol;  /* not sure */
+			knsupc = SuperSize( k );
+			nsupr = lsub[1];
+			for (j=0; j<knsupc; ++j)
+				for (i = 0; i < nsupr; ++i)
+					lsum +=lusup[j*nsupr+i];
+		}
+	}
+
+
+	MPI_Allreduce( &asum, &asum_tot,1, MPI_FLOAT, MPI_SUM, grid->comm );
+	MPI_Allreduce( &lsum, &lsum_tot,1, MPI_FLOAT, MPI_SUM, grid->comm );
+
+
+	MPI_Allreduce( &Astore->rowptr[Astore->m_loc], &nnz_tot,1, mpi_int_t, MPI_SUM, grid->comm );
+	// MPI_Bcast( &nnzLU, 1, mpi_int_t, 0, grid->comm );
+
+	MPI_Comm_rank( MPI_COMM_WORLD, &iam_g );
+
+    if (!iam_g) {
+	print_options_dist(options);
+	fflush(stdout);
+    }
+
+    printf(".. Ainfo mygid %5d   mysid %5d   nnz_loc " IFMT "  sum_loc  %e lsum_loc   %e nnz " IFMT " nnzLU %ld sum %e  lsum %e  N " IFMT "\n", iam_g,iam,Astore->rowptr[Astore->m_loc],asum, lsum, nnz_tot,nnzLU,asum_tot,lsum_tot,A->ncol);
+	fflush(stdout);
+#endif
+
+#if 0
+
+// #ifdef GPU_PROF
+
+//  if(!iam )
+//  {
+//      char* ttemp;
+
+//      ttemp = getenv("IO_FILE");
+//      if(ttemp!=NULL)
+//      {
+//          printf("File being opend is %s\n",ttemp );
+//          FILE* fp;
+//          fp = fopen(ttemp,"w");
+//          if(!fp)
+//          {
+//              fprintf(stderr," Couldn't open output file %s\n",ttemp);
+//          }
+
+//          int nsup=Glu_persist->supno[n-1]+1;
+//          int ii;
+//          for (ii = 0; ii < nsup; ++ii)
+//          {
+//                  fprintf(fp,"%d,%d,%d,%d,%d,%d\n",gs1.mnk_min_stats[ii],gs1.mnk_min_stats[ii+nsup],
+//                  gs1.mnk_min_stats[ii+2*nsup],
+//                  gs1.mnk_max_stats[ii],gs1.mnk_max_stats[ii+nsup],gs1.mnk_max_stats[ii+2*nsup]);
+//          }
+
+//          // lastly put the timeing stats that we need
+
+//          fprintf(fp,"Min %lf Max %lf totaltime %lf \n",gs1.osDgemmMin,gs1.osDgemmMax,stat->utime[FACT]);
+//          fclose(fp);
+//      }
+
+//  }
+// #endif
+
+#endif
+
+	if ( options->PrintStat ) {
+	    int_t TinyPivots;
+	    float for_lu, total, max, avg, temp;
+
+	    sQuerySpace_dist(n, LUstruct, grid, stat, &num_mem_usage);
+
+	    if (parSymbFact == TRUE) {
+	        /* The memory used in the redistribution routine
+		   includes the memory used for storing the symbolic
+  		   structure and the memory allocated for numerical
+		   factorization */
+	        temp = SUPERLU_MAX(symb_mem_usage.total, -dist_mem_use);
+                if ( need_GA )
+                    temp = SUPERLU_MAX(temp, GA_mem_use);
+            } else {
+	        temp = SUPERLU_MAX (
+                         symb_mem_usage.total + GA_mem_use, /* symbfact step */
+		         symb_mem_usage.for_lu + dist_mem_use +
+                             num_mem_usage.for_lu  /* distribution step */
+                       );
+            }
+
+	    temp = SUPERLU_MAX(temp, num_mem_usage.total);
+
+	    MPI_Reduce( &temp, &max,
+		       1, MPI_FLOAT, MPI_MAX, 0, grid->comm );
+	    MPI_Reduce( &temp, &avg,
+		       1, MPI_FLOAT, MPI_SUM, 0, grid->comm );
+	    MPI_Allreduce( &stat->TinyPivots, &TinyPivots, 1, mpi_int_t,
+			  MPI_SUM, grid->comm );
+	    stat->TinyPivots = TinyPivots;
+
+	    MPI_Reduce( &num_mem_usage.for_lu, &for_lu,
+		       1, MPI_FLOAT, MPI_SUM, 0, grid->comm );
+	    MPI_Reduce( &num_mem_usage.total, &total,
+		       1, MPI_FLOAT, MPI_SUM, 0, grid->comm );
+
+            if (!iam) {
+		printf("\n** Memory Usage **********************************\n");
+                printf("** NUMfact space (MB): (sum-of-all-processes)\n"
+		       "    L\\U :        %8.2f |  Total : %8.2f\n",
+		       for_lu * 1e-6, total * 1e-6);
+                printf("** Total highmark (MB):\n"
+		       "    Sum-of-all : %8.2f | Avg : %8.2f  | Max : %8.2f\n",
+		       avg * 1e-6,
+		       avg / grid->nprow / grid->npcol * 1e-6,
+		       max * 1e-6);
+		printf("**************************************************\n");
+		fflush(stdout);
+            }
+	} /* end printing stats */
+
+	if ( options->ShareReplicated == YES ) {
+	    /* Keep one copy per node of the replicated arrays. */
+	    nsupers = Glu_persist->supno[n-1] + 1;
+	    superlu_shm_share((void **) &ScalePermstruct->perm_r,
+			      m * sizeof(int_t), grid);
+	    superlu_shm_share((void **) &ScalePermstruct->perm_c,
+			      n * sizeof(int_t), grid);
+	    superlu_shm_share((void **) &LUstruct->etree, n * sizeof(int_t), grid);
+	    superlu_shm_share((void **) &Glu_persist->xsup,
+			      (nsupers + 1) * sizeof(int_t), grid);
+	    superlu_shm_share((void **) &Glu_persist->supno,
+			      n * sizeof(int_t), grid);
+	    perm_r = ScalePermstruct->perm_r;
+	    perm_c = ScalePermstruct->perm_c;
+	    etree = LUstruct->etree;
+	}
+
+    } /* end if (!factored) */
+
+
+    if ( options->Fact == DOFACT || options->Fact == SamePattern ) {
+	/* Need to reset the solve's communication pattern,
+	   because perm_r[] and/or perm_c[] is changed.    */
+	if ( options->SolveInitialized == YES ) { /* Initialized before */
+	    sSolveFinalize(options, SOLVEstruct); /* Clean up structure */
+	    options->SolveInitialized = NO;   /* Reset the solve state */
+	}
+     }
+    if ( !factored && options->SolveInitialized == YES ) {
+	/* The counts kept by psgstrs() are those of the previous L and U. */
+	sSolveWorkFree(SOLVEstruct);
+    }
+#if 0
+    /* Need to revisit: Why the following is not good enough for X-to-B
+       distribution -- inv_perm_c changed */
+	pxgstrs_finalize(SOLVEstruct->gstrs_comm);
+	psgstrs_init(A->ncol, m_loc, nrhs, fst_row, perm_r, perm_c, grid,
+	             LUstruct->Glu_persist, SOLVEstruct);
+#endif
+
+
+    /* ------------------------------------------------------------
+       Compute the solution matrix X.
+       ------------------------------------------------------------*/
+    if ( nrhs && *info == 0 ) {
+
+	if ( !(b_work = floatMalloc_dist(n)) )
+	    ABORT("Malloc fails for b_work[]");
+
+	/* ------------------------------------------------------------
+	   Scale the right-hand side if equilibration was performed.
+	   ------------------------------------------------------------*/
+	if ( notran ) {
+	    if ( rowequ ) {
+		b_col = B;
+		for (j = 0; j < nrhs; ++j) {
+		    irow = fst_row;
+		    for (i = 0; i < m_loc; ++i) {
+		        b_col[i] *= R[irow];
+		        ++irow;
+		    }
+		    b_col += ldb;
+		}
+	    }
+	} else if ( colequ ) {
+	    b_col = B;
+	    for (j = 0; j < nrhs; ++j) {
+	        irow = fst_row;
+		for (i = 0; i < m_loc; ++i) {
+		    b_col[i] *= C[irow];
+		    ++irow;
+		}
+		b_col += ldb;
+	    }
+	}
+
+	/* Save a copy of the right-hand side. */
+	ldx = ldb;
+	if ( !(X = floatMalloc_dist(((size_t)ldx) * nrhs)) )
+	    ABORT("Malloc fails for X[]");
+	x_col = X;  b_col = B;
+	for (j = 0; j < nrhs; ++j) {
+#if 0 /* Sherry */
+	    for (i = 0; i < m_loc; ++i) x_col[i] = b_col[i];
+#endif
+            memcpy(x_col, b_col, m_loc * sizeof(float));
+	    x_col += ldx;  b_col += ldb;
+	}
+
+	/* ------------------------------------------------------------
+	   Solve the linear system.
+	   ------------------------------------------------------------*/
+	if ( options->SolveInitialized == NO ) { /* First time */
+	    mem_tag = superlu_mem_tag(SUPERLU_MEM_REDIST);
+	    sSolveInit(options, A, perm_r, perm_c, nrhs, LUstruct, grid,
+		       SOLVEstruct);
+	    superlu_mem_tag(mem_tag);
+            /* Inside this routine, SolveInitialized is set to YES.
+	       For repeated call to psgssvx(), no need to re-initialilze
+	       the Solve data & communication structures, unless a new
+	       factorization with Fact == DOFACT or SamePattern is asked for. */
+	}
+
+	LUstruct->Llu->fixed_order = ( options->Reproducible == YES );
+	SOLVEstruct->sparse_rhs = options->SparseRHS;
+	SOLVEstruct->root_size = options->Solve_RootSize;
+	SOLVEstruct->crit_path = options->Solve_CritPath;
+	SOLVEstruct->priority = options->Solve_Priority;
+	SOLVEstruct->rhs_tile = options->Solve_RHSTile;
+	SOLVEstruct->refine_msg_prec = options->Refine_MsgPrec;
+	SOLVEstruct->msg_prec = SLU_MSG_FULL;
+
+	if ( options->ConditionNumber == YES ) {
+	    /* Estimate the reciprocal of the condition number of A1. */
+	    float rcond;
+	    int cinfo;
+	    psgscon(norm, n, anorm, LUstruct, ScalePermstruct, grid, m_loc,
+		    fst_row, SOLVEstruct, &rcond, stat, &cinfo);
+	    stat->RCond = rcond;
+	}
+
+
+	if ( !notran ) {
+	    /* The right-hand side of A_s'*Y = Pc*C*B is ordered as the
+	       columns of A_s; it is also used by the refinement. */
+	    psPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc,
+				   perm_c, X, ldx, X, ldx, nrhs, grid);
+	    x_col = X;  b_col = B;
+	    for (j = 0; j < nrhs; ++j) {
+		memcpy(b_col, x_col, m_loc * sizeof(float));
+		x_col += ldx;  b_col += ldb;
+	    }
+	}
+
+    // #pragma omp parallel
+    // {
+	// #pragma omp master
+	// {
+	if ( notran )
+	    psgstrs(n, LUstruct, ScalePermstruct, grid, X, m_loc,
+		    fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+	else
+	    psgstrs_trans(n, LUstruct, ScalePermstruct, grid, X, m_loc,
+			  fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+	// }
+	// }
+
+	/* ------------------------------------------------------------
+	   Use iterative refinement to improve the computed solution and
+	   compute error bounds and backward error estimates for it.
+	   ------------------------------------------------------------*/
+	if ( options->IterRefine ) {
+	    /* Improve the solution by iterative refinement. */
+	    int_t *it;
+            int_t *colind_gsmv = SOLVEstruct->A_colind_gsmv;
+	          /* This was allocated and set to NULL in sSolveInit() */
+	    sSOLVEstruct_t *SOLVEstruct1;  /* Used by refinement. */
+
+	    t = SuperLU_timer_();
+	    /* The product supplied in LUstruct->matvec does not use A. */
+	    if ( !LUstruct->matvec &&
+		 (options->RefineInitialized == NO || Fact == DOFACT) ) {
+	        /* All these cases need to re-initialize gsmv structure */
+	        if ( options->RefineInitialized )
+		    psgsmv_finalize(SOLVEstruct->gsmv_comm);
+	        mem_tag = superlu_mem_tag(SUPERLU_MEM_REDIST);
+	        psgsmv_init(A, SOLVEstruct->row_to_proc, grid,
+			    SOLVEstruct->gsmv_comm);
+	        superlu_mem_tag(mem_tag);
+
+                /* Save a copy of the transformed local col indices
+		   in colind_gsmv[]. */
+	        if ( colind_gsmv ) SUPERLU_FREE(colind_gsmv);
+	        if ( !(it = intMalloc_dist(nnz_loc)) )
+		    ABORT("Malloc fails for colind_gsmv[]");
+	        colind_gsmv = SOLVEstruct->A_colind_gsmv = it;
+	        for (i = 0; i < nnz_loc; ++i) colind_gsmv[i] = colind[i];
+	        options->RefineInitialized = YES;
+	    }
+
+	    if ( nrhs == 1 ) { /* Use the existing solve structure */
+	        SOLVEstruct1 = SOLVEstruct;
+	    } else { /* For nrhs > 1, since refinement is performed for RHS
+			one at a time, the communication structure for psgstrs
+			is different than the solve with nrhs RHS.
+			So we use SOLVEstruct1 for the refinement step.
+		     */
+	        if ( !(SOLVEstruct1 = (sSOLVEstruct_t *)
+		                       SUPERLU_MALLOC(sizeof(sSOLVEstruct_t))) )
+		    ABORT("Malloc fails for SOLVEstruct1");
+	        /* Copy the same stuff */
+	        SOLVEstruct1->row_to_proc = SOLVEstruct->row_to_proc;
+	        SOLVEstruct1->inv_perm_c = SOLVEstruct->inv_perm_c;
+	        SOLVEstruct1->num_diag_procs = SOLVEstruct->num_diag_procs;
+	        SOLVEstruct1->diag_procs = SOLVEstruct->diag_procs;
+	        SOLVEstruct1->diag_len = SOLVEstruct->diag_len;
+	        SOLVEstruct1->gsmv_comm = SOLVEstruct->gsmv_comm;
+	        SOLVEstruct1->A_colind_gsmv = SOLVEstruct->A_colind_gsmv;
+	        SOLVEstruct1->gstrs_work = NULL;
+	        SOLVEstruct1->sparse_rhs = SOLVEstruct->sparse_rhs;
+	        SOLVEstruct1->out_rows = NULL;
+	        SOLVEstruct1->x_layout = NO;
+	        SOLVEstruct1->root_size = SOLVEstruct->root_size;
+	        SOLVEstruct1->crit_path = SOLVEstruct->crit_path;
+	        SOLVEstruct1->priority = SOLVEstruct->priority;
+	        SOLVEstruct1->rhs_tile = SOLVEstruct->rhs_tile;
+	        SOLVEstruct1->refine_msg_prec = SOLVEstruct->refine_msg_prec;
+	        SOLVEstruct1->msg_prec = SLU_MSG_FULL;
+
+		/* Initialize the *gstrs_comm for 1 RHS. */
+		if ( !(SOLVEstruct1->gstrs_comm = (pxgstrs_comm_t *)
+		       SUPERLU_MALLOC(sizeof(pxgstrs_comm_t))) )
+		    ABORT("Malloc fails for gstrs_comm[]");
+		psgstrs_init(n, m_loc, 1, fst_row, perm_r, perm_c, grid,
+			     Glu_persist, SOLVEstruct1);
+	    }
+
+	    if ( options->IterRefine == SLU_GMRES )
+		psgsrfs_gmres(notran ? NOTRANS : TRANS, n, A, anorm, LUstruct,
+			      ScalePermstruct, grid, B, ldb, X, ldx, nrhs,
+			      SOLVEstruct1, berr, stat, info);
+	    else if ( notran )
+		psgsrfs(n, A, anorm, LUstruct, ScalePermstruct, grid,
+			B, ldb, X, ldx, nrhs, SOLVEstruct1, berr, stat, info);
+	    else
+		psgsrfs_trans(n, A, anorm, LUstruct, ScalePermstruct, grid,
+			      B, ldb, X, ldx, nrhs, SOLVEstruct1, berr, stat,
+			      info);
+
+            /* Deallocate the storage associated with SOLVEstruct1 */
+	    if ( nrhs > 1 ) {
+	        pxgstrs_finalize(SOLVEstruct1->gstrs_comm);
+	        sSolveWorkFree(SOLVEstruct1);
+	        SUPERLU_FREE(SOLVEstruct1);
+	    }
+
+	    stat->utime[REFINE] = SuperLU_timer_() - t;
+	} /* end if IterRefine */
+
+	if ( notran ) {
+	    /* Permute the solution matrix B <= Pc'*X. */
+	    psPermute_Dense_Matrix(fst_row, m_loc, SOLVEstruct->row_to_proc,
+				   SOLVEstruct->inv_perm_c,
+				   X, ldx, B, ldb, nrhs, grid);
+	} else { /* Y is ordered as the rows of A_s. */
+	    x_col = X;  b_col = B;
+	    for (j = 0; j < nrhs; ++j) {
+		memcpy(b_col, x_col, m_loc * sizeof(float));
+		x_col += ldx;  b_col += ldb;
+	    }
+	}
+#if ( DEBUGlevel>=2 )
+	printf("\n (%d) .. After psPermute_Dense_Matrix(): b =\n", iam);
+	for (i = 0; i < m_loc; ++i)
+	  printf("\t(%d)\t%4d\t%.10f\n", iam, i+fst_row, B[i]);
+#endif
+
+	/* Transform the solution matrix X to a solution of the original
+	   system before equilibration. */
+	if ( notran ) {
+	    if ( colequ ) {
+		b_col = B;
+		for (j = 0; j < nrhs; ++j) {
+		    irow = fst_row;
+		    for (i = 0; i < m_loc; ++i) {
+		        b_col[i] *= C[irow];
+		        ++irow;
+		    }
+		    b_col += ldb;
+		}
+	    }
+	} else if ( rowequ ) {
+	    b_col = B;
+	    for (j = 0; j < nrhs; ++j) {
+	        irow = fst_row;
+		for (i = 0; i < m_loc; ++i) {
+		    b_col[i] *= R[irow];
+		    ++irow;
+		}
+		b_col += ldb;
+	    }
+	}
+
+	SUPERLU_FREE(b_work);
+	SUPERLU_FREE(X);
+
+    } /* end if nrhs != 0 && *info == 0 */
+
+#if ( PRNTlevel>=1 )
+    if ( !iam ) printf(".. DiagScale = %d\n", ScalePermstruct->DiagScale);
+#endif
+
+    /* Deallocate R and/or C if it was not used. */
+    if ( Equil && Fact != SamePattern_SameRowPerm ) {
+	switch ( ScalePermstruct->DiagScale ) {
+	    case NOEQUIL:
+	        SUPERLU_FREE(R);
+		SUPERLU_FREE(C);
+		break;
+	    case ROW:
+		SUPERLU_FREE(C);
+		break;
+	    case COL:
+		SUPERLU_FREE(R);
+		break;
+	}
+    }
+
+#if 0
+    if ( !factored && Fact != SamePattern_SameRowPerm && !parSymbFact)
+ 	Destroy_CompCol_Permuted_dist(&GAC);
+#endif
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psgssvx()");
+#endif
+
+}
@@ -0,0 +1,686 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Solves A*X=B by factoring disjoint subtrees of the etree on
+ *        process subgroups
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_sdefs.h"
+
+static int
+subtree_cmp(const void *a, const void *b)
+{
+    const int_t *x = (const int_t *) a, *y = (const int_t *) b;
+    return (x[0] < y[0]) - (x[0] > y[0]);   /* decreasing sizes */
+}
+
+/* Assign the candidate subtrees cand[0:ncand-1] to ng groups, largest
+   first to the least loaded group. On return, grp[t] is the group of
+   cand[t]; the largest load is returned. */
+static int_t
+subtree_lpt(int_t ncand, int_t *cand, int_t *size, int ng, int_t *pair,
+	    int_t *load, int_t *grp)
+{
+    int_t t, maxload = 0;
+    int   g, gmin;
+
+    for (t = 0; t < ncand; ++t) {
+	pair[2*t] = size[cand[t]];
+	pair[2*t+1] = t;
+    }
+    qsort(pair, ncand, 2 * sizeof(int_t), subtree_cmp);
+    for (g = 0; g < ng; ++g) load[g] = 0;
+    for (t = 0; t < ncand; ++t) {
+	for (gmin = 0, g = 1; g < ng; ++g) if ( load[g] < load[gmin] ) gmin = g;
+	load[gmin] += pair[2*t];
+	grp[pair[2*t+1]] = gmin;
+	maxload = SUPERLU_MAX(maxload, load[gmin]);
+    }
+    return maxload;
+}
+
+/* Split the etree parent[] of order n into disjoint subtrees for at most
+   ngroups process groups. The root of the largest subtree is moved to
+   the separator until there are ngroups subtrees whose assignment is
+   balanced within 20%, or the largest subtree is a single node, or the
+   separator would hold half of the nodes. On return, label[j] is the
+   group of node j, or -1 if j is in the separator; the number of groups
+   used is returned. */
+static int
+subtree_groups(int_t n, int_t *parent, int ngroups, int_t *label)
+{
+    int_t *size, *kid, *sib, *cand, *grp, *pair, *load;
+    int_t i, j, t, big, root, ncand = 0, ns = 0, total, maxload;
+    int   ng;
+
+    if ( !(size = intMalloc_dist(8 * (n + 1) + ngroups)) )
+	ABORT("Malloc fails for size[].");
+    kid = size + n + 1;
+    sib = kid + n + 1;
+    cand = sib + n + 1;
+    grp = cand + n + 1;
+    pair = grp + n + 1;
+    load = pair + 2 * (n + 1);
+
+    for (j = 0; j <= n; ++j) { size[j] = 1; kid[j] = -1; }
+    for (j = n - 1; j >= 0; --j) {   /* children in increasing order */
+	sib[j] = kid[parent[j]];
+	kid[parent[j]] = j;
+    }
+    for (j = 0; j < n; ++j)
+	if ( parent[j] < n ) size[parent[j]] += size[j];
+    for (j = kid[n]; j >= 0; j = sib[j]) cand[ncand++] = j;
+    for (j = 0; j < n; ++j) label[j] = -2;
+
+    for (;;) {
+	for (total = 0, t = 0; t < ncand; ++t) total += size[cand[t]];
+	if ( ncand >= ngroups ) {
+	    maxload = subtree_lpt(ncand, cand, size, ngroups, pair, load, grp);
+	    if ( 5 * maxload * ngroups <= 6 * total ) break;
+	}
+	for (big = 0, t = 1; t < ncand; ++t)
+	    if ( size[cand[t]] > size[cand[big]] ) big = t;
+	root = cand[big];
+	if ( size[root] <= 1 || 2 * (ns + 1) > n ) break;
+	cand[big] = cand[--ncand];
+	label[root] = -1;
+	++ns;
+	for (i = kid[root]; i >= 0; i = sib[i]) cand[ncand++] = i;
+    }
+
+    ng = SUPERLU_MIN(ngroups, ncand);
+    if ( ng > 1 ) {
+	subtree_lpt(ncand, cand, size, ng, pair, load, grp);
+	for (t = 0; t < ncand; ++t) label[cand[t]] = grp[t];
+	for (j = n - 1; j >= 0; --j)
+	    if ( label[j] == -2 ) label[j] = label[parent[j]];
+    }
+    SUPERLU_FREE(size);
+    return ng;
+}
+
+/* Replace the interface block of the partially factored L and U by the
+   identity: the diagonal blocks of the interface supernodes become I and
+   their other blocks in L and U become 0. The L and U factors are then
+   those of [A11 A12; A21 A21*inv(A11)*A12 + I], whose solve with the
+   right-hand side [b1; r2] gives x2 = r2 - A21*inv(A11)*b1 and
+   x1 = inv(A11)*(b1 - A12*x2). */
+static void
+schur_set_identity(int_t n, int_t ns, sLUstruct_t *LUstruct, gridinfo_t *grid)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    sLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = Glu_persist->xsup;
+    int_t nsupers = Glu_persist->supno[n-1] + 1;
+    int_t ksch = Glu_persist->supno[n - ns];
+    int_t nlb = CEILING( nsupers, grid->nprow );
+    int_t nub = CEILING( nsupers, grid->npcol );
+    int_t lb, ljb, gb, *lsub, *usub;
+    int   myrow = MYROW( grid->iam, grid ), mycol = MYCOL( grid->iam, grid );
+    int   knsupc, nsupr, c;
+    size_t i;
+    float *lusup, *uval;
+
+    for (ljb = 0; ljb < nub; ++ljb) {
+	gb = ljb * grid->npcol + mycol;
+	if ( gb < ksch || gb >= nsupers || !(lsub = Llu->Lrowind_bc_ptr[ljb]) )
+	    continue;
+	lusup = Llu->Lnzval_bc_ptr[ljb];
+	knsupc = SuperSize( gb );
+	nsupr = lsub[1];
+	for (i = 0; i < (size_t) knsupc * nsupr; ++i) lusup[i] = 0.0;
+	if ( myrow == PROW( gb, grid ) )  /* The diagonal block is first. */
+	    for (c = 0; c < knsupc; ++c) lusup[c + c * nsupr] = 1.0;
+    }
+    for (lb = 0; lb < nlb; ++lb) {
+	gb = lb * grid->nprow + myrow;
+	if ( gb < ksch || gb >= nsupers || !(usub = Llu->Ufstnz_br_ptr[lb]) )
+	    continue;
+	uval = Llu->Unzval_br_ptr[lb];
+	for (i = 0; i < (size_t) usub[1]; ++i) uval[i] = 0.0;
+    }
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSSVX_SUBTREE solves A*X = B like psgssvx(), but factors disjoint
+ * subtrees of the elimination tree on disjoint groups of processes.
+ *
+ * The etree of Pc*(A'+A)*Pc', with Pc given by options->ColPerm, is
+ * split into subtrees by moving the roots of the largest subtrees to a
+ * separator, and the subtrees are assigned to at most ngroups groups of
+ * consecutive processes, balancing the number of columns. Each group
+ * forms the domain matrix
+ *
+ *     A_g = [ A(I,I)  A(I,S) ]
+ *           [ A(S,I)    I    ]
+ *
+ * of its interior columns I and the separator S, and factors it on its
+ * own process grid with psgssvx(options->SchurSize = |S|), which needs no
+ * communication with the other groups. The separator system
+ *
+ *     (A(S,S) + sum_g (Schur complement of A_g - I)) * X(S) = B'(S)
+ *
+ * is then factored and solved by psgssvx() on the whole grid, and the
+ * interior unknowns are recovered by two solves with each domain.
+ *
+ * The domains are factored with RowPerm = NOROWPERM: the pivots of the
+ * interior come from the diagonal of A (possibly equilibrated, see the
+ * ReplaceTinyPivot option). The other options are those of psgssvx(),
+ * and apply as given to the separator system. There is no iterative
+ * refinement of the whole system; check the residual if needed.
+ * A and B are gathered on every process.
+ *
+ * The trees of the etree are the connected components of A'+A. When A is
+ * block diagonal, up to permutation, and its components balance the
+ * groups as above, the separator is empty: each group solves the system
+ * of its components, A(I,I)*X(I) = B(I), by psgssvx() with the options
+ * given (RowPerm and IterRefine included), without any communication
+ * with the other groups until X is gathered, and there is no separator
+ * system.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         The options of psgssvx(); options->Fact must be DOFACT.
+ *
+ * A       (input) SuperMatrix*
+ *         The matrix A, distributed by block rows as for psgssvx()
+ *         (Stype = SLU_NR_loc; Dtype = SLU_S; Mtype = SLU_GE).
+ *         A is not modified.
+ *
+ * ngroups (input) int
+ *         The maximum number of process groups. With ngroups = 1, or if
+ *         the etree cannot be split, psgssvx() is called on a copy of A.
+ *
+ * B       (input/output) float*, dimension (ldb, nrhs)
+ *         On entry, the local rows of the right-hand side matrix B.
+ *         On exit, the local rows of the solution matrix X.
+ *
+ * ldb     (input) int (local)
+ *         The leading dimension of B.
+ *
+ * nrhs    (input) int (global)
+ *         The number of right-hand sides.
+ *
+ * grid    (input) gridinfo_t*
+ *         The 2D process mesh.
+ *
+ * stat    (output) SuperLUStat_t*
+ *         The statistics of the factorization of the separator system;
+ *         unchanged without a separator.
+ *
+ * info    (output) int*
+ *         = 0: successful exit
+ *         < 0: if info = -i, the i-th argument had an illegal value
+ *         > 0: the factorization of a domain or of the separator system
+ *              failed, see psgssvx().
+ * </pre>
+ */
+void
+psgssvx_subtree(superlu_dist_options_t *options, SuperMatrix *A,
+		int ngroups, float B[], int ldb, int nrhs,
+		gridinfo_t *grid, SuperLUStat_t *stat, int *info)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    NCformat *GAstore;
+    NRformat_loc *Sgstore;
+    SuperMatrix GA, Ag, Sg, S;
+    superlu_dist_options_t dopts, sopts;
+    sScalePermstruct_t gSP, sSP;
+    sLUstruct_t gLU, sLU;
+    sSOLVEstruct_t gSOLVE, sSOLVE;
+    SuperLUStat_t gstat;
+    gridinfo_t ggrid;
+    MPI_Comm gcomm;
+    int_t n = A->ncol, m_loc = Astore->m_loc, fst_row = Astore->fst_row;
+    int_t *perm_c, *parent, *label, *glob, *dloc, *sidx, *arow, *acol;
+    int_t *b_colptr, *b_rowind, *c_colbeg, *c_colend, bnz;
+    int_t *rowptr, *colind, *sendidx, *recvidx, *cnt;
+    int_t i, j, k, kk, s, t, ni, ns, nd, g_fst, g_loc, g_loc_fst;
+    int_t s_fst, s_loc, s_loc_fst, nloc, nnz_loc, nnz_s, ldg, lds;
+    float *aval, *nzval, *bg, *r1, *r2, *rs, *xs, *X, *D, *berr;
+    float *sendval, *recvval;
+    int   iam = grid->iam, nprocs = grid->nprow * grid->npcol;
+    int   ng, mygroup, gsize, gprow, p, ginfo;
+    int   *counts, *displs, *sendcnts, *sdispls, *recvcnts, *rdispls;
+    colperm_t permc_spec;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter psgssvx_subtree()");
+#endif
+
+    /* Test the input parameters. */
+    *info = 0;
+    if ( options->Fact != DOFACT || options->SchurSize != 0 ) *info = -1;
+    else if ( A->nrow != A->ncol || A->nrow < 0 || A->Stype != SLU_NR_loc
+	      || A->Dtype != SLU_S || A->Mtype != SLU_GE )
+	*info = -2;
+    else if ( ngroups < 1 ) *info = -3;
+    else if ( ldb < m_loc ) *info = -5;
+    else if ( nrhs < 0 ) *info = -6;
+    if ( *info ) {
+	pxerr_dist("psgssvx_subtree", grid, -*info);
+	return;
+    }
+
+    /* Gather A on every process and compute the etree of Pc*(A'+A)*Pc'. */
+    psCompRow_loc_to_CompCol_global(1, A, grid, &GA);
+    GAstore = (NCformat *) GA.Store;
+    permc_spec = options->ColPerm;
+    if ( permc_spec == MY_PERMC || permc_spec == PARMETIS
+	 || permc_spec == ZOLTAN )
+	permc_spec = MMD_AT_PLUS_A;
+
+    if ( !(perm_c = intMalloc_dist(4 * n + 1)) )
+	ABORT("Malloc fails for perm_c[].");
+    parent = perm_c + n;
+    label = parent + n + 1;
+    glob = label + n;
+    get_perm_c_dist(iam, permc_spec, &GA, perm_c);
+
+    at_plus_a_dist(n, GAstore->nnz, GAstore->colptr, GAstore->rowind,
+		   &bnz, &b_colptr, &b_rowind);
+    if ( !(c_colbeg = intMalloc_dist(2 * n)) )
+	ABORT("Malloc fails for c_colbeg[].");
+    c_colend = c_colbeg + n;
+    for (i = 0; i < n; ++i) {
+	c_colbeg[perm_c[i]] = b_colptr[i];
+	c_colend[perm_c[i]] = b_colptr[i+1];
+    }
+    for (i = 0; i < bnz; ++i) b_rowind[i] = perm_c[b_rowind[i]];
+    sp_symetree_dist(c_colbeg, c_colend, b_rowind, n, parent);
+    SUPERLU_FREE(b_colptr);
+    if ( bnz ) SUPERLU_FREE(b_rowind);
+    SUPERLU_FREE(c_colbeg);
+
+    ng = nprocs > 1 ? subtree_groups(n, parent, SUPERLU_MIN(ngroups, nprocs),
+				     label) : 1;
+
+    if ( ng <= 1 ) {
+	/* Nothing to split: solve on the whole grid. */
+	SuperMatrix Ac;
+	int_t nnz_a = Astore->rowptr[m_loc];
+
+	if ( !(nzval = floatMalloc_dist(nnz_a + 1)) )
+	    ABORT("Malloc fails for nzval[].");
+	if ( !(colind = intMalloc_dist(nnz_a + 1)) )
+	    ABORT("Malloc fails for colind[].");
+	if ( !(rowptr = intMalloc_dist(m_loc + 1)) )
+	    ABORT("Malloc fails for rowptr[].");
+	memcpy(nzval, Astore->nzval, nnz_a * sizeof(float));
+	memcpy(colind, Astore->colind, nnz_a * sizeof(int_t));
+	memcpy(rowptr, Astore->rowptr, (m_loc + 1) * sizeof(int_t));
+	sCreate_CompRowLoc_Matrix_dist(&Ac, n, n, nnz_a, m_loc, fst_row,
+				       nzval, colind, rowptr,
+				       SLU_NR_loc, SLU_S, SLU_GE);
+	if ( !(berr = floatMalloc_dist(SUPERLU_MAX(nrhs, 1))) )
+	    ABORT("Malloc fails for berr[].");
+	sopts = *options;
+	sopts.SolveInitialized = NO;
+	sScalePermstructInit(n, n, &sSP);
+	sLUstructInit(n, &sLU);
+	psgssvx(&sopts, &Ac, &sSP, B, ldb, nrhs, grid, &sLU, &sSOLVE,
+		berr, stat, info);
+	sDestroy_LU(n, grid, &sLU);
+	sScalePermstructFree(&sSP);
+	sLUstructFree(&sLU);
+	if ( sopts.SolveInitialized ) sSolveFinalize(&sopts, &sSOLVE);
+	Destroy_CompRowLoc_Matrix_dist(&Ac);
+	Destroy_CompCol_Matrix_dist(&GA);
+	SUPERLU_FREE(berr);
+	SUPERLU_FREE(perm_c);
+	return;
+    }
+
+    /* Groups of consecutive processes, each on its own process grid. */
+    mygroup = (int) (((long) iam * ng) / nprocs);
+    MPI_Comm_split(grid->comm, mygroup, iam, &gcomm);
+    MPI_Comm_size(gcomm, &gsize);
+    for (gprow = (int) sqrt((double) gsize); gsize % gprow; --gprow) ;
+    superlu_gridinit(gcomm, gprow, gsize / gprow, &ggrid);
+
+    /* Number the interior columns of the group first and the separator
+       last, both in the order of Pc: glob[k] is the column of A of
+       column k of A_g, and dloc[i] the column of A_g of column i of A
+       (-1 if none); sidx[i] is the separator index of column i. */
+    if ( !(dloc = intMalloc_dist(2 * n)) ) ABORT("Malloc fails for dloc[].");
+    sidx = dloc + n;
+    for (i = 0; i < n; ++i) glob[perm_c[i]] = i;  /* inverse of Pc */
+    for (i = 0; i < n; ++i) { dloc[i] = -1; sidx[i] = -1; }
+    for (ni = 0, j = 0; j < n; ++j)
+	if ( label[j] == mygroup ) dloc[glob[j]] = ni++;
+    for (ns = 0, j = 0; j < n; ++j)
+	if ( label[j] == -1 ) { sidx[glob[j]] = ns; dloc[glob[j]] = ni + ns++; }
+    nd = ni + ns;
+    for (i = 0; i < n; ++i) if ( dloc[i] >= 0 ) glob[dloc[i]] = i;
+
+#if ( PRNTlevel>=1 )
+    if ( !iam )
+	printf(".. Subtree groups %d, separator %ld of %ld columns\n",
+	       ng, (long) ns, (long) n);
+#endif
+
+    /* The rows of A in compressed row storage. */
+    if ( !(arow = intMalloc_dist(n + 1 + GAstore->nnz)) )
+	ABORT("Malloc fails for arow[].");
+    acol = arow + n + 1;
+    if ( !(aval = floatMalloc_dist(GAstore->nnz + 1)) )
+	ABORT("Malloc fails for aval[].");
+    for (i = 0; i <= n; ++i) arow[i] = 0;
+    for (t = 0; t < GAstore->nnz; ++t) ++arow[GAstore->rowind[t] + 1];
+    for (i = 0; i < n; ++i) arow[i+1] += arow[i];
+    for (j = 0; j < n; ++j)
+	for (t = GAstore->colptr[j]; t < GAstore->colptr[j+1]; ++t) {
+	    k = arow[GAstore->rowind[t]]++;
+	    acol[k] = j;
+	    aval[k] = ((float *) GAstore->nzval)[t];
+	}
+    for (i = n; i > 0; --i) arow[i] = arow[i-1];
+    arow[0] = 0;
+    Destroy_CompCol_Matrix_dist(&GA);
+
+    /* The local rows of A_g, as in the examples. */
+    g_loc_fst = nd / gsize;
+    g_fst = ggrid.iam * g_loc_fst;
+    g_loc = ggrid.iam == gsize - 1 ? nd - g_fst : g_loc_fst;
+    for (nloc = 0, k = g_fst; k < g_fst + g_loc; ++k)
+	nloc += arow[glob[k]+1] - arow[glob[k]] + 1;
+    if ( !(rowptr = intMalloc_dist(g_loc + 1)) )
+	ABORT("Malloc fails for rowptr[].");
+    if ( !(colind = intMalloc_dist(nloc + 1)) )
+	ABORT("Malloc fails for colind[].");
+    if ( !(nzval = floatMalloc_dist(nloc + 1)) )
+	ABORT("Malloc fails for nzval[].");
+    for (nloc = 0, rowptr[0] = 0, k = g_fst; k < g_fst + g_loc; ++k) {
+	i = glob[k];
+	for (t = arow[i]; t < arow[i+1]; ++t) {
+	    kk = dloc[acol[t]];
+	    if ( kk < 0 || (k >= ni && kk >= ni) ) continue;
+	    colind[nloc] = kk;
+	    nzval[nloc++] = aval[t];
+	}
+	if ( k >= ni ) { colind[nloc] = k; nzval[nloc++] = 1.0; }
+	rowptr[k - g_fst + 1] = nloc;
+    }
+    sCreate_CompRowLoc_Matrix_dist(&Ag, nd, nd, nloc, g_loc, g_fst,
+				   nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_S, SLU_GE);
+
+    /* Factor the interior of A_g and get its Schur complement. */
+    if ( !(berr = floatMalloc_dist(SUPERLU_MAX(nrhs, 1))) )
+	ABORT("Malloc fails for berr[].");
+    dopts = *options;
+    dopts.SchurSize = ns;
+    if ( ns ) dopts.RowPerm = NOROWPERM;
+    dopts.ParSymbFact = NO;
+    dopts.SingleFactor = NO;
+    dopts.ColPerm = permc_spec;
+    dopts.PrintStat = NO;
+    dopts.SolveInitialized = NO;
+    sScalePermstructInit(nd, nd, &gSP);
+    sLUstructInit(nd, &gLU);
+    PStatInit(&gstat);
+    psgssvx(&dopts, &Ag, &gSP, berr, g_loc, 0, &ggrid, &gLU, &gSOLVE,
+	    berr, &gstat, &ginfo);
+    MPI_Allreduce(&ginfo, info, 1, MPI_INT, MPI_MAX, grid->comm);
+
+    if ( *info == 0 ) {
+	/* Gather B on every process. */
+	if ( !(counts = SUPERLU_MALLOC(2 * nprocs * sizeof(int))) )
+	    ABORT("Malloc fails for counts[].");
+	displs = counts + nprocs;
+	p = m_loc;
+	MPI_Allgather(&p, 1, MPI_INT, counts, 1, MPI_INT, grid->comm);
+	for (p = 0, displs[0] = 0; p < nprocs - 1; ++p)
+	    displs[p+1] = displs[p] + counts[p];
+	ldg = SUPERLU_MAX(g_loc, 1);
+	if ( !(bg = floatMalloc_dist((size_t) (2 * n + 3 * ldg + 2 * ns + 1)
+				      * SUPERLU_MAX(nrhs, 1))) )
+	    ABORT("Malloc fails for bg[].");
+	X = bg + (size_t) n * nrhs;
+	r1 = X + (size_t) n * nrhs;
+	r2 = r1 + (size_t) ldg * nrhs;
+	rs = r2 + (size_t) ldg * nrhs;
+	D = rs + (size_t) ns * nrhs;
+	xs = D + ldg;
+	for (j = 0; j < nrhs; ++j)
+	    MPI_Allgatherv(&B[j * ldb], m_loc, MPI_FLOAT, &bg[j * n],
+			   counts, displs, MPI_FLOAT, grid->comm);
+	SUPERLU_FREE(counts);
+
+	if ( ns ) {
+	    psGetSchur(&dopts, nd, &gSP, &gLU, &ggrid, &Sg);
+	    schur_set_identity(nd, ns, &gLU, &ggrid);
+
+	    /* S = A(S,S) + sum_g (Schur complement of A_g - I), by rows. */
+	    Sgstore = (NRformat_loc *) Sg.Store;
+	    s_loc_fst = ns / nprocs;
+	    s_fst = iam * s_loc_fst;
+	    s_loc = iam == nprocs - 1 ? ns - s_fst : s_loc_fst;
+	    lds = SUPERLU_MAX(s_loc, 1);
+	    nnz_s = Sgstore->rowptr[Sgstore->m_loc];
+
+	    if ( !(sendcnts = SUPERLU_MALLOC(4 * nprocs * sizeof(int))) )
+		ABORT("Malloc fails for sendcnts[].");
+	    sdispls = sendcnts + nprocs;
+	    recvcnts = sdispls + nprocs;
+	    rdispls = recvcnts + nprocs;
+	    for (p = 0; p < nprocs; ++p) sendcnts[p] = 0;
+	    for (i = 0; i < Sgstore->m_loc; ++i) {
+		s = Sgstore->fst_row + i;
+		p = s_loc_fst ? SUPERLU_MIN( s / s_loc_fst, nprocs - 1 ) : nprocs - 1;
+		sendcnts[p] += Sgstore->rowptr[i+1] - Sgstore->rowptr[i];
+	    }
+	    MPI_Alltoall(sendcnts, 1, MPI_INT, recvcnts, 1, MPI_INT, grid->comm);
+	    for (p = 0, sdispls[0] = rdispls[0] = 0; p < nprocs - 1; ++p) {
+		sdispls[p+1] = sdispls[p] + sendcnts[p];
+		rdispls[p+1] = rdispls[p] + recvcnts[p];
+	    }
+	    nloc = rdispls[nprocs-1] + recvcnts[nprocs-1];
+	    for (t = 0, i = s_fst; i < s_fst + s_loc; ++i) {
+		k = glob[ni + i];
+		for (j = arow[k]; j < arow[k+1]; ++j) if ( sidx[acol[j]] >= 0 ) ++t;
+	    }
+
+	    if ( !(sendidx = intMalloc_dist(2 * (nnz_s + nloc + t) + 1)) )
+		ABORT("Malloc fails for sendidx[].");
+	    recvidx = sendidx + 2 * nnz_s;
+	    if ( !(sendval = floatMalloc_dist(nnz_s + nloc + t + 1)) )
+		ABORT("Malloc fails for sendval[].");
+	    recvval = sendval + nnz_s;
+	    for (i = 0; i < Sgstore->m_loc; ++i) {
+		s = Sgstore->fst_row + i;
+		p = s_loc_fst ? SUPERLU_MIN( s / s_loc_fst, nprocs - 1 ) : nprocs - 1;
+		for (j = Sgstore->rowptr[i]; j < Sgstore->rowptr[i+1]; ++j) {
+		    k = sdispls[p]++;
+		    sendidx[2*k] = s;
+		    sendidx[2*k+1] = Sgstore->colind[j];
+		    sendval[k] = ((float *) Sgstore->nzval)[j]
+				 - (s == Sgstore->colind[j]);
+		}
+	    }
+	    for (p = 0; p < nprocs; ++p) sdispls[p] -= sendcnts[p];
+	    MPI_Alltoallv(sendval, sendcnts, sdispls, MPI_FLOAT,
+			  recvval, recvcnts, rdispls, MPI_FLOAT, grid->comm);
+	    for (p = 0; p < nprocs; ++p) {
+		sendcnts[p] *= 2; sdispls[p] *= 2;
+		recvcnts[p] *= 2; rdispls[p] *= 2;
+	    }
+	    MPI_Alltoallv(sendidx, sendcnts, sdispls, mpi_int_t,
+			  recvidx, recvcnts, rdispls, mpi_int_t, grid->comm);
+	    SUPERLU_FREE(sendcnts);
+	    Destroy_CompRowLoc_Matrix_dist(&Sg);
+	    for (i = s_fst; i < s_fst + s_loc; ++i) {
+		k = glob[ni + i];
+		for (j = arow[k]; j < arow[k+1]; ++j)
+		    if ( sidx[acol[j]] >= 0 ) {
+			recvidx[2*nloc] = i;
+			recvidx[2*nloc+1] = sidx[acol[j]];
+			recvval[nloc++] = aval[j];
+		    }
+	    }
+
+	    /* Sum the entries of each row. */
+	    if ( !(cnt = intMalloc_dist(s_loc + 1 + ns + nloc)) )
+		ABORT("Malloc fails for cnt[].");
+	    if ( !(rowptr = intMalloc_dist(s_loc + 1)) )
+		ABORT("Malloc fails for rowptr[].");
+	    if ( !(colind = intMalloc_dist(nloc + 1)) )
+		ABORT("Malloc fails for colind[].");
+	    if ( !(nzval = floatMalloc_dist(nloc + 1)) )
+		ABORT("Malloc fails for nzval[].");
+	    {
+		int_t *marker = cnt + s_loc + 1, *ord = marker + ns;
+
+		for (i = 0; i <= s_loc; ++i) cnt[i] = 0;
+		for (t = 0; t < nloc; ++t) ++cnt[recvidx[2*t] - s_fst + 1];
+		for (i = 0; i < s_loc; ++i) cnt[i+1] += cnt[i];
+		for (t = 0; t < nloc; ++t) ord[cnt[recvidx[2*t] - s_fst]++] = t;
+		for (j = 0; j < ns; ++j) marker[j] = -1;
+		for (nnz_loc = 0, rowptr[0] = 0, k = 0, i = 0; i < s_loc; ++i) {
+		    for ( ; k < cnt[i]; ++k) {
+			t = ord[k];
+			j = recvidx[2*t+1];
+			if ( marker[j] < rowptr[i] ) {
+			    marker[j] = nnz_loc;
+			    colind[nnz_loc] = j;
+			    nzval[nnz_loc++] = recvval[t];
+			} else {
+			    nzval[marker[j]] += recvval[t];
+			}
+		    }
+		    rowptr[i+1] = nnz_loc;
+		}
+	    }
+	    SUPERLU_FREE(cnt);
+	    SUPERLU_FREE(sendidx);
+	    SUPERLU_FREE(sendval);
+	    sCreate_CompRowLoc_Matrix_dist(&S, ns, ns, nnz_loc, s_loc, s_fst,
+					   nzval, colind, rowptr,
+					   SLU_NR_loc, SLU_S, SLU_GE);
+
+	    /* The separator rows of A_g*X_g = [B(I); 0] give -A(S,I)*inv(A(I,I))*B(I),
+	       up to the scaling D = inv(R*C) of the separator. */
+	    for (k = 0; k < g_loc; ++k) {
+		kk = g_fst + k;
+		D[k] = 1.0;
+		if ( kk >= ni ) {
+		    if ( gSP.DiagScale == ROW || gSP.DiagScale == BOTH )
+			D[k] /= gSP.R[kk];
+		    if ( gSP.DiagScale == COL || gSP.DiagScale == BOTH )
+			D[k] /= gSP.C[kk];
+		}
+		for (j = 0; j < nrhs; ++j)
+		    r1[k + j * ldg] = kk < ni ? bg[glob[kk] + j * n] : 0.0;
+	    }
+	    dopts.Fact = FACTORED;
+	    dopts.SchurSize = 0;
+	    dopts.IterRefine = NOREFINE;
+	    psgssvx(&dopts, &Ag, &gSP, r1, ldg, nrhs, &ggrid,
+		    &gLU, &gSOLVE, berr, &gstat, &ginfo);
+	    for (t = 0; t < ns * nrhs; ++t) rs[t] = 0.0;
+	    for (k = SUPERLU_MAX(ni - g_fst, 0); k < g_loc; ++k)
+		for (j = 0; j < nrhs; ++j)
+		    rs[g_fst + k - ni + j * ns] = D[k] * r1[k + j * ldg];
+	    MPI_Allreduce(MPI_IN_PLACE, rs, ns * nrhs, MPI_FLOAT, MPI_SUM,
+			  grid->comm);
+
+	    /* Solve the separator system on the whole grid. */
+	    for (i = 0; i < s_loc; ++i)
+		for (j = 0; j < nrhs; ++j)
+		    xs[i + j * lds] =
+			bg[glob[ni + s_fst + i] + j * n] + rs[s_fst + i + j * ns];
+	    sopts = *options;
+	    sopts.SolveInitialized = NO;
+	    sScalePermstructInit(ns, ns, &sSP);
+	    sLUstructInit(ns, &sLU);
+	    psgssvx(&sopts, &S, &sSP, xs, lds, nrhs, grid,
+		    &sLU, &sSOLVE, berr, stat, info);
+	    for (t = 0; t < ns * nrhs; ++t) rs[t] = 0.0;
+	    for (i = 0; i < s_loc; ++i)
+		for (j = 0; j < nrhs; ++j)
+		    rs[s_fst + i + j * ns] = xs[i + j * lds];
+	    MPI_Allreduce(MPI_IN_PLACE, rs, ns * nrhs, MPI_FLOAT, MPI_SUM,
+			  grid->comm);
+
+	    /* The interior from A_g*X_g = [B(I); D*(X(S) - X_g(S))]. */
+	    for (k = 0; k < g_loc; ++k) {
+		kk = g_fst + k;
+		for (j = 0; j < nrhs; ++j)
+		    r2[k + j * ldg] = kk < ni ? bg[glob[kk] + j * n]
+			: D[k] * (rs[kk - ni + j * ns] - r1[k + j * ldg]);
+	    }
+	} else {
+	    /* Whole components: A_g is the system of the group. */
+	    for (k = 0; k < g_loc; ++k)
+		for (j = 0; j < nrhs; ++j)
+		    r2[k + j * ldg] = bg[glob[g_fst + k] + j * n];
+	    dopts.Fact = FACTORED;
+	}
+	psgssvx(&dopts, &Ag, &gSP, r2, ldg, nrhs, &ggrid,
+		&gLU, &gSOLVE, berr, &gstat, &ginfo);
+
+	for (t = 0; t < n * nrhs; ++t) X[t] = 0.0;
+	for (k = 0; k < SUPERLU_MIN(g_loc, ni - g_fst); ++k)
+	    for (j = 0; j < nrhs; ++j)
+		X[glob[g_fst + k] + j * n] = r2[k + j * ldg];
+	if ( !iam )
+	    for (i = 0; i < ns; ++i)
+		for (j = 0; j < nrhs; ++j)
+		    X[glob[ni + i] + j * n] = rs[i + j * ns];
+	MPI_Allreduce(MPI_IN_PLACE, X, n * nrhs, MPI_FLOAT, MPI_SUM,
+		      grid->comm);
+	for (i = 0; i < m_loc; ++i)
+	    for (j = 0; j < nrhs; ++j)
+		B[i + j * ldb] = X[fst_row + i + j * n];
+
+	if ( ns ) {
+	    sDestroy_LU(ns, grid, &sLU);
+	    sScalePermstructFree(&sSP);
+	    sLUstructFree(&sLU);
+	    if ( sopts.SolveInitialized ) sSolveFinalize(&sopts, &sSOLVE);
+	    Destroy_CompRowLoc_Matrix_dist(&S);
+	}
+	SUPERLU_FREE(bg);
+    }
+
+    sDestroy_LU(nd, &ggrid, &gLU);
+    sScalePermstructFree(&gSP);
+    sLUstructFree(&gLU);
+    if ( dopts.SolveInitialized ) sSolveFinalize(&dopts, &gSOLVE);
+    Destroy_CompRowLoc_Matrix_dist(&Ag);
+    PStatFree(&gstat);
+    superlu_gridexit(&ggrid);
+    MPI_Comm_free(&gcomm);
+    SUPERLU_FREE(berr);
+    SUPERLU_FREE(arow);
+    SUPERLU_FREE(aval);
+    SUPERLU_FREE(dloc);
+    SUPERLU_FREE(perm_c);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psgssvx_subtree()");
+#endif
+} /* PSGSSVX_SUBTREE */
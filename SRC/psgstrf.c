@@ -0,0 +1,2859 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Performs LU factorization in parallel.
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.1) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * October 1, 2014
+ *
+ * Modified:
+ *   September 1, 1999
+ *   Feburary 7, 2001  use MPI_Isend/MPI_Irecv
+ *   October 15, 2008  latency-reducing panel factorization
+ *   July    12, 2011  static scheduling and arbitrary look-ahead
+ *   March   13, 2013  change NTAGS to MPI_TAG_UB value
+ *   September 24, 2015 replace xLAMCH by xMACH, using C99 standard.
+ *   December 31, 2015 rename xMACH to xMACH_DIST.
+ *   September 30, 2017 optimization for Intel Knights Landing (KNL) node .
+ *   June 1, 2018      add parallel AWPM pivoting; add back arrive_at_ublock()
+ *   February 8, 2019  version 6.1.1
+ *
+ * Sketch of the algorithm
+ *
+ * =======================
+ *
+ * The following relations hold:
+ *     * A_kk = L_kk * U_kk
+ *     * L_ik = Aik * U_kk^(-1)
+ *     * U_kj = L_kk^(-1) * A_kj
+ *
+ *              ----------------------------------
+ *              |   |                            |
+ *              ----|-----------------------------
+ *              |   | \ U_kk|                    |
+ *              |   |   \   |        U_kj        |
+ *              |   |L_kk \ |         ||         |
+ *              ----|-------|---------||----------
+ *              |   |       |         \/         |
+ *              |   |       |                    |
+ *              |   |       |                    |
+ *              |   |       |                    |
+ *              |   | L_ik ==>       A_ij        |
+ *              |   |       |                    |
+ *              |   |       |                    |
+ *              |   |       |                    |
+ *              ----------------------------------
+ *
+ * Handle the first block of columns separately.
+ *     * Factor diagonal and subdiagonal blocks and test for exact
+ *       singularity. ( psgstrf2(0), one column at a time )
+ *     * Compute block row of U
+ *     * Update trailing matrix
+ *
+ * Loop over the remaining blocks of columns.
+ *   mycol = MYCOL( iam, grid );
+ *   myrow = MYROW( iam, grid );
+ *   N = nsupers;
+ *   For (k = 1; k < N; ++k) {
+ *       krow = PROW( k, grid );
+ *       kcol = PCOL( k, grid );
+ *       Pkk = PNUM( krow, kcol, grid );
+ *
+ *     * Factor diagonal and subdiagonal blocks and test for exact
+ *       singularity.
+ *       if ( mycol == kcol ) {
+ *           psgstrf2(k), one column at a time
+ *       }
+ *
+ *     * Parallel triangular solve
+ *       if ( iam == Pkk ) multicast L_k,k to this process row;
+ *       if ( myrow == krow && mycol != kcol ) {
+ *          Recv L_k,k from process Pkk;
+ *          for (j = k+1; j < N; ++j)
+ *              if ( PCOL( j, grid ) == mycol && A_k,j != 0 )
+ *                 U_k,j = L_k,k \ A_k,j;
+ *       }
+ *
+ *     * Parallel rank-k update
+ *       if ( myrow == krow ) multicast U_k,k+1:N to this process column;
+ *       if ( mycol == kcol ) multicast L_k+1:N,k to this process row;
+ *       if ( myrow != krow ) {
+ *          Pkj = PNUM( krow, mycol, grid );
+ *          Recv U_k,k+1:N from process Pkj;
+ *       }
+ *       if ( mycol != kcol ) {
+ *          Pik = PNUM( myrow, kcol, grid );
+ *          Recv L_k+1:N,k from process Pik;
+ *       }
+ *       for (j = k+1; k < N; ++k) {
+ *          for (i = k+1; i < N; ++i)
+ *              if ( myrow == PROW( i, grid ) && mycol == PCOL( j, grid )
+ *                   && L_i,k != 0 && U_k,j != 0 )
+ *                 A_i,j = A_i,j - L_i,k * U_k,j;
+ *       }
+ *  }
+ *
+ * </pre>
+ */
+
+#include <math.h>
+/*#include "mkl.h"*/
+#include "superlu_sdefs.h"
+
+#ifdef GPU_ACC
+#include "cublas_utils.h"
+/*#include "cublas_dgemm.h"*/
+// #define NUM_CUDA_STREAMS 16
+// #define NUM_CUDA_STREAMS 16
+#endif
+
+/* Various defininations     */
+/*
+    Name    : SUPERNODE_PROFILE
+    Purpose : For SuperNode Level profiling of various measurements such as gigaflop/sec
+    obtained,bandwidth achieved:
+    Overhead : Low
+*/
+// #define SUPERNODE_PROFILE
+
+/*
+    Name    :   BAELINE
+    Purpose : baseline to compare performance against
+    Overhead : NA : this won't be used for running experiments
+*/
+// #define BASELINE
+
+/*
+    Name    :   PHI_FRAMEWORK
+    Purpose : To simulate and test algorithm used for offloading Phi
+    Overhead : NA : this won't be used for running experiments
+*/
+#define PHI_FRAMEWORK
+
+#if 0
+#define CACHELINE 64  /* bytes, Xeon Phi KNL */
+#else
+#define CACHELINE 0  /* not worry about false sharing of different threads */
+#endif
+//#define GEMM_PADLEN 1
+#define GEMM_PADLEN 8
+
+#define PSGSTRF2 psgstrf2_trsm
+
+/* Supernode s keeps its factors: it is not factored again, and only
+   updates the dirty panels (see psgsrefactor_partial()). */
+#define SN_CLEAN(s) ( sn_dirty && !sn_dirty[s] )
+
+#ifdef ISORT
+extern void isort (int_t N, int_t * ARRAY1, int_t * ARRAY2);
+extern void isort1 (int_t N, int_t * ARRAY);
+#endif
+
+
+/************************************************************************/
+
+#include "sscatter.c"
+
+/************************************************************************/
+
+/*! \brief Choose the depth of the look-ahead window from the elimination
+ *  tree of the supernodes.
+ *
+ * <pre>
+ * A panel in the window can be factorized ahead of time only if it does
+ * not wait for the panels before it. The parent of supernode j is taken
+ * as the first block below the diagonal in L(:,j); the number of
+ * supernodes divided by the height of this tree is the average number of
+ * panels that can be ready at the same time. The depth returned is this
+ * number, at least 1 and at most twice the larger dimension of the
+ * process grid: the panels are owned cyclically, and a deeper window
+ * costs buffer space without keeping more processes busy.
+ * Collective over grid->comm.
+ * </pre>
+ */
+static int
+adaptive_lookaheads(int_t nsupers, sLocalLU_t *Llu, gridinfo_t *grid)
+{
+    int_t *parent, *height, *index;
+    int_t h, i, jb, k, lb, nlb;
+    int mycol = MYCOL( grid->iam, grid );
+
+    if ( !(height = intMalloc_dist(2 * nsupers)) )
+	ABORT("Malloc fails for height[].");
+    parent = height + nsupers;
+
+    for (i = 0; i < nsupers; ++i) height[i] = nsupers;
+    for (lb = 0; (jb = lb * grid->npcol + mycol) < nsupers; ++lb) {
+	if ( !(index = Llu->Lrowind_bc_ptr[lb]) ) continue;
+	nlb = index[0];
+	k = BC_HEADER;
+	for (i = 0; i < nlb; ++i) {
+	    if ( index[k] != jb ) height[jb] = SUPERLU_MIN(height[jb], index[k]);
+	    k += LB_DESCRIPTOR + index[k+1];
+	}
+    }
+    MPI_Allreduce(height, parent, nsupers, mpi_int_t, MPI_MIN, grid->comm);
+
+    /* The parent of a supernode is always numbered after it. */
+    for (i = 0; i < nsupers; ++i) height[i] = 1;
+    for (h = 0, i = 0; i < nsupers; ++i) {
+	h = SUPERLU_MAX(h, height[i]);
+	if ( parent[i] < nsupers )
+	    height[parent[i]] = SUPERLU_MAX(height[parent[i]], height[i] + 1);
+    }
+
+    SUPERLU_FREE(height);
+    h = SUPERLU_MIN(nsupers / SUPERLU_MAX(h, 1),
+                    2 * SUPERLU_MAX(grid->nprow, grid->npcol));
+    return (int) SUPERLU_MAX(1, SUPERLU_MIN(h, MAX_LOOKAHEADS - 1));
+}
+
+/*! \brief Fit the buffers of the factorization in options->MemBudget.
+ *
+ * <pre>
+ * The local L and U factors are counted first, the look-ahead panel
+ * buffers, bigU and bigV must fit in the rest of the budget. The
+ * look-ahead depth is reduced first; then U(k,:) is updated by chunks of
+ * at most *u_chunk nonzero columns, halved down to the maximum supernode
+ * size, which shrinks bigU and bigV. The depth is the smallest over the
+ * processes. Returns the number of megabytes missing on the process
+ * short of the most memory, 0 if the buffers fit.
+ * Collective over grid->comm.
+ * </pre>
+ */
+static int
+smem_budget(superlu_dist_options_t *options, int_t n, sLUstruct_t *LUstruct,
+	    gridinfo_t *grid, int *num_look_aheads, int_t *u_chunk)
+{
+    sLocalLU_t *Llu = LUstruct->Llu;
+    int_t nsupers = LUstruct->Glu_persist->supno[n-1] + 1;
+    int_t *perm_u, *lsub, lb, max_ncols = 0, max_ldu, bigu, chunk;
+    int   mycol = MYCOL( grid->iam, grid ), ldt = sp_ienv_dist(3);
+    int   nla = *num_look_aheads, num_threads = 1, my_row_size = 0;
+    int   max_row_size, missing, my_missing;
+    double avail, panel = 0.0, dword = sizeof(float), need;
+
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    for (lb = 0; lb * grid->npcol + mycol < nsupers; ++lb)
+	if ( (lsub = Llu->Lrowind_bc_ptr[lb]) && lsub[1] > my_row_size )
+	    my_row_size = lsub[1];
+    MPI_Allreduce(&my_row_size, &max_row_size, 1, MPI_INT, MPI_MAX,
+		  grid->rscp.comm);
+    if ( !(perm_u = intMalloc_dist(nsupers)) )
+	ABORT("Malloc fails for perm_u[].");
+    bigu = estimate_bigu_size(nsupers, Llu->Ufstnz_br_ptr, LUstruct->Glu_persist,
+			      grid, perm_u, &max_ncols);
+    SUPERLU_FREE(perm_u);
+    max_ldu = max_ncols ? bigu / max_ncols : 0;
+    if ( grid->nprow * grid->npcol > 1 )
+	panel = (double) (Llu->bufmax[0] + Llu->bufmax[2]) * sizeof(int_t)
+	    + (double) (Llu->bufmax[1] + Llu->bufmax[3]) * dword;
+
+#define BUDGET_NEED(nla, chunk) \
+    ((nla + 1) * panel + dword * ((double) max_ldu * (chunk) \
+	+ SUPERLU_MAX((double) max_row_size * (chunk), \
+		      (ldt * ldt + CACHELINE / dword) * num_threads)))
+
+    avail = options->MemBudget * 1e6 - sLU_local_bytes(n, LUstruct, grid);
+    chunk = max_ncols;
+    while ( nla > 0 && BUDGET_NEED(nla, chunk) > avail ) --nla;
+    MPI_Allreduce(MPI_IN_PLACE, &nla, 1, MPI_INT, MPI_MIN, grid->comm);
+#ifndef GPU_ACC /* sSchCompUdt-cuda.c takes U(k,:) whole */
+    while ( chunk > ldt && BUDGET_NEED(nla, chunk) > avail )
+	chunk = SUPERLU_MAX(ldt, chunk / 2);
+#endif
+    need = BUDGET_NEED(nla, chunk);
+#undef BUDGET_NEED
+
+    my_missing = need > avail ? (int) ceil((need - avail) * 1e-6) : 0;
+    MPI_Allreduce(&my_missing, &missing, 1, MPI_INT, MPI_MAX, grid->comm);
+#if ( PRNTlevel>=1 )
+    if ( nla < *num_look_aheads || chunk < max_ncols || my_missing )
+	printf("(%d) .. MemBudget: look-ahead %d, U chunk " IFMT
+	       " of " IFMT " columns, %d MB missing\n", grid->iam, nla,
+	       chunk, max_ncols, my_missing);
+#endif
+    *num_look_aheads = nla;
+    *u_chunk = chunk < max_ncols ? chunk : 0;
+    return missing;
+}
+
+/*! \brief Let the receives posted for the look-ahead window progress.
+ *
+ * <pre>
+ * Used with options->Fact_Comm = SLU_COMM_IRECV between the phases of the
+ * Schur complement update of step k0. MPI_Request_get_status() does not
+ * free a completed request, so that the MPI_Test/MPI_Wait calls of the
+ * main loop and their message counts are unchanged.
+ * </pre>
+ */
+static void
+progress_lookahead_recvs(int_t k0, int_t nfact, int num_look_aheads,
+			 MPI_Request **recv_reqs, MPI_Request **recv_reqs_u)
+{
+    int_t kk0, kk1 = SUPERLU_MIN(k0 + num_look_aheads, nfact - 1);
+    int   i, look_id, flag;
+    MPI_Status status;
+
+    for (kk0 = k0 + 1; kk0 <= kk1; ++kk0) {
+	look_id = kk0 % (1 + num_look_aheads);
+	for (i = 0; i < 2; ++i) {
+	    if ( recv_reqs[look_id][i] != MPI_REQUEST_NULL )
+		MPI_Request_get_status(recv_reqs[look_id][i], &flag, &status);
+	    if ( recv_reqs_u[look_id][i] != MPI_REQUEST_NULL )
+		MPI_Request_get_status(recv_reqs_u[look_id][i], &flag, &status);
+	}
+    }
+}
+
+/* Seconds between two tests of poll_lookahead(). */
+#define SLU_COMM_POLL 2e-5
+
+/* The communicator of the panel messages of step kk0 in the scope scp, of
+   its look-ahead slot with options->Fact_Comm = SLU_COMM_THREADS. */
+#define PANEL_COMM(scp, kk0) \
+    ( slot_comm ? slot_comm[2 * ((kk0) % (1 + num_look_aheads)) \
+			    + ((scp) == &grid->cscp)] : (scp)->comm )
+
+#ifdef _OPENMP
+/*! \brief Let the panel messages of the look-ahead window progress from
+ *         the threads of the Schur complement update.
+ *
+ * <pre>
+ * Used with options->Fact_Comm = SLU_COMM_THREADS after each block
+ * update. The thread that gets *lock, if the last test is SLU_COMM_POLL
+ * seconds old, tests the receives of the window as
+ * progress_lookahead_recvs() and the sends of all the slots; the other
+ * threads go on with their blocks. MPI_Request_get_status() leaves the
+ * requests to the main loop.
+ * </pre>
+ */
+static void
+poll_lookahead(omp_lock_t *lock, double *last, int_t k0, int_t nfact,
+	       int num_look_aheads, MPI_Request **recv_reqs,
+	       MPI_Request **recv_reqs_u, MPI_Request **send_reqs,
+	       MPI_Request **send_reqs_u, int Pr, int Pc)
+{
+    double t;
+    int   i, look_id, flag;
+    MPI_Status status;
+
+    if ( !omp_test_lock(lock) ) return;
+    t = SuperLU_timer_();
+    if ( t - *last >= SLU_COMM_POLL ) {
+	*last = t;
+	progress_lookahead_recvs(k0, nfact, num_look_aheads, recv_reqs,
+				 recv_reqs_u);
+	for (look_id = 0; look_id <= num_look_aheads; ++look_id) {
+	    for (i = 0; i < 2 * Pc; ++i)
+		if ( send_reqs[look_id][i] != MPI_REQUEST_NULL )
+		    MPI_Request_get_status(send_reqs[look_id][i], &flag, &status);
+	    for (i = 0; i < 2 * Pr; ++i)
+		if ( send_reqs_u[look_id][i] != MPI_REQUEST_NULL )
+		    MPI_Request_get_status(send_reqs_u[look_id][i], &flag,
+					   &status);
+	}
+    }
+    omp_unset_lock(lock);
+}
+#endif
+
+/*! \brief The L (or U) panels of a process exposed to its process row
+ * (or column), used with options->Fact_Comm = SLU_COMM_RMA.
+ */
+typedef struct {
+    MPI_Win   iwin, vwin, fwin; /* indices, values and ready flags */
+    int_t    *index;    /* contiguous copy of the local panel indices */
+    int      *ready;    /* ready[lb] = 1 once the local panel lb is final */
+    int       np;       /* size of the communicator, no windows if 1 */
+    int_t     nlb;      /* max. number of local panels of a process */
+    MPI_Aint *disp;     /* 4 entries at 4*(p*nlb+lb) for the panel lb of
+			   process p: displacements of its index and values,
+			   then their counts */
+} panel_rma_t;
+
+/*! \brief Expose the local L (is_L = 1) or U panels in RMA windows.
+ *
+ * <pre>
+ * The panel lb of the calling process, rank me of comm, is the global
+ * block lb*np+me; index[lb] and val[lb] are its index and values. The
+ * values are read in place from the slab that holds all of them, the
+ * indices are copied into one array. The displacements and counts of
+ * every panel of comm are gathered, so that a panel is pulled with one
+ * MPI_Get per array once panel_rma_ready() has been called for it.
+ * </pre>
+ */
+static void
+panel_rma_init(panel_rma_t *pw, int is_L, int_t nsupers, int_t *xsup,
+	       MPI_Comm comm, int me, int np,
+	       int_t **index, float **val, float *slab)
+{
+    int_t lb, gb, i, *sub;
+    MPI_Aint *d, ilen = 0, vlen = 0;
+
+    /* Nothing to pull from with a single process; this also avoids the
+       windows on a communicator of size 1 that some MPIs fail to create. */
+    if ( (pw->np = np) == 1 ) return;
+    pw->nlb = CEILING(nsupers, np);
+    if ( !(d = SUPERLU_MALLOC(4 * SUPERLU_MAX(pw->nlb, 1) * sizeof(MPI_Aint))) )
+	ABORT("Malloc fails for disp[].");
+    for (i = 0; i < 4 * pw->nlb; ++i) d[i] = 0;
+    for (lb = 0, gb = me; gb < nsupers; gb += np, ++lb) {
+	if ( !(sub = index[lb]) ) continue;
+	d[4*lb]   = ilen;
+	d[4*lb+1] = val[lb] - slab;
+	d[4*lb+2] = is_L ? sub[1] + BC_HEADER + sub[0] * LB_DESCRIPTOR : sub[2];
+	d[4*lb+3] = is_L ? (MPI_Aint) sub[1] * SuperSize(gb) : sub[1];
+	ilen += d[4*lb+2];
+	vlen = SUPERLU_MAX(vlen, d[4*lb+1] + d[4*lb+3]);
+    }
+
+    if ( !(pw->index = intMalloc_dist(SUPERLU_MAX(ilen, 1))) )
+	ABORT("Malloc fails for index[].");
+    for (lb = 0, gb = me; gb < nsupers; gb += np, ++lb)
+	for (i = 0; i < d[4*lb+2]; ++i) pw->index[d[4*lb] + i] = index[lb][i];
+
+    if ( !(pw->disp = SUPERLU_MALLOC(4 * SUPERLU_MAX(pw->nlb, 1) * np
+				     * sizeof(MPI_Aint))) )
+	ABORT("Malloc fails for disp[].");
+    MPI_Allgather(d, 4 * pw->nlb, MPI_AINT, pw->disp, 4 * pw->nlb, MPI_AINT,
+		  comm);
+    SUPERLU_FREE(d);
+
+    if ( !(pw->ready = SUPERLU_MALLOC(SUPERLU_MAX(pw->nlb, 1) * sizeof(int))) )
+	ABORT("Malloc fails for ready[].");
+    for (lb = 0; lb < pw->nlb; ++lb) pw->ready[lb] = 0;
+
+    MPI_Win_create(pw->index, ilen * sizeof(int_t), sizeof(int_t),
+		   MPI_INFO_NULL, comm, &pw->iwin);
+    MPI_Win_create(slab, vlen * sizeof(float), sizeof(float),
+		   MPI_INFO_NULL, comm, &pw->vwin);
+    MPI_Win_create(pw->ready, pw->nlb * sizeof(int), sizeof(int),
+		   MPI_INFO_NULL, comm, &pw->fwin);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, pw->iwin);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, pw->vwin);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, pw->fwin);
+}
+
+/*! \brief Flag the local panel lb as final, replaces its MPI_Isend's. */
+static void
+panel_rma_ready(panel_rma_t *pw, int me, int_t lb)
+{
+    int one = 1;
+
+    if ( pw->np == 1 ) return;
+    MPI_Win_sync(pw->vwin); /* the values are visible before the flag */
+    MPI_Accumulate(&one, 1, MPI_INT, me, lb, 1, MPI_INT, MPI_REPLACE,
+		   pw->fwin);
+    MPI_Win_flush(me, pw->fwin);
+}
+
+/*! \brief Pull the panel lb of process p into sub_buf[] and val_buf[].
+ *
+ * <pre>
+ * With wait = 0 the panel is only pulled if it is already flagged ready.
+ * Returns 1 if it was pulled, with the counts of sub_buf[] and val_buf[]
+ * in msgcnt[0] and msgcnt[1], as from the MPI_Irecv's it replaces.
+ * </pre>
+ */
+static int
+panel_rma_get(panel_rma_t *pw, int p, int_t lb, int wait,
+	      int_t *sub_buf, float *val_buf, int *msgcnt)
+{
+    MPI_Aint *d = &pw->disp[4 * (p * pw->nlb + lb)];
+    int flag;
+
+    do {
+	MPI_Fetch_and_op(NULL, &flag, MPI_INT, p, lb, MPI_NO_OP, pw->fwin);
+	MPI_Win_flush(p, pw->fwin);
+    } while ( !flag && wait );
+    if ( !flag ) return 0;
+
+    if ( d[2] ) MPI_Get(sub_buf, (int) d[2], mpi_int_t, p, d[0], (int) d[2],
+			mpi_int_t, pw->iwin);
+    if ( d[3] ) MPI_Get(val_buf, (int) d[3], MPI_FLOAT, p, d[1], (int) d[3],
+			MPI_FLOAT, pw->vwin);
+    MPI_Win_flush(p, pw->iwin);
+    MPI_Win_flush(p, pw->vwin);
+    msgcnt[0] = (int) d[2];
+    msgcnt[1] = (int) d[3];
+    return 1;
+}
+
+/*! \brief Close the windows of panel_rma_init(); collective on its comm. */
+static void
+panel_rma_finalize(panel_rma_t *pw)
+{
+    if ( pw->np == 1 ) return;
+    MPI_Win_unlock_all(pw->iwin);
+    MPI_Win_unlock_all(pw->vwin);
+    MPI_Win_unlock_all(pw->fwin);
+    MPI_Win_free(&pw->iwin);
+    MPI_Win_free(&pw->vwin);
+    MPI_Win_free(&pw->fwin);
+    SUPERLU_FREE(pw->index);
+    SUPERLU_FREE(pw->ready);
+    SUPERLU_FREE(pw->disp);
+}
+
+
+/*! \brief Step k is done with L(:,k) (or U(k,:)), local block lb: retire
+ *  the slab of L (U) up to the first block still needed.
+ *
+ * <pre>
+ * done[] flags the local blocks the factorization is done with, and next
+ * is the first one not done. See options->OutOfCore.
+ * </pre>
+ */
+static void
+sooc_retire(superlu_ooc_t *ooc, float **nzval_ptr, int_t nb, char *done,
+	     int_t *next, int_t lb)
+{
+    done[lb] = 1;
+    while ( *next < nb && done[*next] ) ++(*next);
+    for (lb = *next; lb < nb && !nzval_ptr[lb]; ++lb) ;
+    superlu_ooc_retire(ooc, lb < nb ? (void *) nzval_ptr[lb] : NULL);
+}
+
+/*! \brief Let each thread write first the scratch it uses in the Schur
+ * complement update.
+ *
+ * <pre>
+ * A page is placed in the NUMA domain of the thread that touches it first,
+ * so the arena is not left to the master thread. Thread t uses the slice t
+ * of indirect[] and indirect2[] (iinfo entries each) and of the look-ahead
+ * GEMM output at the head of bigV[] (ldt*ldt entries); the rest of bigV[]
+ * and bigU[] are shared and split evenly among the threads. With unbound
+ * threads (OMP_PROC_BIND unset) the placement may not last.
+ * </pre>
+ */
+static void
+first_touch_scratch(int num_threads, int *indirect, int *indirect2, int iinfo,
+		    float *bigV, int_t bigv_size, int ldt,
+		    float *bigU, int_t bigu_size)
+{
+#ifdef _OPENMP
+    int_t nslice = SUPERLU_MIN((int_t) ldt * ldt * num_threads, bigv_size);
+
+#pragma omp parallel num_threads(num_threads)
+    {
+	int t = omp_get_thread_num(), i;
+	int_t j, lo = SUPERLU_MIN((int_t) ldt * ldt * t, nslice),
+	    hi = SUPERLU_MIN(lo + (int_t) ldt * ldt, nslice);
+
+	for (i = 0; i < iinfo; ++i)
+	    indirect[t * iinfo + i] = indirect2[t * iinfo + i] = 0;
+	for (j = lo; j < hi; ++j) bigV[j] = 0.0;
+#pragma omp for schedule(static) nowait
+	for (j = nslice; j < bigv_size; ++j) bigV[j] = 0.0;
+#pragma omp for schedule(static) nowait
+	for (j = 0; j < bigu_size; ++j) bigU[j] = 0.0;
+    }
+#endif
+}
+
+/*! \brief Buffers of the encoded panel indices, options->Panel_Compress.
+ *
+ * <pre>
+ * pack[2*look_id] and pack[2*look_id+1] hold the index sent and the
+ * index received in the look-ahead slot look_id, each of up to bufmax
+ * entries.
+ * </pre>
+ */
+static unsigned char **
+index_pack_alloc(int num_look_aheads, int_t bufmax)
+{
+    int i, nbuf = 2 * (1 + num_look_aheads);
+    size_t size = SUPERLU_PACK_MAX((size_t) SUPERLU_MAX(bufmax, 1));
+    unsigned char **pack;
+
+    if ( !(pack = SUPERLU_MALLOC(nbuf * sizeof(unsigned char *))) ||
+	 !(pack[0] = SUPERLU_MALLOC(nbuf * size)) )
+	ABORT("Malloc fails for pack[].");
+    for (i = 1; i < nbuf; ++i) pack[i] = pack[0] + i * size;
+    return pack;
+}
+
+static void
+index_pack_free(unsigned char **pack)
+{
+    SUPERLU_FREE(pack[0]);
+    SUPERLU_FREE(pack);
+}
+
+/*! \brief The message of the index sub[] of cnt entries of a panel sent
+ * from the slot look_id: sub[] itself, or its encoding in the slot if
+ * pack is not NULL.
+ */
+static void *
+index_msg(int_t *sub, int cnt, unsigned char **pack, int look_id,
+	  int *msgcnt, MPI_Datatype *type)
+{
+    if ( !pack ) {
+	*msgcnt = cnt;
+	*type = mpi_int_t;
+	return sub;
+    }
+    *msgcnt = superlu_pack_index(cnt, sub, pack[2 * look_id]);
+    *type = MPI_BYTE;
+    return pack[2 * look_id];
+}
+
+/*! \brief The buffer, count and type of the receive of a panel index
+ * into sub_buf[] of bufmax entries in the slot look_id.
+ */
+static void *
+index_recv_buf(int_t *sub_buf, int bufmax, unsigned char **pack,
+	       int look_id, int *cnt, MPI_Datatype *type)
+{
+    if ( !pack ) {
+	*cnt = bufmax;
+	*type = mpi_int_t;
+	return sub_buf;
+    }
+    *cnt = SUPERLU_PACK_MAX(bufmax);
+    *type = MPI_BYTE;
+    return pack[2 * look_id + 1];
+}
+
+/*! \brief The number of entries of the panel index received, decoded
+ * into sub_buf[] if it was encoded.
+ */
+static int
+index_recv_count(MPI_Status *status, int_t *sub_buf, unsigned char **pack,
+		 int look_id)
+{
+    int cnt;
+
+    if ( !pack ) {
+	MPI_Get_count(status, mpi_int_t, &cnt);
+	return cnt;
+    }
+    MPI_Get_count(status, MPI_BYTE, &cnt);
+    return (int) superlu_unpack_index(cnt, pack[2 * look_id + 1], sub_buf);
+}
+
+
+/* Bits of the columns of a block U(k,j) per entry of a folded index. */
+#define UFOLD_BITS      (8 * (int) sizeof(int_t) - 1)
+#define UFOLD_WORDS(nc) (((nc) + UFOLD_BITS - 1) / UFOLD_BITS)
+
+/*! \brief The index of U(k,:) to send with options->SymPattern.
+ *
+ * <pre>
+ * A column of a block U(k,j) is full, its first nonzero being the first
+ * row of block k, or empty; with a symmetric pattern, the full columns
+ * are the rows of L(j,k). Each block is then sent as its number, its
+ * number of values and one bit per column, rather than the first
+ * nonzero of each column. The folded index is written in buf[], of at
+ * least usub[2] entries, with usub[2] replaced by -1 - usub[2]; *cnt is
+ * set to its length. usub is returned as is, and *cnt left unchanged, if
+ * buf is NULL or a column is neither full nor empty.
+ * </pre>
+ */
+static int_t *
+uindex_fold(int_t *usub, int_t k, int_t *xsup, int_t *buf, int *cnt)
+{
+    int_t fst = FstBlockC( k ), lst = FstBlockC( k+1 );
+    int_t b, pos, m, gb, nc, jj, f;
+
+    if ( !buf || !usub ) return usub;
+    buf[0] = usub[0];
+    buf[1] = usub[1];
+    buf[2] = -1 - usub[2];
+    for (b = 0, pos = m = BR_HEADER; b < usub[0]; ++b) {
+	gb = usub[pos];
+	nc = SuperSize( gb );
+	buf[m] = gb;
+	buf[m+1] = usub[pos+1];
+	for (jj = 0; jj < UFOLD_WORDS(nc); ++jj) buf[m+2+jj] = 0;
+	for (jj = 0; jj < nc; ++jj) {
+	    f = usub[pos + UB_DESCRIPTOR + jj];
+	    if ( f == fst ) buf[m + 2 + jj / UFOLD_BITS] |= (int_t) 1 << (jj % UFOLD_BITS);
+	    else if ( f != lst ) return usub;
+	}
+	m += 2 + UFOLD_WORDS(nc);
+	pos += UB_DESCRIPTOR + nc;
+    }
+    *cnt = m;
+    return buf;
+}
+
+/*! \brief Expand in place the index of U(k,:) received in usub[], of cnt
+ * entries, if it was folded by uindex_fold(); msg[] is a scratch of at
+ * least cnt entries.
+ */
+static void
+uindex_unfold(int_t *usub, int cnt, int_t k, int_t *xsup, int_t *msg)
+{
+    int_t fst = FstBlockC( k ), lst = FstBlockC( k+1 );
+    int_t b, pos, m, gb, nc, jj;
+
+    if ( cnt < BR_HEADER || usub[2] >= 0 ) return;
+    for (m = 0; m < cnt; ++m) msg[m] = usub[m];
+    usub[2] = -1 - msg[2];
+    for (b = 0, pos = m = BR_HEADER; b < msg[0]; ++b) {
+	gb = msg[m];
+	nc = SuperSize( gb );
+	usub[pos] = gb;
+	usub[pos+1] = msg[m+1];
+	for (jj = 0; jj < nc; ++jj)
+	    usub[pos + UB_DESCRIPTOR + jj] =
+		(msg[m + 2 + jj / UFOLD_BITS] >> (jj % UFOLD_BITS)) & 1 ? fst : lst;
+	m += 2 + UFOLD_WORDS(nc);
+	pos += UB_DESCRIPTOR + nc;
+    }
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSTRF performs the LU factorization in parallel.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         The structure defines the input parameters to control
+ *         how the LU decomposition will be performed.
+ *         The following field should be defined:
+ *         o ReplaceTinyPivot (yes_no_t)
+ *           Specifies whether to replace the tiny diagonals by
+ *           sqrt(epsilon)*norm(A) during LU factorization.
+ *
+ * m      (input) int
+ *        Number of rows in the matrix.
+ *
+ * n      (input) int
+ *        Number of columns in the matrix.
+ *
+ * anorm  (input) float
+ *        The norm of the original matrix A, or the scaled A if
+ *        equilibration was done.
+ *
+ * LUstruct (input/output) sLUstruct_t*
+ *         The data structures to store the distributed L and U factors.
+ *         The following fields should be defined:
+ *
+ *         o Glu_persist (input) Glu_persist_t*
+ *           Global data structure (xsup, supno) replicated on all processes,
+ *           describing the supernode partition in the factored matrices
+ *           L and U:
+ *         xsup[s] is the leading column of the s-th supernode,
+ *             supno[i] is the supernode number to which column i belongs.
+ *
+ *         o Llu (input/output) sLocalLU_t*
+ *           The distributed data structures to store L and U factors.
+ *           See superlu_sdefs.h for the definition of 'sLocalLU_t'.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh. It contains the MPI communicator, the number
+ *        of process rows (NPROW), the number of process columns (NPCOL),
+ *        and my process rank. It is an input argument to all the
+ *        parallel routines.
+ *        Grid can be initialized by subroutine SUPERLU_GRIDINIT.
+ *        See superlu_sdefs.h for the definition of 'gridinfo_t'.
+ *
+ * stat   (output) SuperLUStat_t*
+ *        Record the statistics on runtime and floating-point operation count.
+ *        See util.h for the definition of 'SuperLUStat_t'.
+ *
+ * info   (output) int*
+ *        = 0: successful exit
+ *        < 0: if info = -i, the i-th argument had an illegal value
+ *        > 0: if info = i, U(i,i) is exactly zero. The factorization has
+ *             been completed, but the factor U is exactly singular,
+ *             and division by zero will occur if it is used to solve a
+ *             system of equations.
+ *        > n: the buffers do not fit in options->MemBudget; info - n is
+ *             the number of megabytes missing. Nothing is factored.
+ * </pre>
+ */
+int_t
+psgstrf(superlu_dist_options_t * options, int m, int n, float anorm,
+       sLUstruct_t * LUstruct, gridinfo_t * grid, SuperLUStat_t * stat, int *info)
+{
+#ifdef _CRAY
+    _fcd ftcs = _cptofcd ("N", strlen ("N"));
+    _fcd ftcs1 = _cptofcd ("L", strlen ("L"));
+    _fcd ftcs2 = _cptofcd ("N", strlen ("N"));
+    _fcd ftcs3 = _cptofcd ("U", strlen ("U"));
+#endif
+    float zero = 0.0, alpha = 1.0, beta = 0.0;
+    int_t *xsup;
+    int_t *lsub, *lsub1, *usub, *Usub_buf;
+    int_t **Lsub_buf_2, **Usub_buf_2;
+    float **Lval_buf_2, **Uval_buf_2;          /* pointers to starts of bufs */
+    float *lusup, *lusup1, *uval, *Uval_buf;   /* pointer to current buf     */
+    int_t fnz, i, ib, ijb, ilst, it, iukp, jb, jj, klst, knsupc,
+        lb, lib, ldv, ljb, lptr, lptr0, lptrj, luptr, luptr0, luptrj,
+        nlb, nub, nsupc, rel, rukp, il, iu;
+    int_t Pc, Pr;
+    int iam, kcol, krow, yourcol, mycol, myrow, pi, pj;
+    int j, k, lk, nsupers;  /* k - current panel to work on */
+    int nfact;     /* number of panels to factor */
+    int k0;        /* counter of the next supernode to be factored */
+    int kk, kk0, kk1, kk2, jj0; /* panels in the look-ahead window */
+    int iukp0, rukp0, flag0, flag1;
+    int nsupr, nbrow, segsize;
+    int msg0, msg2;
+    int_t **Ufstnz_br_ptr, **Lrowind_bc_ptr;
+    float **Unzval_br_ptr, **Lnzval_bc_ptr;
+    int_t *index;
+    float *nzval;
+    float *ucol;
+    int *indirect, *indirect2;
+    superlu_arena_t arena; /* work arrays of the factorization */
+    size_t arena_size;
+    int_t *tempi;
+    float *tempu, *tempv, *tempr;
+    /*    float *tempv2d, *tempU2d;  Sherry */
+    int iinfo;
+    int *ToRecv, *ToSendD, **ToSendR;
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    sLocalLU_t *Llu = LUstruct->Llu;
+    superlu_scope_t *scp;
+    float s_eps;
+    float thresh;
+    /*int full;*/
+    int ldt, ldu, lead_zero, ncols, ncb, nrb, p, pr, pc, nblocks;
+    int_t *etree_supno_l, *etree_supno, *blocks, *blockr, *Ublock, *Urows,
+        *Lblock, *Lrows, *perm_u, *sf_block, *sf_block_l, *nnodes_l,
+        *nnodes_u, *edag_supno_l, *recvbuf, **edag_supno;
+    float edag_supno_l_bytes;
+#ifdef ISORT
+    int_t *iperm_u;
+#endif
+    int *msgcnt;   /* Count the size of the message xfer'd in each buffer:
+		    *     0 : transferred in Lsub_buf[]
+		    *     1 : transferred in Lval_buf[]
+		    *     2 : transferred in Usub_buf[]
+		    *     3 : transferred in Uval_buf[]
+		    */
+    int **msgcnts, **msgcntsU; /* counts in the look-ahead window */
+    int *factored;  /* factored[j] == 0 : L col panel j is factorized. */
+    int *factoredU; /* factoredU[i] == 1 : U row panel i is factorized. */
+    int nnodes, *sendcnts, *sdispls, *recvcnts, *rdispls, *srows, *rrows;
+    etree_node *head, *tail, *ptr;
+    int *num_child;
+    int num_look_aheads, look_id;
+    int_t u_chunk = 0; /* columns of U(k,:) per update, see smem_budget() */
+    int *look_ahead; /* global look_ahead table */
+    int_t *perm_c_supno, *iperm_c_supno;
+          /* perm_c_supno[k] = j means at the k-th step of elimination,
+	   * the j-th supernode is chosen. */
+    MPI_Request *recv_req, **recv_reqs, **send_reqs, **send_reqs_u,
+        **recv_reqs_u;
+    MPI_Request *send_req, *U_diag_blk_send_req = NULL;
+    panel_rma_t Lrma, Urma;   /* options->Fact_Comm = SLU_COMM_RMA */
+    int_t rma_inL[MAX_LOOKAHEADS]; /* step of the L panel pulled in a buffer */
+    int use_rma = 0;
+    int sync_comm = (options->Fact_Comm == SLU_COMM_SYNC); /* MPI_Send */
+    int comm_threads = 0;     /* options->Fact_Comm = SLU_COMM_THREADS */
+    MPI_Comm *slot_comm = NULL; /* row and column comms of each slot */
+    double poll_last = 0.;    /* see poll_lookahead() */
+#ifdef _OPENMP
+    omp_lock_t poll_lock;
+#endif
+    char *ooc_done = NULL; /* options->OutOfCore, see sooc_retire() */
+    char *sn_dirty = Llu->sn_dirty; /* see SN_CLEAN() */
+    int_t ooc_next[2] = {0, 0};
+    unsigned char **Lpack = NULL, **Upack = NULL; /* Panel_Compress */
+    int_t *Ufold = NULL; /* options->SymPattern, see uindex_fold() */
+    int_t ldfold = 0;    /* length of a slot of Ufold[] */
+    int_t *usub_msg;
+    void *imsg, *ibuf;
+    int icnt;
+    MPI_Datatype itype;
+    MPI_Status status;
+    void *attr_val;
+    int flag;
+
+    /* The following variables are used to pad GEMM dimensions so that
+       each is a multiple of vector length (8 doubles for KNL)  */
+    int gemm_m_pad = GEMM_PADLEN, gemm_k_pad = GEMM_PADLEN,
+        gemm_n_pad = GEMM_PADLEN;
+    int gemm_padding = 0;
+
+    int iword = sizeof (int_t);
+    int dword = sizeof (float);
+
+    /* For measuring load imbalence in omp threads */
+    float omp_load_imblc = 0.0;
+    float *omp_loop_time;
+
+    double schur_flop_timer     = 0.0;
+    double psgstrf2_timer       = 0.0;
+    double psgstrs2_timer       = 0.0;
+    double lookaheadupdatetimer = 0.0;
+    double InitTimer            = 0.0; /* including compute schedule, malloc */
+    double tt_start, tt_end;
+
+/* #if !defined( GPU_ACC ) */
+    /* Counters for memory operations and timings */
+    float scatter_mem_op_counter  = 0.0;
+    double scatter_mem_op_timer    = 0.0;
+    float scatterL_mem_op_counter = 0.0;
+    double scatterL_mem_op_timer   = 0.0;
+    float scatterU_mem_op_counter = 0.0;
+    double scatterU_mem_op_timer   = 0.0;
+
+    /* Counters for flops/gather/scatter and timings */
+    double GatherLTimer            = 0.0;
+    float LookAheadRowSepMOP      = 0.0;
+    double GatherUTimer             = 0.0;
+    float GatherMOP               = 0.0;
+    double LookAheadGEMMTimer      = 0.0;
+    float LookAheadGEMMFlOp       = 0.0;
+    double LookAheadScatterTimer   = 0.0;
+    float LookAheadScatterMOP     = 0.0;
+    double RemainGEMMTimer         = 0.0;
+    float RemainGEMM_flops        = 0.0;
+    double RemainScatterTimer      = 0.0;
+    double NetSchurUpTimer         = 0.0;
+    float schur_flop_counter      = 0.0;
+/* #endif */
+
+#if ( PRNTlevel>= 1)
+    /* count GEMM max dimensions */
+    int gemm_max_m = 0, gemm_max_n = 0, gemm_max_k = 0;
+#endif
+
+#if ( DEBUGlevel>=2 )
+    int_t num_copy = 0, num_update = 0;
+#endif
+#if ( PRNTlevel==3 )
+    int zero_msg = 0, total_msg = 0;
+#endif
+#if ( PROFlevel>=1 )
+    double t1, t2;
+    float msg_vol = 0, msg_cnt = 0;
+    float comm_wait_time = 0.0;
+    /* Record GEMM dimensions and times */
+    FILE *fopen(), *fgemm;
+    int gemm_count = 0;
+    typedef struct {
+	int m, n, k;
+	float microseconds;
+    } gemm_profile;
+    gemm_profile *gemm_stats;
+#endif
+
+    /* Test the input parameters. */
+    *info = 0;
+    if (m < 0)
+        *info = -2;
+    else if (n < 0)
+        *info = -3;
+    if (*info) {
+        pxerr_dist ("psgstrf", grid, -*info);
+        return (-1);
+    }
+
+    /* Quick return if possible. */
+    if (m == 0 || n == 0) return 0;
+
+    double tt1 = SuperLU_timer_ ();
+    double t_trace;
+
+    /*
+     * Initialization.
+     */
+    iam = grid->iam;
+    Pc = grid->npcol;
+    Pr = grid->nprow;
+    myrow = MYROW (iam, grid);
+    mycol = MYCOL (iam, grid);
+    nsupers = Glu_persist->supno[n - 1] + 1;
+    xsup = Glu_persist->xsup;
+    /* With options->SchurSize > 0, the supernodes of the trailing
+       SchurSize columns only receive the updates of the others and are
+       left unfactored (see psGetSchur()). With options->DenseRoot_Tol > 0,
+       the supernodes of the dense root are factored after the main loop by
+       psgstrf_root(). */
+    nfact = options->SchurSize > 0 ? Glu_persist->supno[n - options->SchurSize]
+                                   : psgstrf_root_start(options, n, Glu_persist,
+                                                        grid, Llu);
+    s_eps = smach_dist("Epsilon");
+    thresh = s_eps * anorm;
+
+    MPI_Comm_get_attr (MPI_COMM_WORLD, MPI_TAG_UB, &attr_val, &flag);
+    if (!flag) {
+        fprintf (stderr, "Could not get TAG_UB\n");
+        return (-1);
+    }
+    int tag_ub = *(int *) attr_val;
+
+#if ( PRNTlevel>=1 )
+    if (!iam) {
+        printf ("MPI tag upper bound = %d\n", tag_ub); fflush(stdout);
+    }
+#endif
+
+#if ( DEBUGlevel>=1 )
+    if (s_eps == 0.0)
+        printf (" ***** warning s_eps = %e *****\n", s_eps);
+    CHECK_MALLOC (iam, "Enter psgstrf()");
+#endif
+#if (PROFlevel >= 1 )
+    gemm_stats = (gemm_profile *) SUPERLU_MALLOC(nsupers * sizeof(gemm_profile));
+    if (iam == 0) fgemm = fopen("dgemm_mnk.dat", "w");
+    int *prof_sendR = intCalloc_dist(nsupers);
+#endif
+
+    stat->ops[FACT]      = 0.0;
+    stat->current_buffer = 0.0;
+    stat->peak_buffer    = 0.0;
+    stat->gpu_buffer     = 0.0;
+
+    /* make sure the range of look-ahead window [0, MAX_LOOKAHEADS-1] */
+    if ( options->Fact_Comm == SLU_COMM_SYNC )
+        num_look_aheads = 0;
+    else if ( options->num_lookaheads < 0 )
+        num_look_aheads = adaptive_lookaheads(nsupers, Llu, grid);
+    else
+        num_look_aheads = SUPERLU_MAX(0, SUPERLU_MIN(options->num_lookaheads, MAX_LOOKAHEADS - 1));
+#if ( PRNTlevel>=1 )
+    if ( !iam && options->num_lookaheads < 0 )
+        printf(".. adaptive look-ahead depth %d\n", num_look_aheads);
+#endif
+
+    if ( options->MemBudget > 0.0 ) {
+	i = smem_budget(options, n, LUstruct, grid, &num_look_aheads, &u_chunk);
+	if ( i ) { /* The buffers do not fit even at the smallest. */
+	    if ( !iam )
+		fprintf(stderr, "psgstrf: MemBudget %g MB is short of %d MB\n",
+			options->MemBudget, (int) i);
+	    *info = n + i;
+	    return 0;
+	}
+    }
+
+    if (Pr * Pc > 1) {
+        if (!(U_diag_blk_send_req =
+              (MPI_Request *) SUPERLU_MALLOC (Pr * sizeof (MPI_Request))))
+            ABORT ("Malloc fails for U_diag_blk_send_req[].");
+	/* flag no outstanding Isend */
+        U_diag_blk_send_req[myrow] = MPI_REQUEST_NULL; /* used 0 before */
+
+        /* allocating buffers for look-ahead */
+        i = Llu->bufmax[0];
+        if (i != 0) {
+            if ( !(Llu->Lsub_buf_2[0] = (int_t *) superlu_malloc_comm
+                   ((num_look_aheads + 1) * (size_t) i * iword)) )
+                ABORT ("Malloc fails for Lsub_buf.");
+	    tempi = Llu->Lsub_buf_2[0];
+            for (jj = 0; jj < num_look_aheads; jj++)
+		Llu->Lsub_buf_2[jj+1] = tempi + i*(jj+1); /* vectorize */
+	    //Llu->Lsub_buf_2[jj + 1] = Llu->Lsub_buf_2[jj] + i;
+        }
+        i = Llu->bufmax[1];
+        if (i != 0) {
+            if (!(Llu->Lval_buf_2[0] = (float *) superlu_malloc_comm
+                  ((num_look_aheads + 1) * (size_t) i * dword)))
+                ABORT ("Malloc fails for Lval_buf[].");
+	    tempr = Llu->Lval_buf_2[0];
+            for (jj = 0; jj < num_look_aheads; jj++)
+		Llu->Lval_buf_2[jj+1] = tempr + i*(jj+1); /* vectorize */
+	    //Llu->Lval_buf_2[jj + 1] = Llu->Lval_buf_2[jj] + i;
+        }
+        i = Llu->bufmax[2];
+        if (i != 0) {
+            if (!(Llu->Usub_buf_2[0] = (int_t *) superlu_malloc_comm
+                  ((num_look_aheads + 1) * (size_t) i * iword)))
+                ABORT ("Malloc fails for Usub_buf_2[].");
+	    tempi = Llu->Usub_buf_2[0];
+            for (jj = 0; jj < num_look_aheads; jj++)
+                Llu->Usub_buf_2[jj+1] = tempi + i*(jj+1); /* vectorize */
+                //Llu->Usub_buf_2[jj + 1] = Llu->Usub_buf_2[jj] + i;
+        }
+        i = Llu->bufmax[3];
+        if (i != 0) {
+            if (!(Llu->Uval_buf_2[0] = (float *) superlu_malloc_comm
+                  ((num_look_aheads + 1) * (size_t) i * dword)))
+                ABORT ("Malloc fails for Uval_buf_2[].");
+	    tempr = Llu->Uval_buf_2[0];
+            for (jj = 0; jj < num_look_aheads; jj++)
+                Llu->Uval_buf_2[jj+1] = tempr + i*(jj+1); /* vectorize */
+	    //Llu->Uval_buf_2[jj + 1] = Llu->Uval_buf_2[jj] + i;
+        }
+    }
+
+    log_memory( (Llu->bufmax[0] + Llu->bufmax[2]) * (num_look_aheads + 1)
+		* iword +
+		(Llu->bufmax[1] + Llu->bufmax[3]) * (num_look_aheads + 1)
+		* dword, stat );
+
+    /* creating pointers to the look-ahead buffers */
+    if (! (Lsub_buf_2 = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (int_t *))))
+        ABORT ("Malloc fails for Lsub_buf_2[].");
+    if (! (Lval_buf_2 = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (float *))))
+        ABORT ("Malloc fails for Lval_buf_2[].");
+    if (! (Usub_buf_2 = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (int_t *))))
+        ABORT ("Malloc fails for Uval_buf_2[].");
+    if (! (Uval_buf_2 = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (float *))))
+        ABORT ("Malloc fails for buf_2[].");
+    for (i = 0; i <= num_look_aheads; i++) {
+        Lval_buf_2[i] = Llu->Lval_buf_2[i];
+        Lsub_buf_2[i] = Llu->Lsub_buf_2[i];
+        Uval_buf_2[i] = Llu->Uval_buf_2[i];
+        Usub_buf_2[i] = Llu->Usub_buf_2[i];
+    }
+
+    if (!(msgcnts = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (int *))))
+        ABORT ("Malloc fails for msgcnts[].");
+    if (!(msgcntsU = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (int *))))
+        ABORT ("Malloc fails for msgcntsU[].");
+    for (i = 0; i <= num_look_aheads; i++) {
+        if (!(msgcnts[i] = SUPERLU_MALLOC (4 * sizeof (int))))
+            ABORT ("Malloc fails for msgcnts[].");
+        if (!(msgcntsU[i] = SUPERLU_MALLOC (4 * sizeof (int))))
+            ABORT ("Malloc fails for msgcntsU[].");
+    }
+
+    if (! (recv_reqs_u = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (MPI_Request *))))
+        ABORT ("Malloc fails for recv_reqs_u[].");
+    if (! (send_reqs_u = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (MPI_Request *))))
+        ABORT ("Malloc fails for send_reqs_u[].");
+    if (! (send_reqs = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (MPI_Request *))))
+        ABORT ("Malloc fails for send_reqs_u[].");
+    if (! (recv_reqs = SUPERLU_MALLOC ((1 + num_look_aheads) * sizeof (MPI_Request *))))
+        ABORT ("Malloc fails for recv_reqs[].");
+    for (i = 0; i <= num_look_aheads; i++) {
+        if (!(recv_reqs_u[i] = (MPI_Request *) SUPERLU_MALLOC (2 * sizeof (MPI_Request))))
+            ABORT ("Malloc fails for recv_req_u[i].");
+        if (!(send_reqs_u[i] = (MPI_Request *) SUPERLU_MALLOC (2 * Pr * sizeof (MPI_Request))))
+            ABORT ("Malloc fails for send_req_u[i].");
+        if (!(send_reqs[i] = (MPI_Request *) SUPERLU_MALLOC (2 * Pc * sizeof (MPI_Request))))
+            ABORT ("Malloc fails for send_reqs[i].");
+        if (!(recv_reqs[i] = (MPI_Request *) SUPERLU_MALLOC (4 * sizeof (MPI_Request))))
+            ABORT ("Malloc fails for recv_req[].");
+        for (j = 0; j < 2 * Pc; ++j) send_reqs[i][j] = MPI_REQUEST_NULL;
+        for (j = 0; j < 2 * Pr; ++j) send_reqs_u[i][j] = MPI_REQUEST_NULL;
+        recv_reqs[i][0] = recv_reqs[i][1] = MPI_REQUEST_NULL;
+        recv_reqs_u[i][0] = recv_reqs_u[i][1] = MPI_REQUEST_NULL;
+    }
+
+    if (!(factored = SUPERLU_MALLOC (nsupers * sizeof (int_t))))
+        ABORT ("Malloc fails for factored[].");
+    if (!(factoredU = SUPERLU_MALLOC (nsupers * sizeof (int_t))))
+        ABORT ("Malloc fails for factoredU[].");
+    for (i = 0; i < nsupers; i++) factored[i] = factoredU[i] = -1;
+
+    log_memory(2 * nsupers * iword, stat);
+
+    int num_threads = superlu_num_threads();
+
+#if 0
+    omp_loop_time = (float *) _mm_malloc (sizeof (float) * num_threads,64);
+#else
+    omp_loop_time = (float *) SUPERLU_MALLOC(num_threads * sizeof(float));
+#endif
+
+#if ( PRNTlevel>=1 )
+    if(!iam) {
+       printf(".. Starting with %d OpenMP threads \n", num_threads );
+#ifdef _OPENMP
+       if ( num_threads > 1 && omp_get_proc_bind() == omp_proc_bind_false )
+           printf(".. OpenMP threads are not bound (OMP_PROC_BIND), "
+                  "the work arrays may be on a remote NUMA domain\n");
+#endif
+       fflush(stdout);
+    }
+#endif
+
+    nblocks = 0;
+    ncb = nsupers / Pc; /* number of column blocks, horizontal */
+    nrb = nsupers / Pr; /* number of row blocks, vertical  */
+
+    /* in order to have dynamic scheduling */
+    int *full_u_cols;
+    int *blk_ldu;
+#if 0
+    full_u_cols = (int_t *) _mm_malloc (sizeof (int_t) * ncb,64);
+    blk_ldu = (int_t *) _mm_malloc (sizeof (int_t) * ncb,64);
+#else
+    full_u_cols = SUPERLU_MALLOC((ncb+1) * sizeof(int));
+    blk_ldu = SUPERLU_MALLOC((ncb+1) * sizeof(int)); // +1 to accommodate un-even division
+#endif
+
+    log_memory(2 * ncb * iword, stat);
+
+#if 0  /* Sherry: not used? */
+    /* This bunch is used for static scheduling */
+    pair *full_col_count = (pair *) _mm_malloc (sizeof (pair) * ncb,64);
+    int_t *count_cols, *sum_cols, *partition;
+    count_cols = (int_t *) _mm_malloc (sizeof (int_t) * num_threads,64);
+    sum_cols = (int_t *) _mm_malloc (sizeof (int_t) * num_threads,64);
+    partition = (int_t *) _mm_malloc (sizeof (int_t) * num_threads * ncb,64);
+    int_t ldp = ncb;
+#endif
+
+    /* ##################################################################
+     *  Compute a good static schedule based on the factorization task graph.
+     * ################################################################## */
+    perm_c_supno = SUPERLU_MALLOC (2 * nsupers * sizeof (int_t));
+    iperm_c_supno = perm_c_supno + nsupers;
+
+    sstatic_schedule(options, m, n, LUstruct, grid, stat,
+		    perm_c_supno, iperm_c_supno, info);
+
+    if ( nfact < nsupers ) {
+        /* No interior panel depends on the unfactored ones, which are
+           moved to the end of the schedule. */
+        for (i = 0, j = 0; i < nsupers; ++i)
+            if ( perm_c_supno[i] < nfact ) iperm_c_supno[j++] = perm_c_supno[i];
+        for (i = 0; i < nsupers; ++i)
+            if ( perm_c_supno[i] >= nfact ) iperm_c_supno[j++] = perm_c_supno[i];
+        for (i = 0; i < nsupers; ++i) perm_c_supno[i] = iperm_c_supno[i];
+        for (i = 0; i < nsupers; ++i) iperm_c_supno[perm_c_supno[i]] = i;
+    }
+
+#if ( DEBUGlevel >= 2 )
+    PrintInt10("schedule:perm_c_supno", nsupers, perm_c_supno);
+
+    /* Turn off static schedule */
+    printf("[%d] .. Turn off static schedule for debugging ..\n", iam);
+    for (i = 0; i < nsupers; ++i) perm_c_supno[i] = iperm_c_supno[i] = i;
+#endif
+     /* ################################################################## */
+
+    /* constructing look-ahead table to indicate the last dependency */
+    int *look_ahead_l; /* Sherry: add comment on look_ahead_l[] */
+    stat->num_look_aheads = num_look_aheads;
+
+    look_ahead_l = SUPERLU_MALLOC (nsupers * sizeof (int));
+    look_ahead = SUPERLU_MALLOC (nsupers * sizeof (int));
+    for (lb = 0; lb < nsupers; lb++) look_ahead_l[lb] = -1; /* vectorized */
+    log_memory(3 * nsupers * iword, stat);
+
+    /* Sherry: omp parallel?
+       not worth doing, due to concurrent write to look_ahead_l[jb] */
+    for (lb = 0; lb < nrb; ++lb) { /* go through U-factor */
+        ib = lb * Pr + myrow;
+        index = Llu->Ufstnz_br_ptr[lb];
+        if (index) { /* Not an empty row */
+            k = BR_HEADER;
+            for (j = 0; j < index[0]; ++j) {
+                jb = index[k]; /* global block number */
+                if (jb != ib)
+                    look_ahead_l[jb] =
+                        SUPERLU_MAX (iperm_c_supno[ib], look_ahead_l[jb]);
+                k += UB_DESCRIPTOR + SuperSize (index[k]);
+            }
+        }
+    }
+    if (myrow < nsupers % grid->nprow) { /* leftover block rows */
+        ib = nrb * Pr + myrow;
+        index = Llu->Ufstnz_br_ptr[nrb];
+        if (index) {             /* Not an empty row */
+            k = BR_HEADER;
+            for (j = 0; j < index[0]; ++j) {
+                jb = index[k];
+                if (jb != ib)
+                    look_ahead_l[jb] =
+                        SUPERLU_MAX (iperm_c_supno[ib], look_ahead_l[jb]);
+                k += UB_DESCRIPTOR + SuperSize (index[k]);
+            }
+        }
+    }
+
+    if (options->SymPattern == NO) {
+	/* Sherry: omp parallel?
+	   not worth doing, due to concurrent write to look_ahead_l[jb] */
+        for (lb = 0; lb < ncb; lb++) { /* go through L-factor */
+            ib = lb * Pc + mycol;
+            index = Llu->Lrowind_bc_ptr[lb];
+            if (index) {
+                k = BC_HEADER;
+                for (j = 0; j < index[0]; j++) {
+                    jb = index[k];
+                    if (jb != ib)
+                        look_ahead_l[jb] =
+                            SUPERLU_MAX (iperm_c_supno[ib], look_ahead_l[jb]);
+                    k += LB_DESCRIPTOR + index[k + 1];
+                }
+            }
+        }
+        if (mycol < nsupers % grid->npcol) { /* leftover block columns */
+            ib = ncb * Pc + mycol;
+            index = Llu->Lrowind_bc_ptr[ncb];
+            if (index) {
+                k = BC_HEADER;
+                for (j = 0; j < index[0]; j++) {
+                    jb = index[k];
+                    if (jb != ib)
+                        look_ahead_l[jb] =
+                            SUPERLU_MAX (iperm_c_supno[ib], look_ahead_l[jb]);
+                    k += LB_DESCRIPTOR + index[k + 1];
+                }
+            }
+        }
+    }
+    MPI_Allreduce (look_ahead_l, look_ahead, nsupers, MPI_INT, MPI_MAX, grid->comm);
+    SUPERLU_FREE (look_ahead_l);
+
+#ifdef ISORT
+    iperm_u = SUPERLU_MALLOC (nsupers * sizeof (int_t));
+    perm_u = SUPERLU_MALLOC (nsupers * sizeof (int_t));
+#else
+    perm_u = SUPERLU_MALLOC (2 * nsupers * sizeof (int_t));
+#endif
+    log_memory(nsupers * iword, stat);
+
+    k = sp_ienv_dist (3);       /* max supernode size */
+#if 0
+    if ( !(Llu->ujrow = floatMalloc_dist(k*(k+1)/2)) )
+         ABORT("Malloc fails for ujrow[].");
+#else
+    /* Instead of half storage, we'll do full storage */
+    if (!(Llu->ujrow = floatCalloc_dist (k * k)))
+        ABORT ("Malloc fails for ujrow[].");
+#endif
+    log_memory(k * k * iword, stat);
+
+#if ( PRNTlevel>=1 )
+    if (!iam) {
+        printf (".. thresh = s_eps %e * anorm %e = %e\n", s_eps, anorm,
+                thresh);
+        printf
+            (".. Buffer size: Lsub %ld\tLval %ld\tUsub %ld\tUval %ld\tLDA %ld\n",
+             (long int) Llu->bufmax[0], (long int) Llu->bufmax[1],
+             (long int) Llu->bufmax[2], (long int) Llu->bufmax[3],
+             (long int) Llu->bufmax[4]);
+        fflush(stdout);
+    }
+#endif
+
+    Lrowind_bc_ptr = Llu->Lrowind_bc_ptr;
+    Lnzval_bc_ptr = Llu->Lnzval_bc_ptr;
+    Ufstnz_br_ptr = Llu->Ufstnz_br_ptr;
+    Unzval_br_ptr = Llu->Unzval_br_ptr;
+    ToRecv = Llu->ToRecv;
+    ToSendD = Llu->ToSendD;
+    ToSendR = Llu->ToSendR;
+
+    ldt = sp_ienv_dist (3);     /* Size of maximum supernode */
+    k = CEILING (nsupers, Pr);  /* Number of local block rows */
+
+    /* Following code is for finding maximum row dimension of all L panels */
+    int local_max_row_size = 0;
+    int max_row_size;
+
+#if 0
+#if defined _OPENMP  // Sherry: parallel reduction -- seems slower?
+#pragma omp parallel for reduction(max :local_max_row_size) private(lk,lsub)
+#endif
+#endif
+    for (i = mycol; i < nsupers; i += Pc) { /* grab my local columns */
+        //int tpc = PCOL (i, grid);
+	lk = LBj (i, grid);
+	lsub = Lrowind_bc_ptr[lk];
+	if (lsub != NULL) {
+	    if (lsub[1] > local_max_row_size) local_max_row_size = lsub[1];
+	}
+
+    }
+
+    /* Max row size is global reduction within a row */
+    MPI_Allreduce (&local_max_row_size, &max_row_size, 1, MPI_INT, MPI_MAX,
+                   (grid->rscp.comm));
+
+    /* Buffer size is max of look-ahead window */
+    /* int_t buffer_size =
+         SUPERLU_MAX (max_row_size * num_threads * ldt,
+                      get_max_buffer_size ());           */
+
+#ifdef GPU_ACC
+    int cublas_nb = get_cublas_nb(); // default 64
+    int nstreams = get_num_cuda_streams ();
+
+    int_t buffer_size  = SUPERLU_MAX(max_row_size*nstreams*cublas_nb,get_max_buffer_size());
+    /* array holding last column blk for each partition,
+       used in SchCompUdt--CUDA.c         */
+  #if 0
+    int *stream_end_col = (int_t *) _mm_malloc (sizeof (int_t) * nstreams,64);
+  #else
+    int *stream_end_col = SUPERLU_MALLOC( nstreams * sizeof(int) );
+  #endif
+
+#else /* not to use GPU */
+
+    int Threads_per_process = get_thread_per_process();
+    int_t buffer_size  = SUPERLU_MAX(max_row_size*Threads_per_process*ldt,get_max_buffer_size());
+#endif /* end ifdef GPU_ACC */
+
+    int_t max_ncols = 0;
+#if 0
+    /* symmetric assumption -- using L's supernode to estimate. */
+    /* Note that in following expression 8 can be anything
+       as long as its not too big */
+    int bigu_size = 8 * sp_ienv_dist (3) * (max_row_size);
+#else
+    int_t bigu_size = estimate_bigu_size( nsupers, Ufstnz_br_ptr, Glu_persist,
+    	                                  grid, perm_u, &max_ncols );
+#endif
+
+    if ( u_chunk > 0 ) { /* U(k,:) is updated by chunks, see smem_budget() */
+	bigu_size = bigu_size / max_ncols * u_chunk;
+	max_ncols = u_chunk;
+    }
+
+    /* +16 to avoid cache line false sharing */
+    // int_t bigv_size = SUPERLU_MAX(max_row_size * (bigu_size / ldt),
+    int_t bigv_size = SUPERLU_MAX(max_row_size * max_ncols,
+				  (ldt*ldt + CACHELINE / dword) * num_threads);
+
+    /* bigU and bigV are only allocated on CPU, but may be allocated as
+       page-locked memory accessible to GPU. */
+    float* bigU; /* for storing entire U(k,:) panel, prepare for GEMM. */
+    float* bigV; /* for storing GEMM output matrix, i.e. update matrix.
+	              bigV is large enough to hold the aggregate GEMM output.*/
+    bigU = NULL; /* allocated only on CPU */
+    bigV = NULL;
+
+#if ( PRNTlevel>=1 )
+    if(!iam) printf("\t.. GEMM buffer size: max_row_size X max_ncols = %d x " IFMT "\n",
+	     		  max_row_size, max_ncols);
+    printf("[%d].. BIG U size " IFMT " (on CPU)\n", iam, bigu_size);
+    fflush(stdout);
+#endif
+
+#ifdef GPU_ACC /*-- use GPU --*/
+
+    if ( checkCuda(cudaHostAlloc((void**)&bigU,  bigu_size * sizeof(float), cudaHostAllocDefault)) )
+        ABORT("Malloc fails for dgemm buffer U ");
+
+#if 0 // !!Sherry fix -- only dC on GPU uses buffer_size
+    bigv_size = buffer_size;
+#endif
+
+#if ( PRNTlevel>=1 )
+    printf("[%d].. BIG V size %d (on CPU), dC buffer_size %d (on GPU)\n", iam, bigv_size, buffer_size);
+    fflush(stdout);
+#endif
+
+    if ( checkCuda(cudaHostAlloc((void**)&bigV, bigv_size * sizeof(float) ,cudaHostAllocDefault)) )
+        ABORT("Malloc fails for dgemm buffer V");
+
+    DisplayHeader();
+
+#if ( PRNTlevel>=1 )
+    printf(" Starting with %d Cuda Streams \n",nstreams );
+#endif
+
+    cublasHandle_t *handle;
+    handle = (cublasHandle_t *) SUPERLU_MALLOC(sizeof(cublasHandle_t)*nstreams);
+    for(int i = 0; i < nstreams; i++) handle[i] = create_handle();
+
+    // creating streams
+    cudaStream_t *streams;
+    streams = (cudaStream_t *) SUPERLU_MALLOC(sizeof(cudaStream_t)*nstreams);
+    for (int i = 0; i < nstreams; ++i)
+        checkCuda( cudaStreamCreate(&streams[i]) );
+
+    // allocating data in device
+    float *dA, *dB, *dC;
+    cudaError_t cudaStat;
+#if 0
+    // cudaStat = cudaMalloc( (void**)&dA, m*k*sizeof(float));
+    // HOw much should be the size of dA?
+    // for time being just making it
+    // cudaStat = cudaMalloc( (void**)&dA, ((max_row_size*sp_ienv_dist(3)))* sizeof(float));
+#endif
+
+    cudaStat = cudaMalloc( (void**)&dA, max_row_size*sp_ienv_dist(3)* sizeof(float));
+    if (cudaStat!= cudaSuccess) {
+        fprintf(stderr, "!!!! Error in allocating A in the device %ld \n",m*k*sizeof(float) );
+        return 1;
+    }
+
+    // size of B should be bigu_size
+    cudaStat = cudaMalloc((void**)&dB, bigu_size * sizeof(float));
+    if (cudaStat!= cudaSuccess) {
+        fprintf(stderr, "!!!! Error in allocating B in the device %ld \n",n*k*sizeof(float));
+        return 1;
+    }
+
+    cudaStat = cudaMalloc((void**)&dC, buffer_size * sizeof(float) );
+    if (cudaStat!= cudaSuccess) {
+        fprintf(stderr, "!!!! Error in allocating C in the device \n" );
+        return 1;
+    }
+
+    stat->gpu_buffer += ( max_row_size * sp_ienv_dist(3)
+			  + bigu_size + buffer_size ) * dword;
+
+#else   /*-- not to use GPU --*/
+
+    // for GEMM padding 0
+    j = bigu_size / ldt;
+    bigu_size += (gemm_k_pad * (j + ldt + gemm_n_pad));
+    bigv_size += (gemm_m_pad * (j + max_row_size + gemm_n_pad));
+
+#if ( PRNTlevel>=1 )
+    printf("[%d].. BIG V size %d (on CPU)\n", iam, bigv_size);
+    fflush(stdout);
+#endif
+
+//#ifdef __INTEL_COMPILER
+//    bigU = _mm_malloc(bigu_size * sizeof(float), 1<<12); // align at 4K page
+//    bigV = _mm_malloc(bigv_size * sizeof(float), 1<<12);
+//#endif
+    /* bigU and bigV are taken from the arena below. */
+
+    log_memory((bigv_size + bigu_size) * dword, stat);
+#endif /* end ifdef GPU_ACC */
+
+    // mlock(bigU,(bigu_size) * sizeof (float));
+
+#if ( PRNTlevel>=1 )
+    if(!iam) {
+	printf ("  Max row size is %d \n", max_row_size);
+        printf ("  Threads per process %d \n", num_threads);
+	fflush(stdout);
+    }
+
+#endif
+
+    int_t mrb = (nsupers + Pr - 1) / Pr;
+    int_t mcb = (nsupers + Pc - 1) / Pc;
+
+    /* Sherry: (ldt + 16), avoid cache line false sharing.
+       KNL cacheline size = 64 bytes = 16 int */
+    iinfo = ldt + CACHELINE / sizeof(int);
+    j = gemm_m_pad * (ldt + max_row_size + gemm_k_pad);
+
+    /* The work arrays below are used until the end of the factorization
+       and are all taken from one arena. The last 3 * mcb integers are the
+       scratch space of psgstrs2_omp(), released after each U panel. */
+    arena_size = 2 * superlu_arena_bytes(iinfo * num_threads * sizeof(int))
+	+ 4 * superlu_arena_bytes((num_look_aheads + 1) * iword)
+	+ 3 * superlu_arena_bytes(mrb * iword)
+	+ superlu_arena_bytes(mrb * sizeof(Remain_info_t))
+	+ 2 * superlu_arena_bytes(mrb * iword) + 2 * superlu_arena_bytes(mcb * iword)
+	+ superlu_arena_bytes((size_t) ldt * ldt * (num_look_aheads + 1) * dword)
+	+ superlu_arena_bytes((size_t) (Llu->bufmax[1] + j) * dword) /* This is loose */
+	+ superlu_arena_bytes(mcb * sizeof(Ublock_info_t))
+	+ superlu_arena_bytes(3 * mcb * sizeof(int));
+#ifndef GPU_ACC
+    arena_size += superlu_arena_bytes((size_t) bigu_size * dword)
+	+ superlu_arena_bytes((size_t) bigv_size * dword);
+#endif
+    superlu_arena_init(&arena, arena_size);
+    log_memory(arena.size, stat);
+
+#ifndef GPU_ACC
+    bigU = (float *) superlu_arena_alloc(&arena, (size_t) bigu_size * dword);
+    bigV = (float *) superlu_arena_alloc(&arena, (size_t) bigv_size * dword);
+#endif
+    indirect = (int *) superlu_arena_alloc(&arena, iinfo * num_threads * sizeof(int));
+    indirect2 = (int *) superlu_arena_alloc(&arena, iinfo * num_threads * sizeof(int));
+#ifndef GPU_ACC
+    first_touch_scratch(num_threads, indirect, indirect2, iinfo,
+                        bigV, bigv_size, ldt, bigU, bigu_size);
+#endif
+
+    int_t *lookAheadFullRow,*lookAheadStRow,*lookAhead_lptr,*lookAhead_ib,
+          *RemainStRow;
+
+    lookAheadFullRow = (int_t *) superlu_arena_alloc(&arena, (num_look_aheads+1) * iword);
+    lookAheadStRow   = (int_t *) superlu_arena_alloc(&arena, (num_look_aheads+1) * iword);
+    lookAhead_lptr   = (int_t *) superlu_arena_alloc(&arena, (num_look_aheads+1) * iword);
+    lookAhead_ib     = (int_t *) superlu_arena_alloc(&arena, (num_look_aheads+1) * iword);
+
+    RemainStRow  = (int_t *) superlu_arena_alloc(&arena, mrb * iword);
+
+    Remain_info_t *Remain_info;
+    Remain_info = (Remain_info_t *) superlu_arena_alloc(&arena, mrb * sizeof(Remain_info_t));
+
+    /* Order in which the Schur complement tiles L(i,k)*U(k,j) are handed
+       to the threads: the largest first (see sSchCompUdt-2Ddynamic.c). */
+    int_t *Remain_key, *Remain_order, *Ublock_key, *Ublock_order;
+    Remain_key   = (int_t *) superlu_arena_alloc(&arena, mrb * iword);
+    Remain_order = (int_t *) superlu_arena_alloc(&arena, mrb * iword);
+    Ublock_key   = (int_t *) superlu_arena_alloc(&arena, mcb * iword);
+    Ublock_order = (int_t *) superlu_arena_alloc(&arena, mcb * iword);
+
+    float *lookAhead_L_buff, *Remain_L_buff; /* Stores entire L-panel */
+    Ublock_info_t *Ublock_info;
+    /* The following is quite loose */
+    lookAhead_L_buff = (float *) superlu_arena_alloc(&arena,
+                           (size_t) ldt * ldt * (num_look_aheads + 1) * dword);
+    Remain_L_buff = (float *) superlu_arena_alloc(&arena, (size_t) (Llu->bufmax[1] + j) * dword);
+    Ublock_info = (Ublock_info_t *) superlu_arena_alloc(&arena, mcb * sizeof(Ublock_info_t));
+
+    /* The panels are pulled one-sided from the slabs of the values of L
+       and U, so the factors of all the processes must be in slabs. */
+    if ( options->Fact_Comm == SLU_COMM_RMA && Pr * Pc > 1 ) {
+        flag = (Llu->Lnzval_slab != NULL && Llu->Unzval_slab != NULL);
+        MPI_Allreduce(&flag, &use_rma, 1, MPI_INT, MPI_MIN, grid->comm);
+#if ( PRNTlevel>=1 )
+        if ( !iam && !use_rma )
+            printf(".. no slab storage of L and U, panels sent with MPI_Isend\n");
+#endif
+    }
+    if ( use_rma ) {
+        panel_rma_init(&Lrma, 1, nsupers, xsup, grid->rscp.comm, mycol, Pc,
+                       Lrowind_bc_ptr, Lnzval_bc_ptr, Llu->Lnzval_slab);
+        panel_rma_init(&Urma, 0, nsupers, xsup, grid->cscp.comm, myrow, Pr,
+                       Ufstnz_br_ptr, Unzval_br_ptr, Llu->Unzval_slab);
+        for (i = 0; i <= num_look_aheads; ++i) rma_inL[i] = -1;
+    }
+    /* Each look-ahead slot has its own row and column communicators,
+       which the MPI libraries with several network contexts match
+       independently, and the threads of the Schur complement update test
+       the panel messages; needs MPI_THREAD_MULTIPLE on all the processes. */
+#ifdef _OPENMP
+    if ( options->Fact_Comm == SLU_COMM_THREADS && Pr * Pc > 1 ) {
+        MPI_Query_thread(&flag);
+        flag = (flag == MPI_THREAD_MULTIPLE);
+        MPI_Allreduce(&flag, &comm_threads, 1, MPI_INT, MPI_MIN, grid->comm);
+#if ( PRNTlevel>=1 )
+        if ( !iam && !comm_threads )
+            printf(".. MPI_THREAD_MULTIPLE not provided, panels sent as with SLU_COMM_IRECV\n");
+#endif
+    }
+    if ( comm_threads ) {
+        if ( !(slot_comm = (MPI_Comm *) SUPERLU_MALLOC(2 * (1 + num_look_aheads)
+                                                       * sizeof(MPI_Comm))) )
+            ABORT ("Malloc fails for slot_comm[].");
+        for (i = 0; i <= num_look_aheads; ++i) {
+            MPI_Comm_dup(grid->rscp.comm, &slot_comm[2 * i]);
+            MPI_Comm_dup(grid->cscp.comm, &slot_comm[2 * i + 1]);
+        }
+        omp_init_lock(&poll_lock);
+    }
+#endif
+    if ( options->Panel_Compress == YES && Pr * Pc > 1 && !use_rma ) {
+        Lpack = index_pack_alloc(num_look_aheads, Llu->bufmax[0]);
+        Upack = index_pack_alloc(num_look_aheads, Llu->bufmax[2]);
+    }
+    /* A slot for each look-ahead, and a scratch for the receives. */
+    if ( options->SymPattern == YES && Pr > 1 && !use_rma ) {
+        ldfold = SUPERLU_MAX(Llu->bufmax[2], 1);
+        if ( !(Ufold = intMalloc_dist((2 + num_look_aheads) * ldfold)) )
+            ABORT ("Malloc fails for Ufold[].");
+    }
+
+    InitTimer = SuperLU_timer_() - tt1;
+
+    superlu_trace_init(grid, stat);
+    superlu_histo_supernodes(stat, nsupers, xsup);
+    /* Drives the panel sends while the threads update, if requested. */
+    superlu_progress_t *progress = superlu_progress_start(grid);
+    /* One BLAS thread in the parallel regions; see superlu_blas_threads.c */
+    int blas_threads = superlu_blas_set_threads(1);
+    stat->fact_sent = stat->fact_recv = stat->fact_wait = 0.;
+    stat->fact_dropped = 0.;
+    superlu_sncost_start(options, stat, nsupers);
+    Llu->droptol = SUPERLU_MAX(options->ILU_DropTol, 0.0);
+    double pxgstrfTimer = SuperLU_timer_();
+    superlu_hwc_begin(stat, HWC_FACT);
+    SUPERLU_PROF_BEGIN(PROF_FACT, EMPTY);
+
+    /* ##################################################################
+       ** Handle first block column separately to start the pipeline. **
+       ################################################################## */
+    look_id = 0;
+    msgcnt = msgcnts[0]; /* Lsub[0] to be transferred */
+    send_req = send_reqs[0];
+    recv_req = recv_reqs[0];
+
+    k0 = 0;
+    k = perm_c_supno[0];
+    kcol = PCOL (k, grid);
+    krow = PROW (k, grid);
+    if (mycol == kcol) {
+        double ttt1 = SuperLU_timer_();
+
+	/* panel factorization */
+        if ( !SN_CLEAN(k) )
+            PSGSTRF2 (options, k0, k, thresh, Glu_persist, grid, Llu,
+                      U_diag_blk_send_req, tag_ub, stat, info);
+
+        psgstrf2_timer += SuperLU_timer_()-ttt1;
+        superlu_trace_event(stat, TRACE_PANEL_L, k, ttt1);
+
+        scp = &grid->rscp;      /* The scope of process row. */
+
+        /* Multicasts numeric values of L(:,0) to process rows. */
+        lk = LBj (k, grid);     /* Local block number. */
+        lsub = Lrowind_bc_ptr[lk];
+        lusup = Lnzval_bc_ptr[lk];
+        if (lsub) {
+	    /* number of entries in Lsub_buf[] to be transferred */
+            msgcnt[0] = lsub[1] + BC_HEADER + lsub[0] * LB_DESCRIPTOR;
+	    /* number of entries in Lval_buf[] to be transferred */
+            msgcnt[1] = lsub[1] * SuperSize (k);
+        } else {
+            msgcnt[0] = msgcnt[1] = 0;
+        }
+
+        if ( use_rma ) panel_rma_ready(&Lrma, mycol, lk);
+        imsg = index_msg(lsub, msgcnt[0], Lpack, look_id, &icnt, &itype);
+        for (pj = 0; pj < Pc; ++pj) {
+            if (!use_rma && ToSendR[lk][pj] != EMPTY) {
+#if ( PROFlevel>=1 )
+                TIC (t1);
+#endif
+
+                t_trace = TRACE_TIME(stat);
+                if ( sync_comm ) { /* see SLU_COMM_SYNC */
+                    MPI_Send (imsg, icnt, itype, pj,
+                              SLU_MPI_TAG (0, 0) /* 0 */,
+                              PANEL_COMM (scp, 0));
+                    MPI_Send (lusup, msgcnt[1], MPI_FLOAT, pj,
+                              SLU_MPI_TAG (1, 0) /* 1 */,
+                              PANEL_COMM (scp, 0));
+                } else {
+                    MPI_Isend (imsg, icnt, itype, pj,
+                               SLU_MPI_TAG (0, 0) /* 0 */,
+                               PANEL_COMM (scp, 0), &send_req[pj]);
+                    MPI_Isend (lusup, msgcnt[1], MPI_FLOAT, pj,
+                               SLU_MPI_TAG (1, 0) /* 1 */,
+                               PANEL_COMM (scp, 0), &send_req[pj + Pc]);
+                }
+                superlu_trace_event(stat, TRACE_SEND_L, k, t_trace);
+                stat->fact_sent += (double) msgcnt[0] * iword + msgcnt[1] * dword;
+#if ( DEBUGlevel>=2 )
+                printf ("[%d] first block cloumn Send L(:,%4d): lsub %4d, lusup %4d to Pc %2d\n",
+                        iam, 0, msgcnt[0], msgcnt[1], pj);
+#endif
+
+#if ( PROFlevel>=1 )
+                TOC (t2, t1);
+                stat->utime[COMM] += t2;
+                stat->utime[COMM_RIGHT] += t2;
+		++prof_sendR[lk];
+                msg_cnt += 2;
+                msg_vol += msgcnt[0] * iword + msgcnt[1] * dword;
+#endif
+            } /* end if */
+        }  /* end for pj ... */
+        superlu_sncost_charge(stat, SNCOST_PANEL, k);
+    } else {  /* Post immediate receives. */
+        if (!use_rma && ToRecv[k] >= 1) {   /* Recv block column L(:,0). */
+            scp = &grid->rscp;  /* The scope of process row. */
+#if ( PROFlevel>=1 )
+	    TIC (t1);
+#endif
+            ibuf = index_recv_buf(Lsub_buf_2[0], Llu->bufmax[0], Lpack, 0, &icnt, &itype);
+            MPI_Irecv (ibuf, icnt, itype, kcol,
+                       SLU_MPI_TAG (0, 0) /* 0 */ ,
+                       PANEL_COMM (scp, 0), &recv_req[0]);
+            MPI_Irecv (Lval_buf_2[0], Llu->bufmax[1], MPI_FLOAT, kcol,
+                       SLU_MPI_TAG (1, 0) /* 1 */ ,
+                       PANEL_COMM (scp, 0), &recv_req[1]);
+#if ( PROFlevel>=1 )
+	    TOC (t2, t1);
+	    stat->utime[COMM] += t2;
+	    stat->utime[COMM_RIGHT] += t2;
+#endif
+        }
+    } /* end if mycol == 0 */
+
+    factored[k] = 0; /* flag column k as factored. */
+
+    /* post receive of first U-row */
+    if (myrow != krow) {
+        if (!use_rma && ToRecv[k] == 2) {   /* Recv block row U(k,:). */
+            scp = &grid->cscp;  /* The scope of process column. */
+            Usub_buf = Llu->Usub_buf_2[0];
+            Uval_buf = Llu->Uval_buf_2[0];
+#if ( PROFlevel>=1 )
+	    TIC (t1);
+#endif
+            ibuf = index_recv_buf(Usub_buf, Llu->bufmax[2], Upack, 0, &icnt, &itype);
+            MPI_Irecv (ibuf, icnt, itype, krow,
+                       SLU_MPI_TAG (2, 0) /* 2%tag_ub */ ,
+                       PANEL_COMM (scp, 0), &recv_reqs_u[0][0]);
+            MPI_Irecv (Uval_buf, Llu->bufmax[3], MPI_FLOAT, krow,
+                       SLU_MPI_TAG (3, 0) /* 3%tag_ub */ ,
+                       PANEL_COMM (scp, 0), &recv_reqs_u[0][1]);
+#if ( PROFlevel>=1 )
+	    TOC (t2, t1);
+	    stat->utime[COMM] += t2;
+	    stat->utime[COMM_DOWN] += t2;
+#endif
+        }
+    }
+
+    /* The values of L and U in files are written out as the steps are
+       done with them. */
+    if ( Llu->Lnzval_ooc.base || Llu->Unzval_ooc.base ) {
+        superlu_ooc_rewind(&Llu->Lnzval_ooc);
+        superlu_ooc_rewind(&Llu->Unzval_ooc);
+        if ( !(ooc_done = (char *) SUPERLU_MALLOC(mcb + mrb)) )
+            ABORT("Malloc fails for ooc_done[].");
+        memset(ooc_done, 0, mcb + mrb);
+    }
+
+    /* ##################################################################
+       **** MAIN LOOP ****
+       ################################################################## */
+    for (k0 = 0; k0 < nfact; ++k0) {
+        k = perm_c_supno[k0];
+        SUPERLU_PROF_BEGIN(PROF_STEP, k);
+
+        /* ============================================ *
+         * ======= look-ahead the new L columns ======= *
+         * ============================================ */
+        /* tt1 = SuperLU_timer_(); */
+        if (k0 == 0) { /* look-ahead all the columns in the window */
+            kk1 = k0 + 1;
+            kk2 = SUPERLU_MIN (k0 + num_look_aheads, nfact - 1);
+        } else {  /* look-ahead one new column after the current window */
+            kk1 = k0 + num_look_aheads;
+            kk2 = SUPERLU_MIN (kk1, nfact - 1);
+        }
+
+        for (kk0 = kk1; kk0 <= kk2; kk0++) {
+	    /* loop through look-ahead window in L */
+
+            kk = perm_c_supno[kk0]; /* use the ordering from static schedule */
+            look_id = kk0 % (1 + num_look_aheads); /* which column in window */
+
+            if (look_ahead[kk] < k0) { /* does not depend on current column k */
+                kcol = PCOL (kk, grid);
+                if (mycol == kcol) { /* I own this panel */
+
+                    /* Panel factorization -- Factor diagonal and subdiagonal
+                       L blocks and test for exact singularity.  */
+                    factored[kk] = 0; /* flag column kk as factored */
+                    double ttt1 = SuperLU_timer_();
+
+                    if ( !SN_CLEAN(kk) )
+                        PSGSTRF2 (options, kk0, kk, thresh, Glu_persist,
+                                  grid, Llu, U_diag_blk_send_req, tag_ub, stat, info);
+
+                     psgstrf2_timer += SuperLU_timer_() - ttt1;
+                     superlu_trace_event(stat, TRACE_PANEL_L, kk, ttt1);
+
+                    /* Multicasts numeric values of L(:,kk) to process rows. */
+                    /* ttt1 = SuperLU_timer_(); */
+                    msgcnt = msgcnts[look_id];  /* point to the proper count array */
+                    send_req = send_reqs[look_id];
+
+                    lk = LBj (kk, grid);    /* Local block number in L. */
+                    lsub1 = Lrowind_bc_ptr[lk];
+                    if (lsub1) {
+                        msgcnt[0] = lsub1[1] + BC_HEADER + lsub1[0] * LB_DESCRIPTOR; /* size of metadata */
+                        msgcnt[1] = lsub1[1] * SuperSize (kk); /* Lval_buf[] size */
+                    } else {
+                        msgcnt[0] = 0;
+                        msgcnt[1] = 0;
+                    }
+                    scp = &grid->rscp;  /* The scope of process row. */
+                    if ( use_rma ) panel_rma_ready(&Lrma, mycol, lk);
+                    imsg = index_msg(lsub1, msgcnt[0], Lpack, look_id, &icnt, &itype);
+                    for (pj = 0; pj < Pc; ++pj) {
+                        if (!use_rma && ToSendR[lk][pj] != EMPTY) {
+                            lusup1 = Lnzval_bc_ptr[lk];
+#if ( PROFlevel>=1 )
+			    TIC (t1);
+#endif
+                            t_trace = TRACE_TIME(stat);
+                            if ( sync_comm ) { /* see SLU_COMM_SYNC */
+                                MPI_Send (imsg, icnt, itype, pj,
+                                          SLU_MPI_TAG (0, kk0),  /* (4*kk0)%tag_ub */
+                                          PANEL_COMM (scp, kk0));
+                                MPI_Send (lusup1, msgcnt[1], MPI_FLOAT, pj,
+                                          SLU_MPI_TAG (1, kk0),  /* (4*kk0+1)%tag_ub */
+                                          PANEL_COMM (scp, kk0));
+                            } else {
+                                MPI_Isend (imsg, icnt, itype, pj,
+                                           SLU_MPI_TAG (0, kk0),  /* (4*kk0)%tag_ub */
+                                           PANEL_COMM (scp, kk0), &send_req[pj]);
+                                MPI_Isend (lusup1, msgcnt[1], MPI_FLOAT, pj,
+                                           SLU_MPI_TAG (1, kk0),  /* (4*kk0+1)%tag_ub */
+                                           PANEL_COMM (scp, kk0), &send_req[pj + Pc]);
+                            }
+                            superlu_trace_event(stat, TRACE_SEND_L, kk, t_trace);
+                            stat->fact_sent += (double) msgcnt[0] * iword + msgcnt[1] * dword;
+#if ( PROFlevel>=1 )
+			    TOC (t2, t1);
+			    stat->utime[COMM] += t2;
+			    stat->utime[COMM_RIGHT] += t2;
+			    ++prof_sendR[lk];
+#endif
+#if ( DEBUGlevel>=2 )
+			    printf ("[%d] -1- Send L(:,%4d): #lsub1 %4d, #lusup1 %4d right to Pj %2d\n",
+				    iam, kk, msgcnt[0], msgcnt[1], pj);
+#endif
+                        }
+                    }
+                    /* stat->time9 += SuperLU_timer_() - ttt1; */
+                    superlu_sncost_charge(stat, SNCOST_PANEL, kk);
+                } else {     /* Post Recv of block column L(:,kk). */
+                    /* double ttt1 = SuperLU_timer_(); */
+                    if (!use_rma && ToRecv[kk] >= 1) {
+                        scp = &grid->rscp;  /* The scope of process row. */
+                        recv_req = recv_reqs[look_id];
+#if ( PROFlevel>=1 )
+			TIC (t1);
+#endif
+                        ibuf = index_recv_buf(Lsub_buf_2[look_id], Llu->bufmax[0],
+                                              Lpack, look_id, &icnt, &itype);
+                        MPI_Irecv (ibuf, icnt,
+                                   itype, kcol, SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
+                                   PANEL_COMM (scp, kk0), &recv_req[0]);
+                        MPI_Irecv (Lval_buf_2[look_id], Llu->bufmax[1],
+                                   MPI_FLOAT, kcol,
+                                   SLU_MPI_TAG (1, kk0), /* (4*kk0+1)%tag_ub */
+                                   PANEL_COMM (scp, kk0), &recv_req[1]);
+#if ( PROFlevel>=1 )
+			TOC (t2, t1);
+			stat->utime[COMM] += t2;
+			stat->utime[COMM_RIGHT] += t2;
+#endif
+                    }
+                    /* stat->time10 += SuperLU_timer_() - ttt1; */
+                }  /* end if mycol == Pc(kk) */
+            }  /* end if look-ahead in L panels */
+
+            /* Pre-post irecv for U-row look-ahead */
+            krow = PROW (kk, grid);
+            if (myrow != krow) {
+                if (!use_rma && ToRecv[kk] == 2) { /* post iRecv block row U(kk,:). */
+                    scp = &grid->cscp;  /* The scope of process column. */
+                    Usub_buf = Llu->Usub_buf_2[look_id];
+                    Uval_buf = Llu->Uval_buf_2[look_id];
+#if ( PROFlevel>=1 )
+		    TIC (t1);
+#endif
+                    ibuf = index_recv_buf(Usub_buf, Llu->bufmax[2], Upack, look_id, &icnt, &itype);
+                    MPI_Irecv (ibuf, icnt, itype, krow,
+                               SLU_MPI_TAG (2, kk0) /* (4*kk0+2)%tag_ub */ ,
+                               PANEL_COMM (scp, kk0), &recv_reqs_u[look_id][0]);
+                    MPI_Irecv (Uval_buf, Llu->bufmax[3], MPI_FLOAT, krow,
+                               SLU_MPI_TAG (3, kk0) /* (4*kk0+3)%tag_ub */ ,
+                               PANEL_COMM (scp, kk0), &recv_reqs_u[look_id][1]);
+#if ( PROFlevel>=1 )
+		    TOC (t2, t1);
+		    stat->utime[COMM] += t2;
+		    stat->utime[COMM_DOWN] += t2;
+#endif
+                }
+            }
+
+        }  /* end for each column in look-ahead window for L panels */
+
+        /* stat->time4 += SuperLU_timer_()-tt1; */
+
+        /* ================================= *
+         * ==== look-ahead the U rows    === *
+         * ================================= */
+        kk1 = k0;
+        kk2 = SUPERLU_MIN (k0 + num_look_aheads, nfact - 1);
+        for (kk0 = kk1; kk0 < kk2; kk0++) {
+            kk = perm_c_supno[kk0]; /* order determined from static schedule */
+            if (factoredU[kk0] != 1 && look_ahead[kk] < k0) {
+		/* does not depend on current column k */
+                kcol = PCOL (kk, grid);
+                krow = PROW (kk, grid);
+                lk = LBj (kk, grid);  /* Local block number across row. NOT USED?? -- Sherry */
+
+                look_id = kk0 % (1 + num_look_aheads);
+                msgcnt = msgcntsU[look_id];
+                recv_req = recv_reqs[look_id];
+
+                /* ================================================= *
+                 * Check if diagonal block has been received         *
+                 * for panel factorization of U in look-ahead window *
+                 * ================================================= */
+
+                if (mycol == kcol) {  /* I own this column panel, no need
+                                         to receive L  */
+                    flag0 = flag1 = 1;
+                    msgcnt[0] = msgcnt[1] = -1; /* No need to transfer Lsub, nor Lval */
+                } else { /* Check to receive L(:,kk) from the left */
+                    flag0 = flag1 = 0;
+                    if ( ToRecv[kk] >= 1 ) {
+#if ( PROFlevel>=1 )
+			TIC (t1);
+#endif
+                        if ( recv_req[0] != MPI_REQUEST_NULL ) {
+                            MPI_Test (&recv_req[0], &flag0, &status);
+                            if ( flag0 ) {
+                                msgcnt[0] = index_recv_count(&status, Lsub_buf_2[look_id],
+                                                             Lpack, look_id);
+                                recv_req[0] = MPI_REQUEST_NULL;
+                            }
+                        } else flag0 = 1;
+
+                        if ( recv_req[1] != MPI_REQUEST_NULL ) {
+                            MPI_Test (&recv_req[1], &flag1, &status);
+                            if ( flag1 ) {
+                                MPI_Get_count (&status, MPI_FLOAT, &msgcnt[1]);
+                                recv_req[1] = MPI_REQUEST_NULL;
+                            }
+                        } else flag1 = 1;
+
+                        if ( use_rma ) { /* pull L(:,kk) if it is ready */
+                            if ( rma_inL[look_id] != kk0
+                                 && panel_rma_get(&Lrma, kcol, LBj (kk, grid), 0,
+                                                  Lsub_buf_2[look_id],
+                                                  Lval_buf_2[look_id], msgcnt) )
+                                rma_inL[look_id] = kk0;
+                            flag0 = flag1 = (rma_inL[look_id] == kk0);
+                        }
+#if ( PROFlevel>=1 )
+			TOC (t2, t1);
+			stat->utime[COMM] += t2;
+			stat->utime[COMM_RIGHT] += t2;
+#endif
+                    } else {
+                        msgcnt[0] = 0;
+ 	            }
+                }
+
+                if (flag0 && flag1) { /* L(:,kk) is ready */
+                    /* tt1 = SuperLU_timer_(); */
+                    scp = &grid->cscp;  /* The scope of process column. */
+                    if (myrow == krow) {
+                        factoredU[kk0] = 1;
+                        /* Parallel triangular solve across process row *krow* --
+                           U(k,j) = L(k,k) \ A(k,j).  */
+                        double ttt2 = SuperLU_timer_();
+#ifdef _OPENMP
+/* #pragma omp parallel */ /* Sherry -- parallel done inside psgstrs2 */
+#endif
+			{
+                            if ( !SN_CLEAN(kk) )
+                                psgstrs2_omp (kk0, kk, Glu_persist, grid, Llu,
+                                            Ublock_info, &arena, stat);
+                        }
+
+                        psgstrs2_timer += SuperLU_timer_()-ttt2;
+                        superlu_trace_event(stat, TRACE_PANEL_U, kk, ttt2);
+                        /* stat->time8 += SuperLU_timer_()-ttt2; */
+
+                        /* Multicasts U(kk,:) to process columns. */
+                        lk = LBi (kk, grid);
+                        usub = Ufstnz_br_ptr[lk];
+                        uval = Unzval_br_ptr[lk];
+                        if (usub) {
+                            msgcnt[2] = usub[2]; /* metadata size */
+                            msgcnt[3] = usub[1]; /* Uval[] size */
+                        } else {
+                            msgcnt[2] = msgcnt[3] = 0;
+                        }
+
+                        if ( use_rma ) panel_rma_ready(&Urma, myrow, lk);
+                        usub_msg = uindex_fold(usub, kk, xsup, Ufold ?
+                                               &Ufold[look_id * ldfold] : NULL, &msgcnt[2]);
+                        imsg = index_msg(usub_msg, msgcnt[2], Upack, look_id, &icnt, &itype);
+                        if (!use_rma && ToSendD[lk] == YES) {
+                            for (pi = 0; pi < Pr; ++pi) {
+                                if (pi != myrow) {
+#if ( PROFlevel>=1 )
+                                    TIC (t1);
+#endif
+
+                                    t_trace = TRACE_TIME(stat);
+                                    MPI_Isend (imsg, icnt, itype, pi,
+                                               SLU_MPI_TAG (2, kk0), /* (4*kk0+2)%tag_ub */
+                                               PANEL_COMM (scp, kk0), &send_reqs_u[look_id][pi]);
+                                    MPI_Isend (uval, msgcnt[3], MPI_FLOAT,
+                                               pi, SLU_MPI_TAG (3, kk0), /* (4*kk0+3)%tag_ub */
+                                               PANEL_COMM (scp, kk0), &send_reqs_u[look_id][pi + Pr]);
+                                    superlu_trace_event(stat, TRACE_SEND_U, kk, t_trace);
+                                    stat->fact_sent += (double) msgcnt[2] * iword + msgcnt[3] * dword;
+
+#if ( PROFlevel>=1 )
+                                    TOC (t2, t1);
+                                    stat->utime[COMM] += t2;
+                                    msg_cnt += 2;
+                                    msg_vol += msgcnt[2] * iword + msgcnt[3] * dword;
+#endif
+#if ( DEBUGlevel>=2 )
+                                    printf ("[%d] Send U(%4d,:) to Pr %2d\n",
+                                            iam, k, pi);
+#endif
+                                }   /* if pi ... */
+                            }   /* for pi ... */
+                        }       /* if ToSendD ... */
+
+                        /* stat->time2 += SuperLU_timer_()-tt1; */
+                        superlu_sncost_charge(stat, SNCOST_PANEL, kk);
+
+                    } /* end if myrow == krow */
+                } /* end if flag0 & flag1 ... */
+            } /* end if factoredU[] ... */
+        } /* end for kk0 ... */
+
+        /* ============================================== *
+         * == start processing the current row of U(k,:) *
+         * ============================================== */
+        knsupc = SuperSize (k);
+        krow = PROW (k, grid);
+        kcol = PCOL (k, grid);
+
+        /* tt1 = SuperLU_timer_(); */
+        look_id = k0 % (1 + num_look_aheads);
+        recv_req = recv_reqs[look_id];
+        send_req = send_reqs[look_id];
+        msgcnt = msgcnts[look_id];
+        Usub_buf = Llu->Usub_buf_2[look_id];
+        Uval_buf = Llu->Uval_buf_2[look_id];
+
+        if (mycol == kcol) {
+            lk = LBj (k, grid); /* Local block number in L */
+
+#if ( PROFlevel>=1 )
+	    TIC(t1);
+#endif
+            t_trace = TRACE_TIME(stat);
+            for (pj = 0; pj < Pc; ++pj) {
+                /* Wait for Isend to complete before using lsub/lusup buffer. */
+                if (!use_rma && ToSendR[lk][pj] != EMPTY) {
+                    MPI_Wait (&send_req[pj], &status);
+                    MPI_Wait (&send_req[pj + Pc], &status);
+                }
+            }
+#if ( PROFlevel>=1 )
+	    TOC(t2, t1);
+	    stat->utime[COMM] += t2;
+	    stat->utime[COMM_RIGHT] += t2;
+#endif
+            superlu_trace_event(stat, TRACE_WAIT_L, k, t_trace);
+            lsub = Lrowind_bc_ptr[lk];
+            lusup = Lnzval_bc_ptr[lk];
+        } else {
+            if (ToRecv[k] >= 1) { /* Recv block column L(:,k). */
+
+                scp = &grid->rscp;  /* The scope of process row. */
+
+                /* ============================================= *
+                 * Waiting for L(:,kk) for outer-product uptate  *
+                 * if iam in U(kk,:), then the diagonal block    *
+                 * did not reach in time for panel factorization *
+                 * of U(k,:).          	                         *
+                 * ============================================= */
+#if ( PROFlevel>=1 )
+                TIC (t1);
+#endif
+                t_trace = SuperLU_timer_();
+                if ( use_rma && rma_inL[look_id] != k0 ) {
+                    /* not pulled in the look-ahead, counts as below */
+                    panel_rma_get(&Lrma, kcol, LBj (k, grid), 1,
+                                  Lsub_buf_2[look_id], Lval_buf_2[look_id],
+                                  msgcntsU[look_id]);
+                    rma_inL[look_id] = k0;
+                }
+                if (recv_req[0] != MPI_REQUEST_NULL) {
+                    MPI_Wait (&recv_req[0], &status);
+                    msgcnt[0] = index_recv_count(&status, Lsub_buf_2[look_id],
+                                                 Lpack, look_id);
+                    recv_req[0] = MPI_REQUEST_NULL;
+                } else {
+                    msgcnt[0] = msgcntsU[look_id][0];
+#if (DEBUGlevel>=2)
+		    printf("\t[%d] k=%d, look_id=%d, recv_req[0] == MPI_REQUEST_NULL, msgcnt[0] = %d\n",
+			   iam, k, look_id, msgcnt[0]);
+#endif
+                }
+
+                if (recv_req[1] != MPI_REQUEST_NULL) {
+                    MPI_Wait (&recv_req[1], &status);
+                    MPI_Get_count (&status, MPI_FLOAT, &msgcnt[1]);
+                    recv_req[1] = MPI_REQUEST_NULL;
+                } else {
+                    msgcnt[1] = msgcntsU[look_id][1];
+#if (DEBUGlevel>=2)
+		    printf("\t[%d] k=%d, look_id=%d, recv_req[1] == MPI_REQUEST_NULL, msgcnt[1] = %d\n",
+			   iam, k, look_id, msgcnt[1]);
+#endif
+                }
+
+#if ( PROFlevel>=1 )
+                TOC (t2, t1);
+                stat->utime[COMM] += t2;
+                stat->utime[COMM_RIGHT] += t2;
+#endif
+                stat->fact_wait += SuperLU_timer_() - t_trace;
+                stat->fact_recv += (double) msgcnt[0] * iword + msgcnt[1] * dword;
+                superlu_trace_event(stat, TRACE_WAIT_L, k, t_trace);
+#if ( DEBUGlevel>=2 )
+                printf("[%d] Recv L(:,%4d): #lsub %4d, #lusup %4d from Pc %2d\n",
+                     iam, k, msgcnt[0], msgcnt[1], kcol);
+                fflush (stdout);
+#endif
+
+#if ( PRNTlevel==3 )
+                ++total_msg;
+                if (!msgcnt[0])  ++zero_msg;
+#endif
+            } else {
+                msgcnt[0] = 0;
+	    }
+
+            lsub = Lsub_buf_2[look_id];
+            lusup = Lval_buf_2[look_id];
+        }  /* else if mycol = Pc(k) */
+        /* stat->time1 += SuperLU_timer_()-tt1; */
+
+        scp = &grid->cscp;      /* The scope of process column. */
+
+        /* tt1 = SuperLU_timer_(); */
+        if (myrow == krow) { /* I own U(k,:) */
+            lk = LBi (k, grid);
+            usub = Ufstnz_br_ptr[lk];
+            uval = Unzval_br_ptr[lk];
+
+            if (factoredU[k0] == -1) {
+                /* Parallel triangular solve across process row *krow* --
+                   U(k,j) = L(k,k) \ A(k,j).  */
+                 double ttt2 = SuperLU_timer_();
+#ifdef _OPENMP
+/* #pragma omp parallel */ /* Sherry -- parallel done inside psgstrs2 */
+#endif
+                {
+                    if ( !SN_CLEAN(k) )
+                        psgstrs2_omp (k0, k, Glu_persist, grid, Llu,
+                                    Ublock_info, &arena, stat);
+                }
+                psgstrs2_timer += SuperLU_timer_() - ttt2;
+                superlu_trace_event(stat, TRACE_PANEL_U, k, ttt2);
+
+	        /* Sherry -- need to set factoredU[k0] = 1; ?? */
+
+                /* Multicasts U(k,:) along process columns. */
+                if ( usub ) {
+                    msgcnt[2] = usub[2]; /* metadata size */
+                    msgcnt[3] = usub[1]; /* Uval[] size */
+                } else {
+                    msgcnt[2] = msgcnt[3] = 0;
+                }
+
+                if ( use_rma ) panel_rma_ready(&Urma, myrow, lk);
+                usub_msg = uindex_fold(usub, k, xsup, Ufold ?
+                                       &Ufold[look_id * ldfold] : NULL, &msgcnt[2]);
+                imsg = index_msg(usub_msg, msgcnt[2], Upack, look_id, &icnt, &itype);
+                if (!use_rma && ToSendD[lk] == YES) {
+                    for (pi = 0; pi < Pr; ++pi) {
+                        if (pi != myrow) { /* Matching recv was pre-posted before */
+#if ( PROFlevel>=1 )
+                            TIC (t1);
+#endif
+                            t_trace = TRACE_TIME(stat);
+                            MPI_Send (imsg, icnt, itype, pi,
+                                      SLU_MPI_TAG (2, k0), /* (4*k0+2)%tag_ub */
+                                      PANEL_COMM (scp, k0));
+                            MPI_Send (uval, msgcnt[3], MPI_FLOAT, pi,
+                                      SLU_MPI_TAG (3, k0), /* (4*k0+3)%tag_ub */
+                                      PANEL_COMM (scp, k0));
+                            superlu_trace_event(stat, TRACE_SEND_U, k, t_trace);
+                            stat->fact_sent += (double) msgcnt[2] * iword + msgcnt[3] * dword;
+#if ( PROFlevel>=1 )
+                            TOC (t2, t1);
+                            stat->utime[COMM] += t2;
+                            stat->utime[COMM_DOWN] += t2;
+                            msg_cnt += 2;
+                            msg_vol += msgcnt[2] * iword + msgcnt[3] * dword;
+#endif
+#if ( DEBUGlevel>=2 )
+                            printf ("[%d] Send U(%4d,:) down to Pr %2d\n", iam, k, pi);
+#endif
+                        } /* if pi ... */
+                    } /* for pi ... */
+                } /* if ToSendD ... */
+                superlu_sncost_charge(stat, SNCOST_PANEL, k);
+
+            } else { /* Panel U(k,:) already factorized from previous look-ahead */
+
+               /* ================================================ *
+                * Wait for downward sending of U(k,:) to complete  *
+		* for outer-product update.                        *
+                * ================================================ */
+
+                if (!use_rma && ToSendD[lk] == YES) {
+#if ( PROFlevel>=1 )
+		    TIC (t1);
+#endif
+                    t_trace = TRACE_TIME(stat);
+                    for (pi = 0; pi < Pr; ++pi) {
+                        if (pi != myrow) {
+                            MPI_Wait (&send_reqs_u[look_id][pi], &status);
+                            MPI_Wait (&send_reqs_u[look_id][pi + Pr], &status);
+                        }
+                    }
+#if ( PROFlevel>=1 )
+		    TOC (t2, t1);
+		    stat->utime[COMM] += t2;
+		    stat->utime[COMM_DOWN] += t2;
+#endif
+                    superlu_trace_event(stat, TRACE_WAIT_U, k, t_trace);
+                }
+                msgcnt[2] = msgcntsU[look_id][2];
+                msgcnt[3] = msgcntsU[look_id][3];
+            }
+            /* stat->time2 += SuperLU_timer_()-tt1; */
+
+        } else {    /* myrow != krow */
+
+            /* ========================================== *
+             * Wait for U(k,:) for outer-product updates. *
+             * ========================================== */
+
+            if (ToRecv[k] == 2) { /* Recv block row U(k,:). */
+#if ( PROFlevel>=1 )
+                TIC (t1);
+#endif
+                t_trace = SuperLU_timer_();
+                if ( use_rma ) {
+                    panel_rma_get(&Urma, krow, LBi (k, grid), 1,
+                                  Usub_buf, Uval_buf, &msgcnt[2]);
+                } else {
+                    MPI_Wait (&recv_reqs_u[look_id][0], &status);
+                    msgcnt[2] = index_recv_count(&status, Usub_buf, Upack, look_id);
+                    if ( Ufold )
+                        uindex_unfold(Usub_buf, msgcnt[2], k, xsup,
+                                      &Ufold[(1 + num_look_aheads) * ldfold]);
+                    MPI_Wait (&recv_reqs_u[look_id][1], &status);
+                    MPI_Get_count (&status, MPI_FLOAT, &msgcnt[3]);
+                }
+
+#if ( PROFlevel>=1 )
+                TOC (t2, t1);
+                stat->utime[COMM] += t2;
+                stat->utime[COMM_DOWN] += t2;
+#endif
+                stat->fact_wait += SuperLU_timer_() - t_trace;
+                stat->fact_recv += (double) msgcnt[2] * iword + msgcnt[3] * dword;
+                superlu_trace_event(stat, TRACE_WAIT_U, k, t_trace);
+                usub = Usub_buf;
+                uval = Uval_buf;
+#if ( DEBUGlevel>=2 )
+                printf ("[%d] Recv U(%4d,:) from Pr %2d\n", iam, k, krow);
+#endif
+#if ( PRNTlevel==3 )
+                ++total_msg;
+                if (!msgcnt[2])  ++zero_msg;
+#endif
+            } else {
+                msgcnt[2] = 0;
+	    }
+            /* stat->time6 += SuperLU_timer_()-tt1; */
+        } /* end if myrow == Pr(k) */
+
+        /*
+         * Parallel rank-k update; pair up blocks L(i,k) and U(k,j).
+         *  for (j = k+1; k < N; ++k) {
+         *     for (i = k+1; i < N; ++i)
+         *         if ( myrow == PROW( i, grid ) && mycol == PCOL( j, grid )
+         *              && L(i,k) != 0 && U(k,j) != 0 )
+         *             A(i,j) = A(i,j) - L(i,k) * U(k,j);
+         */
+        msg0 = msgcnt[0];
+        msg2 = msgcnt[2];
+        /* tt1 = SuperLU_timer_(); */
+        if (msg0 && msg2) {     /* L(:,k) and U(k,:) are not empty. */
+            nsupr = lsub[1];    /* LDA of lusup. */
+            if (myrow == krow) { /* Skip diagonal block L(k,k). */
+                lptr0 = BC_HEADER + LB_DESCRIPTOR + lsub[BC_HEADER + 1];
+                luptr0 = knsupc;
+                nlb = lsub[0] - 1;
+            } else {
+                lptr0 = BC_HEADER;
+                luptr0 = 0;
+                nlb = lsub[0];
+            }
+            iukp = BR_HEADER;   /* Skip header; Pointer to index[] of U(k,:) */
+            rukp = 0;           /* Pointer to nzval[] of U(k,:) */
+            nub = usub[0];      /* Number of blocks in the block row U(k,:) */
+            klst = FstBlockC (k + 1);
+
+            /* -------------------------------------------------------------
+               Update the look-ahead block columns A(:,k+1:k+num_look_ahead)
+               ------------------------------------------------------------- */
+            iukp0 = iukp;
+            rukp0 = rukp;
+            /* reorder the remaining columns in bottome-up */
+            /* TAU_STATIC_TIMER_START("LOOK_AHEAD_UPDATE"); */
+            for (jj = 0; jj < nub; jj++) {
+#ifdef ISORT
+                iperm_u[jj] = iperm_c_supno[usub[iukp]];    /* Global block number of block U(k,j). */
+                perm_u[jj] = jj;
+#else
+                perm_u[2 * jj] = iperm_c_supno[usub[iukp]]; /* Global block number of block U(k,j). */
+                perm_u[2 * jj + 1] = jj;
+#endif
+                jb = usub[iukp];    /* Global block number of block U(k,j). */
+                nsupc = SuperSize (jb);
+                iukp += UB_DESCRIPTOR;  /* Start fstnz of block U(k,j). */
+                iukp += nsupc;
+            }
+            iukp = iukp0;
+#ifdef ISORT
+            /* iperm_u is sorted based on elimination order;
+               perm_u reorders the U blocks to match the elimination order. */
+            isort (nub, iperm_u, perm_u);
+#else
+            superlu_sort_pairs (nub, perm_u);
+#endif
+
+/************************************************************************/
+            double ttx = SuperLU_timer_();
+
+//#include "dlook_ahead_update_v4.c"
+#include "slook_ahead_update.c"
+
+            lookaheadupdatetimer += SuperLU_timer_() - ttx;
+            superlu_sncost_charge(stat, SNCOST_SCHUR, k);
+            superlu_trace_event(stat, TRACE_LOOKAHEAD, k, ttx);
+/************************************************************************/
+
+            /*ifdef OMP_LOOK_AHEAD */
+            /* TAU_STATIC_TIMER_STOP("LOOK_AHEAD_UPDATE"); */
+        }                       /* if L(:,k) and U(k,:) not empty */
+
+        /* stat->time3 += SuperLU_timer_()-tt1; */
+
+        /* ================== */
+        /* == post receive == */
+        /* ================== */
+        kk1 = SUPERLU_MIN (k0 + num_look_aheads, nfact - 1);
+        for (kk0 = k0 + 1; kk0 <= kk1; kk0++) {
+            kk = perm_c_supno[kk0];
+            kcol = PCOL (kk, grid);
+
+            if (look_ahead[kk] == k0) {
+                if (mycol != kcol) {
+                    if (!use_rma && ToRecv[kk] >= 1) {
+                        scp = &grid->rscp;  /* The scope of process row. */
+
+                        look_id = kk0 % (1 + num_look_aheads);
+                        recv_req = recv_reqs[look_id];
+#if ( PROFlevel>=1 )
+			TIC (t1);
+#endif
+                        ibuf = index_recv_buf(Lsub_buf_2[look_id], Llu->bufmax[0],
+                                              Lpack, look_id, &icnt, &itype);
+                        MPI_Irecv (ibuf, icnt,
+                                   itype, kcol, SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
+                                   PANEL_COMM (scp, kk0), &recv_req[0]);
+                        MPI_Irecv (Lval_buf_2[look_id], Llu->bufmax[1],
+                                   MPI_FLOAT, kcol,
+                                   SLU_MPI_TAG (1, kk0), /* (4*kk0+1)%tag_ub */
+                                   PANEL_COMM (scp, kk0), &recv_req[1]);
+#if ( PROFlevel>=1 )
+			TOC (t2, t1);
+			stat->utime[COMM] += t2;
+			stat->utime[COMM_RIGHT] += t2;
+#endif
+                    }
+                } else {
+                    lk = LBj (kk, grid);    /* Local block number. */
+                    lsub1 = Lrowind_bc_ptr[lk];
+                    lusup1 = Lnzval_bc_ptr[lk];
+                    if (factored[kk] == -1) {
+                        /* Factor diagonal and subdiagonal blocks and
+			   test for exact singularity.  */
+                        factored[kk] = 0; /* flag column kk as factored */
+                        double ttt1 = SuperLU_timer_();
+                        if ( !SN_CLEAN(kk) )
+                            PSGSTRF2 (options, kk0, kk, thresh,
+                                      Glu_persist, grid, Llu, U_diag_blk_send_req,
+                                      tag_ub, stat, info);
+                        psgstrf2_timer += SuperLU_timer_() - ttt1;
+                        superlu_trace_event(stat, TRACE_PANEL_L, kk, ttt1);
+
+                        /* Process column *kcol+1* multicasts numeric
+			   values of L(:,k+1) to process rows. */
+                        look_id = kk0 % (1 + num_look_aheads);
+                        send_req = send_reqs[look_id];
+                        msgcnt = msgcnts[look_id];
+
+                        if (lsub1) {
+                            msgcnt[0] = lsub1[1] + BC_HEADER + lsub1[0] * LB_DESCRIPTOR;
+                            msgcnt[1] = lsub1[1] * SuperSize (kk);
+                        } else {
+                            msgcnt[0] = 0;
+                            msgcnt[1] = 0;
+                        }
+
+                        scp = &grid->rscp;  /* The scope of process row. */
+                        if ( use_rma ) panel_rma_ready(&Lrma, mycol, lk);
+                        imsg = index_msg(lsub1, msgcnt[0], Lpack, look_id, &icnt, &itype);
+                        for (pj = 0; pj < Pc; ++pj) {
+                            if (!use_rma && ToSendR[lk][pj] != EMPTY) {
+#if ( PROFlevel>=1 )
+			       TIC (t1);
+#endif
+                                t_trace = TRACE_TIME(stat);
+                                if ( sync_comm ) { /* see SLU_COMM_SYNC */
+                                    MPI_Send (imsg, icnt, itype, pj,
+                                              SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
+                                              PANEL_COMM (scp, kk0));
+                                    MPI_Send (lusup1, msgcnt[1], MPI_FLOAT, pj,
+                                              SLU_MPI_TAG (1, kk0), /* (4*kk0+1)%tag_ub */
+                                              PANEL_COMM (scp, kk0));
+                                } else {
+                                    MPI_Isend (imsg, icnt, itype, pj,
+                                               SLU_MPI_TAG (0, kk0), /* (4*kk0)%tag_ub */
+                                               PANEL_COMM (scp, kk0), &send_req[pj]);
+                                    MPI_Isend (lusup1, msgcnt[1], MPI_FLOAT, pj,
+                                               SLU_MPI_TAG (1, kk0), /* (4*kk0+1)%tag_ub */
+                                               PANEL_COMM (scp, kk0), &send_req[pj + Pc]);
+                                }
+                                superlu_trace_event(stat, TRACE_SEND_L, kk, t_trace);
+                                stat->fact_sent += (double) msgcnt[0] * iword + msgcnt[1] * dword;
+#if ( PROFlevel>=1 )
+				TOC (t2, t1);
+				stat->utime[COMM] += t2;
+				stat->utime[COMM_RIGHT] += t2;
+				++prof_sendR[lk];
+#endif
+                            }
+                        } /* end for pj ... */
+                        superlu_sncost_charge(stat, SNCOST_PANEL, kk);
+                    } /* if    factored[kk] ... */
+                }
+            }
+        }
+
+        if ( options->Fact_Comm == SLU_COMM_IRECV
+             || options->Fact_Comm == SLU_COMM_THREADS )
+            progress_lookahead_recvs(k0, nfact, num_look_aheads,
+                                     recv_reqs, recv_reqs_u);
+
+        double tsch = SuperLU_timer_();
+        SUPERLU_PROF_BEGIN(PROF_SCHUR, k);
+
+	/*******************************************************************/
+
+#ifdef GPU_ACC /*-- GPU --*/
+
+#include "sSchCompUdt-cuda.c"
+
+#else
+
+/*#include "SchCompUdt--Phi-2Ddynamic-alt.c"*/
+//#include "sSchCompUdt-2Ddynamic_v6.c"
+
+#include "sSchCompUdt-2Ddynamic.c"
+
+#endif
+	/*uncomment following to compare against SuperLU 3.3 baseline*/
+        /* #include "SchCompUdt--baseline.c"  */
+	/************************************************************************/
+
+        NetSchurUpTimer += SuperLU_timer_() - tsch;
+        superlu_sncost_charge(stat, SNCOST_SCHUR, k);
+        SUPERLU_PROF_END(PROF_SCHUR, k);
+
+        if ( options->Fact_Comm == SLU_COMM_IRECV
+             || options->Fact_Comm == SLU_COMM_THREADS )
+            progress_lookahead_recvs(k0, nfact, num_look_aheads,
+                                     recv_reqs, recv_reqs_u);
+
+        if ( ooc_done ) {
+            if ( mycol == PCOL( k, grid ) )
+                sooc_retire(&Llu->Lnzval_ooc, Lnzval_bc_ptr, mcb, ooc_done,
+                             &ooc_next[0], LBj( k, grid ));
+            if ( myrow == PROW( k, grid ) )
+                sooc_retire(&Llu->Unzval_ooc, Unzval_br_ptr, mrb,
+                             ooc_done + mcb, &ooc_next[1], LBi( k, grid ));
+        }
+
+        SUPERLU_PROF_END(PROF_STEP, k);
+    }  /* MAIN LOOP for k0 = 0, ... */
+
+    /* ##################################################################
+       ** END MAIN LOOP: for k0 = ...
+       ################################################################## */
+
+    if ( use_rma ) {
+        panel_rma_finalize(&Lrma);
+        panel_rma_finalize(&Urma);
+    }
+#ifdef _OPENMP
+    if ( slot_comm ) {
+        for (i = 0; i < 2 * (1 + num_look_aheads); ++i)
+            MPI_Comm_free(&slot_comm[i]);
+        SUPERLU_FREE(slot_comm);
+        omp_destroy_lock(&poll_lock);
+    }
+#endif
+
+    if ( nfact < nsupers && options->SchurSize == 0 )
+        psgstrf_root(options, nfact, n, thresh, Glu_persist, grid, Llu,
+                     stat, info);
+    /* The dense root, if any, is charged to the last supernode. */
+    superlu_sncost_charge(stat, SNCOST_SCHUR, nsupers - 1);
+    superlu_sncost_finish(stat, xsup, grid, &Llu->sn_cost);
+
+    if ( ooc_done ) { /* the rest of the factors, the root among them */
+        superlu_ooc_retire(&Llu->Lnzval_ooc, NULL);
+        superlu_ooc_retire(&Llu->Unzval_ooc, NULL);
+        SUPERLU_FREE(ooc_done);
+    }
+
+    pxgstrfTimer = SuperLU_timer_() - pxgstrfTimer;
+    superlu_hwc_end(stat, HWC_FACT);
+    SUPERLU_PROF_END(PROF_FACT, EMPTY);
+    superlu_progress_stop(progress);
+    superlu_blas_restore_threads(blas_threads);
+    superlu_trace_finalize(grid, stat);
+
+#if ( PRNTlevel>=2 )
+    /* Print detailed statistics */
+    /* Updating total flops */
+    float allflops;
+    MPI_Reduce(&RemainGEMM_flops, &allflops, 1, MPI_FLOAT, MPI_SUM,
+	       0, grid->comm);
+    if ( iam==0 ) {
+	printf("\nInitialization time\t%8.2lf seconds\n"
+	       "\t Serial: compute static schedule, allocate storage\n", InitTimer);
+        printf("\n==== Time breakdown in factorization (rank 0) ====\n");
+	printf("Panel factorization \t %8.2lf seconds\n",
+	       psgstrf2_timer + psgstrs2_timer);
+	printf(".. L-panel pxgstrf2 \t %8.2lf seconds\n", psgstrf2_timer);
+	printf(".. U-panel pxgstrs2 \t %8.2lf seconds\n", psgstrs2_timer);
+	printf("Time in Look-ahead update \t %8.2lf seconds\n", lookaheadupdatetimer);
+        printf("Time in Schur update \t\t %8.2lf seconds\n", NetSchurUpTimer);
+        printf(".. Time to Gather L buffer\t %8.2lf  (Separate L panel by Lookahead/Remain)\n", GatherLTimer);
+        printf(".. Time to Gather U buffer\t %8.2lf \n", GatherUTimer);
+
+        printf(".. Time in GEMM %8.2lf \n",
+	       LookAheadGEMMTimer + RemainGEMMTimer);
+        printf("\t* Look-ahead\t %8.2lf \n", LookAheadGEMMTimer);
+        printf("\t* Remain\t %8.2lf\tFlops %8.2le\tGflops %8.2lf\n",
+	       RemainGEMMTimer, allflops, allflops/RemainGEMMTimer*1e-9);
+        printf(".. Time to Scatter %8.2lf \n",
+	       LookAheadScatterTimer + RemainScatterTimer);
+        printf("\t* Look-ahead\t %8.2lf \n", LookAheadScatterTimer);
+        printf("\t* Remain\t %8.2lf \n", RemainScatterTimer);
+
+        printf("Total factorization time            \t: %8.2lf seconds, \n", pxgstrfTimer);
+        printf("--------\n");
+	printf("GEMM maximum block: %d-%d-%d\n", gemm_max_m, gemm_max_k, gemm_max_n);
+    }
+#endif
+
+#if ( DEBUGlevel>=3 )
+    for (i = 0; i < Pr * Pc; ++i) {
+        if (iam == i) {
+            sPrintLblocks(iam, nsupers, grid, Glu_persist, Llu);
+            sPrintUblocks(iam, nsupers, grid, Glu_persist, Llu);
+            printf ("(%d)\n", iam);
+            PrintInt10 ("Recv", nsupers, Llu->ToRecv);
+        }
+        MPI_Barrier (grid->comm);
+    }
+#endif
+
+    /********************************************************
+     * Free memory                                          *
+     ********************************************************/
+
+    if (Pr * Pc > 1) {
+        superlu_free_comm (Lsub_buf_2[0]);   /* also free Lsub_buf_2[1] */
+        superlu_free_comm (Lval_buf_2[0]);   /* also free Lval_buf_2[1] */
+        if (Llu->bufmax[2] != 0)
+            superlu_free_comm (Usub_buf_2[0]);
+        if (Llu->bufmax[3] != 0)
+            superlu_free_comm (Uval_buf_2[0]);
+        if (U_diag_blk_send_req[myrow] != MPI_REQUEST_NULL) {
+            /* wait for last Isend requests to complete, deallocate objects */
+            for (krow = 0; krow < Pr; ++krow) {
+                if (krow != myrow)
+                    MPI_Wait (U_diag_blk_send_req + krow, &status);
+            }
+        }
+        SUPERLU_FREE (U_diag_blk_send_req);
+    }
+
+    log_memory( -((Llu->bufmax[0] + Llu->bufmax[2]) * (num_look_aheads + 1) * iword +
+		  (Llu->bufmax[1] + Llu->bufmax[3]) * (num_look_aheads + 1) * dword),
+		stat );
+
+    SUPERLU_FREE (Lsub_buf_2);
+    SUPERLU_FREE (Lval_buf_2);
+    SUPERLU_FREE (Usub_buf_2);
+    SUPERLU_FREE (Uval_buf_2);
+    SUPERLU_FREE (perm_c_supno);
+    SUPERLU_FREE (perm_u);
+#ifdef ISORT
+    SUPERLU_FREE (iperm_u);
+#endif
+    SUPERLU_FREE (look_ahead);
+    SUPERLU_FREE (factoredU);
+    SUPERLU_FREE (factored);
+    log_memory(-(6 * nsupers * iword), stat);
+
+    for (i = 0; i <= num_look_aheads; i++) {
+        SUPERLU_FREE (msgcnts[i]);
+        SUPERLU_FREE (msgcntsU[i]);
+    }
+    SUPERLU_FREE (msgcnts);
+    SUPERLU_FREE (msgcntsU);
+
+    for (i = 0; i <= num_look_aheads; i++) {
+        SUPERLU_FREE (send_reqs_u[i]);
+        SUPERLU_FREE (recv_reqs_u[i]);
+        SUPERLU_FREE (send_reqs[i]);
+        SUPERLU_FREE (recv_reqs[i]);
+    }
+
+    if ( Lpack ) index_pack_free(Lpack);
+    if ( Upack ) index_pack_free(Upack);
+    if ( Ufold ) SUPERLU_FREE (Ufold);
+
+    SUPERLU_FREE (recv_reqs_u);
+    SUPERLU_FREE (send_reqs_u);
+    SUPERLU_FREE (recv_reqs);
+    SUPERLU_FREE (send_reqs);
+
+#ifdef GPU_ACC
+    checkCuda (cudaFreeHost (bigV));
+    checkCuda (cudaFreeHost (bigU));
+    cudaFree( (void*)dA ); /* Sherry added */
+    cudaFree( (void*)dB );
+    cudaFree( (void*)dC );
+    SUPERLU_FREE( handle );
+    SUPERLU_FREE( streams );
+    SUPERLU_FREE( stream_end_col );
+#else
+    /* bigU and bigV are freed with the arena. */
+#endif
+
+    SUPERLU_FREE (Llu->ujrow);
+    // SUPERLU_FREE (tempv2d);/* Sherry */
+
+    /* Sherry added */
+    SUPERLU_FREE(omp_loop_time);
+    SUPERLU_FREE(full_u_cols);
+    SUPERLU_FREE(blk_ldu);
+#if ( PRNTlevel>=1 )
+    log_memory(-2 * ncb * dword, stat);
+#endif
+
+#if ( PRNTlevel>=1 )
+    printf("[%d].. factorization arena: %.2f MB reserved, %.2f MB peak\n",
+	   iam, arena.size * 1e-6, arena.peak * 1e-6);
+#endif
+    log_memory(-(int64_t) arena.size, stat);
+    superlu_arena_destroy(&arena);
+
+
+#if ( PROFlevel>=1 )
+    TIC (t1);
+#endif
+
+    /* Prepare error message - find the smallesr index i that U(i,i)==0 */
+    if ( *info == 0 ) *info = n + 1;
+    MPI_Allreduce (info, &iinfo, 1, MPI_INT, MPI_MIN, grid->comm);
+    if ( iinfo == n + 1 ) *info = 0;
+    else *info = iinfo;
+
+    /* Size of the local factors, and the balance over the grid. */
+    if ( options->PrintStat == YES ) {
+        int_t *index, gb;
+        stat->fact_size = 0.;
+        for (lk = 0; lk < CEILING( nsupers, Pc ); ++lk) {
+            gb = lk * Pc + mycol;
+            if ( gb < nsupers && (index = Lrowind_bc_ptr[lk]) )
+                stat->fact_size += (double)
+                    (BC_HEADER + index[0] * LB_DESCRIPTOR + index[1]) * iword
+                    + (double) index[1] * SuperSize( gb ) * dword;
+        }
+        for (lk = 0; lk < CEILING( nsupers, Pr ); ++lk) {
+            gb = lk * Pr + myrow;
+            if ( gb < nsupers && (index = Ufstnz_br_ptr[lk]) )
+                stat->fact_size += (double) index[2] * iword
+                                   + (double) index[1] * dword;
+        }
+        PStatImbalance(stat, grid);
+    }
+
+#if ( PROFlevel>=1 )
+    TOC (t2, t1);
+    stat->utime[COMM] += t2;
+    {
+        float msg_vol_max, msg_vol_sum, msg_cnt_max, msg_cnt_sum;
+
+        MPI_Reduce (&msg_cnt, &msg_cnt_sum,
+                    1, MPI_FLOAT, MPI_SUM, 0, grid->comm);
+        MPI_Reduce (&msg_cnt, &msg_cnt_max,
+                    1, MPI_FLOAT, MPI_MAX, 0, grid->comm);
+        MPI_Reduce (&msg_vol, &msg_vol_sum,
+                    1, MPI_FLOAT, MPI_SUM, 0, grid->comm);
+        MPI_Reduce (&msg_vol, &msg_vol_max,
+                    1, MPI_FLOAT, MPI_MAX, 0, grid->comm);
+        if ( iam==0 ) {
+            printf ("\tPDGSTRF comm stat:"
+                    "\tAvg\tMax\t\tAvg\tMax\n"
+                    "\t\t\tCount:\t%.0f\t%.0f\tVol(MB)\t%.2f\t%.2f\n",
+                    msg_cnt_sum / Pr / Pc, msg_cnt_max,
+                    msg_vol_sum / Pr / Pc * 1e-6, msg_vol_max * 1e-6);
+	    printf("\t\tcomm time on task 0: %8.2lf\n"
+		   "\t\t\tcomm down DIAG block %8.2lf\n"
+		   "\t\t\tcomm right L panel %8.2lf\n"
+		   "\t\t\tcomm down U panel %8.2lf\n",
+		   stat->utime[COMM], stat->utime[COMM_DIAG],
+		   stat->utime[COMM_RIGHT], stat->utime[COMM_DOWN]);
+	    //#include <float.h>
+	    //int Digs = DECIMAL_DIG;
+	    printf("gemm_count %d\n", gemm_count);
+	    for (i = 0; i < gemm_count; ++i)
+		fprintf(fgemm, "%8d%8d%8d\t %20.16e\t%8d\n", gemm_stats[i].m, gemm_stats[i].n,
+			gemm_stats[i].k, gemm_stats[i].microseconds, prof_sendR[i]);
+
+	    fclose(fgemm);
+        }
+	SUPERLU_FREE(gemm_stats);
+	SUPERLU_FREE(prof_sendR);
+    }
+#endif
+
+#if ( PRNTlevel==3 )
+    MPI_Allreduce (&zero_msg, &iinfo, 1, MPI_INT, MPI_SUM, grid->comm);
+    if (!iam)
+        printf (".. # msg of zero size\t%d\n", iinfo);
+    MPI_Allreduce (&total_msg, &iinfo, 1, MPI_INT, MPI_SUM, grid->comm);
+    if (!iam)
+        printf (".. # total msg\t%d\n", iinfo);
+#endif
+
+#if ( DEBUGlevel>=3 )
+    for (i = 0; i < Pr * Pc; ++i) {
+        if (iam == i) {
+            sPrintLblocks (iam, nsupers, grid, Glu_persist, Llu);
+            sPrintUblocks (iam, nsupers, grid, Glu_persist, Llu);
+            printf ("(%d)\n", iam);
+            PrintInt10 ("Recv", nsupers, Llu->ToRecv);
+        }
+        MPI_Barrier (grid->comm);
+    }
+#endif
+
+#if ( DEBUGlevel>=3 )
+    printf ("(%d) num_copy=%d, num_update=%d\n", iam, num_copy, num_update);
+#endif
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC (iam, "Exit psgstrf()");
+#endif
+
+    return 0;
+} /* PSGSTRF */
+
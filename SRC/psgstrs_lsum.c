@@ -0,0 +1,3000 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Perform local block modifications: lsum[i] -= L_i,k * X[k]
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.1) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * March 15, 2003
+ *
+ * Modified:
+ *     Feburary 7, 2001    use MPI_Isend/MPI_Irecv
+ *     October 2, 2001     use MPI_Isend/MPI_Irecv with MPI_Test
+ * February 8, 2019  version 6.1.1
+ * </pre>
+ */
+
+#include "superlu_sdefs.h"
+#include "superlu_defs.h"
+
+#ifndef CACHELINE
+#define CACHELINE 64  /* bytes, Xeon Phi KNL, Cori haswell, Edision */
+#endif
+
+#define ISEND_IRECV
+
+/* Apply the U blocks with GEMM when there are at least this many RHS */
+#ifndef BMOD_GEMM_NRHS
+#define BMOD_GEMM_NRHS 4
+#endif
+
+/*
+ * Function prototypes
+ */
+#ifdef _CRAY
+fortran void STRSM(_fcd, _fcd, _fcd, _fcd, int*, int*, float*,
+		   float*, int*, float*, int*);
+fortran void SGEMM(_fcd, _fcd, int*, int*, int*, float*, float*,
+		   int*, float*, int*, float*, float*, int*);
+_fcd ftcs1;
+_fcd ftcs2;
+_fcd ftcs3;
+#endif
+
+/*! \brief Subtract src from rows of dest shared by the threads.
+ *
+ * <pre>
+ * dest[rows[i] - rel + j*ldd] -= src[i + j*lds], for i < nrow and all the
+ * right-hand sides j, or dest[i + j*ldd] if rows is NULL, with atomic
+ * updates: the threads update the blocks of the shared lsum[] without
+ * locks (see LSUM_COPY()).
+ * </pre>
+ */
+static void slsum_sub_atomic(float *dest, int_t ldd, int nrhs, int_t nrow,
+			      int_t *rows, int_t rel, float *src, int_t lds)
+{
+    int_t i, irow, j;
+
+    RHS_ITERATE(j)
+	for (i = 0; i < nrow; ++i) {
+	    irow = rows ? rows[i] - rel : i;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+	    dest[irow + j*ldd] -= src[i + j*lds];
+	}
+}
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform local block modifications: lsum[i] -= L_i,k * X[k].
+ * </pre>
+ */
+void slsum_fmod
+/************************************************************************/
+(
+ float *lsum,    /* Sum of local modifications.                        */
+ float *x,       /* X array (local)                                    */
+ float *xk,      /* X[k].                                              */
+ float *rtemp,   /* Result of full matrix-vector multiply.             */
+ int   nrhs,      /* Number of right-hand sides.                        */
+ int   knsupc,    /* Size of supernode k.                               */
+ int_t k,         /* The k-th component of X.                           */
+ int_t *fmod,     /* Modification count for L-solve.                    */
+ int_t nlb,       /* Number of L blocks.                                */
+ int_t lptr,      /* Starting position in lsub[*].                      */
+ int_t luptr,     /* Starting position in lusup[*].                     */
+ int_t *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ MPI_Request send_req[], /* input/output */
+ SuperLUStat_t *stat
+)
+{
+    float alpha = 1.0, beta = 0.0;
+    float *lusup, *lusup1;
+    float *dest;
+    int    iam, iknsupc, myrow, nbrow, nsupr, nsupr1, p, pi;
+    int_t  i, ii, ik, il, ikcol, irow, j, lb, lk, lib, rel;
+    int_t  *lsub, *lsub1, nlb1, lptr1, luptr1;
+    int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
+    int_t  *frecv = Llu->frecv;
+    int_t  **fsendx_plist = Llu->fsendx_plist;
+    MPI_Status status;
+    int test_flag;
+
+#if ( PROFlevel>=1 )
+	double t1, t2;
+	float msg_vol = 0, msg_cnt = 0;
+#endif
+#if ( PROFlevel>=1 )
+	TIC(t1);
+#endif
+
+    iam = grid->iam;
+    myrow = MYROW( iam, grid );
+    lk = LBj( k, grid ); /* Local block number, column-wise. */
+    lsub = Llu->Lrowind_bc_ptr[lk];
+    lusup = Llu->Lnzval_bc_ptr[lk];
+    nsupr = lsub[1];
+
+    for (lb = 0; lb < nlb; ++lb) {
+	ik = lsub[lptr]; /* Global block number, row-wise. */
+	nbrow = lsub[lptr+1];
+	if ( !sgemm_small(nbrow, nrhs, knsupc,
+	                  &lusup[luptr], nsupr, xk, knsupc, rtemp, nbrow) ) {
+#ifdef _CRAY
+	SGEMM( ftcs2, ftcs2, &nbrow, &nrhs, &knsupc,
+	      &alpha, &lusup[luptr], &nsupr, xk,
+	      &knsupc, &beta, rtemp, &nbrow );
+#elif defined (USE_VENDOR_BLAS)
+	sgemm_( "N", "N", &nbrow, &nrhs, &knsupc,
+	       &alpha, &lusup[luptr], &nsupr, xk,
+	       &knsupc, &beta, rtemp, &nbrow, 1, 1 );
+#else
+	sgemm_( "N", "N", &nbrow, &nrhs, &knsupc,
+	       &alpha, &lusup[luptr], &nsupr, xk,
+	       &knsupc, &beta, rtemp, &nbrow );
+#endif
+	}
+	stat->ops[SOLVE] += 2 * nbrow * nrhs * knsupc + nbrow * nrhs;
+
+	lk = LBi( ik, grid ); /* Local block number, row-wise. */
+	iknsupc = SuperSize( ik );
+	il = LSUM_BLK( lk );
+	dest = &lsum[il];
+	lptr += LB_DESCRIPTOR;
+	rel = xsup[ik]; /* Global row index of block ik. */
+	for (i = 0; i < nbrow; ++i) {
+	    irow = lsub[lptr++] - rel; /* Relative row. */
+	    RHS_ITERATE(j)
+		dest[irow + j*iknsupc] -= rtemp[i + j*nbrow];
+	}
+	luptr += nbrow;
+
+#if ( PROFlevel>=1 )
+		TOC(t2, t1);
+		stat->utime[SOL_GEMM] += t2;
+#endif
+
+	if ( (--fmod[lk])==0 ) { /* Local accumulation done. */
+	    ikcol = PCOL( ik, grid );
+	    p = PNUM( myrow, ikcol, grid );
+	    if ( iam != p ) {
+#ifdef ISEND_IRECV
+		MPI_Isend( &lsum[il - LSUM_H], iknsupc * nrhs + LSUM_H,
+			   MPI_FLOAT, p, LSUM, grid->comm,
+                           &send_req[Llu->SolveMsgSent++] );
+#else
+#ifdef BSEND
+		MPI_Bsend( &lsum[il - LSUM_H], iknsupc * nrhs + LSUM_H,
+			   MPI_FLOAT, p, LSUM, grid->comm );
+#else
+		MPI_Send( &lsum[il - LSUM_H], iknsupc * nrhs + LSUM_H,
+			 MPI_FLOAT, p, LSUM, grid->comm );
+#endif
+#endif
+#if ( DEBUGlevel>=2 )
+		printf("(%2d) Sent LSUM[%2.0f], size %2d, to P %2d\n",
+		       iam, lsum[il-LSUM_H], iknsupc*nrhs+LSUM_H, p);
+#endif
+	    } else { /* Diagonal process: X[i] += lsum[i]. */
+		ii = X_BLK( lk );
+		RHS_ITERATE(j)
+		    for (i = 0; i < iknsupc; ++i)
+			x[i + ii + j*iknsupc] += lsum[i + il + j*iknsupc];
+		if ( frecv[lk]==0 ) { /* Becomes a leaf node. */
+		    fmod[lk] = -1; /* Do not solve X[k] in the future. */
+		    lk = LBj( ik, grid );/* Local block number, column-wise. */
+		    lsub1 = Llu->Lrowind_bc_ptr[lk];
+		    lusup1 = Llu->Lnzval_bc_ptr[lk];
+		    nsupr1 = lsub1[1];
+#if ( PROFlevel>=1 )
+			TIC(t1);
+#endif
+		    if ( !strsm_small('L', iknsupc, nrhs,
+		                      lusup1, nsupr1, &x[ii], iknsupc) ) {
+#ifdef _CRAY
+		    STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &iknsupc, &nrhs, &alpha,
+			  lusup1, &nsupr1, &x[ii], &iknsupc);
+#elif defined (USE_VENDOR_BLAS)
+		    strsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
+			   lusup1, &nsupr1, &x[ii], &iknsupc, 1, 1, 1, 1);
+#else
+		    strsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
+			   lusup1, &nsupr1, &x[ii], &iknsupc);
+#endif
+		    }
+#if ( PROFlevel>=1 )
+			TOC(t2, t1);
+			stat->utime[SOL_TRSM] += t2;
+#endif
+
+		    stat->ops[SOLVE] += iknsupc * (iknsupc - 1) * nrhs;
+#if ( DEBUGlevel>=2 )
+		    printf("(%2d) Solve X[%2d]\n", iam, ik);
+#endif
+
+		    /*
+		     * Send Xk to process column Pc[k].
+		     */
+		    for (p = 0; p < grid->nprow; ++p) {
+			if ( fsendx_plist[lk][p] != EMPTY ) {
+			    pi = PNUM( p, ikcol, grid );
+#ifdef ISEND_IRECV
+			    MPI_Isend( &x[ii - XK_H], iknsupc * nrhs + XK_H,
+				       MPI_FLOAT, pi, Xk, grid->comm,
+				       &send_req[Llu->SolveMsgSent++] );
+#else
+#ifdef BSEND
+			    MPI_Bsend( &x[ii - XK_H], iknsupc * nrhs + XK_H,
+				       MPI_FLOAT, pi, Xk, grid->comm );
+#else
+			    MPI_Send( &x[ii - XK_H], iknsupc * nrhs + XK_H,
+				     MPI_FLOAT, pi, Xk, grid->comm );
+#endif
+#endif
+#if ( DEBUGlevel>=2 )
+			    printf("(%2d) Sent X[%2.0f] to P %2d\n",
+				   iam, x[ii-XK_H], pi);
+#endif
+			}
+                    }
+		    /*
+		     * Perform local block modifications.
+		     */
+		    nlb1 = lsub1[0] - 1;
+		    lptr1 = BC_HEADER + LB_DESCRIPTOR + iknsupc;
+		    luptr1 = iknsupc; /* Skip diagonal block L(I,I). */
+
+		    slsum_fmod(lsum, x, &x[ii], rtemp, nrhs, iknsupc, ik,
+			       fmod, nlb1, lptr1, luptr1, xsup,
+			       grid, Llu, send_req, stat);
+		} /* if frecv[lk] == 0 */
+	    } /* if iam == p */
+	} /* if fmod[lk] == 0 */
+
+    } /* for lb ... */
+
+} /* sLSUM_FMOD */
+
+
+/************************************************************************/
+void slsum_bmod
+/************************************************************************/
+(
+ float *lsum,        /* Sum of local modifications.                    */
+ float *x,           /* X array (local).                               */
+ float *xk,          /* X[k].                                          */
+ int    nrhs,	      /* Number of right-hand sides.                    */
+ int_t  k,            /* The k-th component of X.                       */
+ int_t  *bmod,        /* Modification count for L-solve.                */
+ int_t  *Urbs,        /* Number of row blocks in each block column of U.*/
+ Ucb_indptr_t **Ucb_indptr,/* Vertical linked list pointing to Uindex[].*/
+ int_t  **Ucb_valptr, /* Vertical linked list pointing to Unzval[].     */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ MPI_Request send_req[], /* input/output */
+ SuperLUStat_t *stat
+ )
+{
+/*
+ * Purpose
+ * =======
+ *   Perform local block modifications: lsum[i] -= U_i,k * X[k].
+ */
+    float alpha = 1.0, beta = 0.0;
+    int    iam, iknsupc, knsupc, myrow, nsupr, p, pi;
+    int_t  fnz, gik, gikcol, i, ii, ik, ikfrow, iklrow, il, irow,
+           j, jj, lk, lk1, nub, ub, uptr;
+    int_t  *usub;
+    float *uval, *dest, *y;
+    int_t  *lsub;
+    float *lusup;
+    int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
+    int_t  *brecv = Llu->brecv;
+    int_t  **bsendx_plist = Llu->bsendx_plist;
+    MPI_Status status;
+    int test_flag;
+
+    iam = grid->iam;
+    myrow = MYROW( iam, grid );
+    knsupc = SuperSize( k );
+    lk = LBj( k, grid ); /* Local block number, column-wise. */
+    nub = Urbs[lk];      /* Number of U blocks in block column lk */
+
+    for (ub = 0; ub < nub; ++ub) {
+	ik = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
+	usub = Llu->Ufstnz_br_ptr[ik];
+	uval = Llu->Unzval_br_ptr[ik];
+	i = Ucb_indptr[lk][ub].indpos; /* Start of the block in usub[]. */
+	i += UB_DESCRIPTOR;
+	il = LSUM_BLK( ik );
+	gik = ik * grid->nprow + myrow;/* Global block number, row-wise. */
+	iknsupc = SuperSize( gik );
+	ikfrow = FstBlockC( gik );
+	iklrow = FstBlockC( gik+1 );
+
+	RHS_ITERATE(j) {
+	    dest = &lsum[il + j*iknsupc];
+	    y = &xk[j*knsupc];
+	    uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
+	    for (jj = 0; jj < knsupc; ++jj) {
+		fnz = usub[i + jj];
+		if ( fnz < iklrow ) { /* Nonzero segment. */
+		    /* AXPY */
+		    for (irow = fnz; irow < iklrow; ++irow)
+			dest[irow - ikfrow] -= uval[uptr++] * y[jj];
+		    stat->ops[SOLVE] += 2 * (iklrow - fnz);
+		}
+	    } /* for jj ... */
+	}
+
+	if ( (--bmod[ik]) == 0 ) { /* Local accumulation done. */
+	    gikcol = PCOL( gik, grid );
+	    p = PNUM( myrow, gikcol, grid );
+	    if ( iam != p ) {
+#ifdef ISEND_IRECV
+		MPI_Isend( &lsum[il - LSUM_H], iknsupc * nrhs + LSUM_H,
+			   MPI_FLOAT, p, LSUM, grid->comm,
+                           &send_req[Llu->SolveMsgSent++] );
+#else
+#ifdef BSEND
+		MPI_Bsend( &lsum[il - LSUM_H], iknsupc * nrhs + LSUM_H,
+			   MPI_FLOAT, p, LSUM, grid->comm );
+#else
+		MPI_Send( &lsum[il - LSUM_H], iknsupc * nrhs + LSUM_H,
+			  MPI_FLOAT, p, LSUM, grid->comm );
+#endif
+#endif
+#if ( DEBUGlevel>=2 )
+		printf("(%2d) Sent LSUM[%2.0f], size %2d, to P %2d\n",
+		       iam, lsum[il-LSUM_H], iknsupc*nrhs+LSUM_H, p);
+#endif
+	    } else { /* Diagonal process: X[i] += lsum[i]. */
+		ii = X_BLK( ik );
+		dest = &x[ii];
+		RHS_ITERATE(j)
+		    for (i = 0; i < iknsupc; ++i)
+			dest[i + j*iknsupc] += lsum[i + il + j*iknsupc];
+		if ( !brecv[ik] ) { /* Becomes a leaf node. */
+		    bmod[ik] = -1; /* Do not solve X[k] in the future. */
+		    lk1 = LBj( gik, grid ); /* Local block number. */
+		    lsub = Llu->Lrowind_bc_ptr[lk1];
+		    lusup = Llu->Lnzval_bc_ptr[lk1];
+		    nsupr = lsub[1];
+		    if ( !strsm_small('U', iknsupc, nrhs,
+		                      lusup, nsupr, &x[ii], iknsupc) ) {
+#ifdef _CRAY
+		    STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &iknsupc, &nrhs, &alpha,
+			  lusup, &nsupr, &x[ii], &iknsupc);
+#elif defined (USE_VENDOR_BLAS)
+		    strsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
+			   lusup, &nsupr, &x[ii], &iknsupc, 1, 1, 1, 1);
+#else
+		    strsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
+			   lusup, &nsupr, &x[ii], &iknsupc);
+#endif
+		    }
+		    stat->ops[SOLVE] += iknsupc * (iknsupc + 1) * nrhs;
+#if ( DEBUGlevel>=2 )
+		    printf("(%2d) Solve X[%2d]\n", iam, gik);
+#endif
+
+		    /*
+		     * Send Xk to process column Pc[k].
+		     */
+		    for (p = 0; p < grid->nprow; ++p) {
+			if ( bsendx_plist[lk1][p] != EMPTY ) {
+			    pi = PNUM( p, gikcol, grid );
+#ifdef ISEND_IRECV
+			    MPI_Isend( &x[ii - XK_H], iknsupc * nrhs + XK_H,
+				       MPI_FLOAT, pi, Xk, grid->comm,
+				       &send_req[Llu->SolveMsgSent++] );
+#else
+#ifdef BSEND
+			    MPI_Bsend( &x[ii - XK_H], iknsupc * nrhs + XK_H,
+				       MPI_FLOAT, pi, Xk, grid->comm );
+#else
+			    MPI_Send( &x[ii - XK_H], iknsupc * nrhs + XK_H,
+				     MPI_FLOAT, pi, Xk, grid->comm );
+#endif
+#endif
+#if ( DEBUGlevel>=2 )
+			    printf("(%2d) Sent X[%2.0f] to P %2d\n",
+				   iam, x[ii-XK_H], pi);
+#endif
+			}
+                     }
+		    /*
+		     * Perform local block modifications.
+		     */
+		    if ( Urbs[lk1] )
+			slsum_bmod(lsum, x, &x[ii], nrhs, gik, bmod, Urbs,
+				   Ucb_indptr, Ucb_valptr, xsup, grid, Llu,
+				   send_req, stat);
+		} /* if brecv[ik] == 0 */
+	    }
+	} /* if bmod[ik] == 0 */
+
+    } /* for ub ... */
+
+} /* dlSUM_BMOD */
+
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform local block modifications: lsum[i] -= L_i,k * X[k].
+ * </pre>
+ */
+void slsum_fmod_inv
+/************************************************************************/
+(
+ float *lsum,    /* Sum of local modifications.                        */
+ float *x,       /* X array (local)                                    */
+ float *xk,      /* X[k].                                              */
+ float *rtemp,   /* Result of full matrix-vector multiply.             */
+ int   nrhs,      /* Number of right-hand sides.                        */
+ int_t k,         /* The k-th component of X.                           */
+ int_t *fmod,     /* Modification count for L-solve.                    */
+ int_t *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ SuperLUStat_t **stat,
+ int_t *leaf_send,
+ int_t *nleaf_send,
+ int_t sizelsum,
+ int_t sizertemp,
+ int_t recurlevel,
+ int_t maxsuper,
+ int thread_id,
+ int num_thread
+)
+{
+    float alpha = 1.0, beta = 0.0,malpha=-1.0;
+    float *lusup, *lusup1;
+    float *dest;
+	float *Linv;/* Inverse of diagonal block */
+	int    iam, iknsupc, myrow, krow, nbrow, nbrow1, nbrow_ref, nsupr, nsupr1, p, pi, idx_r,m;
+	int_t  i, ii,jj, ik, il, ikcol, irow, j, lb, lk, rel, lib,lready;
+	int_t  *lsub, *lsub1, nlb1, lptr1, luptr1,*lloc;
+    int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
+    int_t  *frecv = Llu->frecv;
+    int_t  **fsendx_plist = Llu->fsendx_plist;
+	int_t  luptr_tmp,luptr_tmp1,lptr1_tmp,maxrecvsz, idx_i, idx_v,idx_n,  idx_l, fmod_tmp, lbstart,lbend,nn,Nchunk,nlb_loc,remainder;
+	int thread_id1;
+	flops_t ops_loc=0.0;
+    MPI_Status status;
+    int test_flag;
+	yes_no_t done;
+	BcTree  *LBtree_ptr = Llu->LBtree_ptr;
+	RdTree  *LRtree_ptr = Llu->LRtree_ptr;
+	int_t* idx_lsum,idx_lsum1;
+	float *rtemp_loc;
+	int_t ldalsum;
+	int_t nleaf_send_tmp;
+	int_t lptr;      /* Starting position in lsub[*].                      */
+	int_t luptr;     /* Starting position in lusup[*].                     */
+	int_t iword = sizeof(int_t);
+	int_t dword = sizeof (float);
+	int_t aln_d,aln_i;
+	aln_d = ceil(CACHELINE/(float)dword);
+	aln_i = ceil(CACHELINE/(float)iword);
+	int   knsupc;    /* Size of supernode k.                               */
+	int_t nlb;       /* Number of L blocks.                                */
+
+
+	knsupc = SuperSize( k );
+
+	lk = LBj( k, grid ); /* Local block number, column-wise. */
+	lsub = Llu->Lrowind_bc_ptr[lk];
+	nlb = lsub[0] - 1;
+
+
+	ldalsum=Llu->ldalsum;
+
+	rtemp_loc = &rtemp[sizertemp* thread_id];
+
+	// #if ( PROFlevel>=1 )
+	double t1, t2, t3, t4;
+	float msg_vol = 0, msg_cnt = 0;
+	// #endif
+
+	if(nlb>0){
+
+		iam = grid->iam;
+		myrow = MYROW( iam, grid );
+
+		lusup = Llu->Lnzval_bc_ptr[lk];
+		lloc = Llu->Lindval_loc_bc_ptr[lk];
+
+		nsupr = lsub[1];
+
+		// printf("nlb: %5d lk: %5d\n",nlb,lk);
+		// fflush(stdout);
+
+		krow = PROW( k, grid );
+		if(myrow==krow){
+			idx_n = 1;
+			idx_i = nlb+2;
+			idx_v = 2*nlb+3;
+			luptr_tmp = lloc[idx_v];
+			m = nsupr-knsupc;
+		}else{
+			idx_n = 0;
+			idx_i = nlb;
+			idx_v = 2*nlb;
+			luptr_tmp = lloc[idx_v];
+			m = nsupr;
+		}
+
+		assert(m>0);
+
+		if(m>8*maxsuper){
+		// if(0){
+
+			// Nchunk=floor(num_thread/2.0)+1;
+			Nchunk=SUPERLU_MIN(num_thread,nlb);
+			// Nchunk=1;
+			nlb_loc = floor(((float)nlb)/Nchunk);
+			remainder = nlb % Nchunk;
+
+#ifdef _OPENMP
+#pragma	omp	taskloop private (lptr1,luptr1,nlb1,thread_id1,lsub1,lusup1,nsupr1,Linv,nn,lbstart,lbend,luptr_tmp1,nbrow,lb,lptr1_tmp,rtemp_loc,nbrow_ref,lptr,nbrow1,ik,rel,lk,iknsupc,il,i,irow,fmod_tmp,ikcol,p,ii,jj,t1,t2,j,nleaf_send_tmp) untied nogroup
+#endif
+			for (nn=0;nn<Nchunk;++nn){
+
+#ifdef _OPENMP
+				thread_id1 = omp_get_thread_num ();
+#else
+				thread_id1 = 0;
+#endif
+				rtemp_loc = &rtemp[sizertemp* thread_id1];
+
+				if(nn<remainder){
+					lbstart = nn*(nlb_loc+1);
+					lbend = (nn+1)*(nlb_loc+1);
+				}else{
+					lbstart = remainder+nn*nlb_loc;
+					lbend = remainder + (nn+1)*nlb_loc;
+				}
+
+				if(lbstart<lbend){
+
+#if ( PROFlevel>=1 )
+					TIC(t1);
+#endif
+					luptr_tmp1 = lloc[lbstart+idx_v];
+					nbrow=0;
+					for (lb = lbstart; lb < lbend; ++lb){
+						lptr1_tmp = lloc[lb+idx_i];
+						nbrow += lsub[lptr1_tmp+1];
+					}
+
+					if ( !sgemm_small(nbrow, nrhs, knsupc,
+					                  &lusup[luptr_tmp1], nsupr, xk, knsupc, rtemp_loc, nbrow) ) {
+				#ifdef _CRAY
+					SGEMM( ftcs2, ftcs2, &nbrow, &nrhs, &knsupc,
+						  &alpha, &lusup[luptr_tmp1], &nsupr, xk,
+						  &knsupc, &beta, rtemp_loc, &nbrow );
+				#elif defined (USE_VENDOR_BLAS)
+					sgemm_( "N", "N", &nbrow, &nrhs, &knsupc,
+						   &alpha, &lusup[luptr_tmp1], &nsupr, xk,
+						   &knsupc, &beta, rtemp_loc, &nbrow, 1, 1 );
+				#else
+					sgemm_( "N", "N", &nbrow, &nrhs, &knsupc,
+						   &alpha, &lusup[luptr_tmp1], &nsupr, xk,
+						   &knsupc, &beta, rtemp_loc, &nbrow );
+				#endif
+					}
+
+					nbrow_ref=0;
+					for (lb = lbstart; lb < lbend; ++lb){
+						lptr1_tmp = lloc[lb+idx_i];
+						lptr= lptr1_tmp+2;
+						nbrow1 = lsub[lptr1_tmp+1];
+						ik = lsub[lptr1_tmp]; /* Global block number, row-wise. */
+						rel = xsup[ik]; /* Global row index of block ik. */
+
+						lk = LBi( ik, grid ); /* Local block number, row-wise. */
+
+						iknsupc = SuperSize( ik );
+						il = LSUM_BLK( lk );
+
+						if ( Llu->lsum_shared ) {
+							slsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1, &lsub[lptr],
+									   rel, &rtemp_loc[nbrow_ref], nbrow);
+						} else {
+							RHS_ITERATE(j)
+								#ifdef _OPENMP
+								#pragma omp simd
+								#endif
+								for (i = 0; i < nbrow1; ++i) {
+									irow = lsub[lptr+i] - rel; /* Relative row. */
+									lsum[il+irow + j*iknsupc+LSUM_COPY(thread_id1)] -= rtemp_loc[nbrow_ref+i + j*nbrow];
+								}
+						}
+						nbrow_ref+=nbrow1;
+					}
+
+#if ( PROFlevel>=1 )
+					TOC(t2, t1);
+					stat[thread_id1]->utime[SOL_GEMM] += t2;
+#endif
+
+					for (lb=lbstart;lb<lbend;lb++){
+						lk = lloc[lb+idx_n];
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+						fmod_tmp=--fmod[lk*aln_i];
+
+						if ( fmod_tmp==0 ) { /* Local accumulation done. */
+
+							lptr1_tmp = lloc[lb+idx_i];
+
+							ik = lsub[lptr1_tmp]; /* Global block number, row-wise. */
+							lk = LBi( ik, grid ); /* Local block number, row-wise. */
+
+							iknsupc = SuperSize( ik );
+							il = LSUM_BLK( lk );
+
+							ikcol = PCOL( ik, grid );
+							p = PNUM( myrow, ikcol, grid );
+							if ( iam != p ) {
+								for (ii=1;ii<LSUM_NCOPY;ii++)
+									#ifdef _OPENMP
+									#pragma omp simd
+									#endif
+									for (jj=0;jj<iknsupc*nrhs;jj++)
+										lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+								nleaf_send_tmp = ++nleaf_send[0];
+								leaf_send[(nleaf_send_tmp-1)*aln_i] = -lk-1;
+								// RdTree_forwardMessageSimple(LRtree_ptr[lk],&lsum[il - LSUM_H ],'s');
+
+							} else { /* Diagonal process: X[i] += lsum[i]. */
+
+#if ( PROFlevel>=1 )
+								TIC(t1);
+#endif
+								for (ii=1;ii<LSUM_NCOPY;ii++)
+									#ifdef _OPENMP
+									#pragma omp simd
+									#endif
+									for (jj=0;jj<iknsupc*nrhs;jj++)
+										lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+								ii = X_BLK( lk );
+								RHS_ITERATE(j)
+									#ifdef _OPENMP
+									#pragma omp simd
+									#endif
+									for (i = 0; i < iknsupc; ++i)
+										x[i + ii + j*iknsupc] += lsum[i + il + j*iknsupc ];
+
+
+								// fmod[lk] = -1; /* Do not solve X[k] in the future. */
+								lk = LBj( ik, grid );/* Local block number, column-wise. */
+								lsub1 = Llu->Lrowind_bc_ptr[lk];
+								lusup1 = Llu->Lnzval_bc_ptr[lk];
+								nsupr1 = lsub1[1];
+
+								if(Llu->inv == 1 && Llu->Linv_bc_ptr[lk]){
+									Linv = Llu->Linv_bc_ptr[lk];
+
+
+									if ( !sgemm_small(iknsupc, nrhs, iknsupc,
+									                  Linv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
+#ifdef _CRAY
+									SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
+											&alpha, Linv, &iknsupc, &x[ii],
+											&iknsupc, &beta, rtemp_loc, &iknsupc );
+#elif defined (USE_VENDOR_BLAS)
+									sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+											&alpha, Linv, &iknsupc, &x[ii],
+											&iknsupc, &beta, rtemp_loc, &iknsupc, 1, 1 );
+#else
+									sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+											&alpha, Linv, &iknsupc, &x[ii],
+											&iknsupc, &beta, rtemp_loc, &iknsupc );
+#endif
+									}
+									#ifdef _OPENMP
+									#pragma omp simd
+									#endif
+									for (i=0 ; i<iknsupc*nrhs ; i++){
+										x[ii+i] = rtemp_loc[i];
+									}
+
+								}else{
+									if ( !strsm_small('L', iknsupc, nrhs,
+									                  lusup1, nsupr1, &x[ii], iknsupc) ) {
+#ifdef _CRAY
+									STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &iknsupc, &nrhs, &alpha,
+											lusup1, &nsupr1, &x[ii], &iknsupc);
+#elif defined (USE_VENDOR_BLAS)
+									strsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
+											lusup1, &nsupr1, &x[ii], &iknsupc, 1, 1, 1, 1);
+#else
+									strsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
+											lusup1, &nsupr1, &x[ii], &iknsupc);
+
+#endif
+									}
+								}
+
+#if ( PROFlevel>=1 )
+								TOC(t2, t1);
+								stat[thread_id1]->utime[SOL_TRSM] += t2;
+
+#endif
+
+								stat[thread_id1]->ops[SOLVE] += iknsupc * (iknsupc - 1) * nrhs;
+								SOLVE_STAMP(Llu->sol_tdone, ik);
+
+#if ( DEBUGlevel>=2 )
+								printf("(%2d) Solve X[%2d]\n", iam, ik);
+
+#endif
+
+								/*
+								 * Send Xk to process column Pc[k].
+								 */
+
+								if(LBtree_ptr[lk]!=NULL){
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+									nleaf_send_tmp = ++nleaf_send[0];
+									leaf_send[(nleaf_send_tmp-1)*aln_i] = lk;
+								}
+
+								/*
+								 * Perform local block modifications.
+								 */
+
+								// #ifdef _OPENMP
+								// #pragma	omp	task firstprivate (Llu,sizelsum,iknsupc,ii,ik,lsub1,x,rtemp,fmod,lsum,stat,nrhs,grid,xsup,recurlevel) private(lptr1,luptr1,nlb1,thread_id1) untied priority(1)
+								// #endif
+								{
+
+									slsum_fmod_inv(lsum, x, &x[ii], rtemp, nrhs, ik,
+											fmod, xsup,
+											grid, Llu, stat, leaf_send, nleaf_send ,sizelsum,sizertemp,1+recurlevel,maxsuper,thread_id1,num_thread);
+								}
+
+								// } /* if frecv[lk] == 0 */
+						} /* if iam == p */
+					} /* if fmod[lk] == 0 */
+				}
+
+			}
+		}
+
+		}else{
+
+#if ( PROFlevel>=1 )
+			TIC(t1);
+#endif
+
+			if ( !sgemm_small(m, nrhs, knsupc,
+			                  &lusup[luptr_tmp], nsupr, xk, knsupc, rtemp_loc, m) ) {
+#ifdef _CRAY
+			SGEMM( ftcs2, ftcs2, &m, &nrhs, &knsupc,
+					&alpha, &lusup[luptr_tmp], &nsupr, xk,
+					&knsupc, &beta, rtemp_loc, &m );
+#elif defined (USE_VENDOR_BLAS)
+			sgemm_( "N", "N", &m, &nrhs, &knsupc,
+					&alpha, &lusup[luptr_tmp], &nsupr, xk,
+					&knsupc, &beta, rtemp_loc, &m, 1, 1 );
+#else
+			sgemm_( "N", "N", &m, &nrhs, &knsupc,
+					&alpha, &lusup[luptr_tmp], &nsupr, xk,
+					&knsupc, &beta, rtemp_loc, &m );
+#endif
+			}
+
+			nbrow=0;
+			for (lb = 0; lb < nlb; ++lb){
+				lptr1_tmp = lloc[lb+idx_i];
+				nbrow += lsub[lptr1_tmp+1];
+			}
+			nbrow_ref=0;
+			for (lb = 0; lb < nlb; ++lb){
+				lptr1_tmp = lloc[lb+idx_i];
+				lptr= lptr1_tmp+2;
+				nbrow1 = lsub[lptr1_tmp+1];
+				ik = lsub[lptr1_tmp]; /* Global block number, row-wise. */
+				rel = xsup[ik]; /* Global row index of block ik. */
+
+				lk = LBi( ik, grid ); /* Local block number, row-wise. */
+
+				iknsupc = SuperSize( ik );
+				il = LSUM_BLK( lk );
+
+				if ( Llu->lsum_shared ) {
+					slsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1, &lsub[lptr],
+							   rel, &rtemp_loc[nbrow_ref], nbrow);
+				} else {
+					RHS_ITERATE(j)
+						#ifdef _OPENMP
+						#pragma omp simd
+						#endif
+						for (i = 0; i < nbrow1; ++i) {
+							irow = lsub[lptr+i] - rel; /* Relative row. */
+
+									lsum[il+irow + j*iknsupc+LSUM_COPY(thread_id)] -= rtemp_loc[nbrow_ref+i + j*nbrow];
+						}
+				}
+				nbrow_ref+=nbrow1;
+			}
+
+			// TOC(t3, t1);
+
+#if ( PROFlevel>=1 )
+			TOC(t2, t1);
+			stat[thread_id]->utime[SOL_GEMM] += t2;
+#endif
+
+			for (lb=0;lb<nlb;lb++){
+				lk = lloc[lb+idx_n];
+
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+				fmod_tmp=--fmod[lk*aln_i];
+
+
+				if ( fmod_tmp==0 ) { /* Local accumulation done. */
+
+					lptr1_tmp = lloc[lb+idx_i];
+
+					ik = lsub[lptr1_tmp]; /* Global block number, row-wise. */
+					lk = LBi( ik, grid ); /* Local block number, row-wise. */
+
+					iknsupc = SuperSize( ik );
+					il = LSUM_BLK( lk );
+					ikcol = PCOL( ik, grid );
+					p = PNUM( myrow, ikcol, grid );
+					if ( iam != p ) {
+						for (ii=1;ii<LSUM_NCOPY;ii++)
+							#ifdef _OPENMP
+							#pragma omp simd
+							#endif
+							for (jj=0;jj<iknsupc*nrhs;jj++)
+								lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+						nleaf_send_tmp = ++nleaf_send[0];
+						leaf_send[(nleaf_send_tmp-1)*aln_i] = -lk-1;
+
+					} else { /* Diagonal process: X[i] += lsum[i]. */
+
+#if ( PROFlevel>=1 )
+						TIC(t1);
+#endif
+						for (ii=1;ii<LSUM_NCOPY;ii++)
+							#ifdef _OPENMP
+							#pragma omp simd
+							#endif
+							for (jj=0;jj<iknsupc*nrhs;jj++)
+								lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+						ii = X_BLK( lk );
+						RHS_ITERATE(j)
+							#ifdef _OPENMP
+							#pragma omp simd
+							#endif
+							for (i = 0; i < iknsupc; ++i)
+							    x[i + ii + j*iknsupc] += lsum[i + il + j*iknsupc];
+
+
+						lk = LBj( ik, grid );/* Local block number, column-wise. */
+						lsub1 = Llu->Lrowind_bc_ptr[lk];
+						lusup1 = Llu->Lnzval_bc_ptr[lk];
+						nsupr1 = lsub1[1];
+
+						if(Llu->inv == 1 && Llu->Linv_bc_ptr[lk]){
+							Linv = Llu->Linv_bc_ptr[lk];
+							if ( !sgemm_small(iknsupc, nrhs, iknsupc,
+							                  Linv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
+#ifdef _CRAY
+							SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
+									&alpha, Linv, &iknsupc, &x[ii],
+									&iknsupc, &beta, rtemp_loc, &iknsupc );
+#elif defined (USE_VENDOR_BLAS)
+							sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+									&alpha, Linv, &iknsupc, &x[ii],
+									&iknsupc, &beta, rtemp_loc, &iknsupc, 1, 1 );
+#else
+							sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+									&alpha, Linv, &iknsupc, &x[ii],
+									&iknsupc, &beta, rtemp_loc, &iknsupc );
+#endif
+							}
+							#ifdef _OPENMP
+							#pragma omp simd
+							#endif
+							for (i=0 ; i<iknsupc*nrhs ; i++){
+								x[ii+i] = rtemp_loc[i];
+							}
+						}else{
+							if ( !strsm_small('L', iknsupc, nrhs,
+							                  lusup1, nsupr1, &x[ii], iknsupc) ) {
+#ifdef _CRAY
+							STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &iknsupc, &nrhs, &alpha,
+									lusup1, &nsupr1, &x[ii], &iknsupc);
+#elif defined (USE_VENDOR_BLAS)
+							strsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
+									lusup1, &nsupr1, &x[ii], &iknsupc, 1, 1, 1, 1);
+#else
+							strsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
+									lusup1, &nsupr1, &x[ii], &iknsupc);
+#endif
+							}
+						}
+
+#if ( PROFlevel>=1 )
+						TOC(t2, t1);
+						stat[thread_id]->utime[SOL_TRSM] += t2;
+#endif
+
+						stat[thread_id]->ops[SOLVE] += iknsupc * (iknsupc - 1) * nrhs;
+						SOLVE_STAMP(Llu->sol_tdone, ik);
+
+#if ( DEBUGlevel>=2 )
+						printf("(%2d) Solve X[%2d]\n", iam, ik);
+#endif
+
+						/*
+						 * Send Xk to process column Pc[k].
+						 */
+
+						if(LBtree_ptr[lk]!=NULL){
+
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+							nleaf_send_tmp = ++nleaf_send[0];
+							// printf("nleaf_send_tmp %5d lk %5d\n",nleaf_send_tmp);
+							leaf_send[(nleaf_send_tmp-1)*aln_i] = lk;
+							// BcTree_forwardMessageSimple(LBtree_ptr[lk],&x[ii - XK_H],'s');
+						}
+
+						/*
+						 * Perform local block modifications.
+						 */
+
+						// #ifdef _OPENMP
+						// #pragma	omp	task firstprivate (Llu,sizelsum,iknsupc,ii,ik,lsub1,x,rtemp,fmod,lsum,stat,nrhs,grid,xsup,recurlevel) private(lptr1,luptr1,nlb1) untied priority(1)
+						// #endif
+
+						{
+							slsum_fmod_inv(lsum, x, &x[ii], rtemp, nrhs, ik,
+									fmod, xsup,
+									grid, Llu, stat, leaf_send, nleaf_send ,sizelsum,sizertemp,1+recurlevel,maxsuper,thread_id,num_thread);
+						}
+
+						// } /* if frecv[lk] == 0 */
+				} /* if iam == p */
+			} /* if fmod[lk] == 0 */
+		}
+		// }
+}
+
+	stat[thread_id]->ops[SOLVE] += 2 * m * nrhs * knsupc;
+
+
+
+} /* if nlb>0*/
+} /* sLSUM_FMOD_INV */
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform local block modifications: lsum[i] -= L_i,k * X[k].
+ * </pre>
+ */
+void slsum_fmod_inv_master
+/************************************************************************/
+(
+ float *lsum,    /* Sum of local modifications.                        */
+ float *x,       /* X array (local)                                    */
+ float *xk,      /* X[k].                                              */
+ float *rtemp,   /* Result of full matrix-vector multiply.             */
+ int   nrhs,      /* Number of right-hand sides.                        */
+ int   knsupc,    /* Size of supernode k.                               */
+ int_t k,         /* The k-th component of X.                           */
+ int_t *fmod,     /* Modification count for L-solve.                    */
+ int_t nlb,       /* Number of L blocks.                                */
+ int_t *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ SuperLUStat_t **stat,
+ int_t sizelsum,
+ int_t sizertemp,
+ int_t recurlevel,
+ int_t maxsuper,
+ int thread_id,
+ int num_thread
+)
+{
+    float alpha = 1.0, beta = 0.0, malpha=-1.0;
+    float *lusup, *lusup1;
+    float *dest;
+	float *Linv;/* Inverse of diagonal block */
+	int    iam, iknsupc, myrow, krow, nbrow, nbrow1, nbrow_ref, nsupr, nsupr1, p, pi, idx_r;
+	int_t  i, ii,jj, ik, il, ikcol, irow, j, lb, lk, rel, lib,lready;
+	int_t  *lsub, *lsub1, nlb1, lptr1, luptr1,*lloc;
+    int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
+    int_t  *frecv = Llu->frecv;
+    int_t  **fsendx_plist = Llu->fsendx_plist;
+	int_t  luptr_tmp,luptr_tmp1,lptr1_tmp,maxrecvsz, idx_i, idx_v,idx_n,  idx_l, fmod_tmp, lbstart,lbend,nn,Nchunk,nlb_loc,remainder;
+	int thread_id1;
+	int m;
+	flops_t ops_loc=0.0;
+    MPI_Status status;
+    int test_flag;
+	yes_no_t done;
+	BcTree  *LBtree_ptr = Llu->LBtree_ptr;
+	RdTree  *LRtree_ptr = Llu->LRtree_ptr;
+	int_t* idx_lsum,idx_lsum1;
+	float *rtemp_loc;
+	int_t ldalsum;
+	int_t nleaf_send_tmp;
+	int_t lptr;      /* Starting position in lsub[*].                      */
+	int_t luptr;     /* Starting position in lusup[*].                     */
+	int_t iword = sizeof(int_t);
+	int_t dword = sizeof (float);
+	int_t aln_d,aln_i;
+	aln_d = ceil(CACHELINE/(float)dword);
+	aln_i = ceil(CACHELINE/(float)iword);
+
+	ldalsum=Llu->ldalsum;
+
+	rtemp_loc = &rtemp[sizertemp* thread_id];
+
+	// #if ( PROFlevel>=1 )
+	double t1, t2, t3, t4;
+	float msg_vol = 0, msg_cnt = 0;
+	// #endif
+
+	if(nlb>0){
+
+		iam = grid->iam;
+		myrow = MYROW( iam, grid );
+		lk = LBj( k, grid ); /* Local block number, column-wise. */
+
+		// printf("ya1 %5d k %5d lk %5d\n",thread_id,k,lk);
+		// fflush(stdout);
+
+		lsub = Llu->Lrowind_bc_ptr[lk];
+
+		// printf("ya2 %5d k %5d lk %5d\n",thread_id,k,lk);
+		// fflush(stdout);
+
+		lusup = Llu->Lnzval_bc_ptr[lk];
+		lloc = Llu->Lindval_loc_bc_ptr[lk];
+		// idx_lsum = Llu->Lrowind_bc_2_lsum[lk];
+
+		nsupr = lsub[1];
+
+		// printf("nlb: %5d lk: %5d\n",nlb,lk);
+		// fflush(stdout);
+
+		krow = PROW( k, grid );
+		if(myrow==krow){
+			idx_n = 1;
+			idx_i = nlb+2;
+			idx_v = 2*nlb+3;
+			luptr_tmp = lloc[idx_v];
+			m = nsupr-knsupc;
+		}else{
+			idx_n = 0;
+			idx_i = nlb;
+			idx_v = 2*nlb;
+			luptr_tmp = lloc[idx_v];
+			m = nsupr;
+		}
+
+		assert(m>0);
+
+		if(m>4*maxsuper || nrhs>10){
+			// if(m<1){
+			// TIC(t1);
+			Nchunk=num_thread;
+			nlb_loc = floor(((float)nlb)/Nchunk);
+			remainder = nlb % Nchunk;
+
+#ifdef _OPENMP
+#pragma	omp	taskloop private (lptr1,luptr1,nlb1,thread_id1,lsub1,lusup1,nsupr1,Linv,nn,lbstart,lbend,luptr_tmp1,nbrow,lb,lptr1_tmp,rtemp_loc,nbrow_ref,lptr,nbrow1,ik,rel,lk,iknsupc,il,i,irow,fmod_tmp,ikcol,p,ii,jj,t1,t2,j) untied
+#endif
+			for (nn=0;nn<Nchunk;++nn){
+
+#ifdef _OPENMP
+				thread_id1 = omp_get_thread_num ();
+#else
+				thread_id1 = 0;
+#endif
+				rtemp_loc = &rtemp[sizertemp* thread_id1];
+
+				if(nn<remainder){
+					lbstart = nn*(nlb_loc+1);
+					lbend = (nn+1)*(nlb_loc+1);
+				}else{
+					lbstart = remainder+nn*nlb_loc;
+					lbend = remainder + (nn+1)*nlb_loc;
+				}
+
+				if(lbstart<lbend){
+
+#if ( PROFlevel>=1 )
+					TIC(t1);
+#endif
+					luptr_tmp1 = lloc[lbstart+idx_v];
+					nbrow=0;
+					for (lb = lbstart; lb < lbend; ++lb){
+						lptr1_tmp = lloc[lb+idx_i];
+						nbrow += lsub[lptr1_tmp+1];
+					}
+
+					if ( !sgemm_small(nbrow, nrhs, knsupc,
+					                  &lusup[luptr_tmp1], nsupr, xk, knsupc, rtemp_loc, nbrow) ) {
+				#ifdef _CRAY
+					SGEMM( ftcs2, ftcs2, &nbrow, &nrhs, &knsupc,
+						  &alpha, &lusup[luptr_tmp1], &nsupr, xk,
+						  &knsupc, &beta, rtemp_loc, &nbrow );
+				#elif defined (USE_VENDOR_BLAS)
+					sgemm_( "N", "N", &nbrow, &nrhs, &knsupc,
+						   &alpha, &lusup[luptr_tmp1], &nsupr, xk,
+						   &knsupc, &beta, rtemp_loc, &nbrow, 1, 1 );
+				#else
+					sgemm_( "N", "N", &nbrow, &nrhs, &knsupc,
+						   &alpha, &lusup[luptr_tmp1], &nsupr, xk,
+						   &knsupc, &beta, rtemp_loc, &nbrow );
+				#endif
+					}
+
+					nbrow_ref=0;
+					for (lb = lbstart; lb < lbend; ++lb){
+						lptr1_tmp = lloc[lb+idx_i];
+						lptr= lptr1_tmp+2;
+						nbrow1 = lsub[lptr1_tmp+1];
+						ik = lsub[lptr1_tmp]; /* Global block number, row-wise. */
+						rel = xsup[ik]; /* Global row index of block ik. */
+
+						lk = LBi( ik, grid ); /* Local block number, row-wise. */
+
+						iknsupc = SuperSize( ik );
+						il = LSUM_BLK( lk );
+
+						if ( Llu->lsum_shared ) {
+							slsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1, &lsub[lptr],
+									   rel, &rtemp_loc[nbrow_ref], nbrow);
+						} else {
+							RHS_ITERATE(j)
+								#ifdef _OPENMP
+									#pragma omp simd lastprivate(irow)
+								#endif
+								for (i = 0; i < nbrow1; ++i) {
+									irow = lsub[lptr+i] - rel; /* Relative row. */
+									lsum[il+irow + j*iknsupc] -= rtemp_loc[nbrow_ref+i + j*nbrow];
+								}
+						}
+						nbrow_ref+=nbrow1;
+					}
+
+#if ( PROFlevel>=1 )
+					TOC(t2, t1);
+					stat[thread_id1]->utime[SOL_GEMM] += t2;
+#endif
+			}
+		}
+
+		}else{
+
+#if ( PROFlevel>=1 )
+			TIC(t1);
+#endif
+
+			if ( !sgemm_small(m, nrhs, knsupc,
+			                  &lusup[luptr_tmp], nsupr, xk, knsupc, rtemp_loc, m) ) {
+#ifdef _CRAY
+			SGEMM( ftcs2, ftcs2, &m, &nrhs, &knsupc,
+					&alpha, &lusup[luptr_tmp], &nsupr, xk,
+					&knsupc, &beta, rtemp_loc, &m );
+#elif defined (USE_VENDOR_BLAS)
+			sgemm_( "N", "N", &m, &nrhs, &knsupc,
+					&alpha, &lusup[luptr_tmp], &nsupr, xk,
+					&knsupc, &beta, rtemp_loc, &m, 1, 1 );
+#else
+			sgemm_( "N", "N", &m, &nrhs, &knsupc,
+					&alpha, &lusup[luptr_tmp], &nsupr, xk,
+					&knsupc, &beta, rtemp_loc, &m );
+#endif
+			}
+
+			nbrow=0;
+			for (lb = 0; lb < nlb; ++lb){
+				lptr1_tmp = lloc[lb+idx_i];
+				nbrow += lsub[lptr1_tmp+1];
+			}
+			nbrow_ref=0;
+			for (lb = 0; lb < nlb; ++lb){
+				lptr1_tmp = lloc[lb+idx_i];
+				lptr= lptr1_tmp+2;
+				nbrow1 = lsub[lptr1_tmp+1];
+				ik = lsub[lptr1_tmp]; /* Global block number, row-wise. */
+				rel = xsup[ik]; /* Global row index of block ik. */
+
+				lk = LBi( ik, grid ); /* Local block number, row-wise. */
+
+				iknsupc = SuperSize( ik );
+				il = LSUM_BLK( lk );
+
+				if ( Llu->lsum_shared ) {
+					slsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1, &lsub[lptr],
+							   rel, &rtemp_loc[nbrow_ref], nbrow);
+				} else {
+					RHS_ITERATE(j)
+						#ifdef _OPENMP
+							#pragma omp simd lastprivate(irow)
+						#endif
+						for (i = 0; i < nbrow1; ++i) {
+							irow = lsub[lptr+i] - rel; /* Relative row. */
+
+									lsum[il+irow + j*iknsupc+LSUM_COPY(thread_id)] -= rtemp_loc[nbrow_ref+i + j*nbrow];
+						}
+				}
+				nbrow_ref+=nbrow1;
+			}
+#if ( PROFlevel>=1 )
+			TOC(t2, t1);
+			stat[thread_id]->utime[SOL_GEMM] += t2;
+#endif
+		}
+			// TOC(t3, t1);
+		rtemp_loc = &rtemp[sizertemp* thread_id];
+
+		for (lb=0;lb<nlb;lb++){
+			lk = lloc[lb+idx_n];
+
+			// #ifdef _OPENMP
+			// #pragma omp atomic capture
+			// #endif
+			fmod_tmp=--fmod[lk*aln_i];
+
+
+			if ( fmod_tmp==0 ) { /* Local accumulation done. */
+				// --fmod[lk];
+
+
+				lptr1_tmp = lloc[lb+idx_i];
+				// luptr_tmp = lloc[lb+idx_v];
+
+				ik = lsub[lptr1_tmp]; /* Global block number, row-wise. */
+				lk = LBi( ik, grid ); /* Local block number, row-wise. */
+
+				iknsupc = SuperSize( ik );
+				il = LSUM_BLK( lk );
+
+				// nbrow = lsub[lptr1_tmp+1];
+
+				ikcol = PCOL( ik, grid );
+				p = PNUM( myrow, ikcol, grid );
+				if ( iam != p ) {
+					// if(frecv[lk]==0){
+					// fmod[lk] = -1;
+
+					for (ii=1;ii<LSUM_NCOPY;ii++)
+						// if(ii!=thread_id)
+						#ifdef _OPENMP
+							#pragma omp simd
+						#endif
+						for (jj=0;jj<iknsupc*nrhs;jj++)
+							lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+					RdTree_forwardMessageSimple(LRtree_ptr[lk],&lsum[il - LSUM_H ],RdTree_GetMsgSize(LRtree_ptr[lk],'s')*nrhs+LSUM_H,'s');
+					// }
+
+
+				} else { /* Diagonal process: X[i] += lsum[i]. */
+
+
+
+					// if ( frecv[lk]==0 ) { /* Becomes a leaf node. */
+
+#if ( PROFlevel>=1 )
+					TIC(t1);
+#endif
+					for (ii=1;ii<LSUM_NCOPY;ii++)
+						// if(ii!=thread_id)
+						#ifdef _OPENMP
+							#pragma omp simd
+						#endif
+						for (jj=0;jj<iknsupc*nrhs;jj++)
+							lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+					ii = X_BLK( lk );
+					// for (jj=0;jj<num_thread;jj++)
+					RHS_ITERATE(j)
+						#ifdef _OPENMP
+							#pragma omp simd
+						#endif
+						for (i = 0; i < iknsupc; ++i)
+							x[i + ii + j*iknsupc] += lsum[i + il + j*iknsupc ];
+
+					// fmod[lk] = -1; /* Do not solve X[k] in the future. */
+					lk = LBj( ik, grid );/* Local block number, column-wise. */
+					lsub1 = Llu->Lrowind_bc_ptr[lk];
+					lusup1 = Llu->Lnzval_bc_ptr[lk];
+					nsupr1 = lsub1[1];
+
+					if(Llu->inv == 1 && Llu->Linv_bc_ptr[lk]){
+						Linv = Llu->Linv_bc_ptr[lk];
+						if ( !sgemm_small(iknsupc, nrhs, iknsupc,
+						                  Linv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
+#ifdef _CRAY
+						SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
+								&alpha, Linv, &iknsupc, &x[ii],
+								&iknsupc, &beta, rtemp_loc, &iknsupc );
+#elif defined (USE_VENDOR_BLAS)
+						sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+								&alpha, Linv, &iknsupc, &x[ii],
+								&iknsupc, &beta, rtemp_loc, &iknsupc, 1, 1 );
+#else
+						sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+								&alpha, Linv, &iknsupc, &x[ii],
+								&iknsupc, &beta, rtemp_loc, &iknsupc );
+#endif
+						}
+						#ifdef _OPENMP
+							#pragma omp simd
+						#endif
+						for (i=0 ; i<iknsupc*nrhs ; i++){
+							x[ii+i] = rtemp_loc[i];
+						}
+					}else{
+						if ( !strsm_small('L', iknsupc, nrhs,
+						                  lusup1, nsupr1, &x[ii], iknsupc) ) {
+#ifdef _CRAY
+						STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &iknsupc, &nrhs, &alpha,
+								lusup1, &nsupr1, &x[ii], &iknsupc);
+#elif defined (USE_VENDOR_BLAS)
+						strsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
+								lusup1, &nsupr1, &x[ii], &iknsupc, 1, 1, 1, 1);
+#else
+						strsm_("L", "L", "N", "U", &iknsupc, &nrhs, &alpha,
+								lusup1, &nsupr1, &x[ii], &iknsupc);
+#endif
+						}
+					}
+
+#if ( PROFlevel>=1 )
+					TOC(t2, t1);
+					stat[thread_id]->utime[SOL_TRSM] += t2;
+
+#endif
+
+					stat[thread_id]->ops[SOLVE] += iknsupc * (iknsupc - 1) * nrhs;
+					SOLVE_STAMP(Llu->sol_tdone, ik);
+
+#if ( DEBUGlevel>=2 )
+					printf("(%2d) Solve X[%2d]\n", iam, ik);
+#endif
+
+					/*
+					 * Send Xk to process column Pc[k].
+					 */
+
+					if(LBtree_ptr[lk]!=NULL)
+						BcTree_forwardMessageSimple(LBtree_ptr[lk],&x[ii - XK_H],BcTree_GetMsgSize(LBtree_ptr[lk],'s')*nrhs+XK_H,'s');
+
+					/*
+					 * Perform local block modifications.
+					 */
+
+					// #ifdef _OPENMP
+					// #pragma	omp	task firstprivate (Llu,sizelsum,iknsupc,ii,ik,lsub1,x,rtemp,fmod,lsum,stat,nrhs,grid,xsup,recurlevel) private(lptr1,luptr1,nlb1,thread_id1) untied priority(1)
+					// #endif
+					{
+						nlb1 = lsub1[0] - 1;
+
+
+						slsum_fmod_inv_master(lsum, x, &x[ii], rtemp, nrhs, iknsupc, ik,
+								fmod, nlb1, xsup,
+								grid, Llu, stat,sizelsum,sizertemp,1+recurlevel,maxsuper,thread_id,num_thread);
+					}
+
+					// } /* if frecv[lk] == 0 */
+				} /* if iam == p */
+			} /* if fmod[lk] == 0 */
+		}
+		// }
+		stat[thread_id]->ops[SOLVE] += 2 * m * nrhs * knsupc;
+	} /* if nlb>0*/
+} /* sLSUM_FMOD_INV */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform dest -= U_i,k * X[k] for one block U_i,k, for all the
+ *   right-hand sides. The block is stored by column segments: column jj
+ *   has nonzeros in rows usub[jj], ..., iklrow-1.
+ *
+ *   With nrhs < BMOD_GEMM_NRHS the segments are applied one AXPY at a
+ *   time for each right-hand side. Otherwise the block is expanded into
+ *   a dense matrix in work[] (padded with zeros above the segments) and
+ *   applied to all the right-hand sides with a single GEMM. The AXPY
+ *   loop is kept when the dense block does not fit in work[].
+ *
+ *   If the threads share lsum[] (shared != 0), dest is updated with
+ *   atomic subtractions; the GEMM then goes to work[] after the dense
+ *   block, which must also fit.
+ * </pre>
+ */
+static void slsum_bmod_blk
+/************************************************************************/
+(
+ float *dest,    /* lsum[] of block i, leading dimension iknsupc.      */
+ float *xk,      /* X[k], leading dimension knsupc.                    */
+ int    nrhs,     /* Number of right-hand sides.                        */
+ int    knsupc,   /* Size of supernode k.                               */
+ int_t  *usub,    /* First nonzero row of each column of the block.     */
+ float *uval,    /* Nonzeros of the block, column by column.           */
+ int_t  ikfrow,   /* First row of supernode i.                          */
+ int_t  iklrow,   /* First row of supernode i+1.                        */
+ float *work,    /* Workspace for the dense block.                     */
+ int_t  lwork,    /* Size of work[].                                    */
+ flops_t *ops,    /* Flop count of the solve.                           */
+ int    shared    /* lsum[] is shared by the threads.                   */
+ )
+{
+    float alpha = -1.0, beta = 1.0, one = 1.0, zero = 0.0, t;
+    int    iknsupc = iklrow - ikfrow, nrow;
+    int_t  fnz, fnzmin = iklrow, irow, j, jj, uptr;
+    float *y, *dst;
+
+    for (jj = 0; jj < knsupc; ++jj) fnzmin = SUPERLU_MIN(fnzmin, usub[jj]);
+    if ( fnzmin == iklrow ) return; /* Empty block. */
+    nrow = iklrow - fnzmin;
+
+    if ( nrhs < BMOD_GEMM_NRHS
+	 || (int_t) nrow * (knsupc + (shared ? nrhs : 0)) > lwork ) {
+	RHS_ITERATE(j) {
+	    dst = &dest[j*iknsupc];
+	    y = &xk[j*knsupc];
+	    uptr = 0;
+	    for (jj = 0; jj < knsupc; ++jj) {
+		fnz = usub[jj];
+		if ( fnz < iklrow ) { /* Nonzero segment. */
+		    /* AXPY */
+		    if ( shared ) {
+			for (irow = fnz; irow < iklrow; ++irow) {
+			    t = uval[uptr++] * y[jj];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+			    dst[irow - ikfrow] -= t;
+			}
+		    } else {
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+			for (irow = fnz; irow < iklrow; ++irow)
+			    dst[irow - ikfrow] -= uval[uptr++] * y[jj];
+		    }
+		    *ops += 2 * (iklrow - fnz);
+		}
+	    } /* for jj ... */
+	}
+	return;
+    }
+
+    /* Expand the block into rows fnzmin:iklrow-1 of a dense matrix. */
+    uptr = 0;
+    for (jj = 0; jj < knsupc; ++jj) {
+	fnz = usub[jj];
+	y = &work[jj*nrow];
+	for (irow = fnzmin; irow < fnz; ++irow) y[irow - fnzmin] = 0.0;
+	for (irow = fnz; irow < iklrow; ++irow) y[irow - fnzmin] = uval[uptr++];
+	*ops += 2 * (iklrow - fnz) * nrhs;
+    }
+
+    dst = &dest[fnzmin - ikfrow];
+    if ( shared ) {
+	/* Y = U_i,k * X[k] in work[], subtracted from dest atomically. */
+	y = &work[nrow * knsupc];
+#ifdef _CRAY
+	SGEMM( ftcs2, ftcs2, &nrow, &nrhs, &knsupc,
+	       &one, work, &nrow, xk, &knsupc, &zero, y, &nrow );
+#elif defined (USE_VENDOR_BLAS)
+	sgemm_( "N", "N", &nrow, &nrhs, &knsupc,
+		&one, work, &nrow, xk, &knsupc, &zero, y, &nrow, 1, 1 );
+#else
+	sgemm_( "N", "N", &nrow, &nrhs, &knsupc,
+		&one, work, &nrow, xk, &knsupc, &zero, y, &nrow );
+#endif
+	slsum_sub_atomic(dst, iknsupc, nrhs, nrow, NULL, 0, y, nrow);
+	return;
+    }
+    if ( !sgemm_small_sub(nrow, nrhs, knsupc,
+                          work, nrow, xk, knsupc, dst, iknsupc) ) {
+#ifdef _CRAY
+    SGEMM( ftcs2, ftcs2, &nrow, &nrhs, &knsupc,
+	   &alpha, work, &nrow, xk, &knsupc, &beta, dst, &iknsupc );
+#elif defined (USE_VENDOR_BLAS)
+    sgemm_( "N", "N", &nrow, &nrhs, &knsupc,
+	    &alpha, work, &nrow, xk, &knsupc, &beta, dst, &iknsupc, 1, 1 );
+#else
+    sgemm_( "N", "N", &nrow, &nrhs, &knsupc,
+	    &alpha, work, &nrow, xk, &knsupc, &beta, dst, &iknsupc );
+#endif
+    }
+} /* slsum_bmod_blk */
+
+
+/************************************************************************/
+void slsum_bmod_inv
+/************************************************************************/
+(
+ float *lsum,        /* Sum of local modifications.                    */
+ float *x,           /* X array (local).                               */
+ float *xk,          /* X[k].                                          */
+ float *rtemp,   /* Result of full matrix-vector multiply.             */
+ int    nrhs,	      /* Number of right-hand sides.                    */
+ int_t  k,            /* The k-th component of X.                       */
+ int_t  *bmod,        /* Modification count for L-solve.                */
+ int_t  *Urbs,        /* Number of row blocks in each block column of U.*/
+ Ucb_indptr_t **Ucb_indptr,/* Vertical linked list pointing to Uindex[].*/
+ int_t  **Ucb_valptr, /* Vertical linked list pointing to Unzval[].     */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ SuperLUStat_t **stat,
+ int_t* root_send,
+ int_t* nroot_send,
+ int_t sizelsum,
+ int_t sizertemp,
+ int thread_id,
+ int num_thread
+ )
+{
+	/*
+	 * Purpose
+	 * =======
+	 *   Perform local block modifications: lsum[i] -= U_i,k * X[k].
+	 */
+    float alpha = 1.0, beta = 0.0;
+	int    iam, iknsupc, knsupc, myrow, nsupr, p, pi;
+	int_t  gik, gikcol, i, ii, ik, ikfrow, iklrow, il,
+	       j, jj, lk, lk1, nub, ub, uptr;
+	int_t  *usub;
+	float *uval, *dest;
+	int_t  *lsub;
+	float *lusup;
+	int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
+	int_t  *brecv = Llu->brecv;
+	int_t  **bsendx_plist = Llu->bsendx_plist;
+	BcTree  *UBtree_ptr = Llu->UBtree_ptr;
+	RdTree  *URtree_ptr = Llu->URtree_ptr;
+	MPI_Status status;
+	int test_flag;
+	int_t bmod_tmp;
+	int thread_id1;
+	float *rtemp_loc;
+	int_t nroot_send_tmp;
+	float *Uinv;/* Inverse of diagonal block */
+	float temp;
+	double t1, t2;
+	float msg_vol = 0, msg_cnt = 0;
+	int_t Nchunk, nub_loc,remainder,nn,lbstart,lbend;
+	int_t iword = sizeof(int_t);
+	int_t dword = sizeof (float);
+	int_t aln_d,aln_i;
+	aln_d = ceil(CACHELINE/(float)dword);
+	aln_i = ceil(CACHELINE/(float)iword);
+
+
+	iam = grid->iam;
+	myrow = MYROW( iam, grid );
+	knsupc = SuperSize( k );
+	lk = LBj( k, grid ); /* Local block number, column-wise. */
+	nub = Urbs[lk];      /* Number of U blocks in block column lk */
+
+	if(Llu->Unnz[lk]>knsupc*64 || nub>16){
+	// if(nub>num_thread){
+	// if(nub>16){
+	// // // // if(Urbs2[lk]>num_thread){
+	// if(Urbs2[lk]>0){
+		Nchunk=SUPERLU_MIN(num_thread,nub);
+		nub_loc = floor(((float)nub)/Nchunk);
+		remainder = nub % Nchunk;
+		// printf("Unnz: %5d nub: %5d knsupc: %5d\n",Llu->Unnz[lk],nub,knsupc);
+#ifdef _OPENMP
+#pragma	omp	taskloop firstprivate (stat) private (thread_id1,Uinv,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,lk1,gik,gikcol,usub,uval,lsub,lusup,iknsupc,il,i,bmod_tmp,p,ii,jj,t1,t2,j,ikfrow,iklrow,dest,uptr,nsupr) untied nogroup
+#endif
+		for (nn=0;nn<Nchunk;++nn){
+
+#ifdef _OPENMP
+			thread_id1 = omp_get_thread_num ();
+#else
+			thread_id1 = 0;
+#endif
+			rtemp_loc = &rtemp[sizertemp* thread_id1];
+
+			if(nn<remainder){
+				lbstart = nn*(nub_loc+1);
+				lbend = (nn+1)*(nub_loc+1);
+			}else{
+				lbstart = remainder+nn*nub_loc;
+				lbend = remainder + (nn+1)*nub_loc;
+			}
+			for (ub = lbstart; ub < lbend; ++ub){
+				ik = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
+				usub = Llu->Ufstnz_br_ptr[ik];
+				uval = Llu->Unzval_br_ptr[ik];
+				i = Ucb_indptr[lk][ub].indpos; /* Start of the block in usub[]. */
+				i += UB_DESCRIPTOR;
+				il = LSUM_BLK( ik );
+				gik = ik * grid->nprow + myrow;/* Global block number, row-wise. */
+				iknsupc = SuperSize( gik );
+				ikfrow = FstBlockC( gik );
+				iklrow = FstBlockC( gik+1 );
+
+#if ( PROFlevel>=1 )
+				TIC(t1);
+#endif
+
+				uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
+				slsum_bmod_blk(&lsum[il+LSUM_COPY(thread_id1)], xk, nrhs, knsupc,
+						&usub[i], &uval[uptr], ikfrow, iklrow,
+						rtemp_loc, sizertemp, &stat[thread_id1]->ops[SOLVE],
+						Llu->lsum_shared);
+
+#if ( PROFlevel>=1 )
+				TOC(t2, t1);
+				stat[thread_id1]->utime[SOL_GEMM] += t2;
+#endif
+
+
+		#ifdef _OPENMP
+		#pragma omp atomic capture
+		#endif
+				bmod_tmp=--bmod[ik*aln_i];
+
+				if ( bmod_tmp == 0 ) { /* Local accumulation done. */
+					gikcol = PCOL( gik, grid );
+					p = PNUM( myrow, gikcol, grid );
+					if ( iam != p ) {
+						for (ii=1;ii<LSUM_NCOPY;ii++)
+							// if(ii!=thread_id1)
+							#ifdef _OPENMP
+							#pragma omp simd
+							#endif
+							for (jj=0;jj<iknsupc*nrhs;jj++)
+								lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+						nroot_send_tmp = ++nroot_send[0];
+						root_send[(nroot_send_tmp-1)*aln_i] = -ik-1;
+						// RdTree_forwardMessageSimple(URtree_ptr[ik],&lsum[il - LSUM_H ],'s');
+
+		#if ( DEBUGlevel>=2 )
+						printf("(%2d) Sent LSUM[%2.0f], size %2d, to P %2d\n",
+								iam, lsum[il-LSUM_H], iknsupc*nrhs+LSUM_H, p);
+		#endif
+					} else { /* Diagonal process: X[i] += lsum[i]. */
+
+#if ( PROFlevel>=1 )
+						TIC(t1);
+#endif
+
+						for (ii=1;ii<LSUM_NCOPY;ii++)
+							// if(ii!=thread_id1)
+							#ifdef _OPENMP
+							#pragma omp simd
+							#endif
+							for (jj=0;jj<iknsupc*nrhs;jj++)
+								lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+						ii = X_BLK( ik );
+						dest = &x[ii];
+
+						RHS_ITERATE(j)
+							#ifdef _OPENMP
+							#pragma omp simd
+							#endif
+							for (i = 0; i < iknsupc; ++i)
+							    dest[i + j*iknsupc] += lsum[i + il + j*iknsupc];
+
+						// if ( !brecv[ik] ) { /* Becomes a leaf node. */
+							// bmod[ik] = -1; /* Do not solve X[k] in the future. */
+							lk1 = LBj( gik, grid ); /* Local block number. */
+							lsub = Llu->Lrowind_bc_ptr[lk1];
+							lusup = Llu->Lnzval_bc_ptr[lk1];
+							nsupr = lsub[1];
+
+							if(Llu->inv == 1 && Llu->Uinv_bc_ptr[lk1]){
+								Uinv = Llu->Uinv_bc_ptr[lk1];
+								if ( !sgemm_small(iknsupc, nrhs, iknsupc,
+								                  Uinv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
+		#ifdef _CRAY
+								SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
+										&alpha, Uinv, &iknsupc, &x[ii],
+										&iknsupc, &beta, rtemp_loc, &iknsupc );
+		#elif defined (USE_VENDOR_BLAS)
+								sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+										&alpha, Uinv, &iknsupc, &x[ii],
+										&iknsupc, &beta, rtemp_loc, &iknsupc, 1, 1 );
+		#else
+								sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+										&alpha, Uinv, &iknsupc, &x[ii],
+										&iknsupc, &beta, rtemp_loc, &iknsupc );
+		#endif
+								}
+								#ifdef _OPENMP
+								#pragma omp simd
+								#endif
+								for (i=0 ; i<iknsupc*nrhs ; i++){
+									x[ii+i] = rtemp_loc[i];
+								}
+							}else{
+								if ( !strsm_small('U', iknsupc, nrhs,
+								                  lusup, nsupr, &x[ii], iknsupc) ) {
+		#ifdef _CRAY
+								STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &iknsupc, &nrhs, &alpha,
+										lusup, &nsupr, &x[ii], &iknsupc);
+		#elif defined (USE_VENDOR_BLAS)
+								strsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
+										lusup, &nsupr, &x[ii], &iknsupc, 1, 1, 1, 1);
+		#else
+								strsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
+										lusup, &nsupr, &x[ii], &iknsupc);
+		#endif
+								}
+							}
+
+		#if ( PROFlevel>=1 )
+							TOC(t2, t1);
+							stat[thread_id1]->utime[SOL_TRSM] += t2;
+		#endif
+							stat[thread_id1]->ops[SOLVE] += iknsupc * (iknsupc + 1) * nrhs;
+							SOLVE_STAMP(Llu->sol_tdone, gik);
+
+		#if ( DEBUGlevel>=2 )
+							printf("(%2d) Solve X[%2d]\n", iam, gik);
+		#endif
+
+							/*
+							 * Send Xk to process column Pc[k].
+							 */
+
+							 // for (i=0 ; i<iknsupc*nrhs ; i++){
+								// printf("xre: %f\n",x[ii+i]);
+								// fflush(stdout);
+							// }
+							if(UBtree_ptr[lk1]!=NULL){
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+							nroot_send_tmp = ++nroot_send[0];
+							root_send[(nroot_send_tmp-1)*aln_i] = lk1;
+							// BcTree_forwardMessageSimple(UBtree_ptr[lk1],&x[ii - XK_H],'s');
+							}
+
+							/*
+							 * Perform local block modifications.
+							 */
+							if ( Urbs[lk1] ){
+								// #ifdef _OPENMP
+								// #pragma	omp	task firstprivate (Ucb_indptr,Ucb_valptr,Llu,sizelsum,ii,gik,x,rtemp,bmod,Urbs,lsum,stat,nrhs,grid,xsup) untied
+								// #endif
+								{
+								slsum_bmod_inv(lsum, x, &x[ii], rtemp, nrhs, gik, bmod, Urbs,
+										Ucb_indptr, Ucb_valptr, xsup, grid, Llu,
+										stat, root_send, nroot_send, sizelsum,sizertemp,thread_id1,num_thread);
+								}
+							}
+						// } /* if brecv[ik] == 0 */
+					}
+				} /* if bmod[ik] == 0 */
+			}
+		}
+
+	} else {
+
+		rtemp_loc = &rtemp[sizertemp* thread_id];
+
+		for (ub = 0; ub < nub; ++ub) {
+			ik = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
+			usub = Llu->Ufstnz_br_ptr[ik];
+			uval = Llu->Unzval_br_ptr[ik];
+			i = Ucb_indptr[lk][ub].indpos; /* Start of the block in usub[]. */
+			i += UB_DESCRIPTOR;
+			il = LSUM_BLK( ik );
+			gik = ik * grid->nprow + myrow;/* Global block number, row-wise. */
+			iknsupc = SuperSize( gik );
+			ikfrow = FstBlockC( gik );
+			iklrow = FstBlockC( gik+1 );
+
+#if ( PROFlevel>=1 )
+		TIC(t1);
+#endif
+			uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
+			slsum_bmod_blk(&lsum[il+LSUM_COPY(thread_id)], xk, nrhs, knsupc,
+					&usub[i], &uval[uptr], ikfrow, iklrow,
+					rtemp_loc, sizertemp, &stat[thread_id]->ops[SOLVE],
+					Llu->lsum_shared);
+
+#if ( PROFlevel>=1 )
+		TOC(t2, t1);
+		stat[thread_id]->utime[SOL_GEMM] += t2;
+#endif
+
+	#ifdef _OPENMP
+	#pragma omp atomic capture
+	#endif
+			bmod_tmp=--bmod[ik*aln_i];
+
+			if ( bmod_tmp == 0 ) { /* Local accumulation done. */
+				gikcol = PCOL( gik, grid );
+				p = PNUM( myrow, gikcol, grid );
+				if ( iam != p ) {
+					for (ii=1;ii<LSUM_NCOPY;ii++)
+						// if(ii!=thread_id)
+						#ifdef _OPENMP
+						#pragma omp simd
+						#endif
+						for (jj=0;jj<iknsupc*nrhs;jj++)
+							lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+					nroot_send_tmp = ++nroot_send[0];
+					root_send[(nroot_send_tmp-1)*aln_i] = -ik-1;
+					// RdTree_forwardMessageSimple(URtree_ptr[ik],&lsum[il - LSUM_H ],'s');
+
+	#if ( DEBUGlevel>=2 )
+					printf("(%2d) Sent LSUM[%2.0f], size %2d, to P %2d\n",
+							iam, lsum[il-LSUM_H], iknsupc*nrhs+LSUM_H, p);
+	#endif
+				} else { /* Diagonal process: X[i] += lsum[i]. */
+
+#if ( PROFlevel>=1 )
+					TIC(t1);
+#endif
+
+					for (ii=1;ii<LSUM_NCOPY;ii++)
+						// if(ii!=thread_id)
+						#ifdef _OPENMP
+						#pragma omp simd
+						#endif
+						for (jj=0;jj<iknsupc*nrhs;jj++)
+								lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+					ii = X_BLK( ik );
+					dest = &x[ii];
+
+					RHS_ITERATE(j)
+						#ifdef _OPENMP
+						#pragma omp simd
+						#endif
+						for (i = 0; i < iknsupc; ++i)
+							dest[i + j*iknsupc] += lsum[i + il + j*iknsupc];
+
+					// if ( !brecv[ik] ) { /* Becomes a leaf node. */
+						// bmod[ik] = -1; /* Do not solve X[k] in the future. */
+						lk1 = LBj( gik, grid ); /* Local block number. */
+						lsub = Llu->Lrowind_bc_ptr[lk1];
+						lusup = Llu->Lnzval_bc_ptr[lk1];
+						nsupr = lsub[1];
+
+						if(Llu->inv == 1 && Llu->Uinv_bc_ptr[lk1]){
+							Uinv = Llu->Uinv_bc_ptr[lk1];
+							if ( !sgemm_small(iknsupc, nrhs, iknsupc,
+							                  Uinv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
+	#ifdef _CRAY
+							SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
+									&alpha, Uinv, &iknsupc, &x[ii],
+									&iknsupc, &beta, rtemp_loc, &iknsupc );
+	#elif defined (USE_VENDOR_BLAS)
+							sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+									&alpha, Uinv, &iknsupc, &x[ii],
+									&iknsupc, &beta, rtemp_loc, &iknsupc, 1, 1 );
+	#else
+							sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+									&alpha, Uinv, &iknsupc, &x[ii],
+									&iknsupc, &beta, rtemp_loc, &iknsupc );
+	#endif
+							}
+							#ifdef _OPENMP
+							#pragma omp simd
+							#endif
+							for (i=0 ; i<iknsupc*nrhs ; i++){
+								x[ii+i] = rtemp_loc[i];
+							}
+						}else{
+							if ( !strsm_small('U', iknsupc, nrhs,
+							                  lusup, nsupr, &x[ii], iknsupc) ) {
+	#ifdef _CRAY
+							STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &iknsupc, &nrhs, &alpha,
+									lusup, &nsupr, &x[ii], &iknsupc);
+	#elif defined (USE_VENDOR_BLAS)
+							strsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
+									lusup, &nsupr, &x[ii], &iknsupc, 1, 1, 1, 1);
+	#else
+							strsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
+									lusup, &nsupr, &x[ii], &iknsupc);
+	#endif
+							}
+						}
+
+	#if ( PROFlevel>=1 )
+						TOC(t2, t1);
+						stat[thread_id]->utime[SOL_TRSM] += t2;
+	#endif
+						stat[thread_id]->ops[SOLVE] += iknsupc * (iknsupc + 1) * nrhs;
+						SOLVE_STAMP(Llu->sol_tdone, gik);
+	#if ( DEBUGlevel>=2 )
+						printf("(%2d) Solve X[%2d]\n", iam, gik);
+	#endif
+
+						/*
+						 * Send Xk to process column Pc[k].
+						 */
+
+						 // for (i=0 ; i<iknsupc*nrhs ; i++){
+							// printf("xre: %f\n",x[ii+i]);
+							// fflush(stdout);
+						// }
+						if(UBtree_ptr[lk1]!=NULL){
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+						nroot_send_tmp = ++nroot_send[0];
+						root_send[(nroot_send_tmp-1)*aln_i] = lk1;
+						// BcTree_forwardMessageSimple(UBtree_ptr[lk1],&x[ii - XK_H],'s');
+						}
+
+						/*
+						 * Perform local block modifications.
+						 */
+						if ( Urbs[lk1] )
+
+							// if(Urbs[lk1]>16){
+							// #ifdef _OPENMP
+							// #pragma	omp	task firstprivate (Ucb_indptr,Ucb_valptr,Llu,sizelsum,ii,gik,x,rtemp,bmod,Urbs,lsum,stat,nrhs,grid,xsup) untied
+							// #endif
+							// 	slsum_bmod_inv(lsum, x, &x[ii], rtemp, nrhs, gik, bmod, Urbs,
+									//	Ucb_indptr, Ucb_valptr, xsup, grid, Llu,
+									//	stat, root_send, nroot_send, sizelsum,sizertemp);
+							//}else{
+								slsum_bmod_inv(lsum, x, &x[ii], rtemp, nrhs, gik, bmod, Urbs,
+										Ucb_indptr, Ucb_valptr, xsup, grid, Llu,
+										stat, root_send, nroot_send, sizelsum,sizertemp,thread_id,num_thread);
+							//}
+
+					// } /* if brecv[ik] == 0 */
+				}
+			} /* if bmod[ik] == 0 */
+
+		} /* for ub ... */
+	}
+
+} /* dlSUM_BMOD_inv */
+
+
+
+/************************************************************************/
+void slsum_bmod_inv_master
+/************************************************************************/
+(
+ float *lsum,        /* Sum of local modifications.                    */
+ float *x,           /* X array (local).                               */
+ float *xk,          /* X[k].                                          */
+ float *rtemp,   /* Result of full matrix-vector multiply.             */
+ int    nrhs,	      /* Number of right-hand sides.                    */
+ int_t  k,            /* The k-th component of X.                       */
+ int_t  *bmod,        /* Modification count for L-solve.                */
+ int_t  *Urbs,        /* Number of row blocks in each block column of U.*/
+ Ucb_indptr_t **Ucb_indptr,/* Vertical linked list pointing to Uindex[].*/
+ int_t  **Ucb_valptr, /* Vertical linked list pointing to Unzval[].     */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ SuperLUStat_t **stat,
+ int_t sizelsum,
+ int_t sizertemp,
+ int thread_id,
+ int num_thread
+ )
+{
+	/*
+	 * Purpose
+	 * =======
+	 *   Perform local block modifications: lsum[i] -= U_i,k * X[k].
+	 */
+    float alpha = 1.0, beta = 0.0;
+	int    iam, iknsupc, knsupc, myrow, nsupr, p, pi;
+	int_t  gik, gikcol, i, ii, ik, ikfrow, iklrow, il,
+	       j, jj, lk, lk1, nub, ub, uptr;
+	int_t  *usub;
+	float *uval, *dest;
+	int_t  *lsub;
+	float *lusup;
+	int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
+	int_t  *brecv = Llu->brecv;
+	int_t  **bsendx_plist = Llu->bsendx_plist;
+	BcTree  *UBtree_ptr = Llu->UBtree_ptr;
+	RdTree  *URtree_ptr = Llu->URtree_ptr;
+	MPI_Status status;
+	int test_flag;
+	int_t bmod_tmp;
+	int thread_id1;
+	float *rtemp_loc;
+	float temp;
+	float *Uinv;/* Inverse of diagonal block */
+
+	double t1, t2;
+	float msg_vol = 0, msg_cnt = 0;
+	int_t Nchunk, nub_loc,remainder,nn,lbstart,lbend;
+	int_t iword = sizeof(int_t);
+	int_t dword = sizeof (float);
+	int_t aln_d,aln_i;
+	aln_d = ceil(CACHELINE/(float)dword);
+	aln_i = ceil(CACHELINE/(float)iword);
+
+
+	rtemp_loc = &rtemp[sizertemp* thread_id];
+
+
+	iam = grid->iam;
+	myrow = MYROW( iam, grid );
+	knsupc = SuperSize( k );
+	lk = LBj( k, grid ); /* Local block number, column-wise. */
+	nub = Urbs[lk];      /* Number of U blocks in block column lk */
+
+	// printf("Urbs2[lk] %5d lk %5d nub %5d\n",Urbs2[lk],lk,nub);
+	// fflush(stdout);
+
+	if(nub>num_thread){
+	// if(nub>0){
+		Nchunk=num_thread;
+		nub_loc = floor(((float)nub)/Nchunk);
+		remainder = nub % Nchunk;
+
+//#ifdef _OPENMP
+//#pragma	omp	taskloop firstprivate (stat) private (thread_id1,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,gik,usub,uval,iknsupc,il,i,irow,jj,t1,t2,j,ikfrow,iklrow,dest,y,uptr,fnz) untied
+//#endif
+		for (nn=0;nn<Nchunk;++nn){
+
+#ifdef _OPENMP
+			thread_id1 = omp_get_thread_num ();
+#else
+			thread_id1 = 0;
+#endif
+			rtemp_loc = &rtemp[sizertemp* thread_id1];
+
+#if ( PROFlevel>=1 )
+			TIC(t1);
+#endif
+
+			if(nn<remainder){
+				lbstart = nn*(nub_loc+1);
+				lbend = (nn+1)*(nub_loc+1);
+			}else{
+				lbstart = remainder+nn*nub_loc;
+				lbend = remainder + (nn+1)*nub_loc;
+			}
+			for (ub = lbstart; ub < lbend; ++ub){
+				ik = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
+				usub = Llu->Ufstnz_br_ptr[ik];
+				uval = Llu->Unzval_br_ptr[ik];
+				i = Ucb_indptr[lk][ub].indpos; /* Start of the block in usub[]. */
+				i += UB_DESCRIPTOR;
+				il = LSUM_BLK( ik );
+				gik = ik * grid->nprow + myrow;/* Global block number, row-wise. */
+				iknsupc = SuperSize( gik );
+				ikfrow = FstBlockC( gik );
+				iklrow = FstBlockC( gik+1 );
+
+				uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
+				slsum_bmod_blk(&lsum[il+LSUM_COPY(thread_id1)], xk, nrhs, knsupc,
+						&usub[i], &uval[uptr], ikfrow, iklrow,
+						rtemp_loc, sizertemp, &stat[thread_id1]->ops[SOLVE],
+						Llu->lsum_shared);
+			}
+#if ( PROFlevel>=1 )
+			TOC(t2, t1);
+			stat[thread_id1]->utime[SOL_GEMM] += t2;
+#endif
+		}
+
+	}else{
+		rtemp_loc = &rtemp[sizertemp* thread_id];
+#if ( PROFlevel>=1 )
+		TIC(t1);
+#endif
+		for (ub = 0; ub < nub; ++ub) {
+			ik = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
+			usub = Llu->Ufstnz_br_ptr[ik];
+			uval = Llu->Unzval_br_ptr[ik];
+			i = Ucb_indptr[lk][ub].indpos; /* Start of the block in usub[]. */
+			i += UB_DESCRIPTOR;
+			il = LSUM_BLK( ik );
+			gik = ik * grid->nprow + myrow;/* Global block number, row-wise. */
+			iknsupc = SuperSize( gik );
+			ikfrow = FstBlockC( gik );
+			iklrow = FstBlockC( gik+1 );
+
+			uptr = Ucb_valptr[lk][ub]; /* Start of the block in uval[]. */
+			slsum_bmod_blk(&lsum[il+LSUM_COPY(thread_id)], xk, nrhs, knsupc,
+					&usub[i], &uval[uptr], ikfrow, iklrow,
+					rtemp_loc, sizertemp, &stat[thread_id]->ops[SOLVE],
+					Llu->lsum_shared);
+		}
+#if ( PROFlevel>=1 )
+		TOC(t2, t1);
+		stat[thread_id]->utime[SOL_GEMM] += t2;
+#endif
+	}
+
+
+	rtemp_loc = &rtemp[sizertemp* thread_id];
+	for (ub = 0; ub < nub; ++ub){
+		ik = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
+		il = LSUM_BLK( ik );
+		gik = ik * grid->nprow + myrow;/* Global block number, row-wise. */
+		iknsupc = SuperSize( gik );
+
+	// #ifdef _OPENMP
+	// #pragma omp atomic capture
+	// #endif
+		bmod_tmp=--bmod[ik*aln_i];
+
+		if ( bmod_tmp == 0 ) { /* Local accumulation done. */
+			gikcol = PCOL( gik, grid );
+			p = PNUM( myrow, gikcol, grid );
+			if ( iam != p ) {
+				for (ii=1;ii<LSUM_NCOPY;ii++)
+					// if(ii!=thread_id)
+					#ifdef _OPENMP
+					#pragma omp simd
+					#endif
+					for (jj=0;jj<iknsupc*nrhs;jj++)
+						lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+				RdTree_forwardMessageSimple(URtree_ptr[ik],&lsum[il - LSUM_H ],RdTree_GetMsgSize(URtree_ptr[ik],'s')*nrhs+LSUM_H,'s');
+
+#if ( DEBUGlevel>=2 )
+				printf("(%2d) Sent LSUM[%2.0f], size %2d, to P %2d\n",
+						iam, lsum[il-LSUM_H], iknsupc*nrhs+LSUM_H, p);
+#endif
+			} else { /* Diagonal process: X[i] += lsum[i]. */
+
+#if ( PROFlevel>=1 )
+				TIC(t1);
+#endif
+				for (ii=1;ii<LSUM_NCOPY;ii++)
+					// if(ii!=thread_id)
+					#ifdef _OPENMP
+					#pragma omp simd
+					#endif
+					for (jj=0;jj<iknsupc*nrhs;jj++)
+						lsum[il + jj ] += lsum[il + jj + ii*sizelsum];
+
+				ii = X_BLK( ik );
+				dest = &x[ii];
+
+				RHS_ITERATE(j)
+					#ifdef _OPENMP
+					#pragma omp simd
+					#endif
+					for (i = 0; i < iknsupc; ++i)
+						dest[i + j*iknsupc] += lsum[i + il + j*iknsupc];
+
+				// if ( !brecv[ik] ) { /* Becomes a leaf node. */
+					// bmod[ik] = -1; /* Do not solve X[k] in the future. */
+					lk1 = LBj( gik, grid ); /* Local block number. */
+					lsub = Llu->Lrowind_bc_ptr[lk1];
+					lusup = Llu->Lnzval_bc_ptr[lk1];
+					nsupr = lsub[1];
+
+					if(Llu->inv == 1 && Llu->Uinv_bc_ptr[lk1]){
+						Uinv = Llu->Uinv_bc_ptr[lk1];
+						if ( !sgemm_small(iknsupc, nrhs, iknsupc,
+						                  Uinv, iknsupc, &x[ii], iknsupc, rtemp_loc, iknsupc) ) {
+#ifdef _CRAY
+						SGEMM( ftcs2, ftcs2, &iknsupc, &nrhs, &iknsupc,
+								&alpha, Uinv, &iknsupc, &x[ii],
+								&iknsupc, &beta, rtemp_loc, &iknsupc );
+#elif defined (USE_VENDOR_BLAS)
+						sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+								&alpha, Uinv, &iknsupc, &x[ii],
+								&iknsupc, &beta, rtemp_loc, &iknsupc, 1, 1 );
+#else
+						sgemm_( "N", "N", &iknsupc, &nrhs, &iknsupc,
+								&alpha, Uinv, &iknsupc, &x[ii],
+								&iknsupc, &beta, rtemp_loc, &iknsupc );
+#endif
+						}
+						#ifdef _OPENMP
+						#pragma omp simd
+						#endif
+						for (i=0 ; i<iknsupc*nrhs ; i++){
+							x[ii+i] = rtemp_loc[i];
+						}
+					}else{
+						if ( !strsm_small('U', iknsupc, nrhs,
+						                  lusup, nsupr, &x[ii], iknsupc) ) {
+#ifdef _CRAY
+						STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &iknsupc, &nrhs, &alpha,
+								lusup, &nsupr, &x[ii], &iknsupc);
+#elif defined (USE_VENDOR_BLAS)
+						strsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
+								lusup, &nsupr, &x[ii], &iknsupc, 1, 1, 1, 1);
+#else
+						strsm_("L", "U", "N", "N", &iknsupc, &nrhs, &alpha,
+								lusup, &nsupr, &x[ii], &iknsupc);
+#endif
+						}
+					}
+
+#if ( PROFlevel>=1 )
+					TOC(t2, t1);
+					stat[thread_id]->utime[SOL_TRSM] += t2;
+#endif
+					stat[thread_id]->ops[SOLVE] += iknsupc * (iknsupc + 1) * nrhs;
+					SOLVE_STAMP(Llu->sol_tdone, gik);
+#if ( DEBUGlevel>=2 )
+					printf("(%2d) Solve X[%2d]\n", iam, gik);
+#endif
+
+					/*
+					 * Send Xk to process column Pc[k].
+					 */
+
+					 // for (i=0 ; i<iknsupc*nrhs ; i++){
+						// printf("xre: %f\n",x[ii+i]);
+						// fflush(stdout);
+					// }
+					if(UBtree_ptr[lk1]!=NULL){
+					BcTree_forwardMessageSimple(UBtree_ptr[lk1],&x[ii - XK_H],BcTree_GetMsgSize(UBtree_ptr[lk1],'s')*nrhs+XK_H,'s');
+					}
+
+					/*
+					 * Perform local block modifications.
+					 */
+					if ( Urbs[lk1] ){
+						// #ifdef _OPENMP
+						// #pragma	omp	task firstprivate (Ucb_indptr,Ucb_valptr,Llu,sizelsum,ii,gik,x,rtemp,bmod,Urbs,lsum,stat,nrhs,grid,xsup) untied
+						// #endif
+						{
+						slsum_bmod_inv_master(lsum, x, &x[ii], rtemp, nrhs, gik, bmod, Urbs,
+								Ucb_indptr, Ucb_valptr, xsup, grid, Llu,
+								stat, sizelsum,sizertemp,thread_id,num_thread);
+						}
+					}
+				// } /* if brecv[ik] == 0 */
+			}
+		} /* if bmod[ik] == 0 */
+	}
+
+} /* slsum_bmod_inv_master */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform the L-solve of psgstrs on one process with all the threads,
+ *   without the recursive tasks of slsum_fmod_inv().
+ *
+ *   The supernodes are taken in the order of lvlsups[], the level sets of
+ *   the L-solve, each thread taking the next one with an atomic counter.
+ *   A thread waits until the count fmod[] of its supernode k drops to 0,
+ *   adds the partial sums of all the threads into X[k], solves with the
+ *   diagonal block, and subtracts L(i,k) * X[k] from its own copy of
+ *   lsum[i], decrementing fmod[i] atomically. As the supernodes that k
+ *   depends on are at lower levels, they are taken before k, so that the
+ *   threads never wait on a supernode that is not being solved.
+ * </pre>
+ */
+void slsum_fmod_levels
+/************************************************************************/
+(
+ float *lsum,    /* Sum of local modifications, one copy per thread.   */
+ float *x,       /* X array (local)                                    */
+ float *rtemp,   /* Workspace for the GEMM results, one per thread.    */
+ int    nrhs,     /* Number of right-hand sides.                        */
+ int_t  nsupers,  /* Number of supernodes.                              */
+ int_t  *fmod,    /* Modification count for L-solve.                    */
+ int_t  *lvlsups, /* The supernodes in the order of the level sets.     */
+ int    *active,  /* The supernodes solved, NULL for all of them.       */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ SuperLUStat_t **stat,
+ int_t  sizelsum,
+ int_t  sizertemp,
+ int    num_thread
+)
+{
+    int_t *ilsum = Llu->ilsum;
+    int_t aln_i = ceil(CACHELINE/(float)sizeof(int_t));
+    int_t next = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel default(shared)
+#endif
+    {
+	float alpha = 1.0, beta = 0.0;
+	float *lusup, *Linv, *rtemp_loc, *xk;
+	int_t  *lsub, *lloc;
+	int    knsupc, iknsupc, nsupr, m, nbrow1, thread_id = 0;
+	int_t  i, j, jj, k, t, ii, ik, il, irow, lb, lk, lkc, nlb, nbrow;
+	int_t  lptr, rel, fmod_tmp;
+
+#ifdef _OPENMP
+	thread_id = omp_get_thread_num();
+#endif
+	rtemp_loc = &rtemp[sizertemp * thread_id];
+
+	for (;;) {
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+	    jj = next++;
+	    if ( jj >= nsupers ) break;
+	    k = lvlsups[jj];
+	    if ( active && !active[k] ) continue; /* X[k] = 0 */
+	    lk = LBi( k, grid );   /* Local block number, row-wise. */
+	    lkc = LBj( k, grid );  /* Local block number, column-wise. */
+
+	    /* Wait for the modifications of X[k] by the lower levels. */
+	    do {
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+		fmod_tmp = fmod[lk*aln_i];
+	    } while ( fmod_tmp > 0 );
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+
+	    /* X[k] += lsum[k], summed over the threads. */
+	    knsupc = SuperSize( k );
+	    il = LSUM_BLK( lk );
+	    ii = X_BLK( lk );
+	    xk = &x[ii];
+	    for (t = 0; t < LSUM_NCOPY; ++t)
+		for (i = 0; i < knsupc * nrhs; ++i)
+		    xk[i] += lsum[il + i + t*sizelsum];
+
+	    lsub = Llu->Lrowind_bc_ptr[lkc];
+	    lusup = Llu->Lnzval_bc_ptr[lkc];
+	    nsupr = lsub[1];
+	    if ( Llu->inv == 1 && Llu->Linv_bc_ptr[lkc] ) {
+		Linv = Llu->Linv_bc_ptr[lkc];
+		if ( !sgemm_small(knsupc, nrhs, knsupc,
+		                  Linv, knsupc, xk, knsupc, rtemp_loc, knsupc) ) {
+#ifdef _CRAY
+		SGEMM( ftcs2, ftcs2, &knsupc, &nrhs, &knsupc,
+		       &alpha, Linv, &knsupc, xk, &knsupc, &beta, rtemp_loc, &knsupc );
+#elif defined (USE_VENDOR_BLAS)
+		sgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+			&alpha, Linv, &knsupc, xk, &knsupc, &beta, rtemp_loc, &knsupc, 1, 1 );
+#else
+		sgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+			&alpha, Linv, &knsupc, xk, &knsupc, &beta, rtemp_loc, &knsupc );
+#endif
+		}
+		for (i = 0; i < knsupc * nrhs; ++i) xk[i] = rtemp_loc[i];
+	    } else {
+		if ( !strsm_small('L', knsupc, nrhs,
+		                  lusup, nsupr, xk, knsupc) ) {
+#ifdef _CRAY
+		STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &knsupc, &nrhs, &alpha,
+		      lusup, &nsupr, xk, &knsupc);
+#elif defined (USE_VENDOR_BLAS)
+		strsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+		       lusup, &nsupr, xk, &knsupc, 1, 1, 1, 1);
+#else
+		strsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+		       lusup, &nsupr, xk, &knsupc);
+#endif
+		}
+	    }
+	    stat[thread_id]->ops[SOLVE] += knsupc * (knsupc - 1) * nrhs;
+	    SOLVE_STAMP(Llu->sol_tdone, k);
+
+	    /* lsum[i] -= L(i,k) * X[k] in the copy of this thread. */
+	    nlb = lsub[0] - 1; /* The diagonal block is first. */
+	    if ( nlb == 0 ) continue;
+	    lloc = Llu->Lindval_loc_bc_ptr[lkc];
+	    m = nsupr - knsupc;
+	    if ( !sgemm_small(m, nrhs, knsupc,
+	                      &lusup[lloc[2*nlb+3]], nsupr, xk, knsupc, rtemp_loc, m) ) {
+#ifdef _CRAY
+	    SGEMM( ftcs2, ftcs2, &m, &nrhs, &knsupc,
+		   &alpha, &lusup[lloc[2*nlb+3]], &nsupr, xk,
+		   &knsupc, &beta, rtemp_loc, &m );
+#elif defined (USE_VENDOR_BLAS)
+	    sgemm_( "N", "N", &m, &nrhs, &knsupc,
+		    &alpha, &lusup[lloc[2*nlb+3]], &nsupr, xk,
+		    &knsupc, &beta, rtemp_loc, &m, 1, 1 );
+#else
+	    sgemm_( "N", "N", &m, &nrhs, &knsupc,
+		    &alpha, &lusup[lloc[2*nlb+3]], &nsupr, xk,
+		    &knsupc, &beta, rtemp_loc, &m );
+#endif
+	    }
+	    stat[thread_id]->ops[SOLVE] += 2 * m * nrhs * knsupc;
+
+	    nbrow = 0;
+	    for (lb = 0; lb < nlb; ++lb) {
+		lptr = lloc[lb + nlb + 2];
+		nbrow1 = lsub[lptr + 1];
+		ik = lsub[lptr]; /* Global block number, row-wise. */
+		rel = xsup[ik];  /* Global row index of block ik. */
+		iknsupc = SuperSize( ik );
+		il = LSUM_BLK( LBi( ik, grid ) ) + LSUM_COPY(thread_id);
+		if ( Llu->lsum_shared )
+		    slsum_sub_atomic(&lsum[il], iknsupc, nrhs, nbrow1,
+				     &lsub[lptr + 2], rel, &rtemp_loc[nbrow], m);
+		else
+		    RHS_ITERATE(j)
+			for (i = 0; i < nbrow1; ++i) {
+			    irow = lsub[lptr + 2 + i] - rel; /* Relative row. */
+			    lsum[il + irow + j*iknsupc] -= rtemp_loc[nbrow + i + j*m];
+			}
+		nbrow += nbrow1;
+	    }
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+	    for (lb = 0; lb < nlb; ++lb) {
+		lk = lloc[lb + 1];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+		--fmod[lk*aln_i];
+	    }
+	}
+    }
+} /* slsum_fmod_levels */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Complete the block lsum[lk] of the fixed-order solves, once all its
+ *   local modifications are done and the contributions of its children
+ *   in the reduction tree are buffered in rdbuf[]. The children are
+ *   added in increasing order of the sending process. The diagonal
+ *   process then solves for X[k] and sends it down the broadcast tree;
+ *   the other processes send lsum[lk] to their parent.
+ * </pre>
+ */
+static void slsum_fixed_done
+/************************************************************************/
+(
+ char   uplo,     /* 'L' for the L-solve, 'U' for the U-solve.          */
+ int_t  lk,       /* Local block number, row-wise.                      */
+ float *lsum,
+ float *x,
+ float *rtemp,
+ int    nrhs,
+ int_t  *rdoff,   /* Start of the children of block lk in rdbuf[].     */
+ int_t  *rdcnt,   /* Number of children of block lk received.          */
+ float *rdbuf,
+ float **xptr,   /* X[k] for each local block column, NULL if unknown. */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ SuperLUStat_t *stat
+)
+{
+    float alpha = 1.0, beta = 0.0;
+    float *tempv, *lusup, *Linv;
+    int_t  *ilsum = Llu->ilsum;
+    int    iam = grid->iam, myrow = MYROW( iam, grid ), knsupc, nsupr;
+    int_t  c, i, ii, il, k, lkc, size;
+    BcTree btree;
+    RdTree rtree;
+
+    k = myrow + lk * grid->nprow; /* Global block number. */
+    knsupc = SuperSize( k );
+    il = LSUM_BLK( lk );
+    size = knsupc * nrhs;
+
+    tempv = &rdbuf[rdoff[lk]];
+    for (c = 0; c < rdcnt[lk]; ++c, tempv += size)
+	for (i = 0; i < size; ++i) lsum[il + i] += tempv[i];
+
+    if ( iam != PNUM( myrow, PCOL( k, grid ), grid ) ) {
+	rtree = uplo == 'L' ? Llu->LRtree_ptr[lk] : Llu->URtree_ptr[lk];
+	RdTree_forwardMessageSimple(rtree, &lsum[il - LSUM_H],
+			RdTree_GetMsgSize(rtree,'s')*nrhs+LSUM_H,'s');
+	return;
+    }
+
+    /* Diagonal process: X[k] += lsum[k], then solve with the diagonal block. */
+    ii = X_BLK( lk );
+    for (i = 0; i < size; ++i) x[ii + i] += lsum[il + i];
+
+    lkc = LBj( k, grid ); /* Local block number, column-wise. */
+    lusup = Llu->Lnzval_bc_ptr[lkc];
+    nsupr = Llu->Lrowind_bc_ptr[lkc][1];
+    if ( Llu->inv == 1 && Llu->Linv_bc_ptr[lkc] ) {
+	Linv = uplo == 'L' ? Llu->Linv_bc_ptr[lkc] : Llu->Uinv_bc_ptr[lkc];
+	if ( !sgemm_small(knsupc, nrhs, knsupc,
+	                  Linv, knsupc, &x[ii], knsupc, rtemp, knsupc) ) {
+#ifdef _CRAY
+	SGEMM( ftcs2, ftcs2, &knsupc, &nrhs, &knsupc,
+	       &alpha, Linv, &knsupc, &x[ii], &knsupc, &beta, rtemp, &knsupc );
+#elif defined (USE_VENDOR_BLAS)
+	sgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+	       &alpha, Linv, &knsupc, &x[ii], &knsupc, &beta, rtemp, &knsupc, 1, 1 );
+#else
+	sgemm_( "N", "N", &knsupc, &nrhs, &knsupc,
+	       &alpha, Linv, &knsupc, &x[ii], &knsupc, &beta, rtemp, &knsupc );
+#endif
+	}
+	for (i = 0; i < size; ++i) x[ii + i] = rtemp[i];
+    } else if ( uplo == 'L' ) {
+	if ( !strsm_small('L', knsupc, nrhs,
+	                  lusup, nsupr, &x[ii], knsupc) ) {
+#ifdef _CRAY
+	STRSM(ftcs1, ftcs1, ftcs2, ftcs3, &knsupc, &nrhs, &alpha,
+	      lusup, &nsupr, &x[ii], &knsupc);
+#elif defined (USE_VENDOR_BLAS)
+	strsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &x[ii], &knsupc, 1, 1, 1, 1);
+#else
+	strsm_("L", "L", "N", "U", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &x[ii], &knsupc);
+#endif
+	}
+    } else {
+	if ( !strsm_small('U', knsupc, nrhs,
+	                  lusup, nsupr, &x[ii], knsupc) ) {
+#ifdef _CRAY
+	STRSM(ftcs1, ftcs3, ftcs2, ftcs2, &knsupc, &nrhs, &alpha,
+	      lusup, &nsupr, &x[ii], &knsupc);
+#elif defined (USE_VENDOR_BLAS)
+	strsm_("L", "U", "N", "N", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &x[ii], &knsupc, 1, 1, 1, 1);
+#else
+	strsm_("L", "U", "N", "N", &knsupc, &nrhs, &alpha,
+	       lusup, &nsupr, &x[ii], &knsupc);
+#endif
+	}
+    }
+    stat->ops[SOLVE] += knsupc * (knsupc + (uplo == 'L' ? -1 : 1)) * nrhs;
+    SOLVE_STAMP(Llu->sol_tdone, k);
+
+    btree = uplo == 'L' ? Llu->LBtree_ptr[lkc] : Llu->UBtree_ptr[lkc];
+    if ( btree != NULL )
+	BcTree_forwardMessageSimple(btree, &x[ii - XK_H],
+			BcTree_GetMsgSize(btree,'s')*nrhs+XK_H,'s');
+    xptr[lkc] = &x[ii];
+} /* slsum_fixed_done */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Buffer the contribution tempv[] to lsum[lk] received from process
+ *   src, keeping the contributions of block lk sorted by process.
+ * </pre>
+ */
+static void slsum_fixed_recv
+/************************************************************************/
+(
+ int_t lk, int src, float *tempv, int_t size,
+ int_t *rdoff, int_t *rdslot, int_t *rdcnt, int *rdsrc, float *rdbuf
+)
+{
+    int_t pos = rdcnt[lk]++;
+    int   *s = &rdsrc[rdslot[lk]];
+    float *buf = &rdbuf[rdoff[lk]];
+
+    for ( ; pos > 0 && s[pos-1] > src; --pos) {
+	s[pos] = s[pos-1];
+	memcpy(&buf[pos * size], &buf[(pos-1) * size], size * sizeof(float));
+    }
+    s[pos] = src;
+    memcpy(&buf[pos * size], tempv, size * sizeof(float));
+}
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Set up the buffers of the fixed-order solves for the contributions
+ *   of the children in the reduction trees: recv[lk] blocks of size
+ *   SuperSize(k)*nrhs for each local block row lk.
+ * </pre>
+ */
+static void slsum_fixed_init
+/************************************************************************/
+(
+ int_t nsupers, int nrhs, int_t *recv, int_t *xsup, gridinfo_t *grid,
+ int_t **rdoff, int_t **rdslot, int_t **rdcnt, int **rdsrc, float **rdbuf
+)
+{
+    int_t lk, k, nlb = CEILING( nsupers, grid->nprow );
+    int   myrow = MYROW( grid->iam, grid );
+
+    if ( !(*rdoff = intMalloc_dist(nlb + 1)) )
+	ABORT("Malloc fails for rdoff[].");
+    if ( !(*rdslot = intMalloc_dist(nlb + 1)) )
+	ABORT("Malloc fails for rdslot[].");
+    if ( !(*rdcnt = intCalloc_dist(nlb)) )
+	ABORT("Calloc fails for rdcnt[].");
+    (*rdoff)[0] = (*rdslot)[0] = 0;
+    for (lk = 0; lk < nlb; ++lk) {
+	k = myrow + lk * grid->nprow;
+	(*rdslot)[lk+1] = (*rdslot)[lk] + recv[lk];
+	(*rdoff)[lk+1] = (*rdoff)[lk] + (k < nsupers ? recv[lk] * SuperSize( k ) * nrhs : 0);
+    }
+    if ( !(*rdsrc = SUPERLU_MALLOC(((*rdslot)[nlb] + 1) * sizeof(int))) )
+	ABORT("Malloc fails for rdsrc[].");
+    if ( !(*rdbuf = floatMalloc_dist((*rdoff)[nlb] + 1)) )
+	ABORT("Malloc fails for rdbuf[].");
+}
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform the L-solve of psgstrs with a fixed summation order, so that
+ *   the solution is bitwise identical from run to run on the same grid
+ *   (options->Reproducible = YES).
+ *
+ *   Each process applies the X[k] it needs, lsum[i] -= L_i,k * X[k], in
+ *   increasing order of k, whatever the order in which they arrive; an
+ *   X[k] is buffered until all the smaller ones are applied. In the
+ *   reduction of lsum[i] across a process row, the contributions of the
+ *   children are buffered and added after the local modifications, in
+ *   increasing order of the sending process. The same reduction and
+ *   broadcast trees as in the asynchronous solve are used.
+ *
+ *   On entry, fmod[] includes the children counts frecv[], and the
+ *   broadcast and reduction trees are initialized. If active[] is not
+ *   NULL, the X[k] of the supernodes not marked are 0 and not applied.
+ * </pre>
+ */
+void slsum_fmod_fixed
+/************************************************************************/
+(
+ float *lsum,    /* Sum of local modifications.                        */
+ float *x,       /* X array (local)                                    */
+ float *rtemp,   /* Workspace for the GEMM results.                    */
+ int    nrhs,     /* Number of right-hand sides.                        */
+ int_t  nsupers,  /* Number of supernodes.                              */
+ int_t  *fmod,    /* Modification count for L-solve.                    */
+ int_t  *frecv,   /* Number of children in the reduction tree.          */
+ int_t  nfrecvx,  /* Number of X[k] to be received.                     */
+ int_t  nfrecvmod,/* Number of lsum[] blocks to be received.            */
+ pxgstrs_ring_t *ring, /* Receives posted for the messages.             */
+ int    *active,  /* The supernodes solved, NULL for all of them.       */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ SuperLUStat_t *stat
+)
+{
+    float alpha = 1.0, beta = 0.0;
+    float *lusup, *recvbuf0, *rdbuf, **xptr;
+    int_t  *ilsum = Llu->ilsum, *lsub, *lloc, *rdoff, *rdslot, *rdcnt;
+    int    *rdsrc;
+    int    iam = grid->iam, myrow, mycol, knsupc, iknsupc, nsupr, m, nbrow1;
+    int_t  i, j, k, ik, il, irow, lb, lk, lkc, nlb, nlbc, nb, nbrow;
+    int_t  idx_n, idx_i, idx_v, lptr, rel, nrecv = 0;
+    int_t  aln_i = ceil(CACHELINE/(float)sizeof(int_t));
+    BcTree *LBtree_ptr = Llu->LBtree_ptr;
+    MPI_Status status;
+
+    myrow = MYROW( iam, grid );
+    mycol = MYCOL( iam, grid );
+    nlb = CEILING( nsupers, grid->nprow );
+    nlbc = CEILING( nsupers, grid->npcol );
+
+    if ( !(xptr = (float **) SUPERLU_MALLOC(nlbc * sizeof(float*))) )
+	ABORT("Malloc fails for xptr[].");
+    for (lkc = 0; lkc < nlbc; ++lkc) xptr[lkc] = NULL;
+    slsum_fixed_init(nsupers, nrhs, frecv, xsup, grid,
+		     &rdoff, &rdslot, &rdcnt, &rdsrc, &rdbuf);
+
+    /* Solve the leaves. */
+    for (lk = 0; lk < nlb; ++lk) {
+	k = myrow + lk * grid->nprow;
+	if ( k < nsupers && mycol == PCOL( k, grid ) && fmod[lk*aln_i] == 0 )
+	    slsum_fixed_done('L', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+			     rdbuf, xptr, xsup, grid, Llu, stat);
+    }
+
+    lkc = 0;
+    for (;;) {
+	/* Apply the known X[k] in increasing order of k. */
+	for ( ; lkc < nlbc; ++lkc) {
+	    k = mycol + lkc * grid->npcol; /* Global block number. */
+	    if ( k >= nsupers ) { lkc = nlbc; break; }
+	    if ( active && !active[k] ) continue; /* X[k] = 0 */
+	    if ( !(lsub = Llu->Lrowind_bc_ptr[lkc]) ) continue;
+	    nb = myrow == PROW( k, grid ) ? lsub[0] - 1 : lsub[0];
+	    if ( nb == 0 ) continue;
+	    if ( xptr[lkc] == NULL ) break; /* Wait for X[k]. */
+
+	    knsupc = SuperSize( k );
+	    lusup = Llu->Lnzval_bc_ptr[lkc];
+	    lloc = Llu->Lindval_loc_bc_ptr[lkc];
+	    nsupr = lsub[1];
+	    if ( myrow == PROW( k, grid ) ) {
+		idx_n = 1;
+		idx_i = nb + 2;
+		idx_v = 2 * nb + 3;
+		m = nsupr - knsupc;
+	    } else {
+		idx_n = 0;
+		idx_i = nb;
+		idx_v = 2 * nb;
+		m = nsupr;
+	    }
+	    if ( !sgemm_small(m, nrhs, knsupc,
+	                      &lusup[lloc[idx_v]], nsupr, xptr[lkc], knsupc, rtemp, m) ) {
+#ifdef _CRAY
+	    SGEMM( ftcs2, ftcs2, &m, &nrhs, &knsupc,
+		   &alpha, &lusup[lloc[idx_v]], &nsupr, xptr[lkc],
+		   &knsupc, &beta, rtemp, &m );
+#elif defined (USE_VENDOR_BLAS)
+	    sgemm_( "N", "N", &m, &nrhs, &knsupc,
+		    &alpha, &lusup[lloc[idx_v]], &nsupr, xptr[lkc],
+		    &knsupc, &beta, rtemp, &m, 1, 1 );
+#else
+	    sgemm_( "N", "N", &m, &nrhs, &knsupc,
+		    &alpha, &lusup[lloc[idx_v]], &nsupr, xptr[lkc],
+		    &knsupc, &beta, rtemp, &m );
+#endif
+	    }
+	    stat->ops[SOLVE] += 2 * m * nrhs * knsupc;
+
+	    nbrow = 0;
+	    for (lb = 0; lb < nb; ++lb) {
+		lptr = lloc[lb + idx_i];
+		nbrow1 = lsub[lptr + 1];
+		ik = lsub[lptr]; /* Global block number, row-wise. */
+		rel = xsup[ik];  /* Global row index of block ik. */
+		iknsupc = SuperSize( ik );
+		il = LSUM_BLK( LBi( ik, grid ) );
+		RHS_ITERATE(j)
+		    for (i = 0; i < nbrow1; ++i) {
+			irow = lsub[lptr + 2 + i] - rel; /* Relative row. */
+			lsum[il + irow + j*iknsupc] -= rtemp[nbrow + i + j*m];
+		    }
+		nbrow += nbrow1;
+	    }
+
+	    for (lb = 0; lb < nb; ++lb) {
+		lk = lloc[lb + idx_n];
+		if ( --fmod[lk*aln_i] == 0 ) /* Local accumulation done. */
+		    slsum_fixed_done('L', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+				     rdbuf, xptr, xsup, grid, Llu, stat);
+	    }
+	}
+
+	if ( nrecv == nfrecvx + nfrecvmod ) break;
+
+	/* Receive a message. */
+	recvbuf0 = (float *) pxgstrs_ring_recv( ring, &status, stat );
+	++nrecv;
+	k = *recvbuf0;
+
+	if ( status.MPI_TAG == BC_L ) {
+	    pxgstrs_ring_keep(ring); /* X[k] is kept until it is applied. */
+	    lk = LBj( k, grid );
+	    if ( BcTree_getDestCount(LBtree_ptr[lk],'s') > 0 )
+		BcTree_forwardMessageSimple(LBtree_ptr[lk], recvbuf0,
+			BcTree_GetMsgSize(LBtree_ptr[lk],'s')*nrhs+XK_H,'s');
+	    xptr[lk] = &recvbuf0[XK_H];
+	} else { /* RD_L */
+	    lk = LBi( k, grid );
+	    slsum_fixed_recv(lk, status.MPI_SOURCE, &recvbuf0[LSUM_H],
+			     SuperSize( k ) * nrhs, rdoff, rdslot, rdcnt, rdsrc, rdbuf);
+	    if ( --fmod[lk*aln_i] == 0 )
+		slsum_fixed_done('L', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+				 rdbuf, xptr, xsup, grid, Llu, stat);
+	}
+    }
+
+    SUPERLU_FREE(xptr);
+    SUPERLU_FREE(rdoff);
+    SUPERLU_FREE(rdslot);
+    SUPERLU_FREE(rdcnt);
+    SUPERLU_FREE(rdsrc);
+    SUPERLU_FREE(rdbuf);
+} /* slsum_fmod_fixed */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Perform the U-solve of psgstrs with a fixed summation order, as
+ *   slsum_fmod_fixed() does for the L-solve: the X[k] are applied,
+ *   lsum[i] -= U_i,k * X[k], in decreasing order of k, and the children
+ *   in the reduction trees are added in increasing order of the sending
+ *   process.
+ *
+ *   On entry, bmod[] includes the children counts brecv[], and the
+ *   broadcast and reduction trees are initialized. If needed[] is not
+ *   NULL, the X[k] of the supernodes not marked are not computed.
+ * </pre>
+ */
+void slsum_bmod_fixed
+/************************************************************************/
+(
+ float *lsum,    /* Sum of local modifications.                        */
+ float *x,       /* X array (local)                                    */
+ float *rtemp,   /* Workspace of size sizertemp.                       */
+ int    nrhs,     /* Number of right-hand sides.                        */
+ int_t  nsupers,  /* Number of supernodes.                              */
+ int_t  *bmod,    /* Modification count for U-solve.                    */
+ int_t  *brecv,   /* Number of children in the reduction tree.          */
+ int_t  nbrecvx,  /* Number of X[k] to be received.                     */
+ int_t  nbrecvmod,/* Number of lsum[] blocks to be received.            */
+ pxgstrs_ring_t *ring, /* Receives posted for the messages.             */
+ int_t  sizertemp,
+ int    *needed,  /* The supernodes solved, NULL for all of them.       */
+ int_t  *xsup,
+ gridinfo_t *grid,
+ sLocalLU_t *Llu,
+ SuperLUStat_t *stat
+)
+{
+    float *recvbuf0, *rdbuf, **xptr;
+    int_t  *ilsum = Llu->ilsum, *usub, *rdoff, *rdslot, *rdcnt;
+    int_t  *Urbs = Llu->Urbs;
+    Ucb_indptr_t **Ucb_indptr = Llu->Ucb_indptr;
+    int_t  **Ucb_valptr = Llu->Ucb_valptr;
+    int    *rdsrc;
+    int    iam = grid->iam, myrow, mycol, knsupc;
+    int_t  gik, i, ik, il, k, lk, lkc, nlb, nlbc, ub, nrecv = 0;
+    int_t  aln_i = ceil(CACHELINE/(float)sizeof(int_t));
+    BcTree *UBtree_ptr = Llu->UBtree_ptr;
+    MPI_Status status;
+
+    myrow = MYROW( iam, grid );
+    mycol = MYCOL( iam, grid );
+    nlb = CEILING( nsupers, grid->nprow );
+    nlbc = CEILING( nsupers, grid->npcol );
+
+    if ( !(xptr = (float **) SUPERLU_MALLOC(nlbc * sizeof(float*))) )
+	ABORT("Malloc fails for xptr[].");
+    for (lkc = 0; lkc < nlbc; ++lkc) xptr[lkc] = NULL;
+    slsum_fixed_init(nsupers, nrhs, brecv, xsup, grid,
+		     &rdoff, &rdslot, &rdcnt, &rdsrc, &rdbuf);
+
+    /* Solve the roots. */
+    for (lk = 0; lk < nlb; ++lk) {
+	k = myrow + lk * grid->nprow;
+	if ( k < nsupers && mycol == PCOL( k, grid ) && bmod[lk*aln_i] == 0 )
+	    slsum_fixed_done('U', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+			     rdbuf, xptr, xsup, grid, Llu, stat);
+    }
+
+    lkc = nlbc - 1;
+    for (;;) {
+	/* Apply the known X[k] in decreasing order of k. */
+	for ( ; lkc >= 0; --lkc) {
+	    k = mycol + lkc * grid->npcol; /* Global block number. */
+	    if ( k >= nsupers || Urbs[lkc] == 0 ) continue;
+	    if ( needed && !needed[k] ) continue; /* X[k] is not computed. */
+	    if ( xptr[lkc] == NULL ) break; /* Wait for X[k]. */
+
+	    knsupc = SuperSize( k );
+	    for (ub = 0; ub < Urbs[lkc]; ++ub) {
+		ik = Ucb_indptr[lkc][ub].lbnum; /* Local block number, row-wise. */
+		usub = Llu->Ufstnz_br_ptr[ik];
+		i = Ucb_indptr[lkc][ub].indpos + UB_DESCRIPTOR;
+		il = LSUM_BLK( ik );
+		gik = ik * grid->nprow + myrow; /* Global block number, row-wise. */
+		slsum_bmod_blk(&lsum[il], xptr[lkc], nrhs, knsupc, &usub[i],
+			       &Llu->Unzval_br_ptr[ik][Ucb_valptr[lkc][ub]],
+			       FstBlockC( gik ), FstBlockC( gik+1 ),
+			       rtemp, sizertemp, &stat->ops[SOLVE], 0);
+	    }
+
+	    for (ub = 0; ub < Urbs[lkc]; ++ub) {
+		ik = Ucb_indptr[lkc][ub].lbnum;
+		if ( --bmod[ik*aln_i] == 0 ) /* Local accumulation done. */
+		    slsum_fixed_done('U', ik, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+				     rdbuf, xptr, xsup, grid, Llu, stat);
+	    }
+	}
+
+	if ( nrecv == nbrecvx + nbrecvmod ) break;
+
+	/* Receive a message. */
+	recvbuf0 = (float *) pxgstrs_ring_recv( ring, &status, stat );
+	++nrecv;
+	k = *recvbuf0;
+
+	if ( status.MPI_TAG == BC_U ) {
+	    pxgstrs_ring_keep(ring); /* X[k] is kept until it is applied. */
+	    lk = LBj( k, grid );
+	    if ( BcTree_getDestCount(UBtree_ptr[lk],'s') > 0 )
+		BcTree_forwardMessageSimple(UBtree_ptr[lk], recvbuf0,
+			BcTree_GetMsgSize(UBtree_ptr[lk],'s')*nrhs+XK_H,'s');
+	    xptr[lk] = &recvbuf0[XK_H];
+	} else { /* RD_U */
+	    lk = LBi( k, grid );
+	    slsum_fixed_recv(lk, status.MPI_SOURCE, &recvbuf0[LSUM_H],
+			     SuperSize( k ) * nrhs, rdoff, rdslot, rdcnt, rdsrc, rdbuf);
+	    if ( --bmod[lk*aln_i] == 0 )
+		slsum_fixed_done('U', lk, lsum, x, rtemp, nrhs, rdoff, rdcnt,
+				 rdbuf, xptr, xsup, grid, Llu, stat);
+	}
+    }
+
+    SUPERLU_FREE(xptr);
+    SUPERLU_FREE(rdoff);
+    SUPERLU_FREE(rdslot);
+    SUPERLU_FREE(rdcnt);
+    SUPERLU_FREE(rdsrc);
+    SUPERLU_FREE(rdbuf);
+} /* slsum_bmod_fixed */
@@ -0,0 +1,147 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Tunes the blocking parameters of the factorization for a matrix
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <stdlib.h>
+#include "superlu_sdefs.h"
+
+/* Candidate {relaxation, maximum supernode size}; the first is the
+   default of sp_ienv_dist(). */
+static const int_t tune_cand[][2] = {
+    {20, 128}, {10, 64}, {40, 128}, {20, 256}, {60, 256}
+};
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSGSTUNE factorizes copies of A with psgssvx() for a few choices of the
+ * relaxation and the maximum supernode size (sp_ienv_dist(2) and (3)),
+ * and keeps the one with the shortest time for the symbolic
+ * factorization, the distribution and the numerical factorization.
+ * The result is used by the following factorizations in this process,
+ * and is appended to the tuning cache if SUPERLU_TUNE_CACHE is set (see
+ * superlu_tune.c), so that later runs get it through psgssvx().
+ *
+ * The environment variables NREL and NSUP take precedence over the tuned
+ * values; if either is set, nothing is done.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         The options used for the factorizations; Fact is taken as
+ *         DOFACT and no statistics are printed.
+ *
+ * A       (input) SuperMatrix*
+ *         The distributed matrix in SLU_NR_loc format. A is not modified.
+ *
+ * grid    (input) gridinfo_t*
+ *         The 2D process mesh.
+ *
+ * relax   (output) int_t*
+ * maxsuper (output) int_t*
+ *         The chosen relaxation and maximum supernode size.
+ *
+ * Return value
+ * ============
+ *
+ * The time of the chosen factorization in seconds, or a negative value
+ * if nothing was tuned.
+ * </pre>
+ */
+double psgstune(superlu_dist_options_t *options, SuperMatrix *A,
+		gridinfo_t *grid, int_t *relax, int_t *maxsuper)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    superlu_dist_options_t opt = *options;
+    SuperMatrix B;
+    sScalePermstruct_t ScalePermstruct;
+    sLUstruct_t LUstruct;
+    SuperLUStat_t stat;
+    float *nzval, berr[1];
+    double t, tbest = -1.0;
+    int_t *colind, *rowptr, m_loc = Astore->m_loc, nnz_loc = Astore->nnz_loc;
+    int_t i, c, ncand = sizeof(tune_cand) / sizeof(tune_cand[0]);
+    int info;
+
+    *relax = sp_ienv_dist(2);
+    *maxsuper = sp_ienv_dist(3);
+    if ( getenv("NREL") || getenv("NSUP") ) return tbest;
+
+    opt.Fact = DOFACT;
+    opt.PrintStat = NO;
+    opt.SolveInitialized = NO;
+    opt.RefineInitialized = NO;
+
+    superlu_tune_lock(1);
+    for (c = 0; c < ncand; ++c) {
+	superlu_tune_set(tune_cand[c][0], tune_cand[c][1]);
+
+	/* psgssvx() may scale and permute its matrix. */
+	nzval = floatMalloc_dist(nnz_loc);
+	colind = intMalloc_dist(nnz_loc);
+	rowptr = intMalloc_dist(m_loc + 1);
+	if ( !nzval || !colind || !rowptr )
+	    ABORT("Malloc fails for the copy of A.");
+	for (i = 0; i < nnz_loc; ++i) {
+	    nzval[i] = ((float *) Astore->nzval)[i];
+	    colind[i] = Astore->colind[i];
+	}
+	for (i = 0; i <= m_loc; ++i) rowptr[i] = Astore->rowptr[i];
+	sCreate_CompRowLoc_Matrix_dist(&B, A->nrow, A->ncol, nnz_loc, m_loc,
+				       Astore->fst_row, nzval, colind, rowptr,
+				       SLU_NR_loc, SLU_S, SLU_GE);
+
+	sScalePermstructInit(A->nrow, A->ncol, &ScalePermstruct);
+	sLUstructInit(A->ncol, &LUstruct);
+	PStatInit(&stat);
+
+	MPI_Barrier(grid->comm);
+	t = SuperLU_timer_();
+	psgssvx(&opt, &B, &ScalePermstruct, NULL, m_loc, 0, grid,
+		&LUstruct, NULL, berr, &stat, &info);
+	t = SuperLU_timer_() - t;
+	MPI_Allreduce(MPI_IN_PLACE, &t, 1, MPI_DOUBLE, MPI_MAX, grid->comm);
+
+#if ( PRNTlevel>=1 )
+	if ( !grid->iam )
+	    printf(".. psgstune: relax " IFMT ", maxsuper " IFMT ": %.4f s, info %d\n",
+		   tune_cand[c][0], tune_cand[c][1], t, info);
+#endif
+	if ( info == 0 && (tbest < 0.0 || t < tbest) ) {
+	    tbest = t;
+	    *relax = tune_cand[c][0];
+	    *maxsuper = tune_cand[c][1];
+	}
+
+	PStatFree(&stat);
+	sDestroy_LU(A->ncol, grid, &LUstruct);
+	sLUstructFree(&LUstruct);
+	sScalePermstructFree(&ScalePermstruct);
+	Destroy_CompRowLoc_Matrix_dist(&B);
+    }
+
+    superlu_tune_lock(0);
+    superlu_tune_set(*relax, *maxsuper);
+    if ( tbest >= 0.0 ) superlu_tune_store(A, grid, *relax, *maxsuper, tbest);
+    return tbest;
+}
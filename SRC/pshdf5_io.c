@@ -0,0 +1,637 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Read and write distributed matrices and vectors in HDF5 files
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Built when HDF5 is enabled (TPL_ENABLE_HDF5LIB, i.e. HAVE_HDF5).
+ *
+ * A matrix is an HDF5 group holding the compressed rows of the global
+ * matrix, as scipy.sparse / h5py store a CSR matrix:
+ *   indptr  : m+1 integers, indptr[0] = 0 and indptr[m] = nnz
+ *   indices : nnz integers, the column indices
+ *   data    : nnz reals
+ *   shape   : attribute of the group, the 2 integers m and n
+ * A block of vectors is a dataset of nrhs x m reals, i.e. one row per
+ * vector, or of m reals if nrhs = 1. Integers and reals of any width
+ * are converted by HDF5.
+ *
+ * Each process reads or writes only its own rows. With a parallel HDF5
+ * (H5_HAVE_PARALLEL) the file is opened on grid->comm and the transfers
+ * are collective; with a serial one the processes read the file
+ * independently, and write it one after the other.
+ *
+ * Experimental: these routines are not built by the continuous
+ * integration, and the path of a serial HDF5 is untested.
+ * </pre>
+ */
+
+#include <stdio.h>
+#include "superlu_sdefs.h"
+
+#ifdef HAVE_HDF5
+
+#include <hdf5.h>
+
+#define H5_INT_T  ( sizeof(int_t) == 8 ? H5T_NATIVE_LLONG : H5T_NATIVE_INT )
+
+/*! \brief Open or create filename, collectively if HDF5 is parallel. */
+static hid_t
+h5_open(char *filename, int write, int create, gridinfo_t *grid)
+{
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS), fid;
+
+#ifdef H5_HAVE_PARALLEL
+    H5Pset_fapl_mpio(fapl, grid->comm, MPI_INFO_NULL);
+#endif
+    if ( create )
+	fid = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    else
+	fid = H5Fopen(filename, write ? H5F_ACC_RDWR : H5F_ACC_RDONLY, fapl);
+    H5Pclose(fapl);
+    return fid;
+}
+
+/*! \brief Whether filename exists, as seen by process 0. */
+static int
+h5_exists(char *filename, gridinfo_t *grid)
+{
+    FILE *fp;
+    int exists = 0;
+
+    if ( !grid->iam && (fp = fopen(filename, "r")) ) {
+	exists = 1;
+	fclose(fp);
+    }
+    MPI_Bcast(&exists, 1, MPI_INT, 0, grid->comm);
+    return exists;
+}
+
+/*! \brief Read or write a block of a dataset of rank 1 or 2.
+ *
+ * <pre>
+ * The count[0] x count[1] block at start[] of the dataset is transferred
+ * to or from the top left corner of buf[], an array of mdim[0] x mdim[1]
+ * elements of type mtype (rank 1: count[0] and mdim[0] only). An empty
+ * block still takes part in a collective transfer.
+ * </pre>
+ */
+static herr_t
+h5_block(hid_t dset, hid_t mtype, int rank, hsize_t *start, hsize_t *count,
+	 hsize_t *mdim, void *buf, int write)
+{
+    hid_t fspace = H5Dget_space(dset), mspace, dxpl = H5Pcreate(H5P_DATASET_XFER);
+    hsize_t zero[2] = {0, 0}, one[2] = {1, 1};
+    herr_t err = 0;
+    int empty = !count[0] || (rank == 2 && !count[1]);
+
+    mspace = H5Screate_simple(rank, empty ? one : mdim, NULL);
+    if ( empty ) {
+	H5Sselect_none(fspace);
+	H5Sselect_none(mspace);
+    } else {
+	err |= H5Sselect_hyperslab(fspace, H5S_SELECT_SET, start, NULL, count,
+				   NULL);
+	err |= H5Sselect_hyperslab(mspace, H5S_SELECT_SET, zero, NULL, count,
+				   NULL);
+    }
+#ifdef H5_HAVE_PARALLEL
+    H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+#endif
+    if ( err >= 0 )
+	err = write ? H5Dwrite(dset, mtype, mspace, fspace, dxpl, buf)
+	    : H5Dread(dset, mtype, mspace, fspace, dxpl, buf);
+    H5Pclose(dxpl);
+    H5Sclose(mspace);
+    H5Sclose(fspace);
+    return err;
+}
+
+/*! \brief Create a dataset of rank 1 or 2, replacing an existing one. */
+static hid_t
+h5_create(hid_t loc, char *name, hid_t type, int rank, hsize_t *dim)
+{
+    hid_t space, dset;
+
+    if ( H5Lexists(loc, name, H5P_DEFAULT) > 0 )
+	H5Ldelete(loc, name, H5P_DEFAULT);
+    space = H5Screate_simple(rank, dim, NULL);
+    dset = H5Dcreate(loc, name, type, space, H5P_DEFAULT, H5P_DEFAULT,
+		     H5P_DEFAULT);
+    H5Sclose(space);
+    return dset;
+}
+
+/*! \brief Number of elements of a dataset of rank 1, or -1. */
+static long long
+h5_length(hid_t dset)
+{
+    hid_t space = H5Dget_space(dset);
+    hsize_t dim;
+    long long len = -1;
+
+    if ( H5Sget_simple_extent_ndims(space) == 1 ) {
+	H5Sget_simple_extent_dims(space, &dim, NULL);
+	len = dim;
+    }
+    H5Sclose(space);
+    return len;
+}
+
+/*! \brief Write the rows of this process of the matrix A into a group.
+ *
+ * <pre>
+ * The first writer (first = 1) creates the group, its datasets and its
+ * attribute; the others open them. gptr[0:nptr-1] are the local entries
+ * of indptr, and start the offset of the local entries of indices and
+ * data. Returns 1 if HDF5 fails.
+ * </pre>
+ */
+static int
+h5_write_mat(char *filename, char *group, int create, int first,
+	     SuperMatrix *A, int_t *gptr, int_t nptr, long long start,
+	     long long nnz, gridinfo_t *grid)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    long long shape[2];
+    hid_t fid, gid, sid, aid, dptr, dind, dval;
+    hsize_t off, len, two = 2, dim;
+    int err = 0;
+
+    if ( (fid = h5_open(filename, 1, create, grid)) < 0 ) return 1;
+    if ( first ) {
+	if ( H5Lexists(fid, group, H5P_DEFAULT) > 0 )
+	    H5Ldelete(fid, group, H5P_DEFAULT);
+	gid = H5Gcreate(fid, group, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	dim = A->nrow + 1;
+	dptr = h5_create(gid, "indptr", H5_INT_T, 1, &dim);
+	dim = nnz;
+	dind = h5_create(gid, "indices", H5_INT_T, 1, &dim);
+	dval = h5_create(gid, "data", H5T_NATIVE_FLOAT, 1, &dim);
+	shape[0] = A->nrow;
+	shape[1] = A->ncol;
+	sid = H5Screate_simple(1, &two, NULL);
+	aid = H5Acreate(gid, "shape", H5T_NATIVE_LLONG, sid, H5P_DEFAULT,
+			H5P_DEFAULT);
+	if ( aid < 0 || H5Awrite(aid, H5T_NATIVE_LLONG, shape) < 0 ) err = 1;
+	H5Aclose(aid);
+	H5Sclose(sid);
+    } else {
+	gid = H5Gopen(fid, group, H5P_DEFAULT);
+	dptr = H5Dopen(gid, "indptr", H5P_DEFAULT);
+	dind = H5Dopen(gid, "indices", H5P_DEFAULT);
+	dval = H5Dopen(gid, "data", H5P_DEFAULT);
+    }
+
+    off = Astore->fst_row;
+    len = nptr;
+    if ( gid < 0 || dptr < 0 || dind < 0 || dval < 0
+	 || h5_block(dptr, H5_INT_T, 1, &off, &len, &len, gptr, 1) < 0 )
+	err = 1;
+    off = start;
+    len = Astore->nnz_loc;
+    if ( !err
+	 && (h5_block(dind, H5_INT_T, 1, &off, &len, &len, Astore->colind,
+		      1) < 0
+	     || h5_block(dval, H5T_NATIVE_FLOAT, 1, &off, &len, &len,
+			 Astore->nzval, 1) < 0) )
+	err = 1;
+
+    if ( dval >= 0 ) H5Dclose(dval);
+    if ( dind >= 0 ) H5Dclose(dind);
+    if ( dptr >= 0 ) H5Dclose(dptr);
+    if ( gid >= 0 ) H5Gclose(gid);
+    H5Fclose(fid);
+    return err;
+}
+
+/*! \brief Write the rows of this process of a block of vectors.
+ *
+ * <pre>
+ * The first writer (first = 1) creates the dataset, of dim[0:rank-1]
+ * elements, and the others open it. The block count[] at start[] of the
+ * dataset is written from x, of mdim[] elements. Returns 1 if HDF5 fails.
+ * </pre>
+ */
+static int
+h5_write_vec(char *filename, char *name, int create, int first, int rank,
+	     hsize_t *dim, hsize_t *start, hsize_t *count, hsize_t *mdim,
+	     float *x, gridinfo_t *grid)
+{
+    hid_t fid, dset;
+    int err = 0;
+
+    if ( (fid = h5_open(filename, 1, create, grid)) < 0 ) return 1;
+    if ( first ) dset = h5_create(fid, name, H5T_NATIVE_FLOAT, rank, dim);
+    else dset = H5Dopen(fid, name, H5P_DEFAULT);
+    if ( dset < 0
+	 || h5_block(dset, H5T_NATIVE_FLOAT, rank, start, count, mdim, x,
+		     1) < 0 )
+	err = 1;
+    if ( dset >= 0 ) H5Dclose(dset);
+    H5Fclose(fid);
+    return err;
+}
+
+/*! \brief Read a distributed matrix from an HDF5 file.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Read the matrix stored in the group "group" of the HDF5 file
+ *   "filename", see the layout at the top of this file, and distribute it
+ *   by rows in SLU_NR_loc format: process iam gets m/nprocs rows starting
+ *   at iam*(m/nprocs), and the last one the rest, as screate_matrix()
+ *   does. Collective over grid->comm; each process reads only its rows.
+ *
+ * Arguments
+ * =========
+ *
+ * filename (input) char*
+ *        Name of the file, the same on all processes.
+ *
+ * group  (input) char*
+ *        Path of the group of the matrix in the file, e.g. "/A".
+ *
+ * A      (output) SuperMatrix*
+ *        The local rows of the matrix, created by
+ *        sCreate_CompRowLoc_Matrix_dist(). Not set if an error is
+ *        returned.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * Return value
+ * ============
+ *   = 0: successful exit
+ *   < 0: HDF5 failed to open or read the file (-1), the group is not a
+ *        matrix of that layout (-2), or its sizes do not fit in int_t (-3).
+ * </pre>
+ */
+int
+psread_hdf5_loc(char *filename, char *group, SuperMatrix *A,
+		gridinfo_t *grid)
+{
+    int iam = grid->iam, nprocs = grid->nprow * grid->npcol, err = 0;
+    long long shape[2] = {0, 0}, m, n, nnz = 0, m_loc, fst_row, start;
+    hid_t fid, gid = -1, aid, dptr = -1, dind = -1, dval = -1;
+    hsize_t off, len;
+    int_t *rowptr, *colind, i, nnz_loc;
+    float *nzval;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter psread_hdf5_loc()");
+#endif
+
+    if ( (fid = h5_open(filename, 0, 0, grid)) < 0 ) return -1;
+    if ( (gid = H5Gopen(fid, group, H5P_DEFAULT)) < 0
+	 || H5Aexists(gid, "shape") <= 0
+	 || (aid = H5Aopen(gid, "shape", H5P_DEFAULT)) < 0 ) {
+	err = -2;
+    } else {
+	if ( H5Aread(aid, H5T_NATIVE_LLONG, shape) < 0 ) err = -2;
+	H5Aclose(aid);
+	if ( (dptr = H5Dopen(gid, "indptr", H5P_DEFAULT)) < 0
+	     || (dind = H5Dopen(gid, "indices", H5P_DEFAULT)) < 0
+	     || (dval = H5Dopen(gid, "data", H5P_DEFAULT)) < 0
+	     || h5_length(dptr) != shape[0] + 1
+	     || (nnz = h5_length(dind)) < 0 || h5_length(dval) != nnz )
+	    err = -2;
+    }
+    m = shape[0];
+    n = shape[1];
+    if ( !err && (m != (int_t) m || n != (int_t) n || nnz != (int_t) nnz) )
+	err = -3;
+    if ( err ) {
+	if ( dval >= 0 ) H5Dclose(dval);
+	if ( dind >= 0 ) H5Dclose(dind);
+	if ( dptr >= 0 ) H5Dclose(dptr);
+	if ( gid >= 0 ) H5Gclose(gid);
+	H5Fclose(fid);
+	return err;
+    }
+
+    /* My rows, and where their entries are. */
+    m_loc = m / nprocs;
+    fst_row = iam * m_loc;
+    if ( iam == nprocs - 1 ) m_loc = m - fst_row;
+    if ( !(rowptr = intMalloc_dist(m_loc + 1)) )
+	ABORT("Malloc fails for rowptr[].");
+    off = fst_row;
+    len = m_loc + 1;
+    if ( h5_block(dptr, H5_INT_T, 1, &off, &len, &len, rowptr, 0) < 0 )
+	err = 1;
+    start = rowptr[0];
+    nnz_loc = rowptr[m_loc] - start;
+    if ( err || nnz_loc < 0 || start < 0 || start + nnz_loc > nnz ) {
+	err = 1;
+	start = nnz_loc = 0;
+    }
+    for (i = 0; i <= m_loc; ++i) rowptr[i] -= start;
+
+    if ( !(colind = intMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for colind[].");
+    if ( !(nzval = floatMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for nzval[].");
+    off = start;
+    len = nnz_loc;
+    if ( h5_block(dind, H5_INT_T, 1, &off, &len, &len, colind, 0) < 0
+	 || h5_block(dval, H5T_NATIVE_FLOAT, 1, &off, &len, &len, nzval, 0) < 0 )
+	err = 1;
+
+    H5Dclose(dval);
+    H5Dclose(dind);
+    H5Dclose(dptr);
+    H5Gclose(gid);
+    H5Fclose(fid);
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MAX, grid->comm);
+    if ( err ) {
+	SUPERLU_FREE(rowptr);
+	SUPERLU_FREE(colind);
+	SUPERLU_FREE(nzval);
+	return -1;
+    }
+
+    sCreate_CompRowLoc_Matrix_dist(A, m, n, nnz_loc, m_loc, fst_row,
+				   nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_S, SLU_GE);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psread_hdf5_loc()");
+#endif
+    return 0;
+}
+
+/*! \brief Write a distributed matrix into an HDF5 file.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Write the matrix A, distributed by rows in SLU_NR_loc format, as the
+ *   group "group" of the HDF5 file "filename", see the layout at the top
+ *   of this file. The file is created if it does not exist; a group of
+ *   that name is replaced. Collective over grid->comm; the rows of the
+ *   processes must together be 0:m-1, in any order.
+ *
+ * Arguments
+ * =========
+ *
+ * filename (input) char*
+ *        Name of the file, the same on all processes.
+ *
+ * group  (input) char*
+ *        Path of the group of the matrix in the file, e.g. "/A". Its
+ *        parent must exist.
+ *
+ * A      (input) SuperMatrix*
+ *        The local rows of A, in SLU_NR_loc format with float values.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * Return value
+ * ============
+ *   = 0: successful exit
+ *   < 0: HDF5 failed to create or write the file (-1), or A is not a
+ *        matrix of that format, or its rows do not cover 0:m-1 (-2).
+ * </pre>
+ */
+int
+pswrite_hdf5_loc(char *filename, char *group, SuperMatrix *A,
+		 gridinfo_t *grid)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t m_loc = Astore->m_loc, *gptr, i;
+    int iam = grid->iam, nprocs = grid->nprow * grid->npcol, p, err = 0;
+    int exists, last;
+    long long mine[3], *all, nnz, start, rows;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter pswrite_hdf5_loc()");
+#endif
+
+    /* Where the rows of each process go. */
+    mine[0] = Astore->fst_row;
+    mine[1] = m_loc;
+    mine[2] = Astore->nnz_loc;
+    if ( !(all = (long long *) SUPERLU_MALLOC(3 * nprocs * sizeof(long long))) )
+	ABORT("Malloc fails for all[].");
+    MPI_Allgather(mine, 3, MPI_LONG_LONG, all, 3, MPI_LONG_LONG, grid->comm);
+    nnz = start = rows = 0;
+    for (p = 0; p < nprocs; ++p) {
+	nnz += all[3*p+2];
+	rows += all[3*p+1];
+	if ( all[3*p] < mine[0] ) start += all[3*p+2];
+    }
+    SUPERLU_FREE(all);
+    if ( A->Stype != SLU_NR_loc || A->Dtype != SLU_S || rows != A->nrow )
+	return -2;
+    last = ( mine[0] + m_loc == A->nrow ); /* writes indptr[m] */
+
+    if ( !(gptr = intMalloc_dist(m_loc + 1)) )
+	ABORT("Malloc fails for gptr[].");
+    for (i = 0; i <= m_loc; ++i) gptr[i] = Astore->rowptr[i] + start;
+
+    exists = h5_exists(filename, grid);
+#ifdef H5_HAVE_PARALLEL
+    err = h5_write_mat(filename, group, !exists, 1, A, gptr, m_loc + last,
+		       start, nnz, grid);
+#else
+    for (p = 0; p < nprocs; ++p) {
+	if ( p == iam )
+	    err = h5_write_mat(filename, group, !exists && !p, !p, A, gptr,
+			       m_loc + last, start, nnz, grid);
+	MPI_Barrier(grid->comm);
+    }
+#endif
+
+    SUPERLU_FREE(gptr);
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MAX, grid->comm);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit pswrite_hdf5_loc()");
+#endif
+    return err ? -1 : 0;
+}
+
+/*! \brief Read the local rows of a block of vectors from an HDF5 file.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Read rows fst_row:fst_row+m_loc-1 of the nrhs vectors stored in the
+ *   dataset "name" of the HDF5 file "filename" (nrhs x m, or m if
+ *   nrhs = 1) into x, e.g. the right-hand sides of the local rows of the
+ *   matrix read by psread_hdf5_loc(). Collective over grid->comm.
+ *
+ * Arguments
+ * =========
+ *
+ * filename (input) char*
+ *        Name of the file, the same on all processes.
+ *
+ * name   (input) char*
+ *        Path of the dataset in the file, e.g. "/b".
+ *
+ * m_loc, fst_row (input) int_t
+ *        The local rows, as in NRformat_loc.
+ *
+ * nrhs   (input) int
+ *        The number of vectors.
+ *
+ * x      (output) float*, dimension (ldx, nrhs)
+ *        The local rows of the vectors.
+ *
+ * ldx    (input) int
+ *        The leading dimension of x, ldx >= m_loc.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * Return value
+ * ============
+ *   = 0: successful exit
+ *   < 0: HDF5 failed to open or read the file (-1), or the dataset does
+ *        not hold nrhs vectors that include these rows (-2).
+ * </pre>
+ */
+int
+psread_hdf5_vec(char *filename, char *name, int_t m_loc, int_t fst_row,
+		int nrhs, float *x, int ldx, gridinfo_t *grid)
+{
+    hid_t fid, dset, space;
+    hsize_t dim[2], start[2], count[2], mdim[2];
+    int rank, err = 0;
+
+    if ( (fid = h5_open(filename, 0, 0, grid)) < 0 ) return -1;
+    if ( (dset = H5Dopen(fid, name, H5P_DEFAULT)) < 0 ) {
+	H5Fclose(fid);
+	return -2;
+    }
+    space = H5Dget_space(dset);
+    rank = H5Sget_simple_extent_ndims(space);
+    if ( rank == 1 || rank == 2 ) H5Sget_simple_extent_dims(space, dim, NULL);
+    H5Sclose(space);
+    if ( rank == 1 ) dim[1] = dim[0], dim[0] = 1;
+    if ( (rank != 1 && rank != 2) || dim[0] != nrhs
+	 || dim[1] < fst_row + m_loc )
+	err = -2;
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MIN, grid->comm);
+
+    if ( !err ) {
+	start[0] = 0;
+	start[1] = fst_row;
+	count[0] = nrhs;
+	count[1] = m_loc;
+	mdim[0] = nrhs;
+	mdim[1] = ldx;
+	if ( rank == 1 )
+	    err = h5_block(dset, H5T_NATIVE_FLOAT, 1, &start[1], &count[1],
+			   &mdim[1], x, 0) < 0;
+	else
+	    err = h5_block(dset, H5T_NATIVE_FLOAT, 2, start, count, mdim,
+			   x, 0) < 0;
+	MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MAX, grid->comm);
+	err = -err;
+    }
+    H5Dclose(dset);
+    H5Fclose(fid);
+    return err;
+}
+
+/*! \brief Write the local rows of a block of vectors into an HDF5 file.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Write x, rows fst_row:fst_row+m_loc-1 of nrhs vectors of length m,
+ *   as the dataset "name" of the HDF5 file "filename" (nrhs x m, or m if
+ *   nrhs = 1), e.g. the solution returned by psgssvx(). The file is
+ *   created if it does not exist; a dataset of that name is replaced.
+ *   Collective over grid->comm; the rows of the processes must together
+ *   be 0:m-1.
+ *
+ * Arguments
+ * =========
+ *
+ * filename (input) char*
+ *        Name of the file, the same on all processes.
+ *
+ * name   (input) char*
+ *        Path of the dataset in the file, e.g. "/x". Its parent must
+ *        exist.
+ *
+ * m      (input) int_t
+ *        The length of the vectors.
+ *
+ * m_loc, fst_row (input) int_t
+ *        The local rows, as in NRformat_loc.
+ *
+ * nrhs   (input) int
+ *        The number of vectors.
+ *
+ * x      (input) float*, dimension (ldx, nrhs)
+ *        The local rows of the vectors.
+ *
+ * ldx    (input) int
+ *        The leading dimension of x, ldx >= m_loc.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * Return value
+ * ============
+ *   = 0: successful exit
+ *   < 0: HDF5 failed to create or write the file (-1).
+ * </pre>
+ */
+int
+pswrite_hdf5_vec(char *filename, char *name, int_t m, int_t m_loc,
+		 int_t fst_row, int nrhs, float *x, int ldx, gridinfo_t *grid)
+{
+    int iam = grid->iam, nprocs = grid->nprow * grid->npcol, p, err = 0;
+    int exists, rank = ( nrhs == 1 ) ? 1 : 2;
+    hsize_t dim[2], start[2], count[2], mdim[2];
+
+    dim[0] = nrhs;
+    dim[1] = m;
+    start[0] = 0;
+    start[1] = fst_row;
+    count[0] = nrhs;
+    count[1] = m_loc;
+    mdim[0] = nrhs;
+    mdim[1] = ldx;
+
+    exists = h5_exists(filename, grid);
+#ifdef H5_HAVE_PARALLEL
+    err = h5_write_vec(filename, name, !exists, 1, rank, &dim[2 - rank],
+		       &start[2 - rank], &count[2 - rank], &mdim[2 - rank],
+		       x, grid);
+#else
+    for (p = 0; p < nprocs; ++p) {
+	if ( p == iam )
+	    err = h5_write_vec(filename, name, !exists && !p, !p, rank,
+			       &dim[2 - rank], &start[2 - rank],
+			       &count[2 - rank], &mdim[2 - rank], x, grid);
+	MPI_Barrier(grid->comm);
+    }
+#endif
+
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MAX, grid->comm);
+    return err ? -1 : 0;
+}
+
+#endif /* HAVE_HDF5 */
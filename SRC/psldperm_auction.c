@@ -0,0 +1,320 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Distributed auction algorithm for a large-diagonal row permutation
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Used with options->RowPerm = LargeDiag_AUCTION. The rows of the
+ * distributed matrix are matched to the columns so that the product of
+ * the matched entries |a_ij| is (approximately) maximal, the objective of
+ * MC64 job 5, by Bertsekas' auction algorithm with epsilon-scaling on the
+ * weights w_ij = log|a_ij|. The matching is computed on the SLU_NR_loc
+ * matrix in place; no process holds more than its own rows, plus the
+ * column prices and the column-to-row matching, which have length n.
+ *
+ * Each round is a Jacobi-type auction: every process computes the bids of
+ * its unmatched rows, the bids are exchanged with MPI_Allgatherv, and all
+ * processes resolve them in the same order, so that the prices and the
+ * matching stay identical everywhere. The weights and the prices are
+ * kept in double precision.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_sdefs.h"
+
+/* Reduction of epsilon between two scaling phases. */
+#define AUCTION_EPS_FACTOR  4.0
+
+/*! \brief Find a row permutation that makes the diagonal large.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * psldperm_auction() computes perm_r[] such that row i of A is row
+ * perm_r[i] of Pr*A, and the diagonal of Pr*A has an (approximately)
+ * maximal product of absolute values. If R1 and C1 are not NULL, they
+ * return scaling factors such that diag(R1)*A*diag(C1) has entries of
+ * absolute value at most about one, with the matched entries about one,
+ * as MC64 job 5 (without the logarithm: R1 and C1 are the factors).
+ *
+ * Arguments
+ * =========
+ *
+ * A      (input) SuperMatrix*
+ *        The distributed matrix in SLU_NR_loc format; not modified.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh. The routine is collective over grid->comm.
+ *
+ * perm_r (output) int_t*, dimension A->nrow
+ *        The row permutation, replicated on all processes.
+ *
+ * R1     (output) float*, dimension A->nrow, or NULL
+ *        The row scaling factors, replicated on all processes.
+ *
+ * C1     (output) float*, dimension A->ncol, or NULL
+ *        The column scaling factors, replicated on all processes.
+ *
+ * Return value
+ * ============
+ *
+ * = 0: success.
+ * > 0: the matrix is structurally singular, or has a zero row; perm_r,
+ *      R1 and C1 are not set.
+ * </pre>
+ */
+int psldperm_auction(SuperMatrix *A, gridinfo_t *grid, int_t *perm_r,
+		     float *R1, float *C1)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t  m = A->nrow, n = A->ncol;
+    int_t  m_loc = Astore->m_loc, fst_row = Astore->fst_row;
+    int_t  *rowptr = Astore->rowptr, *colind = Astore->colind;
+    float  *a = (float *) Astore->nzval;
+    int_t  nnz_loc = rowptr[m_loc];
+    int_t  i, j, k, q, jbest, irow, nfree, nfree_all, ntouched;
+    int_t  *row2col, *col2row, *freerows, *winner, *touched;
+    int_t  *sendidx, *recvidx;
+    double *w, *price, *maxbid, *sendbid, *recvbid;
+    double wmin, wmax, range, eps, eps_final, best, second, v, pbound;
+    double buf[2];
+    int    nprocs = grid->nprow * grid->npcol;
+    int    *counts, *displs, *counts2, *displs2, p, iinfo = 0, bad;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Enter psldperm_auction()");
+#endif
+
+    if ( m != n ) ABORT("psldperm_auction: the matrix must be square.");
+
+    /* Weights of the local entries; -HUGE_VAL for explicit zeros. */
+    if ( !(w = (double *) SUPERLU_MALLOC(SUPERLU_MAX(nnz_loc, 1)
+					 * sizeof(double))) )
+	ABORT("Malloc fails for w[].");
+    wmin = HUGE_VAL;
+    wmax = -HUGE_VAL;
+    bad = 0;
+    for (i = 0; i < m_loc; ++i) {
+	p = 0;
+	for (k = rowptr[i]; k < rowptr[i+1]; ++k) {
+	    if ( a[k] != 0.0 ) {
+		w[k] = log(fabs((double) a[k]));
+		wmin = SUPERLU_MIN(wmin, w[k]);
+		wmax = SUPERLU_MAX(wmax, w[k]);
+		p = 1;
+	    } else w[k] = -HUGE_VAL;
+	}
+	if ( !p ) bad = 1; /* zero row */
+    }
+    buf[0] = -wmin;
+    buf[1] = wmax;
+    MPI_Allreduce(MPI_IN_PLACE, buf, 2, MPI_DOUBLE, MPI_MAX, grid->comm);
+    MPI_Allreduce(MPI_IN_PLACE, &bad, 1, MPI_INT, MPI_MAX, grid->comm);
+    if ( bad ) {
+	SUPERLU_FREE(w);
+	return 1;
+    }
+    wmin = -buf[0];
+    wmax = buf[1];
+    range = SUPERLU_MAX(wmax - wmin, 1.0);
+
+    if ( !(row2col = intMalloc_dist(SUPERLU_MAX(m_loc, 1))) )
+	ABORT("Malloc fails for row2col[].");
+    if ( !(freerows = intMalloc_dist(SUPERLU_MAX(m_loc, 1))) )
+	ABORT("Malloc fails for freerows[].");
+    if ( !(col2row = intMalloc_dist(n)) )
+	ABORT("Malloc fails for col2row[].");
+    if ( !(winner = intMalloc_dist(n)) )
+	ABORT("Malloc fails for winner[].");
+    if ( !(touched = intMalloc_dist(n)) )
+	ABORT("Malloc fails for touched[].");
+    if ( !(price = (double *) SUPERLU_MALLOC(n * sizeof(double))) )
+	ABORT("Malloc fails for price[].");
+    if ( !(maxbid = (double *) SUPERLU_MALLOC(n * sizeof(double))) )
+	ABORT("Malloc fails for maxbid[].");
+    /* A process sends at most m_loc bids and receives at most m. */
+    if ( !(sendidx = intMalloc_dist(2 * SUPERLU_MAX(m_loc, 1))) )
+	ABORT("Malloc fails for sendidx[].");
+    if ( !(sendbid = (double *) SUPERLU_MALLOC(SUPERLU_MAX(m_loc, 1)
+					       * sizeof(double))) )
+	ABORT("Malloc fails for sendbid[].");
+    if ( !(recvidx = intMalloc_dist(2 * m)) )
+	ABORT("Malloc fails for recvidx[].");
+    if ( !(recvbid = (double *) SUPERLU_MALLOC(m * sizeof(double))) )
+	ABORT("Malloc fails for recvbid[].");
+    if ( !(counts = SUPERLU_MALLOC(4 * nprocs * sizeof(int))) )
+	ABORT("Malloc fails for counts[].");
+    displs = counts + nprocs;
+    counts2 = displs + nprocs;
+    displs2 = counts2 + nprocs;
+
+    for (j = 0; j < n; ++j) {
+	price[j] = 0.0;
+	winner[j] = EMPTY;
+	maxbid[j] = -HUGE_VAL;
+    }
+
+    /* With eps < range/n the matching is within range of the optimum
+       sum of the log weights; the phases before that bring the prices
+       close to their final values cheaply. */
+    eps_final = range / (n + 1);
+    eps = range / AUCTION_EPS_FACTOR;
+    if ( eps < eps_final ) eps = eps_final;
+
+    for (;;) { /* epsilon-scaling phases */
+	/* Start a phase with everything unmatched, keeping the prices. */
+	for (j = 0; j < n; ++j) col2row[j] = EMPTY;
+	for (i = 0; i < m_loc; ++i) {
+	    row2col[i] = EMPTY;
+	    freerows[i] = i;
+	}
+	nfree = m_loc;
+
+	/* If A has a perfect matching, the prices stay bounded during a
+	   phase; a price above pbound means there is none. */
+	best = -HUGE_VAL;
+	second = HUGE_VAL;
+	for (j = 0; j < n; ++j) {
+	    best = SUPERLU_MAX(best, price[j]);
+	    second = SUPERLU_MIN(second, price[j]);
+	}
+	pbound = best + n * (range + (best - second) + eps);
+
+	for (;;) { /* auction rounds */
+	    /* Bids of the unmatched local rows: the best column, and the
+	       price at which its value equals that of the second best. */
+	    for (k = 0; k < nfree; ++k) {
+		i = freerows[k];
+		best = second = -HUGE_VAL;
+		jbest = EMPTY;
+		for (q = rowptr[i]; q < rowptr[i+1]; ++q) {
+		    if ( w[q] == -HUGE_VAL ) continue;
+		    v = w[q] - price[colind[q]];
+		    if ( v > best ) {
+			second = best;
+			best = v;
+			jbest = colind[q];
+		    } else if ( v > second ) second = v;
+		}
+		if ( second == -HUGE_VAL ) second = best - range;
+		sendidx[2*k] = jbest;
+		sendidx[2*k+1] = fst_row + i;
+		sendbid[k] = price[jbest] + (best - second) + eps;
+	    }
+
+	    p = nfree;
+	    MPI_Allgather(&p, 1, MPI_INT, counts, 1, MPI_INT, grid->comm);
+	    displs[0] = 0;
+	    for (p = 1; p < nprocs; ++p) displs[p] = displs[p-1] + counts[p-1];
+	    nfree_all = displs[nprocs-1] + counts[nprocs-1];
+	    if ( nfree_all == 0 ) break;
+	    for (p = 0; p < nprocs; ++p) {
+		counts2[p] = 2 * counts[p];
+		displs2[p] = 2 * displs[p];
+	    }
+	    MPI_Allgatherv(sendidx, 2 * nfree, mpi_int_t,
+			   recvidx, counts2, displs2, mpi_int_t, grid->comm);
+	    MPI_Allgatherv(sendbid, nfree, MPI_DOUBLE,
+			   recvbid, counts, displs, MPI_DOUBLE, grid->comm);
+
+	    /* Every process resolves all the bids in the same order; the
+	       highest bid for a column wins, the first one on ties. */
+	    ntouched = 0;
+	    for (k = 0; k < nfree_all; ++k) {
+		j = recvidx[2*k];
+		if ( winner[j] == EMPTY ) touched[ntouched++] = j;
+		if ( recvbid[k] > maxbid[j] ) {
+		    maxbid[j] = recvbid[k];
+		    winner[j] = recvidx[2*k+1];
+		}
+	    }
+
+	    nfree = 0;
+	    bad = 0;
+	    for (k = 0; k < ntouched; ++k) {
+		j = touched[k];
+		irow = col2row[j];
+		if ( irow != EMPTY && irow >= fst_row && irow < fst_row + m_loc )
+		    row2col[irow - fst_row] = EMPTY; /* outbid */
+		col2row[j] = winner[j];
+		price[j] = maxbid[j];
+		if ( price[j] > pbound ) bad = 1;
+		irow = winner[j];
+		if ( irow >= fst_row && irow < fst_row + m_loc )
+		    row2col[irow - fst_row] = j;
+		winner[j] = EMPTY;
+		maxbid[j] = -HUGE_VAL;
+	    }
+	    if ( bad ) break; /* the same on all processes */
+
+	    /* The rows that lost their bid, or were outbid. */
+	    for (i = 0; i < m_loc; ++i)
+		if ( row2col[i] == EMPTY ) freerows[nfree++] = i;
+	} /* end auction rounds */
+
+	if ( bad ) { /* structurally singular */
+	    iinfo = 2;
+	    break;
+	}
+	if ( eps <= eps_final ) break;
+	eps = SUPERLU_MAX(eps / AUCTION_EPS_FACTOR, eps_final);
+    } /* end epsilon-scaling phases */
+
+    if ( iinfo == 0 ) {
+	for (j = 0; j < n; ++j) perm_r[col2row[j]] = j;
+
+	if ( R1 && C1 ) {
+	    /* Row duals u_i = max_j (w_ij - price_j), so that
+	       |a_ij| exp(-u_i) exp(-price_j) <= 1. */
+	    for (i = 0; i < m_loc; ++i) {
+		best = -HUGE_VAL;
+		for (q = rowptr[i]; q < rowptr[i+1]; ++q)
+		    if ( w[q] != -HUGE_VAL )
+			best = SUPERLU_MAX(best, w[q] - price[colind[q]]);
+		sendbid[i] = exp(-best);
+	    }
+	    p = m_loc;
+	    MPI_Allgather(&p, 1, MPI_INT, counts, 1, MPI_INT, grid->comm);
+	    displs[0] = 0;
+	    for (p = 1; p < nprocs; ++p) displs[p] = displs[p-1] + counts[p-1];
+	    MPI_Allgatherv(sendbid, m_loc, MPI_DOUBLE,
+			   recvbid, counts, displs, MPI_DOUBLE, grid->comm);
+	    for (i = 0; i < m; ++i) R1[i] = recvbid[i];
+	    for (j = 0; j < n; ++j) C1[j] = exp(-price[j]);
+	}
+    }
+
+    SUPERLU_FREE(w);
+    SUPERLU_FREE(row2col);
+    SUPERLU_FREE(freerows);
+    SUPERLU_FREE(col2row);
+    SUPERLU_FREE(winner);
+    SUPERLU_FREE(touched);
+    SUPERLU_FREE(price);
+    SUPERLU_FREE(maxbid);
+    SUPERLU_FREE(sendidx);
+    SUPERLU_FREE(sendbid);
+    SUPERLU_FREE(recvidx);
+    SUPERLU_FREE(recvbid);
+    SUPERLU_FREE(counts);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(grid->iam, "Exit psldperm_auction()");
+#endif
+    return iinfo;
+}
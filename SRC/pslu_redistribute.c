@@ -0,0 +1,460 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Moves the factors onto another process grid for the solves
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include "superlu_sdefs.h"
+
+static int
+lu_cmp_int_t(const void *a, const void *b)
+{
+    int_t x = *(const int_t *) a, y = *(const int_t *) b;
+    return ( x > y ) - ( x < y );
+}
+
+/* Gather the variable-size pieces buf[0:cnt) of all the processes of
+   comm into *all, of *tot entries. */
+static void
+lu_allgather(int_t *buf, int cnt, MPI_Comm comm, int np, int_t **all,
+	     int *tot)
+{
+    int *cnts, *displs, p;
+
+    if ( !(cnts = SUPERLU_MALLOC(2 * np * sizeof(int))) )
+	ABORT("Malloc fails for cnts[].");
+    displs = cnts + np;
+    MPI_Allgather(&cnt, 1, MPI_INT, cnts, 1, MPI_INT, comm);
+    for (*tot = 0, p = 0; p < np; ++p) {
+	displs[p] = *tot;
+	*tot += cnts[p];
+    }
+    if ( !(*all = intMalloc_dist(SUPERLU_MAX(*tot, 1))) )
+	ABORT("Malloc fails for all[].");
+    MPI_Allgatherv(buf, cnt, mpi_int_t, *all, cnts, displs, mpi_int_t, comm);
+    SUPERLU_FREE(cnts);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PSLU_REDISTRIBUTE moves the factors L and U computed on grid onto
+ * grid1, a smaller or differently shaped grid, so that the solves run
+ * there. A large square grid suits psgstrf(), while the triangular solves
+ * are latency-bound and run better on fewer processes; the processes of
+ * grid outside grid1 are free once LUstruct is destroyed.
+ *
+ * The global structure of L and U is gathered from the blocks on grid,
+ * the blocks of grid1 and the communication structures of the solves are
+ * set up from it by psdistribute(), and the values are sent block by
+ * block to their owners on grid1. Nothing is refactored.
+ *
+ * The solves on grid1 are done by psgssvx() with Fact = FACTORED, the
+ * same ScalePermstruct, and B distributed by block rows on grid1. The
+ * refinement needs A on grid1 as psgssvx() leaves it (scaled by R and C,
+ * columns permuted by perm_c); otherwise use IterRefine = NOREFINE.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         The options of the factorization; with DiagInv = YES, the
+ *         inverses of the diagonal blocks are computed by the first solve
+ *         on grid1.
+ *
+ * n       (input) int_t
+ *         The order of A.
+ *
+ * grid    (input) gridinfo_t*
+ *         The grid of the factorization. The routine is collective over
+ *         it; the processes outside it return at once.
+ *
+ * ScalePermstruct (input) sScalePermstruct_t*
+ *         The scalings and permutations of the factorization, the same on
+ *         all the processes.
+ *
+ * LUstruct (input) sLUstruct_t*
+ *         The factors on grid, unchanged; sDestroy_LU() releases them.
+ *
+ * grid1   (input) gridinfo_t*
+ *         The grid of the solves, made by superlu_gridinit() or
+ *         superlu_gridmap() of processes of grid; a process belongs to it
+ *         if grid1->iam < grid1->nprow * grid1->npcol.
+ *
+ * LUstruct1 (output) sLUstruct_t*
+ *         On the processes of grid1, initialized by sLUstructInit() on
+ *         entry, and the factors on grid1 on exit; unused elsewhere.
+ *
+ * info    (output) int*
+ *         = 0: successful exit
+ *         < 0: if info = -i, the i-th argument had an illegal value
+ *              (LUstruct must hold both L and U).
+ * </pre>
+ */
+void
+psLU_redistribute(superlu_dist_options_t *options, int_t n,
+		  gridinfo_t *grid, sScalePermstruct_t *ScalePermstruct,
+		  sLUstruct_t *LUstruct, gridinfo_t *grid1,
+		  sLUstruct_t *LUstruct1, int *info)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    sLocalLU_t *Llu = LUstruct->Llu, *Llu1;
+    Glu_freeable_t Glu_freeable;
+    SuperMatrix A1;
+    int_t  *xsup, *supno, *xlsub, *lsub, *xusub, *usub, *cnt, *all;
+    int_t  *index, *ibuf, *ibuf1, *rowpos;
+    int_t  nsupers, gb, jb, gk, lk, lb, nr, nsupc, nsupr, fsupc1;
+    int_t  i, j, c, p, q, r0, m_loc1, fst_row1;
+    float  *lusup, *dbuf, *dbuf1;
+    int    np = grid->nprow * grid->npcol, np1, iam = grid->iam, in1;
+    int    myrow, mycol, pdest, tot, len, b;
+    int    *new_to_old, *icnt, *dcnt, *icnt1, *dcnt1, *idsp, *ddsp,
+	   *idsp1, *ddsp1, *ipos, *dpos;
+
+    *info = 0;
+    if ( iam >= np ) return;
+    if ( Llu->Udropped ) *info = -5;
+    if ( *info ) {
+	pxerr_dist("psLU_redistribute", grid, -*info);
+	return;
+    }
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter psLU_redistribute()");
+#endif
+
+    xsup = Glu_persist->xsup;
+    supno = Glu_persist->supno;
+    nsupers = supno[n-1] + 1;
+    myrow = MYROW( iam, grid );
+    mycol = MYCOL( iam, grid );
+    np1 = grid1->nprow * grid1->npcol;
+    in1 = ( grid1->iam < np1 );
+
+    /* Where the processes of grid1 are in grid. */
+    if ( !(new_to_old = SUPERLU_MALLOC((np + np1) * sizeof(int))) )
+	ABORT("Malloc fails for new_to_old[].");
+    len = in1 ? grid1->iam : -1;
+    MPI_Allgather(&len, 1, MPI_INT, &new_to_old[np1], 1, MPI_INT,
+		  grid->comm);
+    for (p = 0; p < np1; ++p) new_to_old[p] = -1;
+    for (p = 0; p < np; ++p)
+	if ( new_to_old[np1 + p] >= 0 ) new_to_old[new_to_old[np1 + p]] = p;
+    for (p = 0; p < np1; ++p)
+	if ( new_to_old[p] < 0 )
+	    ABORT("psLU_redistribute: grid1 is not a subset of grid.");
+
+    /* ------------------------------------------------------------
+       THE GLOBAL STRUCTURE OF L: (k, number of rows, rows) for each
+       local block column.
+       ------------------------------------------------------------*/
+    lk = CEILING( nsupers, grid->npcol );
+    for (len = 0, lb = 0; lb < lk; ++lb)
+	if ( (index = Llu->Lrowind_bc_ptr[lb]) ) len += 2 + index[1];
+    if ( !(ibuf = intMalloc_dist(SUPERLU_MAX(len, 1))) )
+	ABORT("Malloc fails for ibuf[].");
+    for (len = 0, lb = 0; lb < lk; ++lb) {
+	if ( !(index = Llu->Lrowind_bc_ptr[lb]) ) continue;
+	ibuf[len++] = lb * grid->npcol + mycol;
+	ibuf[len++] = index[1];
+	for (p = BC_HEADER, b = 0; b < index[0]; ++b) {
+	    nr = index[p+1];
+	    for (i = 0; i < nr; ++i) ibuf[len++] = index[p + LB_DESCRIPTOR + i];
+	    p += LB_DESCRIPTOR + nr;
+	}
+    }
+    lu_allgather(ibuf, len, grid->comm, np, &all, &tot);
+    SUPERLU_FREE(ibuf);
+
+    if ( !(cnt = intCalloc_dist(nsupers + 1)) )
+	ABORT("Calloc fails for cnt[].");
+    for (p = 0; p < tot; p += 2 + all[p+1]) cnt[all[p]] += all[p+1];
+    if ( !(xlsub = intMalloc_dist(n + 1)) ||
+	 !(lsub = intMalloc_dist(SUPERLU_MAX(tot, 1))) )
+	ABORT("Malloc fails for xlsub[] and lsub[].");
+    /* The structure of supernode k is at xlsub[xsup[k]], the other
+       columns are empty. */
+    for (q = 0, gk = 0; gk < nsupers; ++gk) {
+	xlsub[xsup[gk]] = q;
+	q += cnt[gk];
+	for (j = xsup[gk] + 1; j < xsup[gk+1]; ++j) xlsub[j] = q;
+	cnt[gk] = xlsub[xsup[gk]];
+    }
+    xlsub[n] = q;
+    for (p = 0; p < tot; p += 2 + all[p+1]) {
+	gk = all[p];
+	for (i = 0; i < all[p+1]; ++i) lsub[cnt[gk]++] = all[p + 2 + i];
+    }
+    /* Ascending, so that the diagonal block comes first, in order. */
+    for (gk = 0; gk < nsupers; ++gk)
+	qsort(&lsub[xlsub[xsup[gk]]], xlsub[xsup[gk]+1] - xlsub[xsup[gk]],
+	      sizeof(int_t), lu_cmp_int_t);
+    SUPERLU_FREE(all);
+
+    /* ------------------------------------------------------------
+       THE GLOBAL STRUCTURE OF U: (column, first row) of each segment.
+       ------------------------------------------------------------*/
+    lk = CEILING( nsupers, grid->nprow );
+    for (len = 0, lb = 0; lb < lk; ++lb) {
+	if ( !(index = Llu->Ufstnz_br_ptr[lb]) ) continue;
+	for (p = BR_HEADER, b = 0; b < index[0]; ++b) {
+	    nsupc = SuperSize( index[p] );
+	    len += 2 * nsupc;
+	    p += UB_DESCRIPTOR + nsupc;
+	}
+    }
+    if ( !(ibuf = intMalloc_dist(SUPERLU_MAX(len, 1))) )
+	ABORT("Malloc fails for ibuf[].");
+    for (len = 0, lb = 0; lb < lk; ++lb) {
+	if ( !(index = Llu->Ufstnz_br_ptr[lb]) ) continue;
+	fsupc1 = FstBlockC( lb * grid->nprow + myrow + 1 );
+	for (p = BR_HEADER, b = 0; b < index[0]; ++b) {
+	    jb = index[p];
+	    nsupc = SuperSize( jb );
+	    p += UB_DESCRIPTOR;
+	    for (c = 0; c < nsupc; ++c)
+		if ( index[p+c] < fsupc1 ) {
+		    ibuf[len++] = FstBlockC( jb ) + c;
+		    ibuf[len++] = index[p+c];
+		}
+	    p += nsupc;
+	}
+    }
+    lu_allgather(ibuf, len, grid->comm, np, &all, &tot);
+    SUPERLU_FREE(ibuf);
+    SUPERLU_FREE(cnt);
+
+    if ( !(xusub = intCalloc_dist(n + 1)) ||
+	 !(usub = intMalloc_dist(SUPERLU_MAX(tot / 2, 1))) )
+	ABORT("Malloc fails for xusub[] and usub[].");
+    for (p = 0; p < tot; p += 2) ++xusub[all[p] + 1];
+    for (j = 0; j < n; ++j) xusub[j+1] += xusub[j];
+    for (p = 0; p < tot; p += 2) usub[xusub[all[p]]++] = all[p+1];
+    for (j = n; j > 0; --j) xusub[j] = xusub[j-1];
+    xusub[0] = 0;
+    SUPERLU_FREE(all);
+
+    /* ------------------------------------------------------------
+       THE BLOCKS OF GRID1, EMPTY, AND THE STRUCTURES OF THE SOLVES.
+       ------------------------------------------------------------*/
+    if ( in1 ) {
+	Glu_persist_t *Glu_persist1 = LUstruct1->Glu_persist;
+
+	if ( !(Glu_persist1->xsup = intMalloc_dist(n + 1)) ||
+	     !(Glu_persist1->supno = intMalloc_dist(n + 1)) )
+	    ABORT("Malloc fails for xsup[] and supno[].");
+	memcpy(Glu_persist1->xsup, xsup, (nsupers + 1) * sizeof(int_t));
+	memcpy(Glu_persist1->supno, supno, n * sizeof(int_t));
+	memcpy(LUstruct1->etree, LUstruct->etree, n * sizeof(int_t));
+
+	Glu_freeable.lsub = lsub;
+	Glu_freeable.xlsub = xlsub;
+	Glu_freeable.usub = usub;
+	Glu_freeable.xusub = xusub;
+	Glu_freeable.nzlmax = xlsub[n];
+	Glu_freeable.nzumax = xusub[n];
+	Glu_freeable.MemModel = SYSTEM;
+
+	/* No entries: psdistribute() only builds the structures. */
+	m_loc1 = n / np1;
+	fst_row1 = m_loc1 * grid1->iam;
+	if ( grid1->iam == np1 - 1 ) m_loc1 = n - fst_row1;
+	if ( !(ibuf = intCalloc_dist(m_loc1 + 1)) ||
+	     !(ibuf1 = intMalloc_dist(1)) || !(dbuf = floatMalloc_dist(1)) )
+	    ABORT("Malloc fails for A1.");
+	sCreate_CompRowLoc_Matrix_dist(&A1, n, n, 0, m_loc1, fst_row1, dbuf,
+				       ibuf1, ibuf, SLU_NR_loc, SLU_S, SLU_GE);
+	psdistribute(DOFACT, n, &A1, ScalePermstruct, &Glu_freeable,
+		     LUstruct1, grid1);
+	Destroy_CompRowLoc_Matrix_dist(&A1);
+    }
+    SUPERLU_FREE(lsub);
+    SUPERLU_FREE(xlsub);
+    SUPERLU_FREE(usub);
+    SUPERLU_FREE(xusub);
+
+    /* ------------------------------------------------------------
+       SEND THE VALUES, BLOCK BY BLOCK:
+         L(gb,k): (0, k, gb, nr, rows) and the nr-by-nsupc values;
+         U(gb,jb): (1, gb, jb, len) and the len values.
+       ------------------------------------------------------------*/
+    if ( !(icnt = SUPERLU_MALLOC(12 * np * sizeof(int))) )
+	ABORT("Malloc fails for icnt[].");
+    dcnt = icnt + np;   icnt1 = dcnt + np;  dcnt1 = icnt1 + np;
+    idsp = dcnt1 + np;  ddsp = idsp + np;   idsp1 = ddsp + np;
+    ddsp1 = idsp1 + np; ipos = ddsp1 + np;  dpos = ipos + np;
+    for (p = 0; p < np; ++p) icnt[p] = dcnt[p] = 0;
+
+    for (q = 0; q < 2; ++q) { /* count, then pack */
+	if ( q == 1 ) {
+	    for (idsp[0] = ddsp[0] = 0, p = 1; p < np; ++p) {
+		idsp[p] = idsp[p-1] + icnt[p-1];
+		ddsp[p] = ddsp[p-1] + dcnt[p-1];
+	    }
+	    if ( !(ibuf = intMalloc_dist(SUPERLU_MAX(idsp[np-1] + icnt[np-1], 1)))
+		 || !(dbuf = floatMalloc_dist(SUPERLU_MAX(ddsp[np-1] + dcnt[np-1], 1))) )
+		ABORT("Malloc fails for the send buffers.");
+	    for (p = 0; p < np; ++p) {
+		ipos[p] = idsp[p];
+		dpos[p] = ddsp[p];
+	    }
+	}
+
+	lk = CEILING( nsupers, grid->npcol );
+	for (lb = 0; lb < lk; ++lb) {
+	    if ( !(index = Llu->Lrowind_bc_ptr[lb]) ) continue;
+	    gk = lb * grid->npcol + mycol;
+	    nsupc = SuperSize( gk );
+	    nsupr = index[1];
+	    lusup = Llu->Lnzval_bc_ptr[lb];
+	    for (r0 = 0, p = BC_HEADER, b = 0; b < index[0]; ++b) {
+		gb = index[p];
+		nr = index[p+1];
+		pdest = new_to_old[PNUM( PROW( gb, grid1 ), PCOL( gk, grid1 ),
+					 grid1 )];
+		if ( q == 0 ) {
+		    icnt[pdest] += 4 + nr;
+		    dcnt[pdest] += nr * nsupc;
+		} else {
+		    ibuf[ipos[pdest]++] = 0;
+		    ibuf[ipos[pdest]++] = gk;
+		    ibuf[ipos[pdest]++] = gb;
+		    ibuf[ipos[pdest]++] = nr;
+		    for (i = 0; i < nr; ++i)
+			ibuf[ipos[pdest]++] = index[p + LB_DESCRIPTOR + i];
+		    for (c = 0; c < nsupc; ++c)
+			for (i = 0; i < nr; ++i)
+			    dbuf[dpos[pdest]++] = lusup[r0 + i + c * nsupr];
+		}
+		r0 += nr;
+		p += LB_DESCRIPTOR + nr;
+	    }
+	}
+
+	lk = CEILING( nsupers, grid->nprow );
+	for (lb = 0; lb < lk; ++lb) {
+	    if ( !(index = Llu->Ufstnz_br_ptr[lb]) ) continue;
+	    gb = lb * grid->nprow + myrow;
+	    lusup = Llu->Unzval_br_ptr[lb];
+	    for (r0 = 0, p = BR_HEADER, b = 0; b < index[0]; ++b) {
+		jb = index[p];
+		len = index[p+1];
+		if ( len ) {
+		    pdest = new_to_old[PNUM( PROW( gb, grid1 ),
+					     PCOL( jb, grid1 ), grid1 )];
+		    if ( q == 0 ) {
+			icnt[pdest] += 4;
+			dcnt[pdest] += len;
+		    } else {
+			ibuf[ipos[pdest]++] = 1;
+			ibuf[ipos[pdest]++] = gb;
+			ibuf[ipos[pdest]++] = jb;
+			ibuf[ipos[pdest]++] = len;
+			memcpy(&dbuf[dpos[pdest]], &lusup[r0],
+			       len * sizeof(float));
+			dpos[pdest] += len;
+		    }
+		}
+		r0 += len;
+		p += UB_DESCRIPTOR + SuperSize( jb );
+	    }
+	}
+    }
+
+    MPI_Alltoall(icnt, 1, MPI_INT, icnt1, 1, MPI_INT, grid->comm);
+    MPI_Alltoall(dcnt, 1, MPI_INT, dcnt1, 1, MPI_INT, grid->comm);
+    for (idsp1[0] = ddsp1[0] = 0, p = 1; p < np; ++p) {
+	idsp1[p] = idsp1[p-1] + icnt1[p-1];
+	ddsp1[p] = ddsp1[p-1] + dcnt1[p-1];
+    }
+    if ( !(ibuf1 = intMalloc_dist(SUPERLU_MAX(idsp1[np-1] + icnt1[np-1], 1)))
+	 || !(dbuf1 = floatMalloc_dist(SUPERLU_MAX(ddsp1[np-1] + dcnt1[np-1], 1))) )
+	ABORT("Malloc fails for the receive buffers.");
+    MPI_Alltoallv(ibuf, icnt, idsp, mpi_int_t, ibuf1, icnt1, idsp1,
+		  mpi_int_t, grid->comm);
+    MPI_Alltoallv(dbuf, dcnt, ddsp, MPI_FLOAT, dbuf1, dcnt1, ddsp1,
+		  MPI_FLOAT, grid->comm);
+    SUPERLU_FREE(ibuf);
+    SUPERLU_FREE(dbuf);
+
+    /* ------------------------------------------------------------
+       PUT THE VALUES IN THE BLOCKS OF GRID1.
+       ------------------------------------------------------------*/
+    if ( in1 ) {
+	Llu1 = LUstruct1->Llu;
+	if ( !(rowpos = intMalloc_dist(n)) )
+	    ABORT("Malloc fails for rowpos[].");
+	tot = idsp1[np-1] + icnt1[np-1];
+	for (q = 0, r0 = 0; q < tot; ) {
+	    if ( ibuf1[q] == 0 ) { /* L(gb,gk) */
+		gk = ibuf1[q+1];
+		gb = ibuf1[q+2];
+		nr = ibuf1[q+3];
+		nsupc = SuperSize( gk );
+		index = Llu1->Lrowind_bc_ptr[LBj( gk, grid1 )];
+		lusup = Llu1->Lnzval_bc_ptr[LBj( gk, grid1 )];
+		nsupr = index[1];
+		for (j = 0, p = BC_HEADER, b = 0; b < index[0]; ++b) {
+		    if ( index[p] == gb ) break;
+		    j += index[p+1];
+		    p += LB_DESCRIPTOR + index[p+1];
+		}
+		if ( b == index[0] || index[p+1] != nr )
+		    ABORT("psLU_redistribute: L blocks do not match.");
+		for (i = 0; i < nr; ++i)
+		    rowpos[index[p + LB_DESCRIPTOR + i]] = j + i;
+		for (c = 0; c < nsupc; ++c)
+		    for (i = 0; i < nr; ++i)
+			lusup[rowpos[ibuf1[q+4+i]] + c * nsupr] =
+			    dbuf1[r0 + i + c * nr];
+		q += 4 + nr;
+		r0 += nr * nsupc;
+	    } else { /* U(gb,jb) */
+		gb = ibuf1[q+1];
+		jb = ibuf1[q+2];
+		len = ibuf1[q+3];
+		index = Llu1->Ufstnz_br_ptr[LBi( gb, grid1 )];
+		lusup = Llu1->Unzval_br_ptr[LBi( gb, grid1 )];
+		for (j = 0, p = BR_HEADER, b = 0; b < index[0]; ++b) {
+		    if ( index[p] == jb ) break;
+		    j += index[p+1];
+		    p += UB_DESCRIPTOR + SuperSize( index[p] );
+		}
+		if ( b == index[0] || index[p+1] != len )
+		    ABORT("psLU_redistribute: U blocks do not match.");
+		memcpy(&lusup[j], &dbuf1[r0], len * sizeof(float));
+		q += 4;
+		r0 += len;
+	    }
+	}
+	SUPERLU_FREE(rowpos);
+
+	if ( options->DiagInv == YES ) psDefer_Diag_Inv(options, LUstruct1);
+    }
+    SUPERLU_FREE(ibuf1);
+    SUPERLU_FREE(dbuf1);
+    SUPERLU_FREE(icnt);
+    SUPERLU_FREE(new_to_old);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psLU_redistribute()");
+#endif
+}
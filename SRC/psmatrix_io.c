@@ -0,0 +1,369 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Read and write a distributed matrix in binary with MPI-IO
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * pswrite_binary_loc() writes a matrix in SLU_NR_loc format into one file,
+ * and psread_binary_loc() reads it back on any number of processes, each
+ * reading only its own rows. Unlike sread_binary(), nothing goes through
+ * process 0.
+ *
+ * File layout, compressed rows of the global matrix:
+ *   header   : 16 long long words, see MAT_IO_* below: magic, version,
+ *              bytes of an index (4 or 8), type of the values (Dtype_t,
+ *              SLU_D or SLU_S), m, n, nnz, and the checksums of the three
+ *              arrays (see mat_io_sum())
+ *   rowptr   : m+1 indices, rowptr[0] = 0 and rowptr[m] = nnz
+ *   colind   : nnz indices
+ *   nzval    : nnz values
+ * The indices and values may be read with another int_t or precision than
+ * they were written with.
+ * </pre>
+ */
+
+#include <string.h>
+#include "superlu_sdefs.h"
+
+#define MAT_IO_MAGIC   0x4d554c53   /* "SLUM" */
+#define MAT_IO_VERSION 1
+#define MAT_IO_HEADER  16
+#define MAT_IO_CHUNK   (1 << 30)    /* Largest single MPI-IO request */
+
+/*! \brief Read or write nbytes at off on all the processes of comm.
+ *
+ * The requests are collective and at most MAT_IO_CHUNK bytes each; a
+ * process with less to do joins the remaining ones with 0 bytes.
+ * Returns 1 if a request fails.
+ */
+static int
+mat_io_all(MPI_File fh, MPI_Offset off, void *p, size_t nbytes, int write,
+	   MPI_Comm comm)
+{
+    char *c = (char *) p;
+    long long nc = (nbytes + MAT_IO_CHUNK - 1) / MAT_IO_CHUNK, maxc, i;
+    size_t len;
+    int err = 0;
+    MPI_Status status;
+
+    MPI_Allreduce(&nc, &maxc, 1, MPI_LONG_LONG, MPI_MAX, comm);
+    for (i = 0; i < maxc; ++i) {
+	len = SUPERLU_MIN(nbytes, MAT_IO_CHUNK);
+	if ( write )
+	    err |= MPI_File_write_at_all(fh, off, c, (int) len, MPI_BYTE,
+					 &status) != MPI_SUCCESS;
+	else
+	    err |= MPI_File_read_at_all(fh, off, c, (int) len, MPI_BYTE,
+					&status) != MPI_SUCCESS;
+	off += len;
+	c += len;
+	nbytes -= len;
+    }
+    return err;
+}
+
+/*! \brief Checksum of the elements first:first+n-1 of an array of size
+ *         bytes each, held in p[].
+ *
+ * The sum over the elements of their bits times (2*i+1) for element i,
+ * modulo 2^64: it detects changed and swapped elements, and the sums of
+ * the parts of an array add up to that of the whole array.
+ */
+static unsigned long long
+mat_io_sum(void *p, int size, long long first, size_t n)
+{
+    unsigned long long s = 0, w, i;
+    unsigned char *c = (unsigned char *) p;
+
+    for (i = 0; i < n; ++i) {
+	w = 0;
+	memcpy(&w, c + i * size, size);
+	s += w * (2 * (first + i) + 1);
+    }
+    return s;
+}
+
+/*! \brief Convert n indices of size bytes each in p[] to int_t in q[],
+ *         minus shift. Returns 1 if an index does not fit in int_t.
+ */
+static int
+mat_io_int(void *p, int size, int_t *q, size_t n, long long shift)
+{
+    long long v;
+    size_t i;
+    int err = 0;
+
+    for (i = 0; i < n; ++i) {
+	v = ( size == 4 ) ? ((int *) p)[i] : ((long long *) p)[i];
+	v -= shift;
+	if ( v != (int_t) v ) err = 1;
+	q[i] = (int_t) v;
+    }
+    return err;
+}
+
+/*! \brief Write a distributed matrix into a binary file.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Write the matrix A, distributed by rows in SLU_NR_loc format, into
+ *   the binary file "filename" with MPI-IO. The routine is collective over
+ *   grid->comm. Each process writes its rows at their place in the file;
+ *   the rows of the processes must together be 0:m-1, in any order.
+ *
+ * Arguments
+ * =========
+ *
+ * filename (input) char*
+ *        Name of the file, the same on all processes.
+ *
+ * A      (input) SuperMatrix*
+ *        The local rows of A, in SLU_NR_loc format with float values.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * Return value
+ * ============
+ *   = 0: successful exit
+ *   < 0: the file could not be created or written (-1), or A is not a
+ *        matrix of that format, or its rows do not cover 0:m-1 (-2).
+ * </pre>
+ */
+int
+pswrite_binary_loc(char *filename, SuperMatrix *A, gridinfo_t *grid)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t m_loc = Astore->m_loc, *rowptr = Astore->rowptr, *gptr;
+    int iam = grid->iam, nprocs = grid->nprow * grid->npcol, p, err;
+    long long mine[3], *all, nnz, start, last;
+    unsigned long long sum[3];
+    long long hdr[MAT_IO_HEADER];
+    MPI_Offset off;
+    MPI_File fh;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter pswrite_binary_loc()");
+#endif
+
+    /* Where the rows of each process go. */
+    mine[0] = Astore->fst_row;
+    mine[1] = m_loc;
+    mine[2] = Astore->nnz_loc;
+    if ( !(all = (long long *) SUPERLU_MALLOC(3 * nprocs * sizeof(long long))) )
+	ABORT("Malloc fails for all[].");
+    MPI_Allgather(mine, 3, MPI_LONG_LONG, all, 3, MPI_LONG_LONG, grid->comm);
+    nnz = start = last = 0;
+    for (p = 0; p < nprocs; ++p) {
+	nnz += all[3*p+2];
+	last += all[3*p+1];
+	if ( all[3*p] < mine[0] ) start += all[3*p+2];
+    }
+    SUPERLU_FREE(all);
+    if ( A->Stype != SLU_NR_loc || A->Dtype != SLU_S || last != A->nrow )
+	return -2;
+    last = ( mine[0] + m_loc == A->nrow ); /* writes rowptr[m] */
+
+    /* rowptr[] with the global offsets. */
+    if ( !(gptr = intMalloc_dist(m_loc + 1)) )
+	ABORT("Malloc fails for gptr[].");
+    for (p = 0; p <= m_loc; ++p) gptr[p] = rowptr[p] + start;
+    sum[0] = mat_io_sum(gptr, sizeof(int_t), mine[0], m_loc + last);
+    sum[1] = mat_io_sum(Astore->colind, sizeof(int_t), start, mine[2]);
+    sum[2] = mat_io_sum(Astore->nzval, sizeof(float), start, mine[2]);
+    MPI_Allreduce(MPI_IN_PLACE, sum, 3, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+		  grid->comm);
+
+    MPI_File_delete(filename, MPI_INFO_NULL); /* Truncate an existing file. */
+    MPI_Barrier(grid->comm);
+    err = MPI_File_open(grid->comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+			MPI_INFO_NULL, &fh);
+    if ( err != MPI_SUCCESS ) {
+	SUPERLU_FREE(gptr);
+	return -1;
+    }
+
+    memset(hdr, 0, sizeof(hdr));
+    hdr[0] = MAT_IO_MAGIC;
+    hdr[1] = MAT_IO_VERSION;
+    hdr[2] = sizeof(int_t);
+    hdr[3] = SLU_S;
+    hdr[4] = A->nrow;
+    hdr[5] = A->ncol;
+    hdr[6] = nnz;
+    memcpy(&hdr[7], sum, sizeof(sum));
+    err = mat_io_all(fh, 0, hdr, iam ? 0 : sizeof(hdr), 1, grid->comm);
+
+    off = sizeof(hdr) + mine[0] * sizeof(int_t);
+    err |= mat_io_all(fh, off, gptr, (m_loc + last) * sizeof(int_t), 1,
+		      grid->comm);
+    off = sizeof(hdr) + (A->nrow + 1 + start) * sizeof(int_t);
+    err |= mat_io_all(fh, off, Astore->colind, mine[2] * sizeof(int_t), 1,
+		      grid->comm);
+    off = sizeof(hdr) + (A->nrow + 1 + nnz) * sizeof(int_t)
+	+ start * sizeof(float);
+    err |= mat_io_all(fh, off, Astore->nzval, mine[2] * sizeof(float), 1,
+		      grid->comm);
+
+    MPI_File_close(&fh);
+    SUPERLU_FREE(gptr);
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_BOR, grid->comm);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit pswrite_binary_loc()");
+#endif
+    return err ? -1 : 0;
+}
+
+/*! \brief Read a matrix written by pswrite_binary_loc().
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Read the matrix of the binary file "filename" with MPI-IO, and
+ *   distribute it by rows in SLU_NR_loc format: process iam gets
+ *   m/nprocs rows starting at iam*(m/nprocs), and the last one the rest,
+ *   as screate_matrix() does. The routine is collective over grid->comm;
+ *   each process reads only its own rows. The checksums of the file are
+ *   verified.
+ *
+ * Arguments
+ * =========
+ *
+ * filename (input) char*
+ *        Name of the file, the same on all processes.
+ *
+ * A      (output) SuperMatrix*
+ *        The local rows of the matrix, with float values, created by
+ *        sCreate_CompRowLoc_Matrix_dist(). Not set if an error is
+ *        returned.
+ *
+ * grid   (input) gridinfo_t*
+ *        The 2D process mesh.
+ *
+ * Return value
+ * ============
+ *   = 0: successful exit
+ *   < 0: the file could not be opened or read (-1), it is not such a file
+ *        or of a later version (-2), its indices do not fit in int_t (-3),
+ *        or a checksum does not match (-4).
+ * </pre>
+ */
+int
+psread_binary_loc(char *filename, SuperMatrix *A, gridinfo_t *grid)
+{
+    int iam = grid->iam, nprocs = grid->nprow * grid->npcol, err, isize, vsize;
+    long long hdr[MAT_IO_HEADER], m, n, nnz, m_loc, fst_row, start, nnz_loc;
+    long long bounds[2];
+    unsigned long long sum[3];
+    int_t *rowptr, *colind, i;
+    float *nzval;
+    void *buf, *p;
+    MPI_Offset off;
+    MPI_File fh;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter psread_binary_loc()");
+#endif
+
+    err = MPI_File_open(grid->comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL,
+			&fh);
+    if ( err != MPI_SUCCESS ) return -1;
+
+    err = mat_io_all(fh, 0, hdr, iam ? 0 : sizeof(hdr), 0, grid->comm);
+    MPI_Bcast(&err, 1, MPI_INT, 0, grid->comm);
+    MPI_Bcast(hdr, MAT_IO_HEADER, MPI_LONG_LONG, 0, grid->comm);
+    if ( err || hdr[0] != MAT_IO_MAGIC || hdr[1] > MAT_IO_VERSION
+	 || (hdr[2] != 4 && hdr[2] != 8)
+	 || (hdr[3] != SLU_S && hdr[3] != SLU_D) ) {
+	MPI_File_close(&fh);
+	return err ? -1 : -2;
+    }
+    isize = hdr[2];
+    vsize = ( hdr[3] == SLU_S ) ? sizeof(float) : sizeof(double);
+    m = hdr[4];
+    n = hdr[5];
+    nnz = hdr[6];
+    if ( m != (int_t) m || n != (int_t) n || nnz != (int_t) nnz ) {
+	MPI_File_close(&fh);
+	return -3;
+    }
+
+    /* My rows, and where their entries are. */
+    m_loc = m / nprocs;
+    fst_row = iam * m_loc;
+    if ( iam == nprocs - 1 ) m_loc = m - fst_row;
+    if ( !(rowptr = intMalloc_dist(m_loc + 1)) )
+	ABORT("Malloc fails for rowptr[].");
+    if ( !(buf = SUPERLU_MALLOC((m_loc + 1) * SUPERLU_MAX(isize, sizeof(int_t)))) )
+	ABORT("Malloc fails for buf[].");
+    off = sizeof(hdr) + fst_row * isize;
+    err = mat_io_all(fh, off, buf, (m_loc + 1) * isize, 0, grid->comm);
+    sum[0] = mat_io_sum(buf, isize, fst_row, m_loc + (iam == nprocs - 1));
+    bounds[0] = ( isize == 4 ) ? ((int *) buf)[0] : ((long long *) buf)[0];
+    bounds[1] = ( isize == 4 ) ? ((int *) buf)[m_loc]
+	: ((long long *) buf)[m_loc];
+    start = bounds[0];
+    nnz_loc = bounds[1] - start;
+    err |= mat_io_int(buf, isize, rowptr, m_loc + 1, start) << 1;
+    SUPERLU_FREE(buf);
+    if ( nnz_loc < 0 || start < 0 || bounds[1] > nnz ) nnz_loc = start = 0;
+
+    /* colind[] and nzval[] of my rows, through buf[] if converted. */
+    if ( !(colind = intMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for colind[].");
+    if ( !(nzval = floatMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for nzval[].");
+    buf = NULL;
+    if ( isize != sizeof(int_t) || vsize != sizeof(float) )
+	if ( !(buf = SUPERLU_MALLOC(SUPERLU_MAX(nnz_loc, 1) *
+				    SUPERLU_MAX(isize, vsize))) )
+	    ABORT("Malloc fails for buf[].");
+    p = ( isize == sizeof(int_t) ) ? (void *) colind : buf;
+    off = sizeof(hdr) + (m + 1 + start) * isize;
+    err |= mat_io_all(fh, off, p, nnz_loc * isize, 0, grid->comm);
+    sum[1] = mat_io_sum(p, isize, start, nnz_loc);
+    err |= mat_io_int(p, isize, colind, nnz_loc, 0) << 1;
+    p = ( vsize == sizeof(float) ) ? (void *) nzval : buf;
+    off = sizeof(hdr) + (m + 1 + nnz) * isize + start * vsize;
+    err |= mat_io_all(fh, off, p, nnz_loc * vsize, 0, grid->comm);
+    sum[2] = mat_io_sum(p, vsize, start, nnz_loc);
+    if ( vsize != sizeof(float) )
+	for (i = 0; i < nnz_loc; ++i) nzval[i] = ((double *) p)[i];
+    if ( buf ) SUPERLU_FREE(buf);
+    MPI_File_close(&fh);
+
+    MPI_Allreduce(MPI_IN_PLACE, sum, 3, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+		  grid->comm);
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_BOR, grid->comm);
+    if ( !err && memcmp(sum, &hdr[7], sizeof(sum)) ) err = 4;
+    if ( err ) {
+	SUPERLU_FREE(rowptr);
+	SUPERLU_FREE(colind);
+	SUPERLU_FREE(nzval);
+	return ( err & 1 ) ? -1 : ( err & 2 ) ? -3 : -4;
+    }
+
+    sCreate_CompRowLoc_Matrix_dist(A, m, n, nnz_loc, m_loc, fst_row,
+				   nzval, colind, rowptr,
+				   SLU_NR_loc, SLU_S, SLU_GE);
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit psread_binary_loc()");
+#endif
+    return 0;
+}
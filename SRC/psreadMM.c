@@ -0,0 +1,337 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Parallel reader of MatrixMarket and triplet files into a
+ *        distributed SLU_NR_loc matrix
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Unlike sreadMM_dist() and sreadtriple_dist(), which parse the whole file
+ * on one process and leave it to the caller to broadcast the global matrix,
+ * every process maps the file with mmap(), parses an equal byte range of
+ * the entries, and sends each entry to the process owning its row. The
+ * rows are distributed in contiguous blocks of m/P rows, the last process
+ * getting the remainder, as in the example drivers (screate_matrix.c),
+ * and the entries given several times are summed, see pscoord_to_loc().
+ * The file must be visible to all processes.
+ * </pre>
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "superlu_sdefs.h"
+
+/* Powers of ten that are exact in double precision. */
+static const double exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const char *
+skip_blank(const char *p, const char *end)
+{
+    while ( p < end && (*p == ' ' || *p == '\t' || *p == '\r') ) ++p;
+    return p;
+}
+
+/*! \brief Parse a nonnegative integer; return NULL if there is none. */
+static const char *
+parse_int(const char *p, const char *end, int_t *val)
+{
+    int_t v = 0;
+
+    p = skip_blank(p, end);
+    if ( p == end || !isdigit((unsigned char) *p) ) return NULL;
+    while ( p < end && isdigit((unsigned char) *p) ) v = 10 * v + (*p++ - '0');
+    *val = v;
+    return p;
+}
+
+/*! \brief Parse a floating-point number; return NULL if there is none.
+ *
+ * If the significant digits form an integer below 2^53 and the decimal
+ * exponent is at most 22 in magnitude, both are exact doubles and one
+ * multiplication or division gives the correctly rounded result; this
+ * covers the output of the usual "%.15e"-style writers. The other numbers
+ * are passed to strtod().
+ */
+static const char *
+parse_double(const char *p, const char *end, double *val)
+{
+    const char *start;
+    unsigned long long mant = 0;
+    int neg = 0, ndig = 0, exp10 = 0, e = 0, eneg = 0;
+    char buf[64];
+    size_t len;
+
+    p = skip_blank(p, end);
+    start = p;
+    if ( p < end && (*p == '-' || *p == '+') ) neg = (*p++ == '-');
+    while ( p < end && isdigit((unsigned char) *p) ) {
+	if ( mant || *p != '0' ) ++ndig;
+	if ( ndig <= 18 ) mant = 10 * mant + (*p - '0');
+	else ++exp10;
+	++p;
+    }
+    if ( p < end && *p == '.' ) {
+	++p;
+	while ( p < end && isdigit((unsigned char) *p) ) {
+	    if ( mant || *p != '0' ) ++ndig;
+	    if ( ndig <= 18 ) { mant = 10 * mant + (*p - '0'); --exp10; }
+	    ++p;
+	}
+    }
+    if ( p == start || (p == start + 1 && (neg || *start == '+')) )
+	return NULL;
+    if ( p < end && (*p == 'e' || *p == 'E' || *p == 'd' || *p == 'D') ) {
+	++p;
+	if ( p < end && (*p == '-' || *p == '+') ) eneg = (*p++ == '-');
+	while ( p < end && isdigit((unsigned char) *p) ) {
+	    if ( e < 100000 ) e = 10 * e + (*p - '0');
+	    ++p;
+	}
+	exp10 += eneg ? -e : e;
+    }
+
+    if ( ndig <= 18 && mant <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22 ) {
+	*val = exp10 >= 0 ? (double) mant * exact_pow10[exp10]
+	                  : (double) mant / exact_pow10[-exp10];
+	if ( neg ) *val = -*val;
+    } else { /* Slow path: copy the token; 'd' exponents become 'e'. */
+	len = SUPERLU_MIN((size_t) (p - start), sizeof(buf) - 1);
+	memcpy(buf, start, len);
+	buf[len] = '\0';
+	for (e = 0; e < len; ++e) if ( buf[e] == 'd' || buf[e] == 'D' ) buf[e] = 'e';
+	*val = strtod(buf, NULL);
+    }
+    return p;
+}
+
+static const char *
+next_line(const char *p, const char *end)
+{
+    const char *q = memchr(p, '\n', end - p);
+    return q ? q + 1 : end;
+}
+
+/*! \brief Read the header; return the offset of the first entry.
+ *
+ * <pre>
+ * mm = 1: MatrixMarket, "%%MatrixMarket matrix coordinate real general",
+ *         comment lines, then "m n nnz".
+ * mm = 0: triplet file, "m n nnz" on the first line.
+ * sym is set to 0 (general), 1 (symmetric) or -1 (skew-symmetric).
+ * </pre>
+ */
+static size_t
+read_header(const char *buf, size_t size, int mm, int_t *m, int_t *n,
+	    int_t *nnz, int *sym)
+{
+    const char *p = buf, *end = buf + size, *q;
+    char line[512], banner[64], mtx[64], crd[64], arith[64], symm[64];
+    size_t len;
+
+    *sym = 0;
+    if ( mm ) {
+	q = next_line(p, end);
+	len = SUPERLU_MIN((size_t) (q - p), sizeof(line) - 1);
+	memcpy(line, p, len);
+	line[len] = '\0';
+	for (len = 0; line[len]; ++len) line[len] = tolower(line[len]);
+	if ( sscanf(line, "%63s %63s %63s %63s %63s",
+		    banner, mtx, crd, arith, symm) != 5 )
+	    ABORT("Invalid header (first line does not contain 5 tokens)");
+	if ( strcmp(banner, "%%matrixmarket") )
+	    ABORT("Invalid header (first token is not \"%%MatrixMarket\")");
+	if ( strcmp(mtx, "matrix") || strcmp(crd, "coordinate") )
+	    ABORT("Not a matrix in coordinate format.");
+	if ( strcmp(arith, "real") && strcmp(arith, "integer") )
+	    ABORT("Only real or integer matrices can be read.");
+	if ( !strcmp(symm, "symmetric") ) *sym = 1;
+	else if ( !strcmp(symm, "skew-symmetric") ) *sym = -1;
+	else if ( strcmp(symm, "general") )
+	    ABORT("Unknown symmetry.");
+	p = q;
+	/* Skip comments and blank lines. */
+	while ( p < end && (*(q = skip_blank(p, end)) == '%' || *q == '\n') )
+	    p = next_line(p, end);
+    }
+
+    if ( !(p = parse_int(p, end, m)) || !(p = parse_int(p, end, n)) ||
+	 !(p = parse_int(p, end, nnz)) )
+	ABORT("Cannot read the matrix dimensions.");
+    return next_line(p, end) - buf;
+}
+
+/*! \brief Parse the entries in buf[begin:end); return their number. */
+static int_t
+parse_entries(const char *buf, size_t begin, size_t end, int sym,
+	      int_t *row, int_t *col, float *val, int_t *minind)
+{
+    const char *p = buf + begin, *e = buf + end, *q;
+    int_t nz = 0, i, j;
+    double v;
+
+    *minind = 1;
+    while ( p < e ) {
+	q = skip_blank(p, e);
+	if ( q == e || *q == '\n' || *q == '%' ) { /* Blank or comment line */
+	    p = next_line(q, e);
+	    continue;
+	}
+	if ( !(q = parse_int(q, e, &i)) || !(q = parse_int(q, e, &j)) ||
+	     !(q = parse_double(q, e, &v)) ) {
+	    fprintf(stderr, "Cannot parse entry at byte %lld\n",
+		    (long long) (p - buf));
+	    ABORT("Invalid matrix entry.");
+	}
+	*minind = SUPERLU_MIN(*minind, SUPERLU_MIN(i, j));
+	row[nz] = i;
+	col[nz] = j;
+	val[nz] = v;
+	++nz;
+	if ( sym && i != j ) { /* Expand the other triangle. */
+	    row[nz] = j;
+	    col[nz] = i;
+	    val[nz] = sym * v;
+	    ++nz;
+	}
+	p = next_line(q, e);
+    }
+    return nz;
+}
+
+/*! \brief Start of the byte range parsed by process p. */
+static size_t
+range_start(const char *buf, size_t data, size_t size, int p, int procs)
+{
+    size_t s = data + (size - data) / procs * p;
+    const char *q;
+
+    if ( p == 0 ) return data;
+    if ( p == procs ) return size;
+    if ( buf[s-1] == '\n' ) return s;
+    q = memchr(buf + s, '\n', size - s);
+    return q ? q - buf + 1 : size;
+}
+
+static int
+psread_coord_loc(char *filename, int mm, SuperMatrix *A, gridinfo_t *grid)
+{
+    int iam = grid->iam, procs = grid->nprow * grid->npcol, p, fd;
+    struct stat st;
+    char *buf;
+    size_t size, data, begin, end;
+    int_t m, n, nnz, nz, m_loc_fst, k, minind, nlines;
+    int_t *row, *col, *start;
+    float *val;
+    int sym;
+
+    /* Map the file. */
+    if ( (fd = open(filename, O_RDONLY)) < 0 || fstat(fd, &st) ) {
+	fprintf(stderr, "Cannot open %s\n", filename);
+	ABORT("File cannot be opened.");
+    }
+    size = st.st_size;
+    buf = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if ( buf == MAP_FAILED ) ABORT("mmap fails for the matrix file.");
+    close(fd);
+#ifdef MADV_SEQUENTIAL
+    madvise(buf, size, MADV_SEQUENTIAL);
+#endif
+
+    data = read_header(buf, size, mm, &m, &n, &nnz, &sym);
+    begin = range_start(buf, data, size, iam, procs);
+    end = range_start(buf, data, size, iam + 1, procs);
+
+    /* Count the lines of my range to size the triplet arrays. */
+    nlines = 0;
+    for (k = begin; k < end; ++k) nlines += (buf[k] == '\n');
+    nlines = (sym ? 2 : 1) * (nlines + 1);
+    if ( !(row = intMalloc_dist(nlines)) || !(col = intMalloc_dist(nlines)) )
+	ABORT("Malloc fails for row[] / col[].");
+    if ( !(val = floatMalloc_dist(nlines)) )
+	ABORT("Malloc fails for val[].");
+
+    nz = parse_entries(buf, begin, end, sym, row, col, val, &minind);
+    munmap(buf, size);
+
+    /* Indices are zero-based if any of them is zero. */
+    MPI_Allreduce(MPI_IN_PLACE, &minind, 1, mpi_int_t, MPI_MIN, grid->comm);
+    for (k = 0; k < nz; ++k) {
+	if ( minind > 0 ) { --row[k]; --col[k]; }
+	if ( row[k] >= m || col[k] >= n ) {
+	    fprintf(stderr, "(" IFMT ", " IFMT ") out of bound\n", row[k], col[k]);
+	    ABORT("Matrix entry out of bound.");
+	}
+    }
+#if ( PRNTlevel>=1 )
+    if ( !iam ) {
+	printf("m " IFMT ", n " IFMT ", nonz " IFMT ", %s-based%s\n", m, n, nnz,
+	       minind > 0 ? "one" : "zero", sym ? ", expanded" : "");
+	fflush(stdout);
+    }
+#endif
+
+    /* The row distribution of screate_matrix(). */
+    m_loc_fst = m / procs;
+    if ( !(start = intMalloc_dist(procs + 1)) )
+	ABORT("Malloc fails for start[].");
+    for (p = 0; p < procs; ++p) start[p] = p * m_loc_fst;
+    start[procs] = m;
+
+    /* Send each entry to the owner of its row, and sort the rows. */
+    pscoord_to_loc(m, n, nz, row, col, val, start, A, grid);
+    SUPERLU_FREE(start);
+    return 0;
+}
+
+/*! \brief Read a MatrixMarket file in parallel into a distributed matrix.
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   Collective over grid->comm. Each process parses a part of the file
+ *   "filename" in "%%MatrixMarket matrix coordinate real" format
+ *   (general, symmetric or skew-symmetric; the other triangle is
+ *   expanded) and A is created in SLU_NR_loc format with block rows of
+ *   m/P rows. Indices are zero-based if any index in the file is zero.
+ *   A is freed by Destroy_CompRowLoc_Matrix_dist().
+ * </pre>
+ */
+int
+psreadMM_loc(char *filename, SuperMatrix *A, gridinfo_t *grid)
+{
+    return psread_coord_loc(filename, 1, A, grid);
+}
+
+/*! \brief Read a triplet file in parallel into a distributed matrix.
+ *
+ * <pre>
+ *   Same as psreadMM_loc() for the format read by sreadtriple_dist():
+ *   "m n nnz" on the first line, followed by "row col value" lines.
+ * </pre>
+ */
+int
+psreadtriple_loc(char *filename, SuperMatrix *A, gridinfo_t *grid)
+{
+    return psread_coord_loc(filename, 0, A, grid);
+}
@@ -82,7 +82,7 @@ intraLvl_symbfact
  comm_symbfact_t *, psymbfact_stat_t *, int_t *, int_t *, int_t *, int_t *, 
  int_t *, int_t *, int_t *, MPI_Comm, MPI_Comm *);
 
-static void
+static int_t
 initLvl_symbfact
 (int_t, int, int_t, int_t, Pslu_freeable_t *, 
  Llu_symbfact_t *, vtcsInfo_symbfact_t *, psymbfact_stat_t *, MPI_Comm, 
@@ -225,6 +225,14 @@ float symbfact_dist
  *   < 0, number of bytes allocated on return from the symbolic factorization.
  *   > 0, number of bytes allocated when out of memory.
  *
+ * Environment
+ * ===========
+ *   SUPERLU_SYMB_SCRATCH names a node-local directory.  When it is set,
+ *   the expansions of the L and U structures write their content to an
+ *   unnamed file there and free the old storage before allocating the
+ *   new one, which lowers the peak memory of the processes owning the
+ *   dense upper separators.
+ *
  * Sketch of the algorithm
  * =======================
  *
@@ -309,7 +317,10 @@ float symbfact_dist
   VInfo.maxSzBlk = sp_ienv_dist(3);
   maxSzBlk = VInfo.maxSzBlk;
   
-  mark = EMPTY;
+  /* mark must differ from EMPTY, the initial value of marker[]: with
+     empty domains (trivial separator tree), rl_update() is the first
+     to use it */
+  mark = 0;
   nsuper_loc = 0;
   nextl   = 0; nextu      = 0;
   neltsZr = 0; neltsTotal = 0;
@@ -318,11 +329,12 @@ float symbfact_dist
   n = A->ncol;
   min_mn = SUPERLU_MIN( m, n );
   
-  if (!(tempArray = intMalloc_symbfact(n))) {
+  /* one extra entry: marker[vtx+1] is looked at for the last vertex */
+  if (!(tempArray = intMalloc_symbfact(n+1))) {
     fprintf (stderr, "Malloc fails for tempArray[].\n");  
     return (PS.allocMem);
   }
-  PS.allocMem += n * sizeof(int_t);
+  PS.allocMem += (n+1) * sizeof(int_t);
   
 #if ( PROFlevel>=1 )  
   t = SuperLU_timer_();
@@ -394,7 +406,7 @@ float symbfact_dist
     }
     
     /* set to EMPTY marker[] array */
-    for (i = 0; i < n; i++)
+    for (i = 0; i <= n; i++)
       tempArray[i] = EMPTY;
     
     szSep = nprocs_symb;
@@ -446,9 +458,10 @@ float symbfact_dist
 	    t1 = SuperLU_timer_();	  
 #endif
 	    if (VInfo.filledSep != FILLED_SEPS)
-	      initLvl_symbfact(n, iam, fstVtx, lstVtx,
-			       Pslu_freeable, &Llu_symbfact, &VInfo, &PS, commLvls[jSep], 
-			       tempArray, nextl, nextu);
+	      if (initLvl_symbfact(n, iam, fstVtx, lstVtx,
+				   Pslu_freeable, &Llu_symbfact, &VInfo, &PS,
+				   commLvls[jSep], tempArray, nextl, nextu))
+		return (PS.allocMem);
 #if ( PROFlevel>=1 )
 	    t2 = SuperLU_timer_();
 	    time_lvls[3*lvl] = t2 - t1;
@@ -1864,8 +1877,8 @@ int symbfact_alloc
   usub = (void *) SUPERLU_MALLOC(nzumax * lword);
   
   while ( !lsub || !usub ) {
-    if (!lsub) SUPERLU_FREE(lsub); 
-    if (!usub) SUPERLU_FREE(usub);
+    if (lsub) SUPERLU_FREE(lsub); 
+    if (usub) SUPERLU_FREE(usub);
     
     nzlmax /= 2;     nzlmax = alpha * nzlmax;
     nzumax /= 2;     nzumax = alpha * nzumax;
@@ -2869,9 +2882,10 @@ domain_symbfact
  * and n when i is zero before current separator.
  *
  * Set up nvtcsLvl_loc.
+ * Returns ERROR_RET when the storage of L or U can't be expanded.
  * </pre>
  */
-static void
+static int_t
 initLvl_symbfact
 (
  int_t n,       /* Input - order of the matrix */
@@ -2969,18 +2983,20 @@ initLvl_symbfact
   
   if (use_fillcnts) {
     if (nextl + nelts_fill_l >= Llu_symbfact->szLsub - nelts_ainf)
-      mem_error = 
-	psymbfact_LUXpandMem (iam, n, fstVtx, nextl,
-			      nextl + nelts_fill_l, LSUB,
-			      RL_SYMB, 1, 
-			      Pslu_freeable, Llu_symbfact, VInfo, PS);
+      if (mem_error = 
+	  psymbfact_LUXpandMem (iam, n, fstVtx, nextl,
+				nextl + nelts_fill_l, LSUB,
+				RL_SYMB, 1, 
+				Pslu_freeable, Llu_symbfact, VInfo, PS))
+	return (mem_error);
     lsub = Llu_symbfact->lsub;
     if (nextu + nelts_fill_u >= Llu_symbfact->szUsub - nelts_asup) 
-      mem_error = 
-	psymbfact_LUXpandMem (iam, n, fstVtx, nextu,
-			      nextu + nelts_fill_u, USUB,
-			      RL_SYMB, 1, 
-			      Pslu_freeable, Llu_symbfact, VInfo, PS);      
+      if (mem_error = 
+	  psymbfact_LUXpandMem (iam, n, fstVtx, nextu,
+				nextu + nelts_fill_u, USUB,
+				RL_SYMB, 1, 
+				Pslu_freeable, Llu_symbfact, VInfo, PS))
+	return (mem_error);
     usub = Llu_symbfact->usub;
   }
 
@@ -3063,6 +3079,7 @@ initLvl_symbfact
     VInfo->nnz_asup_loc -= nelts_asup;
   }
   VInfo->fstVtx_nextLvl = fstVtx_nextLvl;
+  return SUCCES_RET;
 }
 
 
@@ -3567,7 +3584,7 @@ dnsUpSeps_symbfact
     if (nextl + lstVtx_lvl - vtx_elt >= Llu_symbfact->szLsub) {
       if (mem_error =
 	  psymbfact_LUXpandMem (iam, n, fstVtx_blk, nextl, 
-				nextl + fstVtx_lvl - vtx_elt,
+				nextl + lstVtx_lvl - vtx_elt + 1,
 				LSUB, DNS_UPSEPS, 1,
 				Pslu_freeable, Llu_symbfact, VInfo, PS))
 	return (mem_error);
@@ -3576,8 +3593,8 @@ dnsUpSeps_symbfact
     if (nextu + lstVtx_lvl - vtx_elt >= Llu_symbfact->szUsub) {
       if (mem_error =
 	  psymbfact_LUXpandMem (iam, n, fstVtx_blk, nextu, 
-				nextu + fstVtx_lvl - vtx_elt,
-				LSUB, DNS_UPSEPS, 1,
+				nextu + lstVtx_lvl - vtx_elt + 1,
+				USUB, DNS_UPSEPS, 1,
 				Pslu_freeable, Llu_symbfact, VInfo, PS))
 	return (mem_error);
       usub = Llu_symbfact->usub;
@@ -21,6 +21,10 @@ at the top-level directory.
  * </pre>
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "superlu_ddefs.h"
 #include "psymbfact.h"
 
@@ -32,7 +36,41 @@ copy_mem_int(int_t howmany, int_t* old, int_t* new)
 }
 
 
+/*! \brief Open an unnamed scratch file in $SUPERLU_SYMB_SCRATCH.
+ *
+ * <pre>
+ * Returns NULL when the variable is not set, or the file can't be
+ * created. The file is removed when it is closed.
+ * </pre>
+ */
+static FILE *
+spill_open(void)
+{
+  char *dir = getenv("SUPERLU_SYMB_SCRATCH"), *path;
+  FILE *fp = NULL;
+  int fd;
+
+  if (!dir || !dir[0]) return NULL;
+  if (!(path = (char *) SUPERLU_MALLOC(strlen(dir) + 32))) return NULL;
+  sprintf(path, "%s/superlu_symbXXXXXX", dir);
+  if ((fd = mkstemp(path)) >= 0) {
+    unlink(path);
+    if (!(fp = fdopen(fd, "w+b"))) close(fd);
+  }
+  SUPERLU_FREE(path);
+  return fp;
+}
+
 /*! \brief Expand the existing storage to accommodate more fill-ins.
+ *
+ * <pre>
+ * When the allocation fails, the growth factor is reduced as in
+ * symbfact_SubXpand(), down to min_new_len.  If free_prev_mem = 1,
+ * prev_mem is freed on return; when SUPERLU_SYMB_SCRATCH names a
+ * node-local directory, the part of prev_mem to be copied is then
+ * written there and prev_mem is freed before the new allocation, so
+ * the old and new storage are never held at the same time.
+ * </pre>
  */
 /************************************************************************/
 static int_t *expand
@@ -46,31 +84,64 @@ static int_t *expand
 			     starting from the beginning of the memory */
  int_t len_tcopy_fend,  /* size of the memory to be copied to new store,
 			    starting from the end of the memory */
+ int_t free_prev_mem,   /* =1 if prev_mem has to be freed */
  psymbfact_stat_t *PS
  )
 {
   float exp = 2.0;
   float alpha;
   int_t *new_mem;
-  int_t new_len, tries, lword, extra, bytes_to_copy;
+  int_t new_len, tries, lword;
+  FILE  *fp = NULL;
   
   alpha = exp;
   lword = sizeof(int_t);
+
+  /* Spill the content of prev_mem to scratch */
+  if (free_prev_mem && (fp = spill_open())) {
+    if (fwrite(prev_mem, lword, len_tcopy_fbeg, fp) == len_tcopy_fbeg &&
+	fwrite(&(prev_mem[prev_len-len_tcopy_fend]), lword, len_tcopy_fend,
+	       fp) == len_tcopy_fend && fflush(fp) == 0) {
+      SUPERLU_FREE (prev_mem);
+      prev_mem = NULL;
+    } else {
+      fclose(fp);
+      fp = NULL;
+    }
+  }
   
   new_len = alpha * prev_len;
   if (min_new_len > 0 && new_len < min_new_len)
     new_len = min_new_len;
   
   new_mem = (void *) SUPERLU_MALLOC(new_len * lword);
-  PS->allocMem += new_len * lword;
+  tries = 0;
+  while ( !new_mem && new_len > min_new_len && ++tries <= 10 ) {
+    alpha = SuperLU_Reduce(alpha);
+    new_len = alpha * prev_len;
+    if (new_len < min_new_len) new_len = min_new_len;
+    if (new_len <= prev_len) break;
+    new_mem = (void *) SUPERLU_MALLOC(new_len * lword);
+  }
   
   if (new_mem) {
-    if (len_tcopy_fbeg != 0)
-      copy_mem_int(len_tcopy_fbeg, prev_mem, new_mem);
-    if (len_tcopy_fend != 0)  
-      copy_mem_int(len_tcopy_fend, &(prev_mem[prev_len-len_tcopy_fend]), 
-		   &(new_mem[new_len-len_tcopy_fend]));
+    PS->allocMem += new_len * lword;
+    if (fp) {
+      rewind(fp);
+      if (fread(new_mem, lword, len_tcopy_fbeg, fp) != len_tcopy_fbeg ||
+	  fread(&(new_mem[new_len-len_tcopy_fend]), lword, len_tcopy_fend,
+		fp) != len_tcopy_fend)
+	ABORT("Can't read back the symbolic factorization scratch file.");
+    } else {
+      if (len_tcopy_fbeg != 0)
+	copy_mem_int(len_tcopy_fbeg, prev_mem, new_mem);
+      if (len_tcopy_fend != 0)  
+	copy_mem_int(len_tcopy_fend, &(prev_mem[prev_len-len_tcopy_fend]), 
+		     &(new_mem[new_len-len_tcopy_fend]));
+    }
   }
+  if (fp) fclose(fp);
+  if (free_prev_mem && prev_mem && new_mem) SUPERLU_FREE (prev_mem);
   *p_new_len = new_len;
   return new_mem;
   
@@ -154,7 +225,7 @@ int_t psymbfact_LUXpandMem
 	  iam, mem_type, vtxXp); 
 #endif
   new_mem = expand (prev_len, min_new_len, prev_mem,
-		    &new_len, len_tcopy_fbeg, len_tcopy_fend, PS);
+		    &new_len, len_tcopy_fbeg, len_tcopy_fend, free_prev_mem, PS);
   if ( !new_mem ) {
     fprintf(stderr, "Pe[" IFMT "] Can't exp MemType " IFMT ": prv_len " IFMT
 	    " min_new " IFMT " new_l " IFMT "\n",
@@ -180,11 +251,6 @@ int_t psymbfact_LUXpandMem
     xsub[vtx_lid] = i;
   }
 
-  if (free_prev_mem) {
-    SUPERLU_FREE (prev_mem);
-    PS->allocMem -= 0;
-  }
-  
   if ( mem_type == LSUB ) {
     Llu_symbfact->lsub   = new_mem;
     Llu_symbfact->szLsub = new_len;
@@ -530,7 +596,7 @@ int_t psymbfact_prLUXpand
 #endif
   
   new_mem = expand (prev_len, min_new_len, prev_mem, 
-		    &new_len, len_tcopy_fbeg, 0, PS);
+		    &new_len, len_tcopy_fbeg, 0, 1, PS);
   
   if ( !new_mem ) {
     fprintf(stderr, "Can't expand MemType %d: \n", mem_type);
@@ -545,8 +611,6 @@ int_t psymbfact_prLUXpand
     Llu_symbfact->usubPr  = new_mem;
     Llu_symbfact->szUsubPr = new_len;
   } else ABORT("Tries to expand nonexisting memory type.\n");
-  
-  SUPERLU_FREE (prev_mem);
 
   return SUCCES_RET;
 }
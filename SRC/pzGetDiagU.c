@@ -75,6 +75,13 @@ void pzGetDiagU(int_t n, zLUstruct_t *LUstruct, gridinfo_t *grid,
     zLocalLU_t *Llu = LUstruct->Llu;
     doublecomplex *zblock, *zwork, *lusup;
 
+#ifdef SLU_HAVE_COMPLEX
+    if ( LUstruct->cLUstruct ) { /* Single precision factors */
+	pzcGetDiagU(n, LUstruct, grid, diagU);
+	return;
+    }
+#endif
+
     iam = grid->iam;
     nsupers = Glu_persist->supno[n-1] + 1;
     xsup = Glu_persist->xsup;
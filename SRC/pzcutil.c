@@ -0,0 +1,266 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Mixed precision support: single precision complex LU factors
+ *        used by the double precision complex driver
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The complex counterpart of pdsutil.c: when options->SingleFactor = YES,
+ * pzgssvx() distributes and factors a single precision copy of the scaled
+ * and permuted matrix. The factors are kept in a cLUstruct_t attached to
+ * zLUstruct_t::cLUstruct, which shares the etree and the supernode
+ * partition (Glu_persist) with the double precision structure, and the
+ * residual and the update of the iterative refinement (pzgsrfs) remain in
+ * double precision.
+ * </pre>
+ */
+
+#include "superlu_zdefs.h"
+#include "superlu_cdefs.h"
+
+/*! \brief Return the single precision factors, allocating them if needed.
+ */
+static cLUstruct_t *
+zc_LUstruct(zLUstruct_t *LUstruct)
+{
+    cLUstruct_t *cLUstruct = (cLUstruct_t *) LUstruct->cLUstruct;
+
+    if ( !cLUstruct ) {
+	if ( !(cLUstruct = (cLUstruct_t *) SUPERLU_MALLOC(sizeof(cLUstruct_t))) )
+	    ABORT("Malloc fails for cLUstruct.");
+	if ( !(cLUstruct->Llu = (cLocalLU_t *) SUPERLU_MALLOC(sizeof(cLocalLU_t))) )
+	    ABORT("Malloc fails for cLocalLU_t.");
+	cLUstruct->Llu->inv = 0;
+	cLUstruct->dt = 'c';
+	LUstruct->cLUstruct = cLUstruct;
+    }
+
+    /* The symbolic data are owned by the double precision structure. */
+    cLUstruct->etree = LUstruct->etree;
+    cLUstruct->Glu_persist = LUstruct->Glu_persist;
+    return cLUstruct;
+}
+
+/*! \brief Set up a single precision view of the row and column permutations.
+ *
+ * Only perm_r[] and perm_c[] are used by the distribution and the
+ * triangular solve; the scaling has already been applied to A and B.
+ */
+static void
+zc_ScalePermstruct(zScalePermstruct_t *ScalePermstruct,
+		   cScalePermstruct_t *cScalePermstruct)
+{
+    cScalePermstruct->DiagScale = ScalePermstruct->DiagScale;
+    cScalePermstruct->R = NULL;
+    cScalePermstruct->C = NULL;
+    cScalePermstruct->perm_r = ScalePermstruct->perm_r;
+    cScalePermstruct->perm_c = ScalePermstruct->perm_c;
+}
+
+/*! \brief Make a single precision copy of the values of the distributed A.
+ *
+ * The row pointers and column indices are shared with A.
+ */
+static void
+zc_CompRowLoc_Matrix(SuperMatrix *A, SuperMatrix *cA)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t nnz_loc = Astore->nnz_loc, i;
+    doublecomplex *a = (doublecomplex *) Astore->nzval;
+    singlecomplex *nzval;
+
+    if ( !(nzval = singlecomplexMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for nzval[].");
+    for (i = 0; i < nnz_loc; ++i) {
+	nzval[i].r = (float) a[i].r;
+	nzval[i].i = (float) a[i].i;
+    }
+
+    cCreate_CompRowLoc_Matrix_dist(cA, A->nrow, A->ncol, nnz_loc,
+				   Astore->m_loc, Astore->fst_row, nzval,
+				   Astore->colind, Astore->rowptr,
+				   SLU_NR_loc, SLU_C, SLU_GE);
+}
+
+static void
+zc_Destroy_CompRowLoc_Matrix(SuperMatrix *cA)
+{
+    NRformat_loc *Astore = (NRformat_loc *) cA->Store;
+    SUPERLU_FREE(Astore->nzval);
+    SUPERLU_FREE(Astore);
+}
+
+/*! \brief Distribute a single precision copy of A into the L and U storage.
+ *
+ * Counterpart of pzdistribute(); the factors go to LUstruct->cLUstruct.
+ */
+float
+pzcdistribute(fact_t fact, int_t n, SuperMatrix *A,
+	      zScalePermstruct_t *ScalePermstruct,
+	      Glu_freeable_t *Glu_freeable, zLUstruct_t *LUstruct,
+	      gridinfo_t *grid)
+{
+    cLUstruct_t *cLUstruct = zc_LUstruct(LUstruct);
+    cScalePermstruct_t cScalePermstruct;
+    SuperMatrix cA;
+    float mem_use;
+
+    zc_ScalePermstruct(ScalePermstruct, &cScalePermstruct);
+    zc_CompRowLoc_Matrix(A, &cA);
+    mem_use = pcdistribute(fact, n, &cA, &cScalePermstruct, Glu_freeable,
+			   cLUstruct, grid);
+    zc_Destroy_CompRowLoc_Matrix(&cA);
+    return mem_use;
+}
+
+/*! \brief Counterpart of zdist_psymbtonum() for single precision factors.
+ */
+float
+zcdist_psymbtonum(fact_t fact, int_t n, SuperMatrix *A,
+		  zScalePermstruct_t *ScalePermstruct,
+		  Pslu_freeable_t *Pslu_freeable, zLUstruct_t *LUstruct,
+		  gridinfo_t *grid)
+{
+    cLUstruct_t *cLUstruct = zc_LUstruct(LUstruct);
+    cScalePermstruct_t cScalePermstruct;
+    SuperMatrix cA;
+    float mem_use;
+
+    zc_ScalePermstruct(ScalePermstruct, &cScalePermstruct);
+    zc_CompRowLoc_Matrix(A, &cA);
+    mem_use = cdist_psymbtonum(fact, n, &cA, &cScalePermstruct,
+			       Pslu_freeable, cLUstruct, grid);
+    zc_Destroy_CompRowLoc_Matrix(&cA);
+    return mem_use;
+}
+
+/*! \brief Factor the single precision copy of A, see pcgstrf().
+ */
+int_t
+pzcgstrf(superlu_dist_options_t *options, int m, int n, double anorm,
+	 zLUstruct_t *LUstruct, gridinfo_t *grid, SuperLUStat_t *stat,
+	 int *info)
+{
+    return pcgstrf(options, m, n, (float) anorm, zc_LUstruct(LUstruct),
+		   grid, stat, info);
+}
+
+/*! \brief Invert the diagonal blocks of the single precision factors.
+ */
+void
+pzcCompute_Diag_Inv(int_t n, zLUstruct_t *LUstruct, gridinfo_t *grid,
+		    SuperLUStat_t *stat, int *info)
+{
+    pcCompute_Diag_Inv(n, zc_LUstruct(LUstruct), grid, stat, info);
+}
+
+/*! \brief Solve A*X = B in double precision using the single precision
+ *         factors.
+ *
+ * B is rounded to single precision, solved with pcgstrs() and promoted
+ * back in place. The communication structures in SOLVEstruct do not depend
+ * on the precision and are shared with the single precision solve.
+ */
+void
+pzcgstrs(int_t n, zLUstruct_t *LUstruct,
+	 zScalePermstruct_t *ScalePermstruct, gridinfo_t *grid,
+	 doublecomplex *B, int_t m_loc, int_t fst_row, int_t ldb, int nrhs,
+	 zSOLVEstruct_t *SOLVEstruct, SuperLUStat_t *stat, int *info)
+{
+    cScalePermstruct_t cScalePermstruct;
+    cSOLVEstruct_t cSOLVEstruct;
+    singlecomplex *cB;
+    int_t i, j;
+
+    zc_ScalePermstruct(ScalePermstruct, &cScalePermstruct);
+    cSOLVEstruct.row_to_proc = SOLVEstruct->row_to_proc;
+    cSOLVEstruct.inv_perm_c = SOLVEstruct->inv_perm_c;
+    cSOLVEstruct.num_diag_procs = SOLVEstruct->num_diag_procs;
+    cSOLVEstruct.diag_procs = SOLVEstruct->diag_procs;
+    cSOLVEstruct.diag_len = SOLVEstruct->diag_len;
+    cSOLVEstruct.gstrs_comm = SOLVEstruct->gstrs_comm;
+    cSOLVEstruct.gsmv_comm = NULL;
+    cSOLVEstruct.A_colind_gsmv = NULL;
+    cSOLVEstruct.xrow_to_proc = SOLVEstruct->xrow_to_proc;
+
+    if ( !(cB = singlecomplexMalloc_dist(SUPERLU_MAX(ldb * nrhs, 1))) )
+	ABORT("Malloc fails for cB[].");
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) {
+	    cB[i + j*ldb].r = (float) B[i + j*ldb].r;
+	    cB[i + j*ldb].i = (float) B[i + j*ldb].i;
+	}
+
+    pcgstrs(n, zc_LUstruct(LUstruct), &cScalePermstruct, grid, cB,
+	    m_loc, fst_row, ldb, nrhs, &cSOLVEstruct, stat, info);
+
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) {
+	    B[i + j*ldb].r = cB[i + j*ldb].r;
+	    B[i + j*ldb].i = cB[i + j*ldb].i;
+	}
+    SUPERLU_FREE(cB);
+}
+
+/*! \brief Gather the diagonal of U from the single precision factors.
+ */
+void
+pzcGetDiagU(int_t n, zLUstruct_t *LUstruct, gridinfo_t *grid,
+	    doublecomplex *diagU)
+{
+    singlecomplex *cdiagU;
+    int_t i;
+
+    if ( !(cdiagU = singlecomplexMalloc_dist(SUPERLU_MAX(n, 1))) )
+	ABORT("Malloc fails for cdiagU[].");
+    pcGetDiagU(n, zc_LUstruct(LUstruct), grid, cdiagU);
+    for (i = 0; i < n; ++i) {
+	diagU[i].r = cdiagU[i].r;
+	diagU[i].i = cdiagU[i].i;
+    }
+    SUPERLU_FREE(cdiagU);
+}
+
+/*! \brief Query the memory used by the single precision factors.
+ */
+int_t
+zcQuerySpace_dist(int_t n, zLUstruct_t *LUstruct, gridinfo_t *grid,
+		  SuperLUStat_t *stat, superlu_dist_mem_usage_t *mem_usage)
+{
+    return cQuerySpace_dist(n, zc_LUstruct(LUstruct), grid, stat, mem_usage);
+}
+
+/*! \brief Set the single precision factor L to zero, see zZeroLblocks().
+ */
+void
+zcZeroLblocks(int iam, int_t n, gridinfo_t *grid, zLUstruct_t *LUstruct)
+{
+    cZeroLblocks(iam, n, grid, zc_LUstruct(LUstruct));
+}
+
+/*! \brief Destroy the single precision factors and detach them from LUstruct.
+ */
+void
+zcDestroy_LU(int_t n, gridinfo_t *grid, zLUstruct_t *LUstruct)
+{
+    cLUstruct_t *cLUstruct = (cLUstruct_t *) LUstruct->cLUstruct;
+
+    if ( !cLUstruct ) return;
+    cDestroy_LU(n, grid, zc_LUstruct(LUstruct));
+    SUPERLU_FREE(cLUstruct->Llu);
+    SUPERLU_FREE(cLUstruct);
+    LUstruct->cLUstruct = NULL;
+}
@@ -231,6 +231,13 @@ pzgsrfs(int_t n, SuperMatrix *A, double anorm, zLUstruct_t *LUstruct,
 #endif
 	    if ( berr[j] > eps && berr[j] * 2 <= lstres && count < ITMAX ) {
 		/* Compute new dx. */
+#ifdef SLU_HAVE_COMPLEX
+		if ( LUstruct->cLUstruct ) /* Single precision factors */
+		    pzcgstrs(n, LUstruct, ScalePermstruct, grid,
+			     dx, m_loc, fst_row, m_loc, 1,
+			     SOLVEstruct, stat, info);
+		else
+#endif
 		pzgstrs(n, LUstruct, ScalePermstruct, grid,
 			dx, m_loc, fst_row, m_loc, 1,
 			SOLVEstruct, stat, info);
@@ -348,6 +348,14 @@ at the top-level directory.
  *           = SLU_DOUBLE: accumulate residual in double precision.
  *           = SLU_EXTRA:  accumulate residual in extra precision.
  *
+ *         o SingleFactor (yes_no_t)
+ *           = NO:  compute the LU factors in double precision.
+ *           = YES: compute the LU factors in single precision (requires
+ *                  the single precision complex library); they are kept
+ *                  in LUstruct->cLUstruct and used by the triangular
+ *                  solves, while the residual and the update in iterative
+ *                  refinement are computed in double precision.
+ *
  *         NOTE: all options must be identical on all processes when
  *               calling this routine.
  *
@@ -1141,6 +1149,12 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	       NOTE: the row permutation Pc*Pr is applied internally in the
   	       distribution routine. */
 	    t = SuperLU_timer_();
+#ifdef SLU_HAVE_COMPLEX
+	    if ( options->SingleFactor == YES )
+	        dist_mem_use = pzcdistribute(Fact, n, A, ScalePermstruct,
+                                             Glu_freeable, LUstruct, grid);
+	    else
+#endif
 	    dist_mem_use = pzdistribute(Fact, n, A, ScalePermstruct,
                                       Glu_freeable, LUstruct, grid);
 	    stat->utime[DIST] = SuperLU_timer_() - t;
@@ -1158,6 +1172,12 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    for (j = 0; j < nnz_loc; ++j) colind[j] = perm_c[colind[j]];
 
     	    t = SuperLU_timer_();
+#ifdef SLU_HAVE_COMPLEX
+	    if ( options->SingleFactor == YES )
+	        dist_mem_use = zcdist_psymbtonum(Fact, n, A, ScalePermstruct,
+		  			         &Pslu_freeable, LUstruct, grid);
+	    else
+#endif
 	    dist_mem_use = zdist_psymbtonum(Fact, n, A, ScalePermstruct,
 		  			   &Pslu_freeable, LUstruct, grid);
 	    if (dist_mem_use > 0)
@@ -1174,6 +1194,11 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
     // {
 	// #pragma omp master
 	// {
+#ifdef SLU_HAVE_COMPLEX
+	if ( options->SingleFactor == YES )
+	    pzcgstrf(options, m, n, anorm, LUstruct, grid, stat, info);
+	else
+#endif
 	pzgstrf(options, m, n, anorm, LUstruct, grid, stat, info);
 	stat->utime[FACT] = SuperLU_timer_() - t;
 	// }
@@ -1281,6 +1306,11 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    int_t TinyPivots;
 	    float for_lu, total, max, avg, temp;
 
+#ifdef SLU_HAVE_COMPLEX
+	    if ( LUstruct->cLUstruct )
+	        zcQuerySpace_dist(n, LUstruct, grid, stat, &num_mem_usage);
+	    else
+#endif
 	    zQuerySpace_dist(n, LUstruct, grid, stat, &num_mem_usage);
 
 	    if (parSymbFact == TRUE) {
@@ -1412,6 +1442,11 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	if ( options->DiagInv==YES &&
              (options->SolveInitialized == NO || Fact == SamePattern ||
               Fact == SamePattern_SameRowPerm) ) {
+#ifdef SLU_HAVE_COMPLEX
+	    if ( LUstruct->cLUstruct )
+	        pzcCompute_Diag_Inv(n, LUstruct, grid, stat, info);
+	    else
+#endif
 	    pzCompute_Diag_Inv(n, LUstruct, grid, stat, info);
 	}
 
@@ -1420,6 +1455,12 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
     // {
 	// #pragma omp master
 	// {
+#ifdef SLU_HAVE_COMPLEX
+	if ( LUstruct->cLUstruct ) /* Single precision factors */
+	    pzcgstrs(n, LUstruct, ScalePermstruct, grid, X, m_loc,
+		     fst_row, ldb, nrhs, SOLVEstruct, stat, info);
+	else
+#endif
 	pzgstrs(n, LUstruct, ScalePermstruct, grid, X, m_loc,
 		fst_row, ldb, nrhs, SOLVEstruct, stat, info);
 	// }
@@ -409,6 +409,7 @@ void zLUstructInit(const int_t n, zLUstruct_t *LUstruct)
 	   SUPERLU_MALLOC(sizeof(zLocalLU_t))) )
 	ABORT("Malloc fails for LocalLU_t.");
 	LUstruct->Llu->inv = 0;
+	LUstruct->cLUstruct = NULL;
 }
 
 /*! \brief Deallocate LUstruct */
@@ -443,6 +444,13 @@ zDestroy_LU(int_t n, gridinfo_t *grid, zLUstruct_t *LUstruct)
     CHECK_MALLOC(iam, "Enter zDestroy_LU()");
 #endif
 
+#ifdef SLU_HAVE_COMPLEX
+    if ( LUstruct->cLUstruct ) { /* Factored in single precision */
+        zcDestroy_LU(n, grid, LUstruct);
+        return;
+    }
+#endif
+
     zDestroy_Tree(n, grid, LUstruct);
 
     nsupers = Glu_persist->supno[n-1] + 1;
@@ -680,6 +688,8 @@ pzgstrs_init(int_t n, int_t m_loc, int_t nrhs, int_t fst_row,
     gstrs_comm->ptr_to_ibuf = ptr_to_ibuf;
     gstrs_comm->ptr_to_dbuf = ptr_to_ibuf + procs;
 
+    pxgstrs_neighbors(gstrs_comm, grid);
+
     return 0;
 } /* PZGSTRS_INIT */
 
@@ -0,0 +1,217 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Block low-rank (BLR) Schur complement update
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_sdefs.h"
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * slr_aca computes a low-rank approximation A ~= U * V^T of the m-by-n
+ * block A by adaptive cross approximation with partial pivoting (ACA).
+ * Each step takes the residual of one row of A, pivots on its largest
+ * entry, and adds the residual of the pivot column; the next row is the
+ * one where that column is largest. The iteration stops when the last
+ * rank-one term is below tol times the norm of the approximation.
+ *
+ * Returns the rank r, with U (m-by-r) and V (n-by-r) stored with leading
+ * dimensions m and n, or -1 if the rank would exceed maxrank.
+ * mark[] is an integer work array of size m.
+ * </pre>
+ */
+static int
+slr_aca(int m, int n, float *A, int lda, float tol, int maxrank,
+	float *U, float *V, int *mark)
+{
+    int i, ii, j, jp, l, r = 0, nleft = m;
+    float *u, *v, piv, amax, nu, nv, cross, s, t, nrm2 = 0.0;
+
+    for (ii = 0; ii < m; ++ii) mark[ii] = 0;
+    i = 0;
+
+    while ( nleft > 0 ) {
+	if ( r == maxrank ) return -1;
+	v = &V[r * n];
+	u = &U[r * m];
+
+	/* Residual of row i. */
+	for (j = 0; j < n; ++j) v[j] = A[i + j*lda];
+	for (l = 0; l < r; ++l) {
+	    t = U[i + l*m];
+	    for (j = 0; j < n; ++j) v[j] -= t * V[j + l*n];
+	}
+	mark[i] = 1;
+	--nleft;
+
+	jp = 0; amax = 0.0;
+	for (j = 0; j < n; ++j)
+	    if ( fabs(v[j]) > amax ) { amax = fabs(v[j]); jp = j; }
+
+	if ( amax == 0.0 ) { /* Row i is already represented. */
+	    for (ii = 0; ii < m && mark[ii]; ++ii) ;
+	    i = ii;
+	    continue;
+	}
+
+	piv = 1.0 / v[jp];
+	for (j = 0; j < n; ++j) v[j] *= piv;
+
+	/* Residual of column jp. */
+	for (ii = 0; ii < m; ++ii) u[ii] = A[ii + jp*lda];
+	for (l = 0; l < r; ++l) {
+	    t = V[jp + l*n];
+	    for (ii = 0; ii < m; ++ii) u[ii] -= t * U[ii + l*m];
+	}
+
+	/* Update the Frobenius norm of U * V^T. */
+	nu = nv = cross = 0.0;
+	for (ii = 0; ii < m; ++ii) nu += u[ii] * u[ii];
+	for (j = 0; j < n; ++j) nv += v[j] * v[j];
+	for (l = 0; l < r; ++l) {
+	    s = t = 0.0;
+	    for (ii = 0; ii < m; ++ii) s += U[ii + l*m] * u[ii];
+	    for (j = 0; j < n; ++j) t += V[j + l*n] * v[j];
+	    cross += s * t;
+	}
+	nrm2 += 2.0 * cross + nu * nv;
+	++r;
+
+	if ( nu * nv <= tol * tol * nrm2 ) break;
+
+	/* Next row: the largest unused entry of the new column. */
+	i = m; amax = -1.0;
+	for (ii = 0; ii < m; ++ii)
+	    if ( !mark[ii] && fabs(u[ii]) > amax ) { amax = fabs(u[ii]); i = ii; }
+    }
+
+    return r;
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * sblr_gemm computes the product V = L * B of the remaining-rows update
+ * in psgstrf, with L the Rnbrow-by-ldu buffer of the blocks L(i,k) in
+ * the RemainBlk row blocks described by Remain_info[], and B the
+ * ldu-by-ncols buffer of U(k,:).
+ *
+ * A block L(i,k) with at least minsize rows, when ldu >= minsize, is
+ * compressed by slr_aca() with tolerance tol; if its rank r saves at
+ * least half of the flops, its rows of V are computed as U * (V^T * B).
+ * The other blocks are multiplied by B with one GEMM per run of
+ * consecutive uncompressed blocks. The result is an approximation of the
+ * Schur complement update of relative accuracy about tol.
+ *
+ * Returns the number of flops performed.
+ * </pre>
+ */
+double
+sblr_gemm(int_t RemainBlk, Remain_info_t *Remain_info, int ldu, int ncols,
+	  float *Lbuf, int ldl, float *B, int ldb, float *bigV,
+	  double tol, int minsize)
+{
+    float alpha = 1.0, beta = 0.0;
+    double flops = 0.0;
+    float *Uw, *Vw, *W;
+    int *mark;
+    int_t i, i0;
+    int m, st, maxm = 0, maxr, mr, r, nrow;
+
+    for (i = 0; i < RemainBlk; ++i) {
+	st = i ? Remain_info[i-1].FullRow : 0;
+	maxm = SUPERLU_MAX(maxm, Remain_info[i].FullRow - st);
+    }
+    maxr = SUPERLU_MAX(1, (maxm * ldu) / (2 * (maxm + ldu)));
+    if ( !(Uw = floatMalloc_dist(maxm * maxr)) )
+	ABORT("Malloc fails for Uw[]");
+    if ( !(Vw = floatMalloc_dist(ldu * maxr)) )
+	ABORT("Malloc fails for Vw[]");
+    if ( !(W = floatMalloc_dist(maxr * ncols)) )
+	ABORT("Malloc fails for W[]");
+    if ( !(mark = SUPERLU_MALLOC(maxm * sizeof(int))) )
+	ABORT("Malloc fails for mark[]");
+
+    i0 = 0; /* first block of the current uncompressed run */
+    for (i = 0; i <= RemainBlk; ++i) {
+	r = -1;
+	if ( i < RemainBlk ) {
+	    st = i ? Remain_info[i-1].FullRow : 0;
+	    m = Remain_info[i].FullRow - st;
+	    if ( m >= minsize && ldu >= minsize ) {
+		mr = (m * ldu) / (2 * (m + ldu));
+		r = slr_aca(m, ldu, &Lbuf[st], ldl, tol, mr, Uw, Vw, mark);
+		mr = r < 0 ? mr : r;
+		flops += 4.0 * mr * mr * (m + ldu);
+	    }
+	}
+	if ( r < 0 && i < RemainBlk ) continue;
+
+	/* Flush the run of uncompressed blocks i0, ..., i-1. */
+	if ( i > i0 ) {
+	    st = i0 ? Remain_info[i0-1].FullRow : 0;
+	    nrow = (i ? Remain_info[i-1].FullRow : 0) - st;
+#if defined (USE_VENDOR_BLAS)
+	    sgemm_("N", "N", &nrow, &ncols, &ldu, &alpha, &Lbuf[st], &ldl,
+		   B, &ldb, &beta, &bigV[st], &ldl, 1, 1);
+#else
+	    sgemm_("N", "N", &nrow, &ncols, &ldu, &alpha, &Lbuf[st], &ldl,
+		   B, &ldb, &beta, &bigV[st], &ldl);
+#endif
+	    flops += 2.0 * nrow * ldu * ncols;
+	}
+	i0 = i + 1;
+	if ( i == RemainBlk ) break;
+
+	/* Block i is compressed: V(i,:) = Uw * (Vw^T * B). */
+	st = i ? Remain_info[i-1].FullRow : 0;
+	m = Remain_info[i].FullRow - st;
+	if ( r == 0 ) {
+	    int j, ii;
+	    for (j = 0; j < ncols; ++j)
+		for (ii = 0; ii < m; ++ii) bigV[st + ii + j*ldl] = 0.0;
+	    continue;
+	}
+#if defined (USE_VENDOR_BLAS)
+	sgemm_("T", "N", &r, &ncols, &ldu, &alpha, Vw, &ldu,
+	       B, &ldb, &beta, W, &r, 1, 1);
+	sgemm_("N", "N", &m, &ncols, &r, &alpha, Uw, &m,
+	       W, &r, &beta, &bigV[st], &ldl, 1, 1);
+#else
+	sgemm_("T", "N", &r, &ncols, &ldu, &alpha, Vw, &ldu,
+	       B, &ldb, &beta, W, &r);
+	sgemm_("N", "N", &m, &ncols, &r, &alpha, Uw, &m,
+	       W, &r, &beta, &bigV[st], &ldl);
+#endif
+	flops += 2.0 * r * ncols * (ldu + m);
+    }
+
+    SUPERLU_FREE(Uw);
+    SUPERLU_FREE(Vw);
+    SUPERLU_FREE(W);
+    SUPERLU_FREE(mark);
+    return flops;
+}
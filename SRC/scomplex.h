@@ -0,0 +1,90 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required 
+approvals from U.S. Dept. of Energy) 
+
+All rights reserved. 
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Header for scomplex.c
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 1.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * September 1, 1999
+ * </pre>
+ */
+
+/* 
+ * This header file is to be included in source files c*.c
+ */
+#ifndef __SUPERLU_SCOMPLEX /* allow multiple inclusions */
+#define __SUPERLU_SCOMPLEX
+
+#include <mpi.h>
+#include "superlu_defs.h"
+
+typedef struct { float r, i; } singlecomplex;
+
+/*
+ * These variables will be defined to be MPI datatypes for complex
+ * and single complex. I'm too lazy to declare them external in every
+ * file that needs them.
+ * 
+ * Use WINOWS_EXPORT_ALL_SYMBOLS on windows to export all symbols when
+ * building a shared library.
+ * Introduce macro SUPERLU_DIST_EXPORT to correctly export the only
+ * remaining data symbol SuperLU_MPI_COMPLEX.
+ */
+//extern SUPERLU_DIST_EXPORT MPI_Datatype SuperLU_MPI_COMPLEX;
+
+/* Macro definitions */
+
+/*! \brief Complex Copy c = a */
+#define c_copy(c, a) { (c)->r = (a)->r ; \
+			 (c)->i = (a)->i ; }
+
+/*! \brief Complex Addition c = a + b */
+#define c_add(c, a, b) { (c)->r = (a)->r + (b)->r; \
+			 (c)->i = (a)->i + (b)->i; }
+
+/*! \brief Complex Subtraction c = a - b */
+#define c_sub(c, a, b) { (c)->r = (a)->r - (b)->r; \
+			 (c)->i = (a)->i - (b)->i; }
+
+/*! \brief Complex-Float Multiplication */
+#define cs_mult(c, a, b) { (c)->r = (a)->r * (b); \
+                           (c)->i = (a)->i * (b); }
+
+/*! \brief Complex-Complex Multiplication */
+#define cc_mult(c, a, b) { \
+	float cr, ci; \
+    	cr = (a)->r * (b)->r - (a)->i * (b)->i; \
+    	ci = (a)->i * (b)->r + (a)->r * (b)->i; \
+    	(c)->r = cr; \
+    	(c)->i = ci; \
+    }
+
+/*! \brief Complex equality testing */
+#define c_eq(a, b)  ( (a)->r == (b)->r && (a)->i == (b)->i )
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Prototypes for functions in scomplex.c */
+void   slud_c_div(singlecomplex *, singlecomplex *, singlecomplex *);
+float  slud_c_abs(singlecomplex *);     /* exact */
+float  slud_c_abs1(singlecomplex *);    /* approximate */
+
+
+#ifdef __cplusplus
+  }
+#endif
+
+
+#endif  /* __SUPERLU_SCOMPLEX */
@@ -22,6 +22,9 @@ at the top-level directory.
 
 
 int check_perm_dist(char *, int_t, int_t *);
+static void sp_colorder_etree(superlu_dist_options_t *, SuperMatrix *,
+			      int_t *, int_t *, SuperMatrix *, SuperMatrix *,
+			      int_t *, gridinfo_t *);
 
 /*! \brief
  *
@@ -41,6 +44,10 @@ int check_perm_dist(char *, int_t, int_t *);
  *       (3) Apply post[] permutation to columns of AC;
  *       (4) Overwrite perm_c[] with the product perm_c * post.
  *
+ *    With options->SchurSize > 0, perm_c[] is first changed to order the
+ *    last SchurSize columns of A after the others, and only the interior
+ *    part of etree[] is postordered, so that the interface stays last.
+ *
  * Arguments
  * =========
  *
@@ -81,11 +88,40 @@ void
 sp_colorder(superlu_dist_options_t *options,  SuperMatrix *A, int_t *perm_c, 
 	    int_t *etree, SuperMatrix *AC)
 {
+    sp_colorder_etree(options, A, perm_c, etree, AC, NULL, NULL, NULL);
+}
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * sp_colorder_loc() is sp_colorder() where the elimination tree is
+ * computed on the distributed matrix Aloc (SLU_NR_loc), which has the
+ * same structure as A up to the row permutation perm_r[] (A = Pr*Aloc),
+ * by sp_symetree_dist_loc() or sp_coletree_dist_loc(). This avoids
+ * forming A'+A on every process of grid.
+ * </pre>
+ */
+void
+sp_colorder_loc(superlu_dist_options_t *options, SuperMatrix *A,
+		int_t *perm_c, int_t *etree, SuperMatrix *AC,
+		SuperMatrix *Aloc, int_t *perm_r, gridinfo_t *grid)
+{
+    sp_colorder_etree(options, A, perm_c, etree, AC, Aloc, perm_r, grid);
+}
+
+static void
+sp_colorder_etree(superlu_dist_options_t *options, SuperMatrix *A,
+		  int_t *perm_c, int_t *etree, SuperMatrix *AC,
+		  SuperMatrix *Aloc, int_t *perm_r, gridinfo_t *grid)
+{
 
     NCformat  *Astore;
     NCPformat *ACstore;
-    int_t       *iwork, *post;
-    register  int_t n, i;
+    int_t       *iwork, *post, *post_int;
+    register  int_t n, i, j, nint;
 #if ( DEBUGlevel>=1 )
     int iam;
     MPI_Comm_rank( MPI_COMM_WORLD, &iam );
@@ -93,6 +129,7 @@ sp_colorder(superlu_dist_options_t *options,  SuperMatrix *A, int_t *perm_c,
 #endif
 
     n = A->ncol;
+    nint = n - options->SchurSize;
     
     /* Apply column permutation perm_c to A's column pointers so to
        obtain NCP format in AC = A*Pc.  */
@@ -119,6 +156,17 @@ sp_colorder(superlu_dist_options_t *options,  SuperMatrix *A, int_t *perm_c,
     }
 #endif      
 
+    if ( nint < n && (options->Fact == DOFACT
+		      || options->Fact == SamePattern) ) {
+	/* Order the interior columns 0:nint-1 first and the interface
+	   last, keeping the relative order given by perm_c[]. */
+	if ( !(iwork = intMalloc_dist(n)) ) ABORT("Malloc fails for iwork[]");
+	for (i = 0; i < n; ++i) iwork[perm_c[i]] = i;
+	for (i = 0, j = 0; i < n; ++i) if ( iwork[i] < nint ) perm_c[iwork[i]] = j++;
+	for (i = 0; i < n; ++i) if ( iwork[i] >= nint ) perm_c[iwork[i]] = j++;
+	SUPERLU_FREE(iwork);
+    }
+
     for (i = 0; i < n; i++) {
 	ACstore->colbeg[perm_c[i]] = Astore->colptr[i]; 
 	ACstore->colend[perm_c[i]] = Astore->colptr[i+1];
@@ -135,7 +183,13 @@ sp_colorder(superlu_dist_options_t *options,  SuperMatrix *A, int_t *perm_c,
 	iwork = (int_t*) SUPERLU_MALLOC((n+1)*sizeof(int_t)); 
 	if ( !iwork ) ABORT("SUPERLU_MALLOC fails for iwork[]");
 
-	if ( A->nrow != A->ncol  /* Rectangular matrix */
+	if ( Aloc && (A->nrow != A->ncol || options->ColPerm == MMD_ATA) ) {
+	    /* Compute the column etree of A*Pc' on the distributed Aloc. */
+	    sp_coletree_dist_loc(Aloc, perm_c, etree, grid);
+	} else if ( Aloc ) {
+	    /* Compute the etree of Pc*(A'+A)*Pc' on the distributed Aloc. */
+	    sp_symetree_dist_loc(Aloc, perm_r, perm_c, etree, grid);
+	} else if ( A->nrow != A->ncol  /* Rectangular matrix */
 	     || options->ColPerm == MMD_ATA ) {
 	    /* Compute the column etree of A*Pc'. */
 	    sp_coletree_dist(ACstore->colbeg, ACstore->colend, ACstore->rowind,
@@ -177,7 +231,19 @@ sp_colorder(superlu_dist_options_t *options,  SuperMatrix *A, int_t *perm_c,
 #endif	
 	
 	/* Post order etree */
-	post = (int_t *) TreePostorder_dist(n, etree);
+	if ( nint < n ) {
+	    /* The parents of the interface nodes nint:n-1 are interface
+	       nodes; postorder the interior forest and keep them last. */
+	    for (i = 0; i < nint; ++i)
+		iwork[i] = etree[i] < nint ? etree[i] : nint;
+	    post_int = (int_t *) TreePostorder_dist(nint, iwork);
+	    if ( !(post = intMalloc_dist(n+1)) ) ABORT("Malloc fails for post[]");
+	    for (i = 0; i < nint; ++i) post[i] = post_int[i];
+	    for (i = nint; i <= n; ++i) post[i] = i;
+	    SUPERLU_FREE(post_int);
+	} else {
+	    post = (int_t *) TreePostorder_dist(n, etree);
+	}
 	/* for (i = 0; i < n+1; ++i) inv_post[post[i]] = i;
 	   iwork = post; */
 
@@ -218,7 +284,7 @@ sp_colorder(superlu_dist_options_t *options,  SuperMatrix *A, int_t *perm_c,
     CHECK_MALLOC(iam, "Exit sp_colorder()");
 #endif
 
-} /* SP_COLORDER */
+} /* SP_COLORDER_ETREE */
 
 int
 check_perm_dist(char *what, int_t n, int_t *perm)
@@ -90,6 +90,8 @@ sp_ienv_dist(int_t ispec)
             {
                 return(atoi(ttemp));
             }
+            else if ( (i = superlu_tune_param(2)) )
+                return i;   /* from the tuning cache, see superlu_tune.c */
             else
             return 20;
             
@@ -99,6 +101,8 @@ sp_ienv_dist(int_t ispec)
             {
                 return(atoi(ttemp));
             }
+            else if ( (i = superlu_tune_param(3)) )
+                return i;
             else
             return 128;
 
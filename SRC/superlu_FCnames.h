@@ -45,6 +45,7 @@ at the top-level directory.
 #define f_set_CompRowLoc_Matrix          FC_GLOBAL(f_set_comprowloc_matrix,F_SET_COMPROWLOC_MATRIX)
 #define f_get_superlu_options            FC_GLOBAL(f_get_superlu_options,F_GET_SUPERLU_OPTIONS)
 #define f_set_superlu_options            FC_GLOBAL(f_set_superlu_options,F_SET_SUPERLU_OPTIONS)
+#define f_set_RefactorMap                FC_GLOBAL(f_set_refactormap,F_SET_REFACTORMAP)
 #define f_set_default_options            FC_GLOBAL(f_set_default_options,F_SET_DEFAULT_OPTIONS)
 #define f_superlu_gridinit               FC_GLOBAL(f_superlu_gridinit,F_SUPERLU_GRIDINIT)
 #define f_superlu_gridmap                FC_GLOBAL(f_superlu_gridmap,F_SUPERLU_GRIDMAP)
@@ -53,6 +54,7 @@ at the top-level directory.
 #define f_ScalePermstructFree            FC_GLOBAL(f_scalepermstructfree,F_SCALEPERMSTRUCTFREE)
 #define f_PStatInit                      FC_GLOBAL(f_pstatinit,F_PSTATINIT)
 #define f_PStatFree                      FC_GLOBAL(f_pstatfree,F_PSTATFREE)
+#define f_PStatPrint                     FC_GLOBAL(f_pstatprint,F_PSTATPRINT)
 #define f_LUstructInit                   FC_GLOBAL(f_lustructinit,F_LUSTRUCTINIT)
 #define f_LUstructFree                   FC_GLOBAL(f_lustructfree,F_LUSTRUCTFREE)
 #define f_Destroy_LU                     FC_GLOBAL(f_destroy_lu,F_DESTROY_LU)
@@ -63,6 +65,8 @@ at the top-level directory.
 #define f_dSolveFinalize                 FC_GLOBAL(f_dsolvefinalize,F_DSOLVEFINALIZE)
 #define f_zSolveFinalize                 FC_GLOBAL(f_zsolvefinalize,F_ZSOLVEFINALIZE)
 #define f_pdgssvx                        FC_GLOBAL(f_pdgssvx,F_PDGSSVX)
+#define f_pdgssvx_solve                  FC_GLOBAL(f_pdgssvx_solve,F_PDGSSVX_SOLVE)
+#define f_pdgsrefactor                   FC_GLOBAL(f_pdgsrefactor,F_PDGSREFACTOR)
 #define f_pzgssvx                        FC_GLOBAL(f_pzgssvx,F_PZGSSVX)
 #define f_dcreate_dist_matrix            FC_GLOBAL(f_dcreate_dist_matrix,F_DCREATE_DIST_MATRIX)
 #define f_zcreate_dist_matrix            FC_GLOBAL(f_zcreate_dist_matrix,F_ZCREATE_DIST_MATRIX)
@@ -0,0 +1,102 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Bump allocator for the work arrays of the numerical factorization
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * PxGSTRF reserves one block of memory for all its work arrays (the GEMM
+ * buffers bigU/bigV, the look-ahead and remaining L panels, the index
+ * arrays of the Schur complement update, ...) and hands them out with
+ * superlu_arena_alloc(). Scratch space needed for a single panel is taken
+ * between superlu_arena_mark() and superlu_arena_reset(), so nothing is
+ * allocated or freed inside the elimination loop.
+ *
+ * If the environment variable SUPERLU_HUGEPAGE is set to a nonzero value,
+ * the arena is advised to be backed by transparent huge pages (Linux), see
+ * superlu_hugepage().
+ * The arena is not thread safe; it is used by the master thread only.
+ * </pre>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "superlu_defs.h"
+
+#define ARENA_ALIGN  64         /* bytes, one cache line */
+
+/*! \brief Return the number of arena bytes taken by an array of nbytes.
+ */
+size_t superlu_arena_bytes(size_t nbytes)
+{
+    return (nbytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+/*! \brief Reserve size bytes for the arena.
+ *
+ * <pre>
+ * size should be the sum of superlu_arena_bytes() of all the arrays that
+ * are live at the same time.
+ * </pre>
+ */
+void superlu_arena_init(superlu_arena_t *arena, size_t size)
+{
+    arena->size = size + ARENA_ALIGN; /* room to align the base */
+    arena->used = arena->peak = 0;
+    if ( !(arena->base = (char *) SUPERLU_MALLOC(arena->size)) )
+	ABORT("Malloc fails for the factorization arena.");
+
+    superlu_hugepage(arena->base, arena->size);
+}
+
+/*! \brief Return nbytes from the arena, aligned to a cache line.
+ */
+void *superlu_arena_alloc(superlu_arena_t *arena, size_t nbytes)
+{
+    uintptr_t p = ((uintptr_t) arena->base + arena->used + ARENA_ALIGN - 1)
+                  & ~((uintptr_t) ARENA_ALIGN - 1);
+    size_t used = (p - (uintptr_t) arena->base) + superlu_arena_bytes(nbytes);
+
+    if ( used > arena->size ) {
+	fprintf(stderr, "superlu_arena_alloc: %lu bytes requested, "
+		"%lu of %lu in use\n", (unsigned long) nbytes,
+		(unsigned long) arena->used, (unsigned long) arena->size);
+	ABORT("Factorization arena is exhausted.");
+    }
+    arena->used = used;
+    arena->peak = SUPERLU_MAX(arena->peak, used);
+    return (void *) p;
+}
+
+/*! \brief Return the current position, to be passed to superlu_arena_reset().
+ */
+size_t superlu_arena_mark(superlu_arena_t *arena)
+{
+    return arena->used;
+}
+
+/*! \brief Release everything allocated since the mark was taken.
+ */
+void superlu_arena_reset(superlu_arena_t *arena, size_t mark)
+{
+    arena->used = mark;
+}
+
+void superlu_arena_destroy(superlu_arena_t *arena)
+{
+    SUPERLU_FREE(arena->base);
+    arena->base = NULL;
+    arena->size = arena->used = 0;
+}
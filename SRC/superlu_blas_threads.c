@@ -0,0 +1,117 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Number of threads of a multithreaded BLAS, call by call
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The Schur complement update of pdgstrf() calls dgemm_() on many small
+ * blocks from the threads of an OpenMP parallel region, where a threaded
+ * BLAS must run on one thread, but also makes single large calls outside
+ * of any parallel region: the aggregated GEMM of the remaining blocks, and
+ * the updates of the dense root in pdgstrf_root(). Those are faster when
+ * the BLAS uses all the threads of the process.
+ *
+ * The factorization sets the BLAS to one thread on entry, raises it with
+ * superlu_blas_set_threads(superlu_blas_max_threads(flops)) around each
+ * large call made by the master thread, and restores the setting of the
+ * caller on exit. The number is set with MKL_Set_Num_Threads_Local() with
+ * MKL, or openblas_set_num_threads() with OpenBLAS, whichever is linked;
+ * the symbols are weak, so nothing is done with another BLAS, or when the
+ * compiler does not support weak symbols. With a static OpenBLAS, the
+ * object holding openblas_set_num_threads() must be linked in, e.g. with
+ * -Wl,-u,openblas_set_num_threads.
+ *
+ * The environment variable SUPERLU_BLAS_THREADS sets the number of
+ * threads of a large call, by default the number of OpenMP threads;
+ * SUPERLU_BLAS_THREADS=0 leaves the BLAS alone.
+ * </pre>
+ */
+
+#include <stdlib.h>
+#include "superlu_defs.h"
+
+#if defined(__GNUC__) && !defined(_WIN32)
+extern int  MKL_Set_Num_Threads_Local(int) __attribute__((weak));
+extern void openblas_set_num_threads(int) __attribute__((weak));
+extern int  openblas_get_num_threads(void) __attribute__((weak));
+#define SUPERLU_BLAS_WEAK
+#endif
+
+/* Fewer flops than this run on one thread, a fork costing about as much. */
+#define BLAS_MT_FLOPS 4.0e6
+
+static int blas_max = -1;   /* threads of a large call, 0 if disabled */
+
+/*! \brief Set the number of threads of the BLAS of the calling thread.
+ *
+ * <pre>
+ * Returns the previous setting, to give back to superlu_blas_set_threads(),
+ * or -1 if nothing is done: nthreads < 1, SUPERLU_BLAS_THREADS=0, or no
+ * known threaded BLAS is linked. Must not be called from a parallel region
+ * with OpenBLAS, whose setting holds for the whole process.
+ * </pre>
+ */
+int superlu_blas_set_threads(int nthreads)
+{
+    int prev = -1;
+
+    if ( nthreads < 1 || superlu_blas_max_threads(BLAS_MT_FLOPS) == 0 )
+	return -1;
+#ifdef SUPERLU_BLAS_WEAK
+    if ( MKL_Set_Num_Threads_Local ) {
+	prev = MKL_Set_Num_Threads_Local(nthreads);
+    } else if ( openblas_set_num_threads && openblas_get_num_threads ) {
+	prev = openblas_get_num_threads();
+	if ( prev != nthreads ) openblas_set_num_threads(nthreads);
+    }
+#endif
+    return prev;
+}
+
+/*! \brief Give back a setting returned by superlu_blas_set_threads(). */
+void superlu_blas_restore_threads(int prev)
+{
+#ifdef SUPERLU_BLAS_WEAK
+    if ( prev < 0 ) return;
+    if ( MKL_Set_Num_Threads_Local )
+	MKL_Set_Num_Threads_Local(prev); /* 0 falls back to the global one */
+    else if ( openblas_set_num_threads && openblas_get_num_threads
+	      && openblas_get_num_threads() != prev )
+	openblas_set_num_threads(prev);
+#endif
+}
+
+/*! \brief Number of BLAS threads for one call of about flops operations.
+ *
+ * <pre>
+ * Meant for a call made outside of any parallel region. Returns 0 if
+ * SUPERLU_BLAS_THREADS=0, 1 for a small call, and SUPERLU_BLAS_THREADS or
+ * the number of OpenMP threads otherwise.
+ * </pre>
+ */
+int superlu_blas_max_threads(double flops)
+{
+    if ( blas_max < 0 ) {
+	char *ttemp = getenv("SUPERLU_BLAS_THREADS");
+	int nt = 1;
+#ifdef _OPENMP
+	nt = omp_get_max_threads();
+#endif
+	if ( ttemp ) nt = SUPERLU_MAX(atoi(ttemp), 0);
+	blas_max = nt;
+    }
+    if ( blas_max == 0 ) return 0;
+    return flops < BLAS_MT_FLOPS ? 1 : blas_max;
+}
@@ -0,0 +1,1092 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief  Distributed SuperLU data types and function prototypes
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 7.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley,
+ * Georgia Institute of Technology
+ * November 1, 2007
+ * April 5, 2015
+ * September 18, 2018  version 6.0
+ * February 8, 2019  version 6.1.1
+ * May 10, 2019 version 7.0.0
+ * </pre>
+ */
+
+#ifndef __SUPERLU_CDEFS /* allow multiple inclusions */
+#define __SUPERLU_CDEFS
+
+/*
+ * File name:	superlu_cdefs.h
+ * Purpose:     Distributed SuperLU data types and function prototypes
+ * History:
+ */
+
+#include "superlu_defs.h"
+#include "scomplex.h"
+
+/* 
+ *-- The structure used to store matrix A of the linear system and
+ *   several vectors describing the transformations done to matrix A.
+ *
+ * A      (SuperMatrix*)
+ *        Matrix A in A*X=B, of dimension (A->nrow, A->ncol).
+ *        The number of linear equations is A->nrow. The type of A can be:
+ *        Stype = SLU_NC; Dtype = SLU_D; Mtype = SLU_GE.
+ *         
+ * DiagScale  (DiagScale_t)
+ *        Specifies the form of equilibration that was done.
+ *        = NOEQUIL: No equilibration.
+ *        = ROW:  Row equilibration, i.e., A was premultiplied by diag(R).
+ *        = COL:  Column equilibration, i.e., A was postmultiplied by diag(C).
+ *        = BOTH: Both row and column equilibration, i.e., A was replaced 
+ *                 by diag(R)*A*diag(C).
+ *
+ * R      float*, dimension (A->nrow)
+ *        The row scale factors for A.
+ *        If DiagScale = ROW or BOTH, A is multiplied on the left by diag(R).
+ *        If DiagScale = NOEQUIL or COL, R is not defined.
+ *
+ * C      float*, dimension (A->ncol)
+ *        The column scale factors for A.
+ *        If DiagScale = COL or BOTH, A is multiplied on the right by diag(C).
+ *        If DiagScale = NOEQUIL or ROW, C is not defined.
+ *         
+ * perm_r (int*) dimension (A->nrow)
+ *        Row permutation vector which defines the permutation matrix Pr,
+ *        perm_r[i] = j means row i of A is in position j in Pr*A.
+ *
+ * perm_c (int*) dimension (A->ncol)
+ *	  Column permutation vector, which defines the 
+ *        permutation matrix Pc; perm_c[i] = j means column i of A is 
+ *        in position j in A*Pc.
+ *
+ */
+typedef struct {
+    DiagScale_t DiagScale;
+    float *R;
+    float *C; 
+    int_t  *perm_r;
+    int_t  *perm_c;
+} cScalePermstruct_t;
+
+#if 0 // Sherry: move to superlu_defs.h 
+/*-- Auxiliary data type used in PxGSTRS/PxGSTRS1. */
+typedef struct {
+    int_t lbnum;  /* Row block number (local).      */
+    int_t indpos; /* Starting position in Uindex[]. */
+} Ucb_indptr_t;
+#endif
+
+/*
+ * On each processor, the blocks in L are stored in compressed block
+ * column format, the blocks in U are stored in compressed block row format.
+ */
+#define MAX_LOOKAHEADS 50
+typedef struct {
+    int_t   **Lrowind_bc_ptr; /* size ceil(NSUPERS/Pc)                 */
+    singlecomplex **Lnzval_bc_ptr;  /* size ceil(NSUPERS/Pc)                 */
+    singlecomplex **Linv_bc_ptr;  /* size ceil(NSUPERS/Pc)                 */
+    int_t   **Lindval_loc_bc_ptr; /* size ceil(NSUPERS/Pc)  pointers to locations in Lrowind_bc_ptr and Lnzval_bc_ptr */
+    int_t   *Unnz; /* number of nonzeros per block column in U*/
+	int_t   **Lrowind_bc_2_lsum; /* size ceil(NSUPERS/Pc)  map indices of Lrowind_bc_ptr to indices of lsum  */
+    singlecomplex  **Uinv_bc_ptr;  /* size ceil(NSUPERS/Pc)     	*/
+    int_t   **Ufstnz_br_ptr;  /* size ceil(NSUPERS/Pr)                 */
+    singlecomplex  **Unzval_br_ptr;  /* size ceil(NSUPERS/Pr)                 */
+        /*-- Data structures used for broadcast and reduction trees. --*/
+    BcTree  *LBtree_ptr;       /* size ceil(NSUPERS/Pc)                */
+    RdTree  *LRtree_ptr;       /* size ceil(NSUPERS/Pr)                */
+    BcTree  *UBtree_ptr;       /* size ceil(NSUPERS/Pc)                */
+    RdTree  *URtree_ptr;       /* size ceil(NSUPERS/Pr)			*/
+#if 0
+    int_t   *Lsub_buf;        /* Buffer for the remote subscripts of L */
+    singlecomplex  *Lval_buf;        /* Buffer for the remote nonzeros of L   */
+    int_t   *Usub_buf;        /* Buffer for the remote subscripts of U */
+    singlecomplex  *Uval_buf;        /* Buffer for the remote nonzeros of U   */
+#endif
+    int_t   *Lsub_buf_2[MAX_LOOKAHEADS];   /* Buffers for the remote subscripts of L*/
+    singlecomplex  *Lval_buf_2[MAX_LOOKAHEADS];   /* Buffers for the remote nonzeros of L  */
+    int_t   *Usub_buf_2[MAX_LOOKAHEADS];   /* Buffer for the remote subscripts of U */
+    singlecomplex  *Uval_buf_2[MAX_LOOKAHEADS];   /* Buffer for the remote nonzeros of U   */
+    singlecomplex  *ujrow;           /* used in panel factorization.          */
+    int_t   bufmax[NBUFFERS]; /* Maximum buffer size across all MPI ranks:
+			       *  0 : maximum size of Lsub_buf[]
+			       *  1 : maximum size of Lval_buf[]
+			       *  2 : maximum size of Usub_buf[]
+			       *  3 : maximum size of Uval_buf[]
+			       *  4 : maximum size of tempv[LDA]
+			       */
+
+    /*-- Record communication schedule for factorization. --*/
+    int   *ToRecv;          /* Recv from no one (0), left (1), and up (2).*/
+    int   *ToSendD;         /* Whether need to send down block row.       */
+    int   **ToSendR;        /* List of processes to send right block col. */
+
+    /*-- Record communication schedule for forward/back solves. --*/
+    int_t   *fmod;            /* Modification count for L-solve            */
+    int_t   **fsendx_plist;   /* Column process list to send down Xk       */
+    int_t   *frecv;           /* Modifications to be recv'd in proc row    */
+    int_t   nfrecvx;          /* Number of Xk I will receive in L-solve    */
+    int_t   nfsendx;          /* Number of Xk I will send in L-solve       */
+    int_t   *bmod;            /* Modification count for U-solve            */
+    int_t   **bsendx_plist;   /* Column process list to send down Xk       */
+    int_t   *brecv;           /* Modifications to be recv'd in proc row    */
+    int_t   nbrecvx;          /* Number of Xk I will receive in U-solve    */
+    int_t   nbsendx;          /* Number of Xk I will send in U-solve       */
+    int_t   *mod_bit;         /* Flag contribution from each row blocks    */
+
+    /*-- Auxiliary arrays used for forward/back solves. --*/
+    int_t   *ilsum;           /* Starting position of each supernode in lsum
+				 (local)  */
+    int_t   ldalsum;          /* LDA of lsum (local) */
+    int_t   SolveMsgSent;     /* Number of actual messages sent in LU-solve */
+    int_t   SolveMsgVol;      /* Volume of messages sent in the solve phase */
+
+
+    /*********************/
+    /* The following variables are used in the hybrid solver */
+
+    /*-- Counts to be used in U^{-T} triangular solve. -- */
+    int_t UT_SOLVE;
+    int_t L_SOLVE;
+    int_t FRECV;
+    int_t ut_ldalsum;        /* LDA of lsum (local) */
+    int_t *ut_ilsum;         /* ilsum in column-wise                        */
+    int_t *utmod;            /* Modification count for Ut-solve.            */
+    int_t **ut_sendx_plist;  /* Row process list to send down Xk            */
+    int_t *utrecv;           /* Modifications to be recev'd in proc column. */
+    int_t n_utsendx;         /* Number of Xk I will receive                 */
+    int_t n_utrecvx;         /* Number of Xk I will send                    */
+    int_t n_utrecvmod;
+    int_t nroot;
+    int_t *ut_modbit;
+    int_t *Urbs;
+    Ucb_indptr_t **Ucb_indptr;/* Vertical linked list pointing to Uindex[] */
+    int_t  **Ucb_valptr;      /* Vertical linked list pointing to Unzval[] */
+
+    /* some additional counters for L solve */
+    int_t n;
+    int_t nleaf;
+    int_t nfrecvmod;
+    int_t inv; /* whether the diagonal block is inverted*/
+} cLocalLU_t;
+
+
+typedef struct {
+    int_t *etree;
+    Glu_persist_t *Glu_persist;
+    cLocalLU_t *Llu;
+    char dt;
+} cLUstruct_t;
+
+
+/*-- Data structure for communication during matrix-vector multiplication. */
+typedef struct {
+    int_t *extern_start;
+    int_t *ind_tosend;    /* X indeices to be sent to other processes */
+    int_t *ind_torecv;    /* X indeices to be received from other processes */
+    int_t *ptr_ind_tosend;/* Printers to ind_tosend[] (Size procs)
+			     (also point to val_torecv) */
+    int_t *ptr_ind_torecv;/* Printers to ind_torecv[] (Size procs)
+			     (also point to val_tosend) */
+    int   *SendCounts;    /* Numbers of X indices to be sent
+			     (also numbers of X values to be received) */
+    int   *RecvCounts;    /* Numbers of X indices to be received
+			     (also numbers of X values to be sent) */
+    singlecomplex *val_tosend;   /* X values to be sent to other processes */
+    singlecomplex *val_torecv;   /* X values to be received from other processes */
+    int_t TotalIndSend;   /* Total number of indices to be sent
+			     (also total number of values to be received) */
+    int_t TotalValSend;   /* Total number of values to be sent.
+			     (also total number of indices to be received) */
+} pcgsmv_comm_t;
+
+/*-- Data structure holding the information for the solution phase --*/
+typedef struct {
+    int_t *row_to_proc;
+    int_t *inv_perm_c;
+    int_t num_diag_procs, *diag_procs, *diag_len;
+    pcgsmv_comm_t *gsmv_comm; /* communication metadata for SpMV,
+         	       		      required by IterRefine.          */
+    pxgstrs_comm_t *gstrs_comm;  /* communication metadata for SpTRSV. */
+    int_t *A_colind_gsmv; /* After pcgsmv_init(), the global column
+                             indices of A are translated into the relative
+                             positions in the gathered x-vector.
+                             This is re-used in repeated calls to pcgsmv() */
+    int_t *xrow_to_proc; /* used by PDSLin */
+} cSOLVEstruct_t;
+
+#if 0 
+
+/*==== For 3D code ====*/
+
+// new structures for pdgstrf_4_8 
+
+typedef struct
+{
+    int_t nub;
+    int_t klst;
+    int_t ldu;
+    int_t* usub;
+    singlecomplex* uval;
+} uPanelInfo_t;
+
+typedef struct
+{
+    int_t *lsub;
+    singlecomplex *lusup;
+    int_t luptr0;
+    int_t nlb;  //number of l blocks
+    int_t nsupr;
+} lPanelInfo_t;
+
+ 
+
+/* HyP_t is the data structure to assist HALO offload of Schur-complement. */
+typedef struct
+{
+    Remain_info_t *lookAhead_info, *Remain_info;
+    Ublock_info_t *Ublock_info, *Ublock_info_Phi;
+    
+    int_t first_l_block_acc , first_u_block_acc;
+    int_t last_offload ;
+    int_t *Lblock_dirty_bit, * Ublock_dirty_bit;
+    singlecomplex *lookAhead_L_buff, *Remain_L_buff;
+    int_t lookAheadBlk;  /* number of blocks in look-ahead window */
+    int_t RemainBlk ;    /* number of blocks outside look-ahead window */
+    int_t  num_look_aheads, nsupers;
+    int_t ldu, ldu_Phi;
+    int_t num_u_blks, num_u_blks_Phi;
+
+    int_t jj_cpu;
+    singlecomplex *bigU_Phi;
+    singlecomplex *bigU_host;
+    int_t Lnbrow;
+    int_t Rnbrow;
+
+    int_t buffer_size;
+    int_t bigu_size;
+    int_t offloadCondition;
+    int_t superlu_acc_offload;
+    int_t nCudaStreams;
+} HyP_t;
+
+typedef struct 
+{
+    int_t * Lsub_buf ;
+    singlecomplex * Lval_buf ;
+    int_t * Usub_buf ;
+    singlecomplex * Uval_buf ;
+} cLUValSubBuf_t;
+
+int_t scuStatUpdate(
+    int_t knsupc,
+    HyP_t* HyP, 
+    SCT_t* SCT,
+    SuperLUStat_t *stat
+    );
+
+typedef struct
+{
+    gEtreeInfo_t gEtreeInfo;
+    int_t* iperm_c_supno;
+    int_t* myNodeCount;
+    int_t* myTreeIdxs;
+    int_t* myZeroTrIdxs;
+    int_t** treePerm;
+    sForest_t** sForests;
+    int_t* supernode2treeMap;
+    cLUValSubBuf_t  *LUvsb;
+} trf3Dpartition_t;
+
+typedef struct
+{
+    singlecomplex *bigU;
+    singlecomplex *bigV;
+} scuBufs_t;
+
+typedef struct
+{   
+    singlecomplex* BlockLFactor;
+    singlecomplex* BlockUFactor;
+} diagFactBufs_t;
+
+typedef struct
+{
+    Ublock_info_t* Ublock_info;
+    Remain_info_t*  Remain_info;
+    uPanelInfo_t* uPanelInfo;
+    lPanelInfo_t* lPanelInfo;
+} packLUInfo_t;
+
+#endif
+/*=====================*/
+
+/***********************************************************************
+ * Function prototypes
+ ***********************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Supernodal LU factor related */
+extern void
+cCreate_CompCol_Matrix_dist(SuperMatrix *, int_t, int_t, int_t, singlecomplex *,
+			    int_t *, int_t *, Stype_t, Dtype_t, Mtype_t);
+extern void
+cCreate_CompRowLoc_Matrix_dist(SuperMatrix *, int_t, int_t, int_t, int_t,
+			       int_t, singlecomplex *, int_t *, int_t *,
+			       Stype_t, Dtype_t, Mtype_t);
+extern void
+cCompRow_to_CompCol_dist(int_t, int_t, int_t, singlecomplex *, int_t *, int_t *,
+                         singlecomplex **, int_t **, int_t **);
+extern int
+pcCompRow_loc_to_CompCol_global(int_t, SuperMatrix *, gridinfo_t *,
+	 		        SuperMatrix *);
+extern void
+cCopy_CompCol_Matrix_dist(SuperMatrix *, SuperMatrix *);
+extern void
+cCreate_Dense_Matrix_dist(SuperMatrix *, int_t, int_t, singlecomplex *, int_t,
+			  Stype_t, Dtype_t, Mtype_t);
+extern void
+cCreate_SuperNode_Matrix_dist(SuperMatrix *, int_t, int_t, int_t, singlecomplex *,
+			      int_t *, int_t *, int_t *, int_t *, int_t *,
+			      Stype_t, Dtype_t, Mtype_t);
+extern void
+cCopy_Dense_Matrix_dist(int_t, int_t, singlecomplex *, int_t,
+                        singlecomplex *, int_t);
+
+extern void    callocateA_dist (int_t, int_t, singlecomplex **, int_t **, int_t **);
+extern void    cGenXtrue_dist (int_t, int_t, singlecomplex *, int_t);
+extern void    cFillRHS_dist (char *, int_t, singlecomplex *, int_t,
+                              SuperMatrix *, singlecomplex *, int_t);
+extern int     ccreate_matrix(SuperMatrix *, int, singlecomplex **, int *,
+			      singlecomplex **, int *, FILE *, gridinfo_t *);
+extern int     ccreate_matrix_rb(SuperMatrix *, int, singlecomplex **, int *,
+			      singlecomplex **, int *, FILE *, gridinfo_t *);
+extern int     ccreate_matrix_dat(SuperMatrix *, int, singlecomplex **, int *,
+			      singlecomplex **, int *, FILE *, gridinfo_t *);
+extern int 	   ccreate_matrix_postfix(SuperMatrix *, int, singlecomplex **, int *,
+				  singlecomplex **, int *, FILE *, char *, gridinfo_t *);
+
+extern void   cScalePermstructInit(const int_t, const int_t, 
+                                      cScalePermstruct_t *);
+extern void   cScalePermstructFree(cScalePermstruct_t *);
+
+/* Driver related */
+extern void    cgsequ_dist (SuperMatrix *, float *, float *, float *,
+			    float *, float *, int_t *);
+extern float  clangs_dist (char *, SuperMatrix *);
+extern void    claqgs_dist (SuperMatrix *, float *, float *, float,
+			    float, float, char *);
+extern void    pcgsequ (SuperMatrix *, float *, float *, float *,
+			float *, float *, int_t *, gridinfo_t *);
+extern float  pclangs (char *, SuperMatrix *, gridinfo_t *);
+extern void    pclaqgs (SuperMatrix *, float *, float *, float,
+			float, float, char *);
+extern int     pcPermute_Dense_Matrix(int_t, int_t, int_t [], int_t[],
+				      singlecomplex [], int, singlecomplex [], int, int,
+				      gridinfo_t *);
+
+extern int     sp_ctrsv_dist (char *, char *, char *, SuperMatrix *,
+			      SuperMatrix *, singlecomplex *, int *);
+extern int     sp_cgemv_dist (char *, singlecomplex, SuperMatrix *, singlecomplex *,
+			      int, singlecomplex, singlecomplex *, int);
+extern int     sp_cgemm_dist (char *, int, singlecomplex, SuperMatrix *,
+                        singlecomplex *, int, singlecomplex, singlecomplex *, int);
+
+extern float cdistribute(fact_t, int_t, SuperMatrix *, Glu_freeable_t *,
+			 cLUstruct_t *, gridinfo_t *);
+extern void  pcgssvx_ABglobal(superlu_dist_options_t *, SuperMatrix *,
+			      cScalePermstruct_t *, singlecomplex *,
+			      int, int, gridinfo_t *, cLUstruct_t *, float *,
+			      SuperLUStat_t *, int *);
+extern float pcdistribute(fact_t, int_t, SuperMatrix *,
+			 cScalePermstruct_t *, Glu_freeable_t *,
+			 cLUstruct_t *, gridinfo_t *);
+extern void  pcgssvx(superlu_dist_options_t *, SuperMatrix *,
+		     cScalePermstruct_t *, singlecomplex *,
+		     int, int, gridinfo_t *, cLUstruct_t *,
+		     cSOLVEstruct_t *, float *, SuperLUStat_t *, int *);
+extern void  pcCompute_Diag_Inv(int_t, cLUstruct_t *,gridinfo_t *, SuperLUStat_t *, int *);
+extern int  cSolveInit(superlu_dist_options_t *, SuperMatrix *, int_t [], int_t [],
+		       int_t, cLUstruct_t *, gridinfo_t *, cSOLVEstruct_t *);
+extern void cSolveFinalize(superlu_dist_options_t *, cSOLVEstruct_t *);
+extern int_t pcgstrs_init(int_t, int_t, int_t, int_t,
+                          int_t [], int_t [], gridinfo_t *grid,
+	                  Glu_persist_t *, cSOLVEstruct_t *);
+extern void pxgstrs_finalize(pxgstrs_comm_t *);
+extern int  cldperm_dist(int_t, int_t, int_t, int_t [], int_t [],
+		    singlecomplex [], int_t *, float [], float []);
+extern int  cstatic_schedule(superlu_dist_options_t *, int, int,
+		            cLUstruct_t *, gridinfo_t *, SuperLUStat_t *,
+			    int_t *, int_t *, int *);
+extern void cLUstructInit(const int_t, cLUstruct_t *);
+extern void cLUstructFree(cLUstruct_t *);
+extern void cDestroy_LU(int_t, gridinfo_t *, cLUstruct_t *);
+extern void cDestroy_Tree(int_t, gridinfo_t *, cLUstruct_t *);
+extern void cscatter_l (int ib, int ljb, int nsupc, int_t iukp, int_t* xsup,
+			int klst, int nbrow, int_t lptr, int temp_nbrow,
+			int_t* usub, int_t* lsub, singlecomplex *tempv,
+			int* indirect_thread, int* indirect2,
+			int_t ** Lrowind_bc_ptr, singlecomplex **Lnzval_bc_ptr,
+			gridinfo_t * grid);
+extern void cscatter_u (int ib, int jb, int nsupc, int_t iukp, int_t * xsup,
+                        int klst, int nbrow, int_t lptr, int temp_nbrow,
+                        int_t* lsub, int_t* usub, singlecomplex* tempv,
+                        int_t ** Ufstnz_br_ptr, singlecomplex **Unzval_br_ptr,
+                        gridinfo_t * grid);
+extern int_t pcgstrf(superlu_dist_options_t *, int, int, float,
+		    cLUstruct_t*, gridinfo_t*, SuperLUStat_t*, int*);
+
+/* #define GPU_PROF
+#define IPM_PROF */
+
+/* Solve related */
+extern void pcgstrs_Bglobal(int_t, cLUstruct_t *, gridinfo_t *,
+			     singlecomplex *, int_t, int, SuperLUStat_t *, int *);
+extern void pcgstrs(int_t, cLUstruct_t *, cScalePermstruct_t *, gridinfo_t *,
+		    singlecomplex *, int_t, int_t, int_t, int, cSOLVEstruct_t *,
+		    SuperLUStat_t *, int *);
+extern void pcgstrf2_trsm(superlu_dist_options_t * options, int_t k0, int_t k,
+			  float thresh, Glu_persist_t *, gridinfo_t *,
+			  cLocalLU_t *, MPI_Request *, int tag_ub,
+			  SuperLUStat_t *, int *info);
+extern void pcgstrs2_omp(int_t k0, int_t k, Glu_persist_t *, gridinfo_t *,
+			 cLocalLU_t *, Ublock_info_t *, SuperLUStat_t *);
+extern int_t pcReDistribute_B_to_X(singlecomplex *B, int_t m_loc, int nrhs, int_t ldb,
+				   int_t fst_row, int_t *ilsum, singlecomplex *x,
+				   cScalePermstruct_t *, Glu_persist_t *,
+				   gridinfo_t *, cSOLVEstruct_t *);
+extern void clsum_fmod(singlecomplex *, singlecomplex *, singlecomplex *, singlecomplex *,
+		       int, int, int_t , int_t *, int_t, int_t, int_t,
+		       int_t *, gridinfo_t *, cLocalLU_t *,
+		       MPI_Request [], SuperLUStat_t *);
+extern void clsum_bmod(singlecomplex *, singlecomplex *, singlecomplex *,
+                       int, int_t, int_t *, int_t *, Ucb_indptr_t **,
+                       int_t **, int_t *, gridinfo_t *, cLocalLU_t *,
+		       MPI_Request [], SuperLUStat_t *);
+
+extern void clsum_fmod_inv(singlecomplex *, singlecomplex *, singlecomplex *, singlecomplex *,
+		       int, int_t , int_t *,
+		       int_t *, gridinfo_t *, cLocalLU_t *,
+		       SuperLUStat_t **, int_t *, int_t *, int_t, int_t, int_t, int_t, int, int);
+extern void clsum_fmod_inv_master(singlecomplex *, singlecomplex *, singlecomplex *, singlecomplex *,
+		       int, int, int_t , int_t *, int_t,
+		       int_t *, gridinfo_t *, cLocalLU_t *,
+		       SuperLUStat_t **, int_t, int_t, int_t, int_t, int, int);
+extern void clsum_bmod_inv(singlecomplex *, singlecomplex *, singlecomplex *, singlecomplex *,
+                       int, int_t, int_t *, int_t *, Ucb_indptr_t **,
+                       int_t **, int_t *, gridinfo_t *, cLocalLU_t *,
+		       SuperLUStat_t **, int_t *, int_t *, int_t, int_t, int, int);
+extern void clsum_bmod_inv_master(singlecomplex *, singlecomplex *, singlecomplex *, singlecomplex *,
+                       int, int_t, int_t *, int_t *, Ucb_indptr_t **,
+                       int_t **, int_t *, gridinfo_t *, cLocalLU_t *,
+		       SuperLUStat_t **, int_t, int_t, int, int);
+
+extern void pcgsrfs(int_t, SuperMatrix *, float, cLUstruct_t *,
+		    cScalePermstruct_t *, gridinfo_t *,
+		    singlecomplex [], int_t, singlecomplex [], int_t, int,
+		    cSOLVEstruct_t *, float *, SuperLUStat_t *, int *);
+extern void pcgsrfs_ABXglobal(int_t, SuperMatrix *, float, cLUstruct_t *,
+		  gridinfo_t *, singlecomplex *, int_t, singlecomplex *, int_t,
+		  int, float *, SuperLUStat_t *, int *);
+extern int   pcgsmv_AXglobal_setup(SuperMatrix *, Glu_persist_t *,
+				   gridinfo_t *, int_t *, int_t *[],
+				   singlecomplex *[], int_t *[], int_t []);
+extern int  pcgsmv_AXglobal(int_t, int_t [], singlecomplex [], int_t [],
+	                       singlecomplex [], singlecomplex []);
+extern int  pcgsmv_AXglobal_abs(int_t, int_t [], singlecomplex [], int_t [],
+				 singlecomplex [], float []);
+extern void pcgsmv_init(SuperMatrix *, int_t *, gridinfo_t *,
+			pcgsmv_comm_t *);
+extern void pcgsmv(int_t, SuperMatrix *, gridinfo_t *, pcgsmv_comm_t *,
+		   singlecomplex x[], singlecomplex ax[]);
+extern void pcgsmv_finalize(pcgsmv_comm_t *);
+
+/* Memory-related */
+extern singlecomplex  *singlecomplexMalloc_dist(int_t);
+extern singlecomplex  *singlecomplexCalloc_dist(int_t);
+extern float  *floatMalloc_dist(int_t);
+extern float  *floatCalloc_dist(int_t);
+extern void  *duser_malloc_dist (int_t, int_t);
+extern void  duser_free_dist (int_t, int_t);
+extern int_t cQuerySpace_dist(int_t, cLUstruct_t *, gridinfo_t *,
+			      SuperLUStat_t *, superlu_dist_mem_usage_t *);
+
+/* Auxiliary routines */
+
+extern void cClone_CompRowLoc_Matrix_dist(SuperMatrix *, SuperMatrix *);
+extern void cCopy_CompRowLoc_Matrix_dist(SuperMatrix *, SuperMatrix *);
+extern void cZero_CompRowLoc_Matrix_dist(SuperMatrix *);
+extern void cScaleAddId_CompRowLoc_Matrix_dist(SuperMatrix *, singlecomplex);
+extern void cScaleAdd_CompRowLoc_Matrix_dist(SuperMatrix *, SuperMatrix *, singlecomplex);
+extern void cZeroLblocks(int, int_t, gridinfo_t *, cLUstruct_t *);
+extern void    cfill_dist (singlecomplex *, int_t, singlecomplex);
+extern void    cinf_norm_error_dist (int_t, int_t, singlecomplex*, int_t,
+                                     singlecomplex*, int_t, gridinfo_t*);
+extern void    pcinf_norm_error(int, int_t, int_t, singlecomplex [], int_t,
+				singlecomplex [], int_t , gridinfo_t *);
+extern void  creadhb_dist (int, FILE *, int_t *, int_t *, int_t *,
+			   singlecomplex **, int_t **, int_t **);
+extern void  creadtriple_dist(FILE *, int_t *, int_t *, int_t *,
+			 singlecomplex **, int_t **, int_t **);
+extern void  creadtriple_noheader(FILE *, int_t *, int_t *, int_t *,
+			 singlecomplex **, int_t **, int_t **);
+extern void  creadrb_dist(int, FILE *, int_t *, int_t *, int_t *,
+		     singlecomplex **, int_t **, int_t **);
+extern void  creadMM_dist(FILE *, int_t *, int_t *, int_t *,
+	                  singlecomplex **, int_t **, int_t **);
+extern int  cread_binary(FILE *, int_t *, int_t *, int_t *,
+	                  singlecomplex **, int_t **, int_t **);
+
+/* Distribute the data for numerical factorization */
+extern float cdist_psymbtonum(fact_t, int_t, SuperMatrix *,
+                                cScalePermstruct_t *, Pslu_freeable_t *,
+                                cLUstruct_t *, gridinfo_t *);
+extern void pcGetDiagU(int_t, cLUstruct_t *, gridinfo_t *, singlecomplex *);
+
+extern int  c_c2cpp_GetHWPM(SuperMatrix *, gridinfo_t *, cScalePermstruct_t *);
+
+/* Routines for debugging */
+extern void  cPrintLblocks(int, int_t, gridinfo_t *, Glu_persist_t *,
+		 	   cLocalLU_t *);
+extern void  cPrintUblocks(int, int_t, gridinfo_t *, Glu_persist_t *,
+			   cLocalLU_t *);
+extern void  cPrint_CompCol_Matrix_dist(SuperMatrix *);
+extern void  cPrint_Dense_Matrix_dist(SuperMatrix *);
+extern int   cPrint_CompRowLoc_Matrix_dist(SuperMatrix *);
+extern int   file_cPrint_CompRowLoc_Matrix_dist(FILE *fp, SuperMatrix *A);
+extern void  PrintSinglecomplex(char *, int_t, singlecomplex *);
+extern int   file_PrintSinglecomplex(FILE *fp, char *, int_t, singlecomplex *);
+
+
+/* BLAS */
+
+#ifdef USE_VENDOR_BLAS
+extern void cgemm_(const char*, const char*, const int*, const int*, const int*,
+                  const singlecomplex*, const singlecomplex*, const int*, const singlecomplex*,
+                  const int*, const singlecomplex*, singlecomplex*, const int*, int, int);
+extern void ctrsv_(char*, char*, char*, int*, singlecomplex*, int*,
+                  singlecomplex*, int*, int, int, int);
+extern void ctrsm_(char*, char*, char*, char*, int*, int*,
+                  singlecomplex*, singlecomplex*, int*, singlecomplex*,
+                  int*, int, int, int, int);
+extern void cgemv_(char *, int *, int *, singlecomplex *, singlecomplex *a, int *,
+                  singlecomplex *, int *, singlecomplex *, singlecomplex *, int *, int);
+
+extern void cgeru_(int*, int*, singlecomplex*, singlecomplex*, int*,
+                 singlecomplex*, int*, singlecomplex*, int*);
+
+#else
+extern int cgemm_(const char*, const char*, const int*, const int*, const int*,
+                   const singlecomplex*,  const singlecomplex*,  const int*,  const singlecomplex*,
+                   const int*,  const singlecomplex*, singlecomplex*, const int*);
+extern int ctrsv_(char*, char*, char*, int*, singlecomplex*, int*,
+                  singlecomplex*, int*);
+extern int ctrsm_(char*, char*, char*, char*, int*, int*,
+                  singlecomplex*, singlecomplex*, int*, singlecomplex*, int*);
+extern int cgemv_(char *, int *, int *, singlecomplex *, singlecomplex *a, int *,
+                  singlecomplex *, int *, singlecomplex *, singlecomplex *, int *);
+extern int cgeru_(int*, int*, singlecomplex*, singlecomplex*, int*,
+                 singlecomplex*, int*, singlecomplex*, int*);
+
+#endif
+
+extern int cgemm_3m(int, int, int, singlecomplex *, int, singlecomplex *,
+                    int, singlecomplex *, int);
+
+extern int cscal_(int *n, singlecomplex *da, singlecomplex *dx, int *incx);
+extern int caxpy_(int *n, singlecomplex *za, singlecomplex *zx, 
+	               int *incx, singlecomplex *zy, int *incy);
+// LAPACK routine
+extern void ctrtri_(char*, char*, int*, singlecomplex*, int*, int*);
+
+
+#if 0
+/*==== For 3D code ====*/
+
+extern void pcgssvx3d (superlu_dist_options_t *, SuperMatrix *,
+		       cScalePermstruct_t *, singlecomplex B[], int ldb, int nrhs,
+		       gridinfo3d_t *, cLUstruct_t *, cSOLVEstruct_t *, 
+		       float *berr, SuperLUStat_t *, int *info);
+extern int_t pcgstrf3d(superlu_dist_options_t *, int m, int n, float anorm,
+		       trf3Dpartition_t*, SCT_t *, cLUstruct_t *,
+		       gridinfo3d_t *, SuperLUStat_t *, int *);
+extern void cInit_HyP(HyP_t* HyP, cLocalLU_t *Llu, int_t mcb, int_t mrb );
+extern void Free_HyP(HyP_t* HyP);
+extern int updateDirtyBit(int_t k0, HyP_t* HyP, gridinfo_t* grid);
+
+    /* from scatter.h */
+extern void
+cblock_gemm_scatter( int_t lb, int_t j, Ublock_info_t *Ublock_info,
+                    Remain_info_t *Remain_info, singlecomplex *L_mat, int_t ldl,
+                    singlecomplex *U_mat, int_t ldu,  singlecomplex *bigV,
+                    // int_t jj0,
+                    int_t knsupc,  int_t klst,
+                    int_t *lsub, int_t *usub, int_t ldt,
+                    int_t thread_id,
+                    int_t *indirect, int_t *indirect2,
+                    int_t **Lrowind_bc_ptr, singlecomplex **Lnzval_bc_ptr,
+                    int_t **Ufstnz_br_ptr, singlecomplex **Unzval_br_ptr,
+                    int_t *xsup, gridinfo_t *, SuperLUStat_t *
+#ifdef SCATTER_PROFILE
+                    , double *Host_TheadScatterMOP, double *Host_TheadScatterTimer
+#endif
+                  );
+/*this version uses a lock to prevent multiple thread updating the same block*/
+extern void
+cblock_gemm_scatter_lock( int_t lb, int_t j, omp_lock_t* lock,
+                         Ublock_info_t *Ublock_info,  Remain_info_t *Remain_info,
+                         singlecomplex *L_mat, int_t ldl, singlecomplex *U_mat, int_t ldu,
+                         singlecomplex *bigV,
+                         // int_t jj0,
+                         int_t knsupc,  int_t klst,
+                         int_t *lsub, int_t *usub, int_t ldt,
+                         int_t thread_id,
+                         int_t *indirect, int_t *indirect2,
+                         int_t **Lrowind_bc_ptr, singlecomplex **Lnzval_bc_ptr,
+                         int_t **Ufstnz_br_ptr, singlecomplex **Unzval_br_ptr,
+                         int_t *xsup, gridinfo_t *
+#ifdef SCATTER_PROFILE
+                         , double *Host_TheadScatterMOP, double *Host_TheadScatterTimer
+#endif
+                       );
+extern int_t
+cblock_gemm_scatterTopLeft( int_t lb,  int_t j, singlecomplex* bigV,
+				 int_t knsupc,  int_t klst, int_t* lsub,
+                                 int_t * usub, int_t ldt,
+				 int_t* indirect, int_t* indirect2,
+                                 HyP_t* HyP, cLUstruct_t *, gridinfo_t*,
+                                 SCT_t*SCT, SuperLUStat_t *
+                               );
+extern int_t 
+cblock_gemm_scatterTopRight( int_t lb,  int_t j, singlecomplex* bigV,
+				  int_t knsupc,  int_t klst, int_t* lsub,
+                                  int_t * usub, int_t ldt,
+				  int_t* indirect, int_t* indirect2,
+                                  HyP_t* HyP, cLUstruct_t *, gridinfo_t*,
+                                  SCT_t*SCT, SuperLUStat_t * );
+extern int_t
+cblock_gemm_scatterBottomLeft( int_t lb,  int_t j, singlecomplex* bigV,
+				    int_t knsupc,  int_t klst, int_t* lsub,
+                                    int_t * usub, int_t ldt, 
+				    int_t* indirect, int_t* indirect2,
+                                    HyP_t* HyP, cLUstruct_t *, gridinfo_t*,
+                                    SCT_t*SCT, SuperLUStat_t * );
+extern int_t 
+cblock_gemm_scatterBottomRight( int_t lb,  int_t j, singlecomplex* bigV,
+				     int_t knsupc,  int_t klst, int_t* lsub,
+                                     int_t * usub, int_t ldt,
+				     int_t* indirect, int_t* indirect2,
+                                     HyP_t* HyP, cLUstruct_t *, gridinfo_t*,
+                                     SCT_t*SCT, SuperLUStat_t * );
+
+    /* from gather.h */
+extern void cgather_u(int_t num_u_blks,
+              Ublock_info_t *Ublock_info, int_t * usub,
+              singlecomplex *uval,  singlecomplex *bigU,  int_t ldu,
+              int_t *xsup, int_t klst                /* for SuperSize */
+             );
+
+extern void cgather_l( int_t num_LBlk, int_t knsupc,
+               Remain_info_t *L_info,
+               singlecomplex * lval, int_t LD_lval,
+               singlecomplex * L_buff );
+
+extern void cRgather_L(int_t k, int_t *lsub, singlecomplex *lusup, gEtreeInfo_t*,
+		      Glu_persist_t *, gridinfo_t *, HyP_t *,
+		      int_t *myIperm, int_t *iperm_c_supno );
+extern void cRgather_U(int_t k, int_t jj0, int_t *usub, singlecomplex *uval,
+		      singlecomplex *bigU, gEtreeInfo_t*, Glu_persist_t *,
+		      gridinfo_t *, HyP_t *, int_t *myIperm,
+		      int_t *iperm_c_supno, int_t *perm_u);
+
+    /* from xtrf3Dpartition.h */
+extern trf3Dpartition_t* cinitTrf3Dpartition(int_t nsupers,
+					     superlu_dist_options_t *options,
+					     cLUstruct_t *LUstruct, gridinfo3d_t * grid3d);
+extern void cDestroy_trf3Dpartition(trf3Dpartition_t *trf3Dpartition, gridinfo3d_t *grid3d);
+
+extern void c3D_printMemUse(trf3Dpartition_t*  trf3Dpartition,
+			    cLUstruct_t *LUstruct, gridinfo3d_t * grid3d);
+
+extern int* getLastDep(gridinfo_t *grid, SuperLUStat_t *stat,
+		       superlu_dist_options_t *options, cLocalLU_t *Llu,
+		       int_t* xsup, int_t num_look_aheads, int_t nsupers,
+		       int_t * iperm_c_supno);
+
+extern void cinit3DLUstructForest( int_t* myTreeIdxs, int_t* myZeroTrIdxs,
+				  sForest_t**  sForests, cLUstruct_t* LUstruct,
+				  gridinfo3d_t* grid3d);
+
+extern int_t cgatherAllFactoredLUFr(int_t* myZeroTrIdxs, sForest_t* sForests,
+				   cLUstruct_t* LUstruct, gridinfo3d_t* grid3d,
+				   SCT_t* SCT );
+
+    /* The following are from pdgstrf2.h */
+#if 0 // Sherry: same routine names, but different code !!!!!!!
+extern void pcgstrf2_trsm(superlu_dist_options_t *options, int_t, int_t,
+                          int_t k, float thresh, Glu_persist_t *,
+			  gridinfo_t *, cLocalLU_t *, MPI_Request *U_diag_blk_send_req,
+			  int tag_ub, SuperLUStat_t *, int *info, SCT_t *);
+#ifdef _CRAY
+void pcgstrs2_omp (int_t, int_t, int_t, Glu_persist_t *, gridinfo_t *,
+                      cLocalLU_t *, SuperLUStat_t *, _fcd, _fcd, _fcd);
+#else
+void pcgstrs2_omp (int_t, int_t, int_t, int_t *, singlecomplex*, Glu_persist_t *, gridinfo_t *,
+                      cLocalLU_t *, SuperLUStat_t *, Ublock_info_t *, singlecomplex *bigV, int_t ldt, SCT_t *SCT );
+#endif
+
+#else 
+extern void pcgstrf2_trsm(superlu_dist_options_t * options, int_t k0, int_t k,
+			  float thresh, Glu_persist_t *, gridinfo_t *,
+			  cLocalLU_t *, MPI_Request *, int tag_ub,
+			  SuperLUStat_t *, int *info);
+extern void pcgstrs2_omp(int_t k0, int_t k, Glu_persist_t *, gridinfo_t *,
+			 cLocalLU_t *, Ublock_info_t *, SuperLUStat_t *);
+#endif // same routine names   !!!!!!!!
+
+extern int_t cLpanelUpdate(int_t off0, int_t nsupc, singlecomplex* ublk_ptr,
+			  int_t ld_ujrow, singlecomplex* lusup, int_t nsupr, SCT_t*);
+extern void Local_Cgstrf2(superlu_dist_options_t *options, int_t k,
+			  float thresh, singlecomplex *BlockUFactor, Glu_persist_t *,
+			  gridinfo_t *, cLocalLU_t *,
+                          SuperLUStat_t *, int *info, SCT_t*);
+extern int_t cTrs2_GatherU(int_t iukp, int_t rukp, int_t klst,
+			  int_t nsupc, int_t ldu, int_t *usub,
+			  singlecomplex* uval, singlecomplex *tempv);
+extern int_t cTrs2_ScatterU(int_t iukp, int_t rukp, int_t klst,
+			   int_t nsupc, int_t ldu, int_t *usub,
+			   singlecomplex* uval, singlecomplex *tempv);
+extern int_t cTrs2_GatherTrsmScatter(int_t klst, int_t iukp, int_t rukp,
+                             int_t *usub, singlecomplex* uval, singlecomplex *tempv,
+                             int_t knsupc, int_t nsupr, singlecomplex* lusup,
+                             Glu_persist_t *Glu_persist)  ;
+extern void pcgstrs2
+#ifdef _CRAY
+(
+    int_t m, int_t k0, int_t k, Glu_persist_t *Glu_persist, gridinfo_t *grid,
+    cLocalLU_t *Llu, SuperLUStat_t *stat, _fcd ftcs1, _fcd ftcs2, _fcd ftcs3
+);
+#else
+(
+    int_t m, int_t k0, int_t k, Glu_persist_t *Glu_persist, gridinfo_t *grid,
+    cLocalLU_t *Llu, SuperLUStat_t *stat
+);
+#endif
+
+extern void pcgstrf2(superlu_dist_options_t *, int_t nsupers, int_t k0,
+		     int_t k, float thresh, Glu_persist_t *, gridinfo_t *,
+		     cLocalLU_t *, MPI_Request *, int, SuperLUStat_t *, int *);
+
+    /* from p3dcomm.h */
+extern int_t cAllocLlu_3d(int_t nsupers, cLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t cp3dScatter(int_t n, cLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t cscatter3dLPanels(int_t nsupers,
+                       cLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t cscatter3dUPanels(int_t nsupers,
+                       cLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t ccollect3dLpanels(int_t layer, int_t nsupers, cLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t ccollect3dUpanels(int_t layer, int_t nsupers, cLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t cp3dCollect(int_t layer, int_t n, cLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+/*zero out LU non zero entries*/
+extern int_t czeroSetLU(int_t nnodes, int_t* nodeList , cLUstruct_t *, gridinfo3d_t*);
+extern int AllocGlu_3d(int_t n, int_t nsupers, cLUstruct_t *);
+extern int DeAllocLlu_3d(int_t n, cLUstruct_t *, gridinfo3d_t*);
+extern int DeAllocGlu_3d(cLUstruct_t *);
+
+/* Reduces L and U panels of nodes in the List nodeList (size=nnnodes)
+receiver[L(nodelist)] =sender[L(nodelist)] +receiver[L(nodelist)]
+receiver[U(nodelist)] =sender[U(nodelist)] +receiver[U(nodelist)]
+*/
+int_t creduceAncestors3d(int_t sender, int_t receiver,
+                        int_t nnodes, int_t* nodeList,
+                        singlecomplex* Lval_buf, singlecomplex* Uval_buf,
+                        cLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+/*reduces all nodelists required in a level*/
+int_t creduceAllAncestors3d(int_t ilvl, int_t* myNodeCount,
+                           int_t** treePerm,
+                           cLUValSubBuf_t* LUvsb,
+                           cLUstruct_t* LUstruct,
+                           gridinfo3d_t* grid3d,
+                           SCT_t* SCT );
+/*
+	Copies factored L and U panels from sender grid to receiver grid
+	receiver[L(nodelist)] <-- sender[L(nodelist)];
+	receiver[U(nodelist)] <-- sender[U(nodelist)];
+*/
+int_t cgatherFactoredLU(int_t sender, int_t receiver,
+                       int_t nnodes, int_t *nodeList, cLUValSubBuf_t*  LUvsb,
+                       cLUstruct_t* LUstruct, gridinfo3d_t* grid3d,SCT_t* SCT );
+
+/*Gathers all the L and U factors to grid 0 for solve stage 
+	By  repeatidly calling above function*/
+int_t cgatherAllFactoredLU(trf3Dpartition_t*  trf3Dpartition, cLUstruct_t* LUstruct,
+			   gridinfo3d_t* grid3d, SCT_t* SCT );
+
+/*Distributes data in each layer and initilizes ancestors
+ as zero in required nodes*/
+int_t cinit3DLUstruct( int_t* myTreeIdxs, int_t* myZeroTrIdxs,
+                      int_t* nodeCount, int_t** nodeList,
+                      cLUstruct_t* LUstruct, gridinfo3d_t* grid3d);
+
+int_t czSendLPanel(int_t k, int_t receiver,
+		   cLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+int_t czRecvLPanel(int_t k, int_t sender, singlecomplex alpha, 
+                   singlecomplex beta, singlecomplex* Lval_buf,
+		   cLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+int_t czSendUPanel(int_t k, int_t receiver,
+		   cLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+int_t czRecvUPanel(int_t k, int_t sender, singlecomplex alpha,
+                   singlecomplex beta, singlecomplex* Uval_buf,
+		   cLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+
+    /* from communication_aux.h */
+extern int_t cIBcast_LPanel (int_t k, int_t k0, int_t* lsub, singlecomplex* lusup,
+			     gridinfo_t *, int* msgcnt, MPI_Request *,
+			     int_t **ToSendR, int_t *xsup, int );
+extern int_t cBcast_LPanel(int_t k, int_t k0, int_t* lsub, singlecomplex* lusup,
+			   gridinfo_t *, int* msgcnt, int_t **ToSendR,
+			   int_t *xsup , SCT_t*, int);
+extern int_t cIBcast_UPanel(int_t k, int_t k0, int_t* usub, singlecomplex* uval,
+			    gridinfo_t *, int* msgcnt, MPI_Request *,
+			    int_t *ToSendD, int );
+extern int_t cBcast_UPanel(int_t k, int_t k0, int_t* usub, singlecomplex* uval,
+			   gridinfo_t *, int* msgcnt, int_t *ToSendD, SCT_t*, int);
+extern int_t cIrecv_LPanel (int_t k, int_t k0,  int_t* Lsub_buf, 
+			    singlecomplex* Lval_buf, gridinfo_t *,
+			    MPI_Request *, cLocalLU_t *, int);
+extern int_t cIrecv_UPanel(int_t k, int_t k0, int_t* Usub_buf, singlecomplex*,
+			   cLocalLU_t *, gridinfo_t*, MPI_Request *, int);
+extern int_t Wait_LSend(int_t k, gridinfo_t *grid, int_t **ToSendR,
+			MPI_Request *s, SCT_t*);
+extern int_t Wait_USend(MPI_Request *, gridinfo_t *, SCT_t *);
+extern int_t cWait_URecv(MPI_Request *, int* msgcnt, SCT_t *);
+extern int_t Check_LRecv(MPI_Request*, int* msgcnt);
+extern int_t cWait_LRecv(MPI_Request*, int* msgcnt, int* msgcntsU,
+			 gridinfo_t *, SCT_t*);
+extern int_t cISend_UDiagBlock(int_t k0, singlecomplex *ublk_ptr, int_t size,
+			       MPI_Request *, gridinfo_t *, int);
+extern int_t cRecv_UDiagBlock(int_t k0, singlecomplex *ublk_ptr, int_t size,
+			      int_t src, gridinfo_t *, SCT_t*, int);
+extern int_t Wait_UDiagBlockSend(MPI_Request *, gridinfo_t *, SCT_t *);
+extern int_t Wait_LDiagBlockSend(MPI_Request *, gridinfo_t *, SCT_t *);
+extern int_t cPackLBlock(int_t k, singlecomplex* Dest, Glu_persist_t *,
+			 gridinfo_t *, cLocalLU_t *);
+extern int_t cISend_LDiagBlock(int_t k0, singlecomplex *lblk_ptr, int_t size,
+			       MPI_Request *, gridinfo_t *, int);
+extern int_t cIRecv_UDiagBlock(int_t k0, singlecomplex *ublk_ptr, int_t size,
+			       int_t src, MPI_Request *, gridinfo_t *,
+			       SCT_t*, int);
+extern int_t Wait_UDiagBlock_Recv(MPI_Request *, SCT_t *);
+extern int_t Test_UDiagBlock_Recv(MPI_Request *, SCT_t *);
+extern int_t cIRecv_LDiagBlock(int_t k0, singlecomplex *L_blk_ptr, int_t size,
+			       int_t src, MPI_Request *, gridinfo_t*, SCT_t*, int);
+extern int_t Wait_LDiagBlock_Recv(MPI_Request *, SCT_t *);
+extern int_t Test_LDiagBlock_Recv(MPI_Request *, SCT_t *);
+
+extern int_t cUDiagBlockRecvWait( int_t k,  int_t* IrecvPlcd_D, int_t* factored_L,
+				  MPI_Request *, gridinfo_t *, cLUstruct_t *, SCT_t *);
+extern int_t LDiagBlockRecvWait( int_t k, int_t* factored_U, MPI_Request *, gridinfo_t *);
+#if (MPI_VERSION>2)
+extern int_t cIBcast_UDiagBlock(int_t k, singlecomplex *ublk_ptr, int_t size,
+				MPI_Request *, gridinfo_t *);
+extern int_t cIBcast_LDiagBlock(int_t k, singlecomplex *lblk_ptr, int_t size,
+			       MPI_Request *, gridinfo_t *);
+#endif
+
+    /* from trfCommWrapper.h */
+extern int_t cDiagFactIBCast(int_t k,  int_t k0,
+			     singlecomplex *BlockUFactor, singlecomplex *BlockLFactor,
+			     int_t* IrecvPlcd_D, MPI_Request *, MPI_Request *,
+			     MPI_Request *, MPI_Request *, gridinfo_t *,
+			     superlu_dist_options_t *, float thresh,
+			     cLUstruct_t *LUstruct, SuperLUStat_t *, int *info,
+			     SCT_t *, int tag_ub);
+extern int_t cUPanelTrSolve( int_t k, singlecomplex* BlockLFactor, singlecomplex* bigV,
+			     int_t ldt, Ublock_info_t*, gridinfo_t *,
+			     cLUstruct_t *, SuperLUStat_t *, SCT_t *);
+extern int_t Wait_LUDiagSend(int_t k, MPI_Request *, MPI_Request *,
+			     gridinfo_t *, SCT_t *);
+extern int_t cLPanelUpdate(int_t k,  int_t* IrecvPlcd_D, int_t* factored_L,
+			   MPI_Request *, singlecomplex* BlockUFactor, gridinfo_t *,
+			   cLUstruct_t *, SCT_t *);
+extern int_t cUPanelUpdate(int_t k, int_t* factored_U, MPI_Request *,
+			   singlecomplex* BlockLFactor, singlecomplex* bigV,
+			   int_t ldt, Ublock_info_t*, gridinfo_t *,
+			   cLUstruct_t *, SuperLUStat_t *, SCT_t *);
+extern int_t cIBcastRecvLPanel(int_t k, int_t k0, int* msgcnt,
+			       MPI_Request *, MPI_Request *,
+			       int_t* Lsub_buf, singlecomplex* Lval_buf,
+			      int_t * factored, gridinfo_t *, cLUstruct_t *,
+			      SCT_t *, int tag_ub);
+extern int_t cIBcastRecvUPanel(int_t k, int_t k0, int* msgcnt, MPI_Request *,
+			       MPI_Request *, int_t* Usub_buf, singlecomplex* Uval_buf,
+			       gridinfo_t *, cLUstruct_t *, SCT_t *, int tag_ub);
+extern int_t cWaitL(int_t k, int* msgcnt, int* msgcntU, MPI_Request *,
+		    MPI_Request *, gridinfo_t *, cLUstruct_t *, SCT_t *);
+extern int_t cWaitU(int_t k, int* msgcnt, MPI_Request *, MPI_Request *,
+		   gridinfo_t *, cLUstruct_t *, SCT_t *);
+extern int_t cLPanelTrSolve(int_t k, int_t* factored_L, singlecomplex* BlockUFactor,
+			    gridinfo_t *, cLUstruct_t *);
+
+    /* from trfAux.h */
+extern int_t getNsupers(int, cLUstruct_t *);
+extern int_t initPackLUInfo(int_t nsupers, packLUInfo_t* packLUInfo);
+extern int   freePackLUInfo(packLUInfo_t* packLUInfo);
+extern int_t cSchurComplementSetup(int_t k, int *msgcnt, Ublock_info_t*,
+				   Remain_info_t*, uPanelInfo_t *,
+				   lPanelInfo_t *, int_t*, int_t *, int_t *,
+				   singlecomplex *bigU, int_t* Lsub_buf,
+				   singlecomplex* Lval_buf, int_t* Usub_buf,
+				   singlecomplex* Uval_buf, gridinfo_t *, cLUstruct_t *);
+extern int_t cSchurComplementSetupGPU(int_t k, msgs_t* msgs, packLUInfo_t*,
+				      int_t*, int_t*, int_t*, gEtreeInfo_t*,
+				      factNodelists_t*, scuBufs_t*,
+				      cLUValSubBuf_t* LUvsb, gridinfo_t *,
+				      cLUstruct_t *, HyP_t*);
+extern singlecomplex* cgetBigV(int_t, int_t);
+extern singlecomplex* cgetBigU(int_t, gridinfo_t *, cLUstruct_t *);
+extern int_t getBigUSize(int_t, gridinfo_t *, cLUstruct_t *);
+// permutation from superLU default
+extern int_t* getPerm_c_supno(int_t nsupers, superlu_dist_options_t *,
+			      cLUstruct_t *, gridinfo_t *);
+extern void getSCUweight(int_t nsupers, treeList_t* treeList, cLUstruct_t *, gridinfo3d_t *);
+
+    /* from treeFactorization.h */
+extern int_t cLluBufInit(cLUValSubBuf_t*, cLUstruct_t *);
+extern int_t cinitScuBufs(int_t ldt, int_t num_threads, int_t nsupers,
+			  scuBufs_t*, cLUstruct_t*, gridinfo_t *);
+extern int cfreeScuBufs(scuBufs_t* scuBufs);
+
+// the generic tree factoring code 
+extern int_t treeFactor(
+    int_t nnnodes,          // number of nodes in the tree
+    int_t *perm_c_supno,    // list of nodes in the order of factorization
+    commRequests_t *comReqs,    // lists of communication requests
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t*msgs,
+    cLUValSubBuf_t* LUvsb,
+    diagFactBufs_t *dFBuf,
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    cLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT,
+    int *info
+);
+
+extern int_t csparseTreeFactor(
+    int_t nnodes,          // number of nodes in the tree
+    int_t *perm_c_supno,    // list of nodes in the order of factorization
+    treeTopoInfo_t* treeTopoInfo,
+    commRequests_t *comReqs,    // lists of communication requests
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t*msgs,
+    cLUValSubBuf_t* LUvsb,
+    diagFactBufs_t *dFBuf,
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    cLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT,
+    int *info
+);
+
+extern int_t cdenseTreeFactor(
+    int_t nnnodes,          // number of nodes in the tree
+    int_t *perm_c_supno,    // list of nodes in the order of factorization
+    commRequests_t *comReqs,    // lists of communication requests
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t*msgs,
+    cLUValSubBuf_t* LUvsb,
+    diagFactBufs_t *dFBuf,
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    cLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT, int tag_ub,
+    int *info
+);
+
+extern int_t csparseTreeFactor_ASYNC(
+    sForest_t* sforest,
+    commRequests_t **comReqss,    // lists of communication requests // size maxEtree level
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t**msgss,                  // size=num Look ahead
+    cLUValSubBuf_t** LUvsbs,          // size=num Look ahead
+    diagFactBufs_t **dFBufs,         // size maxEtree level
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    gEtreeInfo_t*   gEtreeInfo,        // global etree info
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    HyP_t* HyP,
+    cLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT, int tag_ub,
+    int *info
+);
+extern cLUValSubBuf_t** cLluBufInitArr(int_t numLA, cLUstruct_t *LUstruct);
+extern int cLluBufFreeArr(int_t numLA, cLUValSubBuf_t **LUvsbs);
+extern diagFactBufs_t** cinitDiagFactBufsArr(int_t mxLeafNode, int_t ldt, gridinfo_t* grid);
+extern int cfreeDiagFactBufsArr(int_t mxLeafNode, diagFactBufs_t** dFBufs);
+extern int_t cinitDiagFactBufs(int_t ldt, diagFactBufs_t* dFBuf);
+extern int_t checkRecvUDiag(int_t k, commRequests_t *comReqs,
+			    gridinfo_t *grid, SCT_t *SCT);
+extern int_t checkRecvLDiag(int_t k, commRequests_t *comReqs, gridinfo_t *, SCT_t *);
+
+    /* from ancFactorization.h (not called) */
+extern int_t ancestorFactor(
+    int_t ilvl,             // level of factorization 
+    sForest_t* sforest,
+    commRequests_t **comReqss,    // lists of communication requests // size maxEtree level
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t**msgss,                  // size=num Look ahead
+    cLUValSubBuf_t** LUvsbs,          // size=num Look ahead
+    diagFactBufs_t **dFBufs,         // size maxEtree level
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    gEtreeInfo_t*   gEtreeInfo,        // global etree info
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    HyP_t* HyP,
+    cLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT, int tag_ub, int *info
+);
+
+/*=====================*/
+#endif  // end 3D prototypes
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif /* __SUPERLU_CDEFS */
+
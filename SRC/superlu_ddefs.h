@@ -89,6 +89,24 @@ typedef struct {
 } Ucb_indptr_t;
 #endif
 
+/*
+ * Where the entries of the distributed A go in L and U. Recorded by
+ * pddistribute() at the first refactorization with
+ * Fact = SamePattern_SameRowPerm, and used by the following ones to
+ * move the new values of A into L and U without any index computation.
+ */
+typedef struct {
+    int_t  nnz_loc;     /* number of entries of the local A              */
+    int_t  nlocal;      /* of which stay on this process                 */
+    int_t  nrecv;       /* number of entries of A put in my L and U      */
+    int_t  *send_slot;  /* position of A's entry k in sendbuf[]          */
+    int    *sendcnt, *sdispls, *recvcnt, *rdispls; /* for MPI_Alltoallv  */
+    double **dst;       /* where received entry i goes; NULL if dropped  */
+    int    *dst_sn;     /* the supernode of the panel of dst[i]          */
+    double *sendbuf;    /* size nnz_loc, the nlocal ones first           */
+    double *recvbuf;    /* size nrecv - nlocal, the remote entries       */
+} dAmap_t;
+
 /*
  * On each processor, the blocks in L are stored in compressed block
  * column format, the blocks in U are stored in compressed block row format.
@@ -180,14 +198,75 @@ typedef struct {
     int_t nleaf;
     int_t nfrecvmod;
     int_t inv; /* whether the diagonal block is inverted*/
+    int   inv_minsize, inv_maxsize; /* sizes of the supernodes inverted,
+					see options->DiagInv_MinSize */
+    int   inv_pending; /* pdgstrs() computes the inverses first */
+    double inv_budget; /* megabytes for the factors and the inverses,
+			  0 for no limit, see options->MemBudget */
+    double *sol_tdone; /* when X[k] is solved, set by pdgstrs(); NULL
+			  if not measured, see options->Solve_CritPath */
+    int   lsum_shared; /* the threads of pdgstrs() share lsum[], 0 if
+			  each has its own copy, see LSUM_COPY() */
+    int_t fixed_order; /* solve in a fixed summation order, see
+			  options->Reproducible */
+    dAmap_t *Amap; /* see pddistribute(); NULL until recorded */
+    double *sn_cost; /* measured cost of each supernode in the last
+			factorization, used by the static schedule of the
+			next one; NULL if not recorded, see superlu_sncost.c */
+    char *sn_dirty; /* the supernodes refactored by pdgsrefactor_partial(),
+		       the others keep their factors; NULL for all */
+    int_t *Acolind; /* column indices of A permuted by columns, in the
+		       order of its entries, kept by pdgssvx() for
+		       pdgsrefactor(); NULL if not kept */
+    double *Lnzval_slab, *Unzval_slab; /* values of all the blocks of L or U,
+				      see pddistribute(); NULL if the
+				      blocks are allocated one by one */
+    int ooc; /* keep the slabs in files, see options->OutOfCore */
+    int release; /* no Amap, ToRecv etc. freed after the factorization,
+		    see options->ReleaseMemory */
+    int Udropped; /* the blocks of U off the diagonal are freed, U being
+		     diag(U)*L^T, see options->SymValues */
+    int compact; /* convert the factors at the next solve, see
+		    options->Solve_Compact */
+    double *solve_slab; /* L, the inverses of its diagonal blocks and U in
+		       the layout of the solves, see dCompact_LU(); NULL
+		       if not converted */
+    double droptol; /* threshold ILU, see options->ILU_DropTol */
+    superlu_ooc_t Lnzval_ooc, Unzval_ooc; /* the slabs in files; base is
+				      NULL if in memory */
+    superlu_treespec_t LBtree_spec, LRtree_spec, /* trees not created yet */
+		       UBtree_spec, URtree_spec; /* see dCreate_Trees()  */
 } dLocalLU_t;
 
 
+/*-- Product by the original matrix supplied by the user to the iterative
+ *   refinement, see LUstruct->matvec and pdgsrfs_matvec().
+ *
+ * apply(trans, abs, nrhs, x, ldx, y, ldy, data) computes y = op(A)*x, or
+ * y = abs(op(A))*x if abs is nonzero (x being then nonnegative), for the
+ * matrix A given to pdgssvx() before scaling and permutation. Each process
+ * holds the rows fst_row:fst_row+m_loc-1 of x and y, as for A, and all the
+ * processes call apply() together. data is passed unchanged.
+ */
+typedef struct {
+    void (*apply)(trans_t trans, int abs, int nrhs, double *x, int_t ldx,
+		  double *y, int_t ldy, void *data);
+    void *data;
+} dMatvec_t;
+
 typedef struct {
     int_t *etree;
     Glu_persist_t *Glu_persist;
     dLocalLU_t *Llu;
     char dt;
+    void *sLUstruct;  /* single precision factors, used when
+			 options->SingleFactor = YES (see pdsutil.c) */
+    void *dense;      /* dense factors of a small A, used when
+			 n <= options->Dense_MaxN (see pdgsdense.c) */
+    superlu_symbfact_t *usymb; /* symbolic factorization supplied by the
+				  user, see options->UserSymbFact */
+    dMatvec_t *matvec; /* product by A in the refinement, in place of the
+			  distributed A; NULL to use A */
 } dLUstruct_t;
 
 
@@ -212,6 +291,41 @@ typedef struct {
 			     (also total number of indices to be received) */
 } pdgsmv_comm_t;
 
+/*-- Workspace of pdgstrs(), kept between the calls with the same nrhs --*/
+typedef struct {
+    int    nrhs, num_thread, maxrecvsz; /* the buffers are sized for these */
+    int    nrecvbuf;  /* slots of maxrecvsz in recvbuf */
+    int    root_size; /* and the root for this SOLVEstruct->root_size */
+    int_t  *fmod_init, *frecv_init; /* counts at the start of the L-solve */
+    int_t  *bmod_init, *brecv_init; /* counts at the start of the U-solve */
+    int_t  *fmod, *frecv, *bmod, *brecv; /* the counts altered by a solve */
+    int_t  *leafsups, *rootsups;    /* blocks solved first in the L- and U-solve */
+    int_t  nleaf, nroot, nfrecvmod, nbrecvmod;
+    int_t  *leaf_send, *root_send;
+    int_t  nlevels;   /* number of level sets of the threaded L-solve */
+    int_t  *lvlptr, *lvlsups; /* supernodes of level l in lvlsups[lvlptr[l]:
+				 lvlptr[l+1]-1]; NULL on more than 1 process */
+    int_t  *sparent;  /* supernodal etree, set up by the first pruned solve */
+    int    *active, *needed; /* supernodes of the pruned L- and U-solves */
+    int_t  *prunesups; /* leaves or roots of the pruned solves */
+    int_t  kroot;     /* supernodes kroot:nsupers-1 are solved on all the
+			 processes, kroot = nsupers if none */
+    double *rootLU;   /* their dense L\U, unit lower L, on all processes */
+    double *rootx;    /* their part of X */
+    double *tdone;    /* when X[k] is solved in the L-solve, tdone[0:nsupers-1],
+			 and in the U-solve; NULL if not measured */
+    int_t  *prio;     /* priorities of the L- and U-solve, see
+			 pxgstrs_priority(); NULL if not used */
+    int_t  sizelsum, sizertemp;
+    int    nlsum;     /* copies of lsum[]: num_thread, or 1 if shared */
+    int    lsum_shared; /* lsum[] is shared by the threads, see LSUM_COPY() */
+    double *lsum, *x, *rtemp, *recvbuf;
+    pxgstrs_agg_t *agg; /* small messages sent in packets, or NULL */
+    int    *plan;     /* messages by source of the L-solve, then of the
+			 U-solve, see pxgstrs_ring_init() */
+    SuperLUStat_t **stat_loc;
+} dgstrs_work_t;
+
 /*-- Data structure holding the information for the solution phase --*/
 typedef struct {
     int_t *row_to_proc;
@@ -225,8 +339,97 @@ typedef struct {
                              positions in the gathered x-vector.
                              This is re-used in repeated calls to pdgsmv() */
     int_t *xrow_to_proc; /* used by PDSLin */
+    dgstrs_work_t *gstrs_work; /* set up by the first pdgstrs() call */
+    yes_no_t sparse_rhs; /* prune the L-solve to the nonzeros of B,
+			    see options->SparseRHS */
+    int_t nout_rows, *out_rows; /* if out_rows is not NULL, pdgstrs() only
+				   computes these rows of X, see pdgstrs() */
+    yes_no_t x_layout; /* B of pdgstrs() is in the solve layout, see
+			  pdSolveLayout() */
+    int root_size; /* see options->Solve_RootSize */
+    yes_no_t crit_path; /* see options->Solve_CritPath */
+    yes_no_t priority; /* see options->Solve_Priority */
+    int rhs_tile; /* see options->Solve_RHSTile */
+    msg_prec_t refine_msg_prec; /* see options->Refine_MsgPrec */
+    msg_prec_t msg_prec; /* precision of the tree messages of pdgstrs(),
+			    set by pdgsrfs() for its corrections */
 } dSOLVEstruct_t;
 
+/*
+ * The selected inverse W = A1^{-T} computed by pdSelInv(), in the layouts
+ * of the local blocks of L (Lnzval_bc_ptr) and U (Unzval_br_ptr).
+ */
+typedef struct {
+    double **Ainv_bc_ptr; /* Ainv_bc_ptr[lk] has the shape of Lnzval_bc_ptr[lk] */
+    double **Ainv_br_ptr; /* Ainv_br_ptr[lk] has the shape of Unzval_br_ptr[lk] */
+} dSelInvstruct_t;
+
+/*-- Handle of a call started by pdgssvx_start() --*/
+typedef struct {
+    superlu_dist_options_t *options;
+    SuperMatrix *A;
+    dScalePermstruct_t *ScalePermstruct;
+    double *B;
+    int ldb, nrhs;
+    gridinfo_t *grid;
+    dLUstruct_t *LUstruct;
+    dSOLVEstruct_t *SOLVEstruct;
+    double *berr;
+    SuperLUStat_t *stat;
+    int *info;
+    void *thread;     /* progress thread; NULL once the call completed */
+} dgssvxRequest_t;
+
+/*-- Queue of right-hand sides for pdgstrs_push() --*/
+typedef struct {
+    int_t m_loc, fst_row; /* local rows of B, as in pdgstrs() */
+    int maxrhs;           /* capacity of the queue, in columns */
+    int nrhs;             /* number of queued columns */
+    int nbatch;           /* number of queued batches */
+    double *Q;            /* queued columns, m_loc-by-maxrhs */
+    double **Bptr;        /* where the solution of each batch goes */
+    int_t *ldb;           /* leading dimension of each batch */
+    int *ncol;            /* number of columns of each batch */
+} dRHSqueue_t;
+
+/*-- Triples being assembled into a distributed matrix, see pdassemble.c --*/
+typedef struct {
+    int_t m, n;
+    int_t *start;         /* first row of each process, and m */
+    int_t nz, cap;        /* triples added, and room for */
+    int_t *row, *col;
+    double *val;
+    gridinfo_t *grid;
+} dAssembly_t;
+
+/*-- Batch of independent systems for pdgssvx_batch() --*/
+typedef struct {
+    int nsys;             /* number of systems of the batch */
+    int ngroups;          /* number of process groups */
+    int group;            /* my group, -1 if idle */
+    int *sys_group;       /* sys_group[s] is the group of system s */
+    int nloc;             /* number of systems of my group */
+    int *loc;             /* loc[l] is the l-th system of my group */
+    gridinfo_t grid;      /* process grid of my group */
+    /* Kept between the calls, for each system of my group: */
+    superlu_dist_options_t *options;
+    dScalePermstruct_t *ScalePermstruct;
+    dLUstruct_t *LUstruct;
+    dSOLVEstruct_t *SOLVEstruct;
+    int_t *n;             /* order of the factored system, EMPTY if none */
+} dBatch_t;
+
+/*-- Low-rank update A + U*V^T of the factored A, see pdgssmw_update() --*/
+typedef struct {
+    int k;                /* rank of the update so far */
+    int kmax;             /* beyond which A + U*V^T should be refactored */
+    int m_loc;            /* number of local rows of W and V */
+    double *W;            /* A^{-1}*U, local rows, leading dimension m_loc */
+    double *V;            /* V, local rows, leading dimension m_loc */
+    double *C;            /* LU of I + V^T*A^{-1}*U, k-by-k, on all processes */
+    int *ipiv;            /* pivots of C */
+} dSMW_t;
+
 #if 0 
 
 /*==== For 3D code ====*/
@@ -381,6 +584,8 @@ extern int     dcreate_matrix_dat(SuperMatrix *, int, double **, int *,
 			      double **, int *, FILE *, gridinfo_t *);
 extern int 	   dcreate_matrix_postfix(SuperMatrix *, int, double **, int *,
 				  double **, int *, FILE *, char *, gridinfo_t *);
+extern int     dcreate_matrix_gen(SuperMatrix *, int, double **, int *,
+				  double **, int *, char *, gridinfo_t *);
 
 extern void   dScalePermstructInit(const int_t, const int_t, 
                                       dScalePermstruct_t *);
@@ -394,6 +599,8 @@ extern void    dlaqgs_dist (SuperMatrix *, double *, double *, double,
 			    double, double, char *);
 extern void    pdgsequ (SuperMatrix *, double *, double *, double *,
 			double *, double *, int_t *, gridinfo_t *);
+extern void    pdgsequ_ruiz (SuperMatrix *, int, double *, double *, double *,
+			     double *, double *, int_t *, gridinfo_t *);
 extern double  pdlangs (char *, SuperMatrix *, gridinfo_t *);
 extern void    pdlaqgs (SuperMatrix *, double *, double *, double,
 			double, double, char *);
@@ -421,23 +628,94 @@ extern void  pdgssvx(superlu_dist_options_t *, SuperMatrix *,
 		     dScalePermstruct_t *, double *,
 		     int, int, gridinfo_t *, dLUstruct_t *,
 		     dSOLVEstruct_t *, double *, SuperLUStat_t *, int *);
+extern int   pdgssvx_start(superlu_dist_options_t *, SuperMatrix *,
+			   dScalePermstruct_t *, double *, int, int,
+			   gridinfo_t *, dLUstruct_t *, dSOLVEstruct_t *,
+			   double *, SuperLUStat_t *, int *, dgssvxRequest_t *);
+extern void  pdgssvx_subtree(superlu_dist_options_t *, SuperMatrix *, int,
+			     double *, int, int, gridinfo_t *,
+			     SuperLUStat_t *, int *);
+extern void  dBatchInit(int, double *, int, int, gridinfo_t *, dBatch_t *);
+extern void  pdgssvx_batch(superlu_dist_options_t *, dBatch_t *,
+			   SuperMatrix **, double **, int *, int,
+			   double **, SuperLUStat_t *, int *);
+extern void  dBatchFinalize(dBatch_t *);
+extern void  pdgsrefactor(superlu_dist_options_t *, SuperMatrix *, double *,
+			    dScalePermstruct_t *, gridinfo_t *, dLUstruct_t *,
+			    dSOLVEstruct_t *, SuperLUStat_t *, int *);
+extern void  pdgsrefactor_partial(superlu_dist_options_t *, SuperMatrix *,
+				    double *, int_t, int_t *, dScalePermstruct_t *,
+				    gridinfo_t *, dLUstruct_t *,
+				    dSOLVEstruct_t *, SuperLUStat_t *, int *);
+extern void  pdgsrefactor_pattern(superlu_dist_options_t *, SuperMatrix *,
+				  dScalePermstruct_t *, gridinfo_t *,
+				  dLUstruct_t *, dSOLVEstruct_t *,
+				  SuperLUStat_t *, int *);
+extern void  pdgssvx_sweep(superlu_dist_options_t *, SuperMatrix *, int,
+			   double **, double **, int, int, dScalePermstruct_t *,
+			   gridinfo_t *, dLUstruct_t *, dSOLVEstruct_t *,
+			   double **, SuperLUStat_t *, int *);
+extern void  pdgssvx_shifts(superlu_dist_options_t *, SuperMatrix *, int,
+			    double *, double **, int, int, dScalePermstruct_t *,
+			    gridinfo_t *, dLUstruct_t *, dSOLVEstruct_t *,
+			    double **, SuperLUStat_t *, int *);
+extern void  pdLU_redistribute(superlu_dist_options_t *, int_t, gridinfo_t *,
+				dScalePermstruct_t *, dLUstruct_t *,
+				gridinfo_t *, dLUstruct_t *, int *);
+extern void  pdgssvx_dense(superlu_dist_options_t *, SuperMatrix *,
+			   dScalePermstruct_t *, double *, int, int,
+			   gridinfo_t *, dLUstruct_t *, double *,
+			   SuperLUStat_t *, int *);
+extern void  pdgssvx_fused(superlu_dist_options_t *, SuperMatrix *, double *,
+			   int, int, gridinfo_t *, double *, SuperLUStat_t *,
+			   int *);
+extern void  dSMWInit(int, dSMW_t *);
+extern void  pdgssmw_update(superlu_dist_options_t *, SuperMatrix *,
+			    dScalePermstruct_t *, gridinfo_t *, dLUstruct_t *,
+			    dSOLVEstruct_t *, dSMW_t *, int, double *, double *, int,
+			    SuperLUStat_t *, int *);
+extern void  pdgssmw_solve(superlu_dist_options_t *, SuperMatrix *,
+			   dScalePermstruct_t *, dSMW_t *, double *, int, int,
+			   gridinfo_t *, dLUstruct_t *, dSOLVEstruct_t *,
+			   double *, SuperLUStat_t *, int *);
+extern void  dSMWFree(dSMW_t *);
+extern int   pdgssvx_test(dgssvxRequest_t *);
+extern void  pdgssvx_wait(dgssvxRequest_t *);
+extern double pdgstune(superlu_dist_options_t *, SuperMatrix *, gridinfo_t *,
+		       int_t *, int_t *);
 extern void  pdCompute_Diag_Inv(int_t, dLUstruct_t *,gridinfo_t *, SuperLUStat_t *, int *);
+extern void  pdDefer_Diag_Inv(superlu_dist_options_t *, dLUstruct_t *);
 extern int  dSolveInit(superlu_dist_options_t *, SuperMatrix *, int_t [], int_t [],
 		       int_t, dLUstruct_t *, gridinfo_t *, dSOLVEstruct_t *);
 extern void dSolveFinalize(superlu_dist_options_t *, dSOLVEstruct_t *);
+extern void dSolveWorkFree(dSOLVEstruct_t *);
 extern int_t pdgstrs_init(int_t, int_t, int_t, int_t,
                           int_t [], int_t [], gridinfo_t *grid,
 	                  Glu_persist_t *, dSOLVEstruct_t *);
 extern void pxgstrs_finalize(pxgstrs_comm_t *);
 extern int  dldperm_dist(int_t, int_t, int_t, int_t [], int_t [],
 		    double [], int_t *, double [], double []);
+extern int  pdldperm_auction(SuperMatrix *, gridinfo_t *, int_t *,
+			     double *, double *);
+extern int  pdldperm_check(SuperMatrix *, dScalePermstruct_t *, double,
+			   gridinfo_t *);
 extern int  dstatic_schedule(superlu_dist_options_t *, int, int,
 		            dLUstruct_t *, gridinfo_t *, SuperLUStat_t *,
 			    int_t *, int_t *, int *);
 extern void dLUstructInit(const int_t, dLUstruct_t *);
 extern void dLUstructFree(dLUstruct_t *);
 extern void dDestroy_LU(int_t, gridinfo_t *, dLUstruct_t *);
+extern void dDestroy_DenseLU(dLUstruct_t *);
 extern void dDestroy_Tree(int_t, gridinfo_t *, dLUstruct_t *);
+extern void dCreate_Trees(dLocalLU_t *, gridinfo_t *, int);
+extern double dLU_local_bytes(int_t, dLUstruct_t *, gridinfo_t *);
+extern void dDestroy_Amap(dLocalLU_t *);
+extern int_t pdLU_pattern_check(int_t, SuperMatrix *, dScalePermstruct_t *,
+				dLUstruct_t *, gridinfo_t *);
+extern void dRelease_LU(int_t, gridinfo_t *, dLUstruct_t *);
+extern void dCompact_LU(int_t, gridinfo_t *, dLUstruct_t *);
+extern int  dDrop_U(superlu_dist_options_t *, int_t, dScalePermstruct_t *,
+		    dLUstruct_t *, gridinfo_t *);
 extern void dscatter_l (int ib, int ljb, int nsupc, int_t iukp, int_t* xsup,
 			int klst, int nbrow, int_t lptr, int temp_nbrow,
 			int_t* usub, int_t* lsub, double *tempv,
@@ -449,6 +727,8 @@ extern void dscatter_u (int ib, int jb, int nsupc, int_t iukp, int_t * xsup,
                         int_t* lsub, int_t* usub, double* tempv,
                         int_t ** Ufstnz_br_ptr, double **Unzval_br_ptr,
                         gridinfo_t * grid);
+extern double dblr_gemm(int_t, Remain_info_t *, int, int, double *, int,
+			double *, int, double *, double, int);
 extern int_t pdgstrf(superlu_dist_options_t *, int, int, double,
 		    dLUstruct_t*, gridinfo_t*, SuperLUStat_t*, int*);
 
@@ -456,21 +736,52 @@ extern int_t pdgstrf(superlu_dist_options_t *, int, int, double,
 #define IPM_PROF */
 
 /* Solve related */
+extern int_t pdSolveLayout(int_t, dLUstruct_t *, gridinfo_t *, int_t *);
 extern void pdgstrs_Bglobal(int_t, dLUstruct_t *, gridinfo_t *,
 			     double *, int_t, int, SuperLUStat_t *, int *);
 extern void pdgstrs(int_t, dLUstruct_t *, dScalePermstruct_t *, gridinfo_t *,
 		    double *, int_t, int_t, int_t, int, dSOLVEstruct_t *,
 		    SuperLUStat_t *, int *);
+extern void dRHSqueueInit(int_t, int_t, int, dRHSqueue_t *);
+extern void dRHSqueueFree(dRHSqueue_t *);
+extern int  pdgstrs_push(int_t, dLUstruct_t *, dScalePermstruct_t *,
+			 gridinfo_t *, double *, int_t, int, dSOLVEstruct_t *,
+			 SuperLUStat_t *, int *, dRHSqueue_t *);
+extern void pdgstrs_flush(int_t, dLUstruct_t *, dScalePermstruct_t *,
+			  gridinfo_t *, dSOLVEstruct_t *, SuperLUStat_t *,
+			  int *, dRHSqueue_t *);
+extern void pdgstrs_trans(int_t, dLUstruct_t *, dScalePermstruct_t *,
+			  gridinfo_t *, double *, int_t, int_t, int_t, int,
+			  dSOLVEstruct_t *, SuperLUStat_t *, int *);
+extern void pdgstrs_sym(int_t, dLUstruct_t *, dScalePermstruct_t *,
+			gridinfo_t *, double *, int_t, int_t, int_t, int,
+			dSOLVEstruct_t *, SuperLUStat_t *, int *);
+extern void pdgscon(char *, int_t, double, dLUstruct_t *,
+		    dScalePermstruct_t *, gridinfo_t *, int_t, int_t,
+		    dSOLVEstruct_t *, double *, SuperLUStat_t *, int *);
 extern void pdgstrf2_trsm(superlu_dist_options_t * options, int_t k0, int_t k,
 			  double thresh, Glu_persist_t *, gridinfo_t *,
 			  dLocalLU_t *, MPI_Request *, int tag_ub,
 			  SuperLUStat_t *, int *info);
+extern void pdgstrf2_diag(superlu_dist_options_t *, int, double *, int,
+			  double thresh, int_t, SuperLUStat_t *, int *info);
+extern int_t pdgstrf_root_start(superlu_dist_options_t *, int_t,
+			       Glu_persist_t *, gridinfo_t *, dLocalLU_t *);
+extern void pdgstrf_root(superlu_dist_options_t *, int_t kd, int_t n,
+			 double thresh, Glu_persist_t *, gridinfo_t *,
+			 dLocalLU_t *, SuperLUStat_t *, int *info);
 extern void pdgstrs2_omp(int_t k0, int_t k, Glu_persist_t *, gridinfo_t *,
-			 dLocalLU_t *, Ublock_info_t *, SuperLUStat_t *);
+			 dLocalLU_t *, Ublock_info_t *, superlu_arena_t *,
+			 SuperLUStat_t *);
 extern int_t pdReDistribute_B_to_X(double *B, int_t m_loc, int nrhs, int_t ldb,
 				   int_t fst_row, int_t *ilsum, double *x,
 				   dScalePermstruct_t *, Glu_persist_t *,
 				   gridinfo_t *, dSOLVEstruct_t *);
+extern int_t pdReDistribute_X_to_B(int_t n, double *B, int_t m_loc, int_t ldb,
+				   int_t fst_row, int_t nrhs, double *x,
+				   int_t *ilsum, dScalePermstruct_t *,
+				   Glu_persist_t *, gridinfo_t *,
+				   dSOLVEstruct_t *);
 extern void dlsum_fmod(double *, double *, double *, double *,
 		       int, int, int_t , int_t *, int_t, int_t, int_t,
 		       int_t *, gridinfo_t *, dLocalLU_t *,
@@ -497,10 +808,32 @@ extern void dlsum_bmod_inv_master(double *, double *, double *, double *,
                        int_t **, int_t *, gridinfo_t *, dLocalLU_t *,
 		       SuperLUStat_t **, int_t, int_t, int, int);
 
+extern void dlsum_fmod_levels(double *, double *, double *, int, int_t,
+		       int_t *, int_t *, int *, int_t *, gridinfo_t *,
+		       dLocalLU_t *, SuperLUStat_t **, int_t, int_t, int);
+extern void dlsum_fmod_fixed(double *, double *, double *, int, int_t,
+		       int_t *, int_t *, int_t, int_t, pxgstrs_ring_t *, int *,
+		       int_t *, gridinfo_t *, dLocalLU_t *, SuperLUStat_t *);
+extern void dlsum_bmod_fixed(double *, double *, double *, int, int_t,
+		       int_t *, int_t *, int_t, int_t, pxgstrs_ring_t *, int_t,
+		       int *, int_t *, gridinfo_t *, dLocalLU_t *,
+		       SuperLUStat_t *);
+
 extern void pdgsrfs(int_t, SuperMatrix *, double, dLUstruct_t *,
 		    dScalePermstruct_t *, gridinfo_t *,
 		    double [], int_t, double [], int_t, int,
 		    dSOLVEstruct_t *, double *, SuperLUStat_t *, int *);
+extern void pdgsrfs_matvec(trans_t, int, SuperMatrix *, dLUstruct_t *,
+			   dScalePermstruct_t *, gridinfo_t *,
+			   dSOLVEstruct_t *, int, double *, int_t, double *, int_t);
+extern void pdgsrfs_trans(int_t, SuperMatrix *, double, dLUstruct_t *,
+			  dScalePermstruct_t *, gridinfo_t *,
+			  double [], int_t, double [], int_t, int,
+			  dSOLVEstruct_t *, double *, SuperLUStat_t *, int *);
+extern void pdgsrfs_gmres(trans_t, int_t, SuperMatrix *, double, dLUstruct_t *,
+			  dScalePermstruct_t *, gridinfo_t *,
+			  double [], int_t, double [], int_t, int,
+			  dSOLVEstruct_t *, double *, SuperLUStat_t *, int *);
 extern void pdgsrfs_ABXglobal(int_t, SuperMatrix *, double, dLUstruct_t *,
 		  gridinfo_t *, double *, int_t, double *, int_t,
 		  int, double *, SuperLUStat_t *, int *);
@@ -513,8 +846,13 @@ extern int  pdgsmv_AXglobal_abs(int_t, int_t [], double [], int_t [],
 				 double [], double []);
 extern void pdgsmv_init(SuperMatrix *, int_t *, gridinfo_t *,
 			pdgsmv_comm_t *);
+extern void pdgsmv_reuse(SuperMatrix *, int_t *, int_t *, gridinfo_t *);
 extern void pdgsmv(int_t, SuperMatrix *, gridinfo_t *, pdgsmv_comm_t *,
 		   double x[], double ax[]);
+extern void pdgsmv_trans(int_t, SuperMatrix *, gridinfo_t *,
+			 pdgsmv_comm_t *, double x[], double atx[]);
+extern void pdgsmv_block(SuperMatrix *, gridinfo_t *, pdgsmv_comm_t *, int,
+			 double x[], int_t, double ax[], double aax[], int_t);
 extern void pdgsmv_finalize(pdgsmv_comm_t *);
 
 /* Memory-related */
@@ -550,12 +888,66 @@ extern void  dreadMM_dist(FILE *, int_t *, int_t *, int_t *,
 	                  double **, int_t **, int_t **);
 extern int  dread_binary(FILE *, int_t *, int_t *, int_t *,
 	                  double **, int_t **, int_t **);
+extern int  pdSave_LU(char *, int_t, int_t, dScalePermstruct_t *,
+                      dLUstruct_t *, gridinfo_t *);
+extern int  pdLoad_LU(char *, int_t, int_t, SuperMatrix *,
+                      dScalePermstruct_t *, dLUstruct_t *, gridinfo_t *);
+extern int  pdreadMM_loc(char *, SuperMatrix *, gridinfo_t *);
+extern int  pdreadtriple_loc(char *, SuperMatrix *, gridinfo_t *);
+extern int  pdread_binary_loc(char *, SuperMatrix *, gridinfo_t *);
+extern int  pdwrite_binary_loc(char *, SuperMatrix *, gridinfo_t *);
+extern void pdcoord_to_loc(int_t, int_t, int_t, int_t *, int_t *, double *,
+                           int_t *, SuperMatrix *, gridinfo_t *);
+extern void pdAssemblyInit(int_t, int_t, int_t, int_t, gridinfo_t *,
+                           dAssembly_t *);
+extern void dAssemblyAdd(dAssembly_t *, int_t, int_t *, int_t *, double *);
+extern void pdAssemblyFinish(dAssembly_t *, SuperMatrix *);
+#ifdef HAVE_HDF5 /* experimental, see pdhdf5_io.c */
+extern int  pdread_hdf5_loc(char *, char *, SuperMatrix *, gridinfo_t *);
+extern int  pdwrite_hdf5_loc(char *, char *, SuperMatrix *, gridinfo_t *);
+extern int  pdread_hdf5_vec(char *, char *, int_t, int_t, int, double *, int,
+                             gridinfo_t *);
+extern int  pdwrite_hdf5_vec(char *, char *, int_t, int_t, int_t, int, double *,
+                              int, gridinfo_t *);
+#endif
 
 /* Distribute the data for numerical factorization */
 extern float ddist_psymbtonum(fact_t, int_t, SuperMatrix *,
                                 dScalePermstruct_t *, Pslu_freeable_t *,
                                 dLUstruct_t *, gridinfo_t *);
 extern void pdGetDiagU(int_t, dLUstruct_t *, gridinfo_t *, double *);
+extern void pdLogDet(int_t, dLUstruct_t *, dScalePermstruct_t *,
+		     gridinfo_t *, double *, int *);
+extern void pdSelInv(int_t, dLUstruct_t *, gridinfo_t *, dSelInvstruct_t *);
+extern int_t pdSelInvDiag(int_t, dScalePermstruct_t *, dLUstruct_t *,
+			  dSelInvstruct_t *, gridinfo_t *, double *);
+extern void dSelInvFree(int_t, gridinfo_t *, dLUstruct_t *, dSelInvstruct_t *);
+extern void pdGetSchur(superlu_dist_options_t *, int_t, dScalePermstruct_t *,
+			dLUstruct_t *, gridinfo_t *, SuperMatrix *);
+
+/* Mixed precision: single precision factors, double precision refinement */
+extern float pdsdistribute(fact_t, int_t, SuperMatrix *,
+			   dScalePermstruct_t *, Glu_freeable_t *,
+			   dLUstruct_t *, gridinfo_t *);
+extern float dsdist_psymbtonum(fact_t, int_t, SuperMatrix *,
+			       dScalePermstruct_t *, Pslu_freeable_t *,
+			       dLUstruct_t *, gridinfo_t *);
+extern int_t pdsgstrf(superlu_dist_options_t *, int, int, double,
+		      dLUstruct_t*, gridinfo_t*, SuperLUStat_t*, int*);
+extern void pdsCompute_Diag_Inv(int_t, dLUstruct_t *, gridinfo_t *,
+				SuperLUStat_t *, int *);
+extern void pdsDefer_Diag_Inv(superlu_dist_options_t *, dLUstruct_t *);
+extern void pdsgstrs(int_t, dLUstruct_t *, dScalePermstruct_t *, gridinfo_t *,
+		     double *, int_t, int_t, int_t, int, dSOLVEstruct_t *,
+		     SuperLUStat_t *, int *);
+extern void pdsgstrs_trans(int_t, dLUstruct_t *, dScalePermstruct_t *,
+			   gridinfo_t *, double *, int_t, int_t, int_t, int,
+			   dSOLVEstruct_t *, SuperLUStat_t *, int *);
+extern void pdsGetDiagU(int_t, dLUstruct_t *, gridinfo_t *, double *);
+extern int_t dsQuerySpace_dist(int_t, dLUstruct_t *, gridinfo_t *,
+			       SuperLUStat_t *, superlu_dist_mem_usage_t *);
+extern void dsZeroLblocks(int, int_t, gridinfo_t *, dLUstruct_t *);
+extern void dsDestroy_LU(int_t, gridinfo_t *, dLUstruct_t *);
 
 extern int  d_c2cpp_GetHWPM(SuperMatrix *, gridinfo_t *, dScalePermstruct_t *);
 
@@ -604,6 +996,12 @@ extern void dger_(int*, int*, double*, double*, int*,
 
 #endif
 
+extern int dgemm_small(int, int, int, double *, int, double *, int,
+                        double *, int);
+extern int dgemm_small_sub(int, int, int, double *, int, double *, int,
+                           double *, int);
+extern int dtrsm_small(char, int, int, double *, int, double *, int);
+
 extern int dscal_(int *n, double *da, double *dx, int *incx);
 extern int daxpy_(int *n, double *za, double *zx, 
 	               int *incx, double *zy, int *incy);
@@ -752,7 +1150,8 @@ extern void pdgstrf2_trsm(superlu_dist_options_t * options, int_t k0, int_t k,
 			  dLocalLU_t *, MPI_Request *, int tag_ub,
 			  SuperLUStat_t *, int *info);
 extern void pdgstrs2_omp(int_t k0, int_t k, Glu_persist_t *, gridinfo_t *,
-			 dLocalLU_t *, Ublock_info_t *, SuperLUStat_t *);
+			 dLocalLU_t *, Ublock_info_t *, superlu_arena_t *,
+			 SuperLUStat_t *);
 #endif // same routine names   !!!!!!!!
 
 extern int_t dLpanelUpdate(int_t off0, int_t nsupc, double* ublk_ptr,
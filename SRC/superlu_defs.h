@@ -193,6 +193,8 @@ typedef MPI_C_DOUBLE_COMPLEX  SuperLU_MPI_DOUBLE_COMPLEX;
 #define LkkDIAG  15
     /* For triangular solves. */
 #define XK_H     2  /* The header preceding each X block. */
+#define RHS_TILE_WORDS 4096 /* Entries in a tile of the right-hand side
+			       copies, see options->Solve_RHSTile. */
 #define LSUM_H   2  /* The header preceding each MOD block. */
 #define GSUM     20 
 #define Xk       21
@@ -204,6 +206,19 @@ static const int BC_L=1;	/* MPI tag for x in L-solve*/
 static const int RD_L=2;	/* MPI tag for lsum in L-solve*/	
 static const int BC_U=3;	/* MPI tag for x in U-solve*/
 static const int RD_U=4;	/* MPI tag for lsum in U-solve*/	
+static const int AG_SOL=5;	/* MPI tag for aggregated messages of a solve */
+static const int SOL_LOWP=32;	/* added to the tag of a message of a solve
+				   sent in reduced precision, see
+				   pxgstrs_lowp_pack() */
+
+/* Record when X[k] is solved, if tdone is not NULL (see
+   options->Solve_CritPath). */
+#define SOLVE_STAMP(tdone, k) \
+    do { if ( tdone ) (tdone)[k] = SuperLU_timer_(); } while (0)
+
+/* Start time of an event of the factorization tracer; the clock is only
+   read when stat is tracing (see superlu_trace.c). */
+#define TRACE_TIME(stat) ( (stat)->trace ? SuperLU_timer_() : 0.0 )
 
 /* 
  * Communication scopes
@@ -240,6 +255,8 @@ static const int RD_U=4;	/* MPI tag for lsum in U-solve*/
 #define PCOL(bnum,grid) ( (bnum) % grid->npcol )
 #define PNUM(i,j,grid)  ( (i)*grid->npcol + j ) /* Process number at coord(i,j) */
 #define CEILING(a,b)    ( ((a)%(b)) ? ((a)/(b) + 1) : ((a)/(b)) )
+/* Bytes of n int_t encoded by superlu_pack_index(), in the worst case */
+#define SUPERLU_PACK_MAX(n) ( (n) * (sizeof(int_t) == 4 ? 5 : 10) )
     /* For triangular solves */
 #define RHS_ITERATE(i)                    \
         for (i = 0; i < nrhs; ++i)
@@ -247,6 +264,13 @@ static const int RD_U=4;	/* MPI tag for lsum in U-solve*/
         ilsum[i] * nrhs + (i+1) * XK_H
 #define LSUM_BLK(i)                       \
         ilsum[i] * nrhs + (i+1) * LSUM_H
+/* The copy of lsum[] updated by thread t, and the number of copies: one
+   per thread, or one shared by the threads if Llu->lsum_shared is set,
+   updated with atomic adds, see pxgstrs_lsum_shared(). */
+#define LSUM_COPY(t)                      \
+        ( Llu->lsum_shared ? 0 : (t) * sizelsum )
+#define LSUM_NCOPY                        \
+        ( Llu->lsum_shared ? 1 : num_thread )
 
 #define SuperLU_timer_  SuperLU_timer_dist_
 #define LOG2(x)   (log10((double) x) / log10(2.0))
@@ -324,6 +348,21 @@ typedef struct {
     int Iam;              /* my process number */
 } superlu_scope_t;
 
+/*-- A broadcast in progress, see bcast_tree_start() --*/
+typedef struct {
+    MPI_Comm comm;
+    char   *buf;
+    int    count, seg;   /* count entries of dtype, in segments of seg */
+    MPI_Datatype dtype;
+    MPI_Aint extent;
+    int    tag;
+    int    nseg, irecv;  /* the segments; the next one to be received */
+    int    parent;       /* -1 at the root */
+    int    dest[32], ndest; /* the children in the binomial tree */
+    int    ibcast;       /* MPI_Ibcast() in req[0] */
+    MPI_Request *req;    /* nseg receives, then ndest sends per segment */
+} superlu_bcast_t;
+
 /*-- Process grid definition */
 typedef struct {
     MPI_Comm comm;        /* MPI communicator */
@@ -416,6 +455,28 @@ typedef struct {
     int64_t nnzLU;   /* number of nonzeros in L+U*/
 } Glu_freeable_t;
 
+/*
+ *-- The symbolic factorization supplied by the user, in place of the one
+ *   of the library, see options->UserSymbFact and symbfact_user().
+ *
+ *   The supernodes and blocks are those of Pc*A*Pc', with Pc = perm_c[]
+ *   given with ColPerm = MY_PERMC. The blocks are dense, and the same
+ *   structure must be given on all the processes.
+ */
+typedef struct {
+    int_t     nsupers;   /* number of supernodes */
+    int_t     *xsup;     /* supernode s is columns xsup[s]:xsup[s+1]-1,
+			    xsup[0] = 0 and xsup[nsupers] = n */
+    int_t     *etree;    /* column etree, etree[root] = n; NULL to derive
+			    it from the blocks */
+    int_t     *xlblk;    /* the block rows of L below the diagonal in */
+    int_t     *lblk;     /* block column s: lblk[xlblk[s]:xlblk[s+1]-1],
+			    increasing */
+    int_t     *xublk;    /* the block rows of U above the diagonal in */
+    int_t     *ublk;     /* block column s: ublk[xublk[s]:xublk[s+1]-1],
+			    increasing */
+} superlu_symbfact_t;
+
 #if 0 // Sherry: move to precision-dependent file
 /* 
  *-- The structure used to store matrix A of the linear system and
@@ -481,8 +542,79 @@ typedef struct {
     int_t  *recv_ibuf2;
     void   *send_dbuf2;
     void   *recv_dbuf2;
+
+    /* neighborhoods of the redistribution, see pxgstrs_neighbors() */
+    MPI_Comm B_to_X_comm, X_to_B_comm; /* MPI_COMM_NULL if not used */
+    int    *B_to_X_nbr, *X_to_B_nbr;   /* neighbors and their counts */
+    int_t  *B_to_X_rowind, *X_to_B_rowind; /* received row indices,
+					      kept after the first solve */
+    void   *buf;          /* send/receive buffers, reused between solves */
+    size_t buf_size;
 } pxgstrs_comm_t;
 
+/*-- Small messages of a triangular solve aggregated by destination, see
+     pxgstrs_agg_init(). --*/
+typedef struct {
+    MPI_Comm comm;
+    size_t maxmsg;     /* messages up to maxmsg bytes are aggregated */
+    size_t cap;        /* bytes of a packet, at most a receive slot */
+    char   **buf;      /* buf[p]: packet being filled for rank p, or NULL */
+    size_t *len;       /* its length */
+    int    *pending, npending; /* the ranks with a packet being filled */
+    char   **pool;     /* free packets */
+    char   **fbuf;     /* packets in flight, sent by freq[] */
+    MPI_Request *freq;
+    int    npool, nflight, npackets, maxpool; /* the lists hold maxpool */
+} pxgstrs_agg_t;
+
+/*-- Receives of a triangular solve, pre-posted into the slots of its
+     receive buffer, see pxgstrs_ring_init(). --*/
+typedef struct {
+    char   *buf;      /* nslot slots of slot bytes */
+    size_t slot;
+    int    nslot, count; /* count entries of type per message */
+    MPI_Datatype type;
+    MPI_Comm comm;
+    int    depth;     /* receives kept posted */
+    int    left;      /* messages without a posted receive yet */
+    MPI_Request *req; /* req[i] receives into slot rslot[i], -1 if none */
+    int    *rslot;
+    int    *done, ndone, idone; /* completed, handed out in turn */
+    MPI_Status *status;
+    int    *freeslots, nfree, fresh; /* slots free again; first unused */
+    int    cur, keep; /* slot of the last message, and whether it is kept */
+    pxgstrs_agg_t *agg; /* flushed before blocking, or NULL */
+    int    npkt;      /* messages left in the packet of slot cur */
+    char   *pkt;      /* the next of them */
+    int    pktkeep;   /* a message of the packet is kept */
+    int    nmsg, procs; /* messages of the solve, ranks of comm */
+    int    *plan;     /* messages from each rank, recorded or followed,
+			 see pxgstrs_ring_init(); NULL if none */
+    int    record;    /* the plan is being recorded */
+    int    nsrc, persrc; /* plan followed: persrc receives posted from
+			     each of the nsrc ranks srcs[], req[i] from
+			     srcs[i / persrc]; nsrc = 0 for MPI_ANY_SOURCE */
+    int    *srcs, *src_left, *src_cover; /* per source: messages not handed
+					    out, and receives and packet
+					    messages that hold some of them */
+    int    cursrc;    /* source of slot cur */
+    int_t  *prio, nprio; /* priority of the messages of each supernode,
+			    see pxgstrs_ring_prio(); NULL if none */
+} pxgstrs_ring_t;
+
+/*-- Rank lists of the broadcast or reduction trees of the triangular
+     solves, recorded by the distribution; the tree objects are created
+     from them on the first solve, see pdgstrs(). --*/
+typedef struct {
+    int    ntree;    /* number of local block columns or rows */
+    int    *start;   /* the ranks of tree k, root first, are       */
+    int    *cnt;     /* rank[start[k] : start[k]+cnt[k]-1];        */
+    int    *msgsize; /* cnt[k] = 0 if block k has no tree          */
+    double *seed;
+    int    *rank;
+    int    nrank, maxrank;
+} superlu_treespec_t;
+
 /* 
  *-- This contains the options used to control the solution process.
  *
@@ -515,7 +647,19 @@ typedef struct {
  *
  * DiagInv (yes_no_t)
  *        Specifies whether to invert the diagonal blocks of the LU
- *        triangular matrices.
+ *        triangular matrices. The inverses are computed by the first
+ *        solve after the factorization, for the supernodes of the
+ *        sizes in DiagInv_MinSize:DiagInv_MaxSize only; the triangular
+ *        solves use TRSM for the other supernodes.
+ *
+ * DiagInv_MinSize, DiagInv_MaxSize (int) (only for SuperLU_DIST)
+ *        Give the range of the supernode sizes whose diagonal blocks are
+ *        inverted when DiagInv = YES. The inverses of L and U take
+ *        2*nsupc^2 words per supernode, and a GEMM with them is faster
+ *        than a TRSM mostly for the medium sizes; a small DiagInv_MaxSize
+ *        keeps the large supernodes near the root from doubling the
+ *        memory of the diagonal blocks. DiagInv_MaxSize = 0 (default)
+ *        means no upper bound; the default DiagInv_MinSize = 1.
  *
  * ColPerm (colperm_t)
  *        Specifies what type of column permutation to use to reduce fill.
@@ -523,7 +667,20 @@ typedef struct {
  *        = MMD_ATA: use minimum degree ordering on structure of A'*A
  *        = MMD_AT_PLUS_A: use minimum degree ordering on structure of A'+A
  *        = COLAMD: use approximate minimum degree column ordering
+ *        = METIS_AT_PLUS_A: use METIS ordering on structure of A'+A
+ *        = PARMETIS: use parallel METIS ordering on structure of A'+A
+ *        = ZOLTAN: use PT-Scotch parallel nested dissection on A'+A
+ *                  (needs HAVE_PTSCOTCH)
  *        = MY_PERMC: use the ordering specified by the user
+ *        = AMD_AT_PLUS_A: use approximate minimum degree ordering on
+ *                  structure of A'+A (SYMAMD), much faster than MMD on
+ *                  large meshes for a comparable fill
+ *        = RCM_AT_PLUS_A: use reverse Cuthill-McKee ordering on structure
+ *                  of A'+A; a narrow band of L and U is factored by
+ *                  block columns of its width (see symbfact_band())
+ *        All but PARMETIS and ZOLTAN are sequential; with the serial
+ *        symbolic factorization, process 0 computes the ordering and
+ *        broadcasts it (see pdgssvx()).
  *         
  * Trans  (trans_t)
  *        Specifies the form of the system of equations:
@@ -537,6 +694,7 @@ typedef struct {
  *        = SINGLE: perform iterative refinement in single precision
  *        = DOUBLE: perform iterative refinement in double precision
  *        = EXTRA: perform iterative refinement in extra precision
+ *        = GMRES: use flexible GMRES preconditioned by the LU factors
  *
  * DiagPivotThresh (double, in [0.0, 1.0]) (only for serial SuperLU)
  *        Specifies the threshold used for a diagonal entry to be an
@@ -550,13 +708,17 @@ typedef struct {
  * PivotGrowth (yes_no_t)  (only for serial SuperLU)
  *        Specifies whether to compute the reciprocal pivot growth.
  *
- * ConditionNumber (ues_no_t) (only for serial SuperLU)
+ * ConditionNumber (yes_no_t)
  *        Specifies whether to compute the reciprocal condition number.
+ *        In SuperLU_DIST, it is estimated by PxGSCON when there is a
+ *        right-hand side, and returned in stat->RCond.
  *
  * RowPerm (rowperm_t) (only for SuperLU_DIST or ILU in serial SuperLU)
  *        Specifies whether to permute rows of the original matrix.
  *        = NO: not to permute the rows
  *        = LargeDiag: make the diagonal large relative to the off-diagonal
+ *        = LargeDiag_AUCTION: the same, by a distributed auction algorithm
+ *          on the distributed matrix (SuperLU_DIST only)
  *        = MY_PERMR: use the permutation given by the user
  *
  * ILU_DropRule (int)  (only for serial SuperLU)
@@ -581,8 +743,16 @@ typedef struct {
  *   	  Note: DROP_PROWS, DROP_COLUMN and DROP_AREA are mutually exclusive.
  *	  ( Default: DROP_BASIC | DROP_AREA )
  *
- * ILU_DropTol (double) (only for serial SuperLU)
- *        numerical threshold for dropping.
+ * ILU_DropTol (double)
+ *        numerical threshold for dropping. In SuperLU_DIST, the 2D
+ *        factorization drops whole blocks of a supernode: a block of L
+ *        whose entries are all smaller than ILU_DropTol, and a block of U
+ *        whose entries are all smaller than ILU_DropTol times the largest
+ *        entry of the diagonal block, are set to zero before they update
+ *        the Schur complement. Both tests are relative to the pivots:
+ *        the entries of L are the multipliers, already divided by the
+ *        diagonal of U. The other ILU_ fields are not used.
+ *        ( Default: 0.0, complete LU )
  *
  * ILU_FillFactor (double) (only for serial SuperLU)
  *        Gamma in the secondary dropping.
@@ -614,7 +784,9 @@ typedef struct {
  *        refinement.
  *
  * num_lookaheads (int) (only for SuperLU_DIST)
- *        Specifies the number of levels in the look-ahead factorization
+ *        Specifies the number of levels in the look-ahead factorization.
+ *        If negative, the number of levels is chosen by the factorization
+ *        from the elimination tree of the supernodes.
  *
  * lookahead_etree (yes_no_t) (only for SuperLU_DIST)
  *        Specifies whether to use the elimination tree computed from the 
@@ -622,7 +794,302 @@ typedef struct {
  *
  * SymPattern (yes_no_t) (only for SuperLU_DIST)
  *        Gives the scheduling algorithm a hint whether the matrix
- *        would have symmetric pattern.
+ *        would have symmetric pattern. With SymPattern = YES, pdgstrf
+ *        also sends the index of each block of U(k,:) with one bit per
+ *        column, as the rows of L(j,k) give the columns of U(k,j), in
+ *        place of the first nonzero row of each column.
+ *
+ * SingleFactor (yes_no_t) (only for SuperLU_DIST, used by pdgssvx
+ *        and pzgssvx)
+ *        Specifies whether to compute the LU factors in single precision.
+ *        The solution is then improved by iterative refinement in double
+ *        precision (see IterRefine), which normally recovers double
+ *        precision accuracy with about half the factorization time and
+ *        memory. Requires the single precision library (real or complex).
+ *        If the refinement does not converge (stat->RefineSteps is
+ *        large and berr is not small), destroy the factors and call
+ *        pdgssvx again with SingleFactor = NO and Fact = SamePattern.
+ *
+ * ShareReplicated (yes_no_t) (only for SuperLU_DIST, used by pdgssvx)
+ *        Specifies whether the arrays replicated on all processes
+ *        (perm_r, perm_c, etree, and the supernode partition xsup/supno)
+ *        are kept in MPI-3 shared memory after the factorization, with
+ *        one copy per node instead of one per process (see superlu_shm.c).
+ *        dScalePermstructFree, dLUstructFree and dDestroy_LU are then
+ *        collective over the processes of each node.
+ *
+ * SchurSize (int) (only for SuperLU_DIST, used by pdgssvx)
+ *        If positive, the last SchurSize rows and columns of A are the
+ *        interface of a partial factorization: they are ordered last and
+ *        left unfactored, and the Schur complement of the interior block
+ *        is then obtained with pdGetSchur(). Requires RowPerm = NOROWPERM
+ *        and the serial symbolic factorization.
+ *
+ * BLR_Tol (double) (only for SuperLU_DIST, used by pdgstrf)
+ *        If positive, the blocks L(i,k) of at least BLR_MinSize rows and
+ *        columns are compressed to low rank with this relative tolerance
+ *        in the Schur complement update of the factorization (see
+ *        dblr_gemm()). The factors are then an approximation of accuracy
+ *        about BLR_Tol, and the solution is improved by IterRefine.
+ *        The factors are stored uncompressed. = 0: no compression.
+ *
+ * BLR_MinSize (int) (only for SuperLU_DIST, used by pdgstrf)
+ *        The smallest dimension of a block compressed when BLR_Tol > 0.
+ *
+ * Reproducible (yes_no_t) (only for SuperLU_DIST, used by pdgssvx)
+ *        Specifies whether the triangular solves sum the contributions
+ *        of the processes in a fixed order, whatever the arrival order of
+ *        the messages, so that repeated runs on the same process grid
+ *        (and the same number of threads) give bitwise identical results.
+ *        The communication trees are then built from fixed seeds.
+ *
+ * Amalg_Tol (double) (only for SuperLU_DIST, used by pdgssvx)
+ *        If positive, the supernodes of the serial symbolic factorization
+ *        are merged with their parent in the supernodal etree while the
+ *        explicit zeros stay below this fraction of the merged L block
+ *        column; 0 keeps the supernodes of symbfact().
+ *
+ * PatternCache (yes_no_t) (only for SuperLU_DIST, used by pdgssvx)
+ *        Specifies whether to keep the column ordering, elimination tree
+ *        and serial symbolic factorization of each sparsity pattern in a
+ *        cache of the process, and reuse them when a matrix with the same
+ *        pattern (after the row permutation) is factored with
+ *        Fact = DOFACT. Released by symbfact_cache_free().
+ *
+ * RowPerm_Tol (double) (only for SuperLU_DIST, used by pdgssvx)
+ *        If positive, with Fact = SamePattern, Equil = YES and RowPerm =
+ *        LargeDiag_MC64 or LargeDiag_AUCTION, the row permutation and the
+ *        scaling of the previous factorization are kept as long as the
+ *        matched entries of the scaled matrix stay at least RowPerm_Tol
+ *        and all entries at most 1/RowPerm_Tol in absolute value; 0 always
+ *        recomputes them.
+ *
+ * Equil_Iter (int) (only for SuperLU_DIST, used by pdgssvx)
+ *        If positive, with Equil = YES, R and C are computed from scratch
+ *        by at most Equil_Iter sweeps of the iterative scaling of Ruiz
+ *        (see pdgsequ_ruiz()); 0 computes them as in LAPACK's DGEEQU.
+ *
+ * DenseRoot_Tol (double) (only for SuperLU_DIST, used by pdgssvx)
+ *        If positive, the largest trailing set of supernodes whose L and U
+ *        blocks fill at least this fraction of their dense block (the
+ *        top separators of a nested dissection) is factored as one dense
+ *        matrix after the others (see pdgstrf_root()); 0 factors all the
+ *        supernodes in the sparse way.
+ *
+ * Fact_Comm (fact_comm_t) (only for SuperLU_DIST, used by pdgstrf)
+ *        Specifies how the L and U panels are exchanged in the
+ *        factorization:
+ *        = SLU_COMM_ISEND: the panels of the look-ahead window are sent
+ *             with MPI_Isend as soon as they are factored, and received
+ *             in buffers posted when they enter the window.
+ *        = SLU_COMM_IRECV: the look-ahead scheme of SLU_COMM_ISEND, with
+ *             the same sends and receives; the receives posted for the
+ *             window are only also tested during the Schur complement
+ *             update, which helps the networks where the messages only
+ *             progress inside MPI calls.
+ *        = SLU_COMM_SYNC: no look-ahead (num_lookaheads is ignored), and
+ *             blocking sends: each panel is sent with MPI_Send and
+ *             received in the step that uses it.
+ *        = SLU_COMM_RMA: as SLU_COMM_ISEND, but the owner of a panel only
+ *             flags it ready in an RMA window over the slab storage of
+ *             the factor, from which the receivers pull it with MPI_Get;
+ *             no send buffer is waited for. Used if the values of L and U
+ *             are in slabs on all the processes, else SLU_COMM_ISEND.
+ *        = SLU_COMM_THREADS: as SLU_COMM_IRECV, with each slot of the
+ *             look-ahead window on its own duplicate of the row and column
+ *             communicators, which the MPI libraries with several network
+ *             contexts (VCIs) match and progress independently; the
+ *             threads of the Schur complement update take turns testing
+ *             the panel sends and receives of the window between their
+ *             block updates. Needs OpenMP and MPI initialized with
+ *             MPI_THREAD_MULTIPLE on all the processes, else
+ *             SLU_COMM_IRECV.
+ *
+ * Sched_Priority (yes_no_t) (only for SuperLU_DIST, used by pdgstrf)
+ *        Specifies whether the static schedule of the factorization takes,
+ *        among the panels whose dependencies are factored, the one with
+ *        the longest chain of dependent panels first (critical-path, or
+ *        bottom-level, priority), the panels being weighted by their
+ *        flops and message volume; otherwise the ready panels are taken
+ *        in the order they became ready.
+ *
+ * Panel_Compress (yes_no_t) (only for SuperLU_DIST, used by pdgstrf)
+ *        Specifies whether the indices of the L and U panels sent in the
+ *        factorization are delta and varint encoded (see
+ *        superlu_pack_index()), which makes most of them one byte; the
+ *        values are sent as they are.
+ *
+ * SparseRHS (yes_no_t) (only for SuperLU_DIST, used by pdgstrs)
+ *        Specifies whether the forward solve is restricted to the
+ *        supernodes reached in the supernodal etree from those where B is
+ *        nonzero; the X[k] of the other supernodes are 0. It saves most
+ *        of the forward solve when B has few nonzeros, and costs a global
+ *        reduction of one integer per supernode in each solve.
+ *
+ * Solve_CritPath (yes_no_t) (only for SuperLU_DIST, used by pdgstrs)
+ *        Specifies whether the triangular solves measure their critical
+ *        path through the supernodal etree. Each process records when it
+ *        solves each X[k], from a barrier at the start of the L- and
+ *        U-solve; the path is followed back from the last X[k] solved,
+ *        through the child solved last in the L-solve, or through the
+ *        parents in the U-solve. The length and number of supernodes of
+ *        the paths are returned in stat->sol_critpath[] and
+ *        stat->sol_crithops[]. It costs two barriers and two global
+ *        reductions of nsupers words per solve; = NO (default).
+ *
+ * Solve_RootSize (int) (only for SuperLU_DIST, used by pdgstrs)
+ *        Specifies the order of the top of the supernodal etree solved
+ *        redundantly: the trailing supernodes of order up to
+ *        Solve_RootSize in total are gathered as a dense L\U on all the
+ *        processes at the first solve, and each solve then replaces their
+ *        messages in both triangular solves by one global sum of their
+ *        part of the right-hand sides. It costs Solve_RootSize^2 words
+ *        on each process; 0 (default) disables it.
+ *
+ * Solve_RHSTile (int) (only for SuperLU_DIST, used by pdgstrs)
+ *        Specifies the number of right-hand sides per tile when B is
+ *        redistributed to X and back. With more than Solve_RHSTile
+ *        right-hand sides, the copies between the column-major B and X
+ *        and the row-major message buffers go by tiles of Solve_RHSTile
+ *        columns and RHS_TILE_WORDS entries, instead of one row at a time
+ *        across all the columns; = 16 (default), 0 disables the tiles.
+ *
+ * Predict (yes_no_t) (only for SuperLU_DIST, used by pdgssvx)
+ *        Specifies whether process 0 prints, right after the serial
+ *        symbolic factorization, the memory, flops and messages predicted
+ *        by superlu_predict() for each process of the grid, and the times
+ *        of the factorization and the solve simulated by superlu_simulate()
+ *        for the grid and the candidates of SUPERLU_SIMULATE; = NO (default).
+ *
+ * MemBudget (double) (only for SuperLU_DIST, used by pdgstrf and pdgstrs)
+ *        Specifies the memory of each process, in megabytes, that the
+ *        factors and the buffers of the factorization must fit in. The
+ *        look-ahead depth is reduced first, then U(k,:) is updated by
+ *        chunks of fewer columns to shrink bigU and bigV; if they still do
+ *        not fit, the factorization returns at once with info > n. The
+ *        inverses of DiagInv are computed for the smallest supernodes
+ *        that fit next to the factors, or skipped; = 0 (default) for no
+ *        budget.
+ *
+ * OutOfCore (yes_no_t) (only for SuperLU_DIST, used by pddistribute,
+ *        pdgstrf and pdgstrs)
+ *        Specifies whether the values of L and U are kept in files under
+ *        $SUPERLU_OOC_DIR (default /tmp), ideally node-local storage,
+ *        instead of memory. The factorization writes the blocks out as it
+ *        is done with them, and the solve reads them back ahead of use,
+ *        see superlu_ooc.c. The index arrays stay in memory. Only used with
+ *        the serial symbolic factorization; = NO (default).
+ *
+ * ReleaseMemory (yes_no_t) (only for SuperLU_DIST, used by pdgssvx and
+ *        pddistribute)
+ *        Specifies whether what the triangular solves do not need is freed
+ *        as soon as possible: the map of the values of A into L and U is
+ *        not kept for Fact = SamePattern_SameRowPerm, and the schedule of
+ *        the messages of the factorization (ToRecv, ToSendD, ToSendR) is
+ *        freed after it. The factors can then only be used for solves: a
+ *        later call with Fact = SamePattern_SameRowPerm returns info = -1,
+ *        and pdSave_LU() is not supported; = NO (default).
+ *
+ * RefactorMap (yes_no_t) (only for SuperLU_DIST, used by pdgssvx and
+ *        pdgsrefactor)
+ *        Specifies whether the column indices of the distributed A are
+ *        kept with the factors (one int_t per local entry), so that
+ *        pdgsrefactor() can refactor new values of A with the same pattern
+ *        without a new SuperMatrix; = NO (default).
+ *
+ * SymValues (yes_no_t) (only for SuperLU_DIST, used by pdgssvx and
+ *        psgssvx)
+ *        Specifies whether A is numerically symmetric. Without row
+ *        permutation and with a symmetric scaling, the factors are then
+ *        A1 = L*D*L^T, D = diag(U): the blocks of U off the diagonal are
+ *        freed after the factorization, and the solves use L and D only.
+ *        A later call with Fact = SamePattern_SameRowPerm returns
+ *        info = -1, and pdSave_LU() and pdSelInv() are not supported.
+ *        Ignored for the factors in single precision, with ILU, BLR,
+ *        OutOfCore or SchurSize; = NO (default).
+ *
+ * Refine_MsgPrec (msg_prec_t) (only for SuperLU_DIST, used by pdgsrfs)
+ *        Specifies the precision of the values in the messages of the
+ *        broadcast and reduction trees of the triangular solves made by
+ *        the iterative refinement for the corrections; the sums are still
+ *        made in the working precision. Each message is scaled by a power
+ *        of 2 and its values sent in single precision (SLU_MSG_SINGLE) or
+ *        bfloat16 (SLU_MSG_BF16), which halves or quarters the volume of
+ *        the solve in double precision. A step whose backward error does
+ *        not halve is done again with full messages, and so are the
+ *        following ones. The first solve and pdgstrs_trans() are not
+ *        affected; = SLU_MSG_FULL (default).
+ *
+ * Overlap_Preproc (yes_no_t) (only for SuperLU_DIST, used by pdgssvx)
+ *        With RowPerm = LargeDiag_MC64 and ColPerm = MMD_ATA or COLAMD,
+ *        which order the columns whatever the row permutation, the
+ *        column ordering is computed by the last process while process 0
+ *        runs MC64, and broadcast, instead of after MC64 by all the
+ *        processes. Ties may be broken otherwise than after the row
+ *        permutation. Ignored with one process, ParSymbFact or
+ *        PatternCache; = NO (default).
+ *
+ * DofBlock (int) (only for SuperLU_DIST, used by pdgssvx)
+ *        The number b of unknowns per node of a vector PDE, numbered
+ *        consecutively: the serial orderings of ColPerm are computed on
+ *        the graph of the nodes, b^2 times smaller, and the unknowns of a
+ *        node are kept together (see get_perm_c_block()). = 0: b is found
+ *        from the pattern of A; = 1 (default): the scalar graph is
+ *        ordered. Not used by ParMETIS or ParSymbFact.
+ *
+ * Complex_3M (yes_no_t) (only for SuperLU_DIST, used by pzgstrf)
+ *        The large GEMM of the Schur complement update of the complex
+ *        factorization is computed by three real GEMMs on the real and
+ *        imaginary parts of its operands (see zgemm_3m()), which saves a
+ *        quarter of its flops; the imaginary parts of the updates may lose
+ *        a few digits. = NO (default).
+ *
+ * SplitSuper (int) (only for SuperLU_DIST, used by pdgssvx)
+ *        If positive, the supernodes of the serial symbolic factorization
+ *        with more columns are split into block columns of at most
+ *        SplitSuper columns (see symbfact_split()), so that the panels of
+ *        large separators are spread over several process columns;
+ *        = 0 (default): the supernodes are kept.
+ *
+ * Dense_MaxN (int) (only for SuperLU_DIST, used by pdgssvx)
+ *        Systems with n <= Dense_MaxN are gathered on every process and
+ *        solved with dense LU with partial pivoting (see pdgssvx_dense()),
+ *        without equilibration, row permutation or column ordering;
+ *        = 0 (default): the sparse path is always taken.
+ *
+ * Solve_Compact (yes_no_t) (only for SuperLU_DIST, used by pdgssvx and
+ *        pdgstrs)
+ *        Specifies whether the factors are converted to the layout of the
+ *        triangular solves: what only the factorization needs is freed as
+ *        with ReleaseMemory = YES, and at the first solve, once the
+ *        diagonal blocks are inverted, the values of each block column of
+ *        L and the inverses of its diagonal block are put next to each
+ *        other in one array, in the order of the L-solve, followed by the
+ *        block rows of U in the order of the U-solve (see dCompact_LU()).
+ *        The factors can then only be used for solves; = NO (default).
+ *
+ * UserSymbFact (yes_no_t) (only for SuperLU_DIST, used by pdgssvx)
+ *        Specifies whether the supernode partition, the etree and the
+ *        block structure of L and U are supplied by the user in
+ *        LUstruct->usymb (see superlu_symbfact_t), with the column
+ *        permutation in perm_c[] (ColPerm = MY_PERMC) and the serial
+ *        symbolic factorization (ParSymbFact = NO). The ordering and the
+ *        symbolic factorization are then skipped, as is the gather of A
+ *        unless RowPerm = LargeDiag_MC64. The structure is checked by
+ *        symbfact_user(); = NO (default).
+ *
+ * Solve_Priority (yes_no_t) (only for SuperLU_DIST, used by pdgstrs)
+ *        Specifies whether the triangular solves take the work that
+ *        unblocks the longest chain of dependent supernodes first: the
+ *        ready leaves of the L-solve and roots of the U-solve are started
+ *        in that order, and among the messages completed by one wait, the
+ *        one of the supernode with the longest remaining path in the
+ *        supernodal etree is processed first. The path of the L-solve
+ *        goes up to the root, that of the U-solve down to the deepest
+ *        leaf, the supernodes being weighted by their number of columns.
+ *        The priorities are computed once per factorization, with one
+ *        global reduction of nsupers integers; = NO (default), the
+ *        messages are processed in the order they complete.
  *
  */
 typedef struct {
@@ -654,8 +1121,73 @@ typedef struct {
     yes_no_t      lookahead_etree; /* use etree computed from the
 				      serial symbolic factorization */
     yes_no_t      SymPattern;      /* symmetric factorization          */
+    yes_no_t      SingleFactor;    /* factor in single precision       */
+    yes_no_t      ShareReplicated; /* one copy per node of the
+				      replicated arrays                */
+    int           SchurSize;       /* order of the unfactored trailing
+				      Schur complement                 */
+    double        BLR_Tol;         /* low-rank compression tolerance   */
+    int           BLR_MinSize;     /* smallest block compressed        */
+    yes_no_t      Reproducible;    /* bitwise reproducible solves      */
+    yes_no_t      PatternCache;    /* reuse the symbolic analysis of a
+				      known sparsity pattern           */
+    double        Amalg_Tol;       /* fraction of zeros allowed when
+				      merging supernodes               */
+    double        RowPerm_Tol;     /* keep the previous large-diagonal
+				      row permutation and scaling      */
+    int           Equil_Iter;      /* sweeps of the Ruiz scaling       */
+    double        DenseRoot_Tol;   /* density from which the trailing
+				      supernodes are factored densely  */
+    fact_comm_t   Fact_Comm;       /* panel communication scheme of
+				      the factorization                */
+    yes_no_t      Sched_Priority;  /* critical-path static schedule    */
+    yes_no_t      Panel_Compress;  /* encode the panel indices sent    */
+    yes_no_t      SparseRHS;       /* prune the L-solve to the nonzeros
+				      of B                             */
+    int           Solve_RootSize;  /* order of the etree root solved on
+				      all the processes                */
+    int           DiagInv_MinSize; /* sizes of the supernodes whose  */
+    int           DiagInv_MaxSize; /* diagonal blocks are inverted     */
+    yes_no_t      Solve_CritPath;  /* measure the critical path of the
+				      triangular solves                */
+    int           Solve_RHSTile;   /* right-hand sides per tile of the
+				      B and X redistribution           */
+    yes_no_t      Predict;         /* print the predicted memory after
+				      the symbolic factorization       */
+    double        MemBudget;       /* megabytes per process, 0: none   */
+    yes_no_t      OutOfCore;       /* values of L and U kept in files  */
+    yes_no_t      ReleaseMemory;   /* free what the solves do not need */
+    yes_no_t      RefactorMap;     /* keep what pdgsrefactor() needs   */
+    yes_no_t      SymValues;       /* A symmetric: keep L and D only   */
+    msg_prec_t    Refine_MsgPrec;  /* precision of the solve messages
+				      of the refinement corrections    */
+    yes_no_t      Overlap_Preproc; /* column ordering during MC64     */
+    int           DofBlock;        /* unknowns per node for the
+				      ordering, 0: detect              */
+    yes_no_t      Complex_3M;      /* complex GEMM by 3 real GEMMs     */
+    int           SplitSuper;      /* largest supernode after the
+				      symbolic factorization, 0: any   */
+    int           Dense_MaxN;      /* largest n solved by dense LU     */
+    yes_no_t      Solve_Compact;   /* factors in the layout of the
+				      solves, see dCompact_LU()        */
+    yes_no_t      UserSymbFact;    /* symbolic factorization given in
+				      LUstruct->usymb                  */
+    yes_no_t      Solve_Priority;  /* longest etree path first in the
+				      triangular solves                */
 } superlu_dist_options_t;
 
+/*
+ * Key of the ordering and symbolic factorization of a sparsity pattern,
+ * see symbfact_cache.c.
+ */
+typedef struct {
+    uint64_t  h[2];       /* hashes of (n, colptr, rowind) */
+    int_t     n, nnz;
+    int       ColPerm, SchurSize, relax, maxsuper, DofBlock;
+    double    Amalg_Tol;
+    int       SplitSuper;
+} symbfact_key_t;
+
 typedef struct {
     float for_lu;
     float total;
@@ -663,6 +1195,31 @@ typedef struct {
     int64_t nnzL, nnzU;
 } superlu_dist_mem_usage_t;
 
+/*
+ * Prediction of the factorization on one process, see superlu_predict.c.
+ * The memory is in bytes.
+ */
+typedef struct {
+    double mem_L, mem_U;  /* the local L and U factors, with their indices */
+    double mem_trees;     /* the broadcast and reduction trees of the solve */
+    double mem_buffers;   /* bigU, bigV and the look-ahead panels of pxgstrf */
+    double mem_inv;       /* Linv and Uinv with options->DiagInv = YES */
+    double mem_solve;     /* the solve workspace for one right-hand side */
+    double mem_peak;      /* factors and trees, plus the larger of the
+			     buffers and the solve memory */
+    double flops;         /* of the factorization */
+    double msgs, msg_bytes; /* panel messages sent in the factorization */
+} superlu_predict_t;
+
+/*
+ * Machine model of the simulator, see superlu_simulate.c.
+ */
+typedef struct {
+    double gflops;    /* GEMM rate of one thread, GFLOP/s */
+    double latency;   /* of a message, seconds */
+    double bandwidth; /* bytes per second */
+} superlu_machine_t;
+
 /*-- Auxiliary data type used in PxGSTRS/PxGSTRS1. */
 typedef struct {
     int_t lbnum;  /* Row block number (local).      */
@@ -691,6 +1248,43 @@ typedef struct
     void *next;
 } etree_node;
 
+/*-- Bump allocator for the work arrays that live through one call of
+     PxGSTRF; see superlu_arena.c. */
+typedef struct {
+    char   *base;
+    size_t size;   /* bytes reserved */
+    size_t used;   /* bytes handed out */
+    size_t peak;   /* high-water mark of used */
+} superlu_arena_t;
+
+/*-- The communication progress thread, see superlu_progress.c --*/
+typedef struct superlu_progress_s superlu_progress_t;
+
+/*-- Callback at the beginning or end of a phase (ProfPhaseType) for
+     supernode k, see superlu_prof.c. */
+typedef void (*superlu_prof_hook_t)(int phase, int_t k, void *data);
+extern superlu_prof_hook_t superlu_prof_begin_hook, superlu_prof_end_hook;
+extern void *superlu_prof_data;
+
+#define SUPERLU_PROF_BEGIN(phase, k) \
+    { if ( superlu_prof_begin_hook ) \
+	  superlu_prof_begin_hook(phase, k, superlu_prof_data); }
+#define SUPERLU_PROF_END(phase, k) \
+    { if ( superlu_prof_end_hook ) \
+	  superlu_prof_end_hook(phase, k, superlu_prof_data); }
+
+/*-- Slab of the values of L or U kept in a file, see superlu_ooc.c. */
+typedef struct {
+    char   *base;     /* the mapping; NULL if the slab is in memory */
+    size_t size;      /* bytes mapped, whole pages */
+    int    fd;
+    size_t retired;   /* [0, retired) is no longer needed by PxGSTRF */
+    size_t dropped;   /* [0, dropped) was dropped from the page cache */
+    size_t ahead[2];  /* [ahead[0], size) and [0, ahead[1]) were read
+			 ahead by the U- and L-solve */
+    size_t window;    /* bytes read ahead at a time */
+} superlu_ooc_t;
+
 struct superlu_pair
 {
     int ind;
@@ -713,8 +1307,50 @@ extern void   superlu_gridinit(MPI_Comm, int_t, int_t, gridinfo_t *);
 extern void   superlu_gridmap(MPI_Comm, int_t, int_t, int_t [], int_t,
 			      gridinfo_t *);
 extern void   superlu_gridexit(gridinfo_t *);
+extern void   superlu_node_usermap(MPI_Comm, int_t, int_t, int_t []);
+extern void   superlu_grid_shape(int, int_t, int_t *, int_t *);
+extern int    superlu_node_id(MPI_Comm);
+extern void   superlu_gridinit_hybrid(MPI_Comm, superlu_dist_options_t *,
+				      SuperMatrix *, int, gridinfo_t *);
 extern void   print_options_dist(superlu_dist_options_t *);
 extern void   print_sp_ienv_dist(superlu_dist_options_t *);
+extern void   pxgstrs_comm_nrhs(pxgstrs_comm_t *, int, gridinfo_t *);
+extern void   pxgstrs_neighbors(pxgstrs_comm_t *, gridinfo_t *);
+extern void   *pxgstrs_buf(pxgstrs_comm_t *, size_t);
+extern void   pxgstrs_recv(void *, int, MPI_Datatype, gridinfo_t *,
+			   MPI_Status *, SuperLUStat_t *);
+extern int    pxgstrs_ring_depth(void);
+extern int    pxgstrs_ring_slots(gridinfo_t *);
+extern void   pxgstrs_waitsome(int, MPI_Request *, int *, int *,
+			       MPI_Status *);
+extern void   pxgstrs_waitall(int, MPI_Request *);
+extern int    pxgstrs_lsum_shared(size_t, int);
+extern void   pxgstrs_ring_init(pxgstrs_ring_t *, void *, int, MPI_Datatype,
+				int, int, pxgstrs_agg_t *, int *, gridinfo_t *);
+extern void   *pxgstrs_ring_recv(pxgstrs_ring_t *, MPI_Status *,
+				 SuperLUStat_t *);
+extern void   pxgstrs_ring_prio(pxgstrs_ring_t *, int_t *, int_t);
+extern void   pxgstrs_ring_keep(pxgstrs_ring_t *);
+extern void   pxgstrs_ring_free(pxgstrs_ring_t *);
+extern pxgstrs_agg_t *pxgstrs_agg_init(size_t, gridinfo_t *);
+extern int    pxgstrs_agg_put(pxgstrs_agg_t *, int, int, void *, size_t);
+extern void   pxgstrs_agg_flush(pxgstrs_agg_t *);
+extern void   pxgstrs_agg_wait(pxgstrs_agg_t *);
+extern void   pxgstrs_agg_free(pxgstrs_agg_t *);
+extern int    pxgstrs_lowp_pack(int, void *, int, int, void *);
+extern void   pxgstrs_lowp_unpack(void *, int);
+extern void   pxgstrs_critpath(char, int_t, int_t *, double *, gridinfo_t *,
+			       double *, int_t *);
+extern void   pxgstrs_priority(int_t, int_t *, int_t *, int_t *);
+extern void   pxgstrs_sort_prio(int_t, int_t *, int_t *);
+extern int_t  *pxgstrs_nbr_exchange(pxgstrs_comm_t *, int, int, int_t *,
+				    void *, void *, MPI_Datatype);
+extern void   superlu_treespec_init(superlu_treespec_t *, int);
+extern void   superlu_treespec_add(superlu_treespec_t *, int, int *, int,
+				   int, double);
+extern void   superlu_treespec_free(superlu_treespec_t *);
+extern int    superlu_pack_index(int_t, int_t *, unsigned char *);
+extern int_t  superlu_unpack_index(int, unsigned char *, int_t *);
 extern void   Destroy_CompCol_Matrix_dist(SuperMatrix *);
 extern void   Destroy_SuperNode_Matrix_dist(SuperMatrix *);
 extern void   Destroy_SuperMatrix_Store_dist(SuperMatrix *);
@@ -723,9 +1359,21 @@ extern void   Destroy_CompRowLoc_Matrix_dist(SuperMatrix *);
 extern void   Destroy_CompRow_Matrix_dist(SuperMatrix *);
 extern void   sp_colorder (superlu_dist_options_t*, SuperMatrix*, int_t*, int_t*,
 			   SuperMatrix*);
+extern void   sp_colorder_loc (superlu_dist_options_t*, SuperMatrix*, int_t*,
+			       int_t*, SuperMatrix*, SuperMatrix*, int_t*,
+			       gridinfo_t*);
 extern int    sp_symetree_dist(int_t *, int_t *, int_t *, int_t, int_t *);
 extern int    sp_coletree_dist (int_t *, int_t *, int_t *, int_t, int_t, int_t *);
+extern int    sp_symetree_dist_loc(SuperMatrix *, int_t *, int_t *, int_t *,
+				   gridinfo_t *);
+extern int    sp_coletree_dist_loc(SuperMatrix *, int_t *, int_t *,
+				   gridinfo_t *);
+extern int    sp_colcounts_dist_loc(SuperMatrix *, int_t *, int_t *, int_t *,
+				    int_t *, gridinfo_t *);
+extern int    sp_colcounts_ata_dist_loc(SuperMatrix *, int_t *, int_t *,
+					int_t *, gridinfo_t *);
 extern void   get_perm_c_dist(int_t, int_t, SuperMatrix *, int_t *);
+extern void   get_perm_c_block(int_t, int_t, int, SuperMatrix *, int_t *);
 extern void   at_plus_a_dist(const int_t, const int_t, int_t *, int_t *,
 			     int_t *, int_t **, int_t **);
 extern int    genmmd_dist_(int_t *, int_t *, int_t *a, 
@@ -733,13 +1381,40 @@ extern int    genmmd_dist_(int_t *, int_t *, int_t *a,
 			   int_t *, int_t *, int_t *, int_t *, int_t *);
 extern void  bcast_tree(void *, int, MPI_Datatype, int, int,
 			gridinfo_t *, int, int *);
+extern void  bcast_tree_start(void *, int, MPI_Datatype, int, int,
+			      gridinfo_t *, int, superlu_bcast_t *);
+extern int   bcast_tree_test(superlu_bcast_t *);
+extern void  bcast_tree_wait(superlu_bcast_t *);
 extern int_t symbfact(superlu_dist_options_t *, int, SuperMatrix *, int_t *,
                       int_t *, Glu_persist_t *, Glu_freeable_t *);
+extern int_t symbfact_node(superlu_dist_options_t *, int, SuperMatrix *,
+			   int_t *, int_t *, Glu_persist_t *, Glu_freeable_t *,
+			   gridinfo_t *);
 extern int_t symbfact_SubInit(fact_t, void *, int_t, int_t, int_t, int_t,
 			      Glu_persist_t *, Glu_freeable_t *);
+extern void  symbfact_SubHint(int_t, int_t);
+extern void  symbfact_estimate(superlu_dist_options_t *, SuperMatrix *,
+			       int_t *, int_t *);
+extern int_t symbfact_amalgamate(superlu_dist_options_t *, int_t,
+				 Glu_persist_t *, Glu_freeable_t *);
+extern int_t symbfact_band(superlu_dist_options_t *, int_t,
+			   Glu_persist_t *, Glu_freeable_t *);
+extern int_t symbfact_split(superlu_dist_options_t *, int_t,
+			    Glu_persist_t *, Glu_freeable_t *);
+extern int_t symbfact_user(superlu_symbfact_t *, int_t, SuperMatrix *,
+			   int_t *, int_t *, int_t *, Glu_persist_t *,
+			   Glu_freeable_t *, gridinfo_t *);
 extern int_t symbfact_SubXpand(int_t, int_t, int_t, MemType, int_t *,
 			       Glu_freeable_t *);
 extern int_t symbfact_SubFree(Glu_freeable_t *);
+extern void  symbfact_cache_key(superlu_dist_options_t *, SuperMatrix *,
+				symbfact_key_t *);
+extern int   symbfact_cache_get(symbfact_key_t *, int_t *, int_t *,
+				Glu_persist_t *, Glu_freeable_t **, int_t *,
+				gridinfo_t *);
+extern void  symbfact_cache_put(symbfact_key_t *, int_t *, int_t *,
+				Glu_persist_t *, Glu_freeable_t *, int_t);
+extern void  symbfact_cache_free(void);
 extern void    countnz_dist (const int_t, int_t *, int_t *, int_t *,
 			     Glu_persist_t *, Glu_freeable_t *);
 extern int64_t fixupL_dist (const int_t, const int_t *, Glu_persist_t *,
@@ -749,6 +1424,13 @@ extern float   smach_dist(char *);
 extern double  dmach_dist(char *);
 extern void    *superlu_malloc_dist (size_t);
 extern void    superlu_free_dist (void*);
+extern int     superlu_mem_tag (int);
+extern int     superlu_mem_tracked (void);
+extern void    superlu_mem_query (double *, double *);
+extern void    superlu_mem_print (gridinfo_t *);
+extern void    superlu_hugepage (void *, size_t);
+extern void    *superlu_malloc_comm (size_t);
+extern void    superlu_free_comm (void *);
 extern int_t   *intMalloc_dist (int_t);
 extern int_t   *intCalloc_dist (int_t);
 extern int_t   mc64id_dist(int_t *);
@@ -766,15 +1448,86 @@ extern void   ifill_dist (int_t *, int_t, int_t);
 extern void   super_stats_dist (int_t, int_t *);
 extern void  get_diag_procs(int_t, Glu_persist_t *, gridinfo_t *, int_t *,
 			    int_t **, int_t **);
+extern int_t superlu_dirty_supernodes(superlu_dist_options_t *, SuperMatrix *,
+				      int_t *, int_t *, int_t *, Glu_persist_t *,
+				      int_t *, int_t, int_t, int_t *, char *,
+				      gridinfo_t *);
 extern int_t QuerySpace_dist(int_t, int_t, Glu_freeable_t *, superlu_dist_mem_usage_t *);
 extern int   xerr_dist (char *, int *);
 extern void  pxerr_dist (char *, gridinfo_t *, int_t);
 extern void  PStatInit(SuperLUStat_t *);
 extern void  PStatFree(SuperLUStat_t *);
 extern void  PStatPrint(superlu_dist_options_t *, SuperLUStat_t *, gridinfo_t *);
+extern void  PStatImbalance(SuperLUStat_t *, gridinfo_t *);
+extern void  PStatQuery(SuperLUStat_t *, gridinfo_t *, superlu_stat_summary_t *);
+extern void  PStatPrintJSON(FILE *, superlu_stat_summary_t *);
 extern void  log_memory(int64_t, SuperLUStat_t *);
 extern void  print_memorylog(SuperLUStat_t *, char *);
 extern int   superlu_dist_GetVersionNumber(int *, int *, int *);
+extern int   superlu_trace_init(gridinfo_t *, SuperLUStat_t *);
+extern void  superlu_trace_event(SuperLUStat_t *, TraceEventType, int_t,
+                                 double);
+extern void  superlu_trace_finalize(gridinfo_t *, SuperLUStat_t *);
+extern void  superlu_trace_free(SuperLUStat_t *);
+extern void  superlu_prof_register(superlu_prof_hook_t, superlu_prof_hook_t,
+				   void *);
+extern const char *superlu_prof_name(int);
+extern int   superlu_hwc_init(void);
+extern void  superlu_hwc_begin(SuperLUStat_t *, int);
+extern void  superlu_hwc_end(SuperLUStat_t *, int);
+extern void  superlu_hwc_print(SuperLUStat_t *, gridinfo_t *);
+extern void  superlu_histo_init(SuperLUStat_t *);
+extern void  superlu_histo_free(SuperLUStat_t *);
+extern void  superlu_histo_gemm(SuperLUStat_t *, int_t, int_t, int_t, double);
+extern void  superlu_histo_supernodes(SuperLUStat_t *, int_t, int_t *);
+extern void  superlu_histo_print(SuperLUStat_t *, gridinfo_t *);
+extern void  superlu_sncost_start(superlu_dist_options_t *, SuperLUStat_t *,
+				  int_t);
+extern void  superlu_sncost_charge(SuperLUStat_t *, int, int_t);
+extern void  superlu_sncost_finish(SuperLUStat_t *, int_t *, gridinfo_t *,
+				   double **);
+extern void  superlu_sncost_free(SuperLUStat_t *);
+extern superlu_progress_t *superlu_progress_start(gridinfo_t *);
+extern void  superlu_progress_stop(superlu_progress_t *);
+extern int   superlu_omp_init(void);
+extern int   superlu_num_threads(void);
+extern int   superlu_omp_set_threads(int);
+extern int   superlu_blas_set_threads(int);
+extern void  superlu_blas_restore_threads(int);
+extern int   superlu_blas_max_threads(double);
+extern size_t superlu_arena_bytes(size_t);
+extern void  superlu_arena_init(superlu_arena_t *, size_t);
+extern void  *superlu_arena_alloc(superlu_arena_t *, size_t);
+extern size_t superlu_arena_mark(superlu_arena_t *);
+extern void  superlu_arena_reset(superlu_arena_t *, size_t);
+extern void  superlu_arena_destroy(superlu_arena_t *);
+extern void  *superlu_ooc_alloc(superlu_ooc_t *, size_t);
+extern void  superlu_ooc_rewind(superlu_ooc_t *);
+extern void  superlu_ooc_retire(superlu_ooc_t *, void *);
+extern void  superlu_ooc_ahead(superlu_ooc_t *, void *, int);
+extern void  superlu_ooc_free(superlu_ooc_t *);
+extern int   superlu_shm_share(void **, size_t, gridinfo_t *);
+extern int   superlu_shm_unshare(void **, size_t);
+extern void  superlu_shm_free(void *);
+extern int_t superlu_tune_param(int_t);
+extern void  superlu_tune_set(int_t, int_t);
+extern void  superlu_tune_lock(int);
+extern int   superlu_tune_load(SuperMatrix *, gridinfo_t *);
+extern void  superlu_tune_store(SuperMatrix *, gridinfo_t *, int_t, int_t,
+				double);
+extern void  superlu_predict(superlu_dist_options_t *, int_t, Glu_persist_t *,
+			     Glu_freeable_t *, int, int, int, int,
+			     superlu_predict_t *);
+extern void  superlu_predict_print(int, int, superlu_predict_t *);
+extern void  superlu_machine_default(superlu_machine_t *);
+extern void  superlu_simulate(int_t, Glu_persist_t *, Glu_freeable_t *,
+			      int, int, int, int, int, int,
+			      superlu_machine_t *, double *, double *);
+extern void  superlu_simulate_print(superlu_dist_options_t *, int_t,
+				    Glu_persist_t *, Glu_freeable_t *,
+				    int, int, int, int, int);
+extern void  superlu_sort_int(int_t, int_t *, int_t *);
+extern void  superlu_sort_pairs(int_t, int_t *);
 extern void  quickSort( int_t*, int_t, int_t, int_t);
 extern void  quickSortM( int_t*, int_t, int_t, int_t, int_t, int_t);
 extern int_t partition( int_t*, int_t, int_t, int_t);
@@ -790,6 +1543,11 @@ extern float get_perm_c_parmetis
 (SuperMatrix *, int_t *, int_t *, int, int, 
  int_t **, int_t **, gridinfo_t *, MPI_Comm *);
 
+/* Get the column permutation using PT-Scotch (ColPerm = ZOLTAN) */
+extern float get_perm_c_ptscotch
+(SuperMatrix *, int_t *, int_t *, int, int,
+ int_t **, int_t **, gridinfo_t *, MPI_Comm *);
+
 /* Auxiliary routines for memory expansions used during
    the parallel symbolic factorization routine */
 
@@ -845,7 +1603,10 @@ typedef void* StdList;
 
 // typedef enum {NO, YES}  yes_no_t;
 extern RdTree   RdTree_Create(MPI_Comm comm, int* ranks, int rank_cnt, int msgSize, double rseed, char precision);  
+extern RdTree   RdTree_CreateLocal(MPI_Comm comm, int root, int* dests, int ndest, int msgSize, char precision);
 extern void   	RdTree_Destroy(RdTree Tree, char precision);
+extern int  	RdTree_GetRoot(RdTree Tree, char precision);
+extern int  	RdTree_GetDest(RdTree Tree, int i, char precision);
 extern void 	RdTree_SetTag(RdTree Tree, int tag, char precision);
 extern yes_no_t RdTree_IsRoot(RdTree Tree, char precision);
 extern void 	RdTree_forwardMessageSimple(RdTree Tree, void* localBuffer, int msgSize, char precision);
@@ -853,9 +1614,17 @@ extern void 	RdTree_allocateRequest(RdTree Tree, char precision);
 extern int  	RdTree_GetDestCount(RdTree Tree, char precision);
 extern int  	RdTree_GetMsgSize(RdTree Tree, char precision);
 extern void 	RdTree_waitSendRequest(RdTree Tree, char precision);
+extern void 	RdTree_SetAggregator(RdTree Tree, pxgstrs_agg_t *agg, char precision);
+extern void 	RdTree_SetMsgPrec(RdTree Tree, int prec, char precision);
 
+extern void     TreeNodeMap_Create(MPI_Comm comm);
+extern void     TreeNodeMap_Destroy(MPI_Comm comm);
 extern BcTree   BcTree_Create(MPI_Comm comm, int* ranks, int rank_cnt, int msgSize, double rseed, char precision);  
+extern BcTree   BcTree_CreateNrhs(MPI_Comm comm, int* ranks, int rank_cnt, int msgSize, int nrhs, double rseed, char precision);
+extern BcTree   BcTree_CreateLocal(MPI_Comm comm, int root, int* dests, int ndest, int msgSize, char precision);
 extern void   	BcTree_Destroy(BcTree Tree, char precision);
+extern int  	BcTree_GetRoot(BcTree Tree, char precision);
+extern int  	BcTree_GetDest(BcTree Tree, int i, char precision);
 extern void 	BcTree_SetTag(BcTree Tree, int tag, char precision);
 extern yes_no_t BcTree_IsRoot(BcTree Tree, char precision);
 extern void 	BcTree_forwardMessageSimple(BcTree Tree, void* localBuffer, int msgSize, char precision);
@@ -863,6 +1632,8 @@ extern void 	BcTree_allocateRequest(BcTree Tree, char precision);
 extern int 		BcTree_getDestCount(BcTree Tree, char precision); 
 extern int 		BcTree_GetMsgSize(BcTree Tree, char precision); 
 extern void 	BcTree_waitSendRequest(BcTree Tree, char precision);
+extern void 	BcTree_SetAggregator(BcTree Tree, pxgstrs_agg_t *agg, char precision);
+extern void 	BcTree_SetMsgPrec(BcTree Tree, int prec, char precision);
  
 extern StdList 	StdList_Init();
 extern void 	StdList_Pushback(StdList lst, int_t dat);
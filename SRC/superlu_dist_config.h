@@ -4,14 +4,26 @@
 /* #undef HAVE_CUDA */
 
 /* Enable parmetis */
-#define HAVE_PARMETIS TRUE
+/* #undef HAVE_PARMETIS */
+
+/* Enable PT-Scotch */
+/* #undef HAVE_PTSCOTCH */
+
+/* Enable HDF5 */
+/* #undef HAVE_HDF5 */
 
 /* Enable LAPACK */
-/* #undef SLU_HAVE_LAPACK */
+#define SLU_HAVE_LAPACK TRUE
 
 /* Enable CombBLAS */
 /* #undef HAVE_COMBBLAS */
 
+/* Enable the single precision library */
+#define SLU_HAVE_SINGLE TRUE
+
+/* Enable the single precision complex library */
+#define SLU_HAVE_COMPLEX TRUE
+
 /* enable 64bit index mode */
 /* #undef XSDK_INDEX_SIZE */
 
@@ -29,18 +29,24 @@ at the top-level directory.
  ***********************************************************************/
 typedef enum {NO, YES}                                          yes_no_t;
 typedef enum {DOFACT, SamePattern, SamePattern_SameRowPerm, FACTORED} fact_t;
-typedef enum {NOROWPERM, LargeDiag_MC64, LargeDiag_HWPM, MY_PERMR} rowperm_t;
+typedef enum {NOROWPERM, LargeDiag_MC64, LargeDiag_HWPM, MY_PERMR,
+              LargeDiag_AUCTION}                                rowperm_t;
 typedef enum {NATURAL, MMD_ATA, MMD_AT_PLUS_A, COLAMD,
-	      METIS_AT_PLUS_A, PARMETIS, ZOLTAN, MY_PERMC}      colperm_t;
+	      METIS_AT_PLUS_A, PARMETIS, ZOLTAN, MY_PERMC,
+	      AMD_AT_PLUS_A, RCM_AT_PLUS_A}                     colperm_t;
 typedef enum {NOTRANS, TRANS, CONJ}                             trans_t;
 typedef enum {NOEQUIL, ROW, COL, BOTH}                          DiagScale_t;
-typedef enum {NOREFINE, SLU_SINGLE=1, SLU_DOUBLE, SLU_EXTRA}    IterRefine_t;
+typedef enum {NOREFINE, SLU_SINGLE=1, SLU_DOUBLE, SLU_EXTRA,
+              SLU_GMRES}                                        IterRefine_t;
 //typedef enum {LUSUP, UCOL, LSUB, USUB, LLVL, ULVL, NO_MEMTYPE}  MemType;
 typedef enum {USUB, LSUB, UCOL, LUSUP, LLVL, ULVL, NO_MEMTYPE}  MemType;
 typedef enum {HEAD, TAIL}                                       stack_end_t;
 typedef enum {SYSTEM, USER}                                     LU_space_t;
 typedef enum {ONE_NORM, TWO_NORM, INF_NORM}			norm_t;
 typedef enum {SILU, SMILU_1, SMILU_2, SMILU_3}			milu_t;
+typedef enum {SLU_COMM_ISEND, SLU_COMM_IRECV, SLU_COMM_SYNC, SLU_COMM_RMA,
+              SLU_COMM_THREADS}                                  fact_comm_t;
+typedef enum {SLU_MSG_FULL, SLU_MSG_SINGLE, SLU_MSG_BF16}          msg_prec_t;
 #if 0
 typedef enum {NODROP		= 0x0000,
 	      DROP_BASIC	= 0x0001, /* ILU(tau) */
@@ -88,4 +94,95 @@ typedef enum {
     NPHASES  /* total number of phases */
 } PhaseType;
 
+/*
+ * The following enumerate type labels the communication trees of the
+ * triangular solve, whose messages are counted in SuperLUStat_t.
+ * The order is that of the MPI tags BC_L, RD_L, BC_U, RD_U.
+ */
+typedef enum {
+    SOL_BC_L,   /* broadcast of X[k] in the L-solve */
+    SOL_RD_L,   /* reduction of lsum[k] in the L-solve */
+    SOL_BC_U,   /* broadcast of X[k] in the U-solve */
+    SOL_RD_U,   /* reduction of lsum[k] in the U-solve */
+    NSOL_TREES  /* total number of trees */
+} SolveTreeType;
+
+/*
+ * The following enumerate type labels the per-supernode events recorded
+ * by the factorization tracer (see superlu_trace.c).
+ */
+typedef enum {
+    TRACE_PANEL_L,    /* panel factorization of L(:,k) */
+    TRACE_PANEL_U,    /* triangular solve for U(k,:) */
+    TRACE_SEND_L,     /* post Isend of L(:,k) to process row */
+    TRACE_WAIT_L,     /* wait for L(:,k) to be sent or received */
+    TRACE_SEND_U,     /* post Isend of U(k,:) to process column */
+    TRACE_WAIT_U,     /* wait for U(k,:) to be sent or received */
+    TRACE_LOOKAHEAD,  /* Schur complement update of look-ahead panels */
+    TRACE_SCHUR_GEMM, /* GEMM of the remaining Schur complement update */
+    TRACE_SCATTER,    /* scatter of the Schur complement update */
+    NTRACE_EVENTS     /* total number of event types */
+} TraceEventType;
+
+/*
+ * The following enumerate type labels the categories the allocations of
+ * SUPERLU_MALLOC are attributed to when they are tracked (see memory.c).
+ */
+typedef enum {
+    SUPERLU_MEM_OTHER,    /* not attributed */
+    SUPERLU_MEM_SYMB,     /* ordering and symbolic factorization */
+    SUPERLU_MEM_FACTORS,  /* L and U, and the buffers of the factorization */
+    SUPERLU_MEM_TREES,    /* communication trees of the triangular solve */
+    SUPERLU_MEM_SOLVE,    /* workspace of the triangular solve */
+    SUPERLU_MEM_REDIST,   /* redistribution of B, X and A for the solve */
+    SUPERLU_MEM_NCATS     /* total number of categories */
+} MemCategory;
+
+/*
+ * The following enumerate types label the phases whose hardware counters
+ * are kept in SuperLUStat_t, and the counters (see superlu_hwc.c).
+ */
+typedef enum {
+    HWC_FACT,     /* the whole numerical factorization */
+    HWC_GEMM,     /* GEMM of the remaining Schur complement update */
+    HWC_SCATTER,  /* scatter of the remaining Schur complement update */
+    HWC_LSOLVE,   /* L-solve of the last triangular solve */
+    HWC_USOLVE,   /* U-solve of the last triangular solve */
+    NHWC_PHASES   /* total number of phases */
+} HwcPhaseType;
+
+typedef enum {
+    HWC_CYCLES,   /* CPU cycles */
+    HWC_INSTR,    /* instructions retired */
+    HWC_MISSES,   /* last level cache misses */
+    HWC_SECONDS,  /* elapsed time */
+    NHWC_EVENTS   /* total number of counters */
+} HwcEventType;
+
+/* Buckets of sizes 2^b to 2^(b+1)-1 of the histograms of SuperLUStat_t,
+   see superlu_histo.c. */
+#define NHISTO_BINS 10
+
+/* Entries of the cost of a supernode, see superlu_sncost.c. */
+#define SNCOST_PANEL 0
+#define SNCOST_SCHUR 1
+#define SNCOST_BYTES 2
+
+/*
+ * The following enumerate type labels the phases reported to the
+ * callbacks of superlu_prof_register() (see superlu_prof.c).
+ */
+typedef enum {
+    PROF_ANALYSIS,  /* orderings and symbolic factorization in PxGSSVX */
+    PROF_DIST,      /* distribution of A into L and U in PxGSSVX */
+    PROF_FACT,      /* numerical factorization, PxGSTRF */
+    PROF_STEP,      /* one step of PxGSTRF, for supernode k */
+    PROF_SCHUR,     /* Schur complement update of the step of supernode k */
+    PROF_SOLVE,     /* triangular solves, PxGSTRS */
+    PROF_LSOLVE,    /* L-solve */
+    PROF_USOLVE,    /* U-solve */
+    PROF_REFINE,    /* iterative refinement, PxGSRFS */
+    NPROF_PHASES    /* total number of phases */
+} ProfPhaseType;
+
 #endif /* __SUPERLU_ENUM_CONSTS */
@@ -26,7 +26,158 @@ at the top-level directory.
 MPI_Datatype SuperLU_MPI_DOUBLE_COMPLEX = MPI_DATATYPE_NULL;
 #endif
 
+/*! \brief The node of the calling process: the lowest rank of Bcomm on it.
+ *
+ * <pre>
+ * The nodes are those of MPI_Comm_split_type(MPI_COMM_TYPE_SHARED), or
+ * consecutive groups of SUPERLU_RANKS_PER_NODE ranks if this environment
+ * variable is set. All processes in Bcomm must call this routine.
+ * </pre>
+ */
+int superlu_node_id(MPI_Comm Bcomm)
+{
+    int rank, node, k;
+    char *ttemp;
+
+    MPI_Comm_rank( Bcomm, &rank );
+    ttemp = getenv("SUPERLU_RANKS_PER_NODE");
+    if ( ttemp && (k = atoi(ttemp)) > 0 ) {
+	node = rank / k * k;
+    } else {
+#if MPI_VERSION >= 3
+	MPI_Comm shmcomm;
+	MPI_Comm_split_type(Bcomm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+			    &shmcomm);
+	node = rank;
+	MPI_Bcast(&node, 1, MPI_INT, 0, shmcomm);
+	MPI_Comm_free(&shmcomm);
+#else
+	node = 0;
+#endif
+    }
+    return node;
+}
+
+/*! \brief Place the processes of each node on a block of the grid.
+ *
+ * <pre>
+ * The ranks 0 to nprow*npcol-1 of Bcomm are grouped by node, see
+ * superlu_node_id(). If all the nodes have the same number c of these
+ * processes, the grid is tiled by br-by-bc blocks, br*bc = c, one node
+ * per block, with the shape that minimizes npcol/bc + nprow/br, i.e. the
+ * number of nodes crossed by the broadcasts of a U panel down a process
+ * column and of an L panel along a process row. Otherwise the grid is
+ * filled by rows in the order of the nodes. On return, usermap[j*nprow+i]
+ * is the rank placed in {i,j}, as expected by superlu_gridmap().
+ * All processes in Bcomm must call this routine.
+ * </pre>
+ */
+void superlu_node_usermap(MPI_Comm Bcomm, int_t nprow, int_t npcol,
+			  int_t usermap[])
+{
+    int Np = nprow * npcol, nprocs, node, k;
+    int i, j, p, nnodes, c, br, bc, bi, bj, best;
+    int *nodeof, *order, *nodeid, *count, *first, *pos;
+
+    MPI_Comm_size( Bcomm, &nprocs );
+    node = superlu_node_id(Bcomm);
+
+    nodeof = (int *) SUPERLU_MALLOC((nprocs + 5 * Np) * sizeof(int));
+    order = nodeof + nprocs;
+    nodeid = order + Np;
+    count = nodeid + Np;
+    first = count + Np;
+    pos = first + Np;
+    MPI_Allgather(&node, 1, MPI_INT, nodeof, 1, MPI_INT, Bcomm);
+
+    /* Sort the ranks of the grid by node, the nodes in the order of their
+       lowest ranks. */
+    for (nnodes = 0, p = 0; p < Np; ++p) {
+	for (i = 0; i < nnodes && nodeid[i] != nodeof[p]; ++i) ;
+	if ( i == nnodes ) {
+	    nodeid[nnodes] = nodeof[p];
+	    count[nnodes++] = 0;
+	}
+	++count[i];
+    }
+    for (first[0] = 0, i = 1; i < nnodes; ++i)
+	first[i] = first[i-1] + count[i-1];
+    for (i = 0; i < nnodes; ++i) pos[i] = first[i];
+    for (p = 0; p < Np; ++p) {
+	for (i = 0; nodeid[i] != nodeof[p]; ++i) ;
+	order[pos[i]++] = p;
+    }
+
+    /* Shape of the block of a node. */
+    c = count[0];
+    for (i = 1; i < nnodes; ++i) if ( count[i] != c ) c = 0;
+    br = bc = 0;
+    best = Np + 1;
+    if ( c > 0 ) {
+	for (k = 1; k <= c; ++k)
+	    if ( c % k == 0 && nprow % k == 0 && npcol % (c / k) == 0
+		 && nprow / k + npcol / (c / k) < best ) {
+		br = k;
+		bc = c / k;
+		best = nprow / br + npcol / bc;
+	    }
+    }
+
+    if ( br > 0 ) {
+	for (i = 0; i < nnodes; ++i) {
+	    bi = (i / (npcol / bc)) * br; /* upper left corner of node i */
+	    bj = (i % (npcol / bc)) * bc;
+	    for (k = 0; k < c; ++k)
+		usermap[(bj + k % bc) * nprow + bi + k / bc] = order[first[i] + k];
+	}
+    } else {
+	for (i = 0; i < nprow; ++i)
+	    for (j = 0; j < npcol; ++j)
+		usermap[j * nprow + i] = order[i * npcol + j];
+    }
+
+    SUPERLU_FREE(nodeof);
+}
+
+/*! \brief Choose the shape of the process grid for nprocs processes.
+ *
+ * <pre>
+ * On a 2D grid, a process receives about 1/nprow of each L panel and
+ * 1/npcol of each U panel, so the predicted communication volume per
+ * process is proportional to 1/nprow + 1/npcol. A grid dimension larger
+ * than the number of supernodes nsupers leaves processes without blocks
+ * (nsupers <= 0: no limit). The shape returned uses as many of the
+ * nprocs processes as these limits allow and, among those, minimizes the
+ * predicted volume, with nprow <= npcol.
+ * </pre>
+ */
+void superlu_grid_shape(int nprocs, int_t nsupers, int_t *nprow,
+			int_t *npcol)
+{
+    int pr, pc, maxdim = nsupers > 0 ? nsupers : nprocs;
+
+    *nprow = *npcol = 1;
+    for (pr = 1; pr * pr <= nprocs && pr <= maxdim; ++pr) {
+	pc = SUPERLU_MIN(nprocs / pr, maxdim);
+	if ( pr * pc >= *nprow * *npcol ) { /* squarer for the same size */
+	    *nprow = pr;
+	    *npcol = pc;
+	}
+    }
+}
+
 /*! \brief All processes in the MPI communicator must call this routine.
+ *
+ * <pre>
+ * The process {i,j} of the grid is rank i*npcol+j of Bcomm, or, if the
+ * environment variable SUPERLU_NODE_GRID is set to a nonzero value, the
+ * processes of each node are placed on a block of the grid by
+ * superlu_node_usermap().
+ *
+ * With MPI_THREAD_MULTIPLE, several threads of a process may each factor
+ * and solve on their own grid at the same time; the grids must be built
+ * on distinct communicators (e.g. from MPI_Comm_dup()).
+ * </pre>
  */
 void superlu_gridinit(MPI_Comm Bcomm, /* The base communicator upon which
 					 the new grid is formed. */
@@ -35,12 +186,8 @@ void superlu_gridinit(MPI_Comm Bcomm, /* The base communicator upon which
     int Np = nprow * npcol;
     int_t *usermap;
     int i, j, info;
+    char *ttemp;
 
-    /* Make a list of the processes in the new communicator. */
-    usermap = (int_t *) SUPERLU_MALLOC(Np*sizeof(int_t));
-    for (j = 0; j < npcol; ++j)
-	for (i = 0; i < nprow; ++i) usermap[j*nprow+i] = i*npcol+j;
-    
     /* Check MPI environment initialization. */
     MPI_Initialized( &info );
     if ( !info )
@@ -52,6 +199,16 @@ void superlu_gridinit(MPI_Comm Bcomm, /* The base communicator upon which
 	exit(-1);
     }
 
+    /* Make a list of the processes in the new communicator. */
+    usermap = (int_t *) SUPERLU_MALLOC(Np*sizeof(int_t));
+    ttemp = getenv("SUPERLU_NODE_GRID");
+    if ( ttemp && atoi(ttemp) ) {
+	superlu_node_usermap(Bcomm, nprow, npcol, usermap);
+    } else {
+	for (j = 0; j < npcol; ++j)
+	    for (i = 0; i < nprow; ++i) usermap[j*nprow+i] = i*npcol+j;
+    }
+
     superlu_gridmap(Bcomm, nprow, npcol, usermap, nprow, grid);
     
     SUPERLU_FREE(usermap);
@@ -77,6 +234,8 @@ void superlu_gridmap(
     int *pranks;
     int i, j, info;
 
+    superlu_omp_init(); /* the thread team, once per process */
+
 #if 0 // older MPI doesn't support complex in C    
     /* Create datatype in C for MPI complex. */
     if ( SuperLU_MPI_DOUBLE_COMPLEX == MPI_DATATYPE_NULL ) {
@@ -153,6 +312,9 @@ void superlu_gridmap(
     grid->cscp.Np = nprow;
     grid->cscp.Iam = myrow;
 
+    /* Find the node of each process for the communication trees. */
+    TreeNodeMap_Create(grid->comm);
+
 #if 0
     {
 	int tag_ub;
@@ -174,6 +336,7 @@ void superlu_gridmap(
 void superlu_gridexit(gridinfo_t *grid)
 {
     if ( grid->comm != MPI_COMM_NULL && grid->comm != MPI_COMM_WORLD ) {
+	TreeNodeMap_Destroy(grid->comm);
 	/* Marks the communicator objects for deallocation. */
 	MPI_Comm_free( &grid->rscp.comm );
 	MPI_Comm_free( &grid->cscp.comm );
@@ -0,0 +1,187 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Histograms of the Schur complement GEMMs and of the supernodes
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The histograms are kept by setting the environment variable
+ * SUPERLU_GEMM_HISTO to a nonzero value. Each process then records in
+ * its SuperLUStat_t:
+ *
+ *   gemm_histo   the GEMMs of the Schur complement update made by the CPU,
+ *                those of the look-ahead window block by block and the
+ *                aggregated one of the remaining blocks, by the buckets of
+ *                their m, n and k: the number of calls, their flops and
+ *                the seconds spent in them, summed over the threads;
+ *   panel_histo  the number of supernodes, and of columns in them, by
+ *                bucket of their size, at the start of the factorization.
+ *
+ * Bucket b holds the sizes in [2^b, 2^(b+1)), the last one all the larger
+ * sizes. PStatPrint() prints both, the GEMMs summed over the processes
+ * with their GFLOP/s per calling thread. A few large GEMMs below the peak
+ * call for relaxing the supernodes (options->SuperRelax, sp_ienv_dist())
+ * or aggregating more; many small ones for the small kernel or batching;
+ * the mass of the flops above the GPU thresholds (SUPERLU_N_GEMM) for an
+ * offload.
+ * </pre>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "superlu_defs.h"
+
+#define HISTO_CELLS (NHISTO_BINS * NHISTO_BINS * NHISTO_BINS)
+
+static int histo_on = -1;
+
+static int histo_bin(int_t x)
+{
+    int b = 0;
+
+    while ( b < NHISTO_BINS - 1 && x >= ((int_t) 2 << b) ) ++b;
+    return b;
+}
+
+/*! \brief Allocate the histograms of stat if SUPERLU_GEMM_HISTO is set,
+ *  else set them to NULL; called by PStatInit(). */
+void superlu_histo_init(SuperLUStat_t *stat)
+{
+    if ( histo_on < 0 ) {
+	char *ttemp = getenv("SUPERLU_GEMM_HISTO");
+	histo_on = ttemp && atoi(ttemp) != 0;
+    }
+    stat->panel_histo = NULL;
+    stat->gemm_histo = NULL;
+    if ( !histo_on ) return;
+
+    stat->panel_histo = (int *) SUPERLU_MALLOC(2 * NHISTO_BINS * sizeof(int));
+    stat->gemm_histo = (double *) SUPERLU_MALLOC(3 * HISTO_CELLS * sizeof(double));
+    if ( !stat->panel_histo || !stat->gemm_histo )
+	ABORT("Malloc fails for the histograms.");
+    memset(stat->panel_histo, 0, 2 * NHISTO_BINS * sizeof(int));
+    memset(stat->gemm_histo, 0, 3 * HISTO_CELLS * sizeof(double));
+}
+
+void superlu_histo_free(SuperLUStat_t *stat)
+{
+    SUPERLU_FREE(stat->panel_histo);
+    SUPERLU_FREE(stat->gemm_histo);
+    stat->panel_histo = NULL;
+    stat->gemm_histo = NULL;
+}
+
+/*! \brief Record an m x n x k GEMM of the given seconds.
+ *
+ * <pre>
+ * May be called from the threads of a parallel region; does nothing if
+ * the histograms are not kept.
+ * </pre>
+ */
+void superlu_histo_gemm(SuperLUStat_t *stat, int_t m, int_t n, int_t k,
+			double seconds)
+{
+    double *cell;
+
+    if ( !stat->gemm_histo || m <= 0 || n <= 0 || k <= 0 ) return;
+    cell = &stat->gemm_histo[3 * ((histo_bin(m) * NHISTO_BINS + histo_bin(n))
+				  * NHISTO_BINS + histo_bin(k))];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    cell[0] += 1.0;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    cell[1] += 2.0 * (double) m * n * k;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    cell[2] += seconds;
+}
+
+/*! \brief Record the sizes of the nsupers supernodes of xsup[]. */
+void superlu_histo_supernodes(SuperLUStat_t *stat, int_t nsupers, int_t *xsup)
+{
+    int_t k, size;
+    int b;
+
+    if ( !stat->panel_histo ) return;
+    memset(stat->panel_histo, 0, 2 * NHISTO_BINS * sizeof(int));
+    for (k = 0; k < nsupers; ++k) {
+	size = xsup[k+1] - xsup[k];
+	b = histo_bin(size);
+	++stat->panel_histo[b];
+	stat->panel_histo[NHISTO_BINS + b] += size;
+    }
+}
+
+/* Bucket b as "[lo,hi)" or "lo+" for the last one. */
+static void histo_range(char *s, int b)
+{
+    if ( b == NHISTO_BINS - 1 ) sprintf(s, "%d+", 1 << b);
+    else sprintf(s, "%d-%d", 1 << b, (2 << b) - 1);
+}
+
+/*! \brief Print the histograms; collective over grid->comm. */
+void superlu_histo_print(SuperLUStat_t *stat, gridinfo_t *grid)
+{
+    double *sum = NULL, flops = 0.0;
+    int i, bm, bn, bk, nsup = 0;
+    char sm[16], sn[16], sk[16];
+
+    if ( !stat->gemm_histo ) return;
+    if ( !grid->iam ) {
+	if ( !(sum = (double *) SUPERLU_MALLOC(3 * HISTO_CELLS * sizeof(double))) )
+	    ABORT("Malloc fails for sum[].");
+    }
+    MPI_Reduce(stat->gemm_histo, sum, 3 * HISTO_CELLS, MPI_DOUBLE, MPI_SUM,
+	       0, grid->comm);
+    if ( grid->iam ) return;
+
+    for (i = 0; i < NHISTO_BINS; ++i) nsup += stat->panel_histo[i];
+    if ( nsup ) {
+	printf("**** Supernode sizes\n");
+	printf("\t%10s %10s %10s\n", "size", "supernodes", "columns");
+	for (i = 0; i < NHISTO_BINS; ++i) {
+	    if ( !stat->panel_histo[i] ) continue;
+	    histo_range(sm, i);
+	    printf("\t%10s %10d %10d\n", sm, stat->panel_histo[i],
+		   stat->panel_histo[NHISTO_BINS + i]);
+	}
+    }
+
+    for (i = 0; i < HISTO_CELLS; ++i) flops += sum[3 * i + 1];
+    if ( flops > 0.0 ) {
+	printf("**** Schur complement GEMMs (sum over the processes)\n");
+	printf("\t%9s %9s %9s %10s %10s %9s %9s\n", "m", "n", "k", "calls",
+	       "Gflop", "%flops", "GFLOP/s");
+	for (bm = 0; bm < NHISTO_BINS; ++bm)
+	    for (bn = 0; bn < NHISTO_BINS; ++bn)
+		for (bk = 0; bk < NHISTO_BINS; ++bk) {
+		    double *cell = &sum[3 * ((bm * NHISTO_BINS + bn)
+					     * NHISTO_BINS + bk)];
+		    if ( cell[0] == 0.0 ) continue;
+		    histo_range(sm, bm);
+		    histo_range(sn, bn);
+		    histo_range(sk, bk);
+		    printf("\t%9s %9s %9s %10.0f %10.3f %9.2f %9.2f\n",
+			   sm, sn, sk, cell[0], cell[1] * 1e-9,
+			   100.0 * cell[1] / flops,
+			   cell[2] > 0.0 ? cell[1] / cell[2] * 1e-9 : 0.0);
+		}
+    }
+    SUPERLU_FREE(sum);
+}
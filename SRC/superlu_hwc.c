@@ -0,0 +1,201 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Hardware counters of the phases of the factorization and solve
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Counting is enabled by setting the environment variable SUPERLU_HWC to
+ * a nonzero value. Each OpenMP thread of each process then opens the
+ * Linux perf_event counters of CPU cycles, instructions and last level
+ * cache misses for itself, at user level; no privilege is needed with the
+ * default perf_event_paranoid. The master thread reads the counters of
+ * all the threads at the start and end of each phase (HwcPhaseType), and
+ * the differences are summed in stat->hwc[]. PStatPrint() prints, for
+ * each phase, the maximum over the processes of the seconds, cycles,
+ * instructions per cycle and cache misses, and the memory bandwidth
+ * estimated as one cache line per miss.
+ *
+ * The threads created outside OpenMP, e.g. by a pthreads BLAS, are not
+ * counted. If the counters cannot be opened, e.g. on another system or in
+ * a container without perf_event, nothing is counted.
+ * </pre>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "superlu_defs.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define HWC_PERF
+#endif
+
+#define HWC_MAX_THREADS  512
+#define HWC_LINE         64  /* bytes moved per cache miss */
+
+static int hwc_on = -1;      /* -1 until superlu_hwc_init() */
+static int hwc_nthreads = 0;
+static int hwc_fd[HWC_MAX_THREADS]; /* group leaders, one per thread */
+
+#ifdef HWC_PERF
+static const unsigned long long hwc_config[HWC_SECONDS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES
+};
+
+/* Open the counters of the calling thread in one group; returns the
+   leader, or -1. */
+static int hwc_open(void)
+{
+    struct perf_event_attr attr;
+    int e, fd, leader = -1;
+
+    for (e = 0; e < HWC_SECONDS; ++e) {
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = hwc_config[e];
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+	fd = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+	if ( fd < 0 ) {
+	    if ( leader >= 0 ) close(leader); /* closes the group */
+	    return -1;
+	}
+	if ( leader < 0 ) leader = fd;
+    }
+    return leader;
+}
+#endif
+
+/*! \brief Open the counters of all the threads if SUPERLU_HWC is set.
+ *
+ * <pre>
+ * Done once, by the master thread outside the parallel regions. Returns
+ * 1 if the counters are in use.
+ * </pre>
+ */
+int superlu_hwc_init(void)
+{
+    char *ttemp;
+    int i, iam, ok = 1;
+
+    if ( hwc_on >= 0 ) return hwc_on;
+    hwc_on = 0;
+    ttemp = getenv("SUPERLU_HWC");
+    if ( !ttemp || !atoi(ttemp) ) return 0;
+
+#ifdef HWC_PERF
+    hwc_nthreads = 1;
+#ifdef _OPENMP
+    hwc_nthreads = SUPERLU_MIN(omp_get_max_threads(), HWC_MAX_THREADS);
+#pragma omp parallel num_threads(hwc_nthreads) reduction(&&:ok)
+#endif
+    {
+	int t = 0;
+#ifdef _OPENMP
+	t = omp_get_thread_num();
+#endif
+	hwc_fd[t] = hwc_open();
+	ok = ( hwc_fd[t] >= 0 );
+    }
+    if ( ok ) return (hwc_on = 1);
+    for (i = 0; i < hwc_nthreads; ++i)
+	if ( hwc_fd[i] >= 0 ) close(hwc_fd[i]);
+#endif
+    MPI_Comm_rank(MPI_COMM_WORLD, &iam);
+    if ( !iam )
+	fprintf(stderr, "SUPERLU_HWC: hardware counters are not available\n");
+    return 0;
+}
+
+/* Sum the counters of all the threads into v[]. */
+static void hwc_read(double *v)
+{
+    int e, i;
+
+    for (e = 0; e < NHWC_EVENTS; ++e) v[e] = 0.0;
+#ifdef HWC_PERF
+    for (i = 0; i < hwc_nthreads; ++i) {
+	unsigned long long buf[1 + HWC_SECONDS];
+	if ( read(hwc_fd[i], buf, sizeof(buf)) != sizeof(buf) ) continue;
+	for (e = 0; e < HWC_SECONDS && e < (int) buf[0]; ++e)
+	    v[e] += (double) buf[1 + e];
+    }
+#endif
+    v[HWC_SECONDS] = SuperLU_timer_();
+}
+
+/*! \brief Phase phase (HwcPhaseType) starts.
+ */
+void superlu_hwc_begin(SuperLUStat_t *stat, int phase)
+{
+    if ( superlu_hwc_init() ) hwc_read(stat->hwc0[phase]);
+}
+
+/*! \brief Phase phase ends: add its counts to stat->hwc[phase].
+ */
+void superlu_hwc_end(SuperLUStat_t *stat, int phase)
+{
+    double v[NHWC_EVENTS];
+    int e;
+
+    if ( !hwc_on ) return;
+    hwc_read(v);
+    for (e = 0; e < NHWC_EVENTS; ++e)
+	stat->hwc[phase][e] += v[e] - stat->hwc0[phase][e];
+}
+
+/*! \brief Print the counters of each phase, the maximum over the grid.
+ *
+ * <pre>
+ * Collective over grid->comm when SUPERLU_HWC is set; the processes
+ * without counters contribute zeros.
+ * </pre>
+ */
+void superlu_hwc_print(SuperLUStat_t *stat, gridinfo_t *grid)
+{
+    static const char *phase_name[NHWC_PHASES] = {
+	"factor  ", "GEMM    ", "scatter ", "L-solve ", "U-solve "
+    };
+    double mx[NHWC_PHASES][NHWC_EVENTS];
+    char *ttemp = getenv("SUPERLU_HWC");
+    int i, on = superlu_hwc_init(), any;
+
+    if ( !ttemp || !atoi(ttemp) ) return;
+    MPI_Allreduce(&on, &any, 1, MPI_INT, MPI_MAX, grid->comm);
+    if ( !any ) return;
+    MPI_Reduce(stat->hwc, mx, NHWC_PHASES * NHWC_EVENTS, MPI_DOUBLE,
+	       MPI_MAX, 0, grid->comm);
+    if ( grid->iam ) return;
+
+    printf("\tCounters (max)     seconds      cycles   IPC   LLC misses"
+	   "    GB/s\n");
+    for (i = 0; i < NHWC_PHASES; ++i) {
+	if ( mx[i][HWC_SECONDS] <= 0.0 ) continue;
+	printf("\t  %s   %10.3f  %10.3e  %4.2f  %11.3e  %6.2f\n",
+	       phase_name[i], mx[i][HWC_SECONDS], mx[i][HWC_CYCLES],
+	       mx[i][HWC_CYCLES] > 0.0 ?
+	           mx[i][HWC_INSTR] / mx[i][HWC_CYCLES] : 0.0,
+	       mx[i][HWC_MISSES],
+	       mx[i][HWC_MISSES] * HWC_LINE / mx[i][HWC_SECONDS] * 1e-9);
+    }
+}
@@ -0,0 +1,279 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Choice of the processes per node and of the threads per process
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * superlu_gridinit_hybrid() forms the process grid for a matrix from all
+ * the processes launched, a fixed number c per node, each with the same
+ * number of OpenMP threads. It keeps r of the c processes of each node,
+ * r dividing c, and gives each of them the threads of the node, i.e.
+ * c/r times as many, choosing the r of the shortest factorization and
+ * solve simulated by superlu_simulate() on the symbolic factorization of
+ * the matrix; the grid of the r processes of the nodes is shaped by
+ * superlu_grid_shape(). The processes left out of the grid are those
+ * with grid->iam >= nprow*npcol on return, as with superlu_gridinit() on
+ * fewer processes than launched, and must not call the solver.
+ *
+ * The symbolic factorization is computed by process 0 on the pattern of
+ * A gathered from the processes, with the column ordering of options but
+ * without the row permutation, as pdgssvx() with options->RowPerm =
+ * NOROWPERM: it only ranks the candidates. The number of cores of a node
+ * is c times the threads of a process, or the environment variable
+ * SUPERLU_CORES_PER_NODE; the nodes are found by superlu_node_id().
+ * With options->PrintStat = YES, process 0 prints the candidates.
+ *
+ * The processes left out should wait for the others without spinning on
+ * their cores, e.g. with Open MPI's mpi_yield_when_idle.
+ * </pre>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "superlu_defs.h"
+
+/* Gather the pattern of the distributed A into the n x n matrix GA in
+   compressed column format on process 0 of comm, without values. */
+static void hybrid_gather(SuperMatrix *A, MPI_Comm comm, SuperMatrix *GA)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    NCformat *GAstore;
+    int_t n = A->ncol, m_loc = Astore->m_loc, nnz_loc = Astore->nnz_loc;
+    int_t i, j, nnz = 0, *rowlen, *rowptr = NULL, *colind = NULL;
+    int_t *colptr, *rowind;
+    int iam, nprocs, p, *cnt = NULL, *displ = NULL, loc[3], *all = NULL;
+
+    MPI_Comm_rank(comm, &iam);
+    MPI_Comm_size(comm, &nprocs);
+    loc[0] = (int) m_loc;
+    loc[1] = (int) Astore->fst_row;
+    loc[2] = (int) nnz_loc;
+    if ( !iam ) {
+	if ( !(all = SUPERLU_MALLOC(5 * nprocs * sizeof(int))) )
+	    ABORT("Malloc fails for all[].");
+	cnt = all + 3 * nprocs;
+	displ = cnt + nprocs;
+	rowptr = intMalloc_dist(n + 1);
+    }
+    MPI_Gather(loc, 3, MPI_INT, all, 3, MPI_INT, 0, comm);
+
+    /* The length of each row, at its global position. */
+    rowlen = intMalloc_dist(SUPERLU_MAX(m_loc, 1));
+    for (i = 0; i < m_loc; ++i)
+	rowlen[i] = Astore->rowptr[i+1] - Astore->rowptr[i];
+    if ( !iam )
+	for (p = 0; p < nprocs; ++p) {
+	    cnt[p] = all[3 * p];
+	    displ[p] = all[3 * p + 1] + 1;
+	}
+    MPI_Gatherv(rowlen, (int) m_loc, mpi_int_t, rowptr, cnt, displ,
+		mpi_int_t, 0, comm);
+    SUPERLU_FREE(rowlen);
+
+    /* The rows of a process are consecutive, hence their columns too. */
+    if ( !iam ) {
+	rowptr[0] = 0;
+	for (i = 0; i < n; ++i) rowptr[i+1] += rowptr[i];
+	nnz = rowptr[n];
+	colind = intMalloc_dist(SUPERLU_MAX(nnz, 1));
+	for (p = 0; p < nprocs; ++p) {
+	    cnt[p] = all[3 * p + 2];
+	    displ[p] = (int) rowptr[all[3 * p + 1]];
+	}
+    }
+    MPI_Gatherv(Astore->colind + Astore->rowptr[0], (int) nnz_loc, mpi_int_t,
+		colind, cnt, displ, mpi_int_t, 0, comm);
+    if ( iam ) return;
+
+    /* Transpose into compressed columns. */
+    colptr = intCalloc_dist(n + 1);
+    rowind = intMalloc_dist(SUPERLU_MAX(nnz, 1));
+    for (j = 0; j < nnz; ++j) ++colptr[colind[j] + 1];
+    for (j = 0; j < n; ++j) colptr[j+1] += colptr[j];
+    for (i = 0; i < n; ++i)
+	for (j = rowptr[i]; j < rowptr[i+1]; ++j)
+	    rowind[colptr[colind[j]]++] = i;
+    for (j = n; j > 0; --j) colptr[j] = colptr[j-1];
+    colptr[0] = 0;
+
+    GA->Stype = SLU_NC;
+    GA->Dtype = A->Dtype;
+    GA->Mtype = SLU_GE;
+    GA->nrow = GA->ncol = n;
+    if ( !(GA->Store = GAstore = SUPERLU_MALLOC(sizeof(NCformat))) )
+	ABORT("Malloc fails for GA->Store.");
+    GAstore->nnz = nnz;
+    GAstore->nzval = NULL;
+    GAstore->rowind = rowind;
+    GAstore->colptr = colptr;
+    SUPERLU_FREE(rowptr);
+    SUPERLU_FREE(colind);
+    SUPERLU_FREE(all);
+}
+
+/* Choose the processes kept per node, best[0], among the divisors of c,
+   their threads best[1] and the grid best[2] x best[3]; on process 0. */
+static void hybrid_choose(superlu_dist_options_t *options, SuperMatrix *GA,
+			  int nnodes, int c, int cores, int nrhs, int *best)
+{
+    superlu_dist_options_t opt = *options;
+    superlu_machine_t machine;
+    SuperMatrix GAC;
+    NCPformat *GACstore;
+    Glu_persist_t Glu_persist;
+    Glu_freeable_t Glu_freeable;
+    int_t n = GA->ncol, *perm_c, *etree, i, j, nsupers, nprow, npcol;
+    int r, t, dsize;
+    double tf, ts, tbest = -1.0;
+
+    /* The orderings needing the distributed A, or libraries that may not
+       be there, are replaced by minimum degree. */
+    if ( opt.ColPerm == PARMETIS || opt.ColPerm == METIS_AT_PLUS_A
+	 || opt.ColPerm == MY_PERMC )
+	opt.ColPerm = MMD_AT_PLUS_A;
+    perm_c = intMalloc_dist(n);
+    etree = intMalloc_dist(n);
+    get_perm_c_dist(0, opt.ColPerm, GA, perm_c);
+    sp_colorder(&opt, GA, perm_c, etree, &GAC);
+    GACstore = (NCPformat *) GAC.Store;
+    for (j = 0; j < n; ++j)
+	for (i = GACstore->colbeg[j]; i < GACstore->colend[j]; ++i)
+	    GACstore->rowind[i] = perm_c[GACstore->rowind[i]];
+    if ( symbfact(&opt, 0, &GAC, perm_c, etree, &Glu_persist,
+		  &Glu_freeable) > 0 )
+	ABORT("symbfact() runs out of memory in superlu_gridinit_hybrid().");
+    nsupers = Glu_persist.supno[n-1] + 1;
+
+    switch ( GA->Dtype ) {
+	case SLU_S: dsize = 4; break;
+	case SLU_Z: dsize = 16; break;
+	default:    dsize = 8;
+    }
+    superlu_machine_default(&machine);
+    if ( options->PrintStat == YES )
+	printf(".. Hybrid grid: %d node(s) of %d processes, %d cores\n"
+	       "\t%9s %7s %9s %12s %12s\n", nnodes, c, cores,
+	       "processes", "threads", "grid", "factor (s)", "solve (s)");
+    for (r = 1; r <= c; ++r) {
+	if ( c % r ) continue;
+	t = SUPERLU_MAX(cores / r, 1);
+	superlu_grid_shape(r * nnodes, nsupers, &nprow, &npcol);
+	superlu_simulate(n, &Glu_persist, &Glu_freeable, (int) nprow,
+			 (int) npcol, options->num_lookaheads, t, nrhs, dsize,
+			 &machine, &tf, &ts);
+	if ( options->PrintStat == YES )
+	    printf("\t%9d %7d %4dx%-4d %12.4e %12.4e\n", r, t, (int) nprow,
+		   (int) npcol, tf, ts);
+	if ( tbest < 0.0 || tf + ts < tbest ) {
+	    tbest = tf + ts;
+	    best[0] = r;
+	    best[1] = t;
+	    best[2] = (int) nprow;
+	    best[3] = (int) npcol;
+	}
+    }
+    if ( options->PrintStat == YES ) {
+	printf(".. Chosen: %d process(es) per node, %d threads, grid %dx%d\n",
+	       best[0], best[1], best[2], best[3]);
+	fflush(stdout);
+    }
+
+    symbfact_SubFree(&Glu_freeable);
+    SUPERLU_FREE(Glu_persist.xsup);
+    SUPERLU_FREE(Glu_persist.supno);
+    Destroy_CompCol_Permuted_dist(&GAC);
+    SUPERLU_FREE(perm_c);
+    SUPERLU_FREE(etree);
+}
+
+/*! \brief Form the grid and the thread teams for the matrix A.
+ *
+ * <pre>
+ * Bcomm   (input) the processes launched, all of which must call this
+ *         routine;
+ * options (input) the options of the factorization: ColPerm,
+ *         num_lookaheads, PrintStat;
+ * A       (input) the matrix in NR_loc format, its rows split in any way
+ *         among the processes of Bcomm, e.g. all on process 0; only its
+ *         pattern is used;
+ * nrhs    (input) the number of right-hand sides of a solve;
+ * grid    (output) the grid, as from superlu_gridinit().
+ *
+ * The OpenMP team of each process of the grid is resized with
+ * superlu_omp_set_threads(), that of the others set to one thread. A is
+ * generally redistributed on the grid afterwards, its rows among the
+ * nprow*npcol processes of the grid.
+ * </pre>
+ */
+void superlu_gridinit_hybrid(MPI_Comm Bcomm, superlu_dist_options_t *options,
+			     SuperMatrix *A, int nrhs, gridinfo_t *grid)
+{
+    SuperMatrix GA;
+    int iam, nprocs, node, nnodes, c, cores, p, q, i, j, k, Np, lrank;
+    int best[4] = {1, 1, 1, 1}, *nodeof, *act;
+    int_t *usermap;
+    char *ttemp;
+
+    MPI_Comm_rank(Bcomm, &iam);
+    MPI_Comm_size(Bcomm, &nprocs);
+    node = superlu_node_id(Bcomm);
+    if ( !(nodeof = SUPERLU_MALLOC(2 * nprocs * sizeof(int))) )
+	ABORT("Malloc fails for nodeof[].");
+    act = nodeof + nprocs;
+    MPI_Allgather(&node, 1, MPI_INT, nodeof, 1, MPI_INT, Bcomm);
+
+    /* The nodes, and the fewest processes of a node. */
+    nnodes = 0;
+    c = nprocs;
+    for (p = 0; p < nprocs; ++p) {
+	if ( nodeof[p] != p ) continue; /* not the lowest rank of its node */
+	for (k = 0, q = p; q < nprocs; ++q) k += nodeof[q] == p;
+	++nnodes;
+	c = SUPERLU_MIN(c, k);
+    }
+    ttemp = getenv("SUPERLU_CORES_PER_NODE");
+    cores = ttemp ? atoi(ttemp) : c * superlu_num_threads();
+    MPI_Bcast(&cores, 1, MPI_INT, 0, Bcomm);
+
+    hybrid_gather(A, Bcomm, &GA);
+    if ( !iam ) {
+	hybrid_choose(options, &GA, nnodes, c, cores, nrhs, best);
+	Destroy_CompCol_Matrix_dist(&GA);
+    }
+    MPI_Bcast(best, 4, MPI_INT, 0, Bcomm);
+
+    /* The first best[0] processes of each node, by node, fill the grid
+       by rows. */
+    Np = best[2] * best[3];
+    for (k = 0, p = 0; p < nprocs; ++p) {
+	if ( nodeof[p] != p ) continue;
+	for (lrank = 0, q = p; q < nprocs && lrank < best[0]; ++q)
+	    if ( nodeof[q] == p ) {
+		act[k++] = q;
+		++lrank;
+	    }
+    }
+    usermap = (int_t *) SUPERLU_MALLOC(Np * sizeof(int_t));
+    for (i = 0; i < best[2]; ++i)
+	for (j = 0; j < best[3]; ++j)
+	    usermap[j * best[2] + i] = act[i * best[3] + j];
+    superlu_gridmap(Bcomm, best[2], best[3], usermap, best[2], grid);
+    for (k = 0; k < Np && act[k] != iam; ++k) ;
+    if ( k == Np ) grid->iam = Np + iam; /* left out, whatever its rank */
+
+    superlu_omp_set_threads(grid->iam < Np ? best[1] : 1);
+    SUPERLU_FREE(usermap);
+    SUPERLU_FREE(nodeof);
+}
@@ -0,0 +1,144 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief The OpenMP thread team of the process, set up once
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The factorization and the solve open many short parallel regions. The
+ * OpenMP runtime keeps the threads of a team parked between them, and
+ * reuses them as long as the regions ask for the same number of threads;
+ * a region of another size, or the first one, creates or resizes the team
+ * and binds its threads. superlu_omp_init(), called by superlu_gridinit()
+ * and on entry of the drivers, does that once per process:
+ *
+ *   - it fixes the size of the team, the environment variable
+ *     SUPERLU_NUM_THREADS if set, else omp_get_max_threads(), with
+ *     omp_set_num_threads() and no dynamic adjustment, so that all the
+ *     regions without a num_threads clause run on the same threads;
+ *   - with SUPERLU_OMP_PIN=1, on Linux, when the runtime does not bind
+ *     the threads itself (OMP_PROC_BIND), it pins thread i of the team to
+ *     the i-th CPU of the affinity mask of the process, which must then
+ *     be given by the MPI launcher, disjoint from the other processes;
+ *   - it runs an empty region, so that the threads are created and bound
+ *     before the first timed phase.
+ *
+ * superlu_num_threads() returns the size of the team without opening a
+ * region; superlu_omp_set_threads() resizes it. Keeping the threads
+ * spinning between regions, instead of sleeping, is left to the runtime:
+ * OMP_WAIT_POLICY=active, or e.g. GOMP_SPINCOUNT or KMP_BLOCKTIME.
+ * </pre>
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include "superlu_defs.h"
+#if defined(__linux__) && defined(_OPENMP)
+#include <sched.h>
+#define SUPERLU_OMP_AFFINITY
+#endif
+
+static int team_size = 0;   /* 0 until superlu_omp_init() */
+
+#ifdef SUPERLU_OMP_AFFINITY
+/* Pin the calling thread to CPU number i of mask, counting the set ones. */
+static void omp_pin(cpu_set_t *mask, int i)
+{
+    cpu_set_t one;
+    int cpu, ncpu = CPU_COUNT(mask);
+
+    if ( ncpu == 0 ) return;
+    i %= ncpu;
+    for (cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+	if ( CPU_ISSET(cpu, mask) && i-- == 0 ) break;
+    CPU_ZERO(&one);
+    CPU_SET(cpu, &one);
+    sched_setaffinity(0, sizeof(one), &one);
+}
+#endif
+
+/*! \brief Set up the thread team of the process; returns its size.
+ *
+ * <pre>
+ * Only the first call does anything. Must be called outside of any
+ * parallel region, by the master thread.
+ * </pre>
+ */
+int superlu_omp_init(void)
+{
+    if ( team_size ) return team_size;
+    team_size = 1;
+#ifdef _OPENMP
+    {
+	char *ttemp = getenv("SUPERLU_NUM_THREADS");
+	int pin = 0;
+
+	team_size = ttemp ? atoi(ttemp) : omp_get_max_threads();
+	if ( team_size < 1 ) team_size = 1;
+	omp_set_dynamic(0);
+	omp_set_num_threads(team_size);
+
+	ttemp = getenv("SUPERLU_OMP_PIN");
+	pin = ttemp && atoi(ttemp) != 0
+	      && omp_get_proc_bind() == omp_proc_bind_false;
+#ifdef SUPERLU_OMP_AFFINITY
+	cpu_set_t mask;
+	if ( pin && sched_getaffinity(0, sizeof(mask), &mask) != 0 ) pin = 0;
+#pragma omp parallel
+	{
+	    if ( pin ) omp_pin(&mask, omp_get_thread_num());
+	}
+#else
+	if ( pin ) fprintf(stderr, "SUPERLU_OMP_PIN is not supported here.\n");
+#pragma omp parallel
+	{
+	}
+#endif
+    }
+#endif
+    return team_size;
+}
+
+/*! \brief Resize the team to nthreads; returns the previous size.
+ *
+ * <pre>
+ * Used by superlu_gridinit_hybrid() to give the cores of the processes
+ * left out of the grid to those in it. Same restrictions as
+ * superlu_omp_init().
+ * </pre>
+ */
+int superlu_omp_set_threads(int nthreads)
+{
+    int prev = superlu_omp_init();
+
+    team_size = SUPERLU_MAX(nthreads, 1);
+#ifdef _OPENMP
+    omp_set_num_threads(team_size);
+#pragma omp parallel
+    {
+    }
+#else
+    team_size = 1;
+#endif
+    return prev;
+}
+
+/*! \brief The number of threads of the team, set up if needed. */
+int superlu_num_threads(void)
+{
+    return team_size ? team_size : superlu_omp_init();
+}
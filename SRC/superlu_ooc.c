@@ -0,0 +1,202 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Out-of-core storage of the values of L and U
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * With options->OutOfCore = YES, PxDISTRIBUTE maps the slabs holding the
+ * values of all the local blocks of L and of U onto unnamed files in the
+ * directory $SUPERLU_OOC_DIR (default /tmp), which should be on node-local
+ * storage. The blocks are addressed as in memory; the operating system
+ * moves the pages between memory and the file.
+ *
+ * The slabs are laid out by increasing local block column of L and block
+ * row of U. As PxGSTRF finishes with the leading blocks, it retires the
+ * corresponding prefix of the slab: the pages are queued for writing
+ * without waiting, unmapped, and dropped from the page cache once written,
+ * so the memory held by the factors is about that of the blocks still
+ * updated. PxGSTRS reads the slabs back ahead of the solve, by windows of
+ * $SUPERLU_OOC_WINDOW megabytes (default 64) forward in the L-solve and
+ * backward in the U-solve.
+ *
+ * Only POSIX systems are supported; elsewhere superlu_ooc_alloc() fails
+ * and the slabs stay in memory.
+ * </pre>
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* sync_file_range() */
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "superlu_defs.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#define OOC_POSIX
+#endif
+
+#define OOC_BATCH   (1 << 22)   /* bytes retired at a time, 4 MB */
+#define OOC_WINDOW  64          /* megabytes read ahead */
+
+static size_t ooc_page(void)
+{
+#ifdef OOC_POSIX
+    return (size_t) sysconf(_SC_PAGESIZE);
+#else
+    return 4096;
+#endif
+}
+
+/*! \brief Map size bytes onto a new file in $SUPERLU_OOC_DIR.
+ *
+ * <pre>
+ * Returns the address of the mapping, filled with zeros, or NULL if the
+ * file cannot be created; ooc->base is then NULL and the caller allocates
+ * the slab in memory. The file is removed at once, and its space given
+ * back by superlu_ooc_free().
+ * </pre>
+ */
+void *superlu_ooc_alloc(superlu_ooc_t *ooc, size_t size)
+{
+    memset(ooc, 0, sizeof(superlu_ooc_t));
+    ooc->fd = -1;
+#ifdef OOC_POSIX
+    size_t page = ooc_page();
+    char *dir, *path, *ttemp;
+
+    dir = getenv("SUPERLU_OOC_DIR");
+    if ( !dir || !dir[0] ) dir = "/tmp";
+    ttemp = getenv("SUPERLU_OOC_WINDOW");
+    ooc->window = (size_t) (ttemp && atoi(ttemp) > 0 ? atoi(ttemp) : OOC_WINDOW)
+                  << 20;
+    ooc->size = (SUPERLU_MAX(size, 1) + page - 1) / page * page;
+
+    if ( !(path = (char *) SUPERLU_MALLOC(strlen(dir) + 32)) ) return NULL;
+    sprintf(path, "%s/superlu_oocXXXXXX", dir);
+    if ( (ooc->fd = mkstemp(path)) >= 0 ) {
+	unlink(path);
+	if ( ftruncate(ooc->fd, (off_t) ooc->size) == 0 ) {
+	    ooc->base = (char *) mmap(NULL, ooc->size, PROT_READ | PROT_WRITE,
+				      MAP_SHARED, ooc->fd, 0);
+	    if ( ooc->base == (char *) MAP_FAILED ) ooc->base = NULL;
+	}
+	if ( !ooc->base ) {
+	    close(ooc->fd);
+	    ooc->fd = -1;
+	    ooc->size = 0;
+	}
+    }
+    SUPERLU_FREE(path);
+    superlu_ooc_rewind(ooc);
+#endif
+    return ooc->base;
+}
+
+/*! \brief Start over the retiring of the factorization and the reading
+ *  ahead of the solve.
+ */
+void superlu_ooc_rewind(superlu_ooc_t *ooc)
+{
+    ooc->retired = ooc->dropped = 0;
+    ooc->ahead[0] = ooc->size; /* U-solve, from the end */
+    ooc->ahead[1] = 0;         /* L-solve, from the start */
+}
+
+/*! \brief The bytes of the slab before upto are no longer needed by the
+ *  factorization.
+ *
+ * <pre>
+ * The whole pages among them are queued for writing and unmapped, once
+ * OOC_BATCH bytes have accumulated or upto is the end of the slab. The
+ * pages retired by the previous call have been written meanwhile, and are
+ * dropped from the page cache. The data are kept: touching the pages
+ * again reads them back. upto = NULL stands for the end of the slab.
+ * </pre>
+ */
+void superlu_ooc_retire(superlu_ooc_t *ooc, void *upto)
+{
+#ifdef OOC_POSIX
+    size_t page = ooc_page(), end;
+
+    if ( !ooc->base ) return;
+    end = upto ? (size_t) ((char *) upto - ooc->base) : ooc->size;
+    end = end >= ooc->size ? ooc->size : end / page * page;
+    if ( end <= ooc->retired
+	 || (end < ooc->size && end - ooc->retired < OOC_BATCH) ) return;
+
+#if defined(__linux__) && defined(SYNC_FILE_RANGE_WRITE)
+    sync_file_range(ooc->fd, (off_t) ooc->retired,
+		    (off_t) (end - ooc->retired), SYNC_FILE_RANGE_WRITE);
+#endif
+    madvise(ooc->base + ooc->retired, end - ooc->retired, MADV_DONTNEED);
+#if defined(POSIX_FADV_DONTNEED)
+    if ( ooc->retired > ooc->dropped )
+	posix_fadvise(ooc->fd, (off_t) ooc->dropped,
+		      (off_t) (ooc->retired - ooc->dropped),
+		      POSIX_FADV_DONTNEED);
+#endif
+    ooc->dropped = ooc->retired;
+    ooc->retired = end;
+#endif
+}
+
+/*! \brief The solve is at the block starting at at: read the next window
+ *  ahead, forward (fwd = 1) or backward (fwd = 0).
+ *
+ * <pre>
+ * Nothing is read while at is at least half a window inside what was read
+ * ahead already. The reading is asynchronous.
+ * </pre>
+ */
+void superlu_ooc_ahead(superlu_ooc_t *ooc, void *at, int fwd)
+{
+#ifdef OOC_POSIX
+    size_t page = ooc_page(), pos, b, e;
+
+    if ( !ooc->base ) return;
+    pos = (size_t) ((char *) at - ooc->base);
+    if ( fwd ) {
+	if ( SUPERLU_MIN(pos + ooc->window / 2, ooc->size) <= ooc->ahead[1] )
+	    return;
+	b = SUPERLU_MAX(pos, ooc->ahead[1]);
+	e = SUPERLU_MIN(pos + ooc->window, ooc->size);
+	ooc->ahead[1] = e;
+    } else {
+	if ( !ooc->ahead[0] || pos >= ooc->ahead[0] + ooc->window / 2 )
+	    return;
+	b = pos > ooc->window ? pos - ooc->window : 0;
+	e = SUPERLU_MIN(ooc->ahead[0], pos + ooc->window);
+	ooc->ahead[0] = b;
+    }
+    b = b / page * page;
+    e = SUPERLU_MIN((e + page - 1) / page * page, ooc->size);
+    if ( e > b ) madvise(ooc->base + b, e - b, MADV_WILLNEED);
+#endif
+}
+
+/*! \brief Unmap the slab and give back the space of its file.
+ */
+void superlu_ooc_free(superlu_ooc_t *ooc)
+{
+#ifdef OOC_POSIX
+    if ( ooc->base ) munmap(ooc->base, ooc->size);
+    if ( ooc->fd >= 0 ) close(ooc->fd);
+#endif
+    ooc->base = NULL;
+    ooc->fd = -1;
+}
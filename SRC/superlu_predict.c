@@ -0,0 +1,382 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Prediction of the memory, flops and messages of the factorization
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * superlu_predict() walks the supernodal structure returned by the serial
+ * symbolic factorization (symbfact()) and deals it out to an nprow x npcol
+ * process grid the way pdistribute() does, block-cyclically. It returns
+ * for each process the bytes of its part of the L and U factors, of the
+ * solve trees, of the buffers of pdgstrf() (bigU, bigV and the look-ahead
+ * panels), of Linv and Uinv, and of the solve workspace, together with
+ * its factorization flops and the panel messages it sends.
+ *
+ * The grid does not have to be the one of the caller, nor to exist: the
+ * routine is local and can be called by one process for several grid
+ * shapes before the job is sized. The sizes follow the allocations of
+ * pddistribute(), pdgstrf() and pdgstrs(); the small per-supernode
+ * arrays and the communication library are not counted.
+ * </pre>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "superlu_defs.h"
+
+#define CACHELINE  64   /* bytes, as in pdgstrf() */
+#define TREE_BYTES 256  /* fixed part of one broadcast or reduction tree */
+
+/*! \brief Add a solve tree over cnt processes to each of its members.
+ */
+static void predict_tree(int cnt, int *member, superlu_predict_t *pred)
+{
+    int i;
+    if ( cnt < 2 ) return; /* no messages, no tree */
+    for (i = 0; i < cnt; ++i)
+	pred[member[i]].mem_trees += TREE_BYTES + (double) cnt * sizeof(int);
+}
+
+/*! \brief Predict the memory, flops and messages of each process.
+ *
+ * <pre>
+ * Arguments
+ * =========
+ * options (input) superlu_dist_options_t*
+ *         num_lookaheads, DiagInv, DiagInv_MinSize and DiagInv_MaxSize
+ *         are used.
+ * n       (input) int_t
+ *         The order of the matrix.
+ * Glu_persist, Glu_freeable (input)
+ *         The supernodes and the structure of L and U from symbfact().
+ * nprow, npcol (input) int
+ *         The shape of the process grid.
+ * nthreads (input) int
+ *         The number of OpenMP threads per process.
+ * dsize   (input) int
+ *         The size of one entry of the factors, e.g. sizeof(double).
+ * pred    (output) superlu_predict_t*, of length nprow*npcol
+ *         pred[PNUM(i,j)] is the prediction of process (i,j).
+ * </pre>
+ */
+void superlu_predict(superlu_dist_options_t *options, int_t n,
+		     Glu_persist_t *Glu_persist, Glu_freeable_t *Glu_freeable,
+		     int nprow, int npcol, int nthreads, int dsize,
+		     superlu_predict_t *pred)
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *lsub = Glu_freeable->lsub, *xlsub = Glu_freeable->xlsub;
+    int_t *usub = Glu_freeable->usub, *xusub = Glu_freeable->xusub;
+    int_t nsupers = supno[n-1] + 1;
+    int_t i, j, k, kb, kj, b, nsupc, fsupc, len, ldt;
+    int_t *mark, *fill, *ubptr, *ubsup, *ubnnz, *ubncol, *ubldu, *lbptr, *lbsup;
+    int_t *Lrows, *Lblks, *Unnz, *Uncol, *Uldu, *Uidx, *prmark, *pcmark;
+    int_t *max_row_size, *max_ldu, *max_ncols, *ldalsum, *nlb, bufmax[4];
+    int *member, P = nprow * npcol, p, pr, pc, prk, pck, cnt, nd;
+    int iword = sizeof(int_t);
+    double bytes, bigu, bigv;
+
+    memset(pred, 0, P * sizeof(superlu_predict_t));
+    if ( n <= 0 ) return;
+    ldt = sp_ienv_dist(3);
+    if ( nthreads < 1 ) nthreads = 1;
+
+    if ( !(mark = intMalloc_dist(4 * nsupers + 2)) )
+	ABORT("Malloc fails for mark[].");
+    ubptr = mark + nsupers;
+    lbptr = ubptr + nsupers + 1;
+    fill = lbptr + nsupers + 1;
+    if ( !(Lrows = intCalloc_dist(8 * (nprow + npcol))) )
+	ABORT("Malloc fails for Lrows[].");
+    Lblks = Lrows + nprow;
+    prmark = Lblks + nprow;
+    max_row_size = prmark + nprow;
+    nlb = max_row_size + nprow;
+    ldalsum = nlb + nprow;
+    Unnz = ldalsum + nprow;
+    Uncol = Unnz + npcol;
+    Uldu = Uncol + npcol;
+    Uidx = Uldu + npcol;
+    pcmark = Uidx + npcol;
+    max_ldu = pcmark + npcol;
+    max_ncols = max_ldu + npcol;
+    if ( !(member = SUPERLU_MALLOC(SUPERLU_MAX(nprow, npcol) * sizeof(int))) )
+	ABORT("Malloc fails for member[].");
+
+    /* Blocks of U by block row: U(kb,kj) has ubnnz entries in ubncol
+       nonzero columns, of segments of at most ubldu rows. The segments of
+       a column of U start at the rows in usub[] and end with their
+       supernode. */
+    for (k = 0; k <= nsupers; ++k) ubptr[k] = 0;
+    for (k = 0; k < nsupers; ++k) mark[k] = EMPTY;
+    for (j = 0; j < n; ++j) {
+	kj = supno[j];
+	for (i = xusub[j]; i < xusub[j+1]; ++i) {
+	    kb = supno[usub[i]];
+	    if ( kb < kj && mark[kb] != kj ) { mark[kb] = kj; ++ubptr[kb+1]; }
+	}
+    }
+    for (k = 0; k < nsupers; ++k) ubptr[k+1] += ubptr[k];
+    len = SUPERLU_MAX(ubptr[nsupers], 1);
+    if ( !(ubsup = intMalloc_dist(4 * len)) )
+	ABORT("Malloc fails for ubsup[].");
+    ubnnz = ubsup + len;
+    ubncol = ubnnz + len;
+    ubldu = ubncol + len;
+    for (k = 0; k < nsupers; ++k) fill[k] = ubptr[k];
+    for (k = 0; k < nsupers; ++k) mark[k] = EMPTY;
+    for (j = 0; j < n; ++j) {
+	kj = supno[j];
+	for (i = xusub[j]; i < xusub[j+1]; ++i) {
+	    kb = supno[usub[i]];
+	    if ( kb >= kj ) continue;
+	    if ( mark[kb] != kj ) {
+		mark[kb] = kj;
+		b = fill[kb]++;
+		ubsup[b] = kj;
+		ubnnz[b] = ubncol[b] = ubldu[b] = 0;
+	    }
+	    b = fill[kb] - 1;
+	    len = xsup[kb+1] - usub[i];
+	    ubnnz[b] += len;
+	    ++ubncol[b];
+	    ubldu[b] = SUPERLU_MAX(ubldu[b], len);
+	}
+    }
+
+    /* Blocks of L below the diagonal by block row. */
+    for (k = 0; k <= nsupers; ++k) lbptr[k] = 0;
+    for (k = 0; k < nsupers; ++k) mark[k] = EMPTY;
+    for (k = 0; k < nsupers; ++k) {
+	fsupc = xsup[k];
+	for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
+	    kb = supno[lsub[i]];
+	    if ( kb > k && mark[kb] != k ) { mark[kb] = k; ++lbptr[kb+1]; }
+	}
+    }
+    for (k = 0; k < nsupers; ++k) lbptr[k+1] += lbptr[k];
+    if ( !(lbsup = intMalloc_dist(SUPERLU_MAX(lbptr[nsupers], 1))) )
+	ABORT("Malloc fails for lbsup[].");
+    for (k = 0; k < nsupers; ++k) fill[k] = lbptr[k];
+    for (k = 0; k < nsupers; ++k) mark[k] = EMPTY;
+    for (k = 0; k < nsupers; ++k) {
+	fsupc = xsup[k];
+	for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
+	    kb = supno[lsub[i]];
+	    if ( kb > k && mark[kb] != k ) { mark[kb] = k; lbsup[fill[kb]++] = k; }
+	}
+    }
+
+    /* Block rows of each process row, for the solve workspace. */
+    for (k = 0; k < nsupers; ++k) {
+	pr = k % nprow;
+	ldalsum[pr] += xsup[k+1] - xsup[k];
+	++nlb[pr];
+    }
+    for (i = 0; i < 4; ++i) bufmax[i] = 0;
+    for (pr = 0; pr < nprow; ++pr) prmark[pr] = EMPTY;
+    for (pc = 0; pc < npcol; ++pc) pcmark[pc] = EMPTY;
+    for (k = 0; k < nsupers; ++k) mark[k] = EMPTY;
+
+    for (k = 0; k < nsupers; ++k) {
+	fsupc = xsup[k];
+	nsupc = xsup[k+1] - fsupc;
+	prk = k % nprow;
+	pck = k % npcol;
+
+	/* L(:,k) on each process row, the diagonal block included. */
+	for (pr = 0; pr < nprow; ++pr) Lrows[pr] = Lblks[pr] = 0;
+	for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
+	    kb = supno[lsub[i]];
+	    pr = kb % nprow;
+	    ++Lrows[pr];
+	    if ( mark[kb] != k ) { mark[kb] = k; ++Lblks[pr]; }
+	}
+
+	/* U(k,:) on each process column. */
+	for (pc = 0; pc < npcol; ++pc) Unnz[pc] = Uncol[pc] = Uldu[pc] = Uidx[pc] = 0;
+	for (b = ubptr[k]; b < ubptr[k+1]; ++b) {
+	    kj = ubsup[b];
+	    pc = kj % npcol;
+	    Unnz[pc] += ubnnz[b];
+	    Uncol[pc] += ubncol[b];
+	    Uldu[pc] = SUPERLU_MAX(Uldu[pc], ubldu[b]);
+	    Uidx[pc] += UB_DESCRIPTOR + xsup[kj+1] - xsup[kj];
+	}
+
+	/* Factors and the look-ahead panels. */
+	for (pr = 0; pr < nprow; ++pr) {
+	    if ( !Lrows[pr] ) continue;
+	    p = pr * npcol + pck;
+	    len = Lrows[pr] + BC_HEADER + Lblks[pr] * LB_DESCRIPTOR;
+	    pred[p].mem_L += (double) Lrows[pr] * nsupc * dsize
+		+ (double) (len + 3 * Lblks[pr]) * iword;
+	    bufmax[0] = SUPERLU_MAX(bufmax[0], len);
+	    bufmax[1] = SUPERLU_MAX(bufmax[1], Lrows[pr] * nsupc);
+	    max_row_size[pr] = SUPERLU_MAX(max_row_size[pr], Lrows[pr]);
+	}
+	for (pc = 0; pc < npcol; ++pc) {
+	    if ( !Unnz[pc] ) continue;
+	    p = prk * npcol + pc;
+	    pred[p].mem_U += (double) Unnz[pc] * dsize
+		+ (double) (Uidx[pc] + BR_HEADER) * iword;
+	    bufmax[2] = SUPERLU_MAX(bufmax[2], Uidx[pc] + BR_HEADER);
+	    bufmax[3] = SUPERLU_MAX(bufmax[3], Unnz[pc]);
+	    max_ldu[pc] = SUPERLU_MAX(max_ldu[pc], Uldu[pc]);
+	    max_ncols[pc] = SUPERLU_MAX(max_ncols[pc], Uncol[pc]);
+	}
+	if ( options->DiagInv == YES && nsupc >= options->DiagInv_MinSize
+	     && (options->DiagInv_MaxSize <= 0
+		 || nsupc <= options->DiagInv_MaxSize) )
+	    pred[prk * npcol + pck].mem_inv += 2.0 * nsupc * nsupc * dsize;
+
+	/* Flops: the diagonal block, the two panels, the Schur complement
+	   update. Lrows[prk] is made the number of rows below the diagonal
+	   block from here on. */
+	Lrows[prk] -= nsupc;
+	pred[prk * npcol + pck].flops += 2.0 / 3.0 * nsupc * nsupc * nsupc;
+	for (pr = 0; pr < nprow; ++pr)
+	    pred[pr * npcol + pck].flops += (double) Lrows[pr] * nsupc * nsupc;
+	for (pc = 0; pc < npcol; ++pc)
+	    pred[prk * npcol + pc].flops += (double) Unnz[pc] * nsupc;
+	for (pr = 0; pr < nprow; ++pr) {
+	    if ( !Lrows[pr] ) continue;
+	    for (pc = 0; pc < npcol; ++pc)
+		pred[pr * npcol + pc].flops += 2.0 * Lrows[pr] * Unnz[pc];
+	}
+
+	/* Messages: L(:,k) along the process rows to the columns of U(k,:),
+	   U(k,:) down the process columns to the rows of L(:,k). */
+	for (nd = 0, pc = 0; pc < npcol; ++pc) if ( pc != pck && Unnz[pc] ) ++nd;
+	for (pr = 0; pr < nprow && nd; ++pr) {
+	    len = Lrows[pr] + (pr == prk ? nsupc : 0);
+	    if ( !len ) continue;
+	    p = pr * npcol + pck;
+	    bytes = (double) len * nsupc * dsize
+		+ (double) (len + BC_HEADER + Lblks[pr] * LB_DESCRIPTOR) * iword;
+	    pred[p].msgs += nd;
+	    pred[p].msg_bytes += nd * bytes;
+	}
+	for (nd = 0, pr = 0; pr < nprow; ++pr) if ( pr != prk && Lrows[pr] ) ++nd;
+	for (pc = 0; pc < npcol && nd; ++pc) {
+	    if ( !Unnz[pc] ) continue;
+	    p = prk * npcol + pc;
+	    bytes = (double) Unnz[pc] * dsize
+		+ (double) (Uidx[pc] + BR_HEADER) * iword;
+	    pred[p].msgs += nd;
+	    pred[p].msg_bytes += nd * bytes;
+	}
+
+	/* Solve trees: the broadcasts of X[k] down the process column to
+	   the rows of L(:,k) and U(:,k), the reductions of lsum[k] along
+	   the process row from the columns of L(k,:) and U(k,:). */
+	for (cnt = 0, pr = 0; pr < nprow; ++pr)
+	    if ( pr == prk || Lrows[pr] ) member[cnt++] = pr * npcol + pck;
+	predict_tree(cnt, member, pred);
+
+	member[0] = prk * npcol + pck;
+	prmark[prk] = k;
+	for (cnt = 1, j = fsupc; j < xsup[k+1]; ++j)
+	    for (i = xusub[j]; i < xusub[j+1]; ++i) {
+		kb = supno[usub[i]];
+		pr = kb % nprow;
+		if ( kb < k && prmark[pr] != k ) {
+		    prmark[pr] = k;
+		    member[cnt++] = pr * npcol + pck;
+		}
+	    }
+	predict_tree(cnt, member, pred);
+
+	member[0] = prk * npcol + pck;
+	pcmark[pck] = k;
+	for (cnt = 1, b = lbptr[k]; b < lbptr[k+1]; ++b) {
+	    pc = lbsup[b] % npcol;
+	    if ( pcmark[pc] != k ) {
+		pcmark[pc] = k;
+		member[cnt++] = prk * npcol + pc;
+	    }
+	}
+	predict_tree(cnt, member, pred);
+
+	for (cnt = 0, pc = 0; pc < npcol; ++pc)
+	    if ( pc == pck || Unnz[pc] ) member[cnt++] = prk * npcol + pc;
+	predict_tree(cnt, member, pred);
+    }
+
+    /* Buffers of pdgstrf(), solve workspace of pdgstrs() for one
+       right-hand side, and the peak: the buffers are freed before the
+       first solve, which computes Linv and Uinv. */
+    for (pr = 0; pr < nprow; ++pr)
+	for (pc = 0; pc < npcol; ++pc) {
+	    p = pr * npcol + pc;
+	    bigu = (double) max_ldu[pc] * max_ncols[pc];
+	    bigv = SUPERLU_MAX((double) max_row_size[pr] * max_ncols[pc],
+			       (double) (ldt * ldt + CACHELINE / dsize) * nthreads);
+	    pred[p].mem_buffers = (bigu + bigv) * dsize
+		+ (options->num_lookaheads + 1.0)
+		* ((double) (bufmax[0] + bufmax[2]) * iword
+		   + (double) (bufmax[1] + bufmax[3]) * dsize);
+	    pred[p].mem_solve = (1.0 + nthreads) * dsize
+		* (ldalsum[pr] + (double) nlb[pr] * SUPERLU_MAX(XK_H, LSUM_H));
+	    pred[p].mem_peak = pred[p].mem_L + pred[p].mem_U + pred[p].mem_trees
+		+ SUPERLU_MAX(pred[p].mem_buffers,
+			      pred[p].mem_inv + pred[p].mem_solve);
+	}
+
+    SUPERLU_FREE(mark);
+    SUPERLU_FREE(ubsup);
+    SUPERLU_FREE(lbsup);
+    SUPERLU_FREE(Lrows);
+    SUPERLU_FREE(member);
+}
+
+static void predict_fields(superlu_predict_t *pred, double *v)
+{
+    v[0] = pred->mem_L;       v[1] = pred->mem_U;
+    v[2] = pred->mem_trees;   v[3] = pred->mem_buffers;
+    v[4] = pred->mem_inv;     v[5] = pred->mem_solve;
+    v[6] = pred->mem_peak;    v[7] = pred->flops;
+    v[8] = pred->msgs;        v[9] = pred->msg_bytes;
+}
+
+/*! \brief Print the largest and the average prediction over the processes.
+ */
+void superlu_predict_print(int nprow, int npcol, superlu_predict_t *pred)
+{
+    static const char *name[] = {
+	"L factor", "U factor", "trees", "buffers", "Linv+Uinv", "solve",
+	"peak", "flops", "msgs", "msg bytes"
+    };
+    int P = nprow * npcol, p, i, imax = 0;
+    double v[10], vmax, sum;
+
+    printf(".. Predicted for a %d x %d grid (MB, max and average):\n",
+	   nprow, npcol);
+    for (i = 0; i < 10; ++i) {
+	vmax = sum = 0.0;
+	for (p = 0; p < P; ++p) {
+	    predict_fields(&pred[p], v);
+	    sum += v[i];
+	    if ( v[i] > vmax ) { vmax = v[i]; if ( i == 6 ) imax = p; }
+	}
+	if ( i < 7 )
+	    printf("\t%-10s %12.2f %12.2f\n", name[i], vmax * 1e-6,
+		   sum * 1e-6 / P);
+	else
+	    printf("\t%-10s %12.4e %12.4e\n", name[i], vmax, sum / P);
+    }
+    printf("\tlargest peak on process %d\n", imax);
+    fflush(stdout);
+}
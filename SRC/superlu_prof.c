@@ -0,0 +1,65 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief User callbacks at the beginning and end of the phases
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * A profiler or telemetry layer (NVTX, Caliper, TAU, ...) registers two
+ * functions with superlu_prof_register(); PxGSSVX, PxGSTRF, PxGSTRS and
+ * PxGSRFS then call them when each phase of ProfPhaseType begins and
+ * ends, with the supernode for the per-step phases of the factorization
+ * and EMPTY otherwise. The phases nest, and the calls are made by the
+ * master thread outside the parallel regions. For example, with NVTX:
+ *
+ *     static void begin(int phase, int_t k, void *data)
+ *     { nvtxRangePushA(superlu_prof_name(phase)); }
+ *     static void end(int phase, int_t k, void *data)
+ *     { nvtxRangePop(); }
+ *     ...
+ *     superlu_prof_register(begin, end, NULL);
+ *
+ * When nothing is registered, each hook costs one test of a pointer, see
+ * SUPERLU_PROF_BEGIN() and SUPERLU_PROF_END().
+ * </pre>
+ */
+
+#include "superlu_defs.h"
+
+superlu_prof_hook_t superlu_prof_begin_hook = NULL;
+superlu_prof_hook_t superlu_prof_end_hook = NULL;
+void *superlu_prof_data = NULL;
+
+/*! \brief Register the callbacks of all the phases; NULL, NULL removes
+ *  them. data is passed to each call.
+ */
+void superlu_prof_register(superlu_prof_hook_t begin, superlu_prof_hook_t end,
+			   void *data)
+{
+    superlu_prof_data = data;
+    superlu_prof_begin_hook = begin;
+    superlu_prof_end_hook = end;
+}
+
+/*! \brief Return the name of phase (a ProfPhaseType).
+ */
+const char *superlu_prof_name(int phase)
+{
+    static const char *name[NPROF_PHASES] = {
+	"superlu:analysis", "superlu:distribute", "superlu:factor",
+	"superlu:step", "superlu:schur", "superlu:solve", "superlu:lsolve",
+	"superlu:usolve", "superlu:refine"
+    };
+    return ( phase >= 0 && phase < NPROF_PHASES ) ? name[phase] : "superlu";
+}
@@ -0,0 +1,116 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Communication progress thread of the factorization and solve
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Most MPI libraries move the data of a nonblocking message only when the
+ * process calls MPI: a panel of pdgstrf() sent with MPI_Isend(), too large
+ * to go eagerly, waits for the receiver's rendezvous answer to be noticed,
+ * which happens at the next MPI_Test() or MPI_Wait() of the sender, after
+ * the Schur complement update at hand. The same holds for the messages
+ * forwarded by the trees of pdgstrs() while the threads solve.
+ *
+ * Setting the environment variable SUPERLU_PROGRESS to a number of
+ * microseconds, e.g.
+ *
+ *     export SUPERLU_PROGRESS=20
+ *
+ * starts a thread during the factorization and the solve which calls
+ * MPI_Iprobe() on MPI_COMM_SELF at that interval. The call touches no
+ * message of SuperLU, but drives the progress engine of the library, so
+ * that the outstanding sends and receives move on while the other threads
+ * compute. This needs MPI to be initialized with MPI_THREAD_MULTIPLE;
+ * otherwise nothing is started. The thread mostly sleeps, but it should
+ * be left a core, e.g. with one OpenMP thread less per process.
+ * </pre>
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include "superlu_defs.h"
+
+struct superlu_progress_s {
+    pthread_t       tid;
+    pthread_mutex_t lock;
+    int             stop;
+    long            usec;     /* between two polls */
+};
+
+static void *superlu_progress_main(void *arg)
+{
+    superlu_progress_t *pg = (superlu_progress_t *) arg;
+    struct timespec ts;
+    int flag, stop = 0;
+
+    ts.tv_sec = pg->usec / 1000000;
+    ts.tv_nsec = (pg->usec % 1000000) * 1000;
+    while ( !stop ) {
+	MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_SELF, &flag,
+		   MPI_STATUS_IGNORE);
+	nanosleep(&ts, NULL);
+	pthread_mutex_lock(&pg->lock);
+	stop = pg->stop;
+	pthread_mutex_unlock(&pg->lock);
+    }
+    return NULL;
+}
+
+/*! \brief Start the progress thread if SUPERLU_PROGRESS is set.
+ *
+ * <pre>
+ * Returns the handle to pass to superlu_progress_stop(), or NULL if no
+ * thread is started: SUPERLU_PROGRESS is not set, grid has one process,
+ * MPI is not initialized with MPI_THREAD_MULTIPLE, or the thread cannot
+ * be created. Local to the process.
+ * </pre>
+ */
+superlu_progress_t *superlu_progress_start(gridinfo_t *grid)
+{
+    superlu_progress_t *pg;
+    char *ttemp = getenv("SUPERLU_PROGRESS");
+    int provided;
+
+    if ( !ttemp || atol(ttemp) <= 0 ) return NULL;
+    if ( grid->nprow * grid->npcol == 1 ) return NULL;
+    MPI_Query_thread(&provided);
+    if ( provided != MPI_THREAD_MULTIPLE ) return NULL;
+
+    if ( !(pg = (superlu_progress_t *)
+	   SUPERLU_MALLOC(sizeof(superlu_progress_t))) )
+	ABORT("Malloc fails for pg.");
+    pg->stop = 0;
+    pg->usec = atol(ttemp);
+    pthread_mutex_init(&pg->lock, NULL);
+    if ( pthread_create(&pg->tid, NULL, superlu_progress_main, pg) ) {
+	pthread_mutex_destroy(&pg->lock);
+	SUPERLU_FREE(pg);
+	return NULL;
+    }
+    return pg;
+}
+
+/*! \brief Stop the thread started by superlu_progress_start(), if any. */
+void superlu_progress_stop(superlu_progress_t *pg)
+{
+    if ( !pg ) return;
+    pthread_mutex_lock(&pg->lock);
+    pg->stop = 1;
+    pthread_mutex_unlock(&pg->lock);
+    pthread_join(pg->tid, NULL);
+    pthread_mutex_destroy(&pg->lock);
+    SUPERLU_FREE(pg);
+}
@@ -0,0 +1,1460 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief  Distributed SuperLU data types and function prototypes
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 7.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley,
+ * Georgia Institute of Technology
+ * November 1, 2007
+ * April 5, 2015
+ * September 18, 2018  version 6.0
+ * February 8, 2019  version 6.1.1
+ * May 10, 2019 version 7.0.0
+ * </pre>
+ */
+
+#ifndef __SUPERLU_SDEFS /* allow multiple inclusions */
+#define __SUPERLU_SDEFS
+
+/*
+ * File name:	superlu_sdefs.h
+ * Purpose:     Distributed SuperLU data types and function prototypes
+ * History:
+ */
+
+#include "superlu_defs.h"
+
+/* 
+ *-- The structure used to store matrix A of the linear system and
+ *   several vectors describing the transformations done to matrix A.
+ *
+ * A      (SuperMatrix*)
+ *        Matrix A in A*X=B, of dimension (A->nrow, A->ncol).
+ *        The number of linear equations is A->nrow. The type of A can be:
+ *        Stype = SLU_NC; Dtype = SLU_S; Mtype = SLU_GE.
+ *         
+ * DiagScale  (DiagScale_t)
+ *        Specifies the form of equilibration that was done.
+ *        = NOEQUIL: No equilibration.
+ *        = ROW:  Row equilibration, i.e., A was premultiplied by diag(R).
+ *        = COL:  Column equilibration, i.e., A was postmultiplied by diag(C).
+ *        = BOTH: Both row and column equilibration, i.e., A was replaced 
+ *                 by diag(R)*A*diag(C).
+ *
+ * R      float*, dimension (A->nrow)
+ *        The row scale factors for A.
+ *        If DiagScale = ROW or BOTH, A is multiplied on the left by diag(R).
+ *        If DiagScale = NOEQUIL or COL, R is not defined.
+ *
+ * C      float*, dimension (A->ncol)
+ *        The column scale factors for A.
+ *        If DiagScale = COL or BOTH, A is multiplied on the right by diag(C).
+ *        If DiagScale = NOEQUIL or ROW, C is not defined.
+ *         
+ * perm_r (int*) dimension (A->nrow)
+ *        Row permutation vector which defines the permutation matrix Pr,
+ *        perm_r[i] = j means row i of A is in position j in Pr*A.
+ *
+ * perm_c (int*) dimension (A->ncol)
+ *	  Column permutation vector, which defines the 
+ *        permutation matrix Pc; perm_c[i] = j means column i of A is 
+ *        in position j in A*Pc.
+ *
+ */
+typedef struct {
+    DiagScale_t DiagScale;
+    float *R;
+    float *C; 
+    int_t  *perm_r;
+    int_t  *perm_c;
+} sScalePermstruct_t;
+
+#if 0 // Sherry: move to superlu_defs.h 
+/*-- Auxiliary data type used in PxGSTRS/PxGSTRS1. */
+typedef struct {
+    int_t lbnum;  /* Row block number (local).      */
+    int_t indpos; /* Starting position in Uindex[]. */
+} Ucb_indptr_t;
+#endif
+
+/*
+ * Where the entries of the distributed A go in L and U. Recorded by
+ * psdistribute() at the first refactorization with
+ * Fact = SamePattern_SameRowPerm, and used by the following ones to
+ * move the new values of A into L and U without any index computation.
+ */
+typedef struct {
+    int_t  nnz_loc;     /* number of entries of the local A              */
+    int_t  nlocal;      /* of which stay on this process                 */
+    int_t  nrecv;       /* number of entries of A put in my L and U      */
+    int_t  *send_slot;  /* position of A's entry k in sendbuf[]          */
+    int    *sendcnt, *sdispls, *recvcnt, *rdispls; /* for MPI_Alltoallv  */
+    float **dst;        /* where received entry i goes; NULL if dropped  */
+    int    *dst_sn;     /* the supernode of the panel of dst[i]          */
+    float *sendbuf;     /* size nnz_loc, the nlocal ones first           */
+    float *recvbuf;     /* size nrecv - nlocal, the remote entries       */
+} sAmap_t;
+
+/*
+ * On each processor, the blocks in L are stored in compressed block
+ * column format, the blocks in U are stored in compressed block row format.
+ */
+#define MAX_LOOKAHEADS 50
+typedef struct {
+    int_t   **Lrowind_bc_ptr; /* size ceil(NSUPERS/Pc)                 */
+    float **Lnzval_bc_ptr;  /* size ceil(NSUPERS/Pc)                 */
+    float **Linv_bc_ptr;  /* size ceil(NSUPERS/Pc)                 */
+    int_t   **Lindval_loc_bc_ptr; /* size ceil(NSUPERS/Pc)  pointers to locations in Lrowind_bc_ptr and Lnzval_bc_ptr */
+    int_t   *Unnz; /* number of nonzeros per block column in U*/
+	int_t   **Lrowind_bc_2_lsum; /* size ceil(NSUPERS/Pc)  map indices of Lrowind_bc_ptr to indices of lsum  */
+    float  **Uinv_bc_ptr;  /* size ceil(NSUPERS/Pc)     	*/
+    int_t   **Ufstnz_br_ptr;  /* size ceil(NSUPERS/Pr)                 */
+    float  **Unzval_br_ptr;  /* size ceil(NSUPERS/Pr)                 */
+        /*-- Data structures used for broadcast and reduction trees. --*/
+    BcTree  *LBtree_ptr;       /* size ceil(NSUPERS/Pc)                */
+    RdTree  *LRtree_ptr;       /* size ceil(NSUPERS/Pr)                */
+    BcTree  *UBtree_ptr;       /* size ceil(NSUPERS/Pc)                */
+    RdTree  *URtree_ptr;       /* size ceil(NSUPERS/Pr)			*/
+#if 0
+    int_t   *Lsub_buf;        /* Buffer for the remote subscripts of L */
+    float  *Lval_buf;        /* Buffer for the remote nonzeros of L   */
+    int_t   *Usub_buf;        /* Buffer for the remote subscripts of U */
+    float  *Uval_buf;        /* Buffer for the remote nonzeros of U   */
+#endif
+    int_t   *Lsub_buf_2[MAX_LOOKAHEADS];   /* Buffers for the remote subscripts of L*/
+    float  *Lval_buf_2[MAX_LOOKAHEADS];   /* Buffers for the remote nonzeros of L  */
+    int_t   *Usub_buf_2[MAX_LOOKAHEADS];   /* Buffer for the remote subscripts of U */
+    float  *Uval_buf_2[MAX_LOOKAHEADS];   /* Buffer for the remote nonzeros of U   */
+    float  *ujrow;           /* used in panel factorization.          */
+    int_t   bufmax[NBUFFERS]; /* Maximum buffer size across all MPI ranks:
+			       *  0 : maximum size of Lsub_buf[]
+			       *  1 : maximum size of Lval_buf[]
+			       *  2 : maximum size of Usub_buf[]
+			       *  3 : maximum size of Uval_buf[]
+			       *  4 : maximum size of tempv[LDA]
+			       */
+
+    /*-- Record communication schedule for factorization. --*/
+    int   *ToRecv;          /* Recv from no one (0), left (1), and up (2).*/
+    int   *ToSendD;         /* Whether need to send down block row.       */
+    int   **ToSendR;        /* List of processes to send right block col. */
+
+    /*-- Record communication schedule for forward/back solves. --*/
+    int_t   *fmod;            /* Modification count for L-solve            */
+    int_t   **fsendx_plist;   /* Column process list to send down Xk       */
+    int_t   *frecv;           /* Modifications to be recv'd in proc row    */
+    int_t   nfrecvx;          /* Number of Xk I will receive in L-solve    */
+    int_t   nfsendx;          /* Number of Xk I will send in L-solve       */
+    int_t   *bmod;            /* Modification count for U-solve            */
+    int_t   **bsendx_plist;   /* Column process list to send down Xk       */
+    int_t   *brecv;           /* Modifications to be recv'd in proc row    */
+    int_t   nbrecvx;          /* Number of Xk I will receive in U-solve    */
+    int_t   nbsendx;          /* Number of Xk I will send in U-solve       */
+    int_t   *mod_bit;         /* Flag contribution from each row blocks    */
+
+    /*-- Auxiliary arrays used for forward/back solves. --*/
+    int_t   *ilsum;           /* Starting position of each supernode in lsum
+				 (local)  */
+    int_t   ldalsum;          /* LDA of lsum (local) */
+    int_t   SolveMsgSent;     /* Number of actual messages sent in LU-solve */
+    int_t   SolveMsgVol;      /* Volume of messages sent in the solve phase */
+
+
+    /*********************/
+    /* The following variables are used in the hybrid solver */
+
+    /*-- Counts to be used in U^{-T} triangular solve. -- */
+    int_t UT_SOLVE;
+    int_t L_SOLVE;
+    int_t FRECV;
+    int_t ut_ldalsum;        /* LDA of lsum (local) */
+    int_t *ut_ilsum;         /* ilsum in column-wise                        */
+    int_t *utmod;            /* Modification count for Ut-solve.            */
+    int_t **ut_sendx_plist;  /* Row process list to send down Xk            */
+    int_t *utrecv;           /* Modifications to be recev'd in proc column. */
+    int_t n_utsendx;         /* Number of Xk I will receive                 */
+    int_t n_utrecvx;         /* Number of Xk I will send                    */
+    int_t n_utrecvmod;
+    int_t nroot;
+    int_t *ut_modbit;
+    int_t *Urbs;
+    Ucb_indptr_t **Ucb_indptr;/* Vertical linked list pointing to Uindex[] */
+    int_t  **Ucb_valptr;      /* Vertical linked list pointing to Unzval[] */
+
+    /* some additional counters for L solve */
+    int_t n;
+    int_t nleaf;
+    int_t nfrecvmod;
+    int_t inv; /* whether the diagonal block is inverted*/
+    int   inv_minsize, inv_maxsize; /* sizes of the supernodes inverted,
+					see options->DiagInv_MinSize */
+    int   inv_pending; /* psgstrs() computes the inverses first */
+    double inv_budget; /* megabytes for the factors and the inverses,
+			  0 for no limit, see options->MemBudget */
+    double *sol_tdone; /* when X[k] is solved, set by psgstrs(); NULL
+			  if not measured, see options->Solve_CritPath */
+    int   lsum_shared; /* the threads of psgstrs() share lsum[], 0 if
+			  each has its own copy, see LSUM_COPY() */
+    int_t fixed_order; /* solve in a fixed summation order, see
+			  options->Reproducible */
+    sAmap_t *Amap; /* see psdistribute(); NULL until recorded */
+    double *sn_cost; /* measured cost of each supernode in the last
+			factorization, used by the static schedule of the
+			next one; NULL if not recorded, see superlu_sncost.c */
+    char *sn_dirty; /* the supernodes refactored by psgsrefactor_partial(),
+		       the others keep their factors; NULL for all */
+    int_t *Acolind; /* column indices of A permuted by columns, in the
+		       order of its entries, kept by psgssvx() for
+		       psgsrefactor(); NULL if not kept */
+    float *Lnzval_slab, *Unzval_slab; /* values of all the blocks of L or U,
+				      see psdistribute(); NULL if the
+				      blocks are allocated one by one */
+    int ooc; /* keep the slabs in files, see options->OutOfCore */
+    int release; /* no Amap, ToRecv etc. freed after the factorization,
+		    see options->ReleaseMemory */
+    int Udropped; /* the blocks of U off the diagonal are freed, U being
+		     diag(U)*L^T, see options->SymValues */
+    int compact; /* convert the factors at the next solve, see
+		    options->Solve_Compact */
+    float *solve_slab; /* L, the inverses of its diagonal blocks and U in
+		       the layout of the solves, see sCompact_LU(); NULL
+		       if not converted */
+    double droptol; /* threshold ILU, see options->ILU_DropTol */
+    superlu_ooc_t Lnzval_ooc, Unzval_ooc; /* the slabs in files; base is
+				      NULL if in memory */
+    superlu_treespec_t LBtree_spec, LRtree_spec, /* trees not created yet */
+		       UBtree_spec, URtree_spec; /* see sCreate_Trees()  */
+} sLocalLU_t;
+
+
+/*-- Product by the original matrix supplied by the user to the iterative
+ *   refinement, see LUstruct->matvec and pdgsrfs_matvec().
+ *
+ * apply(trans, abs, nrhs, x, ldx, y, ldy, data) computes y = op(A)*x, or
+ * y = abs(op(A))*x if abs is nonzero (x being then nonnegative), for the
+ * matrix A given to psgssvx() before scaling and permutation. Each process
+ * holds the rows fst_row:fst_row+m_loc-1 of x and y, as for A, and all the
+ * processes call apply() together. data is passed unchanged.
+ */
+typedef struct {
+    void (*apply)(trans_t trans, int abs, int nrhs, float *x, int_t ldx,
+		  float *y, int_t ldy, void *data);
+    void *data;
+} sMatvec_t;
+
+typedef struct {
+    int_t *etree;
+    Glu_persist_t *Glu_persist;
+    sLocalLU_t *Llu;
+    char dt;
+    void *dense;      /* dense factors of a small A, used when
+			 n <= options->Dense_MaxN (see psgsdense.c) */
+    superlu_symbfact_t *usymb; /* symbolic factorization supplied by the
+				  user, see options->UserSymbFact */
+    sMatvec_t *matvec; /* product by A in the refinement, in place of the
+			  distributed A; NULL to use A */
+} sLUstruct_t;
+
+
+/*-- Data structure for communication during matrix-vector multiplication. */
+typedef struct {
+    int_t *extern_start;
+    int_t *ind_tosend;    /* X indeices to be sent to other processes */
+    int_t *ind_torecv;    /* X indeices to be received from other processes */
+    int_t *ptr_ind_tosend;/* Printers to ind_tosend[] (Size procs)
+			     (also point to val_torecv) */
+    int_t *ptr_ind_torecv;/* Printers to ind_torecv[] (Size procs)
+			     (also point to val_tosend) */
+    int   *SendCounts;    /* Numbers of X indices to be sent
+			     (also numbers of X values to be received) */
+    int   *RecvCounts;    /* Numbers of X indices to be received
+			     (also numbers of X values to be sent) */
+    float *val_tosend;   /* X values to be sent to other processes */
+    float *val_torecv;   /* X values to be received from other processes */
+    int_t TotalIndSend;   /* Total number of indices to be sent
+			     (also total number of values to be received) */
+    int_t TotalValSend;   /* Total number of values to be sent.
+			     (also total number of indices to be received) */
+} psgsmv_comm_t;
+
+/*-- Workspace of psgstrs(), kept between the calls with the same nrhs --*/
+typedef struct {
+    int    nrhs, num_thread, maxrecvsz; /* the buffers are sized for these */
+    int    nrecvbuf;  /* slots of maxrecvsz in recvbuf */
+    int    root_size; /* and the root for this SOLVEstruct->root_size */
+    int_t  *fmod_init, *frecv_init; /* counts at the start of the L-solve */
+    int_t  *bmod_init, *brecv_init; /* counts at the start of the U-solve */
+    int_t  *fmod, *frecv, *bmod, *brecv; /* the counts altered by a solve */
+    int_t  *leafsups, *rootsups;    /* blocks solved first in the L- and U-solve */
+    int_t  nleaf, nroot, nfrecvmod, nbrecvmod;
+    int_t  *leaf_send, *root_send;
+    int_t  nlevels;   /* number of level sets of the threaded L-solve */
+    int_t  *lvlptr, *lvlsups; /* supernodes of level l in lvlsups[lvlptr[l]:
+				 lvlptr[l+1]-1]; NULL on more than 1 process */
+    int_t  *sparent;  /* supernodal etree, set up by the first pruned solve */
+    int    *active, *needed; /* supernodes of the pruned L- and U-solves */
+    int_t  *prunesups; /* leaves or roots of the pruned solves */
+    int_t  kroot;     /* supernodes kroot:nsupers-1 are solved on all the
+			 processes, kroot = nsupers if none */
+    float *rootLU;   /* their dense L\U, unit lower L, on all processes */
+    float *rootx;    /* their part of X */
+    double *tdone;    /* when X[k] is solved in the L-solve, tdone[0:nsupers-1],
+			 and in the U-solve; NULL if not measured */
+    int_t  *prio;     /* priorities of the L- and U-solve, see
+			 pxgstrs_priority(); NULL if not used */
+    int_t  sizelsum, sizertemp;
+    int    nlsum;     /* copies of lsum[]: num_thread, or 1 if shared */
+    int    lsum_shared; /* lsum[] is shared by the threads, see LSUM_COPY() */
+    float *lsum, *x, *rtemp, *recvbuf;
+    pxgstrs_agg_t *agg; /* small messages sent in packets, or NULL */
+    int    *plan;     /* messages by source of the L-solve, then of the
+			 U-solve, see pxgstrs_ring_init() */
+    SuperLUStat_t **stat_loc;
+} sgstrs_work_t;
+
+/*-- Data structure holding the information for the solution phase --*/
+typedef struct {
+    int_t *row_to_proc;
+    int_t *inv_perm_c;
+    int_t num_diag_procs, *diag_procs, *diag_len;
+    psgsmv_comm_t *gsmv_comm; /* communication metadata for SpMV,
+         	       		      required by IterRefine.          */
+    pxgstrs_comm_t *gstrs_comm;  /* communication metadata for SpTRSV. */
+    int_t *A_colind_gsmv; /* After psgsmv_init(), the global column
+                             indices of A are translated into the relative
+                             positions in the gathered x-vector.
+                             This is re-used in repeated calls to psgsmv() */
+    int_t *xrow_to_proc; /* used by PDSLin */
+    sgstrs_work_t *gstrs_work; /* set up by the first psgstrs() call */
+    yes_no_t sparse_rhs; /* prune the L-solve to the nonzeros of B,
+			    see options->SparseRHS */
+    int_t nout_rows, *out_rows; /* if out_rows is not NULL, psgstrs() only
+				   computes these rows of X, see psgstrs() */
+    yes_no_t x_layout; /* B of psgstrs() is in the solve layout, see
+			  psSolveLayout() */
+    int root_size; /* see options->Solve_RootSize */
+    yes_no_t crit_path; /* see options->Solve_CritPath */
+    yes_no_t priority; /* see options->Solve_Priority */
+    int rhs_tile; /* see options->Solve_RHSTile */
+    msg_prec_t refine_msg_prec; /* see options->Refine_MsgPrec */
+    msg_prec_t msg_prec; /* precision of the tree messages of psgstrs(),
+			    set by psgsrfs() for its corrections */
+} sSOLVEstruct_t;
+
+/*
+ * The selected inverse W = A1^{-T} computed by psSelInv(), in the layouts
+ * of the local blocks of L (Lnzval_bc_ptr) and U (Unzval_br_ptr).
+ */
+typedef struct {
+    float **Ainv_bc_ptr; /* Ainv_bc_ptr[lk] has the shape of Lnzval_bc_ptr[lk] */
+    float **Ainv_br_ptr; /* Ainv_br_ptr[lk] has the shape of Unzval_br_ptr[lk] */
+} sSelInvstruct_t;
+
+/*-- Handle of a call started by psgssvx_start() --*/
+typedef struct {
+    superlu_dist_options_t *options;
+    SuperMatrix *A;
+    sScalePermstruct_t *ScalePermstruct;
+    float *B;
+    int ldb, nrhs;
+    gridinfo_t *grid;
+    sLUstruct_t *LUstruct;
+    sSOLVEstruct_t *SOLVEstruct;
+    float *berr;
+    SuperLUStat_t *stat;
+    int *info;
+    void *thread;     /* progress thread; NULL once the call completed */
+} sgssvxRequest_t;
+
+/*-- Queue of right-hand sides for psgstrs_push() --*/
+typedef struct {
+    int_t m_loc, fst_row; /* local rows of B, as in psgstrs() */
+    int maxrhs;           /* capacity of the queue, in columns */
+    int nrhs;             /* number of queued columns */
+    int nbatch;           /* number of queued batches */
+    float *Q;             /* queued columns, m_loc-by-maxrhs */
+    float **Bptr;         /* where the solution of each batch goes */
+    int_t *ldb;           /* leading dimension of each batch */
+    int *ncol;            /* number of columns of each batch */
+} sRHSqueue_t;
+
+/*-- Triples being assembled into a distributed matrix, see psassemble.c --*/
+typedef struct {
+    int_t m, n;
+    int_t *start;         /* first row of each process, and m */
+    int_t nz, cap;        /* triples added, and room for */
+    int_t *row, *col;
+    float *val;
+    gridinfo_t *grid;
+} sAssembly_t;
+
+/*-- Batch of independent systems for psgssvx_batch() --*/
+typedef struct {
+    int nsys;             /* number of systems of the batch */
+    int ngroups;          /* number of process groups */
+    int group;            /* my group, -1 if idle */
+    int *sys_group;       /* sys_group[s] is the group of system s */
+    int nloc;             /* number of systems of my group */
+    int *loc;             /* loc[l] is the l-th system of my group */
+    gridinfo_t grid;      /* process grid of my group */
+    /* Kept between the calls, for each system of my group: */
+    superlu_dist_options_t *options;
+    sScalePermstruct_t *ScalePermstruct;
+    sLUstruct_t *LUstruct;
+    sSOLVEstruct_t *SOLVEstruct;
+    int_t *n;             /* order of the factored system, EMPTY if none */
+} sBatch_t;
+
+/*-- Low-rank update A + U*V^T of the factored A, see psgssmw_update() --*/
+typedef struct {
+    int k;                /* rank of the update so far */
+    int kmax;             /* beyond which A + U*V^T should be refactored */
+    int m_loc;            /* number of local rows of W and V */
+    float *W;             /* A^{-1}*U, local rows, leading dimension m_loc */
+    float *V;             /* V, local rows, leading dimension m_loc */
+    float *C;             /* LU of I + V^T*A^{-1}*U, k-by-k, on all processes */
+    int *ipiv;            /* pivots of C */
+} sSMW_t;
+
+#if 0 
+
+/*==== For 3D code ====*/
+
+// new structures for psgstrf_4_8 
+
+typedef struct
+{
+    int_t nub;
+    int_t klst;
+    int_t ldu;
+    int_t* usub;
+    float* uval;
+} uPanelInfo_t;
+
+typedef struct
+{
+    int_t *lsub;
+    float *lusup;
+    int_t luptr0;
+    int_t nlb;  //number of l blocks
+    int_t nsupr;
+} lPanelInfo_t;
+
+ 
+
+/* HyP_t is the data structure to assist HALO offload of Schur-complement. */
+typedef struct
+{
+    Remain_info_t *lookAhead_info, *Remain_info;
+    Ublock_info_t *Ublock_info, *Ublock_info_Phi;
+    
+    int_t first_l_block_acc , first_u_block_acc;
+    int_t last_offload ;
+    int_t *Lblock_dirty_bit, * Ublock_dirty_bit;
+    float *lookAhead_L_buff, *Remain_L_buff;
+    int_t lookAheadBlk;  /* number of blocks in look-ahead window */
+    int_t RemainBlk ;    /* number of blocks outside look-ahead window */
+    int_t  num_look_aheads, nsupers;
+    int_t ldu, ldu_Phi;
+    int_t num_u_blks, num_u_blks_Phi;
+
+    int_t jj_cpu;
+    float *bigU_Phi;
+    float *bigU_host;
+    int_t Lnbrow;
+    int_t Rnbrow;
+
+    int_t buffer_size;
+    int_t bigu_size;
+    int_t offloadCondition;
+    int_t superlu_acc_offload;
+    int_t nCudaStreams;
+} HyP_t;
+
+typedef struct 
+{
+    int_t * Lsub_buf ;
+    float * Lval_buf ;
+    int_t * Usub_buf ;
+    float * Uval_buf ;
+} sLUValSubBuf_t;
+
+int_t scuStatUpdate(
+    int_t knsupc,
+    HyP_t* HyP, 
+    SCT_t* SCT,
+    SuperLUStat_t *stat
+    );
+
+typedef struct
+{
+    gEtreeInfo_t gEtreeInfo;
+    int_t* iperm_c_supno;
+    int_t* myNodeCount;
+    int_t* myTreeIdxs;
+    int_t* myZeroTrIdxs;
+    int_t** treePerm;
+    sForest_t** sForests;
+    int_t* supernode2treeMap;
+    sLUValSubBuf_t  *LUvsb;
+} trf3Dpartition_t;
+
+typedef struct
+{
+    float *bigU;
+    float *bigV;
+} scuBufs_t;
+
+typedef struct
+{   
+    float* BlockLFactor;
+    float* BlockUFactor;
+} diagFactBufs_t;
+
+typedef struct
+{
+    Ublock_info_t* Ublock_info;
+    Remain_info_t*  Remain_info;
+    uPanelInfo_t* uPanelInfo;
+    lPanelInfo_t* lPanelInfo;
+} packLUInfo_t;
+
+#endif
+/*=====================*/
+
+/***********************************************************************
+ * Function prototypes
+ ***********************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Supernodal LU factor related */
+extern void
+sCreate_CompCol_Matrix_dist(SuperMatrix *, int_t, int_t, int_t, float *,
+			    int_t *, int_t *, Stype_t, Dtype_t, Mtype_t);
+extern void
+sCreate_CompRowLoc_Matrix_dist(SuperMatrix *, int_t, int_t, int_t, int_t,
+			       int_t, float *, int_t *, int_t *,
+			       Stype_t, Dtype_t, Mtype_t);
+extern void
+sCompRow_to_CompCol_dist(int_t, int_t, int_t, float *, int_t *, int_t *,
+                         float **, int_t **, int_t **);
+extern int
+psCompRow_loc_to_CompCol_global(int_t, SuperMatrix *, gridinfo_t *,
+	 		        SuperMatrix *);
+extern void
+sCopy_CompCol_Matrix_dist(SuperMatrix *, SuperMatrix *);
+extern void
+sCreate_Dense_Matrix_dist(SuperMatrix *, int_t, int_t, float *, int_t,
+			  Stype_t, Dtype_t, Mtype_t);
+extern void
+sCreate_SuperNode_Matrix_dist(SuperMatrix *, int_t, int_t, int_t, float *,
+			      int_t *, int_t *, int_t *, int_t *, int_t *,
+			      Stype_t, Dtype_t, Mtype_t);
+extern void
+sCopy_Dense_Matrix_dist(int_t, int_t, float *, int_t,
+                        float *, int_t);
+
+extern void    sallocateA_dist (int_t, int_t, float **, int_t **, int_t **);
+extern void    sGenXtrue_dist (int_t, int_t, float *, int_t);
+extern void    sFillRHS_dist (char *, int_t, float *, int_t,
+                              SuperMatrix *, float *, int_t);
+extern int     screate_matrix(SuperMatrix *, int, float **, int *,
+			      float **, int *, FILE *, gridinfo_t *);
+extern int     screate_matrix_rb(SuperMatrix *, int, float **, int *,
+			      float **, int *, FILE *, gridinfo_t *);
+extern int     screate_matrix_dat(SuperMatrix *, int, float **, int *,
+			      float **, int *, FILE *, gridinfo_t *);
+extern int 	   screate_matrix_postfix(SuperMatrix *, int, float **, int *,
+				  float **, int *, FILE *, char *, gridinfo_t *);
+extern int     screate_matrix_gen(SuperMatrix *, int, float **, int *,
+				  float **, int *, char *, gridinfo_t *);
+
+extern void   sScalePermstructInit(const int_t, const int_t, 
+                                      sScalePermstruct_t *);
+extern void   sScalePermstructFree(sScalePermstruct_t *);
+
+/* Driver related */
+extern void    sgsequ_dist (SuperMatrix *, float *, float *, float *,
+			    float *, float *, int_t *);
+extern float  slangs_dist (char *, SuperMatrix *);
+extern void    slaqgs_dist (SuperMatrix *, float *, float *, float,
+			    float, float, char *);
+extern void    psgsequ (SuperMatrix *, float *, float *, float *,
+			float *, float *, int_t *, gridinfo_t *);
+extern void    psgsequ_ruiz (SuperMatrix *, int, float *, float *, float *,
+			     float *, float *, int_t *, gridinfo_t *);
+extern float  pslangs (char *, SuperMatrix *, gridinfo_t *);
+extern void    pslaqgs (SuperMatrix *, float *, float *, float,
+			float, float, char *);
+extern int     psPermute_Dense_Matrix(int_t, int_t, int_t [], int_t[],
+				      float [], int, float [], int, int,
+				      gridinfo_t *);
+
+extern int     sp_strsv_dist (char *, char *, char *, SuperMatrix *,
+			      SuperMatrix *, float *, int *);
+extern int     sp_sgemv_dist (char *, float, SuperMatrix *, float *,
+			      int, float, float *, int);
+extern int     sp_sgemm_dist (char *, int, float, SuperMatrix *,
+                        float *, int, float, float *, int);
+
+extern float sdistribute(fact_t, int_t, SuperMatrix *, Glu_freeable_t *,
+			 sLUstruct_t *, gridinfo_t *);
+extern void  psgssvx_ABglobal(superlu_dist_options_t *, SuperMatrix *,
+			      sScalePermstruct_t *, float *,
+			      int, int, gridinfo_t *, sLUstruct_t *, float *,
+			      SuperLUStat_t *, int *);
+extern float psdistribute(fact_t, int_t, SuperMatrix *,
+			 sScalePermstruct_t *, Glu_freeable_t *,
+			 sLUstruct_t *, gridinfo_t *);
+extern void  psgssvx(superlu_dist_options_t *, SuperMatrix *,
+		     sScalePermstruct_t *, float *,
+		     int, int, gridinfo_t *, sLUstruct_t *,
+		     sSOLVEstruct_t *, float *, SuperLUStat_t *, int *);
+extern int   psgssvx_start(superlu_dist_options_t *, SuperMatrix *,
+			   sScalePermstruct_t *, float *, int, int,
+			   gridinfo_t *, sLUstruct_t *, sSOLVEstruct_t *,
+			   float *, SuperLUStat_t *, int *, sgssvxRequest_t *);
+extern void  psgssvx_subtree(superlu_dist_options_t *, SuperMatrix *, int,
+			     float *, int, int, gridinfo_t *,
+			     SuperLUStat_t *, int *);
+extern void  sBatchInit(int, double *, int, int, gridinfo_t *, sBatch_t *);
+extern void  psgssvx_batch(superlu_dist_options_t *, sBatch_t *,
+			   SuperMatrix **, float **, int *, int,
+			   float **, SuperLUStat_t *, int *);
+extern void  sBatchFinalize(sBatch_t *);
+extern void  psgsrefactor(superlu_dist_options_t *, SuperMatrix *, float *,
+			    sScalePermstruct_t *, gridinfo_t *, sLUstruct_t *,
+			    sSOLVEstruct_t *, SuperLUStat_t *, int *);
+extern void  psgsrefactor_partial(superlu_dist_options_t *, SuperMatrix *,
+				    float *, int_t, int_t *, sScalePermstruct_t *,
+				    gridinfo_t *, sLUstruct_t *,
+				    sSOLVEstruct_t *, SuperLUStat_t *, int *);
+extern void  psgsrefactor_pattern(superlu_dist_options_t *, SuperMatrix *,
+				  sScalePermstruct_t *, gridinfo_t *,
+				  sLUstruct_t *, sSOLVEstruct_t *,
+				  SuperLUStat_t *, int *);
+extern void  psgssvx_sweep(superlu_dist_options_t *, SuperMatrix *, int,
+			   float **, float **, int, int, sScalePermstruct_t *,
+			   gridinfo_t *, sLUstruct_t *, sSOLVEstruct_t *,
+			   float **, SuperLUStat_t *, int *);
+extern void  psgssvx_shifts(superlu_dist_options_t *, SuperMatrix *, int,
+			    float *, float **, int, int, sScalePermstruct_t *,
+			    gridinfo_t *, sLUstruct_t *, sSOLVEstruct_t *,
+			    float **, SuperLUStat_t *, int *);
+extern void  psLU_redistribute(superlu_dist_options_t *, int_t, gridinfo_t *,
+				sScalePermstruct_t *, sLUstruct_t *,
+				gridinfo_t *, sLUstruct_t *, int *);
+extern void  psgssvx_dense(superlu_dist_options_t *, SuperMatrix *,
+			   sScalePermstruct_t *, float *, int, int,
+			   gridinfo_t *, sLUstruct_t *, float *,
+			   SuperLUStat_t *, int *);
+extern void  psgssvx_fused(superlu_dist_options_t *, SuperMatrix *, float *,
+			   int, int, gridinfo_t *, float *, SuperLUStat_t *,
+			   int *);
+extern void  sSMWInit(int, sSMW_t *);
+extern void  psgssmw_update(superlu_dist_options_t *, SuperMatrix *,
+			    sScalePermstruct_t *, gridinfo_t *, sLUstruct_t *,
+			    sSOLVEstruct_t *, sSMW_t *, int, float *, float *, int,
+			    SuperLUStat_t *, int *);
+extern void  psgssmw_solve(superlu_dist_options_t *, SuperMatrix *,
+			   sScalePermstruct_t *, sSMW_t *, float *, int, int,
+			   gridinfo_t *, sLUstruct_t *, sSOLVEstruct_t *,
+			   float *, SuperLUStat_t *, int *);
+extern void  sSMWFree(sSMW_t *);
+extern int   psgssvx_test(sgssvxRequest_t *);
+extern void  psgssvx_wait(sgssvxRequest_t *);
+extern double psgstune(superlu_dist_options_t *, SuperMatrix *, gridinfo_t *,
+		       int_t *, int_t *);
+extern void  psCompute_Diag_Inv(int_t, sLUstruct_t *,gridinfo_t *, SuperLUStat_t *, int *);
+extern void  psDefer_Diag_Inv(superlu_dist_options_t *, sLUstruct_t *);
+extern int  sSolveInit(superlu_dist_options_t *, SuperMatrix *, int_t [], int_t [],
+		       int_t, sLUstruct_t *, gridinfo_t *, sSOLVEstruct_t *);
+extern void sSolveFinalize(superlu_dist_options_t *, sSOLVEstruct_t *);
+extern void sSolveWorkFree(sSOLVEstruct_t *);
+extern int_t psgstrs_init(int_t, int_t, int_t, int_t,
+                          int_t [], int_t [], gridinfo_t *grid,
+	                  Glu_persist_t *, sSOLVEstruct_t *);
+extern void pxgstrs_finalize(pxgstrs_comm_t *);
+extern int  sldperm_dist(int_t, int_t, int_t, int_t [], int_t [],
+		    float [], int_t *, float [], float []);
+extern int  psldperm_auction(SuperMatrix *, gridinfo_t *, int_t *,
+			     float *, float *);
+extern int  psldperm_check(SuperMatrix *, sScalePermstruct_t *, double,
+			   gridinfo_t *);
+extern int  sstatic_schedule(superlu_dist_options_t *, int, int,
+		            sLUstruct_t *, gridinfo_t *, SuperLUStat_t *,
+			    int_t *, int_t *, int *);
+extern void sLUstructInit(const int_t, sLUstruct_t *);
+extern void sLUstructFree(sLUstruct_t *);
+extern void sDestroy_LU(int_t, gridinfo_t *, sLUstruct_t *);
+extern void sDestroy_DenseLU(sLUstruct_t *);
+extern void sDestroy_Tree(int_t, gridinfo_t *, sLUstruct_t *);
+extern void sCreate_Trees(sLocalLU_t *, gridinfo_t *, int);
+extern double sLU_local_bytes(int_t, sLUstruct_t *, gridinfo_t *);
+extern void sDestroy_Amap(sLocalLU_t *);
+extern int_t psLU_pattern_check(int_t, SuperMatrix *, sScalePermstruct_t *,
+				sLUstruct_t *, gridinfo_t *);
+extern void sRelease_LU(int_t, gridinfo_t *, sLUstruct_t *);
+extern void sCompact_LU(int_t, gridinfo_t *, sLUstruct_t *);
+extern int  sDrop_U(superlu_dist_options_t *, int_t, sScalePermstruct_t *,
+		    sLUstruct_t *, gridinfo_t *);
+extern void sscatter_l (int ib, int ljb, int nsupc, int_t iukp, int_t* xsup,
+			int klst, int nbrow, int_t lptr, int temp_nbrow,
+			int_t* usub, int_t* lsub, float *tempv,
+			int* indirect_thread, int* indirect2,
+			int_t ** Lrowind_bc_ptr, float **Lnzval_bc_ptr,
+			gridinfo_t * grid);
+extern void sscatter_u (int ib, int jb, int nsupc, int_t iukp, int_t * xsup,
+                        int klst, int nbrow, int_t lptr, int temp_nbrow,
+                        int_t* lsub, int_t* usub, float* tempv,
+                        int_t ** Ufstnz_br_ptr, float **Unzval_br_ptr,
+                        gridinfo_t * grid);
+extern double sblr_gemm(int_t, Remain_info_t *, int, int, float *, int,
+			float *, int, float *, double, int);
+extern int_t psgstrf(superlu_dist_options_t *, int, int, float,
+		    sLUstruct_t*, gridinfo_t*, SuperLUStat_t*, int*);
+
+/* #define GPU_PROF
+#define IPM_PROF */
+
+/* Solve related */
+extern int_t psSolveLayout(int_t, sLUstruct_t *, gridinfo_t *, int_t *);
+extern void psgstrs_Bglobal(int_t, sLUstruct_t *, gridinfo_t *,
+			     float *, int_t, int, SuperLUStat_t *, int *);
+extern void psgstrs(int_t, sLUstruct_t *, sScalePermstruct_t *, gridinfo_t *,
+		    float *, int_t, int_t, int_t, int, sSOLVEstruct_t *,
+		    SuperLUStat_t *, int *);
+extern void sRHSqueueInit(int_t, int_t, int, sRHSqueue_t *);
+extern void sRHSqueueFree(sRHSqueue_t *);
+extern int  psgstrs_push(int_t, sLUstruct_t *, sScalePermstruct_t *,
+			 gridinfo_t *, float *, int_t, int, sSOLVEstruct_t *,
+			 SuperLUStat_t *, int *, sRHSqueue_t *);
+extern void psgstrs_flush(int_t, sLUstruct_t *, sScalePermstruct_t *,
+			  gridinfo_t *, sSOLVEstruct_t *, SuperLUStat_t *,
+			  int *, sRHSqueue_t *);
+extern void psgstrs_trans(int_t, sLUstruct_t *, sScalePermstruct_t *,
+			  gridinfo_t *, float *, int_t, int_t, int_t, int,
+			  sSOLVEstruct_t *, SuperLUStat_t *, int *);
+extern void psgstrs_sym(int_t, sLUstruct_t *, sScalePermstruct_t *,
+			gridinfo_t *, float *, int_t, int_t, int_t, int,
+			sSOLVEstruct_t *, SuperLUStat_t *, int *);
+extern void psgscon(char *, int_t, float, sLUstruct_t *,
+		    sScalePermstruct_t *, gridinfo_t *, int_t, int_t,
+		    sSOLVEstruct_t *, float *, SuperLUStat_t *, int *);
+extern void psgstrf2_trsm(superlu_dist_options_t * options, int_t k0, int_t k,
+			  float thresh, Glu_persist_t *, gridinfo_t *,
+			  sLocalLU_t *, MPI_Request *, int tag_ub,
+			  SuperLUStat_t *, int *info);
+extern void psgstrf2_diag(superlu_dist_options_t *, int, float *, int,
+			  float thresh, int_t, SuperLUStat_t *, int *info);
+extern int_t psgstrf_root_start(superlu_dist_options_t *, int_t,
+			       Glu_persist_t *, gridinfo_t *, sLocalLU_t *);
+extern void psgstrf_root(superlu_dist_options_t *, int_t kd, int_t n,
+			 float thresh, Glu_persist_t *, gridinfo_t *,
+			 sLocalLU_t *, SuperLUStat_t *, int *info);
+extern void psgstrs2_omp(int_t k0, int_t k, Glu_persist_t *, gridinfo_t *,
+			 sLocalLU_t *, Ublock_info_t *, superlu_arena_t *,
+			 SuperLUStat_t *);
+extern int_t psReDistribute_B_to_X(float *B, int_t m_loc, int nrhs, int_t ldb,
+				   int_t fst_row, int_t *ilsum, float *x,
+				   sScalePermstruct_t *, Glu_persist_t *,
+				   gridinfo_t *, sSOLVEstruct_t *);
+extern int_t psReDistribute_X_to_B(int_t n, float *B, int_t m_loc, int_t ldb,
+				   int_t fst_row, int_t nrhs, float *x,
+				   int_t *ilsum, sScalePermstruct_t *,
+				   Glu_persist_t *, gridinfo_t *,
+				   sSOLVEstruct_t *);
+extern void slsum_fmod(float *, float *, float *, float *,
+		       int, int, int_t , int_t *, int_t, int_t, int_t,
+		       int_t *, gridinfo_t *, sLocalLU_t *,
+		       MPI_Request [], SuperLUStat_t *);
+extern void slsum_bmod(float *, float *, float *,
+                       int, int_t, int_t *, int_t *, Ucb_indptr_t **,
+                       int_t **, int_t *, gridinfo_t *, sLocalLU_t *,
+		       MPI_Request [], SuperLUStat_t *);
+
+extern void slsum_fmod_inv(float *, float *, float *, float *,
+		       int, int_t , int_t *,
+		       int_t *, gridinfo_t *, sLocalLU_t *,
+		       SuperLUStat_t **, int_t *, int_t *, int_t, int_t, int_t, int_t, int, int);
+extern void slsum_fmod_inv_master(float *, float *, float *, float *,
+		       int, int, int_t , int_t *, int_t,
+		       int_t *, gridinfo_t *, sLocalLU_t *,
+		       SuperLUStat_t **, int_t, int_t, int_t, int_t, int, int);
+extern void slsum_bmod_inv(float *, float *, float *, float *,
+                       int, int_t, int_t *, int_t *, Ucb_indptr_t **,
+                       int_t **, int_t *, gridinfo_t *, sLocalLU_t *,
+		       SuperLUStat_t **, int_t *, int_t *, int_t, int_t, int, int);
+extern void slsum_bmod_inv_master(float *, float *, float *, float *,
+                       int, int_t, int_t *, int_t *, Ucb_indptr_t **,
+                       int_t **, int_t *, gridinfo_t *, sLocalLU_t *,
+		       SuperLUStat_t **, int_t, int_t, int, int);
+
+extern void slsum_fmod_levels(float *, float *, float *, int, int_t,
+		       int_t *, int_t *, int *, int_t *, gridinfo_t *,
+		       sLocalLU_t *, SuperLUStat_t **, int_t, int_t, int);
+extern void slsum_fmod_fixed(float *, float *, float *, int, int_t,
+		       int_t *, int_t *, int_t, int_t, pxgstrs_ring_t *, int *,
+		       int_t *, gridinfo_t *, sLocalLU_t *, SuperLUStat_t *);
+extern void slsum_bmod_fixed(float *, float *, float *, int, int_t,
+		       int_t *, int_t *, int_t, int_t, pxgstrs_ring_t *, int_t,
+		       int *, int_t *, gridinfo_t *, sLocalLU_t *,
+		       SuperLUStat_t *);
+
+extern void psgsrfs(int_t, SuperMatrix *, float, sLUstruct_t *,
+		    sScalePermstruct_t *, gridinfo_t *,
+		    float [], int_t, float [], int_t, int,
+		    sSOLVEstruct_t *, float *, SuperLUStat_t *, int *);
+extern void psgsrfs_matvec(trans_t, int, SuperMatrix *, sLUstruct_t *,
+			   sScalePermstruct_t *, gridinfo_t *,
+			   sSOLVEstruct_t *, int, float *, int_t, float *, int_t);
+extern void psgsrfs_trans(int_t, SuperMatrix *, float, sLUstruct_t *,
+			  sScalePermstruct_t *, gridinfo_t *,
+			  float [], int_t, float [], int_t, int,
+			  sSOLVEstruct_t *, float *, SuperLUStat_t *, int *);
+extern void psgsrfs_gmres(trans_t, int_t, SuperMatrix *, float, sLUstruct_t *,
+			  sScalePermstruct_t *, gridinfo_t *,
+			  float [], int_t, float [], int_t, int,
+			  sSOLVEstruct_t *, float *, SuperLUStat_t *, int *);
+extern void psgsrfs_ABXglobal(int_t, SuperMatrix *, float, sLUstruct_t *,
+		  gridinfo_t *, float *, int_t, float *, int_t,
+		  int, float *, SuperLUStat_t *, int *);
+extern int   psgsmv_AXglobal_setup(SuperMatrix *, Glu_persist_t *,
+				   gridinfo_t *, int_t *, int_t *[],
+				   float *[], int_t *[], int_t []);
+extern int  psgsmv_AXglobal(int_t, int_t [], float [], int_t [],
+	                       float [], float []);
+extern int  psgsmv_AXglobal_abs(int_t, int_t [], float [], int_t [],
+				 float [], float []);
+extern void psgsmv_init(SuperMatrix *, int_t *, gridinfo_t *,
+			psgsmv_comm_t *);
+extern void psgsmv_reuse(SuperMatrix *, int_t *, int_t *, gridinfo_t *);
+extern void psgsmv(int_t, SuperMatrix *, gridinfo_t *, psgsmv_comm_t *,
+		   float x[], float ax[]);
+extern void psgsmv_trans(int_t, SuperMatrix *, gridinfo_t *,
+			 psgsmv_comm_t *, float x[], float atx[]);
+extern void psgsmv_block(SuperMatrix *, gridinfo_t *, psgsmv_comm_t *, int,
+			 float x[], int_t, float ax[], float aax[], int_t);
+extern void psgsmv_finalize(psgsmv_comm_t *);
+
+/* Memory-related */
+extern float  *floatMalloc_dist(int_t);
+extern float  *floatCalloc_dist(int_t);
+extern void  *suser_malloc_dist (int_t, int_t);
+extern void  suser_free_dist (int_t, int_t);
+extern int_t sQuerySpace_dist(int_t, sLUstruct_t *, gridinfo_t *,
+			      SuperLUStat_t *, superlu_dist_mem_usage_t *);
+
+/* Auxiliary routines */
+
+extern void sClone_CompRowLoc_Matrix_dist(SuperMatrix *, SuperMatrix *);
+extern void sCopy_CompRowLoc_Matrix_dist(SuperMatrix *, SuperMatrix *);
+extern void sZero_CompRowLoc_Matrix_dist(SuperMatrix *);
+extern void sScaleAddId_CompRowLoc_Matrix_dist(SuperMatrix *, float);
+extern void sScaleAdd_CompRowLoc_Matrix_dist(SuperMatrix *, SuperMatrix *, float);
+extern void sZeroLblocks(int, int_t, gridinfo_t *, sLUstruct_t *);
+extern void    sfill_dist (float *, int_t, float);
+extern void    sinf_norm_error_dist (int_t, int_t, float*, int_t,
+                                     float*, int_t, gridinfo_t*);
+extern void    psinf_norm_error(int, int_t, int_t, float [], int_t,
+				float [], int_t , gridinfo_t *);
+extern void  sreadhb_dist (int, FILE *, int_t *, int_t *, int_t *,
+			   float **, int_t **, int_t **);
+extern void  sreadtriple_dist(FILE *, int_t *, int_t *, int_t *,
+			 float **, int_t **, int_t **);
+extern void  sreadtriple_noheader(FILE *, int_t *, int_t *, int_t *,
+			 float **, int_t **, int_t **);
+extern void  sreadrb_dist(int, FILE *, int_t *, int_t *, int_t *,
+		     float **, int_t **, int_t **);
+extern void  sreadMM_dist(FILE *, int_t *, int_t *, int_t *,
+	                  float **, int_t **, int_t **);
+extern int  sread_binary(FILE *, int_t *, int_t *, int_t *,
+	                  float **, int_t **, int_t **);
+extern int  psSave_LU(char *, int_t, int_t, sScalePermstruct_t *,
+                      sLUstruct_t *, gridinfo_t *);
+extern int  psLoad_LU(char *, int_t, int_t, SuperMatrix *,
+                      sScalePermstruct_t *, sLUstruct_t *, gridinfo_t *);
+extern int  psreadMM_loc(char *, SuperMatrix *, gridinfo_t *);
+extern int  psreadtriple_loc(char *, SuperMatrix *, gridinfo_t *);
+extern int  psread_binary_loc(char *, SuperMatrix *, gridinfo_t *);
+extern int  pswrite_binary_loc(char *, SuperMatrix *, gridinfo_t *);
+extern void pscoord_to_loc(int_t, int_t, int_t, int_t *, int_t *, float *,
+                           int_t *, SuperMatrix *, gridinfo_t *);
+extern void psAssemblyInit(int_t, int_t, int_t, int_t, gridinfo_t *,
+                           sAssembly_t *);
+extern void sAssemblyAdd(sAssembly_t *, int_t, int_t *, int_t *, float *);
+extern void psAssemblyFinish(sAssembly_t *, SuperMatrix *);
+#ifdef HAVE_HDF5 /* experimental, see pshdf5_io.c */
+extern int  psread_hdf5_loc(char *, char *, SuperMatrix *, gridinfo_t *);
+extern int  pswrite_hdf5_loc(char *, char *, SuperMatrix *, gridinfo_t *);
+extern int  psread_hdf5_vec(char *, char *, int_t, int_t, int, float *, int,
+                             gridinfo_t *);
+extern int  pswrite_hdf5_vec(char *, char *, int_t, int_t, int_t, int, float *,
+                              int, gridinfo_t *);
+#endif
+
+/* Distribute the data for numerical factorization */
+extern float sdist_psymbtonum(fact_t, int_t, SuperMatrix *,
+                                sScalePermstruct_t *, Pslu_freeable_t *,
+                                sLUstruct_t *, gridinfo_t *);
+extern void psGetDiagU(int_t, sLUstruct_t *, gridinfo_t *, float *);
+extern void psLogDet(int_t, sLUstruct_t *, sScalePermstruct_t *,
+		     gridinfo_t *, float *, int *);
+extern void psSelInv(int_t, sLUstruct_t *, gridinfo_t *, sSelInvstruct_t *);
+extern int_t psSelInvDiag(int_t, sScalePermstruct_t *, sLUstruct_t *,
+			  sSelInvstruct_t *, gridinfo_t *, float *);
+extern void sSelInvFree(int_t, gridinfo_t *, sLUstruct_t *, sSelInvstruct_t *);
+extern void psGetSchur(superlu_dist_options_t *, int_t, sScalePermstruct_t *,
+			sLUstruct_t *, gridinfo_t *, SuperMatrix *);
+
+extern int  s_c2cpp_GetHWPM(SuperMatrix *, gridinfo_t *, sScalePermstruct_t *);
+
+/* Routines for debugging */
+extern void  sPrintLblocks(int, int_t, gridinfo_t *, Glu_persist_t *,
+		 	   sLocalLU_t *);
+extern void  sPrintUblocks(int, int_t, gridinfo_t *, Glu_persist_t *,
+			   sLocalLU_t *);
+extern void  sPrint_CompCol_Matrix_dist(SuperMatrix *);
+extern void  sPrint_Dense_Matrix_dist(SuperMatrix *);
+extern int   sPrint_CompRowLoc_Matrix_dist(SuperMatrix *);
+extern int   file_sPrint_CompRowLoc_Matrix_dist(FILE *fp, SuperMatrix *A);
+extern void  Printfloat5(char *, int_t, float *);
+extern int   file_Printfloat5(FILE *, char *, int_t, float *);
+
+
+/* BLAS */
+
+#ifdef USE_VENDOR_BLAS
+extern void sgemm_(const char*, const char*, const int*, const int*, const int*,
+                  const float*, const float*, const int*, const float*,
+                  const int*, const float*, float*, const int*, int, int);
+extern void strsv_(char*, char*, char*, int*, float*, int*,
+                  float*, int*, int, int, int);
+extern void strsm_(char*, char*, char*, char*, int*, int*,
+                  float*, float*, int*, float*,
+                  int*, int, int, int, int);
+extern void sgemv_(char *, int *, int *, float *, float *a, int *,
+                  float *, int *, float *, float *, int *, int);
+
+extern void sger_(int*, int*, float*, float*, int*,
+                 float*, int*, float*, int*);
+
+#else
+extern int sgemm_(const char*, const char*, const int*, const int*, const int*,
+                   const float*,  const float*,  const int*,  const float*,
+                   const int*,  const float*, float*, const int*);
+extern int strsv_(char*, char*, char*, int*, float*, int*,
+                  float*, int*);
+extern int strsm_(char*, char*, char*, char*, int*, int*,
+                  float*, float*, int*, float*, int*);
+extern int sgemv_(char *, int *, int *, float *, float *a, int *,
+                  float *, int *, float *, float *, int *);
+extern void sger_(int*, int*, float*, float*, int*,
+                 float*, int*, float*, int*);
+
+#endif
+
+extern int sgemm_small(int, int, int, float *, int, float *, int,
+                        float *, int);
+extern int sgemm_small_sub(int, int, int, float *, int, float *, int,
+                           float *, int);
+extern int strsm_small(char, int, int, float *, int, float *, int);
+
+extern int sscal_(int *n, float *da, float *dx, int *incx);
+extern int saxpy_(int *n, float *za, float *zx, 
+	               int *incx, float *zy, int *incy);
+// LAPACK routine
+extern void strtri_(char*, char*, int*, float*, int*, int*);
+
+
+#if 0
+/*==== For 3D code ====*/
+
+extern void psgssvx3d (superlu_dist_options_t *, SuperMatrix *,
+		       sScalePermstruct_t *, float B[], int ldb, int nrhs,
+		       gridinfo3d_t *, sLUstruct_t *, sSOLVEstruct_t *, 
+		       float *berr, SuperLUStat_t *, int *info);
+extern int_t psgstrf3d(superlu_dist_options_t *, int m, int n, float anorm,
+		       trf3Dpartition_t*, SCT_t *, sLUstruct_t *,
+		       gridinfo3d_t *, SuperLUStat_t *, int *);
+extern void sInit_HyP(HyP_t* HyP, sLocalLU_t *Llu, int_t mcb, int_t mrb );
+extern void Free_HyP(HyP_t* HyP);
+extern int updateDirtyBit(int_t k0, HyP_t* HyP, gridinfo_t* grid);
+
+    /* from scatter.h */
+extern void
+sblock_gemm_scatter( int_t lb, int_t j, Ublock_info_t *Ublock_info,
+                    Remain_info_t *Remain_info, float *L_mat, int_t ldl,
+                    float *U_mat, int_t ldu,  float *bigV,
+                    // int_t jj0,
+                    int_t knsupc,  int_t klst,
+                    int_t *lsub, int_t *usub, int_t ldt,
+                    int_t thread_id,
+                    int_t *indirect, int_t *indirect2,
+                    int_t **Lrowind_bc_ptr, float **Lnzval_bc_ptr,
+                    int_t **Ufstnz_br_ptr, float **Unzval_br_ptr,
+                    int_t *xsup, gridinfo_t *, SuperLUStat_t *
+#ifdef SCATTER_PROFILE
+                    , float *Host_TheadScatterMOP, float *Host_TheadScatterTimer
+#endif
+                  );
+/*this version uses a lock to prevent multiple thread updating the same block*/
+extern void
+sblock_gemm_scatter_lock( int_t lb, int_t j, omp_lock_t* lock,
+                         Ublock_info_t *Ublock_info,  Remain_info_t *Remain_info,
+                         float *L_mat, int_t ldl, float *U_mat, int_t ldu,
+                         float *bigV,
+                         // int_t jj0,
+                         int_t knsupc,  int_t klst,
+                         int_t *lsub, int_t *usub, int_t ldt,
+                         int_t thread_id,
+                         int_t *indirect, int_t *indirect2,
+                         int_t **Lrowind_bc_ptr, float **Lnzval_bc_ptr,
+                         int_t **Ufstnz_br_ptr, float **Unzval_br_ptr,
+                         int_t *xsup, gridinfo_t *
+#ifdef SCATTER_PROFILE
+                         , float *Host_TheadScatterMOP, float *Host_TheadScatterTimer
+#endif
+                       );
+extern int_t
+sblock_gemm_scatterTopLeft( int_t lb,  int_t j, float* bigV,
+				 int_t knsupc,  int_t klst, int_t* lsub,
+                                 int_t * usub, int_t ldt,
+				 int_t* indirect, int_t* indirect2,
+                                 HyP_t* HyP, sLUstruct_t *, gridinfo_t*,
+                                 SCT_t*SCT, SuperLUStat_t *
+                               );
+extern int_t 
+sblock_gemm_scatterTopRight( int_t lb,  int_t j, float* bigV,
+				  int_t knsupc,  int_t klst, int_t* lsub,
+                                  int_t * usub, int_t ldt,
+				  int_t* indirect, int_t* indirect2,
+                                  HyP_t* HyP, sLUstruct_t *, gridinfo_t*,
+                                  SCT_t*SCT, SuperLUStat_t * );
+extern int_t
+sblock_gemm_scatterBottomLeft( int_t lb,  int_t j, float* bigV,
+				    int_t knsupc,  int_t klst, int_t* lsub,
+                                    int_t * usub, int_t ldt, 
+				    int_t* indirect, int_t* indirect2,
+                                    HyP_t* HyP, sLUstruct_t *, gridinfo_t*,
+                                    SCT_t*SCT, SuperLUStat_t * );
+extern int_t 
+sblock_gemm_scatterBottomRight( int_t lb,  int_t j, float* bigV,
+				     int_t knsupc,  int_t klst, int_t* lsub,
+                                     int_t * usub, int_t ldt,
+				     int_t* indirect, int_t* indirect2,
+                                     HyP_t* HyP, sLUstruct_t *, gridinfo_t*,
+                                     SCT_t*SCT, SuperLUStat_t * );
+
+    /* from gather.h */
+extern void sgather_u(int_t num_u_blks,
+              Ublock_info_t *Ublock_info, int_t * usub,
+              float *uval,  float *bigU,  int_t ldu,
+              int_t *xsup, int_t klst                /* for SuperSize */
+             );
+
+extern void sgather_l( int_t num_LBlk, int_t knsupc,
+               Remain_info_t *L_info,
+               float * lval, int_t LD_lval,
+               float * L_buff );
+
+extern void sRgather_L(int_t k, int_t *lsub, float *lusup, gEtreeInfo_t*,
+		      Glu_persist_t *, gridinfo_t *, HyP_t *,
+		      int_t *myIperm, int_t *iperm_c_supno );
+extern void sRgather_U(int_t k, int_t jj0, int_t *usub, float *uval,
+		      float *bigU, gEtreeInfo_t*, Glu_persist_t *,
+		      gridinfo_t *, HyP_t *, int_t *myIperm,
+		      int_t *iperm_c_supno, int_t *perm_u);
+
+    /* from xtrf3Dpartition.h */
+extern trf3Dpartition_t* sinitTrf3Dpartition(int_t nsupers,
+					     superlu_dist_options_t *options,
+					     sLUstruct_t *LUstruct, gridinfo3d_t * grid3d);
+extern void sDestroy_trf3Dpartition(trf3Dpartition_t *trf3Dpartition, gridinfo3d_t *grid3d);
+
+extern void d3D_printMemUse(trf3Dpartition_t*  trf3Dpartition,
+			    sLUstruct_t *LUstruct, gridinfo3d_t * grid3d);
+
+extern int* getLastDep(gridinfo_t *grid, SuperLUStat_t *stat,
+		       superlu_dist_options_t *options, sLocalLU_t *Llu,
+		       int_t* xsup, int_t num_look_aheads, int_t nsupers,
+		       int_t * iperm_c_supno);
+
+extern void sinit3DLUstructForest( int_t* myTreeIdxs, int_t* myZeroTrIdxs,
+				  sForest_t**  sForests, sLUstruct_t* LUstruct,
+				  gridinfo3d_t* grid3d);
+
+extern int_t sgatherAllFactoredLUFr(int_t* myZeroTrIdxs, sForest_t* sForests,
+				   sLUstruct_t* LUstruct, gridinfo3d_t* grid3d,
+				   SCT_t* SCT );
+
+    /* The following are from psgstrf2.h */
+#if 0 // Sherry: same routine names, but different code !!!!!!!
+extern void psgstrf2_trsm(superlu_dist_options_t *options, int_t, int_t,
+                          int_t k, float thresh, Glu_persist_t *,
+			  gridinfo_t *, sLocalLU_t *, MPI_Request *U_diag_blk_send_req,
+			  int tag_ub, SuperLUStat_t *, int *info, SCT_t *);
+#ifdef _CRAY
+void psgstrs2_omp (int_t, int_t, int_t, Glu_persist_t *, gridinfo_t *,
+                      sLocalLU_t *, SuperLUStat_t *, _fcd, _fcd, _fcd);
+#else
+void psgstrs2_omp (int_t, int_t, int_t, int_t *, float*, Glu_persist_t *, gridinfo_t *,
+                      sLocalLU_t *, SuperLUStat_t *, Ublock_info_t *, float *bigV, int_t ldt, SCT_t *SCT );
+#endif
+
+#else 
+extern void psgstrf2_trsm(superlu_dist_options_t * options, int_t k0, int_t k,
+			  float thresh, Glu_persist_t *, gridinfo_t *,
+			  sLocalLU_t *, MPI_Request *, int tag_ub,
+			  SuperLUStat_t *, int *info);
+extern void psgstrs2_omp(int_t k0, int_t k, Glu_persist_t *, gridinfo_t *,
+			 sLocalLU_t *, Ublock_info_t *, superlu_arena_t *,
+			 SuperLUStat_t *);
+#endif // same routine names   !!!!!!!!
+
+extern int_t sLpanelUpdate(int_t off0, int_t nsupc, float* ublk_ptr,
+			  int_t ld_ujrow, float* lusup, int_t nsupr, SCT_t*);
+extern void Local_Sgstrf2(superlu_dist_options_t *options, int_t k,
+			  float thresh, float *BlockUFactor, Glu_persist_t *,
+			  gridinfo_t *, sLocalLU_t *,
+                          SuperLUStat_t *, int *info, SCT_t*);
+extern int_t sTrs2_GatherU(int_t iukp, int_t rukp, int_t klst,
+			  int_t nsupc, int_t ldu, int_t *usub,
+			  float* uval, float *tempv);
+extern int_t sTrs2_ScatterU(int_t iukp, int_t rukp, int_t klst,
+			   int_t nsupc, int_t ldu, int_t *usub,
+			   float* uval, float *tempv);
+extern int_t sTrs2_GatherTrsmScatter(int_t klst, int_t iukp, int_t rukp,
+                             int_t *usub, float* uval, float *tempv,
+                             int_t knsupc, int_t nsupr, float* lusup,
+                             Glu_persist_t *Glu_persist)  ;
+extern void psgstrs2
+#ifdef _CRAY
+(
+    int_t m, int_t k0, int_t k, Glu_persist_t *Glu_persist, gridinfo_t *grid,
+    sLocalLU_t *Llu, SuperLUStat_t *stat, _fcd ftcs1, _fcd ftcs2, _fcd ftcs3
+);
+#else
+(
+    int_t m, int_t k0, int_t k, Glu_persist_t *Glu_persist, gridinfo_t *grid,
+    sLocalLU_t *Llu, SuperLUStat_t *stat
+);
+#endif
+
+extern void psgstrf2(superlu_dist_options_t *, int_t nsupers, int_t k0,
+		     int_t k, float thresh, Glu_persist_t *, gridinfo_t *,
+		     sLocalLU_t *, MPI_Request *, int, SuperLUStat_t *, int *);
+
+    /* from p3dcomm.h */
+extern int_t sAllocLlu_3d(int_t nsupers, sLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t sp3dScatter(int_t n, sLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t sscatter3dLPanels(int_t nsupers,
+                       sLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t sscatter3dUPanels(int_t nsupers,
+                       sLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t scollect3dLpanels(int_t layer, int_t nsupers, sLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t scollect3dUpanels(int_t layer, int_t nsupers, sLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+extern int_t sp3dCollect(int_t layer, int_t n, sLUstruct_t * LUstruct, gridinfo3d_t* grid3d);
+/*zero out LU non zero entries*/
+extern int_t szeroSetLU(int_t nnodes, int_t* nodeList , sLUstruct_t *, gridinfo3d_t*);
+extern int AllocGlu_3d(int_t n, int_t nsupers, sLUstruct_t *);
+extern int DeAllocLlu_3d(int_t n, sLUstruct_t *, gridinfo3d_t*);
+extern int DeAllocGlu_3d(sLUstruct_t *);
+
+/* Reduces L and U panels of nodes in the List nodeList (size=nnnodes)
+receiver[L(nodelist)] =sender[L(nodelist)] +receiver[L(nodelist)]
+receiver[U(nodelist)] =sender[U(nodelist)] +receiver[U(nodelist)]
+*/
+int_t sreduceAncestors3d(int_t sender, int_t receiver,
+                        int_t nnodes, int_t* nodeList,
+                        float* Lval_buf, float* Uval_buf,
+                        sLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+/*reduces all nodelists required in a level*/
+int_t sreduceAllAncestors3d(int_t ilvl, int_t* myNodeCount,
+                           int_t** treePerm,
+                           sLUValSubBuf_t* LUvsb,
+                           sLUstruct_t* LUstruct,
+                           gridinfo3d_t* grid3d,
+                           SCT_t* SCT );
+/*
+	Copies factored L and U panels from sender grid to receiver grid
+	receiver[L(nodelist)] <-- sender[L(nodelist)];
+	receiver[U(nodelist)] <-- sender[U(nodelist)];
+*/
+int_t sgatherFactoredLU(int_t sender, int_t receiver,
+                       int_t nnodes, int_t *nodeList, sLUValSubBuf_t*  LUvsb,
+                       sLUstruct_t* LUstruct, gridinfo3d_t* grid3d,SCT_t* SCT );
+
+/*Gathers all the L and U factors to grid 0 for solve stage 
+	By  repeatidly calling above function*/
+int_t sgatherAllFactoredLU(trf3Dpartition_t*  trf3Dpartition, sLUstruct_t* LUstruct,
+			   gridinfo3d_t* grid3d, SCT_t* SCT );
+
+/*Distributes data in each layer and initilizes ancestors
+ as zero in required nodes*/
+int_t sinit3DLUstruct( int_t* myTreeIdxs, int_t* myZeroTrIdxs,
+                      int_t* nodeCount, int_t** nodeList,
+                      sLUstruct_t* LUstruct, gridinfo3d_t* grid3d);
+
+int_t szSendLPanel(int_t k, int_t receiver,
+		   sLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+int_t szRecvLPanel(int_t k, int_t sender, float alpha, 
+                   float beta, float* Lval_buf,
+		   sLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+int_t szSendUPanel(int_t k, int_t receiver,
+		   sLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+int_t szRecvUPanel(int_t k, int_t sender, float alpha,
+                   float beta, float* Uval_buf,
+		   sLUstruct_t* LUstruct,  gridinfo3d_t* grid3d, SCT_t* SCT);
+
+    /* from communication_aux.h */
+extern int_t sIBcast_LPanel (int_t k, int_t k0, int_t* lsub, float* lusup,
+			     gridinfo_t *, int* msgcnt, MPI_Request *,
+			     int_t **ToSendR, int_t *xsup, int );
+extern int_t sBcast_LPanel(int_t k, int_t k0, int_t* lsub, float* lusup,
+			   gridinfo_t *, int* msgcnt, int_t **ToSendR,
+			   int_t *xsup , SCT_t*, int);
+extern int_t sIBcast_UPanel(int_t k, int_t k0, int_t* usub, float* uval,
+			    gridinfo_t *, int* msgcnt, MPI_Request *,
+			    int_t *ToSendD, int );
+extern int_t sBcast_UPanel(int_t k, int_t k0, int_t* usub, float* uval,
+			   gridinfo_t *, int* msgcnt, int_t *ToSendD, SCT_t*, int);
+extern int_t sIrecv_LPanel (int_t k, int_t k0,  int_t* Lsub_buf, 
+			    float* Lval_buf, gridinfo_t *,
+			    MPI_Request *, sLocalLU_t *, int);
+extern int_t sIrecv_UPanel(int_t k, int_t k0, int_t* Usub_buf, float*,
+			   sLocalLU_t *, gridinfo_t*, MPI_Request *, int);
+extern int_t Wait_LSend(int_t k, gridinfo_t *grid, int_t **ToSendR,
+			MPI_Request *s, SCT_t*);
+extern int_t Wait_USend(MPI_Request *, gridinfo_t *, SCT_t *);
+extern int_t sWait_URecv(MPI_Request *, int* msgcnt, SCT_t *);
+extern int_t Check_LRecv(MPI_Request*, int* msgcnt);
+extern int_t sWait_LRecv(MPI_Request*, int* msgcnt, int* msgcntsU,
+			 gridinfo_t *, SCT_t*);
+extern int_t sISend_UDiagBlock(int_t k0, float *ublk_ptr, int_t size,
+			       MPI_Request *, gridinfo_t *, int);
+extern int_t sRecv_UDiagBlock(int_t k0, float *ublk_ptr, int_t size,
+			      int_t src, gridinfo_t *, SCT_t*, int);
+extern int_t Wait_UDiagBlockSend(MPI_Request *, gridinfo_t *, SCT_t *);
+extern int_t Wait_LDiagBlockSend(MPI_Request *, gridinfo_t *, SCT_t *);
+extern int_t sPackLBlock(int_t k, float* Dest, Glu_persist_t *,
+			 gridinfo_t *, sLocalLU_t *);
+extern int_t sISend_LDiagBlock(int_t k0, float *lblk_ptr, int_t size,
+			       MPI_Request *, gridinfo_t *, int);
+extern int_t sIRecv_UDiagBlock(int_t k0, float *ublk_ptr, int_t size,
+			       int_t src, MPI_Request *, gridinfo_t *,
+			       SCT_t*, int);
+extern int_t Wait_UDiagBlock_Recv(MPI_Request *, SCT_t *);
+extern int_t Test_UDiagBlock_Recv(MPI_Request *, SCT_t *);
+extern int_t sIRecv_LDiagBlock(int_t k0, float *L_blk_ptr, int_t size,
+			       int_t src, MPI_Request *, gridinfo_t*, SCT_t*, int);
+extern int_t Wait_LDiagBlock_Recv(MPI_Request *, SCT_t *);
+extern int_t Test_LDiagBlock_Recv(MPI_Request *, SCT_t *);
+
+extern int_t sUDiagBlockRecvWait( int_t k,  int_t* IrecvPlcd_D, int_t* factored_L,
+				  MPI_Request *, gridinfo_t *, sLUstruct_t *, SCT_t *);
+extern int_t LDiagBlockRecvWait( int_t k, int_t* factored_U, MPI_Request *, gridinfo_t *);
+#if (MPI_VERSION>2)
+extern int_t sIBcast_UDiagBlock(int_t k, float *ublk_ptr, int_t size,
+				MPI_Request *, gridinfo_t *);
+extern int_t sIBcast_LDiagBlock(int_t k, float *lblk_ptr, int_t size,
+			       MPI_Request *, gridinfo_t *);
+#endif
+
+    /* from trfCommWrapper.h */
+extern int_t sDiagFactIBCast(int_t k,  int_t k0,
+			     float *BlockUFactor, float *BlockLFactor,
+			     int_t* IrecvPlcd_D, MPI_Request *, MPI_Request *,
+			     MPI_Request *, MPI_Request *, gridinfo_t *,
+			     superlu_dist_options_t *, float thresh,
+			     sLUstruct_t *LUstruct, SuperLUStat_t *, int *info,
+			     SCT_t *, int tag_ub);
+extern int_t sUPanelTrSolve( int_t k, float* BlockLFactor, float* bigV,
+			     int_t ldt, Ublock_info_t*, gridinfo_t *,
+			     sLUstruct_t *, SuperLUStat_t *, SCT_t *);
+extern int_t Wait_LUDiagSend(int_t k, MPI_Request *, MPI_Request *,
+			     gridinfo_t *, SCT_t *);
+extern int_t sLPanelUpdate(int_t k,  int_t* IrecvPlcd_D, int_t* factored_L,
+			   MPI_Request *, float* BlockUFactor, gridinfo_t *,
+			   sLUstruct_t *, SCT_t *);
+extern int_t sUPanelUpdate(int_t k, int_t* factored_U, MPI_Request *,
+			   float* BlockLFactor, float* bigV,
+			   int_t ldt, Ublock_info_t*, gridinfo_t *,
+			   sLUstruct_t *, SuperLUStat_t *, SCT_t *);
+extern int_t sIBcastRecvLPanel(int_t k, int_t k0, int* msgcnt,
+			       MPI_Request *, MPI_Request *,
+			       int_t* Lsub_buf, float* Lval_buf,
+			      int_t * factored, gridinfo_t *, sLUstruct_t *,
+			      SCT_t *, int tag_ub);
+extern int_t sIBcastRecvUPanel(int_t k, int_t k0, int* msgcnt, MPI_Request *,
+			       MPI_Request *, int_t* Usub_buf, float* Uval_buf,
+			       gridinfo_t *, sLUstruct_t *, SCT_t *, int tag_ub);
+extern int_t sWaitL(int_t k, int* msgcnt, int* msgcntU, MPI_Request *,
+		    MPI_Request *, gridinfo_t *, sLUstruct_t *, SCT_t *);
+extern int_t sWaitU(int_t k, int* msgcnt, MPI_Request *, MPI_Request *,
+		   gridinfo_t *, sLUstruct_t *, SCT_t *);
+extern int_t sLPanelTrSolve(int_t k, int_t* factored_L, float* BlockUFactor,
+			    gridinfo_t *, sLUstruct_t *);
+
+    /* from trfAux.h */
+extern int_t getNsupers(int, sLUstruct_t *);
+extern int_t initPackLUInfo(int_t nsupers, packLUInfo_t* packLUInfo);
+extern int   freePackLUInfo(packLUInfo_t* packLUInfo);
+extern int_t sSchurComplementSetup(int_t k, int *msgcnt, Ublock_info_t*,
+				   Remain_info_t*, uPanelInfo_t *,
+				   lPanelInfo_t *, int_t*, int_t *, int_t *,
+				   float *bigU, int_t* Lsub_buf,
+				   float* Lval_buf, int_t* Usub_buf,
+				   float* Uval_buf, gridinfo_t *, sLUstruct_t *);
+extern int_t sSchurComplementSetupGPU(int_t k, msgs_t* msgs, packLUInfo_t*,
+				      int_t*, int_t*, int_t*, gEtreeInfo_t*,
+				      factNodelists_t*, scuBufs_t*,
+				      sLUValSubBuf_t* LUvsb, gridinfo_t *,
+				      sLUstruct_t *, HyP_t*);
+extern float* sgetBigV(int_t, int_t);
+extern float* sgetBigU(int_t, gridinfo_t *, sLUstruct_t *);
+extern int_t getBigUSize(int_t, gridinfo_t *, sLUstruct_t *);
+// permutation from superLU default
+extern int_t* getPerm_c_supno(int_t nsupers, superlu_dist_options_t *,
+			      sLUstruct_t *, gridinfo_t *);
+extern void getSCUweight(int_t nsupers, treeList_t* treeList, sLUstruct_t *, gridinfo3d_t *);
+
+    /* from treeFactorization.h */
+extern int_t sLluBufInit(sLUValSubBuf_t*, sLUstruct_t *);
+extern int_t sinitScuBufs(int_t ldt, int_t num_threads, int_t nsupers,
+			  scuBufs_t*, sLUstruct_t*, gridinfo_t *);
+extern int sfreeScuBufs(scuBufs_t* scuBufs);
+
+// the generic tree factoring code 
+extern int_t treeFactor(
+    int_t nnnodes,          // number of nodes in the tree
+    int_t *perm_c_supno,    // list of nodes in the order of factorization
+    commRequests_t *comReqs,    // lists of communication requests
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t*msgs,
+    sLUValSubBuf_t* LUvsb,
+    diagFactBufs_t *sFBuf,
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    sLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT,
+    int *info
+);
+
+extern int_t ssparseTreeFactor(
+    int_t nnodes,          // number of nodes in the tree
+    int_t *perm_c_supno,    // list of nodes in the order of factorization
+    treeTopoInfo_t* treeTopoInfo,
+    commRequests_t *comReqs,    // lists of communication requests
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t*msgs,
+    sLUValSubBuf_t* LUvsb,
+    diagFactBufs_t *sFBuf,
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    sLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT,
+    int *info
+);
+
+extern int_t sdenseTreeFactor(
+    int_t nnnodes,          // number of nodes in the tree
+    int_t *perm_c_supno,    // list of nodes in the order of factorization
+    commRequests_t *comReqs,    // lists of communication requests
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t*msgs,
+    sLUValSubBuf_t* LUvsb,
+    diagFactBufs_t *sFBuf,
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    sLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT, int tag_ub,
+    int *info
+);
+
+extern int_t ssparseTreeFactor_ASYNC(
+    sForest_t* sforest,
+    commRequests_t **comReqss,    // lists of communication requests // size maxEtree level
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t**msgss,                  // size=num Look ahead
+    sLUValSubBuf_t** LUvsbs,          // size=num Look ahead
+    diagFactBufs_t **sFBufs,         // size maxEtree level
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    gEtreeInfo_t*   gEtreeInfo,        // global etree info
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    HyP_t* HyP,
+    sLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT, int tag_ub,
+    int *info
+);
+extern sLUValSubBuf_t** sLluBufInitArr(int_t numLA, sLUstruct_t *LUstruct);
+extern int sLluBufFreeArr(int_t numLA, sLUValSubBuf_t **LUvsbs);
+extern diagFactBufs_t** sinitDiagFactBufsArr(int_t mxLeafNode, int_t ldt, gridinfo_t* grid);
+extern int sfreeDiagFactBufsArr(int_t mxLeafNode, diagFactBufs_t** sFBufs);
+extern int_t sinitDiagFactBufs(int_t ldt, diagFactBufs_t* sFBuf);
+extern int_t checkRecvUDiag(int_t k, commRequests_t *comReqs,
+			    gridinfo_t *grid, SCT_t *SCT);
+extern int_t checkRecvLDiag(int_t k, commRequests_t *comReqs, gridinfo_t *, SCT_t *);
+
+    /* from ancFactorization.h (not called) */
+extern int_t ancestorFactor(
+    int_t ilvl,             // level of factorization 
+    sForest_t* sforest,
+    commRequests_t **comReqss,    // lists of communication requests // size maxEtree level
+    scuBufs_t *scuBufs,          // contains buffers for schur complement update
+    packLUInfo_t*packLUInfo,
+    msgs_t**msgss,                  // size=num Look ahead
+    sLUValSubBuf_t** LUvsbs,          // size=num Look ahead
+    diagFactBufs_t **sFBufs,         // size maxEtree level
+    factStat_t *factStat,
+    factNodelists_t  *fNlists,
+    gEtreeInfo_t*   gEtreeInfo,        // global etree info
+    superlu_dist_options_t *options,
+    int_t * gIperm_c_supno,
+    int_t ldt,
+    HyP_t* HyP,
+    sLUstruct_t *LUstruct, gridinfo3d_t * grid3d, SuperLUStat_t *stat,
+    float thresh,  SCT_t *SCT, int tag_ub, int *info
+);
+
+/*=====================*/
+#endif  // end 3D prototypes
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif /* __SUPERLU_sDEFS */
+
@@ -0,0 +1,159 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Node-shared storage of the arrays replicated on all processes
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * perm_r[], perm_c[], etree[] and the supernode partition xsup[]/supno[]
+ * have full length and are identical on all processes. With
+ * options->ShareReplicated = YES, pdgssvx() moves them after the
+ * factorization into an MPI-3 shared memory window, so that the processes
+ * of a node keep a single copy. The shared arrays are read-only; they are
+ * made private again (superlu_shm_unshare) before they are recomputed,
+ * and must be freed with superlu_shm_free(), which is collective over the
+ * processes of the node.
+ * </pre>
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include "superlu_defs.h"
+
+typedef struct shm_seg {
+    void     *base;    /* shared copy */
+    MPI_Win  win;
+    MPI_Comm comm;     /* processes of the node */
+    struct shm_seg *next;
+} shm_seg_t;
+
+/* The segments of all the threads of the process, only read and written
+   under shm_segs_lock. */
+static shm_seg_t *shm_segs = NULL;
+static pthread_mutex_t shm_segs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Return the segment of ptr; it is unlinked from the list if unlink. */
+static shm_seg_t *find_seg(void *ptr, int unlink)
+{
+    shm_seg_t **p, *seg = NULL;
+
+    pthread_mutex_lock(&shm_segs_lock);
+    for (p = &shm_segs; *p; p = &(*p)->next)
+	if ( (*p)->base == ptr ) {
+	    seg = *p;
+	    if ( unlink ) *p = seg->next;
+	    break;
+	}
+    pthread_mutex_unlock(&shm_segs_lock);
+    return seg;
+}
+
+/*! \brief Replace the private array *ptr by a copy shared within the node.
+ *
+ * <pre>
+ * Collective over grid->comm. *ptr must hold the same bytes on all the
+ * processes; it is freed and set to the shared copy. Returns 1 if the
+ * array is now shared, 0 if it was left alone (one process per node, or
+ * no MPI-3 shared memory).
+ * </pre>
+ */
+int superlu_shm_share(void **ptr, size_t bytes, gridinfo_t *grid)
+{
+#if MPI_VERSION >= 3
+    MPI_Comm comm;
+    MPI_Win  win;
+    MPI_Aint size;
+    shm_seg_t *seg;
+    void *base;
+    int rank, nprocs, disp;
+
+    if ( !*ptr || !bytes || find_seg(*ptr, 0) ) return 0;
+
+    MPI_Comm_split_type(grid->comm, MPI_COMM_TYPE_SHARED, grid->iam,
+			MPI_INFO_NULL, &comm);
+    MPI_Comm_size(comm, &nprocs);
+    if ( nprocs == 1 ) {
+	MPI_Comm_free(&comm);
+	return 0;
+    }
+    MPI_Comm_rank(comm, &rank);
+
+    /* The first process of the node holds the array. */
+    MPI_Win_allocate_shared(rank ? 0 : (MPI_Aint) bytes, 1, MPI_INFO_NULL,
+			    comm, &base, &win);
+    MPI_Win_shared_query(win, 0, &size, &disp, &base);
+    MPI_Win_fence(0, win);
+    if ( !rank ) memcpy(base, *ptr, bytes);
+    MPI_Win_fence(0, win);
+
+    if ( !(seg = (shm_seg_t *) SUPERLU_MALLOC(sizeof(shm_seg_t))) )
+	ABORT("Malloc fails for shm_seg_t.");
+    seg->base = base;
+    seg->win = win;
+    seg->comm = comm;
+    pthread_mutex_lock(&shm_segs_lock);
+    seg->next = shm_segs;
+    shm_segs = seg;
+    pthread_mutex_unlock(&shm_segs_lock);
+
+    SUPERLU_FREE(*ptr);
+    *ptr = base;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/*! \brief Make a private copy of *ptr if it is shared.
+ *
+ * <pre>
+ * Collective over the processes of the node if *ptr is shared; does
+ * nothing otherwise. Returns 1 if *ptr was shared.
+ * </pre>
+ */
+int superlu_shm_unshare(void **ptr, size_t bytes)
+{
+    void *buf;
+
+    if ( !*ptr || !find_seg(*ptr, 0) ) return 0;
+
+    if ( !(buf = SUPERLU_MALLOC(bytes)) )
+	ABORT("Malloc fails for the private copy of a shared array.");
+    memcpy(buf, *ptr, bytes);
+    superlu_shm_free(*ptr);
+    *ptr = buf;
+    return 1;
+}
+
+/*! \brief Free an array that may be shared by superlu_shm_share().
+ *
+ * <pre>
+ * Collective over the processes of the node if ptr is shared; the same
+ * as SUPERLU_FREE(ptr) otherwise.
+ * </pre>
+ */
+void superlu_shm_free(void *ptr)
+{
+    shm_seg_t *seg;
+
+    if ( (seg = find_seg(ptr, 1)) ) {
+#if MPI_VERSION >= 3
+	MPI_Win_free(&seg->win);
+	MPI_Comm_free(&seg->comm);
+	SUPERLU_FREE(seg);
+#endif
+    } else {
+	SUPERLU_FREE(ptr);
+    }
+}
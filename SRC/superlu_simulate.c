@@ -0,0 +1,449 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Simulation of the schedules of the factorization and the solve
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * superlu_simulate() replays the right-looking factorization of pdgstrf()
+ * and the triangular solves of pdgstrs() on the supernodal structure of
+ * symbfact(), dealt out block-cyclically to an nprow x npcol grid as in
+ * superlu_predict(), with a simple machine model: the GEMM rate of one
+ * thread, less efficient on narrow supernodes, and the latency and the
+ * bandwidth of a message. It predicts the time of both for a candidate
+ * grid, look-ahead depth and thread count, without running them.
+ *
+ * The factorization is simulated step by step. The panel of supernode k
+ * is factored once the steps updating it are done: for a step within the
+ * look-ahead window, as soon as its panels have arrived, the look-ahead
+ * blocks being updated first; else once the whole Schur complement update
+ * of that step is. The panels are sent one message per destination, and
+ * each process updates its blocks after its previous update and the
+ * arrival of the panels. The solves follow the dependencies between the
+ * supernodes, one message for each block, bounded below by the work of
+ * the busiest process; their products are as narrow as the number of
+ * right-hand sides, hence as slow as the GEMMs of as narrow supernodes.
+ *
+ * The machine is described by SUPERLU_SIM_MACHINE="gflops,latency,bw": the
+ * GEMM GFLOP/s of one thread, the latency of a message in microseconds and
+ * the bandwidth in GB/s; by default 10,2,10. With options->Predict = YES,
+ * pdgssvx() prints the simulation of its grid and of the candidates of
+ * SUPERLU_SIMULATE, a list of "nprowxnpcol[:lookaheads[:threads]]"
+ * separated by commas, e.g. SUPERLU_SIMULATE=4x4,8x4:4,8x8:8:2.
+ *
+ * The model ignores the contention of the network, the overlap of the
+ * communication with the computation within a step, the row pivoting and
+ * the GPU; it is meant to rank the candidates, calibrated on a run of
+ * the grid at hand by adjusting the machine.
+ * </pre>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "superlu_defs.h"
+
+/* Width of a supernode at which the GEMM runs at half of its rate. */
+#define SIM_HALF_WIDTH 16.0
+
+/*! \brief Machine of SUPERLU_SIM_MACHINE, or the default one. */
+void superlu_machine_default(superlu_machine_t *machine)
+{
+    char *ttemp = getenv("SUPERLU_SIM_MACHINE");
+    double v[3] = {10.0, 2.0, 10.0};
+
+    if ( ttemp ) sscanf(ttemp, "%lf,%lf,%lf", &v[0], &v[1], &v[2]);
+    machine->gflops = v[0] > 0.0 ? v[0] : 10.0;
+    machine->latency = v[1] >= 0.0 ? v[1] * 1e-6 : 2e-6;
+    machine->bandwidth = v[2] > 0.0 ? v[2] * 1e9 : 1e10;
+}
+
+/* Seconds of flops on one thread of a supernode of width w. */
+static double sim_flops(superlu_machine_t *machine, double flops, double w)
+{
+    return flops * (w + SIM_HALF_WIDTH) / (w * machine->gflops * 1e9);
+}
+
+/* Seconds of a message of the given bytes. */
+static double sim_msg(superlu_machine_t *machine, double bytes)
+{
+    return machine->latency + bytes / machine->bandwidth;
+}
+
+/* Number of steps of a tree over cnt processes. */
+static double sim_depth(int cnt)
+{
+    int d = 0;
+    while ( (1 << d) < cnt ) ++d;
+    return (double) d;
+}
+
+/* One block of supernode k in a triangular solve, of nnz entries on
+   process p: x_k arrives at xk + bcast, the product is reduced along the
+   process row onto the diagonal process of block row kb, of width wkb. */
+static void sim_solve_block(superlu_machine_t *machine, double xk,
+			    double nnz, int_t kb, double wkb, int nrhs,
+			    int dsize, double bcast, double rdepth, int p,
+			    double *work, double *ready)
+{
+    double t = sim_flops(machine, 2.0 * nnz * nrhs, (double) nrhs);
+    work[p] += t;
+    t += xk + bcast + rdepth * sim_msg(machine, wkb * nrhs * dsize);
+    ready[kb] = SUPERLU_MAX(ready[kb], t);
+}
+
+/*! \brief Simulate the factorization and the solve on one configuration.
+ *
+ * <pre>
+ * Arguments
+ * =========
+ * n       (input) int_t
+ *         The order of the matrix.
+ * Glu_persist, Glu_freeable (input)
+ *         The supernodes and the structure of L and U from symbfact().
+ * nprow, npcol (input) int
+ *         The shape of the process grid.
+ * lookaheads (input) int
+ *         The look-ahead depth, as options->num_lookaheads.
+ * nthreads (input) int
+ *         The number of OpenMP threads per process.
+ * nrhs    (input) int
+ *         The number of right-hand sides of the solve.
+ * dsize   (input) int
+ *         The size of one entry of the factors, e.g. sizeof(double).
+ * machine (input) superlu_machine_t*
+ * t_fact, t_solve (output) double*
+ *         The predicted seconds of pdgstrf() and of pdgstrs().
+ * </pre>
+ */
+void superlu_simulate(int_t n, Glu_persist_t *Glu_persist,
+		      Glu_freeable_t *Glu_freeable, int nprow, int npcol,
+		      int lookaheads, int nthreads, int nrhs, int dsize,
+		      superlu_machine_t *machine,
+		      double *t_fact, double *t_solve)
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *lsub = Glu_freeable->lsub, *xlsub = Glu_freeable->xlsub;
+    int_t *usub = Glu_freeable->usub, *xusub = Glu_freeable->xusub;
+    int_t nsupers, i, j, k, kb, kj, b, fsupc, len, nlist;
+    int_t *mark, *fill, *ubptr, *ubsup, *lbptr, *lbsup, *list;
+    int P = nprow * npcol, p, pr, pc, prk, pck, nd, cnt;
+    int iword = sizeof(int_t);
+    double *ubnnz, *avail, *work, *Lrows, *Lblks, *Unnz, *Ublks;
+    double *done, *arrive, *ready, *nnz;
+    double w, t, t0, start, tpanel, tl, tu, send, bytes, tmax, crit, wmax;
+
+    *t_fact = *t_solve = 0.0;
+    if ( n <= 0 ) return;
+    nsupers = supno[n-1] + 1;
+    if ( nthreads < 1 ) nthreads = 1;
+    if ( lookaheads < 0 ) lookaheads = 0;
+    if ( nrhs < 1 ) nrhs = 1;
+
+    if ( !(mark = intMalloc_dist(5 * nsupers + 2)) )
+	ABORT("Malloc fails for mark[].");
+    fill = mark + nsupers;
+    list = fill + nsupers;
+    ubptr = list + nsupers;
+    lbptr = ubptr + nsupers + 1;
+    if ( !(avail = (double *) SUPERLU_MALLOC((2 * P + 2 * nprow + 2 * npcol
+					      + 4 * nsupers) * sizeof(double))) )
+	ABORT("Malloc fails for avail[].");
+    work = avail + P;
+    Lrows = work + P;
+    Lblks = Lrows + nprow;
+    Unnz = Lblks + nprow;
+    Ublks = Unnz + npcol;
+    done = Ublks + npcol;
+    arrive = done + nsupers;
+    ready = arrive + nsupers;
+    nnz = ready + nsupers;
+
+    /* Blocks U(kb,kj) by block row, with their nonzeros, and the block
+       rows of the blocks of L below the diagonal, as in superlu_predict(). */
+    for (k = 0; k <= nsupers; ++k) ubptr[k] = lbptr[k] = 0;
+    for (k = 0; k < nsupers; ++k) mark[k] = EMPTY;
+    for (j = 0; j < n; ++j) {
+	kj = supno[j];
+	for (i = xusub[j]; i < xusub[j+1]; ++i) {
+	    kb = supno[usub[i]];
+	    if ( kb < kj && mark[kb] != kj ) { mark[kb] = kj; ++ubptr[kb+1]; }
+	}
+    }
+    for (k = 0; k < nsupers; ++k) ubptr[k+1] += ubptr[k];
+    len = SUPERLU_MAX(ubptr[nsupers], 1);
+    if ( !(ubsup = intMalloc_dist(len)) ) ABORT("Malloc fails for ubsup[].");
+    if ( !(ubnnz = (double *) SUPERLU_MALLOC(len * sizeof(double))) )
+	ABORT("Malloc fails for ubnnz[].");
+    for (k = 0; k < nsupers; ++k) { fill[k] = ubptr[k]; mark[k] = EMPTY; }
+    for (j = 0; j < n; ++j) {
+	kj = supno[j];
+	for (i = xusub[j]; i < xusub[j+1]; ++i) {
+	    kb = supno[usub[i]];
+	    if ( kb >= kj ) continue;
+	    if ( mark[kb] != kj ) {
+		mark[kb] = kj;
+		ubsup[fill[kb]] = kj;
+		ubnnz[fill[kb]++] = 0.0;
+	    }
+	    ubnnz[fill[kb] - 1] += xsup[kb+1] - usub[i];
+	}
+    }
+
+    for (k = 0; k < nsupers; ++k) mark[k] = EMPTY;
+    for (k = 0; k < nsupers; ++k) {
+	fsupc = xsup[k];
+	for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
+	    kb = supno[lsub[i]];
+	    if ( kb > k && mark[kb] != k ) { mark[kb] = k; ++lbptr[kb+1]; }
+	}
+    }
+    for (k = 0; k < nsupers; ++k) lbptr[k+1] += lbptr[k];
+    if ( !(lbsup = intMalloc_dist(SUPERLU_MAX(lbptr[nsupers], 1))) )
+	ABORT("Malloc fails for lbsup[].");
+    for (k = 0; k < nsupers; ++k) { fill[k] = lbptr[k]; mark[k] = EMPTY; }
+    for (k = 0; k < nsupers; ++k) {
+	fsupc = xsup[k];
+	for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
+	    kb = supno[lsub[i]];
+	    if ( kb > k && mark[kb] != k ) { mark[kb] = k; lbsup[fill[kb]++] = k; }
+	}
+    }
+
+    /*-- The factorization. --*/
+    for (p = 0; p < P; ++p) avail[p] = 0.0;
+    for (k = 0; k < nsupers; ++k) mark[k] = EMPTY;
+    for (k = 0; k < nsupers; ++k) {
+	fsupc = xsup[k];
+	w = xsup[k+1] - fsupc;
+	prk = k % nprow;
+	pck = k % npcol;
+
+	/* L(:,k) below the diagonal block and U(k,:), by process. */
+	for (pr = 0; pr < nprow; ++pr) Lrows[pr] = Lblks[pr] = 0.0;
+	for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
+	    kb = supno[lsub[i]];
+	    if ( kb == k ) continue;
+	    pr = kb % nprow;
+	    Lrows[pr] += 1.0;
+	    if ( mark[kb] != k ) { mark[kb] = k; Lblks[pr] += 1.0; }
+	}
+	for (pc = 0; pc < npcol; ++pc) Unnz[pc] = Ublks[pc] = 0.0;
+	for (b = ubptr[k]; b < ubptr[k+1]; ++b) {
+	    pc = ubsup[b] % npcol;
+	    Unnz[pc] += ubnnz[b];
+	    Ublks[pc] += UB_DESCRIPTOR + xsup[ubsup[b]+1] - xsup[ubsup[b]];
+	}
+
+	/* The panels can be factored once the steps updating them are
+	   done: U(j,k) != 0 for L(:,k), L(k,j) != 0 for U(k,:). */
+	t0 = 0.0;
+	for (j = fsupc; j < xsup[k+1]; ++j)
+	    for (i = xusub[j]; i < xusub[j+1]; ++i) {
+		kb = supno[usub[i]];
+		if ( kb >= k ) continue;
+		t = k - kb <= lookaheads ? arrive[kb] : done[kb];
+		t0 = SUPERLU_MAX(t0, t);
+	    }
+	for (b = lbptr[k]; b < lbptr[k+1]; ++b) {
+	    kb = lbsup[b];
+	    t = k - kb <= lookaheads ? arrive[kb] : done[kb];
+	    t0 = SUPERLU_MAX(t0, t);
+	}
+	p = prk * npcol + pck;
+	if ( lookaheads == 0 ) t0 = SUPERLU_MAX(t0, avail[p]);
+
+	/* The diagonal block, sent to the panels, then the panels. */
+	t = sim_flops(machine, 2.0 / 3.0 * w * w * w, w);
+	avail[p] += t;
+	start = t0 + t;
+	if ( P > 1 ) start += sim_msg(machine, w * w * dsize);
+	tpanel = 0.0;
+	for (pr = 0; pr < nprow; ++pr) {
+	    t = sim_flops(machine, Lrows[pr] * w * w, w);
+	    avail[pr * npcol + pck] += t;
+	    tpanel = SUPERLU_MAX(tpanel, t);
+	}
+	for (pc = 0; pc < npcol; ++pc) {
+	    t = sim_flops(machine, Unnz[pc] * w, w);
+	    avail[prk * npcol + pc] += t;
+	    tpanel = SUPERLU_MAX(tpanel, t);
+	}
+	t0 = start + tpanel;
+
+	/* L(:,k) to the process columns of U(k,:), U(k,:) to the process
+	   rows of L(:,k), one message after the other. */
+	send = 0.0;
+	for (nd = 0, pc = 0; pc < npcol; ++pc) if ( pc != pck && Unnz[pc] ) ++nd;
+	for (pr = 0; pr < nprow && nd; ++pr) {
+	    len = Lrows[pr] + (pr == prk ? w : 0);
+	    if ( !len ) continue;
+	    bytes = (double) len * w * dsize
+		+ (len + BC_HEADER + Lblks[pr] * LB_DESCRIPTOR) * iword;
+	    send = SUPERLU_MAX(send, nd * bytes / machine->bandwidth
+			       + machine->latency);
+	}
+	for (nd = 0, pr = 0; pr < nprow; ++pr) if ( pr != prk && Lrows[pr] ) ++nd;
+	for (pc = 0; pc < npcol && nd; ++pc) {
+	    if ( !Unnz[pc] ) continue;
+	    bytes = Unnz[pc] * dsize + (Ublks[pc] + BR_HEADER) * iword;
+	    send = SUPERLU_MAX(send, nd * bytes / machine->bandwidth
+			       + machine->latency);
+	}
+	arrive[k] = t0 + send;
+
+	/* The Schur complement update of each process. */
+	done[k] = t0;
+	for (pr = 0; pr < nprow; ++pr) {
+	    if ( !Lrows[pr] ) continue;
+	    for (pc = 0; pc < npcol; ++pc) {
+		if ( !Unnz[pc] ) continue;
+		p = pr * npcol + pc;
+		t = sim_flops(machine, 2.0 * Lrows[pr] * Unnz[pc], w) / nthreads;
+		avail[p] = SUPERLU_MAX(avail[p], arrive[k]) + t;
+		done[k] = SUPERLU_MAX(done[k], avail[p]);
+	    }
+	}
+    }
+    for (tmax = 0.0, p = 0; p < P; ++p) tmax = SUPERLU_MAX(tmax, avail[p]);
+    for (k = 0; k < nsupers; ++k) tmax = SUPERLU_MAX(tmax, done[k]);
+    *t_fact = tmax;
+
+    /*-- The L solve: x_k is broadcast down its process column to the
+      blocks L(kb,k), the products reduced along the process rows. --*/
+    for (p = 0; p < P; ++p) work[p] = 0.0;
+    for (k = 0; k < nsupers; ++k) { ready[k] = 0.0; nnz[k] = 0.0; }
+    crit = 0.0;
+    for (k = 0; k < nsupers; ++k) {
+	fsupc = xsup[k];
+	w = xsup[k+1] - fsupc;
+	pck = k % npcol;
+	p = (k % nprow) * npcol + pck;
+	t = sim_flops(machine, w * w * nrhs, (double) nrhs);
+	work[p] += t;
+	t0 = ready[k] + t;
+	crit = SUPERLU_MAX(crit, t0);
+
+	for (nlist = 0, i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
+	    kb = supno[lsub[i]];
+	    if ( kb == k ) continue;
+	    if ( nnz[kb] == 0.0 ) list[nlist++] = kb;
+	    nnz[kb] += w;
+	}
+	for (cnt = 1, pr = 0; pr < nprow; ++pr) Lrows[pr] = 0.0;
+	for (i = 0; i < nlist; ++i) Lrows[list[i] % nprow] = 1.0;
+	for (pr = 0; pr < nprow; ++pr)
+	    if ( pr != k % nprow && Lrows[pr] ) ++cnt;
+	start = sim_depth(cnt) * sim_msg(machine, w * nrhs * dsize);
+	for (i = 0; i < nlist; ++i) {
+	    kb = list[i];
+	    sim_solve_block(machine, t0, nnz[kb], kb,
+			    (double) (xsup[kb+1] - xsup[kb]), nrhs, dsize,
+			    start, sim_depth(npcol),
+			    (kb % nprow) * npcol + pck, work, ready);
+	    nnz[kb] = 0.0;
+	}
+    }
+    for (wmax = 0.0, p = 0; p < P; ++p) wmax = SUPERLU_MAX(wmax, work[p]);
+    tl = SUPERLU_MAX(crit, wmax);
+
+    /*-- The U solve, backward, with the blocks U(kb,k) of the columns of
+      supernode k. --*/
+    for (p = 0; p < P; ++p) work[p] = 0.0;
+    for (k = 0; k < nsupers; ++k) ready[k] = 0.0;
+    crit = 0.0;
+    for (k = nsupers - 1; k >= 0; --k) {
+	fsupc = xsup[k];
+	w = xsup[k+1] - fsupc;
+	pck = k % npcol;
+	p = (k % nprow) * npcol + pck;
+	t = sim_flops(machine, w * w * nrhs, (double) nrhs);
+	work[p] += t;
+	t0 = ready[k] + t;
+	crit = SUPERLU_MAX(crit, t0);
+
+	for (nlist = 0, j = fsupc; j < xsup[k+1]; ++j)
+	    for (i = xusub[j]; i < xusub[j+1]; ++i) {
+		kb = supno[usub[i]];
+		if ( kb >= k ) continue;
+		if ( nnz[kb] == 0.0 ) list[nlist++] = kb;
+		nnz[kb] += xsup[kb+1] - usub[i];
+	    }
+	for (cnt = 1, pr = 0; pr < nprow; ++pr) Lrows[pr] = 0.0;
+	for (i = 0; i < nlist; ++i) Lrows[list[i] % nprow] = 1.0;
+	for (pr = 0; pr < nprow; ++pr)
+	    if ( pr != k % nprow && Lrows[pr] ) ++cnt;
+	start = sim_depth(cnt) * sim_msg(machine, w * nrhs * dsize);
+	for (i = 0; i < nlist; ++i) {
+	    kb = list[i];
+	    sim_solve_block(machine, t0, nnz[kb], kb,
+			    (double) (xsup[kb+1] - xsup[kb]), nrhs, dsize,
+			    start, sim_depth(npcol),
+			    (kb % nprow) * npcol + pck, work, ready);
+	    nnz[kb] = 0.0;
+	}
+    }
+    for (wmax = 0.0, p = 0; p < P; ++p) wmax = SUPERLU_MAX(wmax, work[p]);
+    tu = SUPERLU_MAX(crit, wmax);
+    *t_solve = tl + tu;
+
+    SUPERLU_FREE(mark);
+    SUPERLU_FREE(avail);
+    SUPERLU_FREE(ubsup);
+    SUPERLU_FREE(ubnnz);
+    SUPERLU_FREE(lbsup);
+}
+
+/*! \brief Print the simulation of the grid and of SUPERLU_SIMULATE.
+ *
+ * <pre>
+ * The grid is nprow x npcol with options->num_lookaheads and nthreads;
+ * the candidates of SUPERLU_SIMULATE default to those. Called by process
+ * 0 of pdgssvx() with options->Predict = YES.
+ * </pre>
+ */
+void superlu_simulate_print(superlu_dist_options_t *options, int_t n,
+			    Glu_persist_t *Glu_persist,
+			    Glu_freeable_t *Glu_freeable, int nprow, int npcol,
+			    int nthreads, int nrhs, int dsize)
+{
+    superlu_machine_t machine;
+    char *list = getenv("SUPERLU_SIMULATE"), *s;
+    int r = nprow, c = npcol, la = options->num_lookaheads, nt = nthreads;
+    double tf, ts;
+
+    superlu_machine_default(&machine);
+    printf(".. Simulated for %d right-hand side(s), %.1f GFLOP/s per thread,"
+	   " latency %.1f us, %.1f GB/s:\n", SUPERLU_MAX(nrhs, 1),
+	   machine.gflops, machine.latency * 1e6, machine.bandwidth * 1e-9);
+    printf("\t%9s %10s %7s %12s %12s\n", "grid", "lookaheads", "threads",
+	   "factor (s)", "solve (s)");
+    s = list;
+    for (;;) {
+	if ( r > 0 && c > 0 ) {
+	    superlu_simulate(n, Glu_persist, Glu_freeable, r, c, la, nt, nrhs,
+			     dsize, &machine, &tf, &ts);
+	    printf("\t%4dx%-4d %10d %7d %12.4e %12.4e\n", r, c, la, nt, tf, ts);
+	}
+	if ( !s || !*s ) break;
+	r = c = 0;
+	la = options->num_lookaheads;
+	nt = nthreads;
+	sscanf(s, "%dx%d:%d:%d", &r, &c, &la, &nt);
+	s = strchr(s, ',');
+	if ( s ) ++s;
+    }
+    fflush(stdout);
+}
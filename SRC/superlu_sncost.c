@@ -0,0 +1,139 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Measured cost of each supernode in the factorization
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * With options->Sched_Priority = YES, or the environment variable
+ * SUPERLU_SN_COST set, pdgstrf() records in stat->sn_cost[3*k+i], for each
+ * supernode k:
+ *
+ *   i = SNCOST_PANEL  the flops of the factorization of the panels L(:,k)
+ *                     and U(k,:),
+ *   i = SNCOST_SCHUR  the flops of the Schur complement update by them,
+ *   i = SNCOST_BYTES  the bytes of the panels sent,
+ *
+ * summed over the processes at the end. pdgstrf() charges to a supernode
+ * the flops counted in stat->ops[FACT] and the bytes in stat->fact_sent
+ * since the previous charge, right after each panel is factored and sent
+ * and after each update; the dense root of pdgstrf_root() is charged to
+ * the last supernode. The counts are kept in double precision, and
+ * stat->ops[FACT] is more accurate at the end than if summed in flops_t.
+ *
+ * The record is copied to the LU structure (Llu->sn_cost), where the
+ * static schedule of the next factorization with the same structure
+ * (Fact = SamePattern_SameRowPerm) takes the measured weights in place of
+ * the estimated ones, see dstatic_schedule(). With SUPERLU_SN_COST set to
+ * a file name, process 0 also writes one line per supernode to it:
+ *
+ *     k size panel_flops schur_flops bytes
+ * </pre>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "superlu_defs.h"
+
+/*! \brief Start the record of a factorization of nsupers supernodes.
+ *
+ * <pre>
+ * Called by pdgstrf() after stat->ops[FACT] and stat->fact_sent are reset;
+ * does nothing unless the costs are recorded.
+ * </pre>
+ */
+void superlu_sncost_start(superlu_dist_options_t *options,
+			  SuperLUStat_t *stat, int_t nsupers)
+{
+    if ( options->Sched_Priority != YES && !getenv("SUPERLU_SN_COST") ) {
+	superlu_sncost_free(stat);
+	return;
+    }
+    if ( stat->sn_cost && stat->sn_nsupers != nsupers ) {
+	SUPERLU_FREE(stat->sn_cost);
+	stat->sn_cost = NULL;
+    }
+    if ( !stat->sn_cost &&
+	 !(stat->sn_cost = SUPERLU_MALLOC(3 * nsupers * sizeof(double))) )
+	ABORT("Malloc fails for stat->sn_cost[].");
+    memset(stat->sn_cost, 0, 3 * nsupers * sizeof(double));
+    stat->sn_nsupers = nsupers;
+    stat->sn_mark[0] = stat->ops[FACT];
+    stat->sn_mark[1] = stat->fact_sent;
+    stat->ops[FACT] = 0.0;
+}
+
+/*! \brief Charge the flops and the bytes since the last charge to k.
+ *
+ * <pre>
+ * kind is SNCOST_PANEL or SNCOST_SCHUR. Must not be called from a
+ * parallel region.
+ * </pre>
+ */
+void superlu_sncost_charge(SuperLUStat_t *stat, int kind, int_t k)
+{
+    double *cost = stat->sn_cost;
+
+    if ( !cost || k < 0 || k >= stat->sn_nsupers ) return;
+    cost[3 * k + kind] += stat->ops[FACT];
+    cost[3 * k + SNCOST_BYTES] += stat->fact_sent - stat->sn_mark[1];
+    stat->sn_mark[0] += stat->ops[FACT];
+    stat->sn_mark[1] = stat->fact_sent;
+    stat->ops[FACT] = 0.0;
+}
+
+/*! \brief End the record: sum it over the grid and keep it in *cost.
+ *
+ * <pre>
+ * *cost, of 3*nsupers entries, is allocated if NULL. Restores the total
+ * of stat->ops[FACT]. Collective over grid->comm if the costs are
+ * recorded.
+ * </pre>
+ */
+void superlu_sncost_finish(SuperLUStat_t *stat, int_t *xsup,
+			   gridinfo_t *grid, double **cost)
+{
+    int_t k, nsupers = stat->sn_nsupers;
+    char *file = getenv("SUPERLU_SN_COST");
+    FILE *fp;
+
+    if ( !stat->sn_cost ) return;
+    stat->ops[FACT] += stat->sn_mark[0];
+    MPI_Allreduce(MPI_IN_PLACE, stat->sn_cost, 3 * nsupers, MPI_DOUBLE,
+		  MPI_SUM, grid->comm);
+    if ( !*cost && !(*cost = SUPERLU_MALLOC(3 * nsupers * sizeof(double))) )
+	ABORT("Malloc fails for cost[].");
+    memcpy(*cost, stat->sn_cost, 3 * nsupers * sizeof(double));
+
+    if ( grid->iam || !file || !*file ) return;
+    if ( !(fp = fopen(file, "w")) ) {
+	fprintf(stderr, "Cannot open SUPERLU_SN_COST file %s\n", file);
+	return;
+    }
+    fprintf(fp, "# k size panel_flops schur_flops bytes\n");
+    for (k = 0; k < nsupers; ++k)
+	fprintf(fp, IFMT " " IFMT " %.6e %.6e %.6e\n", k, xsup[k+1] - xsup[k],
+		stat->sn_cost[3 * k + SNCOST_PANEL],
+		stat->sn_cost[3 * k + SNCOST_SCHUR],
+		stat->sn_cost[3 * k + SNCOST_BYTES]);
+    fclose(fp);
+}
+
+void superlu_sncost_free(SuperLUStat_t *stat)
+{
+    if ( stat->sn_cost ) SUPERLU_FREE(stat->sn_cost);
+    stat->sn_cost = NULL;
+    stat->sn_nsupers = 0;
+}
@@ -0,0 +1,218 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Header-only C++ interface that owns the state of pdgssvx()
+ *
+ * <pre>
+ * superlu::Solver<T>, T = double or float, pairs the Init/Free calls of
+ * the structures of pdgssvx() (psgssvx()) and keeps the factors between
+ * the calls:
+ *
+ *     superlu::Solver<double> solver(MPI_COMM_WORLD, nprow, npcol);
+ *     solver.options().ColPerm = MMD_AT_PLUS_A;
+ *     solver.factor(&A);                   // Fact = DOFACT
+ *     solver.solve(b, ldb, nrhs, berr);    // Fact = FACTORED
+ *     ...                                  // new values in A
+ *     solver.refactor(&A);                 // Fact = SamePattern
+ *     solver.solve(b, ldb, nrhs, berr);
+ *
+ * The factors are destroyed and the grid is freed with the solver. A
+ * solver can be moved but not copied; a moved-from solver may only be
+ * destroyed or assigned to.
+ * </pre>
+ */
+
+#ifndef __SUPERLU_SOLVER_HPP
+#define __SUPERLU_SOLVER_HPP
+
+#include "superlu_ddefs.h"
+#ifdef SLU_HAVE_SINGLE
+#include "superlu_sdefs.h"
+#endif
+
+#include <memory>
+
+namespace superlu {
+
+  // The entry points of each precision.
+  template< typename T > struct Traits;
+
+  template<> struct Traits<double> {
+    typedef dScalePermstruct_t ScalePermstruct;
+    typedef dLUstruct_t LUstruct;
+    typedef dSOLVEstruct_t SOLVEstruct;
+
+    static void ScalePermstructInit(int_t n, ScalePermstruct *sp){ dScalePermstructInit(n, n, sp); }
+    static void ScalePermstructFree(ScalePermstruct *sp){ dScalePermstructFree(sp); }
+    static void LUstructInit(int_t n, LUstruct *lu){ dLUstructInit(n, lu); }
+    static void LUstructFree(LUstruct *lu){ dLUstructFree(lu); }
+    static void Destroy_LU(int_t n, gridinfo_t *grid, LUstruct *lu){ dDestroy_LU(n, grid, lu); }
+    static void SolveFinalize(superlu_dist_options_t *options, SOLVEstruct *s){ dSolveFinalize(options, s); }
+    static void gssvx(superlu_dist_options_t *options, SuperMatrix *A, ScalePermstruct *sp,
+                      double *B, int ldb, int nrhs, gridinfo_t *grid, LUstruct *lu,
+                      SOLVEstruct *s, double *berr, SuperLUStat_t *stat, int *info){
+      pdgssvx(options, A, sp, B, ldb, nrhs, grid, lu, s, berr, stat, info);
+    }
+  };
+
+#ifdef SLU_HAVE_SINGLE
+  template<> struct Traits<float> {
+    typedef sScalePermstruct_t ScalePermstruct;
+    typedef sLUstruct_t LUstruct;
+    typedef sSOLVEstruct_t SOLVEstruct;
+
+    static void ScalePermstructInit(int_t n, ScalePermstruct *sp){ sScalePermstructInit(n, n, sp); }
+    static void ScalePermstructFree(ScalePermstruct *sp){ sScalePermstructFree(sp); }
+    static void LUstructInit(int_t n, LUstruct *lu){ sLUstructInit(n, lu); }
+    static void LUstructFree(LUstruct *lu){ sLUstructFree(lu); }
+    static void Destroy_LU(int_t n, gridinfo_t *grid, LUstruct *lu){ sDestroy_LU(n, grid, lu); }
+    static void SolveFinalize(superlu_dist_options_t *options, SOLVEstruct *s){ sSolveFinalize(options, s); }
+    static void gssvx(superlu_dist_options_t *options, SuperMatrix *A, ScalePermstruct *sp,
+                      float *B, int ldb, int nrhs, gridinfo_t *grid, LUstruct *lu,
+                      SOLVEstruct *s, float *berr, SuperLUStat_t *stat, int *info){
+      psgssvx(options, A, sp, B, ldb, nrhs, grid, lu, s, berr, stat, info);
+    }
+  };
+#endif
+
+  template< typename T >
+  class Solver{
+    public:
+      // Build an nprow-by-npcol grid on comm; collective over comm.
+      Solver(MPI_Comm comm, int nprow, int npcol) : s_(new State){
+        superlu_gridinit(comm, nprow, npcol, &s_->ownGrid);
+        s_->grid = &s_->ownGrid;
+        s_->gridOwned = true;
+      }
+
+      // Use the grid of the caller, which must outlive the solver.
+      explicit Solver(gridinfo_t *grid) : s_(new State){
+        s_->grid = grid;
+      }
+
+      Solver(Solver && other) = default;
+      Solver & operator=(Solver && other) = default;
+      Solver(const Solver &) = delete;
+      Solver & operator=(const Solver &) = delete;
+
+      // The options of pdgssvx(); Fact and SolveInitialized are managed
+      // by the solver.
+      superlu_dist_options_t & options(){ return s_->options; }
+      gridinfo_t * grid(){ return s_->grid; }
+      // The statistics, accumulated over the calls; see PStatPrint().
+      SuperLUStat_t & stat(){ return s_->stat; }
+      bool factored() const { return s_->n >= 0; }
+      typename Traits<T>::LUstruct & LUstruct(){ return s_->LU; }
+      typename Traits<T>::ScalePermstruct & ScalePermstruct(){ return s_->SP; }
+
+      // Factor A afresh (Fact = DOFACT), dropping the previous factors.
+      // A is overwritten as by pdgssvx(), and must stay alive until the
+      // next factorization, as the solves refine against it. Returns the
+      // info of pdgssvx().
+      int factor(SuperMatrix *A){
+        s_->release();
+        return s_->call(A, DOFACT, NULL, 0, 0, NULL);
+      }
+
+      // Factor new values of A with the pattern of the last factorization,
+      // reusing its column permutation (fact = SamePattern) or both of its
+      // permutations (fact = SamePattern_SameRowPerm). Without factors, or
+      // if the order of A changed, this is factor(A).
+      int refactor(SuperMatrix *A, fact_t fact = SamePattern){
+        if ( !factored() || A->ncol != s_->n || fact == DOFACT ) return factor(A);
+        if ( fact == SamePattern )
+          Traits<T>::Destroy_LU(s_->n, s_->grid, &s_->LU);
+        return s_->call(A, fact, NULL, 0, 0, NULL);
+      }
+
+      // Solve with the factors (Fact = FACTORED): B holds the local rows of
+      // the nrhs right-hand sides on entry, of the solution on exit; berr
+      // of dimension nrhs gets the backward errors. Returns -1 without
+      // factors, else the info of pdgssvx().
+      int solve(T *B, int ldb, int nrhs, T *berr){
+        if ( !factored() ) return -1;
+        return s_->call(s_->A, FACTORED, B, ldb, nrhs, berr);
+      }
+
+    private:
+      // On the heap, so that moving the solver leaves the addresses seen
+      // by the factors (grid, SOLVEstruct) unchanged.
+      struct State{
+        gridinfo_t ownGrid;
+        gridinfo_t *grid;
+        bool gridOwned;
+        superlu_dist_options_t options;
+        SuperLUStat_t stat;
+        typename Traits<T>::ScalePermstruct SP;
+        typename Traits<T>::LUstruct LU;
+        typename Traits<T>::SOLVEstruct SOLVE;
+        SuperMatrix *A;   // the matrix of the last factorization
+        int_t n;          // its order, -1 without factors
+
+        State() : grid(NULL), gridOwned(false), A(NULL), n(-1){
+          set_default_options_dist(&options);
+          PStatInit(&stat);
+        }
+
+        ~State(){
+          release();
+          PStatFree(&stat);
+          if ( gridOwned ) superlu_gridexit(&ownGrid);
+        }
+
+        // Free the factors; the structures are set up again by the next
+        // factorization, for its order.
+        void release(){
+          if ( n < 0 ) return;
+          Traits<T>::Destroy_LU(n, grid, &LU);
+          Traits<T>::ScalePermstructFree(&SP);
+          Traits<T>::LUstructFree(&LU);
+          if ( options.SolveInitialized ) {
+            Traits<T>::SolveFinalize(&options, &SOLVE);
+            options.SolveInitialized = NO;
+          }
+          n = -1;
+        }
+
+        int call(SuperMatrix *a, fact_t fact, T *B, int ldb, int nrhs, T *berr){
+          int info;
+          bool fresh = n < 0;
+          if ( fresh ) {
+            Traits<T>::ScalePermstructInit(a->ncol, &SP);
+            Traits<T>::LUstructInit(a->ncol, &LU);
+            options.SolveInitialized = NO;
+          }
+          if ( nrhs == 0 ) ldb = ((NRformat_loc *) a->Store)->m_loc;
+          A = a;
+          n = a->ncol;
+          options.Fact = fact;
+          Traits<T>::gssvx(&options, a, &SP, B, ldb, nrhs, grid, &LU, &SOLVE,
+                           berr, &stat, &info);
+          if ( info > 0 && fact != FACTORED ) release(); // no usable factors
+          else if ( info < 0 && fresh ) {                 // nothing factored
+            Traits<T>::ScalePermstructFree(&SP);
+            Traits<T>::LUstructFree(&LU);
+            n = -1;
+          }
+          return info;
+        }
+
+        State(const State &) = delete;
+        State & operator=(const State &) = delete;
+      };
+
+      std::unique_ptr<State> s_;
+  };
+
+} // namespace superlu
+
+#endif
@@ -0,0 +1,198 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Per-supernode event tracing of the numerical factorization
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Tracing is enabled by setting the environment variable SUPERLU_TRACE
+ * to a file prefix, e.g.
+ *
+ *     export SUPERLU_TRACE=/tmp/lu
+ *
+ * Each MPI process then records one event per supernode and phase
+ * (panel factorization, L/U sends and waits, look-ahead update, Schur
+ * complement GEMM and scatter) with its start and end time and the OpenMP
+ * thread that ran it. At the end of its n-th factorization (n = 0, 1, ...)
+ * process p writes <prefix>.<p>.<n>.json in the Chrome trace event format,
+ * which can be viewed with chrome://tracing or Perfetto; the files of all
+ * the processes can be loaded together. The time is measured from a
+ * barrier at the start of the factorization.
+ *
+ * The events are kept in the SuperLUStat_t of the factorization, so that
+ * factorizations on different grids can be traced at the same time. When
+ * tracing is off, stat->trace is NULL and the clock is not read.
+ * </pre>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "superlu_defs.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+typedef struct {
+    double tstart, tend;
+    int_t  k;         /* supernode number */
+    int    type;      /* TraceEventType */
+    int    thread;
+} trace_event_t;
+
+struct superlu_trace_t {
+    int            rank;    /* in MPI_COMM_WORLD */
+    double         t0;
+    trace_event_t *buf;
+    int_t          cnt, size;
+    char           file[256];
+};
+
+static const char *trace_name[NTRACE_EVENTS] = {
+    "panel_L", "panel_U", "send_L", "wait_L", "send_U", "wait_U",
+    "lookahead", "schur_gemm", "scatter"
+};
+
+/* Number of the traced factorizations of this process, for the file
+   names. The factorizations may be started by several application
+   threads, not only by OpenMP ones. */
+static int trace_nfact = 0;
+static pthread_mutex_t trace_nfact_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*! \brief Start recording the events of a factorization in stat if
+ * SUPERLU_TRACE is set.
+ *
+ * <pre>
+ * Collective over grid->comm. Returns 1 if tracing is enabled.
+ * </pre>
+ */
+int superlu_trace_init(gridinfo_t *grid, SuperLUStat_t *stat)
+{
+    char *ttemp = getenv("SUPERLU_TRACE");
+    struct superlu_trace_t *tr;
+    int n;
+
+    superlu_trace_free(stat);
+    if ( !ttemp || !ttemp[0] ) return 0;
+
+    if ( !(tr = (struct superlu_trace_t *)
+	   SUPERLU_MALLOC(sizeof(struct superlu_trace_t))) )
+	ABORT("Malloc fails for stat->trace.");
+    MPI_Comm_rank(MPI_COMM_WORLD, &tr->rank);
+    pthread_mutex_lock(&trace_nfact_lock);
+    n = trace_nfact++;
+    pthread_mutex_unlock(&trace_nfact_lock);
+    snprintf(tr->file, sizeof(tr->file), "%s.%d.%d.json", ttemp, tr->rank, n);
+    tr->size = 4096;
+    if ( !(tr->buf = (trace_event_t *)
+	   SUPERLU_MALLOC(tr->size * sizeof(trace_event_t))) )
+	ABORT("Malloc fails for trace buf[].");
+    tr->cnt = 0;
+
+    MPI_Barrier(grid->comm);
+    tr->t0 = SuperLU_timer_();
+    stat->trace = tr;
+    return 1;
+}
+
+/*! \brief Record that the event type on supernode k ran from tstart, as
+ * given by TRACE_TIME(stat), until now.
+ *
+ * <pre>
+ * This may be called from inside OpenMP parallel regions; it does nothing
+ * if stat is not tracing.
+ * </pre>
+ */
+void superlu_trace_event(SuperLUStat_t *stat, TraceEventType type, int_t k,
+                         double tstart)
+{
+    struct superlu_trace_t *tr = stat->trace;
+    trace_event_t *new_buf;
+    double tend;
+    int thread = 0;
+
+    if ( !tr ) return;
+    tend = SuperLU_timer_();
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#endif
+
+#ifdef _OPENMP
+#pragma omp critical (superlu_trace)
+#endif
+    {
+	if ( tr->cnt == tr->size ) { /* Double the buffer. */
+	    if ( !(new_buf = (trace_event_t *)
+		   SUPERLU_MALLOC(2 * tr->size * sizeof(trace_event_t))) )
+		ABORT("Malloc fails for trace buf[].");
+	    memcpy(new_buf, tr->buf, tr->size * sizeof(trace_event_t));
+	    SUPERLU_FREE(tr->buf);
+	    tr->buf = new_buf;
+	    tr->size *= 2;
+	}
+	tr->buf[tr->cnt].tstart = tstart;
+	tr->buf[tr->cnt].tend = tend;
+	tr->buf[tr->cnt].k = k;
+	tr->buf[tr->cnt].type = type;
+	tr->buf[tr->cnt].thread = thread;
+	++tr->cnt;
+    }
+}
+
+/*! \brief Write the events recorded in stat and stop tracing.
+ */
+void superlu_trace_finalize(gridinfo_t *grid, SuperLUStat_t *stat)
+{
+    struct superlu_trace_t *tr = stat->trace;
+    FILE *fp;
+    int_t i;
+    int iam;
+
+    if ( !tr ) return;
+
+    if ( !(fp = fopen(tr->file, "w")) ) {
+	fprintf(stderr, "superlu_trace: cannot open %s\n", tr->file);
+    } else {
+	iam = grid->iam;
+	fprintf(fp, "{\"traceEvents\":[\n");
+	fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+		"\"args\":{\"name\":\"rank %d (%d,%d)\"}}",
+		tr->rank, tr->rank, (int) MYROW(iam, grid),
+		(int) MYCOL(iam, grid));
+	for (i = 0; i < tr->cnt; ++i) {
+	    fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"fact\",\"ph\":\"X\","
+		    "\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+		    "\"args\":{\"k\":" IFMT "}}",
+		    trace_name[tr->buf[i].type], tr->rank,
+		    tr->buf[i].thread, (tr->buf[i].tstart - tr->t0) * 1e6,
+		    (tr->buf[i].tend - tr->buf[i].tstart) * 1e6,
+		    tr->buf[i].k);
+	}
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(fp);
+    }
+
+    superlu_trace_free(stat);
+}
+
+/*! \brief Drop the events recorded in stat, if any.
+ */
+void superlu_trace_free(SuperLUStat_t *stat)
+{
+    if ( !stat->trace ) return;
+    SUPERLU_FREE(stat->trace->buf);
+    SUPERLU_FREE(stat->trace);
+    stat->trace = NULL;
+}
@@ -0,0 +1,168 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+/*! @file
+ * \brief Cache of the blocking parameters tuned for a matrix and a machine
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * pdgstune() times the factorization of a matrix with a few choices of
+ * the relaxation and the maximum supernode size (sp_ienv_dist(2) and (3))
+ * and records the fastest one in the file named by the environment
+ * variable SUPERLU_TUNE_CACHE. The entries of the file are keyed by the
+ * sparsity pattern of the matrix, the process grid, the number of
+ * threads and the host name of process 0; one entry per line:
+ *
+ *     key relax maxsuper seconds
+ *
+ * The last entry of a key wins. When SUPERLU_TUNE_CACHE is set, pdgssvx()
+ * with Fact = DOFACT looks the matrix up and, if it is found,
+ * sp_ienv_dist() returns the cached values unless NREL or NSUP are set.
+ * As with NSUP, the values are global to the process: the LU factors that
+ * are still in use must have been computed with the same maximum
+ * supernode size.
+ * </pre>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "superlu_defs.h"
+
+#define TUNE_KEYLEN 256
+
+static int_t tune_relax = 0, tune_maxsuper = 0; /* 0: not tuned */
+static int tune_locked = 0; /* nonzero while pdgstune() runs */
+
+/*! \brief Return the tuned value of sp_ienv_dist(ispec), or 0 if none.
+ */
+int_t superlu_tune_param(int_t ispec)
+{
+    switch ( ispec ) {
+	case 2: return tune_relax;
+	case 3: return tune_maxsuper;
+    }
+    return 0;
+}
+
+/*! \brief Set the values returned by superlu_tune_param(); 0 resets them.
+ */
+void superlu_tune_set(int_t relax, int_t maxsuper)
+{
+    tune_relax = relax;
+    tune_maxsuper = maxsuper;
+}
+
+/*! \brief With lock != 0, superlu_tune_load() leaves the parameters alone.
+ */
+void superlu_tune_lock(int lock)
+{
+    tune_locked = lock;
+}
+
+static uint64_t mix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/* Form the cache key of A on process 0; collective over grid->comm.
+   The hash of the pattern is a sum over the entries, independent of the
+   distribution of the rows. The host name is cut to fit the key. */
+static void tune_key(SuperMatrix *A, gridinfo_t *grid, char key[TUNE_KEYLEN])
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    uint64_t h = 0, hsum;
+    long long nnz = Astore->nnz_loc, nnzsum;
+    char host[MPI_MAX_PROCESSOR_NAME];
+    int_t i, j;
+    int len, nthreads = 1;
+
+    for (i = 0; i < Astore->m_loc; ++i)
+	for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j)
+	    h += mix64((uint64_t) (Astore->fst_row + i) * A->ncol
+		       + Astore->colind[j]);
+    MPI_Reduce(&h, &hsum, 1, MPI_UINT64_T, MPI_SUM, 0, grid->comm);
+    MPI_Reduce(&nnz, &nnzsum, 1, MPI_LONG_LONG, MPI_SUM, 0, grid->comm);
+    if ( grid->iam ) return;
+
+    MPI_Get_processor_name(host, &len);
+    for (i = 0; i < len; ++i) if ( host[i] == ' ' ) host[i] = '_';
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    snprintf(key, TUNE_KEYLEN, "n%d_nnz%lld_%016llx_%dx%d_t%d_%.160s",
+	     (int) A->ncol, nnzsum, (unsigned long long) hsum,
+	     (int) grid->nprow, (int) grid->npcol, nthreads, host);
+}
+
+/*! \brief Look A up in the tuning cache and set the tuned parameters.
+ *
+ * <pre>
+ * Collective over grid->comm. Does nothing if SUPERLU_TUNE_CACHE is not
+ * set. Returns 1 if an entry was found, 0 otherwise; in both cases the
+ * parameters of a previous matrix are replaced.
+ * </pre>
+ */
+int superlu_tune_load(SuperMatrix *A, gridinfo_t *grid)
+{
+    char *cache = getenv("SUPERLU_TUNE_CACHE");
+    char key[TUNE_KEYLEN], k[TUNE_KEYLEN];
+    long long val[2] = {0, 0}, r, s;
+    FILE *fp;
+
+    if ( !cache || tune_locked ) return 0;
+
+    tune_key(A, grid, key);
+    if ( !grid->iam && (fp = fopen(cache, "r")) ) {
+	while ( fscanf(fp, "%255s %lld %lld %*f", k, &r, &s) == 3 )
+	    if ( !strcmp(k, key) && r > 0 && r <= s ) {
+		val[0] = r;
+		val[1] = s;
+	    }
+	fclose(fp);
+    }
+    MPI_Bcast(val, 2, MPI_LONG_LONG, 0, grid->comm);
+    superlu_tune_set((int_t) val[0], (int_t) val[1]);
+    return val[0] > 0;
+}
+
+/*! \brief Append the parameters tuned for A to the tuning cache.
+ *
+ * <pre>
+ * Collective over grid->comm. Does nothing if SUPERLU_TUNE_CACHE is not
+ * set.
+ * </pre>
+ */
+void superlu_tune_store(SuperMatrix *A, gridinfo_t *grid, int_t relax,
+			int_t maxsuper, double seconds)
+{
+    char *cache = getenv("SUPERLU_TUNE_CACHE");
+    char key[TUNE_KEYLEN];
+    FILE *fp;
+
+    if ( !cache ) return;
+
+    tune_key(A, grid, key);
+    if ( grid->iam ) return;
+    if ( !(fp = fopen(cache, "a")) ) {
+	fprintf(stderr, "superlu_tune_store: cannot open %s\n", cache);
+	return;
+    }
+    fprintf(fp, "%s %lld %lld %.6e\n", key, (long long) relax,
+	    (long long) maxsuper, seconds);
+    fclose(fp);
+}
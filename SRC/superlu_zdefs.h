@@ -188,6 +188,8 @@ typedef struct {
     Glu_persist_t *Glu_persist;
     zLocalLU_t *Llu;
     char dt;
+    void *cLUstruct;  /* single precision factors, used when
+			 options->SingleFactor = YES (see pzcutil.c) */
 } zLUstruct_t;
 
 
@@ -559,6 +561,26 @@ extern float zdist_psymbtonum(fact_t, int_t, SuperMatrix *,
                                 zLUstruct_t *, gridinfo_t *);
 extern void pzGetDiagU(int_t, zLUstruct_t *, gridinfo_t *, doublecomplex *);
 
+/* Mixed precision: single precision factors, double precision refinement */
+extern float pzcdistribute(fact_t, int_t, SuperMatrix *,
+			   zScalePermstruct_t *, Glu_freeable_t *,
+			   zLUstruct_t *, gridinfo_t *);
+extern float zcdist_psymbtonum(fact_t, int_t, SuperMatrix *,
+			       zScalePermstruct_t *, Pslu_freeable_t *,
+			       zLUstruct_t *, gridinfo_t *);
+extern int_t pzcgstrf(superlu_dist_options_t *, int, int, double,
+		      zLUstruct_t*, gridinfo_t*, SuperLUStat_t*, int*);
+extern void pzcCompute_Diag_Inv(int_t, zLUstruct_t *, gridinfo_t *,
+				SuperLUStat_t *, int *);
+extern void pzcgstrs(int_t, zLUstruct_t *, zScalePermstruct_t *, gridinfo_t *,
+		     doublecomplex *, int_t, int_t, int_t, int, zSOLVEstruct_t *,
+		     SuperLUStat_t *, int *);
+extern void pzcGetDiagU(int_t, zLUstruct_t *, gridinfo_t *, doublecomplex *);
+extern int_t zcQuerySpace_dist(int_t, zLUstruct_t *, gridinfo_t *,
+			       SuperLUStat_t *, superlu_dist_mem_usage_t *);
+extern void zcZeroLblocks(int, int_t, gridinfo_t *, zLUstruct_t *);
+extern void zcDestroy_LU(int_t, gridinfo_t *, zLUstruct_t *);
+
 extern int  z_c2cpp_GetHWPM(SuperMatrix *, gridinfo_t *, zScalePermstruct_t *);
 
 /* Routines for debugging */
@@ -606,6 +628,9 @@ extern int zgeru_(int*, int*, doublecomplex*, doublecomplex*, int*,
 
 #endif
 
+extern int zgemm_3m(int, int, int, doublecomplex *, int, doublecomplex *,
+                    int, doublecomplex *, int);
+
 extern int zscal_(int *n, doublecomplex *da, doublecomplex *dx, int *incx);
 extern int zaxpy_(int *n, doublecomplex *za, doublecomplex *zx, 
 	               int *incx, doublecomplex *zy, int *incy);
@@ -39,15 +39,59 @@ at the top-level directory.
 #define T2_SUPER
 
 
+/* Subtrees of the etree with fewer columns are not factored separately. */
+#define SYMB_SUBTREE_MIN 32
+
+/* The columns fst:lst-1 of a subtree of the etree, factored by
+   symbfact_subtree() with the rows renumbered: row fst+i is i, and the
+   rows outrow[0:nout-1] below the subtree are lst-fst, lst-fst+1, ... */
+typedef struct {
+    int_t fst, lst;
+    int_t wt;              /* number of nonzeros of A in the subtree */
+    int_t nout, *outrow;
+    int_t *xprune, *perm_r; /* size lst-fst each, local numbering */
+    int_t info;            /* nonzero if the structure is not available */
+    Glu_persist_t  Glu_persist;
+    Glu_freeable_t Glu_freeable;
+} symb_subtree_t;
+
+/* Prefix sums over the columns of the bounds of symbfact_estimate() on the
+   lengths of lsub[] and usub[], sizing the subtrees of the next symbfact()
+   on a matrix of symb_nbound columns; NULL if not estimated. */
+static int_t *symb_lbound, *symb_ubound, symb_nbound;
+
+#if defined(_OPENMP) && !( DEBUGlevel>=1 ) /* debug malloc is not thread-safe */
+#define SYMB_SUBTREES
+/* Those of memory.c, of each thread. */
+extern SuperLU_ExpHeader *expanders;
+extern int_t no_expand;
+#pragma omp threadprivate(expanders, no_expand)
+#endif
+
 /*
  * Internal protypes
  */
-static void  relax_snode(int_t, int_t *, int_t, int_t *, int_t *);
+static int_t symbfact_sweep(SuperMatrix *, const int_t, const int_t, int_t *,
+			    const int_t, symb_subtree_t *,
+			    Glu_persist_t *, Glu_freeable_t *);
+#ifdef SYMB_SUBTREES
+static symb_subtree_t *symbfact_subtrees(SuperMatrix *, int_t *, int_t *,
+					 const int_t, const int_t, int_t *);
+static void  symbfact_subtree(SuperMatrix *, int_t *, const int_t,
+			      const int_t, symb_subtree_t *);
+#endif
+static int_t symbfact_subtree_merge(SuperMatrix *, const int_t, const int_t,
+				    symb_subtree_t *, int_t *, int_t *,
+				    int_t *, int_t *,
+				    Glu_persist_t *, Glu_freeable_t *);
+static void  symbfact_subtree_free(symb_subtree_t *);
+static void  symbfact_bound_free(void);
+static void  relax_snode(int_t, int_t *, int_t, int_t, int_t *, int_t *);
 static int_t snode_dfs(SuperMatrix *, const int_t, const int_t, int_t *,
 		       int_t *,	Glu_persist_t *, Glu_freeable_t *);
-static int_t column_dfs(SuperMatrix *, const int_t, int_t *, int_t *, int_t *,
-			int_t *, int_t *, int_t *, int_t *, int_t *,
-			Glu_persist_t *, Glu_freeable_t *);
+static int_t column_dfs(SuperMatrix *, const int_t, const int_t, const int_t,
+			int_t *, int_t *, int_t *, int_t *, int_t *, int_t *, int_t *,
+			int_t *, Glu_persist_t *, Glu_freeable_t *);
 static int_t pivotL(const int_t, int_t *, int_t *,
 		    Glu_persist_t *, Glu_freeable_t *);
 static int_t set_usub(const int_t, const int_t, const int_t, int_t *, int_t *,
@@ -55,6 +99,8 @@ static int_t set_usub(const int_t, const int_t, const int_t, int_t *, int_t *,
 static void  pruneL(const int_t, const int_t *, const int_t, const int_t,
 		    const int_t *, const int_t *, int_t *,
 		    Glu_persist_t *, Glu_freeable_t *);
+static int_t symbfact_merge(superlu_dist_options_t *, int_t, double, int_t,
+			    Glu_persist_t *, Glu_freeable_t *);
 
 
 /************************************************************************/
@@ -70,6 +116,12 @@ static void  pruneL(const int_t, const int_t *, const int_t, const int_t,
  *        o supernodes
  *        o symmetric structure pruning
  *
+ *   With OpenMP, the disjoint subtrees of the etree whose columns are
+ *   neither in the Schur complement (options->SchurSize) nor split from a
+ *   relaxed supernode are factored concurrently, each on its own rows,
+ *   and merged in order in the sweep over the columns; the result is the
+ *   same as with one thread.
+ *
  * Return value
  * ============
  *   < 0, number of bytes needed for LSUB.
@@ -90,10 +142,11 @@ int_t symbfact
  )
 {
 
-    int_t m, n, min_mn, j, i, k, irep, nseg, pivrow, info;
+    int_t m, n, min_mn, i, info, nsub;
     int_t *iwork, *perm_r, *segrep, *repfnz;
     int_t *xprune, *marker, *parent, *xplore;
-    int_t relax, *desc, *relax_end;
+    int_t relax, maxsuper, *desc, *relax_end, nint;
+    symb_subtree_t *sub;
     int_t nnzLU, nnzLSUB;
     int_t nnzL, nnzU;
     NRformat_loc *Astore;
@@ -120,6 +173,10 @@ int_t symbfact
     xprune = xplore + m;
     relax_end = xprune + n;
     relax = sp_ienv_dist(2);
+    maxsuper = sp_ienv_dist(3);
+    /* With options->SchurSize > 0, the interface columns nint:n-1 start
+       a new supernode and are not merged into relaxed supernodes. */
+    nint = n - options->SchurSize;
     ifill_dist(perm_r, m, EMPTY);
     ifill_dist(repfnz, m, EMPTY);
     ifill_dist(marker, m, EMPTY);
@@ -133,50 +190,24 @@ int_t symbfact
     /* Identify relaxed supernodes. */
     if ( !(desc = intMalloc_dist(n+1)) )
 	ABORT("Malloc fails for desc[]");;
-    relax_snode(n, etree, relax, desc, relax_end);
+    relax_snode(n, etree, relax, nint, desc, relax_end);
     SUPERLU_FREE(desc);
     
-    for (j = 0; j < min_mn; ) {
-	if ( relax_end[j] != EMPTY ) { /* beginning of a relaxed snode */
-   	    k = relax_end[j];          /* end of the relaxed snode */
-	 
-	    /* Determine union of the row structure of supernode (j:k). */
-	    if ( (info = snode_dfs(A, j, k, xprune, marker,
-				   Glu_persist, Glu_freeable)) != 0 )
-		return info;
-
-	    for (i = j; i <= k; ++i)
-		pivotL(i, perm_r, &pivrow, Glu_persist, Glu_freeable); 
-
-	    j = k+1;
-	} else {
-	    /* Perform a symbolic factorization on column j, and detects
-	       whether column j starts a new supernode. */
-	    if ((info = column_dfs(A, j, perm_r, &nseg, segrep, repfnz,
-				   xprune, marker, parent, xplore,
-				   Glu_persist, Glu_freeable)) != 0)
-		return info;
-	    
-	    /* Copy the U-segments to usub[*]. */
-	    if ((info = set_usub(min_mn, j, nseg, segrep, repfnz,
-				 Glu_persist, Glu_freeable)) != 0)
-		return info;
-
-	    pivotL(j, perm_r, &pivrow, Glu_persist, Glu_freeable); 
-
-	    /* Prune columns [0:j-1] using column j. */
-	    pruneL(j, perm_r, pivrow, nseg, segrep, repfnz, xprune,
-		   Glu_persist, Glu_freeable);
-
-	    /* Reset repfnz[*] to prepare for the next column. */
-	    for (i = 0; i < nseg; i++) {
-		irep = segrep[i];
-		repfnz[irep] = EMPTY;
-	    }
+    /* Factor independent subtrees of the etree in several threads,
+       then merge them in the column sweep. */
+    nsub = 0;
+    sub = NULL;
+#ifdef SYMB_SUBTREES
+    if ( m == n && omp_get_max_threads() > 1 )
+	sub = symbfact_subtrees(A, etree, relax_end, maxsuper, nint, &nsub);
+#endif
 
-	    ++j;
-	} /* else */
-    } /* for j ... */
+    info = symbfact_sweep(A, maxsuper, nint, iwork, nsub, sub,
+			  Glu_persist, Glu_freeable);
+    for (i = 0; i < nsub; ++i) symbfact_subtree_free(&sub[i]);
+    if ( sub ) SUPERLU_FREE(sub);
+    symbfact_bound_free();
+    if ( info ) return info;
 
     countnz_dist(min_mn, xprune, &nnzL, &nnzU, Glu_persist, Glu_freeable);
     Glu_freeable->nnzLU = nnzL + nnzU - min_mn;	
@@ -211,6 +242,765 @@ int_t symbfact
 
 } /* SYMBFACT */
 
+
+static void
+symb_bcast(int_t *buf, int_t len, MPI_Comm comm)
+{
+    int_t k, nb;
+    for (k = 0; k < len; k += nb) { /* counts are int */
+	nb = SUPERLU_MIN(len - k, 1 << 30);
+	MPI_Bcast(&buf[k], (int) nb, mpi_int_t, 0, comm);
+    }
+}
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_node() is symbfact() computed once per node: the first
+ *   process of each node of grid->comm (MPI-3 shared memory domain) calls
+ *   symbfact(), with all its OpenMP threads, and broadcasts the result to
+ *   the other processes of the node, which would compute the same one.
+ *   Collective over grid->comm; the input A, perm_c[] and etree[] must be
+ *   the same on all processes. The return value is that of symbfact().
+ * </pre>
+ */
+int_t symbfact_node
+/************************************************************************/
+(
+ superlu_dist_options_t *options, /* input options */
+ int         pnum,     /* process number */
+ SuperMatrix *A,       /* original matrix A permuted by columns (input) */
+ int_t       *perm_c,  /* column permutation vector (input) */
+ int_t       *etree,   /* column elimination tree (input) */
+ Glu_persist_t *Glu_persist,  /* output */
+ Glu_freeable_t *Glu_freeable,/* output */
+ gridinfo_t  *grid
+ )
+{
+#if MPI_VERSION >= 3
+    MPI_Comm comm;
+    int      rank, nprocs;
+    int_t    n = A->ncol, len[3];
+    int64_t  nnzLU;
+
+    MPI_Comm_split_type(grid->comm, MPI_COMM_TYPE_SHARED, grid->iam,
+			MPI_INFO_NULL, &comm);
+    MPI_Comm_size(comm, &nprocs);
+    if ( nprocs == 1 ) {
+	MPI_Comm_free(&comm);
+	return symbfact(options, pnum, A, perm_c, etree,
+			Glu_persist, Glu_freeable);
+    }
+    MPI_Comm_rank(comm, &rank);
+
+    if ( !rank ) {
+	len[0] = symbfact(options, pnum, A, perm_c, etree,
+			  Glu_persist, Glu_freeable);
+	len[1] = len[0] <= 0 ? Glu_freeable->xlsub[n] : 0;
+	len[2] = len[0] <= 0 ? Glu_freeable->xusub[n] : 0;
+	nnzLU = Glu_freeable->nnzLU;
+    } else {
+	symbfact_SubHint(0, 0); /* not used here */
+	symbfact_bound_free();
+    }
+    MPI_Bcast(len, 3, mpi_int_t, 0, comm);
+    if ( len[0] > 0 ) { /* out of memory */
+	MPI_Comm_free(&comm);
+	return len[0];
+    }
+
+    if ( rank ) {
+	if ( !(Glu_persist->xsup = intMalloc_dist(n+1)) ||
+	     !(Glu_persist->supno = intMalloc_dist(n+1)) ||
+	     !(Glu_freeable->xlsub = intMalloc_dist(n+1)) ||
+	     !(Glu_freeable->xusub = intMalloc_dist(n+1)) ||
+	     !(Glu_freeable->lsub = intMalloc_dist(SUPERLU_MAX(len[1], 1))) ||
+	     !(Glu_freeable->usub = intMalloc_dist(SUPERLU_MAX(len[2], 1))) )
+	    ABORT("Malloc fails for the symbolic factorization of the node.");
+	Glu_freeable->nzlmax = SUPERLU_MAX(len[1], 1);
+	Glu_freeable->nzumax = SUPERLU_MAX(len[2], 1);
+	Glu_freeable->MemModel = SYSTEM;
+    }
+    symb_bcast(Glu_persist->xsup, n+1, comm);
+    symb_bcast(Glu_persist->supno, n+1, comm);
+    symb_bcast(Glu_freeable->xlsub, n+1, comm);
+    symb_bcast(Glu_freeable->xusub, n+1, comm);
+    symb_bcast(Glu_freeable->lsub, len[1], comm);
+    symb_bcast(Glu_freeable->usub, len[2], comm);
+    MPI_Bcast(&nnzLU, 1, MPI_INT64_T, 0, comm);
+    Glu_freeable->nnzLU = nnzLU;
+    MPI_Comm_free(&comm);
+    return len[0];
+#else
+    return symbfact(options, pnum, A, perm_c, etree,
+		    Glu_persist, Glu_freeable);
+#endif
+} /* SYMBFACT_NODE */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_estimate() sets the sizes of lsub[] and usub[] for the
+ *   next symbfact() on A, from the column counts colcnt[] of a Cholesky
+ *   factor whose structure contains that of L\U (see
+ *   sp_colcounts_dist_loc and sp_colcounts_ata_dist_loc), and its
+ *   postordered elimination tree etree[]. symbfact() then allocates them
+ *   once and never expands them by copying.
+ *
+ *   The sizes are bounds that do not depend on the supernodes found by
+ *   symbfact(), which may split those of the Cholesky factor. A column j
+ *   out of the relaxed supernodes of relax_snode() puts at most the
+ *   colcnt[j] subscripts of L[*,j] in lsub[], whether it is the first,
+ *   the last or an inner column of its supernode. A relaxed supernode
+ *   holds twice the union of the structures of its columns of A (see
+ *   snode_dfs). usub[] holds at most one subscript for each nonzero of
+ *   U[*,j] above the diagonal, i.e. colcnt[j]-1 in all, the rows of U
+ *   being those of L'. Only the part filled by symbfact() is touched.
+ * </pre>
+ */
+void symbfact_estimate
+/************************************************************************/
+(
+ superlu_dist_options_t *options, /* input options */
+ SuperMatrix *A,       /* matrix A permuted by columns, as in symbfact() */
+ int_t       *etree,   /* postordered elimination tree (input) */
+ int_t       *colcnt   /* column counts of the Cholesky factor (input) */
+ )
+{
+    NCPformat *Astore = (NCPformat *) A->Store;
+    int_t n = A->ncol, i, j, k, len;
+    int_t nzlmax = 0, nzumax = 0;
+    int_t relax = sp_ienv_dist(2);
+    int_t nint = n - options->SchurSize;
+    int_t *desc, *relax_end;
+
+    if ( !(desc = intMalloc_dist(2*n + 1)) )
+	ABORT("Malloc fails for desc[]");
+    relax_end = desc + n + 1;
+    relax_snode(n, etree, relax, nint, desc, relax_end);
+
+    symbfact_bound_free();
+    if ( !(symb_lbound = intMalloc_dist(2*(n + 1))) )
+	ABORT("Malloc fails for symb_lbound[]");
+    symb_ubound = symb_lbound + n + 1;
+    symb_nbound = n;
+
+    for (j = 0; j < n; j = k) {
+	symb_lbound[j] = nzlmax;
+	if ( relax_end[j] != EMPTY ) {
+	    /* The union of the structures of A[*,j:k-1]. */
+	    k = relax_end[j] + 1;
+	    for (len = 0, i = j; i < k; ++i)
+		len += Astore->colend[i] - Astore->colbeg[i];
+	    len = SUPERLU_MIN(len, n);
+	    nzlmax += k - j > 1 ? 2 * len : len;
+	} else {
+	    k = j + 1;
+	    nzlmax += colcnt[j];
+	}
+	for (i = j; i < k; ++i) {
+	    symb_lbound[i+1] = nzlmax;
+	    symb_ubound[i] = nzumax;
+	    nzumax += colcnt[i] - 1;
+	}
+    }
+    symb_ubound[n] = nzumax;
+    SUPERLU_FREE(desc);
+
+    /* lsub[] and usub[] are expanded when full, not only when exceeded. */
+    symbfact_SubHint(nzlmax + n, nzumax + n);
+} /* SYMBFACT_ESTIMATE */
+
+/* Free the bounds of symbfact_estimate(). */
+static void symbfact_bound_free(void)
+{
+    if ( symb_lbound ) SUPERLU_FREE(symb_lbound);
+    symb_lbound = symb_ubound = NULL;
+    symb_nbound = 0;
+}
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_amalgamate() merges the supernodes computed by symbfact()
+ *   with their parent in the supernodal elimination tree, when the
+ *   parent is the next supernode and the explicit zeros added to the
+ *   stored L (the dense diagonal block and the union of the row
+ *   structures below it) stay below options->Amalg_Tol times the size
+ *   of the merged supernode. relax_snode() only amalgamates the leaf
+ *   subtrees; this gives fewer and larger supernodes, hence larger
+ *   GEMMs in the Schur complement update and fewer messages.
+ *
+ *   The merged supernodes have at most maxsuper = sp_ienv_dist(3)
+ *   columns, and the first column of the Schur complement (SchurSize)
+ *   still starts a supernode. Glu_persist and Glu_freeable are updated
+ *   in place, in the format returned by symbfact(): lsub[] holds the
+ *   rows of each supernode with the diagonal block first, and usub[]
+ *   the first nonzero of each segment of U. The zeros are counted on L
+ *   only; those of U are the same when the pattern is symmetric.
+ *
+ *   Returns the number of supernodes after amalgamation.
+ * </pre>
+ */
+int_t symbfact_amalgamate
+/************************************************************************/
+(
+ superlu_dist_options_t *options, /* input options */
+ int_t       n,              /* dimension of the matrix (input) */
+ Glu_persist_t *Glu_persist, /* modified */
+ Glu_freeable_t *Glu_freeable /* modified */
+ )
+{
+    int_t nsuper = Glu_persist->supno[n] + 1, ngroups;
+
+    if ( n <= 1 || options->Amalg_Tol <= 0.0 ) return nsuper;
+    ngroups = symbfact_merge(options, n, options->Amalg_Tol, sp_ienv_dist(3),
+			     Glu_persist, Glu_freeable);
+#if ( PRNTlevel>=1 )
+    printf(".. symbfact_amalgamate(): " IFMT " supernodes into " IFMT
+	   ", nnz(L+U) " IFMT "\n", nsuper, ngroups, Glu_freeable->nnzLU);
+#endif
+    return ngroups;
+} /* SYMBFACT_AMALGAMATE */
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_band() detects a factor of small bandwidth, as given by the
+ *   RCM_AT_PLUS_A ordering of a long and thin domain, and makes its
+ *   supernodes the block columns of the band: with bw the largest
+ *   distance of an entry of L or U to the diagonal, the chains of
+ *   supernodes are merged into supernodes of bw columns. L and U are
+ *   then block bidiagonal, and the factorization is that of a block
+ *   tridiagonal matrix of dense bw-by-bw blocks by the supernodal code,
+ *   with one GEMM of order bw per step.
+ *
+ *   The band is used if bw <= maxsuper = sp_ienv_dist(3) and n >= 4*bw;
+ *   the first column of the Schur complement (SchurSize) still starts a
+ *   supernode. Returns the number of supernodes, or 0 if the factors are
+ *   not banded, in which case Glu_persist and Glu_freeable are unchanged.
+ * </pre>
+ */
+int_t symbfact_band
+/************************************************************************/
+(
+ superlu_dist_options_t *options, /* input options */
+ int_t       n,              /* dimension of the matrix (input) */
+ Glu_persist_t *Glu_persist, /* modified */
+ Glu_freeable_t *Glu_freeable /* modified */
+ )
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *xlsub = Glu_freeable->xlsub, *lsub = Glu_freeable->lsub;
+    int_t *xusub = Glu_freeable->xusub, *usub = Glu_freeable->usub;
+    int_t nsuper = supno[n] + 1, bw = 0, s, fst, i, j, ngroups;
+
+    if ( n <= 1 ) return 0;
+    for (s = 0; s < nsuper; ++s) { /* The rows below each supernode. */
+	fst = xsup[s];
+	for (i = xlsub[fst]; i < xlsub[fst+1]; ++i)
+	    bw = SUPERLU_MAX(bw, lsub[i] - fst);
+    }
+    for (j = 0; j < n; ++j) /* The first row of each segment of U. */
+	for (i = xusub[j]; i < xusub[j+1]; ++i)
+	    bw = SUPERLU_MAX(bw, j - usub[i]);
+    if ( bw < 1 || bw > sp_ienv_dist(3) || n < 4 * bw ) return 0;
+
+    ngroups = symbfact_merge(options, n, 1.0, bw, Glu_persist, Glu_freeable);
+#if ( PRNTlevel>=1 )
+    printf(".. symbfact_band(): bandwidth " IFMT ", " IFMT " supernodes into "
+	   IFMT ", nnz(L+U) " IFMT "\n", bw, nsuper, ngroups,
+	   Glu_freeable->nnzLU);
+#endif
+    return ngroups;
+} /* SYMBFACT_BAND */
+
+/* Merge the supernodes of symbfact() with their parent while it is the
+   next supernode, the merged supernode has at most maxsuper columns and
+   the explicit zeros stay below tol times its stored L; see
+   symbfact_amalgamate(). Returns the number of supernodes. */
+static int_t symbfact_merge
+(
+ superlu_dist_options_t *options,
+ int_t       n,
+ double      tol,
+ int_t       maxsuper,
+ Glu_persist_t *Glu_persist,
+ Glu_freeable_t *Glu_freeable
+ )
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *xlsub = Glu_freeable->xlsub, *lsub = Glu_freeable->lsub;
+    int_t *xusub = Glu_freeable->xusub, *usub = Glu_freeable->usub;
+    int_t *nlsub, *nusub, *marker, *rows, *gsup, *upos;
+    int_t nsuper = supno[n] + 1;
+    int_t nint = n - options->SchurSize;
+    int_t s, g, i, j, k, r, pf, pl, gf, glen, below, indiag, newrows;
+    int_t ngroups, nextl, nextu;
+    int_t nnzL, nnzU;
+    double gnz, pnz, ncol, merged;
+
+    if ( !(marker = intMalloc_dist(3*n + nsuper + 1)) )
+	ABORT("Malloc fails for marker[]");
+    rows = marker + n;    /* row structure of the current group */
+    upos = rows + n;      /* position of the segment of a group in U */
+    gsup = upos + n;      /* first old supernode of each group */
+    if ( !(nlsub = intMalloc_dist(SUPERLU_MAX(xlsub[n], 1))) )
+	ABORT("Malloc fails for nlsub[]");
+    for (i = 0; i < n; ++i) marker[i] = upos[i] = EMPTY;
+
+    /* Form the groups of supernodes by a left-to-right sweep; the rows
+       of the current group gf:s are in rows[0:glen-1], marked with gf,
+       and "below" of them are below its last column. */
+    ngroups = 0;
+    nextl = 0;
+    for (s = 0; s < nsuper; ) {
+	gf = s;
+	glen = 0;
+	for (i = xlsub[xsup[s]]; i < xlsub[xsup[s]+1]; ++i) {
+	    marker[lsub[i]] = gf;
+	    rows[glen++] = lsub[i];
+	}
+	below = glen - (xsup[s+1] - xsup[s]);
+	ncol = xsup[s+1] - xsup[s];
+	gnz = ncol * glen;
+
+	while ( s + 1 < nsuper ) {
+	    pf = xsup[s+1];         /* the next supernode */
+	    pl = xsup[s+2] - 1;
+	    if ( pl - xsup[gf] + 1 > maxsuper || pf == nint ) break;
+	    if ( marker[pf] != gf ) break; /* not the parent */
+	    indiag = newrows = 0;
+	    for (i = xlsub[pf]; i < xlsub[pf+1]; ++i) {
+		r = lsub[i];
+		if ( r <= pl ) { if ( marker[r] == gf ) ++indiag; }
+		else if ( marker[r] != gf ) ++newrows;
+	    }
+	    ncol = pl - xsup[gf] + 1;
+	    merged = ncol * (ncol + below - indiag + newrows);
+	    pnz = (double) (pl - pf + 1) * (xlsub[pf+1] - xlsub[pf]);
+	    if ( merged - gnz - pnz > tol * merged ) break;
+
+	    /* Merge the next supernode into the group. */
+	    for (i = xlsub[pf]; i < xlsub[pf+1]; ++i) {
+		r = lsub[i];
+		if ( marker[r] != gf ) {
+		    marker[r] = gf;
+		    rows[glen++] = r;
+		}
+	    }
+	    below += newrows - indiag;
+	    gnz += pnz;
+	    ++s;
+	}
+
+	/* Store the group: the diagonal block first, then the rows below. */
+	gsup[ngroups] = gf;
+	pl = xsup[s+1] - 1;
+	xlsub[xsup[gf]] = nextl;
+	for (r = xsup[gf]; r <= pl; ++r) nlsub[nextl++] = r;
+	for (i = 0; i < glen; ++i)
+	    if ( rows[i] > pl ) nlsub[nextl++] = rows[i];
+	for (k = xsup[gf] + 1; k <= pl; ++k) xlsub[k] = nextl;
+	for (k = xsup[gf]; k <= pl; ++k) supno[k] = ngroups;
+	++ngroups;
+	++s;
+    }
+    xlsub[n] = nextl;
+    for (g = 0; g < ngroups; ++g) xsup[g] = xsup[gsup[g]];
+    xsup[ngroups] = n;
+    supno[n] = ngroups - 1;
+
+    /* U: keep the first nonzero of each segment of the new supernodes,
+       and drop the segments now in the diagonal block. */
+    if ( !(nusub = intMalloc_dist(SUPERLU_MAX(xusub[n], 1))) )
+	ABORT("Malloc fails for nusub[]");
+    nextu = 0;
+    for (j = 0; j < n; ++j) {
+	k = xusub[j];
+	xusub[j] = nextu;
+	for (i = k; i < xusub[j+1]; ++i) {
+	    r = usub[i];
+	    g = supno[r];
+	    if ( g == supno[j] ) continue;
+	    if ( upos[g] >= xusub[j] ) { /* segment already seen in column j */
+		nusub[upos[g]] = SUPERLU_MIN(nusub[upos[g]], r);
+	    } else {
+		upos[g] = nextu;
+		nusub[nextu++] = r;
+	    }
+	}
+    }
+    xusub[n] = nextu;
+
+    SUPERLU_FREE(Glu_freeable->lsub);
+    SUPERLU_FREE(Glu_freeable->usub);
+    Glu_freeable->lsub = nlsub;
+    Glu_freeable->usub = nusub;
+    Glu_freeable->nzlmax = SUPERLU_MAX(nextl, 1);
+    Glu_freeable->nzumax = SUPERLU_MAX(nextu, 1);
+
+    /* xprune[] is only used for the symmetrically reduced L. */
+    countnz_dist(n, xlsub, &nnzL, &nnzU, Glu_persist, Glu_freeable);
+    Glu_freeable->nnzLU = nnzL + nnzU - n;
+    SUPERLU_FREE(marker);
+    return ngroups;
+} /* SYMBFACT_MERGE */
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_split() splits the supernodes with more than
+ *   options->SplitSuper columns into consecutive block columns of at
+ *   most that many columns, of equal sizes. Each piece keeps the row
+ *   structure of the supernode below its own columns, so that its L and
+ *   U blocks are the dense blocks of the supernode: the GEMMs of the
+ *   Schur complement update keep their shapes, and the panels of the
+ *   large separators of 3D problems are factored and broadcast by
+ *   several process columns instead of one. Unlike maxsuper, which
+ *   limits the supernodes formed by symbfact(), this applies to the
+ *   final partition, after symbfact_amalgamate().
+ *
+ *   Glu_persist and Glu_freeable are updated in place, in the format
+ *   returned by symbfact(): the rows of the other pieces of a supernode
+ *   become rows below the diagonal block of a piece in lsub[], and
+ *   segments of U in usub[].
+ *
+ *   Returns the number of supernodes after the splitting.
+ * </pre>
+ */
+int_t symbfact_split
+/************************************************************************/
+(
+ superlu_dist_options_t *options, /* input options */
+ int_t       n,              /* dimension of the matrix (input) */
+ Glu_persist_t *Glu_persist, /* modified */
+ Glu_freeable_t *Glu_freeable /* modified */
+ )
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *xlsub = Glu_freeable->xlsub, *lsub = Glu_freeable->lsub;
+    int_t *xusub = Glu_freeable->xusub, *usub = Glu_freeable->usub;
+    int_t *nxsup, *nsupno, *nlsub, *nusub;
+    int_t nsuper = supno[n] + 1, maxcol = options->SplitSuper;
+    int_t s, g, gl, i, j, k, r, c, f, l, pl, sz, np, ng;
+    int_t lstart, lend, nextl, nextu, nnzL, nnzU;
+
+    if ( n <= 1 || maxcol <= 0 ) return nsuper;
+
+    /* The new partition; supernode s of nsupc columns gives
+       np = ceil(nsupc / maxcol) pieces. */
+    if ( !(nxsup = intMalloc_dist(2 * (n + 1))) )
+	ABORT("Malloc fails for nxsup[]");
+    nsupno = nxsup + n + 1;
+    ng = 0;
+    for (s = 0; s < nsuper; ++s) {
+	f = xsup[s];
+	l = xsup[s+1] - 1;
+	np = (l - f + maxcol) / maxcol;
+	sz = (l - f + np) / np;
+	for (c = f; c <= l; c += sz) {
+	    nxsup[ng] = c;
+	    for (k = c; k <= SUPERLU_MIN(c + sz - 1, l); ++k) nsupno[k] = ng;
+	    ++ng;
+	}
+    }
+    nxsup[ng] = n;
+    nsupno[n] = ng - 1;
+    if ( ng == nsuper ) {
+	SUPERLU_FREE(nxsup);
+	return nsuper;
+    }
+
+    /* Sizes of the new lsub[] and usub[]. */
+    nextl = 0;
+    for (s = 0; s < nsuper; ++s) {
+	f = xsup[s];
+	for (g = nsupno[f]; g <= nsupno[xsup[s+1] - 1]; ++g)
+	    nextl += xlsub[f+1] - xlsub[f] - (nxsup[g] - f);
+    }
+    nextu = 0;
+    for (j = 0; j < n; ++j) {
+	for (i = xusub[j]; i < xusub[j+1]; ++i) {
+	    r = usub[i];
+	    nextu += nsupno[xsup[supno[r] + 1] - 1] - nsupno[r] + 1;
+	}
+	nextu += nsupno[j] - nsupno[xsup[supno[j]]];
+    }
+    if ( !(nlsub = intMalloc_dist(SUPERLU_MAX(nextl, 1))) )
+	ABORT("Malloc fails for nlsub[]");
+    if ( !(nusub = intMalloc_dist(SUPERLU_MAX(nextu, 1))) )
+	ABORT("Malloc fails for nusub[]");
+
+    /* L: the columns of the piece, then the rows of the supernode
+       below them. */
+    nextl = 0;
+    for (s = 0; s < nsuper; ++s) {
+	f = xsup[s];
+	lstart = xlsub[f];
+	lend = xlsub[f+1];
+	for (g = nsupno[f]; g <= nsupno[xsup[s+1] - 1]; ++g) {
+	    c = nxsup[g];
+	    pl = nxsup[g+1] - 1;
+	    xlsub[c] = nextl;
+	    for (r = c; r <= pl; ++r) nlsub[nextl++] = r;
+	    for (i = lstart; i < lend; ++i)
+		if ( lsub[i] > pl ) nlsub[nextl++] = lsub[i];
+	    for (k = c + 1; k <= pl; ++k) xlsub[k] = nextl;
+	}
+    }
+    xlsub[n] = nextl;
+
+    /* U: a segment starting at r in supernode s becomes a segment in
+       each piece of s from the one of r; column j also has a full
+       segment in each of the pieces before its own in its supernode. */
+    nextu = 0;
+    for (j = 0; j < n; ++j) {
+	k = xusub[j];
+	xusub[j] = nextu;
+	for (i = k; i < xusub[j+1]; ++i) {
+	    r = usub[i];
+	    gl = nsupno[xsup[supno[r] + 1] - 1];
+	    nusub[nextu++] = r;
+	    for (g = nsupno[r] + 1; g <= gl; ++g) nusub[nextu++] = nxsup[g];
+	}
+	for (g = nsupno[xsup[supno[j]]]; g < nsupno[j]; ++g)
+	    nusub[nextu++] = nxsup[g];
+    }
+    xusub[n] = nextu;
+
+    for (g = 0; g <= ng; ++g) xsup[g] = nxsup[g];
+    for (k = 0; k <= n; ++k) supno[k] = nsupno[k];
+    SUPERLU_FREE(nxsup);
+
+    SUPERLU_FREE(Glu_freeable->lsub);
+    SUPERLU_FREE(Glu_freeable->usub);
+    Glu_freeable->lsub = nlsub;
+    Glu_freeable->usub = nusub;
+    Glu_freeable->nzlmax = SUPERLU_MAX(nextl, 1);
+    Glu_freeable->nzumax = SUPERLU_MAX(nextu, 1);
+
+    countnz_dist(n, xlsub, &nnzL, &nnzU, Glu_persist, Glu_freeable);
+    Glu_freeable->nnzLU = nnzL + nnzU - n;
+
+#if ( PRNTlevel>=1 )
+    printf(".. symbfact_split(): " IFMT " supernodes into " IFMT "\n",
+	   nsuper, ng);
+#endif
+    return ng;
+} /* SYMBFACT_SPLIT */
+
+/* Whether b is in the increasing list blk[0:len-1]. */
+static int
+symbfact_user_has(int_t *blk, int_t len, int_t b)
+{
+    int_t lo = 0, hi = len - 1, mid;
+
+    while ( lo <= hi ) {
+	mid = (lo + hi) / 2;
+	if ( blk[mid] == b ) return 1;
+	if ( blk[mid] < b ) lo = mid + 1;
+	else hi = mid - 1;
+    }
+    return 0;
+}
+
+/* Whether the block (ib, jb) is in the structure of usymb. */
+static int
+symbfact_user_block(superlu_symbfact_t *usymb, int_t ib, int_t jb)
+{
+    if ( ib > jb )
+	return symbfact_user_has(&usymb->lblk[usymb->xlblk[jb]],
+				 usymb->xlblk[jb+1] - usymb->xlblk[jb], ib);
+    if ( ib < jb )
+	return symbfact_user_has(&usymb->ublk[usymb->xublk[jb]],
+				 usymb->xublk[jb+1] - usymb->xublk[jb], ib);
+    return 1;
+}
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_user() sets up the symbolic factorization from the
+ *   supernode partition and the block structure of L and U supplied by
+ *   the user (see options->UserSymbFact), in place of sp_colorder() and
+ *   symbfact(). The blocks are taken as dense: lsub[] holds the rows of
+ *   each supernode with the diagonal block first, then all the rows of
+ *   its blocks below, and usub[] the first row of each block of U in
+ *   each column.
+ *
+ *   The structure is checked on every process: the partition, with at
+ *   most maxsuper = sp_ienv_dist(3) columns per supernode, that the
+ *   block lists are increasing and on the correct side of the diagonal,
+ *   that it is closed under the fill of the block factorization (the
+ *   block (i,j) is present with L(i,k) and U(k,j) for k < min(i,j)), and
+ *   that it holds the local entries of Pc*Pr*A*Pc'. The etree is copied
+ *   from usymb->etree, or if NULL, is that of the block structure of
+ *   L+U': the columns of a supernode form a chain, and its last column
+ *   has for parent the first column of the nearest block of L below or
+ *   U to the right.
+ *
+ *   Returns 0, or 1 if the structure is not valid on some process; the
+ *   outputs are then not set.
+ * </pre>
+ */
+int_t symbfact_user
+/************************************************************************/
+(
+ superlu_symbfact_t *usymb,  /* structure supplied by the user (input) */
+ int_t       n,              /* dimension of the matrix (input) */
+ SuperMatrix *A,             /* distributed A, SLU_NR_loc (input) */
+ int_t       *perm_r,        /* row permutation (input) */
+ int_t       *perm_c,        /* column permutation (input) */
+ int_t       *etree,         /* column elimination tree (output) */
+ Glu_persist_t *Glu_persist, /* output */
+ Glu_freeable_t *Glu_freeable, /* output */
+ gridinfo_t  *grid
+ )
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t nsupers = usymb->nsupers, *xsup = usymb->xsup;
+    int_t *xlblk = usymb->xlblk, *lblk = usymb->lblk;
+    int_t *xublk = usymb->xublk, *ublk = usymb->ublk;
+    int_t *supno, *xurow, *urow, *xlsub, *lsub, *xusub, *usub;
+    int_t s, k, i, j, jb, ib, p, nextl, nextu, nnzL, nnzU;
+    int   bad = 0, gbad;
+
+    /* The partition and the block lists. */
+    bad = ( nsupers < 1 || xsup[0] != 0 || xsup[nsupers] != n );
+    for (s = 0; !bad && s < nsupers; ++s) {
+	bad = xsup[s+1] <= xsup[s] || xsup[s+1] - xsup[s] > sp_ienv_dist(3);
+	for (i = xlblk[s]; !bad && i < xlblk[s+1]; ++i)
+	    bad = lblk[i] <= (i > xlblk[s] ? lblk[i-1] : s)
+		  || lblk[i] >= nsupers;
+	for (i = xublk[s]; !bad && i < xublk[s+1]; ++i)
+	    bad = (i > xublk[s] && ublk[i] <= ublk[i-1])
+		  || ublk[i] < 0 || ublk[i] >= s;
+    }
+    MPI_Allreduce(&bad, &gbad, 1, MPI_INT, MPI_MAX, grid->comm);
+    if ( gbad ) return 1; /* Nothing else can be read safely. */
+
+    /* The rows of U: the block columns urow[xurow[k]:xurow[k+1]-1] to the
+       right of the diagonal in block row k, increasing. */
+    if ( !(xurow = intCalloc_dist(nsupers + 1)) )
+	ABORT("Calloc fails for xurow[]");
+    if ( !(urow = intMalloc_dist(SUPERLU_MAX(xublk[nsupers], 1))) )
+	ABORT("Malloc fails for urow[]");
+    for (i = 0; i < xublk[nsupers]; ++i) ++xurow[ublk[i] + 1];
+    for (k = 0; k < nsupers; ++k) xurow[k+1] += xurow[k];
+    for (jb = 0; jb < nsupers; ++jb)
+	for (i = xublk[jb]; i < xublk[jb+1]; ++i) urow[xurow[ublk[i]]++] = jb;
+    for (k = nsupers; k > 0; --k) xurow[k] = xurow[k-1];
+    xurow[0] = 0;
+
+    /* Closed under the fill. */
+    for (k = 0; !bad && k < nsupers; ++k)
+	for (i = xlblk[k]; !bad && i < xlblk[k+1]; ++i)
+	    for (j = xurow[k]; !bad && j < xurow[k+1]; ++j)
+		bad = !symbfact_user_block(usymb, lblk[i], urow[j]);
+
+    /* The local entries of Pc*Pr*A*Pc'. */
+    if ( !(supno = intMalloc_dist(n + 1)) )
+	ABORT("Malloc fails for supno[]");
+    for (s = 0; s < nsupers; ++s)
+	for (k = xsup[s]; k < xsup[s+1]; ++k) supno[k] = s;
+    supno[n] = nsupers - 1;
+    for (i = 0; !bad && i < Astore->m_loc; ++i) {
+	ib = supno[perm_c[perm_r[Astore->fst_row + i]]];
+	for (j = Astore->rowptr[i]; !bad && j < Astore->rowptr[i+1]; ++j)
+	    bad = !symbfact_user_block(usymb, ib,
+				       supno[perm_c[Astore->colind[j]]]);
+    }
+
+    MPI_Allreduce(&bad, &gbad, 1, MPI_INT, MPI_MAX, grid->comm);
+    if ( gbad ) {
+	SUPERLU_FREE(xurow);
+	SUPERLU_FREE(urow);
+	SUPERLU_FREE(supno);
+	return 1;
+    }
+
+    /* The etree. */
+    if ( usymb->etree ) {
+	for (j = 0; j < n; ++j) etree[j] = usymb->etree[j];
+    } else {
+	for (s = 0; s < nsupers; ++s) {
+	    for (j = xsup[s]; j < xsup[s+1] - 1; ++j) etree[j] = j + 1;
+	    p = nsupers;
+	    if ( xlblk[s+1] > xlblk[s] ) p = lblk[xlblk[s]];
+	    if ( xurow[s+1] > xurow[s] ) p = SUPERLU_MIN(p, urow[xurow[s]]);
+	    etree[xsup[s+1] - 1] = ( p < nsupers ) ? xsup[p] : n;
+	}
+    }
+
+    /* lsub[] and usub[]. */
+    nextl = nextu = 0;
+    for (s = 0; s < nsupers; ++s) {
+	nextl += xsup[s+1] - xsup[s];
+	for (i = xlblk[s]; i < xlblk[s+1]; ++i)
+	    nextl += xsup[lblk[i]+1] - xsup[lblk[i]];
+	nextu += (xsup[s+1] - xsup[s]) * (xublk[s+1] - xublk[s]);
+    }
+    if ( !(xlsub = intMalloc_dist(n + 1)) || !(xusub = intMalloc_dist(n + 1)) )
+	ABORT("Malloc fails for xlsub[], xusub[]");
+    if ( !(lsub = intMalloc_dist(SUPERLU_MAX(nextl, 1))) )
+	ABORT("Malloc fails for lsub[]");
+    if ( !(usub = intMalloc_dist(SUPERLU_MAX(nextu, 1))) )
+	ABORT("Malloc fails for usub[]");
+    nextl = nextu = 0;
+    for (s = 0; s < nsupers; ++s) {
+	xlsub[xsup[s]] = nextl;
+	for (k = xsup[s]; k < xsup[s+1]; ++k) lsub[nextl++] = k;
+	for (i = xlblk[s]; i < xlblk[s+1]; ++i)
+	    for (k = xsup[lblk[i]]; k < xsup[lblk[i]+1]; ++k) lsub[nextl++] = k;
+	for (k = xsup[s] + 1; k < xsup[s+1]; ++k) xlsub[k] = nextl;
+	for (j = xsup[s]; j < xsup[s+1]; ++j) {
+	    xusub[j] = nextu;
+	    for (i = xublk[s]; i < xublk[s+1]; ++i) usub[nextu++] = xsup[ublk[i]];
+	}
+    }
+    xlsub[n] = nextl;
+    xusub[n] = nextu;
+
+    if ( !(Glu_persist->xsup = intMalloc_dist(n + 1)) )
+	ABORT("Malloc fails for xsup[]");
+    for (s = 0; s <= nsupers; ++s) Glu_persist->xsup[s] = xsup[s];
+    Glu_persist->supno = supno;
+    Glu_freeable->xlsub = xlsub;
+    Glu_freeable->lsub = lsub;
+    Glu_freeable->xusub = xusub;
+    Glu_freeable->usub = usub;
+    Glu_freeable->nzlmax = SUPERLU_MAX(nextl, 1);
+    Glu_freeable->nzumax = SUPERLU_MAX(nextu, 1);
+    Glu_freeable->MemModel = SYSTEM;
+    countnz_dist(n, xlsub, &nnzL, &nnzU, Glu_persist, Glu_freeable);
+    Glu_freeable->nnzLU = nnzL + nnzU - n;
+
+    SUPERLU_FREE(xurow);
+    SUPERLU_FREE(urow);
+    return 0;
+} /* SYMBFACT_USER */
+
 /************************************************************************/
 /*! \brief
  *
@@ -227,6 +1017,7 @@ static void relax_snode
  const int_t n, /* number of columns in the matrix (input) */
  int_t       *et,   /* column elimination tree (input) */
  const int_t relax, /* max no of columns allowed in a relaxed snode (input) */
+ const int_t nint,  /* relaxed snodes do not extend to columns >= nint (input) */
  int_t       *desc, /* number of descendants of each etree node. */
  int_t       *relax_end /* last column in a supernode (output) */
  )
@@ -250,7 +1041,7 @@ static void relax_snode
     for (j = 0; j < n; ) { 
      	parent = et[j];
         fsupc = j;
- 	while ( parent != n && desc[parent] < relax ) {
+ 	while ( parent < nint && desc[parent] < relax ) {
 	    j = parent;
 	    parent = et[j];
 	}
@@ -457,6 +1248,8 @@ static int_t column_dfs
 (
  SuperMatrix *A,        /* original matrix A permuted by columns (input) */
  const int_t jcol,      /* current column number (input) */
+ const int_t maxsuper,  /* max no of columns in a supernode (input) */
+ const int_t fstschur,  /* column that starts a new supernode (input) */
  int_t       *perm_r,   /* row permutation vector (input) */
  int_t       *nseg,     /* number of U-segments in column jcol (output) */
  int_t       *segrep,   /* list of U-segment representatives (output) */
@@ -482,7 +1275,6 @@ static int_t column_dfs
     int_t     ito, ifrom, istop;	/* used to compress row subscripts */
     int_t     *xsup, *supno, *lsub, *xlsub;
     int_t     nzlmax;
-    static int_t first = 1, maxsuper;
     int_t     mem_error;
     
     /* Initializations */
@@ -499,10 +1291,6 @@ static int_t column_dfs
     jcolm1   = jcol - 1;
     jsuper   = nsuper = supno[jcol];
     nextl    = xlsub[jcol];
-    if ( first ) {
-	maxsuper = sp_ienv_dist(3);
-	first = 0;
-    }
     
     *nseg = 0;
 
@@ -632,6 +1420,9 @@ static int_t column_dfs
 	/* Make sure the number of columns in a supernode doesn't
 	   exceed threshold. */
 	if ( jcol - fsupc >= maxsuper ) jsuper = EMPTY;
+
+	/* The first column of the Schur complement starts a supernode. */
+	if ( jcol == fstschur ) jsuper = EMPTY;
 	
 	/* If jcol starts a new supernode, reclaim storage space in
 	 * lsub[*] from the previous supernode. Note we only store
@@ -901,3 +1692,510 @@ static void pruneL
     } /* for each U-segment ... */
 } /* PRUNEL */
 
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_sweep() performs the symbolic factorization of the columns
+ *   0:min(m,n)-1 of A in order, with the work arrays iwork[] laid out as
+ *   in symbfact(). The columns of the subtrees sub[0:nsub-1], sorted by
+ *   first column, are merged from symbfact_subtree() instead.
+ *
+ * Return value
+ * ============
+ *     0  success;
+ *   > 0  number of bytes allocated when run out of space.
+ * </pre>
+ */
+static int_t symbfact_sweep
+/************************************************************************/
+(
+ SuperMatrix *A,       /* original matrix A permuted by columns (input) */
+ const int_t maxsuper, /* max no of columns in a supernode (input) */
+ const int_t nint,     /* first column of the Schur complement (input) */
+ int_t       *iwork,   /* work arrays of symbfact() (modified) */
+ const int_t nsub,     /* number of subtrees in sub[] (input) */
+ symb_subtree_t *sub,  /* factored subtrees (input, released) */
+ Glu_persist_t *Glu_persist,   /* global LU data structures (modified) */
+ Glu_freeable_t *Glu_freeable
+ )
+{
+    int_t m = A->nrow, n = A->ncol, min_mn = SUPERLU_MIN(m, n);
+    int_t *perm_r, *segrep, *repfnz, *marker, *parent, *xplore;
+    int_t *xprune, *relax_end;
+    int_t j, i, k, t, irep, nseg, pivrow, info;
+
+    perm_r = iwork;
+    segrep = iwork + m;
+    repfnz = segrep + m;
+    marker = repfnz + m;
+    parent = marker + m;
+    xplore = parent + m;
+    xprune = xplore + m;
+    relax_end = xprune + n;
+
+    for (j = 0, t = 0; j < min_mn; ) {
+	while ( t < nsub && sub[t].fst < j ) ++t;
+	if ( t < nsub && sub[t].fst == j ) {
+	    /* Columns of a subtree; they are factored here if it returns
+	       EMPTY. */
+	    info = symbfact_subtree_merge(A, maxsuper, nint, &sub[t],
+					  relax_end, perm_r, xprune, marker,
+					  Glu_persist, Glu_freeable);
+	    if ( info > 0 ) return info;
+	    if ( info == 0 ) {
+		j = sub[t].lst;
+		continue;
+	    }
+	}
+
+	if ( relax_end[j] != EMPTY ) { /* beginning of a relaxed snode */
+   	    k = relax_end[j];          /* end of the relaxed snode */
+	 
+	    /* Determine union of the row structure of supernode (j:k). */
+	    if ( (info = snode_dfs(A, j, k, xprune, marker,
+				   Glu_persist, Glu_freeable)) != 0 )
+		return info;
+
+	    for (i = j; i <= k; ++i)
+		pivotL(i, perm_r, &pivrow, Glu_persist, Glu_freeable); 
+
+	    j = k+1;
+	} else {
+	    /* Perform a symbolic factorization on column j, and detects
+	       whether column j starts a new supernode. */
+	    if ((info = column_dfs(A, j, maxsuper, nint, perm_r, &nseg, segrep, repfnz,
+				   xprune, marker, parent, xplore,
+				   Glu_persist, Glu_freeable)) != 0)
+		return info;
+	    
+	    /* Copy the U-segments to usub[*]. */
+	    if ((info = set_usub(min_mn, j, nseg, segrep, repfnz,
+				 Glu_persist, Glu_freeable)) != 0)
+		return info;
+
+	    pivotL(j, perm_r, &pivrow, Glu_persist, Glu_freeable); 
+
+	    /* Prune columns [0:j-1] using column j. */
+	    pruneL(j, perm_r, pivrow, nseg, segrep, repfnz, xprune,
+		   Glu_persist, Glu_freeable);
+
+	    /* Reset repfnz[*] to prepare for the next column. */
+	    for (i = 0; i < nseg; i++) {
+		irep = segrep[i];
+		repfnz[irep] = EMPTY;
+	    }
+
+	    ++j;
+	} /* else */
+    } /* for j ... */
+
+    return 0;
+} /* SYMBFACT_SWEEP */
+
+
+#ifdef SYMB_SUBTREES
+static int
+symb_int_cmp(const void *a, const void *b)
+{
+    int_t i = *(const int_t *) a, j = *(const int_t *) b;
+    return (i > j) - (i < j);
+}
+
+static int
+symb_subtree_wt_cmp(const void *a, const void *b)
+{
+    int_t i = ((const symb_subtree_t *) a)->wt;
+    int_t j = ((const symb_subtree_t *) b)->wt;
+    return (i < j) - (i > j); /* heaviest first */
+}
+
+static int
+symb_subtree_fst_cmp(const void *a, const void *b)
+{
+    int_t i = ((const symb_subtree_t *) a)->fst;
+    int_t j = ((const symb_subtree_t *) b)->fst;
+    return (i > j) - (i < j);
+}
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_subtrees() splits the postordered etree from the roots,
+ *   heaviest subtrees first, into disjoint subtrees with at most a
+ *   fraction 1/(4*nthreads) of the nonzeros of A each, and factors them
+ *   concurrently with symbfact_subtree(). A subtree rooted at or above
+ *   column nint, or that would split a relaxed supernode, is split
+ *   further or left to the sweep; so is a subtree with fewer than
+ *   SYMB_SUBTREE_MIN columns.
+ *   Returns the subtrees sorted by first column, or NULL if there are
+ *   fewer than two.
+ * </pre>
+ */
+static symb_subtree_t *symbfact_subtrees
+/************************************************************************/
+(
+ SuperMatrix *A,        /* original matrix A permuted by columns (input) */
+ int_t       *etree,    /* column elimination tree (input) */
+ int_t       *relax_end,/* relaxed supernodes (input) */
+ const int_t maxsuper,  /* max no of columns in a supernode (input) */
+ const int_t nint,      /* first column of the Schur complement (input) */
+ int_t       *nsub      /* number of subtrees (output) */
+ )
+{
+    NCPformat *Astore = (NCPformat *) A->Store;
+    int_t     n = A->ncol, i, j, k, p, r, top, total, target;
+    int_t     *fd, *wt, *head, *next, *stk;
+    symb_subtree_t *sub;
+
+    *nsub = 0;
+    if ( n < 2 * SYMB_SUBTREE_MIN ) return NULL;
+    if ( !(fd = intMalloc_dist(5*n)) ) ABORT("Malloc fails for fd[]");
+    wt = fd + n;
+    head = wt + n;
+    next = head + n;
+    stk = next + n;
+
+    /* First descendant, number of nonzeros and children of each node. */
+    for (j = 0; j < n; ++j) {
+	fd[j] = j;
+	wt[j] = 0;
+	head[j] = EMPTY;
+    }
+    total = top = 0;
+    for (j = 0; j < n; ++j) {
+	wt[j] += Astore->colend[j] - Astore->colbeg[j];
+	p = etree[j];
+	if ( p < n ) {
+	    if ( p <= j ) { /* not postordered */
+		SUPERLU_FREE(fd);
+		return NULL;
+	    }
+	    fd[p] = SUPERLU_MIN(fd[p], fd[j]);
+	    wt[p] += wt[j];
+	} else {
+	    total += wt[j];
+	    stk[top++] = j;
+	}
+    }
+    for (j = n-1; j >= 0; --j)
+	if ( (p = etree[j]) < n ) {
+	    next[j] = head[p];
+	    head[p] = j;
+	}
+
+    target = total / (4 * omp_get_max_threads()) + 1;
+    if ( !(sub = (symb_subtree_t *)
+	   SUPERLU_MALLOC((n / SYMB_SUBTREE_MIN + 1) * sizeof(symb_subtree_t))) )
+	ABORT("Malloc fails for sub[]");
+    k = 0;
+    while ( top > 0 ) {
+	r = stk[--top];
+	if ( r < nint && (wt[r] <= target || relax_end[fd[r]] == r) ) {
+	    if ( r - fd[r] + 1 >= SYMB_SUBTREE_MIN ) {
+		sub[k].fst = fd[r];
+		sub[k].lst = r + 1;
+		sub[k].wt = wt[r];
+		++k;
+	    }
+	} else if ( relax_end[fd[r]] != r ) {
+	    for (i = head[r]; i != EMPTY; i = next[i]) stk[top++] = i;
+	}
+    }
+    SUPERLU_FREE(fd);
+
+    if ( k < 2 ) {
+	SUPERLU_FREE(sub);
+	return NULL;
+    }
+
+    qsort(sub, (size_t) k, sizeof(symb_subtree_t), symb_subtree_wt_cmp);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (i = 0; i < k; ++i)
+	symbfact_subtree(A, relax_end, maxsuper, nint, &sub[i]);
+    qsort(sub, (size_t) k, sizeof(symb_subtree_t), symb_subtree_fst_cmp);
+
+#if ( PRNTlevel>=1 )
+    for (i = j = 0; i < k; ++i) j += sub[i].lst - sub[i].fst;
+    printf(".. symbfact(): " IFMT " subtrees with " IFMT " of " IFMT
+	   " columns, %d threads\n", k, j, n, omp_get_max_threads());
+#endif
+    *nsub = k;
+    return sub;
+} /* SYMBFACT_SUBTREES */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_subtree() performs the symbolic factorization of the columns
+ *   of the subtree sub, on the rows of A in those columns renumbered as
+ *   described in symb_subtree_t, with the supernodes of symbfact(). It
+ *   uses the expanders of the calling thread and restores them on exit.
+ *   sub->info is set to 0 on success.
+ * </pre>
+ */
+static void symbfact_subtree
+/************************************************************************/
+(
+ SuperMatrix *A,        /* original matrix A permuted by columns (input) */
+ int_t       *relax_end,/* relaxed supernodes (input) */
+ const int_t maxsuper,  /* max no of columns in a supernode (input) */
+ const int_t nint,      /* first column of the Schur complement (input) */
+ symb_subtree_t *sub    /* subtree (modified) */
+ )
+{
+    NCPformat *Astore = (NCPformat *) A->Store, Bstore;
+    SuperMatrix B;
+    SuperLU_ExpHeader *expanders_save = expanders;
+    int_t no_expand_save = no_expand;
+    int_t fst = sub->fst, lst = sub->lst, nb = lst - fst;
+    int_t *asub = Astore->rowind, *xa_begin = Astore->colbeg;
+    int_t *xa_end = Astore->colend;
+    int_t *bsub, *xb, *outrow, *iwork, *p;
+    int_t nnz, nout, m, i, j, k, irow;
+
+    sub->info = EMPTY;
+    for (nnz = 0, j = fst; j < lst; ++j) nnz += xa_end[j] - xa_begin[j];
+    if ( !(outrow = intMalloc_dist(SUPERLU_MAX(nnz, 1))) ) return;
+    if ( !(bsub = intMalloc_dist(nnz + 2*nb)) ) {
+	SUPERLU_FREE(outrow);
+	return;
+    }
+    xb = bsub + nnz;
+
+    /* The rows below the subtree; there are none above it. */
+    for (nout = 0, j = fst; j < lst; ++j)
+	for (k = xa_begin[j]; k < xa_end[j]; ++k) {
+	    irow = asub[k];
+	    if ( irow < fst ) { /* not a subtree of the etree of A */
+		SUPERLU_FREE(outrow);
+		SUPERLU_FREE(bsub);
+		return;
+	    }
+	    if ( irow >= lst ) outrow[nout++] = irow;
+	}
+    qsort(outrow, (size_t) nout, sizeof(int_t), symb_int_cmp);
+    for (i = k = 0; i < nout; ++i)
+	if ( k == 0 || outrow[i] != outrow[k-1] ) outrow[k++] = outrow[i];
+    nout = k;
+    m = nb + nout;
+
+    for (k = 0, j = 0; j < nb; ++j) {
+	xb[j] = k;
+	for (i = xa_begin[fst+j]; i < xa_end[fst+j]; ++i) {
+	    irow = asub[i];
+	    if ( irow < lst ) {
+		bsub[k++] = irow - fst;
+	    } else {
+		p = (int_t *) bsearch(&irow, outrow, (size_t) nout,
+				      sizeof(int_t), symb_int_cmp);
+		bsub[k++] = nb + (p - outrow);
+	    }
+	}
+	xb[nb+j] = k;
+    }
+    Bstore.nnz = nnz;
+    Bstore.nzval = NULL;
+    Bstore.rowind = bsub;
+    Bstore.colbeg = xb;
+    Bstore.colend = xb + nb;
+    B.Stype = SLU_NCP;
+    B.Dtype = A->Dtype;
+    B.Mtype = SLU_GE;
+    B.nrow = m;
+    B.ncol = nb;
+    B.Store = &Bstore;
+
+    expanders = NULL;
+    if ( symb_lbound && symb_nbound == A->ncol )
+	symbfact_SubHint(symb_lbound[lst] - symb_lbound[fst] + m,
+			 symb_ubound[lst] - symb_ubound[fst] + m);
+    if ( symbfact_SubInit(DOFACT, NULL, 0, m, nb, nnz, &sub->Glu_persist,
+			  &sub->Glu_freeable) == 0 ) {
+      if ( (iwork = intMalloc_dist(6*m + 2*nb)) ) {
+	int_t *perm_r = iwork, *repfnz = iwork + 2*m, *marker = iwork + 3*m;
+	int_t *xprune = iwork + 6*m, *brelax_end = xprune + nb;
+
+	ifill_dist(perm_r, m, EMPTY);
+	ifill_dist(repfnz, m, EMPTY);
+	ifill_dist(marker, m, EMPTY);
+	for (j = 0; j < nb; ++j)
+	    brelax_end[j] = relax_end[fst+j] == EMPTY ?
+		EMPTY : relax_end[fst+j] - fst;
+	sub->Glu_persist.supno[0] = -1;
+	sub->Glu_persist.xsup[0] = 0;
+	sub->Glu_freeable.xlsub[0] = 0;
+	sub->Glu_freeable.xusub[0] = 0;
+
+	sub->info = symbfact_sweep(&B, maxsuper, nint - fst, iwork, 0, NULL,
+				   &sub->Glu_persist, &sub->Glu_freeable);
+	if ( sub->info == 0 && (sub->xprune = intMalloc_dist(2*nb)) ) {
+	    sub->perm_r = sub->xprune + nb;
+	    for (j = 0; j < nb; ++j) {
+		sub->xprune[j] = xprune[j];
+		sub->perm_r[j] = perm_r[j];
+	    }
+	    sub->nout = nout;
+	    sub->outrow = outrow;
+	} else {
+	    sub->info = EMPTY;
+	}
+	SUPERLU_FREE(iwork);
+      }
+      if ( sub->info ) {
+	  symbfact_SubFree(&sub->Glu_freeable);
+	  SUPERLU_FREE(sub->Glu_persist.xsup);
+	  SUPERLU_FREE(sub->Glu_persist.supno);
+      }
+    }
+
+    if ( expanders ) SUPERLU_FREE(expanders);
+    expanders = expanders_save;
+    no_expand = no_expand_save;
+    if ( sub->info ) SUPERLU_FREE(outrow);
+    SUPERLU_FREE(bsub);
+} /* SYMBFACT_SUBTREE */
+#endif /* SYMB_SUBTREES */
+
+
+/************************************************************************/
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *   symbfact_subtree_merge() appends the structure of the subtree sub to
+ *   the global one in the sweep, as if its columns were factored there:
+ *   the supernode of the column before it is compressed as column_dfs()
+ *   does, and the rows of L(:,lst-1) are marked. The subtree is released.
+ *
+ * Return value
+ * ============
+ *     0  success;
+ *   EMPTY  the structure of sub is not available, or its first column
+ *          joins the supernode of the column before it; the columns
+ *          must be factored by the sweep.
+ *   > 0  number of bytes allocated when run out of space.
+ * </pre>
+ */
+static int_t symbfact_subtree_merge
+/************************************************************************/
+(
+ SuperMatrix *A,        /* original matrix A permuted by columns (input) */
+ const int_t maxsuper,  /* max no of columns in a supernode (input) */
+ const int_t fstschur,  /* column that starts a new supernode (input) */
+ symb_subtree_t *sub,   /* factored subtree (input, released) */
+ int_t       *relax_end,/* relaxed supernodes (input) */
+ int_t       *perm_r,   /* row permutation vector (modified) */
+ int_t       *xprune,   /* pruned location in each adjacency list (modified) */
+ int_t       *marker,   /* working array of size m */
+ Glu_persist_t *Glu_persist,   /* global LU data structures (modified) */
+ Glu_freeable_t *Glu_freeable
+ )
+{
+    NCPformat *Astore = (NCPformat *) A->Store;
+    int_t fst = sub->fst, lst = sub->lst, nb = lst - fst;
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *lsub, *xlsub = Glu_freeable->xlsub;
+    int_t *usub, *xusub = Glu_freeable->xusub;
+    int_t *bxsup, *bsupno, *blsub, *bxlsub, *busub, *bxusub;
+    int_t nsuper, fsupc, jptr, jm1ptr, ito, ifrom, nextl, nextu;
+    int_t i, k, irow, join, mem_error;
+
+    if ( sub->info ) return EMPTY;
+    bxsup = sub->Glu_persist.xsup;
+    bsupno = sub->Glu_persist.supno;
+    blsub = sub->Glu_freeable.lsub;
+    bxlsub = sub->Glu_freeable.xlsub;
+    busub = sub->Glu_freeable.usub;
+    bxusub = sub->Glu_freeable.xusub;
+    nsuper = supno[fst];
+    nextl = xlsub[fst];
+    nextu = xusub[fst];
+
+    if ( fst > 0 && relax_end[fst] == EMPTY ) {
+	/* The tests of column_dfs() on column fst, whose L rows are those
+	   of A(:,fst). */
+	fsupc = xsup[nsuper];
+	jptr = xlsub[fst];
+	jm1ptr = xlsub[fst-1];
+	join = fst - fsupc < maxsuper && fst != fstschur;
+#ifdef T2_SUPER
+	if ( bxlsub[1] != jptr - jm1ptr - 1 ) join = FALSE;
+#endif
+	for (k = Astore->colbeg[fst]; join && k < Astore->colend[fst]; ++k)
+	    if ( marker[Astore->rowind[k]] != fst-1 ) join = FALSE;
+	if ( join ) return EMPTY;
+
+	if ( fsupc < fst-2 ) { /* >= 3 columns in nsuper */
+	    lsub = Glu_freeable->lsub;
+	    ito = xlsub[fsupc+1];
+	    xlsub[fst-1] = ito;
+	    xprune[fst-1] = ito + jptr - jm1ptr;
+	    for (ifrom = jm1ptr; ifrom < jptr; ++ifrom, ++ito)
+		lsub[ito] = lsub[ifrom];
+	    nextl = ito;
+	}
+    }
+
+    while ( nextl + bxlsub[nb] >= Glu_freeable->nzlmax )
+	if ( (mem_error = symbfact_SubXpand(A->ncol, fst, nextl, (MemType) LSUB,
+					    &Glu_freeable->nzlmax, Glu_freeable)) )
+	    return mem_error;
+    while ( nextu + bxusub[nb] > Glu_freeable->nzumax )
+	if ( (mem_error = symbfact_SubXpand(A->ncol, fst, nextu, (MemType) USUB,
+					    &Glu_freeable->nzumax, Glu_freeable)) )
+	    return mem_error;
+    lsub = Glu_freeable->lsub;
+    usub = Glu_freeable->usub;
+
+    /* The supernodes of sub follow nsuper. */
+    ++nsuper;
+    for (k = 0; k <= bsupno[nb] + 1; ++k) xsup[nsuper+k] = fst + bxsup[k];
+    for (i = 0; i <= nb; ++i) {
+	supno[fst+i] = nsuper + bsupno[i];
+	xlsub[fst+i] = nextl + bxlsub[i];
+	xusub[fst+i] = nextu + bxusub[i];
+    }
+    for (i = 0; i < nb; ++i) {
+	xprune[fst+i] = nextl + sub->xprune[i];
+	perm_r[fst+i] = fst + sub->perm_r[i];
+    }
+    for (k = 0; k < bxlsub[nb]; ++k) {
+	irow = blsub[k];
+	lsub[nextl+k] = irow < nb ? fst + irow : sub->outrow[irow - nb];
+    }
+    for (k = 0; k < bxusub[nb]; ++k) usub[nextu+k] = fst + busub[k];
+
+    /* Column lst-1 marked its L rows visited. */
+    for (k = xlsub[lst-1]; k < xlsub[lst]; ++k) marker[lsub[k]] = lst-1;
+
+    symbfact_subtree_free(sub);
+    sub->info = EMPTY;
+    return 0;
+} /* SYMBFACT_SUBTREE_MERGE */
+
+
+static void symbfact_subtree_free(symb_subtree_t *sub)
+{
+    if ( sub->info ) return; /* nothing is held */
+    SUPERLU_FREE(sub->outrow);
+    SUPERLU_FREE(sub->xprune);
+    SUPERLU_FREE(sub->Glu_persist.xsup);
+    SUPERLU_FREE(sub->Glu_persist.supno);
+    SUPERLU_FREE(sub->Glu_freeable.lsub);
+    SUPERLU_FREE(sub->Glu_freeable.xlsub);
+    SUPERLU_FREE(sub->Glu_freeable.usub);
+    SUPERLU_FREE(sub->Glu_freeable.xusub);
+}
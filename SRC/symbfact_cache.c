@@ -0,0 +1,238 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Cache of the column ordering and symbolic factorization, keyed by sparsity pattern
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 6.4) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include "superlu_defs.h"
+
+#define SYMBFACT_CACHE_SIZE 8
+
+typedef struct {
+    symbfact_key_t key;
+    int_t    *perm_c, *etree;       /* size n each */
+    int_t    *xsup, *supno;         /* Glu_persist, size n+1 each */
+    int_t    *xlsub, *lsub;         /* Glu_freeable */
+    int_t    *xusub, *usub;
+    int64_t  nnzLU;
+    int_t    iinfo;                 /* return value of symbfact() */
+    long     stamp;                 /* for least recently used eviction */
+} symbfact_entry_t;
+
+/* The cache is shared by the threads of the process, and only read and
+   written under symb_cache_lock. */
+static symbfact_entry_t symb_cache[SYMBFACT_CACHE_SIZE];
+static int  symb_cache_len = 0;
+static long symb_cache_clock = 0;
+static pthread_mutex_t symb_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int_t *
+symbfact_cache_dup(int_t *src, int_t len)
+{
+    int_t *dst;
+    if ( !(dst = intMalloc_dist(SUPERLU_MAX(len, 1))) )
+	ABORT("Malloc fails for symbfact cache.");
+    memcpy(dst, src, len * sizeof(int_t));
+    return dst;
+}
+
+static void
+symbfact_entry_free(symbfact_entry_t *e)
+{
+    SUPERLU_FREE(e->perm_c);
+    SUPERLU_FREE(e->etree);
+    SUPERLU_FREE(e->xsup);
+    SUPERLU_FREE(e->supno);
+    SUPERLU_FREE(e->xlsub);
+    SUPERLU_FREE(e->lsub);
+    SUPERLU_FREE(e->xusub);
+    SUPERLU_FREE(e->usub);
+}
+
+/*! \brief Compute the key of the global matrix GA (SLU_NC) and options.
+ *
+ * <pre>
+ * The key holds two independent 64-bit hashes of (n, colptr, rowind),
+ * and the options and parameters on which the ordering and symbolic
+ * factorization depend, which are compared exactly. It must be computed
+ * before sp_colorder(), which permutes the row indices of GA in place.
+ * The key does not hold a user-supplied perm_c[]: ColPerm = MY_PERMC
+ * must not be cached.
+ * </pre>
+ */
+void
+symbfact_cache_key(superlu_dist_options_t *options, SuperMatrix *GA,
+		   symbfact_key_t *key)
+{
+    NCformat *Astore = (NCformat *) GA->Store;
+    int_t    n = GA->ncol, nnz = Astore->nnz, i;
+    int_t    *colptr = Astore->colptr, *rowind = Astore->rowind;
+    uint64_t h0 = 14695981039346656037ULL, h1 = 0x9e3779b97f4a7c15ULL, x;
+
+#define SYMB_HASH(v) \
+    x = (uint64_t) (v); \
+    h0 = (h0 ^ x) * 1099511628211ULL; \
+    h1 = (h1 ^ (x + 0x632be59bd9b4e019ULL)) * 0xbf58476d1ce4e5b9ULL; \
+    h1 ^= h1 >> 31;
+
+    SYMB_HASH(n);
+    SYMB_HASH(nnz);
+    for (i = 0; i <= n; ++i) { SYMB_HASH(colptr[i]); }
+    for (i = 0; i < nnz; ++i) { SYMB_HASH(rowind[i]); }
+#undef SYMB_HASH
+
+    key->h[0] = h0;
+    key->h[1] = h1;
+    key->n = n;
+    key->nnz = nnz;
+    key->ColPerm = options->ColPerm;
+    key->SchurSize = options->SchurSize;
+    key->relax = sp_ienv_dist(2);
+    key->maxsuper = sp_ienv_dist(3);
+    key->Amalg_Tol = options->Amalg_Tol;
+    key->DofBlock = options->DofBlock;
+    key->SplitSuper = options->SplitSuper;
+}
+
+static int
+symbfact_key_equal(symbfact_key_t *a, symbfact_key_t *b)
+{
+    return a->h[0] == b->h[0] && a->h[1] == b->h[1] && a->n == b->n
+	&& a->nnz == b->nnz && a->ColPerm == b->ColPerm
+	&& a->SchurSize == b->SchurSize && a->relax == b->relax
+	&& a->maxsuper == b->maxsuper && a->Amalg_Tol == b->Amalg_Tol
+	&& a->DofBlock == b->DofBlock && a->SplitSuper == b->SplitSuper;
+}
+
+/*! \brief Look up the ordering and symbolic factorization of key.
+ *
+ * <pre>
+ * Collective over grid->comm: it is a hit only if key is found by every
+ * process, so that all of them take the same branch in pdgssvx().
+ * On a hit, copies the final perm_c[] (after sp_colorder()) and etree[],
+ * allocates and sets Glu_persist and *Glu_freeable as symbfact() would,
+ * sets *iinfo to the value symbfact() returned, and returns 1.
+ * Returns 0 otherwise.
+ * </pre>
+ */
+int
+symbfact_cache_get(symbfact_key_t *key, int_t *perm_c, int_t *etree,
+		   Glu_persist_t *Glu_persist, Glu_freeable_t **Glu_freeable,
+		   int_t *iinfo, gridinfo_t *grid)
+{
+    symbfact_entry_t *e;
+    Glu_freeable_t *Glu;
+    int_t n = key->n;
+    int   i, hit;
+
+    /* The entry is copied before the processes agree, since another
+       thread may replace it in the meantime. */
+    pthread_mutex_lock(&symb_cache_lock);
+    for (i = 0; i < symb_cache_len; ++i)
+	if ( symbfact_key_equal(&symb_cache[i].key, key) ) break;
+    hit = i < symb_cache_len;
+    if ( !hit ) {
+	pthread_mutex_unlock(&symb_cache_lock);
+	MPI_Allreduce(MPI_IN_PLACE, &hit, 1, MPI_INT, MPI_MIN, grid->comm);
+	return 0;
+    }
+
+    e = &symb_cache[i];
+    e->stamp = ++symb_cache_clock;
+    memcpy(perm_c, e->perm_c, n * sizeof(int_t));
+    memcpy(etree, e->etree, n * sizeof(int_t));
+    Glu_persist->xsup = symbfact_cache_dup(e->xsup, n+1);
+    Glu_persist->supno = symbfact_cache_dup(e->supno, n+1);
+
+    if ( !(Glu = (Glu_freeable_t *) SUPERLU_MALLOC(sizeof(Glu_freeable_t))) )
+	ABORT("Malloc fails for Glu_freeable.");
+    Glu->xlsub = symbfact_cache_dup(e->xlsub, n+1);
+    Glu->lsub = symbfact_cache_dup(e->lsub, e->xlsub[n]);
+    Glu->xusub = symbfact_cache_dup(e->xusub, n+1);
+    Glu->usub = symbfact_cache_dup(e->usub, e->xusub[n]);
+    Glu->nzlmax = SUPERLU_MAX(e->xlsub[n], 1);
+    Glu->nzumax = SUPERLU_MAX(e->xusub[n], 1);
+    Glu->MemModel = SYSTEM;
+    Glu->nnzLU = e->nnzLU;
+    *iinfo = e->iinfo;
+    pthread_mutex_unlock(&symb_cache_lock);
+
+    MPI_Allreduce(MPI_IN_PLACE, &hit, 1, MPI_INT, MPI_MIN, grid->comm);
+    if ( !hit ) { /* missed by another process */
+	SUPERLU_FREE(Glu_persist->xsup);
+	SUPERLU_FREE(Glu_persist->supno);
+	symbfact_SubFree(Glu);
+	SUPERLU_FREE(Glu);
+	return 0;
+    }
+    *Glu_freeable = Glu;
+    return 1;
+}
+
+/*! \brief Save the result of a successful symbfact() under key.
+ *
+ * <pre>
+ * The least recently used entry is replaced when the cache is full.
+ * </pre>
+ */
+void
+symbfact_cache_put(symbfact_key_t *key, int_t *perm_c, int_t *etree,
+		   Glu_persist_t *Glu_persist, Glu_freeable_t *Glu_freeable,
+		   int_t iinfo)
+{
+    symbfact_entry_t *e;
+    int_t n = key->n;
+    int   i, lru = 0;
+
+    pthread_mutex_lock(&symb_cache_lock);
+    if ( symb_cache_len < SYMBFACT_CACHE_SIZE ) {
+	e = &symb_cache[symb_cache_len++];
+    } else {
+	for (i = 1; i < SYMBFACT_CACHE_SIZE; ++i)
+	    if ( symb_cache[i].stamp < symb_cache[lru].stamp ) lru = i;
+	e = &symb_cache[lru];
+	symbfact_entry_free(e);
+    }
+
+    e->key = *key;
+    e->perm_c = symbfact_cache_dup(perm_c, n);
+    e->etree = symbfact_cache_dup(etree, n);
+    e->xsup = symbfact_cache_dup(Glu_persist->xsup, n+1);
+    e->supno = symbfact_cache_dup(Glu_persist->supno, n+1);
+    e->xlsub = symbfact_cache_dup(Glu_freeable->xlsub, n+1);
+    e->lsub = symbfact_cache_dup(Glu_freeable->lsub, Glu_freeable->xlsub[n]);
+    e->xusub = symbfact_cache_dup(Glu_freeable->xusub, n+1);
+    e->usub = symbfact_cache_dup(Glu_freeable->usub, Glu_freeable->xusub[n]);
+    e->nnzLU = Glu_freeable->nnzLU;
+    e->iinfo = iinfo;
+    e->stamp = ++symb_cache_clock;
+    pthread_mutex_unlock(&symb_cache_lock);
+}
+
+/*! \brief Release all the entries of the cache. */
+void
+symbfact_cache_free(void)
+{
+    int i;
+    pthread_mutex_lock(&symb_cache_lock);
+    for (i = 0; i < symb_cache_len; ++i) symbfact_entry_free(&symb_cache[i]);
+    symb_cache_len = 0;
+    pthread_mutex_unlock(&symb_cache_lock);
+}
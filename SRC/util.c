@@ -22,7 +22,9 @@ at the top-level directory.
  */
 
 #include <math.h>
+#include <float.h>
 #include <unistd.h>
+#include <sched.h>
 #include "superlu_ddefs.h"
 
 /*! \brief Deallocate the structure pointing to the actual storage of the matrix. */
@@ -225,8 +227,8 @@ Destroy_LU(int_t n, gridinfo_t *grid, LUstruct_t *LUstruct)
     SUPERLU_FREE(Llu->Ucb_valptr);	
     SUPERLU_FREE(Llu->Urbs);
 
-    SUPERLU_FREE(Glu_persist->xsup);
-    SUPERLU_FREE(Glu_persist->supno);
+    superlu_shm_free(Glu_persist->xsup);
+    superlu_shm_free(Glu_persist->supno);
 
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC(iam, "Exit Destroy_LU()");
@@ -393,6 +395,43 @@ void set_default_options_dist(superlu_dist_options_t *options)
     options->num_lookaheads    = 10;
     options->lookahead_etree   = NO;
     options->SymPattern        = NO;
+    options->SingleFactor      = NO;
+    options->ShareReplicated   = NO;
+    options->SchurSize         = 0;
+    options->BLR_Tol           = 0.0;
+    options->BLR_MinSize       = 64;
+    options->Reproducible      = NO;
+    options->PatternCache      = NO;
+    options->Amalg_Tol         = 0.0;
+    options->RowPerm_Tol       = 0.0;
+    options->Equil_Iter        = 0;
+    options->DenseRoot_Tol     = 0.0;
+    options->Fact_Comm         = SLU_COMM_ISEND;
+    options->Sched_Priority    = NO;
+    options->Panel_Compress    = NO;
+    options->SparseRHS         = NO;
+    options->Solve_RootSize    = 0;
+    options->DiagInv_MinSize   = 1;
+    options->DiagInv_MaxSize   = 0;
+    options->Solve_CritPath    = NO;
+    options->Solve_RHSTile     = 16;
+    options->Predict           = NO;
+    options->MemBudget         = 0.0;
+    options->OutOfCore         = NO;
+    options->ReleaseMemory     = NO;
+    options->RefactorMap       = NO;
+    options->SymValues         = NO;
+    options->Refine_MsgPrec    = SLU_MSG_FULL;
+    options->Overlap_Preproc   = NO;
+    options->DofBlock          = 1;
+    options->Complex_3M        = NO;
+    options->SplitSuper        = 0;
+    options->Dense_MaxN        = 0;
+    options->Solve_Compact     = NO;
+    options->UserSymbFact      = NO;
+    options->Solve_Priority    = NO;
+    options->ILU_DropTol       = 0.0;
+    options->ConditionNumber   = NO;
 #ifdef SLU_HAVE_LAPACK
     options->DiagInv           = YES;
 #else
@@ -420,6 +459,43 @@ void print_options_dist(superlu_dist_options_t *options)
     printf("**    num_lookaheads   : %4d\n", options->num_lookaheads);
     printf("**    SymPattern       : %4d\n", options->SymPattern);
     printf("**    lookahead_etree  : %4d\n", options->lookahead_etree);
+    printf("**    SingleFactor     : %4d\n", options->SingleFactor);
+    printf("**    ShareReplicated  : %4d\n", options->ShareReplicated);
+    printf("**    SchurSize        : %4d\n", options->SchurSize);
+    printf("**    BLR_Tol          : %8.2e\n", options->BLR_Tol);
+    printf("**    BLR_MinSize      : %4d\n", options->BLR_MinSize);
+    printf("**    Reproducible     : %4d\n", options->Reproducible);
+    printf("**    PatternCache     : %4d\n", options->PatternCache);
+    printf("**    Amalg_Tol        : %8.2e\n", options->Amalg_Tol);
+    printf("**    RowPerm_Tol      : %8.2e\n", options->RowPerm_Tol);
+    printf("**    Equil_Iter       : %4d\n", options->Equil_Iter);
+    printf("**    DenseRoot_Tol    : %8.2e\n", options->DenseRoot_Tol);
+    printf("**    Fact_Comm        : %4d\n", options->Fact_Comm);
+    printf("**    Sched_Priority   : %4d\n", options->Sched_Priority);
+    printf("**    Panel_Compress   : %4d\n", options->Panel_Compress);
+    printf("**    SparseRHS        : %4d\n", options->SparseRHS);
+    printf("**    Solve_RootSize   : %4d\n", options->Solve_RootSize);
+    printf("**    DiagInv_MinSize  : %4d\n", options->DiagInv_MinSize);
+    printf("**    DiagInv_MaxSize  : %4d\n", options->DiagInv_MaxSize);
+    printf("**    Solve_CritPath   : %4d\n", options->Solve_CritPath);
+    printf("**    Solve_RHSTile    : %4d\n", options->Solve_RHSTile);
+    printf("**    Predict          : %4d\n", options->Predict);
+    printf("**    MemBudget        : %8.2e\n", options->MemBudget);
+    printf("**    OutOfCore        : %4d\n", options->OutOfCore);
+    printf("**    ReleaseMemory    : %4d\n", options->ReleaseMemory);
+    printf("**    RefactorMap      : %4d\n", options->RefactorMap);
+    printf("**    SymValues        : %4d\n", options->SymValues);
+    printf("**    Refine_MsgPrec   : %4d\n", options->Refine_MsgPrec);
+    printf("**    Overlap_Preproc  : %4d\n", options->Overlap_Preproc);
+    printf("**    DofBlock         : %4d\n", options->DofBlock);
+    printf("**    Complex_3M       : %4d\n", options->Complex_3M);
+    printf("**    SplitSuper       : %4d\n", options->SplitSuper);
+    printf("**    Dense_MaxN       : %4d\n", options->Dense_MaxN);
+    printf("**    Solve_Compact    : %4d\n", options->Solve_Compact);
+    printf("**    UserSymbFact     : %4d\n", options->UserSymbFact);
+    printf("**    Solve_Priority   : %4d\n", options->Solve_Priority);
+    printf("**    ILU_DropTol      : %8.2e\n", options->ILU_DropTol);
+    printf("**    ConditionNumber  : %4d\n", options->ConditionNumber);
     printf("**************************************************\n");
 }
 
@@ -438,14 +514,1088 @@ void print_sp_ienv_dist(superlu_dist_options_t *options)
     printf("**************************************************\n");
 }
 
+/*! \brief Set the counts of the B <-> X redistribution for nrhs columns.
+ *
+ * <pre>
+ * pdgstrs_init() scales the counts and displacements of its
+ * redistribution pattern by the number of right-hand sides it is given.
+ * This rescales them from the per-row counts, so that the triangular
+ * solves can be called with any nrhs on the same pattern.
+ * </pre>
+ */
+void pxgstrs_comm_nrhs(pxgstrs_comm_t *gstrs_comm, int nrhs, gridinfo_t *grid)
+{
+    int procs = grid->nprow * grid->npcol, p, i;
+    int *itemp;
+
+    for (i = 0; i < 2; ++i) {
+	itemp = i ? gstrs_comm->X_to_B_SendCnt : gstrs_comm->B_to_X_SendCnt;
+	for (p = 0; p < procs; ++p) {
+	    itemp[  procs + p] = itemp[        p] * nrhs; /* SendCnt_nrhs */
+	    itemp[3*procs + p] = itemp[2*procs + p] * nrhs; /* RecvCnt_nrhs */
+	    itemp[5*procs + p] = itemp[4*procs + p] * nrhs; /* sdispls_nrhs */
+	    itemp[7*procs + p] = itemp[6*procs + p] * nrhs; /* rdispls_nrhs */
+	}
+    }
+}
+
+/*! \brief Set up the neighborhoods of the B <-> X redistribution.
+ *
+ * <pre>
+ * Each process only exchanges B and X entries with the few processes
+ * that own its rows of B or its diagonal blocks. For each direction, the
+ * processes it sends to and receives from are recorded, with the counts
+ * and displacements of pdgstrs_init(), in a distributed graph
+ * communicator. The redistribution is then one MPI_Neighbor_alltoallv
+ * on that graph instead of a sweep over all the processes followed by a
+ * barrier (see pxgstrs_nbr_exchange()).
+ *
+ * gstrs_comm->X_to_B_nbr[] (and B_to_X_nbr[]) is laid out as:
+ *   nsend, nrecv, dests[nsend], scnt[nsend], sdsp[nsend],
+ *   srcs[nrecv], rcnt[nrecv], rdsp[nrecv],
+ *   followed by the same four count arrays for nrhs columns.
+ * Must be called at the end of pdgstrs_init() by all the processes.
+ * </pre>
+ */
+void pxgstrs_neighbors(pxgstrs_comm_t *gstrs_comm, gridinfo_t *grid)
+{
+    int procs = grid->nprow * grid->npcol, p, d, nsend, nrecv;
+    int *itemp, *nbr, *dests, *srcs;
+    MPI_Comm comm;
+
+    gstrs_comm->B_to_X_comm = gstrs_comm->X_to_B_comm = MPI_COMM_NULL;
+    gstrs_comm->B_to_X_nbr = gstrs_comm->X_to_B_nbr = NULL;
+    gstrs_comm->B_to_X_rowind = gstrs_comm->X_to_B_rowind = NULL;
+    gstrs_comm->buf = NULL;
+    gstrs_comm->buf_size = 0;
+    if ( procs == 1 ) return; /* The redistribution is a copy. */
+
+    for (d = 0; d < 2; ++d) {
+	itemp = d ? gstrs_comm->X_to_B_SendCnt : gstrs_comm->B_to_X_SendCnt;
+	nsend = nrecv = 0;
+	for (p = 0; p < procs; ++p) {
+	    if ( itemp[p] ) ++nsend;           /* SendCnt */
+	    if ( itemp[2*procs + p] ) ++nrecv; /* RecvCnt */
+	}
+	if ( !(nbr = SUPERLU_MALLOC((2 + 5*nsend + 5*nrecv) * sizeof(int))) )
+	    ABORT("Malloc fails for nbr[].");
+	nbr[0] = nsend;
+	nbr[1] = nrecv;
+	dests = nbr + 2;
+	srcs = dests + 3*nsend;
+	nsend = nrecv = 0;
+	for (p = 0; p < procs; ++p) {
+	    if ( itemp[p] ) {
+		dests[nsend] = p;
+		dests[nbr[0] + nsend] = itemp[p];           /* scnt */
+		dests[2*nbr[0] + nsend] = itemp[4*procs + p]; /* sdsp */
+		++nsend;
+	    }
+	    if ( itemp[2*procs + p] ) {
+		srcs[nrecv] = p;
+		srcs[nbr[1] + nrecv] = itemp[2*procs + p];   /* rcnt */
+		srcs[2*nbr[1] + nrecv] = itemp[6*procs + p]; /* rdsp */
+		++nrecv;
+	    }
+	}
+	/* The counts are the weights of the edges. */
+	MPI_Dist_graph_create_adjacent(grid->comm, nrecv, srcs, srcs + nrecv,
+				       nsend, dests, dests + nsend,
+				       MPI_INFO_NULL, 0, &comm);
+	if ( d ) {
+	    gstrs_comm->X_to_B_comm = comm;
+	    gstrs_comm->X_to_B_nbr = nbr;
+	} else {
+	    gstrs_comm->B_to_X_comm = comm;
+	    gstrs_comm->B_to_X_nbr = nbr;
+	}
+    }
+}
+
+/*! \brief Return the redistribution buffer, grown to at least size bytes.
+ */
+void *pxgstrs_buf(pxgstrs_comm_t *gstrs_comm, size_t size)
+{
+    if ( size > gstrs_comm->buf_size ) {
+	if ( gstrs_comm->buf ) SUPERLU_FREE(gstrs_comm->buf);
+	if ( !(gstrs_comm->buf = SUPERLU_MALLOC(size)) )
+	    ABORT("Malloc fails for gstrs_comm->buf[].");
+	gstrs_comm->buf_size = size;
+    }
+    return gstrs_comm->buf;
+}
+
+/*! \brief Exchange the entries of the redistribution with the neighbors.
+ *
+ * <pre>
+ * dir = 0 for B to X, 1 for X to B. The values, nrhs per row, are sent
+ * from send_dbuf and received into recv_dbuf, with the layout of
+ * pdgstrs_init(). The row indices in send_ibuf do not change between
+ * solves, so they are only exchanged the first time; the received ones
+ * are kept in gstrs_comm and returned.
+ * </pre>
+ */
+int_t *pxgstrs_nbr_exchange(pxgstrs_comm_t *gstrs_comm, int dir, int nrhs,
+			    int_t *send_ibuf, void *send_dbuf, void *recv_dbuf,
+			    MPI_Datatype type)
+{
+    MPI_Comm comm = dir ? gstrs_comm->X_to_B_comm : gstrs_comm->B_to_X_comm;
+    int *nbr = dir ? gstrs_comm->X_to_B_nbr : gstrs_comm->B_to_X_nbr;
+    int_t **rowind = dir ? &gstrs_comm->X_to_B_rowind
+			 : &gstrs_comm->B_to_X_rowind;
+    int nsend = nbr[0], nrecv = nbr[1], i, nr;
+    int *scnt = nbr + 2 + nsend, *sdsp = scnt + nsend;
+    int *rcnt = sdsp + nsend + nrecv, *rdsp = rcnt + nrecv;
+    int *scnt_n = rdsp + nrecv, *sdsp_n = scnt_n + nsend;
+    int *rcnt_n = sdsp_n + nsend, *rdsp_n = rcnt_n + nrecv;
+
+    if ( !*rowind ) {
+	for (i = 0, nr = 0; i < nrecv; ++i) nr += rcnt[i];
+	if ( !(*rowind = intMalloc_dist(SUPERLU_MAX(nr, 1))) )
+	    ABORT("Malloc fails for rowind[].");
+	MPI_Neighbor_alltoallv(send_ibuf, scnt, sdsp, mpi_int_t,
+			       *rowind, rcnt, rdsp, mpi_int_t, comm);
+    }
+
+    for (i = 0; i < nsend; ++i) {
+	scnt_n[i] = scnt[i] * nrhs;
+	sdsp_n[i] = sdsp[i] * nrhs;
+    }
+    for (i = 0; i < nrecv; ++i) {
+	rcnt_n[i] = rcnt[i] * nrhs;
+	rdsp_n[i] = rdsp[i] * nrhs;
+    }
+    MPI_Neighbor_alltoallv(send_dbuf, scnt_n, sdsp_n, type,
+			   recv_dbuf, rcnt_n, rdsp_n, type, comm);
+    return *rowind;
+}
+
+/*! \brief Receive the next message of the triangular solve.
+ *
+ * <pre>
+ * The time blocked in MPI_Recv() is added to stat->utime[SOL_COMM], and
+ * the message to stat->sol_msgs[] and sol_bytes[] of its tree.
+ * </pre>
+ */
+void pxgstrs_recv(void *buf, int count, MPI_Datatype type, gridinfo_t *grid,
+		  MPI_Status *status, SuperLUStat_t *stat)
+{
+    double t = SuperLU_timer_();
+    int bytes;
+
+    MPI_Recv(buf, count, type, MPI_ANY_SOURCE, MPI_ANY_TAG, grid->comm,
+	     status);
+    stat->utime[SOL_COMM] += SuperLU_timer_() - t;
+    if ( status->MPI_TAG >= BC_L + SOL_LOWP && status->MPI_TAG <= RD_U + SOL_LOWP ) {
+	MPI_Type_size(type, &bytes);
+	pxgstrs_lowp_unpack(buf, bytes);
+	status->MPI_TAG -= SOL_LOWP;
+    }
+    if ( status->MPI_TAG >= BC_L && status->MPI_TAG <= RD_U ) {
+	MPI_Get_count(status, MPI_BYTE, &bytes);
+	stat->sol_msgs[status->MPI_TAG - BC_L] += 1;
+	stat->sol_bytes[status->MPI_TAG - BC_L] += bytes;
+    }
+}
+
+#define SOL_RECV_DEPTH 4 /* default of $SUPERLU_RECV_DEPTH */
+#define SOL_AGGR_BYTES 512 /* default of $SUPERLU_SOL_AGGR */
+#define SOL_WAIT_SPIN 64   /* default of $SUPERLU_SOL_SPIN */
+#define SOL_LSUM_MB 64     /* default of $SUPERLU_SOL_LSUM_MB */
+#define AGG_HDR 16       /* header of a message in a packet: tag, bytes */
+#define AGG_PAD(b) (((b) + AGG_HDR - 1) / AGG_HDR * AGG_HDR)
+
+/*! \brief The number of receives kept posted by a triangular solve,
+ *         $SUPERLU_RECV_DEPTH if set.
+ */
+int pxgstrs_ring_depth(void)
+{
+    char *ttemp = getenv("SUPERLU_RECV_DEPTH");
+    return ( ttemp && atoi(ttemp) > 0 ) ? atoi(ttemp) : SOL_RECV_DEPTH;
+}
+
+/*! \brief The slots of the receive buffer of a triangular solve needed
+ *         besides those of the kept messages, see pxgstrs_ring_init().
+ */
+int pxgstrs_ring_slots(gridinfo_t *grid)
+{
+    return pxgstrs_ring_depth() + grid->nprow + grid->npcol;
+}
+
+/*! \brief Wait for some of the n requests req[], as MPI_Waitsome().
+ *
+ * <pre>
+ * The requests are polled $SUPERLU_SOL_SPIN times (default
+ * SOL_WAIT_SPIN) with MPI_Testsome(), the thread running the ready
+ * OpenMP tasks of its team in between, before blocking in
+ * MPI_Waitsome(). With $SUPERLU_SOL_YIELD = 1 the polling goes on
+ * instead, the core being given up with sched_yield() between two
+ * polls, for the MPI libraries whose blocking waits spin on it.
+ * </pre>
+ */
+void pxgstrs_waitsome(int n, MPI_Request *req, int *ndone, int *done,
+		      MPI_Status *status)
+{
+    char *ttemp = getenv("SUPERLU_SOL_SPIN");
+    int spin = ttemp ? atoi(ttemp) : SOL_WAIT_SPIN, i;
+    int yield = (ttemp = getenv("SUPERLU_SOL_YIELD")) && atoi(ttemp) == 1;
+
+    for (i = 0; i < spin || yield; ++i) {
+	MPI_Testsome(n, req, ndone, done, status);
+	if ( *ndone ) return;
+	if ( i < spin ) {
+#ifdef _OPENMP
+#pragma omp taskyield
+#endif
+	} else {
+	    sched_yield();
+	}
+    }
+    MPI_Waitsome(n, req, ndone, done, status);
+}
+
+/*! \brief Wait for all the n requests req[], see pxgstrs_waitsome().
+ */
+void pxgstrs_waitall(int n, MPI_Request *req)
+{
+    int i, ndone, idone;
+
+    for (i = 0; i < n; ++i)
+	pxgstrs_waitsome(1, &req[i], &ndone, &idone, MPI_STATUSES_IGNORE);
+}
+
+/*! \brief Whether the threads of a triangular solve share one lsum[] of
+ *         size bytes instead of keeping a copy each.
+ *
+ * <pre>
+ * The copies are kept while they take at most $SUPERLU_SOL_LSUM_MB
+ * megabytes (default SOL_LSUM_MB) together; beyond, the workspace
+ * would grow with the number of threads, and the shared lsum[] is
+ * updated with atomic adds, see LSUM_COPY().
+ * </pre>
+ */
+int pxgstrs_lsum_shared(size_t size, int num_thread)
+{
+    char *ttemp = getenv("SUPERLU_SOL_LSUM_MB");
+    double mb = ttemp ? atof(ttemp) : SOL_LSUM_MB;
+
+    return num_thread > 1 && (double) size * num_thread > mb * 1e6;
+}
+
+/* A free slot of the receive buffer. */
+static int pxgstrs_ring_slot(pxgstrs_ring_t *ring)
+{
+    if ( ring->nfree ) return ring->freeslots[--ring->nfree];
+    if ( ring->fresh < ring->nslot ) return ring->fresh++;
+    ABORT("pxgstrs_ring: out of receive slots.");
+    return -1;
+}
+
+/* Post receives into free slots until depth are posted, or one is posted
+   for each message not known to be received; with a plan, from each
+   source, for its own messages. */
+static void pxgstrs_ring_post(pxgstrs_ring_t *ring)
+{
+    int i, p, s, nposted = 0;
+
+    if ( ring->nsrc ) {
+	for (i = 0; i < ring->depth; ++i) {
+	    p = i / ring->persrc;
+	    if ( ring->rslot[i] >= 0 || ring->src_cover[p] >= ring->src_left[p] )
+		continue;
+	    s = pxgstrs_ring_slot(ring);
+	    MPI_Irecv(ring->buf + s * ring->slot, ring->count, ring->type,
+		      ring->srcs[p], MPI_ANY_TAG, ring->comm, &ring->req[i]);
+	    ring->rslot[i] = s;
+	    ++ring->src_cover[p];
+	}
+	return;
+    }
+
+    for (i = 0; i < ring->depth; ++i)
+	if ( ring->rslot[i] >= 0 && ring->req[i] != MPI_REQUEST_NULL )
+	    ++nposted;
+    for (i = 0; i < ring->depth; ++i) {
+	/* The completed receives hold at least one message each. */
+	if ( nposted + ring->npkt + ring->ndone - ring->idone >= ring->left )
+	    break;
+	if ( ring->rslot[i] >= 0 ) continue;
+	s = pxgstrs_ring_slot(ring);
+	MPI_Irecv(ring->buf + s * ring->slot, ring->count, ring->type,
+		  MPI_ANY_SOURCE, MPI_ANY_TAG, ring->comm, &ring->req[i]);
+	ring->rslot[i] = s;
+	++nposted;
+    }
+}
+
+/*! \brief Pre-post the receives of the nmsg messages of a triangular solve.
+ *
+ * <pre>
+ * The messages, of at most count entries of type, are received into the
+ * nslot slots of buf, of count entries each. pxgstrs_ring_depth() of them
+ * stay posted, so that a message finds its receive waiting rather than
+ * going through the unexpected-message queue, and the next receive is
+ * posted while the last message is processed. A slot is reused once its
+ * message is processed, unless pxgstrs_ring_keep() is called for it; the
+ * kept messages and the depth must fit in nslot. Exactly nmsg messages
+ * must be received with pxgstrs_ring_recv() before pxgstrs_ring_free().
+ *
+ * The messages aggregated by agg on the other processes arrive in
+ * packets (tag AG_SOL), handed out one message at a time. The packets of
+ * agg, if not NULL, are sent before the ring blocks, and waited for by
+ * pxgstrs_ring_free().
+ *
+ * plan, if not NULL, has nprow*npcol+1 entries and is kept by the caller
+ * between the solves with the same messages, i.e. the same factors, trees
+ * and pruning. If plan[nprow*npcol] is not nmsg, the number of messages
+ * received from each rank p is recorded in plan[p], and nmsg in
+ * plan[nprow*npcol] once all are received. Otherwise the plan is
+ * followed: the receives are posted from each of the ranks that send,
+ * max(1, ceil(depth / number of ranks)) of them, for its remaining
+ * messages, and are matched without MPI_ANY_SOURCE. nslot must leave
+ * room for pxgstrs_ring_slots() receives besides the kept messages.
+ * </pre>
+ */
+void pxgstrs_ring_init(pxgstrs_ring_t *ring, void *buf, int count,
+		       MPI_Datatype type, int nslot, int nmsg,
+		       pxgstrs_agg_t *agg, int *plan, gridinfo_t *grid)
+{
+    int i, p, size, depth = pxgstrs_ring_depth();
+    int procs = grid->nprow * grid->npcol;
+
+    MPI_Type_size(type, &size);
+    ring->buf = (char *) buf;
+    ring->slot = (size_t) count * size;
+    ring->nslot = nslot;
+    ring->count = count;
+    ring->type = type;
+    ring->comm = grid->comm;
+    ring->procs = procs;
+    ring->nmsg = ring->left = nmsg;
+    ring->plan = plan;
+    ring->record = 0;
+    ring->nsrc = 0;
+    ring->srcs = NULL;
+    ring->cursrc = -1;
+    if ( plan && plan[procs] == nmsg ) {
+	for (p = 0; p < procs; ++p)
+	    if ( plan[p] ) ++ring->nsrc;
+	if ( ring->nsrc > grid->nprow + grid->npcol ) ring->nsrc = 0;
+    } else if ( plan ) {
+	for (p = 0; p < procs; ++p) plan[p] = 0;
+	plan[procs] = -1;
+	ring->record = 1;
+    }
+    if ( ring->nsrc ) {
+	ring->persrc = SUPERLU_MAX(1, (depth + ring->nsrc - 1) / ring->nsrc);
+	ring->depth = ring->nsrc * ring->persrc;
+	if ( !(ring->srcs = (int *) SUPERLU_MALLOC(3 * ring->nsrc * sizeof(int))) )
+	    ABORT("Malloc fails for ring->srcs[].");
+	ring->src_left = ring->srcs + ring->nsrc;
+	ring->src_cover = ring->src_left + ring->nsrc;
+	for (i = 0, p = 0; p < procs; ++p)
+	    if ( plan[p] ) {
+		ring->srcs[i] = p;
+		ring->src_left[i] = plan[p];
+		ring->src_cover[i++] = 0;
+	    }
+    } else {
+	ring->depth = SUPERLU_MAX(1, SUPERLU_MIN(depth, nmsg));
+    }
+    ring->req = (MPI_Request *) SUPERLU_MALLOC(ring->depth * sizeof(MPI_Request));
+    ring->status = (MPI_Status *) SUPERLU_MALLOC(ring->depth * sizeof(MPI_Status));
+    ring->rslot = (int *) SUPERLU_MALLOC((2 * ring->depth + nslot + 1)
+					 * sizeof(int));
+    if ( !ring->req || !ring->status || !ring->rslot )
+	ABORT("Malloc fails for the receive ring.");
+    ring->done = ring->rslot + ring->depth;
+    ring->freeslots = ring->done + ring->depth;
+    for (i = 0; i < ring->depth; ++i) {
+	ring->req[i] = MPI_REQUEST_NULL;
+	ring->rslot[i] = -1;
+    }
+    ring->ndone = ring->idone = 0;
+    ring->nfree = ring->fresh = 0;
+    ring->cur = -1;
+    ring->keep = 0;
+    ring->agg = agg;
+    ring->npkt = 0;
+    ring->pkt = NULL;
+    ring->pktkeep = 0;
+    ring->prio = NULL;
+    ring->nprio = 0;
+    pxgstrs_ring_post(ring);
+}
+
+/*! \brief Hand out the messages completed by one wait by priority.
+ *
+ * <pre>
+ * prio[k], k < nprio, is the priority of the messages of supernode k,
+ * whose number is the first entry of the message; the larger first. The
+ * messages of a packet take the largest priority among them. Set after
+ * pxgstrs_ring_init(); prio[] is kept by the caller until
+ * pxgstrs_ring_free().
+ * </pre>
+ */
+void pxgstrs_ring_prio(pxgstrs_ring_t *ring, int_t *prio, int_t nprio)
+{
+    ring->prio = prio;
+    ring->nprio = nprio;
+}
+
+/* The priority of the message msg of tag, of supernode k = msg[0]. */
+static int_t pxgstrs_msg_prio(pxgstrs_ring_t *ring, char *msg, int tag,
+			      int bytes)
+{
+    int   size = (int) (ring->slot / ring->count), i;
+    int_t k, p, best = -1;
+
+    if ( tag == AG_SOL ) {
+	for (i = 0; i < bytes; i += AGG_HDR + AGG_PAD(((int *) (msg + i))[1])) {
+	    p = pxgstrs_msg_prio(ring, msg + i + AGG_HDR, ((int *) (msg + i))[0], 0);
+	    best = SUPERLU_MAX(best, p);
+	}
+	return best;
+    }
+    /* The header of a message in reduced precision is kept in full. */
+    k = size == sizeof(float) ? (int_t) *(float *) msg : (int_t) *(double *) msg;
+    return ( k >= 0 && k < ring->nprio ) ? ring->prio[k] : -1;
+}
+
+/* Swap the completed receive of highest priority to done[idone]. */
+static void pxgstrs_ring_first(pxgstrs_ring_t *ring)
+{
+    int   j, jbest = ring->idone, bytes;
+    int_t p, best = -1;
+    MPI_Status st;
+
+    for (j = ring->idone; j < ring->ndone; ++j) {
+	MPI_Get_count(&ring->status[j], MPI_BYTE, &bytes);
+	p = pxgstrs_msg_prio(ring, ring->buf + ring->rslot[ring->done[j]]
+			     * ring->slot, ring->status[j].MPI_TAG, bytes);
+	if ( p > best ) {
+	    best = p;
+	    jbest = j;
+	}
+    }
+    if ( jbest != ring->idone ) {
+	j = ring->done[jbest];
+	ring->done[jbest] = ring->done[ring->idone];
+	ring->done[ring->idone] = j;
+	st = ring->status[jbest];
+	ring->status[jbest] = ring->status[ring->idone];
+	ring->status[ring->idone] = st;
+    }
+}
+
+/*! \brief Return the next message received by the ring.
+ *
+ * <pre>
+ * The slot of the previous message is reposted, unless it is kept. The
+ * time waiting for a message is added to stat->utime[SOL_COMM], and
+ * the message to stat->sol_msgs[] and sol_bytes[] of its tree, as by
+ * pxgstrs_recv(). All the messages completed by one wait, see
+ * pxgstrs_waitsome(), are handed out before waiting again, in the order
+ * they complete or by the priority set with pxgstrs_ring_prio(). A
+ * message sent in reduced precision is expanded in its slot, see
+ * pxgstrs_lowp_unpack().
+ * </pre>
+ */
+void *pxgstrs_ring_recv(pxgstrs_ring_t *ring, MPI_Status *status,
+			SuperLUStat_t *stat)
+{
+    double t;
+    char *msg;
+    int i, bytes;
+
+    if ( ring->npkt ) {
+	/* The next message of the packet of slot cur. */
+	ring->pktkeep |= ring->keep;
+	ring->keep = 0;
+    } else {
+	if ( ring->cur >= 0 && !ring->keep && !ring->pktkeep )
+	    ring->freeslots[ring->nfree++] = ring->cur;
+	ring->cur = -1;
+	ring->keep = ring->pktkeep = 0;
+	pxgstrs_ring_post(ring);
+
+	if ( ring->idone == ring->ndone ) {
+	    if ( ring->agg ) pxgstrs_agg_flush(ring->agg);
+	    t = SuperLU_timer_();
+	    pxgstrs_waitsome(ring->depth, ring->req, &ring->ndone, ring->done,
+			     ring->status);
+	    stat->utime[SOL_COMM] += SuperLU_timer_() - t;
+	    if ( ring->ndone == MPI_UNDEFINED )
+		ABORT("pxgstrs_ring: no receive posted.");
+	    ring->idone = 0;
+	}
+	if ( ring->prio && ring->ndone - ring->idone > 1 )
+	    pxgstrs_ring_first(ring);
+	*status = ring->status[ring->idone];
+	i = ring->done[ring->idone++];
+	if ( ring->nsrc ) ring->cursrc = i / ring->persrc;
+	ring->cur = ring->rslot[i];
+	ring->rslot[i] = -1;
+	msg = ring->buf + ring->cur * ring->slot;
+
+	if ( status->MPI_TAG == AG_SOL ) {
+	    MPI_Get_count(status, MPI_BYTE, &bytes);
+	    for (ring->npkt = 0, i = 0; i < bytes; ++ring->npkt)
+		i += AGG_HDR + AGG_PAD(((int *) (msg + i))[1]);
+	    ring->pkt = msg;
+	    if ( ring->nsrc ) ring->src_cover[ring->cursrc] += ring->npkt - 1;
+	    ++stat->sol_packets;
+	}
+    }
+
+    if ( ring->npkt ) {
+	/* A message of a packet: its tag and size are in its header. */
+	status->MPI_TAG = ((int *) ring->pkt)[0];
+	bytes = ((int *) ring->pkt)[1];
+	msg = ring->pkt + AGG_HDR;
+	ring->pkt = msg + AGG_PAD(bytes);
+	--ring->npkt;
+    } else {
+	MPI_Get_count(status, MPI_BYTE, &bytes);
+	if ( status->MPI_TAG >= BC_L + SOL_LOWP
+	     && status->MPI_TAG <= RD_U + SOL_LOWP ) {
+	    pxgstrs_lowp_unpack(msg, (int) (ring->slot / ring->count));
+	    status->MPI_TAG -= SOL_LOWP;
+	}
+    }
+    --ring->left;
+    if ( ring->nsrc ) {
+	--ring->src_left[ring->cursrc];
+	--ring->src_cover[ring->cursrc];
+    }
+    if ( ring->record ) ++ring->plan[status->MPI_SOURCE];
+
+    if ( status->MPI_TAG >= BC_L && status->MPI_TAG <= RD_U ) {
+	stat->sol_msgs[status->MPI_TAG - BC_L] += 1;
+	stat->sol_bytes[status->MPI_TAG - BC_L] += bytes;
+    }
+    return msg;
+}
+
+/*! \brief Keep the slot of the last message: its buffer stays in use,
+ *         e.g. by a forwarding send, until the end of the solve.
+ */
+void pxgstrs_ring_keep(pxgstrs_ring_t *ring)
+{
+    ring->keep = 1;
+}
+
+/*! \brief Free the ring after its last message, and wait for the packets
+ *         sent by its aggregator.
+ *
+ * <pre>
+ * The receives posted in excess, when packets held several messages, are
+ * cancelled; no message of the next solve can match them, as the solves
+ * are separated by a barrier.
+ * </pre>
+ */
+void pxgstrs_ring_free(pxgstrs_ring_t *ring)
+{
+    int i;
+
+    for (i = 0; i < ring->depth; ++i)
+	if ( ring->rslot[i] >= 0 && ring->req[i] != MPI_REQUEST_NULL ) {
+	    MPI_Cancel(&ring->req[i]);
+	    MPI_Wait(&ring->req[i], MPI_STATUS_IGNORE);
+	}
+    if ( ring->agg ) pxgstrs_agg_wait(ring->agg);
+    if ( ring->record && ring->left == 0 )
+	ring->plan[ring->procs] = ring->nmsg;
+    if ( ring->srcs ) SUPERLU_FREE(ring->srcs);
+    SUPERLU_FREE(ring->req);
+    SUPERLU_FREE(ring->status);
+    SUPERLU_FREE(ring->rslot);
+}
+
+/*! \brief Set up the aggregation of the small messages of the solves.
+ *
+ * <pre>
+ * The messages of at most $SUPERLU_SOL_AGGR bytes (default 512, 0 turns
+ * the aggregation off) that the broadcast and reduction trees of a solve
+ * forward, see BcTree_SetAggregator(), are copied into one packet per
+ * destination instead of being sent each on its own. A packet is sent
+ * when it is full, or when the process is about to wait for messages
+ * (see pxgstrs_ring_recv()): the messages produced by the processing of
+ * the messages at hand go together, and none is held while its sender
+ * waits. A packet holding one message is sent as that message.
+ *
+ * cap is the size of a receive slot of the solve in bytes, the same on
+ * all the processes. Returns NULL if the aggregation is off.
+ * </pre>
+ */
+pxgstrs_agg_t *pxgstrs_agg_init(size_t cap, gridinfo_t *grid)
+{
+    pxgstrs_agg_t *agg;
+    char *ttemp = getenv("SUPERLU_SOL_AGGR");
+    long maxmsg = ttemp ? atol(ttemp) : SOL_AGGR_BYTES;
+    int  nprocs = grid->nprow * grid->npcol, p;
+
+    /* A packet holds at least two messages. */
+    cap = cap / AGG_HDR * AGG_HDR;
+    maxmsg = SUPERLU_MIN(maxmsg, ((long) cap / 2 - AGG_HDR) / AGG_HDR * AGG_HDR);
+    if ( maxmsg <= 0 ) return NULL;
+
+    if ( !(agg = (pxgstrs_agg_t *) SUPERLU_MALLOC(sizeof(pxgstrs_agg_t))) )
+	ABORT("Malloc fails for agg.");
+    agg->comm = grid->comm;
+    agg->maxmsg = maxmsg;
+    agg->cap = cap;
+    agg->buf = (char **) SUPERLU_MALLOC(nprocs * sizeof(char *));
+    agg->len = (size_t *) SUPERLU_MALLOC(nprocs * sizeof(size_t));
+    agg->pending = (int *) SUPERLU_MALLOC(nprocs * sizeof(int));
+    if ( !agg->buf || !agg->len || !agg->pending )
+	ABORT("Malloc fails for agg.");
+    for (p = 0; p < nprocs; ++p) agg->buf[p] = NULL;
+    agg->npending = 0;
+    agg->pool = agg->fbuf = NULL;
+    agg->freq = NULL;
+    agg->npool = agg->maxpool = agg->npackets = agg->nflight = 0;
+    return agg;
+}
+
+/* Send the packet of rank p. */
+static void pxgstrs_agg_send(pxgstrs_agg_t *agg, int p)
+{
+    char *pkt = agg->buf[p];
+    int  *hdr = (int *) pkt;
+
+    if ( agg->len[p] == AGG_HDR + AGG_PAD(hdr[1]) ) /* one message, as is */
+	MPI_Isend(pkt + AGG_HDR, hdr[1], MPI_BYTE, p, hdr[0], agg->comm,
+		  &agg->freq[agg->nflight]);
+    else
+	MPI_Isend(pkt, (int) agg->len[p], MPI_BYTE, p, AG_SOL, agg->comm,
+		  &agg->freq[agg->nflight]);
+    agg->fbuf[agg->nflight++] = pkt;
+    agg->buf[p] = NULL;
+}
+
+/* A free packet: from the pool, or one whose send is done, or a new one. */
+static char *pxgstrs_agg_packet(pxgstrs_agg_t *agg)
+{
+    char *pkt;
+    int i, j, flag;
+
+    if ( !agg->npool ) {
+	for (i = j = 0; i < agg->nflight; ++i) {
+	    MPI_Test(&agg->freq[i], &flag, MPI_STATUS_IGNORE);
+	    if ( flag ) {
+		agg->pool[agg->npool++] = agg->fbuf[i];
+	    } else {
+		agg->freq[j] = agg->freq[i];
+		agg->fbuf[j++] = agg->fbuf[i];
+	    }
+	}
+	agg->nflight = j;
+    }
+    if ( agg->npool ) return agg->pool[--agg->npool];
+
+    /* A new packet; the lists grow to hold all of them. */
+    if ( agg->npackets == agg->maxpool ) {
+	char **pool = agg->pool, **fbuf = agg->fbuf;
+	MPI_Request *freq = agg->freq;
+	agg->maxpool = SUPERLU_MAX(8, 2 * agg->maxpool);
+	agg->pool = (char **) SUPERLU_MALLOC(2 * agg->maxpool * sizeof(char *));
+	agg->freq = (MPI_Request *) SUPERLU_MALLOC(agg->maxpool
+						   * sizeof(MPI_Request));
+	if ( !agg->pool || !agg->freq ) ABORT("Malloc fails for agg packets.");
+	agg->fbuf = agg->pool + agg->maxpool;
+	for (i = 0; i < agg->nflight; ++i) {
+	    agg->fbuf[i] = fbuf[i];
+	    agg->freq[i] = freq[i];
+	}
+	if ( pool ) {
+	    SUPERLU_FREE(pool);
+	    SUPERLU_FREE(freq);
+	}
+    }
+    ++agg->npackets;
+    if ( !(pkt = (char *) SUPERLU_MALLOC(agg->cap)) )
+	ABORT("Malloc fails for an agg packet.");
+    return pkt;
+}
+
+/*! \brief Add the message buf of bytes with tag to the packet of rank p.
+ *
+ * Returns 0, and does nothing, if the message is too large: it is then
+ * sent as usual.
+ */
+int pxgstrs_agg_put(pxgstrs_agg_t *agg, int p, int tag, void *buf,
+		    size_t bytes)
+{
+    int *hdr;
+
+    if ( bytes > agg->maxmsg ) return 0;
+    if ( !agg->buf[p] ) {
+	agg->buf[p] = pxgstrs_agg_packet(agg);
+	agg->len[p] = 0;
+	agg->pending[agg->npending++] = p;
+    } else if ( agg->len[p] + AGG_HDR + AGG_PAD(bytes) > agg->cap ) {
+	pxgstrs_agg_send(agg, p); /* full; p stays pending */
+	agg->buf[p] = pxgstrs_agg_packet(agg);
+	agg->len[p] = 0;
+    }
+    hdr = (int *) (agg->buf[p] + agg->len[p]);
+    hdr[0] = tag;
+    hdr[1] = (int) bytes;
+    memcpy(agg->buf[p] + agg->len[p] + AGG_HDR, buf, bytes);
+    agg->len[p] += AGG_HDR + AGG_PAD(bytes);
+    return 1;
+}
+
+/*! \brief Send the packets being filled. */
+void pxgstrs_agg_flush(pxgstrs_agg_t *agg)
+{
+    int i, p;
+
+    for (i = 0; i < agg->npending; ++i) {
+	p = agg->pending[i];
+	if ( agg->buf[p] ) pxgstrs_agg_send(agg, p);
+    }
+    agg->npending = 0;
+}
+
+/*! \brief Send the packets being filled, and wait for all the packets. */
+void pxgstrs_agg_wait(pxgstrs_agg_t *agg)
+{
+    int i;
+
+    pxgstrs_agg_flush(agg);
+    MPI_Waitall(agg->nflight, agg->freq, MPI_STATUSES_IGNORE);
+    for (i = 0; i < agg->nflight; ++i) agg->pool[agg->npool++] = agg->fbuf[i];
+    agg->nflight = 0;
+}
+
+void pxgstrs_agg_free(pxgstrs_agg_t *agg)
+{
+    int i;
+
+    if ( !agg ) return;
+    pxgstrs_agg_wait(agg);
+    for (i = 0; i < agg->npool; ++i) SUPERLU_FREE(agg->pool[i]);
+    if ( agg->pool ) {
+	SUPERLU_FREE(agg->pool);
+	SUPERLU_FREE(agg->freq);
+    }
+    SUPERLU_FREE(agg->buf);
+    SUPERLU_FREE(agg->len);
+    SUPERLU_FREE(agg->pending);
+    SUPERLU_FREE(agg);
+}
+
+#define LOWP_META  16 /* after the header: n, precision, scaling exponent */
+#define LOWP_FIRST 8  /* values set aside by the in-place expansion */
+
+/* Value i of the msg of entries of size bytes. */
+#define LOWP_GET(msg, size, i) ( (size) == sizeof(double) \
+    ? ((double *) (msg))[i] : (double) ((float *) (msg))[i] )
+
+static void lowp_put(char *msg, int size, int i, double v)
+{
+    if ( size == sizeof(double) ) ((double *) msg)[i] = v;
+    else ((float *) msg)[i] = (float) v;
+}
+
+static double lowp_get(char *val, int prec, int i)
+{
+    uint32_t u;
+    float f;
+
+    if ( prec == SLU_MSG_SINGLE ) return ((float *) val)[i];
+    u = (uint32_t) ((uint16_t *) val)[i] << 16;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/*! \brief Pack a message of a solve tree with its values in reduced precision.
+ *
+ * <pre>
+ * msg holds count entries of size bytes (float or double): a header of
+ * XK_H (= LSUM_H) entries, copied as is, then the values. They are scaled
+ * by a power of 2 that brings the largest into [0.5, 1), and written into
+ * buf in single precision (prec = SLU_MSG_SINGLE) or bfloat16 rounded to
+ * nearest (SLU_MSG_BF16), after their number, prec and the exponent of
+ * the scaling. buf must hold count * size + LOWP_META bytes.
+ *
+ * Returns the bytes of buf to send with the tag of the tree + SOL_LOWP,
+ * or 0 if the message is to be sent as it is: prec is SLU_MSG_FULL, or
+ * the packed message would not be smaller.
+ * </pre>
+ */
+int pxgstrs_lowp_pack(int prec, void *msg, int count, int size, void *buf)
+{
+    char *out = (char *) buf, *val = (char *) msg + XK_H * size;
+    int  *meta = (int *) (out + XK_H * size);
+    int  n = count - XK_H, vsize, bytes, e = 0, i;
+    double amax = 0., v;
+    uint32_t u;
+    float f;
+
+    if ( prec == SLU_MSG_SINGLE && size > (int) sizeof(float) ) vsize = sizeof(float);
+    else if ( prec == SLU_MSG_BF16 ) vsize = sizeof(uint16_t);
+    else return 0;
+    bytes = XK_H * size + LOWP_META + n * vsize;
+    bytes = (bytes + size - 1) / size * size;
+    if ( n <= 0 || bytes >= count * size ) return 0;
+
+    for (i = 0; i < n; ++i) {
+	v = fabs(LOWP_GET(val, size, i));
+	if ( v > amax ) amax = v;
+    }
+    if ( amax > 0. && amax <= DBL_MAX ) frexp(amax, &e);
+
+    memcpy(out, msg, XK_H * size);
+    meta[0] = n;
+    meta[1] = prec;
+    meta[2] = e;
+    meta[3] = 0;
+    out += XK_H * size + LOWP_META;
+    for (i = 0; i < n; ++i) {
+	f = (float) ldexp(LOWP_GET(val, size, i), -e);
+	if ( prec == SLU_MSG_SINGLE ) {
+	    ((float *) out)[i] = f;
+	} else {
+	    memcpy(&u, &f, sizeof(u));
+	    if ( f != f ) u = 0x7fc00000u; /* NaN stays a NaN */
+	    else u += 0x7fffu + ((u >> 16) & 1);
+	    ((uint16_t *) out)[i] = (uint16_t) (u >> 16);
+	}
+    }
+    return bytes;
+}
+
+/*! \brief Expand in place a message packed by pxgstrs_lowp_pack().
+ *
+ * <pre>
+ * msg, of entries of size bytes, must have room for the message before
+ * packing, as a receive slot of the solve does. The values are written
+ * from the last one down, over the packed ones not yet read, the first
+ * LOWP_FIRST of them being set aside.
+ * </pre>
+ */
+void pxgstrs_lowp_unpack(void *msg, int size)
+{
+    char *hdr = (char *) msg + XK_H * size, *val = hdr + LOWP_META;
+    int  *meta = (int *) hdr, n = meta[0], prec = meta[1], e = meta[2];
+    int  nf = SUPERLU_MIN(n, LOWP_FIRST), i;
+    double first[LOWP_FIRST];
+
+    for (i = 0; i < nf; ++i) first[i] = lowp_get(val, prec, i);
+    for (i = n - 1; i >= nf; --i)
+	lowp_put(hdr, size, i, ldexp(lowp_get(val, prec, i), e));
+    for (i = 0; i < nf; ++i) lowp_put(hdr, size, i, ldexp(first[i], e));
+}
+
+/*! \brief Measure the critical path of a triangular solve through the
+ *         supernodal etree.
+ *
+ * <pre>
+ * On entry, tdone[k] is the time at which this process solved X[k],
+ * from a barrier at the start of the solve, or -1. The path ends at the
+ * last X[k] solved by any process, and is followed back through the
+ * child solved last for the L-solve (uplo = 'L'), or through the parents
+ * for the U-solve. sparent[] is the supernodal etree, nsupers at a root.
+ * Collective over grid->comm; tdone[] is overwritten by the maximum
+ * over the processes.
+ * </pre>
+ */
+void pxgstrs_critpath(char uplo, int_t nsupers, int_t *sparent, double *tdone,
+		      gridinfo_t *grid, double *length, int_t *hops)
+{
+    int_t k, p, q, *last;
+
+    MPI_Allreduce(MPI_IN_PLACE, tdone, nsupers, MPI_DOUBLE, MPI_MAX,
+		  grid->comm);
+    *length = 0.0;
+    *hops = 0;
+    for (k = 0, p = -1; k < nsupers; ++k)
+	if ( tdone[k] >= 0.0 && (p < 0 || tdone[k] > tdone[p]) ) p = k;
+    if ( p < 0 ) return;
+    *length = tdone[p];
+
+    if ( uplo == 'L' ) {
+	if ( !(last = intMalloc_dist(nsupers)) )
+	    ABORT("Malloc fails for last[].");
+	for (k = 0; k < nsupers; ++k) last[k] = -1;
+	for (k = 0; k < nsupers; ++k) {
+	    q = sparent[k];
+	    if ( tdone[k] >= 0.0 && q < nsupers &&
+		 (last[q] < 0 || tdone[k] > tdone[last[q]]) ) last[q] = k;
+	}
+	for ( ; p >= 0; p = last[p]) ++*hops;
+	SUPERLU_FREE(last);
+    } else {
+	for ( ; p < nsupers && tdone[p] >= 0.0; p = sparent[p]) ++*hops;
+    }
+}
+
+/*! \brief The critical-path priorities of the supernodes in the
+ *         triangular solves, see options->Solve_Priority.
+ *
+ * <pre>
+ * prio[k] is the number of columns of the supernodes on the path from k
+ * to the root of the supernodal etree sparent[] (nsupers at a root), the
+ * work left after X[k] in the L-solve; prio[nsupers + k] is that of the
+ * longest path from k down to a leaf, the work left after X[k] in the
+ * U-solve. prio[] has 2 * nsupers entries.
+ * </pre>
+ */
+void pxgstrs_priority(int_t nsupers, int_t *sparent, int_t *xsup,
+		      int_t *prio)
+{
+    int_t k, p, *up = prio + nsupers;
+
+    for (k = nsupers - 1; k >= 0; --k) {
+	p = sparent[k];
+	prio[k] = xsup[k+1] - xsup[k] + (p < nsupers ? prio[p] : 0);
+    }
+    /* The children come before their parent. */
+    for (k = 0; k < nsupers; ++k) up[k] = 0;
+    for (k = 0; k < nsupers; ++k) {
+	up[k] += xsup[k+1] - xsup[k];
+	p = sparent[k];
+	if ( p < nsupers ) up[p] = SUPERLU_MAX(up[p], up[k]);
+    }
+}
+
+/*! \brief Sort the n supernodes sups[] by decreasing prio[], see
+ *         pxgstrs_priority(); the ties by increasing number.
+ */
+void pxgstrs_sort_prio(int_t n, int_t *sups, int_t *prio)
+{
+    int_t gap, i, j, k;
+
+    for (gap = n / 2; gap > 0; gap /= 2)
+	for (i = gap; i < n; ++i) {
+	    k = sups[i];
+	    for (j = i; j >= gap && (prio[sups[j-gap]] < prio[k]
+		 || (prio[sups[j-gap]] == prio[k] && sups[j-gap] > k)); j -= gap)
+		sups[j] = sups[j-gap];
+	    sups[j] = k;
+	}
+}
+
 void pxgstrs_finalize(pxgstrs_comm_t *gstrs_comm)
 {
+    if ( gstrs_comm->B_to_X_comm != MPI_COMM_NULL )
+	MPI_Comm_free(&gstrs_comm->B_to_X_comm);
+    if ( gstrs_comm->X_to_B_comm != MPI_COMM_NULL )
+	MPI_Comm_free(&gstrs_comm->X_to_B_comm);
+    if ( gstrs_comm->B_to_X_nbr ) SUPERLU_FREE(gstrs_comm->B_to_X_nbr);
+    if ( gstrs_comm->X_to_B_nbr ) SUPERLU_FREE(gstrs_comm->X_to_B_nbr);
+    if ( gstrs_comm->B_to_X_rowind ) SUPERLU_FREE(gstrs_comm->B_to_X_rowind);
+    if ( gstrs_comm->X_to_B_rowind ) SUPERLU_FREE(gstrs_comm->X_to_B_rowind);
+    if ( gstrs_comm->buf ) SUPERLU_FREE(gstrs_comm->buf);
     SUPERLU_FREE(gstrs_comm->B_to_X_SendCnt);
     SUPERLU_FREE(gstrs_comm->X_to_B_SendCnt);
     SUPERLU_FREE(gstrs_comm->ptr_to_ibuf);
     SUPERLU_FREE(gstrs_comm);
 }
 
+/*! \brief Start recording the rank lists of ntree trees, none yet.
+ */
+void superlu_treespec_init(superlu_treespec_t *spec, int ntree)
+{
+    int k;
+
+    spec->ntree = ntree;
+    spec->start = spec->cnt = spec->msgsize = spec->rank = NULL;
+    spec->seed = NULL;
+    spec->nrank = spec->maxrank = 0;
+    if ( ntree == 0 ) return;
+    if ( !(spec->start = SUPERLU_MALLOC(3 * ntree * sizeof(int))) )
+	ABORT("Malloc fails for spec->start[].");
+    spec->cnt = spec->start + ntree;
+    spec->msgsize = spec->cnt + ntree;
+    if ( !(spec->seed = SUPERLU_MALLOC(ntree * sizeof(double))) )
+	ABORT("Malloc fails for spec->seed[].");
+    for (k = 0; k < ntree; ++k) spec->cnt[k] = 0;
+}
+
+/*! \brief Record the arguments of BcTree_Create()/RdTree_Create() of tree k.
+ */
+void superlu_treespec_add(superlu_treespec_t *spec, int k, int *ranks,
+			  int rank_cnt, int msgsize, double seed)
+{
+    int i, *rank;
+
+    if ( spec->nrank + rank_cnt > spec->maxrank ) {
+	spec->maxrank = SUPERLU_MAX(2 * spec->maxrank, spec->nrank + rank_cnt);
+	if ( !(rank = SUPERLU_MALLOC(spec->maxrank * sizeof(int))) )
+	    ABORT("Malloc fails for spec->rank[].");
+	for (i = 0; i < spec->nrank; ++i) rank[i] = spec->rank[i];
+	if ( spec->rank ) SUPERLU_FREE(spec->rank);
+	spec->rank = rank;
+    }
+    spec->start[k] = spec->nrank;
+    spec->cnt[k] = rank_cnt;
+    spec->msgsize[k] = msgsize;
+    spec->seed[k] = seed;
+    for (i = 0; i < rank_cnt; ++i) spec->rank[spec->nrank++] = ranks[i];
+}
+
+void superlu_treespec_free(superlu_treespec_t *spec)
+{
+    if ( spec->start ) SUPERLU_FREE(spec->start);
+    if ( spec->seed ) SUPERLU_FREE(spec->seed);
+    if ( spec->rank ) SUPERLU_FREE(spec->rank);
+    superlu_treespec_init(spec, 0);
+}
+
+/*! \brief Encode the n entries of index[] into buf[].
+ *
+ * <pre>
+ * Each entry is stored as the difference to the previous one (the first
+ * to 0), zigzag mapped to an unsigned number and written 7 bits per byte,
+ * the high bit of a byte being set if more bytes follow. The rows of an
+ * L block and the first nonzeros of a U block are close to each other,
+ * so most entries take one byte. buf[] must hold SUPERLU_PACK_MAX(n)
+ * bytes; returns the number of bytes written.
+ * </pre>
+ */
+int superlu_pack_index(int_t n, int_t *index, unsigned char *buf)
+{
+    int_t i;
+    uint64_t d, prev = 0;
+    int nb = 0;
+
+    for (i = 0; i < n; ++i) {
+	d = (uint64_t) (int64_t) index[i] - prev;   /* modulo 2^64 */
+	prev = (uint64_t) (int64_t) index[i];
+	d = (d << 1) ^ (uint64_t) -(int64_t) (d >> 63);  /* zigzag */
+	while ( d >= 0x80 ) {
+	    buf[nb++] = (unsigned char) (d | 0x80);
+	    d >>= 7;
+	}
+	buf[nb++] = (unsigned char) d;
+    }
+    return nb;
+}
+
+/*! \brief Decode the nb bytes of buf[] written by superlu_pack_index()
+ * into index[]; returns the number of entries.
+ */
+int_t superlu_unpack_index(int nb, unsigned char *buf, int_t *index)
+{
+    int_t n = 0;
+    uint64_t d, prev = 0;
+    int i = 0, shift;
+
+    while ( i < nb ) {
+	for (d = 0, shift = 0; buf[i] & 0x80; shift += 7)
+	    d |= (uint64_t) (buf[i++] & 0x7f) << shift;
+	d |= (uint64_t) buf[i++] << shift;
+	d = (d >> 1) ^ (uint64_t) -(int64_t) (d & 1);
+	prev += d;
+	index[n++] = (int_t) (int64_t) prev;
+    }
+    return n;
+}
+
 
 /*! \brief Diagnostic print of segment info after panel_dfs().
  */
@@ -479,6 +1629,22 @@ PStatInit(SuperLUStat_t *stat)
     stat->TinyPivots = stat->RefineSteps = 0;
     stat->current_buffer = stat->peak_buffer = 0.0;
     stat->gpu_buffer = 0.0;
+    for (i = 0; i < NSOL_TREES; ++i) {
+	stat->sol_msgs[i] = 0;
+	stat->sol_bytes[i] = 0.;
+    }
+    stat->sol_packets = 0;
+    stat->sol_critpath[0] = stat->sol_critpath[1] = 0.;
+    stat->sol_crithops[0] = stat->sol_crithops[1] = 0;
+    stat->fact_sent = stat->fact_recv = stat->fact_wait = 0.;
+    stat->fact_size = 0.;
+    stat->fact_dropped = 0.;
+    stat->RCond = 0.;
+    memset(stat->hwc, 0, sizeof(stat->hwc));
+    superlu_histo_init(stat);
+    stat->sn_cost = NULL;
+    stat->sn_nsupers = 0;
+    stat->trace = NULL;
 }
 
 void
@@ -516,6 +1682,12 @@ PStatPrint(superlu_dist_options_t *options, SuperLUStat_t *stat, gridinfo_t *gri
 		   flopcnt,
 		   flopcnt*1e-6/utime[FACT]);
     }
+    if ( options->Fact != FACTORED && options->ILU_DropTol > 0.0 ) {
+	double dropped;
+	MPI_Reduce(&stat->fact_dropped, &dropped, 1, MPI_DOUBLE, MPI_SUM,
+		   0, grid->comm);
+	if ( !iam ) printf("\tILU dropped entries %e\n", dropped);
+    }
 	
     MPI_Reduce(&ops[SOLVE], &flopcnt, 1, MPI_FLOAT, MPI_SUM, 
 	       0, grid->comm);
@@ -530,9 +1702,62 @@ PStatPrint(superlu_dist_options_t *options, SuperLUStat_t *stat, gridinfo_t *gri
 	    printf("\tREFINEMENT time    %8.3f\tSteps%8d\n\n",
 		   utime[REFINE], stat->RefineSteps);
 	}
-	printf("**************************************************\n");
+	if ( options->ConditionNumber == YES )
+	    printf("\tRCOND time         %8.3f\tRCond %10.3e\n",
+		   utime[RCOND], stat->RCond);
+    }
+
+    /* The last triangular solve: messages of each tree, and the time
+       blocked in MPI_Recv() out of the solve time. */
+    {
+	static const char *tree_name[NSOL_TREES] = {
+	    "L bcast ", "L reduce", "U bcast ", "U reduce"
+	};
+	long long msgs[NSOL_TREES], pkts;
+	double bytes[NSOL_TREES], wait[2], tot[2];
+	int i, P = grid->nprow * grid->npcol;
+
+	MPI_Reduce(stat->sol_msgs, msgs, NSOL_TREES, MPI_LONG_LONG, MPI_SUM,
+		   0, grid->comm);
+	MPI_Reduce(stat->sol_bytes, bytes, NSOL_TREES, MPI_DOUBLE, MPI_SUM,
+		   0, grid->comm);
+	MPI_Reduce(&stat->sol_packets, &pkts, 1, MPI_LONG_LONG, MPI_SUM,
+		   0, grid->comm);
+	MPI_Reduce(&utime[SOL_COMM], &wait[0], 1, MPI_DOUBLE, MPI_SUM,
+		   0, grid->comm);
+	MPI_Reduce(&utime[SOL_COMM], &wait[1], 1, MPI_DOUBLE, MPI_MAX,
+		   0, grid->comm);
+	MPI_Reduce(&utime[SOL_TOT], &tot[0], 1, MPI_DOUBLE, MPI_SUM,
+		   0, grid->comm);
+	MPI_Reduce(&utime[SOL_TOT], &tot[1], 1, MPI_DOUBLE, MPI_MAX,
+		   0, grid->comm);
+	if ( !iam && tot[1] > 0.0 ) {
+	    printf("\tLast solve time    %8.3f\n", tot[1]);
+	    printf("\t  blocked in recv  %8.3f avg %8.3f max\n",
+		   wait[0] / P, wait[1]);
+	    printf("\t  computing        %8.3f avg\n", (tot[0] - wait[0]) / P);
+	    for (i = 0; i < NSOL_TREES; ++i)
+		if ( msgs[i] )
+		    printf("\t  %s msgs %10lld  MB %10.3f  avg bytes %8.0f\n",
+			   tree_name[i], msgs[i], bytes[i] * 1e-6,
+			   bytes[i] / msgs[i]);
+	    if ( pkts )
+		printf("\t  packets       %10lld  (aggregated msgs)\n", pkts);
+	    if ( stat->sol_crithops[0] || stat->sol_crithops[1] )
+		printf("\t  critical path    L %8.3f (" IFMT " supernodes)"
+		       "  U %8.3f (" IFMT " supernodes)\n",
+		       stat->sol_critpath[0], stat->sol_crithops[0],
+		       stat->sol_critpath[1], stat->sol_crithops[1]);
+	}
     }
 
+    /* Bytes allocated by category, with SUPERLU_MEM_TRACK set, and the
+       hardware counters, with SUPERLU_HWC set. */
+    superlu_mem_print(grid);
+    superlu_hwc_print(stat, grid);
+    superlu_histo_print(stat, grid);
+    if ( !iam ) printf("**************************************************\n");
+
 	double  *utime1,*utime2,*utime3,*utime4;
 	flops_t  *ops1;
 #if ( PROFlevel>=1 )
@@ -641,11 +1866,196 @@ PStatPrint(superlu_dist_options_t *options, SuperLUStat_t *stat, gridinfo_t *gri
 /*  if ( !iam ) fflush(stdout);  CRASH THE SYSTEM pierre.  */
 }
 
+/*! \brief Print the balance of the last numerical factorization over the
+ *  grid.
+ *
+ * <pre>
+ * For the flops, the bytes of the L and U panels sent and received, the
+ * time waiting for the panels and the size of the local factors, prints
+ * the minimum, average and maximum over the processes, the ratio of the
+ * maximum to the average, and the grid coordinates of the process with
+ * the maximum. With options->Fact_Comm = SLU_COMM_RMA, the bytes are only
+ * counted by the receivers. Collective over grid->comm.
+ * </pre>
+ */
+void
+PStatImbalance(SuperLUStat_t *stat, gridinfo_t *grid)
+{
+    static const char *name[5] = {
+	"flops       ", "MB sent     ", "MB received ", "wait (sec)  ",
+	"factors (MB)"
+    };
+    static const double scale[5] = { 1.0, 1e-6, 1e-6, 1.0, 1e-6 };
+    struct { double val; int rank; } loc[5], mx[5];
+    double v[5], mn[5], sum[5];
+    int i, P = grid->nprow * grid->npcol;
+
+    v[0] = stat->ops[FACT];
+    v[1] = stat->fact_sent;
+    v[2] = stat->fact_recv;
+    v[3] = stat->fact_wait;
+    v[4] = stat->fact_size;
+    for (i = 0; i < 5; ++i) {
+	loc[i].val = v[i];
+	loc[i].rank = grid->iam;
+    }
+    MPI_Reduce(v, mn, 5, MPI_DOUBLE, MPI_MIN, 0, grid->comm);
+    MPI_Reduce(v, sum, 5, MPI_DOUBLE, MPI_SUM, 0, grid->comm);
+    MPI_Reduce(loc, mx, 5, MPI_DOUBLE_INT, MPI_MAXLOC, 0, grid->comm);
+    if ( grid->iam ) return;
+
+    printf("\tFactor balance          min         avg         max"
+	   "   max/avg  (row,col) of max\n");
+    for (i = 0; i < 5; ++i)
+	printf("\t  %s  %10.3e  %10.3e  %10.3e  %8.2f  (%d,%d)\n",
+	       name[i], mn[i] * scale[i], sum[i] / P * scale[i],
+	       mx[i].val * scale[i],
+	       sum[i] > 0.0 ? mx[i].val * P / sum[i] : 1.0,
+	       (int) MYROW( mx[i].rank, grid ), (int) MYCOL( mx[i].rank, grid ));
+}
+
+#define NSTAT_FIELDS (2 * NPHASES + 9 + 2 * NSOL_TREES + 2 * SUPERLU_MEM_NCATS)
+
+/* The fields of s reduced by PStatQuery(), with their names and, if stat
+   is not NULL, their local values. Returns their number. */
+static int
+PStatFields(SuperLUStat_t *stat, superlu_stat_summary_t *s,
+	    superlu_range_t **r, const char **name, double *v)
+{
+    static const char *phase[NPHASES] = {
+	"COLPERM", "ROWPERM", "RELAX", "ETREE", "EQUIL", "SYMBFAC", "DIST",
+	"FACT", "COMM", "COMM_DIAG", "COMM_RIGHT", "COMM_DOWN", "SOL_COMM",
+	"SOL_GEMM", "SOL_TRSM", "SOL_TOT", "RCOND", "SOLVE", "REFINE", "TRSV",
+	"GEMV", "FERR"
+    };
+    static const char *tree[NSOL_TREES] = {
+	"L_bcast", "L_reduce", "U_bcast", "U_reduce"
+    };
+    static const char *cat[SUPERLU_MEM_NCATS] = {
+	"other", "symbolic", "factors", "trees", "solve", "redist"
+    };
+    static char buf[NSTAT_FIELDS][32];
+    double mem[2 * SUPERLU_MEM_NCATS];
+    int i, nf = 0;
+
+#define STAT_FIELD(fld, nm, val) \
+    { r[nf] = &s->fld; name[nf] = nm; if ( stat ) v[nf] = (val); ++nf; }
+
+    if ( stat ) superlu_mem_query(mem, mem + SUPERLU_MEM_NCATS);
+    for (i = 0; i < NPHASES; ++i) {
+	sprintf(buf[nf], "utime_%s", phase[i]);
+	STAT_FIELD(utime[i], buf[nf], stat->utime[i]);
+    }
+    for (i = 0; i < NPHASES; ++i) {
+	sprintf(buf[nf], "ops_%s", phase[i]);
+	STAT_FIELD(ops[i], buf[nf], stat->ops[i]);
+    }
+    STAT_FIELD(TinyPivots, "TinyPivots", stat->TinyPivots);
+    STAT_FIELD(peak_buffer, "peak_buffer", stat->peak_buffer);
+    STAT_FIELD(gpu_buffer, "gpu_buffer", stat->gpu_buffer);
+    STAT_FIELD(fact_sent, "fact_sent", stat->fact_sent);
+    STAT_FIELD(fact_recv, "fact_recv", stat->fact_recv);
+    STAT_FIELD(fact_wait, "fact_wait", stat->fact_wait);
+    STAT_FIELD(fact_size, "fact_size", stat->fact_size);
+    STAT_FIELD(fact_dropped, "fact_dropped", stat->fact_dropped);
+    for (i = 0; i < NSOL_TREES; ++i) {
+	sprintf(buf[nf], "sol_msgs_%s", tree[i]);
+	STAT_FIELD(sol_msgs[i], buf[nf], stat->sol_msgs[i]);
+    }
+    for (i = 0; i < NSOL_TREES; ++i) {
+	sprintf(buf[nf], "sol_bytes_%s", tree[i]);
+	STAT_FIELD(sol_bytes[i], buf[nf], stat->sol_bytes[i]);
+    }
+    STAT_FIELD(sol_packets, "sol_packets", stat->sol_packets);
+    for (i = 0; i < SUPERLU_MEM_NCATS; ++i) {
+	sprintf(buf[nf], "mem_cur_%s", cat[i]);
+	STAT_FIELD(mem_cur[i], buf[nf], mem[i]);
+    }
+    for (i = 0; i < SUPERLU_MEM_NCATS; ++i) {
+	sprintf(buf[nf], "mem_peak_%s", cat[i]);
+	STAT_FIELD(mem_peak[i], buf[nf], mem[SUPERLU_MEM_NCATS + i]);
+    }
+#undef STAT_FIELD
+    return nf;
+}
+
+/*! \brief Reduce the statistics of stat over the grid into s.
+ *
+ * <pre>
+ * Each counter of stat, and the current and peak bytes of each memory
+ * category (with SUPERLU_MEM_TRACK set, see superlu_mem_query()), is
+ * returned as its minimum, average and maximum over the processes, for
+ * the programs that tune the grid shape or the number of threads from
+ * these figures instead of parsing the output of PStatPrint(); see
+ * PStatPrintJSON() to write them out. Collective over grid->comm; s is
+ * set on all the processes.
+ * </pre>
+ */
+void
+PStatQuery(SuperLUStat_t *stat, gridinfo_t *grid, superlu_stat_summary_t *s)
+{
+    superlu_range_t *r[NSTAT_FIELDS];
+    const char *name[NSTAT_FIELDS];
+    double v[NSTAT_FIELDS], mn[NSTAT_FIELDS], mx[NSTAT_FIELDS],
+	   sum[NSTAT_FIELDS];
+    int i, nf, P = grid->nprow * grid->npcol;
+
+    nf = PStatFields(stat, s, r, name, v);
+    MPI_Allreduce(v, mn, nf, MPI_DOUBLE, MPI_MIN, grid->comm);
+    MPI_Allreduce(v, mx, nf, MPI_DOUBLE, MPI_MAX, grid->comm);
+    MPI_Allreduce(v, sum, nf, MPI_DOUBLE, MPI_SUM, grid->comm);
+    for (i = 0; i < nf; ++i) {
+	r[i]->min = mn[i];
+	r[i]->avg = sum[i] / P;
+	r[i]->max = mx[i];
+    }
+    s->nprocs = P;
+    s->mem_tracked = superlu_mem_tracked();
+    s->RefineSteps = stat->RefineSteps;
+    s->RCond = stat->RCond;
+    for (i = 0; i < 2; ++i) {
+	s->sol_critpath[i] = stat->sol_critpath[i];
+	s->sol_crithops[i] = stat->sol_crithops[i];
+    }
+}
+
+/*! \brief Write the statistics s of PStatQuery() to fp as a JSON object.
+ *
+ * <pre>
+ * Each reduced counter is written as "name": [min, avg, max]; the memory
+ * categories only if they are tracked.
+ * </pre>
+ */
+void
+PStatPrintJSON(FILE *fp, superlu_stat_summary_t *s)
+{
+    superlu_range_t *r[NSTAT_FIELDS];
+    const char *name[NSTAT_FIELDS];
+    int i, nf;
+
+    nf = PStatFields(NULL, s, r, name, NULL);
+    fprintf(fp, "{\n  \"nprocs\": %d,\n", s->nprocs);
+    for (i = 0; i < nf; ++i) {
+	if ( !s->mem_tracked && !strncmp(name[i], "mem_", 4) ) continue;
+	fprintf(fp, "  \"%s\": [%.6e, %.6e, %.6e],\n", name[i],
+		r[i]->min, r[i]->avg, r[i]->max);
+    }
+    fprintf(fp, "  \"RefineSteps\": %d,\n  \"RCond\": %.6e,\n",
+	    s->RefineSteps, s->RCond);
+    fprintf(fp, "  \"sol_critpath\": [%.6e, %.6e],\n",
+	    s->sol_critpath[0], s->sol_critpath[1]);
+    fprintf(fp, "  \"sol_crithops\": [%lld, %lld]\n}\n",
+	    (long long) s->sol_crithops[0], (long long) s->sol_crithops[1]);
+}
+
 void
 PStatFree(SuperLUStat_t *stat)
 {
     SUPERLU_FREE(stat->utime);
     SUPERLU_FREE(stat->ops);
+    superlu_histo_free(stat);
+    superlu_sncost_free(stat);
+    superlu_trace_free(stat);
 }
 
 /*! \brief Fills an integer array with a given value.
@@ -694,15 +2104,77 @@ get_diag_procs(int_t n, Glu_persist_t *Glu_persist, gridinfo_t *grid,
 }
 
 
+/*! \brief Mark the supernodes whose factors change with some columns of A.
+ *
+ * <pre>
+ * A is the distributed matrix of the last factorization, whose entry j
+ * is in column Acolind[j] of Pc*A*Pc^T and in row perm_c[perm_r[i]] for
+ * global row i. The ncols columns cols[] of A, in the numbering of A on
+ * entry to pdgssvx(), have new values. On exit, dirty[s] = 1 for the
+ * supernodes s whose L(:,s) and U(s,:) may change, the same on all the
+ * processes, else 0; returns their number. Collective over grid->comm.
+ *
+ * An entry in rows of supernode I and columns of supernode J goes to the
+ * panel of min(I,J), and only changes the panels of it and its ancestors:
+ * those in the etree of the structure of Pc*(A+A')*Pc^T when the symbolic
+ * factorization used it (ParSymbFact = NO and ColPerm != MMD_ATA), else
+ * all the supernodes after it. The supernodes from nfact on (root or
+ * Schur complement, see pdgstrf()) are always dirty. Either way, if a
+ * block L(i,k)*U(k,j) updates a dirty panel, blocks i and j are dirty.
+ * </pre>
+ */
+int_t
+superlu_dirty_supernodes(superlu_dist_options_t *options, SuperMatrix *A,
+			 int_t *Acolind, int_t *perm_r, int_t *perm_c,
+			 Glu_persist_t *Glu_persist, int_t *etree,
+			 int_t nfact, int_t ncols, int_t *cols, char *dirty,
+			 gridinfo_t *grid)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t n = A->ncol, *supno = Glu_persist->supno, *xsup = Glu_persist->xsup;
+    int_t nsupers = supno[n-1] + 1, i, j, s, t, irow, ndirty = 0;
+    char  *changed;
+
+    if ( !(changed = SUPERLU_MALLOC(n)) )
+	ABORT("Malloc fails for changed[].");
+    memset(changed, 0, n);
+    memset(dirty, 0, nsupers);
+    for (j = 0; j < ncols; ++j)
+	if ( cols[j] >= 0 && cols[j] < n ) changed[perm_c[cols[j]]] = 1;
+
+    irow = Astore->fst_row;
+    for (i = 0; i < Astore->m_loc; ++i, ++irow) {
+	s = supno[perm_c[perm_r[irow]]];
+	for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j)
+	    if ( changed[Acolind[j]] )
+		dirty[SUPERLU_MIN(s, supno[Acolind[j]])] = 1;
+    }
+    SUPERLU_FREE(changed);
+    MPI_Allreduce(MPI_IN_PLACE, dirty, nsupers, MPI_BYTE, MPI_BOR, grid->comm);
+
+    if ( etree && options->ParSymbFact == NO && options->ColPerm != MMD_ATA ) {
+	for (s = 0; s < nsupers; ++s)
+	    if ( dirty[s] )
+		for (j = xsup[s]; j < xsup[s+1]; ++j)
+		    if ( etree[j] < n ) dirty[supno[etree[j]]] = 1;
+    } else {
+	for (s = 0; s < nsupers && !dirty[s]; ++s) ;
+	for (t = s; t < nsupers; ++t) dirty[t] = 1;
+    }
+    for (s = SUPERLU_MAX(nfact, 0); s < nsupers; ++s) dirty[s] = 1;
+    for (s = 0; s < nsupers; ++s) ndirty += dirty[s];
+    return ndirty;
+}
+
+
 /*! \brief Get the statistics of the supernodes 
  */
 #define NBUCKS 10
-static 	int_t	max_sup_size;
 
 void super_stats_dist(int_t nsuper, int_t *xsup)
 {
     register int_t nsup1 = 0;
-    int_t          i, isize, whichb, bl, bh;
+    int_t          i, isize, whichb, bl, bh, max_sup_size;
     int_t          bucket[NBUCKS];
 
     max_sup_size = 0;
@@ -826,13 +2298,159 @@ CheckZeroDiagonal(int_t n, int_t *rowind, int_t *colbeg, int_t *colcnt)
 
 
 /* --------------------------------------------------------------------------- */
+#define SORT_RADIX_MIN 256    /* shorter arrays: shell sort */
+#define SORT_PAR_MIN   65536  /* shorter arrays: radix sort on one thread */
+
+/* Shell sort of key[0:n-1] in increasing order, with val[] if not NULL. */
+static void
+shell_sort(int_t n, int_t *key, int_t *val)
+{
+    int_t gap, i, j, t;
+
+    for (gap = n / 2; gap > 0; gap /= 2)
+	for (i = gap; i < n; ++i)
+	    for (j = i - gap; j >= 0 && key[j] > key[j + gap]; j -= gap) {
+		t = key[j]; key[j] = key[j + gap]; key[j + gap] = t;
+		if ( val ) { t = val[j]; val[j] = val[j + gap]; val[j + gap] = t; }
+	    }
+}
+
+/*! \brief Sort key[0:n-1] in increasing order, and val[] the same way if
+ *         it is not NULL.
+ *
+ * <pre>
+ * Arrays of at least SORT_RADIX_MIN entries are sorted by a stable LSD
+ * radix sort on bytes of key - min(key), with only as many passes as the
+ * range of the keys has bytes; from SORT_PAR_MIN entries on, outside of a
+ * parallel region, the counts and the scatter of each pass are shared
+ * among the OpenMP threads by contiguous chunks. Shorter arrays are
+ * sorted in place by a shell sort, as isort() always did.
+ * </pre>
+ */
+void
+superlu_sort_int(int_t n, int_t *key, int_t *val)
+{
+    int_t *tkey, *tval = NULL, *src, *dst, *srcv, *dstv, *cnt, *p;
+    int_t kmin, kmax, i;
+    unsigned long long range;
+    int nthreads = 1, npass, pass;
+
+    if ( n < SORT_RADIX_MIN ) {
+	shell_sort(n, key, val);
+	return;
+    }
+    kmin = kmax = key[0];
+    for (i = 1; i < n; ++i) {
+	kmin = SUPERLU_MIN(kmin, key[i]);
+	kmax = SUPERLU_MAX(kmax, key[i]);
+    }
+    range = (unsigned long long) kmax - (unsigned long long) kmin;
+    for (npass = 0; range; range >>= 8) ++npass;
+    if ( npass == 0 ) return;
+
+#ifdef _OPENMP
+    if ( n >= SORT_PAR_MIN && !omp_in_parallel() )
+	nthreads = omp_get_max_threads();
+#endif
+    if ( !(tkey = intMalloc_dist(n)) ) ABORT("Malloc fails for tkey[].");
+    if ( val && !(tval = intMalloc_dist(n)) ) ABORT("Malloc fails for tval[].");
+    if ( !(cnt = intMalloc_dist(256 * nthreads)) ) ABORT("Malloc fails for cnt[].");
+    src = key; srcv = val;
+    dst = tkey; dstv = tval;
+
+    for (pass = 0; pass < npass; ++pass) {
+	int shift = 8 * pass;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads) private(i)
+#endif
+	{
+	    int t = 0, nt = 1, d;
+	    int_t lo, hi, j, off, c, *mycnt;
+#ifdef _OPENMP
+	    t = omp_get_thread_num();
+	    nt = omp_get_num_threads();
+#endif
+	    lo = n * t / nt;
+	    hi = n * (t + 1) / nt;
+	    mycnt = &cnt[256 * t];
+	    for (d = 0; d < 256; ++d) mycnt[d] = 0;
+#define SORT_DIGIT(k) \
+	((int) ((((unsigned long long) (k) - (unsigned long long) kmin) >> shift) & 255))
+	    for (i = lo; i < hi; ++i) ++mycnt[SORT_DIGIT(src[i])];
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp single
+#endif
+	    { /* Offsets by digit, then by thread. */
+		for (off = 0, d = 0; d < 256; ++d)
+		    for (j = 0; j < nt; ++j) {
+			c = cnt[256 * j + d];
+			cnt[256 * j + d] = off;
+			off += c;
+		    }
+	    }
+	    for (i = lo; i < hi; ++i) {
+		j = mycnt[SORT_DIGIT(src[i])]++;
+		dst[j] = src[i];
+		if ( val ) dstv[j] = srcv[i];
+	    }
+#undef SORT_DIGIT
+	}
+	p = src; src = dst; dst = p;
+	p = srcv; srcv = dstv; dstv = p;
+    }
+
+    if ( src != key ) {
+	memcpy(key, src, n * sizeof(int_t));
+	if ( val ) memcpy(val, srcv, n * sizeof(int_t));
+    }
+    SUPERLU_FREE(tkey);
+    if ( tval ) SUPERLU_FREE(tval);
+    SUPERLU_FREE(cnt);
+}
+
+/*! \brief Sort the n pairs (pairs[2*i], pairs[2*i+1]) by increasing
+ *         pairs[2*i], see superlu_sort_int().
+ */
+void
+superlu_sort_pairs(int_t n, int_t *pairs)
+{
+    int_t *key, i;
+
+    if ( n < SORT_RADIX_MIN ) { /* Insertion sort. */
+	int_t j, k, v;
+	for (i = 1; i < n; ++i) {
+	    k = pairs[2 * i];
+	    v = pairs[2 * i + 1];
+	    for (j = i; j > 0 && pairs[2 * (j-1)] > k; --j) {
+		pairs[2 * j] = pairs[2 * (j-1)];
+		pairs[2 * j + 1] = pairs[2 * (j-1) + 1];
+	    }
+	    pairs[2 * j] = k;
+	    pairs[2 * j + 1] = v;
+	}
+	return;
+    }
+    if ( !(key = intMalloc_dist(2 * n)) ) ABORT("Malloc fails for key[].");
+    for (i = 0; i < n; ++i) {
+	key[i] = pairs[2 * i];
+	key[n + i] = pairs[2 * i + 1];
+    }
+    superlu_sort_int(n, key, key + n);
+    for (i = 0; i < n; ++i) {
+	pairs[2 * i] = key[i];
+	pairs[2 * i + 1] = key[n + i];
+    }
+    SUPERLU_FREE(key);
+}
+
 void isort(int_t N, int_t *ARRAY1, int_t *ARRAY2)
 {
 /*
  * Purpose
  * =======
- * Use quick sort algorithm to sort ARRAY1 and ARRAY2 in the increasing
- * order of ARRAY1.
+ * Sort ARRAY1 and ARRAY2 in the increasing order of ARRAY1, see
+ * superlu_sort_int().
  *
  * Arguments
  * =========
@@ -847,28 +2465,7 @@ void isort(int_t N, int_t *ARRAY1, int_t *ARRAY2)
  *          On entry, contains the array to be sorted.
  *          On exit, contains the sorted array.
  */
-  int_t IGAP, I, J;
-  int_t TEMP;
-  IGAP = N / 2;
-  while (IGAP > 0) {
-      for (I = IGAP; I < N; I++) {
-	  J = I - IGAP;
-	  while (J >= 0) {
-	      if (ARRAY1[J] > ARRAY1[J + IGAP]) {
-		  TEMP = ARRAY1[J];
-		  ARRAY1[J] = ARRAY1[J + IGAP];
-		  ARRAY1[J + IGAP] = TEMP;
-		  TEMP = ARRAY2[J];  
-		  ARRAY2[J] = ARRAY2[J + IGAP];
-		  ARRAY2[J + IGAP] = TEMP;
-		  J = J - IGAP;
-	      } else {
-		  break;
-	      }
-	  }
-      }
-      IGAP = IGAP / 2;
-  }
+    superlu_sort_int(N, ARRAY1, ARRAY2);
 }
 
 
@@ -877,37 +2474,19 @@ void isort1(int_t N, int_t *ARRAY)
 /*
  * Purpose
  * =======
- * Use quick sort algorithm to sort ARRAY in increasing order.
+ * Sort ARRAY in increasing order, see superlu_sort_int().
  *
  * Arguments
  * =========
  * N       (input) INTEGER
  *          On entry, specifies the size of the arrays.
  *
- * ARRAY   (input/output) DOUBLE PRECISION ARRAY of LENGTH N
+ * ARRAY   (input/output) integer array of length N
  *          On entry, contains the array to be sorted.
  *          On exit, contains the sorted array.
  *
  */
-  int_t IGAP, I, J;
-  int_t TEMP;
-  IGAP = N / 2;
-  while (IGAP > 0) {
-      for (I = IGAP; I < N; I++) {
-	  J = I - IGAP;
-	  while (J >= 0) {
-	      if (ARRAY[J] > ARRAY[J + IGAP]) {
-		  TEMP = ARRAY[J];
-		  ARRAY[J] = ARRAY[J + IGAP];
-		  ARRAY[J + IGAP] = TEMP;
-		  J = J - IGAP;
-	      } else {
-		  break;
-	      }
-	  }
-      }
-      IGAP = IGAP / 2;
-  }
+    superlu_sort_int(N, ARRAY, NULL);
 }
 
 /* Only log the memory for the buffer space, excluding the LU factors */
@@ -1165,10 +2744,29 @@ int_t estimate_bigu_size(
     return(max_ldu * (*max_ncols));
 }
 
+/* Reverse a[l:r], and its dims rows of leading dimension lda. */
+static void
+reverse_rows(int_t *a, int_t l, int_t r, int_t lda, int_t dims)
+{
+    int_t i, j, dd, t;
+
+    for (i = l, j = r; i < j; ++i, --j)
+	for (dd = 0; dd < dims; ++dd) {
+	    t = a[i + lda*dd]; a[i + lda*dd] = a[j + lda*dd]; a[j + lda*dd] = t;
+	}
+}
+
 void quickSort( int_t* a, int_t l, int_t r, int_t dir)
 {
    int_t j;
 
+   /* Long ranges: radix sort, see superlu_sort_int(). */
+   if ( r - l + 1 >= SORT_RADIX_MIN ) {
+       superlu_sort_int(r - l + 1, &a[l], NULL);
+       if ( dir == 1 ) reverse_rows(a, l, r, 0, 1);
+       return;
+   }
+
    if( l < r ) 
    {
    	// divide and conquer
@@ -1213,6 +2811,27 @@ void quickSortM( int_t* a, int_t l, int_t r, int_t lda, int_t dir, int_t dims)
 {
    int_t j;
 
+   /* Long ranges: radix sort of the first row with the positions, then
+      the other rows are permuted the same way. */
+   if ( r - l + 1 >= SORT_RADIX_MIN ) {
+       int_t n = r - l + 1, *key, *pos, i, dd;
+       if ( !(key = intMalloc_dist(3 * n)) ) ABORT("Malloc fails for key[].");
+       pos = key + n;
+       for (i = 0; i < n; ++i) {
+	   key[i] = a[l + i];
+	   pos[i] = l + i;
+       }
+       superlu_sort_int(n, key, pos);
+       for (i = 0; i < n; ++i) a[l + i] = key[i];
+       for (dd = 1; dd < dims; ++dd) {
+	   for (i = 0; i < n; ++i) key[n + n + i] = a[pos[i] + lda*dd];
+	   for (i = 0; i < n; ++i) a[l + i + lda*dd] = key[n + n + i];
+       }
+       if ( dir == 1 ) reverse_rows(a, l, r, lda, dims);
+       SUPERLU_FREE(key);
+       return;
+   }
+
    if( l < r ) 
    {
 	   	// printf("dims: %5d",dims);
@@ -81,11 +81,14 @@ typedef unsigned char Logical;
 */
 
 typedef struct {
-    int     *panel_histo; /* histogram of panel size distribution */
+    int     *panel_histo; /* histogram of panel size distribution, with
+			     SUPERLU_GEMM_HISTO set (see superlu_histo.c) */
     double  *utime;       /* running time at various phases */
     flops_t *ops;         /* operation count at various phases */
     int     TinyPivots;   /* number of tiny pivots */
     int     RefineSteps;  /* number of iterative refinement steps */
+    double  RCond;        /* estimate of the reciprocal condition number,
+			     see options->ConditionNumber */
     int     num_look_aheads; /* number of look ahead */
     /*-- new --*/
     float   current_buffer; /* bytes allocated for buffer in numerical factorization */
@@ -93,8 +96,61 @@ typedef struct {
     float   gpu_buffer;     /* monitor the buffer allocated on GPU (bytes) */
     int_t MaxActiveBTrees;
     int_t MaxActiveRTrees;	
+    /*-- last triangular solve, with utime[SOL_COMM] and utime[SOL_TOT] --*/
+    long long sol_msgs[NSOL_TREES];  /* messages received in each tree */
+    double    sol_bytes[NSOL_TREES]; /* bytes received in each tree */
+    long long sol_packets; /* packets of aggregated messages received */
+    double    sol_critpath[2]; /* critical path of the L- and U-solve
+				  (seconds), see options->Solve_CritPath */
+    int_t     sol_crithops[2]; /* number of supernodes on these paths */
+    /*-- last numerical factorization, see PStatImbalance() --*/
+    double    fact_sent;  /* bytes of the L and U panels sent */
+    double    fact_recv;  /* bytes of the L and U panels received */
+    double    fact_wait;  /* seconds waiting for the L and U panels */
+    double    fact_size;  /* bytes of the local blocks of L and U */
+    double    fact_dropped; /* entries of L and U dropped, see
+			       options->ILU_DropTol */
+    /*-- hardware counters with SUPERLU_HWC set, see superlu_hwc.c --*/
+    double    hwc[NHWC_PHASES][NHWC_EVENTS];  /* summed over the calls */
+    double    hwc0[NHWC_PHASES][NHWC_EVENTS]; /* at the start of a call */
+    /*-- with SUPERLU_GEMM_HISTO set, see superlu_histo.c --*/
+    double    *gemm_histo; /* calls, flops, seconds of the Schur GEMMs
+			      by bucket of m, n and k */
+    /*-- cost of each supernode, see superlu_sncost.c --*/
+    double    *sn_cost;    /* 3 per supernode; NULL if not recorded */
+    int_t     sn_nsupers;  /* number of supernodes of sn_cost[] */
+    double    sn_mark[2];  /* flops charged, fact_sent at the last charge */
+    /*-- with SUPERLU_TRACE set, see superlu_trace.c --*/
+    struct superlu_trace_t *trace; /* events of the factorization; NULL
+				      if not tracing */
 } SuperLUStat_t;
 
+typedef struct {
+    double min, avg, max; /* over the processes of the grid */
+} superlu_range_t;
+
+/*-- SuperLUStat_t reduced over the grid, see PStatQuery() --*/
+typedef struct {
+    int       nprocs;
+    superlu_range_t utime[NPHASES]; /* seconds */
+    superlu_range_t ops[NPHASES];   /* flops */
+    superlu_range_t TinyPivots;
+    superlu_range_t peak_buffer;    /* bytes, see log_memory() */
+    superlu_range_t gpu_buffer;     /* bytes */
+    superlu_range_t fact_sent, fact_recv, fact_wait, fact_size, fact_dropped;
+    superlu_range_t sol_msgs[NSOL_TREES], sol_bytes[NSOL_TREES];
+    superlu_range_t sol_packets;
+    int       mem_tracked; /* mem_cur[] and mem_peak[] are only counted with
+			      SUPERLU_MEM_TRACK set, see superlu_mem_query() */
+    superlu_range_t mem_cur[SUPERLU_MEM_NCATS];  /* bytes */
+    superlu_range_t mem_peak[SUPERLU_MEM_NCATS]; /* bytes */
+    /*-- the same on all the processes --*/
+    int       RefineSteps;
+    double    RCond;
+    double    sol_critpath[2];
+    int_t     sol_crithops[2];
+} superlu_stat_summary_t;
+
 /* Headers for 2 types of dynamatically managed memory */
 typedef struct e_node {
     int size;      /* length of the memory that has been used */
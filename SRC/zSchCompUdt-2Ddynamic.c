@@ -562,6 +562,10 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	assert( Rnbrow*ncols < bigv_size ); */
 #endif
 	/* calling aggregated large GEMM, result stored in bigV[]. */
+	if ( options->Complex_3M != YES
+	     || !zgemm_3m(gemm_m_pad, gemm_n_pad, gemm_k_pad,
+			  &Remain_L_buff[0], gemm_m_pad, &bigU[0], gemm_k_pad,
+			  bigV, gemm_m_pad) ) {
 #if defined (USE_VENDOR_BLAS)
 	//zgemm_("N", "N", &Rnbrow, &ncols, &ldu, &alpha,
 	zgemm_("N", "N", &gemm_m_pad, &gemm_n_pad, &gemm_k_pad, &alpha,
@@ -575,6 +579,7 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	       &Remain_L_buff[0], &gemm_m_pad,
 	       &bigU[0], &gemm_k_pad, &beta, bigV, &gemm_m_pad);
 #endif
+	}
 
 #if ( PRNTlevel>=1 )
 	tt_end = SuperLU_timer_();
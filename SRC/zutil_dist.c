@@ -569,6 +569,12 @@ void zZeroLblocks(int iam, int_t n, gridinfo_t *grid, zLUstruct_t *LUstruct)
     doublecomplex *nzval;
     int_t nsupers = Glu_persist->supno[n-1] + 1;
 
+#ifdef SLU_HAVE_COMPLEX
+    if ( LUstruct->cLUstruct ) { /* Factored in single precision */
+	zcZeroLblocks(iam, n, grid, LUstruct);
+	return;
+    }
+#endif
     ncb = nsupers / grid->npcol;
     extra = nsupers % grid->npcol;
     mycol = MYCOL( iam, grid );
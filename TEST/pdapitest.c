@@ -0,0 +1,687 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Driver program for testing the routines called around PDGSSVX.
+ *
+ * <pre>
+ * -- Distributed SuperLU routine --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ * </pre>
+ */
+/*
+ * File name:		pdapitest.c
+ * Purpose:             test program of the API routines
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "superlu_ddefs.h"
+
+/*
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * PDAPITEST tests the routines that are called around PDGSSVX, each on a
+ * matrix generated by dcreate_matrix_gen(), e.g. lap3d:10: every test
+ * solves with them and checks the error of the solution against the
+ * generated exact one. The program exits with status 1 if a test fails.
+ *
+ *    mpiexec -n 6 pdapitest -r 2 -c 3 -t Checkpoint -f lap3d:10
+ *
+ * Without -t, all the tests are run.
+ */
+
+#define API_TOL   1e-8             /* Largest relative error of a solution */
+#define API_FILE  "pdapitest.bin"  /* Scratch file of the tests */
+
+typedef struct {
+    gridinfo_t *grid;
+    char *spec;       /* matrix given to dcreate_matrix_gen() */
+    int nrhs;
+    const char *name; /* test being run */
+} api_test_t;
+
+/* Generate the matrix of the test, its right-hand sides and solution. */
+static void
+api_matrix(api_test_t *t, SuperMatrix *A, double **b, int *ldb,
+	   double **xtrue, int *ldx)
+{
+    if ( dcreate_matrix_gen(A, t->nrhs, b, ldb, xtrue, ldx, t->spec,
+			    t->grid) )
+	ABORT("Unknown matrix");
+}
+
+/* Largest error of x relative to the largest entry of xtrue, over all
+   the processes. */
+static double
+api_error(int_t m_loc, int nrhs, double *x, int ldx, double *xtrue,
+	  int ldxt, gridinfo_t *grid)
+{
+    double err[2] = {0.0, 0.0};
+    int_t i;
+    int j;
+
+    for (j = 0; j < nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) {
+	    err[0] = SUPERLU_MAX(err[0], fabs(x[i + j*ldx] - xtrue[i + j*ldxt]));
+	    err[1] = SUPERLU_MAX(err[1], fabs(xtrue[i + j*ldxt]));
+	}
+    MPI_Allreduce(MPI_IN_PLACE, err, 2, MPI_DOUBLE, MPI_MAX, grid->comm);
+    return err[1] > 0.0 ? err[0] / err[1] : err[0];
+}
+
+/* Report a step of a test; returns 1 if it failed. */
+static int
+api_check(gridinfo_t *grid, const char *test, const char *step, int info,
+	  double err)
+{
+    int fail = info != 0 || !(err <= API_TOL);
+
+    if ( !grid->iam )
+	printf("%-12s %-18s info %4d  error %10.2e  %s\n", test, step, info,
+	       err, fail ? "FAILED" : "passed");
+    return fail;
+}
+
+/* Factor A, save the factors with pdSave_LU(), free everything, then
+   load them with pdLoad_LU() and solve with Fact = FACTORED. */
+static int
+test_checkpoint(api_test_t *t)
+{
+    superlu_dist_options_t options;
+    SuperLUStat_t stat;
+    SuperMatrix A;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    gridinfo_t *grid = t->grid;
+    double *b, *xtrue, *berr;
+    int_t n, m_loc;
+    int info, ldb, ldx, nfail, pass, factored;
+
+    if ( !(berr = doubleMalloc_dist(t->nrhs)) )
+	ABORT("Malloc fails for berr[].");
+    set_default_options_dist(&options);
+    options.PrintStat = NO;
+
+    for (pass = 0, nfail = 0; pass < 2; ++pass) {
+	api_matrix(t, &A, &b, &ldb, &xtrue, &ldx);
+	n = A.ncol;
+	m_loc = ((NRformat_loc *) A.Store)->m_loc;
+	dScalePermstructInit(n, n, &ScalePermstruct);
+	dLUstructInit(n, &LUstruct);
+	PStatInit(&stat);
+	factored = 1;
+	if ( pass == 0 ) {
+	    options.Fact = DOFACT;
+	    pdgssvx(&options, &A, &ScalePermstruct, b, ldb, t->nrhs, grid,
+		    &LUstruct, &SOLVEstruct, berr, &stat, &info);
+	    nfail += api_check(grid, t->name, "factor", info,
+			       api_error(m_loc, t->nrhs, b, ldb, xtrue, ldx,
+					 grid));
+	    info = pdSave_LU(API_FILE, n, n, &ScalePermstruct, &LUstruct,
+			     grid);
+	    nfail += api_check(grid, t->name, "pdSave_LU", info, 0.0);
+	} else {
+	    /* A is scaled and permuted as by the factorization. */
+	    info = pdLoad_LU(API_FILE, n, n, &A, &ScalePermstruct,
+			     &LUstruct, grid);
+	    nfail += api_check(grid, t->name, "pdLoad_LU", info, 0.0);
+	    factored = ( info == 0 );
+	    if ( factored ) {
+		options.Fact = FACTORED;
+		options.SolveInitialized = NO;
+		pdgssvx(&options, &A, &ScalePermstruct, b, ldb, t->nrhs, grid,
+			&LUstruct, &SOLVEstruct, berr, &stat, &info);
+		nfail += api_check(grid, t->name, "solve loaded LU", info,
+				   api_error(m_loc, t->nrhs, b, ldb, xtrue,
+					     ldx, grid));
+	    }
+	}
+
+	PStatFree(&stat);
+	if ( factored ) dDestroy_LU(n, grid, &LUstruct);
+	dScalePermstructFree(&ScalePermstruct);
+	dLUstructFree(&LUstruct);
+	if ( options.SolveInitialized ) dSolveFinalize(&options, &SOLVEstruct);
+	Destroy_CompRowLoc_Matrix_dist(&A);
+	SUPERLU_FREE(b);
+	SUPERLU_FREE(xtrue);
+    }
+
+    if ( !grid->iam ) MPI_File_delete(API_FILE, MPI_INFO_NULL);
+    SUPERLU_FREE(berr);
+    return nfail;
+}
+
+/* Write the local rows of A to "filename" one process after the other,
+   in MatrixMarket format with one-based indices if mm, else in triplet
+   format with zero-based indices. */
+static void
+api_write_coord(char *filename, int mm, SuperMatrix *A, gridinfo_t *grid)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    double *nzval = (double *) Astore->nzval;
+    int_t nnz = Astore->nnz_loc, i, k, base = mm ? 1 : 0;
+    int p;
+    FILE *fp;
+
+    MPI_Allreduce(MPI_IN_PLACE, &nnz, 1, mpi_int_t, MPI_SUM, grid->comm);
+    for (p = 0; p < grid->nprow * grid->npcol; ++p) {
+	if ( p == grid->iam ) {
+	    if ( !(fp = fopen(filename, p ? "a" : "w")) )
+		ABORT("Cannot write the matrix file");
+	    if ( p == 0 && mm )
+		fprintf(fp, "%%%%MatrixMarket matrix coordinate real general\n");
+	    if ( p == 0 )
+		fprintf(fp, IFMT " " IFMT " " IFMT "\n", A->nrow, A->ncol, nnz);
+	    for (i = 0; i < Astore->m_loc; ++i)
+		for (k = Astore->rowptr[i]; k < Astore->rowptr[i+1]; ++k)
+		    fprintf(fp, IFMT " " IFMT " %.17g\n",
+			    Astore->fst_row + i + base,
+			    Astore->colind[k] + base, nzval[k]);
+	    fclose(fp);
+	}
+	MPI_Barrier(grid->comm);
+    }
+}
+
+/* Solve A x = b for the sums of the rows of the generated matrix in
+   rowsum[], its solution being all ones, and check the error; A may be
+   distributed otherwise than the generated matrix. */
+static int
+api_solve_rowsum(api_test_t *t, const char *step, SuperMatrix *A,
+		 double *rowsum)
+{
+    superlu_dist_options_t options;
+    SuperLUStat_t stat;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t n = A->ncol, m_loc = Astore->m_loc, ldb = SUPERLU_MAX(m_loc, 1), i;
+    double *b, *ones, *berr;
+    int info, j, fail;
+
+    if ( !(b = doubleMalloc_dist(ldb * t->nrhs)) )
+	ABORT("Malloc fails for b[].");
+    if ( !(ones = doubleMalloc_dist(ldb * t->nrhs)) )
+	ABORT("Malloc fails for ones[].");
+    if ( !(berr = doubleMalloc_dist(t->nrhs)) )
+	ABORT("Malloc fails for berr[].");
+    for (j = 0; j < t->nrhs; ++j)
+	for (i = 0; i < m_loc; ++i) {
+	    b[i + j*ldb] = rowsum[Astore->fst_row + i];
+	    ones[i + j*ldb] = 1.0;
+	}
+
+    set_default_options_dist(&options);
+    options.PrintStat = NO;
+    dScalePermstructInit(n, n, &ScalePermstruct);
+    dLUstructInit(n, &LUstruct);
+    PStatInit(&stat);
+    pdgssvx(&options, A, &ScalePermstruct, b, ldb, t->nrhs, t->grid,
+	    &LUstruct, &SOLVEstruct, berr, &stat, &info);
+    fail = api_check(t->grid, t->name, step, info,
+		     api_error(m_loc, t->nrhs, b, ldb, ones, ldb, t->grid));
+
+    PStatFree(&stat);
+    dDestroy_LU(n, t->grid, &LUstruct);
+    dScalePermstructFree(&ScalePermstruct);
+    dLUstructFree(&LUstruct);
+    if ( options.SolveInitialized ) dSolveFinalize(&options, &SOLVEstruct);
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(ones);
+    SUPERLU_FREE(berr);
+    return fail;
+}
+
+/* Write the generated matrix to a file in each format, read it back with
+   the parallel reader of the format and solve with it; the binary and
+   HDF5 files are written by pdwrite_binary_loc() and pdwrite_hdf5_loc().
+   The HDF5 part is only built with the experimental TPL_ENABLE_HDF5LIB. */
+static int
+test_readers(api_test_t *t)
+{
+    SuperMatrix A, B;
+    NRformat_loc *Astore;
+    gridinfo_t *grid = t->grid;
+    double *b, *xtrue, *rowsum, *nzval;
+    int_t i, k;
+    int ldb, ldx, nfail = 0, fmt, info;
+    static const char *steps[] = {"pdreadMM_loc", "pdreadtriple_loc",
+				  "pdread_binary_loc",
+#ifdef HAVE_HDF5
+				  "pdread_hdf5_loc"
+#endif
+    };
+
+    api_matrix(t, &A, &b, &ldb, &xtrue, &ldx);
+    Astore = (NRformat_loc *) A.Store;
+    nzval = (double *) Astore->nzval;
+    if ( !(rowsum = doubleCalloc_dist(A.nrow)) )
+	ABORT("Calloc fails for rowsum[].");
+    for (i = 0; i < Astore->m_loc; ++i)
+	for (k = Astore->rowptr[i]; k < Astore->rowptr[i+1]; ++k)
+	    rowsum[Astore->fst_row + i] += nzval[k];
+    MPI_Allreduce(MPI_IN_PLACE, rowsum, A.nrow, MPI_DOUBLE, MPI_SUM,
+		  grid->comm);
+
+    for (fmt = 0; fmt < (int) (sizeof(steps) / sizeof(steps[0])); ++fmt) {
+	if ( fmt < 2 ) api_write_coord(API_FILE, fmt == 0, &A, grid);
+	if ( fmt == 0 ) info = pdreadMM_loc(API_FILE, &B, grid);
+	else if ( fmt == 1 ) info = pdreadtriple_loc(API_FILE, &B, grid);
+	else if ( fmt == 2 ) {
+	    if ( (info = pdwrite_binary_loc(API_FILE, &A, grid)) == 0 )
+		info = pdread_binary_loc(API_FILE, &B, grid);
+	}
+#ifdef HAVE_HDF5
+	else {
+	    /* A new HDF5 file, not the binary one. */
+	    if ( !grid->iam ) remove(API_FILE);
+	    MPI_Barrier(grid->comm);
+	    if ( (info = pdwrite_hdf5_loc(API_FILE, "/A", &A, grid)) == 0 )
+		info = pdread_hdf5_loc(API_FILE, "/A", &B, grid);
+	}
+#endif
+	if ( info ) {
+	    nfail += api_check(grid, t->name, steps[fmt], info, 0.0);
+	    continue;
+	}
+	nfail += api_solve_rowsum(t, steps[fmt], &B, rowsum);
+	Destroy_CompRowLoc_Matrix_dist(&B);
+    }
+
+    if ( !grid->iam ) remove(API_FILE);
+    Destroy_CompRowLoc_Matrix_dist(&A);
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(xtrue);
+    SUPERLU_FREE(rowsum);
+    return nfail;
+}
+
+/* Compute the diagonal of A^{-1} with pdSelInv() and pdSelInvDiag(), and
+   compare API_NCOLS of its entries with the columns of A^{-1} solved
+   for. */
+#define API_NCOLS 16
+
+static int
+test_selinv(api_test_t *t)
+{
+    superlu_dist_options_t options;
+    SuperLUStat_t stat;
+    SuperMatrix A;
+    NRformat_loc *Astore;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    dSelInvstruct_t SelInv;
+    gridinfo_t *grid = t->grid;
+    double *b, *xtrue, *berr, *diag, *E, ref[2*API_NCOLS];
+    int_t n, m_loc, fst_row, i, j, nzero;
+    int info, ldb, ldx, nfail, c, nc;
+
+    set_default_options_dist(&options);
+    options.PrintStat = NO;
+    api_matrix(t, &A, &b, &ldb, &xtrue, &ldx);
+    Astore = (NRformat_loc *) A.Store;
+    n = A.ncol;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+    nc = SUPERLU_MIN(n, API_NCOLS);
+    if ( !(berr = doubleMalloc_dist(nc)) )
+	ABORT("Malloc fails for berr[].");
+    dScalePermstructInit(n, n, &ScalePermstruct);
+    dLUstructInit(n, &LUstruct);
+    PStatInit(&stat);
+    pdgssvx(&options, &A, &ScalePermstruct, b, ldb, t->nrhs, grid,
+	    &LUstruct, &SOLVEstruct, berr, &stat, &info);
+    nfail = api_check(grid, t->name, "factor", info,
+		      api_error(m_loc, t->nrhs, b, ldb, xtrue, ldx, grid));
+    if ( info ) goto out;
+
+    if ( !(diag = doubleMalloc_dist(n)) )
+	ABORT("Malloc fails for diag[].");
+    pdSelInv(n, &LUstruct, grid, &SelInv);
+    nzero = pdSelInvDiag(n, &ScalePermstruct, &LUstruct, &SelInv, grid, diag);
+    dSelInvFree(n, grid, &LUstruct, &SelInv);
+
+    /* Columns j(c) = c*n/nc of A^{-1}: ref[c] = A^{-1}(j,j). */
+    if ( !(E = doubleCalloc_dist(SUPERLU_MAX(m_loc, 1) * nc)) )
+	ABORT("Calloc fails for E[].");
+    for (c = 0; c < nc; ++c) {
+	j = c * n / nc;
+	if ( j >= fst_row && j < fst_row + m_loc )
+	    E[j - fst_row + c * SUPERLU_MAX(m_loc, 1)] = 1.0;
+    }
+    options.Fact = FACTORED;
+    pdgssvx(&options, &A, &ScalePermstruct, E, SUPERLU_MAX(m_loc, 1), nc,
+	    grid, &LUstruct, &SOLVEstruct, berr, &stat, &info);
+    for (c = 0; c < 2 * nc; ++c) ref[c] = 0.0;
+    for (c = 0; c < nc; ++c) {
+	j = c * n / nc;
+	if ( j >= fst_row && j < fst_row + m_loc ) {
+	    ref[c] = E[j - fst_row + c * SUPERLU_MAX(m_loc, 1)];
+	    ref[nc + c] = diag[j];
+	}
+    }
+    MPI_Allreduce(MPI_IN_PLACE, ref, 2 * nc, MPI_DOUBLE, MPI_SUM,
+		  grid->comm);
+    /* The error is computed the same on all the processes. */
+    for (i = 0; i < nc; ++i) diag[i] = ref[nc + i];
+    nfail += api_check(grid, t->name, "pdSelInvDiag", info + (int) nzero,
+		       api_error(nc, 1, diag, nc, ref, nc, grid));
+    SUPERLU_FREE(E);
+    SUPERLU_FREE(diag);
+
+out:
+    PStatFree(&stat);
+    dDestroy_LU(n, grid, &LUstruct);
+    dScalePermstructFree(&ScalePermstruct);
+    dLUstructFree(&LUstruct);
+    if ( options.SolveInitialized ) dSolveFinalize(&options, &SOLVEstruct);
+    Destroy_CompRowLoc_Matrix_dist(&A);
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(xtrue);
+    SUPERLU_FREE(berr);
+    return nfail;
+}
+
+/* Get the Schur complement S of the last API_NSCHUR rows and columns with
+   pdGetSchur(), then solve A x = [0; S*1] with a complete factorization:
+   the last API_NSCHUR entries of x must be ones. */
+#define API_NSCHUR 32
+
+static int
+test_schur(api_test_t *t)
+{
+    superlu_dist_options_t options;
+    SuperLUStat_t stat;
+    SuperMatrix A, S;
+    NRformat_loc *Astore, *Sstore;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    gridinfo_t *grid = t->grid;
+    double *b, *xtrue, *berr, *g = NULL, *x2, *ones, *nzval;
+    int_t n, ns, m_loc, fst_row, i, k, nint, n2;
+    int info, ldb, ldx, nfail, pass;
+
+    if ( !(berr = doubleMalloc_dist(1)) )
+	ABORT("Malloc fails for berr[].");
+    for (pass = 0, nfail = 0; pass < 2; ++pass) {
+	api_matrix(t, &A, &b, &ldb, &xtrue, &ldx);
+	Astore = (NRformat_loc *) A.Store;
+	n = A.ncol;
+	m_loc = Astore->m_loc;
+	fst_row = Astore->fst_row;
+	ns = SUPERLU_MIN(API_NSCHUR, n / 2);
+	nint = n - ns;
+	set_default_options_dist(&options);
+	options.PrintStat = NO;
+	dScalePermstructInit(n, n, &ScalePermstruct);
+	dLUstructInit(n, &LUstruct);
+	PStatInit(&stat);
+
+	if ( pass == 0 ) {
+	    /* Partial factorization, and g = S*1. */
+	    options.RowPerm = NOROWPERM;
+	    options.SchurSize = ns;
+	    pdgssvx(&options, &A, &ScalePermstruct, NULL, ldb, 0, grid,
+		    &LUstruct, &SOLVEstruct, berr, &stat, &info);
+	    nfail += api_check(grid, t->name, "partial factor", info, 0.0);
+	    if ( info == 0 ) {
+		pdGetSchur(&options, n, &ScalePermstruct, &LUstruct, grid, &S);
+		Sstore = (NRformat_loc *) S.Store;
+		nzval = (double *) Sstore->nzval;
+		if ( !(g = doubleCalloc_dist(ns)) )
+		    ABORT("Calloc fails for g[].");
+		for (i = 0; i < Sstore->m_loc; ++i)
+		    for (k = Sstore->rowptr[i]; k < Sstore->rowptr[i+1]; ++k)
+			g[Sstore->fst_row + i] += nzval[k];
+		MPI_Allreduce(MPI_IN_PLACE, g, ns, MPI_DOUBLE, MPI_SUM,
+			      grid->comm);
+		Destroy_CompRowLoc_Matrix_dist(&S);
+	    }
+	} else {
+	    for (i = 0; i < m_loc; ++i)
+		b[i] = fst_row + i < nint ? 0.0 : g[fst_row + i - nint];
+	    pdgssvx(&options, &A, &ScalePermstruct, b, ldb, 1, grid,
+		    &LUstruct, &SOLVEstruct, berr, &stat, &info);
+	    if ( !(x2 = doubleMalloc_dist(SUPERLU_MAX(m_loc, 1))) )
+		ABORT("Malloc fails for x2[].");
+	    if ( !(ones = doubleMalloc_dist(SUPERLU_MAX(m_loc, 1))) )
+		ABORT("Malloc fails for ones[].");
+	    for (i = 0, n2 = 0; i < m_loc; ++i)
+		if ( fst_row + i >= nint ) {
+		    x2[n2] = b[i];
+		    ones[n2++] = 1.0;
+		}
+	    nfail += api_check(grid, t->name, "pdGetSchur", info,
+			       api_error(n2, 1, x2, n2, ones, n2, grid));
+	    SUPERLU_FREE(x2);
+	    SUPERLU_FREE(ones);
+	    SUPERLU_FREE(g);
+	}
+
+	PStatFree(&stat);
+	dDestroy_LU(n, grid, &LUstruct);
+	dScalePermstructFree(&ScalePermstruct);
+	dLUstructFree(&LUstruct);
+	if ( options.SolveInitialized ) dSolveFinalize(&options, &SOLVEstruct);
+	Destroy_CompRowLoc_Matrix_dist(&A);
+	SUPERLU_FREE(b);
+	SUPERLU_FREE(xtrue);
+	if ( nfail ) break;
+    }
+
+    SUPERLU_FREE(berr);
+    return nfail;
+}
+
+/* b = A*1 for the values nzval[] of the local rows rowptr[] of A. */
+static void
+api_rowsum(int_t m_loc, int_t *rowptr, double *nzval, int nrhs, double *b,
+	   int ldb)
+{
+    int_t i, k;
+    int j;
+
+    for (i = 0; i < m_loc; ++i) {
+	b[i] = 0.0;
+	for (k = rowptr[i]; k < rowptr[i+1]; ++k) b[i] += nzval[k];
+	for (j = 1; j < nrhs; ++j) b[i + j*ldb] = b[i];
+    }
+}
+
+/* Factor A with RefactorMap = YES, then factor new values of A, its
+   entries off the diagonal halved, with pdgsrefactor(), and solve with
+   Fact = FACTORED; then halve again those of two columns only, factor
+   them with pdgsrefactor_partial() and solve. */
+static int
+test_refactor(api_test_t *t)
+{
+    superlu_dist_options_t options;
+    SuperLUStat_t stat;
+    SuperMatrix A;
+    NRformat_loc *Astore;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    gridinfo_t *grid = t->grid;
+    double *b, *xtrue, *berr, *nzval;
+    int_t *rowptr, *colind, n, m_loc, nnz_loc, i, k, cols[2];
+    int info, ldb, ldx, nfail;
+
+    if ( !(berr = doubleMalloc_dist(t->nrhs)) )
+	ABORT("Malloc fails for berr[].");
+    set_default_options_dist(&options);
+    options.PrintStat = NO;
+    options.RefactorMap = YES;
+    api_matrix(t, &A, &b, &ldb, &xtrue, &ldx);
+    Astore = (NRformat_loc *) A.Store;
+    n = A.ncol;
+    m_loc = Astore->m_loc;
+    nnz_loc = Astore->nnz_loc;
+
+    /* The new values, in the order of the entries of A on entry. */
+    if ( !(nzval = doubleMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for nzval[].");
+    if ( !(rowptr = intMalloc_dist(m_loc + 1)) )
+	ABORT("Malloc fails for rowptr[].");
+    if ( !(colind = intMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for colind[].");
+    for (i = 0; i <= m_loc; ++i) rowptr[i] = Astore->rowptr[i];
+    for (k = 0; k < nnz_loc; ++k) colind[k] = Astore->colind[k];
+    for (i = 0; i < m_loc; ++i)
+	for (k = rowptr[i]; k < rowptr[i+1]; ++k)
+	    nzval[k] = ((double *) Astore->nzval)[k]
+		* (colind[k] == Astore->fst_row + i ? 1.0 : 0.5);
+    cols[0] = n / 4;
+    cols[1] = n - 1;
+
+    dScalePermstructInit(n, n, &ScalePermstruct);
+    dLUstructInit(n, &LUstruct);
+    PStatInit(&stat);
+    pdgssvx(&options, &A, &ScalePermstruct, b, ldb, t->nrhs, grid,
+	    &LUstruct, &SOLVEstruct, berr, &stat, &info);
+    nfail = api_check(grid, t->name, "factor", info,
+		      api_error(m_loc, t->nrhs, b, ldb, xtrue, ldx, grid));
+
+    if ( info == 0 ) {
+	pdgsrefactor(&options, &A, nzval, &ScalePermstruct, grid, &LUstruct,
+		     &SOLVEstruct, &stat, &info);
+	if ( info == 0 ) {
+	    api_rowsum(m_loc, rowptr, nzval, t->nrhs, b, ldb);
+	    options.Fact = FACTORED;
+	    pdgssvx(&options, &A, &ScalePermstruct, b, ldb, t->nrhs, grid,
+		    &LUstruct, &SOLVEstruct, berr, &stat, &info);
+	}
+	nfail += api_check(grid, t->name, "pdgsrefactor", info,
+			   api_error(m_loc, t->nrhs, b, ldb, xtrue, ldx,
+				     grid));
+    }
+
+    if ( info == 0 ) {
+	for (i = 0; i < m_loc; ++i)
+	    for (k = rowptr[i]; k < rowptr[i+1]; ++k)
+		if ( (colind[k] == cols[0] || colind[k] == cols[1])
+		     && colind[k] != Astore->fst_row + i )
+		    nzval[k] *= 0.5;
+	pdgsrefactor_partial(&options, &A, nzval, 2, cols, &ScalePermstruct,
+			     grid, &LUstruct, &SOLVEstruct, &stat, &info);
+	if ( info == 0 ) {
+	    api_rowsum(m_loc, rowptr, nzval, t->nrhs, b, ldb);
+	    pdgssvx(&options, &A, &ScalePermstruct, b, ldb, t->nrhs, grid,
+		    &LUstruct, &SOLVEstruct, berr, &stat, &info);
+	}
+	nfail += api_check(grid, t->name, "partial", info,
+			   api_error(m_loc, t->nrhs, b, ldb, xtrue, ldx,
+				     grid));
+    }
+
+    PStatFree(&stat);
+    dDestroy_LU(n, grid, &LUstruct);
+    dScalePermstructFree(&ScalePermstruct);
+    dLUstructFree(&LUstruct);
+    if ( options.SolveInitialized ) dSolveFinalize(&options, &SOLVEstruct);
+    Destroy_CompRowLoc_Matrix_dist(&A);
+    SUPERLU_FREE(b);
+    SUPERLU_FREE(xtrue);
+    SUPERLU_FREE(berr);
+    SUPERLU_FREE(nzval);
+    SUPERLU_FREE(rowptr);
+    SUPERLU_FREE(colind);
+    return nfail;
+}
+
+static const struct {
+    const char *name;
+    int (*run)(api_test_t *);
+} api_tests[] = {
+    {"Checkpoint", test_checkpoint},
+    {"Readers",    test_readers},
+    {"SelInv",     test_selinv},
+    {"Schur",      test_schur},
+    {"Refactor",   test_refactor}
+};
+
+static void
+parse_command_line(int argc, char *argv[], int *nprow, int *npcol,
+		   int *nrhs, char **test, char **spec)
+{
+    int c;
+    extern char *optarg;
+
+    while ( (c = getopt(argc, argv, "hr:c:s:t:f:")) != EOF ) {
+	switch (c) {
+	  case 'h':
+	    printf("Options:\n");
+	    printf("\t-r <int> - process rows\n");
+	    printf("\t-c <int> - process columns\n");
+	    printf("\t-s <int> - number of right-hand sides\n");
+	    printf("\t-t <char[]> - test to run, all by default\n");
+	    printf("\t-f <char[]> - generated matrix, e.g. lap3d:10\n");
+	    exit(1);
+	    break;
+	  case 'r': *nprow = atoi(optarg);
+	            break;
+	  case 'c': *npcol = atoi(optarg);
+	            break;
+	  case 's': *nrhs = atoi(optarg);
+	            break;
+	  case 't': *test = optarg;
+	            break;
+	  case 'f': *spec = optarg;
+	            break;
+	}
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    gridinfo_t grid;
+    api_test_t t;
+    char *test = NULL;
+    int nprow = 1, npcol = 1, nrun = 0, nfail = 0;
+    size_t i;
+
+    t.spec = "lap3d:10";
+    t.nrhs = 2;
+    parse_command_line(argc, argv, &nprow, &npcol, &t.nrhs, &test, &t.spec);
+
+    MPI_Init(&argc, &argv);
+    superlu_gridinit(MPI_COMM_WORLD, nprow, npcol, &grid);
+    if ( grid.iam >= nprow * npcol ) goto out;
+    t.grid = &grid;
+
+    for (i = 0; i < sizeof(api_tests) / sizeof(api_tests[0]); ++i)
+	if ( !test || !strcmp(test, api_tests[i].name) ) {
+	    t.name = api_tests[i].name;
+	    if ( api_tests[i].run(&t) ) ++nfail;
+	    ++nrun;
+	}
+    if ( !nrun ) {
+	if ( !grid.iam ) printf("Unknown test -t %s\n", test);
+	nfail = 1;
+    } else if ( !grid.iam )
+	printf("%d of %d tests on %s failed\n", nfail, nrun, t.spec);
+
+out:
+    superlu_gridexit(&grid);
+    MPI_Finalize();
+    return nfail ? 1 : 0;
+}
@@ -20,7 +20,7 @@ at the top-level directory.
  */
 #include "superlu_ddefs.h"
 
-int pdcompute_resid(int m, int n, int nrhs, SuperMatrix *A,
+int pdcompute_resid(trans_t trans, int m, int n, int nrhs, SuperMatrix *A,
 		    double *x, int ldx, double *b, int ldb,
 		    gridinfo_t *grid, dSOLVEstruct_t *SOLVEstruct, double *resid)
 {
@@ -36,6 +36,12 @@ int pdcompute_resid(int m, int n, int nrhs, SuperMatrix *A,
     Arguments   
     =========   
 
+    TRANS   (input) trans_t
+            Specifies the form of the system of equations:   
+            = NOTRANS: A *x = b   
+            = TRANS  : A'*x = b   
+            = CONJ   : A'*x = b, the same as TRANS for real A.
+
     M       (input) INTEGER   
             The number of rows of the matrix A.  M >= 0.   
 
@@ -78,22 +84,14 @@ int pdcompute_resid(int m, int n, int nrhs, SuperMatrix *A,
     =====================================================================
 */
 
-    /* Table of constant values */
-    int    inc  = 1;
-    
     /* Local variables */
     int i, j;
-    double anorm, rnorm, rnorm_g;
-    double xnorm, xnorm_g;
+    double anorm;
     double eps;
-    char transc[1];
-    double *ax, *R;
+    double *ax, *aax, *norms, *R, *X_col;
     pdgsmv_comm_t gsmv_comm; 
     int m_loc = ((NRformat_loc*) A->Store)->m_loc;
 
-    /* Function prototypes */
-    extern double dasum_(int *, double *, int *);
-    
     /* Function Body */
     if ( m <= 0 || n <= 0 || nrhs == 0) {
 	*resid = 0.;
@@ -102,52 +100,61 @@ int pdcompute_resid(int m, int n, int nrhs, SuperMatrix *A,
 
     /* Exit with RESID = 1/EPS if ANORM = 0. */
     eps = dmach_dist("Epsilon");
-    anorm = pdlangs("1", A, grid);
+    anorm = pdlangs(trans == NOTRANS ? "1" : "I", A, grid);
     if (anorm <= 0.) {
 	*resid = 1. / eps;
 	return 0;
     }
 
-    if ( !(ax = doubleMalloc_dist(m_loc)) ) ABORT("Malloc fails for work[]");
-    R = ax;
+    if ( !(ax = doubleMalloc_dist(SUPERLU_MAX(2 * m_loc * nrhs, 1))) )
+	ABORT("Malloc fails for work[]");
+    aax = ax + m_loc * nrhs;
+    if ( !(norms = doubleMalloc_dist(2 * nrhs)) )
+	ABORT("Malloc fails for norms[]");
 
     /* A is modified with colind[] permuted to [internal, external]. */
     pdgsmv_init(A, SOLVEstruct->row_to_proc, grid, &gsmv_comm);
 
+    /* op(A) * X for all the right-hand sides: one block product for A. */
+    if ( trans == NOTRANS )
+	pdgsmv_block(A, grid, &gsmv_comm, nrhs, x, ldx, ax, aax, m_loc);
+    else
+	for (j = 0; j < nrhs; ++j)
+	    pdgsmv_trans(0, A, grid, &gsmv_comm, &x[j*ldx], &ax[j*m_loc]);
+
+    /* The local 1-norms of R = B - op(A) * X and of X in one pass,
+       summed over the processes by one Allreduce. */
+    for (j = 0; j < nrhs; ++j) {
+	double rnorm = 0., xnorm = 0.;
+	R = &ax[j*m_loc];
+	X_col = &x[j*ldx];
+	for (i = 0; i < m_loc; ++i) {
+	    rnorm += fabs(b[i + j*ldb] - R[i]);
+	    xnorm += fabs(X_col[i]);
+	}
+	norms[j] = rnorm;
+	norms[nrhs + j] = xnorm;
+    }
+    MPI_Allreduce( MPI_IN_PLACE, norms, 2 * nrhs, MPI_DOUBLE, MPI_SUM,
+		   grid->comm );
+
     /* Compute the maximum over the number of right-hand sides of   
        norm(B - A*X) / ( norm(A) * norm(X) * EPS ) . */
     *resid = 0.;
     for (j = 0; j < nrhs; ++j) {
-	double *B_col = &b[j*ldb];
-	double *X_col = &x[j*ldx];
-
-	/* Compute residual R = B - op(A) * X,   
-	   where op(A) = A, A**T, or A**H, depending on TRANS. */
-	/* Matrix-vector multiply. */
-	pdgsmv(0, A, grid, &gsmv_comm, X_col, ax);
-	    
-	/* Compute residual, stored in R[]. */
-	for (i = 0; i < m_loc; ++i) R[i] = B_col[i] - ax[i];
-
-	rnorm = dasum_(&m_loc, R, &inc);
-	xnorm = dasum_(&m_loc, X_col, &inc);
-
-	/* */
-	MPI_Allreduce( &rnorm, &rnorm_g, 1, MPI_DOUBLE, MPI_SUM, grid->comm );
-	MPI_Allreduce( &xnorm, &xnorm_g, 1, MPI_DOUBLE, MPI_SUM, grid->comm );
-		
-	if (xnorm_g <= 0.) {
+	if (norms[nrhs + j] <= 0.) {
 	    *resid = 1. / eps;
 	} else {
 	    /* Computing MAX */
 	    double d1, d2;
 	    d1 = *resid;
-	    d2 = rnorm_g / anorm / xnorm_g / eps;
+	    d2 = norms[j] / anorm / norms[nrhs + j] / eps;
 	    *resid = SUPERLU_MAX(d1, d2);
 	}
     } /* end for j ... */
 
     pdgsmv_finalize(&gsmv_comm);
+    SUPERLU_FREE(norms);
     SUPERLU_FREE(ax);
 
     return 0;
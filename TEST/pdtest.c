@@ -25,6 +25,8 @@ at the top-level directory.
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 //#include <unistd.h>
 #ifdef _MSC_VER
 #include <wingetopt.h>
@@ -39,18 +41,62 @@ at the top-level directory.
 #define NTRAN  2    
 #define THRESH 20.0
 #define FMT1   "%10s:n=%d, test(%d)=%12.5g\n"
-#define	FMT2   "%10s:fact=%4d, DiagScale=%d, n=%d, imat=%d, test(%d)=%12.5g, berr=%12.5g\n"
+#define	FMT2   "%10s:fact=%4d, trans=%d, DiagScale=%d, n=%d, imat=%d, test(%d)=%12.5g, berr=%12.5g\n"
 #define FMT3   "%10s:info=%d, izero=%d, n=%d, nrhs=%d, imat=%d, nfail=%d\n"
-
+#define PERF_REPS 3        /* Best of PERF_REPS runs in the performance mode */
+#define PERF_TOL  0.25     /* Default tolerance of the times */
+#define PERF_MTOL 0.05     /* Default tolerance of the memory */
+#define PERF_TMIN 1e-3     /* Seconds of timer noise a time may exceed by */
+#define MAX_SET_OPTS 16    /* Most -o options on the command line */
+
+/*! \brief Performance regression mode, see perf_check(). */
+typedef struct {
+    char   *file;     /* baseline file, NULL if the mode is off */
+    char   *matrix;   /* name of the matrix in the baseline file */
+    double tol, mtol; /* relative tolerances of the times and the memory */
+    int    update;    /* append the measured entry to the file */
+} perf_opts_t;
+
+/*! \brief Options of superlu_dist_options_t set by -o Name=value. */
+typedef struct {
+    char *set[MAX_SET_OPTS]; /* the Name=value arguments */
+    int  nset;
+} test_opts_t;
+
+/* The options -o can set; the enumerations are ints. */
+#define OPT_INT(name) { #name, offsetof(superlu_dist_options_t, name), 0 }
+#define OPT_DBL(name) { #name, offsetof(superlu_dist_options_t, name), 1 }
+
+static const struct {
+    const char *name;
+    size_t off;
+    int isdouble;
+} test_opt_table[] = {
+    OPT_INT(ColPerm), OPT_INT(IterRefine), OPT_DBL(DiagPivotThresh),
+    OPT_INT(RowPerm), OPT_DBL(ILU_DropTol), OPT_INT(ParSymbFact),
+    OPT_INT(ReplaceTinyPivot), OPT_INT(num_lookaheads), OPT_INT(SymPattern),
+    OPT_INT(SingleFactor), OPT_INT(ShareReplicated), OPT_DBL(BLR_Tol),
+    OPT_INT(BLR_MinSize), OPT_INT(Reproducible), OPT_INT(PatternCache),
+    OPT_DBL(Amalg_Tol), OPT_DBL(RowPerm_Tol), OPT_INT(Equil_Iter),
+    OPT_DBL(DenseRoot_Tol), OPT_INT(Fact_Comm), OPT_INT(Sched_Priority),
+    OPT_INT(Panel_Compress), OPT_INT(SparseRHS), OPT_INT(Solve_RootSize),
+    OPT_INT(DiagInv), OPT_INT(DiagInv_MinSize), OPT_INT(DiagInv_MaxSize),
+    OPT_INT(Solve_RHSTile), OPT_DBL(MemBudget), OPT_INT(OutOfCore),
+    OPT_INT(ReleaseMemory),
+    OPT_INT(Refine_MsgPrec), OPT_INT(Overlap_Preproc), OPT_INT(DofBlock),
+    OPT_INT(SplitSuper), OPT_INT(Dense_MaxN), OPT_INT(Solve_Compact),
+    OPT_INT(Solve_Priority), OPT_INT(SymValues), OPT_INT(PrintStat)
+};
 
 static void
 parse_command_line(int argc, char *argv[], int *nprow, int *npcol,
 		   char *matrix_type, int *n, int *relax, int *maxsuper,
 		   int *fill_ratio, int *min_gemm_gpu_offload,
-		   int *nrhs, FILE **fp);
+		   int *nrhs, FILE **fp, char **gen, perf_opts_t *perf,
+		   test_opts_t *topts);
 
 extern int
-pdcompute_resid(int m, int n, int nrhs, SuperMatrix *A,
+pdcompute_resid(trans_t trans, int m, int n, int nrhs, SuperMatrix *A,
 		double *x, int ldx, double *b, int ldb,
 		gridinfo_t *grid, dSOLVEstruct_t *SOLVEstruct, double *resid);
 
@@ -93,6 +139,238 @@ PrintSumm(char *type, int nfail, int nrun, int nerrs)
 	printf("%6d error messages recorded\n", nerrs);
 }
 
+/*! \brief Factor and solve A PERF_REPS times with the default options.
+ *
+ * <pre>
+ * Returns in t[0] and t[1] the best factorization and solve times, the
+ * slowest process counting, and in t[2] the largest memory of a process
+ * for the factors in MB. A and b are restored from Asave and bsave.
+ * </pre>
+ */
+static int
+perf_measure(SuperMatrix *A, SuperMatrix *Asave, double *b, double *bsave,
+	     int ldb, int nrhs, double *berr, gridinfo_t *grid, double t[3])
+{
+    superlu_dist_options_t options;
+    SuperLUStat_t stat;
+    dScalePermstruct_t ScalePermstruct;
+    dLUstruct_t LUstruct;
+    dSOLVEstruct_t SOLVEstruct;
+    superlu_dist_mem_usage_t mem_usage;
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int    m = A->nrow, n = A->ncol, info = 0, rep;
+    double loc[3], max[3];
+
+    set_default_options_dist(&options);
+    options.PrintStat = NO;
+    t[0] = t[1] = 1e30;
+    t[2] = 0.0;
+    for (rep = 0; rep < PERF_REPS && !info; ++rep) {
+	dCopy_CompRowLoc_NoAllocation(Asave, A);
+	dCopy_Dense_Matrix_dist(Astore->m_loc, nrhs, bsave, ldb, b, ldb);
+	dScalePermstructInit(m, n, &ScalePermstruct);
+	dLUstructInit(n, &LUstruct);
+	PStatInit(&stat);
+
+	pdgssvx(&options, A, &ScalePermstruct, b, ldb, nrhs, grid,
+		&LUstruct, &SOLVEstruct, berr, &stat, &info);
+
+	if ( !info ) {
+	    dQuerySpace_dist(n, &LUstruct, grid, &stat, &mem_usage);
+	    loc[0] = stat.utime[FACT];
+	    loc[1] = stat.utime[SOLVE];
+	    loc[2] = mem_usage.total * 1e-6;
+	    MPI_Allreduce(loc, max, 3, MPI_DOUBLE, MPI_MAX, grid->comm);
+	    t[0] = SUPERLU_MIN(t[0], max[0]);
+	    t[1] = SUPERLU_MIN(t[1], max[1]);
+	    t[2] = max[2];
+	}
+
+	PStatFree(&stat);
+	dScalePermstructFree(&ScalePermstruct);
+	dDestroy_LU(n, grid, &LUstruct);
+	dLUstructFree(&LUstruct);
+	if ( options.SolveInitialized ) dSolveFinalize(&options, &SOLVEstruct);
+    }
+    return info;
+}
+
+/*! \brief Compare the performance of A with its baseline entry.
+ *
+ * <pre>
+ * The baseline file holds one entry per line,
+ *     matrix nprow npcol nthreads fact_seconds solve_seconds memory_MB
+ * with '#' starting a comment; the first entry of the matrix, grid and
+ * number of OpenMP threads counts. The test fails if the factorization
+ * or the solve is slower than the entry by more than perf->tol and by
+ * more than PERF_TMIN seconds, or the memory larger by more than
+ * perf->mtol. If there is no entry, the measured one is appended to the
+ * file instead; with perf->update, it replaces the entry.
+ * Returns the number of failures, on all processes.
+ * </pre>
+ */
+static int
+perf_check(perf_opts_t *perf, SuperMatrix *A, SuperMatrix *Asave,
+	   double *b, double *bsave, int ldb, int nrhs, double *berr,
+	   gridinfo_t *grid)
+{
+    static const char *what[3] = {"factor", "solve", "memory"};
+    FILE   *fp;
+    char   line[512], name[256], entry[512], *text = NULL;
+    double t[3], base[3], val[3], limit;
+    long   len = 0, at = -1, end = 0;
+    int    nthreads = 1, r, c, nt, found = 0, nfail = 0, i;
+
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    if ( perf_measure(A, Asave, b, bsave, ldb, nrhs, berr, grid, t) ) {
+	if ( !grid->iam ) printf("perf: the factorization failed\n");
+	return 1;
+    }
+
+    if ( !grid->iam ) {
+	if ( (fp = fopen(perf->file, "r")) ) {
+	    while ( !found && fgets(line, sizeof(line), fp) ) {
+		if ( line[0] != '#'
+		     && sscanf(line, "%255s %d %d %d %lf %lf %lf", name, &r, &c,
+			       &nt, &val[0], &val[1], &val[2]) == 7
+		     && !strcmp(name, perf->matrix) && r == grid->nprow
+		     && c == grid->npcol && nt == nthreads ) {
+		    for (i = 0; i < 3; ++i) base[i] = val[i];
+		    at = end; /* offset of the entry */
+		    found = 1;
+		}
+		end += strlen(line);
+	    }
+	    if ( found && perf->update ) { /* keep the file to rewrite it */
+		fseek(fp, 0, SEEK_END);
+		len = ftell(fp);
+		text = (char *) SUPERLU_MALLOC(len + 1);
+		rewind(fp);
+		len = fread(text, 1, len, fp);
+	    }
+	    fclose(fp);
+	}
+
+	sprintf(entry, "%s %d %d %d %.6f %.6f %.3f\n", perf->matrix,
+		(int) grid->nprow, (int) grid->npcol, nthreads,
+		t[0], t[1], t[2]);
+	if ( found && !perf->update ) {
+	    for (i = 0; i < 3; ++i) {
+		limit = i < 2 ? SUPERLU_MAX(base[i] * (1.0 + perf->tol),
+					    base[i] + PERF_TMIN)
+			      : base[i] * (1.0 + perf->mtol);
+		printf("perf: %-7s %10.4f baseline %10.4f (%+6.1f%%) %s\n",
+		       what[i], t[i], base[i],
+		       base[i] > 0.0 ? 100.0 * (t[i] / base[i] - 1.0) : 0.0,
+		       t[i] > limit ? "REGRESSION" : "ok");
+		if ( t[i] > limit ) ++nfail;
+	    }
+	} else if ( (fp = fopen(perf->file, found ? "w" : "a")) ) {
+	    if ( found ) { /* the entry replaces the old one */
+		fwrite(text, 1, at, fp);
+		fputs(entry, fp);
+		fwrite(text + end, 1, len - end, fp);
+	    } else {
+		fputs(entry, fp);
+	    }
+	    fclose(fp);
+	    printf("perf: recorded %s %dx%d %d threads: factor %.4f solve %.4f "
+		   "memory %.3f MB\n", perf->matrix, (int) grid->nprow,
+		   (int) grid->npcol, nthreads, t[0], t[1], t[2]);
+	} else {
+	    printf("perf: cannot write %s\n", perf->file);
+	    nfail = 1;
+	}
+	if ( text ) SUPERLU_FREE(text);
+	fflush(stdout);
+    }
+    MPI_Bcast(&nfail, 1, MPI_INT, 0, grid->comm);
+    return nfail;
+}
+
+/*! \brief Return the process of each row of the distributed A.
+ *
+ * The residuals are computed with this map rather than the one of the
+ * SOLVEstruct of pdgssvx(), which is not set up by the dense path of a
+ * small A (options->Dense_MaxN).
+ */
+static int_t *
+test_row_to_proc(SuperMatrix *A, gridinfo_t *grid)
+{
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int    nprocs = grid->nprow * grid->npcol, p;
+    int_t  loc[2], *rows, *row_to_proc, i;
+
+    loc[0] = Astore->fst_row;
+    loc[1] = Astore->m_loc;
+    if ( !(rows = intMalloc_dist(2 * nprocs)) )
+	ABORT("Malloc fails for rows[].");
+    MPI_Allgather(loc, 2, mpi_int_t, rows, 2, mpi_int_t, grid->comm);
+    if ( !(row_to_proc = intMalloc_dist(SUPERLU_MAX(A->nrow, 1))) )
+	ABORT("Malloc fails for row_to_proc[].");
+    for (p = 0; p < nprocs; ++p)
+	for (i = rows[2*p]; i < rows[2*p] + rows[2*p + 1]; ++i)
+	    row_to_proc[i] = p;
+    SUPERLU_FREE(rows);
+    return row_to_proc;
+}
+
+/*! \brief Set the options of topts, given as Name=value, in options.
+ *
+ * <pre>
+ * Name is a field of superlu_dist_options_t in test_opt_table; the value
+ * of an enumeration is its number, see SRC/superlu_enum_consts.h, e.g.
+ * RowPerm=4 for LargeDiag_AUCTION. Returns the number of the options
+ * that are not valid.
+ * </pre>
+ */
+static int
+set_test_options(superlu_dist_options_t *options, test_opts_t *topts)
+{
+    char   *p = (char *) options, *eq, *end;
+    size_t i, len;
+    double value;
+    int    k, nbad = 0;
+
+    for (k = 0; k < topts->nset; ++k) {
+	eq = strchr(topts->set[k], '=');
+	len = eq ? (size_t) (eq - topts->set[k]) : 0;
+	value = eq ? strtod(eq + 1, &end) : 0.0;
+	for (i = 0; i < sizeof(test_opt_table) / sizeof(test_opt_table[0]); ++i)
+	    if ( len == strlen(test_opt_table[i].name)
+		 && !strncmp(topts->set[k], test_opt_table[i].name, len) )
+		break;
+	if ( !eq || end == eq + 1 || *end
+	     || i == sizeof(test_opt_table) / sizeof(test_opt_table[0]) ) {
+	    printf("Unknown option -o %s\n", topts->set[k]);
+	    ++nbad;
+	} else if ( test_opt_table[i].isdouble ) {
+	    *(double *) (p + test_opt_table[i].off) = value;
+	} else {
+	    *(int *) (p + test_opt_table[i].off) = (int) value;
+	}
+    }
+    return nbad;
+}
+
+/*! \brief Whether pdgssvx() rejects Fact = fact by design with the options
+ * of the tests; these runs are skipped.
+ */
+static int
+test_fact_rejected(superlu_dist_options_t *options, fact_t fact)
+{
+    /* The map of A into L and U is freed, see options->ReleaseMemory;
+       Solve_Compact releases the factors the same way, and SymValues
+       frees U off the diagonal. */
+    if ( fact == SamePattern_SameRowPerm && (options->ReleaseMemory == YES
+					     || options->Solve_Compact == YES
+					     || options->SymValues == YES) )
+	return 1;
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
 /*
@@ -105,6 +383,16 @@ int main(int argc, char *argv[])
  * 
  * The program is invoked by a shell script file -- dtest.csh.
  * The output from the tests are written into a file -- dtest.out.
+ *
+ * With -p <file>, the factorization and solve times and the memory are
+ * also compared with a baseline, see perf_check(); the program then exits
+ * with status 1 on a regression.
+ *
+ * With -o Name=value, the field Name of superlu_dist_options_t is set
+ * for all the tests, see set_test_options(); the program exits with
+ * status 1 if a test does not pass the threshold or pdgssvx() returns
+ * info != 0. The fact modes rejected by design with these options are
+ * skipped, see test_fact_rejected().
  */
     superlu_dist_options_t options;
     SuperLUStat_t stat;
@@ -112,7 +400,7 @@ int main(int argc, char *argv[])
     NRformat_loc *Astore;
     dScalePermstruct_t ScalePermstruct;
     dLUstruct_t LUstruct;
-    dSOLVEstruct_t SOLVEstruct;
+    dSOLVEstruct_t SOLVEstruct, Rstruct;
     gridinfo_t grid;
     double   *nzval_save;
     int_t    *colind_save, *rowptr_save;
@@ -123,16 +411,21 @@ int main(int argc, char *argv[])
     int    iam, info, ldb, ldx, nrhs;
     int_t  iinfo;
     char     **cpp, c;
-    FILE *fp, *fopen();
+    FILE *fp = NULL, *fopen();
+    char *gen = NULL;
     char matrix_type[8], equed[1];
     int  relax, maxsuper=sp_ienv_dist(3), fill_ratio=sp_ienv_dist(6),
          min_gemm_gpu_offload=0;
     int    equil, ifact, nfact, iequil, iequed, prefact, notfactored, diaginv;
-    int    nt, nrun=0, nfail=0, nerrs=0, imat, fimat=0;
+    int    itran, ntran = 2; /* CONJ is the same as TRANS for real A. */
+    rowperm_t rowperm;
+    int    nt, nrun=0, nfail=0, nerrs=0, imat, fimat=0, perf_fail=0;
     int    nimat=1;  /* Currently only test a sparse matrix read from a file. */
     fact_t fact;
     double rowcnd, colcnd, amax;
     double result[NTESTS];
+    perf_opts_t perf = {NULL, "matrix", PERF_TOL, PERF_MTOL, 0};
+    test_opts_t topts;
 
     /* Fixed set of parameters */
     int     iseed[]  = {1988, 1989, 1990, 1991};
@@ -144,12 +437,14 @@ int main(int argc, char *argv[])
     nprow = 1;  /* Default process rows.      */
     npcol = 1;  /* Default process columns.   */
     nrhs = 1;   /* Number of right-hand side. */
+    topts.nset = 0;
     for (i = 0; i < NTESTS; ++i) result[i] = 0.0;
 
     /* Parse command line argv[]. */
     parse_command_line(argc, argv, &nprow, &npcol, matrix_type, &n,
 		       &relax, &maxsuper,
-		       &fill_ratio, &min_gemm_gpu_offload, &nrhs, &fp);
+		       &fill_ratio, &min_gemm_gpu_offload, &nrhs, &fp, &gen,
+		       &perf, &topts);
 
     /* ------------------------------------------------------------
        INITIALIZE MPI ENVIRONMENT. 
@@ -176,6 +471,10 @@ int main(int argc, char *argv[])
     /* Set the default input options. */
     set_default_options_dist(&options);
     options.PrintStat = NO;
+    if ( set_test_options(&options, &topts) ) {
+	nfail = 1;
+	goto out;
+    }
 	
     if (!iam) {
 	print_sp_ienv_dist(&options);
@@ -192,7 +491,12 @@ int main(int argc, char *argv[])
 	/* ------------------------------------------------------------
 	   GET THE MATRIX FROM FILE AND SETUP THE RIGHT HAND SIDE. 
 	   ------------------------------------------------------------*/
-	dcreate_matrix(&A, nrhs, &b, &ldb, &xtrue, &ldx, fp, &grid);
+	if ( gen ) {
+	    if ( dcreate_matrix_gen(&A, nrhs, &b, &ldb, &xtrue, &ldx, gen,
+				    &grid) )
+		ABORT("Unknown matrix");
+	} else
+	    dcreate_matrix(&A, nrhs, &b, &ldb, &xtrue, &ldx, fp, &grid);
 
 	m = A.nrow;
 	n = A.ncol;
@@ -213,6 +517,12 @@ int main(int argc, char *argv[])
 				       nzval_save, colind_save, rowptr_save,
 				       SLU_NR_loc, SLU_D, SLU_GE);
 	dCopy_CompRowLoc_NoAllocation(&A, &Asave);
+	Rstruct.row_to_proc = test_row_to_proc(&A, &grid);
+
+	rowperm = options.RowPerm;
+	for (itran = 0; itran < ntran; ++itran) {
+	options.Trans = transs[itran];
+	options.RowPerm = rowperm;
 
 	for (iequed = 0; iequed < 4; ++iequed) {
 	    int what_equil = equils[iequed];
@@ -226,6 +536,7 @@ int main(int argc, char *argv[])
 	    for (ifact = 0; ifact < nfact; ++ifact) {
 		fact = facts[ifact];
 		options.Fact = fact;
+		if ( test_fact_rejected(&options, fact) ) continue;
 		//if (!iam) printf("ifact loop ... %d\n", ifact);
 #ifdef SLU_HAVE_LAPACK 
 	        for (diaginv = 0; diaginv < 2; ++diaginv) {
@@ -311,6 +622,7 @@ int main(int argc, char *argv[])
 				   "equil %d, what_equil %d, DiagScale %d \n",
 				   nrun, fact, info, equil, what_equil,
 				   ScalePermstruct.DiagScale);
+				++nerrs;
 			    }
 
 			    PStatFree(&stat);
@@ -361,14 +673,15 @@ int main(int argc, char *argv[])
 #endif
 		        if ( info ) {
 			    printf(FMT3, "pdgssvx",info,izero,n,nrhs,imat,nfail);
+			    ++nerrs;
 		        } else {
 			    /* Restore the matrix A. */
 			    dCopy_CompRowLoc_NoAllocation(&Asave, &A);
 
 			    /* Compute residual of the computed solution.*/
 			    solx = b;
-			    pdcompute_resid(m, n, nrhs, &A, solx, ldx,
-                                        bsave, ldb, &grid, &SOLVEstruct, &result[0]);
+			    pdcompute_resid(options.Trans, m, n, nrhs, &A, solx, ldx,
+                                        bsave, ldb, &grid, &Rstruct, &result[0]);
 			
 #if 0  /* how to get RCOND? */
 			/* Check solution accuracy from generated exact solution. */
@@ -383,7 +696,7 @@ int main(int argc, char *argv[])
 			    int k1 = 0;
 			    for (i = k1; i < NTESTS; ++i) {
 			        if ( result[i] >= THRESH ) {
-				    printf(FMT2, "pdgssvx", options.Fact, 
+				    printf(FMT2, "pdgssvx", options.Fact, options.Trans,
 				       ScalePermstruct.DiagScale,
 				       n, imat, i, result[i], berr[0]);
 				    ++nfail;
@@ -415,12 +728,19 @@ int main(int argc, char *argv[])
 	    } /* end for ifact ... */
 		
 	} /* end for iequed ... */
+
+	} /* end for itran ... */
+
+	if ( perf.file )
+	    perf_fail += perf_check(&perf, &A, &Asave, b, bsave, ldb, nrhs,
+				    berr, &grid);
 	
 	/* ------------------------------------------------------------
 	   DEALLOCATE STORAGE.
 	   ------------------------------------------------------------*/
 	Destroy_CompRowLoc_Matrix_dist(&A);
 	Destroy_CompRowLoc_Matrix_dist(&Asave);
+	SUPERLU_FREE(Rstruct.row_to_proc);
 	//	dScalePermstructFree(&ScalePermstruct);
 	SUPERLU_FREE(b);
 	SUPERLU_FREE(bsave);
@@ -430,6 +750,9 @@ int main(int argc, char *argv[])
 
     /* Print a summary of the testing results. */
     if ( iam==0 ) PrintSumm("DGS", nfail, nrun, nerrs);
+    if ( iam==0 && perf.file )
+	printf("Performance %s the baseline %s\n",
+	       perf_fail ? "REGRESSED against" : "is within", perf.file);
 
     SUPERLU_FREE(berr);
 
@@ -448,6 +771,7 @@ out:
     CHECK_MALLOC(iam, "Exit main()");
 #endif
 
+    return perf_fail || nfail || nerrs ? 1 : 0;
 }
 
 /*  
@@ -457,15 +781,16 @@ static void
 parse_command_line(int argc, char *argv[], int *nprow, int *npcol,
 		   char *matrix_type, int *n, int *relax, int *maxsuper,
 		   int *fill_ratio, int *min_gemm_gpu_offload,
-		   int *nrhs, FILE **fp)
+		   int *nrhs, FILE **fp, char **gen, perf_opts_t *perf,
+		   test_opts_t *topts)
 {
     int c;
     extern char *optarg;
     char  str[20];
-    char *xenvstr, *menvstr, *benvstr, *genvstr;
+    char *xenvstr, *menvstr, *benvstr, *genvstr, *p;
     xenvstr = menvstr = benvstr = genvstr = 0;
 
-    while ( (c = getopt(argc, argv, "hr:c:t:n:x:m:b:g:s:f:")) != EOF ) {
+    while ( (c = getopt(argc, argv, "hr:c:t:n:x:m:b:g:s:f:p:T:uo:")) != EOF ) {
 	switch (c) {
 	  case 'h':
 	    printf("Options:\n");
@@ -477,7 +802,12 @@ parse_command_line(int argc, char *argv[], int *nprow, int *npcol,
 	    printf("\t-b <int> - estimated fill ratio to allocate storage\n");
 	    printf("\t-g <int> - minimum size of GEMM to offload to GPU\n");
 	    printf("\t-s <int> - number of right-hand sides\n");
-	    printf("\t-f <char[]> - file name storing a sparse matrix\n");
+	    printf("\t-f <char[]> - file name storing a sparse matrix, or a\n"
+		   "\t              generated one, e.g. lap3d:12\n");
+	    printf("\t-p <char[]> - baseline file of the performance mode\n");
+	    printf("\t-T <tol>[,<mtol>] - tolerances of the times and memory\n");
+	    printf("\t-u - record the performance in the baseline file\n");
+	    printf("\t-o <Name>=<value> - set an option of all the tests\n");
 	    exit(1);
 	    break;
 	  case 'r': *nprow = atoi(optarg);
@@ -529,11 +859,26 @@ parse_command_line(int argc, char *argv[], int *nprow, int *npcol,
 	  case 's': *nrhs = atoi(optarg); 
 	            break;
           case 'f':
-                    if ( !(*fp = fopen(optarg, "r")) ) {
+                    /* A spec such as lap3d:12 names a generated matrix,
+                       see EXAMPLE/dcreate_matrix_gen.c. */
+                    if ( strchr(optarg, ':') && !strchr(optarg, '/') )
+                        *gen = optarg;
+                    else if ( !(*fp = fopen(optarg, "r")) ) {
                         ABORT("File does not exist");
                     }
                     //printf(".. test sparse matrix in file: %s\n", optarg);
+		    perf->matrix = (p = strrchr(optarg, '/')) ? p + 1 : optarg;
                     break;
+	  case 'p': perf->file = optarg;
+		    break;
+	  case 'T': perf->tol = strtod(optarg, &p);
+		    if ( *p == ',' ) perf->mtol = strtod(p + 1, NULL);
+		    break;
+	  case 'u': perf->update = 1;
+		    break;
+	  case 'o': if ( topts->nset < MAX_SET_OPTS )
+			topts->set[topts->nset++] = optarg;
+		    break;
   	}
     }
 }